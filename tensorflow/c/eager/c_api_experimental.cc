@@ -779,6 +779,13 @@ void TFE_ContextSetJitCompileRewrite(TFE_Context* ctx, unsigned char enable,
   tensorflow::unwrap(ctx)->SetJitCompileRewrite(enable);
 }
 
+void TFE_ContextSetPerDeviceExecutors(TFE_Context* ctx, unsigned char enable,
+                                      TF_Status* status) {
+  tensorflow::EagerContext* context =
+      tensorflow::ContextFromInterface(tensorflow::unwrap(ctx));
+  context->SetPerDeviceExecutors(enable);
+}
+
 const char* TFE_TensorHandleDeviceType(TFE_TensorHandle* h, TF_Status* status) {
   if (h == nullptr) {
     status->status = tensorflow::errors::InvalidArgument("Invalid handle");
@@ -707,6 +707,13 @@ TF_CAPI_EXPORT void TFE_ContextSetJitCompileRewrite(TFE_Context* ctx,
                                                     unsigned char enable,
                                                     TF_Status* status);
 
+// Enables dispatching async primitive ops to one executor per device, so that
+// independent ops placed on different devices run concurrently. Only affects
+// ops that are run on the context's default executor in async mode.
+TF_CAPI_EXPORT void TFE_ContextSetPerDeviceExecutors(TFE_Context* ctx,
+                                                     unsigned char enable,
+                                                     TF_Status* status);
+
 // Returns the device type of the operation that produced `h`.
 TF_CAPI_EXPORT extern const char* TFE_TensorHandleDeviceType(
     TFE_TensorHandle* h, TF_Status* status);
@@ -0,0 +1,322 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/c/experimental/filesystem/caching_random_access_file.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/str_util.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+auto* block_cache_bytes = monitoring::Counter<2>::New(
+    "/tensorflow/core/filesystem/block_cache_bytes",
+    "Bytes of the blocks read from the block cache of remote files, by cache "
+    "tier ('ram' or 'disk') and result ('hit' or 'miss').",
+    "tier", "result");
+
+// Exports the hits and misses of a cache tier.
+class BlockCacheMetrics : public tsl::FileBlockCacheStatsInterface {
+ public:
+  explicit BlockCacheMetrics(const std::string& tier)
+      : hit_bytes_(block_cache_bytes->GetCell(tier, "hit")),
+        miss_bytes_(block_cache_bytes->GetCell(tier, "miss")) {}
+
+  void Configure(const tsl::FileBlockCache* block_cache) override {}
+  void RecordCacheHitBlockSize(size_t bytes_transferred) override {
+    hit_bytes_->IncrementBy(bytes_transferred);
+  }
+  void RecordCacheMissBlockSize(size_t bytes_transferred) override {
+    miss_bytes_->IncrementBy(bytes_transferred);
+  }
+
+ private:
+  monitoring::CounterCell* const hit_bytes_;
+  monitoring::CounterCell* const miss_bytes_;
+};
+
+// The process wide cache returned by SharedFileBlockCache::Get.
+SharedFileBlockCache* global_cache = nullptr;
+
+void CloseGlobalDiskTier() { global_cache->CloseDiskTier(); }
+
+}  // namespace
+
+FileBlockCacheConfig FileBlockCacheConfig::FromEnv() {
+  FileBlockCacheConfig config;
+  std::string schemes;
+  int64_t block_size_mb, max_ram_mb, max_disk_mb, max_readahead_blocks;
+  Status status = [&]() -> Status {
+    TF_RETURN_IF_ERROR(
+        ReadStringFromEnvVar("TF_FILE_BLOCK_CACHE_SCHEMES", "", &schemes));
+    TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_FILE_BLOCK_CACHE_BLOCK_SIZE_MB",
+                                           config.block_size >> 20,
+                                           &block_size_mb));
+    TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_FILE_BLOCK_CACHE_MAX_RAM_MB",
+                                           config.max_ram_bytes >> 20,
+                                           &max_ram_mb));
+    TF_RETURN_IF_ERROR(ReadStringFromEnvVar("TF_FILE_BLOCK_CACHE_DIR", "",
+                                            &config.disk_dir));
+    TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_FILE_BLOCK_CACHE_MAX_DISK_MB",
+                                           config.max_disk_bytes >> 20,
+                                           &max_disk_mb));
+    return ReadInt64FromEnvVar("TF_FILE_BLOCK_CACHE_MAX_READAHEAD_BLOCKS",
+                               config.max_readahead_blocks,
+                               &max_readahead_blocks);
+  }();
+  if (!status.ok()) {
+    LOG(ERROR) << "The block cache of remote files is disabled: " << status;
+    return config;
+  }
+  config.schemes = str_util::Split(schemes, ',', str_util::SkipEmpty());
+  config.block_size = std::max<int64_t>(block_size_mb, 0) << 20;
+  config.max_ram_bytes = std::max<int64_t>(max_ram_mb, 0) << 20;
+  config.max_disk_bytes = std::max<int64_t>(max_disk_mb, 0) << 20;
+  config.max_readahead_blocks = std::max<int64_t>(max_readahead_blocks, 0);
+  return config;
+}
+
+SharedFileBlockCache::SharedFileBlockCache(const FileBlockCacheConfig& config)
+    : config_(config) {
+  disk_cache_ = std::make_unique<tsl::DiskFileBlockCache>(
+      config_.disk_dir, config_.block_size, config_.max_disk_bytes,
+      [this](const std::string& fname, size_t offset, size_t n, char* buffer,
+             size_t* bytes_transferred) {
+        return Fetch(fname, offset, n, buffer, bytes_transferred);
+      });
+  ram_cache_ = std::make_unique<tsl::RamFileBlockCache>(
+      config_.block_size, config_.max_ram_bytes, /*max_staleness=*/0,
+      [this](const std::string& fname, size_t offset, size_t n, char* buffer,
+             size_t* bytes_transferred) {
+        return disk_cache_->Read(fname, offset, n, buffer, bytes_transferred);
+      });
+  static BlockCacheMetrics* ram_metrics = new BlockCacheMetrics("ram");
+  static BlockCacheMetrics* disk_metrics = new BlockCacheMetrics("disk");
+  ram_cache_->SetStats(ram_metrics);
+  disk_cache_->SetStats(disk_metrics);
+}
+
+SharedFileBlockCache::~SharedFileBlockCache() { WaitForReadahead(); }
+
+void SharedFileBlockCache::CloseDiskTier() { disk_cache_->Close(); }
+
+void SharedFileBlockCache::WaitForReadahead() {
+  mutex_lock lock(mu_);
+  while (num_prefetches_ > 0) {
+    prefetch_cv_.wait(lock);
+  }
+}
+
+SharedFileBlockCache* SharedFileBlockCache::Get(StringPiece scheme) {
+  static const FileBlockCacheConfig* config =
+      new FileBlockCacheConfig(FileBlockCacheConfig::FromEnv());
+  static SharedFileBlockCache* cache = [] {
+    if (config->schemes.empty() || config->block_size == 0 ||
+        (config->max_ram_bytes == 0 &&
+         (config->disk_dir.empty() || config->max_disk_bytes == 0))) {
+      return static_cast<SharedFileBlockCache*>(nullptr);
+    }
+    VLOG(1) << "Caching remote files of schemes "
+            << absl::StrJoin(config->schemes, ",");
+    global_cache = new SharedFileBlockCache(*config);
+    // Reads may still run at exit, so the cache itself stays alive.
+    std::atexit(&CloseGlobalDiskTier);
+    return global_cache;
+  }();
+  if (cache == nullptr ||
+      std::find(config->schemes.begin(), config->schemes.end(), scheme) ==
+          config->schemes.end()) {
+    return nullptr;
+  }
+  return cache;
+}
+
+std::unique_ptr<RandomAccessFile> SharedFileBlockCache::Wrap(
+    const std::string& fname, StatFn stat,
+    std::unique_ptr<RandomAccessFile> file) {
+  return std::make_unique<CachingRandomAccessFile>(
+      fname, std::move(stat),
+      std::shared_ptr<RandomAccessFile>(std::move(file)), this);
+}
+
+void SharedFileBlockCache::ValidateSignature(const std::string& fname,
+                                             int64_t signature) {
+  // Both tiers drop the blocks of the file if its signature changed.
+  const bool ram_valid =
+      ram_cache_->ValidateAndUpdateFileSignature(fname, signature);
+  const bool disk_valid =
+      disk_cache_->ValidateAndUpdateFileSignature(fname, signature);
+  if (!ram_valid || !disk_valid) {
+    VLOG(1) << "Dropped the cached blocks of modified file " << fname;
+  }
+}
+
+void SharedFileBlockCache::RegisterFile(
+    const std::string& fname, const std::shared_ptr<RandomAccessFile>& file) {
+  mutex_lock lock(mu_);
+  open_files_[fname].push_back(file);
+}
+
+void SharedFileBlockCache::UnregisterFile(
+    const std::string& fname, const std::shared_ptr<RandomAccessFile>& file) {
+  mutex_lock lock(mu_);
+  auto it = open_files_.find(fname);
+  if (it == open_files_.end()) return;
+  it->second.remove(file);
+  if (it->second.empty()) open_files_.erase(it);
+}
+
+Status SharedFileBlockCache::Fetch(const std::string& fname, size_t offset,
+                                   size_t n, char* buffer,
+                                   size_t* bytes_transferred) {
+  std::shared_ptr<RandomAccessFile> file;
+  {
+    mutex_lock lock(mu_);
+    auto it = open_files_.find(fname);
+    if (it != open_files_.end()) file = it->second.front();
+  }
+  if (file == nullptr) {
+    // Only happens for blocks read ahead of a file closed meanwhile.
+    return errors::FailedPrecondition("File ", fname, " is not open");
+  }
+  StringPiece result;
+  Status status = file->Read(offset, n, &result, buffer);
+  if (!status.ok() && !errors::IsOutOfRange(status)) return status;
+  if (result.data() != buffer) memmove(buffer, result.data(), result.size());
+  *bytes_transferred = result.size();
+  return OkStatus();
+}
+
+Status SharedFileBlockCache::Read(const std::string& fname, size_t offset,
+                                  size_t n, char* buffer,
+                                  size_t* bytes_transferred) {
+  return ram_cache_->Read(fname, offset, n, buffer, bytes_transferred);
+}
+
+void SharedFileBlockCache::Prefetch(const std::string& fname, size_t offset) {
+  {
+    mutex_lock lock(mu_);
+    num_prefetches_++;
+  }
+  Env::Default()->SchedClosure([this, fname, offset]() {
+    std::vector<char> buffer(config_.block_size);
+    size_t bytes_transferred;
+    Status status = Read(fname, offset, buffer.size(), buffer.data(),
+                         &bytes_transferred);
+    if (!status.ok()) {
+      VLOG(2) << "Reading ahead " << fname << " at " << offset
+              << " failed: " << status;
+    }
+    mutex_lock lock(mu_);
+    num_prefetches_--;
+    prefetch_cv_.notify_all();
+  });
+}
+
+CachingRandomAccessFile::CachingRandomAccessFile(
+    const std::string& fname, SharedFileBlockCache::StatFn stat,
+    std::shared_ptr<RandomAccessFile> file, SharedFileBlockCache* cache)
+    : fname_(fname),
+      stat_(std::move(stat)),
+      file_(std::move(file)),
+      cache_(cache) {
+  cache_->RegisterFile(fname_, file_);
+}
+
+CachingRandomAccessFile::~CachingRandomAccessFile() {
+  cache_->UnregisterFile(fname_, file_);
+}
+
+Status CachingRandomAccessFile::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+bool CachingRandomAccessFile::MaybeValidate() const {
+  mutex_lock lock(mu_);
+  if (validated_) return cached_;
+  validated_ = true;
+  FileStatistics stat;
+  Status status = stat_(&stat);
+  if (!status.ok()) {
+    VLOG(1) << "Reading " << fname_ << " without the block cache: " << status;
+    return false;
+  }
+  cache_->ValidateSignature(fname_,
+                            Hash64Combine(stat.mtime_nsec, stat.length));
+  file_size_ = stat.length;
+  cached_ = true;
+  return true;
+}
+
+Status CachingRandomAccessFile::Read(uint64 offset, size_t n,
+                                     StringPiece* result,
+                                     char* scratch) const {
+  if (!MaybeValidate()) return file_->Read(offset, n, result, scratch);
+  size_t bytes_transferred = 0;
+  Status status =
+      cache_->Read(fname_, offset, n, scratch, &bytes_transferred);
+  *result = StringPiece(scratch, bytes_transferred);
+  if (!status.ok() && !errors::IsOutOfRange(status)) return status;
+  MaybeReadAhead(offset, bytes_transferred);
+  if (bytes_transferred < n) {
+    return errors::OutOfRange("EOF reached, ", bytes_transferred,
+                              " bytes were read out of ", n,
+                              " bytes requested.");
+  }
+  return OkStatus();
+}
+
+void CachingRandomAccessFile::MaybeReadAhead(uint64 offset, size_t n) const {
+  const size_t block_size = cache_->block_size();
+  const int max_readahead_blocks = cache_->config_.max_readahead_blocks;
+  if (max_readahead_blocks == 0 || n == 0) return;
+  std::vector<uint64> blocks;
+  {
+    mutex_lock lock(mu_);
+    if (offset == next_offset_) {
+      readahead_blocks_ =
+          std::min(std::max(2 * readahead_blocks_, 1), max_readahead_blocks);
+    } else {
+      // Random access, start over.
+      readahead_blocks_ = 0;
+      readahead_end_ = 0;
+    }
+    next_offset_ = offset + n;
+    const uint64 read_end =
+        (offset + n + block_size - 1) / block_size * block_size;
+    const uint64 end =
+        std::min(read_end + readahead_blocks_ * block_size, file_size_);
+    for (uint64 pos = std::max(readahead_end_, read_end); pos < end;
+         pos += block_size) {
+      blocks.push_back(pos);
+    }
+    readahead_end_ = std::max(readahead_end_, end);
+  }
+  for (uint64 pos : blocks) {
+    cache_->Prefetch(fname_, pos);
+  }
+}
+
+}  // namespace tensorflow
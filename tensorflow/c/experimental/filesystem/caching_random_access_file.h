@@ -0,0 +1,184 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_C_EXPERIMENTAL_FILESYSTEM_CACHING_RANDOM_ACCESS_FILE_H_
+#define TENSORFLOW_C_EXPERIMENTAL_FILESYSTEM_CACHING_RANDOM_ACCESS_FILE_H_
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tsl/platform/cloud/disk_file_block_cache.h"
+#include "tsl/platform/cloud/ram_file_block_cache.h"
+
+namespace tensorflow {
+
+// Configuration of the block cache of remote files, see
+// SharedFileBlockCache::Get.
+struct FileBlockCacheConfig {
+  // URI schemes whose files are cached, e.g. {"s3", "hdfs"}.
+  std::vector<std::string> schemes;
+  // Size of the cached blocks and of the reads from the remote filesystem.
+  size_t block_size = 16 << 20;
+  // Maximum bytes of blocks kept in RAM.
+  size_t max_ram_bytes = size_t{1} << 30;
+  // Local directory, e.g. on an SSD, for a second cache tier. No blocks are
+  // stored on disk if it is empty.
+  std::string disk_dir;
+  // Maximum bytes of blocks kept in `disk_dir`.
+  size_t max_disk_bytes = size_t{16} << 30;
+  // Maximum number of blocks read ahead of sequential reads.
+  int max_readahead_blocks = 4;
+
+  // Reads the configuration from the TF_FILE_BLOCK_CACHE_* environment
+  // variables:
+  //   TF_FILE_BLOCK_CACHE_SCHEMES: comma separated schemes, unset disables
+  //     the cache.
+  //   TF_FILE_BLOCK_CACHE_BLOCK_SIZE_MB, TF_FILE_BLOCK_CACHE_MAX_RAM_MB,
+  //   TF_FILE_BLOCK_CACHE_DIR, TF_FILE_BLOCK_CACHE_MAX_DISK_MB and
+  //   TF_FILE_BLOCK_CACHE_MAX_READAHEAD_BLOCKS.
+  static FileBlockCacheConfig FromEnv();
+};
+
+// A block cache of remote files shared by all files of the configured
+// schemes, independent of their filesystem. Blocks are cached in RAM and, if
+// configured, on a local disk, so repeated epochs over a remote dataset read
+// from the local copy. The hit rates of both tiers are exported as the
+// /tensorflow/core/filesystem/block_cache_bytes metric.
+class SharedFileBlockCache {
+ public:
+  // Gets the statistics of a file.
+  using StatFn = std::function<Status(FileStatistics*)>;
+
+  explicit SharedFileBlockCache(const FileBlockCacheConfig& config);
+
+  // Waits for the blocks that are being read ahead.
+  ~SharedFileBlockCache();
+
+  // Returns the process wide cache configured with FileBlockCacheConfig's
+  // FromEnv, or nullptr if the files of `scheme` are not cached.
+  static SharedFileBlockCache* Get(StringPiece scheme);
+
+  // Returns a RandomAccessFile reading `file` through the cache. `stat` is
+  // called on the first read, so opening a file costs no extra remote call.
+  // The modification time and length of the file identify its contents, and
+  // cached blocks of other contents are dropped. The length also bounds the
+  // readahead. If `stat` fails, the file is read without the cache.
+  std::unique_ptr<RandomAccessFile> Wrap(
+      const std::string& fname, StatFn stat,
+      std::unique_ptr<RandomAccessFile> file);
+
+  // Waits for the blocks that are being read ahead.
+  void WaitForReadahead();
+
+  // Deletes the blocks of the disk tier and its directory. Blocks are only
+  // cached in RAM afterwards. The process wide cache of Get() is never
+  // destroyed, so this is called at exit instead.
+  void CloseDiskTier();
+
+  size_t block_size() const { return config_.block_size; }
+
+ private:
+  friend class CachingRandomAccessFile;
+
+  // Reads the files of the cache misses. The remote files are looked up by
+  // name among the files that are currently open through the cache.
+  Status Fetch(const std::string& fname, size_t offset, size_t n,
+               char* buffer, size_t* bytes_transferred);
+
+  void RegisterFile(const std::string& fname,
+                    const std::shared_ptr<RandomAccessFile>& file);
+  void UnregisterFile(const std::string& fname,
+                      const std::shared_ptr<RandomAccessFile>& file);
+
+  // Drops the cached blocks of `fname` if they have another `signature`.
+  void ValidateSignature(const std::string& fname, int64_t signature);
+
+  // Reads `n` bytes at `offset` of `fname` from the cache, fetching the
+  // missing blocks.
+  Status Read(const std::string& fname, size_t offset, size_t n,
+              char* buffer, size_t* bytes_transferred);
+
+  // Loads the block at `offset` into the cache in the background.
+  void Prefetch(const std::string& fname, size_t offset);
+
+  const FileBlockCacheConfig config_;
+
+  mutex mu_;
+  std::map<std::string, std::list<std::shared_ptr<RandomAccessFile>>>
+      open_files_ TF_GUARDED_BY(mu_);
+  int num_prefetches_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable prefetch_cv_;
+
+  // The disk tier is the block fetcher of the RAM tier, so it is only read on
+  // RAM misses.
+  std::unique_ptr<tsl::DiskFileBlockCache> disk_cache_;
+  std::unique_ptr<tsl::RamFileBlockCache> ram_cache_;
+};
+
+// A RandomAccessFile reading through a SharedFileBlockCache. Sequential reads
+// start reading ahead the following blocks in the background, doubling the
+// readahead window up to max_readahead_blocks while the reads stay sequential.
+class CachingRandomAccessFile final : public RandomAccessFile {
+ public:
+  CachingRandomAccessFile(const std::string& fname,
+                          SharedFileBlockCache::StatFn stat,
+                          std::shared_ptr<RandomAccessFile> file,
+                          SharedFileBlockCache* cache);
+  ~CachingRandomAccessFile() override;
+
+  Status Name(StringPiece* result) const override;
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override;
+
+ private:
+  // Stats the file on the first read and validates the cached blocks. Returns
+  // whether the file is read through the cache.
+  bool MaybeValidate() const;
+
+  // Starts reading ahead of a read of [offset, offset + n).
+  void MaybeReadAhead(uint64 offset, size_t n) const;
+
+  const std::string fname_;
+  const SharedFileBlockCache::StatFn stat_;
+  const std::shared_ptr<RandomAccessFile> file_;
+  SharedFileBlockCache* const cache_;  // not owned
+
+  mutable mutex mu_;
+  // Whether the file was stat'ed, and whether that succeeded.
+  mutable bool validated_ TF_GUARDED_BY(mu_) = false;
+  mutable bool cached_ TF_GUARDED_BY(mu_) = false;
+  mutable uint64 file_size_ TF_GUARDED_BY(mu_) = 0;
+  // Offset at which the next read is sequential.
+  mutable uint64 next_offset_ TF_GUARDED_BY(mu_) = 0;
+  // Number of blocks to read ahead.
+  mutable int readahead_blocks_ TF_GUARDED_BY(mu_) = 0;
+  // End of the blocks that were already read ahead.
+  mutable uint64 readahead_end_ TF_GUARDED_BY(mu_) = 0;
+
+  CachingRandomAccessFile(const CachingRandomAccessFile&) = delete;
+  void operator=(const CachingRandomAccessFile&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_C_EXPERIMENTAL_FILESYSTEM_CACHING_RANDOM_ACCESS_FILE_H_
@@ -0,0 +1,228 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/c/experimental/filesystem/caching_random_access_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// An in-memory file that counts the reads, standing in for a remote file.
+class CountingFile : public RandomAccessFile {
+ public:
+  CountingFile(const std::string& contents, std::atomic<int>* reads)
+      : contents_(contents), reads_(reads) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    (*reads_)++;
+    if (offset >= contents_.size()) {
+      *result = StringPiece();
+      return errors::OutOfRange("EOF");
+    }
+    const size_t bytes = std::min(n, contents_.size() - offset);
+    memcpy(scratch, contents_.data() + offset, bytes);
+    *result = StringPiece(scratch, bytes);
+    if (bytes < n) return errors::OutOfRange("EOF");
+    return OkStatus();
+  }
+
+ private:
+  const std::string contents_;
+  std::atomic<int>* const reads_;  // not owned
+};
+
+std::string Contents(size_t size) {
+  std::string contents(size, 0);
+  for (size_t i = 0; i < size; i++) contents[i] = 'a' + i % 26;
+  return contents;
+}
+
+// Returns a stat function of a file of `length` bytes modified at `mtime`,
+// which counts its calls in `*stats`.
+SharedFileBlockCache::StatFn Stat(int64_t length, int64_t mtime,
+                                  int* stats = nullptr) {
+  return [length, mtime, stats](FileStatistics* stat) {
+    if (stats != nullptr) (*stats)++;
+    *stat = FileStatistics(length, mtime, /*is_directory=*/false);
+    return OkStatus();
+  };
+}
+
+FileBlockCacheConfig TestConfig() {
+  FileBlockCacheConfig config;
+  config.schemes = {"test"};
+  config.block_size = 16;
+  config.max_ram_bytes = 32;
+  config.disk_dir = testing::TmpDir();
+  config.max_disk_bytes = 1024;
+  config.max_readahead_blocks = 0;
+  return config;
+}
+
+TEST(CachingRandomAccessFileTest, RepeatedReadsHitTheCache) {
+  const std::string contents = Contents(100);
+  std::atomic<int> reads(0);
+  SharedFileBlockCache cache(TestConfig());
+  std::unique_ptr<RandomAccessFile> file =
+      cache.Wrap("test://file", Stat(contents.size(), 1),
+                 std::make_unique<CountingFile>(contents, &reads));
+
+  char scratch[100];
+  StringPiece result;
+  // Reads the blocks at 0 and 16.
+  TF_EXPECT_OK(file->Read(10, 10, &result, scratch));
+  EXPECT_EQ(result, contents.substr(10, 10));
+  EXPECT_EQ(reads, 2);
+  TF_EXPECT_OK(file->Read(0, 32, &result, scratch));
+  EXPECT_EQ(result, contents.substr(0, 32));
+  EXPECT_EQ(reads, 2);
+
+  // Evicts the first blocks from RAM, they are read from disk afterwards.
+  TF_EXPECT_OK(file->Read(32, 32, &result, scratch));
+  EXPECT_EQ(reads, 4);
+  TF_EXPECT_OK(file->Read(0, 32, &result, scratch));
+  EXPECT_EQ(result, contents.substr(0, 32));
+  EXPECT_EQ(reads, 4);
+
+  // Reads past the end of the file.
+  EXPECT_TRUE(errors::IsOutOfRange(file->Read(90, 20, &result, scratch)));
+  EXPECT_EQ(result, contents.substr(90));
+}
+
+TEST(CachingRandomAccessFileTest, ModifiedFileIsReadAgain) {
+  std::atomic<int> reads(0);
+  SharedFileBlockCache cache(TestConfig());
+  char scratch[16];
+  StringPiece result;
+  {
+    std::unique_ptr<RandomAccessFile> file =
+        cache.Wrap("test://file", Stat(16, 1),
+                   std::make_unique<CountingFile>("old", &reads));
+    EXPECT_TRUE(errors::IsOutOfRange(file->Read(0, 16, &result, scratch)));
+    EXPECT_EQ(result, "old");
+  }
+  std::unique_ptr<RandomAccessFile> file =
+      cache.Wrap("test://file", Stat(16, 2),
+                 std::make_unique<CountingFile>("new", &reads));
+  EXPECT_TRUE(errors::IsOutOfRange(file->Read(0, 16, &result, scratch)));
+  EXPECT_EQ(result, "new");
+  EXPECT_EQ(reads, 2);
+}
+
+TEST(CachingRandomAccessFileTest, StatsOnFirstRead) {
+  const std::string contents = Contents(32);
+  std::atomic<int> reads(0);
+  int stats = 0;
+  SharedFileBlockCache cache(TestConfig());
+  std::unique_ptr<RandomAccessFile> file =
+      cache.Wrap("test://file", Stat(contents.size(), 1, &stats),
+                 std::make_unique<CountingFile>(contents, &reads));
+  EXPECT_EQ(stats, 0);
+
+  char scratch[16];
+  StringPiece result;
+  TF_EXPECT_OK(file->Read(0, 16, &result, scratch));
+  TF_EXPECT_OK(file->Read(0, 16, &result, scratch));
+  EXPECT_EQ(result, contents.substr(0, 16));
+  EXPECT_EQ(stats, 1);
+  EXPECT_EQ(reads, 1);
+}
+
+TEST(CachingRandomAccessFileTest, FailedStatReadsWithoutCache) {
+  const std::string contents = Contents(32);
+  std::atomic<int> reads(0);
+  SharedFileBlockCache cache(TestConfig());
+  std::unique_ptr<RandomAccessFile> file = cache.Wrap(
+      "test://file",
+      [](FileStatistics* stat) { return errors::Unavailable("No stat"); },
+      std::make_unique<CountingFile>(contents, &reads));
+
+  char scratch[16];
+  StringPiece result;
+  TF_EXPECT_OK(file->Read(0, 16, &result, scratch));
+  TF_EXPECT_OK(file->Read(0, 16, &result, scratch));
+  EXPECT_EQ(result, contents.substr(0, 16));
+  EXPECT_EQ(reads, 2);
+}
+
+TEST(CachingRandomAccessFileTest, SequentialReadsReadAhead) {
+  const std::string contents = Contents(160);
+  std::atomic<int> reads(0);
+  FileBlockCacheConfig config = TestConfig();
+  config.max_ram_bytes = 1024;
+  config.max_readahead_blocks = 4;
+  SharedFileBlockCache cache(config);
+  std::unique_ptr<RandomAccessFile> file =
+      cache.Wrap("test://file", Stat(contents.size(), 1),
+                 std::make_unique<CountingFile>(contents, &reads));
+
+  char scratch[16];
+  StringPiece result;
+  // The first read starts reading ahead one block, the second read two more.
+  TF_EXPECT_OK(file->Read(0, 16, &result, scratch));
+  TF_EXPECT_OK(file->Read(16, 16, &result, scratch));
+  EXPECT_EQ(result, contents.substr(16, 16));
+  cache.WaitForReadahead();
+  EXPECT_EQ(reads, 4);
+}
+
+TEST(SharedFileBlockCacheTest, RemovesDiskTier) {
+  const std::string contents = Contents(64);
+  std::atomic<int> reads(0);
+  FileBlockCacheConfig config = TestConfig();
+  config.disk_dir = io::JoinPath(testing::TmpDir(), "removes_disk_tier");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(config.disk_dir));
+  std::vector<std::string> children;
+  char scratch[16];
+  StringPiece result;
+  {
+    SharedFileBlockCache cache(config);
+    std::unique_ptr<RandomAccessFile> file =
+        cache.Wrap("test://file", Stat(contents.size(), 1),
+                   std::make_unique<CountingFile>(contents, &reads));
+    TF_EXPECT_OK(file->Read(0, 16, &result, scratch));
+    TF_ASSERT_OK(Env::Default()->GetChildren(config.disk_dir, &children));
+    EXPECT_EQ(children.size(), 1);
+  }
+  // Destroying the cache removes its directory.
+  TF_ASSERT_OK(Env::Default()->GetChildren(config.disk_dir, &children));
+  EXPECT_TRUE(children.empty());
+
+  SharedFileBlockCache cache(config);
+  std::unique_ptr<RandomAccessFile> file =
+      cache.Wrap("test://file", Stat(contents.size(), 1),
+                 std::make_unique<CountingFile>(contents, &reads));
+  TF_EXPECT_OK(file->Read(0, 16, &result, scratch));
+  cache.CloseDiskTier();
+  TF_ASSERT_OK(Env::Default()->GetChildren(config.disk_dir, &children));
+  EXPECT_TRUE(children.empty());
+  // The file is still read, from RAM or the remote file.
+  TF_EXPECT_OK(file->Read(16, 16, &result, scratch));
+  EXPECT_EQ(result, contents.substr(16, 16));
+}
+
+}  // namespace
+}  // namespace tensorflow
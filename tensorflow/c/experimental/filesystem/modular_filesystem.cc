@@ -18,6 +18,7 @@ limitations under the License.
 #include <string>
 #include <utility>
 
+#include "tensorflow/c/experimental/filesystem/caching_random_access_file.h"
 #include "tensorflow/c/experimental/filesystem/modular_filesystem_registration.h"
 #include "tensorflow/c/tf_status_helper.h"
 #include "tensorflow/core/platform/env.h"
@@ -47,11 +48,27 @@ Status ModularFileSystem::NewRandomAccessFile(
   ops_->new_random_access_file(filesystem_.get(), translated_name.c_str(),
                                file.get(), plugin_status.get());
 
-  if (TF_GetCode(plugin_status.get()) == TF_OK)
-    *result = std::make_unique<ModularRandomAccessFile>(
-        translated_name, std::move(file), random_access_file_ops_.get());
-
-  return StatusFromTF_Status(plugin_status.get());
+  if (TF_GetCode(plugin_status.get()) != TF_OK)
+    return StatusFromTF_Status(plugin_status.get());
+
+  *result = std::make_unique<ModularRandomAccessFile>(
+      translated_name, std::move(file), random_access_file_ops_.get());
+
+  // Read the files of the schemes configured for caching through the shared
+  // block cache. Their stats identify the cached contents, and are only
+  // fetched once the file is read.
+  StringPiece scheme, host, path;
+  ParseURI(fname, &scheme, &host, &path);
+  SharedFileBlockCache* cache = SharedFileBlockCache::Get(scheme);
+  if (cache != nullptr) {
+    *result = cache->Wrap(
+        translated_name,
+        [this, fname, token](FileStatistics* stat) {
+          return Stat(fname, token, stat);
+        },
+        std::move(*result));
+  }
+  return OkStatus();
 }
 
 Status ModularFileSystem::NewWritableFile(
@@ -0,0 +1,77 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Picks between the batch-size variants of a model generated by tf_library
+// with `batch_sizes`, which are each compiled for one fixed batch size.
+#ifndef TENSORFLOW_COMPILER_AOT_BATCH_VARIANTS_H_
+#define TENSORFLOW_COMPILER_AOT_BATCH_VARIANTS_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function.h"
+
+namespace tensorflow {
+namespace tfcompile {
+
+// BatchVariants owns one computation per batch size, and selects the smallest
+// one which fits a batch. Callers pad the inputs of the selected computation
+// from the batch size of the request up to the one of the computation.
+//
+// Example usage, for variants generated with batch_sizes = [1, 8, 32]:
+//
+//   BatchVariants variants;
+//   variants.Add(1, std::make_unique<MyModelBatch1>());
+//   variants.Add(8, std::make_unique<MyModelBatch8>());
+//   variants.Add(32, std::make_unique<MyModelBatch32>());
+//   int64_t padded_batch_size;
+//   XlaCompiledCpuFunction* computation =
+//       variants.Select(batch_size, &padded_batch_size);
+class BatchVariants {
+ public:
+  // Adds the computation compiled for `batch_size`, replacing any previous
+  // computation for the same batch size.
+  void Add(int64_t batch_size,
+           std::unique_ptr<XlaCompiledCpuFunction> computation) {
+    variants_[batch_size] = std::move(computation);
+  }
+
+  // Returns the computation with the smallest batch size which is at least
+  // `batch_size`, and sets `*padded_batch_size` to its batch size. Returns
+  // nullptr if `batch_size` is larger than the batch size of all variants.
+  XlaCompiledCpuFunction* Select(int64_t batch_size,
+                                 int64_t* padded_batch_size) const {
+    auto it = variants_.lower_bound(batch_size);
+    if (it == variants_.end()) return nullptr;
+    *padded_batch_size = it->first;
+    return it->second.get();
+  }
+
+  // Returns the largest batch size which a variant can run, or 0 if there are
+  // no variants.
+  int64_t max_batch_size() const {
+    return variants_.empty() ? 0 : variants_.rbegin()->first;
+  }
+
+ private:
+  std::map<int64_t, std::unique_ptr<XlaCompiledCpuFunction>> variants_;
+};
+
+}  // namespace tfcompile
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_AOT_BATCH_VARIANTS_H_
@@ -0,0 +1,54 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/aot/batch_variants.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/compiler/aot/test_graph_tfadd.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace tfcompile {
+namespace {
+
+TEST(BatchVariants, SelectsSmallestFittingVariant) {
+  BatchVariants variants;
+  EXPECT_EQ(variants.max_batch_size(), 0);
+  int64_t padded_batch_size = -1;
+  EXPECT_EQ(variants.Select(1, &padded_batch_size), nullptr);
+
+  auto small = std::make_unique<AddComp>();
+  auto large = std::make_unique<AddComp>();
+  XlaCompiledCpuFunction* small_ptr = small.get();
+  XlaCompiledCpuFunction* large_ptr = large.get();
+  variants.Add(8, std::move(large));
+  variants.Add(1, std::move(small));
+  EXPECT_EQ(variants.max_batch_size(), 8);
+
+  EXPECT_EQ(variants.Select(1, &padded_batch_size), small_ptr);
+  EXPECT_EQ(padded_batch_size, 1);
+  EXPECT_EQ(variants.Select(2, &padded_batch_size), large_ptr);
+  EXPECT_EQ(padded_batch_size, 8);
+  EXPECT_EQ(variants.Select(8, &padded_batch_size), large_ptr);
+  EXPECT_EQ(padded_batch_size, 8);
+  EXPECT_EQ(variants.Select(9, &padded_batch_size), nullptr);
+}
+
+}  // namespace
+}  // namespace tfcompile
+}  // namespace tensorflow
@@ -23,6 +23,7 @@ limitations under the License.
 #include <sys/time.h>
 
 #include <algorithm>
+#include <cmath>
 #include <string>
 #include <utility>
 #include <vector>
@@ -43,6 +44,21 @@ static uint64 NowMicros() {
   return static_cast<uint64>(tv.tv_sec) * 1000000 + tv.tv_usec;
 }
 
+// Returns the nearest-rank `percentile` of the sorted `sorted_us`.
+static int64_t SortedPercentile(const std::vector<int64_t>& sorted_us,
+                                double percentile) {
+  if (sorted_us.empty()) return 0;
+  const double rank = percentile / 100 * sorted_us.size();
+  size_t index = rank <= 1 ? 0 : static_cast<size_t>(std::ceil(rank)) - 1;
+  return sorted_us[std::min(index, sorted_us.size() - 1)];
+}
+
+int64_t Percentile(const Stats& stats, double percentile) {
+  std::vector<int64_t> sorted_us(stats.per_iter_us);
+  std::sort(sorted_us.begin(), sorted_us.end());
+  return SortedPercentile(sorted_us, percentile);
+}
+
 void DumpStatsToStdout(const Stats& stats) {
   // Compute stats.
   std::vector<int64_t> sorted_us(stats.per_iter_us);
@@ -83,6 +99,10 @@ void DumpStatsToStdout(const Stats& stats) {
       {"Mean:", sum_us / count_us},
       {std::move(label_trimmed), sum_us_trimmed / count_us_trimmed},
       {std::move(label_best), sum_us_best / count_us_best},
+      {"p50:", static_cast<double>(SortedPercentile(sorted_us, 50))},
+      {"p90:", static_cast<double>(SortedPercentile(sorted_us, 90))},
+      {"p99:", static_cast<double>(SortedPercentile(sorted_us, 99))},
+      {"p99.9:", static_cast<double>(SortedPercentile(sorted_us, 99.9))},
   };
   int max_label_size = 0;
   double max_us = 0;
@@ -106,6 +126,10 @@ void DumpStatsToStdout(const Stats& stats) {
     printf("  %-*s %*.3f us\n", max_label_size, g.first.c_str(), max_digits + 4,
            g.second);
   }
+  if (stats.total_us > 0) {
+    printf("  %-*s %.3f iterations/s\n", max_label_size, "Throughput:",
+           count_us * 1e6 / stats.total_us);
+  }
 }
 
 void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
@@ -52,8 +52,12 @@ struct Stats {
   Stats() : total_us(0) { per_iter_us.reserve(5000); }
 };
 
+// Percentile returns the per-iteration time in us below which `percentile`
+// percent of the iterations of `stats` ran, or 0 if there are no iterations.
+int64_t Percentile(const Stats& stats, double percentile);
+
 // DumpStatsToStdout printfs to stdout stats in a multi-line human-friendly
-// form.
+// form, including latency percentiles and throughput.
 void DumpStatsToStdout(const Stats& stats);
 
 // BenchmarkFn is the signature of the function generated by tfcompile.
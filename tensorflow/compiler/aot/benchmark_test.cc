@@ -40,6 +40,19 @@ TEST(Benchmark, Benchmark) {
   EXPECT_EQ(stats5.per_iter_us.size(), 5);
 }
 
+TEST(Benchmark, Percentile) {
+  Stats stats;
+  EXPECT_EQ(Percentile(stats, 50), 0);
+  for (int64_t us = 100; us >= 1; --us) {
+    stats.per_iter_us.push_back(us);
+  }
+  EXPECT_EQ(Percentile(stats, 0), 1);
+  EXPECT_EQ(Percentile(stats, 50), 50);
+  EXPECT_EQ(Percentile(stats, 99), 99);
+  EXPECT_EQ(Percentile(stats, 99.9), 100);
+  EXPECT_EQ(Percentile(stats, 100), 100);
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tfcompile
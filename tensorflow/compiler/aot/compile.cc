@@ -160,6 +160,7 @@ Status CompileGraph(GraphDef graph_def, const tf2xla::Config& config,
       flags.entry_point,
       xla::cpu::CpuAotCompilationOptions::RelocationModel::BigPic);
   aot_opts.set_use_mlir_hlo_lowering(use_mlir_hlo_lowering);
+  aot_opts.set_intra_op_parallelism(flags.intra_op_parallelism);
 
   if (flags.sanitize_dataflow) {
     aot_opts.set_sanitize_dataflow(flags.sanitize_dataflow);
@@ -178,6 +179,19 @@ static Status ReadProtoFile(const string& fname, protobuf::Message* proto) {
   }
 }
 
+// Sets the first dimension of the shape of every feed in `config` to
+// `batch_size`.
+static Status SetFeedBatchSize(int64_t batch_size, tf2xla::Config* config) {
+  for (tf2xla::Feed& feed : *config->mutable_feed()) {
+    if (feed.shape().dim_size() == 0) {
+      return errors::InvalidArgument(
+          "Can't set the batch size of scalar feed ", feed.id().node_name());
+    }
+    feed.mutable_shape()->mutable_dim(0)->set_size(batch_size);
+  }
+  return absl::OkStatus();
+}
+
 static absl::once_flag targets_init;
 
 static void InitializeTargets() {
@@ -253,6 +267,9 @@ Status Main(const MainFlags& flags) {
   }
   TF_RETURN_IF_ERROR(ReadProtoFile(flags.config, &config));
   TF_RETURN_IF_ERROR(ValidateConfig(config));
+  if (flags.batch_size > 0) {
+    TF_RETURN_IF_ERROR(SetFeedBatchSize(flags.batch_size, &config));
+  }
   if (flags.dump_fetch_nodes) {
     std::set<string> nodes;
     for (const tf2xla::Fetch& fetch : config.fetch()) {
@@ -80,6 +80,13 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
       {"experimental_quantize", &flags->experimental_quantize,
        "If set, quantization passes will run and dump the result before HLO "
        "code generation."},
+      {"intra_op_parallelism", &flags->intra_op_parallelism,
+       "If positive, large ops are split into up to this many tasks which run "
+       "in parallel on the thread pool set with set_thread_pool().  By "
+       "default the generated code is single-threaded."},
+      {"batch_size", &flags->batch_size,
+       "If positive, overrides the first dimension of every feed shape in the "
+       "config, to compile a variant of the model for this batch size."},
       {"sanitize_dataflow", &flags->sanitize_dataflow,
        "Enable DataFlow Sanitizer pass."},
       {"sanitize_abilists_dataflow", &flags->sanitize_abilists_dataflow,
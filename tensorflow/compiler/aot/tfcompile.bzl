@@ -154,7 +154,9 @@ def _tf_library(
         deps = None,
         tags = [],
         copts = [],
-        xla_flags = None):
+        xla_flags = None,
+        intra_op_parallelism = 0,
+        batch_size = 0):
     if not cpp_class:
         fail("cpp_class must be specified")
 
@@ -253,6 +255,12 @@ def _tf_library(
 
     mlir_flags = ["--mlir_components=" + mlir_components]
 
+    codegen_flags = []
+    if intra_op_parallelism > 0:
+        codegen_flags.append("--intra_op_parallelism=%d" % intra_op_parallelism)
+    if batch_size > 0:
+        codegen_flags.append("--batch_size=%d" % batch_size)
+
     srcs = [tfcompile_graph, config]
     debug_info_flags = []
     if debug_info:
@@ -274,7 +282,7 @@ def _tf_library(
         target_cpu = tfcompile_target_cpu(name),
         target_triple = target_llvm_triple(),
         flags = flags,
-        extra_flags = debug_info_flags + profiling_flags + mlir_flags + traceme_flags,
+        extra_flags = debug_info_flags + profiling_flags + mlir_flags + traceme_flags + codegen_flags,
         dfsan = tfcompile_dfsan_enabled(),
         dfsan_abilists = tfcompile_dfsan_abilists(),
         is_linux = select({
@@ -321,6 +329,7 @@ def _tf_library(
             # needed.
             "@local_xla//xla/service/cpu:runtime_conv2d",
             "@local_xla//xla/service/cpu:runtime_custom_call_status",
+            "@local_xla//xla/service/cpu:runtime_fork_join",
             "@local_xla//xla/service/cpu:runtime_key_value_sort",
             "@local_xla//xla/service/cpu:runtime_matmul",
             "@local_xla//xla/service/cpu:runtime_topk",
@@ -463,7 +472,9 @@ def tf_library(
         deps = None,
         tags = [],
         copts = [],
-        xla_flags = None):
+        xla_flags = None,
+        intra_op_parallelism = 0,
+        batch_sizes = None):
     """Compiles a TensorFlow graph into an executable with fast math enabled.
 
     Given an invocation of tf_library(name="foo", ...), generates the following
@@ -476,6 +487,11 @@ def tf_library(
                       useful for mobile devices or other platforms that can't
                       compile the full test libraries. Only created if
                       gen_benchmark=True.
+      foo_batch<N>:  For every N in batch_sizes, a cc_library like foo with the
+                      class <cpp_class>Batch<N>, compiled for a batch size of
+                      N, and its foo_batch<N>_benchmark if gen_benchmark=True.
+                      See tensorflow/compiler/aot/batch_variants.h to select
+                      between them at runtime.
     The output header is called <name>.h.
 
     Args:
@@ -523,6 +539,12 @@ def tf_library(
         library, added to the standard deps if standard_runtime_deps is True.
       tags: tags to apply to subsidiary build rules.
       copts: list of copts to pass to cc rules.
+      xla_flags: Extra XLA_FLAGS for tfcompile.
+      intra_op_parallelism: If positive, large ops are split into up to this
+        many tasks which run in parallel on the thread pool of the generated
+        class, instead of running single-threaded.
+      batch_sizes: Batch sizes to compile variants of the graph for, by
+        overriding the first dimension of every feed in the config.
     """
     _tf_library(
         name,
@@ -547,7 +569,35 @@ def tf_library(
         tags,
         copts,
         xla_flags,
+        intra_op_parallelism,
     )
+    for batch_size in batch_sizes or []:
+        _tf_library(
+            name = "%s_batch%d" % (name, batch_size),
+            graph = graph,
+            config = config,
+            debug_info = debug_info,
+            freeze_checkpoint = freeze_checkpoint,
+            freeze_saver = freeze_saver,
+            cpp_class = "%sBatch%d" % (cpp_class, batch_size),
+            gen_test = False,
+            gen_benchmark = gen_benchmark,
+            gen_compiler_log = gen_compiler_log,
+            visibility = visibility,
+            testonly = testonly,
+            tfcompile_flags = tfcompile_flags,
+            tfcompile_tool = tfcompile_tool,
+            include_standard_runtime_deps = include_standard_runtime_deps,
+            enable_xla_hlo_profiling = enable_xla_hlo_profiling,
+            enable_tracemes = enable_tracemes,
+            mlir_components = mlir_components,
+            deps = deps,
+            tags = tags,
+            copts = copts,
+            xla_flags = xla_flags,
+            intra_op_parallelism = intra_op_parallelism,
+            batch_size = batch_size,
+        )
 
 def target_llvm_triple():
     """Returns the target LLVM triple to be used for compiling the target."""
@@ -0,0 +1,76 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/clustering_cost_model.h"
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+
+ClusterCostEstimate ClusterCostEstimate::ForNode(
+    const Node& node, const std::vector<InferredShape>* output_shapes) {
+  ClusterCostEstimate estimate;
+  estimate.num_nodes_ = 1;
+  // Like the effective cluster size, Identity and Const nodes do not make a
+  // cluster more worth compiling.
+  if (node.IsIdentity() || node.IsConstant()) {
+    return estimate;
+  }
+
+  double output_bytes = 0;
+  bool has_dynamic_shape = false;
+  for (int i = 0; i < node.num_outputs(); ++i) {
+    const PartialTensorShape* shape =
+        output_shapes != nullptr && i < static_cast<int>(output_shapes->size())
+            ? &(*output_shapes)[i].shape
+            : nullptr;
+    if (shape == nullptr || !shape->IsFullyDefined()) {
+      has_dynamic_shape |= shape != nullptr;
+      output_bytes += kUnknownOutputBytes;
+      continue;
+    }
+    output_bytes += static_cast<double>(shape->num_elements()) *
+                    DataTypeSize(BaseType(node.output_type(i)));
+  }
+  estimate.num_dynamic_shape_nodes_ = has_dynamic_shape ? 1 : 0;
+  estimate.savings_usec_ =
+      kOpOverheadUsec + output_bytes * kMemoryRoundTripUsecPerByte;
+  return estimate;
+}
+
+void ClusterCostEstimate::Merge(const ClusterCostEstimate& other) {
+  num_nodes_ += other.num_nodes_;
+  num_dynamic_shape_nodes_ += other.num_dynamic_shape_nodes_;
+  savings_usec_ += other.savings_usec_;
+}
+
+double ClusterCostEstimate::RecompilationCostUsec() const {
+  // The cluster is recompiled if any of its dynamic shapes changes.
+  const double recompilation_probability =
+      1.0 - std::pow(1.0 - kShapeChangeProbability, num_dynamic_shape_nodes_);
+  return recompilation_probability * kCompileUsecPerNode * num_nodes_;
+}
+
+bool ShouldMergeClusters(const ClusterCostEstimate& a,
+                         const ClusterCostEstimate& b) {
+  ClusterCostEstimate merged = a;
+  merged.Merge(b);
+  return merged.BenefitUsec() >= a.BenefitUsec() + b.BenefitUsec();
+}
+
+}  // namespace tensorflow
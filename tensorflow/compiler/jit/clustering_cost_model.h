@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_CLUSTERING_COST_MODEL_H_
+#define TENSORFLOW_COMPILER_JIT_CLUSTERING_COST_MODEL_H_
+
+#include <vector>
+
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/core/graph/graph.h"
+
+namespace tensorflow {
+
+// A static estimate of the time saved per step by compiling a set of
+// TensorFlow nodes as one XLA cluster.  Used by MarkForCompilationPass and
+// PartiallyDeclusterPass when --tf_xla_cost_based_clustering is set.
+//
+// Compiling a cluster saves the TF executor overhead of every op in it and the
+// memory round trip of the outputs XLA can fuse away.  In exchange every step
+// pays for launching the cluster, and the cluster is recompiled whenever the
+// shape of one of its dynamically shaped tensors changes.  Recompiling takes
+// time proportional to the size of the cluster, so merging many dynamically
+// shaped nodes into a large cluster can cost more than the launch it saves.
+//
+// All times are in microseconds.  The constants are deliberately rough, the
+// model is only used to compare clustering decisions with each other.
+class ClusterCostEstimate {
+ public:
+  // Fixed cost of running a cluster once instead of its ops one by one.
+  static constexpr double kLaunchOverheadUsec = 10.0;
+  // TF executor overhead of running one op.
+  static constexpr double kOpOverheadUsec = 3.0;
+  // Time to write one byte of a tensor to memory and read it back.
+  static constexpr double kMemoryRoundTripUsecPerByte = 1e-4;
+  // Output size assumed for tensors whose shape is not fully known.
+  static constexpr double kUnknownOutputBytes = 4096.0;
+  // Time spent compiling one node of a cluster.
+  static constexpr double kCompileUsecPerNode = 200.0;
+  // Probability that a dynamically shaped tensor gets a new shape in a step.
+  static constexpr double kShapeChangeProbability = 1e-4;
+
+  ClusterCostEstimate() = default;
+
+  // Returns the estimate for a cluster containing only `node`.
+  // `output_shapes` are the shapes inferred for the outputs of `node` or
+  // nullptr if shape inference did not run for it.
+  static ClusterCostEstimate ForNode(
+      const Node& node, const std::vector<InferredShape>* output_shapes);
+
+  // Adds the nodes of `other` to this estimate.
+  void Merge(const ClusterCostEstimate& other);
+
+  // The number of nodes in the cluster.
+  int num_nodes() const { return num_nodes_; }
+
+  // The number of nodes with outputs whose shape is not fully known.
+  int num_dynamic_shape_nodes() const { return num_dynamic_shape_nodes_; }
+
+  // Executor overhead and memory traffic saved per step by the cluster.
+  double SavingsUsec() const { return savings_usec_; }
+
+  // Expected time spent per step recompiling the cluster.
+  double RecompilationCostUsec() const;
+
+  // Estimated time saved per step by compiling the cluster.  Negative if the
+  // cluster is not worth compiling.
+  double BenefitUsec() const {
+    return SavingsUsec() - kLaunchOverheadUsec - RecompilationCostUsec();
+  }
+
+  bool IsProfitable() const { return BenefitUsec() > 0; }
+
+ private:
+  int num_nodes_ = 0;
+  int num_dynamic_shape_nodes_ = 0;
+  double savings_usec_ = 0;
+};
+
+// Returns true if compiling `a` and `b` as one cluster is estimated to save
+// at least as much as compiling them as two clusters.
+bool ShouldMergeClusters(const ClusterCostEstimate& a,
+                         const ClusterCostEstimate& b);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_CLUSTERING_COST_MODEL_H_
@@ -0,0 +1,120 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/clustering_cost_model.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class ClusteringCostModelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Scope root = Scope::NewRootScope().ExitOnError();
+    auto a = ops::Placeholder(root.WithOpName("a"), DT_FLOAT);
+    auto b = ops::Placeholder(root.WithOpName("b"), DT_FLOAT);
+    auto add = ops::Add(root.WithOpName("add"), a, b);
+    auto identity = ops::Identity(root.WithOpName("identity"), add);
+    graph_ = std::make_unique<Graph>(OpRegistry::Global());
+    TF_CHECK_OK(root.ToGraph(graph_.get()));
+    for (Node* n : graph_->nodes()) {
+      if (n->name() == "add") add_ = n;
+      if (n->name() == "identity") identity_ = n;
+    }
+  }
+
+  // Returns the estimate for `add_` with an output of shape `dims`.
+  ClusterCostEstimate AddWithShape(std::vector<int64_t> dims) const {
+    std::vector<InferredShape> shapes(1);
+    shapes[0].shape = PartialTensorShape(dims);
+    return ClusterCostEstimate::ForNode(*add_, &shapes);
+  }
+
+  // Returns the estimate for a cluster of `n` copies of `node`.
+  static ClusterCostEstimate Repeat(const ClusterCostEstimate& node, int n) {
+    ClusterCostEstimate cluster;
+    for (int i = 0; i < n; ++i) cluster.Merge(node);
+    return cluster;
+  }
+
+  std::unique_ptr<Graph> graph_;
+  Node* add_;
+  Node* identity_;
+};
+
+TEST_F(ClusteringCostModelTest, SingleNodeIsNotProfitable) {
+  ClusterCostEstimate estimate =
+      ClusterCostEstimate::ForNode(*add_, /*output_shapes=*/nullptr);
+  EXPECT_EQ(estimate.num_nodes(), 1);
+  EXPECT_EQ(estimate.num_dynamic_shape_nodes(), 0);
+  EXPECT_FALSE(estimate.IsProfitable());
+}
+
+TEST_F(ClusteringCostModelTest, IdentityDoesNotSave) {
+  ClusterCostEstimate estimate =
+      ClusterCostEstimate::ForNode(*identity_, /*output_shapes=*/nullptr);
+  EXPECT_EQ(estimate.num_nodes(), 1);
+  EXPECT_EQ(estimate.SavingsUsec(), 0);
+}
+
+TEST_F(ClusteringCostModelTest, LargeOutputsSaveMemoryTraffic) {
+  ClusterCostEstimate small = AddWithShape({16});
+  ClusterCostEstimate large = AddWithShape({1024, 1024});
+  EXPECT_GT(large.SavingsUsec(), small.SavingsUsec());
+  EXPECT_FALSE(small.IsProfitable());
+  EXPECT_TRUE(large.IsProfitable());
+}
+
+TEST_F(ClusteringCostModelTest, DynamicShapesRiskRecompilation) {
+  ClusterCostEstimate static_node = AddWithShape({32, 32});
+  ClusterCostEstimate dynamic_node = AddWithShape({-1, 32});
+  EXPECT_EQ(static_node.num_dynamic_shape_nodes(), 0);
+  EXPECT_EQ(dynamic_node.num_dynamic_shape_nodes(), 1);
+  EXPECT_EQ(static_node.RecompilationCostUsec(), 0);
+  EXPECT_GT(dynamic_node.RecompilationCostUsec(), 0);
+}
+
+TEST_F(ClusteringCostModelTest, MergeStaticClusters) {
+  ClusterCostEstimate static_node = AddWithShape({32, 32});
+  EXPECT_TRUE(ShouldMergeClusters(Repeat(static_node, 100), static_node));
+  EXPECT_TRUE(ShouldMergeClusters(static_node, static_node));
+}
+
+TEST_F(ClusteringCostModelTest, DontMergeManyDynamicShapesIntoLargeCluster) {
+  ClusterCostEstimate static_node = AddWithShape({32, 32});
+  ClusterCostEstimate dynamic_node = AddWithShape({-1, 32});
+  // A few dynamic shapes are worth the launch the merge saves, many are not.
+  EXPECT_TRUE(
+      ShouldMergeClusters(Repeat(static_node, 100), Repeat(dynamic_node, 1)));
+  EXPECT_FALSE(
+      ShouldMergeClusters(Repeat(static_node, 100), Repeat(dynamic_node, 20)));
+}
+
+}  // namespace
+}  // namespace tensorflow
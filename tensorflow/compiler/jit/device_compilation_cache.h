@@ -16,12 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_CACHE_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_CACHE_H_
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
@@ -29,6 +32,8 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "xla/client/local_client.h"
 #include "xla/pjrt/pjrt_client.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
@@ -57,18 +62,42 @@ inline int64_t ExecutableSize<xla::PjRtLoadedExecutable>(
 
   return 0;
 }
+
+// Returns the number of bytes held by a cache entry with `compilation_result`
+// and `executable`.
+template <typename ExecutableType>
+int64_t EntrySize(const XlaCompiler::CompilationResult* compilation_result,
+                  const ExecutableType* executable) {
+  int64_t size = ExecutableSize<ExecutableType>(executable);
+  if (compilation_result != nullptr &&
+      compilation_result->computation != nullptr) {
+    size += compilation_result->computation->proto().ByteSizeLong();
+  }
+  return size;
+}
 }  // namespace device_compilation_cache_internal
 
 // Cache to store compiled HLO, executables and related metadata keyed by
 // `DeviceCompilationClusterSignature`. The cache owns the stored
 // CompilationResults and Executables.
-// Currently no cache eviction policy is implemented and the cache grows without
-// bound.
+//
+// By default the cache grows without bound. If `max_size_bytes` is positive,
+// storing an executable evicts the least recently used compiled entries until
+// the executables and computations of the cache take at most
+// `max_size_bytes`. Evicted entries go back to the uncompiled state, so that
+// they are compiled again the next time they are requested. Users of the cache
+// keep the raw pointers it returns while they run the executables, so entries
+// which were looked up less than `min_idle_time_us` ago are never evicted.
 template <typename ExecutableType>
 class DeviceCompilationCache {
  public:
   DeviceCompilationCache() = default;
-  ~DeviceCompilationCache() = default;
+  DeviceCompilationCache(int64_t max_size_bytes, int64_t min_idle_time_us)
+      : max_size_bytes_(max_size_bytes), min_idle_time_us_(min_idle_time_us) {}
+  ~DeviceCompilationCache() {
+    mutex_lock lock(compile_cache_mu_);
+    metrics::UpdateXlaCompilationCacheSize(-size_bytes_);
+  }
 
   using Key = DeviceCompilationClusterSignature;
   struct Value {
@@ -100,6 +129,19 @@ class DeviceCompilationCache {
 
   std::string DebugString() const;
 
+  // Returns the number of bytes held by the executables and computations of
+  // the cache.
+  int64_t size_bytes() const {
+    mutex_lock lock(compile_cache_mu_);
+    return size_bytes_;
+  }
+
+  // Returns the number of entries evicted so far. Users which keep pointers
+  // returned by the cache across lookups must drop them when this changes.
+  int64_t eviction_count() const {
+    return eviction_count_.load(std::memory_order_acquire);
+  }
+
  private:
   // The value associated with a cache entry.
   struct Entry {
@@ -112,6 +154,13 @@ class DeviceCompilationCache {
     // The number of times a compilation with this signature has been requested.
     int64_t request_count TF_GUARDED_BY(mu) = 0;
 
+    // When the entry was last looked up, if the cache is bounded.
+    int64_t last_use_us TF_GUARDED_BY(mu) = 0;
+
+    // The size of `compilation_result` and `executable` accounted in
+    // `size_bytes_`.
+    int64_t size_bytes TF_GUARDED_BY(mu) = 0;
+
     // Did compilation succeed?
     Status compilation_status TF_GUARDED_BY(mu);
 
@@ -147,9 +196,26 @@ class DeviceCompilationCache {
     }
   };
 
+  // Evicts least recently used entries other than `stored` until the cache
+  // is within `max_size_bytes_`, or no entry can be evicted.
+  void EvictIfNeeded(const Entry* stored)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(compile_cache_mu_);
+
+  // Records that `entry` was looked up, for the eviction policy.
+  void MarkUsed(Entry* entry) const TF_EXCLUSIVE_LOCKS_REQUIRED(entry->mu) {
+    if (max_size_bytes_ > 0) {
+      entry->last_use_us = Env::Default()->NowMicros();
+    }
+  }
+
+  const int64_t max_size_bytes_ = 0;
+  const int64_t min_idle_time_us_ = 0;
+
   mutable mutex compile_cache_mu_;
   absl::flat_hash_map<Key, std::unique_ptr<Entry>, Key::Hash> cache_
       TF_GUARDED_BY(compile_cache_mu_);
+  int64_t size_bytes_ TF_GUARDED_BY(compile_cache_mu_) = 0;
+  std::atomic<int64_t> eviction_count_ = 0;
 
   DeviceCompilationCache(const DeviceCompilationCache&) = delete;
   void operator=(const DeviceCompilationCache&) = delete;
@@ -173,6 +239,7 @@ DeviceCompilationCache<ExecutableType>::Lookup(const Key& key) const {
   }
 
   mutex_lock lock(entry->mu);
+  MarkUsed(entry);
   Value value = {/*compile_state=*/entry->compile_state,
                  /*compilation_status=*/entry->compilation_status,
                  /*request_count=*/++entry->request_count,
@@ -195,6 +262,7 @@ DeviceCompilationCache<ExecutableType>::LookupOrCreate(const Key& key) {
   }
 
   mutex_lock lock(entry->mu);
+  MarkUsed(entry);
   Value value = {/*compile_state=*/entry->compile_state,
                  /*compilation_status=*/entry->compilation_status,
                  /*request_count=*/++entry->request_count,
@@ -218,6 +286,7 @@ void DeviceCompilationCache<ExecutableType>::Store(
     entry = it->second.get();
   }
 
+  int64_t delta_bytes = 0;
   {
     mutex_lock lock(entry->mu);
     if (compile_state.has_value()) {
@@ -232,10 +301,66 @@ void DeviceCompilationCache<ExecutableType>::Store(
     if (executable.has_value()) {
       entry->executable = std::move(*executable);
     }
+    const int64_t size_bytes =
+        device_compilation_cache_internal::EntrySize<ExecutableType>(
+            entry->compilation_result.get(), entry->executable.get());
+    delta_bytes = size_bytes - entry->size_bytes;
+    entry->size_bytes = size_bytes;
+    MarkUsed(entry);
   }
 
   VLOG(4) << "Added/updated cache entry: key=" << key.HumanString()
           << ", entry=" << entry->DebugString();
+
+  if (delta_bytes != 0) {
+    metrics::UpdateXlaCompilationCacheSize(delta_bytes);
+    mutex_lock lock(compile_cache_mu_);
+    size_bytes_ += delta_bytes;
+    if (max_size_bytes_ > 0 && size_bytes_ > max_size_bytes_) {
+      EvictIfNeeded(entry);
+    }
+  }
+}
+
+template <typename ExecutableType>
+void DeviceCompilationCache<ExecutableType>::EvictIfNeeded(
+    const Entry* stored) {
+  const int64_t now_us = Env::Default()->NowMicros();
+  std::vector<std::pair<int64_t, Entry*>> candidates;
+  for (const auto& [key, entry] : cache_) {
+    if (entry.get() == stored) continue;
+    mutex_lock lock(entry->mu);
+    if (entry->compile_state == DeviceCompileState::kCompiled &&
+        entry->size_bytes > 0 &&
+        now_us - entry->last_use_us >= min_idle_time_us_) {
+      candidates.emplace_back(entry->last_use_us, entry.get());
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  int64_t evicted_bytes = 0;
+  int64_t evictions = 0;
+  for (const auto& [last_use_us, entry] : candidates) {
+    if (size_bytes_ - evicted_bytes <= max_size_bytes_) break;
+    mutex_lock lock(entry->mu);
+    entry->compile_state = DeviceCompileState::kUncompiled;
+    entry->compilation_status = absl::OkStatus();
+    entry->compilation_result.reset();
+    entry->executable.reset();
+    evicted_bytes += entry->size_bytes;
+    entry->size_bytes = 0;
+    ++evictions;
+  }
+  if (evictions == 0) return;
+
+  VLOG(1) << "Evicted " << evictions << " entries (" << evicted_bytes
+          << " bytes) from the compilation cache, which now holds "
+          << size_bytes_ - evicted_bytes << " bytes";
+  size_bytes_ -= evicted_bytes;
+  metrics::UpdateXlaCompilationCacheSize(-evicted_bytes);
+  metrics::UpdateXlaCompilationCacheEvictionCount(evictions);
+  eviction_count_.fetch_add(evictions, std::memory_order_release);
 }
 
 template <typename ExecutableType>
@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include <gtest/gtest.h>
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
 #include "tsl/protobuf/error_codes.pb.h"
@@ -32,6 +33,17 @@ struct FakeExecutable {
   std::string data;
   explicit FakeExecutable(const std::string& s) : data(s) {}
 };
+}  // namespace
+
+namespace device_compilation_cache_internal {
+template <>
+inline int64_t ExecutableSize<FakeExecutable>(
+    const FakeExecutable* executable) {
+  return executable != nullptr ? executable->data.size() : 0;
+}
+}  // namespace device_compilation_cache_internal
+
+namespace {
 
 using Cache = DeviceCompilationCache<FakeExecutable>;
 using Signature = DeviceCompilationClusterSignature;
@@ -216,5 +228,67 @@ TEST(DeviceCompilationCacheTest, StoreMultipleEntries) {
   EXPECT_EQ(cache_value_2->executable->data, "bar_exe");
 }
 
+void StoreCompiled(Cache* cache, const Signature& key,
+                   const std::string& data) {
+  cache->Store(key, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::make_unique<XlaCompiler::CompilationResult>(),
+               std::make_unique<FakeExecutable>(data));
+  // Entries stored or looked up later must be more recently used.
+  Env::Default()->SleepForMicroseconds(10);
+}
+
+TEST(DeviceCompilationCacheTest, UnboundedByDefault) {
+  auto cache = std::make_unique<Cache>();
+  TF_ASSERT_OK_AND_ASSIGN(auto key1, BuildSampleSignature("foo"));
+  TF_ASSERT_OK_AND_ASSIGN(auto key2, BuildSampleSignature("bar"));
+  StoreCompiled(cache.get(), key1, std::string(1000, 'a'));
+  StoreCompiled(cache.get(), key2, std::string(1000, 'b'));
+
+  EXPECT_EQ(cache->size_bytes(), 2000);
+  EXPECT_EQ(cache->eviction_count(), 0);
+}
+
+TEST(DeviceCompilationCacheTest, EvictsLeastRecentlyUsedEntries) {
+  auto cache = std::make_unique<Cache>(/*max_size_bytes=*/25,
+                                       /*min_idle_time_us=*/0);
+  TF_ASSERT_OK_AND_ASSIGN(auto key1, BuildSampleSignature("foo"));
+  TF_ASSERT_OK_AND_ASSIGN(auto key2, BuildSampleSignature("bar"));
+  TF_ASSERT_OK_AND_ASSIGN(auto key3, BuildSampleSignature("baz"));
+  StoreCompiled(cache.get(), key1, std::string(10, 'a'));
+  StoreCompiled(cache.get(), key2, std::string(10, 'b'));
+  ASSERT_TRUE(cache->Lookup(key1).has_value());
+  Env::Default()->SleepForMicroseconds(10);
+  StoreCompiled(cache.get(), key3, std::string(10, 'c'));
+
+  EXPECT_EQ(cache->size_bytes(), 20);
+  EXPECT_EQ(cache->eviction_count(), 1);
+  auto evicted = cache->Lookup(key2);
+  ASSERT_TRUE(evicted.has_value());
+  EXPECT_EQ(evicted->compile_state, DeviceCompileState::kUncompiled);
+  EXPECT_EQ(evicted->compilation_result, nullptr);
+  EXPECT_EQ(evicted->executable, nullptr);
+  EXPECT_EQ(cache->Lookup(key1)->executable->data, std::string(10, 'a'));
+  EXPECT_EQ(cache->Lookup(key3)->executable->data, std::string(10, 'c'));
+
+  // An evicted entry is compiled again like a new one.
+  StoreCompiled(cache.get(), key2, std::string(10, 'b'));
+  EXPECT_EQ(cache->Lookup(key2)->compile_state, DeviceCompileState::kCompiled);
+  EXPECT_EQ(cache->size_bytes(), 20);
+  EXPECT_EQ(cache->eviction_count(), 2);
+}
+
+TEST(DeviceCompilationCacheTest, DoesNotEvictRecentlyUsedEntries) {
+  auto cache = std::make_unique<Cache>(/*max_size_bytes=*/15,
+                                       /*min_idle_time_us=*/3600 * 1000000LL);
+  TF_ASSERT_OK_AND_ASSIGN(auto key1, BuildSampleSignature("foo"));
+  TF_ASSERT_OK_AND_ASSIGN(auto key2, BuildSampleSignature("bar"));
+  StoreCompiled(cache.get(), key1, std::string(10, 'a'));
+  StoreCompiled(cache.get(), key2, std::string(10, 'b'));
+
+  EXPECT_EQ(cache->size_bytes(), 20);
+  EXPECT_EQ(cache->eviction_count(), 0);
+  EXPECT_EQ(cache->Lookup(key1)->compile_state, DeviceCompileState::kCompiled);
+}
+
 }  // namespace
 }  // namespace tensorflow
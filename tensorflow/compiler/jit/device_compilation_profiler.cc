@@ -21,8 +21,10 @@ limitations under the License.
 #include <utility>
 
 #include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
+#include "tensorflow/compiler/jit/xla_cluster_stats.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/platform/errors.h"
@@ -55,6 +57,7 @@ void RegisterExecutionForCluster(
             << " as megamorphic, compile_count=" << stats->compile_count
             << " execution_count=" << stats->execution_count;
     stats->is_megamorphic = true;
+    XlaClusterStats::Global()->RecordMegamorphic(function.name());
   }
 }
 
@@ -62,9 +65,6 @@ void RegisterExecutionForCluster(
 // signature before  we attempt to compile it.
 constexpr int64_t kDefaultCompilationThreshold = 2;
 
-// Maximum number of ongoing compilations.
-constexpr int64_t kMaxNumOngoingCompilations = kNumAsyncDeviceCompilerThreads;
-
 }  // namespace
 
 DeviceCompilationProfiler::~DeviceCompilationProfiler() {
@@ -100,6 +100,7 @@ Status DeviceCompilationProfiler::RegisterCompilation(
   metrics::UpdateXlaCompilationTime(compile_time_us);
 
   const std::string& function_name = function.name();
+  XlaClusterStats::Global()->RecordCompilation(function_name, compile_time_us);
 
   mutex_lock lock(mu_);
   // Create a stats entry if it doesn't already exist.
@@ -137,7 +138,8 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
   if (compile_mode == DeviceCompileMode::kLazy) {
     compile_threshold = kDefaultCompilationThreshold;
   } else if (compile_mode == DeviceCompileMode::kAsync) {
-    compile_threshold = 0;  // for now, always compile right away.
+    compile_threshold =
+        GetXlaOpsCommonFlags()->tf_xla_async_compilation_threshold;
   }
 
   if (compile_mode == DeviceCompileMode::kStrict) {
@@ -175,13 +177,18 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
   // (since they get the benefit of XLA right away without waiting for warmup)
   // and doesn't hurt much for dynamically shaped TensorFlow graphs (we "pay" at
   // most one cluster-compilation's worth of compile time).
-  if (it->second.execution_count == 1) {
+  // With a threshold for asynchronous compilation, the first executions run in
+  // the fallback path instead, so that only hot clusters are compiled.
+  const bool wait_for_threshold =
+      compile_mode == DeviceCompileMode::kAsync && *compile_threshold > 0;
+  if (it->second.execution_count == 1 && !wait_for_threshold) {
     return true;
   }
 
   if (compile_mode == DeviceCompileMode::kAsync) {
     // Asynchronous compilation is enabled.
-    if (num_ongoing_compilations_ >= kMaxNumOngoingCompilations) {
+    if (num_ongoing_compilations_ >=
+        GetXlaOpsCommonFlags()->tf_xla_max_async_compilations) {
       VLOG(2) << "Not asynchronously compiling cluster " << function.name()
               << " because of too many ongoing compilations.";
       return false;
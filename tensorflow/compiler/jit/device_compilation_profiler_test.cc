@@ -21,6 +21,7 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/tests/device_compiler_test_helper.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -239,5 +240,53 @@ TEST(DeviceCompilationProfilerTest, ShouldCompileClusterLazy) {
                                              kDefaultCompilationThreshold));
 }
 
+TEST(DeviceCompilationProfilerTest, ShouldCompileClusterAsyncThreshold) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  XlaOpsCommonFlags* flags = GetXlaOpsCommonFlags();
+  const int32 old_threshold = flags->tf_xla_async_compilation_threshold;
+  flags->tf_xla_async_compilation_threshold = 3;
+
+  // The first executions take the fallback path until the threshold is
+  // reached.
+  profiler->RegisterExecution(function);
+  EXPECT_FALSE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 1));
+  profiler->RegisterExecution(function);
+  EXPECT_FALSE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 2));
+  profiler->RegisterExecution(function);
+  EXPECT_TRUE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 3));
+
+  flags->tf_xla_async_compilation_threshold = old_threshold;
+}
+
+TEST(DeviceCompilationProfilerTest, ShouldCompileClusterMaxAsyncCompilations) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  XlaOpsCommonFlags* flags = GetXlaOpsCommonFlags();
+  const int32 old_max = flags->tf_xla_max_async_compilations;
+  flags->tf_xla_max_async_compilations = 1;
+
+  profiler->RegisterExecution(function);
+  profiler->RegisterExecution(function);
+  EXPECT_TRUE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
+  profiler->IncrementOngoingAsyncCompilations();
+  EXPECT_FALSE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
+
+  flags->tf_xla_max_async_compilations = old_max;
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <memory>
 #include <numeric>
 #include <optional>
@@ -35,6 +39,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/tf_graph_to_hlo_compiler.h"
+#include "tensorflow/compiler/jit/xla_cluster_stats.h"
 #include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "xla/client/local_client.h"
@@ -116,6 +121,15 @@ class DeviceCompiler : public ResourceBase {
       const XlaCompiler::CompilationResult** out_compilation_result,
       ExecutableType** out_executable);
 
+  // Compiles `function` for `args` unless it is already compiled or being
+  // compiled, without registering an execution of the cluster with
+  // `profiler`. Used to compile clusters before their first execution.
+  Status Warmup(const XlaCompiler::Options& options,
+                const NameAttrList& function,
+                const std::vector<XlaCompiler::Argument>& args,
+                const XlaCompiler::CompileOptions& compile_options,
+                DeviceCompilationProfiler* profiler);
+
   ClientType* client() const { return compiler_client_->client(); }
   const DeviceType& device_type() const { return persistor_->device_type(); }
   DeviceCompilationCache<ExecutableType>* cache() { return cache_.get(); }
@@ -140,6 +154,9 @@ class DeviceCompiler : public ResourceBase {
       const XlaCompiler::CompilationResult** out_compilation_result,
       ExecutableType** out_executable);
 
+  // Returns the mutex which serializes the compilations of `signature`.
+  mutex* GetClusterMutex(const DeviceCompilationClusterSignature& signature);
+
   StatusOr<typename DeviceCompilationCache<ExecutableType>::Value>
   CompileStrict(
       const DeviceCompilationClusterSignature& sig,
@@ -160,15 +177,32 @@ class DeviceCompiler : public ResourceBase {
                              OpKernelContext* ctx,
                              DeviceCompilationProfiler* profiler);
 
+  // Runs the queued asynchronous compilation of the cluster which was executed
+  // most often, so that hot clusters do not wait behind cold ones.
+  void RunHottestPendingCompilation();
+
+  // An asynchronous compilation which waits for a compiler thread.
+  struct PendingCompilation {
+    NameAttrList function;
+    DeviceCompilationProfiler* profiler;
+    std::function<void()> compile;
+  };
+
   std::unique_ptr<DeviceExecutablePersistor<ExecutableType, ClientType>>
       persistor_;
   std::unique_ptr<DeviceCompilerClient<ExecutableType, ClientType>>
       compiler_client_;
   std::unique_ptr<DeviceCompilationCache<ExecutableType>> cache_;
 
-  // Pool of threads for asynchronous compilations.
+  // Pool of threads for asynchronous compilations. Every compilation queued in
+  // `pending_compilations_` schedules one call to
+  // RunHottestPendingCompilation() on it.
   std::unique_ptr<thread::ThreadPool> async_compiler_threads_;
 
+  mutex pending_compilations_mu_;
+  std::vector<PendingCompilation> pending_compilations_
+      TF_GUARDED_BY(pending_compilations_mu_);
+
   mutex cluster_mutexes_mu_;
   absl::flat_hash_map<DeviceCompilationClusterSignature, std::unique_ptr<mutex>,
                       DeviceCompilationClusterSignature::Hash>
@@ -213,10 +247,13 @@ DeviceCompiler<ExecutableType, ClientType>::DeviceCompiler(
         compiler_client)
     : persistor_(std::move(persistor)),
       compiler_client_(std::move(compiler_client)) {
-  cache_ = std::make_unique<DeviceCompilationCache<ExecutableType>>();
+  cache_ = std::make_unique<DeviceCompilationCache<ExecutableType>>(
+      GetXlaOpsCommonFlags()->tf_xla_compilation_cache_max_bytes,
+      int64_t{GetXlaOpsCommonFlags()->tf_xla_compilation_cache_min_idle_secs} *
+          1000000);
   async_compiler_threads_ = std::make_unique<tensorflow::thread::ThreadPool>(
       tensorflow::Env::Default(), "async_compiler_threads",
-      kNumAsyncDeviceCompilerThreads);
+      std::max(1, GetXlaOpsCommonFlags()->tf_xla_async_compilation_threads));
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -277,6 +314,38 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileSingleOpIfNeeded(
                      out_compilation_result, out_executable);
 }
 
+template <typename ExecutableType, typename ClientType>
+Status DeviceCompiler<ExecutableType, ClientType>::Warmup(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    const std::vector<XlaCompiler::Argument>& args,
+    const XlaCompiler::CompileOptions& compile_options,
+    DeviceCompilationProfiler* profiler) {
+  TF_ASSIGN_OR_RETURN(auto signature,
+                      DeviceCompilationClusterSignature::Build(function, args));
+  mutex* cluster_mutex = GetClusterMutex(signature);
+  mutex_lock cluster_compile_lock(*cluster_mutex);
+  auto cache_value = cache_->LookupOrCreate(signature);
+  if (cache_value.compile_state != DeviceCompileState::kUncompiled) {
+    VLOG(2) << "Not warming up already compiled cluster " << function.name();
+    return absl::OkStatus();
+  }
+  VLOG(2) << "Warming up cluster " << function.name();
+  return CompileStrict(signature, compile_options, options, args, function,
+                       cache_value, CompileScope::kFunction, /*ctx=*/nullptr,
+                       profiler, cluster_mutex)
+      .status();
+}
+
+template <typename ExecutableType, typename ClientType>
+mutex* DeviceCompiler<ExecutableType, ClientType>::GetClusterMutex(
+    const DeviceCompilationClusterSignature& signature) {
+  // The outer lock protects the existence of the mutex in the map.
+  mutex_lock lock(cluster_mutexes_mu_);
+  auto it =
+      cluster_mutexes_.emplace(signature, std::make_unique<mutex>()).first;
+  return it->second.get();
+}
+
 template <typename ExecutableType, typename ClientType>
 StatusOr<typename DeviceCompilationCache<ExecutableType>::Value>
 DeviceCompiler<ExecutableType, ClientType>::CompileStrict(
@@ -344,6 +413,7 @@ DeviceCompiler<ExecutableType, ClientType>::CompileStrict(
   const uint64 compile_time_us = compile_end_us - compile_start_us;
 
   device_compiler_internal::LogOnceXlaCompiledFirstCluster();
+  XlaClusterStats::Global()->RecordShapeSignature(function.name(), args);
   TF_RETURN_IF_ERROR(profiler->RegisterCompilation(
       function, compile_time_us, loaded_executable.has_value()));
   return cache_value;
@@ -372,7 +442,7 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
   // All values are captured by value. Make sure that all pointer values (like
   // entry) do not get freed until the lambda has finished.
   const std::string& function_name = function.name();
-  async_compiler_threads_->Schedule([=] {
+  auto compile = [=] {
     VLOG(2) << "Starting asynchronous compilation of cluster " << function_name
             << '.';
     // We don't need to lock mu, but do it anyway to satisfy thread safety
@@ -390,10 +460,43 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
       cache_->Store(signature, std::nullopt, s.status(), std::nullopt,
                     std::nullopt);
     }
-  });
+  };
+  {
+    mutex_lock lock(pending_compilations_mu_);
+    pending_compilations_.push_back({function, profiler, std::move(compile)});
+  }
+  async_compiler_threads_->Schedule([this] { RunHottestPendingCompilation(); });
   return absl::OkStatus();
 }
 
+template <typename ExecutableType, typename ClientType>
+void DeviceCompiler<ExecutableType,
+                    ClientType>::RunHottestPendingCompilation() {
+  PendingCompilation compilation;
+  {
+    mutex_lock lock(pending_compilations_mu_);
+    if (pending_compilations_.empty()) return;
+    auto execution_count = [](const PendingCompilation& pending) -> int64_t {
+      auto stats = pending.profiler->GetCompileStats(pending.function);
+      return stats.ok() ? stats->execution_count : 0;
+    };
+    // Ties go to the compilation which was queued first.
+    auto hottest = pending_compilations_.begin();
+    int64_t hottest_count = execution_count(*hottest);
+    for (auto it = std::next(hottest); it != pending_compilations_.end();
+         ++it) {
+      const int64_t count = execution_count(*it);
+      if (count > hottest_count) {
+        hottest = it;
+        hottest_count = count;
+      }
+    }
+    compilation = std::move(*hottest);
+    pending_compilations_.erase(hottest);
+  }
+  compilation.compile();
+}
+
 template <typename ExecutableType, typename ClientType>
 Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     const XlaCompiler::CompileOptions& compile_options,
@@ -415,14 +518,7 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
   TF_ASSIGN_OR_RETURN(auto signature,
                       DeviceCompilationClusterSignature::Build(function, args));
 
-  // The outer lock protects the existence of the mutex in the map.
-  mutex* cluster_mutex;
-  {
-    mutex_lock lock(cluster_mutexes_mu_);
-    auto it =
-        cluster_mutexes_.emplace(signature, std::make_unique<mutex>()).first;
-    cluster_mutex = it->second.get();
-  }
+  mutex* cluster_mutex = GetClusterMutex(signature);
 
   profiler->RegisterExecution(function);
 
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
 #include "tensorflow/compiler/jit/device_compiler_client.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/tests/device_compiler_test_helper.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "xla/client/client_library.h"
@@ -48,6 +49,7 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 using ::testing::_;
+using ::testing::ElementsAre;
 using ::testing::Return;
 
 using XlaDeviceCompiler =
@@ -318,6 +320,58 @@ TEST_F(DeviceCompilerTest, CompileAsyncSuccess) {
   EXPECT_TRUE(cache_value->compilation_status.ok());
 }
 
+TEST_F(DeviceCompilerTest, CompileAsyncHottestClusterFirst) {
+  XlaOpsCommonFlags* flags = GetXlaOpsCommonFlags();
+  const int32 old_threads = flags->tf_xla_async_compilation_threads;
+  flags->tf_xla_async_compilation_threads = 1;
+  XlaDeviceCompiler* xla_device_compiler = CreateXlaDeviceCompiler();
+  core::ScopedUnref xla_device_compiler_ref(xla_device_compiler);
+  flags->tf_xla_async_compilation_threads = old_threads;
+
+  for (const char* name : {"cold", "hot"}) {
+    TF_ASSERT_OK_AND_ASSIGN(auto fdef, SampleFuntionAddXY(name));
+    TF_ASSERT_OK(flib_def_->AddFunctionDef(fdef));
+  }
+  XlaCompiler::Options options = GetDefaultXlaOptions();
+  options.client = xla_device_compiler->client();
+  NameAttrList foo, cold, hot;
+  foo.set_name("foo");
+  cold.set_name("cold");
+  hot.set_name("hot");
+
+  // "foo" is the hottest cluster, so it takes the only compiler thread first,
+  // and blocks it until the other compilations are queued.
+  for (int i = 0; i < 10; ++i) mock_profiler_->RegisterExecution(foo);
+  Notification queued;
+  Notification all_compiled;
+  std::vector<std::string> compiled;
+  EXPECT_CALL(*mock_profiler_, ShouldCompileCluster(_, _, _))
+      .WillRepeatedly(Return(true));
+  EXPECT_CALL(*mock_profiler_, RegisterCompilation(_, _, false))
+      .Times(3)
+      .WillRepeatedly([&](const NameAttrList& function, int64_t, bool) {
+        if (function.name() == "foo") queued.WaitForNotification();
+        compiled.push_back(function.name());
+        if (compiled.size() == 3) all_compiled.Notify();
+        return absl::OkStatus();
+      });
+
+  for (const NameAttrList* function : {&foo, &cold, &hot}) {
+    const XlaCompiler::CompilationResult* compilation_result = nullptr;
+    xla::LocalExecutable* xla_executable = nullptr;
+    TF_EXPECT_OK(xla_device_compiler->CompileIfNeeded(
+        options, *function, SampleArgsForAddXY(),
+        XlaCompiler::CompileOptions{}, DeviceCompileMode::kAsync,
+        mock_profiler_, &compilation_result, &xla_executable));
+  }
+  for (int i = 0; i < 5; ++i) mock_profiler_->RegisterExecution(hot);
+  queued.Notify();
+  all_compiled.WaitForNotification();
+
+  // "hot" was queued after "cold", but executed more often.
+  EXPECT_THAT(compiled, ElementsAre("foo", "hot", "cold"));
+}
+
 TEST_F(DeviceCompilerTest, CompilePersistentCacheEnabled) {
   auto xla_device_compiler =
       CreateXlaDeviceCompiler(/*enable_persistence=*/true);
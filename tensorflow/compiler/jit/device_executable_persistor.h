@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 
+#include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 
 #include "absl/log/log.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
@@ -31,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tsl/platform/statusor.h"
 
 namespace tensorflow {
@@ -74,6 +77,15 @@ class DeviceExecutablePersistor {
 
     // Cache is read-only if set to true.
     bool persistent_cache_directory_read_only = false;
+
+    // If non-zero, identifies the compiler version and the target device.
+    // It is part of the cache key so that a directory shared by several hosts
+    // (e.g. on a remote file system) only serves executables built for them.
+    uint64 environment_fingerprint = 0;
+
+    // If true, serialized entries are written to the cache directory in the
+    // background instead of blocking the compilation which produced them.
+    bool asynchronous_writes = false;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -94,7 +106,9 @@ class DeviceExecutablePersistor {
 
   // Tries to serialize an already built `executable` and persist it on disk. If
   // unable to do so, tries to build a serialized executable using the AOT
-  // pipeline and persists that to disk.
+  // pipeline and persists that to disk. If `Config::asynchronous_writes` is
+  // set, the entry is written in the background and errors writing it are only
+  // logged.
   // TODO(b/255826209): Take in Signature instead hash and string once cache
   // is refactored.
   virtual Status TryToPersistExecutable(
@@ -157,6 +171,13 @@ class DeviceExecutablePersistor {
   // Cache is read-only if set to true.
   const bool persistent_cache_directory_read_only_;
 
+  const uint64 environment_fingerprint_;
+
+  // Writes serialized entries if `Config::asynchronous_writes` is set. Declared
+  // last so that pending writes finish before the rest of the persistor is
+  // destroyed.
+  std::unique_ptr<thread::ThreadPool> write_thread_pool_;
+
   DeviceExecutablePersistor(const DeviceExecutablePersistor&) = delete;
   void operator=(const DeviceExecutablePersistor&) = delete;
 };
@@ -170,7 +191,14 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
       persistence_prefix_(config.persistence_prefix),
       persistent_cache_directory_(config.persistent_cache_directory),
       persistent_cache_directory_read_only_(
-          config.persistent_cache_directory_read_only) {}
+          config.persistent_cache_directory_read_only),
+      environment_fingerprint_(config.environment_fingerprint) {
+  if (config.asynchronous_writes && !persistent_cache_directory_.empty() &&
+      !persistent_cache_directory_read_only_) {
+    write_thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "xla_persistent_cache_writes", /*num_threads=*/1);
+  }
+}
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
@@ -183,6 +211,10 @@ std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
       key.device_type(),
       key.compiled_using_pjrt()
           ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
+          : "",
+      key.environment_fingerprint() != 0
+          ? absl::StrCat(kXlaSerializedCacheKeySeparator,
+                         key.environment_fingerprint())
           : "");
 }
 
@@ -205,6 +237,7 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
   key.set_device_type(device_type().type_string());
   key.set_prefix(persistence_prefix());
   key.set_compiled_using_pjrt(compiled_using_pjrt);
+  key.set_environment_fingerprint(environment_fingerprint_);
   return key;
 }
 
@@ -400,6 +433,18 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToPersistExecutable(
   TF_ASSIGN_OR_RETURN(XlaSerializedCacheEntry serialized_entry,
                       SerializeEntry(signature_hash, options,
                                      compilation_result, executable, client));
+  if (write_thread_pool_ != nullptr) {
+    // The entry is serialized while the executable is still alive, only
+    // writing it out (which can be slow on remote file systems) is deferred.
+    write_thread_pool_->Schedule(
+        [this, serialized_entry = std::move(serialized_entry)]() {
+          Status status = SaveSerializedEntry(serialized_entry);
+          if (!status.ok()) {
+            LOG(WARNING) << "Failed to persist executable: " << status;
+          }
+        });
+    return absl::OkStatus();
+  }
   TF_RETURN_IF_ERROR(SaveSerializedEntry(std::move(serialized_entry)));
   return absl::OkStatus();
 }
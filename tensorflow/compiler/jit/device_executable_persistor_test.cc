@@ -206,6 +206,10 @@ std::string GetFilePath(XlaSerializedCacheKey key,
       key.compiled_using_pjrt()
           ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
           : "",
+      key.environment_fingerprint() != 0
+          ? absl::StrCat(kXlaSerializedCacheKeySeparator,
+                         key.environment_fingerprint())
+          : "",
       ".pb");
 
   return io::JoinPath(persistent_cache_dir, file_name);
@@ -223,7 +227,7 @@ XlaSerializedCacheKey CreateCacheKey(
     uint64 signature_hash,
     const XlaCompiler::CompilationResult& compilation_result,
     const DeviceType& device_type, const std::string& persistence_prefix,
-    bool compiled_using_pjrt = false) {
+    bool compiled_using_pjrt = false, uint64 environment_fingerprint = 0) {
   XlaSerializedCacheKey key;
   key.set_signature_fingerprint(signature_hash);
   key.set_cluster_fingerprint(
@@ -231,6 +235,7 @@ XlaSerializedCacheKey CreateCacheKey(
   key.set_device_type(device_type.type_string());
   key.set_prefix(persistence_prefix);
   key.set_compiled_using_pjrt(compiled_using_pjrt);
+  key.set_environment_fingerprint(environment_fingerprint);
   return key;
 }
 
@@ -373,6 +378,33 @@ TEST_F(DeviceExecutionPersistorTest, PersistExecutableEmpty) {
       testing::StatusIs(error::FAILED_PRECONDITION));
 }
 
+TEST_F(DeviceExecutionPersistorTest, PersistAsynchronously) {
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir_,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  config.asynchronous_writes = true;
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(
+          Return(absl::StatusOr<std::string>(serialized_xla_executable_)));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  auto key = CreateCacheKey(/*signature_hash=*/789, compilation_result_add_,
+                            DefaultXlaOptions().device_type, "xla");
+  {
+    XlaDeviceExecutablePersistor persistor(config,
+                                           DefaultXlaOptions().device_type);
+    TF_EXPECT_OK(persistor.TryToPersistExecutable(
+        /*signature_hash=*/789, "signature_string", DefaultXlaOptions(),
+        compilation_result_add_, *executable, &mock_client));
+    // Destroying the persistor waits for the pending write.
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(auto entry, ReadCacheEntryFromFile(key, cache_dir_));
+  EXPECT_EQ(entry.executable(), serialized_xla_executable_);
+}
+
 TEST_F(DeviceExecutionPersistorTest, LoadCacheDirNotSet) {
   XlaDeviceExecutablePersistor::Config config(
       /*persistent_cache_directory=*/"",
@@ -631,5 +663,43 @@ TEST_F(DeviceExecutionPersistorTest, PersistPjRtAndXlaExecutables) {
   EXPECT_EQ(entry.executable(), serialized_xla_executable_);
 }
 
+TEST_F(DeviceExecutionPersistorTest, EnvironmentFingerprintMismatch) {
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir_,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  config.environment_fingerprint = 1;
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(
+          Return(absl::StatusOr<std::string>(serialized_xla_executable_)));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_EXPECT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  auto key = CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                            persistor.device_type(),
+                            persistor.persistence_prefix(),
+                            /*compiled_using_pjrt=*/false,
+                            /*environment_fingerprint=*/1);
+  TF_ASSERT_OK_AND_ASSIGN(auto entry, ReadCacheEntryFromFile(key, cache_dir_));
+  EXPECT_EQ(entry.executable(), serialized_xla_executable_);
+
+  // A host with another compiler or device does not load the entry.
+  config.environment_fingerprint = 2;
+  XlaDeviceExecutablePersistor other_persistor(
+      config, DefaultXlaOptions().device_type);
+  EXPECT_FALSE(other_persistor
+                   .TryToLoadExecutable(
+                       /*signature_hash=*/123, "signature_string",
+                       DefaultXlaOptions(), compilation_result_add_,
+                       &mock_client)
+                   .has_value());
+}
+
 }  // namespace
 }  // namespace tensorflow
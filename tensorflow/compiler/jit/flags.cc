@@ -108,6 +108,12 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_max_cluster_size",
            &mark_for_compilation_flags->tf_xla_max_cluster_size,
            "Maximum number of operators in an XLA compilation."),
+      Flag("tf_xla_cost_based_clustering",
+           &mark_for_compilation_flags->tf_xla_cost_based_clustering,
+           "If true, clusters are only formed and kept if a cost model "
+           "estimates that compiling them saves time, taking the launch "
+           "overhead and the risk of recompiling clusters with dynamic shapes "
+           "into account. Replaces tf_xla_min_cluster_size."),
       Flag(
           "tf_xla_ops_to_cluster",
           &mark_for_compilation_flags->tf_xla_ops_to_cluster,
@@ -158,7 +164,9 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_persistent_cache_directory",
            &mark_for_compilation_flags->tf_xla_persistent_cache_directory,
            "If non-empty, JIT-compiled executables are saved to and loaded "
-           "from the specified file system directory path. Empty by default."),
+           "from the specified file system directory path. Any file system "
+           "supported by TensorFlow can be used (e.g. gs:// or s3://), which "
+           "lets replicas share compiled executables. Empty by default."),
       Flag("tf_xla_persistent_cache_device_types",
            &mark_for_compilation_flags->tf_xla_persistent_cache_device_types,
            "If non-empty, the persistent cache will only be used for the "
@@ -167,6 +175,10 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_persistent_cache_read_only",
            &mark_for_compilation_flags->tf_xla_persistent_cache_read_only,
            "If true, the persistent cache will be read-only."),
+      Flag("tf_xla_persistent_cache_async_writes",
+           &mark_for_compilation_flags->tf_xla_persistent_cache_async_writes,
+           "If true, executables are written to the persistent cache in the "
+           "background instead of delaying the first run of the cluster."),
       Flag("tf_xla_disable_strict_signature_checks",
            &mark_for_compilation_flags->tf_xla_disable_strict_signature_checks,
            "If true, entires loaded into the XLA compile cache will not have "
@@ -230,6 +242,7 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_min_cluster_size = 4;
   mark_for_compilation_flags->tf_xla_max_cluster_size =
       std::numeric_limits<int32>::max();
+  mark_for_compilation_flags->tf_xla_cost_based_clustering = false;
   mark_for_compilation_flags->tf_xla_clustering_debug = false;
   mark_for_compilation_flags->tf_xla_cpu_global_jit = false;
   mark_for_compilation_flags->tf_xla_clustering_fuel =
@@ -242,6 +255,7 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_persistent_cache_directory = "";
   mark_for_compilation_flags->tf_xla_persistent_cache_device_types = "";
   mark_for_compilation_flags->tf_xla_persistent_cache_read_only = false;
+  mark_for_compilation_flags->tf_xla_persistent_cache_async_writes = false;
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
@@ -263,6 +277,15 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_async_compilation_threads = 10;
+  ops_flags->tf_xla_max_async_compilations = 10;
+  ops_flags->tf_xla_async_compilation_threshold = 0;
+  ops_flags->tf_xla_batch_dimension_buckets = "";
+  ops_flags->tf_xla_donate_input_buffers = false;
+  ops_flags->tf_xla_compilation_record_file = "";
+  ops_flags->tf_xla_warmup_compilation_file = "";
+  ops_flags->tf_xla_compilation_cache_max_bytes = 0;
+  ops_flags->tf_xla_compilation_cache_min_idle_secs = 60;
   ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_on_demand_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_and_run_ = true;
@@ -334,6 +357,52 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_async_compilation_threads",
+            &ops_flags->tf_xla_async_compilation_threads,
+            "Number of threads which compile clusters asynchronously."),
+       Flag("tf_xla_max_async_compilations",
+            &ops_flags->tf_xla_max_async_compilations,
+            "Maximum number of asynchronous compilations which are queued or "
+            "running. Queued compilations start in the order of how often "
+            "their clusters were executed."),
+       Flag("tf_xla_async_compilation_threshold",
+            &ops_flags->tf_xla_async_compilation_threshold,
+            "Number of times a signature has to be requested before it is "
+            "compiled asynchronously; the earlier executions take the "
+            "fallback path. If 0, clusters are compiled the first time they "
+            "are executed."),
+       Flag("tf_xla_batch_dimension_buckets",
+            &ops_flags->tf_xla_batch_dimension_buckets,
+            "Comma-separated, increasing sizes to which the XlaLaunch op pads "
+            "the leading dimension of the arguments of a cluster, so that it "
+            "is compiled once per size instead of once per batch size. Only "
+            "correct for clusters which process the rows of the batch "
+            "independently."),
+       Flag("tf_xla_donate_input_buffers",
+            &ops_flags->tf_xla_donate_input_buffers,
+            "If true, the outputs of XLA clusters reuse the buffers of "
+            "arguments of the same type and shape which are not referenced "
+            "anywhere else, reducing peak memory."),
+       Flag("tf_xla_compilation_record_file",
+            &ops_flags->tf_xla_compilation_record_file,
+            "If set, the function, device type and argument shapes of every "
+            "cluster compiled by the XlaLaunch and XlaCompile ops are written "
+            "to this file, to compile them ahead of traffic with "
+            "--tf_xla_warmup_compilation_file."),
+       Flag("tf_xla_warmup_compilation_file",
+            &ops_flags->tf_xla_warmup_compilation_file,
+            "If set, the clusters recorded in this file are compiled in the "
+            "background as soon as their XlaLaunch or XlaCompile kernels are "
+            "created, instead of on their first execution."),
+       Flag("tf_xla_compilation_cache_max_bytes",
+            &ops_flags->tf_xla_compilation_cache_max_bytes,
+            "If positive, the XLA compilation cache of every device evicts "
+            "its least recently used executables once they take more than "
+            "this many bytes. Zero means the cache is unbounded."),
+       Flag("tf_xla_compilation_cache_min_idle_secs",
+            &ops_flags->tf_xla_compilation_cache_min_idle_secs,
+            "Executables used less than this many seconds ago are not evicted "
+            "from the XLA compilation cache."),
        Flag("tf_xla_use_device_api_for_xla_launch",
             &ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_,
             "If true, uses Device API (PjRt) for single device compilation and "
@@ -62,6 +62,12 @@ struct MarkForCompilationPassFlags {
   // Maximum number of operators in an XLA compilation.
   int32 tf_xla_max_cluster_size;
 
+  // If true, clusters are only formed and kept if a cost model estimates that
+  // compiling them saves time, taking the launch overhead and the risk of
+  // recompiling clusters with dynamic shapes into account.  Replaces
+  // tf_xla_min_cluster_size.
+  bool tf_xla_cost_based_clustering;
+
   // If non-empty, limit XLA clustering to the following TF operations.
   string tf_xla_ops_to_cluster;
 
@@ -104,6 +110,10 @@ struct MarkForCompilationPassFlags {
 
   bool tf_xla_persistent_cache_read_only;
 
+  // If true, executables are written to the persistent cache in the background
+  // instead of delaying the first execution of the cluster.
+  bool tf_xla_persistent_cache_async_writes;
+
   // If true, entries loaded into the XLA compile cache will not have their
   // signatures checked strictly. This should generally not be disabled except
   // for debugging. Defaults to false.
@@ -151,6 +161,47 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // Number of threads which compile clusters asynchronously. Defaults to 10.
+  int32 tf_xla_async_compilation_threads;
+  // Maximum number of asynchronous compilations which are queued or running.
+  // Queued compilations start in the order of how often their clusters were
+  // executed. Defaults to 10.
+  int32 tf_xla_max_async_compilations;
+  // Number of times a signature has to be requested before it is compiled
+  // asynchronously; the earlier executions take the fallback path. If 0,
+  // clusters are compiled the first time they are executed. Defaults to 0.
+  int32 tf_xla_async_compilation_threshold;
+  // Comma-separated, increasing sizes to which the XlaLaunch op pads the
+  // leading dimension of the arguments of a cluster, so that it compiles the
+  // cluster once per size instead of once per batch size. The padding is
+  // sliced off the outputs, which is only correct for clusters which process
+  // the rows of the batch independently. Defaults to "", no padding.
+  string tf_xla_batch_dimension_buckets;
+
+  // If true, clusters are compiled so that their outputs may reuse the buffers
+  // of arguments of the same type and shape, and the XlaLaunch op donates the
+  // buffers of arguments which are not referenced anywhere else. Arguments
+  // which cannot be donated are copied by the executable instead.
+  bool tf_xla_donate_input_buffers;
+
+  // If set, the signatures of the clusters compiled by this process are written
+  // to this file, e.g. `assets.extra/tf_xla_compilations.pb` of the SavedModel
+  // next to the serving warmup requests.
+  string tf_xla_compilation_record_file;
+
+  // If set, the clusters recorded in this file by
+  // `tf_xla_compilation_record_file` are compiled in the background when their
+  // kernels are created, instead of on their first execution.
+  string tf_xla_warmup_compilation_file;
+
+  // If positive, the compilation cache of every device evicts its least
+  // recently used executables once the executables and computations it holds
+  // take more than this many bytes.
+  int64_t tf_xla_compilation_cache_max_bytes;
+
+  // Executables which were used less than this many seconds ago are not
+  // evicted from the compilation cache, since they may still be running.
+  int32 tf_xla_compilation_cache_min_idle_secs;
 
   class PjRtForSingleDeviceCompilationRollout {
    public:
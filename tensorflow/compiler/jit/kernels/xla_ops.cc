@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/kernels/xla_ops.h"
 
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
@@ -24,6 +25,7 @@ limitations under the License.
 #include <string_view>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
@@ -35,9 +37,12 @@ limitations under the License.
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/pjrt_compile_util.h"
+#include "tensorflow/compiler/jit/shape_bucketing.h"
 #include "tensorflow/compiler/jit/variable_info.h"
 #include "tensorflow/compiler/jit/variable_info_util.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
+#include "tensorflow/compiler/jit/xla_cluster_stats.h"
+#include "tensorflow/compiler/jit/xla_compilation_warmup.h"
 #include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/compiler/jit/xla_compiler_options_util.h"
 #include "tensorflow/compiler/jit/xla_host_recv_device_context.h"
@@ -67,6 +72,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/util/stream_executor_util.h"
+#include "tsl/framework/device_id_utils.h"
 #include "tsl/platform/statusor.h"
 
 // OP_REQUIRES_OK_RETURN is the same as OP_REQUIRES_OK except that
@@ -105,12 +111,14 @@ class ExecutableClosure {
   explicit ExecutableClosure(
       ClientType* client, ExecutableType* executable,
       const XlaCompiler::CompilationResult* compilation_result,
-      ResourceVarsSnapshot resource_var_snapshots, int num_constant_args)
+      ResourceVarsSnapshot resource_var_snapshots, int num_constant_args,
+      std::string cluster_name)
       : client_(client),
         executable_(executable),
         compilation_result_(compilation_result),
         resource_var_snapshots_(std::move(resource_var_snapshots)),
-        num_constant_args_(num_constant_args) {}
+        num_constant_args_(num_constant_args),
+        cluster_name_(std::move(cluster_name)) {}
 
   ExecutableClosure(ExecutableClosure&&) = default;
   ExecutableClosure& operator=(ExecutableClosure&&) = default;
@@ -124,6 +132,7 @@ class ExecutableClosure {
     return resource_var_snapshots_;
   }
   int num_constant_args() const { return num_constant_args_; }
+  const std::string& cluster_name() const { return cluster_name_; }
 
  private:
   ClientType* client_;
@@ -131,6 +140,7 @@ class ExecutableClosure {
   const XlaCompiler::CompilationResult* compilation_result_;
   ResourceVarsSnapshot resource_var_snapshots_;
   int num_constant_args_;
+  std::string cluster_name_;
 
   ExecutableClosure(const ExecutableClosure&) = delete;
   void operator=(const ExecutableClosure&) = delete;
@@ -315,7 +325,8 @@ absl::StatusOr<xla::ExecutionOutput> RunExecutable(
     const XlaComputationLaunchContext& launch_context,
     std::vector<xla::ExecutionInput> execution_inputs,
     xla::ExecutableRunOptions run_options, xla::LocalExecutable* executable,
-    OpKernelContext* ctx, se::DeviceMemoryAllocator* allocator) {
+    OpKernelContext* ctx, se::DeviceMemoryAllocator* allocator,
+    std::string_view cluster_name) {
   VLOG(2) << "Executing Xla Computation.";
   Env* env = Env::Default();
   auto start_time = env->NowMicros();
@@ -339,6 +350,7 @@ absl::StatusOr<xla::ExecutionOutput> RunExecutable(
 
   auto elapsed = env->NowMicros() - start_time;
   VLOG(2) << "Elapsed time for Xla Executable Run: " << elapsed << "us";
+  XlaClusterStats::Global()->RecordExecution(cluster_name, elapsed);
   return execution_output;
 }
 
@@ -366,17 +378,15 @@ GetXlaCompilerArgsAndSnapshotVariables(
   return result;
 }
 
-Status CompileToLocalExecutable(
-    OpKernelContext* ctx, const NameAttrList& function, bool has_ref_vars,
+// Looks up the XLA device compiler and profiler of the device in `rm`, and
+// creates them if they don't exist yet. The caller owns a reference to both.
+Status LookupOrCreateXlaDeviceCompiler(
+    ResourceMgr* rm, DeviceBase* device, FunctionLibraryRuntime* flr,
     const XlaPlatformInfo& platform_info,
-    const std::vector<XlaCompiler::Argument>& args,
-    DeviceCompileMode compile_mode, bool may_alias_resource_update,
-    xla::LocalClient** client,
-    const XlaCompiler::CompilationResult** compilation_result,
-    xla::LocalExecutable** executable) {
+    XlaDeviceCompiler** xla_device_compiler,
+    DeviceCompilationProfiler** profiler) {
   // We store information about the JIT-compiled XLA computation
   // in the ResourceMgr.
-  ResourceMgr* rm = ctx->resource_manager();
   if (!rm) {
     return absl::InternalError("No resource manager.");
   }
@@ -384,21 +394,38 @@ Status CompileToLocalExecutable(
   TF_ASSIGN_OR_RETURN(DeviceType compilation_device_type,
                       GetCompilationDeviceType(platform_info.device_type()));
 
-  XlaDeviceCompiler* xla_device_compiler;
   TF_RETURN_IF_ERROR(rm->LookupOrCreate<XlaDeviceCompiler>(
-      rm->default_container(), "xla_device_compiler", &xla_device_compiler,
+      rm->default_container(), "xla_device_compiler", xla_device_compiler,
       [&](XlaDeviceCompiler** xla_device_compiler) {
-        return BuildXlaDeviceCompiler(ctx->device(), ctx->function_library(),
-                                      platform_info, compilation_device_type,
+        return BuildXlaDeviceCompiler(device, flr, platform_info,
+                                      compilation_device_type,
                                       xla_device_compiler);
       }));
-  DeviceCompilationProfiler* profiler;
-  TF_RETURN_IF_ERROR(rm->LookupOrCreate<DeviceCompilationProfiler>(
-      rm->default_container(), "device_compilation_profiler", &profiler,
+  Status status = rm->LookupOrCreate<DeviceCompilationProfiler>(
+      rm->default_container(), "device_compilation_profiler", profiler,
       [](DeviceCompilationProfiler** profiler) {
         *profiler = new DeviceCompilationProfiler();
         return absl::OkStatus();
-      }));
+      });
+  if (!status.ok()) {
+    (*xla_device_compiler)->Unref();
+  }
+  return status;
+}
+
+Status CompileToLocalExecutable(
+    OpKernelContext* ctx, const NameAttrList& function, bool has_ref_vars,
+    const XlaPlatformInfo& platform_info,
+    const std::vector<XlaCompiler::Argument>& args,
+    DeviceCompileMode compile_mode, bool may_alias_resource_update,
+    xla::LocalClient** client,
+    const XlaCompiler::CompilationResult** compilation_result,
+    xla::LocalExecutable** executable) {
+  XlaDeviceCompiler* xla_device_compiler;
+  DeviceCompilationProfiler* profiler;
+  TF_RETURN_IF_ERROR(LookupOrCreateXlaDeviceCompiler(
+      ctx->resource_manager(), ctx->device(), ctx->function_library(),
+      platform_info, &xla_device_compiler, &profiler));
   // Hold the reference to the XLA device compiler and profiler during
   // evaluation. (We could probably free them sooner because the ResourceMgr
   // will retain references, but this is more obviously correct.)
@@ -414,9 +441,88 @@ Status CompileToLocalExecutable(
   XlaCompiler::CompileOptions compile_options =
       GenerateCompileOptions(has_ref_vars, may_alias_resource_update);
 
-  return xla_device_compiler->CompileIfNeeded(
+  TF_RETURN_IF_ERROR(xla_device_compiler->CompileIfNeeded(
       options, function, args, compile_options, compile_mode, profiler,
-      compilation_result, executable);
+      compilation_result, executable));
+
+  XlaCompilationRecorder* recorder = XlaCompilationRecorder::Global();
+  if (recorder != nullptr && *compilation_result != nullptr) {
+    Status status = recorder->Record(
+        *compilation_result, platform_info.device_type(), function, args);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to record the compilation of "
+                   << function.name() << ": " << status;
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Compiles the compilations of `function` recorded by an earlier process, see
+// --tf_xla_warmup_compilation_file, in the background. Executions of the
+// cluster with a signature which is being warmed up wait for its compilation
+// instead of compiling it again.
+void WarmupRecordedCompilations(OpKernelConstruction* ctx,
+                                const NameAttrList& function,
+                                const XlaPlatformInfo& platform_info,
+                                bool has_ref_vars,
+                                bool may_alias_resource_update) {
+  const XlaWarmupCompilations* warmup_compilations =
+      XlaWarmupCompilations::Global();
+  if (warmup_compilations == nullptr) return;
+  std::vector<XlaRecordedCompilation> compilations =
+      warmup_compilations->Get(platform_info.device_type(), function);
+  if (compilations.empty()) return;
+
+  XlaDeviceCompiler* xla_device_compiler;
+  DeviceCompilationProfiler* profiler;
+  Status status = LookupOrCreateXlaDeviceCompiler(
+      ctx->resource_manager(), ctx->device(), ctx->function_library(),
+      platform_info, &xla_device_compiler, &profiler);
+  if (!status.ok()) {
+    LOG(WARNING) << "Not warming up " << function.name() << ": " << status;
+    return;
+  }
+  core::ScopedUnref xla_device_compiler_ref(xla_device_compiler);
+  core::ScopedUnref profiler_ref(profiler);
+
+  XlaCompiler::Options options = GenerateCompilerOptions(
+      *xla_device_compiler, *ctx->function_library(), ctx->device(),
+      /*stream=*/nullptr, platform_info, has_ref_vars);
+  // There is no stream to take the device ordinal from, so the executables
+  // would be built for the default device of the client.
+  absl::StatusOr<int> platform_device_id =
+      tsl::GetPlatformDeviceIdFromDeviceParsedName(
+          ctx->device()->parsed_name(), platform_info.device_type());
+  if (platform_device_id.ok()) {
+    options.device_ordinal = *platform_device_id;
+  }
+  XlaCompiler::CompileOptions compile_options =
+      GenerateCompileOptions(has_ref_vars, may_alias_resource_update);
+
+  for (const XlaRecordedCompilation& compilation : compilations) {
+    absl::StatusOr<std::vector<XlaCompiler::Argument>> args =
+        RecordedArguments(compilation);
+    if (!args.ok()) {
+      LOG(WARNING) << "Not warming up " << function.name() << ": "
+                   << args.status();
+      continue;
+    }
+    xla_device_compiler->Ref();
+    profiler->Ref();
+    ScheduleWarmupCompilation([xla_device_compiler, profiler, options,
+                               function, args = *std::move(args),
+                               compile_options]() {
+      VLOG(1) << "Warming up " << function.name();
+      Status status = xla_device_compiler->Warmup(options, function, args,
+                                                  compile_options, profiler);
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to warm up " << function.name() << ": "
+                     << status;
+      }
+      xla_device_compiler->Unref();
+      profiler->Unref();
+    });
+  }
 }
 
 Status GetUpdatedVariables(
@@ -480,7 +586,18 @@ XlaLocalLaunchBase::XlaLocalLaunchBase(OpKernelConstruction* ctx,
       resources_(resources),
       function_(function),
       platform_info_(XlaPlatformInfoFromDevice(ctx->device())),
-      has_ref_vars_(has_ref_vars) {}
+      has_ref_vars_(has_ref_vars) {
+  absl::StatusOr<std::vector<int64_t>> buckets = ParseBatchDimensionBuckets(
+      GetXlaOpsCommonFlags()->tf_xla_batch_dimension_buckets);
+  OP_REQUIRES_OK(ctx, buckets.status());
+  batch_dimension_buckets_ = *std::move(buckets);
+  if (!GetXlaOpsCommonFlags()
+           ->tf_xla_use_device_api.IsEnabledInXlaLaunchForDevice(
+               platform_info_.device_type())) {
+    WarmupRecordedCompilations(ctx, function_, platform_info_, has_ref_vars_,
+                               /*may_alias_resource_update=*/true);
+  }
+}
 
 void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
   VLOG(1) << "XlaLocalLaunchOpBase::Compute "
@@ -569,16 +686,60 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
     return;
   }
 
-  Status status = CompileToLocalExecutable(
-      ctx, function_, /*has_ref_vars=*/has_ref_vars_, platform_info_,
-      xla_compiler_args, DeviceCompileMode::kStrict,
-      /*may_alias_resource_update=*/true, &client, &compilation_result,
-      &executable);
-  OP_REQUIRES_OK_ASYNC(ctx, status, done);
+  // Pads the batch dimension of the arguments to the next bucket size, so
+  // that the cluster is not recompiled for every batch size. XLA devices are
+  // not supported because they keep their tensors on multiple streams.
+  std::optional<int64_t> batch_size;
+  std::optional<int64_t> padded_batch_size;
+  if (!batch_dimension_buckets_.empty() && !platform_info_.is_on_xla_device()) {
+    mutex_lock guard(cannot_bucket_batch_dimension_mu_);
+    if (!cannot_bucket_batch_dimension_) {
+      batch_size = GetBatchSize(xla_compiler_args);
+    }
+  }
+  if (batch_size.has_value() && *batch_size > 0) {
+    padded_batch_size =
+        GetBatchDimensionBucket(*batch_size, batch_dimension_buckets_);
+  }
+  if (padded_batch_size.has_value()) {
+    std::vector<XlaCompiler::Argument> padded_args = xla_compiler_args;
+    SetBatchSize(*padded_batch_size, &padded_args);
+    Status status = CompileToLocalExecutable(
+        ctx, function_, /*has_ref_vars=*/has_ref_vars_, platform_info_,
+        padded_args, DeviceCompileMode::kStrict,
+        /*may_alias_resource_update=*/true, &client, &compilation_result,
+        &executable);
+    if (!status.ok() ||
+        !CanSliceBatchDimension(*compilation_result, *padded_batch_size)) {
+      VLOG(1) << "Not padding the batch dimension of " << function_.name()
+              << ": " << status;
+      mutex_lock guard(cannot_bucket_batch_dimension_mu_);
+      cannot_bucket_batch_dimension_ = true;
+      padded_batch_size.reset();
+    }
+  }
+  if (!padded_batch_size.has_value()) {
+    Status status = CompileToLocalExecutable(
+        ctx, function_, /*has_ref_vars=*/has_ref_vars_, platform_info_,
+        xla_compiler_args, DeviceCompileMode::kStrict,
+        /*may_alias_resource_update=*/true, &client, &compilation_result,
+        &executable);
+    OP_REQUIRES_OK_ASYNC(ctx, status, done);
+  }
+  std::vector<int> padded_input_indices;
+  if (padded_batch_size.has_value()) {
+    for (int i = 0; i < xla_compiler_args.size(); ++i) {
+      if (xla_compiler_args[i].kind == XlaCompiler::Argument::kParameter) {
+        padded_input_indices.push_back(i);
+      }
+    }
+  }
 
   // Continuation of the execution, may be run in a different thread.
   auto run_xla_cluster = [ctx, client, executable, compilation_result, done,
-                          inputs, resources = resources_]() {
+                          inputs, resources = resources_, batch_size,
+                          padded_batch_size, padded_input_indices,
+                          cluster_name = function_.name()]() {
     // Separate scope so that VariableInfo locks are released before done is
     // called.
     {
@@ -601,12 +762,33 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
       XlaComputationLaunchContext launch_context =
           GetLaunchContext(platform_info, ctx, client, allocator.get());
 
+      // The padded inputs have to outlive the execution of the cluster.
+      std::vector<Tensor> padded_inputs;
+      padded_inputs.reserve(padded_input_indices.size());
+      std::map<int, const Tensor*> padded_input_ptrs;
+      for (int i : padded_input_indices) {
+        const Tensor& input = ctx->input(i);
+        TensorShape padded_shape = input.shape();
+        padded_shape.set_dim(0, *padded_batch_size);
+        padded_inputs.emplace_back();
+        OP_REQUIRES_OK_ASYNC(ctx,
+                             ctx->allocate_temp(input.dtype(), padded_shape,
+                                                &padded_inputs.back()),
+                             done);
+        OP_REQUIRES_OK_ASYNC(
+            ctx,
+            PadBatchDimension(input, GetStream(ctx), &padded_inputs.back()),
+            done);
+        padded_input_ptrs[i] = &padded_inputs.back();
+      }
+
       const xla::HloInputOutputAliasConfig& input_output_alias =
           executable->executable()->module().input_output_alias_config();
       absl::StatusOr<std::vector<xla::ExecutionInput>> execution_inputs =
           launch_context.PopulateInputs(
               ctx, compilation_result, resource_var_ptrs,
-              /*missing_ctx_input_prefix=*/0, input_output_alias);
+              /*missing_ctx_input_prefix=*/0, input_output_alias,
+              padded_input_ptrs);
       OP_REQUIRES_OK_ASYNC(ctx, execution_inputs.status(), done);
 
       xla::gpu::GpuExecutableRunOptions gpu_options;
@@ -629,7 +811,7 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
 
       absl::StatusOr<xla::ExecutionOutput> execution_output = RunExecutable(
           platform_info, launch_context, std::move(*execution_inputs),
-          run_options, executable, ctx, allocator.get());
+          run_options, executable, ctx, allocator.get(), cluster_name);
       OP_REQUIRES_ASYNC(ctx, execution_output.ok(), execution_output.status(),
                         done);
 
@@ -640,6 +822,16 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
               /*missing_ctx_input_prefix=*/0, absl::MakeSpan(variable_infos),
               input_output_alias, resource_var_ptrs),
           done);
+      if (padded_batch_size.has_value()) {
+        // Slicing the leading dimension keeps the buffers of the outputs.
+        for (int i = 0; i < ctx->num_outputs(); ++i) {
+          Tensor* output = ctx->mutable_output(i);
+          if (output != nullptr && output->dims() > 0 &&
+              output->dim_size(0) == *padded_batch_size) {
+            *output = output->Slice(0, *batch_size);
+          }
+        }
+      }
       VLOG(1) << "Done";
     }
     done();
@@ -731,7 +923,14 @@ XlaCompileOp::XlaCompileOp(OpKernelConstruction* ctx)
       function_(FunctionAttr(ctx)),
       platform_info_(XlaPlatformInfoFromDevice(ctx->device())),
       must_compile_(MustCompileAttr(ctx)),
-      has_ref_vars_(HasRefVars(ctx)) {}
+      has_ref_vars_(HasRefVars(ctx)) {
+  if (!GetXlaOpsCommonFlags()
+           ->tf_xla_use_device_api.IsEnabledInXlaCompileAndRunForDevice(
+               platform_info_.device_type())) {
+    WarmupRecordedCompilations(ctx, function_, platform_info_, has_ref_vars_,
+                               /*may_alias_resource_update=*/false);
+  }
+}
 
 void XlaCompileOp::Compute(OpKernelContext* ctx) {
   VLOG(3) << "XlaCompileOp " << def().name()
@@ -763,9 +962,14 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
           ->tf_xla_use_device_api.IsEnabledInXlaCompileAndRunForDevice(
               platform_info_.device_type());
 
+  // Why the cluster falls back to the TensorFlow function if it is not
+  // compiled.
+  std::string_view fallback_reason = kXlaFallbackNotCompiled;
   if (GetXlaOpsCommonFlags()->tf_xla_always_defer_compilation ||
       cannot_compile_cluster) {
     executable = nullptr;
+    fallback_reason = cannot_compile_cluster ? kXlaFallbackCompilationFailed
+                                             : kXlaFallbackDeferred;
   } else {
     auto args_and_variables_snapshot = GetXlaCompilerArgsAndSnapshotVariables(
         resources_, constants_, inputs, ctx);
@@ -803,6 +1007,7 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
           .IgnoreError();
       executable = nullptr;
       pjrt_executable = nullptr;
+      fallback_reason = kXlaFallbackCompilationFailed;
       mutex_lock guard(cannot_compile_cluster_mu_);
       cannot_compile_cluster_ = true;
     }
@@ -816,6 +1021,12 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   // Async compilation returns nullptr executable without an error.
   if (!executable && !pjrt_executable) {
     DCHECK(!must_compile_);
+    if (fallback_reason == kXlaFallbackNotCompiled &&
+        XlaClusterStats::Global()->IsMegamorphic(function_.name())) {
+      fallback_reason = kXlaFallbackMegamorphic;
+    }
+    XlaClusterStats::Global()->RecordFallback(function_.name(),
+                                              fallback_reason);
     Tensor compilation_key(cpu_allocator, DT_STRING, TensorShape({}));
     Tensor compilation_successful(cpu_allocator, DT_BOOL, TensorShape({}));
     compilation_successful.scalar<bool>()() = false;
@@ -833,14 +1044,14 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
     PjRtExecutableClosureStore::KeyT key =
         PjRtExecutableClosureStore::Global()->Produce(PjRtExecutableClosure(
             pjrt_client, pjrt_executable, kernel, std::move(variables_snapshot),
-            constants_.size()));
+            constants_.size(), function_.name()));
     compilation_key.flat<tstring>()(0) = key;
     VLOG(2) << "Compiled with PJRT. compilation_key: " << key;
   } else {
     XlaExecutableClosureStore::KeyT key =
         XlaExecutableClosureStore::Global()->Produce(XlaExecutableClosure(
             client, executable, kernel, std::move(variables_snapshot),
-            constants_.size()));
+            constants_.size(), function_.name()));
     compilation_key.flat<tstring>()(0) = key;
     VLOG(2) << "Compiled with XLA. compilation_key: " << key;
   }
@@ -950,7 +1161,7 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
 
   absl::StatusOr<xla::ExecutionOutput> execution_output = RunExecutable(
       platform_info_, launch_context, std::move(*execution_inputs), run_options,
-      closure.executable(), ctx, allocator.get());
+      closure.executable(), ctx, allocator.get(), closure.cluster_name());
   OP_REQUIRES(ctx, execution_output.ok(), execution_output.status());
 
   tsl::profiler::TraceMe hlo_module_activity(
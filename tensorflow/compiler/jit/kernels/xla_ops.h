@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_JIT_KERNELS_XLA_OPS_H_
 
 #include <atomic>
+#include <cstdint>
+#include <vector>
 
 #include "tensorflow/compiler/jit/device_compiler.h"
 #include "tensorflow/compiler/jit/xla_device.h"
@@ -28,6 +30,8 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/stream_executor_util.h"
 
 namespace tensorflow {
@@ -66,6 +70,17 @@ class XlaLocalLaunchBase : public AsyncOpKernel {
   const XlaPlatformInfo platform_info_;
 
   bool has_ref_vars_;
+
+  // Sizes to which the batch dimension of the arguments is padded, from
+  // --tf_xla_batch_dimension_buckets.
+  std::vector<int64_t> batch_dimension_buckets_;
+
+  // cannot_bucket_batch_dimension_ is set to true if the padding of the batch
+  // dimension cannot be sliced off the outputs of the cluster, in which case
+  // the cluster is compiled for the exact shapes of its arguments.
+  bool cannot_bucket_batch_dimension_
+      TF_GUARDED_BY(cannot_bucket_batch_dimension_mu_) = false;
+  mutex cannot_bucket_batch_dimension_mu_;
 };
 
 // XlaLocalLaunchOp is used to replace a region of the TensorFlow graph
@@ -34,12 +34,14 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/compiler/jit/clustering_cost_model.h"
 #include "tensorflow/compiler/jit/compilability_check_util.h"
 #include "tensorflow/compiler/jit/deadness_analysis.h"
 #include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/device_util.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/resource_operation_safety_analysis.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/const_analysis.h"
 #include "tensorflow/compiler/tf2xla/resource_operation_table.h"
@@ -112,6 +114,11 @@ class MarkForCompilationPassImpl {
     int max_cluster_size;
     int min_cluster_size;
 
+    // If true, edges are only contracted and clusters only compiled if
+    // ClusterCostEstimate predicts that it saves time.  `min_cluster_size` is
+    // not used then.
+    bool cost_based_clustering;
+
     // Compiler fuel for the auto-clustering algorithm.
     //
     // We decrement this value by one on every time we choose a compilation
@@ -151,7 +158,8 @@ class MarkForCompilationPassImpl {
             std::optional<DeviceId> resource_op_device,
             std::optional<int> resource_var_operation_node_id,
             std::optional<DeadnessPredicate> deadness_predicate,
-            bool is_xla_compile_attr_true, std::optional<string> xla_scope)
+            bool is_xla_compile_attr_true, std::optional<string> xla_scope,
+            ClusterCostEstimate cost_estimate)
         : cycles_graph_node_id_(tf_graph_node_id),
           effective_cluster_size_(effective_cluster_size),
           has_functional_control_flow_(has_functional_control_flow),
@@ -159,7 +167,8 @@ class MarkForCompilationPassImpl {
           resource_op_device_(resource_op_device),
           deadness_predicate_(deadness_predicate),
           is_xla_compile_attr_true_(is_xla_compile_attr_true),
-          xla_scope_(std::move(xla_scope)) {
+          xla_scope_(std::move(xla_scope)),
+          cost_estimate_(cost_estimate) {
       if (resource_var_operation_node_id.has_value()) {
         resource_var_operation_node_ids_.push_back(
             *resource_var_operation_node_id);
@@ -191,6 +200,10 @@ class MarkForCompilationPassImpl {
     // The size of the cluster excluding constant and identity nodes.
     int effective_cluster_size() const { return effective_cluster_size_; }
 
+    // The estimated benefit of compiling the cluster.  Only meaningful if
+    // cost based clustering is enabled.
+    const ClusterCostEstimate& cost_estimate() const { return cost_estimate_; }
+
     // True if the cluster has functional control flow like `If` and `While`.
     bool has_functional_control_flow() const {
       return has_functional_control_flow_;
@@ -255,6 +268,7 @@ class MarkForCompilationPassImpl {
     std::optional<DeadnessPredicate> deadness_predicate_;
     bool is_xla_compile_attr_true_;
     std::optional<string> xla_scope_;
+    ClusterCostEstimate cost_estimate_;
     std::vector<int> resource_var_operation_node_ids_;
 
     Cluster(const Cluster&) = delete;
@@ -365,12 +379,13 @@ class MarkForCompilationPassImpl {
                           std::optional<int> resource_var_operation_node_id,
                           std::optional<DeadnessPredicate> deadness_predicate,
                           bool is_xla_compile_attr_true,
-                          std::optional<string> xla_scope) {
+                          std::optional<string> xla_scope,
+                          ClusterCostEstimate cost_estimate) {
     cluster_storage_.push_back(std::make_unique<Cluster>(
         cycles_graph_node_id, effective_cluster_size,
         has_functional_control_flow, device_set, resource_op_device,
         resource_var_operation_node_id, deadness_predicate,
-        is_xla_compile_attr_true, xla_scope));
+        is_xla_compile_attr_true, xla_scope, cost_estimate));
     return cluster_storage_.back().get();
   }
 
@@ -487,6 +502,9 @@ class MarkForCompilationPassImpl {
   GraphCycles cycles_graph_;
   OrderedNodeSet compilation_candidates_;
   std::unique_ptr<DeadnessAnalysis> deadness_analysis_;
+  // Shapes of the outputs of the nodes, only inferred for cost based
+  // clustering.
+  GraphShapeInfo shape_info_;
   int64_t iteration_count_ = 0;
   absl::flat_hash_set<std::pair<int, int>> unsafe_resource_deps_;
 };
@@ -588,6 +606,7 @@ void MarkForCompilationPassImpl::Cluster::Merge(Cluster* other) {
   cluster_size_ += other->cluster_size_;
   effective_cluster_size_ += other->effective_cluster_size_;
   has_functional_control_flow_ |= other->has_functional_control_flow_;
+  cost_estimate_.Merge(other->cost_estimate_);
 
   devices_.UnionWith(other->devices_);
 
@@ -676,6 +695,19 @@ absl::StatusOr<bool> MarkForCompilationPassImpl::Initialize() {
     TF_RETURN_IF_ERROR(DeadnessAnalysis::Run(*graph_, &deadness_analysis_));
   }
 
+  if (debug_options_.cost_based_clustering) {
+    XLA_SCOPED_LOGGING_TIMER_LEVEL("InferShapes", 1);
+    // Without shapes the cost model assumes tensors of a default size, so a
+    // failure here only makes the estimates less precise.
+    Status status = InferShapes(graph_, /*arg_shapes=*/{}, flib_def_,
+                                &shape_info_);
+    if (!status.ok()) {
+      VLOG(1) << "Shape inference for cost based clustering failed: "
+              << status;
+      shape_info_.clear();
+    }
+  }
+
   // If the user is requesting deterministic cluster names compute a hash of the
   // input graph to provide a stable but unique prefix for the name.
   if (debug_options_.deterministic_cluster_names) {
@@ -989,8 +1021,12 @@ Status MarkForCompilationPassImpl::CreateClusters() {
     // to (recursively) verify this fact, but that's probably not worth the
     // trouble.
 
-    if (cluster->effective_cluster_size() >= debug_options_.min_cluster_size ||
-        cluster->has_functional_control_flow() ||
+    const bool worth_compiling =
+        debug_options_.cost_based_clustering
+            ? cluster->cost_estimate().IsProfitable()
+            : cluster->effective_cluster_size() >=
+                  debug_options_.min_cluster_size;
+    if (worth_compiling || cluster->has_functional_control_flow() ||
         cluster->is_xla_compile_attr_true()) {
       string& name = cluster_names[cluster->cycles_graph_node_id()];
 
@@ -1173,13 +1209,17 @@ Status MarkForCompilationPassImpl::BuildInitialClusterSet() {
     DeviceSet devices;
     devices.Insert(device);
 
+    auto shape_it = shape_info_.find(node->name());
+    const std::vector<InferredShape>* output_shapes =
+        shape_it != shape_info_.end() ? &shape_it->second : nullptr;
+
     Cluster* new_cluster = MakeNewCluster(
         /*cycles_graph_node_id=*/node->id(),
         /*effective_cluster_size=*/effective_cluster_size,
         /*has_functional_control_flow=*/has_functional_control_flow, devices,
         resource_op_device, resource_var_operation_node_id, deadness_predicate,
         /*is_xla_compile_attr_true=*/is_xla_compile_attr_true,
-        GetXlaScope(node));
+        GetXlaScope(node), ClusterCostEstimate::ForNode(*node, output_shapes));
 
     cluster_for_node_[node->id()].Get() = new_cluster;
   }
@@ -1551,6 +1591,14 @@ absl::StatusOr<bool> MarkForCompilationPassImpl::TryToContractEdge(
         from, to, "the new cluster will be larger than the max cluster size");
   }
 
+  if (debug_options_.cost_based_clustering &&
+      !ShouldMergeClusters(from->cost_estimate(), to->cost_estimate())) {
+    return LogNotContractableAndReturnFalse(
+        from, to,
+        "the expected recompilation cost of the new cluster is larger than "
+        "the launch overhead it saves");
+  }
+
   TF_ASSIGN_OR_RETURN(bool will_introduce_cross_device_dependency,
                       ClusteringWillIntroduceInterDeviceDependency(*from, *to));
 
@@ -1922,6 +1970,7 @@ Status MarkForCompilationPass::Run(
       flags->tf_xla_deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.cost_based_clustering = flags->tf_xla_cost_based_clustering;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -1941,6 +1990,7 @@ Status MarkForCompilationPass::RunForTest(
   debug_options.deterministic_cluster_names = deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.cost_based_clustering = flags->tf_xla_cost_based_clustering;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/sendrecv_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/mark_for_compilation_pass_test_helper.h"
 #include "tensorflow/compiler/jit/node_matchers.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
@@ -790,6 +791,41 @@ TEST(XlaCompilationTest, ChainOfOps) {
   ASSERT_EQ(cluster_sets[cluster_names[0]], expected_clustered_nodes_a);
 }
 
+// Builds Relu(Add(a, b)) for placeholders of shape `shape`, with the op names
+// prefixed by `prefix`.
+void BuildAddRelu(const Scope& root, const string& prefix,
+                  const TensorShape& shape) {
+  auto placeholder_attrs = ops::Placeholder::Shape(shape);
+  auto a = ops::Placeholder(root.WithOpName(absl::StrCat(prefix, "_a")),
+                            DT_FLOAT, placeholder_attrs);
+  auto b = ops::Placeholder(root.WithOpName(absl::StrCat(prefix, "_b")),
+                            DT_FLOAT, placeholder_attrs);
+  auto add = ops::Add(root.WithOpName(absl::StrCat(prefix, "_add")), a, b);
+  ops::Relu(root.WithOpName(absl::StrCat(prefix, "_relu")), add);
+}
+
+TEST(XlaCompilationTest, CostBasedClustering) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  BuildAddRelu(root, "small", TensorShape({2}));
+  BuildAddRelu(root, "large", TensorShape({1024, 1024}));
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  TF_ASSERT_OK(root.ToGraph(graph.get()));
+
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  const bool old_cost_based_clustering = flags->tf_xla_cost_based_clustering;
+  flags->tf_xla_cost_based_clustering = true;
+  TF_ASSERT_OK(MarkForCompilationPassTestHelper::MarkForCompilation(&graph));
+  flags->tf_xla_cost_based_clustering = old_cost_based_clustering;
+
+  // Both clusters are smaller than tf_xla_min_cluster_size, but the large one
+  // saves enough memory traffic to be worth its launch overhead.
+  auto clusters = GetClusters(*graph);
+  EXPECT_EQ(clusters.count("small_add"), 0);
+  EXPECT_EQ(clusters.count("small_relu"), 0);
+  ASSERT_EQ(clusters.count("large_add"), 1);
+  EXPECT_EQ(clusters["large_add"], clusters["large_relu"]);
+}
+
 TEST(XlaCompilationTest, IllegalCycle_UsefulErrorMessage) {
   std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
   Scope root = Scope::NewRootScope().ExitOnError();
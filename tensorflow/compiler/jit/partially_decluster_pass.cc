@@ -15,10 +15,18 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/partially_decluster_pass.h"
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/jit/clustering_cost_model.h"
+#include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/device_util.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/const_analysis.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
@@ -400,6 +408,74 @@ Status PartiallyDeclusterGraph(Graph* graph) {
   return absl::OkStatus();
 }
 }  // namespace decluster_root_shape_consumers
+
+namespace decluster_unprofitable_clusters {
+
+// Returns true if `n` has to stay in its cluster regardless of the cost model,
+// because it has no TF kernel, is placed on an XLA device or was explicitly
+// marked for compilation.
+Status MustKeepCluster(const Node* n, bool* must_keep) {
+  bool attr_value = false;
+  if ((TryGetNodeAttr(n->attrs(), kXlaCompileAttr, &attr_value) &&
+       attr_value) ||
+      (TryGetNodeAttr(n->attrs(), kXlaMustCompileAttr, &attr_value) &&
+       attr_value) ||
+      n->IsWhileNode() || n->IsIfNode()) {
+    *must_keep = true;
+    return absl::OkStatus();
+  }
+  return reduce_recompilation::MustCompileNode(n, must_keep);
+}
+
+// Removes the clusters which the other declustering steps shrunk to a point
+// where ClusterCostEstimate no longer predicts a benefit from compiling them.
+// MarkForCompilationPass only formed and marked profitable clusters when cost
+// based clustering is enabled, but nodes since pulled out of a cluster no
+// longer contribute to its savings.
+Status PartiallyDeclusterGraph(Graph* graph,
+                               const FunctionLibraryDefinition* flib_def) {
+  std::map<std::string, std::vector<Node*>> nodes_by_cluster;
+  for (Node* n : graph->nodes()) {
+    std::optional<absl::string_view> cluster = GetXlaClusterForNode(*n);
+    if (cluster.has_value()) {
+      nodes_by_cluster[std::string(*cluster)].push_back(n);
+    }
+  }
+  if (nodes_by_cluster.empty()) {
+    return absl::OkStatus();
+  }
+
+  GraphShapeInfo shape_info;
+  Status status = InferShapes(graph, /*arg_shapes=*/{}, flib_def, &shape_info);
+  if (!status.ok()) {
+    VLOG(1) << "Shape inference for cost based declustering failed: "
+            << status;
+    shape_info.clear();
+  }
+
+  for (const auto& [cluster, nodes] : nodes_by_cluster) {
+    ClusterCostEstimate estimate;
+    bool must_keep = false;
+    for (const Node* n : nodes) {
+      TF_RETURN_IF_ERROR(MustKeepCluster(n, &must_keep));
+      if (must_keep) break;
+      auto it = shape_info.find(n->name());
+      estimate.Merge(ClusterCostEstimate::ForNode(
+          *n, it != shape_info.end() ? &it->second : nullptr));
+    }
+    if (must_keep || estimate.IsProfitable()) {
+      continue;
+    }
+
+    VLOG(2) << "Declustering " << cluster << " because its estimated benefit "
+            << estimate.BenefitUsec() << "us is not positive";
+    for (Node* n : nodes) {
+      RemoveFromXlaCluster(n);
+    }
+  }
+  return absl::OkStatus();
+}
+}  // namespace decluster_unprofitable_clusters
 }  // namespace
 
 Status PartiallyDeclusterPass::Run(
@@ -430,6 +506,11 @@ Status PartiallyDeclusterPass::Run(
   TF_RETURN_IF_ERROR(
       decluster_root_shape_consumers::PartiallyDeclusterGraph(graph));
 
+  if (GetMarkForCompilationPassFlags()->tf_xla_cost_based_clustering) {
+    TF_RETURN_IF_ERROR(decluster_unprofitable_clusters::PartiallyDeclusterGraph(
+        graph, options.flib_def));
+  }
+
   return absl::OkStatus();
 }
 }  // namespace tensorflow
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/sendrecv_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/test_util.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/cc/ops/xla_ops.h"
@@ -557,5 +558,40 @@ TEST(PartiallyDeclusterPassTest,
   EXPECT_EQ(GetXlaClusterForNode(*n_c), "cluster_0");
 }
 
+TEST(PartiallyDeclusterPassTest, CostBasedDeclusterUnprofitableClusters) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  for (const auto& [prefix, shape] :
+       {std::make_pair("small", TensorShape({2})),
+        std::make_pair("large", TensorShape({1024, 1024}))}) {
+    auto a = ops::Placeholder(s.WithOpName(absl::StrCat(prefix, "_a")),
+                              DT_FLOAT, ops::Placeholder::Shape(shape));
+    auto add = ops::Add(s.WithOpName(absl::StrCat(prefix, "_add")), a, a);
+    ops::Relu(s.WithOpName(absl::StrCat(prefix, "_relu")), add);
+  }
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  TF_ASSERT_OK(s.ToGraph(graph.get()));
+  for (const char* name : {"small_add", "small_relu"}) {
+    FindNodeByName(*graph, name)->AddAttr(kXlaClusterAttr, "cluster_0");
+  }
+  for (const char* name : {"large_add", "large_relu"}) {
+    FindNodeByName(*graph, name)->AddAttr(kXlaClusterAttr, "cluster_1");
+  }
+
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  const bool old_cost_based_clustering = flags->tf_xla_cost_based_clustering;
+  flags->tf_xla_cost_based_clustering = true;
+  TF_ASSERT_OK(PartiallyDecluster(&graph));
+  flags->tf_xla_cost_based_clustering = old_cost_based_clustering;
+
+  EXPECT_EQ(GetXlaClusterForNode(*FindNodeByName(*graph, "small_add")),
+            std::nullopt);
+  EXPECT_EQ(GetXlaClusterForNode(*FindNodeByName(*graph, "small_relu")),
+            std::nullopt);
+  EXPECT_EQ(GetXlaClusterForNode(*FindNodeByName(*graph, "large_add")),
+            "cluster_1");
+  EXPECT_EQ(GetXlaClusterForNode(*FindNodeByName(*graph, "large_relu")),
+            "cluster_1");
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -86,6 +86,43 @@ absl::StatusOr<std::unique_ptr<xla::PjRtBuffer>> HostTensorToPjRtBuffer(
     return first_try_buffer.status();
   }
 }
+
+// Returns the PjRtBuffer backing `device_tensor`, which is held by a
+// PjRtTensorBuffer if `use_pjrt_tensor_buffer` is set and by an
+// AsyncValueTensor otherwise. Neither holder copies the device memory.
+absl::StatusOr<xla::PjRtBuffer*> GetPjRtBufferFromTensor(
+    const Tensor* device_tensor, bool use_pjrt_tensor_buffer) {
+  AsyncValueTensor* device_tensor_av =
+      tensorflow::AsyncValueTensor::FromTensor(device_tensor);
+  xla::PjRtBuffer* device_buffer;
+  if (use_pjrt_tensor_buffer) {
+    if (device_tensor_av) {
+      return absl::InvalidArgumentError(
+          "If use_pjrt_tensor_buffer is set, the device tensor should not "
+          "contain an AsyncValueTensor.");
+    }
+    const PjRtTensorBuffer* pjrt_tensor_buffer =
+        dynamic_cast<const PjRtTensorBuffer*>(DMAHelper::buffer(device_tensor));
+    if (pjrt_tensor_buffer == nullptr) {
+      return absl::UnimplementedError(
+          "use_pjrt_tensor_buffer is set to true. Transferring a tensor "
+          "without pjrt_tensor_buffer in this case is not supported.");
+    }
+    device_buffer = pjrt_tensor_buffer->pjrt_buffer();
+  } else {
+    if (device_tensor_av == nullptr) {
+      return absl::InvalidArgumentError(
+          "The device tensor does not contain an AsyncValueTensor.");
+    }
+    device_buffer = device_tensor_av->GetBuffer().get();
+  }
+
+  if (device_buffer == nullptr) {
+    return absl::InvalidArgumentError(
+        "The device tensor has no associated device buffer.");
+  }
+  return device_buffer;
+}
 }  // namespace
 
 void PjRtDeviceContext::CopyDeviceTensorToCPU(const Tensor* device_tensor,
@@ -107,36 +144,16 @@ void PjRtDeviceContext::CopyDeviceTensorToCPU(const Tensor* device_tensor,
     return;
   }
 
-  xla::PjRtBuffer* device_buffer;
-  AsyncValueTensor* device_tensor_av =
-      tensorflow::AsyncValueTensor::FromTensor(device_tensor);
-  if (use_pjrt_tensor_buffer_) {
-    if (device_tensor_av) {
-      done(absl::InvalidArgumentError(
-          "If use_pjrt_tensor_buffer is set, the device tensor should not "
-          "contain an AsyncValueTensor."));
-      return;
-    }
-    const PjRtTensorBuffer* pjrt_tensor_buffer =
-        dynamic_cast<const PjRtTensorBuffer*>(DMAHelper::buffer(device_tensor));
-    if (pjrt_tensor_buffer == nullptr) {
-      done(absl::UnimplementedError(
-          "use_pjrt_tensor_buffer is set to true. Transferring a tensor "
-          "without pjrt_tensor_buffer in this case is not supported."));
-      return;
-    }
-    device_buffer = pjrt_tensor_buffer->pjrt_buffer();
-  } else {
-    device_buffer = device_tensor_av->GetBuffer().get();
-  }
-
-  if (device_buffer == nullptr) {
-    done(absl::InvalidArgumentError(
-        "The device tensor has no associated device buffer."));
+  absl::StatusOr<xla::PjRtBuffer*> device_buffer =
+      GetPjRtBufferFromTensor(device_tensor, use_pjrt_tensor_buffer_);
+  if (!device_buffer.ok()) {
+    done(device_buffer.status());
     return;
   }
 
-  xla::PjRtFuture<> future = device_buffer->ToLiteral(literal.get());
+  // The literal borrows the memory of `cpu_tensor`, so the transfer writes to
+  // it directly.
+  xla::PjRtFuture<> future = (*device_buffer)->ToLiteral(literal.get());
   future.OnReady([literal = std::move(literal), done = std::move(done)](
                      const tensorflow::Status& status) { done(status); });
 }
@@ -255,20 +272,31 @@ void PjRtDeviceToDeviceCopy(DeviceContext* send_dev_context,
     return;
   }
 
-  xla::PjRtBuffer* src_device_buffer =
-      tensorflow::AsyncValueTensor::FromTensor(input)->GetBuffer().get();
+  absl::StatusOr<xla::PjRtBuffer*> src_device_buffer = GetPjRtBufferFromTensor(
+      input, static_cast<PjRtDeviceContext*>(send_dev_context)
+                 ->use_pjrt_tensor_buffer());
+  if (!src_device_buffer.ok()) {
+    done(src_device_buffer.status());
+    return;
+  }
 
   // The device id should match the local_hardware_id in
   // tensorflow/compiler/xla/pjrt/pjrt_client.h.
-  const int pjrt_dst_device_id =
-      tsl::GetDeviceIdFromDeviceParsedName(dst->parsed_name(),
-                                           DeviceType(dst->device_type()))
-          .value();
-  xla::PjRtDevice* pjrt_dst_device =
-      (*pjrt_dst_client)->LookupAddressableDevice(pjrt_dst_device_id).value();
+  absl::StatusOr<int> pjrt_dst_device_id = tsl::GetDeviceIdFromDeviceParsedName(
+      dst->parsed_name(), DeviceType(dst->device_type()));
+  if (!pjrt_dst_device_id.ok()) {
+    done(pjrt_dst_device_id.status());
+    return;
+  }
+  absl::StatusOr<xla::PjRtDevice*> pjrt_dst_device =
+      (*pjrt_dst_client)->LookupAddressableDevice(*pjrt_dst_device_id);
+  if (!pjrt_dst_device.ok()) {
+    done(pjrt_dst_device.status());
+    return;
+  }
 
   absl::StatusOr<std::unique_ptr<xla::PjRtBuffer>> buffer_or =
-      src_device_buffer->CopyToDevice(pjrt_dst_device);
+      (*src_device_buffer)->CopyToDevice(*pjrt_dst_device);
   if (!buffer_or.ok()) {
     done(buffer_or.status());
     return;
@@ -0,0 +1,174 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/pjrt_device_context.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "tensorflow/compiler/tf2xla/layout_util.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/shape_util.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/device_factory.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/tfrt/common/async_value_tensor.h"
+#include "tensorflow/core/tfrt/common/pjrt_util.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace {
+
+using ::testing::HasSubstr;
+
+// Copies float tensors of shape [2] between two CPU devices, both backed by
+// the same PjRt CPU client.
+class PjRtDeviceContextTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    xla::CpuClientOptions options;
+    options.cpu_device_count = 2;
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<xla::PjRtClient> client,
+                            xla::GetTfrtCpuClient(options));
+    client_ = client.get();
+    TF_ASSERT_OK(
+        SetPjRtClientInTFGlobalResourceManager(DEVICE_CPU, std::move(client)));
+
+    SessionOptions session_options;
+    (*session_options.config.mutable_device_count())["CPU"] = 2;
+    TF_ASSERT_OK(DeviceFactory::AddCpuDevices(
+        session_options, "/job:localhost/replica:0/task:0", &devices_));
+    ASSERT_EQ(devices_.size(), 2);
+  }
+
+  // Returns a device tensor on the first device whose buffer carries `error`,
+  // as if the transfer that defines it had failed.
+  Tensor ErrorTensor(const absl::Status& error) {
+    Tensor tensor(&allocator_, DT_FLOAT, TensorShape({2}));
+    xla::PjRtDevice* device = client_->addressable_devices()[0];
+    absl::StatusOr<std::unique_ptr<xla::PjRtBuffer>> buffer =
+        client_->CreateErrorBuffer(error,
+                                   xla::ShapeUtil::MakeShape(xla::F32, {2}),
+                                   *device->default_memory_space());
+    TF_CHECK_OK(buffer.status());
+    AsyncValueTensor::FromTensor(&tensor)->SetBuffer(std::move(*buffer));
+    return tensor;
+  }
+
+  // Returns the status `copy` calls its `done` callback with.
+  template <typename Copy>
+  static Status DoneStatus(Copy copy) {
+    Notification done;
+    Status status;
+    copy([&](const Status& s) {
+      status = s;
+      done.Notify();
+    });
+    done.WaitForNotification();
+    return status;
+  }
+
+  static core::RefCountPtr<PjRtDeviceContext> NewContext(
+      bool use_pjrt_tensor_buffer = false) {
+    return core::RefCountPtr<PjRtDeviceContext>(new PjRtDeviceContext(
+        XlaShapeLayoutHelpers::ShapeDeterminationFns(),
+        use_pjrt_tensor_buffer));
+  }
+
+  xla::PjRtClient* client_;
+  std::vector<std::unique_ptr<Device>> devices_;
+  AsyncValueAllocator allocator_;
+};
+
+TEST_F(PjRtDeviceContextTest, CopyToCPUReturnsTransferFailure) {
+  Tensor device_tensor = ErrorTensor(absl::InternalError("injected failure"));
+  Tensor cpu_tensor(DT_FLOAT, TensorShape({2}));
+  core::RefCountPtr<PjRtDeviceContext> context = NewContext();
+
+  Status status = DoneStatus([&](StatusCallback done) {
+    context->CopyDeviceTensorToCPU(&device_tensor, "", devices_[0].get(),
+                                   &cpu_tensor, std::move(done));
+  });
+  EXPECT_TRUE(absl::IsInternal(status)) << status;
+  EXPECT_THAT(status.message(), HasSubstr("injected failure"));
+}
+
+TEST_F(PjRtDeviceContextTest, CopyToCPUReturnsMissingBuffer) {
+  Tensor device_tensor(DT_FLOAT, TensorShape({2}));
+  Tensor cpu_tensor(DT_FLOAT, TensorShape({2}));
+  for (bool use_pjrt_tensor_buffer : {false, true}) {
+    core::RefCountPtr<PjRtDeviceContext> context =
+        NewContext(use_pjrt_tensor_buffer);
+    Status status = DoneStatus([&](StatusCallback done) {
+      context->CopyDeviceTensorToCPU(&device_tensor, "", devices_[0].get(),
+                                     &cpu_tensor, std::move(done));
+    });
+    if (use_pjrt_tensor_buffer) {
+      EXPECT_TRUE(absl::IsUnimplemented(status)) << status;
+    } else {
+      EXPECT_TRUE(absl::IsInvalidArgument(status)) << status;
+    }
+  }
+}
+
+TEST_F(PjRtDeviceContextTest, DeviceToDeviceCopyReturnsTransferFailure) {
+  Tensor input = ErrorTensor(absl::InternalError("injected failure"));
+  Tensor output(&allocator_, DT_FLOAT, TensorShape({2}));
+  core::RefCountPtr<PjRtDeviceContext> send_context = NewContext();
+  core::RefCountPtr<PjRtDeviceContext> recv_context = NewContext();
+
+  Status status = DoneStatus([&](StatusCallback done) {
+    PjRtDeviceToDeviceCopy(send_context.get(), recv_context.get(),
+                           devices_[0].get(), devices_[1].get(),
+                           AllocatorAttributes(), AllocatorAttributes(),
+                           &input, &output, /*dev_to_dev_stream_index=*/0,
+                           std::move(done));
+  });
+  EXPECT_TRUE(absl::IsInternal(status)) << status;
+  EXPECT_THAT(status.message(), HasSubstr("injected failure"));
+}
+
+TEST_F(PjRtDeviceContextTest, DeviceToDeviceCopyReturnsMissingBuffer) {
+  Tensor input(DT_FLOAT, TensorShape({2}));
+  Tensor output(&allocator_, DT_FLOAT, TensorShape({2}));
+  core::RefCountPtr<PjRtDeviceContext> send_context = NewContext();
+  core::RefCountPtr<PjRtDeviceContext> recv_context = NewContext();
+
+  Status status = DoneStatus([&](StatusCallback done) {
+    PjRtDeviceToDeviceCopy(send_context.get(), recv_context.get(),
+                           devices_[0].get(), devices_[1].get(),
+                           AllocatorAttributes(), AllocatorAttributes(),
+                           &input, &output, /*dev_to_dev_stream_index=*/0,
+                           std::move(done));
+  });
+  EXPECT_TRUE(absl::IsInvalidArgument(status)) << status;
+  EXPECT_EQ(AsyncValueTensor::FromTensor(&output)->GetBuffer(), nullptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
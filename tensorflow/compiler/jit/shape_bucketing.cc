@@ -0,0 +1,137 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "absl/types/variant.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/stream.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+absl::StatusOr<std::vector<int64_t>> ParseBatchDimensionBuckets(
+    absl::string_view buckets) {
+  std::vector<int64_t> sizes;
+  for (absl::string_view bucket :
+       absl::StrSplit(buckets, ',', absl::SkipWhitespace())) {
+    int64_t size;
+    if (!absl::SimpleAtoi(bucket, &size) || size <= 0) {
+      return errors::InvalidArgument("Invalid batch dimension bucket '",
+                                     bucket, "' in '", buckets, "'");
+    }
+    if (!sizes.empty() && size <= sizes.back()) {
+      return errors::InvalidArgument(
+          "Batch dimension buckets must be strictly increasing, but are '",
+          buckets, "'");
+    }
+    sizes.push_back(size);
+  }
+  return sizes;
+}
+
+std::optional<int64_t> GetBatchSize(
+    absl::Span<const XlaCompiler::Argument> args) {
+  std::optional<int64_t> batch_size;
+  for (const XlaCompiler::Argument& arg : args) {
+    if (arg.kind != XlaCompiler::Argument::kParameter) continue;
+    const TensorShape* shape = absl::get_if<TensorShape>(&arg.shape);
+    if (shape == nullptr || shape->dims() == 0) return std::nullopt;
+    if (batch_size.has_value() && *batch_size != shape->dim_size(0)) {
+      return std::nullopt;
+    }
+    batch_size = shape->dim_size(0);
+  }
+  return batch_size;
+}
+
+std::optional<int64_t> GetBatchDimensionBucket(
+    int64_t batch_size, absl::Span<const int64_t> buckets) {
+  for (int64_t bucket : buckets) {
+    if (bucket == batch_size) return std::nullopt;
+    if (bucket > batch_size) return bucket;
+  }
+  return std::nullopt;
+}
+
+void SetBatchSize(int64_t batch_size,
+                  std::vector<XlaCompiler::Argument>* args) {
+  for (XlaCompiler::Argument& arg : *args) {
+    if (arg.kind != XlaCompiler::Argument::kParameter) continue;
+    absl::get<TensorShape>(arg.shape).set_dim(0, batch_size);
+  }
+}
+
+bool CanSliceBatchDimension(
+    const XlaCompiler::CompilationResult& compilation_result,
+    int64_t padded_batch_size) {
+  for (const XlaCompiler::ResourceUpdate& update :
+       compilation_result.resource_updates) {
+    if (update.modified) return false;
+  }
+  for (const XlaCompiler::OutputDescription& output :
+       compilation_result.outputs) {
+    if (output.is_constant || output.is_tensor_list ||
+        output.type == DT_RESOURCE || output.shape.dims() == 0 ||
+        output.shape.dim_size(0) != padded_batch_size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Status PadBatchDimension(const Tensor& input, se::Stream* stream,
+                         Tensor* padded) {
+  const int64_t input_bytes = input.tensor_data().size();
+  const int64_t padded_bytes = padded->tensor_data().size();
+  if (input.dtype() != padded->dtype() || input_bytes > padded_bytes) {
+    return errors::InvalidArgument("Cannot pad a tensor of shape ",
+                                   input.shape().DebugString(), " to ",
+                                   padded->shape().DebugString());
+  }
+  char* padded_data = const_cast<char*>(padded->tensor_data().data());
+  if (stream == nullptr) {
+    std::memcpy(padded_data, input.tensor_data().data(), input_bytes);
+    std::memset(padded_data + input_bytes, 0, padded_bytes - input_bytes);
+    return absl::OkStatus();
+  }
+  se::DeviceMemoryBase source(const_cast<char*>(input.tensor_data().data()),
+                              input_bytes);
+  se::DeviceMemoryBase rows(padded_data, input_bytes);
+  se::DeviceMemoryBase padding(padded_data + input_bytes,
+                               padded_bytes - input_bytes);
+  if (input_bytes > 0) {
+    TF_RETURN_IF_ERROR(stream->MemcpyD2D(&rows, source, input_bytes));
+  }
+  if (padded_bytes > input_bytes) {
+    TF_RETURN_IF_ERROR(stream->MemZero(&padding, padded_bytes - input_bytes));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,75 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+#define TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "xla/stream_executor/stream.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+// Helpers to round the leading (batch) dimension of the arguments of a
+// cluster up to one of a few bucket sizes, so that a cluster which sees many
+// batch sizes is compiled once per bucket instead of once per batch size.
+//
+// Like the `allowed_batch_sizes` of BatchFunction, this pads the arguments
+// with zeros and slices the padding off the outputs, so it is only correct for
+// clusters in which the rows of the batch do not interact, e.g. which do not
+// reduce over the batch dimension.
+
+// Parses a comma-separated list of strictly increasing positive bucket sizes.
+absl::StatusOr<std::vector<int64_t>> ParseBatchDimensionBuckets(
+    absl::string_view buckets);
+
+// Returns the batch size of `args`: the leading dimension which all the
+// parameters have in common. Returns std::nullopt if there are no parameters,
+// if any of them is a scalar, or if their leading dimensions differ.
+std::optional<int64_t> GetBatchSize(
+    absl::Span<const XlaCompiler::Argument> args);
+
+// Returns the smallest of `buckets` to which `batch_size` has to be padded, or
+// std::nullopt if it is already a bucket size or larger than all of them.
+std::optional<int64_t> GetBatchDimensionBucket(
+    int64_t batch_size, absl::Span<const int64_t> buckets);
+
+// Sets the leading dimension of all the parameters in `args` to `batch_size`.
+void SetBatchSize(int64_t batch_size, std::vector<XlaCompiler::Argument>* args);
+
+// Returns true if the padding can be sliced off all the outputs of a cluster
+// compiled for `padded_batch_size`: every output is a tensor with that leading
+// dimension and no resource variable is updated.
+bool CanSliceBatchDimension(
+    const XlaCompiler::CompilationResult& compilation_result,
+    int64_t padded_batch_size);
+
+// Copies `input` into the leading rows of `padded`, which has the same type and
+// a larger leading dimension, and zeroes the remaining rows. The copy is made
+// on `stream` if the tensors are in device memory, or on the host if `stream`
+// is nullptr.
+Status PadBatchDimension(const Tensor& input, se::Stream* stream,
+                         Tensor* padded);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
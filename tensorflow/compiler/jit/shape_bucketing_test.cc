@@ -0,0 +1,132 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/types/variant.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+XlaCompiler::Argument Parameter(const TensorShape& shape) {
+  XlaCompiler::Argument arg;
+  arg.kind = XlaCompiler::Argument::kParameter;
+  arg.type = DT_FLOAT;
+  arg.shape = shape;
+  return arg;
+}
+
+XlaCompiler::Argument Constant(const Tensor& value) {
+  XlaCompiler::Argument arg;
+  arg.kind = XlaCompiler::Argument::kConstant;
+  arg.type = value.dtype();
+  arg.shape = value.shape();
+  arg.constant_value = value;
+  return arg;
+}
+
+XlaCompiler::OutputDescription Output(const TensorShape& shape) {
+  XlaCompiler::OutputDescription output;
+  output.type = DT_FLOAT;
+  output.shape = shape;
+  return output;
+}
+
+TEST(ShapeBucketingTest, ParseBuckets) {
+  auto buckets = ParseBatchDimensionBuckets("8, 32,128");
+  TF_ASSERT_OK(buckets.status());
+  EXPECT_EQ(*buckets, std::vector<int64_t>({8, 32, 128}));
+
+  buckets = ParseBatchDimensionBuckets("");
+  TF_ASSERT_OK(buckets.status());
+  EXPECT_TRUE(buckets->empty());
+
+  EXPECT_FALSE(ParseBatchDimensionBuckets("8,x").ok());
+  EXPECT_FALSE(ParseBatchDimensionBuckets("0,8").ok());
+  EXPECT_FALSE(ParseBatchDimensionBuckets("32,8").ok());
+}
+
+TEST(ShapeBucketingTest, BatchSizeOfParameters) {
+  // Constants are not padded, so their shapes do not matter.
+  std::vector<XlaCompiler::Argument> args = {
+      Parameter(TensorShape({5, 3})), Constant(test::AsScalar<int32>(1)),
+      Parameter(TensorShape({5}))};
+  EXPECT_EQ(GetBatchSize(args), 5);
+
+  args.push_back(Parameter(TensorShape({4, 3})));
+  EXPECT_EQ(GetBatchSize(args), std::nullopt);
+  EXPECT_EQ(GetBatchSize({Parameter(TensorShape({}))}), std::nullopt);
+  EXPECT_EQ(GetBatchSize({Constant(test::AsScalar<int32>(1))}),
+            std::nullopt);
+}
+
+TEST(ShapeBucketingTest, SmallestBucket) {
+  const std::vector<int64_t> buckets = {8, 32, 128};
+  EXPECT_EQ(GetBatchDimensionBucket(1, buckets), 8);
+  EXPECT_EQ(GetBatchDimensionBucket(9, buckets), 32);
+  EXPECT_EQ(GetBatchDimensionBucket(100, buckets), 128);
+  // Batch sizes which are bucket sizes or too large are not padded.
+  EXPECT_EQ(GetBatchDimensionBucket(32, buckets), std::nullopt);
+  EXPECT_EQ(GetBatchDimensionBucket(129, buckets), std::nullopt);
+}
+
+TEST(ShapeBucketingTest, SetBatchSize) {
+  std::vector<XlaCompiler::Argument> args = {
+      Parameter(TensorShape({5, 3})), Constant(test::AsTensor<int32>({1, 2}))};
+  SetBatchSize(8, &args);
+  EXPECT_EQ(absl::get<TensorShape>(args[0].shape), TensorShape({8, 3}));
+  EXPECT_EQ(absl::get<TensorShape>(args[1].shape), TensorShape({2}));
+}
+
+TEST(ShapeBucketingTest, SliceOnlyBatchMajorOutputs) {
+  XlaCompiler::CompilationResult result;
+  result.outputs = {Output(TensorShape({8, 3})), Output(TensorShape({8}))};
+  EXPECT_TRUE(CanSliceBatchDimension(result, 8));
+
+  // A reduction over the batch dimension.
+  result.outputs.push_back(Output(TensorShape({3})));
+  EXPECT_FALSE(CanSliceBatchDimension(result, 8));
+
+  result.outputs.pop_back();
+  XlaCompiler::ResourceUpdate update;
+  update.input_index = 0;
+  update.modified = true;
+  result.resource_updates.push_back(update);
+  EXPECT_FALSE(CanSliceBatchDimension(result, 8));
+}
+
+TEST(ShapeBucketingTest, PadOnHost) {
+  Tensor input = test::AsTensor<float>({1, 2, 3, 4}, TensorShape({2, 2}));
+  Tensor padded(DT_FLOAT, TensorShape({4, 2}));
+  TF_ASSERT_OK(PadBatchDimension(input, /*stream=*/nullptr, &padded));
+  test::ExpectTensorEqual<float>(
+      padded,
+      test::AsTensor<float>({1, 2, 3, 4, 0, 0, 0, 0}, TensorShape({4, 2})));
+
+  Tensor smaller(DT_FLOAT, TensorShape({1, 2}));
+  EXPECT_FALSE(PadBatchDimension(input, /*stream=*/nullptr, &smaller).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,168 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_cluster_stats.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace {
+
+auto* cluster_compile_count = monitoring::Counter<1>::New(
+    "/tensorflow/core/xla_cluster_compile_count",
+    "The number of times an XLA cluster was compiled.", "cluster");
+
+auto* cluster_compile_time_usecs = monitoring::Counter<1>::New(
+    "/tensorflow/core/xla_cluster_compile_time_usecs",
+    "The time spent compiling an XLA cluster.", "cluster");
+
+auto* cluster_execution_count = monitoring::Counter<1>::New(
+    "/tensorflow/core/xla_cluster_execution_count",
+    "The number of times the executable of an XLA cluster was run.",
+    "cluster");
+
+auto* cluster_execution_time_usecs = monitoring::Counter<1>::New(
+    "/tensorflow/core/xla_cluster_execution_time_usecs",
+    "The time spent running the executable of an XLA cluster.", "cluster");
+
+auto* cluster_megamorphic = monitoring::Gauge<bool, 1>::New(
+    "/tensorflow/core/xla_cluster_megamorphic",
+    "Whether an XLA cluster is no longer compiled because its shapes change "
+    "too often.",
+    "cluster");
+
+auto* cluster_fallback_count = monitoring::Counter<2>::New(
+    "/tensorflow/core/xla_cluster_fallback_count",
+    "The number of executions of an XLA cluster which fell back to the "
+    "TensorFlow function.",
+    "cluster", "reason");
+
+}  // namespace
+
+XlaClusterStats* XlaClusterStats::Global() {
+  static XlaClusterStats* stats = new XlaClusterStats();
+  return stats;
+}
+
+XlaClusterStats::Cluster& XlaClusterStats::GetOrCreateCluster(
+    absl::string_view cluster) {
+  auto it = clusters_.find(cluster);
+  if (it == clusters_.end()) {
+    it = clusters_.emplace(std::string(cluster), Cluster{}).first;
+  }
+  return it->second;
+}
+
+void XlaClusterStats::RecordCompilation(absl::string_view cluster,
+                                        int64_t compile_time_us) {
+  cluster_compile_count->GetCell(std::string(cluster))->IncrementBy(1);
+  cluster_compile_time_usecs->GetCell(std::string(cluster))
+      ->IncrementBy(compile_time_us);
+  mutex_lock lock(mu_);
+  Cluster& stats = GetOrCreateCluster(cluster);
+  ++stats.compile_count;
+  stats.cumulative_compile_time_us += compile_time_us;
+}
+
+void XlaClusterStats::RecordShapeSignature(
+    absl::string_view cluster, absl::Span<const XlaCompiler::Argument> args) {
+  std::string signature = ShapeSignature(args);
+  mutex_lock lock(mu_);
+  Cluster& stats = GetOrCreateCluster(cluster);
+  if (stats.shape_signatures.size() < kMaxShapeSignatures &&
+      std::find(stats.shape_signatures.begin(), stats.shape_signatures.end(),
+                signature) == stats.shape_signatures.end()) {
+    stats.shape_signatures.push_back(std::move(signature));
+  }
+}
+
+void XlaClusterStats::RecordExecution(absl::string_view cluster,
+                                      int64_t execution_time_us) {
+  cluster_execution_count->GetCell(std::string(cluster))->IncrementBy(1);
+  cluster_execution_time_usecs->GetCell(std::string(cluster))
+      ->IncrementBy(execution_time_us);
+  mutex_lock lock(mu_);
+  Cluster& stats = GetOrCreateCluster(cluster);
+  ++stats.execution_count;
+  stats.cumulative_execution_time_us += execution_time_us;
+}
+
+void XlaClusterStats::RecordMegamorphic(absl::string_view cluster) {
+  cluster_megamorphic->GetCell(std::string(cluster))->Set(true);
+  mutex_lock lock(mu_);
+  GetOrCreateCluster(cluster).is_megamorphic = true;
+}
+
+void XlaClusterStats::RecordFallback(absl::string_view cluster,
+                                     absl::string_view reason) {
+  cluster_fallback_count->GetCell(std::string(cluster), std::string(reason))
+      ->IncrementBy(1);
+  mutex_lock lock(mu_);
+  ++GetOrCreateCluster(cluster).fallback_counts[std::string(reason)];
+}
+
+bool XlaClusterStats::IsMegamorphic(absl::string_view cluster) const {
+  mutex_lock lock(mu_);
+  auto it = clusters_.find(cluster);
+  return it != clusters_.end() && it->second.is_megamorphic;
+}
+
+std::map<std::string, XlaClusterStats::Cluster> XlaClusterStats::Snapshot()
+    const {
+  mutex_lock lock(mu_);
+  return std::map<std::string, Cluster>(clusters_.begin(), clusters_.end());
+}
+
+std::string XlaClusterStats::DebugString() const {
+  std::string debug_string = "XlaClusterStats {\n";
+  for (const auto& [name, stats] : Snapshot()) {
+    absl::StrAppend(
+        &debug_string, name, ": {compile_count=", stats.compile_count,
+        ", cumulative_compile_time_us=", stats.cumulative_compile_time_us,
+        ", execution_count=", stats.execution_count,
+        ", cumulative_execution_time_us=", stats.cumulative_execution_time_us,
+        ", is_megamorphic=", stats.is_megamorphic, ", shape_signatures=[",
+        absl::StrJoin(stats.shape_signatures, "; "), "], fallback_counts={",
+        absl::StrJoin(stats.fallback_counts, ", ",
+                      absl::PairFormatter("=")),
+        "}}\n");
+  }
+  absl::StrAppend(&debug_string, "}\n");
+  return debug_string;
+}
+
+std::string XlaClusterStats::ShapeSignature(
+    absl::Span<const XlaCompiler::Argument> args) {
+  return absl::StrJoin(
+      args, ",", [](std::string* out, const XlaCompiler::Argument& arg) {
+        absl::StrAppend(out, DataTypeString(arg.type), arg.ShapeHumanString());
+      });
+}
+
+}  // namespace tensorflow
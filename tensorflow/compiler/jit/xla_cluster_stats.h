@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_XLA_CLUSTER_STATS_H_
+#define TENSORFLOW_COMPILER_JIT_XLA_CLUSTER_STATS_H_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Reasons for which an execution of a cluster fell back to running the
+// TensorFlow function instead of the XLA executable.
+inline constexpr absl::string_view kXlaFallbackDeferred = "deferred";
+inline constexpr absl::string_view kXlaFallbackCompilationFailed =
+    "compilation_failed";
+inline constexpr absl::string_view kXlaFallbackMegamorphic = "megamorphic";
+inline constexpr absl::string_view kXlaFallbackNotCompiled = "not_compiled";
+
+// Aggregates, per cluster, how the XLA clusters of the process are compiled
+// and executed, so that it is possible to tell which clusters pay off
+// without reading VLOG output. The statistics are also exported as
+// monitoring metrics labelled with the cluster name, and as a plane of the
+// profiler.
+class XlaClusterStats {
+ public:
+  // The maximum number of distinct argument shapes recorded for a cluster.
+  static constexpr int kMaxShapeSignatures = 16;
+
+  struct Cluster {
+    int64_t compile_count = 0;
+    int64_t cumulative_compile_time_us = 0;
+
+    // Executions of the XLA executable, and the time spent running them. For
+    // executables which run asynchronously, e.g. on GPUs, this is the time
+    // spent enqueueing them.
+    int64_t execution_count = 0;
+    int64_t cumulative_execution_time_us = 0;
+
+    // See DeviceCompilationProfiler::ClusterCompileStats::is_megamorphic.
+    bool is_megamorphic = false;
+
+    // The argument shapes the cluster was compiled for, in the order of their
+    // first compilation.
+    std::vector<std::string> shape_signatures;
+
+    // The number of executions which fell back to TensorFlow, by reason.
+    std::map<std::string, int64_t> fallback_counts;
+  };
+
+  XlaClusterStats() = default;
+
+  static XlaClusterStats* Global();
+
+  void RecordCompilation(absl::string_view cluster, int64_t compile_time_us);
+  void RecordShapeSignature(absl::string_view cluster,
+                            absl::Span<const XlaCompiler::Argument> args);
+  void RecordExecution(absl::string_view cluster, int64_t execution_time_us);
+  void RecordMegamorphic(absl::string_view cluster);
+  void RecordFallback(absl::string_view cluster, absl::string_view reason);
+
+  bool IsMegamorphic(absl::string_view cluster) const;
+
+  // Returns the statistics of all clusters, by cluster name.
+  std::map<std::string, Cluster> Snapshot() const;
+
+  std::string DebugString() const;
+
+  // Returns a human readable signature of the types and shapes of `args`.
+  static std::string ShapeSignature(
+      absl::Span<const XlaCompiler::Argument> args);
+
+ private:
+  Cluster& GetOrCreateCluster(absl::string_view cluster)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable mutex mu_;
+  std::map<std::string, Cluster, std::less<>> clusters_ TF_GUARDED_BY(mu_);
+
+  XlaClusterStats(const XlaClusterStats&) = delete;
+  void operator=(const XlaClusterStats&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_XLA_CLUSTER_STATS_H_
@@ -0,0 +1,123 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/jit/xla_cluster_stats.h"
+#include "tsl/profiler/lib/profiler_factory.h"
+#include "tsl/profiler/lib/profiler_interface.h"
+#include "tsl/profiler/protobuf/profiler_options.pb.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+#include "tsl/profiler/utils/xplane_builder.h"
+#include "tsl/profiler/utils/xplane_utils.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kXlaClustersPlaneName[] = "/host:xla_clusters";
+
+// Adds a plane with the XlaClusterStats of the clusters which were compiled,
+// executed or fell back to TensorFlow during the profiling session. Every
+// cluster is the metadata of an event, with stats for what happened during
+// the session.
+class XlaClusterStatsCollector : public tsl::profiler::ProfilerInterface {
+ public:
+  XlaClusterStatsCollector() = default;
+
+  absl::Status Start() override {
+    start_ = XlaClusterStats::Global()->Snapshot();
+    return absl::OkStatus();
+  }
+
+  absl::Status Stop() override {
+    stop_ = XlaClusterStats::Global()->Snapshot();
+    return absl::OkStatus();
+  }
+
+  absl::Status CollectData(tsl::profiler::XSpace* space) override {
+    if (stop_.empty()) return absl::OkStatus();
+    tsl::profiler::XPlaneBuilder plane(
+        tsl::profiler::FindOrAddMutablePlaneWithName(space,
+                                                     kXlaClustersPlaneName));
+    for (const auto& [name, stats] : stop_) {
+      XlaClusterStats::Cluster started;
+      if (auto it = start_.find(name); it != start_.end()) {
+        started = it->second;
+      }
+      const int64_t compile_count = stats.compile_count - started.compile_count;
+      const int64_t execution_count =
+          stats.execution_count - started.execution_count;
+      std::map<std::string, int64_t> fallback_counts;
+      for (const auto& [reason, count] : stats.fallback_counts) {
+        const int64_t delta = count - started.fallback_counts[reason];
+        if (delta > 0) fallback_counts[reason] = delta;
+      }
+      if (compile_count == 0 && execution_count == 0 &&
+          fallback_counts.empty()) {
+        continue;
+      }
+
+      tsl::profiler::XStatsBuilder<tsl::profiler::XEventMetadata> cluster(
+          plane.GetOrCreateEventMetadata(name), &plane);
+      auto add_stat = [&](absl::string_view stat_name, auto value) {
+        cluster.AddStatValue(*plane.GetOrCreateStatMetadata(stat_name), value);
+      };
+      add_stat("compile_count", compile_count);
+      add_stat("compile_time_us", stats.cumulative_compile_time_us -
+                                      started.cumulative_compile_time_us);
+      add_stat("execution_count", execution_count);
+      add_stat("execution_time_us", stats.cumulative_execution_time_us -
+                                        started.cumulative_execution_time_us);
+      add_stat("is_megamorphic", stats.is_megamorphic);
+      add_stat("shape_signatures",
+               absl::StrJoin(stats.shape_signatures, "; "));
+      for (const auto& [reason, count] : fallback_counts) {
+        add_stat(absl::StrCat("fallback_count/", reason), count);
+      }
+    }
+    stop_.clear();
+    return absl::OkStatus();
+  }
+
+ private:
+  std::map<std::string, XlaClusterStats::Cluster> start_;
+  std::map<std::string, XlaClusterStats::Cluster> stop_;
+
+  XlaClusterStatsCollector(const XlaClusterStatsCollector&) = delete;
+  void operator=(const XlaClusterStatsCollector&) = delete;
+};
+
+std::unique_ptr<tsl::profiler::ProfilerInterface>
+CreateXlaClusterStatsCollector(const ProfileOptions& options) {
+  return options.host_tracer_level() > 0
+             ? std::make_unique<XlaClusterStatsCollector>()
+             : nullptr;
+}
+
+}  // namespace
+
+auto register_xla_cluster_stats_collector_factory = [] {
+  tsl::profiler::RegisterProfilerFactory(&CreateXlaClusterStatsCollector);
+  return 0;
+}();
+
+}  // namespace tensorflow
@@ -0,0 +1,93 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_cluster_stats.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+std::vector<XlaCompiler::Argument> Arguments(int64_t batch_size) {
+  std::vector<XlaCompiler::Argument> args(2);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({batch_size, 3});
+  args[1].kind = XlaCompiler::Argument::kParameter;
+  args[1].type = DT_INT32;
+  args[1].shape = TensorShape({});
+  return args;
+}
+
+TEST(XlaClusterStatsTest, AggregatesByCluster) {
+  XlaClusterStats stats;
+  stats.RecordCompilation("cluster_0", 100);
+  stats.RecordCompilation("cluster_0", 50);
+  stats.RecordExecution("cluster_0", 10);
+  stats.RecordExecution("cluster_0", 20);
+  stats.RecordExecution("cluster_1", 5);
+
+  std::map<std::string, XlaClusterStats::Cluster> snapshot = stats.Snapshot();
+  ASSERT_EQ(snapshot.size(), 2);
+  EXPECT_EQ(snapshot["cluster_0"].compile_count, 2);
+  EXPECT_EQ(snapshot["cluster_0"].cumulative_compile_time_us, 150);
+  EXPECT_EQ(snapshot["cluster_0"].execution_count, 2);
+  EXPECT_EQ(snapshot["cluster_0"].cumulative_execution_time_us, 30);
+  EXPECT_EQ(snapshot["cluster_1"].compile_count, 0);
+  EXPECT_EQ(snapshot["cluster_1"].execution_count, 1);
+}
+
+TEST(XlaClusterStatsTest, RecordsDistinctShapeSignatures) {
+  XlaClusterStats stats;
+  stats.RecordShapeSignature("cluster", Arguments(8));
+  stats.RecordShapeSignature("cluster", Arguments(8));
+  stats.RecordShapeSignature("cluster", Arguments(16));
+  EXPECT_EQ(stats.Snapshot()["cluster"].shape_signatures,
+            std::vector<std::string>({"float[8,3],int32[]",
+                                      "float[16,3],int32[]"}));
+
+  for (int i = 0; i < 2 * XlaClusterStats::kMaxShapeSignatures; ++i) {
+    stats.RecordShapeSignature("cluster", Arguments(100 + i));
+  }
+  EXPECT_EQ(stats.Snapshot()["cluster"].shape_signatures.size(),
+            XlaClusterStats::kMaxShapeSignatures);
+}
+
+TEST(XlaClusterStatsTest, RecordsFallbacksAndMegamorphism) {
+  XlaClusterStats stats;
+  EXPECT_FALSE(stats.IsMegamorphic("cluster"));
+  stats.RecordFallback("cluster", kXlaFallbackNotCompiled);
+  stats.RecordFallback("cluster", kXlaFallbackNotCompiled);
+  stats.RecordMegamorphic("cluster");
+  stats.RecordFallback("cluster", kXlaFallbackMegamorphic);
+  EXPECT_TRUE(stats.IsMegamorphic("cluster"));
+
+  XlaClusterStats::Cluster cluster = stats.Snapshot()["cluster"];
+  EXPECT_EQ(cluster.fallback_counts,
+            (std::map<std::string, int64_t>{{"megamorphic", 1},
+                                            {"not_compiled", 2}}));
+  EXPECT_NE(stats.DebugString().find("not_compiled=2"), std::string::npos);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,250 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_compilation_warmup.h"
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/compiler/tf2xla/xla_resource.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+absl::StatusOr<XlaRecordedArgument::Kind> RecordedKind(
+    XlaCompiler::Argument::Kind kind) {
+  switch (kind) {
+    case XlaCompiler::Argument::kConstant:
+      return XlaRecordedArgument::CONSTANT;
+    case XlaCompiler::Argument::kResource:
+      return XlaRecordedArgument::RESOURCE;
+    case XlaCompiler::Argument::kParameter:
+      return XlaRecordedArgument::PARAMETER;
+    default:
+      return errors::Unimplemented("Can't record arguments of kind ", kind);
+  }
+}
+
+absl::StatusOr<XlaCompiler::Argument::Kind> ArgumentKind(
+    XlaRecordedArgument::Kind kind) {
+  switch (kind) {
+    case XlaRecordedArgument::CONSTANT:
+      return XlaCompiler::Argument::kConstant;
+    case XlaRecordedArgument::RESOURCE:
+      return XlaCompiler::Argument::kResource;
+    case XlaRecordedArgument::PARAMETER:
+      return XlaCompiler::Argument::kParameter;
+    default:
+      return errors::InvalidArgument("Invalid recorded argument kind ", kind);
+  }
+}
+
+XlaRecordedArgument::ResourceKind RecordedResourceKind(
+    XlaResource::Kind kind) {
+  switch (kind) {
+    case XlaResource::kVariable:
+      return XlaRecordedArgument::VARIABLE;
+    case XlaResource::kTensorArray:
+      return XlaRecordedArgument::TENSOR_ARRAY;
+    case XlaResource::kStack:
+      return XlaRecordedArgument::STACK;
+    default:
+      return XlaRecordedArgument::INVALID_RESOURCE;
+  }
+}
+
+XlaResource::Kind ResourceKind(XlaRecordedArgument::ResourceKind kind) {
+  switch (kind) {
+    case XlaRecordedArgument::VARIABLE:
+      return XlaResource::kVariable;
+    case XlaRecordedArgument::TENSOR_ARRAY:
+      return XlaResource::kTensorArray;
+    case XlaRecordedArgument::STACK:
+      return XlaResource::kStack;
+    default:
+      return XlaResource::kInvalid;
+  }
+}
+
+// Returns the key of the compilations of `function` on `device_type`.
+std::string ClusterKey(const std::string& device_type,
+                       const NameAttrList& function) {
+  std::string serialized_function;
+  SerializeToStringDeterministic(function, &serialized_function);
+  return absl::StrCat(device_type, "/", serialized_function);
+}
+
+}  // namespace
+
+absl::StatusOr<XlaRecordedCompilation> RecordCompilation(
+    const DeviceType& device_type, const NameAttrList& function,
+    absl::Span<const XlaCompiler::Argument> args) {
+  XlaRecordedCompilation compilation;
+  compilation.set_device_type(device_type.type_string());
+  *compilation.mutable_function() = function;
+  for (const XlaCompiler::Argument& arg : args) {
+    XlaRecordedArgument* recorded = compilation.add_args();
+    TF_ASSIGN_OR_RETURN(XlaRecordedArgument::Kind kind,
+                        RecordedKind(arg.kind));
+    recorded->set_kind(kind);
+    recorded->set_type(arg.type);
+    if (!std::holds_alternative<TensorShape>(arg.shape)) {
+      return errors::Unimplemented("Can't record argument ", arg.name,
+                                   " with an XLA shape");
+    }
+    std::get<TensorShape>(arg.shape).AsProto(recorded->mutable_shape());
+    if (arg.kind == XlaCompiler::Argument::kConstant) {
+      arg.constant_value.AsProtoTensorContent(
+          recorded->mutable_constant_value());
+    }
+    recorded->set_name(arg.name);
+    recorded->set_resource_kind(RecordedResourceKind(arg.resource_kind));
+    recorded->set_initialized(arg.initialized);
+    recorded->set_fast_mem(arg.fast_mem);
+    recorded->set_max_array_size(arg.max_array_size);
+    for (const std::string& gradient : arg.tensor_array_gradients) {
+      recorded->add_tensor_array_gradients(gradient);
+    }
+  }
+  return compilation;
+}
+
+absl::StatusOr<std::vector<XlaCompiler::Argument>> RecordedArguments(
+    const XlaRecordedCompilation& compilation) {
+  std::vector<XlaCompiler::Argument> args(compilation.args_size());
+  for (int i = 0; i < compilation.args_size(); ++i) {
+    const XlaRecordedArgument& recorded = compilation.args(i);
+    XlaCompiler::Argument& arg = args[i];
+    TF_ASSIGN_OR_RETURN(arg.kind, ArgumentKind(recorded.kind()));
+    arg.type = recorded.type();
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(recorded.shape(), &shape));
+    arg.shape = shape;
+    if (arg.kind == XlaCompiler::Argument::kConstant &&
+        !arg.constant_value.FromProto(recorded.constant_value())) {
+      return errors::InvalidArgument("Invalid constant value of argument ",
+                                     recorded.name());
+    }
+    arg.name = recorded.name();
+    arg.resource_kind = ResourceKind(recorded.resource_kind());
+    arg.initialized = recorded.initialized();
+    arg.fast_mem = recorded.fast_mem();
+    arg.max_array_size = recorded.max_array_size();
+    arg.tensor_array_gradients.insert(recorded.tensor_array_gradients().begin(),
+                                      recorded.tensor_array_gradients().end());
+  }
+  return args;
+}
+
+Status XlaCompilationRecorder::Record(
+    const XlaCompiler::CompilationResult* compilation_result,
+    const DeviceType& device_type, const NameAttrList& function,
+    absl::Span<const XlaCompiler::Argument> args) {
+  mutex_lock lock(mu_);
+  if (!recorded_results_.insert(compilation_result).second) {
+    return absl::OkStatus();
+  }
+  TF_ASSIGN_OR_RETURN(XlaRecordedCompilation compilation,
+                      RecordCompilation(device_type, function, args));
+  std::string serialized_compilation;
+  SerializeToStringDeterministic(compilation, &serialized_compilation);
+  if (!recorded_compilations_.insert(std::move(serialized_compilation))
+           .second) {
+    return absl::OkStatus();
+  }
+  *compilations_.add_compilations() = std::move(compilation);
+
+  // Write to a temporary file first, so that readers never see a partially
+  // written file.
+  Env* env = Env::Default();
+  const std::string tmp_path = absl::StrCat(path_, ".tmp");
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, tmp_path, compilations_));
+  return env->RenameFile(tmp_path, path_);
+}
+
+XlaCompilationRecorder* XlaCompilationRecorder::Global() {
+  static XlaCompilationRecorder* recorder = []() -> XlaCompilationRecorder* {
+    const std::string& path =
+        GetXlaOpsCommonFlags()->tf_xla_compilation_record_file;
+    if (path.empty()) return nullptr;
+    return new XlaCompilationRecorder(path);
+  }();
+  return recorder;
+}
+
+XlaWarmupCompilations::XlaWarmupCompilations(
+    const XlaRecordedCompilations& compilations) {
+  for (const XlaRecordedCompilation& compilation :
+       compilations.compilations()) {
+    compilations_[ClusterKey(compilation.device_type(), compilation.function())]
+        .push_back(compilation);
+  }
+}
+
+std::vector<XlaRecordedCompilation> XlaWarmupCompilations::Get(
+    const DeviceType& device_type, const NameAttrList& function) const {
+  auto it = compilations_.find(ClusterKey(device_type.type_string(), function));
+  if (it == compilations_.end()) return {};
+  return it->second;
+}
+
+const XlaWarmupCompilations* XlaWarmupCompilations::Global() {
+  static const XlaWarmupCompilations* compilations =
+      []() -> const XlaWarmupCompilations* {
+    const std::string& path =
+        GetXlaOpsCommonFlags()->tf_xla_warmup_compilation_file;
+    if (path.empty()) return nullptr;
+    XlaRecordedCompilations recorded;
+    Status status = ReadBinaryProto(Env::Default(), path, &recorded);
+    if (!status.ok()) {
+      LOG(WARNING) << "Not warming up XLA compilations from " << path << ": "
+                   << status;
+      return nullptr;
+    }
+    VLOG(1) << "Read " << recorded.compilations_size()
+            << " XLA compilations to warm up from " << path;
+    return new XlaWarmupCompilations(recorded);
+  }();
+  return compilations;
+}
+
+void ScheduleWarmupCompilation(std::function<void()> warmup) {
+  static thread::ThreadPool* thread_pool = new thread::ThreadPool(
+      Env::Default(), "xla_warmup_compilation", port::MaxParallelism());
+  thread_pool->Schedule(std::move(warmup));
+}
+
+}  // namespace tensorflow
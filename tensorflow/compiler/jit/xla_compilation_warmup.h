@@ -0,0 +1,102 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_WARMUP_H_
+#define TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_WARMUP_H_
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Returns the recorded form of the compilation of `function` for `args` on
+// `device_type`. Fails for arguments which can't be recorded, e.g. TensorLists
+// or arguments with an XLA shape.
+absl::StatusOr<XlaRecordedCompilation> RecordCompilation(
+    const DeviceType& device_type, const NameAttrList& function,
+    absl::Span<const XlaCompiler::Argument> args);
+
+// Returns the arguments of a recorded compilation.
+absl::StatusOr<std::vector<XlaCompiler::Argument>> RecordedArguments(
+    const XlaRecordedCompilation& compilation);
+
+// Records the clusters compiled by a process to a file, which a later process
+// can use to compile them before they are executed. The file is rewritten with
+// all compilations recorded so far every time a new one is recorded, which is
+// cheap since compilations are rare.
+class XlaCompilationRecorder {
+ public:
+  explicit XlaCompilationRecorder(std::string path) : path_(std::move(path)) {}
+
+  // Records the compilation of `function` for `args` on `device_type`, which
+  // produced `compilation_result`. Compilations with a result which was
+  // already recorded are skipped without looking at `args`, so that this can
+  // be called on every execution of a cluster.
+  Status Record(const XlaCompiler::CompilationResult* compilation_result,
+                const DeviceType& device_type, const NameAttrList& function,
+                absl::Span<const XlaCompiler::Argument> args);
+
+  // Returns the recorder for --tf_xla_compilation_record_file, or nullptr if
+  // the flag is not set.
+  static XlaCompilationRecorder* Global();
+
+ private:
+  const std::string path_;
+  mutex mu_;
+  absl::flat_hash_set<const XlaCompiler::CompilationResult*> recorded_results_
+      TF_GUARDED_BY(mu_);
+  absl::flat_hash_set<std::string> recorded_compilations_ TF_GUARDED_BY(mu_);
+  XlaRecordedCompilations compilations_ TF_GUARDED_BY(mu_);
+};
+
+// The compilations recorded by an earlier process, by cluster.
+class XlaWarmupCompilations {
+ public:
+  explicit XlaWarmupCompilations(const XlaRecordedCompilations& compilations);
+
+  // Returns the recorded compilations of `function` on `device_type`.
+  std::vector<XlaRecordedCompilation> Get(const DeviceType& device_type,
+                                          const NameAttrList& function) const;
+
+  // Returns the compilations read from --tf_xla_warmup_compilation_file, or
+  // nullptr if the flag is not set or the file can't be read.
+  static const XlaWarmupCompilations* Global();
+
+ private:
+  absl::flat_hash_map<std::string, std::vector<XlaRecordedCompilation>>
+      compilations_;
+};
+
+// Runs `warmup` on the threads shared by all warmup compilations of the
+// process, so that the recorded clusters are compiled in parallel.
+void ScheduleWarmupCompilation(std::function<void()> warmup);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_WARMUP_H_
@@ -0,0 +1,125 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_compilation_warmup.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/compiler/tf2xla/xla_resource.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+NameAttrList Function(const std::string& name) {
+  NameAttrList function;
+  function.set_name(name);
+  return function;
+}
+
+std::vector<XlaCompiler::Argument> Arguments() {
+  std::vector<XlaCompiler::Argument> args(3);
+  args[0].kind = XlaCompiler::Argument::kConstant;
+  args[0].type = DT_INT32;
+  args[0].shape = TensorShape({2});
+  args[0].constant_value = test::AsTensor<int32>({3, 4});
+  args[1].kind = XlaCompiler::Argument::kParameter;
+  args[1].type = DT_FLOAT;
+  args[1].shape = TensorShape({8, 3});
+  args[1].name = "x";
+  args[2].kind = XlaCompiler::Argument::kResource;
+  args[2].type = DT_FLOAT;
+  args[2].shape = TensorShape({3});
+  args[2].resource_kind = XlaResource::kVariable;
+  args[2].initialized = true;
+  return args;
+}
+
+TEST(XlaCompilationWarmupTest, RecordedArgumentsRoundTrip) {
+  std::vector<XlaCompiler::Argument> args = Arguments();
+  TF_ASSERT_OK_AND_ASSIGN(
+      XlaRecordedCompilation compilation,
+      RecordCompilation(DeviceType(DEVICE_CPU), Function("cluster"), args));
+  EXPECT_EQ(compilation.device_type(), DEVICE_CPU);
+  EXPECT_EQ(compilation.function().name(), "cluster");
+
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<XlaCompiler::Argument> recorded,
+                          RecordedArguments(compilation));
+  ASSERT_EQ(recorded.size(), args.size());
+  for (int i = 0; i < args.size(); ++i) {
+    EXPECT_EQ(recorded[i].kind, args[i].kind);
+    EXPECT_EQ(recorded[i].type, args[i].type);
+    EXPECT_EQ(recorded[i].HumanString(), args[i].HumanString());
+  }
+  test::ExpectTensorEqual<int32>(recorded[0].constant_value,
+                                 args[0].constant_value);
+  EXPECT_EQ(recorded[1].name, "x");
+  EXPECT_EQ(recorded[2].resource_kind, XlaResource::kVariable);
+  EXPECT_TRUE(recorded[2].initialized);
+}
+
+TEST(XlaCompilationWarmupTest, CannotRecordTensorLists) {
+  std::vector<XlaCompiler::Argument> args(1);
+  args[0].kind = XlaCompiler::Argument::kTensorList;
+  EXPECT_FALSE(
+      RecordCompilation(DeviceType(DEVICE_CPU), Function("cluster"), args)
+          .ok());
+}
+
+TEST(XlaCompilationWarmupTest, RecordAndReadCompilations) {
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "recorded_compilations.pb");
+  XlaCompilationRecorder recorder(path);
+  XlaCompiler::CompilationResult first_result;
+  XlaCompiler::CompilationResult second_result;
+  std::vector<XlaCompiler::Argument> args = Arguments();
+  TF_ASSERT_OK(recorder.Record(&first_result, DeviceType(DEVICE_CPU),
+                               Function("cluster"), args));
+  // Executions of a compiled cluster are not recorded again.
+  TF_ASSERT_OK(recorder.Record(&first_result, DeviceType(DEVICE_CPU),
+                               Function("cluster"), args));
+  args[1].shape = TensorShape({16, 3});
+  TF_ASSERT_OK(recorder.Record(&second_result, DeviceType(DEVICE_GPU),
+                               Function("cluster"), args));
+
+  XlaRecordedCompilations recorded;
+  TF_ASSERT_OK(ReadBinaryProto(Env::Default(), path, &recorded));
+  EXPECT_EQ(recorded.compilations_size(), 2);
+
+  XlaWarmupCompilations warmup(recorded);
+  std::vector<XlaRecordedCompilation> cpu_compilations =
+      warmup.Get(DeviceType(DEVICE_CPU), Function("cluster"));
+  ASSERT_EQ(cpu_compilations.size(), 1);
+  EXPECT_EQ(cpu_compilations[0].args(1).shape().dim(0).size(), 8);
+  std::vector<XlaRecordedCompilation> gpu_compilations =
+      warmup.Get(DeviceType(DEVICE_GPU), Function("cluster"));
+  ASSERT_EQ(gpu_compilations.size(), 1);
+  EXPECT_EQ(gpu_compilations[0].args(1).shape().dim(0).size(), 16);
+  EXPECT_TRUE(warmup.Get(DeviceType(DEVICE_CPU), Function("other")).empty());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -26,7 +26,9 @@ limitations under the License.
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
 #include "tensorflow/compiler/jit/device_compiler.h"
 #include "tensorflow/compiler/jit/flags.h"
@@ -55,6 +57,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/tfrt/common/pjrt_util.h"
 #include "tsl/platform/errors.h"
@@ -103,6 +106,23 @@ Status GetAndLockVariablesAndBuildXlaCompilerArguments(
 }
 }  // namespace
 
+XlaCompileOnDemandOp::~XlaCompileOnDemandOp() {
+  mutex_lock lock(mu_);
+  if (cached_xla_device_compiler_ != nullptr) {
+    cached_xla_device_compiler_->Unref();
+  }
+}
+
+absl::StatusOr<std::vector<int>> XlaCompileOnDemandOp::GetConstantInputIndices(
+    OpKernelContext* ctx) {
+  mutex_lock lock(mu_);
+  if (!constant_input_indices_.has_value()) {
+    TF_ASSIGN_OR_RETURN(constant_input_indices_,
+                        GetConstantInputIndicesFromContext(ctx));
+  }
+  return *constant_input_indices_;
+}
+
 Status XlaCompileOnDemandOp::Run(const ResourceVarsSnapshot& variable_args,
                                  const XlaCompiler::CompilationResult* result,
                                  const XlaDeviceCompiler* xla_device_compiler,
@@ -231,6 +251,60 @@ Status XlaCompileOnDemandOp::Compile(
                                 result, executable);
 }
 
+Status XlaCompileOnDemandOp::GetOrCompile(
+    const std::vector<XlaCompiler::Argument>& args, OpKernelContext* ctx,
+    XlaDeviceCompiler** xla_device_compiler,
+    const XlaCompiler::CompilationResult** result,
+    xla::LocalExecutable** executable) {
+  // The attributes of the op are the same for all the executions of the
+  // kernel, so its name is enough to tell its compilations apart.
+  NameAttrList op;
+  op.set_name(def().op());
+  TF_ASSIGN_OR_RETURN(DeviceCompilationClusterSignature signature,
+                      DeviceCompilationClusterSignature::Build(op, args));
+  int64_t eviction_count = 0;
+  {
+    mutex_lock lock(mu_);
+    if (cached_xla_device_compiler_ != nullptr) {
+      eviction_count = cached_xla_device_compiler_->cache()->eviction_count();
+      if (eviction_count != cached_eviction_count_) {
+        cached_executables_.clear();
+        cached_eviction_count_ = eviction_count;
+      }
+    }
+    auto it = cached_executables_.find(signature);
+    if (it != cached_executables_.end()) {
+      cached_xla_device_compiler_->Ref();
+      *xla_device_compiler = cached_xla_device_compiler_;
+      *result = it->second.result;
+      *executable = it->second.executable;
+      return absl::OkStatus();
+    }
+  }
+
+  DeviceCompilationProfiler* profiler;
+  TF_RETURN_IF_ERROR(
+      Compile(args, ctx, xla_device_compiler, &profiler, result, executable));
+  profiler->Unref();
+
+  mutex_lock lock(mu_);
+  if (cached_xla_device_compiler_ == nullptr) {
+    (*xla_device_compiler)->Ref();
+    cached_xla_device_compiler_ = *xla_device_compiler;
+    cached_eviction_count_ = eviction_count;
+  }
+  // Entries evicted since the lookup above may include the one just
+  // compiled, so it is only cached if there were none.
+  if (cached_xla_device_compiler_ == *xla_device_compiler &&
+      cached_xla_device_compiler_->cache()->eviction_count() ==
+          cached_eviction_count_ &&
+      cached_executables_.size() < kMaxCachedExecutables) {
+    cached_executables_.emplace(std::move(signature),
+                                CachedExecutable{*result, *executable});
+  }
+  return absl::OkStatus();
+}
+
 void XlaCompileOnDemandOp::Compute(OpKernelContext* ctx) {
   const XlaCompiler::CompilationResult* result;
   DeviceCompilationProfiler* profiler;
@@ -239,7 +313,7 @@ void XlaCompileOnDemandOp::Compute(OpKernelContext* ctx) {
               errors::Internal("Function library missing"));
 
   // Get constants, inputs and variables from the OpKernelContext.
-  auto constant_indices_or = GetConstantInputIndicesFromContext(ctx);
+  auto constant_indices_or = GetConstantInputIndices(ctx);
   OP_REQUIRES_OK(ctx, constant_indices_or.status());
   std::vector<const Tensor*> inputs = InputsFromContext(ctx);
   std::vector<int> variable_indices =
@@ -293,13 +367,10 @@ void XlaCompileOnDemandOp::Compute(OpKernelContext* ctx) {
 
     XlaDeviceCompiler* xla_device_compiler;
     xla::LocalExecutable* executable;
-    OP_REQUIRES_OK(ctx, Compile(args, ctx, &xla_device_compiler, &profiler,
-                                &result, &executable));
-    // Hold the reference to the XLA device compiler and profiler during
-    // evaluation. (We could probably free them sooner because the ResourceMgr
-    // will retain references, but this is more obviously correct.)
+    OP_REQUIRES_OK(ctx, GetOrCompile(args, ctx, &xla_device_compiler, &result,
+                                     &executable));
+    // Hold the reference to the XLA device compiler during evaluation.
     core::ScopedUnref xla_device_compiler_ref(xla_device_compiler);
-    core::ScopedUnref profiler_ref(profiler);
 
     // Locks are acquired again when populating the `ctx` outputs.
     OP_REQUIRES_OK(
@@ -19,9 +19,14 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_XLA_COMPILE_ON_DEMAND_OP_H_
 #define TENSORFLOW_COMPILER_JIT_XLA_COMPILE_ON_DEMAND_OP_H_
 
+#include <optional>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
+#include "tensorflow/compiler/jit/device_compiler.h"
 #include "tensorflow/compiler/jit/variable_info.h"
 #include "tensorflow/compiler/jit/variable_info_util.h"
 #include "tensorflow/compiler/jit/xla_launch_util.h"
@@ -33,6 +38,8 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
@@ -44,9 +51,36 @@ class XlaCompileOnDemandOp : public OpKernel {
   explicit XlaCompileOnDemandOp(OpKernelConstruction* ctx)
       : OpKernel(ctx),
         platform_info_(XlaPlatformInfoFromDevice(ctx->device())) {}
+  ~XlaCompileOnDemandOp() override;
   void Compute(OpKernelContext* ctx) override;
 
  private:
+  using XlaDeviceCompiler =
+      DeviceCompiler<xla::LocalExecutable, xla::LocalClient>;
+
+  // The maximum number of executables cached by a kernel, see
+  // `cached_executables_`.
+  static constexpr int kMaxCachedExecutables = 16;
+
+  struct CachedExecutable {
+    const XlaCompiler::CompilationResult* result;
+    xla::LocalExecutable* executable;
+  };
+
+  // Returns the indices of the compile-time constant inputs of the op, which
+  // don't change between executions of the kernel.
+  absl::StatusOr<std::vector<int>> GetConstantInputIndices(
+      OpKernelContext* ctx);
+
+  // Returns the executable of the op for `args` from `cached_executables_`,
+  // or compiles it with the device compiler. The caller owns a reference to
+  // `xla_device_compiler`.
+  Status GetOrCompile(const std::vector<XlaCompiler::Argument>& args,
+                      OpKernelContext* ctx,
+                      XlaDeviceCompiler** xla_device_compiler,
+                      const XlaCompiler::CompilationResult** result,
+                      xla::LocalExecutable** executable);
+
   Status Compile(const std::vector<XlaCompiler::Argument>& args,
                  OpKernelContext* ctx,
                  DeviceCompiler<xla::LocalExecutable, xla::LocalClient>**
@@ -70,6 +104,21 @@ class XlaCompileOnDemandOp : public OpKernel {
              xla::LocalExecutable* executable, OpKernelContext* ctx);
 
   const XlaPlatformInfo platform_info_;
+
+  mutex mu_;
+  std::optional<std::vector<int>> constant_input_indices_ TF_GUARDED_BY(mu_);
+
+  // The executables of the op which were already compiled, by the types,
+  // shapes and constant values of its arguments. Executing an op for which
+  // they contain an executable doesn't have to canonicalize the attributes
+  // of the op and look up the device compiler, which matters when every op
+  // of an eager program is compiled on its own. The executables are owned by
+  // `cached_xla_device_compiler_`, and dropped when its cache evicts entries.
+  XlaDeviceCompiler* cached_xla_device_compiler_ TF_GUARDED_BY(mu_) = nullptr;
+  int64_t cached_eviction_count_ TF_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<DeviceCompilationClusterSignature, CachedExecutable,
+                      DeviceCompilationClusterSignature::Hash>
+      cached_executables_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tensorflow
@@ -0,0 +1,135 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_compile_on_demand_op.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/compiler/jit/device_compilation_profiler.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kXlaCpuDevice[] =
+    "/job:localhost/replica:0/task:0/device:XLA_CPU:0";
+
+// Runs "y = x + x" with the AddV2 op placed on the XLA_CPU device, which
+// compiles it through XlaCompileOnDemandOp.
+class XlaCompileOnDemandOpTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    GetXlaDeviceFlags()->tf_xla_enable_xla_devices = true;
+    // Keeps the op out of auto-clustering, so that it runs on its own.
+    GetXlaDeviceFlags()->tf_xla_compile_on_demand = true;
+
+    Scope root = Scope::NewRootScope().ExitOnError();
+    Output x = ops::Placeholder(root.WithOpName("x"), DT_FLOAT);
+    ops::AddV2(root.WithOpName("y").WithDevice(kXlaCpuDevice), x, x);
+    GraphDef graph_def;
+    TF_ASSERT_OK(root.ToGraphDef(&graph_def));
+
+    // Keeps grappler from rewriting the op.
+    SessionOptions options;
+    options.config.mutable_graph_options()
+        ->mutable_rewrite_options()
+        ->set_disable_meta_optimizer(true);
+    session_.reset(NewSession(options));
+    TF_ASSERT_OK(session_->Create(graph_def));
+  }
+
+  Tensor Run(const Tensor& x) {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session_->Run({{"x", x}}, {"y"}, {}, &outputs));
+    return outputs[0];
+  }
+
+  // Returns how many times the device compiler was asked for an executable
+  // of AddV2, and how many times it compiled one.
+  DeviceCompilationProfiler::ClusterCompileStats Stats() {
+    const DeviceMgr* device_mgr;
+    TF_CHECK_OK(session_->LocalDeviceManager(&device_mgr));
+    Device* device;
+    TF_CHECK_OK(device_mgr->LookupDevice(kXlaCpuDevice, &device));
+    ResourceMgr* rm = device->resource_manager();
+    DeviceCompilationProfiler* profiler;
+    TF_CHECK_OK(rm->Lookup(rm->default_container(),
+                           "device_compilation_profiler", &profiler));
+    core::ScopedUnref profiler_ref(profiler);
+    NameAttrList function;
+    function.set_name("AddV2");
+    auto stats = profiler->GetCompileStats(function);
+    TF_CHECK_OK(stats.status());
+    return *stats;
+  }
+
+  void ExpectCounts(int64_t execution_count, int64_t compile_count) {
+    DeviceCompilationProfiler::ClusterCompileStats stats = Stats();
+    EXPECT_EQ(stats.execution_count, execution_count);
+    EXPECT_EQ(stats.compile_count, compile_count);
+  }
+
+  std::unique_ptr<Session> session_;
+};
+
+TEST_F(XlaCompileOnDemandOpTest, ReusesExecutableForSameShapes) {
+  test::ExpectTensorEqual<float>(Run(test::AsTensor<float>({1, 2})),
+                                 test::AsTensor<float>({2, 4}));
+  ExpectCounts(/*execution_count=*/1, /*compile_count=*/1);
+
+  // The kernel runs its cached executable without going through the device
+  // compiler.
+  test::ExpectTensorEqual<float>(Run(test::AsTensor<float>({3, 4})),
+                                 test::AsTensor<float>({6, 8}));
+  ExpectCounts(/*execution_count=*/1, /*compile_count=*/1);
+}
+
+TEST_F(XlaCompileOnDemandOpTest, RecompilesForNewShapes) {
+  test::ExpectTensorEqual<float>(Run(test::AsTensor<float>({1, 2})),
+                                 test::AsTensor<float>({2, 4}));
+  ExpectCounts(/*execution_count=*/1, /*compile_count=*/1);
+
+  test::ExpectTensorEqual<float>(Run(test::AsTensor<float>({1, 2, 3})),
+                                 test::AsTensor<float>({2, 4, 6}));
+  ExpectCounts(/*execution_count=*/2, /*compile_count=*/2);
+
+  // Both executables stay cached in the kernel.
+  test::ExpectTensorEqual<float>(Run(test::AsTensor<float>({5, 6})),
+                                 test::AsTensor<float>({10, 12}));
+  test::ExpectTensorEqual<float>(Run(test::AsTensor<float>({4, 5, 6})),
+                                 test::AsTensor<float>({8, 10, 12}));
+  ExpectCounts(/*execution_count=*/2, /*compile_count=*/2);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_compiler_options_util.h"
 
+#include "tensorflow/compiler/jit/flags.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "tensorflow/core/framework/function.h"
 #include "tsl/framework/device_id_utils.h"
@@ -144,6 +145,9 @@ XlaCompiler::CompileOptions GenerateCompileOptions(
   compile_options.always_return_tuple = false;
   compile_options.alias_resource_update =
       !has_ref_vars && may_alias_resource_update;
+  compile_options.alias_parameter_args =
+      compile_options.alias_resource_update &&
+      GetXlaOpsCommonFlags()->tf_xla_donate_input_buffers;
   return compile_options;
 }
 
@@ -334,6 +334,25 @@ TEST_F(XlaCompilerOptionsTest, GenerateCompileOptions) {
   XlaCompiler::CompileOptions option4 = GenerateCompileOptions(
       /*has_ref_vars=*/true, /*may_alias_resource_update=*/true);
   EXPECT_FALSE(option4.alias_resource_update);
+  EXPECT_FALSE(option2.alias_parameter_args);
+}
+
+TEST_F(XlaCompilerOptionsTest, GenerateCompileOptionsDonatesInputBuffers) {
+  XlaOpsCommonFlags* flags = GetXlaOpsCommonFlags();
+  const bool old_donate = flags->tf_xla_donate_input_buffers;
+  flags->tf_xla_donate_input_buffers = true;
+
+  EXPECT_TRUE(GenerateCompileOptions(/*has_ref_vars=*/false,
+                                     /*may_alias_resource_update=*/true)
+                  .alias_parameter_args);
+  EXPECT_FALSE(GenerateCompileOptions(/*has_ref_vars=*/false,
+                                      /*may_alias_resource_update=*/false)
+                   .alias_parameter_args);
+  EXPECT_FALSE(GenerateCompileOptions(/*has_ref_vars=*/true,
+                                      /*may_alias_resource_update=*/true)
+                   .alias_parameter_args);
+
+  flags->tf_xla_donate_input_buffers = old_donate;
 }
 
 }  // namespace
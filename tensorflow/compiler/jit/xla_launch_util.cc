@@ -53,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -68,6 +69,12 @@ namespace {
 using xla::ScopedShapedBuffer;
 using xla::ShapedBuffer;
 
+auto* xla_donated_buffer_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/core/xla_donated_buffer_bytes",
+    "The number of bytes of XlaLaunch arguments whose buffers were reused for "
+    "outputs.",
+    "device");
+
 // Fetch the platform Id from device.
 se::Platform::Id XlaPlatformInfoFromDevice(DeviceBase* device_base) {
   auto device = static_cast<Device*>(device_base);
@@ -152,7 +159,8 @@ XlaComputationLaunchContext::PopulateInputs(
     const XlaCompiler::CompilationResult* compilation_result,
     const std::map<int, const Tensor*>& resource_vars,
     int missing_ctx_input_prefix,
-    const xla::HloInputOutputAliasConfig& input_output_alias) {
+    const xla::HloInputOutputAliasConfig& input_output_alias,
+    const std::map<int, const Tensor*>& replaced_inputs) {
   std::vector<xla::ExecutionInput> arguments;
   arguments.reserve(compilation_result->xla_input_shapes.size());
 
@@ -175,12 +183,24 @@ XlaComputationLaunchContext::PopulateInputs(
                                 update.modified;
                        });
 
-    const Tensor* t = is_resource_variable
-                          ? resource_var_it->second
-                          : &(ctx->input(arg_num - missing_ctx_input_prefix));
+    auto replaced_input_it = replaced_inputs.find(arg_num);
+    const Tensor* t = nullptr;
+    if (is_resource_variable) {
+      t = resource_var_it->second;
+    } else if (replaced_input_it != replaced_inputs.end()) {
+      t = replaced_input_it->second;
+    } else {
+      t = &(ctx->input(arg_num - missing_ctx_input_prefix));
+    }
     CHECK(t);
+    // Parameters are only aliased with outputs when compiled with
+    // `alias_parameter_args`. Replaced inputs are owned by the caller, which
+    // must not see their buffers reused.
+    bool is_donatable_parameter = !is_resource_variable &&
+                                  replaced_input_it == replaced_inputs.end();
     bool donate_buffer =
-        t->RefCountIsOne() && is_updated_resource_variable &&
+        t->RefCountIsOne() &&
+        (is_updated_resource_variable || is_donatable_parameter) &&
         input_output_alias.ParameterHasAlias(i, xla::ShapeIndex{});
     VLOG(3) << "Processing input: " << i
             << "; is_resource_variable=" << is_resource_variable
@@ -251,6 +271,8 @@ static absl::StatusOr<Tensor> GetOrCreateTensorForOutput(
       // PopulateExecutionInputBuffer). Release ownership from output to avoid
       // double free.
       output.set_buffer(se::OwningDeviceMemory(), {output_num});
+      xla_donated_buffer_bytes->GetCell(ctx->device()->device_type())
+          ->IncrementBy(input_tensor.TotalBytes());
       return input_tensor;
     }
   }
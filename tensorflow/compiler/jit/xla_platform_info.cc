@@ -24,6 +24,7 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
@@ -35,13 +36,16 @@ limitations under the License.
 #include "xla/client/local_client.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/service/compiler.h"
+#include "xla/stream_executor/device_description.h"
 #include "xla/stream_executor/platform_manager.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/tfrt/common/create_pjrt_client_util.h"
 #include "tensorflow/core/tfrt/common/global_state.h"
 #include "tensorflow/core/tfrt/common/pjrt_util.h"
@@ -59,9 +63,42 @@ using XlaDeviceExecutablePersistor =
 using PjRtDeviceExecutablePersistor =
     DeviceExecutablePersistor<xla::PjRtLoadedExecutable, xla::PjRtClient>;
 
+// Returns the fingerprint of the TensorFlow version and of the device that
+// `local_client` compiles for, or 0 if there is no client.
+uint64 GetEnvironmentFingerprint(xla::LocalClient* local_client) {
+  if (local_client == nullptr) return 0;
+  const se::DeviceDescription& description =
+      local_client->backend().default_stream_executor()->GetDeviceDescription();
+  return Fingerprint64(absl::StrCat(
+      TF_VERSION_STRING, "/", local_client->platform()->Name(), "/",
+      description.name(), "/", description.platform_version()));
+}
+
+uint64 GetEnvironmentFingerprint(xla::PjRtClient* pjrt_client) {
+  if (pjrt_client == nullptr) return 0;
+  std::string environment =
+      absl::StrCat(TF_VERSION_STRING, "/", pjrt_client->platform_name(), "/",
+                   pjrt_client->platform_version());
+  if (!pjrt_client->addressable_devices().empty()) {
+    absl::StrAppend(&environment, "/",
+                    pjrt_client->addressable_devices()[0]->device_kind());
+  }
+  return Fingerprint64(environment);
+}
+
+template <typename Config>
+void SetPersistentCacheOptions(uint64 environment_fingerprint,
+                               Config* config) {
+  config->environment_fingerprint = environment_fingerprint;
+  config->asynchronous_writes =
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_async_writes;
+}
+
 XlaDeviceCompiler* CreateXlaDeviceCompiler(
-    const XlaDeviceExecutablePersistor::Config& persistor_config,
+    XlaDeviceExecutablePersistor::Config persistor_config,
     DeviceType compilation_device_type, xla::LocalClient* local_client) {
+  SetPersistentCacheOptions(GetEnvironmentFingerprint(local_client),
+                            &persistor_config);
   return new XlaDeviceCompiler(
       std::make_unique<XlaDeviceExecutablePersistor>(
           std::move(persistor_config), compilation_device_type),
@@ -78,6 +115,8 @@ PjRtDeviceCompiler* CreatePjRtDeviceCompiler(DeviceType compilation_device_type,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  SetPersistentCacheOptions(GetEnvironmentFingerprint(pjrt_client),
+                            &persistor_config);
 
   return new PjRtDeviceCompiler(
       std::make_unique<PjRtDeviceExecutablePersistor>(
@@ -39,7 +39,8 @@ namespace lite {
 
 TfLiteStatus SparsifyModel(const tflite::ModelT& input_model,
                            flatbuffers::FlatBufferBuilder* builder,
-                           tflite::ErrorReporter* error_reporter) {
+                           tflite::ErrorReporter* error_reporter,
+                           bool structured_sparsity) {
   MLIRContext context;
   StatusScopedDiagnosticHandler statusHandler(&context,
                                               /*propagate=*/true);
@@ -62,7 +63,7 @@ TfLiteStatus SparsifyModel(const tflite::ModelT& input_model,
   }
 
   PassManager pm((*module)->getName(), OpPassManager::Nesting::Implicit);
-  pm.addPass(TFL::CreateDenseToSparsePass());
+  pm.addPass(TFL::CreateDenseToSparsePass(structured_sparsity));
 
   if (failed(pm.run(module.get()))) {
     const std::string err(statusHandler.ConsumeStatus().message());
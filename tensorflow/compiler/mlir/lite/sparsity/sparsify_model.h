@@ -24,9 +24,12 @@ namespace mlir {
 namespace lite {
 
 // Sparsify the `input_model` and write the result to a flatbuffer `builder`.
+// With `structured_sparsity`, FullyConnected weights with 2:4 structured
+// sparsity are kept sparse instead of being densified.
 TfLiteStatus SparsifyModel(const tflite::ModelT& input_model,
                            flatbuffers::FlatBufferBuilder* builder,
-                           tflite::ErrorReporter* error_reporter);
+                           tflite::ErrorReporter* error_reporter,
+                           bool structured_sparsity = false);
 }  // namespace lite
 }  // namespace mlir
 
@@ -947,6 +947,34 @@ func.func @FoldMultpleTranspose(%arg0: tensor<1x4x1440x256xf32>) -> tensor<1x256
   // CHECK: return %0
 }
 
+// CHECK-LABEL: @FoldTransposePairAroundScalarMul
+func.func @FoldTransposePairAroundScalarMul(%arg0: tensor<1x8x16x32xf32>) -> tensor<1x8x16x32xf32> {
+  %perm0 = arith.constant dense<[0, 3, 1, 2]> : tensor<4xi32>
+  %perm1 = arith.constant dense<[0, 2, 3, 1]> : tensor<4xi32>
+  %cst = arith.constant dense<2.0> : tensor<f32>
+  %0 = "tfl.transpose"(%arg0, %perm0) : (tensor<1x8x16x32xf32>, tensor<4xi32>) -> tensor<1x32x8x16xf32>
+  %1 = "tfl.mul"(%0, %cst) {fused_activation_function = "NONE"} : (tensor<1x32x8x16xf32>, tensor<f32>) -> tensor<1x32x8x16xf32>
+  %2 = "tfl.tanh"(%1) : (tensor<1x32x8x16xf32>) -> tensor<1x32x8x16xf32>
+  %3 = "tfl.transpose"(%2, %perm1) : (tensor<1x32x8x16xf32>, tensor<4xi32>) -> tensor<1x8x16x32xf32>
+  func.return %3 : tensor<1x8x16x32xf32>
+  // CHECK-NOT: tfl.transpose
+  // CHECK: %[[MUL:.*]] = tfl.mul(%arg0, %{{.*}}) <{fused_activation_function = "NONE"}> : (tensor<1x8x16x32xf32>, tensor<f32>) -> tensor<1x8x16x32xf32>
+  // CHECK: %[[TANH:.*]] = "tfl.tanh"(%[[MUL]]) : (tensor<1x8x16x32xf32>) -> tensor<1x8x16x32xf32>
+  // CHECK-NOT: tfl.transpose
+  // CHECK: return %[[TANH]]
+}
+
+// CHECK-LABEL: @DontReorderTransposeAndNonScalarAdd
+func.func @DontReorderTransposeAndNonScalarAdd(%arg0: tensor<1x8x16x32xf32>) -> tensor<1x32x8x16xf32> {
+  %perm0 = arith.constant dense<[0, 3, 1, 2]> : tensor<4xi32>
+  %cst = arith.constant dense<1.0> : tensor<16xf32>
+  %0 = "tfl.transpose"(%arg0, %perm0) : (tensor<1x8x16x32xf32>, tensor<4xi32>) -> tensor<1x32x8x16xf32>
+  %1 = "tfl.add"(%0, %cst) {fused_activation_function = "NONE"} : (tensor<1x32x8x16xf32>, tensor<16xf32>) -> tensor<1x32x8x16xf32>
+  func.return %1 : tensor<1x32x8x16xf32>
+  // CHECK: %[[TRANSPOSE:.*]] = "tfl.transpose"(%arg0, %{{.*}})
+  // CHECK: tfl.add(%[[TRANSPOSE]], %{{.*}})
+}
+
 // CHECK-LABEL: @FuseFullyConnectedReshapeAddConstWithOptionalAttribute
 // FOLD-LABEL: @FuseFullyConnectedReshapeAddConstWithOptionalAttribute
 func.func @FuseFullyConnectedReshapeAddConstWithOptionalAttribute(%arg0: tensor<40x37xf32>, %arg1: tensor<40x37xf32>) -> tensor<40x40xf32> {
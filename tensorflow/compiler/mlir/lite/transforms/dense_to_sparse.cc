@@ -15,12 +15,15 @@ limitations under the License.
 
 // This transformation pass convert dense tensor to sparse format.
 
+#include <vector>
+
 #include "absl/memory/memory.h"
 #include "Eigen/Core"  // from @eigen_archive
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
 #include "mlir/IR/Attributes.h"  // from @llvm-project
 #include "mlir/IR/Builders.h"  // from @llvm-project
 #include "mlir/IR/BuiltinTypes.h"  // from @llvm-project
+#include "mlir/IR/TypeUtilities.h"  // from @llvm-project
 #include "mlir/Pass/Pass.h"  // from @llvm-project
 #include "mlir/Support/LLVM.h"  // from @llvm-project
 #include "tensorflow/compiler/mlir/lite/ir/tfl_ops.h"
@@ -160,6 +163,39 @@ float CalculateBlockSparsity(const ElementsAttr& attr, const ShapedType& type,
   return sparsity;
 }
 
+// Returns true if every group of 4 consecutive values along the last dimension
+// of a rank 2 weight has at most 2 non-zeros, i.e. the weight was pruned with
+// 2:4 structured sparsity.
+bool IsStructured2of4Sparse(const ElementsAttr& attr, const ShapedType& type) {
+  constexpr int kGroupSize = 4;
+  if (type.getRank() != 2 || type.getDimSize(1) % kGroupSize != 0) {
+    return false;
+  }
+
+  std::vector<bool> is_zero;
+  is_zero.reserve(type.getNumElements());
+  if (mlir::isa<FloatType>(type.getElementType())) {
+    for (const auto val : attr.getValues<APFloat>()) {
+      is_zero.push_back(val.isZero());
+    }
+  } else if (mlir::isa<quant::QuantizedType>(type.getElementType())) {
+    for (const auto val : attr.getValues<int8_t>()) {
+      is_zero.push_back(val == 0);
+    }
+  } else {
+    return false;
+  }
+
+  for (size_t i = 0; i < is_zero.size(); i += kGroupSize) {
+    int num_nonzeros = 0;
+    for (int j = 0; j < kGroupSize; j++) {
+      if (!is_zero[i + j]) num_nonzeros++;
+    }
+    if (num_nonzeros > 2) return false;
+  }
+  return true;
+}
+
 typedef struct InspectResult {
   // Whether the weight tensor is sparse enough to be compressed.
   bool can_compress;
@@ -174,7 +210,7 @@ typedef struct InspectResult {
 
 InspectResult InspectWeight(
     Operation* inst, const std::vector<std::vector<int>>& supported_block_size,
-    const float ratio_threshold) {
+    const float ratio_threshold, const bool supports_2of4) {
   ElementsAttr attr;
   ShapedType type;
   InspectResult result = {};
@@ -219,6 +255,13 @@ InspectResult InspectWeight(
     }
   }
 
+  // A weight with 2:4 structured sparsity is encoded with random sparsity, and
+  // the op runs it without falling back to dense execution.
+  if (result.needs_densify && supports_2of4 &&
+      IsStructured2of4Sparse(attr, type)) {
+    result.needs_densify = false;
+  }
+
   return result;
 }
 
@@ -280,6 +323,12 @@ std::vector<T> BuildSparsityParameterAttribute(
 
 struct DenseToSparsePass
     : public impl::DenseToSparsePassBase<DenseToSparsePass> {
+  using DenseToSparsePassBase::DenseToSparsePassBase;
+
+  explicit DenseToSparsePass(bool structured_sparsity) {
+    this->structured_sparsity_ = structured_sparsity;
+  }
+
   MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(DenseToSparsePass)
 
   void runOnOperation() override;
@@ -327,8 +376,17 @@ void DenseToSparsePass::runOnOperation() {
         continue;
       }
 
-      InspectResult result =
-          InspectWeight(inst, supported_block_size, ratio_threshold);
+      // The FullyConnected kernels run float weights, and int8 weights of
+      // fully quantized ops, with 2:4 structured sparsity.
+      const bool supports_2of4 =
+          structured_sparsity_ && op == sparse_op.getOperation() &&
+          isa<FullyConnectedOp>(op) &&
+          (isa<ConstOp>(inst)
+               ? type.getElementType().isF32()
+               : mlir::isa<quant::QuantizedType>(
+                     getElementTypeOrSelf(op->getOperand(0).getType())));
+      InspectResult result = InspectWeight(inst, supported_block_size,
+                                           ratio_threshold, supports_2of4);
       if (!result.can_compress) {
         continue;
       }
@@ -425,5 +483,10 @@ std::unique_ptr<OperationPass<func::FuncOp>> CreateDenseToSparsePass() {
   return std::make_unique<DenseToSparsePass>();
 }
 
+std::unique_ptr<OperationPass<func::FuncOp>> CreateDenseToSparsePass(
+    bool structured_sparsity) {
+  return std::make_unique<DenseToSparsePass>(structured_sparsity);
+}
+
 }  // namespace TFL
 }  // namespace mlir
@@ -171,6 +171,11 @@ std::unique_ptr<OperationPass<func::FuncOp>> CreateIdentifyDilatedConvPass();
 // tensor to sparse format.
 std::unique_ptr<OperationPass<func::FuncOp>> CreateDenseToSparsePass();
 
+// Same as above, but `structured_sparsity` keeps FullyConnected weights with
+// 2:4 structured sparsity sparse instead of densifying them.
+std::unique_ptr<OperationPass<func::FuncOp>> CreateDenseToSparsePass(
+    bool structured_sparsity);
+
 // Creates function pass to legalize TF While to TFL While.
 std::unique_ptr<OperationPass<ModuleOp>> CreateLegalizeTFWhilePass();
 
@@ -193,6 +193,14 @@ void EmitKernel(FunctionEmitterContext& function_context,
     arguments.push_back(id);
   }
 
+  // Results without any use are dead as soon as the kernel returns, so their
+  // registers can be reused by the following kernels right away instead of
+  // holding the values until the function returns.
+  for (auto result : op.getResults()) {
+    const auto& reg_info = function_context.register_table[result];
+    if (reg_info.num_uses == 0) function_context.FreeRegId(reg_info.id);
+  }
+
   constructor.construct_arguments(arguments.size())
       .Assign(arguments.begin(), arguments.end());
   constructor.construct_last_uses(last_uses.size())
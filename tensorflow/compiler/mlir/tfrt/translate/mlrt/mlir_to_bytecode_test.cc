@@ -95,6 +95,38 @@ TEST(MlirToByteCodeTest, Basic) {
   EXPECT_TRUE(kernels[10].results().empty());
 }
 
+TEST(MlirToByteCodeTest, DeadResults) {
+  constexpr char kDeadResultsMlir[] =
+      "tensorflow/compiler/mlir/tfrt/translate/mlrt/testdata/"
+      "dead_results.mlir";
+
+  mlir::DialectRegistry registry;
+  registry.insert<mlir::func::FuncDialect>();
+  mlir::MLIRContext mlir_context(registry);
+  mlir_context.allowUnregisteredDialects();
+  auto mlir_module = mlir::parseSourceFile<mlir::ModuleOp>(
+      tsl::GetDataDependencyFilepath(kDeadResultsMlir), &mlir_context);
+
+  AttributeEncoderRegistry attribute_encoder_registry;
+  bc::Buffer buffer =
+      EmitExecutable(attribute_encoder_registry, mlir_module.get()).value();
+
+  bc::Executable executable(buffer.data());
+  auto functions = executable.functions();
+  ASSERT_GE(functions.size(), 1);
+  auto function = functions[0];
+
+  // The registers of the unused results are reused by the following kernels,
+  // so only three registers are live at any time.
+  EXPECT_EQ(function.num_regs(), 3);
+  auto kernels = function.kernels();
+  ASSERT_EQ(kernels.size(), 4);
+  EXPECT_THAT(kernels[0].results(), ElementsAreArray({1, 2}));
+  EXPECT_THAT(kernels[1].results(), ElementsAreArray({2, 0}));
+  EXPECT_THAT(kernels[2].results(), ElementsAreArray({0, 1}));
+  EXPECT_THAT(kernels[3].arguments(), ElementsAreArray({0}));
+}
+
 template <typename T>
 absl::StatusOr<T> DecodeAttribute(absl::string_view data) {
   if (data.size() < sizeof(T))
@@ -0,0 +1,6 @@
+func.func @dead_results(%c0: i32) -> i32 {
+  %c1, %c2 = "test_mlbc.pair.i32"(%c0) : (i32) -> (i32, i32)
+  %c3, %c4 = "test_mlbc.pair.i32"(%c1) : (i32) -> (i32, i32)
+  %c5, %c6 = "test_mlbc.pair.i32"(%c3) : (i32) -> (i32, i32)
+  func.return %c5 : i32
+}
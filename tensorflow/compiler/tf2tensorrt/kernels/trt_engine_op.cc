@@ -16,6 +16,7 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph_to_functiondef.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -65,6 +67,10 @@ using ::nvinfer1::IRuntime;
 #define LOG_FIRST_FEW_WARNING_WITH_PREFIX \
   LOG_FIRST_N(WARNING, 5) << "TF-TRT Warning: "
 
+// Maximum number of engine rebuilds with learned optimization profiles per op,
+// which bounds the memory held by the replaced engines.
+constexpr int kMaxProfileRelearns = 4;
+
 // Allocates device memory for an execution context to execute a TensorRT
 // engine and records the relevant information for deallocating the memory when
 // the engine finishes execution.
@@ -140,6 +146,8 @@ class TRTEngineOp : public AsyncOpKernel {
  public:
   explicit TRTEngineOp(OpKernelConstruction* context);
 
+  ~TRTEngineOp() override;
+
   void ComputeAsync(OpKernelContext* context,
                     AsyncOpKernel::DoneCallback done) override;
 
@@ -160,8 +168,11 @@ class TRTEngineOp : public AsyncOpKernel {
   Status ImportSegmentGraphDef(FunctionLibraryRuntime* lib,
                                const string& device_name);
 
-  // Executes the native segment as function Op  asynchronously.
-  void ExecuteNativeSegment(OpKernelContext* ctx, AsyncHelper* async_helper);
+  // Executes the native segment as function Op  asynchronously. If
+  // `engine_build_fallback` is true, the execution time is recorded as time
+  // spent waiting for an engine that is built in the background.
+  void ExecuteNativeSegment(OpKernelContext* ctx, AsyncHelper* async_helper,
+                            bool engine_build_fallback = false);
 
   // Allocates the device memory for the execution context and enqueues the
   // TensorRT engine for execution. Also deallocates the device memory. Returns
@@ -183,10 +194,12 @@ class TRTEngineOp : public AsyncOpKernel {
   // If a cuda engine for the given input shapes can't be found, returns
   // (nullptr, 0) to allow native engine execution. Returns an error code for
   // any problem that would prevent both TensorRT engine exceution and native
-  // segment execution.
+  // segment execution. `engine_build_pending` is set to whether the missing
+  // engine is being built in the background.
   StatusOr<std::pair<EngineContext*, int>> GetEngine(
       const std::vector<TensorShape>& input_concrete_shapes,
-      OpKernelContext* ctx, TRTEngineCacheResource* cache_resource);
+      OpKernelContext* ctx, TRTEngineCacheResource* cache_resource,
+      bool* engine_build_pending);
 
   // Builds and returns a cuda engine for the input shapes. If building the
   // engine fails, enters a dummy entry into the cache_resource cache so we
@@ -196,6 +209,33 @@ class TRTEngineOp : public AsyncOpKernel {
       bool use_calibration, TRTInt8Calibrator* calibrator,
       TRTEngineCacheResource* cache_resource, OpKernelContext* ctx);
 
+  // Converts the segment to a cuda engine for the input shapes on the device
+  // named `device_name`. `ctx` is only used to read resource inputs and may be
+  // null if the op has none.
+  StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> ConvertSegmentToEngine(
+      const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+      bool use_calibration, TRTInt8Calibrator* calibrator,
+      TRTEngineCacheResource* cache_resource,
+      TrtShapeOptimizationProfile* profiles, OpKernelContext* ctx,
+      const string& device_name);
+
+  // Starts building the engine for the input shapes on a background thread,
+  // which adds it to the cache of `cache_resource` once it is built. If
+  // `learned_profiles` is set, the engine is built for these profiles and
+  // replaces the cached engine, and cache_resource->profiles_ adopts them.
+  void StartEngineBuild(
+      const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+      OpKernelContext* ctx, TRTEngineCacheResource* cache_resource,
+      std::unique_ptr<TrtShapeOptimizationProfile> learned_profiles = nullptr)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
+
+  // Records the input shapes for profile learning, and starts rebuilding the
+  // engine with profiles learned from the recorded shapes if the current
+  // profiles don't cover enough of them.
+  void MaybeRelearnProfiles(
+      const std::vector<TensorShape>& input_concrete_shapes,
+      OpKernelContext* ctx, TRTEngineCacheResource* cache_resource);
+
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
 
@@ -249,6 +289,27 @@ class TRTEngineOp : public AsyncOpKernel {
 
   int64 workspace_size_;
   mutex engine_mutex_;
+
+  // Whether to build the engines for new input shapes on a background thread
+  // and run the native segment until they are ready, instead of blocking the
+  // execution on the engine build.
+  bool async_engine_build_;
+
+  // Whether an engine is being built in the background. Builds are done one at
+  // a time, and the destructor waits for the current one since it uses the
+  // members of the op.
+  bool engine_build_in_progress_ TF_GUARDED_BY(engine_mutex_) = false;
+  condition_variable engine_build_cv_;
+
+  // Whether to learn the optimization profiles from the input shapes seen at
+  // runtime, and to rebuild the engine in the background when the shape
+  // distribution drifts out of the current profiles.
+  bool learn_profiles_;
+
+  // Number of engine rebuilds with learned profiles, bounded by
+  // kMaxProfileRelearns.
+  int num_profile_relearns_ TF_GUARDED_BY(engine_mutex_) = 0;
+
   FunctionLibraryRuntime::Handle native_execution_func_handle_;
 
   // The finalized calibrator for inference.
@@ -471,6 +532,15 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
   // When a TF-TRT converted model without native segments is loaded,
   // func_ can be empty.
   native_segment_absent_ = (func_.name() == "");
+
+  OP_REQUIRES_OK(context, ReadBoolFromEnvVar("TF_TRT_ASYNC_ENGINE_BUILD",
+                                             /*default_val=*/false,
+                                             &async_engine_build_));
+  // The conversion of segments with resource inputs reads the variables from
+  // the OpKernelContext, which is only alive on the execution path.
+  async_engine_build_ = async_engine_build_ && !native_segment_absent_ &&
+                        absl::c_all_of(input_mask_, [](bool m) { return m; });
+
   native_execution_func_handle_ = kInvalidHandle;
   if (!native_segment_absent_) {
     if (!static_engine_) {
@@ -550,6 +620,22 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
       [](PartialTensorShape shape) { return !shape.IsFullyDefined(); });
   VLOG(2) << "TRTEngineOp has_dynamic_shape_input_: "
           << has_dynamic_shape_input_;
+
+  OP_REQUIRES_OK(context, ReadBoolFromEnvVar("TF_TRT_LEARN_PROFILES",
+                                             /*default_val=*/false,
+                                             &learn_profiles_));
+  // Learned profiles are built like any other engine in the background, which
+  // also provides the native segment fallback for the uncovered shapes.
+  learn_profiles_ = learn_profiles_ && async_engine_build_ &&
+                    !use_implicit_batch_ && !static_engine_ &&
+                    has_dynamic_shape_input_;
+}
+
+TRTEngineOp::~TRTEngineOp() {
+  mutex_lock lock(engine_mutex_);
+  while (engine_build_in_progress_) {
+    engine_build_cv_.wait(lock);
+  }
 }
 
 // Copies input tensor ctx->input(i) (which is in device memory) to the host,
@@ -594,7 +680,8 @@ Status CopyToDeviceAsync(OpKernelContext* ctx, const Tensor& native_tensor,
 }
 
 void TRTEngineOp::ExecuteNativeSegment(OpKernelContext* ctx,
-                                       AsyncHelper* async_helper) {
+                                       AsyncHelper* async_helper,
+                                       bool engine_build_fallback) {
   tensorflow::profiler::TraceMe activity(
       "TRTEngineOp::ExecuteNativeSegment",
       tensorflow::profiler::TraceMeLevel::kInfo);
@@ -637,12 +724,18 @@ void TRTEngineOp::ExecuteNativeSegment(OpKernelContext* ctx,
   // segment finishes execution asynchronously, we decrement the reference
   // count of the object.
   async_helper->Ref();
+  const uint64 start_time_usecs = Env::Default()->NowMicros();
   lib->Run(
       opts, native_execution_func_handle_, native_inputs, native_outputs,
-      [this, ctx, native_outputs, async_helper, stream](const Status& s) {
+      [this, ctx, native_outputs, async_helper, stream, engine_build_fallback,
+       start_time_usecs](const Status& s) {
         core::ScopedUnref sc(async_helper);
         DummyAsyncHelper dummy_async_helper;
         std::unique_ptr<std::vector<Tensor>> outputs_wrapper(native_outputs);
+        if (engine_build_fallback) {
+          metrics::UpdateTfTrtEngineBuildFallbackTime(
+              Env::Default()->NowMicros() - start_time_usecs);
+        }
         OP_REQUIRES_OK_ASYNC(ctx, s, dummy_async_helper);
         VLOG(1) << "Native Segment completed";
         int n_copies = 0;
@@ -929,8 +1022,13 @@ void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
     return;
   }
 
+  if (learn_profiles_) {
+    MaybeRelearnProfiles(input_concrete_shapes, ctx, cache_res);
+  }
+
+  bool engine_build_pending = false;
   StatusOr<std::pair<EngineContext*, int>> status =
-      GetEngine(input_concrete_shapes, ctx, cache_res);
+      GetEngine(input_concrete_shapes, ctx, cache_res, &engine_build_pending);
   OP_REQUIRES_OK_ASYNC(ctx, status.status(), dummy_async_helper);
 
   EngineContext* engine_context = status.value().first;
@@ -948,6 +1046,16 @@ void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
     }
     return true;
   };
+  if (!engine_context->GetCudaEngine() && engine_build_pending) {
+    VLOG(1) << "Running native segment for " << name()
+            << " while its engine for input shapes: "
+            << TensorShapeUtils::ShapeListString(input_concrete_shapes)
+            << " is built";
+    if (may_execute_native_segment()) {
+      ExecuteNativeSegment(ctx, async_helper, /*engine_build_fallback=*/true);
+    }
+    return;
+  }
   if (!engine_context->GetCudaEngine()) {
     LOG_FIRST_FEW_WARNING_WITH_PREFIX
         << "Engine retrieval for input shapes: "
@@ -1088,14 +1196,35 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
     const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
     bool use_calibration, TRTInt8Calibrator* calibrator,
     TRTEngineCacheResource* cache_resource, OpKernelContext* ctx) {
+  TRT_ENSURE(cache_resource);
+  TRT_ENSURE(ctx);
+  auto result = ConvertSegmentToEngine(
+      input_concrete_shapes, batch_size, use_calibration, calibrator,
+      cache_resource, &cache_resource->profiles_, ctx, ctx->device()->name());
+  if (!result.ok()) {
+    // Store an empty engine in the cache for these input shapes so we don't try
+    // to build the same failing engine again.
+    cache_resource->cache_.emplace(input_concrete_shapes,
+                                   std::make_unique<EngineContext>());
+  }
+  return result;
+}
+
+StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>>
+TRTEngineOp::ConvertSegmentToEngine(
+    const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+    bool use_calibration, TRTInt8Calibrator* calibrator,
+    TRTEngineCacheResource* cache_resource,
+    TrtShapeOptimizationProfile* profiles, OpKernelContext* ctx,
+    const string& device_name) {
   tensorflow::profiler::TraceMe activity(
       "TRTEngineOp::BuildEngine", tensorflow::profiler::TraceMeLevel::kInfo);
   TRT_ENSURE(cache_resource);
-  TRT_ENSURE(ctx);
+  TRT_ENSURE(profiles);
   // Use concrete shapes for implicit batch mode and partial shapes for
   // explicit batch mode.
   bool use_concrete_shapes =
-      use_implicit_batch_ || cache_resource->profiles_.IsStaticCompatible();
+      use_implicit_batch_ || profiles->IsStaticCompatible();
   const std::vector<PartialTensorShape>& conversion_input_shapes =
       use_concrete_shapes
           ? std::vector<PartialTensorShape>(input_concrete_shapes.begin(),
@@ -1107,9 +1236,8 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
 
   std::unordered_map<string, tensorflow::DeviceProperties> device_map;
   DeviceNameUtils::ParsedName full_parsed_name;
-  DeviceNameUtils::ParseFullName(ctx->device()->name(), &full_parsed_name);
-  device_map.emplace(ctx->device()->name(),
-                     grappler::GetDeviceInfo(full_parsed_name));
+  DeviceNameUtils::ParseFullName(device_name, &full_parsed_name);
+  device_map.emplace(device_name, grappler::GetDeviceInfo(full_parsed_name));
   tensorflow::grappler::VirtualCluster cluster(device_map);
 
   TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
@@ -1117,25 +1245,129 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
       segment_graph_def_, ctx, precision_mode_, batch_size, workspace_size_,
       conversion_input_shapes, &logger, cache_resource->allocator_.get(),
       calibrator, &engine, use_calibration, use_implicit_batch_, nullptr,
-      &cache_resource->profiles_, name(), use_explicit_precision_, &cluster,
-      ctx->device()->name());
+      profiles, name(), use_explicit_precision_, &cluster, device_name);
   if (!status.ok()) {
     LOG_FIRST_FEW_WARNING_WITH_PREFIX
         << "Engine creation for " << name() << " failed. "
         << "The native segment will be used instead. "
         << "Reason: " << status;
-    // Store an empty engine in the cache for these input shapes so we don't try
-    // to build the same failing engine again.
-    cache_resource->cache_.emplace(input_concrete_shapes,
-                                   std::make_unique<EngineContext>());
     return status;
   }
   return engine;
 }
 
+void TRTEngineOp::StartEngineBuild(
+    const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+    OpKernelContext* ctx, TRTEngineCacheResource* cache_resource,
+    std::unique_ptr<TrtShapeOptimizationProfile> learned_profiles) {
+  engine_build_in_progress_ = true;
+  cache_resource->Ref();
+  const string device_name = ctx->device()->name();
+  const int platform_device_id =
+      ctx->device()->tensorflow_accelerator_device_info()->gpu_id;
+  VLOG(1) << "Building the engine of " << name() << " for input shapes: "
+          << TensorShapeUtils::ShapeListString(input_concrete_shapes)
+          << " in the background";
+  ctx->env()->SchedClosure([this, input_concrete_shapes, batch_size,
+                            cache_resource, device_name, platform_device_id,
+                            learned_profiles =
+                                std::move(learned_profiles)]() mutable {
+    core::ScopedUnref sc(cache_resource);
+    if (cudaSetDevice(platform_device_id) != cudaSuccess) {
+      LOG(ERROR) << "Couldn't set cuda device to " << platform_device_id
+                 << " in engine build thread";
+    }
+    // Up to this point, calibrator_ can never be empty, since otherwise it
+    // means calibration_mode_ is true and this path won't get executed.
+    auto result = ConvertSegmentToEngine(
+        input_concrete_shapes, batch_size, use_calibration_, calibrator_.get(),
+        cache_resource,
+        learned_profiles ? learned_profiles.get() : &cache_resource->profiles_,
+        /*ctx=*/nullptr, device_name);
+
+    mutex_lock lock(engine_mutex_);
+    Status status = result.status();
+    if (status.ok()) {
+      TrtUniquePtrType<nvinfer1::ICudaEngine> engine =
+          std::move(result.value());
+      std::vector<ExecutionContext> exec_contexts;
+      TrtShapeOptimizationProfile& profiles =
+          learned_profiles ? *learned_profiles : cache_resource->profiles_;
+      status = profiles.CreateExecutionContexts(engine.get(), &exec_contexts);
+      if (status.ok() && learned_profiles) {
+        // In explicit batch mode the cache holds a single engine, which is
+        // replaced by the new one.
+        auto& cache = cache_resource->cache_;
+        while (cache.begin() != cache.end()) {
+          const std::vector<TensorShape> key = cache.begin()->first;
+          cache_resource->retired_engines_.push_back(
+              std::move(cache.begin()->second));
+          cache.erase(key);
+        }
+        cache_resource->profiles_.AdoptProfiles(*learned_profiles);
+        VLOG(1) << "Replaced the engine of " << name()
+                << " with an engine for "
+                << cache_resource->profiles_.GetNumProfiles()
+                << " learned optimization profile(s)";
+      }
+      if (status.ok()) {
+        cache_resource->cache_.emplace(
+            input_concrete_shapes,
+            std::make_unique<EngineContext>(std::move(engine),
+                                            std::move(exec_contexts)));
+        VLOG(1) << "Added new engine to cache of " << name()
+                << ". Cache size: " << cache_resource->cache_.size();
+      }
+    }
+    if (!status.ok() && learned_profiles) {
+      // Keep using the current engine.
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX
+          << "Building the engine with learned optimization profiles for "
+          << name() << " failed: " << status;
+    } else if (!status.ok()) {
+      // Store an empty engine in the cache for these input shapes so we don't
+      // try to build the same failing engine again.
+      cache_resource->cache_.emplace(input_concrete_shapes,
+                                     std::make_unique<EngineContext>());
+    }
+    engine_build_in_progress_ = false;
+    engine_build_cv_.notify_all();
+  });
+}
+
+void TRTEngineOp::MaybeRelearnProfiles(
+    const std::vector<TensorShape>& input_concrete_shapes,
+    OpKernelContext* ctx, TRTEngineCacheResource* cache_resource) {
+  mutex_lock lock(engine_mutex_);
+  // Profiles are only learned once the first engine is built, which sets the
+  // shape tensor mask the recorded shapes depend on.
+  if (cache_resource->cache_.size() == 0) return;
+  TrtShapeOptimizationProfile& profiles = cache_resource->profiles_;
+  profiles.RecordShape(input_concrete_shapes);
+  if (!profiles.ShouldRelearnProfiles() || engine_build_in_progress_ ||
+      num_profile_relearns_ >= kMaxProfileRelearns) {
+    return;
+  }
+  auto learned_profiles =
+      std::make_unique<TrtShapeOptimizationProfile>(profiles);
+  Status status = learned_profiles->LearnProfiles(input_partial_shapes_);
+  if (!status.ok()) {
+    VLOG(1) << "Could not learn optimization profiles for " << name() << ": "
+            << status;
+    return;
+  }
+  num_profile_relearns_++;
+  VLOG(1) << "Rebuilding the engine of " << name()
+          << " with learned optimization profiles";
+  // The batch size is not used in explicit batch mode.
+  const int batch_size = input_concrete_shapes[0].dim_size(0);
+  StartEngineBuild(input_concrete_shapes, batch_size, ctx, cache_resource,
+                   std::move(learned_profiles));
+}
+
 StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     const std::vector<TensorShape>& input_concrete_shapes, OpKernelContext* ctx,
-    TRTEngineCacheResource* cache_res) {
+    TRTEngineCacheResource* cache_res, bool* engine_build_pending) {
   tensorflow::profiler::TraceMe activity(
       "TRTEngineOp::GetEngine", tensorflow::profiler::TraceMeLevel::kInfo);
   static EngineContext empty_context;
@@ -1290,6 +1522,16 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
 
+    if (async_engine_build_ && AllowEngineNativeSegmentExecution()) {
+      // Only one engine is built at a time; inputs of other shapes run the
+      // native segment meanwhile and start their build once it is done.
+      if (!engine_build_in_progress_) {
+        StartEngineBuild(input_concrete_shapes, batch_size, ctx, cache_res);
+      }
+      *engine_build_pending = true;
+      return std::pair<EngineContext*, int>(&empty_context, 0);
+    }
+
     // Up to this point, calibrator_ can never be empty, since otherwise it
     // means calibration_mode_ is true and this path won't get executed.
     auto result =
@@ -283,6 +283,35 @@ TEST_F(TRTEngineOpTestBase, AllowBuildAtRuntime) {
   EXPECT_EQ(ectx->GetCudaEngine(), nullptr);
 }
 
+TEST_F(TRTEngineOpTestBase, AsyncEngineBuild) {
+  setenv("TF_TRT_ASYNC_ENGINE_BUILD", "1", /*overwrite=*/1);
+  TRTEngineOpTestBase::AddSimpleTrtOp(DT_FLOAT, /*max_cached_engines_count=*/1);
+  unsetenv("TF_TRT_ASYNC_ENGINE_BUILD");
+
+  // The first execution runs the native segment while the engine is built.
+  TensorShape input_shape({2, 2});
+  TRTEngineOpTestBase::AddSimpleInput<float>(input_shape);
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+  Tensor* output = OpsTestBase::GetOutput(0);
+  EXPECT_THAT(absl::Span<const float>(output->flat<float>().data(),
+                                      output->NumElements()),
+              ElementsAre(0.0f, 2.0f, 4.0f, 6.0f));
+
+  // Get the engine cache.
+  TRTEngineCacheResource* cache_resource = nullptr;
+  TF_ASSERT_OK(device_->resource_manager()->Lookup(
+      std::string(kTfTrtContainerName), std::string(kOpName), &cache_resource));
+  core::ScopedUnref sc(cache_resource);
+
+  // Destroying the op waits for the engine build to finish.
+  kernel_.reset();
+  auto cache = &cache_resource->cache_;
+  EXPECT_EQ(1, cache->size());
+  ASSERT_EQ(1, cache->count({input_shape}));
+  EngineContext* ectx = cache->at({input_shape}).get();
+  EXPECT_NE(ectx->GetCudaEngine(), nullptr);
+}
+
 TEST_P(TRTEngineOpTestWithParam, ExplicitBatch) {
   // Test inference in explicit batch mode with static input shapes. Static
   // shapes in this context means that the TensorRT knows all the input shapes
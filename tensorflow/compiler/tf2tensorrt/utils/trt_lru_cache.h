@@ -68,6 +68,14 @@ class LRUCache {
   iterator begin() { return objects_.begin(); }
   iterator end() { return objects_.end(); }
 
+  // Removes the object with the given key, returns the number of removed
+  // objects.
+  size_t erase(const key_type& key) {
+    if (objects_.erase(key) == 0) return 0;
+    keys_.erase(std::find(keys_.begin(), keys_.end(), key));
+    return 1;
+  }
+
   template <typename... Args>
   std::pair<iterator, bool> emplace(Args&&... args) {
     DiscardOld(1);
@@ -243,6 +251,11 @@ class TRTEngineCacheResource : public ResourceBase {
            VectorTensorShapeHasher>
       cache_;
 
+  // Engines that were replaced in cache_ by an engine with learned optimization
+  // profiles. Other executions may still be running them, so they are kept
+  // until the resource is destroyed.
+  std::vector<std::unique_ptr<EngineContext>> retired_engines_;
+
   // TODO(hinsu): Use different calibration context for the available shapes and
   // attach it to each item of the cache.
   std::unique_ptr<CalibrationContext> calib_ctx_;
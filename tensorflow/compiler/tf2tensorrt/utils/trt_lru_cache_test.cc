@@ -53,5 +53,25 @@ TEST(LRUCacheTest, Basic) {
   EXPECT_EQ(cache.count(40), 1);
 }
 
+TEST(LRUCacheTest, Erase) {
+  LRUCache<int, int, std::hash<int>> cache;
+  cache.reserve(2);
+  cache.emplace(10, 100);
+  cache.emplace(20, 200);
+  EXPECT_EQ(cache.erase(10), 1);
+  EXPECT_EQ(cache.erase(10), 0);
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_EQ(cache.count(10), 0);
+  // Insert 30 without evicting 20.
+  cache.emplace(30, 300);
+  EXPECT_EQ(cache.count(20), 1);
+  EXPECT_EQ(cache.count(30), 1);
+  // Insert 40, evicting 20.
+  cache.emplace(40, 400);
+  EXPECT_EQ(cache.count(20), 0);
+  EXPECT_EQ(cache.count(30), 1);
+  EXPECT_EQ(cache.count(40), 1);
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <limits>
 
 #include "absl/algorithm/container.h"
 #include "tensorflow/compiler/tf2tensorrt/common/utils.h"
@@ -313,6 +314,11 @@ void TrtShapeOptimizationProfile::InitProfiles(
       OptimalStrategy(collected_shapes);
       break;
   }
+  EnforceProfileCompatibility(input_partial_shapes);
+}
+
+void TrtShapeOptimizationProfile::EnforceProfileCompatibility(
+    const std::vector<PartialTensorShape>& input_partial_shapes) {
   // Define a mask that describe which input could be a shape tensor. Note
   // that here we can have false positives. The shape tensor mask will be
   // updated once the network is constructed.
@@ -333,6 +339,219 @@ void TrtShapeOptimizationProfile::InitProfiles(
   }
 }
 
+// Returns the number of elements of the input tensors described by dimvec.
+// Shape values are not counted.
+int64_t Volume(const std::vector<nvinfer1::Dims>& dimvec) {
+  int64_t volume = 0;
+  for (int i = 0; i < dimvec.size() / 2; i++) {
+    int64_t n = 1;
+    for (int j = 0; j < dimvec[i].nbDims; j++) n *= dimvec[i].d[j];
+    volume += n;
+  }
+  return volume;
+}
+
+// Checks whether the [min, max] range of prof includes dimvec.
+bool ProfileIncludes(const OptimizationProfileConfig& prof,
+                     const std::vector<nvinfer1::Dims>& dimvec,
+                     const std::vector<bool>& is_pruned_input) {
+  if (prof.min.size() != dimvec.size()) return false;
+  const int n_inputs = dimvec.size() / 2;
+  for (int i = 0; i < dimvec.size(); i++) {
+    if (i % n_inputs < is_pruned_input.size() &&
+        is_pruned_input[i % n_inputs]) {
+      continue;
+    }
+    if (prof.min[i].nbDims != dimvec[i].nbDims) return false;
+    for (int j = 0; j < dimvec[i].nbDims; j++) {
+      if (prof.min[i].d[j] > dimvec[i].d[j] ||
+          prof.max[i].d[j] < dimvec[i].d[j]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+StatusOr<std::vector<OptimizationProfileConfig>> LearnProfilesFromHistogram(
+    const ShapeHistogram& histogram, int max_profiles, double coverage) {
+  std::vector<OptimizationProfileConfig> profiles;
+  if (histogram.empty() || max_profiles < 1) return profiles;
+
+  // Keep the most frequent shapes until they cover the requested share of the
+  // traffic, the rest is left to the native segment.
+  ShapeHistogram shapes = histogram;
+  std::stable_sort(shapes.begin(), shapes.end(),
+                   [](const auto& a, const auto& b) {
+                     return a.second > b.second;
+                   });
+  int64_t total = 0;
+  for (const auto& entry : shapes) total += entry.second;
+  int64_t covered = 0;
+  int n = 0;
+  while (n < shapes.size() && covered < coverage * total) {
+    covered += shapes[n++].second;
+  }
+  shapes.resize(n);
+
+  // Shapes that are close in volume are grouped into the same profile.
+  std::stable_sort(shapes.begin(), shapes.end(),
+                   [](const auto& a, const auto& b) {
+                     return Volume(a.first) < Volume(b.first);
+                   });
+
+  // cost[i][j]: elements wasted by padding each shape of the group [i, j] to
+  // the max of the group, weighted by the shape counts.
+  std::vector<std::vector<double>> cost(n, std::vector<double>(n, 0));
+  for (int i = 0; i < n; i++) {
+    std::vector<nvinfer1::Dims> max = shapes[i].first;
+    for (int j = i; j < n; j++) {
+      TF_RETURN_IF_ERROR(
+          ShapeProfileBinaryOp(&max, shapes[j].first,
+                               [](int a, int b) { return std::max(a, b); }));
+      const int64_t max_volume = Volume(max);
+      for (int k = i; k <= j; k++) {
+        cost[i][j] += static_cast<double>(shapes[k].second) *
+                      (max_volume - Volume(shapes[k].first));
+      }
+    }
+  }
+
+  // best[k][j]: least cost of splitting the first j shapes into k groups.
+  const int k_max = std::min(max_profiles, n);
+  const double inf = std::numeric_limits<double>::infinity();
+  std::vector<std::vector<double>> best(k_max + 1,
+                                        std::vector<double>(n + 1, inf));
+  std::vector<std::vector<int>> split(k_max + 1, std::vector<int>(n + 1, 0));
+  best[0][0] = 0;
+  for (int k = 1; k <= k_max; k++) {
+    for (int j = 1; j <= n; j++) {
+      for (int i = k - 1; i < j; i++) {
+        if (best[k - 1][i] + cost[i][j - 1] < best[k][j]) {
+          best[k][j] = best[k - 1][i] + cost[i][j - 1];
+          split[k][j] = i;
+        }
+      }
+    }
+  }
+  int k_best = 1;
+  for (int k = 2; k <= k_max; k++) {
+    if (best[k][n] < best[k_best][n]) k_best = k;
+  }
+
+  // Create a profile for each group, optimized for its most frequent shape.
+  std::vector<std::pair<int64_t, OptimizationProfileConfig>> groups;
+  for (int k = k_best, j = n; k > 0; j = split[k--][j]) {
+    const int i = split[k][j];
+    std::vector<nvinfer1::Dims> min = shapes[i].first;
+    std::vector<nvinfer1::Dims> max = min;
+    int opt = i;
+    int64_t count = 0;
+    for (int m = i; m < j; m++) {
+      TF_RETURN_IF_ERROR(
+          ShapeProfileBinaryOp(&min, shapes[m].first,
+                               [](int a, int b) { return std::min(a, b); }));
+      TF_RETURN_IF_ERROR(
+          ShapeProfileBinaryOp(&max, shapes[m].first,
+                               [](int a, int b) { return std::max(a, b); }));
+      if (shapes[m].second > shapes[opt].second) opt = m;
+      count += shapes[m].second;
+    }
+    groups.push_back({count, {min, shapes[opt].first, max}});
+  }
+  std::stable_sort(groups.begin(), groups.end(),
+                   [](const auto& a, const auto& b) {
+                     return a.first > b.first;
+                   });
+  for (auto& group : groups) {
+    VLOG(2) << "Learned optimization profile " << group.second.DebugString()
+            << " for " << group.first << " recorded calls";
+    profiles.push_back(std::move(group.second));
+  }
+  return profiles;
+}
+
+std::vector<nvinfer1::Dims> TrtShapeOptimizationProfile::GetDimsAndShapeValues(
+    const std::vector<TensorShape>& shapes) {
+  std::vector<nvinfer1::Dims> dimvec = GetDimVec(shapes);
+  for (int i = 0; i < shapes.size(); i++) {
+    if (i < actual_shape_values_.size() && i < is_shape_tensor_.size() &&
+        is_shape_tensor_[i]) {
+      dimvec.push_back(actual_shape_values_[i]);
+    } else {
+      dimvec.push_back(nvinfer1::Dims{0, {}});
+    }
+  }
+  return dimvec;
+}
+
+void TrtShapeOptimizationProfile::RecordShape(
+    const std::vector<TensorShape>& shapes) {
+  std::vector<nvinfer1::Dims> dimvec = GetDimsAndShapeValues(shapes);
+  num_recorded_since_check_++;
+  for (auto& entry : recorded_shapes_) {
+    if (AlreadyCollected({entry.first}, dimvec)) {
+      entry.second++;
+      return;
+    }
+  }
+  if (recorded_shapes_.size() < kMaxRecordedShapes) {
+    recorded_shapes_.push_back({std::move(dimvec), 1});
+  }
+}
+
+bool TrtShapeOptimizationProfile::ShouldRelearnProfiles() {
+  if (num_recorded_since_check_ < kProfileLearningInterval) return false;
+  num_recorded_since_check_ = 0;
+  int64_t total = 0;
+  int64_t uncovered = 0;
+  for (const auto& entry : recorded_shapes_) {
+    total += entry.second;
+    if (!absl::c_any_of(profiles_, [&](const OptimizationProfileConfig& p) {
+          return ProfileIncludes(p, entry.first, is_pruned_input_);
+        })) {
+      uncovered += entry.second;
+    }
+  }
+  VLOG(2) << uncovered << " of " << total
+          << " recorded calls are not covered by the optimization profiles";
+  // Decay the recorded counts, so that old traffic is gradually forgotten.
+  for (auto& entry : recorded_shapes_) entry.second /= 2;
+  recorded_shapes_.erase(
+      std::remove_if(recorded_shapes_.begin(), recorded_shapes_.end(),
+                     [](const auto& entry) { return entry.second == 0; }),
+      recorded_shapes_.end());
+  return uncovered > (1 - kLearnedProfileCoverage) * total;
+}
+
+Status TrtShapeOptimizationProfile::LearnProfiles(
+    const std::vector<PartialTensorShape>& input_partial_shapes) {
+  TF_ASSIGN_OR_RETURN(
+      std::vector<OptimizationProfileConfig> profiles,
+      LearnProfilesFromHistogram(recorded_shapes_, kMaxLearnedProfiles,
+                                 kLearnedProfileCoverage));
+  if (profiles.empty()) {
+    return errors::FailedPrecondition("No shapes recorded for the profiles");
+  }
+  VLOG(1) << "Learned " << profiles.size()
+          << " optimization profile(s) from the recorded shapes";
+  profiles_ = std::move(profiles);
+  // The learned profiles are ranges, the engine cannot be static.
+  strategy_ = ProfileStrategy::kRangeOptimal;
+  EnforceProfileCompatibility(input_partial_shapes);
+  return OkStatus();
+}
+
+void TrtShapeOptimizationProfile::AdoptProfiles(
+    const TrtShapeOptimizationProfile& other) {
+  profiles_ = other.profiles_;
+  strategy_ = other.strategy_;
+  has_shape_tensor_ = other.has_shape_tensor_;
+  need_profiles_ = other.need_profiles_;
+  is_shape_tensor_ = other.is_shape_tensor_;
+  is_pruned_input_ = other.is_pruned_input_;
+}
+
 void TrtShapeOptimizationProfile::InitCalibProfile(
     const std::vector<TensorShape>& shapes) {
   VLOG(1) << "Collected shape(s) " << DebugString(shapes) << " for "
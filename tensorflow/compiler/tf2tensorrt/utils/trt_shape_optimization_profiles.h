@@ -19,6 +19,7 @@ limitations under the License.
 #include <list>
 #include <string>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/compiler/tf2tensorrt/common/datavec.h"
@@ -192,6 +193,36 @@ struct OptimizationProfileConfig {
   }
 };
 
+// Parameters of online profile learning, see
+// TrtShapeOptimizationProfile::RecordShape.
+//
+// Maximum number of profiles learned from the recorded shapes.
+constexpr int kMaxLearnedProfiles = 4;
+// Share of the recorded traffic that the learned profiles have to cover. The
+// rarest shapes beyond it run the native segment.
+constexpr double kLearnedProfileCoverage = 0.95;
+// Number of inference calls between two checks of the profiles against the
+// recorded shapes.
+constexpr int kProfileLearningInterval = 1000;
+// Maximum number of distinct shapes in the histogram of recorded shapes.
+constexpr int kMaxRecordedShapes = 64;
+
+// Counts of the distinct input shapes seen in inference calls. Each entry
+// holds the input dims followed by the input shape values, like the dims of
+// an OptimizationProfileConfig.
+using ShapeHistogram =
+    std::vector<std::pair<std::vector<nvinfer1::Dims>, int64_t>>;
+
+// Chooses at most `max_profiles` optimization profiles for the shapes of
+// `histogram`. The most frequent shapes that together account for a
+// `coverage` share of the counts are grouped into ranges so that padding each
+// shape to the max of its range would waste the fewest elements. Each profile
+// spans the min and max of its group and is optimized for its most frequent
+// shape. Profiles are ordered by decreasing traffic. Returns an error if the
+// shapes have different ranks.
+StatusOr<std::vector<OptimizationProfileConfig>> LearnProfilesFromHistogram(
+    const ShapeHistogram& histogram, int max_profiles, double coverage);
+
 // Manages Optimization profiles during TRT Engine construction.
 //
 // An optimization profile describes a range of dimensions for each TRT network
@@ -269,6 +300,28 @@ class TrtShapeOptimizationProfile {
 
   void SetShapeTensorMask(const nvinfer1::INetworkDefinition* network);
 
+  // Online profile learning. Counts the input shapes of an inference call,
+  // together with the shape values collected by CollectShapeValues, in a
+  // histogram of at most kMaxRecordedShapes distinct entries.
+  void RecordShape(const std::vector<TensorShape>& shapes);
+
+  // Returns true once every kProfileLearningInterval recorded shapes if more
+  // than 1 - kLearnedProfileCoverage of the recorded traffic doesn't fit the
+  // current profiles. Every check halves the recorded counts, so that the
+  // histogram follows changes of the shape distribution.
+  bool ShouldRelearnProfiles();
+
+  // Replaces the profiles with the ones that LearnProfilesFromHistogram
+  // chooses for the recorded shapes. The engine has to be rebuilt to use them.
+  Status LearnProfiles(
+      const std::vector<PartialTensorShape>& input_partial_shapes);
+
+  // Takes over the profiles of `other`, which were learned from a copy of this
+  // object and used to build a new engine, along with the shape tensor and
+  // pruned input masks of that engine. The recorded shapes and the shape values
+  // of the current inference call are kept.
+  void AdoptProfiles(const TrtShapeOptimizationProfile& other);
+
   // Whether the optimization profiles describe input that can be handled with
   // a static engine (only 1 profile with min=max).
   bool IsStaticCompatible() {
@@ -324,11 +377,25 @@ class TrtShapeOptimizationProfile {
   // Optimization profile generation strategy.
   ProfileStrategy strategy_;
 
+  // Shapes recorded for online profile learning.
+  ShapeHistogram recorded_shapes_;
+
+  // Number of shapes recorded since the last ShouldRelearnProfiles check.
+  int num_recorded_since_check_ = 0;
+
   // Adds optimization profiles to the builder config.
   Status AddProfiles(nvinfer1::IBuilder* builder,
                      nvinfer1::IBuilderConfig* config,
                      const nvinfer1::INetworkDefinition* network);
 
+  // Makes profiles_ compatible with the network inputs.
+  void EnforceProfileCompatibility(
+      const std::vector<PartialTensorShape>& input_partial_shapes);
+
+  // Returns the input dims and the current shape values as a single vector.
+  std::vector<nvinfer1::Dims> GetDimsAndShapeValues(
+      const std::vector<TensorShape>& shapes);
+
   void SetShapeTensorMask(const nvinfer1::ICudaEngine* engine, int n_inputs);
   void SetShapeTensorMask(
       const std::vector<PartialTensorShape>& input_partial_shapes);
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <string.h>
 
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -25,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "third_party/tensorrt/NvInfer.h"
 
@@ -250,6 +252,42 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   CheckProfile(unseen_shapes, &profile, has_prof, false);
 }
 
+TEST(LearnProfilesFromHistogramTest, GroupsFrequentShapes) {
+  // Single input of shape [batch, 8], which is not a shape tensor.
+  auto entry = [](int batch, int64_t count) {
+    nvinfer1::Dims dims{2, {batch, 8}};
+    return std::make_pair(std::vector<nvinfer1::Dims>{dims, {0, {}}}, count);
+  };
+  // The rare batch size 128 is left to the native segment.
+  ShapeHistogram histogram = {entry(32, 300), entry(1, 500), entry(128, 5),
+                              entry(2, 400), entry(33, 200)};
+  StatusOr<std::vector<OptimizationProfileConfig>> profiles =
+      LearnProfilesFromHistogram(histogram, /*max_profiles=*/2,
+                                 /*coverage=*/0.95);
+  TF_ASSERT_OK(profiles.status());
+  ASSERT_EQ(2, profiles->size());
+  // Profiles are ordered by traffic.
+  const OptimizationProfileConfig& small = profiles->at(0);
+  EXPECT_EQ(1, small.min[0].d[0]);
+  EXPECT_EQ(1, small.opt[0].d[0]);
+  EXPECT_EQ(2, small.max[0].d[0]);
+  const OptimizationProfileConfig& large = profiles->at(1);
+  EXPECT_EQ(32, large.min[0].d[0]);
+  EXPECT_EQ(32, large.opt[0].d[0]);
+  EXPECT_EQ(33, large.max[0].d[0]);
+  for (const OptimizationProfileConfig& prof : *profiles) {
+    EXPECT_EQ(8, prof.min[0].d[1]);
+    EXPECT_EQ(8, prof.max[0].d[1]);
+  }
+
+  // Shapes of different ranks cannot share a profile.
+  nvinfer1::Dims rank3{3, {1, 8, 8}};
+  histogram.push_back({{rank3, {0, {}}}, 1000});
+  EXPECT_FALSE(LearnProfilesFromHistogram(histogram, /*max_profiles=*/1,
+                                          /*coverage=*/1.0)
+                   .ok());
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 
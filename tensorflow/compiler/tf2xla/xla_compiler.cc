@@ -204,11 +204,13 @@ Status BuildComputation(
     const XlaShapeLayoutHelpers::ShapeDeterminationFns& shape_determination_fns,
     bool is_entry_computation, bool return_updated_values_for_all_resources,
     bool always_return_tuple, bool use_tuple_arg, bool alias_resource_update,
-    xla::XlaBuilder* builder, xla::XlaComputation* computation,
-    int* num_computation_outputs, int* num_nonconst_outputs,
+    bool alias_parameter_args, xla::XlaBuilder* builder,
+    xla::XlaComputation* computation, int* num_computation_outputs,
+    int* num_nonconst_outputs,
     std::vector<XlaCompiler::OutputDescription>* outputs,
     std::vector<XlaCompiler::ResourceUpdate>* resource_updates,
-    xla::Shape* output_shape, absl::Span<int const> input_mapping) {
+    xla::Shape* output_shape, absl::Span<int const> input_mapping,
+    absl::Span<const xla::Shape> input_shapes) {
   // Attach a common operator name as metadata. This has no semantic effect — it
   // merely makes the HLO graph more readable when visualized via TensorBoard,
   // since TensorBoard forms groups out of operators with similar names.
@@ -230,6 +232,21 @@ Status BuildComputation(
   std::vector<xla::XlaOp> elems;
   elems.reserve(retvals.size());
 
+  std::vector<xla::XlaBuilder::InputOutputAlias> aliases;
+  // Parameters which can still be aliased with a non-constant output, see
+  // `alias_parameter_args`.
+  std::vector<bool> parameter_aliasable;
+  if (alias_parameter_args && is_entry_computation && !use_tuple_arg) {
+    parameter_aliasable.resize(input_mapping.size());
+    for (int xla_arg = 0; xla_arg < input_mapping.size(); ++xla_arg) {
+      const int arg_num = input_mapping[xla_arg];
+      parameter_aliasable[xla_arg] =
+          args[arg_num].kind == XlaCompiler::Argument::kParameter &&
+          !arg_shardings.count(arg_num) && xla_arg < input_shapes.size() &&
+          input_shapes[xla_arg].IsArray();
+    }
+  }
+
   // Keeps track of sharding of each retval. If a retval is not in this list,
   // replicate sharding is used. The first element is the output index, second
   // element is the sharding.
@@ -274,6 +291,24 @@ Status BuildComputation(
         if (it != retval_shardings.end()) {
           // Apply the sharding to the output, if there is a core assignment.
           value = identity_op(value, sharding);
+        } else if (!parameter_aliasable.empty()) {
+          // Let the output reuse the buffer of the first parameter of the
+          // same shape, which the caller may donate.
+          TF_ASSIGN_OR_RETURN(xla::Shape value_shape, builder->GetShape(value));
+          for (int xla_arg = 0; xla_arg < parameter_aliasable.size();
+               ++xla_arg) {
+            if (!parameter_aliasable[xla_arg] ||
+                !xla::ShapeUtil::Equal(input_shapes[xla_arg], value_shape)) {
+              continue;
+            }
+            parameter_aliasable[xla_arg] = false;
+            int64_t output_index_num = elems.size();
+            VLOG(3) << "Storing parameter alias: {" << output_index_num
+                    << "}: (" << xla_arg << ", {})";
+            aliases.push_back({xla::ShapeIndex({output_index_num}), xla_arg,
+                               xla::ShapeIndex{}});
+            break;
+          }
         }
 
         elems.push_back(value);
@@ -314,7 +349,6 @@ Status BuildComputation(
     argument_to_xla_arg[input_mapping[xla_arg]] = xla_arg;
   }
 
-  std::vector<xla::XlaBuilder::InputOutputAlias> aliases;
   for (const XlaResource* resource : arg_resources) {
     DCHECK_LT(resource->arg_num(), args.size());
     const XlaCompiler::Argument& arg = args[resource->arg_num()];
@@ -1565,10 +1599,11 @@ Status XlaCompiler::CompileGraph(const XlaCompiler::CompileOptions& options,
       options.is_entry_computation,
       options.return_updated_values_for_all_resources,
       options.always_return_tuple, options.use_tuple_arg,
-      options.alias_resource_update, builder.get(), result->computation.get(),
-      &num_computation_outputs, &num_nonconst_outputs, &result->outputs,
-      &result->resource_updates, &result->xla_output_shape,
-      result->input_mapping));
+      options.alias_resource_update, options.alias_parameter_args,
+      builder.get(), result->computation.get(), &num_computation_outputs,
+      &num_nonconst_outputs, &result->outputs, &result->resource_updates,
+      &result->xla_output_shape, result->input_mapping,
+      result->xla_input_shapes));
 
   for (const auto& [key, send] : host_compute_sends_) {
     auto* d2h = result->host_compute_metadata.add_device_to_host();
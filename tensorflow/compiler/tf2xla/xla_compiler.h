@@ -134,6 +134,12 @@ class XlaCompiler {
     // Resource updates are converted into input / output of xla. The two
     // buffers are aliased with other if this option is true.
     bool alias_resource_update = false;
+
+    // If true, every non-constant output may alias a not yet aliased parameter
+    // argument with the same XLA shape, so that the caller can donate the
+    // buffers of arguments it holds the only reference to.  Only supported
+    // without `use_tuple_arg`.
+    bool alias_parameter_args = false;
   };
 
   using OutputDescription = ::tensorflow::XlaOutputDescription;
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 
+#include <map>
+
 #include "absl/strings/match.h"
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/const_op.h"
@@ -1976,6 +1978,47 @@ TEST_F(XlaCompilerTest, AliasResourceUpdates) {
   EXPECT_EQ(alias.entries(0).parameter_number(), 0);
 }
 
+TEST_F(XlaCompilerTest, AliasParameterArgs) {
+  Scope scope = Scope::NewRootScope().ExitOnError();
+  auto a = ops::_Arg(scope.WithOpName("A"), DT_INT32, 0);
+  auto b = ops::_Arg(scope.WithOpName("B"), DT_INT32, 1);
+  auto c = ops::_Retval(scope.WithOpName("C"), ops::Neg(scope, b), 0);
+  auto d = ops::_Retval(scope.WithOpName("D"), ops::Neg(scope, a), 1);
+  auto e = ops::_Retval(scope.WithOpName("E"), ops::Neg(scope, a), 2);
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  TF_ASSERT_OK(scope.ToGraph(graph.get()));
+
+  std::vector<XlaCompiler::Argument> args(2);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_INT32;
+  args[0].shape = TensorShape({2});
+  args[1].kind = XlaCompiler::Argument::kParameter;
+  args[1].type = DT_INT32;
+  args[1].shape = TensorShape({3});
+
+  XlaCompiler compiler(DefaultOptions());
+
+  XlaCompiler::CompileOptions compile_options;
+  compile_options.alias_parameter_args = true;
+
+  XlaCompiler::CompilationResult result;
+  TF_ASSERT_OK(compiler.CompileGraph(compile_options, "neg", std::move(graph),
+                                     args, &result));
+
+  // Every parameter is aliased with at most one output of its shape.
+  const xla::HloInputOutputAliasProto& alias =
+      result.computation->proto().input_output_alias();
+  ASSERT_EQ(alias.entries_size(), 2);
+  std::map<int64_t, int64_t> output_to_parameter;
+  for (const auto& entry : alias.entries()) {
+    ASSERT_EQ(entry.output_shape_index_size(), 1);
+    output_to_parameter[entry.output_shape_index(0)] =
+        entry.parameter_number();
+  }
+  EXPECT_EQ(output_to_parameter,
+            (std::map<int64_t, int64_t>{{0, 1}, {1, 0}}));
+}
+
 // Tests that passing in an exact duplicate input to SetDeviceToHostMetadata
 // is not an error.
 TEST_F(XlaCompilerTest, SetDeviceToHostMetadataExactDuplicate) {
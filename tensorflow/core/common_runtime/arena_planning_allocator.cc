@@ -0,0 +1,196 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/arena_planning_allocator.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+size_t RoundUpToAlignment(size_t num_bytes) {
+  return (num_bytes + Allocator::kAllocatorAlignment - 1) &
+         ~(Allocator::kAllocatorAlignment - 1);
+}
+
+}  // namespace
+
+ArenaPlanningAllocator::ArenaPlanningAllocator(Allocator* wrapped,
+                                               int planning_steps)
+    : wrapped_(wrapped), planning_steps_(std::max(1, planning_steps)) {}
+
+ArenaPlanningAllocator::~ArenaPlanningAllocator() {
+  if (arena_ != nullptr) {
+    wrapped_->DeallocateRaw(arena_);
+  }
+}
+
+void* ArenaPlanningAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (planned()) {
+    if (alignment <= kAllocatorAlignment) {
+      void* ptr = AllocateFromArena(num_bytes);
+      if (ptr != nullptr) {
+        num_arena_allocations_.fetch_add(1, std::memory_order_relaxed);
+        Ref();
+        return ptr;
+      }
+    }
+    void* ptr = wrapped_->AllocateRaw(alignment, num_bytes);
+    if (ptr != nullptr) {
+      num_fallback_allocations_.fetch_add(1, std::memory_order_relaxed);
+      Ref();
+    }
+    return ptr;
+  }
+
+  void* ptr = wrapped_->AllocateRaw(alignment, num_bytes);
+  if (ptr == nullptr) return nullptr;
+  Ref();
+  // Requests that the arena could not serve are not recorded.
+  if (num_bytes == 0 || alignment > kAllocatorAlignment) return ptr;
+  mutex_lock l(mu_);
+  if (!planned_.load(std::memory_order_relaxed)) {
+    planning_allocations_[ptr] = num_bytes;
+    const int live = ++live_[num_bytes];
+    int& max_live = max_live_[num_bytes];
+    max_live = std::max(max_live, live);
+  }
+  return ptr;
+}
+
+void ArenaPlanningAllocator::DeallocateRaw(void* ptr) {
+  char* p = static_cast<char*>(ptr);
+  if (planned() && p >= arena_ && p < arena_ + arena_bytes_) {
+    SizeClass* size_class = FindSizeClass(p);
+    const int slot = (p - arena_ - size_class->arena_offset) /
+                     size_class->slot_bytes;
+    mutex_lock l(size_class->mu);
+    size_class->free_slots.push_back(slot);
+  } else {
+    if (!planned()) {
+      mutex_lock l(mu_);
+      auto it = planning_allocations_.find(ptr);
+      if (it != planning_allocations_.end()) {
+        --live_[it->second];
+        planning_allocations_.erase(it);
+      }
+    }
+    wrapped_->DeallocateRaw(ptr);
+  }
+  Unref();
+}
+
+void ArenaPlanningAllocator::EndStep() {
+  if (planned()) return;
+  mutex_lock l(mu_);
+  if (planned_.load(std::memory_order_relaxed)) return;
+  if (!max_live_.empty() && max_live_ == previous_max_live_) {
+    ++num_stable_steps_;
+  } else {
+    num_stable_steps_ = 1;
+    previous_max_live_ = max_live_;
+  }
+  if (num_stable_steps_ >= planning_steps_ && !max_live_.empty() &&
+      InstallPlan()) {
+    return;
+  }
+  // Buffers that are still live count towards the maxima of the next step.
+  max_live_.clear();
+  for (const auto& size_and_live : live_) {
+    if (size_and_live.second > 0) {
+      max_live_.insert(size_and_live);
+    }
+  }
+}
+
+bool ArenaPlanningAllocator::InstallPlan() {
+  std::vector<std::pair<size_t, int>> sizes(max_live_.begin(),
+                                            max_live_.end());
+  std::sort(sizes.begin(), sizes.end());
+  size_t total_bytes = 0;
+  for (const auto& size_and_count : sizes) {
+    total_bytes += RoundUpToAlignment(size_and_count.first) *
+                   size_and_count.second;
+  }
+  void* arena = wrapped_->AllocateRaw(kAllocatorAlignment, total_bytes);
+  if (arena == nullptr) {
+    LOG(WARNING) << "ArenaPlanningAllocator failed to allocate an arena of "
+                 << total_bytes << " bytes; continuing to plan.";
+    num_stable_steps_ = 0;
+    return false;
+  }
+
+  size_t offset = 0;
+  for (const auto& size_and_count : sizes) {
+    auto size_class = std::make_unique<SizeClass>();
+    size_class->slot_bytes = RoundUpToAlignment(size_and_count.first);
+    size_class->arena_offset = offset;
+    {
+      mutex_lock sl(size_class->mu);
+      // Hand out the slots in increasing address order.
+      for (int i = size_and_count.second - 1; i >= 0; --i) {
+        size_class->free_slots.push_back(i);
+      }
+    }
+    offset += size_class->slot_bytes * size_and_count.second;
+    size_class_by_bytes_[size_and_count.first] = size_class.get();
+    size_classes_.push_back(std::move(size_class));
+  }
+  arena_ = static_cast<char*>(arena);
+  arena_bytes_ = total_bytes;
+
+  VLOG(1) << "ArenaPlanningAllocator planned " << sizes.size()
+          << " buffer sizes in an arena of " << total_bytes << " bytes.";
+
+  // Buffers allocated during planning are returned directly to `wrapped_`.
+  live_.clear();
+  max_live_.clear();
+  previous_max_live_.clear();
+  planning_allocations_.clear();
+  planned_.store(true, std::memory_order_release);
+  return true;
+}
+
+void* ArenaPlanningAllocator::AllocateFromArena(size_t num_bytes) {
+  auto it = size_class_by_bytes_.find(num_bytes);
+  if (it == size_class_by_bytes_.end()) return nullptr;
+  SizeClass* size_class = it->second;
+  int slot;
+  {
+    mutex_lock l(size_class->mu);
+    if (size_class->free_slots.empty()) return nullptr;
+    slot = size_class->free_slots.back();
+    size_class->free_slots.pop_back();
+  }
+  return arena_ + size_class->arena_offset + slot * size_class->slot_bytes;
+}
+
+ArenaPlanningAllocator::SizeClass* ArenaPlanningAllocator::FindSizeClass(
+    const char* ptr) {
+  const size_t offset = ptr - arena_;
+  auto it = std::upper_bound(
+      size_classes_.begin(), size_classes_.end(), offset,
+      [](size_t value, const std::unique_ptr<SizeClass>& size_class) {
+        return value < size_class->arena_offset;
+      });
+  DCHECK(it != size_classes_.begin());
+  return std::prev(it)->get();
+}
+
+}  // namespace tensorflow
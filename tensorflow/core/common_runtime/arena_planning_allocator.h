@@ -0,0 +1,142 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_ARENA_PLANNING_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_ARENA_PLANNING_ALLOCATOR_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that learns which buffer sizes a graph allocates in each step,
+// and then serves those buffers from one preallocated arena, instead of going
+// through the wrapped (typically BFC) allocator for every allocation.
+//
+// During the planning phase, every request is forwarded to the wrapped
+// allocator, and for each requested size the allocator records the maximum
+// number of buffers of that size that are live at the same time. Once the
+// recorded maxima have been identical at the end of `planning_steps`
+// consecutive steps, the allocator allocates a single arena with that many
+// slots for each size, and serves subsequent requests from those slots.
+//
+// Slots are assigned per size rather than by packing lifetimes, so that the
+// plan remains valid when the executor runs kernels in a different order than
+// during planning. Requests of an unplanned size or alignment, or for which
+// all slots of that size are in use (e.g. because shapes changed, or buffers
+// outlived the step), fall back to the wrapped allocator.
+//
+// The allocator is reference counted: each outstanding allocation holds a
+// reference, so that it stays alive until the last buffer that it returned has
+// been deallocated, even if its owner has released it.
+class ArenaPlanningAllocator : public Allocator, public core::RefCounted {
+ public:
+  // Does not take ownership of `wrapped`, which must outlive this object.
+  ArenaPlanningAllocator(Allocator* wrapped, int planning_steps);
+
+  std::string Name() override { return wrapped_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  absl::optional<AllocatorStats> GetStats() override {
+    return wrapped_->GetStats();
+  }
+  AllocatorMemoryType GetMemoryType() const override {
+    return wrapped_->GetMemoryType();
+  }
+
+  // Marks the end of a step. Steps may overlap; the recorded maxima cover all
+  // allocations that were live since the previous call.
+  void EndStep();
+
+  // Returns true if requests are being served from the arena.
+  bool planned() const { return planned_.load(std::memory_order_acquire); }
+
+  // Counters for monitoring the effectiveness of the plan.
+  int64_t num_arena_allocations() const {
+    return num_arena_allocations_.load(std::memory_order_relaxed);
+  }
+  int64_t num_fallback_allocations() const {
+    return num_fallback_allocations_.load(std::memory_order_relaxed);
+  }
+
+ protected:
+  ~ArenaPlanningAllocator() override;
+
+ private:
+  // The slots of one planned size.
+  struct SizeClass {
+    // The size of each slot, rounded up to `kAllocatorAlignment`.
+    size_t slot_bytes;
+    // The offset of the first slot in the arena.
+    size_t arena_offset;
+    mutex mu;
+    std::vector<int> free_slots TF_GUARDED_BY(mu);
+  };
+
+  // Builds the arena from `max_live_`, and switches to serving requests from
+  // it. Returns false if the arena could not be allocated.
+  bool InstallPlan() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  void* AllocateFromArena(size_t num_bytes);
+  // Returns the size class of `ptr`, which must lie within the arena.
+  SizeClass* FindSizeClass(const char* ptr);
+
+  Allocator* const wrapped_;  // Not owned.
+  const int planning_steps_;
+
+  mutex mu_;
+  // The following fields are used only during the planning phase.
+  //
+  // The number of live buffers, and the maximum number since the last
+  // `EndStep()`, for each requested size.
+  absl::flat_hash_map<size_t, int> live_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<size_t, int> max_live_ TF_GUARDED_BY(mu_);
+  // The requested size of each live buffer allocated during planning.
+  absl::flat_hash_map<const void*, size_t> planning_allocations_
+      TF_GUARDED_BY(mu_);
+  // The maxima recorded in the previous step, and the number of consecutive
+  // steps for which they did not change.
+  absl::flat_hash_map<size_t, int> previous_max_live_ TF_GUARDED_BY(mu_);
+  int num_stable_steps_ TF_GUARDED_BY(mu_) = 0;
+
+  // The following fields are immutable once `planned_` is true.
+  std::atomic<bool> planned_{false};
+  char* arena_ = nullptr;
+  size_t arena_bytes_ = 0;
+  // Sorted by `arena_offset`.
+  std::vector<std::unique_ptr<SizeClass>> size_classes_;
+  // Maps a requested size to its entry in `size_classes_`.
+  absl::flat_hash_map<size_t, SizeClass*> size_class_by_bytes_;
+
+  std::atomic<int64_t> num_arena_allocations_{0};
+  std::atomic<int64_t> num_fallback_allocations_{0};
+
+  ArenaPlanningAllocator(const ArenaPlanningAllocator&) = delete;
+  void operator=(const ArenaPlanningAllocator&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_ARENA_PLANNING_ALLOCATOR_H_
@@ -0,0 +1,127 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/arena_planning_allocator.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Allocates and deallocates the buffers of one step: two buffers of 256 bytes
+// that are live at the same time, followed by one buffer of 1000 bytes.
+void RunStep(ArenaPlanningAllocator* a) {
+  void* p0 = a->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  void* p1 = a->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  a->DeallocateRaw(p0);
+  a->DeallocateRaw(p1);
+  void* p2 = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  a->DeallocateRaw(p2);
+  a->EndStep();
+}
+
+TEST(ArenaPlanningAllocatorTest, PlansAfterStableSteps) {
+  ArenaPlanningAllocator* a = new ArenaPlanningAllocator(cpu_allocator(), 2);
+  RunStep(a);
+  EXPECT_FALSE(a->planned());
+  RunStep(a);
+  EXPECT_TRUE(a->planned());
+  EXPECT_EQ(0, a->num_arena_allocations());
+
+  RunStep(a);
+  EXPECT_EQ(3, a->num_arena_allocations());
+  EXPECT_EQ(0, a->num_fallback_allocations());
+  a->Unref();
+}
+
+TEST(ArenaPlanningAllocatorTest, ChangingPatternDelaysPlan) {
+  ArenaPlanningAllocator* a = new ArenaPlanningAllocator(cpu_allocator(), 2);
+  RunStep(a);
+  void* p = a->AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  a->DeallocateRaw(p);
+  a->EndStep();
+  EXPECT_FALSE(a->planned());
+  a->Unref();
+}
+
+TEST(ArenaPlanningAllocatorTest, SlotsAreDistinctAndReused) {
+  ArenaPlanningAllocator* a = new ArenaPlanningAllocator(cpu_allocator(), 1);
+  RunStep(a);
+  ASSERT_TRUE(a->planned());
+
+  void* p0 = a->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  void* p1 = a->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  void* p2 = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  EXPECT_NE(p0, p1);
+  EXPECT_NE(p0, p2);
+  EXPECT_NE(p1, p2);
+  for (void* p : {p0, p1, p2}) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) %
+                     Allocator::kAllocatorAlignment);
+  }
+  a->DeallocateRaw(p1);
+  void* p3 = a->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  EXPECT_EQ(p1, p3);
+  EXPECT_EQ(4, a->num_arena_allocations());
+
+  a->DeallocateRaw(p0);
+  a->DeallocateRaw(p2);
+  a->DeallocateRaw(p3);
+  a->Unref();
+}
+
+TEST(ArenaPlanningAllocatorTest, FallsBackToWrappedAllocator) {
+  ArenaPlanningAllocator* a = new ArenaPlanningAllocator(cpu_allocator(), 1);
+  RunStep(a);
+  ASSERT_TRUE(a->planned());
+
+  // An unplanned size.
+  void* p0 = a->AllocateRaw(Allocator::kAllocatorAlignment, 128);
+  EXPECT_EQ(1, a->num_fallback_allocations());
+
+  // More buffers of a planned size than were live during planning.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 3; ++i) {
+    ptrs.push_back(a->AllocateRaw(Allocator::kAllocatorAlignment, 256));
+  }
+  EXPECT_EQ(2, a->num_arena_allocations());
+  EXPECT_EQ(2, a->num_fallback_allocations());
+
+  // Buffers that come back into the arena can be handed out again.
+  a->DeallocateRaw(ptrs[0]);
+  ptrs[0] = a->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  EXPECT_EQ(3, a->num_arena_allocations());
+
+  a->DeallocateRaw(p0);
+  for (void* p : ptrs) a->DeallocateRaw(p);
+  a->Unref();
+}
+
+TEST(ArenaPlanningAllocatorTest, OutlivesOwnerWhileBuffersAreLive) {
+  ArenaPlanningAllocator* a = new ArenaPlanningAllocator(cpu_allocator(), 1);
+  RunStep(a);
+  ASSERT_TRUE(a->planned());
+  void* p = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  a->Unref();
+  // The outstanding buffer keeps the allocator alive.
+  a->DeallocateRaw(p);
+}
+
+}  // namespace
+}  // namespace tensorflow
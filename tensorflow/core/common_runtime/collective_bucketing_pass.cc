@@ -0,0 +1,365 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/collective_bucketing_pass.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/config/flag_defs.h"
+#include "tensorflow/core/config/flags.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/dump_graph.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kCollectiveReduceV2[] = "CollectiveReduceV2";
+
+// Input indices of CollectiveReduceV2.
+constexpr int kGroupSizeInput = 1;
+constexpr int kGroupKeyInput = 2;
+constexpr int kInstanceKeyInput = 3;
+
+struct Candidate {
+  Node* node;
+  int32_t instance_key;
+  TensorShape shape;
+  int64_t size_bytes;
+};
+
+// Returns the value of the scalar int32 constant feeding `node`'s input
+// `index`, or an error if that input is not a constant.
+absl::StatusOr<int32_t> ConstantInput(const Node* node, int index) {
+  const Node* input;
+  TF_RETURN_IF_ERROR(node->input_node(index, &input));
+  if (!input->IsConstant()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Input ", index, " of ", node->name(),
+                     " is not a constant."));
+  }
+  const TensorProto* proto = nullptr;
+  TF_RETURN_IF_ERROR(GetNodeAttr(input->attrs(), "value", &proto));
+  Tensor value;
+  if (!value.FromProto(*proto) || value.dtype() != DT_INT32 ||
+      value.NumElements() != 1) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Input ", index, " of ", node->name(),
+                     " is not a scalar int32 constant."));
+  }
+  return value.flat<int32_t>()(0);
+}
+
+// Returns the key which CollectiveReduceV2 ops must share to be bucketed
+// together: the device, the group and all non-internal attributes.
+std::string BucketingKey(const Node* node, int32_t group_size,
+                         int32_t group_key) {
+  std::string key = absl::StrCat(node->assigned_device_name(), ";",
+                                 group_size, ";", group_key);
+  std::map<std::string, std::string> attrs;
+  for (const auto& attr : node->attrs()) {
+    if (absl::StartsWith(attr.first, "_")) continue;
+    attrs[attr.first] = SummarizeAttrValue(attr.second);
+  }
+  for (const auto& attr : attrs) {
+    absl::StrAppend(&key, ";", attr.first, "=", attr.second);
+  }
+  return key;
+}
+
+// Adds `node` to `groups`, keyed by its bucketing key, if it can be bucketed.
+void MaybeAddCandidate(
+    Node* node, const ShapeRefiner& refiner,
+    absl::btree_map<std::string, std::vector<Candidate>>& groups) {
+  if (node->type_string() != kCollectiveReduceV2) return;
+  if (!node->has_assigned_device_name()) return;
+  int num_ordering_tokens;
+  if (!GetNodeAttr(node->attrs(), "Nordering_token", &num_ordering_tokens)
+           .ok() ||
+      num_ordering_tokens != 0) {
+    return;
+  }
+  absl::StatusOr<int32_t> group_size = ConstantInput(node, kGroupSizeInput);
+  absl::StatusOr<int32_t> group_key = ConstantInput(node, kGroupKeyInput);
+  absl::StatusOr<int32_t> instance_key =
+      ConstantInput(node, kInstanceKeyInput);
+  if (!group_size.ok() || !group_key.ok() || !instance_key.ok()) return;
+
+  shape_inference::InferenceContext* context = refiner.GetContext(node);
+  if (context == nullptr) return;
+  shape_inference::ShapeHandle handle = context->input(0);
+  if (!context->FullyDefined(handle)) return;
+  TensorShape shape;
+  for (int i = 0; i < context->Rank(handle); ++i) {
+    shape.AddDim(context->Value(context->Dim(handle, i)));
+  }
+  groups[BucketingKey(node, *group_size, *group_key)].push_back(
+      {node, *instance_key, shape,
+       shape.num_elements() * DataTypeSize(node->input_type(0))});
+}
+
+// Returns the ancestors of `node` in `graph`. Sets `in_control_flow` if any
+// of them is a control flow op, in which case the input of `node` may be dead.
+absl::flat_hash_set<const Node*> Ancestors(const Graph& graph, Node* node,
+                                          bool* in_control_flow) {
+  absl::flat_hash_set<const Node*> ancestors;
+  *in_control_flow = false;
+  std::function<void(Node*)> enter = [&](Node* n) {
+    if (n == node) return;
+    ancestors.insert(n);
+    if (n->IsControlFlow()) *in_control_flow = true;
+  };
+  ReverseDFSFrom(graph, {node}, enter, /*leave=*/nullptr);
+  return ancestors;
+}
+
+Tensor VectorTensor(absl::Span<const int64_t> values) {
+  Tensor tensor(DT_INT64, TensorShape({static_cast<int64_t>(values.size())}));
+  std::copy(values.begin(), values.end(), tensor.flat<int64_t>().data());
+  return tensor;
+}
+
+absl::StatusOr<Node*> AddConstant(Graph* graph, const std::string& name,
+                                  const Tensor& value,
+                                  const std::string& device) {
+  return NodeBuilder(graph->NewName(name), "Const")
+      .Attr("dtype", value.dtype())
+      .Attr("value", value)
+      .AssignedDevice(device)
+      .Finalize(graph);
+}
+
+// Replaces the CollectiveReduceV2 ops of `bucket` with a single one over the
+// concatenation of their inputs, whose result is split back into the shapes
+// of the original outputs.
+Status FuseBucket(Graph* graph, const std::vector<Candidate>& bucket) {
+  Node* first = bucket.front().node;
+  const std::string prefix = absl::StrCat(first->name(), "/bucketed");
+  // Copied, since the ops of the bucket are removed as they are rewired.
+  const std::string device = first->assigned_device_name();
+
+  TF_ASSIGN_OR_RETURN(
+      Node * flat_shape,
+      AddConstant(graph, prefix, VectorTensor({-1}), device));
+  std::vector<NodeBuilder::NodeOut> flat_inputs;
+  std::vector<int64_t> split_sizes;
+  for (const Candidate& candidate : bucket) {
+    const Edge* input;
+    TF_RETURN_IF_ERROR(candidate.node->input_edge(0, &input));
+    TF_ASSIGN_OR_RETURN(Node * flat_input,
+                        NodeBuilder(graph->NewName(prefix), "Reshape")
+                            .Input(input->src(), input->src_output())
+                            .Input(flat_shape)
+                            .AssignedDevice(device)
+                            .Finalize(graph));
+    flat_inputs.emplace_back(flat_input);
+    split_sizes.push_back(candidate.shape.num_elements());
+  }
+  TF_ASSIGN_OR_RETURN(
+      Node * axis, AddConstant(graph, prefix, Tensor(int32_t{0}), device));
+  TF_ASSIGN_OR_RETURN(Node * concat,
+                      NodeBuilder(graph->NewName(prefix), "ConcatV2")
+                          .Input(flat_inputs)
+                          .Input(axis)
+                          .AssignedDevice(device)
+                          .Finalize(graph));
+
+  // The fused op keeps the group, instance key and attributes of the first
+  // op of the bucket.
+  NodeDef fused_def = first->def();
+  fused_def.set_name(graph->NewName(prefix));
+  fused_def.clear_input();
+  TF_ASSIGN_OR_RETURN(Node * fused, graph->AddNode(std::move(fused_def)));
+  fused->set_assigned_device_name(device);
+  graph->AddEdge(concat, 0, fused, 0);
+  for (const Edge* edge : first->in_edges()) {
+    if (!edge->IsControlEdge() && edge->dst_input() > 0) {
+      graph->AddEdge(edge->src(), edge->src_output(), fused, edge->dst_input());
+    }
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      Node * sizes, AddConstant(graph, prefix, VectorTensor(split_sizes),
+                                device));
+  TF_ASSIGN_OR_RETURN(Node * split,
+                      NodeBuilder(graph->NewName(prefix), "SplitV")
+                          .Input(fused)
+                          .Input(sizes)
+                          .Input(axis)
+                          .Attr("num_split", static_cast<int>(bucket.size()))
+                          .AssignedDevice(device)
+                          .Finalize(graph));
+
+  for (int i = 0; i < bucket.size(); ++i) {
+    Node* node = bucket[i].node;
+    TF_ASSIGN_OR_RETURN(
+        Node * shape,
+        AddConstant(graph, prefix, VectorTensor(bucket[i].shape.dim_sizes()),
+                    device));
+    TF_ASSIGN_OR_RETURN(Node * output,
+                        NodeBuilder(graph->NewName(prefix), "Reshape")
+                            .Input(split, i)
+                            .Input(shape)
+                            .AssignedDevice(device)
+                            .Finalize(graph));
+    std::vector<const Edge*> out_edges(node->out_edges().begin(),
+                                       node->out_edges().end());
+    for (const Edge* edge : out_edges) {
+      if (edge->IsControlEdge()) {
+        graph->AddControlEdge(output, edge->dst());
+      } else {
+        TF_RETURN_IF_ERROR(
+            graph->UpdateEdge(output, 0, edge->dst(), edge->dst_input()));
+      }
+    }
+    for (const Edge* edge : node->in_edges()) {
+      if (edge->IsControlEdge()) {
+        graph->AddControlEdge(edge->src(), fused);
+      }
+    }
+    VLOG(2) << "Bucketed " << node->name() << " into " << fused->name();
+    graph->RemoveNode(node);
+  }
+  return absl::OkStatus();
+}
+
+// Greedily splits the CollectiveReduceV2 ops of `candidates` into buckets of
+// at most `bucket_size_bytes` and fuses every bucket with more than one op.
+// Buckets are fused one at a time, and ancestors are computed on the graph
+// rewritten so far, so that no fusion introduces a cycle.
+Status BucketCandidates(Graph* graph, std::vector<Candidate>& candidates,
+                        int64_t bucket_size_bytes, int* num_fused) {
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) {
+              return a.instance_key < b.instance_key;
+            });
+  std::vector<Candidate> bucket;
+  absl::flat_hash_set<const Node*> bucket_ancestors;
+  int64_t bucket_bytes = 0;
+  auto flush = [&]() -> Status {
+    if (bucket.size() > 1) {
+      TF_RETURN_IF_ERROR(FuseBucket(graph, bucket));
+      *num_fused += bucket.size();
+    }
+    bucket.clear();
+    bucket_ancestors.clear();
+    bucket_bytes = 0;
+    return absl::OkStatus();
+  };
+  for (const Candidate& candidate : candidates) {
+    if (candidate.size_bytes > bucket_size_bytes) continue;
+    bool in_control_flow;
+    absl::flat_hash_set<const Node*> ancestors =
+        Ancestors(*graph, candidate.node, &in_control_flow);
+    if (in_control_flow) continue;
+    bool depends_on_bucket = bucket_ancestors.contains(candidate.node);
+    for (const Candidate& member : bucket) {
+      depends_on_bucket |= ancestors.contains(member.node);
+    }
+    if (depends_on_bucket ||
+        bucket_bytes + candidate.size_bytes > bucket_size_bytes) {
+      TF_RETURN_IF_ERROR(flush());
+      // Fusing the previous bucket may have changed the ancestors.
+      ancestors = Ancestors(*graph, candidate.node, &in_control_flow);
+    }
+    bucket.push_back(candidate);
+    bucket_ancestors.insert(ancestors.begin(), ancestors.end());
+    bucket_bytes += candidate.size_bytes;
+  }
+  return flush();
+}
+
+}  // namespace
+
+Status CollectiveBucketingPass::Run(
+    const GraphOptimizationPassOptions& options) {
+  if (!flags::Global().enable_collective_bucketing.value()) {
+    VLOG(1) << "collective_bucketing_pass is disabled.";
+    return absl::OkStatus();
+  }
+  if (options.graph == nullptr) {
+    VLOG(1) << "No graph in collective_bucketing_pass.";
+    return absl::OkStatus();
+  }
+  Graph* graph = options.graph->get();
+  if (std::count_if(graph->op_nodes().begin(), graph->op_nodes().end(),
+                    [](const Node* node) {
+                      return node->type_string() == kCollectiveReduceV2;
+                    }) < 2) {
+    return absl::OkStatus();
+  }
+  if (VLOG_IS_ON(1)) {
+    VLOG(1) << DumpGraphToFile("before_collective_bucketing_pass", *graph,
+                               options.flib_def);
+  }
+
+  // Shapes which cannot be inferred are left unknown, and the ops consuming
+  // them are not bucketed.
+  ShapeRefiner refiner(graph->versions(), graph->op_registry());
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+  for (Node* node : order) {
+    refiner.AddNode(node).IgnoreError();
+  }
+  absl::btree_map<std::string, std::vector<Candidate>> groups;
+  for (Node* node : order) {
+    MaybeAddCandidate(node, refiner, groups);
+  }
+
+  int num_fused = 0;
+  for (auto& group : groups) {
+    TF_RETURN_IF_ERROR(
+        BucketCandidates(graph, group.second, bucket_size_bytes_, &num_fused));
+  }
+  VLOG(1) << "collective_bucketing_pass bucketed " << num_fused
+          << " CollectiveReduceV2 ops.";
+
+  if (VLOG_IS_ON(1)) {
+    VLOG(1) << DumpGraphToFile("after_collective_bucketing_pass", *graph,
+                               options.flib_def);
+  }
+  return absl::OkStatus();
+}
+
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 4,
+                      CollectiveBucketingPass);
+
+}  // namespace tensorflow
@@ -0,0 +1,66 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_BUCKETING_PASS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_BUCKETING_PASS_H_
+
+#include <cstdint>
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+
+// Small CollectiveReduceV2 ops are fused into bucketed all-reduces, so that a
+// step which reduces many gradients pays the per-collective latency once per
+// bucket instead of once per tensor. This pass only runs when the flag
+// enable_collective_bucketing is true.
+//
+// Two CollectiveReduceV2 ops can share a bucket when they are assigned to the
+// same device, have constant group_size, group_key and instance_key inputs,
+// the same attributes, statically known input shapes, no ordering tokens, and
+// neither depends on the other. Candidates are visited in instance key order,
+// which follows the order in which the program created them and is identical
+// across the members of the group; a bucket is closed once it would exceed
+// the bucket size.
+//
+// For example, the graph:
+//   A[2, 3] -> CollectiveReduceV2(instance_key=1) -> X
+//   B[4]    -> CollectiveReduceV2(instance_key=2) -> Y
+// is rewritten to:
+//   {Reshape(A, [-1]), Reshape(B, [-1])} -> ConcatV2
+//   ConcatV2 -> CollectiveReduceV2(instance_key=1) -> SplitV([6, 4])
+//   SplitV:0 -> Reshape([2, 3]) -> X
+//   SplitV:1 -> Reshape([4])    -> Y
+// The split outputs alias the reduced buffer whenever the tensor sizes are
+// multiples of the allocator alignment, so the only extra copy is the concat.
+
+namespace tensorflow {
+
+class CollectiveBucketingPass : public GraphOptimizationPass {
+ public:
+  // Default upper bound on the number of bytes reduced by one bucket.
+  static constexpr int64_t kDefaultBucketSizeBytes = 25 << 20;
+
+  explicit CollectiveBucketingPass(
+      int64_t bucket_size_bytes = kDefaultBucketSizeBytes)
+      : bucket_size_bytes_(bucket_size_bytes) {}
+
+  Status Run(const GraphOptimizationPassOptions& options) override;
+
+ private:
+  const int64_t bucket_size_bytes_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_BUCKETING_PASS_H_
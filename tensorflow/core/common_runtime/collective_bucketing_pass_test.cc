@@ -0,0 +1,178 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/collective_bucketing_pass.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/config/flag_defs.h"
+#include "tensorflow/core/config/flags.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/validate.h"
+#include "tensorflow/core/platform/test.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/test.h"
+
+namespace tensorflow {
+
+const char kCpu0[] = "/job:worker/replica:0/task:0/device:CPU:0";
+
+Node* Constant(Graph* graph, const std::string& name, const Tensor& value) {
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(name, "Const")
+                  .Attr("dtype", value.dtype())
+                  .Attr("value", value)
+                  .AssignedDevice(kCpu0)
+                  .Finalize(graph, &node));
+  return node;
+}
+
+// Adds a CollectiveReduceV2 of `input` in group 1 of size 2 and its consumer.
+Node* AddReduce(Graph* graph, const std::string& name, Node* input,
+                int instance_key) {
+  Node* group_size = Constant(graph, name + "/group_size", Tensor(2));
+  Node* group_key = Constant(graph, name + "/group_key", Tensor(1));
+  Node* key = Constant(graph, name + "/instance_key", Tensor(instance_key));
+  Node* reduce;
+  TF_CHECK_OK(NodeBuilder(name, "CollectiveReduceV2")
+                  .Input(input)
+                  .Input(group_size)
+                  .Input(group_key)
+                  .Input(key)
+                  .Input(std::vector<NodeBuilder::NodeOut>{})
+                  .Attr("merge_op", "Add")
+                  .Attr("final_op", "Id")
+                  .AssignedDevice(kCpu0)
+                  .Finalize(graph, &reduce));
+  Node* identity;
+  TF_CHECK_OK(NodeBuilder(name + "/identity", "Identity")
+                  .Input(reduce)
+                  .AssignedDevice(kCpu0)
+                  .Finalize(graph, &identity));
+  return identity;
+}
+
+// Adds reductions of float tensors of shapes [2, 3], [4] and [5].
+void AddIndependentReduces(Graph* graph) {
+  AddReduce(graph, "reduce_0",
+            Constant(graph, "input_0", Tensor(DT_FLOAT, TensorShape({2, 3}))),
+            /*instance_key=*/1);
+  AddReduce(graph, "reduce_1",
+            Constant(graph, "input_1", Tensor(DT_FLOAT, TensorShape({4}))),
+            /*instance_key=*/2);
+  AddReduce(graph, "reduce_2",
+            Constant(graph, "input_2", Tensor(DT_FLOAT, TensorShape({5}))),
+            /*instance_key=*/3);
+}
+
+int CountOps(const Graph& graph, const std::string& type) {
+  int count = 0;
+  for (const Node* node : graph.op_nodes()) {
+    if (node->type_string() == type) ++count;
+  }
+  return count;
+}
+
+Node* GetNode(const Graph& graph, const std::string& name) {
+  for (Node* node : graph.nodes()) {
+    if (node->name() == name) return node;
+  }
+  return nullptr;
+}
+
+Status RunPass(std::unique_ptr<Graph>& graph,
+               CollectiveBucketingPass& pass) {
+  GraphOptimizationPassOptions options;
+  options.graph = &graph;
+  return pass.Run(options);
+}
+
+// Test the pass is skipped by default because flag enable_collective_bucketing
+// is false by default.
+TEST(CollectiveBucketingPassTest, FlagFalse) {
+  flags::Global().enable_collective_bucketing.reset(false);
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  AddIndependentReduces(graph.get());
+  CollectiveBucketingPass pass;
+  TF_ASSERT_OK(RunPass(graph, pass));
+  EXPECT_EQ(CountOps(*graph, "CollectiveReduceV2"), 3);
+}
+
+TEST(CollectiveBucketingPassTest, BucketsIndependentReduces) {
+  flags::Global().enable_collective_bucketing.reset(true);
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  AddIndependentReduces(graph.get());
+  CollectiveBucketingPass pass;
+  TF_ASSERT_OK(RunPass(graph, pass));
+  TF_ASSERT_OK(graph::ValidateGraphHasNoCycle(*graph));
+
+  EXPECT_EQ(CountOps(*graph, "CollectiveReduceV2"), 1);
+  EXPECT_EQ(CountOps(*graph, "ConcatV2"), 1);
+  EXPECT_EQ(CountOps(*graph, "SplitV"), 1);
+  for (int i = 0; i < 3; ++i) {
+    Node* identity = GetNode(*graph, absl::StrCat("reduce_", i, "/identity"));
+    ASSERT_NE(identity, nullptr);
+    const Node* reshape;
+    TF_ASSERT_OK(identity->input_node(0, &reshape));
+    EXPECT_EQ(reshape->type_string(), "Reshape");
+    EXPECT_EQ(reshape->assigned_device_name(), kCpu0);
+    const Node* split;
+    TF_ASSERT_OK(reshape->input_node(0, &split));
+    EXPECT_EQ(split->type_string(), "SplitV");
+  }
+  for (const Node* node : graph->op_nodes()) {
+    if (node->type_string() != "CollectiveReduceV2") continue;
+    const Node* instance_key;
+    TF_ASSERT_OK(node->input_node(3, &instance_key));
+    EXPECT_EQ(instance_key->name(), "reduce_0/instance_key");
+  }
+}
+
+TEST(CollectiveBucketingPassTest, DependentReducesAreNotBucketed) {
+  flags::Global().enable_collective_bucketing.reset(true);
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  Node* output = AddReduce(
+      graph.get(), "reduce_0",
+      Constant(graph.get(), "input_0", Tensor(DT_FLOAT, TensorShape({4}))),
+      /*instance_key=*/1);
+  AddReduce(graph.get(), "reduce_1", output, /*instance_key=*/2);
+  CollectiveBucketingPass pass;
+  TF_ASSERT_OK(RunPass(graph, pass));
+  EXPECT_EQ(CountOps(*graph, "CollectiveReduceV2"), 2);
+  EXPECT_EQ(CountOps(*graph, "ConcatV2"), 0);
+}
+
+TEST(CollectiveBucketingPassTest, BucketSizeLimit) {
+  flags::Global().enable_collective_bucketing.reset(true);
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  AddIndependentReduces(graph.get());
+  // The first two inputs take 40 bytes, so the third starts a new bucket.
+  CollectiveBucketingPass pass(/*bucket_size_bytes=*/40);
+  TF_ASSERT_OK(RunPass(graph, pass));
+  TF_ASSERT_OK(graph::ValidateGraphHasNoCycle(*graph));
+  EXPECT_EQ(CountOps(*graph, "CollectiveReduceV2"), 2);
+  EXPECT_EQ(CountOps(*graph, "ConcatV2"), 1);
+  EXPECT_NE(GetNode(*graph, "reduce_2"), nullptr);
+}
+
+}  // namespace tensorflow
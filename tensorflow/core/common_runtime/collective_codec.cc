@@ -0,0 +1,225 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace {
+
+absl::flat_hash_map<std::string, CollectiveCodec*>* MutableCodecRegistry() {
+  static auto* registry =
+      new absl::flat_hash_map<std::string, CollectiveCodec*>;
+  return registry;
+}
+
+Status CheckEncodedBytes(const CollectiveCodec& codec, int64_t num_elements,
+                         const Tensor& encoded) {
+  if (encoded.dtype() != DT_UINT8 ||
+      encoded.TotalBytes() != codec.EncodedBytes(num_elements)) {
+    return errors::InvalidArgument(
+        "Encoding of ", num_elements, " elements must be a DT_UINT8 tensor of ",
+        codec.EncodedBytes(num_elements), " bytes, got ",
+        DataTypeString(encoded.dtype()), " tensor of ", encoded.TotalBytes(),
+        " bytes");
+  }
+  return OkStatus();
+}
+
+// Rounds float values to bfloat16, halving the bytes on the wire.
+class BFloat16Codec : public CollectiveCodec {
+ public:
+  bool SupportsType(DataType dtype) const override {
+    return dtype == DT_FLOAT;
+  }
+
+  int64_t EncodedBytes(int64_t num_elements) const override {
+    return num_elements * sizeof(bfloat16);
+  }
+
+  bool IsIdempotent() const override { return true; }
+
+  Status Encode(const std::string& stream_key, const Tensor& input,
+                Tensor* encoded) override {
+    TF_RETURN_IF_ERROR(
+        CheckEncodedBytes(*this, input.NumElements(), *encoded));
+    RoundFloatToBFloat16(input.flat<float>().data(),
+                         reinterpret_cast<bfloat16*>(encoded->data()),
+                         input.NumElements());
+    return OkStatus();
+  }
+
+  Status Decode(const Tensor& encoded, Tensor* output) override {
+    TF_RETURN_IF_ERROR(
+        CheckEncodedBytes(*this, output->NumElements(), encoded));
+    BFloat16ToFloat(reinterpret_cast<const bfloat16*>(encoded.data()),
+                    output->flat<float>().data(), output->NumElements());
+    return OkStatus();
+  }
+};
+
+// Sends only the largest `kFraction` of the values by magnitude, as pairs of
+// int32 index and float value.  The values which are not sent are kept as a
+// residual per stream and added to the next value of the stream (error
+// feedback), so that every update is eventually applied.
+class TopKCodec : public CollectiveCodec {
+ public:
+  static constexpr double kFraction = 0.01;
+  // Upper bound on the number of streams with a residual.  Beyond it, e.g.
+  // when every step runs new collective instances, all residuals are dropped.
+  static constexpr int kMaxStreams = 1 << 16;
+
+  bool SupportsType(DataType dtype) const override {
+    return dtype == DT_FLOAT;
+  }
+
+  int64_t EncodedBytes(int64_t num_elements) const override {
+    return NumSelected(num_elements) * (sizeof(int32_t) + sizeof(float));
+  }
+
+  bool IsIdempotent() const override { return false; }
+
+  Status Encode(const std::string& stream_key, const Tensor& input,
+                Tensor* encoded) override {
+    const int64_t num_elements = input.NumElements();
+    TF_RETURN_IF_ERROR(CheckEncodedBytes(*this, num_elements, *encoded));
+    if (num_elements > std::numeric_limits<int32_t>::max()) {
+      return errors::InvalidArgument("Cannot encode ", num_elements,
+                                     " elements with top_k");
+    }
+    std::shared_ptr<Residual> residual = GetResidual(stream_key);
+    mutex_lock l(residual->mu);
+    std::vector<float>& values = residual->values;
+    if (values.size() != num_elements) values.assign(num_elements, 0.0f);
+    const float* in = input.flat<float>().data();
+    for (int64_t i = 0; i < num_elements; ++i) {
+      values[i] += in[i];
+    }
+
+    const int64_t num_selected = NumSelected(num_elements);
+    std::vector<int32_t> indices(num_elements);
+    std::iota(indices.begin(), indices.end(), 0);
+    if (num_selected < num_elements) {
+      std::nth_element(indices.begin(), indices.begin() + num_selected,
+                       indices.end(), [&values](int32_t a, int32_t b) {
+                         return std::abs(values[a]) > std::abs(values[b]);
+                       });
+      indices.resize(num_selected);
+      std::sort(indices.begin(), indices.end());
+    }
+    char* out = reinterpret_cast<char*>(encoded->data());
+    std::memcpy(out, indices.data(), num_selected * sizeof(int32_t));
+    out += num_selected * sizeof(int32_t);
+    for (int32_t index : indices) {
+      std::memcpy(out, &values[index], sizeof(float));
+      out += sizeof(float);
+      values[index] = 0.0f;
+    }
+    return OkStatus();
+  }
+
+  Status Decode(const Tensor& encoded, Tensor* output) override {
+    const int64_t num_elements = output->NumElements();
+    TF_RETURN_IF_ERROR(CheckEncodedBytes(*this, num_elements, encoded));
+    const int64_t num_selected = NumSelected(num_elements);
+    const char* in = reinterpret_cast<const char*>(encoded.data());
+    const char* values = in + num_selected * sizeof(int32_t);
+    auto out = output->flat<float>();
+    out.setZero();
+    for (int64_t i = 0; i < num_selected; ++i) {
+      int32_t index;
+      std::memcpy(&index, in + i * sizeof(int32_t), sizeof(int32_t));
+      if (index < 0 || index >= num_elements) {
+        return errors::InvalidArgument("Invalid top_k index ", index,
+                                       " for ", num_elements, " elements");
+      }
+      std::memcpy(&out(index), values + i * sizeof(float), sizeof(float));
+    }
+    return OkStatus();
+  }
+
+ private:
+  struct Residual {
+    mutex mu;
+    std::vector<float> values TF_GUARDED_BY(mu);
+  };
+
+  static int64_t NumSelected(int64_t num_elements) {
+    if (num_elements == 0) return 0;
+    return std::max<int64_t>(
+        1, static_cast<int64_t>(std::ceil(num_elements * kFraction)));
+  }
+
+  std::shared_ptr<Residual> GetResidual(const std::string& stream_key) {
+    mutex_lock l(mu_);
+    auto it = residuals_.find(stream_key);
+    if (it != residuals_.end()) return it->second;
+    if (residuals_.size() >= kMaxStreams) residuals_.clear();
+    auto residual = std::make_shared<Residual>();
+    residuals_.emplace(stream_key, residual);
+    return residual;
+  }
+
+  mutex mu_;
+  absl::flat_hash_map<std::string, std::shared_ptr<Residual>> residuals_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+/*static*/
+Status CollectiveCodecRegistry::Lookup(const std::string& codec_name,
+                                       CollectiveCodec** codec) {
+  auto* registry = MutableCodecRegistry();
+  auto it = registry->find(codec_name);
+  if (it == registry->end()) {
+    return errors::NotFound("No collective codec named ", codec_name);
+  }
+  *codec = it->second;
+  return OkStatus();
+}
+
+/*static*/
+Status CollectiveCodecRegistry::Register(const std::string& codec_name,
+                                         Factory factory) {
+  if (!MutableCodecRegistry()->emplace(codec_name, factory()).second) {
+    return errors::Internal("Already registered collective codec ",
+                            codec_name);
+  }
+  return OkStatus();
+}
+
+REGISTER_COLLECTIVE_CODEC(bf16, BFloat16Codec);
+REGISTER_COLLECTIVE_CODEC(top_k, TopKCodec);
+
+}  // namespace tensorflow
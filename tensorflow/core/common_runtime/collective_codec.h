@@ -0,0 +1,99 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_CODEC_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_CODEC_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+// A CollectiveCodec compresses the values which collective implementations
+// exchange with devices in other tasks, trading precision for bandwidth.  It
+// is selected per collective instance by CollImplDetails::wire_codec.
+//
+// Values are encoded into DT_UINT8 tensors whose size is a function of the
+// number of encoded elements only, so that a receiver can allocate the buffer
+// of an encoded transfer before it arrives.  Encoding and decoding run on
+// host memory.
+//
+// A codec is shared by all collectives of the process and must be
+// thread-safe.
+class CollectiveCodec {
+ public:
+  virtual ~CollectiveCodec() = default;
+
+  // Returns true if values of type `dtype` can be encoded.
+  virtual bool SupportsType(DataType dtype) const = 0;
+
+  // Returns the number of bytes of the encoding of `num_elements` values.
+  virtual int64_t EncodedBytes(int64_t num_elements) const = 0;
+
+  // Returns true if Decode(Encode(v)) == v whenever v is itself the result of
+  // Decode(Encode(x)).  Such codecs may be applied to values which all
+  // members of a group must agree on exactly, by having the owner of the
+  // value apply the codec to its own copy.
+  virtual bool IsIdempotent() const = 0;
+
+  // Encodes `input` into `encoded`, which holds EncodedBytes(
+  // input.NumElements()) bytes.  `stream_key` identifies the sequence of
+  // transfers to which this one belongs across steps, e.g. the same chunk of
+  // the same collective instance; stateful codecs key their state by it.
+  virtual Status Encode(const std::string& stream_key, const Tensor& input,
+                        Tensor* encoded) = 0;
+
+  // Decodes `encoded` into `output`, which must have the shape and type of
+  // the encoded input.
+  virtual Status Decode(const Tensor& encoded, Tensor* output) = 0;
+};
+
+// Static-methods only class for registering and looking up collective codecs.
+class CollectiveCodecRegistry {
+ public:
+  using Factory = std::function<CollectiveCodec*()>;
+
+  // Looks up the codec registered under `codec_name` and returns its process
+  // wide instance via `codec`.
+  static Status Lookup(const std::string& codec_name, CollectiveCodec** codec);
+
+ private:
+  friend class CollectiveCodecRegistration;
+  // Registers a codec with name `codec_name` and creates its instance with
+  // `factory`.
+  static Status Register(const std::string& codec_name, Factory factory);
+};
+
+// Class used to call CollectiveCodecRegistry::Register.  This should only be
+// used to create a global static object.
+class CollectiveCodecRegistration {
+ public:
+  CollectiveCodecRegistration(const std::string& codec_name,
+                              CollectiveCodecRegistry::Factory factory) {
+    TF_CHECK_OK(CollectiveCodecRegistry::Register(codec_name, factory));
+  }
+};
+
+#define REGISTER_COLLECTIVE_CODEC(name, implementation) \
+  static ::tensorflow::CollectiveCodecRegistration      \
+      register_##name##_collective_codec(               \
+          #name, []() { return new implementation; });
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_CODEC_H_
@@ -0,0 +1,121 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_codec.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+CollectiveCodec* GetCodec(const string& name) {
+  CollectiveCodec* codec = nullptr;
+  TF_CHECK_OK(CollectiveCodecRegistry::Lookup(name, &codec));
+  return codec;
+}
+
+Tensor Encode(CollectiveCodec* codec, const string& stream_key,
+              const Tensor& input) {
+  Tensor encoded(DT_UINT8,
+                 TensorShape({codec->EncodedBytes(input.NumElements())}));
+  TF_CHECK_OK(codec->Encode(stream_key, input, &encoded));
+  return encoded;
+}
+
+Tensor Decode(CollectiveCodec* codec, const Tensor& encoded,
+              const TensorShape& shape) {
+  Tensor output(DT_FLOAT, shape);
+  TF_CHECK_OK(codec->Decode(encoded, &output));
+  return output;
+}
+
+TEST(CollectiveCodecTest, UnknownCodec) {
+  CollectiveCodec* codec = nullptr;
+  EXPECT_EQ(CollectiveCodecRegistry::Lookup("unknown", &codec).code(),
+            error::NOT_FOUND);
+}
+
+TEST(CollectiveCodecTest, BFloat16HalvesBytes) {
+  CollectiveCodec* codec = GetCodec("bf16");
+  EXPECT_TRUE(codec->SupportsType(DT_FLOAT));
+  EXPECT_FALSE(codec->SupportsType(DT_INT32));
+  EXPECT_EQ(codec->EncodedBytes(100), 200);
+  EXPECT_TRUE(codec->IsIdempotent());
+}
+
+TEST(CollectiveCodecTest, BFloat16RoundTrip) {
+  CollectiveCodec* codec = GetCodec("bf16");
+  Tensor input = test::AsTensor<float>({1.0f, -2.5f, 3.14159f, 1e-3f, 1e6f});
+  Tensor decoded = Decode(codec, Encode(codec, "", input), input.shape());
+  test::ExpectClose(input, decoded, /*atol=*/0, /*rtol=*/1e-2);
+  // Values which went through the codec are not changed by it again.
+  test::ExpectTensorEqual<float>(
+      decoded, Decode(codec, Encode(codec, "", decoded), input.shape()));
+}
+
+TEST(CollectiveCodecTest, BFloat16WrongEncodingSize) {
+  CollectiveCodec* codec = GetCodec("bf16");
+  Tensor input = test::AsTensor<float>({1.0f, 2.0f});
+  Tensor encoded(DT_UINT8, TensorShape({3}));
+  EXPECT_EQ(codec->Encode("", input, &encoded).code(),
+            error::INVALID_ARGUMENT);
+}
+
+TEST(CollectiveCodecTest, TopKSendsLargestValues) {
+  CollectiveCodec* codec = GetCodec("top_k");
+  EXPECT_FALSE(codec->IsIdempotent());
+  std::vector<float> values(200, 0.1f);
+  values[17] = -5.0f;
+  values[123] = 7.0f;
+  Tensor input = test::AsTensor<float>(values);
+  // 1% of 200 elements, as int32 indices and float values.
+  EXPECT_EQ(codec->EncodedBytes(200), 2 * 8);
+
+  Tensor decoded =
+      Decode(codec, Encode(codec, "largest", input), input.shape());
+  std::vector<float> expected(200, 0.0f);
+  expected[17] = -5.0f;
+  expected[123] = 7.0f;
+  test::ExpectTensorEqual<float>(test::AsTensor<float>(expected), decoded);
+}
+
+TEST(CollectiveCodecTest, TopKErrorFeedback) {
+  CollectiveCodec* codec = GetCodec("top_k");
+  std::vector<float> values(100, 0.0f);
+  values[3] = 2.0f;
+  values[42] = 1.5f;
+  Tensor input = test::AsTensor<float>(values);
+  // Only one value is sent per transfer, the other one is held back and
+  // added to the next transfer of the same stream.
+  Tensor first =
+      Decode(codec, Encode(codec, "feedback", input), input.shape());
+  EXPECT_EQ(first.flat<float>()(3), 2.0f);
+  EXPECT_EQ(first.flat<float>()(42), 0.0f);
+  Tensor second =
+      Decode(codec, Encode(codec, "feedback", input), input.shape());
+  EXPECT_EQ(second.flat<float>()(3), 0.0f);
+  EXPECT_EQ(second.flat<float>()(42), 3.0f);
+  // Other streams have their own residuals.
+  Tensor other = Decode(codec, Encode(codec, "other", input), input.shape());
+  EXPECT_EQ(other.flat<float>()(3), 2.0f);
+}
+
+}  // namespace
+}  // namespace tensorflow
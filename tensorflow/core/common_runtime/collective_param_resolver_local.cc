@@ -53,7 +53,10 @@ CollectiveParamResolverLocal::CollectiveParamResolverLocal(
       nccl_communicator_(nccl_communicator),
       task_name_(task_name),
       gpu_ring_order_(
-          config.gpu_options().experimental().collective_ring_order()) {}
+          config.gpu_options().experimental().collective_ring_order()),
+      ring_max_chunk_bytes_(
+          config.experimental().collective_ring_max_chunk_bytes()),
+      wire_codec_(config.experimental().collective_wire_codec()) {}
 
 void CollectiveParamResolverLocal::CompleteGroupAsync(
     const DeviceAttributes& device, CollGroupParams* group_params,
@@ -87,6 +90,32 @@ const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
   }
 }
 
+// Returns true if the reduction `cp` should run as a hierarchical ring
+// all-reduce, i.e. if its group spans several tasks with the same number of
+// devices, each task has more than one device, and the devices of each task
+// are adjacent in the group.  The user may ask for a flat ring with the
+// "ring" communication hint.
+bool UseHierarchicalRingReduce(const CollectiveParams& cp) {
+  const CollGroupParams& group = cp.group;
+  if (cp.instance.type != REDUCTION_COLLECTIVE ||
+      cp.instance.impl_details.communication_hint == "ring" ||
+      group.num_tasks < 2 || !group.same_num_devices_per_task ||
+      group.group_size / group.num_tasks < 2) {
+    return false;
+  }
+  int num_task_changes = 0;
+  for (int di = 1; di < group.members.size(); ++di) {
+    if (group.members[di].task != group.members[di - 1].task) {
+      ++num_task_changes;
+    }
+  }
+  CollectiveImplementationInterface* col_impl;
+  return num_task_changes == group.num_tasks - 1 &&
+         CollectiveRegistry::LookupParamResolverInstance(
+             "HierarchicalRingReduce", &col_impl)
+             .ok();
+}
+
 string TaskNameFromDeviceName(const string& device_name) {
   DeviceNameUtils::ParsedName parsed_device;
   CHECK(DeviceNameUtils::ParseFullName(device_name, &parsed_device));
@@ -699,6 +728,9 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
   cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  if (!use_nccl && UseHierarchicalRingReduce(*cp)) {
+    cp->instance.impl_details.collective_name = "HierarchicalRingReduce";
+  }
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
@@ -757,6 +789,10 @@ void CollectiveParamResolverLocal::CompleteInstanceFromInitializedIRec(
   }
   // Populate the fields common across task.
   AssignCollectiveType(cp);
+  cp->instance.impl_details.max_chunk_size_bytes = ring_max_chunk_bytes_;
+  if (cp->instance.impl_details.wire_codec.empty()) {
+    cp->instance.impl_details.wire_codec = wire_codec_;
+  }
   SetDefaultRank(device, cp);
 
   CollectiveImplementationInterface* col_impl;
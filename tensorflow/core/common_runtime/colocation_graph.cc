@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/colocation_graph.h"
 
+#include <algorithm>
 #include <memory>
 #include <set>
 #include <unordered_map>
@@ -49,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/hash.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/port.h"
@@ -161,8 +163,43 @@ bool HasHostMemoryOutType(const Node& node) {
 
   return false;
 }
+
+// Returns a hash of the op, the requested device and the attributes of `def`
+// that may select its kernels. The requested device matters for ops without
+// local kernels, see SupportedDeviceTypesForNode(). The colocation groups and
+// output shapes differ between otherwise identical nodes and never constrain
+// kernels, so they are left out.
+uint64 KernelSelectionHash(const NodeDef& def) {
+  std::vector<std::pair<StringPiece, uint64>> attrs;
+  attrs.reserve(def.attr_size());
+  for (const auto& attr : def.attr()) {
+    if (attr.first == kColocationAttrName || attr.first == "_output_shapes") {
+      continue;
+    }
+    attrs.emplace_back(attr.first, FastAttrValueHash(attr.second));
+  }
+  std::sort(attrs.begin(), attrs.end());
+  uint64 hash = Hash64Combine(Hash64(def.op()), Hash64(def.device()));
+  for (const auto& attr : attrs) {
+    hash = Hash64Combine(hash, Hash64(attr.first.data(), attr.first.size()));
+    hash = Hash64Combine(hash, attr.second);
+  }
+  return hash;
+}
 }  // namespace
 
+Status Member::SetParentAndSupportedDevices(
+    const Node& node, PrioritizedDeviceTypeVector supported_device_types) {
+  int id = node.id();
+  if (id < 0) {
+    return errors::Internal("Placer should not be creating a Member for node: ",
+                            node.DebugString());
+  }
+  parent_ = id;
+  supported_device_types_ = std::move(supported_device_types);
+  return absl::OkStatus();
+}
+
 Status Member::SetParentAndSupportedDevices(
     const Node& node, const std::vector<DeviceType>& types,
     const DeviceNameUtils::ParsedName* local_address_spec) {
@@ -427,6 +464,14 @@ bool Member::MergeSupportedDevices(const Member& other) {
 
 bool Member::MergeSupportedDevices(
     const PrioritizedDeviceTypeVector& other_devices) {
+  if (supported_device_types_ == other_devices) {
+    // Members of the same op, the common case, need no intersection. This
+    // gives the same result as below.
+    if (supported_device_types_.empty()) return false;
+    DeviceSet::SortPrioritizedDeviceTypeVector(&supported_device_types_);
+    return true;
+  }
+
   // Generate intersection with priorities.
   // Each vector contains the same device types but with different priorities.
   // The priorities are taken from the corresponding source vector.
@@ -1491,9 +1536,25 @@ Status ColocationGraph::InitializeMemberWithAssignedDevice(
                           node_type);
 }
 
+Status ColocationGraph::GetSupportedDeviceTypes(
+    const Node& node, PrioritizedDeviceTypeVector* supported_device_types) {
+  const uint64 hash = KernelSelectionHash(node.def());
+  auto it = supported_device_types_cache_.find(hash);
+  if (it != supported_device_types_cache_.end()) {
+    *supported_device_types = it->second;
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(SupportedDeviceTypesForNode(
+      device_types_, node.def(), supported_device_types, &local_address_spec_));
+  supported_device_types_cache_.emplace(hash, *supported_device_types);
+  return absl::OkStatus();
+}
+
 Status ColocationGraph::InitializeMember(const Node& node, Member* member) {
+  PrioritizedDeviceTypeVector supported_device_types;
+  TF_RETURN_IF_ERROR(GetSupportedDeviceTypes(node, &supported_device_types));
   TF_RETURN_IF_ERROR(member->SetParentAndSupportedDevices(
-      node, device_types_, &local_address_spec_));
+      node, std::move(supported_device_types)));
 
   if (node.has_assigned_device_name()) {
     TF_RETURN_IF_ERROR(InitializeMemberWithAssignedDevice(
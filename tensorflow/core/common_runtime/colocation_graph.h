@@ -19,6 +19,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/inspecting_placer.h"
@@ -41,6 +42,11 @@ class Member {
       const Node& node, const std::vector<DeviceType>& types,
       const DeviceNameUtils::ParsedName* local_address_spec);
 
+  // Same as above, with the supported device types of `node` already looked
+  // up.
+  Status SetParentAndSupportedDevices(
+      const Node& node, PrioritizedDeviceTypeVector supported_device_types);
+
   const DeviceNameUtils::ParsedName& requested_device_name() const {
     return requested_device_name_;
   }
@@ -362,6 +368,12 @@ class ColocationGraph {
 
   Status InitializeMember(const Node& node, Member* member);
 
+  // Returns the device types with a kernel for `node`, like
+  // SupportedDeviceTypesForNode. Nodes with the same op and attributes share
+  // the kernel registry lookups.
+  Status GetSupportedDeviceTypes(
+      const Node& node, PrioritizedDeviceTypeVector* supported_device_types);
+
   // Returns the root node of the disjoint tree to which the node with the
   // given id is connected.
   // FindRoot should be called only for debugging or after the members have
@@ -384,6 +396,11 @@ class ColocationGraph {
   const bool allow_soft_placement_;
   const bool log_device_placement_;
 
+  // Supported device types by the hash of the op and attributes of the nodes,
+  // see GetSupportedDeviceTypes().
+  absl::flat_hash_map<uint64, PrioritizedDeviceTypeVector>
+      supported_device_types_cache_;
+
   ColocationGraph(const ColocationGraph&) = delete;
   void operator=(const ColocationGraph&) = delete;
 };
@@ -100,14 +100,26 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
+      use_host_callbacks_(
+          gpu_options.experimental().event_mgr_use_host_callbacks()),
       threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
+  // The polling loop is still needed with host callbacks, for the callbacks of
+  // streams that do not support them.
   StartPollingLoop();
 }
 
 EventMgr::~EventMgr() {
   StopPollingLoop();
 
+  {
+    // Host callbacks refer to this object, so wait until they have all run.
+    mutex_lock l(mu_);
+    while (num_pending_host_callbacks_ > 0) {
+      host_callbacks_done_.wait(l);
+    }
+  }
+
   for (auto& [stream, stream_callbacks] : callbacks_) {
     for (auto& [event, callback] : stream_callbacks) {
       threadpool_.Schedule(std::move(callback));
@@ -188,6 +200,57 @@ void EventMgr::EnqueueCallback(se::Stream* stream, std::function<void()> func) {
   }
 }
 
+void EventMgr::EnqueueHostCallback(se::Stream* stream,
+                                   std::function<void()> func) {
+  {
+    mutex_lock l(mu_);
+    ++num_pending_host_callbacks_;
+  }
+  // Shared so that `func` is still available for the fallback if
+  // DoHostCallback() fails.
+  auto shared_func = std::make_shared<std::function<void()>>(std::move(func));
+  absl::Status s = stream->DoHostCallback(
+      [this, shared_func]() { CompleteHostCallback(std::move(*shared_func)); });
+  if (!s.ok()) {
+    VLOG(1) << "Falling back to polling events: " << s;
+    mutex_lock l(mu_);
+    if (--num_pending_host_callbacks_ == 0) {
+      host_callbacks_done_.notify_all();
+    }
+    EnqueueCallback(stream, std::move(*shared_func));
+    PollEvents(stream);
+  }
+}
+
+void EventMgr::CompleteHostCallback(std::function<void()> func) {
+  // The host callback may run on a driver thread that must not call back into
+  // the driver, so `func` is only handed over to threadpool_. Callbacks that
+  // complete while an earlier batch is waiting to run join that batch.
+  bool schedule;
+  {
+    mutex_lock l(mu_);
+    schedule = completed_callbacks_.empty();
+    completed_callbacks_.push_back(std::move(func));
+    if (--num_pending_host_callbacks_ == 0) {
+      host_callbacks_done_.notify_all();
+    }
+  }
+  if (schedule) {
+    threadpool_.Schedule([this]() { RunCompletedCallbacks(); });
+  }
+}
+
+void EventMgr::RunCompletedCallbacks() {
+  std::vector<std::function<void()>> callbacks;
+  {
+    mutex_lock l(mu_);
+    callbacks.swap(completed_callbacks_);
+  }
+  for (auto& callback : callbacks) {
+    callback();
+  }
+}
+
 // This function must be called periodically to check whether pending
 // events have recorded, and then retire them.  Initial observations
 // suggest that typical behavior in a TensorFlow program is to have
@@ -68,6 +68,10 @@ class EventMgr {
   // be brief and non-blocking since it executes in the one thread used for all
   // such callbacks and also buffer deletions.
   void ThenExecute(se::Stream* stream, std::function<void()> func) {
+    if (use_host_callbacks_) {
+      EnqueueHostCallback(stream, std::move(func));
+      return;
+    }
     mutex_lock l(mu_);
     EnqueueCallback(stream, std::move(func));
     PollEvents(stream);
@@ -80,6 +84,8 @@ class EventMgr {
 
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  // See GPUOptions::Experimental::event_mgr_use_host_callbacks.
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
 
@@ -98,6 +104,18 @@ class EventMgr {
   void PollEvents(se::Stream* stream = nullptr)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Set up `func` to be called once `stream` completes all its outstanding
+  // work, by a host callback on the stream. Falls back to EnqueueCallback() if
+  // the stream does not support host callbacks.
+  void EnqueueHostCallback(se::Stream* stream, std::function<void()> func)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Called by the host callback enqueued by EnqueueHostCallback().
+  void CompleteHostCallback(std::function<void()> func) TF_LOCKS_EXCLUDED(mu_);
+
+  // Runs the callbacks whose host callbacks have completed.
+  void RunCompletedCallbacks() TF_LOCKS_EXCLUDED(mu_);
+
   // An internal polling loop that runs at a low frequency to clear straggler
   // Events.
   void PollLoop();
@@ -115,6 +133,14 @@ class EventMgr {
       std::deque<std::pair<std::unique_ptr<se::Event>, std::function<void()>>>>
       callbacks_ TF_GUARDED_BY(mu_);
 
+  // Callbacks whose host callbacks have completed, but which have not been
+  // run yet. Host callbacks are run by a driver thread, so completed callbacks
+  // are batched here and run by one closure on threadpool_.
+  std::vector<std::function<void()>> completed_callbacks_ TF_GUARDED_BY(mu_);
+  // The number of host callbacks that have been enqueued but not run.
+  int64_t num_pending_host_callbacks_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable host_callbacks_done_ TF_GUARDED_BY(mu_);
+
   bool stop_polling_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
 
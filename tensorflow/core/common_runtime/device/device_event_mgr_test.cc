@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -134,6 +135,29 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+TEST(EventMgr, HostCallbacks) {
+  auto stream_exec = se::GPUMachineManager()->ExecutorForDevice(0).value();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_mgr_use_host_callbacks(true);
+  TEST_EventMgr em(stream_exec, gpu_options);
+  TEST_EventMgrHelper th(&em);
+  TF_ASSERT_OK_AND_ASSIGN(auto stream, stream_exec->CreateStream());
+  std::atomic<int> num_callbacks(0);
+  BlockingCounter counter(100);
+  for (int i = 0; i < 100; ++i) {
+    em.ThenExecute(stream.get(), [&num_callbacks, &counter]() {
+      // Callbacks must run on the EventMgr threads, not on a driver thread.
+      device_event_mgr::WarnIfInCallback([&num_callbacks] { ++num_callbacks; });
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  EXPECT_EQ(100, num_callbacks);
+  // No events are used for host callbacks.
+  EXPECT_EQ(0, th.queue_size());
+  EXPECT_EQ(0, th.free_size());
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
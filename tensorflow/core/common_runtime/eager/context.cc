@@ -413,6 +413,31 @@ EagerExecutor& EagerContext::Executor() {
                                std::this_thread::get_id(), &default_executor_);
 }
 
+EagerExecutor& EagerContext::DeviceExecutor(const Device* device) {
+  {
+    tf_shared_lock l(executor_map_mu_);
+    auto it = device_executors_.find(device);
+    if (it != device_executors_.end()) return *it->second;
+  }
+  tensorflow::mutex_lock l(executor_map_mu_);
+  std::unique_ptr<EagerExecutor>& executor = device_executors_[device];
+  if (executor == nullptr) {
+    executor = std::make_unique<EagerExecutor>(
+        /*async=*/true, default_executor_.StreamingEnqueue());
+  }
+  return *executor;
+}
+
+std::vector<EagerExecutor*> EagerContext::GetDeviceExecutors() {
+  tf_shared_lock l(executor_map_mu_);
+  std::vector<EagerExecutor*> executors;
+  executors.reserve(device_executors_.size());
+  for (const auto& entry : device_executors_) {
+    executors.push_back(entry.second.get());
+  }
+  return executors;
+}
+
 void EagerContext::SetExecutorForThread(EagerExecutor* executor) {
   tensorflow::mutex_lock l(executor_map_mu_);
   if (executor == &default_executor_) {
@@ -462,6 +487,9 @@ void EagerContext::ClearCachesAndThreadExecutors() {
   for (const auto& entry : executors_copy) {
     entry.second->WaitForAllPendingNodes().IgnoreError();
   }
+  for (EagerExecutor* executor : GetDeviceExecutors()) {
+    executor->WaitForAllPendingNodes().IgnoreError();
+  }
   ClearCachesAndDefaultExecutor();
 }
 
@@ -473,6 +501,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     mutex_lock ml(cache_mu_);
     default_executor_.WaitForAllPendingNodes().IgnoreError();
     kernel_cache_.clear();
+    call_site_kernel_cache_.clear();
     for (auto& entry : registered_functions_) {
       entry.second->cached_kernel_keys->clear();
     }
@@ -633,6 +662,9 @@ EagerContext::~EagerContext() {
     // Let the executor know that its cleanup closure is no longer valid.
     entry.second->RemoveCleanups(reinterpret_cast<intptr_t>(this));
   }
+  for (EagerExecutor* executor : GetDeviceExecutors()) {
+    executor->ShutDown().IgnoreError();
+  }
   for (auto& entry : registered_functions_) {
     while (!entry.second->Unref()) {
       // remove all references.
@@ -1177,6 +1209,12 @@ Status EagerContext::SyncExecutors() {
     entry.second->ClearError();
   }
 
+  // Synchronize per-device executors.
+  for (EagerExecutor* executor : GetDeviceExecutors()) {
+    sg.Update(executor->WaitForAllPendingNodes());
+    executor->ClearError();
+  }
+
 #if !defined(IS_MOBILE_PLATFORM)
   auto remote_contexts = GetRemoteContexts();
   // Synchronize executors on remote workers
@@ -1225,6 +1263,18 @@ core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
   return new_ref;
 }
 
+core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedCallSiteKernel(
+    Fprint128 call_site_key) {
+  tf_shared_lock l(cache_mu_);
+  auto iter = call_site_kernel_cache_.find(call_site_key);
+  if (iter == call_site_kernel_cache_.end()) {
+    return nullptr;
+  }
+  core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
+  new_ref->Ref();
+  return new_ref;
+}
+
 Device* EagerContext::GetCachedDevice(Fprint128 device_cache_key) {
   tf_shared_lock l(device_cache_mu_);
   auto iter = device_cache_.find(device_cache_key);
@@ -1256,6 +1306,15 @@ core::RefCountPtr<KernelAndDevice> EagerContext::AddKernelToCache(
   return kernel;
 }
 
+void EagerContext::AddCallSiteKernelToCache(
+    Fprint128 call_site_key, const core::RefCountPtr<KernelAndDevice>& kernel) {
+  mutex_lock ml(cache_mu_);
+  if (call_site_kernel_cache_.contains(call_site_key)) return;
+  kernel->Ref();
+  call_site_kernel_cache_[call_site_key] =
+      core::RefCountPtr<KernelAndDevice>(kernel.get());
+}
+
 void EagerContext::AddDeviceToCache(Fprint128 device_cache_key,
                                     Device* device) {
   mutex_lock l(device_cache_mu_);
@@ -189,6 +189,23 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
     return prioritized_device_type_list_;
   }
 
+  // Whether async primitive ops that don't touch resources or state are
+  // dispatched to an executor per device (see DeviceExecutor) rather than to
+  // the default executor. This lets independent ops on different devices run
+  // concurrently; data dependencies between the executors are resolved by
+  // waiting for their input TensorHandles to become ready.
+  bool PerDeviceExecutors() const { return per_device_executors_; }
+  void SetPerDeviceExecutors(bool enable) { per_device_executors_ = enable; }
+
+  // Returns the async executor dedicated to the ops placed on `device`,
+  // creating it on first use.
+  EagerExecutor& DeviceExecutor(const Device* device);
+
+  // Returns whether `executor` is the default executor of this context.
+  bool IsDefaultExecutor(const EagerExecutor& executor) const {
+    return &executor == &default_executor_;
+  }
+
   // Clear pending nodes in thread executors and kernel caches.
   void ClearCachesAndThreadExecutors() override;
   // Clear pending nodes in default executor and kernel caches.
@@ -297,6 +314,17 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
       Fprint128 cache_key, core::RefCountPtr<KernelAndDevice> kernel);
   void AddDeviceToCache(Fprint128 device_cache_key, Device* device);
 
+  // Call site cache for primitive ops: maps the fingerprint of an op's
+  // attributes, requested device and placement policy directly to the kernel
+  // that was resolved for it, so that repeated calls skip placement and the
+  // kernel cache key computation. Only kernels that are also in the kernel
+  // cache are added.
+  core::RefCountPtr<KernelAndDevice> GetCachedCallSiteKernel(
+      Fprint128 call_site_key);
+  void AddCallSiteKernelToCache(
+      Fprint128 call_site_key,
+      const core::RefCountPtr<KernelAndDevice>& kernel);
+
   bool LogDevicePlacement() const { return log_device_placement_; }
   void SetLogDevicePlacement(bool enable) override {
     log_device_placement_ = enable;
@@ -788,6 +816,9 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
       kernel_cache_ TF_GUARDED_BY(cache_mu_);
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
+  absl::flat_hash_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
+                      Fprint128Hasher>
+      call_site_kernel_cache_ TF_GUARDED_BY(cache_mu_);
 
   std::unordered_map<string, std::unique_ptr<FunctionLibraryDefinition>>
       component_function_libraries_ TF_GUARDED_BY(cache_mu_);
@@ -816,6 +847,12 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
       TF_GUARDED_BY(executor_map_mu_);
   std::unordered_map<std::thread::id, absl::flat_hash_set<EagerExecutor*>>
       has_cleanup_ TF_GUARDED_BY(executor_map_mu_);
+  std::atomic<bool> per_device_executors_{false};
+  absl::flat_hash_map<const Device*, std::unique_ptr<EagerExecutor>>
+      device_executors_ TF_GUARDED_BY(executor_map_mu_);
+
+  // Returns the executors created by DeviceExecutor.
+  std::vector<EagerExecutor*> GetDeviceExecutors();
 
   const bool log_memory_;
 
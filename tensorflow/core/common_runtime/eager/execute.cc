@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/arg_ret_placement.h"
 #include "tensorflow/core/common_runtime/eager/eager_operation.h"
 #include "tensorflow/core/common_runtime/eager/small_constants_optimizer.h"
+#include "tensorflow/core/common_runtime/eager/small_host_ops.h"
 #include "tensorflow/core/common_runtime/eager/summary_optimizer.h"
 #include "tensorflow/core/common_runtime/int32_fulltype.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -76,8 +77,10 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/profiler/lib/annotated_traceme.h"
 #include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tsl/platform/fingerprint.h"
@@ -1273,6 +1276,40 @@ Status GetOrCreateKernelAndDevice(
     op->UpdateName(summary_optimizer::StrippedFunctionName(op->Name()));
   }
 
+  auto set_out_kernel =
+      [&](core::RefCountPtr<KernelAndDevice> kernel) -> Status {
+    int num_outputs = kernel->num_outputs();
+    if (num_outputs > *num_retvals) {
+      return errors::InvalidArgument("Expecting ", num_outputs,
+                                     " outputs, but *num_retvals is ",
+                                     *num_retvals);
+    }
+    *num_retvals = num_outputs;
+    *out_kernel = std::move(kernel);
+    return absl::OkStatus();
+  };
+
+  // The kernel of a primitive op that isn't run as a function only depends on
+  // its attributes (including the input dtypes), its requested device and the
+  // placement policy, so a kernel resolved for an earlier call with the same
+  // fingerprint is reused without placing the op or rebuilding its NodeDef.
+  // Input devices are still checked on every call by
+  // ValidateInputTypeAndPlacement.
+  const bool use_call_site_cache =
+      !op->is_function() && !ctx.RunEagerOpAsFunction();
+  Fprint128 call_site_key;
+  if (use_call_site_cache) {
+    call_site_key = tsl::FingerprintCat128(
+        op->MutableAttrs()->CacheKey(op->DeviceName()),
+        ctx.AllowSoftPlacement());
+    core::RefCountPtr<KernelAndDevice> kernel =
+        ctx.GetCachedCallSiteKernel(call_site_key);
+    if (kernel != nullptr) {
+      if (device == nullptr) op->SetDevice(kernel->device());
+      return set_out_kernel(std::move(kernel));
+    }
+  }
+
   // Set the EagerOperation's device prior to extracting the input_device_ptrs
   // to avoid any redundant H2D/D2H copies.
   if (device == nullptr && !op->is_function()) {
@@ -1304,7 +1341,9 @@ Status GetOrCreateKernelAndDevice(
   std::unordered_map<int, DtypeAndPartialTensorShape>
       input_resource_variable_dtypes_and_shapes;
   const KernelDef* kernel_def = nullptr;
-  if (!op->is_function()) {
+  // The KernelDef is only needed to place the inputs of a primitive op that
+  // is wrapped in a function.
+  if (!op->is_function() && ctx.RunEagerOpAsFunction()) {
     const NodeDef& node_def = op->MutableAttrs()->BuildNodeDef();
     auto get_kernel_def = [](const EagerOperation& op, const NodeDef& node_def,
                              const Device* op_device) -> const KernelDef* {
@@ -1330,6 +1369,7 @@ Status GetOrCreateKernelAndDevice(
                         input_resource_variable_dtypes_and_shapes,
                         reuse_rendezvous_for_functions));
   core::RefCountPtr<KernelAndDevice> kernel = ctx.GetCachedKernel(cache_key);
+  bool kernel_cached = kernel != nullptr;
   AbstractOperationPtr wrapped_op_releaser;
   // We can eliminate some overhead by running simple functions using regular
   // CallOp kernel. However, it is tricky to figure out which functions should
@@ -1559,20 +1599,14 @@ Status GetOrCreateKernelAndDevice(
       // If the kernel is already in the cache, this discards the passed-in
       // kernel and returns the cached kernel.
       kernel = ctx.AddKernelToCache(cache_key, std::move(kernel));
+      kernel_cached = true;
     }
   }
 
-  int num_outputs = kernel->num_outputs();
-  if (num_outputs > *num_retvals) {
-    return errors::InvalidArgument("Expecting ", num_outputs,
-                                   " outputs, but *num_retvals is ",
-                                   *num_retvals);
+  if (use_call_site_cache && kernel_cached) {
+    ctx.AddCallSiteKernelToCache(call_site_key, kernel);
   }
-  *num_retvals = num_outputs;
-
-  kernel->Ref();  // Ownership of reference is passed to out_kernel.
-  out_kernel->reset(kernel.get());
-  return absl::OkStatus();
+  return set_out_kernel(std::move(kernel));
 }
 
 Status CreateUnshapedOutput(
@@ -1610,10 +1644,90 @@ Status CreateUnshapedOutput(
 #endif  // !IS_MOBILE_PLATFORM
 }
 
+// Evaluates `op` inline with small_host_ops if it's a cheap elementwise op on
+// small host tensors, e.g. step counter or loss scale arithmetic. This
+// skips creating an ExecuteNode and an OpKernelContext. Returns whether `op`
+// was evaluated, in which case `retvals[0]` holds its output.
+bool MaybeEvaluateSmallHostOp(KernelAndDevice* kernel, EagerOperation* op,
+                              TensorHandle** retvals) {
+  EagerContext& ctx = op->EagerContext();
+  // Async execution and graph collection rely on the regular path.
+  if (kernel->IsFunction() || kernel->kernel() == nullptr ||
+      kernel->num_outputs() != 1 || op->Executor().Async() ||
+      ctx.ShouldStoreGraphs() || kernel->device() == nullptr ||
+      kernel->device()->device_type() != DEVICE_CPU) {
+    return false;
+  }
+  const absl::InlinedVector<TensorHandle*, 4>* handles;
+  if (!op->TensorHandleInputs(&handles).ok()) return false;
+  absl::InlinedVector<const Tensor*, 2> inputs;
+  for (TensorHandle* handle : *handles) {
+    // Tensor() waits for pending inputs, as executing the kernel would.
+    const Tensor* tensor;
+    if (handle->Type() != TensorHandle::LOCAL ||
+        (handle->device() != nullptr &&
+         handle->device()->device_type() != DEVICE_CPU) ||
+        !handle->Tensor(&tensor).ok()) {
+      return false;
+    }
+    inputs.push_back(tensor);
+  }
+  if (inputs.empty() || inputs[0]->dtype() != kernel->output_dtypes()[0] ||
+      !small_host_ops::CanEvaluate(op->Name(), inputs)) {
+    return false;
+  }
+  std::optional<Tensor> output;
+  {
+    // Matches the trace of the kernel in KernelAndDevice::Run.
+    profiler::AnnotatedTraceMe activity(
+        [&] {
+          return profiler::TraceMeOp(kernel->kernel()->name_view(),
+                                     kernel->kernel()->type_string_view());
+        },
+        tsl::profiler::TraceMeLevel::kInfo);
+    output = small_host_ops::MaybeEvaluate(op->Name(), inputs);
+  }
+  if (!output.has_value()) return false;
+  retvals[0] = TensorHandle::CreateLocalHandle(
+      std::move(*output),
+      /* d= */ ctx.CanonicalDevice(kernel->OutputDevice(0)),
+      /* op_device= */ kernel->device(),
+      /* resource_device= */ kernel->OutputResourceDevice(0), &ctx);
+  op->Clear();
+  return true;
+}
+
+// Returns whether `op` can be dispatched to the per-device executor of its
+// kernel's device instead of `executor`. This is only done for async
+// primitive ops without resource or variant inputs that aren't stateful, so
+// that their only dependencies on other ops are through their input
+// TensorHandles, which the executing node waits for.
+bool UsePerDeviceExecutor(const EagerOperation& op, KernelAndDevice* kernel,
+                          const EagerExecutor& executor) {
+  EagerContext& ctx = op.EagerContext();
+  if (!ctx.PerDeviceExecutors() || !executor.Async() ||
+      !ctx.IsDefaultExecutor(executor) || op.is_function() ||
+      kernel->IsFunction() || kernel->device() == nullptr ||
+      !kernel->device()->IsLocal()) {
+    return false;
+  }
+  const OpDef* op_def = nullptr;
+  if (!OpDefForOp(op.Name().c_str(), &op_def).ok() || op_def->is_stateful()) {
+    return false;
+  }
+  for (const DataType dtype : kernel->input_dtypes()) {
+    if (dtype == DT_RESOURCE || dtype == DT_VARIANT) return false;
+  }
+  return true;
+}
+
 Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
                         EagerOperation* op, TensorHandle** retvals) {
-  EagerExecutor& executor = op->Executor();
   EagerContext& ctx = op->EagerContext();
+  EagerExecutor& executor =
+      UsePerDeviceExecutor(*op, kernel.get(), op->Executor())
+          ? ctx.DeviceExecutor(kernel->device())
+          : op->Executor();
   GraphCollector* graph_collector = nullptr;
   if (ctx.ShouldStoreGraphs()) {
     graph_collector = ctx.GetGraphCollector();
@@ -1747,6 +1861,9 @@ Status EagerLocalExecute(EagerOperation* op, TensorHandle** retvals,
     }
   }
 
+  if (MaybeEvaluateSmallHostOp(kernel.get(), op, retvals)) {
+    return absl::OkStatus();
+  }
   Status s = AddOrExecuteNode(std::move(kernel), op, retvals);
   // Since the operation failed, we need to Unref any outputs if they were
   // allocated.
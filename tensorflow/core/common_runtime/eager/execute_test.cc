@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/eager/execute.h"
 
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -428,5 +429,163 @@ TEST(ExecuteTest, MultipleNestedCompiledFunction) {
   ctx->Unref();
 }
 
+TEST(ExecuteTest, PrimitiveOpReusesCallSiteKernel) {
+  StaticDeviceMgr device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+      false, &device_mgr, false, nullptr, nullptr);
+
+  auto op = std::make_unique<EagerOperation>(ctx);
+  auto mul = [&](Tensor x, Tensor y, Tensor* output) {
+    TF_ASSERT_OK(op->Reset(/*op=*/"Mul", /*raw_device_name=*/nullptr));
+    auto input1 = core::RefCountPtr<ImmediateExecutionTensorHandle>(
+        ctx->CreateLocalHandleFromTFTensor(x, ctx->HostCPUName().c_str()));
+    TF_ASSERT_OK(op->AddInput(input1.get()));
+    auto input2 = core::RefCountPtr<ImmediateExecutionTensorHandle>(
+        ctx->CreateLocalHandleFromTFTensor(y, ctx->HostCPUName().c_str()));
+    TF_ASSERT_OK(op->AddInput(input2.get()));
+
+    std::vector<TensorHandle*> retvals(1);
+    int num_retvals = retvals.size();
+    TF_ASSERT_OK(EagerExecute(op.get(), retvals.data(), &num_retvals));
+    const Tensor* t = nullptr;
+    TF_ASSERT_OK(retvals[0]->Tensor(&t));
+    *output = *t;
+    retvals[0]->Unref();
+    op->Clear();
+  };
+
+  Tensor output;
+  mul(test::AsScalar<int64_t>(3), test::AsScalar<int64_t>(2), &output);
+  test::ExpectTensorEqual<int64_t>(output, test::AsScalar<int64_t>(6));
+  EXPECT_EQ(ctx->GetCacheStats().kernel_cache_size, 1);
+
+  // Same call site: the kernel resolved by the first call is reused.
+  mul(test::AsScalar<int64_t>(4), test::AsScalar<int64_t>(5), &output);
+  test::ExpectTensorEqual<int64_t>(output, test::AsScalar<int64_t>(20));
+  EXPECT_EQ(ctx->GetCacheStats().kernel_cache_size, 1);
+
+  // A different input dtype changes the attributes and needs another kernel.
+  mul(test::AsScalar<int32_t>(4), test::AsScalar<int32_t>(5), &output);
+  test::ExpectTensorEqual<int32_t>(output, test::AsScalar<int32_t>(20));
+  EXPECT_EQ(ctx->GetCacheStats().kernel_cache_size, 2);
+
+  op.reset();
+  ctx->Unref();
+}
+
+TEST(ExecuteTest, PerDeviceExecutors) {
+  StaticDeviceMgr device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+      /*async=*/true, &device_mgr, false, nullptr, nullptr);
+  ctx->SetPerDeviceExecutors(true);
+
+  Tensor input_tensor = test::AsScalar<int64_t>(3);
+  auto input = core::RefCountPtr<ImmediateExecutionTensorHandle>(
+      ctx->CreateLocalHandleFromTFTensor(input_tensor,
+                                         ctx->HostCPUName().c_str()));
+  // Square the input twice; the second op consumes the pending output of the
+  // first one on the per-device executor.
+  core::RefCountPtr<TensorHandle> result(
+      TensorHandleFromInterface(input.get()));
+  result->Ref();
+  for (int i = 0; i < 2; ++i) {
+    auto op = std::make_unique<EagerOperation>(ctx);
+    TF_ASSERT_OK(op->Reset(
+        /*op=*/"Mul",
+        /*raw_device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0"));
+    TF_ASSERT_OK(op->AddInput(result.get()));
+    TF_ASSERT_OK(op->AddInput(result.get()));
+    std::vector<TensorHandle*> retvals(1);
+    int num_retvals = retvals.size();
+    TF_ASSERT_OK(EagerExecute(op.get(), retvals.data(), &num_retvals));
+    result.reset(retvals[0]);
+  }
+  TF_ASSERT_OK(ctx->SyncExecutors());
+
+  const Tensor* t = nullptr;
+  TF_ASSERT_OK(result->Tensor(&t));
+  test::ExpectTensorEqual<int64_t>(*t, test::AsScalar<int64_t>(81));
+
+  result.reset();
+  input.reset();
+  ctx->Unref();
+}
+
+// Executes `op_name` on host copies of `inputs` and returns its output.
+Tensor ExecuteOnHost(EagerContext* ctx, const char* op_name,
+                     const std::vector<Tensor>& inputs) {
+  auto op = std::make_unique<EagerOperation>(ctx);
+  TF_CHECK_OK(op->Reset(op_name, /*raw_device_name=*/nullptr));
+  std::vector<core::RefCountPtr<ImmediateExecutionTensorHandle>> handles;
+  for (Tensor input : inputs) {
+    handles.emplace_back(
+        ctx->CreateLocalHandleFromTFTensor(input, ctx->HostCPUName().c_str()));
+    TF_CHECK_OK(op->AddInput(handles.back().get()));
+  }
+  std::vector<TensorHandle*> retvals(1);
+  int num_retvals = retvals.size();
+  TF_CHECK_OK(EagerExecute(op.get(), retvals.data(), &num_retvals));
+  TF_CHECK_OK(ctx->SyncExecutors());
+  const Tensor* t = nullptr;
+  TF_CHECK_OK(retvals[0]->Tensor(&t));
+  Tensor output = *t;
+  retvals[0]->Unref();
+  return output;
+}
+
+TEST(ExecuteTest, SmallHostOpsMatchKernels) {
+  // Sync execution evaluates small host ops inline, while async execution
+  // always runs their kernels.
+  StaticDeviceMgr inline_device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  auto inline_ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+      /*async=*/false, &inline_device_mgr, false, nullptr, nullptr);
+  StaticDeviceMgr kernel_device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  auto kernel_ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+      /*async=*/true, &kernel_device_mgr, false, nullptr, nullptr);
+
+  struct TestCase {
+    const char* op_name;
+    std::vector<Tensor> inputs;
+  };
+  const std::vector<TestCase> test_cases = {
+      {"Mul",
+       {test::AsScalar<int64_t>(3), test::AsTensor<int64_t>({1, -2, 5})}},
+      {"AddV2",
+       {test::AsTensor<float>({1.5f, 2.0f}), test::AsScalar<float>(0.25f)}},
+      {"Sub", {test::AsTensor<double>({1.0, 2.0}),
+               test::AsTensor<double>({0.5, 4.0})}},
+      {"Neg", {test::AsTensor<int32_t>({7, -3}, TensorShape({2, 1}))}},
+      {"Maximum",
+       {test::AsTensor<float>(
+            {1.0f, std::numeric_limits<float>::quiet_NaN(), -2.0f}),
+        test::AsScalar<float>(0)}},
+      {"Minimum", {test::AsScalar<int32_t>(4), test::AsScalar<int32_t>(-1)}},
+  };
+  for (const TestCase& test_case : test_cases) {
+    SCOPED_TRACE(test_case.op_name);
+    Tensor expected =
+        ExecuteOnHost(kernel_ctx, test_case.op_name, test_case.inputs);
+    Tensor output =
+        ExecuteOnHost(inline_ctx, test_case.op_name, test_case.inputs);
+    EXPECT_EQ(output.dtype(), expected.dtype());
+    test::ExpectEqual(output, expected);
+  }
+
+  kernel_ctx->Unref();
+  inline_ctx->Unref();
+}
+
 }  // namespace
 }  // namespace tensorflow
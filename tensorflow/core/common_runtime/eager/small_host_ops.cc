@@ -0,0 +1,160 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/eager/small_host_ops.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+
+namespace tensorflow::small_host_ops {
+namespace {
+
+enum class OpType { kAdd, kSub, kMul, kMaximum, kMinimum, kNeg };
+
+std::optional<OpType> GetOpType(absl::string_view op_name) {
+  if (op_name == "Add" || op_name == "AddV2") return OpType::kAdd;
+  if (op_name == "Sub") return OpType::kSub;
+  if (op_name == "Mul") return OpType::kMul;
+  if (op_name == "Maximum") return OpType::kMaximum;
+  if (op_name == "Minimum") return OpType::kMinimum;
+  if (op_name == "Neg") return OpType::kNeg;
+  return std::nullopt;
+}
+
+template <typename T>
+bool IsNan(T x) {
+  if constexpr (std::is_floating_point_v<T>) {
+    return std::isnan(x);
+  } else {
+    return false;
+  }
+}
+
+template <typename T>
+T Apply(OpType op_type, T x, T y) {
+  switch (op_type) {
+    case OpType::kAdd:
+      return x + y;
+    case OpType::kSub:
+      return x - y;
+    case OpType::kMul:
+      return x * y;
+    // Maximum and Minimum propagate NaNs like their kernels do.
+    case OpType::kMaximum:
+      if (IsNan(x) || IsNan(y)) return std::numeric_limits<T>::quiet_NaN();
+      return x > y ? x : y;
+    case OpType::kMinimum:
+      if (IsNan(x) || IsNan(y)) return std::numeric_limits<T>::quiet_NaN();
+      return x < y ? x : y;
+    case OpType::kNeg:
+      break;
+  }
+  return -x;
+}
+
+template <typename T>
+void Evaluate(OpType op_type, absl::Span<const Tensor* const> inputs,
+              Tensor* output) {
+  auto out = output->flat<T>();
+  auto x = inputs[0]->flat<T>();
+  if (inputs.size() == 1) {
+    for (int64_t i = 0; i < out.size(); ++i) out(i) = Apply(op_type, x(i), {});
+    return;
+  }
+  auto y = inputs[1]->flat<T>();
+  const bool x_is_scalar = x.size() == 1 && inputs[0]->dims() == 0;
+  const bool y_is_scalar = y.size() == 1 && inputs[1]->dims() == 0;
+  for (int64_t i = 0; i < out.size(); ++i) {
+    out(i) = Apply(op_type, x(x_is_scalar ? 0 : i), y(y_is_scalar ? 0 : i));
+  }
+}
+
+// Returns the output shape of `op_type` on `inputs` if it can be evaluated
+// inline.
+std::optional<TensorShape> GetOutputShape(
+    OpType op_type, absl::Span<const Tensor* const> inputs) {
+  const size_t num_inputs = op_type == OpType::kNeg ? 1 : 2;
+  if (inputs.size() != num_inputs) return std::nullopt;
+
+  const DataType dtype = inputs[0]->dtype();
+  if (dtype != DT_INT32 && dtype != DT_INT64 && dtype != DT_FLOAT &&
+      dtype != DT_DOUBLE) {
+    return std::nullopt;
+  }
+  for (const Tensor* input : inputs) {
+    if (input->dtype() != dtype || input->NumElements() > kMaxNumElements) {
+      return std::nullopt;
+    }
+  }
+
+  TensorShape shape = inputs[0]->shape();
+  if (num_inputs == 2 && inputs[0]->shape() != inputs[1]->shape()) {
+    // Only broadcast a scalar operand; anything else goes through BCast in
+    // the kernel.
+    if (inputs[0]->dims() == 0) {
+      shape = inputs[1]->shape();
+    } else if (inputs[1]->dims() != 0) {
+      return std::nullopt;
+    }
+  }
+  return shape;
+}
+
+}  // namespace
+
+bool CanEvaluate(absl::string_view op_name,
+                 absl::Span<const Tensor* const> inputs) {
+  const std::optional<OpType> op_type = GetOpType(op_name);
+  return op_type.has_value() && GetOutputShape(*op_type, inputs).has_value();
+}
+
+std::optional<Tensor> MaybeEvaluate(absl::string_view op_name,
+                                    absl::Span<const Tensor* const> inputs) {
+  const std::optional<OpType> op_type = GetOpType(op_name);
+  if (!op_type.has_value()) return std::nullopt;
+  const std::optional<TensorShape> shape = GetOutputShape(*op_type, inputs);
+  if (!shape.has_value()) return std::nullopt;
+
+  const DataType dtype = inputs[0]->dtype();
+  Tensor output(dtype, *shape);
+  switch (dtype) {
+    case DT_INT32:
+      Evaluate<int32_t>(*op_type, inputs, &output);
+      break;
+    case DT_INT64:
+      Evaluate<int64_t>(*op_type, inputs, &output);
+      break;
+    case DT_FLOAT:
+      Evaluate<float>(*op_type, inputs, &output);
+      break;
+    case DT_DOUBLE:
+      Evaluate<double>(*op_type, inputs, &output);
+      break;
+    default:
+      return std::nullopt;
+  }
+  return output;
+}
+
+}  // namespace tensorflow::small_host_ops
@@ -0,0 +1,46 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_SMALL_HOST_OPS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_SMALL_HOST_OPS_H_
+
+#include <cstdint>
+#include <optional>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow::small_host_ops {
+
+// Tensors with more elements than this are never evaluated inline.
+inline constexpr int64_t kMaxNumElements = 16;
+
+// Evaluates the primitive op `op_name` on the host tensors `inputs`, without
+// creating a kernel context, if it's one of a few cheap elementwise ops
+// (Add, AddV2, Sub, Mul, Maximum, Minimum, Neg) on int32, int64, float or
+// double tensors of at most kMaxNumElements elements. Binary ops only support
+// inputs of the same shape or a scalar operand. Returns std::nullopt if the op
+// must go through its kernel instead.
+std::optional<Tensor> MaybeEvaluate(absl::string_view op_name,
+                                    absl::Span<const Tensor* const> inputs);
+
+// Returns whether MaybeEvaluate evaluates `op_name` on `inputs`.
+bool CanEvaluate(absl::string_view op_name,
+                 absl::Span<const Tensor* const> inputs);
+
+}  // namespace tensorflow::small_host_ops
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_SMALL_HOST_OPS_H_
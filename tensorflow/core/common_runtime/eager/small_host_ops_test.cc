@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/eager/small_host_ops.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::small_host_ops::kMaxNumElements;
+using ::tensorflow::small_host_ops::MaybeEvaluate;
+
+TEST(SmallHostOpsTest, BinarySameShape) {
+  const Tensor x = test::AsTensor<int64_t>({1, 2, 3}, {3});
+  const Tensor y = test::AsTensor<int64_t>({4, 5, 6}, {3});
+  std::optional<Tensor> output = MaybeEvaluate("AddV2", {&x, &y});
+  ASSERT_TRUE(output.has_value());
+  test::ExpectTensorEqual<int64_t>(*output,
+                                   test::AsTensor<int64_t>({5, 7, 9}, {3}));
+
+  output = MaybeEvaluate("Sub", {&x, &y});
+  ASSERT_TRUE(output.has_value());
+  test::ExpectTensorEqual<int64_t>(*output,
+                                   test::AsTensor<int64_t>({-3, -3, -3}, {3}));
+}
+
+TEST(SmallHostOpsTest, BinaryScalarBroadcast) {
+  const Tensor x = test::AsTensor<float>({1, 2, 3, 4}, {2, 2});
+  const Tensor scale = test::AsScalar<float>(0.5f);
+  std::optional<Tensor> output = MaybeEvaluate("Mul", {&scale, &x});
+  ASSERT_TRUE(output.has_value());
+  test::ExpectTensorEqual<float>(
+      *output, test::AsTensor<float>({0.5f, 1, 1.5f, 2}, {2, 2}));
+
+  output = MaybeEvaluate("Maximum", {&x, &scale});
+  ASSERT_TRUE(output.has_value());
+  EXPECT_EQ(output->shape(), TensorShape({2, 2}));
+}
+
+TEST(SmallHostOpsTest, Unary) {
+  const Tensor x = test::AsScalar<int32_t>(7);
+  std::optional<Tensor> output = MaybeEvaluate("Neg", {&x});
+  ASSERT_TRUE(output.has_value());
+  test::ExpectTensorEqual<int32_t>(*output, test::AsScalar<int32_t>(-7));
+}
+
+TEST(SmallHostOpsTest, MaximumPropagatesNan) {
+  const Tensor x =
+      test::AsScalar<double>(std::numeric_limits<double>::quiet_NaN());
+  const Tensor y = test::AsScalar<double>(1.0);
+  std::optional<Tensor> output = MaybeEvaluate("Maximum", {&x, &y});
+  ASSERT_TRUE(output.has_value());
+  EXPECT_TRUE(std::isnan(output->scalar<double>()()));
+  output = MaybeEvaluate("Minimum", {&y, &x});
+  ASSERT_TRUE(output.has_value());
+  EXPECT_TRUE(std::isnan(output->scalar<double>()()));
+}
+
+TEST(SmallHostOpsTest, Unsupported) {
+  const Tensor x = test::AsTensor<int64_t>({1, 2}, {2});
+  const Tensor y = test::AsTensor<int64_t>({1, 2}, {1, 2});
+  // Unsupported op.
+  EXPECT_FALSE(MaybeEvaluate("RealDiv", {&x, &x}).has_value());
+  // Wrong number of inputs.
+  EXPECT_FALSE(MaybeEvaluate("Neg", {&x, &x}).has_value());
+  // Broadcasting between non-scalar shapes.
+  EXPECT_FALSE(MaybeEvaluate("AddV2", {&x, &y}).has_value());
+  // Unsupported dtype.
+  const Tensor b = test::AsScalar<bool>(true);
+  EXPECT_FALSE(MaybeEvaluate("Mul", {&b, &b}).has_value());
+  // Too many elements.
+  const Tensor large(DT_FLOAT, TensorShape({kMaxNumElements + 1}));
+  EXPECT_FALSE(MaybeEvaluate("Neg", {&large}).has_value());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -25,6 +25,8 @@ limitations under the License.
 #include <variant>
 #include <vector>
 
+#include "absl/base/config.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/variant.h"
@@ -66,8 +68,85 @@ string SafeDeviceDebugString(Device* device) {
   }
 }
 
+// Sanitizers need to see every allocation and free of a handle to report
+// uses after free, leaks and races, so they bypass the freelist.
+#if defined(ABSL_HAVE_ADDRESS_SANITIZER) ||   \
+    defined(ABSL_HAVE_HWADDRESS_SANITIZER) || \
+    defined(ABSL_HAVE_MEMORY_SANITIZER) || defined(ABSL_HAVE_THREAD_SANITIZER)
+#define TF_TENSOR_HANDLE_FREE_LIST 0
+#else
+#define TF_TENSOR_HANDLE_FREE_LIST 1
+#endif
+
+#if TF_TENSOR_HANDLE_FREE_LIST
+// Maximum number of freed TensorHandle blocks kept for reuse per thread.
+constexpr int kMaxFreeTensorHandles = 64;
+
+// Set once the calling thread's freelist has been destroyed. Handles may still
+// be freed by other thread-local destructors after that; they then bypass the
+// freelist. This flag is trivially destructible, so it stays readable.
+thread_local bool tensor_handle_free_list_destroyed = false;
+
+// Per-thread freelist of TensorHandle-sized memory blocks. A thread-local
+// list needs no locking; blocks freed on one thread and reused on another
+// simply migrate between the lists.
+class TensorHandleFreeList {
+ public:
+  ~TensorHandleFreeList() {
+    tensor_handle_free_list_destroyed = true;
+    for (void* block : blocks_) ::operator delete(block);
+  }
+
+  void* Allocate() {
+    if (blocks_.empty()) return ::operator new(sizeof(TensorHandle));
+    void* block = blocks_.back();
+    blocks_.pop_back();
+    return block;
+  }
+
+  void Free(void* block) {
+    if (blocks_.size() >= kMaxFreeTensorHandles) {
+      ::operator delete(block);
+      return;
+    }
+    blocks_.push_back(block);
+  }
+
+ private:
+  absl::InlinedVector<void*, kMaxFreeTensorHandles> blocks_;
+};
+
+TensorHandleFreeList& GetTensorHandleFreeList() {
+  thread_local TensorHandleFreeList free_list;
+  return free_list;
+}
+#endif  // TF_TENSOR_HANDLE_FREE_LIST
+
 }  // namespace
 
+const bool TensorHandle::kRecyclesMemory = TF_TENSOR_HANDLE_FREE_LIST;
+
+void* TensorHandle::operator new(size_t size) {
+#if TF_TENSOR_HANDLE_FREE_LIST
+  if (size == sizeof(TensorHandle) && !tensor_handle_free_list_destroyed) {
+    return GetTensorHandleFreeList().Allocate();
+  }
+#endif  // TF_TENSOR_HANDLE_FREE_LIST
+  return ::operator new(size);
+}
+
+void TensorHandle::operator delete(void* ptr, size_t size) {
+#if TF_TENSOR_HANDLE_FREE_LIST
+  if (size == sizeof(TensorHandle) && !tensor_handle_free_list_destroyed) {
+    GetTensorHandleFreeList().Free(ptr);
+    return;
+  }
+#endif  // TF_TENSOR_HANDLE_FREE_LIST
+  ::operator delete(ptr);
+}
+
+#undef TF_TENSOR_HANDLE_FREE_LIST
+
 TensorHandle::PackedTensorHandleData::PackedTensorHandleData(
     std::vector<TensorHandle*>&& handles, const TensorShape& shape)
     : handles_(std::move(handles)), shape_(shape) {
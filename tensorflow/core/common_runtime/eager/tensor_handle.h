@@ -74,6 +74,14 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
 #endif  // IS_MOBILE_PLATFORM
 
  public:
+  // TensorHandles are created and destroyed for every output of every eager
+  // op, so their memory is recycled through a small per-thread freelist
+  // instead of going through the global allocator each time. Sanitizer builds
+  // don't recycle memory, and kRecyclesMemory is false there.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+  static const bool kRecyclesMemory;
+
   // TensorHandle with no assigned device
   static TensorHandle* CreateLocalHandle(const tensorflow::Tensor& t);
   static TensorHandle* CreateLocalHandle(tensorflow::Tensor&& t, Device* d,
@@ -22,16 +22,20 @@ limitations under the License.
 #include <vector>
 
 #include "absl/cleanup/cleanup.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -297,6 +301,88 @@ TEST_F(PackedTensorHandleTest, PoisonHandle) {
                        std::string(fake_failure_status.message())));
 }
 
+TEST(TensorHandle_FreeListTest, ReusesFreedHandleMemory) {
+  if (!TensorHandle::kRecyclesMemory) GTEST_SKIP() << "No freelist";
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0/device:CPU:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT, false,
+      &device_mgr, false, nullptr, nullptr);
+  absl::Cleanup ctx_cleanup = [&]() { ctx->Unref(); };
+
+  TensorHandle* first = TensorHandle::CreateLocalHandle(
+      Tensor(DT_FLOAT, TensorShape({2})), nullptr, nullptr, ctx);
+  const void* first_address = first;
+  first->Unref();
+
+  // The next handle created on this thread reuses the freed memory.
+  TensorHandle* second = TensorHandle::CreateLocalHandle(
+      Tensor(DT_INT32, TensorShape({3})), nullptr, nullptr, ctx);
+  EXPECT_EQ(first_address, second);
+  EXPECT_EQ(second->DataType(), DT_INT32);
+  TensorShape shape;
+  TF_EXPECT_OK(second->Shape(&shape));
+  EXPECT_EQ(shape, TensorShape({3}));
+  second->Unref();
+}
+
+TEST(TensorHandle_FreeListTest, FreesHandlesOnOtherThreads) {
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0/device:CPU:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT, false,
+      &device_mgr, false, nullptr, nullptr);
+  absl::Cleanup ctx_cleanup = [&]() { ctx->Unref(); };
+
+  // More handles than a freelist keeps, so that some of them go back to the
+  // global allocator.
+  constexpr int kNumHandles = 200;
+  std::vector<TensorHandle*> handles;
+  std::unique_ptr<Thread> producer(Env::Default()->StartThread(
+      ThreadOptions(), "producer", [&] {
+        for (int i = 0; i < kNumHandles; ++i) {
+          handles.push_back(TensorHandle::CreateLocalHandle(
+              test::AsScalar<int32_t>(i), nullptr, nullptr, ctx));
+        }
+      }));
+  producer.reset();
+
+  // Handles freed on one thread are recycled by the next handles created on
+  // that thread, and keep their values until then.
+  std::unique_ptr<Thread> consumer(Env::Default()->StartThread(
+      ThreadOptions(), "consumer", [&] {
+        absl::flat_hash_set<const void*> freed;
+        for (int i = 0; i < kNumHandles; ++i) {
+          const tensorflow::Tensor* t = nullptr;
+          TF_ASSERT_OK(handles[i]->Tensor(&t));
+          EXPECT_EQ(t->scalar<int32_t>()(), i);
+          freed.insert(handles[i]);
+          handles[i]->Unref();
+        }
+        TensorHandle* handle = TensorHandle::CreateLocalHandle(
+            test::AsScalar<int32_t>(-1), nullptr, nullptr, ctx);
+        if (TensorHandle::kRecyclesMemory) {
+          EXPECT_TRUE(freed.contains(handle));
+        }
+        const tensorflow::Tensor* t = nullptr;
+        TF_ASSERT_OK(handle->Tensor(&t));
+        EXPECT_EQ(t->scalar<int32_t>()(), -1);
+        handle->Unref();
+      }));
+  // Joining the consumer destroys its freelist and frees its blocks.
+  consumer.reset();
+
+  // The producer's thread is gone, and handles are still created normally.
+  TensorHandle* handle = TensorHandle::CreateLocalHandle(
+      test::AsScalar<int32_t>(7), nullptr, nullptr, ctx);
+  const tensorflow::Tensor* t = nullptr;
+  TF_ASSERT_OK(handle->Tensor(&t));
+  EXPECT_EQ(t->scalar<int32_t>()(), 7);
+  handle->Unref();
+}
+
 TEST(TensorHandle_ResourceDeviceTest, OnLocalDevice) {
   std::unique_ptr<Device> d0(
       CreateDevice("CPU", "/job:localhost/replica:0/task:0/device:CPU:0"));
@@ -859,4 +945,63 @@ TEST(TensorHandle_DeviceNameTest, OnLocalDevice) {
   ASSERT_EQ(0, device_id) << device_id;
 }
 
+// Allocates and frees state.range(0) TensorHandle-sized blocks at a time, as
+// the outputs of eager ops are, through the TensorHandle freelist or, for
+// comparison, through the global allocator.
+void BenchmarkHandleAllocation(::testing::benchmark::State& state,
+                               bool use_free_list) {
+  const int batch_size = state.range(0);
+  std::vector<void*> blocks(batch_size);
+  for (auto s : state) {
+    for (void*& block : blocks) {
+      block = use_free_list ? TensorHandle::operator new(sizeof(TensorHandle))
+                            : ::operator new(sizeof(TensorHandle));
+      tensorflow::testing::DoNotOptimize(block);
+    }
+    for (void* block : blocks) {
+      if (use_free_list) {
+        TensorHandle::operator delete(block, sizeof(TensorHandle));
+      } else {
+        ::operator delete(block);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+void BM_HandleAllocationFreeList(::testing::benchmark::State& state) {
+  BenchmarkHandleAllocation(state, /*use_free_list=*/true);
+}
+BENCHMARK(BM_HandleAllocationFreeList)
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(64)
+    ->Threads(1)
+    ->Threads(8);
+
+void BM_HandleAllocationGlobal(::testing::benchmark::State& state) {
+  BenchmarkHandleAllocation(state, /*use_free_list=*/false);
+}
+BENCHMARK(BM_HandleAllocationGlobal)
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(64)
+    ->Threads(1)
+    ->Threads(8);
+
+void BM_CreateAndUnrefLocalHandle(::testing::benchmark::State& state) {
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0/device:CPU:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT, false,
+      &device_mgr, false, nullptr, nullptr);
+  absl::Cleanup ctx_cleanup = [&]() { ctx->Unref(); };
+  const Tensor t = test::AsScalar<float>(1.0f);
+  for (auto s : state) {
+    TensorHandle::CreateLocalHandle(Tensor(t), nullptr, nullptr, ctx)->Unref();
+  }
+}
+BENCHMARK(BM_CreateAndUnrefLocalHandle);
+
 }  // namespace tensorflow
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <deque>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -26,6 +28,7 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/activity_watcher/activity.h"
+#include "tensorflow/core/common_runtime/arena_planning_allocator.h"
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
@@ -62,6 +65,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -79,6 +83,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/util/determinism.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/managed_stack_trace.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
 #include "tsl/platform/tracing.h"
@@ -141,17 +146,165 @@ struct KernelTimer {
   }
 };
 
+// Returns how many synchronous kernel executions happen on a thread for each
+// one whose execution time is recorded in the op execution time metric. The
+// sampling is always on and independent of step stats collection and
+// profiler sessions; it can be tuned or disabled (with 0) through the
+// TF_EXECUTOR_OP_TIMING_SAMPLE_PERIOD environment variable.
+int64_t OpTimingSamplePeriod() {
+  static const int64_t period = [] {
+    int64_t value;
+    Status s = ReadInt64FromEnvVar("TF_EXECUTOR_OP_TIMING_SAMPLE_PERIOD",
+                                   /*default_val=*/1024, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return int64_t{1024};
+    }
+    return value;
+  }();
+  return period;
+}
+
+// Returns true if the next kernel execution on this thread should be timed.
+// Uses a thread-local countdown so the common case is one decrement and
+// compare, without any shared state.
+inline bool ShouldSampleOpTiming() {
+  thread_local int64_t countdown = 0;
+  if (TF_PREDICT_TRUE(--countdown > 0)) return false;
+  const int64_t period = OpTimingSamplePeriod();
+  if (period <= 0) {
+    countdown = std::numeric_limits<int64_t>::max();
+    return false;
+  }
+  countdown = period;
+  return true;
+}
+
 // TODO(b/152925936): Re-evaluate these constants with current usage patterns.
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
+// Per-step set of worker deques used by the "WORK_STEALING" executor.
+//
+// Each worker pushes the expensive nodes that it makes ready onto the back of
+// its own deque and pops from the back (LIFO), so that consumers run on the
+// core that produced their inputs. A worker whose deque is empty steals from
+// the front (FIFO) of the other deques. At most `num_workers()` worker
+// closures are alive at any time.
+//
+// This object is shared between the `ExecutorState` and its worker closures,
+// because a worker may still be draining its loop after the step finished and
+// the `ExecutorState` was deleted.
+template <class TaggedNode>
+class WorkStealingQueues {
+ public:
+  struct Item {
+    TaggedNode node;
+    int64_t scheduled_nsec;
+  };
+
+  explicit WorkStealingQueues(int num_workers)
+      : queues_(std::max(1, num_workers)) {}
+
+  int num_workers() const { return queues_.size(); }
+
+  // Returns the index of the deque to be used by a newly spawned worker.
+  int NextQueueIndex() {
+    return next_queue_.fetch_add(1, std::memory_order_relaxed) % num_workers();
+  }
+
+  void Push(int index, const TaggedNode& node, int64_t scheduled_nsec) {
+    Queue& queue = queues_[index];
+    {
+      mutex_lock l(queue.mu);
+      queue.items.push_back(Item{node, scheduled_nsec});
+    }
+    num_queued_.fetch_add(1);
+  }
+
+  // Pops the most recently pushed item of deque `index`, or steals the oldest
+  // item of another deque if deque `index` is empty.
+  absl::optional<Item> Pop(int index) {
+    if (num_queued_.load() == 0) return absl::nullopt;
+    const int n = num_workers();
+    for (int i = 0; i < n; ++i) {
+      Queue& queue = queues_[(index + i) % n];
+      mutex_lock l(queue.mu);
+      if (queue.items.empty()) continue;
+      absl::optional<Item> item;
+      if (i == 0) {
+        item.emplace(std::move(queue.items.back()));
+        queue.items.pop_back();
+      } else {
+        item.emplace(std::move(queue.items.front()));
+        queue.items.pop_front();
+      }
+      num_queued_.fetch_sub(1);
+      return item;
+    }
+    return absl::nullopt;
+  }
+
+  // Claims a worker slot. Returns false if `num_workers()` workers are
+  // already active.
+  bool TryAcquireWorker() {
+    int active = num_active_workers_.load();
+    while (active < num_workers()) {
+      if (num_active_workers_.compare_exchange_weak(active, active + 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Releases the slot of a worker that found no work. Returns false if work
+  // was pushed concurrently and the caller re-acquired its slot, in which
+  // case the caller must keep running.
+  //
+  // NOTE: `Push()` increments `num_queued_` before a new worker is acquired,
+  // and this method decrements `num_active_workers_` before it reads
+  // `num_queued_`, so at least one of them observes the other's update and no
+  // pushed node is left without a worker.
+  bool ReleaseWorker() {
+    num_active_workers_.fetch_sub(1);
+    return num_queued_.load() == 0 || !TryAcquireWorker();
+  }
+
+ private:
+  struct alignas(64) Queue {
+    mutex mu;
+    std::deque<Item> items TF_GUARDED_BY(mu);
+  };
+
+  std::vector<Queue> queues_;
+  std::atomic<int> num_queued_{0};
+  std::atomic<int> num_active_workers_{0};
+  std::atomic<int> next_queue_{0};
+};
+
+// Identifies the work-stealing deque owned by the worker that runs on the
+// current thread, if any.
+struct WorkStealingWorker {
+  const void* queues = nullptr;
+  int index = 0;
+};
+thread_local WorkStealingWorker current_work_stealing_worker;
+
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool use_work_stealing = false)
+      : immutable_state_(p), use_work_stealing_(use_work_stealing) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
     kernel_stats_.Initialize(immutable_state_.graph_view());
+    const LocalExecutorParams& params = immutable_state_.params();
+    if (params.arena_planning_steps > 0) {
+      arena_allocator_.reset(new ArenaPlanningAllocator(
+          params.device->GetAllocator(AllocatorAttributes()),
+          params.arena_planning_steps));
+    }
     return absl::OkStatus();
   }
 
@@ -225,6 +378,12 @@ class ExecutorImpl : public Executor {
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  // If true, ready expensive nodes are scheduled onto per-worker
+  // work-stealing deques instead of one thread pool closure per node.
+  const bool use_work_stealing_;
+  // If not null, serves the default allocations of kernels once the
+  // per-step allocation pattern has been learned.
+  core::RefCountPtr<ArenaPlanningAllocator> arena_allocator_;
 
   ExecutorImpl(const ExecutorImpl&) = delete;
   void operator=(const ExecutorImpl&) = delete;
@@ -284,7 +443,9 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                bool use_work_stealing = false,
+                ArenaPlanningAllocator* arena_allocator = nullptr);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -298,6 +459,8 @@ class ExecutorState {
 
   struct AsyncState;
 
+  typedef WorkStealingQueues<TaggedNode> WorkQueues;
+
   // Process a ready node in current thread.
   void Process(const TaggedNode& node, int64_t scheduled_nsec);
 
@@ -340,6 +503,35 @@ class ExecutorState {
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // If the graph has critical path slacks from Grappler, orders `*ready` by
+  // increasing slack, so that the nodes on the critical path are scheduled
+  // first. The first expensive node in `*ready` is then the one to keep on the
+  // current thread.
+  void SortByCriticalPathSlack(TaggedNodeSeq* ready) const;
+
+  // Returns true iff `item` should run on the current thread even if there
+  // are inexpensive nodes to run inline already.
+  bool IsOnCriticalPath(const NodeItem& item) const {
+    return item.critical_path_slack == 0;
+  }
+
+  // Work-stealing variant of `ScheduleReady()`. Inexpensive nodes are put
+  // into 'inline_ready' as usual, and the remaining nodes are pushed onto the
+  // deque of the current worker, spawning new workers as needed.
+  void ScheduleReadyWorkStealing(TaggedNodeSeq* ready,
+                                 TaggedNodeReadyQueue* inline_ready,
+                                 int64_t scheduled_nsec);
+
+  // Spawns up to `num_nodes` additional workers, subject to the limit of
+  // `work_queues_->num_workers()` concurrently active workers.
+  void MaybeSpawnWorkers(size_t num_nodes);
+
+  // Runs the nodes in `queues` until there is no more work. `state` is only
+  // dereferenced while a node is being processed, because the step may
+  // complete, and the state be deleted, as soon as the last node is done.
+  static void WorkerLoop(ExecutorState* state,
+                         std::shared_ptr<WorkQueues> queues, int index);
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
@@ -401,6 +593,13 @@ class ExecutorState {
 
   PropagatorStateType propagator_;
 
+  // Non-null iff ready nodes are scheduled in the work-stealing mode.
+  std::shared_ptr<WorkQueues> work_queues_;
+
+  // Not owned. If not null, used for the default allocations of kernels, and
+  // notified when the step ends.
+  ArenaPlanningAllocator* const arena_allocator_;
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
@@ -419,7 +618,8 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, bool use_work_stealing,
+    ArenaPlanningAllocator* arena_allocator)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -449,12 +649,16 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
       propagator_(immutable_state, step_id_, vlog_),
+      arena_allocator_(arena_allocator),
       num_outstanding_ops_(0) {
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (use_work_stealing && !run_all_kernels_inline_) {
+    work_queues_ = std::make_shared<WorkQueues>(port::MaxParallelism());
+  }
 }
 
 template <class PropagatorStateType>
@@ -463,6 +667,9 @@ ExecutorState<PropagatorStateType>::~ExecutorState() {
     device_context_->Unref();
   }
   delete slice_reader_cache_;
+  if (arena_allocator_ != nullptr) {
+    arena_allocator_->EndStep();
+  }
 }
 
 template <class PropagatorStateType>
@@ -593,6 +800,9 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   OpKernel* op_kernel = item.kernel;
   Device* device = immutable_state_.params().device;
   const bool is_expensive = kernel_stats_->IsExpensive(item);
+  const bool sample_timing = ShouldSampleOpTiming();
+  const int64_t sample_start_nsec =
+      sample_timing ? nodestats::NowInNsec() : 0;
 
   if (TF_PREDICT_FALSE(MightTrace(event_collector_, is_expensive))) {
     tsl::tracing::ScopedRegion region(tsl::tracing::EventCategory::kCompute,
@@ -618,6 +828,11 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   } else {
     device->Compute(op_kernel, &ctx);
   }
+  if (TF_PREDICT_FALSE(sample_timing)) {
+    metrics::RecordOpExecutionTime(
+        op_kernel->type_string(),
+        (nodestats::NowInNsec() - sample_start_nsec) / 1000.0);
+  }
   nodestats::SetOpEnd(stats);
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
   s = ProcessOutputs(item, &ctx, outputs->data(), stats);
@@ -774,6 +989,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   params->function_library = immutable_state_.params().function_library;
   params->resource_manager = device->resource_manager();
   params->step_container = step_container_;
+  params->default_allocator_override = arena_allocator_;
   params->slice_reader_cache = slice_reader_cache_;
   params->runner = &runner_;
   params->run_all_kernels_inline = run_all_kernels_inline_;
@@ -1276,13 +1492,16 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       },
       tsl::profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
   DCHECK(!ready->empty());
+  SortByCriticalPathSlack(ready);
 
   int64_t scheduled_nsec = 0;
   if (stats_collector_) {
     scheduled_nsec = nodestats::NowInNsec();
   }
 
-  if (run_all_kernels_inline_) {
+  if (work_queues_) {
+    ScheduleReadyWorkStealing(ready, inline_ready, scheduled_nsec);
+  } else if (run_all_kernels_inline_) {
     if (inline_ready == nullptr) {
       // Schedule all ready kernels from a single closure. This ensure that,
       // regardless of the `runner_` implementation, all kernels will run
@@ -1313,16 +1532,22 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
           // Inline this inexpensive node.
           inline_ready->push_back(tagged_node);
+        } else if (curr_expensive_node == nullptr) {
+          curr_expensive_node = &tagged_node;
+        } else if (immutable_state_.has_critical_path_slacks()) {
+          // Keep the most critical expensive node.
+          expensive_nodes.push_back(tagged_node);
         } else {
-          if (curr_expensive_node) {
-            expensive_nodes.push_back(*curr_expensive_node);
-          }
+          expensive_nodes.push_back(*curr_expensive_node);
           curr_expensive_node = &tagged_node;
         }
       }
     }
     if (curr_expensive_node) {
-      if (inline_ready->empty()) {
+      if (inline_ready->empty() ||
+          IsOnCriticalPath(*curr_expensive_node->node_item)) {
+        // The nodes on the critical path don't wait for a thread of the pool,
+        // the other expensive nodes fill the idle threads instead.
         inline_ready->push_back(*curr_expensive_node);
       } else {
         // There are inline nodes to run already. We dispatch this expensive
@@ -1375,6 +1600,108 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::SortByCriticalPathSlack(
+    TaggedNodeSeq* ready) const {
+  if (!immutable_state_.has_critical_path_slacks() || ready->size() < 2) {
+    return;
+  }
+  std::stable_sort(ready->begin(), ready->end(),
+                   [](const TaggedNode& a, const TaggedNode& b) {
+                     return a.node_item->critical_path_slack <
+                            b.node_item->critical_path_slack;
+                   });
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ScheduleReadyWorkStealing(
+    TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready,
+    int64_t scheduled_nsec) {
+  const WorkStealingWorker& worker = current_work_stealing_worker;
+  const bool on_worker = worker.queues == work_queues_.get();
+  size_t num_pushed = 0;
+  auto push = [&](const TaggedNode& tagged_node) {
+    // Nodes made ready outside of a worker (e.g. the root nodes, or nodes
+    // made ready by an asynchronous kernel's callback) are spread over the
+    // deques in round-robin order.
+    const int index = on_worker ? worker.index : work_queues_->NextQueueIndex();
+    work_queues_->Push(index, tagged_node, scheduled_nsec);
+    ++num_pushed;
+  };
+
+  if (inline_ready == nullptr) {
+    // The last node is kept out of the deques until all workers have been
+    // spawned, because it keeps the step (and therefore `this`) alive until
+    // it is dispatched.
+    const auto last = std::prev(ready->end());
+    for (auto it = ready->begin(); it != last; ++it) {
+      push(*it);
+    }
+    if (num_pushed > 0) {
+      MaybeSpawnWorkers(num_pushed);
+    }
+    RunTask([this, tagged_node = *last, scheduled_nsec]() {
+      Process(tagged_node, scheduled_nsec);
+    });
+    return;
+  }
+
+  // The current thread continues with at least one node from
+  // 'inline_ready', which keeps `this` alive while workers are spawned.
+  const TaggedNode* curr_expensive_node = nullptr;
+  for (auto& tagged_node : *ready) {
+    const NodeItem& item = *tagged_node.node_item;
+    if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
+      // Inline this inexpensive node.
+      inline_ready->push_back(tagged_node);
+    } else if (curr_expensive_node == nullptr) {
+      curr_expensive_node = &tagged_node;
+    } else if (immutable_state_.has_critical_path_slacks()) {
+      // Keep the most critical expensive node.
+      push(tagged_node);
+    } else {
+      push(*curr_expensive_node);
+      curr_expensive_node = &tagged_node;
+    }
+  }
+  if (curr_expensive_node) {
+    if (inline_ready->empty() ||
+        IsOnCriticalPath(*curr_expensive_node->node_item)) {
+      inline_ready->push_back(*curr_expensive_node);
+    } else {
+      push(*curr_expensive_node);
+    }
+  }
+  if (num_pushed > 0) {
+    MaybeSpawnWorkers(num_pushed);
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::MaybeSpawnWorkers(size_t num_nodes) {
+  for (size_t i = 0; i < num_nodes; ++i) {
+    if (!work_queues_->TryAcquireWorker()) break;
+    const int index = work_queues_->NextQueueIndex();
+    RunTask([this, queues = work_queues_,
+             index]() { WorkerLoop(this, queues, index); },
+            /*sample_rate=*/num_nodes);
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::WorkerLoop(
+    ExecutorState* state, std::shared_ptr<WorkQueues> queues, int index) {
+  const WorkStealingWorker saved_worker = current_work_stealing_worker;
+  current_work_stealing_worker = {queues.get(), index};
+  do {
+    while (absl::optional<typename WorkQueues::Item> item =
+               queues->Pop(index)) {
+      state->Process(item->node, item->scheduled_nsec);
+    }
+  } while (!queues->ReleaseWorker());
+  current_work_stealing_worker = saved_worker;
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1513,15 +1840,20 @@ void ExecutorState<PropagatorStateType>::Finish() {
 
 void ExecutorImpl::RunAsyncInternal(const Args& args, DoneCallback done) {
   if (OpOrderDeterminismRequired()) {
-    (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
-                                               &kernel_stats_))
+    // Work stealing reorders execution, so it is never used here.
+    (new ExecutorState<OrderedPropagatorState>(
+         args, immutable_state_, &kernel_stats_, /*use_work_stealing=*/false,
+         arena_allocator_.get()))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        use_work_stealing_,
+                                        arena_allocator_.get()))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_, use_work_stealing_,
+         arena_allocator_.get()))
         ->RunAsync(std::move(done));
   }
 }
@@ -1575,6 +1907,30 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers the "WORK_STEALING" executor, which differs from the default
+// executor only in how ready expensive nodes are dispatched: instead of one
+// thread pool closure per node, a bounded number of workers drain per-worker
+// deques and steal from each other when idle.
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      auto impl = std::make_unique<ExecutorImpl>(params,
+                                                 /*use_work_stealing=*/true);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return absl::OkStatus();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 
 #include <algorithm>
+#include <optional>
+#include <vector>
 
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -25,11 +27,13 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/local_rendezvous.h"
 #include "tensorflow/core/framework/op.h"
@@ -76,11 +80,16 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor based on a graph 'gdef'. If
+  // 'executor_type' is non-empty, the executor is created through the
+  // registered ExecutorFactory of that type.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "",
+              int arena_planning_steps = 0) {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
+    params.arena_planning_steps = arena_planning_steps;
     params.create_kernel =
         [this, version](const std::shared_ptr<const NodeProperties>& props,
                         OpKernel** kernel) {
@@ -92,7 +101,13 @@ class ExecutorTest : public ::testing::Test {
     };
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    if (executor_type.empty()) {
+      TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    } else {
+      std::unique_ptr<Executor> exec;
+      TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &exec));
+      exec_ = exec.release();
+    }
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -265,6 +280,45 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+// Annotates the nodes of `g` as if some of them were on the critical path.
+void AddCriticalPathSlacks(Graph* g) {
+  for (Node* n : g->op_nodes()) {
+    n->AddAttr("_critical_path_slack", static_cast<int64_t>(n->id() % 3));
+  }
+}
+
+TEST_F(ExecutorTest, CriticalPathRandomTree) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  AddCriticalPathSlacks(g.get());
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+TEST_F(ExecutorTest, WorkStealingCriticalPathRandomTree) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  AddCriticalPathSlacks(g.get());
+  Create(std::move(g), "WORK_STEALING");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -302,6 +356,81 @@ TEST_F(ExecutorTest, ConcurrentAddAssign) {
 }
 #endif
 
+TEST_F(ExecutorTest, WorkStealingRandomTree) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING");
+  for (int iters = 0; iters < 4; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
+#ifndef THREAD_SANITIZER
+TEST_F(ExecutorTest, WorkStealingConcurrentAddAssign) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildConcurrentAddAssign(g.get());
+  Create(std::move(g), "WORK_STEALING");
+  for (int iters = 0; iters < 16; ++iters) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    TF_ASSERT_OK(Run(rendez));
+    Rendezvous::Args args;
+    Tensor out;
+    bool is_dead;
+    TF_ASSERT_OK(rendez->Recv(Key(ALICE, kIncarnation, BOB, "out"), args, &out,
+                              &is_dead));
+    EXPECT_LE(V(out), 1025.0);
+    rendez->Unref();
+  }
+}
+#endif
+
+TEST_F(ExecutorTest, ArenaPlanning) {
+  // b = (a + a) + (a + a) + ... + (a + a), with 16 sums of a vector `a` that
+  // can't forward their inputs.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  Node* total = test::graph::Add(g.get(), in, in);
+  for (int i = 1; i < 16; ++i) {
+    total = test::graph::Add(g.get(), total, test::graph::Add(g.get(), in, in));
+  }
+  test::graph::Send(g.get(), total, "b", BOB, 1, ALICE);
+  Create(std::move(g), /*executor_type=*/"", /*arena_planning_steps=*/2);
+
+  EnableCPUAllocatorStats();
+  Allocator* allocator = device_->GetAllocator(AllocatorAttributes());
+  std::vector<int64_t> num_allocs;
+  for (int step = 0; step < 8; ++step) {
+    const std::optional<AllocatorStats> before = allocator->GetStats();
+    ASSERT_TRUE(before.has_value());
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               test::AsTensor<float>(std::vector<float>(
+                                   1024, static_cast<float>(step))),
+                               false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out;
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    test::ExpectTensorEqual<float>(
+        out,
+        test::AsTensor<float>(std::vector<float>(1024, 32.0f * step)));
+    num_allocs.push_back(allocator->GetStats()->num_allocs -
+                         before->num_allocs);
+  }
+  // Once the plan is installed, the sums are allocated from the arena instead
+  // of the device allocator.
+  EXPECT_LT(num_allocs.back(), num_allocs.front());
+}
+
 TEST_F(ExecutorTest, SimpleSwitchLive) {
   auto g = std::make_unique<Graph>(OpRegistry::Global());
   auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
@@ -520,6 +649,66 @@ BENCHMARK(BM_const_identity)
     ->ArgPair(100, 1)
     ->ArgPair(100, 100);
 
+// Same as BM_const_identity, but run with the "WORK_STEALING" executor.
+static void BM_const_identity_work_stealing(
+    ::testing::benchmark::State& state) {
+  const int width = state.range(0);
+  const int outputs_per_const = state.range(1);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  for (int i = 0; i < width; ++i) {
+    Tensor i_t(i);
+    Node* const_node = test::graph::Constant(g, i_t);
+    for (int j = 0; j < outputs_per_const; ++j) {
+      test::graph::Identity(g, const_node);
+    }
+  }
+  FixupSourceAndSinkEdges(g);
+  test::Benchmark("cpu", g, /*options=*/nullptr, /*init=*/nullptr,
+                  /*rendez=*/nullptr, "WORK_STEALING",
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetLabel(strings::StrCat("Nodes = ", (1 + outputs_per_const) * width));
+  state.SetItemsProcessed((1 + outputs_per_const) * width *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_const_identity_work_stealing)
+    ->UseRealTime()
+    ->ArgPair(1, 100)
+    ->ArgPair(100, 1)
+    ->ArgPair(100, 100);
+
+// Measures the per-edge cost of output propagation: each of 'width' constants
+// feeds 'fanout' identity nodes, whose outputs are all control inputs of a
+// single no-op.
+static void BM_propagate_outputs(::testing::benchmark::State& state) {
+  const int width = state.range(0);
+  const int fanout = state.range(1);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  std::vector<Node*> identities;
+  identities.reserve(width * fanout);
+  for (int i = 0; i < width; ++i) {
+    Node* const_node = test::graph::Constant(g, Tensor(i));
+    for (int j = 0; j < fanout; ++j) {
+      identities.push_back(test::graph::Identity(g, const_node));
+    }
+  }
+  test::graph::NoOp(g, identities);
+  FixupSourceAndSinkEdges(g);
+  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+  const int64_t num_edges = 2 * width * fanout;
+  state.SetLabel(strings::StrCat("Edges = ", num_edges));
+  state.SetItemsProcessed(num_edges * static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_propagate_outputs)
+    ->UseRealTime()
+    ->ArgPair(1, 1024)
+    ->ArgPair(16, 1024)
+    ->ArgPair(1024, 16);
+
 static void BM_FeedInputFetchOutput(::testing::benchmark::State& state) {
   Graph* g = new Graph(OpRegistry::Global());
   // z = x + y: x and y are provided as benchmark inputs.  z is the
@@ -95,6 +95,7 @@ GPUBFCAllocator::GPUBFCAllocator(
           o.garbage_collection = GetGarbageCollectionValue();
         }
         o.fragmentation_fraction = opts.fragmentation_fraction;
+        o.enable_thread_cache = opts.enable_thread_cache;
         return o;
       }()) {}
 
@@ -23,9 +23,13 @@ limitations under the License.
 #include <vector>
 
 #include "xla/stream_executor/gpu/gpu_driver.h"
+#if GOOGLE_CUDA
+#include "xla/stream_executor/gpu/gpu_executor.h"
+#endif  // GOOGLE_CUDA
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "xla/stream_executor/stream_executor.h"
 #include "tensorflow/core/common_runtime/device/device_mem_allocator.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 #include "tensorflow/core/framework/typed_allocator.h"
 #include "tensorflow/core/protobuf/bfc_memory_map.pb.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -38,6 +42,7 @@ limitations under the License.
 #include "tsl/platform/test_benchmark.h"
 #include "tsl/platform/threadpool.h"
 #include "tsl/platform/types.h"
+#include "tsl/profiler/lib/scoped_memory_debug_annotation.h"
 
 namespace tsl {
 namespace {
@@ -73,12 +78,37 @@ std::unique_ptr<SubAllocator> CreateGPUMemAllocator(size_t) {
       stream_executor::MemoryType::kDevice, {}, {}));
 }
 
+#if GOOGLE_CUDA
+std::unique_ptr<SubAllocator> CreateVirtualMemorySubAllocator(
+    size_t virtual_address_space_size) {
+  PlatformDeviceId gpu_id(0);
+  auto executor =
+      GPUMachineManager()->ExecutorForDevice(gpu_id.value()).value();
+  return tensorflow::GpuVirtualMemAllocator::Create(
+             {}, {},
+             stream_executor::gpu::ExtractGpuExecutor(executor)->gpu_context(),
+             gpu_id, virtual_address_space_size, {})
+      .value();
+}
+#endif  // GOOGLE_CUDA
+
 std::unique_ptr<SubAllocator> CreateSubAllocator(
     size_t virtual_address_space_size = 1ull << 32) {
+#if GOOGLE_CUDA
+  return CreateVirtualMemorySubAllocator(virtual_address_space_size);
+#else
   return CreateGPUMemAllocator(virtual_address_space_size);
+#endif  // GOOGLE_CUDA
 }
 
-auto TestSuiteValues() { return ::testing::Values(&CreateGPUMemAllocator); }
+auto TestSuiteValues() {
+#if GOOGLE_CUDA
+  return ::testing::Values(&CreateGPUMemAllocator,
+                           &CreateVirtualMemorySubAllocator);
+#else
+  return ::testing::Values(&CreateGPUMemAllocator);
+#endif  // GOOGLE_CUDA
+}
 
 TEST_P(GPUBFCAllocatorTest, NoDups) {
   GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", {});
@@ -233,6 +263,131 @@ TEST_P(GPUBFCAllocatorTest, TestCustomMemoryLimit) {
   a.DeallocateRaw(first_ptr);
 }
 
+TEST_P(GPUBFCAllocatorTest, ThreadCacheReusesChunks) {
+  GPUBFCAllocator::Options options;
+  options.enable_thread_cache = true;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+
+  void* first_ptr = a.AllocateRaw(1, 1000);
+  a.DeallocateRaw(first_ptr);
+  void* second_ptr = a.AllocateRaw(1, 1000);
+  EXPECT_EQ(first_ptr, second_ptr);
+  EXPECT_EQ(1000, a.RequestedSize(second_ptr));
+  CheckStats(&a, 2, 1024, 1024, 1024);
+
+  // A request of a different rounded size is not served from the cache.
+  void* third_ptr = a.AllocateRaw(1, 2000);
+  EXPECT_NE(first_ptr, third_ptr);
+
+  std::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(1, stats->thread_cache_hits);
+  EXPECT_EQ(2, stats->thread_cache_misses);
+
+  a.DeallocateRaw(second_ptr);
+  a.DeallocateRaw(third_ptr);
+  stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, stats->bytes_in_use);
+}
+
+TEST_P(GPUBFCAllocatorTest, ThreadCacheDrainsWhenOutOfMemory) {
+  GPUBFCAllocator::Options options;
+  options.enable_thread_cache = true;
+  // Configure a 2MiB byte limit.
+  GPUBFCAllocator a(GetParam()(1ull << 32), 2 << 20, "GPU_0_bfc", options);
+
+  // Fill most of the memory with small chunks, and keep them in the cache.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 31; ++i) {
+    void* raw = a.AllocateRaw(1, 64 << 10);
+    ASSERT_NE(nullptr, raw);
+    ptrs.push_back(raw);
+  }
+  for (void* raw : ptrs) {
+    a.DeallocateRaw(raw);
+  }
+
+  // The cached chunks are coalesced to serve a larger request.
+  void* big_ptr = a.AllocateRaw(1, 1 << 20);
+  EXPECT_NE(nullptr, big_ptr);
+  a.DeallocateRaw(big_ptr);
+}
+
+TEST_P(GPUBFCAllocatorTest, ThreadCacheConcurrentAllocations) {
+  GPUBFCAllocator::Options options;
+  options.enable_thread_cache = true;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&a, t]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 1000; ++i) {
+          ptrs.push_back(a.AllocateRaw(1, 256 * (1 + (i + t) % 16)));
+          if (ptrs.size() == 8) {
+            for (void* raw : ptrs) {
+              a.DeallocateRaw(raw);
+            }
+            ptrs.clear();
+          }
+        }
+        for (void* raw : ptrs) {
+          a.DeallocateRaw(raw);
+        }
+      });
+    }
+  }
+
+  std::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, stats->bytes_in_use);
+  EXPECT_EQ(8000, stats->num_allocs);
+  EXPECT_GT(*stats->thread_cache_hits, 0);
+}
+
+TEST_P(GPUBFCAllocatorTest, AllocationHistory) {
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", {});
+
+  void* first_ptr;
+  void* second_ptr;
+  {
+    profiler::ScopedMemoryDebugAnnotation annotation("op1", 1);
+    first_ptr = a.AllocateRaw(1, 1024);
+    second_ptr = a.AllocateRaw(1, 2048);
+    a.DeallocateRaw(first_ptr);
+  }
+  {
+    profiler::ScopedMemoryDebugAnnotation annotation("op2", 2);
+    void* third_ptr = a.AllocateRaw(1, 200);
+    a.DeallocateRaw(second_ptr);
+    a.DeallocateRaw(third_ptr);
+  }
+
+  MemoryDump md = a.RecordMemoryMap();
+  ASSERT_EQ(6, md.allocation_event_size());
+  EXPECT_EQ("op1", md.allocation_event(0).op_name());
+  EXPECT_EQ(1, md.allocation_event(0).step_id());
+  EXPECT_EQ(1024, md.allocation_event(0).allocated_bytes());
+  EXPECT_EQ(1024, md.allocation_event(0).bytes_in_use());
+  EXPECT_EQ(-1024, md.allocation_event(2).allocated_bytes());
+  EXPECT_EQ("op2", md.allocation_event(3).op_name());
+  EXPECT_EQ(200, md.allocation_event(3).requested_bytes());
+  EXPECT_EQ(256, md.allocation_event(3).allocated_bytes());
+  EXPECT_EQ(0, md.allocation_event(5).bytes_in_use());
+
+  ASSERT_EQ(2, md.step_memory_size());
+  EXPECT_EQ(1, md.step_memory(0).step_id());
+  EXPECT_EQ(3072, md.step_memory(0).peak_bytes_in_use());
+  EXPECT_EQ(2, md.step_memory(0).num_allocs());
+  EXPECT_EQ(1, md.step_memory(0).num_deallocs());
+  EXPECT_EQ(2, md.step_memory(1).step_id());
+  EXPECT_EQ(2304, md.step_memory(1).peak_bytes_in_use());
+  EXPECT_EQ(1, md.step_memory(1).num_allocs());
+  EXPECT_EQ(2, md.step_memory(1).num_deallocs());
+}
+
 TEST_P(GPUBFCAllocatorTest, AllocationsAndDeallocationsWithGrowth) {
   GPUOptions options;
   options.set_allow_growth(true);
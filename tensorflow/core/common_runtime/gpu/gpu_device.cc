@@ -99,6 +99,7 @@ limitations under the License.
 #ifdef TF_GPU_USE_PJRT
 #include "tensorflow/core/tfrt/common/pjrt_util.h"
 #endif  // TF_GPU_USE_PJRT
+#include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/stream_executor_util.h"
@@ -1610,6 +1611,10 @@ Status BaseGPUDeviceFactory::CreateDevices(
     return OkStatus();
   }
 
+  // Reuse the autotuning results of the previous runs, before any op is
+  // autotuned.
+  MaybeUseAutotuneMapsFile();
+
   struct TfDeviceSpec {
     tsl::PlatformDeviceId platform_device_id;
     int64_t memory_limit_bytes;
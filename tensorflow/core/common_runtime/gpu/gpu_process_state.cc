@@ -30,6 +30,9 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "xla/stream_executor/gpu/gpu_cudamallocasync_allocator.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
+#if GOOGLE_CUDA
+#include "xla/stream_executor/gpu/gpu_executor.h"
+#endif  // GOOGLE_CUDA
 #include "xla/stream_executor/integrations/device_mem_allocator.h"
 #include "xla/stream_executor/stream_executor.h"
 #include "xla/tsl/util/env_var.h"
@@ -39,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_cudamalloc_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_debug_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
 #include "tensorflow/core/framework/log_memory.h"
@@ -68,6 +72,13 @@ static bool UseCudaMemoryGuardAllocator() {
          std::strcmp(allocator_env, "memory_guard") == 0;
 }
 
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static bool UseVirtualMemoryAllocator() {
+  const char* allocator_env = std::getenv("TF_GPU_ALLOCATOR");
+  return allocator_env != nullptr &&
+         std::strcmp(allocator_env, "bfc_virtual_memory") == 0;
+}
+
 // NOLINTNEXTLINE(clang-diagnostic-unused-function)
 static bool UseCudaMallocAsyncAllocator() {
   const char* allocator_env = std::getenv("TF_GPU_ALLOCATOR");
@@ -117,6 +128,31 @@ static std::unique_ptr<SubAllocator> CreateSubAllocator(
 
   bool use_unified_memory = (options.per_process_gpu_memory_fraction() > 1.0 ||
                              options.experimental().use_unified_memory());
+#if GOOGLE_CUDA
+  if (UseVirtualMemoryAllocator() && !use_unified_memory) {
+    std::vector<tsl::PlatformDeviceId> peer_platform_device_ids;
+    peer_platform_device_ids.reserve(peer_gpu_ids.size());
+    for (tsl::TfDeviceId peer_gpu_id : peer_gpu_ids) {
+      tsl::PlatformDeviceId peer_platform_device_id;
+      TF_CHECK_OK(GpuIdManager::TfToPlatformDeviceId(
+          peer_gpu_id, &peer_platform_device_id));
+      peer_platform_device_ids.push_back(peer_platform_device_id);
+    }
+    // Regions are mapped contiguously, so twice the memory limit leaves room
+    // for the holes that garbage collected regions leave behind.
+    auto allocator = GpuVirtualMemAllocator::Create(
+        alloc_visitors, {},
+        se::gpu::ExtractGpuExecutor(executor)->gpu_context(),
+        platform_device_id, 2 * total_bytes, peer_platform_device_ids);
+    if (allocator.ok()) {
+      LOG(INFO) << "Using virtual memory backed BFC allocator for GPU: "
+                << platform_device_id;
+      return *std::move(allocator);
+    }
+    LOG(WARNING) << "Failed to create the GPU virtual memory allocator, "
+                 << "falling back to the default one: " << allocator.status();
+  }
+#endif  // GOOGLE_CUDA
   return absl::WrapUnique(new se::DeviceMemAllocator(
       executor, platform_device_id,
       use_unified_memory ? stream_executor::MemoryType::kUnified
@@ -135,6 +135,56 @@ TEST(GpuServingDeviceSelector, DefaultPolicyOnlyEnqueueCall) {
       0e6);
 }
 
+TEST(GpuServingDeviceSelector, EarliestCompletionPolicy) {
+  ServingDeviceSelectorTestHelper helper;
+  GpuServingDeviceSelector selector(
+      /*num_devices=*/2, std::make_unique<tsl::EarliestCompletionPolicy>(
+                             /*device_miss_penalty_ns=*/0,
+                             ServingDeviceSelectorTestHelper::NowNs));
+  helper.ElapseNs(1);
+
+  // Execution times are only recorded for programs that run back-to-back.
+  selector.Enqueue(0, "slow");
+  selector.Enqueue(0, "slow");
+  selector.Enqueue(1, "fast");
+  selector.Enqueue(1, "fast");
+  helper.ElapseNs(1e6);
+  selector.Completed(1);
+  helper.ElapseNs(1e6);
+  selector.Completed(1);
+  helper.ElapseNs(8e6);
+  selector.Completed(0);
+  helper.ElapseNs(10e6);
+  selector.Completed(0);
+
+  // Device 0 is busy for 10ms, and device 1 for 3ms with more programs.
+  selector.Enqueue(0, "slow");
+  selector.Enqueue(1, "fast");
+  selector.Enqueue(1, "fast");
+  selector.Enqueue(1, "fast");
+  EXPECT_EQ(selector.ReserveDevice("fast").device_index(), 1);
+
+  // Once device 1 is busier, the programs go to device 0.
+  for (int i = 0; i < 10; ++i) selector.Enqueue(1, "fast");
+  EXPECT_EQ(selector.ReserveDevice("fast").device_index(), 0);
+}
+
+TEST(GpuServingDeviceSelector, EarliestCompletionPolicyDeviceMissPenalty) {
+  ServingDeviceSelectorTestHelper helper;
+  GpuServingDeviceSelector selector(
+      /*num_devices=*/2, std::make_unique<tsl::EarliestCompletionPolicy>(
+                             /*device_miss_penalty_ns=*/20000000,
+                             ServingDeviceSelectorTestHelper::NowNs));
+  helper.ElapseNs(1);
+
+  tsl::DeviceReservation reservation = selector.ReserveDevice("program");
+  EXPECT_EQ(reservation.device_index(), 0);
+  // Device 1 is idle, but the program is kept on device 0 it has been run on.
+  EXPECT_EQ(selector.ReserveDevice("program").device_index(), 0);
+  // Other programs are not affected.
+  EXPECT_EQ(selector.ReserveDevice("other").device_index(), 1);
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace tensorflow
@@ -0,0 +1,164 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
+
+#if defined(GOOGLE_CUDA) && GOOGLE_CUDA
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+
+namespace {
+
+using ::stream_executor::gpu::GpuContext;
+using ::stream_executor::gpu::GpuDeviceHandle;
+using ::stream_executor::gpu::GpuDevicePtr;
+using ::stream_executor::gpu::GpuDriver;
+
+size_t RoundUp(size_t value, size_t granularity) {
+  return (value + granularity - 1) / granularity * granularity;
+}
+
+}  // namespace
+
+/*static*/ absl::StatusOr<std::unique_ptr<GpuVirtualMemAllocator>>
+GpuVirtualMemAllocator::Create(
+    const std::vector<Visitor>& alloc_visitors,
+    const std::vector<Visitor>& free_visitors, GpuContext* gpu_context,
+    tsl::PlatformDeviceId gpu_id, size_t virtual_address_space_size,
+    const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids) {
+  std::vector<GpuDeviceHandle> access_device_handles;
+  access_device_handles.reserve(peer_gpu_ids.size() + 1);
+  GpuDeviceHandle device_handle;
+  TF_RETURN_IF_ERROR(GpuDriver::GetDevice(gpu_id.value(), &device_handle));
+  access_device_handles.push_back(device_handle);
+  for (tsl::PlatformDeviceId peer_id : peer_gpu_ids) {
+    if (peer_id == gpu_id) continue;
+    GpuDeviceHandle handle;
+    TF_RETURN_IF_ERROR(GpuDriver::GetDevice(peer_id.value(), &handle));
+    access_device_handles.push_back(handle);
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      uint64_t granularity,
+      GpuDriver::GetMinAllocationGranularity(device_handle));
+  TF_ASSIGN_OR_RETURN(
+      GpuDriver::VmemSpan vmem,
+      GpuDriver::ReserveVirtualMemory(
+          gpu_context, RoundUp(virtual_address_space_size, granularity)));
+  VLOG(1) << "Reserved GPU virtual memory at " << vmem.base << " of size "
+          << vmem.size_bytes << " bytes on GPU " << gpu_id
+          << " with granularity " << granularity;
+
+  return absl::WrapUnique(new GpuVirtualMemAllocator(
+      alloc_visitors, free_visitors, gpu_context, gpu_id,
+      std::move(access_device_handles), vmem, granularity));
+}
+
+GpuVirtualMemAllocator::GpuVirtualMemAllocator(
+    const std::vector<Visitor>& alloc_visitors,
+    const std::vector<Visitor>& free_visitors, GpuContext* gpu_context,
+    tsl::PlatformDeviceId gpu_id,
+    std::vector<GpuDeviceHandle> access_device_handles,
+    GpuDriver::VmemSpan vmem, size_t granularity)
+    : SubAllocator(alloc_visitors, free_visitors),
+      gpu_context_(gpu_context),
+      gpu_id_(gpu_id),
+      access_device_handles_(std::move(access_device_handles)),
+      vmem_(vmem),
+      granularity_(granularity) {}
+
+GpuVirtualMemAllocator::~GpuVirtualMemAllocator() {
+  for (const Mapping& mapping : mappings_) {
+    GpuDriver::UnmapMemory(gpu_context_, mapping.va, mapping.physical.bytes);
+    GpuDriver::ReleaseMemoryHandle(gpu_context_, mapping.physical);
+  }
+  GpuDriver::FreeVirtualMemory(gpu_context_, vmem_);
+}
+
+void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes,
+                                    size_t* bytes_received) {
+  if (num_bytes == 0) return nullptr;
+  const size_t padded_bytes = RoundUp(num_bytes, granularity_);
+  if (next_alloc_offset_ + padded_bytes > vmem_.size_bytes) {
+    LOG(ERROR) << "GPU virtual memory of GPU " << gpu_id_ << " exhausted: "
+               << next_alloc_offset_ << " of " << vmem_.size_bytes
+               << " bytes are mapped, " << padded_bytes << " more requested.";
+    return nullptr;
+  }
+
+  absl::StatusOr<GpuDriver::GenericMemoryHandle> physical =
+      GpuDriver::CreateMemoryHandle(gpu_context_, padded_bytes);
+  if (!physical.ok()) {
+    LOG(ERROR) << physical.status();
+    return nullptr;
+  }
+  const GpuDevicePtr va = vmem_.base + next_alloc_offset_;
+  absl::Status status =
+      GpuDriver::MapMemory(gpu_context_, va, *physical, access_device_handles_);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    GpuDriver::ReleaseMemoryHandle(gpu_context_, *physical);
+    return nullptr;
+  }
+
+  next_alloc_offset_ += padded_bytes;
+  mappings_.push_back({va, *physical});
+  void* ptr = reinterpret_cast<void*>(va);
+  VisitAlloc(ptr, gpu_id_.value(), padded_bytes);
+  *bytes_received = padded_bytes;
+  return ptr;
+}
+
+void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
+  if (ptr == nullptr) return;
+  VisitFree(ptr, gpu_id_.value(), num_bytes);
+
+  const GpuDevicePtr begin = reinterpret_cast<GpuDevicePtr>(ptr);
+  const GpuDevicePtr end = begin + num_bytes;
+  auto first = std::lower_bound(
+      mappings_.begin(), mappings_.end(), begin,
+      [](const Mapping& mapping, GpuDevicePtr va) { return mapping.va < va; });
+  auto last = first;
+  for (; last != mappings_.end() && last->va < end; ++last) {
+    CHECK_LE(last->va + last->physical.bytes, end)
+        << "Freeing part of a GPU virtual memory mapping";
+    GpuDriver::UnmapMemory(gpu_context_, last->va, last->physical.bytes);
+    GpuDriver::ReleaseMemoryHandle(gpu_context_, last->physical);
+  }
+  mappings_.erase(first, last);
+
+  // Hand the top of the address range out again once it is unmapped. Holes
+  // below stay unused, the range is reserved large enough for that.
+  if (end == vmem_.base + next_alloc_offset_) {
+    next_alloc_offset_ =
+        mappings_.empty() ? 0
+                          : mappings_.back().va +
+                                mappings_.back().physical.bytes - vmem_.base;
+  }
+}
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
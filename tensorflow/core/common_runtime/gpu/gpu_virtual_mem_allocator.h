@@ -0,0 +1,104 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_VIRTUAL_MEM_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_VIRTUAL_MEM_ALLOCATOR_H_
+
+#if defined(GOOGLE_CUDA) && GOOGLE_CUDA
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xla/stream_executor/gpu/gpu_driver.h"
+#include "xla/stream_executor/gpu/gpu_types.h"
+#include "tsl/framework/allocator.h"
+#include "tsl/framework/device_id.h"
+
+namespace tensorflow {
+
+// A SubAllocator that reserves one range of virtual GPU addresses up front and
+// maps physical memory into it as the BFC allocator grows. Successive regions
+// are contiguous, so the BFC allocator can coalesce them and serve allocations
+// larger than any single region, which avoids the out of memory errors of a
+// fragmented device. Regions freed by the BFC allocator's garbage collection
+// are unmapped, returning their physical memory to the device.
+class GpuVirtualMemAllocator : public tsl::SubAllocator {
+ public:
+  // Reserves `virtual_address_space_size` bytes of addresses on `gpu_id`. The
+  // memory is also made accessible to `peer_gpu_ids`.
+  static absl::StatusOr<std::unique_ptr<GpuVirtualMemAllocator>> Create(
+      const std::vector<Visitor>& alloc_visitors,
+      const std::vector<Visitor>& free_visitors,
+      stream_executor::gpu::GpuContext* gpu_context,
+      tsl::PlatformDeviceId gpu_id, size_t virtual_address_space_size,
+      const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids);
+  ~GpuVirtualMemAllocator() override;
+
+  // Maps at least `num_bytes` of physical memory after the previously mapped
+  // memory. `alignment` is ignored, the memory is aligned to the allocation
+  // granularity of the device.
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override;
+
+  // Unmaps and releases the physical memory of [ptr, ptr + num_bytes), which
+  // must cover whole calls to Alloc.
+  void Free(void* ptr, size_t num_bytes) override;
+
+  bool SupportsCoalescing() const override { return true; }
+
+  tsl::AllocatorMemoryType GetMemoryType() const override {
+    return tsl::AllocatorMemoryType::kDevice;
+  }
+
+ private:
+  GpuVirtualMemAllocator(
+      const std::vector<Visitor>& alloc_visitors,
+      const std::vector<Visitor>& free_visitors,
+      stream_executor::gpu::GpuContext* gpu_context,
+      tsl::PlatformDeviceId gpu_id,
+      std::vector<stream_executor::gpu::GpuDeviceHandle> access_device_handles,
+      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity);
+
+  // The physical memory mapped at an address by one call to Alloc.
+  struct Mapping {
+    stream_executor::gpu::GpuDevicePtr va;
+    stream_executor::gpu::GpuDriver::GenericMemoryHandle physical;
+  };
+
+  stream_executor::gpu::GpuContext* const gpu_context_;
+  const tsl::PlatformDeviceId gpu_id_;
+  // The devices the memory is accessible from, starting with `gpu_id_`.
+  const std::vector<stream_executor::gpu::GpuDeviceHandle>
+      access_device_handles_;
+  const stream_executor::gpu::GpuDriver::VmemSpan vmem_;
+  const size_t granularity_;
+
+  // The offset in `vmem_` after the highest mapped address. Only the caller's
+  // BFC allocator lock serializes calls, like for other sub allocators.
+  size_t next_alloc_offset_ = 0;
+  // Sorted by address.
+  std::vector<Mapping> mappings_;
+
+  GpuVirtualMemAllocator(const GpuVirtualMemAllocator&) = delete;
+  void operator=(const GpuVirtualMemAllocator&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_VIRTUAL_MEM_ALLOCATOR_H_
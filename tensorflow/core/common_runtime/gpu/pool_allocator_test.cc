@@ -17,6 +17,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/pool_allocator.h"
 
+#include <optional>
+
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "xla/stream_executor/platform_manager.h"
 #include "tensorflow/core/common_runtime/device/device_host_allocator.h"
@@ -242,6 +244,65 @@ TEST(PoolAllocatorTest, Pow2Rounder) {
   EXPECT_EQ(65536, rounder.RoundUp(65536));
 }
 
+TEST(PoolAllocatorTest, SizeClassRounder) {
+  SizeClassRounder rounder(4);
+  EXPECT_EQ(1, rounder.RoundUp(1));
+  EXPECT_EQ(2, rounder.RoundUp(2));
+  EXPECT_EQ(10, rounder.RoundUp(9));
+  EXPECT_EQ(16, rounder.RoundUp(16));
+  EXPECT_EQ(640, rounder.RoundUp(600));
+  EXPECT_EQ(1024, rounder.RoundUp(1000));
+  EXPECT_EQ(49152, rounder.RoundUp(41234));
+  EXPECT_EQ(65536, rounder.RoundUp(65535));
+  EXPECT_EQ(65536, rounder.RoundUp(65536));
+}
+
+TEST(PoolAllocatorTest, PrefillAndStats) {
+  se::Platform* platform =
+      se::PlatformManager::PlatformWithName(se::GpuPlatformName()).value();
+  PoolAllocator pool(
+      4 /*pool_size_limit*/, false /*auto_resize*/,
+      new DeviceHostAllocator(
+          platform->GetExecutor(se::StreamExecutorConfig(/*ordinal=*/0))
+              .value(),
+          0 /*numa_node*/, {}, {}),
+      new SizeClassRounder, "pool");
+
+  // Only as many regions as the pool can hold are added.
+  EXPECT_EQ(4, pool.Prefill(4 /*alignment*/, 1000 /*num_bytes*/, 8));
+  std::optional<AllocatorStats> stats = pool.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, stats->bytes_in_use);
+  EXPECT_EQ(4 * 1024, *stats->pool_bytes);
+  EXPECT_EQ(1024, stats->largest_free_block_bytes);
+
+  // Requests in the same size class are served from the prefilled regions.
+  void* p1 = pool.AllocateRaw(4, 1000);
+  void* p2 = pool.AllocateRaw(4, 990);
+  EXPECT_NE(nullptr, p1);
+  EXPECT_NE(nullptr, p2);
+  EXPECT_EQ(2, pool.get_from_pool_count());
+  EXPECT_EQ(0, pool.allocated_count());
+  stats = pool.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(2, stats->num_allocs);
+  EXPECT_EQ(2 * 1024, stats->bytes_in_use);
+  EXPECT_EQ(4 * 1024, *stats->pool_bytes);
+
+  pool.DeallocateRaw(p1);
+  pool.DeallocateRaw(p2);
+  stats = pool.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, stats->bytes_in_use);
+  EXPECT_EQ(2 * 1024, stats->peak_bytes_in_use);
+  EXPECT_EQ(4 * 1024, *stats->pool_bytes);
+
+  pool.Clear();
+  stats = pool.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, *stats->pool_bytes);
+}
+
 TEST(PoolAllocatorTest, Name) {
   se::Platform* platform =
       se::PlatformManager::PlatformWithName(se::GpuPlatformName()).value();
@@ -31,6 +31,7 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/shape_refiner.h"
 #include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/graph_debug_info.pb.h"
@@ -50,9 +51,12 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
@@ -63,6 +67,16 @@ namespace {
 // can skip expensive duplicates check in 'AddControlEdge'.
 static constexpr const bool kDoNotCheckDuplicates = true;
 
+// Graphs with fewer nodes prepare their NodeDefs on the calling thread, the
+// parallel preparation does not pay off for them.
+static constexpr int kMinNodesForParallelPreparation = 4096;
+
+thread::ThreadPool* NodeDefPreparationThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "graph_import", port::MaxParallelism());
+  return pool;
+}
+
 inline bool IsMerge(const NodeDef& node_def) {
   return node_def.op() == "Merge" || node_def.op() == "RefMerge" ||
          node_def.op() == "_XlaMerge";
@@ -107,7 +121,8 @@ class GraphConstructor {
           importing(false),
           validate_nodes(in.validate_nodes),
           validate_colocation_constraints(false),
-          add_default_attributes(in.add_default_attributes) {}
+          add_default_attributes(in.add_default_attributes),
+          parallel_node_def_preparation(in.parallel_node_def_preparation) {}
     Options(const ImportGraphDefOptions& in)  // NOLINT(runtime/explicit)
         : allow_internal_ops(false),
           expect_device_spec(false),
@@ -161,6 +176,10 @@ class GraphConstructor {
     // value to the Node when they are missing from the NodeDef.
     bool add_default_attributes = true;
 
+    // If true, Convert() prepares the NodeDefs of large graphs in parallel,
+    // see GraphConstructorOptions.
+    bool parallel_node_def_preparation = false;
+
     string default_device;
   };
 
@@ -198,6 +217,8 @@ class GraphConstructor {
   virtual ~GraphConstructor() {}
 
   Status TryImport() {
+    Env* env = Env::Default();
+    const uint64 index_start_usecs = env->NowMicros();
     TF_RETURN_IF_ERROR(EnsureNoNameCollisions());
     TF_RETURN_IF_ERROR(ValidateInputMapAndControlDependencies());
     TF_RETURN_IF_ERROR(BuildNodeIndex());
@@ -205,8 +226,18 @@ class GraphConstructor {
 
     // NOTE: Convert() invokes `consume_node_def()` on each node in the input
     // graph, so `get_node_def()` is no longer usable once it is called.
+    const uint64 convert_start_usecs = env->NowMicros();
     TF_RETURN_IF_ERROR(Convert());
 
+    const uint64 finalize_start_usecs = env->NowMicros();
+    metrics::UpdateGraphImportTime("index",
+                                   convert_start_usecs - index_start_usecs);
+    metrics::UpdateGraphImportTime("prepare_node_defs", prepare_usecs_);
+    metrics::UpdateGraphImportTime("shape_inference", shape_inference_usecs_);
+    metrics::UpdateGraphImportTime(
+        "convert", finalize_start_usecs - convert_start_usecs -
+                       prepare_usecs_ - shape_inference_usecs_);
+
     TF_RETURN_IF_ERROR(AddBackEdges());
     TF_RETURN_IF_ERROR(UpdateVersionDef());
     TF_RETURN_IF_ERROR(PopulateReturnTensors());
@@ -214,6 +245,8 @@ class GraphConstructor {
     TF_RETURN_IF_ERROR(PopulateMissingUnusedInputMapKeys());
     UpdateUniquifiedColocationNames();
     FixupSourceAndSinkEdges(g_);
+    metrics::UpdateGraphImportTime("finalize",
+                                   env->NowMicros() - finalize_start_usecs);
     return absl::OkStatus();
   }
 
@@ -222,6 +255,11 @@ class GraphConstructor {
   Status ValidateInputMapAndControlDependencies();
   Status BuildNodeIndex();
   Status InitFromEdges();
+  // Looks up the OpDefs of the NodeDefs, adds their default attributes and
+  // validates them on a thread pool, ahead of Convert() adding the nodes in
+  // topological order. Nodes that fail are left to Convert(), which reports
+  // the same errors as without the preparation.
+  void PrepareNodeDefs();
   Status Convert();
   Status AddBackEdges();
   Status UpdateVersionDef();
@@ -300,6 +338,12 @@ class GraphConstructor {
   // possible. After calling this method, the result of get_node_def(i) is
   // undefined.
   virtual NodeDef consume_node_def(int i) = 0;
+  // Makes mutable_node_def() usable. Called once, before mutable_node_def().
+  virtual void EnableMutableNodeDefs() {}
+  // Returns the i^th node in the graph for modification, copying it if it is
+  // not owned. May be called concurrently for different nodes. Must not be
+  // called after consume_node_def(i).
+  virtual NodeDef* mutable_node_def(int i) = 0;
   // Returns the version information for the graph, or nullptr if none is
   // available.
   virtual const VersionDef* versions() const = 0;
@@ -337,6 +381,17 @@ class GraphConstructor {
   // Intermediate datastructure used to track the destinations of back edges.
   absl::flat_hash_set<int> merge_node_indices_;
 
+  // Total number of inputs of the NodeDefs, used to pre-size the Graph.
+  int64_t num_gdef_inputs_ = 0;
+
+  // prepared_[i] is true if PrepareNodeDefs() already looked up, defaulted
+  // and validated the i^th NodeDef. Empty if it did not run.
+  std::vector<char> prepared_;
+
+  // Time spent in PrepareNodeDefs() and in shape inference.
+  uint64 prepare_usecs_ = 0;
+  uint64 shape_inference_usecs_ = 0;
+
   // Mapping from node name to the index within node_defs_.
   struct NodeInfo {
     explicit NodeInfo(int i) : gdef_index(i), node(nullptr) {}
@@ -433,8 +488,23 @@ class NodeDefCopyingGraphConstructor : public GraphConstructor {
 
  private:
   size_t node_def_count() const override { return node_defs_.size(); }
-  const NodeDef& get_node_def(int i) const override { return *node_defs_[i]; }
-  NodeDef consume_node_def(int i) override { return *node_defs_[i]; }
+  const NodeDef& get_node_def(int i) const override {
+    return is_copied(i) ? copies_[i] : *node_defs_[i];
+  }
+  NodeDef consume_node_def(int i) override {
+    return is_copied(i) ? std::move(copies_[i]) : *node_defs_[i];
+  }
+  void EnableMutableNodeDefs() override {
+    copies_.resize(node_defs_.size());
+    is_copied_.resize(node_defs_.size(), false);
+  }
+  NodeDef* mutable_node_def(int i) override {
+    if (!is_copied_[i]) {
+      copies_[i] = *node_defs_[i];
+      is_copied_[i] = true;
+    }
+    return &copies_[i];
+  }
   const VersionDef* versions() const override { return versions_; }
   std::optional<FunctionDefLibrary> consume_library() override {
     if (library_ == nullptr) {
@@ -445,10 +515,17 @@ class NodeDefCopyingGraphConstructor : public GraphConstructor {
   }
   const GraphDebugInfo* debug_info() const override { return debug_info_; }
 
+  bool is_copied(int i) const { return !is_copied_.empty() && is_copied_[i]; }
+
   const NodeDefSlice node_defs_;
   const VersionDef* const versions_;
   const FunctionDefLibrary* const library_;
   const GraphDebugInfo* const debug_info_;
+
+  // Copies of the nodes made by mutable_node_def(). The flags are chars so
+  // that different nodes can be copied concurrently.
+  std::vector<NodeDef> copies_;
+  std::vector<char> is_copied_;
 };
 
 // Implementation of GraphConstructor that takes ownership of the input
@@ -477,6 +554,11 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
     is_consumed_[i] = true;
     return std::move(*graph_def_.mutable_node(i));
   }
+  NodeDef* mutable_node_def(int i) override {
+    CHECK(!is_consumed_[i])
+        << "NodeDef " << i << " accessed after it was consumed.";
+    return graph_def_.mutable_node(i);
+  }
   const VersionDef* versions() const override { return &graph_def_.versions(); }
   std::optional<FunctionDefLibrary> consume_library() override {
     return std::move(*graph_def_.mutable_library());
@@ -675,6 +757,7 @@ Status GraphConstructor::ValidateInputMapAndControlDependencies() {
 
 Status GraphConstructor::BuildNodeIndex() {
   // Validate the node names and add them to gdef_nodes_ and gdef_prefixes_.
+  gdef_nodes_.reserve(node_def_count());
   for (int n = 0; n < node_def_count(); ++n) {
     const NodeDef& node_def = get_node_def(n);
     if (!IsValidNodeName(node_def.name(), opts_.allow_internal_ops)) {
@@ -733,6 +816,7 @@ Status GraphConstructor::InitFromEdges() {
   for (int n = 0; n < num_nodes; ++n) {
     const NodeDef& node_def = get_node_def(n);
     int pending_count = node_def.input_size();
+    num_gdef_inputs_ += node_def.input_size();
     if (IsMerge(node_def)) {
       // Cycles in the graph are only allowed for while loops. A while loop is
       // identified by an edge from a NextIteration node to a Merge node. For
@@ -1161,6 +1245,39 @@ GraphConstructor::CreateStackTracesForFunctionDefLibrary(
   }
 }
 
+void GraphConstructor::PrepareNodeDefs() {
+  // When importing, Convert() rewrites the NodeDefs before validating them.
+  if (opts_.importing || !opts_.parallel_node_def_preparation ||
+      (!opts_.add_default_attributes && !opts_.validate_nodes) ||
+      node_def_count() < kMinNodesForParallelPreparation) {
+    return;
+  }
+  const uint64 start_usecs = Env::Default()->NowMicros();
+  EnableMutableNodeDefs();
+  prepared_.resize(node_def_count(), false);
+  // Rough cost of preparing one NodeDef, in cycles.
+  const int64_t kCostPerNodeDef = 10000;
+  NodeDefPreparationThreadPool()->ParallelFor(
+      node_def_count(), kCostPerNodeDef, [this](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          NodeDef* node_def = mutable_node_def(i);
+          const OpDef* op_def;
+          if (!g_->op_registry()->LookUpOpDef(node_def->op(), &op_def).ok()) {
+            continue;
+          }
+          if (opts_.add_default_attributes) {
+            AddDefaultsToNodeDef(*op_def, node_def);
+          }
+          if (opts_.validate_nodes &&
+              !ValidateNodeDef(*node_def, *op_def).ok()) {
+            continue;
+          }
+          prepared_[i] = true;
+        }
+      });
+  prepare_usecs_ = Env::Default()->NowMicros() - start_usecs;
+}
+
 Status GraphConstructor::Convert() {
   if (debug_info() != nullptr) {
     traces_ = LoadTracesFromDebugInfo(*debug_info());
@@ -1185,6 +1302,10 @@ Status GraphConstructor::Convert() {
         g_->AddFunctionLibrary(*std::move(library), library_traces));
   }
 
+  // The NodeDefs may use the functions added above.
+  PrepareNodeDefs();
+  g_->Reserve(node_def_count(), num_gdef_inputs_);
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1297,7 +1418,7 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
-    } else {
+    } else if (prepared_.empty() || !prepared_[o]) {
       const OpDef* op_def;
       TF_RETURN_IF_ERROR(
           g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
@@ -1341,7 +1462,10 @@ Status GraphConstructor::Convert() {
       }
     }
 
+    const uint64 shape_inference_start_usecs = Env::Default()->NowMicros();
     TF_RETURN_IF_ERROR(ValidateShape(node));
+    shape_inference_usecs_ +=
+        Env::Default()->NowMicros() - shape_inference_start_usecs;
 
     // Update pending_count_ for outputs.
     UpdatePendingCountAndReady(o, node->IsNextIteration());
@@ -52,6 +52,11 @@ struct GraphConstructorOptions {
   // If true, GraphConstructor will add attributes with their default
   // value to the Node when they are missing from the NodeDef.
   bool add_default_attributes = true;
+
+  // If true, the OpDef lookup, attribute defaulting and validation of the
+  // NodeDefs of large graphs runs on a shared thread pool before the nodes
+  // are added to the Graph. The resulting Graph and errors are the same.
+  bool parallel_node_def_preparation = true;
 };
 extern Status ConvertGraphDefToGraph(const GraphConstructorOptions& opts,
                                      const GraphDef& gdef, Graph* g);
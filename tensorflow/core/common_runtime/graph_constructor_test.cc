@@ -925,6 +925,54 @@ TEST_F(GraphConstructorTest, Error_ControlEdgeBeforeRealInput) {
       {"Node 't2': Control dependencies must come after regular dependencies"});
 }
 
+// Large enough for the NodeDefs to be prepared in parallel.
+GraphDef LargeGraphDef(int num_nodes) {
+  GraphDef def;
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = def.add_node();
+    node->set_name(strings::StrCat("n", i));
+    node->set_op(i % 2 == 0 ? "TestDefaultAttr" : "TestOneInputOneOutput");
+    if (i % 2 == 1) {
+      node->add_input("x");
+      (*node->mutable_attr())["T"].set_type(DT_FLOAT);
+    }
+  }
+  NodeDef* x = def.add_node();
+  x->set_name("x");
+  x->set_op("TestParams");
+  return def;
+}
+
+TEST_F(GraphConstructorTest, ConvertLargeGraph) {
+  const GraphDef def = LargeGraphDef(10000);
+  GraphConstructorOptions opts;
+  opts.validate_nodes = true;
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, def, &graph_));
+  EXPECT_EQ(graph_.num_op_nodes(), 10001);
+  EXPECT_TRUE(HasEdge("x", 0, "n9999", 0));
+  int value = 0;
+  TF_ASSERT_OK(GetNodeAttr(FindNode("n9998")->attrs(), "default_int", &value));
+  EXPECT_EQ(value, 31415);
+
+  Graph moved_graph(OpRegistry::Global());
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, GraphDef(def), &moved_graph));
+  EXPECT_EQ(moved_graph.num_op_nodes(), 10001);
+}
+
+TEST_F(GraphConstructorTest, ConvertLargeGraphWithInvalidNode) {
+  GraphDef def = LargeGraphDef(10000);
+  (*def.mutable_node(5000)->mutable_attr())["bogus"].set_i(1);
+  GraphConstructorOptions opts;
+  opts.validate_nodes = true;
+  Status s = ConvertGraphDefToGraph(opts, def, &graph_);
+  EXPECT_TRUE(absl::StrContains(s.message(), "bogus")) << s;
+  EXPECT_EQ(graph_.num_op_nodes(), 0);
+
+  // Without validation the unknown attribute is accepted.
+  opts.validate_nodes = false;
+  TF_EXPECT_OK(ConvertGraphDefToGraph(opts, def, &graph_));
+}
+
 TEST_F(GraphConstructorTest, ImportGraphDef) {
   GraphDef def;
   ImportGraphDefOptions opts;
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GRAPH_VIEW_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GRAPH_VIEW_H_
 
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -101,6 +103,11 @@ struct NodeItem {
   // for this node.
   int input_start = 0;
 
+  // By how many nanoseconds this node can be delayed without delaying the
+  // graph, as estimated by Grappler in the "_critical_path_slack" attribute.
+  // The nodes on the critical path have a slack of 0.
+  int64_t critical_path_slack = std::numeric_limits<int64_t>::max();
+
   // Number of output edges, excluding control edges.
   int32 num_output_edges;
 
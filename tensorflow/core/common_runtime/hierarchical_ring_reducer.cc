@@ -0,0 +1,398 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+
+// Subdiv of the ring of the devices in a task.
+constexpr int kIntraTaskSubdiv = 0;
+// Subdiv of the ring of the devices with the same local index in each task.
+constexpr int kInterTaskSubdiv = 1;
+
+// Produces the BufRendezvous key of the chunk `chunk_idx` sent by the device
+// of group rank `source_rank` in `phase`.  Each chunk is sent at most once per
+// phase by each device, and the exec_key differentiates between instances.
+string HierarchicalRingBufKey(const string& exec_key, int phase, int chunk_idx,
+                              int source_rank) {
+  return strings::StrCat(exec_key, ":", phase, ":", chunk_idx, ":",
+                         source_rank);
+}
+
+}  // namespace
+
+HierarchicalRingReducer::HierarchicalRingReducer()
+    : col_ctx_(nullptr), col_params_(nullptr) {}
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  CHECK_EQ(col_params->instance.impl_details.collective_name,
+           "HierarchicalRingReduce");
+  const CollGroupParams& group = col_params->group;
+  // Count the devices in each task, which must be adjacent in the group.
+  std::vector<int> dev_per_task;
+  absl::flat_hash_set<string> tasks;
+  for (int di = 0; di < group.group_size; ++di) {
+    if (di == 0 || group.members[di].task != group.members[di - 1].task) {
+      if (!tasks.insert(group.members[di].task).second) {
+        return errors::InvalidArgument(
+            "HierarchicalRingReduce requires the devices of each task to be "
+            "adjacent in the group, but the devices of ",
+            group.members[di].task, " are not.");
+      }
+      dev_per_task.push_back(0);
+    }
+    ++dev_per_task.back();
+  }
+  const int num_tasks = static_cast<int>(dev_per_task.size());
+  const int num_devices_per_task = dev_per_task[0];
+  for (int num_devices : dev_per_task) {
+    if (num_devices != num_devices_per_task) {
+      return errors::InvalidArgument(
+          "HierarchicalRingReduce requires the same number of devices in each "
+          "task, but group ", group.group_key, " has tasks with ",
+          num_devices_per_task, " and ", num_devices, " devices.");
+    }
+  }
+
+  const int task_idx = col_params->default_rank / num_devices_per_task;
+  const int local_idx = col_params->default_rank % num_devices_per_task;
+  std::vector<std::vector<int>>& perms =
+      col_params->instance.impl_details.subdiv_permutations;
+  perms.assign(2, {});
+  for (int di = 0; di < num_devices_per_task; ++di) {
+    perms[kIntraTaskSubdiv].push_back(task_idx * num_devices_per_task + di);
+  }
+  for (int ti = 0; ti < num_tasks; ++ti) {
+    perms[kInterTaskSubdiv].push_back(ti * num_devices_per_task + local_idx);
+  }
+  col_params->subdiv_rank = {local_idx, task_idx};
+
+  VLOG(2) << collective_util::SubdivPermDebugString(*col_params);
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Since `HierarchicalRingReducer` doesn't require non-overlapping
+  // collectives, unblock any collective that is blocked on this instance.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  const std::vector<std::vector<int>>& perms =
+      col_params_->instance.impl_details.subdiv_permutations;
+  CHECK_EQ(perms.size(), 2);
+  const int num_devices_per_task =
+      static_cast<int>(perms[kIntraTaskSubdiv].size());
+  const int num_tasks = static_cast<int>(perms[kInterTaskSubdiv].size());
+  const int local_idx = col_params_->subdiv_rank[kIntraTaskSubdiv];
+  const int task_idx = col_params_->subdiv_rank[kInterTaskSubdiv];
+  VLOG(1) << "HierarchicalRingReducer::Run for device "
+          << col_ctx_->device_name << " default_rank "
+          << col_params_->default_rank << " num_tasks " << num_tasks
+          << " num_devices_per_task " << num_devices_per_task;
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+  }
+
+  // Chunk `l * num_tasks + t` is reduced across tasks by the device with
+  // local index l in task t.
+  const int num_chunks = num_devices_per_task * num_tasks;
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output, num_chunks,
+                                  col_ctx_->device->GetAllocator(attr)));
+  tmp_chunks_.resize(num_chunks);
+  for (int ci = 0; ci < num_chunks; ++ci) {
+    if (ca_->ChunkBytes(ci) > 0) {
+      tmp_chunks_[ci] = ca_->TempChunk(ci);
+    }
+  }
+  Status status;
+  const DeviceBase::AcceleratorDeviceInfo* gpu_info =
+      col_ctx_->device->tensorflow_accelerator_device_info();
+  if (gpu_info) {
+    // Wait for all currently queued events on the compute stream to complete,
+    // since the temp buffers are not guaranteed to be valid (e.g. for RDMA
+    // write) until then.
+    Notification note;
+    status = gpu_info->default_context->ThenExecute(
+        col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); });
+    if (status.ok()) {
+      note.WaitForNotification();
+    }
+  }
+
+  // Segment l of the intra-task rings holds the chunks which the device with
+  // local index l reduces across tasks.
+  std::vector<std::vector<int>> intra_task_segments(num_devices_per_task);
+  for (int li = 0; li < num_devices_per_task; ++li) {
+    for (int ti = 0; ti < num_tasks; ++ti) {
+      intra_task_segments[li].push_back(li * num_tasks + ti);
+    }
+  }
+  std::vector<std::vector<int>> inter_task_segments(num_tasks);
+  for (int ti = 0; ti < num_tasks; ++ti) {
+    inter_task_segments[ti].push_back(local_idx * num_tasks + ti);
+  }
+
+  if (status.ok()) {
+    status = RunRing(/*phase=*/0, kIntraTaskSubdiv, intra_task_segments,
+                     /*reduce=*/true);
+  }
+  if (status.ok()) {
+    status = RunRing(/*phase=*/1, kInterTaskSubdiv, inter_task_segments,
+                     /*reduce=*/true);
+  }
+  if (status.ok() && col_params_->final_op) {
+    Tensor chunk = ca_->ChunkAlias(local_idx * num_tasks + task_idx);
+    status = Finalize(&chunk);
+  }
+  if (status.ok()) {
+    status = RunRing(/*phase=*/2, kInterTaskSubdiv, inter_task_segments,
+                     /*reduce=*/false);
+  }
+  if (status.ok()) {
+    status = RunRing(/*phase=*/3, kIntraTaskSubdiv, intra_task_segments,
+                     /*reduce=*/false);
+  }
+
+  tmp_chunks_.clear();
+  if (status.ok()) {
+    // Recover the output from the adaptor.
+    ca_->ConsumeFinalValue(col_ctx_->output);
+  }
+  ca_.reset();
+  {
+    mutex_lock l(status_mu_);
+    status_.Update(status);
+    status = status_;
+  }
+  done(status);
+}
+
+Status HierarchicalRingReducer::RunRing(
+    int phase, int subdiv, const std::vector<std::vector<int>>& segments,
+    bool reduce) {
+  tsl::profiler::TraceMe activity(
+      [&] { return strings::StrCat("HierarchicalRingReduce:", phase); },
+      tsl::profiler::TraceMeLevel::kInfo);
+  const int ring_size = static_cast<int>(segments.size());
+  const int rank = col_params_->subdiv_rank[subdiv];
+  for (int step = 0; step < ring_size - 1; ++step) {
+    // In a reduce-scatter the device of rank r ends up owning segment r, and
+    // in an all-gather it starts with segment r.
+    const int send_segment = reduce
+                                 ? (rank + 2 * ring_size - step - 1) % ring_size
+                                 : (rank + ring_size - step) % ring_size;
+    const int recv_segment = (send_segment + ring_size - 1) % ring_size;
+
+    std::vector<std::pair<int, Tensor>> send_chunks;
+    for (int ci : segments[send_segment]) {
+      if (ca_->ChunkBytes(ci) > 0) {
+        send_chunks.emplace_back(ci, ca_->ChunkAlias(ci));
+      }
+    }
+    std::vector<std::pair<int, Tensor>> recv_chunks;
+    for (int ci : segments[recv_segment]) {
+      if (ca_->ChunkBytes(ci) > 0) {
+        recv_chunks.emplace_back(ci, ca_->ChunkAlias(ci));
+      }
+    }
+
+    BlockingCounter pending(
+        static_cast<int>(send_chunks.size() + recv_chunks.size()));
+    auto op_done = [this, &pending](const Status& s) {
+      if (!s.ok()) StartAbort(s);
+      pending.DecrementCount();
+    };
+    for (auto& [ci, chunk] : recv_chunks) {
+      DispatchRecv(phase, subdiv, ci, reduce ? &tmp_chunks_[ci] : &chunk,
+                   op_done);
+    }
+    for (auto& [ci, chunk] : send_chunks) {
+      DispatchSend(phase, subdiv, ci, &chunk, op_done);
+    }
+    pending.Wait();
+    {
+      mutex_lock l(status_mu_);
+      TF_RETURN_IF_ERROR(status_);
+    }
+
+    if (reduce) {
+      for (auto& [ci, chunk] : recv_chunks) {
+        Status s = collective_util::ComputeBinOp(
+            col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+            col_params_->merge_op, &chunk, &tmp_chunks_[ci]);
+        if (!s.ok()) {
+          StartAbort(s);
+          return s;
+        }
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::Finalize(Tensor* chunk) {
+  if (chunk->NumElements() == 0) return absl::OkStatus();
+  Tensor group_size_tensor = ca_->Scalar(col_params_->group.group_size);
+  if (col_params_->group.device_type != "CPU") {
+    Tensor group_size_val = group_size_tensor;
+    group_size_tensor = ca_->Scalar(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+        AllocationAttributes());
+    Notification note;
+    Status status;
+    col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+        &group_size_val, col_ctx_->device, &group_size_tensor,
+        [&note, &status](const Status& s) {
+          status = s;
+          note.Notify();
+        });
+    note.WaitForNotification();
+    TF_RETURN_IF_ERROR(status);
+  }
+  return collective_util::ComputeBinOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->final_op, chunk, &group_size_tensor);
+}
+
+void HierarchicalRingReducer::DispatchSend(int phase, int subdiv,
+                                           int chunk_idx, Tensor* chunk,
+                                           const StatusCallback& done) {
+  const std::vector<int>& perm =
+      col_params_->instance.impl_details.subdiv_permutations[subdiv];
+  const int ring_size = static_cast<int>(perm.size());
+  const int dst_idx = perm[(col_params_->subdiv_rank[subdiv] + 1) % ring_size];
+  string send_buf_key = HierarchicalRingBufKey(
+      col_ctx_->exec_key, phase, chunk_idx, col_params_->default_rank);
+  VLOG(3) << "DispatchSend " << send_buf_key << " from_device "
+          << col_ctx_->device_name << " to_device "
+          << col_params_->group.members[dst_idx].device.name() << " chunk "
+          << ca_->TBounds(*chunk);
+  col_ctx_->col_exec->remote_access()->PostToPeer(
+      col_params_->group.members[dst_idx].device.name(),
+      col_params_->group.members[dst_idx].task, send_buf_key, col_ctx_->device,
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), chunk, col_ctx_->device_locality,
+      col_ctx_->op_ctx->cancellation_manager(), done);
+}
+
+void HierarchicalRingReducer::DispatchRecv(int phase, int subdiv,
+                                           int chunk_idx, Tensor* chunk,
+                                           const StatusCallback& done) {
+  const std::vector<int>& perm =
+      col_params_->instance.impl_details.subdiv_permutations[subdiv];
+  const int ring_size = static_cast<int>(perm.size());
+  const int src_idx =
+      perm[(col_params_->subdiv_rank[subdiv] + ring_size - 1) % ring_size];
+  string recv_buf_key =
+      HierarchicalRingBufKey(col_ctx_->exec_key, phase, chunk_idx, src_idx);
+  VLOG(3) << "DispatchRecv " << recv_buf_key << " from_device "
+          << col_params_->group.members[src_idx].device.name() << " to_device "
+          << col_ctx_->device_name;
+  col_ctx_->col_exec->remote_access()->RecvFromPeer(
+      col_params_->group.members[src_idx].device.name(),
+      col_params_->group.members[src_idx].task,
+      col_params_->group.members[src_idx].is_local, recv_buf_key,
+      col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), chunk, col_ctx_->device_locality,
+      subdiv /*dev_to_dev_stream_index*/,
+      col_ctx_->op_ctx->cancellation_manager(), done);
+}
+
+void HierarchicalRingReducer::StartAbort(const Status& s) {
+  // In abort mode we stop issuing additional sends and recvs, but we need to
+  // wait for all of the outstanding callbacks to be invoked before quitting.
+  bool abort_started = false;
+  {
+    mutex_lock l(status_mu_);
+    if (status_.ok()) {
+      LOG(ERROR) << "Aborting HierarchicalRingReduce with " << s;
+      abort_started = true;
+      status_.Update(s);
+    }
+  }
+  // Unless the collective is being cancelled, in which case the pending sends
+  // and recvs are cancelled as well, abort the CollectiveExecutor to cancel
+  // the outstanding CollectiveRemoteAccess actions.
+  if (abort_started) {
+    if (col_ctx_->op_ctx->cancellation_manager() == nullptr ||
+        (!col_ctx_->op_ctx->cancellation_manager()->IsCancelled() &&
+         !col_ctx_->op_ctx->cancellation_manager()->IsCancelling())) {
+      col_ctx_->col_exec->StartAbort(s);
+    }
+  }
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
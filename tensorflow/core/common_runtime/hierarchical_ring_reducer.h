@@ -0,0 +1,97 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Hierarchical implementation of collective all-reduce for groups which span
+// several tasks with the same number of devices each.
+//
+// With T tasks of L devices each, the tensor is split into L * T chunks and
+// reduced in three phases:
+// 1. A ring reduce-scatter among the devices of each task, after which the
+//    device with local index l holds the task-local sum of the l-th of L
+//    shards of the tensor.
+// 2. A ring all-reduce of that shard among the T devices with local index l,
+//    one in each task.  Only 1/L of the tensor crosses task boundaries per
+//    device, and the L inter-task rings run in parallel.
+// 3. A ring all-gather among the devices of each task.
+//
+// The intra-task phases move data through the local CollectiveRemoteAccess,
+// i.e. device-to-device copies, so the slower inter-task links carry L times
+// less data than with a flat ring over all devices.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer();
+  ~HierarchicalRingReducer() override = default;
+
+  // Establishes two subdiv permutations: subdiv 0 is the ring of the devices
+  // in this device's task and subdiv 1 is the ring of the devices with the
+  // same local index as this device, one in each task.  Returns an error if
+  // the devices of a task are not adjacent in the group or if the tasks have
+  // different numbers of devices.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Begins async execution of the hierarchical all-reduce.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Runs a ring reduce-scatter (if `reduce`) or all-gather (otherwise) in
+  // `subdiv` over `segments`, where segment i lists the chunks owned by the
+  // device of rank i in the subdiv.  Blocks until the ring completes.
+  Status RunRing(int phase, int subdiv,
+                 const std::vector<std::vector<int>>& segments, bool reduce);
+
+  // Applies the final op of the reduction to `chunk`.
+  Status Finalize(Tensor* chunk);
+
+  void DispatchSend(int phase, int subdiv, int chunk_idx, Tensor* chunk,
+                    const StatusCallback& done);
+  void DispatchRecv(int phase, int subdiv, int chunk_idx, Tensor* chunk,
+                    const StatusCallback& done);
+
+  // Called when a bad status is received that implies we should terminate
+  // execution and return a bad status.
+  void StartAbort(const Status& s);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  std::unique_ptr<CollectiveAdapter> ca_;
+  // Buffers into which the chunks reduced with this device's chunks are
+  // received.
+  std::vector<Tensor> tmp_chunks_;
+  mutex status_mu_;
+  Status status_ TF_GUARDED_BY(status_mu_);
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
@@ -0,0 +1,190 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinaryOp(const string& op, DataType dtype,
+                                      const DeviceType& device_type,
+                                      DeviceBase* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder("binary_op", op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      device_type, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalRingReducerTest : public ::testing::Test {
+ protected:
+  class DeviceInstance {
+   public:
+    DeviceInstance(int rank, const TensorShape& shape,
+                   CollectiveTestEnv* test_env)
+        : test_env_(test_env), tensor_(DT_FLOAT, shape) {
+      col_params_ =
+          CreateCollectiveParams(*test_env_, rank, "HierarchicalRingReduce",
+                                 REDUCTION_COLLECTIVE, DT_FLOAT, shape);
+      string dev_name = col_params_->group.members[rank].device.name();
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(dev_name, &device_));
+      merge_op_ = GetBinaryOp("Add", DT_FLOAT, test_env_->device_type, device_);
+      final_op_ = GetBinaryOp("Div", DT_FLOAT, test_env_->device_type, device_);
+      col_params_->merge_op = merge_op_.get();
+      col_params_->final_op = final_op_.get();
+    }
+
+    void DoReduce() {
+      status_ = RunCollective(test_env_, col_params_.get(), device_, &tensor_,
+                              &tensor_);
+    }
+
+    CollectiveTestEnv* test_env_;
+    Tensor tensor_;
+    Device* device_;
+    core::RefCountPtr<CollectiveParams> col_params_;
+    std::unique_ptr<OpKernel> merge_op_;
+    std::unique_ptr<OpKernel> final_op_;
+    Status status_;
+  };
+
+  void Init(int num_workers, int num_devices, int tensor_len, int fail_after) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    test_env_->remote_access->set_fail_after(fail_after);
+    for (int rank = 0; rank < num_workers * num_devices; ++rank) {
+      instances_.push_back(std::make_unique<DeviceInstance>(
+          rank, TensorShape({tensor_len}), test_env_.get()));
+    }
+  }
+
+  void Reduce() {
+    std::atomic<int> done(0);
+    for (auto& di : instances_) {
+      SchedClosure([&di, &done] {
+        di->DoReduce();
+        ++done;
+      });
+    }
+    while (done < static_cast<int>(instances_.size())) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+  }
+
+  void RunTest(int num_workers, int num_devices, int tensor_len) {
+    Init(num_workers, num_devices, tensor_len, /*fail_after=*/0);
+    std::vector<float> expected(tensor_len);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      auto values = instances_[di]->tensor_.flat<float>();
+      for (int i = 0; i < tensor_len; ++i) {
+        values(i) = di * 10 + i;
+        expected[i] += values(i);
+      }
+    }
+    Reduce();
+    for (int i = 0; i < tensor_len; ++i) {
+      expected[i] /= instances_.size();
+    }
+    for (const auto& instance : instances_) {
+      TF_EXPECT_OK(instance->status_);
+      test::ExpectTensorNear<float>(test::AsTensor<float>(expected),
+                                    instance->tensor_, 1e-5);
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  std::vector<std::unique_ptr<DeviceInstance>> instances_;
+};
+
+TEST_F(HierarchicalRingReducerTest, SingleWorker) { RunTest(1, 4, 1001); }
+
+TEST_F(HierarchicalRingReducerTest, SingleDevicePerWorker) {
+  RunTest(3, 1, 1001);
+}
+
+TEST_F(HierarchicalRingReducerTest, MultipleWorkers) { RunTest(2, 4, 4096); }
+
+TEST_F(HierarchicalRingReducerTest, UnevenChunks) { RunTest(3, 3, 1045); }
+
+TEST_F(HierarchicalRingReducerTest, TensorSmallerThanChunks) {
+  RunTest(2, 4, 3);
+}
+
+TEST_F(HierarchicalRingReducerTest, Failure) {
+  Init(/*num_workers=*/2, /*num_devices=*/4, /*tensor_len=*/4096,
+       /*fail_after=*/5);
+  Reduce();
+  for (const auto& instance : instances_) {
+    EXPECT_NE(instance->status_.message().find("Deliberate failure"),
+              string::npos);
+  }
+}
+
+TEST(HierarchicalRingReducerInitParamsTest, SubdivPermutations) {
+  auto test_env = CreateCollectiveTestEnv(/*num_workers=*/3,
+                                          /*num_devices_per_worker=*/2,
+                                          DEVICE_CPU);
+  core::RefCountPtr<CollectiveParams> cp =
+      CreateCollectiveParams(*test_env, /*rank=*/3, "HierarchicalRingReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({8}));
+  core::RefCountPtr<HierarchicalRingReducer> reducer(
+      new HierarchicalRingReducer());
+  TF_ASSERT_OK(reducer->InitializeCollectiveParams(cp.get()));
+  EXPECT_EQ(cp->instance.impl_details.subdiv_permutations,
+            (std::vector<std::vector<int>>{{2, 3}, {1, 3, 5}}));
+  EXPECT_EQ(cp->subdiv_rank, (std::vector<int>{1, 1}));
+}
+
+TEST(HierarchicalRingReducerInitParamsTest, NonAdjacentTaskDevices) {
+  auto test_env = CreateCollectiveTestEnv(/*num_workers=*/2,
+                                          /*num_devices_per_worker=*/2,
+                                          DEVICE_CPU);
+  core::RefCountPtr<CollectiveParams> cp =
+      CreateCollectiveParams(*test_env, /*rank=*/0, "HierarchicalRingReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({8}));
+  std::swap(cp->group.members[1], cp->group.members[2]);
+  core::RefCountPtr<HierarchicalRingReducer> reducer(
+      new HierarchicalRingReducer());
+  EXPECT_EQ(reducer->InitializeCollectiveParams(cp.get()).code(),
+            error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace tensorflow
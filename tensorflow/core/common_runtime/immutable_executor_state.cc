@@ -99,6 +99,7 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Preprocess every node in the graph to create an instance of op
   // kernel for each node.
   requires_control_flow_ = false;
+  has_critical_path_slacks_ = false;
   for (const Node* n : graph.nodes()) {
     if (IsSink(n)) continue;
     if (IsSwitch(n) || IsMerge(n) || IsEnter(n) || IsExit(n)) {
@@ -196,6 +197,10 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     item->is_recv_or_switch = IsRecv(n) || IsSwitch(n);
     item->is_next_iteration = IsNextIteration(n);
     item->is_distributed_communication = IsDistributedCommunication(n);
+    if (TryGetNodeAttr(n->attrs(), "_critical_path_slack",
+                       &item->critical_path_slack)) {
+      has_critical_path_slacks_ = true;
+    }
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
@@ -259,6 +264,7 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
+  InitializeFlatOutputEdges();
   return gview_.SetAllocAttrs(&graph, params_.device);
 }
 
@@ -378,4 +384,44 @@ void ImmutableExecutorState::InitializePending(const Graph* graph,
     }
   }
 }
+
+void ImmutableExecutorState::InitializeFlatOutputEdges() {
+  const int32_t num_nodes = gview_.num_nodes();
+  size_t num_edges = 0;
+  for (int32_t id = 0; id < num_nodes; ++id) {
+    const NodeItem* item = gview_.node(id);
+    if (item == nullptr) continue;
+    num_edges += item->num_output_edges + item->num_output_control_edges;
+  }
+
+  flat_edges_.clear();
+  flat_edges_.reserve(num_edges);
+  flat_edge_offsets_.assign(num_nodes, 0);
+  auto add_edge = [this](int32_t dst_id) -> FlatOutputEdge& {
+    FlatOutputEdge& flat_edge = flat_edges_.emplace_back();
+    flat_edge.dst_item = &gview_.node_ref(dst_id);
+    flat_edge.dst_pending_id = pending_ids_[dst_id];
+    flat_edge.dst_id = dst_id;
+    flat_edge.input_slot = -1;
+    flat_edge.output_slot = -1;
+    flat_edge.is_last = false;
+    return flat_edge;
+  };
+  for (int32_t id = 0; id < num_nodes; ++id) {
+    const NodeItem* item = gview_.node(id);
+    if (item == nullptr) continue;
+    flat_edge_offsets_[id] = flat_edges_.size();
+    for (const EdgeInfo& e : item->output_edges()) {
+      FlatOutputEdge& flat_edge = add_edge(e.dst_id);
+      flat_edge.input_slot = e.input_slot;
+      flat_edge.output_slot = e.output_slot;
+      flat_edge.is_last = e.is_last;
+    }
+    for (const ControlEdgeInfo& e : item->output_control_edges()) {
+      add_edge(e.dst_id);
+    }
+  }
+  DCHECK_EQ(flat_edges_.size(), num_edges);
+}
+
 }  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/local_executor_params.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
@@ -74,6 +75,29 @@ class ImmutableExecutorState {
     int32 parallel_iterations;
   };
 
+  // An output edge of a node, flattened together with the information about
+  // its destination that is needed to propagate a value along it.
+  //
+  // The propagators walk these instead of `NodeItem::output_edges()`, so that
+  // each edge costs one sequential read, rather than additional dependent
+  // loads from `pending_ids()` and the `GraphView` node offsets.
+  struct FlatOutputEdge {
+    // The destination node of this edge.
+    const NodeItem* dst_item;
+    // The handle of `dst_item` in the pending counts of its frame.
+    PendingCounts::Handle dst_pending_id;
+    // The node ID of `dst_item` in `graph_view()`.
+    int32 dst_id;
+    // The location of the consumed input in the frame's input tensors.
+    // Unused for control edges.
+    int32 input_slot;
+    // The index of the output that produces values on this edge. Unused for
+    // control edges.
+    int32 output_slot : 31;
+    // true if this is the last edge for `output_slot`.
+    bool is_last : 1;
+  };
+
   explicit ImmutableExecutorState(const LocalExecutorParams& p)
       : params_(p), gview_() {}
   ~ImmutableExecutorState();
@@ -101,6 +125,29 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // True iff any node has a `NodeItem::critical_path_slack` estimate.
+  bool has_critical_path_slacks() const { return has_critical_path_slacks_; }
+
+  // Returns the flattened data output edges of `item`, in the same order as
+  // `item.output_edges()`.
+  absl::Span<const FlatOutputEdge> flat_output_edges(
+      const NodeItem& item) const {
+    return absl::Span<const FlatOutputEdge>(
+        flat_edges_.data() + flat_edge_offsets_[item.node_id],
+        item.num_output_edges);
+  }
+
+  // Returns the flattened control output edges of `item`, in the same order
+  // as `item.output_control_edges()`. They immediately follow the data edges
+  // of `item` in memory.
+  absl::Span<const FlatOutputEdge> flat_output_control_edges(
+      const NodeItem& item) const {
+    return absl::Span<const FlatOutputEdge>(
+        flat_edges_.data() + flat_edge_offsets_[item.node_id] +
+            item.num_output_edges,
+        item.num_output_control_edges);
+  }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -125,6 +172,7 @@ class ImmutableExecutorState {
   static Status BuildControlFlowInfo(const Graph* graph,
                                      ControlFlowInfo* cf_info);
   void InitializePending(const Graph* graph, const ControlFlowInfo& cf_info);
+  void InitializeFlatOutputEdges();
 
   FrameInfo* EnsureFrameInfo(const string& fname);
 
@@ -132,6 +180,7 @@ class ImmutableExecutorState {
   LocalExecutorParams params_;
   GraphView gview_;
   bool requires_control_flow_;
+  bool has_critical_path_slacks_;
   std::vector<PendingCounts::Handle> pending_ids_;
 
   // Root nodes (with no in edges) that should form the initial ready queue
@@ -152,6 +201,12 @@ class ImmutableExecutorState {
   // pending counts for the nodes in the graph, indexed by node ID.
   std::unique_ptr<std::atomic<int32>[]> atomic_pending_counts_;
 
+  // The output edges of all nodes, stored contiguously: the data edges of a
+  // node followed by its control edges. `flat_edge_offsets_[id]` is the index
+  // of the first edge of the node with the given ID.
+  std::vector<FlatOutputEdge> flat_edges_;
+  std::vector<int32> flat_edge_offsets_;
+
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
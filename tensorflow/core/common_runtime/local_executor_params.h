@@ -50,6 +50,12 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // If positive, kernel allocations with default allocator attributes are
+  // served from a reusable arena, once the buffer sizes allocated per step have
+  // been stable for this many consecutive steps. See
+  // `ArenaPlanningAllocator` for details. Supported by the default executor.
+  int arena_planning_steps = 0;
 };
 
 }  // end namespace tensorflow
@@ -80,10 +80,13 @@ void NextPluggableDeviceContext::CopyDeviceTensorToCPU(
   TF_Tensor* c_cpu_tensor = TF_TensorFromTensor(*cpu_tensor, &s);
   if (!s.ok()) {
     done(s);
+    return;
   }
   TF_Tensor* c_device_tensor = TF_TensorFromTensor(*device_tensor, &s);
   if (!s.ok()) {
+    TF_DeleteTensor(c_cpu_tensor);
     done(s);
+    return;
   }
 
   TF_Status* c_status = TF_NewStatus();
@@ -109,10 +112,13 @@ void NextPluggableDeviceContext::CopyCPUTensorToDevice(
   TF_Tensor* c_cpu_tensor = TF_TensorFromTensor(*cpu_tensor, &s);
   if (!s.ok()) {
     done(s);
+    return;
   }
   TF_Tensor* c_device_tensor = TF_TensorFromTensor(*device_tensor, &s);
   if (!s.ok()) {
+    TF_DeleteTensor(c_cpu_tensor);
     done(s);
+    return;
   }
 
   TF_Status* c_status = TF_NewStatus();
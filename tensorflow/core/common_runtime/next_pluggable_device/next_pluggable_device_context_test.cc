@@ -0,0 +1,146 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/next_pluggable_device/next_pluggable_device_context.h"
+
+#include <vector>
+
+#include "tensorflow/c/tf_status.h"
+#include "tensorflow/core/common_runtime/next_pluggable_device/c/plugin_c_api.h"
+#include "tensorflow/core/common_runtime/next_pluggable_device/next_pluggable_device_api.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/test.h"
+
+struct TFNPD_DeviceEvent {};
+
+namespace tensorflow {
+namespace {
+
+// The number of transfers started through the fake plugin.
+int num_transfers = 0;
+
+TFNPD_DeviceEvent* FailTransfer(TF_Status* status) {
+  ++num_transfers;
+  TF_SetStatus(status, TF_INTERNAL, "injected transfer failure");
+  return new TFNPD_DeviceEvent;
+}
+
+// A plugin whose transfers all fail, and whose events are always ready.
+const TFNPD_Api* FailingTransfersApi() {
+  static const TFNPD_Api* api = [] {
+    auto* api = new TFNPD_Api{TFNPD_Api_STRUCT_SIZE};
+    api->TFNPD_DeviceContextCreate = [](int) -> TFNPD_DeviceContext* {
+      return nullptr;
+    };
+    api->TFNPD_DeviceContextDelete = [](TFNPD_DeviceContext*) {};
+    api->TFNPD_DeviceTensorToHostTensor =
+        [](TFNPD_DeviceContext*, const TF_Tensor*, TF_Tensor*,
+           TF_Status* status) { return FailTransfer(status); };
+    api->TFNPD_HostTensorToDeviceTensor =
+        [](TFNPD_DeviceContext*, const TF_Tensor*, TF_Tensor*,
+           TF_Status* status) { return FailTransfer(status); };
+    api->TFNPD_DeviceEventAndThen =
+        [](TFNPD_DeviceEvent*, void (*callback)(void*), void* callback_arg) {
+          callback(callback_arg);
+        };
+    api->TFNPD_DeviceEventDelete = [](TFNPD_DeviceEvent* event) {
+      delete event;
+    };
+    return api;
+  }();
+  return api;
+}
+
+class NextPluggableDeviceContextTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SetTfnpdApi(FailingTransfersApi());
+    num_transfers = 0;
+  }
+
+  // Returns the statuses `done` was called with by `copy`.
+  template <typename Copy>
+  static std::vector<Status> DoneStatuses(Copy copy) {
+    core::RefCountPtr<NextPluggableDeviceContext> context(
+        new NextPluggableDeviceContext(/*device_ordinal=*/0));
+    std::vector<Status> statuses;
+    copy(*context, [&statuses](const Status& s) { statuses.push_back(s); });
+    return statuses;
+  }
+
+  Tensor valid_ = test::AsTensor<float>({1, 2});
+  // Can't be converted to a TF_Tensor.
+  Tensor uninitialized_;
+};
+
+TEST_F(NextPluggableDeviceContextTest, CopyToDeviceReturnsTransferFailure) {
+  Tensor device_tensor = test::AsTensor<float>({0, 0});
+  std::vector<Status> statuses = DoneStatuses(
+      [&](NextPluggableDeviceContext& context, StatusCallback done) {
+        context.CopyCPUTensorToDevice(&valid_, nullptr, &device_tensor, done,
+                                      /*sync_dst_compute=*/true);
+      });
+  ASSERT_EQ(statuses.size(), 1);
+  EXPECT_TRUE(errors::IsInternal(statuses[0])) << statuses[0];
+  EXPECT_EQ(num_transfers, 1);
+}
+
+TEST_F(NextPluggableDeviceContextTest, CopyToCPUReturnsTransferFailure) {
+  Tensor cpu_tensor = test::AsTensor<float>({0, 0});
+  std::vector<Status> statuses = DoneStatuses(
+      [&](NextPluggableDeviceContext& context, StatusCallback done) {
+        context.CopyDeviceTensorToCPU(&valid_, "", nullptr, &cpu_tensor,
+                                      done);
+      });
+  ASSERT_EQ(statuses.size(), 1);
+  EXPECT_TRUE(errors::IsInternal(statuses[0])) << statuses[0];
+  EXPECT_EQ(num_transfers, 1);
+}
+
+TEST_F(NextPluggableDeviceContextTest, CopyToDeviceReturnsConversionFailure) {
+  Tensor device_tensor = test::AsTensor<float>({0, 0});
+  for (auto [cpu, device] : {std::make_pair(&uninitialized_, &device_tensor),
+                             std::make_pair(&valid_, &uninitialized_)}) {
+    std::vector<Status> statuses = DoneStatuses(
+        [&](NextPluggableDeviceContext& context, StatusCallback done) {
+          context.CopyCPUTensorToDevice(cpu, nullptr, device, done,
+                                        /*sync_dst_compute=*/true);
+        });
+    ASSERT_EQ(statuses.size(), 1);
+    EXPECT_TRUE(errors::IsFailedPrecondition(statuses[0])) << statuses[0];
+  }
+  EXPECT_EQ(num_transfers, 0);
+}
+
+TEST_F(NextPluggableDeviceContextTest, CopyToCPUReturnsConversionFailure) {
+  Tensor cpu_tensor = test::AsTensor<float>({0, 0});
+  for (auto [device, cpu] : {std::make_pair(&uninitialized_, &cpu_tensor),
+                             std::make_pair(&valid_, &uninitialized_)}) {
+    std::vector<Status> statuses = DoneStatuses(
+        [&](NextPluggableDeviceContext& context, StatusCallback done) {
+          context.CopyDeviceTensorToCPU(device, "", nullptr, cpu, done);
+        });
+    ASSERT_EQ(statuses.size(), 1);
+    EXPECT_TRUE(errors::IsFailedPrecondition(statuses[0])) << statuses[0];
+  }
+  EXPECT_EQ(num_transfers, 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstdlib>
 #include <iterator>
+#include <map>
 #include <memory>
 #include <string>
 #include <type_traits>
@@ -26,6 +27,8 @@ limitations under the License.
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
@@ -48,12 +51,14 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/debug_data_dumper.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
-#include "tsl/platform/host_info.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/statusor.h"
@@ -232,29 +237,68 @@ absl::StatusOr<OptimizedFunctionGraphInfo> ReadFromCache(
   return optimized_function_graph_info_restored;
 }
 
-// Gets the full path name of the file cache.
-// TODO(b/276813768) Include more runtime specific info like env/flag
-// values, or line number. An alternative is to use the fingerprint of the
-// graph once graph building cache is enabled.
-//
-// Current file cache key components:
-// 1) Job name.
-// 2) Task ID.
-// 3) Function name (without UUID suffix).
-// 4) TF graph node count.
-string GetFileCacheName(const string& dir_name, const string& function_name,
-                        const FunctionDef* fdef) {
-  string plain_func_name = function_name;
-  // Remove the random UUID in the function name.
-  if (absl::StrContains(function_name, "_")) {
-    std::vector<string> func_name_tokens = absl::StrSplit(function_name, '_');
-    func_name_tokens.pop_back();
-    plain_func_name = absl::StrJoin(func_name_tokens, "_");
-  }
-
-  return absl::StrCat(dir_name, "/", tsl::port::JobName(), "_",
-                      tsl::port::TaskId(), "_", plain_func_name, "_",
-                      fdef->node_def_size());
+// Removes the random UUID suffix from the function name.
+string GetPlainFunctionName(const string& function_name) {
+  if (!absl::StrContains(function_name, "_")) return function_name;
+  std::vector<string> func_name_tokens = absl::StrSplit(function_name, '_');
+  func_name_tokens.pop_back();
+  return absl::StrJoin(func_name_tokens, "_");
+}
+
+// Fingerprints everything that influences the optimized graph of a function:
+// 1) TensorFlow version and graph def version.
+// 2) Definitions of the function and of the functions it reaches.
+// 3) Attrs and instantiation options. Unlike `Canonicalize`, this leaves out
+//    process local state such as the `lib_def` pointer.
+// 4) Names and types of the devices in the device set.
+uint64 FunctionGraphFingerprint(
+    const FunctionDef& fdef, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition& lib_def) {
+  uint64 fingerprint = Fingerprint64(
+      absl::StrCat(TF_VERSION_STRING, "/", TF_GRAPH_DEF_VERSION));
+
+  fingerprint = FingerprintCat64(fingerprint, FunctionDefHash(fdef));
+  const FunctionLibraryDefinition reachable_lib_def =
+      lib_def.ReachableDefinitions(fdef);
+  std::vector<string> reachable_names = reachable_lib_def.ListFunctionNames();
+  std::sort(reachable_names.begin(), reachable_names.end());
+  for (const string& name : reachable_names) {
+    const FunctionDef* reachable_fdef = reachable_lib_def.Find(name);
+    if (reachable_fdef == nullptr) continue;
+    fingerprint =
+        FingerprintCat64(fingerprint, FunctionDefHash(*reachable_fdef));
+  }
+
+  string options_key = Canonicalize("", attrs);
+  absl::StrAppend(&options_key, "|", options.target, "|",
+                  absl::StrJoin(options.input_devices, ","), "|",
+                  absl::StrJoin(options.output_devices, ","), "|",
+                  FunctionLibraryRuntime::ExecutorType(options, attrs));
+  std::map<int, DtypeAndPartialTensorShape> resource_dtypes_and_shapes(
+      options.input_resource_dtypes_and_shapes.begin(),
+      options.input_resource_dtypes_and_shapes.end());
+  for (const auto& [index, dtype_and_shape] : resource_dtypes_and_shapes) {
+    absl::StrAppend(&options_key, "|", index, ":",
+                    DataTypeString(dtype_and_shape.dtype), ":",
+                    dtype_and_shape.shape.DebugString());
+  }
+  if (options.config_proto.ByteSizeLong() > 0) {
+    string config_proto_serialized;
+    SerializeToStringDeterministic(options.config_proto,
+                                   &config_proto_serialized);
+    absl::StrAppend(&options_key, "|", config_proto_serialized);
+  }
+  fingerprint = FingerprintCat64(fingerprint, Fingerprint64(options_key));
+
+  std::vector<string> devices;
+  devices.reserve(dev_set.devices().size());
+  for (const Device* device : dev_set.devices()) {
+    devices.push_back(absl::StrCat(device->name(), "=", device->device_type()));
+  }
+  std::sort(devices.begin(), devices.end());
+  return FingerprintCat64(fingerprint,
+                          Fingerprint64(absl::StrJoin(devices, ",")));
 }
 
 // Generates graph and return information given the input function name,
@@ -299,6 +343,19 @@ Status GetGraphAndArgRets(const string& function_name, AttrSlice attrs,
 }
 }  // namespace
 
+string GetFunctionGraphCacheFileName(
+    const string& dir_name, const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition& lib_def) {
+  const FunctionDef* fdef = lib_def.Find(function_name);
+  const uint64 fingerprint =
+      fdef == nullptr
+          ? 0
+          : FunctionGraphFingerprint(*fdef, attrs, options, dev_set, lib_def);
+  return absl::StrCat(dir_name, "/", GetPlainFunctionName(function_name), "_",
+                      absl::Hex(fingerprint, absl::kZeroPad16));
+}
+
 Status PinArgsAndRets(const std::vector<string>& input_devices,
                       const std::vector<string>& output_devices,
                       const DeviceSet& device_set,
@@ -659,14 +716,22 @@ OptimizeFunctionGraphOrReadFromFileCache(
     const DeviceSet& dev_set, const FunctionLibraryDefinition* input_lib_def,
     const std::vector<CompositeDevice*>& composite_devices, Device* cpu_device,
     Device* default_device, Env* env,
-    absl::Duration caching_threshold_duration) {
+    absl::Duration caching_threshold_duration, const ConfigProto* config) {
   // There are 3 scenarios in this codepath:
   // (1) This function is not eligible for caching.
   // (2) This function is eligible for caching and its cache exists.
   // (3) This function is eligible for caching and its cache does not exist.
 
-  // Get the caching directory from Env variable.
-  const string dir_name = absl::StrCat(getenv(kGraphCachingEnvVariableName));
+  // Get the caching directory from the config, or else from Env variable.
+  string dir_name;
+  if (config != nullptr &&
+      !config->experimental().function_graph_cache_dir().empty()) {
+    dir_name = config->experimental().function_graph_cache_dir();
+    caching_threshold_duration = absl::Milliseconds(
+        config->experimental().function_graph_cache_min_optimization_time_ms());
+  } else {
+    dir_name = absl::StrCat(getenv(kGraphCachingEnvVariableName));
+  }
 
   // Scenario (1): Not eligible for caching. Run the optimization passes.
   if (dir_name.empty() || options.is_component_function) {
@@ -686,7 +751,8 @@ OptimizeFunctionGraphOrReadFromFileCache(
         "Failed to find function ", function_name,
         " in function library: ", lib_def->ToProto().DebugString()));
   }
-  const string file_name = GetFileCacheName(dir_name, function_name, fdef);
+  const string file_name = GetFunctionGraphCacheFileName(
+      dir_name, function_name, attrs, options, dev_set, *lib_def);
 
   // Scenario (2): File cache exists for this function; restore from the cache.
   if (env->FileExists(file_name).ok()) {
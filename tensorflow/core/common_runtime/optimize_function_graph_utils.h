@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/optimized_function_graph_info.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
 // TODO(b/246646753): add more tests.
@@ -62,11 +63,28 @@ absl::StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraph(
     Device* default_device, Env* env,
     OptimizedFunctionGraph::OptimizationSource optimization_source);
 
+// Returns the path of the file caching the optimized graph of
+// `function_name` instantiated with `attrs` and `options` on `dev_set`. The
+// name embeds a fingerprint of the definitions of the function and of all the
+// functions it reaches in `lib_def`, the attrs and instantiation options, the
+// device set and the TensorFlow version, so that it stays valid across
+// processes and never matches a graph optimized for something else.
+string GetFunctionGraphCacheFileName(
+    const string& dir_name, const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition& lib_def);
+
 // Outputs graph optimization results (as OptimizedFunctionGraphInfo proto),
 // either by running the actual graph optimization passes,  or by reloading from
 // the file cache if existent. If cache loading fails, it goes ahead and runs
 // the graph optimization passes. Returns error if running the optimization
 // passes fails.
+//
+// The cache lives in the directory named by
+// `config->experimental().function_graph_cache_dir()`, in which case
+// `function_graph_cache_min_optimization_time_ms` replaces
+// `caching_threshold_duration`, or otherwise in the directory named by the
+// TF_GRAPH_CACHING env variable.
 absl::StatusOr<OptimizedFunctionGraphInfo>
 OptimizeFunctionGraphOrReadFromFileCache(
     const string& function_name, AttrSlice attrs,
@@ -74,7 +92,8 @@ OptimizeFunctionGraphOrReadFromFileCache(
     const DeviceSet& dev_set, const FunctionLibraryDefinition* input_lib_def,
     const std::vector<CompositeDevice*>& composite_devices, Device* cpu_device,
     Device* default_device, Env* env,
-    absl::Duration caching_threshold_duration = kCachingThresholdDuration);
+    absl::Duration caching_threshold_duration = kCachingThresholdDuration,
+    const ConfigProto* config = nullptr);
 
 // Pre-processes, partitions and post-optimizes the input graph; returns
 // subgraph result (maps from device name to the subgraph); returns error if any
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/device.h"
@@ -27,7 +28,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function_testlib.h"
 #include "tensorflow/core/common_runtime/optimized_function_graph_info.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/env.h"
@@ -195,7 +198,7 @@ TEST(OptimizeFunctionGraphTest, OptimizeFunctionGraphAndWriteToCache) {
   // Check that only one cache file exists.
   file_list.clear();
   TF_ASSERT_OK(env->GetMatchingPaths(
-      absl::StrCat(temp_dir, "/_-1_FindDevice_1"), &file_list));
+      absl::StrCat(temp_dir, "/FindDevice_*"), &file_list));
   EXPECT_EQ(file_list.size(), 1);
   EXPECT_EQ(metrics::GetFunctionGraphOptimizationSavingTimeUsecs(
                 metrics::GraphOptimizationSource::kJit),
@@ -215,7 +218,7 @@ TEST(OptimizeFunctionGraphTest, OptimizeFunctionGraphAndWriteToCache) {
   TF_ASSERT_OK(optimized_info.status());
   file_list.clear();
   TF_ASSERT_OK(env->GetMatchingPaths(
-      absl::StrCat(temp_dir, "/_-1_FindDevice_1"), &file_list));
+      absl::StrCat(temp_dir, "/FindDevice_*"), &file_list));
   EXPECT_EQ(file_list.size(), 1);
   EXPECT_GT(metrics::GetFunctionGraphOptimizationSavingTimeUsecs(
                 metrics::GraphOptimizationSource::kJit),
@@ -246,5 +249,98 @@ TEST(OptimizeFunctionGraphTest, OptimizeFunctionGraphAndWriteToCache) {
   ASSERT_TRUE(empty_file_list.empty());
 }
 
+TEST(OptimizeFunctionGraphTest, CacheFileNameDependsOnDevicesAndFunction) {
+  FunctionLibraryRuntime::InstantiateOptions opts;
+  opts.is_multi_device_function = true;
+  FunctionDefLibrary proto;
+  *(proto.add_function()) = test::function::FindDeviceWithUuid();
+  FunctionLibraryDefinition lib_def(OpRegistry::Global(), proto);
+  std::vector<std::unique_ptr<Device>> devices;
+  CreateCpuDeviceList(kDevicePrefix, 3, devices);
+  DeviceSet device_set;
+  DeviceSet smaller_device_set;
+  for (const auto& device : devices) {
+    device_set.AddDevice(device.get());
+    if (device != devices.back()) smaller_device_set.AddDevice(device.get());
+  }
+
+  const string file_name = GetFunctionGraphCacheFileName(
+      "/cache", "FindDevice_1234", {}, opts, device_set, lib_def);
+  EXPECT_TRUE(absl::StartsWith(file_name, "/cache/FindDevice_"));
+  // The name only depends on the contents of its inputs.
+  FunctionLibraryDefinition lib_def_copy(OpRegistry::Global(), proto);
+  EXPECT_EQ(file_name,
+            GetFunctionGraphCacheFileName("/cache", "FindDevice_1234", {}, opts,
+                                          device_set, lib_def_copy));
+
+  EXPECT_NE(file_name,
+            GetFunctionGraphCacheFileName("/cache", "FindDevice_1234", {}, opts,
+                                          smaller_device_set, lib_def));
+
+  FunctionLibraryRuntime::InstantiateOptions targeted_opts = opts;
+  targeted_opts.target = devices[1]->name();
+  EXPECT_NE(file_name,
+            GetFunctionGraphCacheFileName("/cache", "FindDevice_1234", {},
+                                          targeted_opts, device_set, lib_def));
+
+  FunctionDef changed_fdef = test::function::FindDeviceWithUuid();
+  changed_fdef.mutable_node_def(0)->set_device(devices[2]->name());
+  FunctionDefLibrary changed_proto;
+  *(changed_proto.add_function()) = changed_fdef;
+  FunctionLibraryDefinition changed_lib_def(OpRegistry::Global(),
+                                            changed_proto);
+  EXPECT_NE(file_name,
+            GetFunctionGraphCacheFileName("/cache", "FindDevice_1234", {}, opts,
+                                          device_set, changed_lib_def));
+}
+
+TEST(OptimizeFunctionGraphTest, ConfigEnablesCache) {
+  Env* env = Env::Default();
+  const string temp_dir =
+      io::JoinPath(testing::TmpDir(), "function_graph_cache_from_config");
+  ConfigProto config;
+  config.mutable_experimental()->set_function_graph_cache_dir(temp_dir);
+
+  FunctionLibraryRuntime::InstantiateOptions opts;
+  opts.is_multi_device_function = true;
+  FunctionDefLibrary proto;
+  *(proto.add_function()) = test::function::FindDeviceWithUuid();
+  auto lib_def =
+      std::make_unique<FunctionLibraryDefinition>(OpRegistry::Global(), proto);
+  std::vector<std::unique_ptr<Device>> devices;
+  CreateCpuDeviceList(kDevicePrefix, 3, devices);
+  DeviceSet device_set;
+  for (const auto& device : devices) {
+    device_set.AddDevice(device.get());
+  }
+
+  const int64_t initial_hit_count =
+      metrics::GetFunctionGraphOptimizationCacheHitCount(
+          metrics::GraphOptimizationSource::kJit);
+  // The config replaces the very high caching threshold with zero.
+  for (int i = 0; i < 2; ++i) {
+    absl::StatusOr<OptimizedFunctionGraphInfo> optimized_info =
+        OptimizeFunctionGraphOrReadFromFileCache(
+            "FindDevice_1234", {}, opts, device_set, lib_def.get(),
+            /*composite_devices=*/{}, devices[0].get(), devices[1].get(), env,
+            /*caching_threshold_duration=*/absl::Hours(48), &config);
+    TF_ASSERT_OK(optimized_info.status());
+    EXPECT_EQ(optimized_info->name, "FindDevice_1234");
+  }
+
+  std::vector<string> file_list;
+  TF_ASSERT_OK(env->GetMatchingPaths(io::JoinPath(temp_dir, "FindDevice_*"),
+                                     &file_list));
+  EXPECT_EQ(file_list.size(), 1);
+  EXPECT_EQ(metrics::GetFunctionGraphOptimizationCacheHitCount(
+                metrics::GraphOptimizationSource::kJit),
+            initial_hit_count + 1);
+
+  int64_t undeleted_files;
+  int64_t undeleted_dirs;
+  TF_EXPECT_OK(
+      env->DeleteRecursively(temp_dir, &undeleted_files, &undeleted_dirs));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <atomic>
 
+#include "absl/base/prefetch.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/logging.h"
@@ -97,6 +98,12 @@ class PendingCounts {
     memcpy(bytes_, other.bytes_, other.num_bytes_);
   }
 
+  // Resets the counts to those of "other", which must have the same layout.
+  void ResetFrom(const PendingCounts& other) {
+    DCHECK_EQ(num_bytes_, other.num_bytes_);
+    memcpy(bytes_, other.bytes_, other.num_bytes_);
+  }
+
   ~PendingCounts() { delete[] bytes_; }
 
   void set_initial_count(Handle h, size_t pending_count) {
@@ -389,6 +396,12 @@ class PendingCounts {
     }
   }
 
+  // Prefetches the counts for the node with the given handle. Used to hide
+  // the latency of the next pending count update when walking output edges.
+  void prefetch(Handle h) const {
+    absl::PrefetchToLocalCache(bytes_ + h.byte_offset_);
+  }
+
   class Handle {
    public:
     Handle() : byte_offset_(0), is_large_(0) {}
@@ -215,6 +215,16 @@ REGISTER_KERNEL_BUILDER(Name("TestTypedConsumer").Device("FakeGPU"), DummyOp);
 
 REGISTER_OP("ConvertToListOfCooTensorsV2").Input("i: int32");
 
+// Op whose kernels depend on its type attribute.
+REGISTER_OP("TestTypedOutput").Output("o: T").Attr("T: {float, int32}");
+REGISTER_KERNEL_BUILDER(Name("TestTypedOutput")
+                            .Device("FakeCPU")
+                            .TypeConstraint("T", {DT_FLOAT, DT_INT32}),
+                        DummyOp);
+REGISTER_KERNEL_BUILDER(
+    Name("TestTypedOutput").Device("FakeGPU").TypeConstraint<float>("T"),
+    DummyOp);
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // A PlacerTest method has three phases:
@@ -872,6 +882,27 @@ TEST_F(PlacerTest, TestAssignedDevicePreserved) {
             GetNodeByName(g, "in")->assigned_device_name());
 }
 
+// Test that nodes of the same op with different attributes do not share their
+// supported device types.
+TEST_F(PlacerTest, TestSupportedDevicesDependOnAttrs) {
+  Graph g(OpRegistry::Global());
+  {  // Scope for temporary variables used to construct g.
+    GraphDefBuilder b(GraphDefBuilder::kFailImmediately);
+    ops::SourceOp("TestTypedOutput",
+                  b.opts().WithName("float1").WithAttr("T", DT_FLOAT));
+    ops::SourceOp("TestTypedOutput",
+                  b.opts().WithName("int").WithAttr("T", DT_INT32));
+    ops::SourceOp("TestTypedOutput",
+                  b.opts().WithName("float2").WithAttr("T", DT_FLOAT));
+    TF_EXPECT_OK(BuildGraph(b, &g));
+  }
+
+  TF_EXPECT_OK(Place(&g));
+  EXPECT_DEVICE_TYPE(g, "float1", "FakeGPU");
+  EXPECT_DEVICE_TYPE(g, "int", "FakeCPU");
+  EXPECT_DEVICE_TYPE(g, "float2", "FakeGPU");
+}
+
 // Test that a graph with partial device specifications for CPU-only ops
 // will be relocated to CPU.
 TEST_F(PlacerTest, TestPartialSpecGpuToCpu) {
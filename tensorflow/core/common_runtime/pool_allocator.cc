@@ -94,9 +94,7 @@ ChunkPrefix* FindPrefix(void* user_ptr) {
 }
 }  // namespace
 
-void* PoolAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
-  if (num_bytes == 0) return nullptr;
-
+size_t PoolAllocator::PoolKey(size_t alignment, size_t num_bytes) {
   // If alignment is larger than kPoolAlignment, increase num_bytes so that we
   // are guaranteed to be able to return an aligned ptr by advancing user_ptr
   // without overrunning the end of the chunk.
@@ -104,7 +102,30 @@ void* PoolAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
     num_bytes += alignment;
   }
   num_bytes += sizeof(ChunkPrefix);
-  num_bytes = size_rounder_->RoundUp(num_bytes);
+  return size_rounder_->RoundUp(num_bytes);
+}
+
+void PoolAllocator::RecordAllocation(size_t num_bytes) {
+  num_allocs_.fetch_add(1, std::memory_order_relaxed);
+  const int64_t bytes_in_use =
+      bytes_in_use_.fetch_add(num_bytes, std::memory_order_relaxed) +
+      num_bytes;
+  int64_t peak = peak_bytes_in_use_.load(std::memory_order_relaxed);
+  while (bytes_in_use > peak &&
+         !peak_bytes_in_use_.compare_exchange_weak(
+             peak, bytes_in_use, std::memory_order_relaxed)) {
+  }
+  int64_t largest = largest_alloc_size_.load(std::memory_order_relaxed);
+  while (static_cast<int64_t>(num_bytes) > largest &&
+         !largest_alloc_size_.compare_exchange_weak(
+             largest, num_bytes, std::memory_order_relaxed)) {
+  }
+}
+
+void* PoolAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (num_bytes == 0) return nullptr;
+
+  num_bytes = PoolKey(alignment, num_bytes);
   PtrRecord* pr = nullptr;
   if (has_size_limit_) {
     {
@@ -120,6 +141,7 @@ void* PoolAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
         pr = iter->second;
         RemoveFromList(pr);
         pool_.erase(iter);
+        pooled_bytes_ -= pr->num_bytes;
         // Fall out of lock scope and do the result without the lock held.
       }
     }
@@ -127,10 +149,13 @@ void* PoolAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
   if (pr != nullptr) {
     void* r = pr->ptr;
     delete pr;
+    RecordAllocation(num_bytes);
     return PrepareChunk(r, alignment, num_bytes);
   } else {
     size_t bytes_received;
     void* ptr = allocator_->Alloc(kPoolAlignment, num_bytes, &bytes_received);
+    if (ptr == nullptr) return nullptr;
+    RecordAllocation(bytes_received);
     return PrepareChunk(ptr, alignment, bytes_received);
   }
 }
@@ -139,6 +164,7 @@ void PoolAllocator::DeallocateRaw(void* ptr) {
   if (ptr == nullptr) return;
   ChunkPrefix* cp = FindPrefix(ptr);
   CHECK_LE((void*)cp, (void*)ptr);
+  bytes_in_use_.fetch_sub(cp->num_bytes, std::memory_order_relaxed);
   if (!has_size_limit_ && !auto_resize_) {
     allocator_->Free(cp, cp->num_bytes);
   } else {
@@ -152,7 +178,55 @@ void PoolAllocator::DeallocateRaw(void* ptr) {
     pr->ptr = cp;
     AddToList(pr);
     pool_.insert(std::make_pair(cp->num_bytes, pr));
+    pooled_bytes_ += cp->num_bytes;
+  }
+}
+
+int PoolAllocator::Prefill(size_t alignment, size_t num_bytes, int count) {
+  if (!has_size_limit_ || num_bytes == 0) return 0;
+  num_bytes = PoolKey(alignment, num_bytes);
+  int num_added = 0;
+  for (; num_added < count; ++num_added) {
+    {
+      mutex_lock lock(mutex_);
+      if (pool_.size() >= pool_size_limit_) break;
+    }
+    // Allocate without the lock held, since registering memory may be slow.
+    size_t bytes_received;
+    void* ptr = allocator_->Alloc(kPoolAlignment, num_bytes, &bytes_received);
+    if (ptr == nullptr) break;
+    mutex_lock lock(mutex_);
+    PtrRecord* pr = new PtrRecord;
+    pr->num_bytes = bytes_received;
+    pr->ptr = ptr;
+    AddToList(pr);
+    pool_.insert(std::make_pair(bytes_received, pr));
+    pooled_bytes_ += bytes_received;
   }
+  return num_added;
+}
+
+absl::optional<AllocatorStats> PoolAllocator::GetStats() {
+  AllocatorStats stats;
+  stats.num_allocs = num_allocs_.load(std::memory_order_relaxed);
+  stats.bytes_in_use = bytes_in_use_.load(std::memory_order_relaxed);
+  stats.peak_bytes_in_use = peak_bytes_in_use_.load(std::memory_order_relaxed);
+  stats.largest_alloc_size =
+      largest_alloc_size_.load(std::memory_order_relaxed);
+  mutex_lock lock(mutex_);
+  stats.pool_bytes = stats.bytes_in_use + pooled_bytes_;
+  if (!pool_.empty()) {
+    stats.largest_free_block_bytes = pool_.rbegin()->first;
+  }
+  return stats;
+}
+
+bool PoolAllocator::ClearStats() {
+  num_allocs_.store(0, std::memory_order_relaxed);
+  peak_bytes_in_use_.store(bytes_in_use_.load(std::memory_order_relaxed),
+                           std::memory_order_relaxed);
+  largest_alloc_size_.store(0, std::memory_order_relaxed);
+  return true;
 }
 
 void PoolAllocator::Clear() {
@@ -164,6 +238,7 @@ void PoolAllocator::Clear() {
       delete pr;
     }
     pool_.clear();
+    pooled_bytes_ = 0;
     get_from_pool_count_ = 0;
     put_count_ = 0;
     allocated_count_ = 0;
@@ -214,6 +289,7 @@ void PoolAllocator::EvictOne() {
     DCHECK(iter != pool_.end());
   }
   pool_.erase(iter);
+  pooled_bytes_ -= prec->num_bytes;
   allocator_->Free(prec->ptr, prec->num_bytes);
   delete prec;
   ++evicted_count_;
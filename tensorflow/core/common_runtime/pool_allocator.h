@@ -18,6 +18,7 @@ limitations under the License.
 
 // Simple LRU pool allocators for various flavors of CPU RAM.
 
+#include <algorithm>
 #include <atomic>
 #include <map>
 #include <memory>
@@ -76,6 +77,14 @@ class PoolAllocator : public Allocator {
   // Reset the pool to empty.
   void Clear();
 
+  // Adds up to "count" regions to the pool that can serve requests for
+  // "num_bytes" bytes with "alignment", so that such requests do not have to
+  // go through the SubAllocator later on. Stops early when the pool is full
+  // or the SubAllocator fails, and returns the number of regions added. This
+  // may be called from a background thread to grow the pool ahead of demand,
+  // e.g. to avoid registering pinned memory on the critical path.
+  int Prefill(size_t alignment, size_t num_bytes, int count);
+
   // The following accessors permit monitoring the effectiveness of
   // the pool at avoiding repeated malloc/frees on the underlying
   // allocator.  Read locks are not taken on the theory that value
@@ -100,6 +109,15 @@ class PoolAllocator : public Allocator {
     return pool_size_limit_;
   }
 
+  // Reports the bytes of the regions in use, and in pool_bytes the bytes of
+  // the regions in use or held in the pool. The difference between the two is
+  // memory that is allocated from the SubAllocator but not used, i.e. the
+  // fragmentation of the pool. largest_free_block_bytes is the size of the
+  // largest region held in the pool.
+  absl::optional<AllocatorStats> GetStats() override;
+
+  bool ClearStats() override;
+
   AllocatorMemoryType GetMemoryType() const override {
     return allocator_->GetMemoryType();
   }
@@ -121,6 +139,13 @@ class PoolAllocator : public Allocator {
   // Delete the least recently used record.
   void EvictOne() TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Returns the key under which a request for "num_bytes" with "alignment" is
+  // looked up in the pool.
+  size_t PoolKey(size_t alignment, size_t num_bytes);
+
+  // Updates the stats for a region of "num_bytes" that is handed out.
+  void RecordAllocation(size_t num_bytes);
+
   const string name_;
   const bool has_size_limit_;
   const bool auto_resize_;
@@ -135,6 +160,15 @@ class PoolAllocator : public Allocator {
   int64_t put_count_ TF_GUARDED_BY(mutex_) = 0;
   int64_t allocated_count_ TF_GUARDED_BY(mutex_) = 0;
   int64_t evicted_count_ TF_GUARDED_BY(mutex_) = 0;
+  // Sum of the sizes of the regions in pool_.
+  int64_t pooled_bytes_ TF_GUARDED_BY(mutex_) = 0;
+
+  // Stats of the regions in use. Atomic, so that allocators without a pool do
+  // not need to take mutex_.
+  std::atomic<int64_t> num_allocs_{0};
+  std::atomic<int64_t> bytes_in_use_{0};
+  std::atomic<int64_t> peak_bytes_in_use_{0};
+  std::atomic<int64_t> largest_alloc_size_{0};
 };
 
 // Do-nothing rounder. Passes through sizes unchanged.
@@ -151,6 +185,28 @@ class Pow2Rounder : public RoundUpInterface {
   }
 };
 
+// Size class rounder: divides each power of 2 interval (2^(k-1), 2^k] into
+// "classes_per_power_of_2" equally spaced size classes, and rounds up to the
+// nearest class. Compared to Pow2Rounder, this bounds the memory wasted by
+// rounding to 1 / classes_per_power_of_2 of the request, at the cost of more
+// distinct sizes in the pool.
+class SizeClassRounder : public RoundUpInterface {
+ public:
+  explicit SizeClassRounder(int classes_per_power_of_2 = 4)
+      : classes_per_power_of_2_(classes_per_power_of_2) {
+    CHECK_GT(classes_per_power_of_2, 0);
+  }
+
+  size_t RoundUp(size_t num_bytes) override {
+    const size_t pow2 = 1uLL << Log2Ceiling64(num_bytes);
+    const size_t step = std::max<size_t>(1, pow2 / 2 / classes_per_power_of_2_);
+    return (num_bytes + step - 1) / step * step;
+  }
+
+ private:
+  const int classes_per_power_of_2_;
+};
+
 class BasicCPUAllocator : public SubAllocator {
  public:
   BasicCPUAllocator(int numa_node, const std::vector<Visitor>& alloc_visitors,
@@ -578,7 +578,8 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
        !optimized_graph_proto.value().ok())
           ? OptimizeFunctionGraphOrReadFromFileCache(
                 function_name, attrs, options, *dev_set, lib_def_,
-                composite_devices, cpu_device, default_device, env_)
+                composite_devices, cpu_device, default_device, env_,
+                kCachingThresholdDuration, config())
           : OptimizedFunctionGraphInfo::FromProto(
                 std::move(optimized_graph_proto.value().value()));
   if (!optimized_graph_info.ok()) return optimized_graph_info.status();
@@ -76,9 +76,12 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
     // depending on env var setting.
     const bool alloc_visitors_defined =
         (!cpu_alloc_visitors_.empty() || !cpu_free_visitors_.empty());
+    // NUMA-local allocators default to BFC, which keeps freed memory on its
+    // node for reuse.
     bool use_bfc_allocator = false;
     Status status = ReadBoolFromEnvVar(
-        "TF_CPU_ALLOCATOR_USE_BFC", alloc_visitors_defined, &use_bfc_allocator);
+        "TF_CPU_ALLOCATOR_USE_BFC", alloc_visitors_defined || numa_enabled_,
+        &use_bfc_allocator);
     if (!status.ok()) {
       LOG(ERROR) << "GetCPUAllocator: " << status.message();
     }
@@ -103,6 +106,12 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
 
       BFCAllocator::Options allocator_opts;
       allocator_opts.allow_growth = true;
+      status = ReadBoolFromEnvVar("TF_CPU_BFC_ENABLE_THREAD_CACHE",
+                                  /*default_val=*/false,
+                                  &allocator_opts.enable_thread_cache);
+      if (!status.ok()) {
+        LOG(ERROR) << "GetCPUAllocator: " << status.message();
+      }
       allocator = new BFCAllocator(
           absl::WrapUnique(sub_allocator), cpu_mem_limit,
           /*name=*/"bfc_cpu_allocator_for_gpu", allocator_opts);
@@ -416,31 +416,31 @@ int PropagatorState::FrameState::ActivateNodesFastPathInternal(
   // If we know that none of the item's edge destinations require special
   // handling (i.e. none of the nodes is a merge or control trigger node), we
   // can take a fast path that avoids accessing the destination NodeItem.
-  const GraphView& gview = immutable_state.graph_view();
   int new_outstanding = 0;
 
 // Add dst to the ready queue if it's ready
 //
 // NOTE(mrry): Use a macro here instead of a lambda, because this method is
 // performance-critical and we need to ensure that the code is inlined.
-#define MAYBE_ADD_TO_READY(dst_id, adjust_result)         \
-  do {                                                    \
-    if (!(adjust_result.pending_count > 0)) {             \
-      const NodeItem* dst_item = &gview.node_ref(dst_id); \
-      TaggedNode& t = ready->emplace_back();              \
-      t.node_item = dst_item;                             \
-      t.input_frame = this;                               \
-      t.input_iter = iter_state;                          \
-      t.is_dead = adjust_result.dead_count > 0;           \
-      new_outstanding++;                                  \
-    }                                                     \
+#define MAYBE_ADD_TO_READY(dst_item, adjust_result) \
+  do {                                              \
+    if (!(adjust_result.pending_count > 0)) {       \
+      TaggedNode& t = ready->emplace_back();        \
+      t.node_item = dst_item;                       \
+      t.input_frame = this;                         \
+      t.input_iter = iter_state;                    \
+      t.is_dead = adjust_result.dead_count > 0;     \
+      new_outstanding++;                            \
+    }                                               \
   } while (0);
 
   Entry* input_tensors = iter_state->input_tensors;
-  for (const EdgeInfo& e : item->output_edges()) {
-    const int dst_id = e.dst_id;
-    const PendingCounts::Handle dst_pending_id =
-        immutable_state.pending_ids()[dst_id];
+  const auto edges = immutable_state.flat_output_edges(*item);
+  for (size_t i = 0; i < edges.size(); ++i) {
+    const ImmutableExecutorState::FlatOutputEdge& e = edges[i];
+    if (i + 1 < edges.size()) {
+      iter_state->prefetch(edges[i + 1].dst_pending_id);
+    }
     const int src_slot = e.output_slot;
 
     const bool increment_dead =
@@ -453,21 +453,24 @@ int PropagatorState::FrameState::ActivateNodesFastPathInternal(
     }
     const PendingCounts::AdjustResult adjust_result =
         atomic
-            ? iter_state->adjust_for_activation_atomic(dst_pending_id,
+            ? iter_state->adjust_for_activation_atomic(e.dst_pending_id,
                                                        increment_dead)
-            : iter_state->adjust_for_activation(dst_pending_id, increment_dead);
-    MAYBE_ADD_TO_READY(dst_id, adjust_result);
+            : iter_state->adjust_for_activation(e.dst_pending_id,
+                                                increment_dead);
+    MAYBE_ADD_TO_READY(e.dst_item, adjust_result);
   }
 
-  for (const ControlEdgeInfo& e : item->output_control_edges()) {
-    const int dst_id = e.dst_id;
-    const PendingCounts::Handle dst_pending_id =
-        immutable_state.pending_ids()[dst_id];
+  const auto control_edges = immutable_state.flat_output_control_edges(*item);
+  for (size_t i = 0; i < control_edges.size(); ++i) {
+    const ImmutableExecutorState::FlatOutputEdge& e = control_edges[i];
+    if (i + 1 < control_edges.size()) {
+      iter_state->prefetch(control_edges[i + 1].dst_pending_id);
+    }
     const PendingCounts::AdjustResult adjust_result =
-        atomic
-            ? iter_state->adjust_for_activation_atomic(dst_pending_id, is_dead)
-            : iter_state->adjust_for_activation(dst_pending_id, is_dead);
-    MAYBE_ADD_TO_READY(dst_id, adjust_result);
+        atomic ? iter_state->adjust_for_activation_atomic(e.dst_pending_id,
+                                                          is_dead)
+               : iter_state->adjust_for_activation(e.dst_pending_id, is_dead);
+    MAYBE_ADD_TO_READY(e.dst_item, adjust_result);
   }
 
   return new_outstanding;
@@ -481,7 +484,6 @@ int PropagatorState::FrameState::ActivateNodesSlowPathInternal(
   // If any of the edge destinations is a merge or a control trigger node,
   // we need to read each destination NodeItem to determine what action
   // to take.
-  const GraphView& gview = immutable_state.graph_view();
   int activated = 0;
   auto maybe_add_to_ready = [&](int dst_id, const NodeItem* dst_item,
                                 bool dst_ready, bool dst_dead) {
@@ -495,11 +497,11 @@ int PropagatorState::FrameState::ActivateNodesSlowPathInternal(
 
   Entry* input_tensors = iter_state->input_tensors;
 
-  for (const EdgeInfo& e : item->output_edges()) {
+  for (const ImmutableExecutorState::FlatOutputEdge& e :
+       immutable_state.flat_output_edges(*item)) {
     const int dst_id = e.dst_id;
-    const NodeItem* dst_item = &gview.node_ref(dst_id);
-    const PendingCounts::Handle dst_pending_id =
-        immutable_state.pending_ids()[dst_id];
+    const NodeItem* dst_item = e.dst_item;
+    const PendingCounts::Handle dst_pending_id = e.dst_pending_id;
     const int src_slot = e.output_slot;
 
     bool dst_dead = false;
@@ -577,11 +579,11 @@ int PropagatorState::FrameState::ActivateNodesSlowPathInternal(
     maybe_add_to_ready(dst_id, dst_item, dst_ready, dst_dead);
   }
 
-  for (const ControlEdgeInfo& e : item->output_control_edges()) {
+  for (const ImmutableExecutorState::FlatOutputEdge& e :
+       immutable_state.flat_output_control_edges(*item)) {
     const int dst_id = e.dst_id;
-    const NodeItem* dst_item = &gview.node_ref(dst_id);
-    const PendingCounts::Handle dst_pending_id =
-        immutable_state.pending_ids()[dst_id];
+    const NodeItem* dst_item = e.dst_item;
+    const PendingCounts::Handle dst_pending_id = e.dst_pending_id;
 
     bool dst_dead;
     bool dst_ready;
@@ -753,8 +755,15 @@ PropagatorState::FrameState::IncrementIteration(TaggedNodeSeq* ready) {
   iteration_count++;
 
   // Initialize the next iteration.
-  IterationState* next_iter =
-      new IterationState(iteration_count, pending_counts, total_input_tensors);
+  IterationState* next_iter;
+  if (!free_iterations.empty()) {
+    next_iter = free_iterations.back();
+    free_iterations.pop_back();
+    next_iter->Reset(iteration_count, pending_counts);
+  } else {
+    next_iter = new IterationState(iteration_count, pending_counts,
+                                   total_input_tensors);
+  }
   SetIteration(iteration_count, next_iter);
   num_outstanding_iterations++;
   {
@@ -775,7 +784,14 @@ bool PropagatorState::FrameState::CleanupIterations(IterationState* iter_state,
                                                     TaggedNodeSeq* ready) {
   int64_t curr_iter = iter_state->iter_num;
   while (curr_iter <= iteration_count && IsIterationDone(iter_state)) {
-    delete iter_state;
+    // Child frames and ops of a done iteration no longer refer to it, so it
+    // can be reused. At most one state per parallel iteration is kept.
+    if (free_iterations.size() <
+        static_cast<size_t>(max_parallel_iterations)) {
+      free_iterations.push_back(iter_state);
+    } else {
+      delete iter_state;
+    }
     SetIteration(curr_iter, nullptr);
     --num_outstanding_iterations;
     ++curr_iter;
@@ -130,13 +130,25 @@ class PropagatorState {
                             int total_input_tensors)
         : iter_num(iter_num),
           input_tensors(new Entry[total_input_tensors]),
+          total_input_tensors(total_input_tensors),
           outstanding_ops(0),
           outstanding_frame_count(0),
           counts(*pending_counts) {  // Initialize with copy of *pending_counts
     }
 
-    const int64_t
-        iter_num;  // The index of this iteration in the enclosing loop.
+    // Reuses a done iteration state of the same frame for iteration
+    // `iter_num`, as if it was newly constructed.
+    void Reset(int64_t iter_num, const PendingCounts* pending_counts) {
+      this->iter_num = iter_num;
+      for (int i = 0; i < total_input_tensors; ++i) {
+        input_tensors[i].ClearVal();
+      }
+      outstanding_ops = 0;
+      outstanding_frame_count = 0;
+      counts.ResetFrom(*pending_counts);
+    }
+
+    int64_t iter_num;  // The index of this iteration in the enclosing loop.
 
     // One copy per iteration. For iteration k, i-th node's j-th input is in
     // input_tensors[k][immutable_state_.nodes[i].input_start + j]. An entry is
@@ -147,6 +159,7 @@ class PropagatorState {
     // source node of an edge and is cleared by the destination of the same
     // edge. The latter node is never run concurrently with the former node.
     Entry* input_tensors;
+    const int total_input_tensors;
 
     // The number of outstanding ops for each iteration.
     std::atomic<size_t> outstanding_ops;
@@ -205,6 +218,7 @@ class PropagatorState {
         PendingCounts::Handle h, bool increment_dead) {
       return counts.adjust_for_activation_atomic(h, increment_dead);
     }
+    void prefetch(PendingCounts::Handle h) const { counts.prefetch(h); }
 
     ~IterationState() { delete[] input_tensors; }
 
@@ -286,6 +300,9 @@ class PropagatorState {
     gtl::InlinedVector<IterationState*, 12> iterations;
     IterationState** const iterations_raw TF_GUARDED_BY(mu);
     IterationState* iterations_first TF_GUARDED_BY(mu);
+    // Done iteration states kept to be reset for later iterations, instead of
+    // allocating the input tensors and pending counts of every iteration.
+    std::vector<IterationState*> free_iterations TF_GUARDED_BY(mu);
 
    public:
     // The NextIteration nodes to enter a new iteration. If the number of
@@ -419,6 +436,9 @@ class PropagatorState {
         delete iterations[i];
         iterations[i] = nullptr;
       }
+      for (IterationState* iter_state : free_iterations) {
+        delete iter_state;
+      }
     }
 
    private:
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
@@ -53,6 +54,14 @@ constexpr size_t kMaxChunkSizeBytes = (4 * 1024 * 1024);
 // through the collectives API. A reasonable value would be a small
 // multiple of the number of NICs adjacent to each device.
 constexpr int kMaxSubdivsPerDeviceDefault = 2;
+// Within one subdivision, a device reduces a chunk only after it has received
+// it and sends it only after it has reduced it, so transfers and reductions
+// take turns.  With at least kMinPipelineDepth subdivisions the reduction of
+// a chunk in one subdivision overlaps with the transfers of the others.  Mid
+// size tensors are subdivided that deep as long as the chunks stay at least
+// kMinPipelinedChunkSizeBytes, below which the per-chunk overheads dominate.
+constexpr int kMinPipelineDepth = 2;
+constexpr size_t kMinPipelinedChunkSizeBytes = (1024 * 1024);
 
 namespace tensorflow {
 namespace {
@@ -135,8 +144,12 @@ Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
   }
   // NOTE(ayushd): If no subdiv_offsets have been specified, dynamically add
   // as many offsets as needed so that the size of tensor chunks <=
-  // kMaxChunkSizeBytes.  Empirically, chunks that are too small or too large
+  // max_chunk_size.  Empirically, chunks that are too small or too large
   // lead to worse performance.
+  const size_t max_chunk_size =
+      (col_params->instance.impl_details.max_chunk_size_bytes > 0)
+          ? col_params->instance.impl_details.max_chunk_size_bytes
+          : kMaxChunkSizeBytes;
   int num_subdivs = 0;
   const size_t tensor_size = col_params->instance.shape.num_elements() *
                              DataTypeSize(col_params->instance.data_type);
@@ -147,7 +160,15 @@ Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
     chunk_size = tensor_size / num_chunks;
     VLOG(2) << "num_subdivs " << num_subdivs << " num_chunks " << num_chunks
             << " chunk_size " << chunk_size;
-  } while (chunk_size > kMaxChunkSizeBytes && num_subdivs < kMaxNumSubdivs);
+  } while (chunk_size > max_chunk_size && num_subdivs < kMaxNumSubdivs);
+  if (num_subdivs < kMinPipelineDepth && kMinPipelineDepth <= kMaxNumSubdivs &&
+      tensor_size / (col_params->group.group_size * kMinPipelineDepth) >=
+          kMinPipelinedChunkSizeBytes) {
+    num_subdivs = kMinPipelineDepth;
+    chunk_size = tensor_size / (col_params->group.group_size * num_subdivs);
+    VLOG(2) << "Pipelining with num_subdivs " << num_subdivs << " chunk_size "
+            << chunk_size;
+  }
   if (num_subdivs <= 0) {
     return errors::Internal("Unexpected num_subdivs ", num_subdivs, " in ",
                             col_params->instance.impl_details.collective_name);
@@ -260,9 +281,21 @@ Status RingAlg::InitializeCollectiveContext(
   DCHECK(col_ctx->dev_mgr);
   col_ctx_ = col_ctx;
   col_params_ = col_ctx->col_params.get();
-  return collective_util::InitializeDeviceAndLocality(
+  TF_RETURN_IF_ERROR(collective_util::InitializeDeviceAndLocality(
       col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
-      &col_ctx->device_locality);
+      &col_ctx->device_locality));
+  // Codecs run on host memory, and only reductions tolerate lossy transfers.
+  const string& wire_codec = col_params_->instance.impl_details.wire_codec;
+  codec_ = nullptr;
+  if (!wire_codec.empty() && type_ == REDUCTION_COLLECTIVE &&
+      col_params_->group.num_tasks > 1 &&
+      col_params_->group.device_type == "CPU") {
+    TF_RETURN_IF_ERROR(CollectiveCodecRegistry::Lookup(wire_codec, &codec_));
+    if (!codec_->SupportsType(col_params_->instance.data_type)) {
+      codec_ = nullptr;
+    }
+  }
+  return OkStatus();
 }
 
 string RingAlg::TensorDebugString(const Tensor& tensor) {
@@ -404,11 +437,26 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_->instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  Tensor* send_tensor = &rf->chunk;
+  if (UseCodec(*rf, rf->send_is_remote)) {
+    AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+    rf->encoded_chunk =
+        Tensor(col_ctx_->device->GetAllocator(attr), DT_UINT8,
+               TensorShape({codec_->EncodedBytes(rf->chunk.NumElements())}));
+    Status s = codec_->Encode(
+        strings::StrCat(col_ctx_->device_name, ":", send_buf_key), rf->chunk,
+        &rf->encoded_chunk);
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+    send_tensor = &rf->encoded_chunk;
+  }
   col_ctx_->col_exec->remote_access()->PostToPeer(
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), send_tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
       done);
 }
@@ -424,14 +472,52 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  Tensor* recv_tensor = dst_tensor;
+  const CollGroupMember& peer = col_params_->group.members[rf->recv_dev_idx];
+  StatusCallback recv_done = done;
+  if (UseCodec(*rf, rf->recv_is_remote)) {
+    AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+    rf->encoded_chunk =
+        Tensor(col_ctx_->device->GetAllocator(attr), DT_UINT8,
+               TensorShape({codec_->EncodedBytes(dst_tensor->NumElements())}));
+    recv_tensor = &rf->encoded_chunk;
+    recv_done = [this, rf, dst_tensor, done](const Status& s) {
+      if (!s.ok()) {
+        done(s);
+        return;
+      }
+      done(codec_->Decode(rf->encoded_chunk, dst_tensor));
+    };
+  }
+  // Stop the clock once the chunk has arrived, before it is decoded.
+  recv_done = [peer_task = peer.task, start_usecs = Env::Default()->NowMicros(),
+               recv_done = std::move(recv_done)](const Status& s) {
+    metrics::RecordCollectiveRecvTime(
+        peer_task, Env::Default()->NowMicros() - start_usecs);
+    recv_done(s);
+  };
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
-      col_params_->group.members[rf->recv_dev_idx].device.name(),
-      col_params_->group.members[rf->recv_dev_idx].task,
-      col_params_->group.members[rf->recv_dev_idx].is_local, recv_buf_key,
+      peer.device.name(), peer.task, peer.is_local, recv_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
+      col_ctx_->op_ctx->output_alloc_attr(0), recv_tensor,
       col_ctx_->device_locality, rf->subdiv_idx,
-      col_ctx_->op_ctx->cancellation_manager(), done);
+      col_ctx_->op_ctx->cancellation_manager(), recv_done);
+}
+
+bool RingAlg::UseCodec(const RingField& rf, bool peer_is_remote) const {
+  return codec_ != nullptr && peer_is_remote &&
+         (!rf.second_pass || codec_->IsIdempotent());
+}
+
+Status RingAlg::ApplyCodecToFinalValue(RingField* rf) {
+  if (codec_ == nullptr || !codec_->IsIdempotent() ||
+      rf->chunk.NumElements() == 0) {
+    return OkStatus();
+  }
+  Tensor encoded(DT_UINT8,
+                 TensorShape({codec_->EncodedBytes(rf->chunk.NumElements())}));
+  TF_RETURN_IF_ERROR(codec_->Encode(/*stream_key=*/"", rf->chunk, &encoded));
+  return codec_->Decode(encoded, &rf->chunk);
 }
 
 string RingAlg::FieldState() {
@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_codec.h"
 #include "tensorflow/core/framework/collective.h"
 
 namespace tensorflow {
@@ -75,6 +76,7 @@ class RingAlg : public CollectiveImplementationInterface {
     bool is_final = false;  // is the last field in the pass for this rank
     Tensor chunk;           // alias to field values
     Tensor tmp_chunk;
+    Tensor encoded_chunk;  // encoding of a transfer, when codec_ applies
     Status status;
     string DebugString() const;
   };
@@ -84,6 +86,16 @@ class RingAlg : public CollectiveImplementationInterface {
   void DispatchSend(RingField* rf, const StatusCallback& done);
   void DispatchRecv(RingField* rf, const StatusCallback& done);
 
+  // Returns true if the transfers of `rf` with a peer are encoded with
+  // codec_.  Only transfers with peers in other tasks are encoded, and the
+  // second pass only if the codec is idempotent.
+  bool UseCodec(const RingField& rf, bool peer_is_remote) const;
+
+  // Replaces the fully reduced value of `rf` by the decoding of its encoding
+  // if the second pass encodes transfers, so that the owner of the value
+  // ends with the same value as the devices to which it is sent.
+  Status ApplyCodecToFinalValue(RingField* rf);
+
   // For constructing log messages for debugging.
   string FieldState();
   string TensorDebugString(const Tensor& tensor);
@@ -111,6 +123,8 @@ class RingAlg : public CollectiveImplementationInterface {
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
   std::unique_ptr<CollectiveAdapter> ca_;
+  // Not owned.  Set if the collective encodes transfers with other tasks.
+  CollectiveCodec* codec_ = nullptr;
   mutex status_mu_;
   Status status_ TF_GUARDED_BY(status_mu_);
   std::vector<RingField> rfv_;
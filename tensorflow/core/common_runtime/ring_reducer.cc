@@ -42,6 +42,13 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 
 namespace tensorflow {
+namespace {
+// On CPU devices the merge op runs synchronously in the thread which calls
+// it.  Chunks of at least this size are reduced in a separate closure, so
+// that the loop in RunAsyncParts keeps dispatching the sends and recvs of the
+// other RingFields while the reduction runs.
+constexpr int64_t kMinOffloadedReductionBytes = 64 * 1024;
+}  // namespace
 
 RingReducer::~RingReducer() { group_size_tensor_ready_.WaitForNotification(); }
 
@@ -210,9 +217,14 @@ bool RingReducer::RunAsyncParts() {
     }
   }
 
+  // Accelerator kernels are enqueued on a stream, so only CPU reductions are
+  // worth moving off this thread.
+  const bool offload_reductions =
+      gpu_info == nullptr && ca_->ChunkBytes(0) >= kMinOffloadedReductionBytes;
   int field_done_count = 0;
   int send_pending_count = 0;
   int recv_pending_count = 0;
+  int reduce_pending_count = 0;
   std::atomic<bool> aborted(false);
 
   {
@@ -255,18 +267,35 @@ bool RingReducer::RunAsyncParts() {
             --recv_pending_count;
             if (!rf->second_pass) {
               rf->action = RF_REDUCE;
-              Status s = collective_util::ComputeBinOp(
-                  col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
-                  col_params_->merge_op, &rf->chunk, &rf->tmp_chunk);
-              if (!s.ok()) {
-                aborted = true;
-                StartAbort(s);
+              auto reduce = [this, rf, &aborted]() {
+                Status s = collective_util::ComputeBinOp(
+                    col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+                    col_params_->merge_op, &rf->chunk, &rf->tmp_chunk);
+                if (!s.ok()) {
+                  aborted = true;
+                  StartAbort(s);
+                }
+              };
+              if (offload_reductions) {
+                col_ctx_->col_exec->RunClosure(
+                    [reduce, rf, &ready_queue]() {
+                      reduce();
+                      ready_queue.Enqueue(rf);
+                    });
+                dispatched = true;
+                ++reduce_pending_count;
+              } else {
+                reduce();
               }
             } else {
               rf->action = RF_SEND_READY;
             }
             break;
           case RF_REDUCE:
+            if (offload_reductions) {
+              CHECK_GT(reduce_pending_count, 0);
+              --reduce_pending_count;
+            }
             if (!rf->second_pass && col_params_->final_op && rf->is_final) {
               rf->action = RF_FINALIZE;
               group_size_tensor_ready_.WaitForNotification();
@@ -315,6 +344,13 @@ bool RingReducer::RunAsyncParts() {
             ++field_done_count;
             break;  // from do while(!dispatched)
           } else {
+            if (rf->is_final) {
+              Status s = ApplyCodecToFinalValue(rf);
+              if (!s.ok()) {
+                aborted = true;
+                StartAbort(s);
+              }
+            }
             AdvanceToSecondPass(rf);
           }
         }
@@ -325,12 +361,16 @@ bool RingReducer::RunAsyncParts() {
     if (aborted) {
       // All of the pending data actions should be aborted; field the
       // callbacks and clear the queue before quitting.
-      while ((send_pending_count > 0) || (recv_pending_count > 0)) {
+      while ((send_pending_count > 0) || (recv_pending_count > 0) ||
+             (reduce_pending_count > 0)) {
         RingField* rf = ready_queue.Dequeue();
         switch (rf->action) {
           case RF_RECV:
             --recv_pending_count;
             break;
+          case RF_REDUCE:
+            if (offload_reductions) --reduce_pending_count;
+            break;
           case RF_SEND:
             --send_pending_count;
             break;
@@ -343,6 +383,7 @@ bool RingReducer::RunAsyncParts() {
 
   CHECK_EQ(send_pending_count, 0);
   CHECK_EQ(recv_pending_count, 0);
+  CHECK_EQ(reduce_pending_count, 0);
 
   VLOG(2) << this << " device=" << col_ctx_->device_name << " finish;"
           << " final value " << TensorDebugString(ca_->Value());
@@ -36,6 +36,8 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/lib/monitoring/test_utils.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/unbounded_work_queue.h"
@@ -374,6 +376,94 @@ TEST_F(RingReducerInitParamsTest, AutomaticSubdivDisabled) {
   RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}}, {0});
 }
 
+TEST_F(RingReducerInitParamsTest, AutomaticSubdivPipelinesMidSizeTensors) {
+  const int kNumDevsPerWorker = 1;
+  const int kNumWorkers = 4;
+  auto test_env =
+      CreateCollectiveTestEnv(kNumWorkers, kNumDevsPerWorker, DEVICE_CPU);
+  auto cp =
+      CreateCollectiveParams(*test_env, /*rank*/ 0, "RingReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({1}));
+
+  cp->default_rank = 0;
+  // With a single subdiv the chunks would be 4 MiB, which is within the
+  // default bound.  A second subdiv is added to pipeline reductions and
+  // transfers.
+  cp->instance.impl_details.subdiv_offsets.clear();
+  cp->instance.impl_details.max_subdivs_per_device = 0;
+  cp->instance.shape = TensorShape({16777216 / DataTypeSize(DT_FLOAT)});
+  RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}, {0, 1, 2, 3}}, {0, 0});
+
+  // 1 MiB chunks are too small to be worth pipelining.
+  cp->instance.impl_details.subdiv_offsets.clear();
+  cp->instance.shape = TensorShape({4194304 / DataTypeSize(DT_FLOAT)});
+  RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}}, {0});
+}
+
+TEST_F(RingReducerInitParamsTest, AutomaticSubdivUsesMaxChunkSize) {
+  const int kNumDevsPerWorker = 1;
+  const int kNumWorkers = 4;
+  auto test_env =
+      CreateCollectiveTestEnv(kNumWorkers, kNumDevsPerWorker, DEVICE_CPU);
+  auto cp =
+      CreateCollectiveParams(*test_env, /*rank*/ 0, "RingReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({1}));
+
+  cp->default_rank = 0;
+  // 4 subdivs are needed for the chunks to fit in 1 MiB.
+  cp->instance.impl_details.subdiv_offsets.clear();
+  cp->instance.impl_details.max_subdivs_per_device = 8;
+  cp->instance.impl_details.max_chunk_size_bytes = 1048576;
+  cp->instance.shape = TensorShape({16777216 / DataTypeSize(DT_FLOAT)});
+  RunSubdivPermsTest(cp.get(),
+                     {{0, 1, 2, 3}, {0, 1, 2, 3}, {0, 1, 2, 3}, {0, 1, 2, 3}},
+                     {0, 0, 0, 0});
+}
+
+TEST_F(RingReducerTest, BFloat16WireCodec) {
+  const int kNumWorkers = 2;
+  const int kNumDevsPerWorker = 2;
+  const int kTensorLen = 1001;
+  Init(kNumWorkers, kNumDevsPerWorker, DT_FLOAT, TensorShape({kTensorLen}),
+       DEVICE_CPU, /*num_subdivs=*/0, /*fail_after=*/0);
+  std::vector<float> expected(kTensorLen);
+  for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+    CollectiveParams* cp = instances_[di]->col_params_.get();
+    cp->instance.impl_details.wire_codec = "bf16";
+    // Mark the devices of other workers remote from the perspective of this
+    // device, so that their transfers are encoded.
+    for (CollGroupMember& member : cp->group.members) {
+      member.is_local = member.task == cp->group.members[di].task;
+    }
+    instances_[di]->InitTensor([&expected, di](Tensor* t) {
+      for (int i = 0; i < kTensorLen; ++i) {
+        float value = 0.37f * di + 1.01f * i;
+        t->flat<float>()(i) = value;
+        expected[i] += value / (kNumWorkers * kNumDevsPerWorker);
+      }
+    });
+  }
+  Reduce(/*fail_after=*/0);
+  for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+    TF_EXPECT_OK(instances_[di]->status_);
+    test::ExpectClose(test::AsTensor<float>(expected),
+                      instances_[di]->tensor(), /*atol=*/0, /*rtol=*/2e-2);
+    // All devices end with the same value, although it is rounded.
+    test::ExpectTensorEqual<float>(instances_[0]->tensor(),
+                                   instances_[di]->tensor());
+  }
+}
+
+TEST_F(RingReducerTest, RecordsRecvTimePerPeerTask) {
+  monitoring::testing::CellReader<monitoring::testing::Histogram> recv_time(
+      "/tensorflow/core/collective_recv_time_usecs");
+  RunTest<float>(DT_FLOAT, DEVICE_CPU, /*num_workers=*/2, /*num_devices=*/2,
+                 /*num_subdivs=*/1, /*tensor_len=*/1001, /*fail_after=*/0);
+  // Every task has a device whose ring successor receives from it.
+  EXPECT_GT(recv_time.Delta("/job:worker/replica:0/task:0").num(), 0);
+  EXPECT_GT(recv_time.Delta("/job:worker/replica:0/task:1").num(), 0);
+}
+
 // TODO(b/113171733): change to use TEST_P.
 #define DEF_TEST(B, T, W, D, S, L, A)                                         \
   TEST_F(RingReducerTest,                                                     \
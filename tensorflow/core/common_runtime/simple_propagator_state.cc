@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <atomic>
 
+#include "absl/base/prefetch.h"
 #include "tensorflow/core/common_runtime/propagator_debug_utils.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
@@ -71,11 +72,14 @@ void SimplePropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
   // into the ready queue.
   DCHECK(ready->empty());
 
-  const GraphView& gview = immutable_state_.graph_view();
   const NodeItem* item = tagged_node.node_item;
 
-  for (const EdgeInfo& e : item->output_edges()) {
-    const int dst_id = e.dst_id;
+  const auto edges = immutable_state_.flat_output_edges(*item);
+  for (size_t i = 0; i < edges.size(); ++i) {
+    const ImmutableExecutorState::FlatOutputEdge& e = edges[i];
+    if (i + 1 < edges.size()) {
+      absl::PrefetchToLocalCache(&pending_[edges[i + 1].dst_id]);
+    }
     const int src_slot = e.output_slot;
     const int dst_loc = e.input_slot;
 
@@ -90,16 +94,21 @@ void SimplePropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
     }
 
     int32_t previous_num_pending =
-        pending_[dst_id].fetch_sub(1, std::memory_order_release);
-    if (previous_num_pending == 1) ready->emplace_back(&gview.node_ref(dst_id));
+        pending_[e.dst_id].fetch_sub(1, std::memory_order_release);
+    if (previous_num_pending == 1) ready->emplace_back(e.dst_item);
   }
 
-  for (const ControlEdgeInfo& e : item->output_control_edges()) {
-    const int dst_id = e.dst_id;
+  const auto control_edges = immutable_state_.flat_output_control_edges(*item);
+  for (size_t i = 0; i < control_edges.size(); ++i) {
+    const ImmutableExecutorState::FlatOutputEdge& e = control_edges[i];
+    if (i + 1 < control_edges.size()) {
+      absl::PrefetchToLocalCache(
+          &pending_[control_edges[i + 1].dst_id]);
+    }
 
     int32_t previous_num_pending =
-        pending_[dst_id].fetch_sub(1, std::memory_order_release);
-    if (previous_num_pending == 1) ready->emplace_back(&gview.node_ref(dst_id));
+        pending_[e.dst_id].fetch_sub(1, std::memory_order_release);
+    if (previous_num_pending == 1) ready->emplace_back(e.dst_item);
   }
 }
 
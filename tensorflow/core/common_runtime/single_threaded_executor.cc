@@ -16,7 +16,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/single_threaded_executor.h"
 
 #include <utility>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
@@ -62,9 +64,6 @@ Status ValidateOpIsSafeForSyncExecution(
 
 namespace {
 
-typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
-typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
-
 static const string& kSingleThreadedExecutor =
     *new string("SINGLE_THREADED_EXECUTOR");
 
@@ -205,18 +204,31 @@ class SingleThreadedExecutorImpl : public Executor {
     }
 
     // Build the mapping from each node output to the input slot for the
-    // corresponding destination node.
+    // corresponding destination node. The destinations of all outputs of all
+    // kernels are stored contiguously, in execution order, in
+    // `output_locations_`.
+    output_location_offsets_.clear();
+    output_locations_.clear();
     for (size_t i = 0; i < kernels_.size(); ++i) {
       Node* n = nodes_with_kernels[i];
       KernelState& kernel_state = kernels_[i];
-      kernel_state.output_locations.resize(kernel_state.num_outputs);
+      std::vector<std::vector<size_t>> output_locations(
+          kernel_state.num_outputs);
       for (const Edge* e : n->out_edges()) {
         if (!e->IsControlEdge()) {
-          kernel_state.output_locations[e->src_output()].push_back(
+          output_locations[e->src_output()].push_back(
               kernels_[node_to_index_map[e->dst()]].input_start_index +
               e->dst_input());
         }
       }
+      kernel_state.output_location_offsets_index =
+          output_location_offsets_.size();
+      for (const std::vector<size_t>& locations : output_locations) {
+        output_location_offsets_.push_back(output_locations_.size());
+        output_locations_.insert(output_locations_.end(), locations.begin(),
+                                 locations.end());
+      }
+      output_location_offsets_.push_back(output_locations_.size());
 
       // Compute allocator attributes for each node output, and corresponding
       // node input.
@@ -241,8 +253,8 @@ class SingleThreadedExecutorImpl : public Executor {
           last_kernel_state.input_start_index + last_kernel_state.num_inputs;
       input_alloc_attrs_.resize(total_num_inputs_);
       for (size_t i = 0; i < kernels_.size(); ++i) {
-        for (size_t j = 0; j < kernels_[i].output_locations.size(); ++j) {
-          for (size_t output_location : kernels_[i].output_locations[j]) {
+        for (size_t j = 0; j < kernels_[i].num_outputs; ++j) {
+          for (size_t output_location : output_locations(kernels_[i], j)) {
             input_alloc_attrs_[output_location] =
                 kernels_[i].output_alloc_attrs[j];
           }
@@ -286,14 +298,15 @@ class SingleThreadedExecutorImpl : public Executor {
     // * The elements corresponding to the inputs for kernel `i` are destroyed
     //   after kernel `i` executes.
     // * In an error case (see below), we use the connectivity information in
-    //   `KernelState::output_locations` to determine which locations have been
+    //   `output_locations_` to determine which locations have been
     //   initialized, and manually destroy them.
     std::vector<Entry> inputs(total_num_inputs_);
 
-    // TODO(mrry): Can we avoid copying into these vectors? Consider modifying
-    // OpKernelContext to take the TensorValueVec as a pointer into `inputs`.
-    TensorValueVec node_inputs;
-    AllocatorAttributeVec input_alloc_attrs;
+    // The `TensorValue`s passed to each kernel are stored in the same layout
+    // as `inputs`, so that the slice for kernel `i` is filled in place and
+    // requires no per-kernel allocation. The corresponding slice of
+    // `input_alloc_attrs_` is passed to the kernel directly.
+    std::vector<TensorValue> input_values(total_num_inputs_);
 
     // Override intra op thread pool if requested.
     Device* device = params_.device;
@@ -414,10 +427,7 @@ class SingleThreadedExecutorImpl : public Executor {
       const size_t num_inputs = kernel_state.num_inputs;
       const size_t num_outputs = kernel_state.num_outputs;
 
-      node_inputs.clear();
-      node_inputs.resize(num_inputs);
-      input_alloc_attrs.clear();
-      input_alloc_attrs.resize(num_inputs);
+      TensorValue* node_inputs = input_values.data() + input_start_index;
       for (size_t j = 0; j < num_inputs; ++j) {
         Entry& input = inputs[input_start_index + j];
         switch (input.state) {
@@ -434,10 +444,10 @@ class SingleThreadedExecutorImpl : public Executor {
           default:
             DCHECK(false) << "Input did not have a valid value.";
         }
-        input_alloc_attrs[j] = input_alloc_attrs_[input_start_index + j];
       }
-      params.inputs = node_inputs;
-      params.input_alloc_attrs = input_alloc_attrs;
+      params.inputs = absl::Span<const TensorValue>(node_inputs, num_inputs);
+      params.input_alloc_attrs = absl::Span<const AllocatorAttributes>(
+          input_alloc_attrs_.data() + input_start_index, num_inputs);
       params.op_kernel = kernel_state.kernel;
       params.output_attr_array = kernel_state.output_alloc_attrs.data();
       OpKernelContext ctx(&params, num_outputs);
@@ -454,14 +464,14 @@ class SingleThreadedExecutorImpl : public Executor {
       // Forward the outputs of the kernel to the inputs of subsequent kernels.
       for (size_t j = 0; j < num_outputs; ++j) {
         TensorValue val = ctx.release_output(j);
-        const size_t num_destinations = kernel_state.output_locations[j].size();
+        const absl::Span<const size_t> destinations =
+            output_locations(kernel_state, j);
+        const size_t num_destinations = destinations.size();
         if (num_destinations > 0) {
-          // TODO(mrry): Consider flattening the `output_locations` vector
-          // to improve the cache-friendliness of this loop.
           for (size_t k = 0; k < num_destinations - 1; ++k) {
             // TODO(mrry): Validate that the types match the expected values or
             // ensure that the necessary validation has already happened.
-            Entry& input = inputs[kernel_state.output_locations[j][k]];
+            Entry& input = inputs[destinations[k]];
             input.state = Entry::State::HAS_VALUE;
             if (val.tensor != nullptr) {
               input.val.Init(*val.tensor);
@@ -470,8 +480,7 @@ class SingleThreadedExecutorImpl : public Executor {
             }
           }
           // Move `arg` to the last consumer to avoid the cost of copying it.
-          Entry& input =
-              inputs[kernel_state.output_locations[j][num_destinations - 1]];
+          Entry& input = inputs[destinations[num_destinations - 1]];
           input.state = Entry::State::HAS_VALUE;
           if (val.tensor != nullptr) {
             input.val.Init(std::move(*val.tensor));
@@ -519,11 +528,10 @@ class SingleThreadedExecutorImpl : public Executor {
 
     size_t num_outputs;
 
-    // For the `j`th output of `kernel`, `output_locations[j]` contains the
-    // locations in the flat `inputs` vector to which that output must be
-    // copied. See comment at the beginning of `Run()` for details.
-    std::vector<std::vector<size_t>>
-        output_locations;  // Length = `num_outputs`.
+    // The index in `output_location_offsets_` of the first of the
+    // `num_outputs + 1` offsets that delimit the destinations of each output
+    // of `kernel` in `output_locations_`.
+    size_t output_location_offsets_index;
 
     // Memory space information for each output of `kernel`.
     std::vector<AllocatorAttributes>
@@ -531,6 +539,25 @@ class SingleThreadedExecutorImpl : public Executor {
   };
   std::vector<KernelState> kernels_;
 
+  // The locations in the flat `inputs` vector to which each output of each
+  // kernel must be copied, in execution order. See comment at the beginning of
+  // `Run()` for details.
+  std::vector<size_t> output_locations_;
+  // Offsets into `output_locations_`. See
+  // `KernelState::output_location_offsets_index`.
+  std::vector<size_t> output_location_offsets_;
+
+  // Returns the locations in the flat `inputs` vector to which the `j`th
+  // output of the kernel of state `kernel_state` must be copied.
+  absl::Span<const size_t> output_locations(const KernelState& kernel_state,
+                                            size_t j) const {
+    const size_t* offsets =
+        output_location_offsets_.data() +
+        kernel_state.output_location_offsets_index + j;
+    return absl::Span<const size_t>(output_locations_.data() + offsets[0],
+                                    offsets[1] - offsets[0]);
+  }
+
   // For the `i`th argument, `arg_output_locations_[i]` contains the locations
   // in the flat `inputs` vector to which that argument must be copied.
   std::vector<std::vector<size_t>>
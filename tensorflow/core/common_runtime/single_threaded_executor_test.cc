@@ -248,6 +248,34 @@ TEST_F(ExecutorTest, EmptyOutput) {
   EXPECT_EQ(0, retvals[1].tensor_data().size());
 }
 
+TEST_F(ExecutorTest, MultipleOutputsFanOut) {
+  // x, y = MockOp(in)
+  // a = x + x
+  // b = a + x
+  // out0 <- b, out1 <- y
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  Node* in = test::graph::Arg(g.get(), 0, DT_FLOAT);
+  Node* mock;
+  TF_ASSERT_OK(
+      NodeBuilder(g->NewName("n"), "Mock").Input(in).Finalize(g.get(), &mock));
+  Node* a = test::graph::Add(g.get(), mock, mock);
+  Node* b = test::graph::Add(g.get(), a, mock);
+  test::graph::Retval(g.get(), 0, b);
+  test::graph::Retval(g.get(), 1, mock, 1);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g),
+         [&](OpKernelContext* ctx) { ctx->set_output(0, ctx->input(0)); });
+  for (int i = 0; i < 2; ++i) {
+    FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT, DT_STRING});
+    TF_ASSERT_OK(call_frame.SetArgs({V(1.0 + i)}));
+    TF_ASSERT_OK(Run(&call_frame));
+    std::vector<Tensor> retvals;
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    EXPECT_EQ(3.0 * (1.0 + i), V(retvals[0]));
+    EXPECT_EQ(DT_STRING, retvals[1].dtype());
+  }
+}
+
 TEST_F(ExecutorTest, SelfAdd) {
   // v0 <- a
   // v1 = v0 + v0
@@ -64,6 +64,9 @@ class Flags {
   // TODO(b/341325107): Make this behavior the default and remove the flag.
   TF_DECLARE_FLAG(enable_function_pruning_before_inlining, false,
                   "If true, functions will be pruned before inlining.")
+  TF_DECLARE_FLAG(enable_collective_bucketing, false,
+                  "If true, small CollectiveReduceV2 ops on the same device "
+                  "and group will be fused into bucketed all-reduces.")
   // LINT.ThenChange(//tensorflow/core/config/flags_api_wrapper.cc)
 };
 
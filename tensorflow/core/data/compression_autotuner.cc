@@ -0,0 +1,142 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/compression_autotuner.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+
+CompressionAutotuner::CompressionAutotuner(const Options& options)
+    : options_(options) {}
+
+absl::Status CompressionAutotuner::CompressElement(
+    const std::vector<Tensor>& element, CompressedElement* out) {
+  bool sample = false;
+  std::vector<CompressionCodec> codecs;
+  {
+    mutex_lock l(mu_);
+    if (num_started_samples_ < options_.num_sample_elements) {
+      ++num_started_samples_;
+      sample = true;
+    } else if (!codecs_.empty() &&
+               ++num_elements_since_sampling_ >= options_.resample_interval) {
+      costs_.clear();
+      num_started_samples_ = 1;
+      num_finished_samples_ = 0;
+      num_elements_since_sampling_ = 0;
+      sample = true;
+    }
+    codecs = codecs_;
+  }
+
+  if (sample) {
+    TF_RETURN_IF_ERROR(Sample(element));
+  }
+  if (codecs.size() != element.size()) {
+    codecs.assign(element.size(), COMPRESSION_CODEC_SNAPPY);
+  }
+  return ::tensorflow::data::CompressElement(element, codecs, out);
+}
+
+absl::Status CompressionAutotuner::Sample(const std::vector<Tensor>& element) {
+  const double nanos_per_byte =
+      1e9 / std::max<int64_t>(options_.link_bandwidth_bytes_per_second, 1);
+  std::vector<std::vector<std::pair<CompressionCodec, double>>> costs;
+  costs.reserve(element.size());
+  for (const Tensor& component : element) {
+    costs.emplace_back();
+    for (CompressionCodec codec : CandidateCodecs(component.dtype())) {
+      const uint64_t start_nanos = EnvTime::NowNanos();
+      CompressedElement compressed;
+      TF_RETURN_IF_ERROR(
+          ::tensorflow::data::CompressElement({component}, {codec},
+                                              &compressed));
+      std::vector<Tensor> uncompressed;
+      TF_RETURN_IF_ERROR(UncompressElement(compressed, &uncompressed));
+      const uint64_t end_nanos = EnvTime::NowNanos();
+      costs.back().emplace_back(
+          codec, (end_nanos - start_nanos) +
+                     compressed.data().size() * nanos_per_byte);
+    }
+  }
+
+  mutex_lock l(mu_);
+  if (costs_.size() != costs.size()) {
+    costs_ = std::move(costs);
+  } else {
+    for (int i = 0; i < costs.size(); ++i) {
+      for (int j = 0; j < costs[i].size(); ++j) {
+        costs_[i][j].second += costs[i][j].second;
+      }
+    }
+  }
+  if (++num_finished_samples_ == options_.num_sample_elements) {
+    ChooseCodecs();
+  }
+  return absl::OkStatus();
+}
+
+void CompressionAutotuner::ChooseCodecs() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  codecs_.clear();
+  for (const auto& component_costs : costs_) {
+    auto cheapest = std::min_element(
+        component_costs.begin(), component_costs.end(),
+        [](const auto& a, const auto& b) { return a.second < b.second; });
+    codecs_.push_back(cheapest->first);
+  }
+  num_elements_since_sampling_ = 0;
+  VLOG(2) << "Chose compression codecs ["
+          << absl::StrJoin(codecs_, ", ",
+                           [](std::string* out, CompressionCodec codec) {
+                             out->append(CompressionCodec_Name(codec));
+                           })
+          << "] for a link of "
+          << options_.link_bandwidth_bytes_per_second << " bytes per second";
+}
+
+std::vector<CompressionCodec> CompressionAutotuner::Codecs() const {
+  mutex_lock l(mu_);
+  return codecs_;
+}
+
+std::vector<CompressionCodec> CompressionAutotuner::CandidateCodecs(
+    DataType dtype) {
+  std::vector<CompressionCodec> codecs = {
+      COMPRESSION_CODEC_NONE, COMPRESSION_CODEC_SNAPPY, COMPRESSION_CODEC_ZSTD};
+  if (DataTypeIsFloating(dtype)) {
+    codecs.push_back(COMPRESSION_CODEC_BYTE_SHUFFLE_ZSTD);
+  }
+  return codecs;
+}
+
+}  // namespace data
+}  // namespace tensorflow
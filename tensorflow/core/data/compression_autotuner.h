@@ -0,0 +1,101 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_COMPRESSION_AUTOTUNER_H_
+#define TENSORFLOW_CORE_DATA_COMPRESSION_AUTOTUNER_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Chooses a compression codec for each component of the elements of a
+// dataset. It compresses sample elements with each candidate codec, and picks
+// the codec which minimizes the estimated time to compress, send, and
+// uncompress the component. Fast links favor cheap codecs or no compression,
+// while slow links favor codecs with higher compression ratios.
+//
+// The codecs are chosen again every `resample_interval` elements, in case the
+// elements change over time. Until the first codecs are chosen, components are
+// compressed with snappy.
+//
+// This class is thread-safe.
+class CompressionAutotuner {
+ public:
+  // 10 Gbps.
+  static constexpr int64_t kDefaultLinkBandwidthBytesPerSecond = 1250000000;
+
+  struct Options {
+    // The bandwidth of the link over which compressed elements are sent.
+    int64_t link_bandwidth_bytes_per_second =
+        kDefaultLinkBandwidthBytesPerSecond;
+    // The number of sample elements used to choose the codecs.
+    int64_t num_sample_elements = 16;
+    // The number of elements compressed between two rounds of sampling.
+    int64_t resample_interval = 10000;
+  };
+
+  explicit CompressionAutotuner(const Options& options);
+  CompressionAutotuner(const CompressionAutotuner&) = delete;
+  CompressionAutotuner& operator=(const CompressionAutotuner&) = delete;
+
+  // Compresses `element` with the chosen codecs, sampling it with every
+  // candidate codec if the codecs are being chosen.
+  absl::Status CompressElement(const std::vector<Tensor>& element,
+                               CompressedElement* out);
+
+  // Returns the chosen codecs, or an empty vector if none have been chosen.
+  std::vector<CompressionCodec> Codecs() const;
+
+  // Returns the codecs to consider for components of type `dtype`.
+  static std::vector<CompressionCodec> CandidateCodecs(DataType dtype);
+
+ private:
+  // Compresses and uncompresses each component of `element` with each of its
+  // candidate codecs, and adds the estimated costs to `costs_`.
+  absl::Status Sample(const std::vector<Tensor>& element);
+
+  // Chooses the codec with the lowest sampled cost for each component.
+  void ChooseCodecs() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Options options_;
+
+  mutable mutex mu_;
+  // The codecs used for each component.
+  std::vector<CompressionCodec> codecs_ TF_GUARDED_BY(mu_);
+  // `costs_[i]` holds the candidate codecs of component `i`, with the total
+  // estimated cost in nanoseconds of the samples of the component.
+  std::vector<std::vector<std::pair<CompressionCodec, double>>> costs_
+      TF_GUARDED_BY(mu_);
+  // The number of elements picked for sampling in this round.
+  int64_t num_started_samples_ TF_GUARDED_BY(mu_) = 0;
+  // The number of elements sampled in this round.
+  int64_t num_finished_samples_ TF_GUARDED_BY(mu_) = 0;
+  // The number of elements compressed since the codecs were chosen.
+  int64_t num_elements_since_sampling_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_COMPRESSION_AUTOTUNER_H_
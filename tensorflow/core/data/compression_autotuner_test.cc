@@ -0,0 +1,113 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/compression_autotuner.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::Contains;
+using ::testing::IsEmpty;
+using ::testing::Not;
+using ::testing::SizeIs;
+
+// Returns an element whose first component compresses well.
+std::vector<Tensor> Element() {
+  return {CreateTensor<int64_t>(TensorShape{64, 64}),
+          CreateTensor<tstring>(TensorShape{2}, {"abc", "xyz"})};
+}
+
+CompressionAutotuner::Options TestOptions(
+    int64_t link_bandwidth_bytes_per_second) {
+  CompressionAutotuner::Options options;
+  options.link_bandwidth_bytes_per_second = link_bandwidth_bytes_per_second;
+  options.num_sample_elements = 3;
+  options.resample_interval = 5;
+  return options;
+}
+
+void CompressAndCheck(CompressionAutotuner& autotuner,
+                      const std::vector<Tensor>& element) {
+  CompressedElement compressed;
+  TF_ASSERT_OK(autotuner.CompressElement(element, &compressed));
+  std::vector<Tensor> uncompressed;
+  TF_ASSERT_OK(UncompressElement(compressed, &uncompressed));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(element, uncompressed,
+                                               /*compare_order=*/true));
+}
+
+TEST(CompressionAutotunerTest, ChoosesCodecsAfterSampling) {
+  CompressionAutotuner autotuner(TestOptions(
+      CompressionAutotuner::kDefaultLinkBandwidthBytesPerSecond));
+  for (int i = 0; i < 2; ++i) {
+    CompressAndCheck(autotuner, Element());
+    EXPECT_THAT(autotuner.Codecs(), IsEmpty());
+  }
+  CompressAndCheck(autotuner, Element());
+  EXPECT_THAT(autotuner.Codecs(), SizeIs(2));
+}
+
+TEST(CompressionAutotunerTest, SlowLinkCompresses) {
+  CompressionAutotuner autotuner(
+      TestOptions(/*link_bandwidth_bytes_per_second=*/1));
+  for (int i = 0; i < 3; ++i) {
+    CompressAndCheck(autotuner, Element());
+  }
+  ASSERT_THAT(autotuner.Codecs(), SizeIs(2));
+  EXPECT_NE(autotuner.Codecs()[0], COMPRESSION_CODEC_NONE);
+}
+
+TEST(CompressionAutotunerTest, FastLinkDoesNotCompress) {
+  CompressionAutotuner autotuner(TestOptions(
+      /*link_bandwidth_bytes_per_second=*/int64_t{1} << 60));
+  for (int i = 0; i < 3; ++i) {
+    CompressAndCheck(autotuner, Element());
+  }
+  ASSERT_THAT(autotuner.Codecs(), SizeIs(2));
+  EXPECT_EQ(autotuner.Codecs()[0], COMPRESSION_CODEC_NONE);
+}
+
+TEST(CompressionAutotunerTest, Resamples) {
+  CompressionAutotuner autotuner(
+      TestOptions(/*link_bandwidth_bytes_per_second=*/1));
+  for (int i = 0; i < 100; ++i) {
+    CompressAndCheck(autotuner, Element());
+  }
+  EXPECT_THAT(autotuner.Codecs(), SizeIs(2));
+}
+
+TEST(CompressionAutotunerTest, CandidateCodecs) {
+  EXPECT_THAT(CompressionAutotuner::CandidateCodecs(DT_FLOAT),
+              Contains(COMPRESSION_CODEC_BYTE_SHUFFLE_ZSTD));
+  EXPECT_THAT(CompressionAutotuner::CandidateCodecs(DT_INT64),
+              Not(Contains(COMPRESSION_CODEC_BYTE_SHUFFLE_ZSTD)));
+  EXPECT_THAT(CompressionAutotuner::CandidateCodecs(DT_STRING),
+              Not(Contains(COMPRESSION_CODEC_BYTE_SHUFFLE_ZSTD)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -14,10 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <cstddef>
+#include <cstring>
 #include <limits>
 #include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -27,6 +31,10 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
 
+#if !defined(IS_MOBILE_PLATFORM)
+#include "zstd.h"
+#endif  // !IS_MOBILE_PLATFORM
+
 namespace tensorflow {
 namespace data {
 namespace {
@@ -34,7 +42,13 @@ namespace {
 // Increment this when making changes to the `CompressedElement` proto. The
 // `UncompressElement` function will determine what to read according to the
 // version.
-constexpr int kCompressedElementVersion = 0;
+constexpr int kCompressedElementVersion = 1;
+
+// Version of the `CompressedElement`s whose components are compressed together
+// with snappy.
+constexpr int kSnappyCompressedElementVersion = 0;
+
+constexpr int kZstdCompressionLevel = 1;
 
 }  // namespace
 
@@ -61,6 +75,263 @@ class Iov {
   size_t num_bytes_;
 };
 
+namespace {
+
+// Returns the uncompressed bytes of `component`, and records their sizes in
+// `metadata`. Components which are not stored contiguously are copied to
+// `storage`.
+absl::string_view ComponentBytes(const Tensor& component, std::string& storage,
+                                 CompressedComponentMetadata& metadata) {
+  if (DataTypeCanUseMemcpy(component.dtype())) {
+    const TensorBuffer* buffer = DMAHelper::buffer(&component);
+    if (buffer == nullptr) {
+      metadata.add_uncompressed_bytes(0);
+      return absl::string_view();
+    }
+    metadata.add_uncompressed_bytes(buffer->size());
+    return absl::string_view(static_cast<const char*>(buffer->data()),
+                             buffer->size());
+  }
+  if (component.dtype() == DT_STRING) {
+    const auto& flats = component.unaligned_flat<tstring>();
+    for (int i = 0; i < flats.size(); ++i) {
+      storage.append(flats.data()[i].data(), flats.data()[i].size());
+      metadata.add_uncompressed_bytes(flats.data()[i].size());
+    }
+    return storage;
+  }
+  TensorProto proto;
+  component.AsProtoTensorContent(&proto);
+  proto.SerializeToString(&storage);
+  metadata.add_uncompressed_bytes(storage.size());
+  return storage;
+}
+
+// Groups the `i`-th bytes of the `value_size`-byte values of `input`. Trailing
+// bytes which don't make a whole value are kept at the end.
+void ByteShuffle(absl::string_view input, size_t value_size, char* output) {
+  const size_t num_values = input.size() / value_size;
+  for (size_t i = 0; i < num_values; ++i) {
+    for (size_t j = 0; j < value_size; ++j) {
+      output[j * num_values + i] = input[i * value_size + j];
+    }
+  }
+  const size_t shuffled_size = num_values * value_size;
+  std::memcpy(output + shuffled_size, input.data() + shuffled_size,
+              input.size() - shuffled_size);
+}
+
+// Reverts `ByteShuffle`.
+void ByteUnshuffle(absl::string_view input, size_t value_size, char* output) {
+  const size_t num_values = input.size() / value_size;
+  for (size_t i = 0; i < num_values; ++i) {
+    for (size_t j = 0; j < value_size; ++j) {
+      output[i * value_size + j] = input[j * num_values + i];
+    }
+  }
+  const size_t shuffled_size = num_values * value_size;
+  std::memcpy(output + shuffled_size, input.data() + shuffled_size,
+              input.size() - shuffled_size);
+}
+
+Status ZstdCompress(absl::string_view input, std::string& output) {
+#if defined(IS_MOBILE_PLATFORM)
+  return errors::Unimplemented(
+      "Zstd compression is not supported on mobile platforms.");
+#else   // !IS_MOBILE_PLATFORM
+  const size_t offset = output.size();
+  output.resize(offset + ZSTD_compressBound(input.size()));
+  const size_t compressed_size =
+      ZSTD_compress(output.data() + offset, output.size() - offset,
+                    input.data(), input.size(), kZstdCompressionLevel);
+  if (ZSTD_isError(compressed_size)) {
+    return errors::Internal("Failed to compress using zstd: ",
+                            ZSTD_getErrorName(compressed_size));
+  }
+  output.resize(offset + compressed_size);
+  return absl::OkStatus();
+#endif  // IS_MOBILE_PLATFORM
+}
+
+Status ZstdUncompress(absl::string_view input, char* output,
+                      size_t output_size) {
+#if defined(IS_MOBILE_PLATFORM)
+  return errors::Unimplemented(
+      "Zstd decompression is not supported on mobile platforms.");
+#else   // !IS_MOBILE_PLATFORM
+  const size_t uncompressed_size =
+      ZSTD_decompress(output, output_size, input.data(), input.size());
+  if (ZSTD_isError(uncompressed_size)) {
+    return errors::Internal("Failed to perform zstd decompression: ",
+                            ZSTD_getErrorName(uncompressed_size));
+  }
+  if (uncompressed_size != output_size) {
+    return errors::Internal("Uncompressed size mismatch. Zstd produced ",
+                            uncompressed_size,
+                            " bytes whereas the tensor metadata suggests ",
+                            output_size);
+  }
+  return absl::OkStatus();
+#endif  // IS_MOBILE_PLATFORM
+}
+
+// Compresses `input`, made of `value_size`-byte values, with `codec`, and
+// appends the result to `output`.
+Status CompressBytes(CompressionCodec codec, absl::string_view input,
+                     size_t value_size, std::string& output) {
+  switch (codec) {
+    case COMPRESSION_CODEC_NONE:
+      output.append(input.data(), input.size());
+      return absl::OkStatus();
+    case COMPRESSION_CODEC_SNAPPY: {
+      if (input.size() > kuint32max) {
+        return errors::OutOfRange(
+            "Encountered dataset element component of size ", input.size(),
+            ", exceeding the 4GB Snappy limit.");
+      }
+      std::string compressed;
+      if (!port::Snappy_Compress(input.data(), input.size(), &compressed)) {
+        return errors::Internal("Failed to compress using snappy.");
+      }
+      output.append(compressed);
+      return absl::OkStatus();
+    }
+    case COMPRESSION_CODEC_ZSTD:
+      return ZstdCompress(input, output);
+    case COMPRESSION_CODEC_BYTE_SHUFFLE_ZSTD: {
+      std::string shuffled(input.size(), '\0');
+      ByteShuffle(input, value_size, shuffled.data());
+      return ZstdCompress(shuffled, output);
+    }
+    default:
+      return errors::InvalidArgument("Unsupported compression codec: ",
+                                     CompressionCodec_Name(codec));
+  }
+}
+
+// Uncompresses `input`, compressed with `codec`, into the `output_size` bytes
+// at `output`.
+Status UncompressBytes(CompressionCodec codec, absl::string_view input,
+                       size_t value_size, char* output, size_t output_size) {
+  switch (codec) {
+    case COMPRESSION_CODEC_NONE:
+      if (input.size() != output_size) {
+        return errors::Internal("Uncompressed size mismatch. Got ",
+                                input.size(),
+                                " bytes whereas the tensor metadata suggests ",
+                                output_size);
+      }
+      std::memcpy(output, input.data(), output_size);
+      return absl::OkStatus();
+    case COMPRESSION_CODEC_SNAPPY: {
+      size_t uncompressed_size;
+      if (!port::Snappy_GetUncompressedLength(input.data(), input.size(),
+                                              &uncompressed_size)) {
+        return errors::Internal(
+            "Could not get snappy uncompressed length. Compressed data size: ",
+            input.size());
+      }
+      if (uncompressed_size != output_size) {
+        return errors::Internal(
+            "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+            " whereas the tensor metadata suggests ", output_size);
+      }
+      if (!port::Snappy_Uncompress(input.data(), input.size(), output)) {
+        return errors::Internal("Failed to perform snappy decompression.");
+      }
+      return absl::OkStatus();
+    }
+    case COMPRESSION_CODEC_ZSTD:
+      return ZstdUncompress(input, output, output_size);
+    case COMPRESSION_CODEC_BYTE_SHUFFLE_ZSTD: {
+      std::string shuffled(output_size, '\0');
+      TF_RETURN_IF_ERROR(ZstdUncompress(input, shuffled.data(), output_size));
+      ByteUnshuffle(shuffled, value_size, output);
+      return absl::OkStatus();
+    }
+    default:
+      return errors::Internal("Unsupported compression codec: ",
+                              CompressionCodec_Name(codec));
+  }
+}
+
+// Uncompresses a `CompressedElement` whose components are compressed
+// separately.
+Status UncompressComponents(const CompressedElement& compressed,
+                            std::vector<Tensor>* out) {
+  out->clear();
+  out->reserve(compressed.component_metadata_size());
+  absl::string_view data = compressed.data();
+  for (const auto& metadata : compressed.component_metadata()) {
+    if (metadata.compressed_bytes() > data.size()) {
+      return errors::Internal("Compressed component of ",
+                              metadata.compressed_bytes(),
+                              " bytes exceeds the remaining ", data.size(),
+                              " bytes of compressed data");
+    }
+    absl::string_view component_data =
+        data.substr(0, metadata.compressed_bytes());
+    data.remove_prefix(metadata.compressed_bytes());
+    size_t uncompressed_size = 0;
+    for (uint64 size : metadata.uncompressed_bytes()) {
+      uncompressed_size += size;
+    }
+
+    if (DataTypeCanUseMemcpy(metadata.dtype())) {
+      out->emplace_back(metadata.dtype(), metadata.tensor_shape());
+      TensorBuffer* buffer = DMAHelper::buffer(&out->back());
+      const size_t buffer_size = buffer == nullptr ? 0 : buffer->size();
+      if (buffer_size != uncompressed_size) {
+        return errors::Internal("Tensor of ", buffer_size,
+                                " bytes does not match the ",
+                                uncompressed_size,
+                                " bytes of the tensor metadata");
+      }
+      if (uncompressed_size > 0) {
+        TF_RETURN_IF_ERROR(UncompressBytes(
+            metadata.codec(), component_data, DataTypeSize(metadata.dtype()),
+            static_cast<char*>(buffer->data()), uncompressed_size));
+      }
+      continue;
+    }
+
+    std::string uncompressed(uncompressed_size, '\0');
+    if (uncompressed_size > 0) {
+      TF_RETURN_IF_ERROR(UncompressBytes(metadata.codec(), component_data,
+                                         /*value_size=*/1, uncompressed.data(),
+                                         uncompressed_size));
+    }
+    if (metadata.dtype() == DT_STRING) {
+      out->emplace_back(metadata.dtype(), metadata.tensor_shape());
+      const auto& flats = out->back().unaligned_flat<tstring>();
+      if (flats.size() != metadata.uncompressed_bytes_size()) {
+        return errors::Internal("String tensor of ", flats.size(),
+                                " strings does not match the ",
+                                metadata.uncompressed_bytes_size(),
+                                " strings of the tensor metadata");
+      }
+      size_t offset = 0;
+      for (int i = 0; i < metadata.uncompressed_bytes_size(); ++i) {
+        flats.data()[i].assign(uncompressed.data() + offset,
+                               metadata.uncompressed_bytes(i));
+        offset += metadata.uncompressed_bytes(i);
+      }
+      continue;
+    }
+    TensorProto tp;
+    if (!tp.ParseFromString(uncompressed)) {
+      return errors::Internal("Could not parse TensorProto");
+    }
+    out->emplace_back();
+    if (!out->back().FromProto(tp)) {
+      return errors::Internal("Could not parse Tensor");
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out) {
   // First pass: preprocess the non`memcpy`able tensors.
@@ -129,15 +400,57 @@ Status CompressElement(const std::vector<Tensor>& element,
                                       out->mutable_data())) {
     return errors::Internal("Failed to compress using snappy.");
   }
-  out->set_version(kCompressedElementVersion);
+  out->set_version(kSnappyCompressedElementVersion);
   VLOG(3) << "Compressed element from " << iov.NumBytes() << " bytes to "
           << out->data().size() << " bytes";
   return absl::OkStatus();
 }
 
+Status CompressElement(const std::vector<Tensor>& element,
+                       absl::Span<const CompressionCodec> codecs,
+                       CompressedElement* out) {
+  if (codecs.size() != element.size()) {
+    return errors::InvalidArgument("Got ", codecs.size(),
+                                   " compression codecs for an element of ",
+                                   element.size(), " components.");
+  }
+  std::string* data = out->mutable_data();
+  size_t uncompressed_size = 0;
+  for (int i = 0; i < element.size(); ++i) {
+    const Tensor& component = element[i];
+    if (codecs[i] == COMPRESSION_CODEC_BYTE_SHUFFLE_ZSTD &&
+        !DataTypeCanUseMemcpy(component.dtype())) {
+      return errors::InvalidArgument(
+          "Byte shuffle compression requires fixed size values, but component ",
+          i, " has type ", DataTypeString(component.dtype()));
+    }
+    CompressedComponentMetadata* metadata =
+        out->mutable_component_metadata()->Add();
+    metadata->set_dtype(component.dtype());
+    component.shape().AsProto(metadata->mutable_tensor_shape());
+    metadata->set_codec(codecs[i]);
+    std::string storage;
+    absl::string_view bytes = ComponentBytes(component, storage, *metadata);
+    const size_t offset = data->size();
+    const size_t value_size = DataTypeCanUseMemcpy(component.dtype())
+                                  ? DataTypeSize(component.dtype())
+                                  : 1;
+    TF_RETURN_IF_ERROR(CompressBytes(codecs[i], bytes, value_size, *data));
+    metadata->set_compressed_bytes(data->size() - offset);
+    uncompressed_size += bytes.size();
+  }
+  out->set_version(kCompressedElementVersion);
+  VLOG(3) << "Compressed element from " << uncompressed_size << " bytes to "
+          << data->size() << " bytes";
+  return absl::OkStatus();
+}
+
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out) {
-  if (compressed.version() != kCompressedElementVersion) {
+  if (compressed.version() == kCompressedElementVersion) {
+    return UncompressComponents(compressed, out);
+  }
+  if (compressed.version() != kSnappyCompressedElementVersion) {
     return errors::Internal("Unsupported compressed element version: ",
                             compressed.version());
   }
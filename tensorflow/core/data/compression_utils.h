@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <vector>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/status.h"
@@ -33,6 +34,16 @@ namespace data {
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
+// Compresses each component of `element` separately, with the codec at the
+// same index in `codecs`. Unlike the snappy compression of all the components
+// together, the codecs can be chosen to fit the types of the components.
+//
+// Returns an error if `COMPRESSION_CODEC_BYTE_SHUFFLE_ZSTD` is chosen for a
+// component whose values don't have a fixed size.
+Status CompressElement(const std::vector<Tensor>& element,
+                       absl::Span<const CompressionCodec> codecs,
+                       CompressedElement* out);
+
 // Uncompresses a `CompressedElement` into a vector of tensor components.
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out);
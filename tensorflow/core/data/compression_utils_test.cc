@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/data/compression_utils.h"
 
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "tensorflow/core/data/dataset_test_base.h"
@@ -98,7 +99,7 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
   CompressedElement compressed;
   TF_ASSERT_OK(CompressElement(element, &compressed));
 
-  compressed.set_version(1);
+  compressed.set_version(2);
   std::vector<Tensor> round_trip_element;
   EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
               StatusIs(error::INTERNAL));
@@ -107,6 +108,96 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
+class CompressionCodecTest
+    : public DatasetOpsTestBase,
+      public ::testing::WithParamInterface<
+          std::tuple<std::vector<Tensor>, CompressionCodec>> {};
+
+TEST_P(CompressionCodecTest, RoundTrip) {
+  const auto& [element, codec] = GetParam();
+  std::vector<CompressionCodec> codecs(element.size(), codec);
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, codecs, &compressed));
+  EXPECT_EQ(compressed.version(), 1);
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Instantiation, CompressionCodecTest,
+    ::testing::Combine(::testing::ValuesIn(TestCases()),
+                       ::testing::Values(COMPRESSION_CODEC_NONE,
+                                         COMPRESSION_CODEC_SNAPPY,
+                                         COMPRESSION_CODEC_ZSTD)));
+
+TEST(CompressionUtilsTest, ByteShuffleRoundTrip) {
+  Tensor floats(DT_FLOAT, TensorShape{257});
+  for (int i = 0; i < floats.NumElements(); ++i) {
+    floats.flat<float>()(i) = i * 0.25f;
+  }
+  std::vector<Tensor> element = {
+      floats, CreateTensor<double>(TensorShape{3}, {1.5, -2.0, 1e10}),
+      CreateTensor<tstring>(TensorShape{2}, {"abc", "xyz"})};
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element,
+                               {COMPRESSION_CODEC_BYTE_SHUFFLE_ZSTD,
+                                COMPRESSION_CODEC_BYTE_SHUFFLE_ZSTD,
+                                COMPRESSION_CODEC_ZSTD},
+                               &compressed));
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(element, round_trip_element,
+                                               /*compare_order=*/true));
+}
+
+TEST(CompressionUtilsTest, MixedCodecs) {
+  std::vector<Tensor> element = {
+      CreateTensor<int64_t>(TensorShape{128}),
+      CreateTensor<tstring>(TensorShape{1}, {"a"}),
+      CreateTensor<int64_t>(TensorShape{1, 0})};
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(
+      element,
+      {COMPRESSION_CODEC_ZSTD, COMPRESSION_CODEC_NONE,
+       COMPRESSION_CODEC_SNAPPY},
+      &compressed));
+  ASSERT_EQ(compressed.component_metadata_size(), 3);
+  EXPECT_EQ(compressed.component_metadata(1).codec(), COMPRESSION_CODEC_NONE);
+  EXPECT_EQ(compressed.component_metadata(1).compressed_bytes(), 1);
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(element, round_trip_element,
+                                               /*compare_order=*/true));
+}
+
+TEST(CompressionUtilsTest, ByteShuffleRequiresFixedSizeValues) {
+  std::vector<Tensor> element = {CreateTensor<tstring>(TensorShape{1}, {"a"})};
+  CompressedElement compressed;
+  EXPECT_THAT(CompressElement(element, {COMPRESSION_CODEC_BYTE_SHUFFLE_ZSTD},
+                              &compressed),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(CompressionUtilsTest, CodecsMismatch) {
+  std::vector<Tensor> element = {CreateTensor<int64_t>(TensorShape{1}, {1})};
+  CompressedElement compressed;
+  EXPECT_THAT(CompressElement(element, {}, &compressed),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(CompressionUtilsTest, TruncatedData) {
+  std::vector<Tensor> element = {CreateTensor<int64_t>(TensorShape{16})};
+  CompressedElement compressed;
+  TF_ASSERT_OK(
+      CompressElement(element, {COMPRESSION_CODEC_ZSTD}, &compressed));
+  compressed.mutable_data()->resize(compressed.data().size() / 2);
+  std::vector<Tensor> round_trip_element;
+  EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
+              StatusIs(error::INTERNAL));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -0,0 +1,348 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/indexed_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/raw_coding.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kIndexedCacheSuffix[] = ".indexed_cache";
+constexpr char kTempSuffix[] = ".tmp";
+constexpr uint64_t kMagic = 0x48434143444654ULL;  // "TFDCACH"
+// The number of elements, the number of components, the offset of the index,
+// and the magic number.
+constexpr int64_t kFooterSize = 4 * sizeof(uint64_t);
+// The dtype, encoding, number of dimensions and an unused word.
+constexpr int64_t kComponentHeaderSize = 4 * sizeof(uint32_t);
+
+// How the content of a component is stored.
+enum Encoding : uint32_t {
+  // The bytes of the tensor buffer.
+  kRaw = 0,
+  // A serialized `TensorProto`.
+  kProto = 1,
+};
+
+uint64_t AlignUp(uint64_t offset) {
+  return (offset + kIndexedCacheAlignment - 1) / kIndexedCacheAlignment *
+         kIndexedCacheAlignment;
+}
+
+// A copy of a file in aligned memory, for file systems that cannot map files.
+class AlignedMemoryRegion : public ReadOnlyMemoryRegion {
+ public:
+  static absl::StatusOr<std::unique_ptr<ReadOnlyMemoryRegion>> Read(
+      Env* env, const std::string& filename) {
+    uint64_t size;
+    TF_RETURN_IF_ERROR(env->GetFileSize(filename, &size));
+    std::unique_ptr<RandomAccessFile> file;
+    TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+    auto region = absl::WrapUnique(new AlignedMemoryRegion(size));
+    StringPiece data;
+    TF_RETURN_IF_ERROR(file->Read(0, size, &data, region->data_));
+    if (data.size() != size) {
+      return errors::DataLoss("Failed to read indexed cache ", filename,
+                              ": expected ", size, " bytes, got ",
+                              data.size());
+    }
+    if (data.data() != region->data_) {
+      memmove(region->data_, data.data(), size);
+    }
+    return region;
+  }
+
+  ~AlignedMemoryRegion() override { port::AlignedFree(data_); }
+
+  const void* data() override { return data_; }
+  uint64_t length() override { return length_; }
+
+ private:
+  explicit AlignedMemoryRegion(uint64_t length)
+      : data_(static_cast<char*>(
+            port::AlignedMalloc(std::max<uint64_t>(length, 1),
+                                kIndexedCacheAlignment))),
+        length_(length) {}
+
+  char* const data_;
+  const uint64_t length_;
+};
+
+}  // namespace
+
+class IndexedCacheReader::RegionBuffer : public TensorBuffer {
+ public:
+  RegionBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region, const char* data,
+               size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("IndexedCache");
+  }
+  // The mapped file is read-only, so ops must not reuse the buffer for their
+  // outputs.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+std::string IndexedCacheFilename(const std::string& prefix) {
+  return strings::StrCat(prefix, kIndexedCacheSuffix);
+}
+
+absl::StatusOr<std::unique_ptr<IndexedCacheWriter>> IndexedCacheWriter::Create(
+    Env* env, const std::string& filename) {
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(
+      env->NewWritableFile(strings::StrCat(filename, kTempSuffix), &file));
+  return absl::WrapUnique(
+      new IndexedCacheWriter(env, filename, std::move(file)));
+}
+
+Status IndexedCacheWriter::Append(absl::string_view data) {
+  TF_RETURN_IF_ERROR(file_->Append(data));
+  offset_ += data.size();
+  return absl::OkStatus();
+}
+
+Status IndexedCacheWriter::Align() {
+  static const auto* const kZeros =
+      new std::string(kIndexedCacheAlignment, '\0');
+  return Append(absl::string_view(*kZeros).substr(0, AlignUp(offset_) -
+                                                         offset_));
+}
+
+Status IndexedCacheWriter::Add(const std::vector<Tensor>& element) {
+  if (num_components_ == -1) {
+    num_components_ = element.size();
+  } else if (num_components_ != static_cast<int64_t>(element.size())) {
+    return errors::InvalidArgument(
+        "All elements of an indexed cache must have the same number of "
+        "components. Expected ",
+        num_components_, ", got ", element.size());
+  }
+  offsets_.push_back(offset_);
+  for (const Tensor& component : element) {
+    const bool raw = DataTypeCanUseMemcpy(component.dtype());
+    std::string proto_content;
+    absl::string_view content;
+    if (raw) {
+      content = component.tensor_data();
+    } else {
+      TensorProto proto;
+      component.AsProtoTensorContent(&proto);
+      if (!proto.SerializeToString(&proto_content)) {
+        return errors::Internal("Failed to serialize a tensor of type ",
+                                DataTypeString(component.dtype()));
+      }
+      content = proto_content;
+    }
+    std::string header;
+    core::PutFixed32(&header, component.dtype());
+    core::PutFixed32(&header, raw ? kRaw : kProto);
+    core::PutFixed32(&header, component.dims());
+    core::PutFixed32(&header, 0);
+    for (int64_t dim : component.shape().dim_sizes()) {
+      core::PutFixed64(&header, dim);
+    }
+    core::PutFixed64(&header, content.size());
+    TF_RETURN_IF_ERROR(Append(header));
+    TF_RETURN_IF_ERROR(Align());
+    TF_RETURN_IF_ERROR(Append(content));
+    TF_RETURN_IF_ERROR(Align());
+  }
+  return absl::OkStatus();
+}
+
+Status IndexedCacheWriter::Finish() {
+  const uint64_t index_offset = offset_;
+  std::string index;
+  index.reserve(offsets_.size() * sizeof(uint64_t) + kFooterSize);
+  for (uint64_t offset : offsets_) {
+    core::PutFixed64(&index, offset);
+  }
+  core::PutFixed64(&index, offsets_.size());
+  core::PutFixed64(&index, std::max<int64_t>(num_components_, 0));
+  core::PutFixed64(&index, index_offset);
+  core::PutFixed64(&index, kMagic);
+  TF_RETURN_IF_ERROR(Append(index));
+  TF_RETURN_IF_ERROR(file_->Close());
+  return env_->RenameFile(strings::StrCat(filename_, kTempSuffix), filename_);
+}
+
+absl::StatusOr<std::shared_ptr<const IndexedCacheReader>>
+IndexedCacheReader::Open(Env* env, const std::string& filename) {
+  static mutex* mu = new mutex();
+  static auto* readers = new absl::flat_hash_map<
+      std::string, std::weak_ptr<const IndexedCacheReader>>();
+  mutex_lock l(*mu);
+  auto& cached = (*readers)[filename];
+  if (std::shared_ptr<const IndexedCacheReader> reader = cached.lock()) {
+    return reader;
+  }
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  Status s = env->NewReadOnlyMemoryRegionFromFile(filename, &region);
+  if (errors::IsUnimplemented(s)) {
+    TF_ASSIGN_OR_RETURN(region, AlignedMemoryRegion::Read(env, filename));
+  } else {
+    TF_RETURN_IF_ERROR(s);
+  }
+  auto reader = std::shared_ptr<IndexedCacheReader>(
+      new IndexedCacheReader(std::move(region)));
+  TF_RETURN_IF_ERROR(reader->Initialize(filename));
+  cached = reader;
+  return reader;
+}
+
+Status IndexedCacheReader::Initialize(const std::string& filename) {
+  const uint64_t length = region_->length();
+  if (length < kFooterSize) {
+    return errors::DataLoss("Indexed cache ", filename, " is truncated.");
+  }
+  const char* footer = data() + length - kFooterSize;
+  num_elements_ = core::DecodeFixed64(footer);
+  num_components_ = core::DecodeFixed64(footer + sizeof(uint64_t));
+  index_offset_ = core::DecodeFixed64(footer + 2 * sizeof(uint64_t));
+  if (core::DecodeFixed64(footer + 3 * sizeof(uint64_t)) != kMagic ||
+      index_offset_ + num_elements_ * sizeof(uint64_t) + kFooterSize !=
+          length) {
+    return errors::DataLoss(filename, " is not a complete indexed cache.");
+  }
+  return absl::OkStatus();
+}
+
+Status IndexedCacheReader::Read(int64_t index,
+                                std::vector<Tensor>* element) const {
+  if (index < 0 || index >= num_elements_) {
+    return errors::OutOfRange("Index out of range [0, ", num_elements_,
+                              "): ", index);
+  }
+  uint64_t offset =
+      core::DecodeFixed64(data() + index_offset_ + index * sizeof(uint64_t));
+  auto check_bounds = [this](uint64_t end) {
+    if (end > index_offset_) {
+      return errors::DataLoss("Indexed cache element extends past the data.");
+    }
+    return absl::OkStatus();
+  };
+  element->clear();
+  element->reserve(num_components_);
+  for (int64_t i = 0; i < num_components_; ++i) {
+    TF_RETURN_IF_ERROR(check_bounds(offset + kComponentHeaderSize));
+    const char* header = data() + offset;
+    const DataType dtype = static_cast<DataType>(core::DecodeFixed32(header));
+    const uint32_t encoding = core::DecodeFixed32(header + sizeof(uint32_t));
+    const uint32_t num_dims =
+        core::DecodeFixed32(header + 2 * sizeof(uint32_t));
+    offset += kComponentHeaderSize;
+    TF_RETURN_IF_ERROR(
+        check_bounds(offset + (num_dims + 1) * sizeof(uint64_t)));
+    std::vector<int64_t> dims(num_dims);
+    for (uint32_t d = 0; d < num_dims; ++d) {
+      dims[d] = core::DecodeFixed64(data() + offset);
+      offset += sizeof(uint64_t);
+    }
+    const uint64_t content_size = core::DecodeFixed64(data() + offset);
+    offset = AlignUp(offset + sizeof(uint64_t));
+    TF_RETURN_IF_ERROR(check_bounds(offset + content_size));
+    const char* content = data() + offset;
+    offset = AlignUp(offset + content_size);
+
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(dims, &shape));
+    if (encoding == kProto) {
+      TensorProto proto;
+      if (!proto.ParseFromArray(content, content_size)) {
+        return errors::DataLoss(
+            "Failed to parse a tensor of an indexed cache.");
+      }
+      element->emplace_back();
+      if (!element->back().FromProto(proto)) {
+        return errors::DataLoss("Invalid tensor in an indexed cache.");
+      }
+      continue;
+    }
+    if (encoding != kRaw || !DataTypeCanUseMemcpy(dtype) ||
+        content_size != shape.num_elements() * DataTypeSize(dtype)) {
+      return errors::DataLoss("Invalid tensor in an indexed cache.");
+    }
+    if (content_size == 0) {
+      element->emplace_back(dtype, shape);
+      continue;
+    }
+    element->emplace_back(
+        dtype, shape,
+        core::RefCountPtr<TensorBuffer>(
+            new RegionBuffer(region_, content, content_size)));
+  }
+  return absl::OkStatus();
+}
+
+Status MergeIndexedCaches(Env* env, const std::vector<std::string>& filenames,
+                          const std::string& output) {
+  if (filenames.size() == 1) {
+    return env->RenameFile(filenames[0], output);
+  }
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<IndexedCacheWriter> writer,
+                      IndexedCacheWriter::Create(env, output));
+  for (const std::string& filename : filenames) {
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<const IndexedCacheReader> reader,
+                        IndexedCacheReader::Open(env, filename));
+    std::vector<Tensor> element;
+    for (int64_t i = 0; i < reader->NumElements(); ++i) {
+      TF_RETURN_IF_ERROR(reader->Read(i, &element));
+      TF_RETURN_IF_ERROR(writer->Add(element));
+    }
+  }
+  TF_RETURN_IF_ERROR(writer->Finish());
+  for (const std::string& filename : filenames) {
+    TF_RETURN_IF_ERROR(env->DeleteFile(filename));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
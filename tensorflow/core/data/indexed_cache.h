@@ -0,0 +1,131 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_INDEXED_CACHE_H_
+#define TENSORFLOW_CORE_DATA_INDEXED_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+
+// An indexed cache is a file of dataset elements that supports reading any
+// element by its index. It is laid out so that it can be memory-mapped:
+//
+//   [element 0][element 1]...[element n-1][index][footer]
+//
+// Each element is a sequence of components, each of which is a header (dtype,
+// shape and encoding) followed by its content. The index holds the offset of
+// each element, and the footer the number of elements and components and the
+// offset of the index. Elements and contents are aligned to `kAlignment`, so
+// tensors of types that can be copied with memcpy are read without copying,
+// as views into the mapped file. Other tensors are stored as `TensorProto`s.
+//
+// All readers of a file in a process share one mapping of it, and hence
+// the page cache.
+
+// The alignment of the elements and component contents in the file.
+inline constexpr int64_t kIndexedCacheAlignment = 64;
+
+// Returns the name of the indexed cache file for the cache `prefix`.
+std::string IndexedCacheFilename(const std::string& prefix);
+
+// Writes elements to an indexed cache file. The elements are written to a
+// temporary file, which is renamed to the file by `Finish()`.
+class IndexedCacheWriter {
+ public:
+  // Creates a writer of the file `filename`, replacing any existing file.
+  static absl::StatusOr<std::unique_ptr<IndexedCacheWriter>> Create(
+      Env* env, const std::string& filename);
+
+  // Appends `element` to the file. All elements must have the same number of
+  // components.
+  Status Add(const std::vector<Tensor>& element);
+
+  // Writes the index and closes the file.
+  Status Finish();
+
+  int64_t NumElements() const { return offsets_.size(); }
+
+ private:
+  IndexedCacheWriter(Env* env, const std::string& filename,
+                     std::unique_ptr<WritableFile> file)
+      : env_(env), filename_(filename), file_(std::move(file)) {}
+
+  Status Append(absl::string_view data);
+  // Pads the file with zeros up to the next multiple of the alignment.
+  Status Align();
+
+  Env* const env_;
+  const std::string filename_;
+  std::unique_ptr<WritableFile> file_;
+  uint64_t offset_ = 0;
+  int64_t num_components_ = -1;
+  std::vector<uint64_t> offsets_;
+};
+
+// Reads elements of an indexed cache file. It is safe to call `Read()`
+// concurrently.
+class IndexedCacheReader {
+ public:
+  // Returns the reader of the complete file `filename`. Readers are shared by
+  // all callers in the process while any of them holds its reader.
+  static absl::StatusOr<std::shared_ptr<const IndexedCacheReader>> Open(
+      Env* env, const std::string& filename);
+
+  int64_t NumElements() const { return num_elements_; }
+
+  // Reads the element at `index`. The tensors of types that can be copied with
+  // memcpy refer to the mapped file, which they keep alive.
+  Status Read(int64_t index, std::vector<Tensor>* element) const;
+
+ private:
+  // Keeps the mapped file alive while tensors refer to it.
+  class RegionBuffer;
+
+  explicit IndexedCacheReader(std::shared_ptr<ReadOnlyMemoryRegion> region)
+      : region_(std::move(region)) {}
+
+  // Parses the footer of the file.
+  Status Initialize(const std::string& filename);
+
+  const char* data() const {
+    return static_cast<const char*>(region_->data());
+  }
+
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  int64_t num_elements_ = 0;
+  int64_t num_components_ = 0;
+  uint64_t index_offset_ = 0;
+};
+
+// Merges the indexed cache files `filenames`, in order, into the file
+// `output`, and deletes them.
+Status MergeIndexedCaches(Env* env, const std::vector<std::string>& filenames,
+                          const std::string& output);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_INDEXED_CACHE_H_
@@ -0,0 +1,134 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/indexed_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<Tensor> MakeElement(int64_t i) {
+  return {test::AsScalar<int64_t>(i),
+          test::AsTensor<float>({1.0f * i, 2.0f * i, 3.0f * i}, {3}),
+          test::AsTensor<tstring>({"a", strings::StrCat(i)}, {2})};
+}
+
+Status WriteCache(const std::string& filename, int64_t begin, int64_t end) {
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<IndexedCacheWriter> writer,
+                      IndexedCacheWriter::Create(Env::Default(), filename));
+  for (int64_t i = begin; i < end; ++i) {
+    TF_RETURN_IF_ERROR(writer->Add(MakeElement(i)));
+  }
+  return writer->Finish();
+}
+
+void ExpectElement(const std::vector<Tensor>& element, int64_t i) {
+  std::vector<Tensor> expected = MakeElement(i);
+  ASSERT_EQ(element.size(), expected.size());
+  for (int j = 0; j < expected.size(); ++j) {
+    test::ExpectEqual(element[j], expected[j]);
+  }
+}
+
+TEST(IndexedCacheTest, ReadsElementsInAnyOrder) {
+  const std::string filename =
+      IndexedCacheFilename(io::JoinPath(testing::TmpDir(), "any_order"));
+  TF_ASSERT_OK(WriteCache(filename, 0, 10));
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const IndexedCacheReader> reader,
+                          IndexedCacheReader::Open(Env::Default(), filename));
+  EXPECT_EQ(reader->NumElements(), 10);
+  for (int64_t i : {7, 0, 9, 3}) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(reader->Read(i, &element));
+    ExpectElement(element, i);
+  }
+  std::vector<Tensor> element;
+  EXPECT_TRUE(errors::IsOutOfRange(reader->Read(10, &element)));
+}
+
+TEST(IndexedCacheTest, ReadsWithoutCopying) {
+  const std::string filename =
+      IndexedCacheFilename(io::JoinPath(testing::TmpDir(), "zero_copy"));
+  TF_ASSERT_OK(WriteCache(filename, 0, 2));
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const IndexedCacheReader> reader,
+                          IndexedCacheReader::Open(Env::Default(), filename));
+  // Readers of the same file are shared.
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const IndexedCacheReader> other,
+                          IndexedCacheReader::Open(Env::Default(), filename));
+  EXPECT_EQ(reader, other);
+
+  std::vector<Tensor> first, second;
+  TF_ASSERT_OK(reader->Read(1, &first));
+  TF_ASSERT_OK(other->Read(1, &second));
+  EXPECT_EQ(first[1].tensor_data().data(), second[1].tensor_data().data());
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(first[1].tensor_data().data()) %
+                kIndexedCacheAlignment,
+            0);
+
+  // The tensors keep the file mapped.
+  reader.reset();
+  other.reset();
+  ExpectElement(first, 1);
+}
+
+TEST(IndexedCacheTest, UnfinishedCacheIsNotReadable) {
+  const std::string filename =
+      IndexedCacheFilename(io::JoinPath(testing::TmpDir(), "unfinished"));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IndexedCacheWriter> writer,
+      IndexedCacheWriter::Create(Env::Default(), filename));
+  TF_ASSERT_OK(writer->Add(MakeElement(0)));
+  EXPECT_TRUE(errors::IsNotFound(
+      IndexedCacheReader::Open(Env::Default(), filename).status()));
+}
+
+TEST(IndexedCacheTest, MergesCaches) {
+  const std::string prefix = io::JoinPath(testing::TmpDir(), "merge");
+  std::vector<std::string> filenames;
+  for (int i = 0; i < 3; ++i) {
+    filenames.push_back(IndexedCacheFilename(strings::StrCat(prefix, "_", i)));
+    TF_ASSERT_OK(WriteCache(filenames.back(), 4 * i, 4 * (i + 1)));
+  }
+  const std::string output = IndexedCacheFilename(prefix);
+  TF_ASSERT_OK(MergeIndexedCaches(Env::Default(), filenames, output));
+  for (const std::string& filename : filenames) {
+    EXPECT_TRUE(errors::IsNotFound(Env::Default()->FileExists(filename)));
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const IndexedCacheReader> reader,
+                          IndexedCacheReader::Open(Env::Default(), output));
+  ASSERT_EQ(reader->NumElements(), 12);
+  for (int64_t i = 0; i < 12; ++i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(reader->Read(i, &element));
+    ExpectElement(element, i);
+  }
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
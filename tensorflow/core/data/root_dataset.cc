@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
+#include "tensorflow/core/data/shared_worker_pool.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -68,13 +69,16 @@ void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
     params->max_intra_op_parallelism =
         options.threading_options().max_intra_op_parallelism();
   }
+  auto experiments = GetExperiments();
   if (ShouldUsePrivateThreadPool(options)) {
     params->private_threadpool_size =
         options.threading_options().private_threadpool_size();
+  } else if (experiments.contains("shared_worker_pool") &&
+             options.autotune_options().cpu_budget() == 0) {
+    params->use_shared_worker_pool = true;
   }
   params->autotune = ShouldUseAutotuning(options);
   params->autotune_algorithm = model::AutotuneAlgorithm::DEFAULT;
-  auto experiments = GetExperiments();
   if (experiments.contains("stage_based_autotune") ||
       experiments.contains("stage_based_autotune_v2")) {
     params->autotune_algorithm = model::AutotuneAlgorithm::STAGE_BASED;
@@ -179,7 +183,12 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
           value_or_default(dataset()->params_.max_intra_op_parallelism, 0,
                            port::MaxParallelism());
     }
-    if (dataset()->params_.private_threadpool_size >= 0) {
+    if (dataset()->params_.use_shared_worker_pool) {
+      shared_worker_pool_pipeline_ =
+          SharedWorkerPool::Global()->RegisterPipeline(
+              dataset()->input_->type_string());
+      threadpool_size_ = shared_worker_pool_pipeline_->NumThreads();
+    } else if (dataset()->params_.private_threadpool_size >= 0) {
       threadpool_size_ =
           value_or_default(dataset()->params_.private_threadpool_size, 0,
                            port::MaxParallelism());
@@ -326,7 +335,13 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     // been set to a valid model in `Initialize()` if autotuning is on. We
     // should simply set `params.model` to `model_` here.
     params.model = model_;
-    if (dataset()->params_.private_threadpool_size >= 0) {
+    if (shared_worker_pool_pipeline_) {
+      params.runner = [pipeline = shared_worker_pool_pipeline_.get()](
+                          std::function<void()> c) {
+        pipeline->Schedule(std::move(c));
+      };
+      params.runner_threadpool_size = threadpool_size_;
+    } else if (dataset()->params_.private_threadpool_size >= 0) {
       params.runner = [pool = thread_pool_.get()](std::function<void()> c) {
         pool->Schedule(std::move(c));
       };
@@ -346,6 +361,14 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       RunMode run_mode = ctx->run_mode();
       model_thread_ = ctx->StartThread("tf_data_model", [this, run_mode]() {
         RootDataset::Params params = dataset()->params_;
+        if (shared_worker_pool_pipeline_) {
+          // Shares ownership of the pipeline, which may be unregistered
+          // before this thread is joined.
+          params.autotune_cpu_budget_func =
+              [pipeline = shared_worker_pool_pipeline_]() {
+                return pipeline->CpuBudget();
+              };
+        }
         std::function<int64_t(int64_t)> ram_budget_func;
         std::optional<int64_t> raw_ram_budget;
         if (params.autotune_ram_budget_from_options > 0) {
@@ -378,6 +401,8 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   int64_t max_intra_op_parallelism_;
   int64_t threadpool_size_;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
+  // Set instead of `thread_pool_` if the iterator uses the shared worker pool.
+  std::shared_ptr<SharedWorkerPool::Pipeline> shared_worker_pool_pipeline_;
 
   // The end time of the previous `GetNextInternal` call.
   uint64_t end_time_usec_ TF_GUARDED_BY(mu_) = 0;
@@ -40,6 +40,10 @@ class RootDataset : public DatasetBase {
     int64_t autotune_ram_budget_from_options;
     int64_t max_intra_op_parallelism = 1;
     int64_t private_threadpool_size = 0;
+    // If true, the iterator runs its work on the process-wide
+    // `SharedWorkerPool` instead of a private threadpool, and autotunes with
+    // the pool's CPU budget for the pipeline.
+    bool use_shared_worker_pool = false;
 
     int64_t ComputeInitialAutotuneRamBudget() const {
       if (autotune_ram_budget_from_options > 0) {
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/data/serialization_utils.h"
 
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -123,9 +124,7 @@ Status ReadElementsFromCheckpoint(IteratorContext* ctx,
 }
 
 Status WriteElement(IteratorStateWriter* writer, StringPiece key_prefix,
-                    const std::vector<std::vector<Tensor>>& elements,
-                    int64_t index) {
-  const std::vector<Tensor>& element = elements[index];
+                    const std::vector<Tensor>& element, int64_t index) {
   std::string element_prefix = absl::StrCat(key_prefix, "::", index);
   TF_RETURN_IF_ERROR(
       writer->WriteScalar(element_prefix, kNumComponents, element.size()));
@@ -142,7 +141,20 @@ Status WriteElementsToCheckpoint(
   TF_RETURN_IF_ERROR(
       writer->WriteScalar(key_prefix, kNumElements, elements.size()));
   for (int i = 0; i < elements.size(); ++i) {
-    TF_RETURN_IF_ERROR(WriteElement(writer, key_prefix, elements, i));
+    TF_RETURN_IF_ERROR(WriteElement(writer, key_prefix, elements[i], i));
+  }
+  return absl::OkStatus();
+}
+
+Status WriteElementsToCheckpoint(
+    IteratorStateWriter* writer, StringPiece key_prefix, int64_t num_elements,
+    const std::function<Status(int64_t, std::vector<Tensor>*)>& get_element) {
+  TF_RETURN_IF_ERROR(
+      writer->WriteScalar(key_prefix, kNumElements, num_elements));
+  std::vector<Tensor> element;
+  for (int64_t i = 0; i < num_elements; ++i) {
+    TF_RETURN_IF_ERROR(get_element(i, &element));
+    TF_RETURN_IF_ERROR(WriteElement(writer, key_prefix, element, i));
   }
   return absl::OkStatus();
 }
@@ -154,7 +166,21 @@ Status UpdateCheckpointElements(
   TF_RETURN_IF_ERROR(
       writer->WriteScalar(key_prefix, kNumElements, elements.size()));
   for (int64_t i : checkpoint_indices) {
-    TF_RETURN_IF_ERROR(WriteElement(writer, key_prefix, elements, i));
+    TF_RETURN_IF_ERROR(WriteElement(writer, key_prefix, elements[i], i));
+  }
+  return absl::OkStatus();
+}
+
+Status UpdateCheckpointElements(
+    IteratorStateWriter* writer, StringPiece key_prefix, int64_t num_elements,
+    const std::function<Status(int64_t, std::vector<Tensor>*)>& get_element,
+    const absl::flat_hash_set<int64_t>& checkpoint_indices) {
+  TF_RETURN_IF_ERROR(
+      writer->WriteScalar(key_prefix, kNumElements, num_elements));
+  std::vector<Tensor> element;
+  for (int64_t i : checkpoint_indices) {
+    TF_RETURN_IF_ERROR(get_element(i, &element));
+    TF_RETURN_IF_ERROR(WriteElement(writer, key_prefix, element, i));
   }
   return absl::OkStatus();
 }
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERIALIZATION_UTILS_H_
 
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -50,6 +51,12 @@ Status WriteElementsToCheckpoint(
     IteratorStateWriter* writer, StringPiece key_prefix,
     const std::vector<std::vector<Tensor>>& elements);
 
+// Like the above, but gets the `num_elements` elements one at a time from
+// `get_element`, for callers that do not store them as tensors.
+Status WriteElementsToCheckpoint(
+    IteratorStateWriter* writer, StringPiece key_prefix, int64_t num_elements,
+    const std::function<Status(int64_t, std::vector<Tensor>*)>& get_element);
+
 // Updates the dataset elements in the checkpoint for given `checkpoint_indices`
 // using the given key prefix, assuming that vector of elements have
 // checkpointed these before. The elements can be read back by passing the same
@@ -59,6 +66,12 @@ Status UpdateCheckpointElements(
     const std::vector<std::vector<Tensor>>& elements,
     const absl::flat_hash_set<int64_t>& checkpoint_indices);
 
+// Like the above, but gets the elements one at a time from `get_element`.
+Status UpdateCheckpointElements(
+    IteratorStateWriter* writer, StringPiece key_prefix, int64_t num_elements,
+    const std::function<Status(int64_t, std::vector<Tensor>*)>& get_element,
+    const absl::flat_hash_set<int64_t>& checkpoint_indices);
+
 // Helper class for reading data from a vector of VariantTensorData objects.
 class VariantTensorDataReader : public IteratorStateReader {
  public:
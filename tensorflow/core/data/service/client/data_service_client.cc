@@ -19,7 +19,6 @@ limitations under the License.
 #include <limits>
 #include <memory>
 #include <optional>
-#include <random>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -39,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/service/worker_client.h"
 #include "tensorflow/core/data/service/worker_impl.h"
+#include "tensorflow/core/data/service/worker_locality.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -178,6 +178,9 @@ absl::StatusOr<GetNextResult> DataServiceClient::GetNext(
       VLOG(3) << "Skipping result from task " << result->task_id;
     }
   } while (result->skip);
+  if (!IsCoordinatedRead()) {
+    batch_sizer_.RecordConsumption(Env::Default()->NowMicros());
+  }
 
   GetNextResult next;
   next.end_of_sequence = result->end_of_sequence;
@@ -437,17 +440,15 @@ Status DataServiceClient::AddTask(const TaskInfo& task_info)
       DCHECK_EQ(next_task_index_, 0);
     }
   }
-  if (!IsCoordinatedRead()) {
-    // Shuffle task order within each client to avoid thundering herd effect.
-    std::mt19937 rng;
-    std::shuffle(tasks_.begin(), tasks_.end(), rng);
-  }
   return absl::OkStatus();
 }
 
 void DataServiceClient::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
   ClientHeartbeatRequest req;
   req.set_iteration_client_id(iteration_client_id_);
+  for (std::string& tag : ClientTopologyTags()) {
+    req.add_client_tags(std::move(tag));
+  }
   if (IsCoordinatedRead()) {
     mutex_lock l(mu_);
     req.set_current_round(current_round_);
@@ -536,6 +537,20 @@ void DataServiceClient::UpdateTasks(const ClientHeartbeatResponse& resp)
       break;
     }
   }
+  if (!IsCoordinatedRead()) {
+    // The dispatcher lists the closest, least loaded tasks first, breaking ties
+    // differently for each client to avoid thundering herd effect.
+    absl::flat_hash_map<int64_t, int> task_order;
+    for (int i = 0; i < resp.task_info_size(); ++i) {
+      task_order[resp.task_info(i).task_id()] = i;
+    }
+    std::stable_sort(tasks_.begin(), tasks_.end(),
+                     [&task_order](const std::shared_ptr<Task>& a,
+                                   const std::shared_ptr<Task>& b) {
+                       return task_order[a->info.task_id()] <
+                              task_order[b->info.task_id()];
+                     });
+  }
 }
 
 bool DataServiceClient::ShouldReadFromTask(const TaskInfo& task) const
@@ -627,7 +642,7 @@ void DataServiceClient::RunWorkerThread(std::function<void()> done)
       mutex_lock l(mu_);
       if (task_to_process) {
         task_to_process->in_use = false;
-        --outstanding_requests_;
+        outstanding_elements_ -= task_to_process->max_elements;
         task_to_process = nullptr;
         worker_thread_cv_.notify_one();
       }
@@ -645,7 +660,8 @@ void DataServiceClient::RunWorkerThread(std::function<void()> done)
       }
       DCHECK(task_to_process != nullptr);
       task_to_process->in_use = true;
-      ++outstanding_requests_;
+      task_to_process->max_elements = MaxElementsPerRequest();
+      outstanding_elements_ += task_to_process->max_elements;
       if (IsCoordinatedRead()) {
         // Reserve a spot in the results_ queue.
         results_.push(std::make_shared<Result>());
@@ -666,7 +682,7 @@ void DataServiceClient::RunWorkerThread(std::function<void()> done)
       VLOG(1) << "Failed to get element from worker "
               << task_to_process->info.worker_address() << ": " << s;
       task_to_process->in_use = false;
-      --outstanding_requests_;
+      outstanding_elements_ -= task_to_process->max_elements;
       status_ = errors::CreateWithUpdatedMessage(
           s, absl::StrCat("Failed to get element from worker ",
                           task_to_process->info.worker_address(), ": ",
@@ -706,7 +722,22 @@ bool DataServiceClient::ShouldProcessTask() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   // Otherwise, results aren't added to `results_` until the data has been
   // successfully retrieved. We need to count requests already added to
   // `results_` as well as in-progress requests.
-  return results_.size() + outstanding_requests_ < max_outstanding_requests_;
+  return results_.size() + outstanding_elements_ < max_outstanding_requests_;
+}
+
+int64_t DataServiceClient::MaxElementsPerRequest() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (IsCoordinatedRead()) {
+    return 1;
+  }
+  // Requested elements count against `max_outstanding_requests_` like
+  // outstanding requests, so requests only ask for the room left.
+  const int64_t available_elements =
+      max_outstanding_requests_ - results_.size() - outstanding_elements_;
+  return std::clamp<int64_t>(
+      batch_sizer_.BatchSize(
+          /*num_concurrent_requests=*/num_running_worker_threads_),
+      1, std::max<int64_t>(available_elements, 1));
 }
 
 // Searches for a task to process, visiting tasks in-order and giving every
@@ -717,6 +748,18 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
     return nullptr;
   }
 
+  if (!IsCoordinatedRead()) {
+    // Prefer the tasks listed first, unless they had no element ready for
+    // their last request: those are only retried in round-robin order below.
+    for (std::shared_ptr<Task>& task : tasks_) {
+      if (current_round_ >= task->info.starting_round() && !task->in_use &&
+          !task->end_of_sequence && !task->removed &&
+          !task->skipped_previous_round) {
+        task->round = current_round_;
+        return task;
+      }
+    }
+  }
   for (int i = 0; i < tasks_.size(); ++i) {
     std::shared_ptr<Task>& task = tasks_[next_task_index_];
     if (IsCoordinatedRead() &&
@@ -757,8 +800,8 @@ void DataServiceClient::AdvanceTaskIndex() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   }
 }
 
-Status DataServiceClient::TryGetElement(const Task& task, bool allow_skip,
-                                        GetElementResult& result) {
+Status DataServiceClient::TryGetElement(
+    const Task& task, bool allow_skip, std::vector<GetElementResult>& results) {
   GetElementRequest req;
   req.set_task_id(task.info.task_id());
   req.set_skipped_previous_round(task.skipped_previous_round);
@@ -768,11 +811,14 @@ Status DataServiceClient::TryGetElement(const Task& task, bool allow_skip,
     req.set_allow_skip(true);
   } else {
     req.set_allow_skip(allow_skip);
+    if (task.max_elements > 1) {
+      req.set_max_elements(task.max_elements);
+    }
   }
   if (params_.cross_trainer_cache_options) {
     req.set_trainer_id(params_.cross_trainer_cache_options->trainer_id());
   }
-  return task.worker->GetElement(req, result);
+  return task.worker->GetElements(req, results);
 }
 
 void DataServiceClient::ProcessGetElementResponse(
@@ -861,9 +907,12 @@ Status DataServiceClient::GetElement(Task* task, int64_t deadline_micros,
                                      bool enqueue_result, bool allow_skip,
                                      std::shared_ptr<Result> result)
     TF_LOCKS_EXCLUDED(mu_) {
-  GetElementResult get_element_result;
+  std::vector<GetElementResult> get_element_results;
+  int64_t start_time_us;
   while (true) {
-    Status s = TryGetElement(*task, allow_skip, get_element_result);
+    get_element_results.clear();
+    start_time_us = Env::Default()->NowMicros();
+    Status s = TryGetElement(*task, allow_skip, get_element_results);
     if (s.ok()) {
       task->num_retries = 0;
       break;
@@ -920,7 +969,31 @@ Status DataServiceClient::GetElement(Task* task, int64_t deadline_micros,
       return absl::OkStatus();
     }
   }
-  ProcessGetElementResponse(enqueue_result, get_element_result, result, *task);
+  const int64_t latency_us = Env::Default()->NowMicros() - start_time_us;
+  if (get_element_results.empty()) {
+    return errors::Internal("Worker ", task->info.worker_address(),
+                            " returned no element for task ",
+                            task->info.task_id(), ".");
+  }
+  int64_t num_elements = 0, num_bytes = 0;
+  for (const GetElementResult& get_element_result : get_element_results) {
+    if (!get_element_result.components.empty()) {
+      ++num_elements;
+      for (const Tensor& component : get_element_result.components) {
+        num_bytes += component.TotalBytes();
+      }
+    }
+  }
+  ProcessGetElementResponse(enqueue_result, get_element_results.front(),
+                            result, *task);
+  // Further elements are only returned when reads are not coordinated, so they
+  // are always enqueued.
+  for (int64_t i = 1; i < get_element_results.size(); ++i) {
+    ProcessGetElementResponse(/*enqueue_result=*/true, get_element_results[i],
+                              std::make_shared<Result>(), *task);
+  }
+  mutex_lock l(mu_);
+  batch_sizer_.RecordResponse(num_elements, num_bytes, latency_us);
   return absl::OkStatus();
 }
 
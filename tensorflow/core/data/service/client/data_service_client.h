@@ -25,6 +25,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/data/service/client/common.h"
+#include "tensorflow/core/data/service/client/element_batch_sizer.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
@@ -112,6 +113,9 @@ class DataServiceClient {
     bool in_use TF_GUARDED_BY(&DataServiceClient::mu_) = false;
     // Indicates whether the worker has returned end_of_sequence for the task.
     bool end_of_sequence TF_GUARDED_BY(&DataServiceClient::mu_) = false;
+    // The number of elements requested from the task by the worker thread
+    // processing it.
+    int64_t max_elements = 1;
     // Number of retries. The more it is retried, the longer it should wait
     // before the next retry.
     int64_t num_retries = 0;
@@ -176,8 +180,10 @@ class DataServiceClient {
   // task a chance to proceed.
   std::shared_ptr<Task> GetTaskToProcess();
   void AdvanceTaskIndex();
+  // Returns the number of elements to request from a task.
+  int64_t MaxElementsPerRequest() const;
   Status TryGetElement(const Task& task, bool allow_skip,
-                       GetElementResult& result);
+                       std::vector<GetElementResult>& results);
   void ProcessGetElementResponse(bool enqueue_result,
                                  GetElementResult& get_element_result,
                                  std::shared_ptr<Result> result, Task& task);
@@ -201,14 +207,18 @@ class DataServiceClient {
 
   bool cancelled_ TF_GUARDED_BY(mu_) = false;
 
-  // Number of outstanding requests.
-  int64_t outstanding_requests_ TF_GUARDED_BY(mu_) = 0;
+  // Number of elements requested by outstanding requests. Requests may ask for
+  // several elements when reads are not coordinated.
+  int64_t outstanding_elements_ TF_GUARDED_BY(mu_) = 0;
 
   // max_outstanding_requests controls how many elements may be held in memory
   // at the same time. This count includes both in-progress requests for
   // elements as well as completed requests which haven't yet been produced.
   int64_t max_outstanding_requests_ TF_GUARDED_BY(mu_);
 
+  // Chooses how many elements requests ask for.
+  ElementBatchSizer batch_sizer_ TF_GUARDED_BY(mu_);
+
   // The number of threads in `worker_threads_` which are still running.
   int64_t num_running_worker_threads_ TF_GUARDED_BY(mu_) = 0;
 
@@ -0,0 +1,72 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/client/element_batch_sizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Weight of new measurements in the moving averages.
+constexpr double kDecay = 0.1;
+
+void Update(double value, double& average) {
+  average = average < 0 ? value : (1 - kDecay) * average + kDecay * value;
+}
+
+}  // namespace
+
+ElementBatchSizer::ElementBatchSizer(int64_t max_batch_size,
+                                     int64_t target_batch_bytes)
+    : max_batch_size_(std::max<int64_t>(max_batch_size, 1)),
+      target_batch_bytes_(target_batch_bytes) {}
+
+void ElementBatchSizer::RecordConsumption(int64_t time_us) {
+  if (last_consumption_us_ >= 0 && time_us >= last_consumption_us_) {
+    Update(time_us - last_consumption_us_, consumption_period_us_);
+  }
+  last_consumption_us_ = time_us;
+}
+
+void ElementBatchSizer::RecordResponse(int64_t num_elements, int64_t num_bytes,
+                                       int64_t latency_us) {
+  Update(latency_us, latency_us_);
+  if (num_elements > 0) {
+    Update(static_cast<double>(num_bytes) / num_elements, element_bytes_);
+  }
+}
+
+int64_t ElementBatchSizer::BatchSize(int64_t num_concurrent_requests) const {
+  if (consumption_period_us_ < 0 || latency_us_ < 0 || element_bytes_ < 0) {
+    return 1;
+  }
+  // The elements read by the consumer during a request, split across the
+  // concurrent requests.
+  const double consumed_elements =
+      latency_us_ / std::max(consumption_period_us_, 1.0) /
+      std::max<int64_t>(num_concurrent_requests, 1);
+  const double max_elements_by_size =
+      target_batch_bytes_ / std::max(element_bytes_, 1.0);
+  const double batch_size = std::ceil(std::min(
+      {consumed_elements, max_elements_by_size,
+       static_cast<double>(max_batch_size_)}));
+  return std::max<int64_t>(static_cast<int64_t>(batch_size), 1);
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,68 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_CLIENT_ELEMENT_BATCH_SIZER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_CLIENT_ELEMENT_BATCH_SIZER_H_
+
+#include <cstdint>
+
+namespace tensorflow {
+namespace data {
+
+// Chooses how many elements a `GetElement` request asks a worker for.
+//
+// A request should return the elements the consumer reads while the request
+// is in flight, so that the consumer does not wait, but no more: elements
+// requested from one worker can't be read from another. The batch size is
+// also bounded so that responses stay around `target_batch_bytes`.
+//
+// This class is not thread-safe.
+class ElementBatchSizer {
+ public:
+  // The default maximum number of elements requested at once.
+  static constexpr int64_t kDefaultMaxBatchSize = 64;
+  // The default target size of responses.
+  static constexpr int64_t kDefaultTargetBatchBytes = 4 << 20;
+
+  explicit ElementBatchSizer(
+      int64_t max_batch_size = kDefaultMaxBatchSize,
+      int64_t target_batch_bytes = kDefaultTargetBatchBytes);
+
+  // Records that the consumer read an element at `time_us`.
+  void RecordConsumption(int64_t time_us);
+
+  // Records a response with `num_elements` elements of `num_bytes` bytes in
+  // total, which took `latency_us` to arrive.
+  void RecordResponse(int64_t num_elements, int64_t num_bytes,
+                      int64_t latency_us);
+
+  // Returns the number of elements to request, if `num_concurrent_requests`
+  // requests are in flight at the same time.
+  int64_t BatchSize(int64_t num_concurrent_requests) const;
+
+ private:
+  const int64_t max_batch_size_;
+  const int64_t target_batch_bytes_;
+  // Exponential moving averages of the time between consumed elements, the
+  // latency of requests, and the size of elements. Negative until measured.
+  double consumption_period_us_ = -1.0;
+  double latency_us_ = -1.0;
+  double element_bytes_ = -1.0;
+  int64_t last_consumption_us_ = -1;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_CLIENT_ELEMENT_BATCH_SIZER_H_
@@ -0,0 +1,75 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/client/element_batch_sizer.h"
+
+#include <cstdint>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Records `n` elements consumed every `period_us`.
+void Consume(ElementBatchSizer& sizer, int64_t n, int64_t period_us) {
+  for (int64_t i = 0; i < n; ++i) {
+    sizer.RecordConsumption(i * period_us);
+  }
+}
+
+TEST(ElementBatchSizerTest, SingleElementsUntilMeasured) {
+  ElementBatchSizer sizer;
+  EXPECT_EQ(sizer.BatchSize(/*num_concurrent_requests=*/1), 1);
+  sizer.RecordResponse(/*num_elements=*/1, /*num_bytes=*/8,
+                       /*latency_us=*/1000);
+  EXPECT_EQ(sizer.BatchSize(/*num_concurrent_requests=*/1), 1);
+}
+
+TEST(ElementBatchSizerTest, CoversConsumptionDuringRequests) {
+  ElementBatchSizer sizer;
+  Consume(sizer, /*n=*/10, /*period_us=*/10);
+  sizer.RecordResponse(/*num_elements=*/1, /*num_bytes=*/8,
+                       /*latency_us=*/200);
+  EXPECT_EQ(sizer.BatchSize(/*num_concurrent_requests=*/1), 20);
+  EXPECT_EQ(sizer.BatchSize(/*num_concurrent_requests=*/4), 5);
+}
+
+TEST(ElementBatchSizerTest, SlowConsumer) {
+  ElementBatchSizer sizer;
+  Consume(sizer, /*n=*/10, /*period_us=*/10000);
+  sizer.RecordResponse(/*num_elements=*/1, /*num_bytes=*/8,
+                       /*latency_us=*/200);
+  EXPECT_EQ(sizer.BatchSize(/*num_concurrent_requests=*/1), 1);
+}
+
+TEST(ElementBatchSizerTest, BoundedByBytes) {
+  ElementBatchSizer sizer(/*max_batch_size=*/64, /*target_batch_bytes=*/1000);
+  Consume(sizer, /*n=*/10, /*period_us=*/1);
+  sizer.RecordResponse(/*num_elements=*/10, /*num_bytes=*/1000,
+                       /*latency_us=*/1000);
+  EXPECT_EQ(sizer.BatchSize(/*num_concurrent_requests=*/1), 10);
+}
+
+TEST(ElementBatchSizerTest, BoundedByMaxBatchSize) {
+  ElementBatchSizer sizer(/*max_batch_size=*/16);
+  Consume(sizer, /*n=*/10, /*period_us=*/1);
+  sizer.RecordResponse(/*num_elements=*/1, /*num_bytes=*/8,
+                       /*latency_us=*/1000000);
+  EXPECT_EQ(sizer.BatchSize(/*num_concurrent_requests=*/1), 16);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
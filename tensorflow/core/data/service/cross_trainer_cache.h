@@ -15,16 +15,21 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <deque>
 #include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/data/service/cross_trainer_cache_disk_tier.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -46,6 +51,11 @@ namespace data {
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
 //
+// With a disk tier, elements evicted from memory are spilled to local disk,
+// and trainers which fall behind the memory tier read them from there. The
+// memory tier is then sized from the gap between the slowest and the fastest
+// trainers, up to `max_cache_size_bytes`.
+//
 // The `CrossTrainerCache` class is thread-safe.
 //
 // Example usage:
@@ -78,7 +88,8 @@ namespace data {
 // To use the cache, the user needs to define a `CachableSequence` to generate
 // an infinite sequence of data. It should implement a `GetNext` method to
 // produce elements, and a `GetElementSizeBytes` method to estimate the element
-// size in bytes.
+// size in bytes. To use a disk tier, it should also implement
+// `SerializeElement` and `DeserializeElement`.
 template <class ElementType>
 class CachableSequence {
  public:
@@ -89,6 +100,18 @@ class CachableSequence {
 
   // Returns the estimated size of the element in bytes.
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
+
+  // Serializes an element evicted from memory to spill it to disk.
+  virtual StatusOr<std::string> SerializeElement(const ElementType&) const {
+    return errors::Unimplemented(
+        "This cachable sequence does not support spilling elements to disk.");
+  }
+
+  // Parses an element serialized by `SerializeElement`.
+  virtual StatusOr<ElementType> DeserializeElement(absl::string_view) const {
+    return errors::Unimplemented(
+        "This cachable sequence does not support spilling elements to disk.");
+  }
 };
 
 // Sliding-window cache shared across concurrent trainers.
@@ -98,9 +121,11 @@ class CrossTrainerCache {
   // Creates a `CrossTrainerCache` with `max_cache_size_bytes` of memory budget.
   // The cache should be able to hold at least one element, i.e.:
   // REQUIRES: `max_cache_size_bytes >= max(GetElementSizeBytes(*))`
+  // If `disk_tier` is set, elements evicted from memory are spilled to it.
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
-      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      std::unique_ptr<CrossTrainerCacheDiskTier> disk_tier = nullptr);
   virtual ~CrossTrainerCache() = default;
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
@@ -124,11 +149,27 @@ class CrossTrainerCache {
   struct CacheQueryResult {
     std::shared_ptr<const ElementType> element;
     bool cache_hit;
+    // True if the element was read from the disk tier.
+    bool from_disk = false;
+    // The number of elements the trainer skipped because they were evicted
+    // before it read them.
+    size_t num_evicted_elements = 0;
   };
 
   // Returns the next element and metrics about this query.
   StatusOr<CacheQueryResult> GetCacheQueryResult(const std::string& trainer_id);
 
+  // Moves `trainer_id` to the first element still cached, in memory or on
+  // disk, if it is behind it. Returns the number of elements it skipped.
+  size_t SkipEvictedElements(const std::string& trainer_id);
+
+  // Returns the index of the first element still cached, in memory or on disk.
+  size_t FirstCachedElementIndex() const;
+
+  // Reads and parses the element at `index` from the disk tier.
+  StatusOr<std::shared_ptr<const ElementType>> ReadSpilledElement(
+      size_t index);
+
   // Returns true if element is ready for `trainer_id`. An element is ready if
   // other trainers have read the data and the data remains in the cache. If the
   // data is not ready, one of the trainers need to extend the cache.
@@ -145,12 +186,26 @@ class CrossTrainerCache {
   // Reads a new element and writes it into the cache.
   Status ExtendCache();
 
-  // Frees old elements to keep the cache size below `max_cache_size_bytes_`.
+  // Sizes the memory tier from the gap between the slowest and the fastest
+  // trainers, if the cache has a disk tier.
+  void UpdateMemoryLimit(size_t new_element_size_bytes);
+
+  // Returns the number of old elements to free to fit a new element of
+  // `new_element_size_bytes` in `memory_limit_bytes_`.
+  size_t NumElementsToFree(size_t new_element_size_bytes) const;
+
+  // Frees old elements to keep the cache size below `memory_limit_bytes_`.
   // `new_element_size_bytes` is the size of the new element being inserted.
   void FreeSpace(size_t new_element_size_bytes);
 
+  // Writes `elements`, starting at `start_index`, to the disk tier.
+  void SpillElements(
+      size_t start_index,
+      const std::vector<std::shared_ptr<const ElementType>>& elements);
+
   // Records the cache hit rate and cache size.
-  void RecordMetrics(const CacheQueryResult& result);
+  void RecordMetrics(const std::string& trainer_id,
+                     const CacheQueryResult& result);
 
   // Maximum cache size in bytes.
   const size_t max_cache_size_bytes_;
@@ -158,6 +213,9 @@ class CrossTrainerCache {
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
 
+  // If set, elements evicted from memory are spilled to disk.
+  const std::unique_ptr<CrossTrainerCacheDiskTier> disk_tier_;
+
   mutable mutex mu_;
   mutable condition_variable cv_;
 
@@ -169,6 +227,9 @@ class CrossTrainerCache {
   std::deque<std::shared_ptr<const ElementType>> cache_ TF_GUARDED_BY(mu_);
   size_t cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
   size_t cache_start_index_ TF_GUARDED_BY(mu_) = 0;
+  // The memory budget of `cache_`. It is `max_cache_size_bytes_` unless the
+  // cache has a disk tier.
+  size_t memory_limit_bytes_ TF_GUARDED_BY(mu_);
 
   // True if one thread is extending the cache.
   bool extending_cache_ TF_GUARDED_BY(mu_) = false;
@@ -183,13 +244,17 @@ class CrossTrainerCache {
 template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
-    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    std::unique_ptr<CrossTrainerCacheDiskTier> disk_tier)
     : max_cache_size_bytes_(max_cache_size_bytes),
-      cachable_sequence_(std::move(cachable_sequence)) {
+      cachable_sequence_(std::move(cachable_sequence)),
+      disk_tier_(std::move(disk_tier)),
+      memory_limit_bytes_(max_cache_size_bytes) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
   VLOG(2) << "Initialized tf.data service cross-trainer cache with "
-          << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
+          << ByteSize::Bytes(max_cache_size_bytes) << " of memory"
+          << (disk_tier_ != nullptr ? " and a disk tier." : ".");
 }
 
 template <class ElementType>
@@ -202,7 +267,7 @@ CrossTrainerCache<ElementType>::Get(const std::string& trainer_id)
   }
 
   TF_ASSIGN_OR_RETURN(CacheQueryResult result, GetCacheQueryResult(trainer_id));
-  RecordMetrics(result);
+  RecordMetrics(trainer_id, result);
   return result.element;
 }
 
@@ -211,21 +276,27 @@ StatusOr<typename CrossTrainerCache<ElementType>::CacheQueryResult>
 CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
+  size_t num_evicted_elements = 0;
   while (true) {
+    std::optional<size_t> spilled_element_index;
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
-      if (IsElementReady(trainer_id)) {
+      num_evicted_elements += SkipEvictedElements(trainer_id);
+      size_t& element_index = trainer_to_element_index_map_[trainer_id];
+      if (element_index < cache_start_index_) {
+        // The element is in the disk tier. It is read without holding `mu_`.
+        spilled_element_index = element_index++;
+      } else if (IsElementReady(trainer_id)) {
         TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
                             GetElement(trainer_id));
         return CacheQueryResult{element,
-                                /*is_cache_hit=*/!should_extend_cache};
-      }
-
-      // Extends the cache or waits for another thread to extend the cache. When
-      // concurrent trainers wait for the next element, only one of them should
-      // extend the cache.
-      if (extending_cache_) {
+                                /*is_cache_hit=*/!should_extend_cache,
+                                /*from_disk=*/false, num_evicted_elements};
+      } else if (extending_cache_) {
+        // Extends the cache or waits for another thread to extend the cache.
+        // When concurrent trainers wait for the next element, only one of them
+        // should extend the cache.
         should_extend_cache = false;
         cv_.wait(l);
       } else {
@@ -234,6 +305,19 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       }
     }
 
+    if (spilled_element_index.has_value()) {
+      StatusOr<std::shared_ptr<const ElementType>> element =
+          ReadSpilledElement(*spilled_element_index);
+      if (errors::IsNotFound(element.status())) {
+        // The element has been deleted from disk since it was looked up.
+        ++num_evicted_elements;
+        continue;
+      }
+      TF_RETURN_IF_ERROR(element.status());
+      return CacheQueryResult{*std::move(element), /*is_cache_hit=*/true,
+                              /*from_disk=*/true, num_evicted_elements};
+    }
+
     if (should_extend_cache) {
       Status s = ExtendCache();
       mutex_lock l(mu_);
@@ -267,6 +351,45 @@ CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
   return result;
 }
 
+template <class ElementType>
+size_t CrossTrainerCache<ElementType>::SkipEvictedElements(
+    const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const size_t first_cached_element_index = FirstCachedElementIndex();
+  auto it = trainer_to_element_index_map_.find(trainer_id);
+  if (it == trainer_to_element_index_map_.end()) {
+    // New trainers start from the first cached element.
+    trainer_to_element_index_map_[trainer_id] = first_cached_element_index;
+    return 0;
+  }
+  if (it->second >= first_cached_element_index) {
+    return 0;
+  }
+  const size_t num_evicted_elements = first_cached_element_index - it->second;
+  it->second = first_cached_element_index;
+  return num_evicted_elements;
+}
+
+template <class ElementType>
+size_t CrossTrainerCache<ElementType>::FirstCachedElementIndex() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  // The disk tier is only used if it holds the elements right before the
+  // memory tier: it starts over after failing to spill an element.
+  if (disk_tier_ != nullptr && disk_tier_->EndIndex() == cache_start_index_) {
+    return disk_tier_->StartIndex();
+  }
+  return cache_start_index_;
+}
+
+template <class ElementType>
+StatusOr<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::ReadSpilledElement(size_t index)
+    TF_LOCKS_EXCLUDED(mu_) {
+  TF_ASSIGN_OR_RETURN(std::string serialized, disk_tier_->Read(index));
+  TF_ASSIGN_OR_RETURN(ElementType element,
+                      cachable_sequence_->DeserializeElement(serialized));
+  return std::make_shared<const ElementType>(std::move(element));
+}
+
 template <class ElementType>
 size_t CrossTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -289,6 +412,23 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
         " and cache size: ", max_cache_size_bytes_);
   }
 
+  std::vector<std::shared_ptr<const ElementType>> evicted_elements;
+  size_t evicted_elements_start_index = 0;
+  {
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(status_);
+    UpdateMemoryLimit(new_element_size_bytes);
+    if (disk_tier_ != nullptr) {
+      evicted_elements.assign(
+          cache_.begin(),
+          cache_.begin() + NumElementsToFree(new_element_size_bytes));
+      evicted_elements_start_index = cache_start_index_;
+    }
+  }
+  // Only the thread extending the cache frees elements, so trainers keep
+  // reading the evicted elements from memory while they are spilled.
+  SpillElements(evicted_elements_start_index, evicted_elements);
+
   mutex_lock l(mu_);
   TF_RETURN_IF_ERROR(status_);
   FreeSpace(new_element_size_bytes);
@@ -297,18 +437,55 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
   return absl::OkStatus();
 }
 
+template <class ElementType>
+void CrossTrainerCache<ElementType>::UpdateMemoryLimit(
+    size_t new_element_size_bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (disk_tier_ == nullptr) {
+    return;
+  }
+  const size_t end_index = cache_start_index_ + cache_.size();
+  size_t slowest_trainer_index = end_index;
+  for (const auto& [trainer_id, element_index] :
+       trainer_to_element_index_map_) {
+    slowest_trainer_index = std::min(
+        slowest_trainer_index, std::max(element_index, cache_start_index_));
+  }
+  const size_t average_element_size_bytes =
+      cache_.empty() ? new_element_size_bytes
+                     : cache_size_bytes_ / cache_.size();
+  const size_t trainer_gap_bytes =
+      (end_index - slowest_trainer_index) * average_element_size_bytes +
+      new_element_size_bytes;
+  memory_limit_bytes_ =
+      std::max(MemoryTierSizeBytes(trainer_gap_bytes, max_cache_size_bytes_),
+               new_element_size_bytes);
+}
+
+template <class ElementType>
+size_t CrossTrainerCache<ElementType>::NumElementsToFree(
+    size_t new_element_size_bytes) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  size_t num_elements = 0;
+  size_t cache_size_bytes = cache_size_bytes_;
+  while (num_elements < cache_.size() &&
+         cache_size_bytes + new_element_size_bytes > memory_limit_bytes_) {
+    cache_size_bytes -=
+        cachable_sequence_->GetElementSizeBytes(*cache_[num_elements]);
+    ++num_elements;
+  }
+  return num_elements;
+}
+
 template <class ElementType>
 void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  size_t num_elements_discarded = 0;
-  while (!cache_.empty() &&
-         cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
+  const size_t num_elements_discarded =
+      NumElementsToFree(new_element_size_bytes);
+  for (size_t i = 0; i < num_elements_discarded; ++i) {
     size_t free_bytes =
         cachable_sequence_->GetElementSizeBytes(*cache_.front());
     cache_.pop_front();
     cache_size_bytes_ -= free_bytes;
     ++cache_start_index_;
-    ++num_elements_discarded;
   }
 
   VLOG(3) << "Freed " << num_elements_discarded << " element(s) from "
@@ -316,6 +493,33 @@ void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
           << ByteSize::Bytes(cache_size_bytes_) << ".";
 }
 
+template <class ElementType>
+void CrossTrainerCache<ElementType>::SpillElements(
+    size_t start_index,
+    const std::vector<std::shared_ptr<const ElementType>>& elements)
+    TF_LOCKS_EXCLUDED(mu_) {
+  if (elements.empty()) {
+    return;
+  }
+  for (size_t i = 0; i < elements.size(); ++i) {
+    StatusOr<std::string> serialized =
+        cachable_sequence_->SerializeElement(*elements[i]);
+    Status status = serialized.status();
+    if (status.ok()) {
+      status = disk_tier_->Append(start_index + i, *serialized);
+    }
+    if (!status.ok()) {
+      // The disk tier starts over from the next element spilled.
+      LOG_EVERY_N_SEC(WARNING, 60)
+          << "Failed to spill tf.data service cross-trainer cache element "
+          << start_index + i << " to disk: " << status;
+      break;
+    }
+  }
+  metrics::RecordTFDataServiceCrossTrainerCacheDiskSizeBytes(
+      disk_tier_->Size().ToUnsignedBytes());
+}
+
 template <class ElementType>
 void CrossTrainerCache<ElementType>::Cancel(Status status)
     TF_LOCKS_EXCLUDED(mu_) {
@@ -338,14 +542,26 @@ bool CrossTrainerCache<ElementType>::IsCancelled() const
 
 template <class ElementType>
 void CrossTrainerCache<ElementType>::RecordMetrics(
-    const CacheQueryResult& result) {
+    const std::string& trainer_id, const CacheQueryResult& result) {
   metrics::RecordTFDataServiceCrossTrainerCacheQuery(result.cache_hit);
+  metrics::RecordTFDataServiceCrossTrainerCacheTrainerQuery(
+      trainer_id, !result.cache_hit ? "miss"
+                  : result.from_disk ? "disk_hit"
+                                     : "memory_hit");
+  if (result.num_evicted_elements > 0) {
+    metrics::RecordTFDataServiceCrossTrainerCacheEvictedElements(
+        trainer_id, result.num_evicted_elements);
+  }
   size_t cache_size_bytes = 0;
+  size_t memory_limit_bytes = 0;
   {
     mutex_lock l(mu_);
     cache_size_bytes = cache_size_bytes_;
+    memory_limit_bytes = memory_limit_bytes_;
   }
   metrics::RecordTFDataServiceCrossTrainerCacheSizeBytes(cache_size_bytes);
+  metrics::RecordTFDataServiceCrossTrainerCacheMemoryLimitBytes(
+      memory_limit_bytes);
 }
 
 }  // namespace data
@@ -0,0 +1,255 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/cross_trainer_cache_disk_tier.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// How much larger than the gap between trainers the memory tier is.
+constexpr double kMemoryTierHeadroom = 1.25;
+
+// The share of the cache size which the memory tier keeps even if trainers are
+// close to each other.
+constexpr double kMinMemoryTierFraction = 0.1;
+
+}  // namespace
+
+CrossTrainerCacheDiskTier::CrossTrainerCacheDiskTier(
+    Env* env, const std::string& directory, ByteSize max_size,
+    ByteSize segment_size)
+    : env_(env),
+      directory_(directory),
+      max_size_bytes_(max_size.ToUnsignedBytes()),
+      segment_size_bytes_(
+          std::max<size_t>(segment_size.ToUnsignedBytes(), size_t{1})) {}
+
+CrossTrainerCacheDiskTier::~CrossTrainerCacheDiskTier() {
+  mutex_lock l(mu_);
+  for (const std::shared_ptr<const Segment>& segment : segments_) {
+    DeleteSegmentFile(*segment);
+  }
+}
+
+absl::Status CrossTrainerCacheDiskTier::Initialize() {
+  return env_->RecursivelyCreateDir(directory_);
+}
+
+absl::Status CrossTrainerCacheDiskTier::Append(size_t index,
+                                               absl::string_view element) {
+  std::deque<std::shared_ptr<const Segment>> discarded_segments;
+  std::shared_ptr<const Segment> full_segment;
+  {
+    mutex_lock l(mu_);
+    if (index != end_index_) {
+      discarded_segments.swap(segments_);
+      active_segment_ = nullptr;
+      start_index_ = end_index_ = index;
+      size_bytes_ = 0;
+    }
+    if (active_segment_ == nullptr) {
+      active_segment_ = std::make_shared<Segment>();
+      active_segment_->start_index = index;
+    }
+    active_segment_->buffer.append(element.data(), element.size());
+    active_segment_->offsets.push_back(active_segment_->buffer.size());
+    ++end_index_;
+    size_bytes_ += element.size();
+    if (active_segment_->SizeBytes() >= segment_size_bytes_) {
+      segments_.push_back(active_segment_);
+      full_segment = active_segment_;
+      active_segment_ = nullptr;
+    }
+  }
+
+  for (const std::shared_ptr<const Segment>& segment : discarded_segments) {
+    DeleteSegmentFile(*segment);
+  }
+  if (full_segment != nullptr) {
+    TF_RETURN_IF_ERROR(WriteSegment(std::move(full_segment)));
+  }
+  DeleteOldSegments();
+  return absl::OkStatus();
+}
+
+absl::Status CrossTrainerCacheDiskTier::WriteSegment(
+    std::shared_ptr<const Segment> segment) {
+  auto written_segment = std::make_shared<Segment>();
+  written_segment->start_index = segment->start_index;
+  written_segment->offsets = segment->offsets;
+  written_segment->filename = tsl::io::JoinPath(
+      directory_, absl::StrCat("segment_", segment->start_index));
+
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(written_segment->filename, &file));
+  TF_RETURN_IF_ERROR(file->Append(segment->buffer));
+  TF_RETURN_IF_ERROR(file->Close());
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(written_segment->filename,
+                                               &written_segment->file));
+
+  mutex_lock l(mu_);
+  for (std::shared_ptr<const Segment>& stored_segment : segments_) {
+    if (stored_segment == segment) {
+      stored_segment = std::move(written_segment);
+      return absl::OkStatus();
+    }
+  }
+  // The segment was deleted while it was being written.
+  DeleteSegmentFile(*written_segment);
+  return absl::OkStatus();
+}
+
+void CrossTrainerCacheDiskTier::DeleteOldSegments() TF_LOCKS_EXCLUDED(mu_) {
+  std::vector<std::shared_ptr<const Segment>> deleted_segments;
+  {
+    mutex_lock l(mu_);
+    while (!segments_.empty() && size_bytes_ > max_size_bytes_) {
+      std::shared_ptr<const Segment> segment = std::move(segments_.front());
+      segments_.pop_front();
+      size_bytes_ -= segment->SizeBytes();
+      start_index_ = segment->start_index + segment->NumElements();
+      deleted_segments.push_back(std::move(segment));
+    }
+  }
+  for (const std::shared_ptr<const Segment>& segment : deleted_segments) {
+    DeleteSegmentFile(*segment);
+  }
+}
+
+void CrossTrainerCacheDiskTier::DeleteSegmentFile(
+    const Segment& segment) const {
+  if (segment.filename.empty()) {
+    return;
+  }
+  absl::Status status = env_->DeleteFile(segment.filename);
+  if (!status.ok() && !absl::IsNotFound(status)) {
+    LOG(WARNING) << "Failed to delete tf.data service cross-trainer cache "
+                 << "segment " << segment.filename << ": " << status;
+  }
+}
+
+std::shared_ptr<const CrossTrainerCacheDiskTier::Segment>
+CrossTrainerCacheDiskTier::FindSegment(size_t index) const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (index < start_index_ || index >= end_index_) {
+    return nullptr;
+  }
+  if (active_segment_ != nullptr && index >= active_segment_->start_index) {
+    return active_segment_;
+  }
+  auto it = std::upper_bound(
+      segments_.begin(), segments_.end(), index,
+      [](size_t index, const std::shared_ptr<const Segment>& segment) {
+        return index < segment->start_index;
+      });
+  if (it == segments_.begin()) {
+    return nullptr;
+  }
+  return *std::prev(it);
+}
+
+absl::StatusOr<std::string> CrossTrainerCacheDiskTier::Read(
+    size_t index) const {
+  std::shared_ptr<const Segment> segment;
+  {
+    mutex_lock l(mu_);
+    segment = FindSegment(index);
+    if (segment == nullptr) {
+      return errors::NotFound(
+          "Element ", index, " is not in the tf.data service cross-trainer ",
+          "cache disk tier, which holds elements ", start_index_, " to ",
+          end_index_, ".");
+    }
+    if (segment->file == nullptr) {
+      // The segment has not been written yet. The active segment may be
+      // appended to, so it is read while holding `mu_`.
+      const size_t i = index - segment->start_index;
+      return std::string(segment->buffer.data() + segment->offsets[i],
+                         segment->offsets[i + 1] - segment->offsets[i]);
+    }
+  }
+
+  const size_t i = index - segment->start_index;
+  const size_t offset = segment->offsets[i];
+  const size_t size = segment->offsets[i + 1] - offset;
+  std::string element(size, '\0');
+  absl::string_view data;
+  TF_RETURN_IF_ERROR(
+      segment->file->Read(offset, size, &data, element.data()));
+  if (data.size() != size) {
+    return errors::DataLoss("Expected ", size, " bytes for element ", index,
+                            " in ", segment->filename, ", got ", data.size(),
+                            ".");
+  }
+  if (data.data() != element.data()) {
+    std::memcpy(element.data(), data.data(), size);
+  }
+  return element;
+}
+
+bool CrossTrainerCacheDiskTier::Contains(size_t index) const {
+  mutex_lock l(mu_);
+  return index >= start_index_ && index < end_index_;
+}
+
+size_t CrossTrainerCacheDiskTier::StartIndex() const {
+  mutex_lock l(mu_);
+  return start_index_;
+}
+
+size_t CrossTrainerCacheDiskTier::EndIndex() const {
+  mutex_lock l(mu_);
+  return end_index_;
+}
+
+ByteSize CrossTrainerCacheDiskTier::Size() const {
+  mutex_lock l(mu_);
+  return ByteSize::Bytes(size_bytes_);
+}
+
+size_t MemoryTierSizeBytes(size_t trainer_gap_bytes,
+                           size_t max_cache_size_bytes) {
+  const size_t min_size_bytes =
+      static_cast<size_t>(max_cache_size_bytes * kMinMemoryTierFraction);
+  const double size_bytes = trainer_gap_bytes * kMemoryTierHeadroom;
+  if (size_bytes >= max_cache_size_bytes) {
+    return max_cache_size_bytes;
+  }
+  return std::max(static_cast<size_t>(size_bytes), min_size_bytes);
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,144 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_DISK_TIER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_DISK_TIER_H_
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Second tier of a `CrossTrainerCache`, holding the serialized elements evicted
+// from memory on local disk, so trainers which fall behind the memory tier
+// read them instead of skipping them.
+//
+// Elements have consecutive indices. They are buffered into segments, and
+// each segment is written to its own file in one sequential write once it
+// reaches `segment_size`. When the disk tier grows over `max_size`, its oldest
+// segments are deleted.
+//
+// The `CrossTrainerCacheDiskTier` class is thread-safe. `Append` should only be
+// called from one thread at a time.
+class CrossTrainerCacheDiskTier {
+ public:
+  static constexpr ByteSize kDefaultSegmentSize = ByteSize::MB(64);
+
+  // Stores segments under `directory`, which should not be shared with other
+  // caches.
+  CrossTrainerCacheDiskTier(Env* env, const std::string& directory,
+                            ByteSize max_size,
+                            ByteSize segment_size = kDefaultSegmentSize);
+  // Deletes the segment files.
+  virtual ~CrossTrainerCacheDiskTier();
+  CrossTrainerCacheDiskTier(const CrossTrainerCacheDiskTier&) = delete;
+  CrossTrainerCacheDiskTier& operator=(const CrossTrainerCacheDiskTier&) =
+      delete;
+
+  // Creates `directory`.
+  absl::Status Initialize();
+
+  // Appends the serialized element at `index`. If `index` does not follow the
+  // last element, the stored elements are discarded and the disk tier starts
+  // over from `index`.
+  absl::Status Append(size_t index, absl::string_view element);
+
+  // Reads the serialized element at `index`. Returns NotFound if it is not
+  // stored, e.g. because its segment has been deleted.
+  absl::StatusOr<std::string> Read(size_t index) const;
+
+  // Returns true if the element at `index` is stored.
+  bool Contains(size_t index) const;
+
+  // Returns the index of the first stored element, or `EndIndex()` if no
+  // element is stored.
+  size_t StartIndex() const;
+
+  // Returns the index after the last stored element.
+  size_t EndIndex() const;
+
+  // Returns the size of the stored elements.
+  ByteSize Size() const;
+
+ private:
+  // A segment is immutable once it is full, which lets readers read its file
+  // without holding `mu_`.
+  struct Segment {
+    // The index of the first element of the segment.
+    size_t start_index = 0;
+    // `offsets[i]` is the offset of element `start_index + i` in the segment,
+    // and the last offset is the size of the segment.
+    std::vector<size_t> offsets = {0};
+    // The elements, until the segment is written to `file`.
+    std::string buffer;
+    std::string filename;
+    std::unique_ptr<RandomAccessFile> file;
+
+    size_t NumElements() const { return offsets.size() - 1; }
+    size_t SizeBytes() const { return offsets.back(); }
+  };
+
+  // Writes the full `segment` to a file, then replaces it in `segments_` with
+  // a segment reading from the file.
+  absl::Status WriteSegment(std::shared_ptr<const Segment> segment);
+
+  // Deletes the oldest full segments until the disk tier fits in `max_size_`.
+  void DeleteOldSegments() TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the segment holding element `index`, or nullptr.
+  std::shared_ptr<const Segment> FindSegment(size_t index) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  void DeleteSegmentFile(const Segment& segment) const;
+
+  Env* const env_;
+  const std::string directory_;
+  const size_t max_size_bytes_;
+  const size_t segment_size_bytes_;
+
+  mutable mutex mu_;
+  // The full segments, oldest first.
+  std::deque<std::shared_ptr<const Segment>> segments_ TF_GUARDED_BY(mu_);
+  // The segment being appended to.
+  std::shared_ptr<Segment> active_segment_ TF_GUARDED_BY(mu_);
+  size_t start_index_ TF_GUARDED_BY(mu_) = 0;
+  size_t end_index_ TF_GUARDED_BY(mu_) = 0;
+  size_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// Returns the memory budget of a `CrossTrainerCache` with a disk tier: enough
+// to hold the `trainer_gap_bytes` of elements between the slowest and the
+// fastest trainers, with some headroom so trainers that fall slightly behind
+// still read from memory, and no more than `max_cache_size_bytes`. Elements
+// older than that are only read by trainers which fell far behind, or which
+// join late, which can read them from disk.
+size_t MemoryTierSizeBytes(size_t trainer_gap_bytes,
+                           size_t max_cache_size_bytes);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_DISK_TIER_H_
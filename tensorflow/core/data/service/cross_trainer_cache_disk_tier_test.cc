@@ -0,0 +1,165 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/cross_trainer_cache_disk_tier.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::IsOkAndHolds;
+using ::tensorflow::testing::StatusIs;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+std::string TestDirectory(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+std::string Element(size_t index) { return absl::StrCat("element ", index); }
+
+TEST(CrossTrainerCacheDiskTierTest, ReadElements) {
+  CrossTrainerCacheDiskTier disk_tier(Env::Default(),
+                                      TestDirectory("read_elements"),
+                                      /*max_size=*/ByteSize::GB(1),
+                                      /*segment_size=*/ByteSize::Bytes(32));
+  TF_ASSERT_OK(disk_tier.Initialize());
+  for (size_t i = 0; i < 100; ++i) {
+    TF_ASSERT_OK(disk_tier.Append(i, Element(i)));
+  }
+  EXPECT_EQ(disk_tier.StartIndex(), 0);
+  EXPECT_EQ(disk_tier.EndIndex(), 100);
+  for (size_t i = 0; i < 100; ++i) {
+    EXPECT_TRUE(disk_tier.Contains(i));
+    EXPECT_THAT(disk_tier.Read(i), IsOkAndHolds(Element(i)));
+  }
+  EXPECT_FALSE(disk_tier.Contains(100));
+  EXPECT_THAT(disk_tier.Read(100), StatusIs(error::NOT_FOUND));
+}
+
+TEST(CrossTrainerCacheDiskTierTest, WritesFullSegments) {
+  const std::string directory = TestDirectory("writes_full_segments");
+  CrossTrainerCacheDiskTier disk_tier(Env::Default(), directory,
+                                      /*max_size=*/ByteSize::GB(1),
+                                      /*segment_size=*/ByteSize::Bytes(20));
+  TF_ASSERT_OK(disk_tier.Initialize());
+  // Each element has 9 bytes, so segments hold 3 elements.
+  for (size_t i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(disk_tier.Append(i, Element(i)));
+  }
+
+  std::vector<std::string> files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &files));
+  EXPECT_THAT(files, SizeIs(3));
+  EXPECT_EQ(disk_tier.Size(), ByteSize::Bytes(90));
+}
+
+TEST(CrossTrainerCacheDiskTierTest, DeletesOldSegments) {
+  CrossTrainerCacheDiskTier disk_tier(Env::Default(),
+                                      TestDirectory("deletes_old_segments"),
+                                      /*max_size=*/ByteSize::Bytes(50),
+                                      /*segment_size=*/ByteSize::Bytes(20));
+  TF_ASSERT_OK(disk_tier.Initialize());
+  for (size_t i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(disk_tier.Append(i, Element(i)));
+  }
+  EXPECT_LE(disk_tier.Size(), ByteSize::Bytes(50));
+  EXPECT_GT(disk_tier.StartIndex(), 0);
+  EXPECT_THAT(disk_tier.Read(0), StatusIs(error::NOT_FOUND));
+  for (size_t i = disk_tier.StartIndex(); i < 10; ++i) {
+    EXPECT_THAT(disk_tier.Read(i), IsOkAndHolds(Element(i)));
+  }
+}
+
+TEST(CrossTrainerCacheDiskTierTest, StartsOverAfterGap) {
+  CrossTrainerCacheDiskTier disk_tier(Env::Default(),
+                                      TestDirectory("starts_over_after_gap"),
+                                      /*max_size=*/ByteSize::GB(1),
+                                      /*segment_size=*/ByteSize::Bytes(20));
+  TF_ASSERT_OK(disk_tier.Initialize());
+  for (size_t i = 0; i < 5; ++i) {
+    TF_ASSERT_OK(disk_tier.Append(i, Element(i)));
+  }
+  TF_ASSERT_OK(disk_tier.Append(10, Element(10)));
+  EXPECT_EQ(disk_tier.StartIndex(), 10);
+  EXPECT_EQ(disk_tier.EndIndex(), 11);
+  EXPECT_THAT(disk_tier.Read(4), StatusIs(error::NOT_FOUND));
+  EXPECT_THAT(disk_tier.Read(10), IsOkAndHolds(Element(10)));
+}
+
+TEST(CrossTrainerCacheDiskTierTest, DeletesFilesOnDestruction) {
+  const std::string directory = TestDirectory("deletes_files");
+  {
+    CrossTrainerCacheDiskTier disk_tier(Env::Default(), directory,
+                                        /*max_size=*/ByteSize::GB(1),
+                                        /*segment_size=*/ByteSize::Bytes(1));
+    TF_ASSERT_OK(disk_tier.Initialize());
+    for (size_t i = 0; i < 10; ++i) {
+      TF_ASSERT_OK(disk_tier.Append(i, Element(i)));
+    }
+  }
+  std::vector<std::string> files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &files));
+  EXPECT_THAT(files, IsEmpty());
+}
+
+TEST(CrossTrainerCacheDiskTierTest, EmptyElements) {
+  CrossTrainerCacheDiskTier disk_tier(Env::Default(),
+                                      TestDirectory("empty_elements"),
+                                      /*max_size=*/ByteSize::GB(1),
+                                      /*segment_size=*/ByteSize::Bytes(1));
+  TF_ASSERT_OK(disk_tier.Initialize());
+  TF_ASSERT_OK(disk_tier.Append(0, ""));
+  TF_ASSERT_OK(disk_tier.Append(1, "a"));
+  EXPECT_THAT(disk_tier.Read(0), IsOkAndHolds(""));
+  EXPECT_THAT(disk_tier.Read(1), IsOkAndHolds("a"));
+}
+
+TEST(MemoryTierSizeBytesTest, FollowsTrainerGap) {
+  EXPECT_EQ(MemoryTierSizeBytes(/*trainer_gap_bytes=*/400,
+                                /*max_cache_size_bytes=*/1000),
+            500);
+}
+
+TEST(MemoryTierSizeBytesTest, AtMostMaxCacheSize) {
+  EXPECT_EQ(MemoryTierSizeBytes(/*trainer_gap_bytes=*/900,
+                                /*max_cache_size_bytes=*/1000),
+            1000);
+  EXPECT_EQ(MemoryTierSizeBytes(/*trainer_gap_bytes=*/5000,
+                                /*max_cache_size_bytes=*/1000),
+            1000);
+}
+
+TEST(MemoryTierSizeBytesTest, AtLeastMinimumSize) {
+  EXPECT_EQ(MemoryTierSizeBytes(/*trainer_gap_bytes=*/0,
+                                /*max_cache_size_bytes=*/1000),
+            100);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -22,14 +22,19 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/data/service/cross_trainer_cache_disk_tier.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
@@ -61,6 +66,32 @@ class InfiniteRange : public CachableSequence<int64_t> {
   int64_t next_ = 0;
 };
 
+// An `InfiniteRange` whose elements can be spilled to disk.
+class SpillableRange : public InfiniteRange {
+ public:
+  absl::StatusOr<std::string> SerializeElement(
+      const int64_t& element) const override {
+    return absl::StrCat(element);
+  }
+
+  absl::StatusOr<int64_t> DeserializeElement(
+      absl::string_view serialized) const override {
+    int64_t element = 0;
+    if (!absl::SimpleAtoi(serialized, &element)) {
+      return errors::DataLoss("Failed to parse element ", serialized);
+    }
+    return element;
+  }
+};
+
+std::unique_ptr<CrossTrainerCacheDiskTier> DiskTier(const std::string& name) {
+  auto disk_tier = std::make_unique<CrossTrainerCacheDiskTier>(
+      Env::Default(), io::JoinPath(testing::TmpDir(), name),
+      /*max_size=*/ByteSize::GB(1), /*segment_size=*/ByteSize::Bytes(32));
+  TF_CHECK_OK(disk_tier->Initialize());
+  return disk_tier;
+}
+
 class TensorDataset : public CachableSequence<Tensor> {
  public:
   absl::StatusOr<Tensor> GetNext() override { return Tensor("Test Tensor"); }
@@ -235,6 +266,105 @@ TEST(CrossTrainerCacheTest, AlternateTrainerExtendsCache) {
   EXPECT_THAT(cache.Get("Trainer 3"), IsOkAndHolds(Pointee(Gt(5))));
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadFromDisk) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SpillableRange>(),
+      DiskTier("slow_trainers_read_from_disk"));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  for (int i = 1; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, NewTrainersReadFromDisk) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SpillableRange>(),
+      DiskTier("new_trainers_read_from_disk"));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Old trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("New trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, MemoryTierFollowsTrainerGap) {
+  CellReader<int64_t> size_reader(
+      "/tensorflow/data/service/cross_trainer_cache_size_bytes");
+  CellReader<int64_t> limit_reader(
+      "/tensorflow/data/service/cross_trainer_cache_memory_limit_bytes");
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/100 * sizeof(int64_t),
+      std::make_unique<SpillableRange>(),
+      DiskTier("memory_tier_follows_trainer_gap"));
+
+  // With one trainer, the memory tier keeps its minimum size.
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Trainer 1"), IsOkAndHolds(Pointee(i)));
+    EXPECT_LE(size_reader.Read(), 10 * sizeof(int64_t));
+  }
+  EXPECT_EQ(limit_reader.Read(), 10 * sizeof(int64_t));
+
+  // A trainer falling behind grows the memory tier to the gap.
+  EXPECT_THAT(cache.Get("Trainer 2"), IsOkAndHolds(Pointee(0)));
+  for (int i = 100; i < 300; ++i) {
+    EXPECT_THAT(cache.Get("Trainer 1"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_EQ(limit_reader.Read(), 100 * sizeof(int64_t));
+  EXPECT_EQ(size_reader.Read(), 100 * sizeof(int64_t));
+}
+
+TEST(CrossTrainerCacheTest, TrainerQueryMetrics) {
+  CellReader<int64_t> cell_reader(
+      "/tensorflow/data/service/cross_trainer_cache_trainer_queries");
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SpillableRange>(),
+      DiskTier("trainer_query_metrics"));
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_THAT(cache.Get("Trainer 1"), IsOkAndHolds(Pointee(i)));
+  }
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_THAT(cache.Get("Trainer 2"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_EQ(cell_reader.Delta("Trainer 1", "miss"), 10);
+  EXPECT_EQ(cell_reader.Delta("Trainer 1", "memory_hit"), 0);
+  EXPECT_EQ(cell_reader.Delta("Trainer 1", "disk_hit"), 0);
+  EXPECT_EQ(cell_reader.Delta("Trainer 2", "miss"), 0);
+  EXPECT_EQ(cell_reader.Delta("Trainer 2", "memory_hit") +
+                cell_reader.Delta("Trainer 2", "disk_hit"),
+            10);
+  EXPECT_GT(cell_reader.Read("Trainer 2", "disk_hit"), 0);
+}
+
+TEST(CrossTrainerCacheTest, EvictedElementsMetrics) {
+  CellReader<int64_t> cell_reader(
+      "/tensorflow/data/service/cross_trainer_cache_evicted_elements");
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>());
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // When 19 is cached, 1 to 14 must have been discarded.
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(15)));
+  EXPECT_EQ(cell_reader.Delta("Slow trainer"), 14);
+  EXPECT_EQ(cell_reader.Delta("Fast trainer"), 0);
+
+  // New trainers don't count the elements before they started as evicted.
+  EXPECT_THAT(cache.Get("New trainer"), IsOkAndHolds(Pointee(15)));
+  EXPECT_EQ(cell_reader.Delta("New trainer"), 0);
+}
+
 TEST(CrossTrainerCacheTest, CacheHitMetrics) {
   CellReader<int64_t> cell_reader(
       "/tensorflow/data/service/cross_trainer_cache_queries");
@@ -81,6 +81,14 @@ class DataTransferClient {
   virtual Status GetElement(const GetElementRequest& req,
                             GetElementResult& result) = 0;
 
+  // Fetches the next element, and up to `req.max_elements()` - 1 further
+  // elements if they are ready, appending them to `results`. Clients which
+  // can't fetch several elements at once return a single one.
+  virtual Status GetElements(const GetElementRequest& req,
+                             std::vector<GetElementResult>& results) {
+    return GetElement(req, results.emplace_back());
+  }
+
   // Makes a best effort to cancel all outstanding calls in progress for the
   // client, and causes further calls to return Cancelled status.
   virtual void TryCancel() = 0;
@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "grpcpp/client_context.h"
@@ -127,13 +128,15 @@ Status DataServiceDispatcherClient::GetDatasetDef(const std::string& dataset_id,
   return absl::OkStatus();
 }
 
-Status DataServiceDispatcherClient::GetSplit(int64_t iteration_id,
+Status DataServiceDispatcherClient::GetSplit(const std::string& worker_address,
+                                             int64_t iteration_id,
                                              int64_t repetition,
                                              int64_t split_provider_index,
                                              Tensor& split,
                                              bool& end_of_splits) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   GetSplitRequest req;
+  req.set_worker_address(worker_address);
   req.set_iteration_id(iteration_id);
   req.set_repetition(repetition);
   req.set_split_provider_index(split_provider_index);
@@ -152,6 +155,35 @@ Status DataServiceDispatcherClient::GetSplit(int64_t iteration_id,
   return absl::OkStatus();
 }
 
+Status DataServiceDispatcherClient::GetSplits(
+    const std::string& worker_address, int64_t iteration_id,
+    int64_t repetition, int64_t split_provider_index, int64_t max_num_splits,
+    std::vector<Tensor>& splits, bool& end_of_splits) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  GetSplitRequest req;
+  req.set_worker_address(worker_address);
+  req.set_iteration_id(iteration_id);
+  req.set_repetition(repetition);
+  req.set_split_provider_index(split_provider_index);
+  req.set_max_num_splits(max_num_splits);
+  GetSplitResponse resp;
+  grpc::ClientContext client_ctx;
+  grpc::Status status = stub_->GetSplit(&client_ctx, req, &resp);
+  if (!status.ok()) {
+    return grpc_util::WrapError("Failed to get splits", status);
+  }
+  splits.reserve(splits.size() + resp.splits_size());
+  for (const TensorProto& split_proto : resp.splits()) {
+    Tensor split;
+    if (!split.FromProto(split_proto)) {
+      return errors::Internal("Failed to parse split tensor proto");
+    }
+    splits.push_back(std::move(split));
+  }
+  end_of_splits = resp.end_of_splits();
+  return absl::OkStatus();
+}
+
 Status DataServiceDispatcherClient::Snapshot(
     const DatasetDef& dataset, const std::string& path,
     const experimental::DistributedSnapshotMetadata& metadata) {
@@ -380,6 +412,37 @@ Status DataServiceDispatcherClient::DisableCompressionAtRuntime(
   return absl::OkStatus();
 }
 
+Status DataServiceDispatcherClient::GetScalingRecommendation(
+    int64_t min_recommendation_id, int64_t timeout_ms,
+    GetScalingRecommendationResponse& response) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  grpc::ClientContext ctx;
+  GetScalingRecommendationRequest request;
+  request.set_min_recommendation_id(min_recommendation_id);
+  request.set_timeout_ms(timeout_ms);
+  grpc::Status s = stub_->GetScalingRecommendation(&ctx, request, &response);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to get scaling recommendation", s);
+  }
+  return absl::OkStatus();
+}
+
+Status DataServiceDispatcherClient::DrainWorker(
+    const std::string& worker_address, bool& drained) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  grpc::ClientContext ctx;
+  DrainWorkerRequest request;
+  request.set_worker_address(worker_address);
+  DrainWorkerResponse response;
+  grpc::Status s = stub_->DrainWorker(&ctx, request, &response);
+  if (!s.ok()) {
+    return grpc_util::WrapError(
+        absl::StrCat("Failed to drain worker ", worker_address), s);
+  }
+  drained = response.drained();
+  return absl::OkStatus();
+}
+
 Status DataServiceDispatcherClient::EnsureInitialized() {
   return grpc_util::Retry([this] { return Initialize(); },
                           "Initialize dispatcher client",
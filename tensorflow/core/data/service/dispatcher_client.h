@@ -61,11 +61,19 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   // definition in `dataset_def`.
   Status GetDatasetDef(const std::string& dataset_id, DatasetDef& dataset_def);
 
-  // Gets the next split for the specified iteration id, repetition, and split
-  // provider index.
-  Status GetSplit(int64_t iteration_id, int64_t repetition,
-                  int64_t split_provider_index, Tensor& split,
-                  bool& end_of_splits);
+  // Gets the next split for the worker with `worker_address` for the specified
+  // iteration id, repetition, and split provider index.
+  Status GetSplit(const std::string& worker_address, int64_t iteration_id,
+                  int64_t repetition, int64_t split_provider_index,
+                  Tensor& split, bool& end_of_splits);
+
+  // Leases up to `max_num_splits` splits to the worker with `worker_address`,
+  // and releases the splits of its previous lease. If `end_of_splits` returns
+  // true, the split provider reaches its end after `splits`.
+  Status GetSplits(const std::string& worker_address, int64_t iteration_id,
+                   int64_t repetition, int64_t split_provider_index,
+                   int64_t max_num_splits, std::vector<Tensor>& splits,
+                   bool& end_of_splits);
 
   // Gets the next split for the specified source of a stream of the snapshot in
   // `base_path`. If `end_of_splits` returns true, then there are no more splits
@@ -137,6 +145,17 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
       const std::string& dataset_id, bool disable_compression_at_runtime,
       DisableCompressionAtRuntimeResponse& response);
 
+  // Gets the latest scaling recommendation. If it is older than
+  // `min_recommendation_id`, waits up to `timeout_ms` milliseconds for a newer
+  // one.
+  Status GetScalingRecommendation(int64_t min_recommendation_id,
+                                  int64_t timeout_ms,
+                                  GetScalingRecommendationResponse& response);
+
+  // Drains the worker with `worker_address`. `drained` returns whether the
+  // worker can be removed without losing splits.
+  Status DrainWorker(const std::string& worker_address, bool& drained);
+
  protected:
   Status EnsureInitialized() override;
 
@@ -388,6 +388,68 @@ TEST_F(DispatcherClientTest, NamedJobsDoNotMatch) {
                      HasSubstr("Existing cross-trainer cache: <disabled>"))));
 }
 
+TEST_F(DispatcherClientTest, GetScalingRecommendation) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/2));
+  GetScalingRecommendationResponse recommendation;
+  TF_ASSERT_OK(dispatcher_client_->GetScalingRecommendation(
+      /*min_recommendation_id=*/0, /*timeout_ms=*/0, recommendation));
+  // Without processing times, there is no estimate.
+  EXPECT_EQ(recommendation.current_number_of_workers(), 2);
+  EXPECT_EQ(recommendation.optimal_number_of_workers(), 0);
+  EXPECT_EQ(recommendation.recommended_number_of_workers(), 2);
+  EXPECT_TRUE(recommendation.workers_to_drain().empty());
+
+  bool drained = false;
+  TF_ASSERT_OK(dispatcher_client_->DrainWorker(test_cluster_->WorkerAddress(0),
+                                               drained));
+  const int64_t recommendation_id = recommendation.recommendation_id();
+  TF_ASSERT_OK(dispatcher_client_->GetScalingRecommendation(
+      recommendation_id + 1, /*timeout_ms=*/60000, recommendation));
+  EXPECT_GT(recommendation.recommendation_id(), recommendation_id);
+  EXPECT_EQ(recommendation.current_number_of_workers(), 1);
+  EXPECT_EQ(recommendation.recommended_number_of_workers(), 1);
+}
+
+TEST_F(DispatcherClientTest, DrainedWorkersGetNoNewTasks) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/2));
+  bool drained = false;
+  TF_ASSERT_OK(dispatcher_client_->DrainWorker(test_cluster_->WorkerAddress(0),
+                                               drained));
+  EXPECT_TRUE(drained);
+
+  DataServiceMetadata metadata = GetDefaultMetadata();
+  metadata.set_cardinality(kInfiniteCardinality);
+  TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id,
+                          RegisterDataset(InfiniteDataset(), metadata));
+  ProcessingModeDef processing_mode;
+  processing_mode.set_sharding_policy(ProcessingModeDef::DYNAMIC);
+  int64_t job_id;
+  TF_ASSERT_OK(dispatcher_client_->GetOrCreateJob(
+      dataset_id, processing_mode, /*job_name=*/std::nullopt,
+      /*num_consumers=*/std::nullopt,
+      /*use_cross_trainer_cache=*/false, TARGET_WORKERS_AUTO, job_id));
+  int64_t iteration_client_id;
+  TF_ASSERT_OK(dispatcher_client_->GetOrCreateIteration(
+      job_id, /*repetition=*/0, iteration_client_id));
+
+  for (int64_t i = 0; i < 2; ++i) {
+    WorkerHeartbeatRequest worker_heartbeat_request;
+    worker_heartbeat_request.set_worker_address(
+        test_cluster_->WorkerAddress(i));
+    TF_ASSERT_OK_AND_ASSIGN(
+        WorkerHeartbeatResponse worker_heartbeat_response,
+        dispatcher_client_->WorkerHeartbeat(worker_heartbeat_request));
+    EXPECT_EQ(worker_heartbeat_response.new_tasks_size(), i == 0 ? 0 : 1);
+  }
+}
+
+TEST_F(DispatcherClientTest, DrainUnknownWorker) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/1));
+  bool drained = false;
+  EXPECT_THAT(dispatcher_client_->DrainWorker("unknown:1234", drained),
+              StatusIs(error::NOT_FOUND));
+}
+
 class DispatcherClientTest_DatasetId
     : public DispatcherClientTest,
       public ::testing::WithParamInterface<std::optional<std::string>> {};
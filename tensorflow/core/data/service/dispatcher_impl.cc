@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
@@ -50,6 +51,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/service/journal.h"
 #include "tensorflow/core/data/service/journal.pb.h"
+#include "tensorflow/core/data/service/scaling_recommender.h"
 #include "tensorflow/core/data/service/snapshot/file_utils.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/snapshot/snapshot_manager.h"
@@ -57,6 +59,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/utils.h"
 #include "tensorflow/core/data/service/validate_utils.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
+#include "tensorflow/core/data/service/worker_locality.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/data/utils.h"
@@ -104,6 +107,9 @@ constexpr absl::Duration kDefaultIterationGcCheckInterval = absl::Minutes(10);
 constexpr absl::Duration kDefaultIterationGcTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultClientTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultWorkerTimeout = absl::Minutes(10);
+constexpr absl::Duration kDefaultScaleDownDelay = absl::Minutes(10);
+constexpr int64_t kDefaultJournalSnapshotInterval = 100000;
+constexpr int64_t kDefaultSplitPrefetchBufferSize = 16;
 
 constexpr std::array<const char*, 8> kNodeNameSharingOps = {
     "HashTable",
@@ -132,6 +138,20 @@ std::string DatasetsDir(const std::string& work_dir) {
   return io::JoinPath(work_dir, kDatasetsDir);
 }
 
+// Returns the number of unfinished tasks in `tasks` which read splits from the
+// dispatcher.
+int64_t NumSplitReadingTasks(
+    const std::vector<std::shared_ptr<const Task>>& tasks) {
+  int64_t num_tasks = 0;
+  for (const auto& task : tasks) {
+    if (!task->finished && !task->iteration->finished &&
+        IsDynamicShard(task->iteration->job->processing_mode)) {
+      ++num_tasks;
+    }
+  }
+  return num_tasks;
+}
+
 Status CreateWorkerStub(const std::string& address, const std::string& protocol,
                         std::unique_ptr<WorkerService::Stub>& stub) {
   ::grpc::ChannelArguments args;
@@ -183,6 +203,16 @@ DispatcherConfig ApplyConfigDefaults(const DispatcherConfig& config) {
     new_config.set_worker_max_concurrent_snapshots(
         kDefaultWorkerMaxConcurrentSnapshots);
   }
+  if (new_config.scale_down_delay_ms() == 0) {
+    new_config.set_scale_down_delay_ms(
+        absl::ToInt64Milliseconds(kDefaultScaleDownDelay));
+  }
+  if (new_config.journal_snapshot_interval() == 0) {
+    new_config.set_journal_snapshot_interval(kDefaultJournalSnapshotInterval);
+  }
+  if (new_config.split_prefetch_buffer_size() == 0) {
+    new_config.set_split_prefetch_buffer_size(kDefaultSplitPrefetchBufferSize);
+  }
   return new_config;
 }
 }  // namespace
@@ -192,7 +222,8 @@ DataServiceDispatcherImpl::DataServiceDispatcherImpl(
     : config_(ApplyConfigDefaults(config)),
       env_(Env::Default()),
       snapshot_assignment_manager_(config_.worker_max_concurrent_snapshots()),
-      state_(config_) {
+      state_(config_),
+      scaling_recommender_(absl::Milliseconds(config_.scale_down_delay_ms())) {
   if (config_.work_dir().empty()) {
     dataset_store_ = std::make_unique<MemoryDatasetStore>();
   } else {
@@ -206,6 +237,7 @@ DataServiceDispatcherImpl::~DataServiceDispatcherImpl() {
     mutex_lock l(mu_);
     cancelled_ = true;
     maintenance_thread_cv_.notify_all();
+    scaling_recommendation_cv_.notify_all();
   }
   maintenance_thread_.reset();
 }
@@ -233,25 +265,7 @@ Status DataServiceDispatcherImpl::Start() {
   }
   journal_writer_ =
       std::make_unique<FileJournalWriter>(env_, JournalDir(config_.work_dir()));
-  LOG(INFO) << "Attempting to restore dispatcher state from journal in "
-            << JournalDir(config_.work_dir());
-  Update update;
-  bool end_of_journal = false;
-  FileJournalReader reader(env_, JournalDir(config_.work_dir()));
-  Status s = reader.Read(update, end_of_journal);
-  if (errors::IsNotFound(s)) {
-    LOG(INFO) << "No journal found. Starting dispatcher from new state.";
-  } else if (!s.ok()) {
-    return s;
-  } else {
-    int64_t start = env_->NowMicros();
-    while (!end_of_journal) {
-      TF_RETURN_IF_ERROR(ApplyWithoutJournaling(update));
-      TF_RETURN_IF_ERROR(reader.Read(update, end_of_journal));
-    }
-    absl::Duration duration = absl::Microseconds(env_->NowMicros() - start);
-    LOG(INFO) << "Restored from journal in " << duration << ".";
-  }
+  TF_RETURN_IF_ERROR(RestoreFromJournal());
   for (const auto& iteration : state_.ListIterations()) {
     if (IsDynamicShard(iteration->job->processing_mode)) {
       TF_RETURN_IF_ERROR(RestoreSplitProviders(
@@ -370,7 +384,8 @@ Status DataServiceDispatcherImpl::FindNewTasks(
   }
   for (const auto& iteration : state_.ListIterations()) {
     if (!assigned_iteration_ids.contains(iteration->iteration_id) &&
-        iteration->IsRoundRobin() && !iteration->finished) {
+        iteration->IsRoundRobin() && !iteration->finished &&
+        !state_.IsWorkerDraining(worker_address)) {
       VLOG(1) << "Creating pending task for reconnected worker "
               << worker_address;
       TF_RETURN_IF_ERROR(CreatePendingTask(iteration, worker_address));
@@ -428,6 +443,7 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
     const std::string& worker_address = request->worker_address();
     latest_worker_heartbeats_time_[worker_address] =
         absl::FromUnixMicros(env_->NowMicros());
+    worker_loads_[worker_address] = request->outstanding_requests();
     // Assigned tasks from the perspective of the dispatcher.
     std::vector<std::shared_ptr<const Task>> assigned_tasks;
     Status s = state_.TasksForWorker(worker_address, assigned_tasks);
@@ -456,6 +472,7 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
     // TODO(b/249286501): Skip this if the user does not enable auto-scaling.
     ReportProcessingTimesFromActiveTasks(active_tasks,
                                          request->worker_address());
+    UpdateScalingRecommendation();
     TF_RETURN_IF_ERROR(
         FindTasksToDelete(current_tasks, assigned_tasks, response));
     TF_RETURN_IF_ERROR(
@@ -526,6 +543,9 @@ Status DataServiceDispatcherImpl::GetDatasetDef(
 Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
                                            GetSplitResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
+  if (request->max_num_splits() > 1) {
+    return LeaseSplits(*request, *response);
+  }
   int64_t iteration_id = request->iteration_id();
   int64_t repetition = request->repetition();
   int64_t provider_index = request->split_provider_index();
@@ -538,11 +558,13 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
   {
     mutex_lock l(mu_);
     std::shared_ptr<const Iteration> iteration;
-    TF_RETURN_IF_ERROR(state_.IterationFromId(iteration_id, iteration));
-    if (!iteration->distributed_epoch_state.has_value()) {
-      return errors::FailedPrecondition(
-          "Cannot get split for iteration ", iteration_id,
-          ", since it is not a distributed_epoch iteration.");
+    TF_RETURN_IF_ERROR(
+        DistributedEpochIterationFromId(iteration_id, iteration));
+    if (state_.IsWorkerDraining(request->worker_address())) {
+      response->set_end_of_splits(true);
+      VLOG(3) << "Returning end_of_splits since worker "
+              << request->worker_address() << " is being drained";
+      return absl::OkStatus();
     }
     current_repetition =
         iteration->distributed_epoch_state.value().repetitions[provider_index];
@@ -579,6 +601,144 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
   return absl::OkStatus();
 }
 
+Status DataServiceDispatcherImpl::DistributedEpochIterationFromId(
+    int64_t iteration_id, std::shared_ptr<const Iteration>& iteration)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  TF_RETURN_IF_ERROR(state_.IterationFromId(iteration_id, iteration));
+  if (!iteration->distributed_epoch_state.has_value()) {
+    return errors::FailedPrecondition(
+        "Cannot get split for iteration ", iteration_id,
+        ", since it is not a distributed_epoch iteration.");
+  }
+  return absl::OkStatus();
+}
+
+Status DataServiceDispatcherImpl::LeaseSplits(const GetSplitRequest& request,
+                                              GetSplitResponse& response)
+    TF_LOCKS_EXCLUDED(mu_) {
+  const int64_t iteration_id = request.iteration_id();
+  const int64_t repetition = request.repetition();
+  const int64_t provider_index = request.split_provider_index();
+  const int64_t max_num_splits = request.max_num_splits();
+  const std::string& worker_address = request.worker_address();
+  VLOG(3) << "Received GetSplit request for up to " << max_num_splits
+          << " splits from worker " << worker_address << " for iteration "
+          << iteration_id << ", repetition " << repetition
+          << ", split provider index " << provider_index;
+  mutex_lock l(get_split_mu_);
+  std::vector<Tensor> splits;
+  int64_t current_repetition = 0;
+  SplitProvider* split_provider = nullptr;
+  {
+    mutex_lock l(mu_);
+    std::shared_ptr<const Iteration> iteration;
+    TF_RETURN_IF_ERROR(
+        DistributedEpochIterationFromId(iteration_id, iteration));
+    SplitLeases& split_leases = split_leases_[iteration_id][provider_index];
+    // Workers only request more splits once they have read their lease.
+    split_leases.leases.erase(worker_address);
+    if (state_.IsWorkerDraining(worker_address)) {
+      response.set_end_of_splits(true);
+      VLOG(3) << "Returning end_of_splits since worker " << worker_address
+              << " is being drained";
+      return absl::OkStatus();
+    }
+
+    ReclaimExpiredSplitLeases(split_leases);
+    std::deque<std::pair<int64_t, Tensor>>& reclaimed_splits =
+        split_leases.reclaimed_splits;
+    for (auto it = reclaimed_splits.begin();
+         it != reclaimed_splits.end() && splits.size() < max_num_splits;) {
+      if (it->first > repetition) {
+        ++it;
+        continue;
+      }
+      if (it->first == repetition) {
+        splits.push_back(std::move(it->second));
+      }
+      it = reclaimed_splits.erase(it);
+    }
+    if (!splits.empty()) {
+      VLOG(3) << "Leasing " << splits.size() << " reclaimed splits to worker "
+              << worker_address;
+      split_leases.leases[worker_address] = SplitLease{
+          repetition, splits, absl::FromUnixMicros(env_->NowMicros())};
+      for (const Tensor& split : splits) {
+        split.AsProtoTensorContent(response.add_splits());
+      }
+      return absl::OkStatus();
+    }
+
+    current_repetition =
+        iteration->distributed_epoch_state.value().repetitions[provider_index];
+    if (repetition < current_repetition) {
+      response.set_end_of_splits(true);
+      VLOG(3) << "Returning end_of_splits since current repetition "
+              << current_repetition
+              << " is greater than the requested repetition " << repetition;
+      return absl::OkStatus();
+    }
+    split_provider = split_providers_[iteration_id][provider_index].get();
+  }
+  if (repetition > current_repetition) {
+    TF_RETURN_IF_ERROR(split_provider->Reset());
+  }
+  bool end_of_splits = false;
+  while (splits.size() < max_num_splits) {
+    Tensor split;
+    TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
+    if (end_of_splits) {
+      break;
+    }
+    splits.push_back(std::move(split));
+  }
+  if (!splits.empty()) {
+    TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
+                                           provider_index, /*finished=*/false,
+                                           /*num_splits=*/splits.size()));
+  }
+  if (end_of_splits) {
+    TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
+                                           provider_index, /*finished=*/true));
+    TF_RETURN_IF_ERROR(split_provider->Reset());
+  }
+  if (!splits.empty()) {
+    mutex_lock l(mu_);
+    split_leases_[iteration_id][provider_index].leases[worker_address] =
+        SplitLease{repetition, splits, absl::FromUnixMicros(env_->NowMicros())};
+  }
+  for (const Tensor& split : splits) {
+    split.AsProtoTensorContent(response.add_splits());
+  }
+  response.set_end_of_splits(end_of_splits);
+  VLOG(3) << "Returning from GetSplit, num_splits=" << splits.size()
+          << ", end_of_splits=" << end_of_splits;
+  return absl::OkStatus();
+}
+
+void DataServiceDispatcherImpl::ReclaimExpiredSplitLeases(
+    SplitLeases& split_leases) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const absl::Time now = absl::FromUnixMicros(env_->NowMicros());
+  for (auto it = split_leases.leases.begin();
+       it != split_leases.leases.end();) {
+    const auto& [worker_address, lease] = *it;
+    // Workers which haven't heartbeated yet, e.g. after a dispatcher restart,
+    // keep their leases for a worker timeout.
+    if (latest_worker_heartbeats_time_.contains(worker_address) ||
+        now < lease.lease_time +
+                  absl::Milliseconds(config_.worker_timeout_ms())) {
+      ++it;
+      continue;
+    }
+    LOG(INFO) << "Reclaiming " << lease.splits.size()
+              << " splits leased to lost worker " << worker_address;
+    for (const Tensor& split : lease.splits) {
+      split_leases.reclaimed_splits.emplace_back(lease.repetition, split);
+    }
+    split_leases.leases.erase(it++);
+  }
+}
+
 Status DataServiceDispatcherImpl::MakeSplitProviders(
     const std::string& dataset_id,
     std::vector<std::unique_ptr<SplitProvider>>& split_providers)
@@ -588,6 +748,12 @@ Status DataServiceDispatcherImpl::MakeSplitProviders(
   std::shared_ptr<const DatasetDef> dataset_def;
   TF_RETURN_IF_ERROR(GetDatasetDef(*dataset, dataset_def));
   TF_RETURN_IF_ERROR(CreateSplitProviders(*dataset_def, split_providers));
+  if (config_.split_prefetch_buffer_size() > 0) {
+    for (std::unique_ptr<SplitProvider>& split_provider : split_providers) {
+      split_provider = std::make_unique<PrefetchingSplitProvider>(
+          std::move(split_provider), config_.split_prefetch_buffer_size());
+    }
+  }
   return absl::OkStatus();
 }
 
@@ -939,6 +1105,9 @@ Status DataServiceDispatcherImpl::CreateTasksForIteration(
   tasks.clear();
   tasks.reserve(workers.size());
   for (const auto& worker : workers) {
+    if (state_.IsWorkerDraining(worker->address)) {
+      continue;
+    }
     std::shared_ptr<const Task> task;
     TF_RETURN_IF_ERROR(CreateTask(iteration, worker->address, task));
     tasks.push_back(task);
@@ -1156,6 +1325,14 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
     task_info->set_worker_uid(task->worker_uid);
     task_info->set_starting_round(task->starting_round);
   }
+  if (!iteration->job->num_consumers.has_value()) {
+    // Coordinated reads need the same task order on all consumers.
+    const std::vector<std::string> client_tags(request->client_tags().begin(),
+                                               request->client_tags().end());
+    OrderTasksByLocalityAndLoad(client_tags, worker_loads_,
+                                request->iteration_client_id(),
+                                *response->mutable_task_info());
+  }
   response->set_iteration_finished(iteration->finished);
   response->set_deployment_mode(config_.deployment_mode());
   VLOG(4) << "Found " << response->task_info_size()
@@ -1281,7 +1458,9 @@ Status DataServiceDispatcherImpl::DisableCompressionAtRuntime(
   mutex_lock l(mu_);
   TF_RETURN_IF_ERROR(state_.DatasetFromId(request->dataset_id(), dataset));
   if (dataset->metadata.compression() !=
-      DataServiceMetadata::COMPRESSION_SNAPPY) {
+          DataServiceMetadata::COMPRESSION_SNAPPY &&
+      dataset->metadata.compression() !=
+          DataServiceMetadata::COMPRESSION_AUTOTUNE) {
     response->set_no_compression_to_disable(true);
     return absl::OkStatus();
   }
@@ -1304,6 +1483,56 @@ Status DataServiceDispatcherImpl::DisableCompressionAtRuntime(
   return absl::OkStatus();
 }
 
+Status DataServiceDispatcherImpl::GetScalingRecommendation(
+    const GetScalingRecommendationRequest* request,
+    GetScalingRecommendationResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  mutex_lock l(mu_);
+  const int64_t deadline_micros =
+      env_->NowMicros() + request->timeout_ms() * 1000;
+  while (!cancelled_ && scaling_recommendation_.recommendation_id() <
+                            request->min_recommendation_id()) {
+    const int64_t remaining_micros = deadline_micros - env_->NowMicros();
+    if (remaining_micros <= 0) {
+      break;
+    }
+    scaling_recommendation_cv_.wait_for(
+        l, std::chrono::microseconds(remaining_micros));
+  }
+  *response = scaling_recommendation_;
+  const int64_t num_workers_to_remove =
+      response->current_number_of_workers() -
+      response->recommended_number_of_workers();
+  if (num_workers_to_remove > 0) {
+    for (std::string& worker_address :
+         CheapestWorkersToRemove(WorkerRemovalCosts(), num_workers_to_remove)) {
+      response->add_workers_to_drain(std::move(worker_address));
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status DataServiceDispatcherImpl::DrainWorker(
+    const DrainWorkerRequest* request, DrainWorkerResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  mutex_lock l(mu_);
+  const std::string& worker_address = request->worker_address();
+  std::shared_ptr<const Worker> worker;
+  TF_RETURN_IF_ERROR(state_.WorkerFromAddress(worker_address, worker));
+  if (!state_.IsWorkerDraining(worker_address)) {
+    // Draining workers get no new tasks or splits, also after a restart.
+    Update update;
+    update.mutable_drain_worker()->set_worker_address(worker_address);
+    TF_RETURN_IF_ERROR(Apply(update));
+    LOG(INFO) << "Draining worker " << worker_address;
+    UpdateScalingRecommendation();
+  }
+  std::vector<std::shared_ptr<const Task>> tasks;
+  TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, tasks));
+  response->set_drained(NumSplitReadingTasks(tasks) == 0);
+  return absl::OkStatus();
+}
+
 Status DataServiceDispatcherImpl::PopulateTaskDef(
     std::shared_ptr<const Task> task, TaskDef* task_def) const
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1353,7 +1582,7 @@ Status DataServiceDispatcherImpl::CheckStarted() TF_LOCKS_EXCLUDED(mu_) {
 
 Status DataServiceDispatcherImpl::RecordSplitProduced(
     int64_t iteration_id, int64_t repetition, int64_t split_provider_index,
-    bool finished) TF_LOCKS_EXCLUDED(mu_) {
+    bool finished, int64_t num_splits) TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
   Update update;
   ProduceSplitUpdate* produce_split = update.mutable_produce_split();
@@ -1361,6 +1590,9 @@ Status DataServiceDispatcherImpl::RecordSplitProduced(
   produce_split->set_repetition(repetition);
   produce_split->set_split_provider_index(split_provider_index);
   produce_split->set_finished(finished);
+  if (num_splits != 1) {
+    produce_split->set_num_splits(num_splits);
+  }
   return Apply(update);
 }
 
@@ -1371,10 +1603,85 @@ Status DataServiceDispatcherImpl::ApplyWithoutJournaling(const Update& update)
 
 Status DataServiceDispatcherImpl::Apply(const Update& update)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  if (journal_writer_.has_value()) {
-    TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
+  if (!journal_writer_.has_value()) {
+    return state_.Apply(update);
+  }
+  TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
+  TF_RETURN_IF_ERROR(state_.Apply(update));
+  if (config_.journal_snapshot_interval() > 0 &&
+      ++updates_since_state_snapshot_ >= config_.journal_snapshot_interval()) {
+    // The update is durable in the journal, so failing to snapshot the state
+    // only makes recovery slower.
+    Status s = SnapshotState();
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to snapshot tf.data service dispatcher state: "
+                   << s;
+    }
   }
-  return state_.Apply(update);
+  return absl::OkStatus();
+}
+
+Status DataServiceDispatcherImpl::RestoreFromJournal()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const std::string journal_dir = JournalDir(config_.work_dir());
+  LOG(INFO) << "Attempting to restore dispatcher state from journal in "
+            << journal_dir;
+  int64_t start = env_->NowMicros();
+  int64_t journal_sequence_number = 0;
+  absl::StatusOr<DispatcherStateSnapshot> snapshot =
+      ReadLatestJournalSnapshot(env_, journal_dir);
+  if (snapshot.ok()) {
+    TF_RETURN_IF_ERROR(state_.RestoreStateSnapshot(*snapshot));
+    journal_sequence_number = snapshot->journal_sequence_number();
+    LOG(INFO) << "Restored dispatcher state snapshot with "
+              << snapshot->updates_size() << " updates.";
+  } else if (!errors::IsNotFound(snapshot.status())) {
+    return snapshot.status();
+  }
+
+  Update update;
+  bool end_of_journal = false;
+  FileJournalReader reader(env_, journal_dir, journal_sequence_number);
+  Status s = reader.Read(update, end_of_journal);
+  if (errors::IsNotFound(s)) {
+    if (!snapshot.ok()) {
+      LOG(INFO) << "No journal found. Starting dispatcher from new state.";
+      return absl::OkStatus();
+    }
+  } else if (!s.ok()) {
+    return s;
+  } else {
+    while (!end_of_journal) {
+      TF_RETURN_IF_ERROR(ApplyWithoutJournaling(update));
+      ++updates_since_state_snapshot_;
+      TF_RETURN_IF_ERROR(reader.Read(update, end_of_journal));
+    }
+  }
+  absl::Duration duration = absl::Microseconds(env_->NowMicros() - start);
+  metrics::RecordTFDataServiceDispatcherRecoveryTime(
+      absl::ToInt64Microseconds(duration));
+  LOG(INFO) << "Restored from journal in " << duration << ", replaying "
+            << updates_since_state_snapshot_ << " updates after the latest "
+            << "state snapshot.";
+  return absl::OkStatus();
+}
+
+Status DataServiceDispatcherImpl::SnapshotState()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  updates_since_state_snapshot_ = 0;
+  int64_t start = env_->NowMicros();
+  // Later updates go to the new journal file, which the snapshot doesn't
+  // reflect.
+  TF_ASSIGN_OR_RETURN(int64_t journal_sequence_number,
+                      journal_writer_.value()->StartNewFile());
+  DispatcherStateSnapshot snapshot = state_.ExportStateSnapshot();
+  snapshot.set_journal_sequence_number(journal_sequence_number);
+  TF_RETURN_IF_ERROR(WriteJournalSnapshot(
+      env_, JournalDir(config_.work_dir()), snapshot));
+  VLOG(1) << "Wrote tf.data service dispatcher state snapshot with "
+          << snapshot.updates_size() << " updates in "
+          << absl::Microseconds(env_->NowMicros() - start) << ".";
+  return absl::OkStatus();
 }
 
 void DataServiceDispatcherImpl::MaintenanceThread() {
@@ -1404,6 +1711,7 @@ void DataServiceDispatcherImpl::MaintenanceThread() {
                 << s;
       }
     }
+    UpdateScalingRecommendation();
     {
       Status s = GcOldIterations();
       if (!s.ok()) {
@@ -1487,6 +1795,7 @@ void DataServiceDispatcherImpl::DetectMissingWorkers()
       LOG(INFO) << "Lost worker " << it->first << " due to timeout";
       RemoveWorkerFromAutoScaler(it->first);
 
+      worker_loads_.erase(it->first);
       latest_worker_heartbeats_time_.erase(it++);
     } else {
       ++it;
@@ -1494,6 +1803,58 @@ void DataServiceDispatcherImpl::DetectMissingWorkers()
   }
 }
 
+void DataServiceDispatcherImpl::UpdateScalingRecommendation()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const int64_t current_number_of_workers =
+      state_.GetNumberOfRegisteredWorkers() -
+      state_.GetNumberOfDrainingWorkers();
+  const std::optional<int64_t> optimal_number_of_workers =
+      auto_scaler_.GetOptimalNumberOfWorkers();
+  const int64_t recommended_number_of_workers = scaling_recommender_.Recommend(
+      current_number_of_workers, optimal_number_of_workers,
+      absl::FromUnixMicros(env_->NowMicros()));
+  scaling_recommendation_.set_optimal_number_of_workers(
+      optimal_number_of_workers.value_or(0));
+  if (current_number_of_workers ==
+          scaling_recommendation_.current_number_of_workers() &&
+      recommended_number_of_workers ==
+          scaling_recommendation_.recommended_number_of_workers()) {
+    return;
+  }
+  VLOG(1) << "Recommending " << recommended_number_of_workers
+          << " tf.data service workers instead of "
+          << current_number_of_workers;
+  scaling_recommendation_.set_recommendation_id(
+      scaling_recommendation_.recommendation_id() + 1);
+  scaling_recommendation_.set_current_number_of_workers(
+      current_number_of_workers);
+  scaling_recommendation_.set_recommended_number_of_workers(
+      recommended_number_of_workers);
+  scaling_recommendation_cv_.notify_all();
+}
+
+std::vector<WorkerRemovalCost> DataServiceDispatcherImpl::WorkerRemovalCosts()
+    const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<WorkerRemovalCost> costs;
+  for (const auto& worker : state_.ListWorkers()) {
+    if (state_.IsWorkerDraining(worker->address)) {
+      continue;
+    }
+    std::vector<std::shared_ptr<const Task>> tasks;
+    if (!state_.TasksForWorker(worker->address, tasks).ok()) {
+      continue;
+    }
+    WorkerRemovalCost& cost = costs.emplace_back();
+    cost.worker_address = worker->address;
+    cost.num_split_reading_tasks = NumSplitReadingTasks(tasks);
+    if (auto it = worker_loads_.find(worker->address);
+        it != worker_loads_.end()) {
+      cost.outstanding_requests = it->second;
+    }
+  }
+  return costs;
+}
+
 Status DataServiceDispatcherImpl::GcOldIterations()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   std::vector<std::shared_ptr<const Iteration>> iterations =
@@ -1507,6 +1868,7 @@ Status DataServiceDispatcherImpl::GcOldIterations()
     update.mutable_garbage_collect_iteration()->set_iteration_id(
         iteration->iteration_id);
     TF_RETURN_IF_ERROR(state_.Apply(update));
+    split_leases_.erase(iteration->iteration_id);
     Status auto_scaler_status =
         auto_scaler_.UnregisterIteration(iteration->iteration_id);
     if (!auto_scaler_status.ok()) {
@@ -17,9 +17,11 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_DISPATCHER_IMPL_H_
 
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -32,10 +34,12 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/dispatcher_state.h"
 #include "tensorflow/core/data/service/export.pb.h"
+#include "tensorflow/core/data/service/scaling_recommender.h"
 #include "tensorflow/core/data/service/snapshot/snapshot_manager.h"
 #include "tensorflow/core/data/service/task_remover.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -189,6 +193,13 @@ class DataServiceDispatcherImpl {
       const DisableCompressionAtRuntimeRequest* request,
       DisableCompressionAtRuntimeResponse* response);
 
+  /// Cluster controller-facing API.
+  Status GetScalingRecommendation(
+      const GetScalingRecommendationRequest* request,
+      GetScalingRecommendationResponse* response);
+  Status DrainWorker(const DrainWorkerRequest* request,
+                     DrainWorkerResponse* response);
+
   // Exports the dispatcher state for debugging.
   DispatcherStateExport ExportState() const;
 
@@ -197,6 +208,32 @@ class DataServiceDispatcherImpl {
   // release, workers to consider missing, and snapshot streams to reassign.
   void MaintenanceThread();
 
+  // Splits leased to a worker by a `GetSplit` request with `max_num_splits`.
+  struct SplitLease {
+    int64_t repetition = 0;
+    std::vector<Tensor> splits;
+    absl::Time lease_time;
+  };
+  // The split leases of a split provider of an iteration.
+  struct SplitLeases {
+    // Map from worker address to the latest lease of the worker.
+    absl::flat_hash_map<std::string, SplitLease> leases;
+    // The splits leased to lost workers, with their repetitions, to be leased
+    // again before new splits.
+    std::deque<std::pair<int64_t, Tensor>> reclaimed_splits;
+  };
+
+  // Returns in `iteration` the distributed epoch iteration with `iteration_id`.
+  Status DistributedEpochIterationFromId(
+      int64_t iteration_id,
+      std::shared_ptr<const DispatcherState::Iteration>& iteration)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Serves a `GetSplit` request which leases several splits to a worker.
+  Status LeaseSplits(const GetSplitRequest& request,
+                     GetSplitResponse& response) TF_LOCKS_EXCLUDED(mu_);
+  // Moves the splits of the leases of lost workers to `reclaimed_splits`.
+  void ReclaimExpiredSplitLeases(SplitLeases& split_leases)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Restores split providers from the state in `iteration` and stores them in
   // `restored`.
   Status RestoreSplitProviders(
@@ -310,16 +347,22 @@ class DataServiceDispatcherImpl {
   Status CheckStarted() TF_LOCKS_EXCLUDED(mu_);
   // Restores ongoing tf.data snapshots.
   absl::Status RestoreSnapshots();
-  // Records that a split was produced by a call to `GetSplit`.
+  // Records that `num_splits` splits were produced by a call to `GetSplit`.
   Status RecordSplitProduced(int64_t iteration_id, int64_t repetition,
-                             int64_t split_provider_index, bool finished)
-      TF_LOCKS_EXCLUDED(mu_);
+                             int64_t split_provider_index, bool finished,
+                             int64_t num_splits = 1) TF_LOCKS_EXCLUDED(mu_);
   // Applies a state update, updating both the journal and the in-memory state.
   Status Apply(const Update& update) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, but doesn't update the journal. Only meant to be
   // used when recovering state when the dispatcher starts.
   Status ApplyWithoutJournaling(const Update& update)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Restores the dispatcher state from the latest state snapshot and the
+  // journal written after it.
+  Status RestoreFromJournal() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Writes a snapshot of the dispatcher state to the journal directory and
+  // deletes the journal files it reflects.
+  Status SnapshotState() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Removes the client with `client_id` from `auto_scaler_`
   void RemoveClientFromAutoScaler(int64_t client_id)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -332,6 +375,13 @@ class DataServiceDispatcherImpl {
   // Checks for workers that haven't heartbeated recently and alerts the
   // snapshot managers.
   void DetectMissingWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Updates `scaling_recommendation_` from the current estimate of
+  // `auto_scaler_`, waking up `GetScalingRecommendation` requests if it
+  // changes.
+  void UpdateScalingRecommendation() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the cost of removing each worker which is not being drained.
+  std::vector<WorkerRemovalCost> WorkerRemovalCosts() const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Scans for old iterations and marks them as finished.
   Status GcOldIterations() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Returns true if an iteration should be garbage collected.
@@ -366,6 +416,9 @@ class DataServiceDispatcherImpl {
   // Mapping from iteration id to the split providers for the iteration.
   absl::flat_hash_map<int64_t, std::vector<std::unique_ptr<SplitProvider>>>
       split_providers_ TF_GUARDED_BY(mu_);
+  // Map from iteration id to the split leases of each of its split providers.
+  absl::flat_hash_map<int64_t, absl::flat_hash_map<int64_t, SplitLeases>>
+      split_leases_ TF_GUARDED_BY(mu_);
   // Mapping from round robin iteration id to the round the iteration is
   // currently on. This is based on the data provided by client heartbeats,
   // and may be stale.
@@ -379,6 +432,9 @@ class DataServiceDispatcherImpl {
   // Map from worker address to the time of the worker's last heartbeat.
   absl::flat_hash_map<std::string, absl::Time> latest_worker_heartbeats_time_
       TF_GUARDED_BY(mu_);
+  // Map from worker address to the number of requests the worker reported
+  // serving in its last heartbeat.
+  absl::flat_hash_map<std::string, int64_t> worker_loads_ TF_GUARDED_BY(mu_);
 
   // TODO(mpcallanan): Don't recover completed snapshots.
   // TODO(mpcallanan): Garbage collect completed snapshots.
@@ -391,11 +447,19 @@ class DataServiceDispatcherImpl {
 
   std::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
+  // The number of updates written to the journal since the latest state
+  // snapshot.
+  int64_t updates_since_state_snapshot_ TF_GUARDED_BY(mu_) = 0;
   DispatcherState state_ TF_GUARDED_BY(mu_);
   // Condition variable for waking up the gc thread.
   condition_variable maintenance_thread_cv_;
   std::unique_ptr<Thread> maintenance_thread_;
   MultipleIterationsAutoScaler auto_scaler_;
+  ScalingRecommender scaling_recommender_ TF_GUARDED_BY(mu_);
+  // The latest scaling recommendation, without `workers_to_drain`.
+  GetScalingRecommendationResponse scaling_recommendation_ TF_GUARDED_BY(mu_);
+  // Condition variable for waking up `GetScalingRecommendation` requests.
+  condition_variable scaling_recommendation_cv_;
 
   DataServiceDispatcherImpl(const DataServiceDispatcherImpl&) = delete;
   void operator=(const DataServiceDispatcherImpl&) = delete;
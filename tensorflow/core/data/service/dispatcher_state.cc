@@ -15,12 +15,15 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher_state.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <queue>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.h"
@@ -33,6 +36,33 @@ limitations under the License.
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+// Fills in the fields of a `CreateTaskUpdate` or `CreatePendingTaskUpdate`
+// which recreate `task`.
+template <class T>
+void FillTaskUpdate(const DispatcherState::Task& task, T& update) {
+  update.set_task_id(task.task_id);
+  update.set_iteration_id(task.iteration->iteration_id);
+  update.set_worker_address(task.worker_address);
+  update.mutable_transfer_servers()->Add(task.transfer_servers.begin(),
+                                         task.transfer_servers.end());
+  update.mutable_worker_tags()->Add(task.worker_tags.begin(),
+                                    task.worker_tags.end());
+  update.set_worker_uid(task.worker_uid);
+}
+
+template <class K, class V>
+std::vector<K> SortedKeys(const absl::flat_hash_map<K, V>& map) {
+  std::vector<K> keys;
+  keys.reserve(map.size());
+  for (const auto& [key, value] : map) {
+    keys.push_back(key);
+  }
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+}  // namespace
 
 DispatcherState::DispatcherState()
     : worker_index_resolver_(std::vector<std::string>{}) {}
@@ -88,6 +118,9 @@ Status DispatcherState::Apply(const Update& update) {
     case Update::kCompressionDisabledAtRuntime:
       CompressionDisabledAtRuntime(update.compression_disabled_at_runtime());
       break;
+    case Update::kDrainWorker:
+      DrainWorker(update.drain_worker());
+      break;
     case Update::UPDATE_TYPE_NOT_SET:
       return errors::Internal("Update type not set.");
   }
@@ -95,6 +128,222 @@ Status DispatcherState::Apply(const Update& update) {
   return absl::OkStatus();
 }
 
+DispatcherStateSnapshot DispatcherState::ExportStateSnapshot() const {
+  DispatcherStateSnapshot snapshot;
+  for (const std::string& dataset_id : SortedKeys(datasets_by_id_)) {
+    RegisterDatasetUpdate* register_dataset =
+        snapshot.add_updates()->mutable_register_dataset();
+    register_dataset->set_dataset_id(dataset_id);
+    *register_dataset->mutable_metadata() =
+        datasets_by_id_.at(dataset_id)->metadata;
+  }
+  for (const std::string& address : SortedKeys(workers_)) {
+    const Worker& worker = *workers_.at(address);
+    RegisterWorkerUpdate* register_worker =
+        snapshot.add_updates()->mutable_register_worker();
+    register_worker->set_worker_address(worker.address);
+    register_worker->mutable_transfer_servers()->Add(
+        worker.transfer_servers.begin(), worker.transfer_servers.end());
+    register_worker->mutable_worker_tags()->Add(worker.tags.begin(),
+                                                worker.tags.end());
+    register_worker->set_worker_uid(worker.uid);
+  }
+  std::vector<std::string> draining_workers(draining_workers_.begin(),
+                                            draining_workers_.end());
+  std::sort(draining_workers.begin(), draining_workers.end());
+  for (const std::string& address : draining_workers) {
+    snapshot.add_updates()->mutable_drain_worker()->set_worker_address(
+        address);
+  }
+  for (const std::string& dataset_id :
+       SortedKeys(compression_disabled_at_runtime_)) {
+    CompressionDisabledAtRuntimeUpdate* compression_disabled_at_runtime =
+        snapshot.add_updates()->mutable_compression_disabled_at_runtime();
+    compression_disabled_at_runtime->set_dataset_id(dataset_id);
+    compression_disabled_at_runtime->set_compression_disabled(
+        compression_disabled_at_runtime_.at(dataset_id));
+  }
+  std::vector<std::string> snapshot_paths(snapshot_paths_.begin(),
+                                          snapshot_paths_.end());
+  std::sort(snapshot_paths.begin(), snapshot_paths.end());
+  for (const std::string& path : snapshot_paths) {
+    snapshot.add_updates()->mutable_snapshot()->set_path(path);
+  }
+  for (int64_t job_id : SortedKeys(jobs_by_id_)) {
+    const Job& job = *jobs_by_id_.at(job_id);
+    CreateJobUpdate* create_job = snapshot.add_updates()->mutable_create_job();
+    create_job->set_job_id(job.id);
+    create_job->set_job_name(job.job_name);
+    create_job->set_dataset_id(job.dataset_id);
+    *create_job->mutable_processing_mode_def() = job.processing_mode;
+    if (job.num_consumers.has_value()) {
+      create_job->set_num_consumers(*job.num_consumers);
+    }
+    create_job->set_target_workers(job.target_workers);
+    create_job->set_use_cross_trainer_cache(job.use_cross_trainer_cache);
+  }
+
+  // Iterations are recreated in the order they were created, so that the
+  // latest iteration for each key is the one found by `IterationByKey`. Each
+  // iteration is garbage collected before the next one may reuse its key.
+  for (int64_t iteration_id : SortedKeys(iterations_)) {
+    const Iteration& iteration = *iterations_.at(iteration_id);
+    CreateIterationUpdate* create_iteration =
+        snapshot.add_updates()->mutable_create_iteration();
+    create_iteration->set_iteration_id(iteration_id);
+    create_iteration->set_job_id(iteration.job->id);
+    create_iteration->set_repetition(iteration.iteration_key.repetition);
+
+    IterationStateSnapshot* iteration_state = snapshot.add_iterations();
+    iteration_state->set_iteration_id(iteration_id);
+    iteration_state->set_finished(iteration.finished);
+    iteration_state->set_last_client_released_micros(
+        iteration.last_client_released_micros);
+    if (iteration.distributed_epoch_state.has_value()) {
+      const DistributedEpochState& state = *iteration.distributed_epoch_state;
+      create_iteration->set_num_split_providers(state.repetitions.size());
+      iteration_state->mutable_split_repetitions()->Add(
+          state.repetitions.begin(), state.repetitions.end());
+      iteration_state->mutable_split_indices()->Add(state.indices.begin(),
+                                                    state.indices.end());
+    }
+
+    const std::vector<std::shared_ptr<Task>>& tasks =
+        tasks_by_iteration_.at(iteration_id);
+    for (const std::shared_ptr<Task>& task : tasks) {
+      FillTaskUpdate(*task, *snapshot.add_updates()->mutable_create_task());
+      if (task->starting_round != 0) {
+        (*snapshot.mutable_task_starting_rounds())[task->task_id] =
+            task->starting_round;
+      }
+    }
+    std::queue<PendingTask> pending_tasks = iteration.pending_tasks;
+    while (!pending_tasks.empty()) {
+      CreatePendingTaskUpdate* create_pending_task =
+          snapshot.add_updates()->mutable_create_pending_task();
+      FillTaskUpdate(*pending_tasks.front().task, *create_pending_task);
+      create_pending_task->set_starting_round(
+          pending_tasks.front().target_round);
+      pending_tasks.pop();
+    }
+    if (iteration.garbage_collected) {
+      snapshot.add_updates()
+          ->mutable_garbage_collect_iteration()
+          ->set_iteration_id(iteration_id);
+      continue;
+    }
+    for (const std::shared_ptr<Task>& task : tasks) {
+      if (task->finished) {
+        snapshot.add_updates()->mutable_finish_task()->set_task_id(
+            task->task_id);
+      }
+    }
+  }
+
+  // `IterationForIterationClientId` may have added null entries for unknown
+  // clients.
+  std::vector<int64_t> iteration_client_ids;
+  for (int64_t iteration_client_id : SortedKeys(iterations_for_client_ids_)) {
+    if (iterations_for_client_ids_.at(iteration_client_id) != nullptr) {
+      iteration_client_ids.push_back(iteration_client_id);
+    }
+  }
+  for (int64_t iteration_client_id : iteration_client_ids) {
+    AcquireIterationClientUpdate* acquire_iteration_client =
+        snapshot.add_updates()->mutable_acquire_iteration_client();
+    acquire_iteration_client->set_iteration_id(
+        iterations_for_client_ids_.at(iteration_client_id)->iteration_id);
+    acquire_iteration_client->set_iteration_client_id(iteration_client_id);
+  }
+
+  // Replays the progress of the round-robin tasks waiting to be added. The
+  // rejections, which reset the task's ready consumers, are replayed from the
+  // first client of the iteration.
+  absl::flat_hash_set<int64_t> iterations_with_replayed_rejections;
+  for (int64_t iteration_client_id : iteration_client_ids) {
+    const Iteration& iteration =
+        *iterations_for_client_ids_.at(iteration_client_id);
+    if (iteration.pending_tasks.empty()) {
+      continue;
+    }
+    const PendingTask& pending_task = iteration.pending_tasks.front();
+    if (iterations_with_replayed_rejections.insert(iteration.iteration_id)
+            .second) {
+      for (int64_t i = 0; i < pending_task.failures; ++i) {
+        ClientHeartbeatUpdate* client_heartbeat =
+            snapshot.add_updates()->mutable_client_heartbeat();
+        client_heartbeat->set_iteration_client_id(iteration_client_id);
+        client_heartbeat->mutable_task_rejected()->set_new_target_round(
+            pending_task.target_round);
+      }
+    }
+    if (pending_task.ready_consumers.contains(iteration_client_id)) {
+      ClientHeartbeatUpdate* client_heartbeat =
+          snapshot.add_updates()->mutable_client_heartbeat();
+      client_heartbeat->set_iteration_client_id(iteration_client_id);
+      client_heartbeat->set_task_accepted(true);
+    }
+  }
+
+  snapshot.set_next_available_iteration_client_id(
+      next_available_iteration_client_id_);
+  snapshot.set_next_available_task_id(next_available_task_id_);
+  return snapshot;
+}
+
+Status DispatcherState::RestoreStateSnapshot(
+    const DispatcherStateSnapshot& snapshot) {
+  for (const Update& update : snapshot.updates()) {
+    TF_RETURN_IF_ERROR(Apply(update));
+  }
+  next_available_iteration_client_id_ =
+      std::max(next_available_iteration_client_id_,
+               snapshot.next_available_iteration_client_id());
+  next_available_task_id_ =
+      std::max(next_available_task_id_, snapshot.next_available_task_id());
+
+  for (const IterationStateSnapshot& iteration_state : snapshot.iterations()) {
+    auto it = iterations_.find(iteration_state.iteration_id());
+    if (it == iterations_.end()) {
+      return errors::DataLoss("Dispatcher state snapshot has the state of ",
+                              "iteration ", iteration_state.iteration_id(),
+                              ", but does not create it.");
+    }
+    Iteration& iteration = *it->second;
+    iteration.finished = iteration_state.finished();
+    iteration.last_client_released_micros =
+        iteration_state.last_client_released_micros();
+    if (!iteration.distributed_epoch_state.has_value()) {
+      continue;
+    }
+    DistributedEpochState& state = *iteration.distributed_epoch_state;
+    if (iteration_state.split_repetitions_size() != state.repetitions.size() ||
+        iteration_state.split_indices_size() != state.indices.size()) {
+      return errors::DataLoss(
+          "Dispatcher state snapshot has the split state of ",
+          iteration_state.split_repetitions_size(),
+          " split providers for iteration ", iteration.iteration_id,
+          ", which has ", state.repetitions.size(), " split providers.");
+    }
+    state.repetitions.assign(iteration_state.split_repetitions().begin(),
+                             iteration_state.split_repetitions().end());
+    state.indices.assign(iteration_state.split_indices().begin(),
+                         iteration_state.split_indices().end());
+  }
+
+  for (const auto& [task_id, starting_round] :
+       snapshot.task_starting_rounds()) {
+    auto it = tasks_.find(task_id);
+    if (it == tasks_.end()) {
+      return errors::DataLoss("Dispatcher state snapshot has the starting ",
+                              "round of task ", task_id,
+                              ", but does not create it.");
+    }
+    it->second->starting_round = starting_round;
+  }
+  return absl::OkStatus();
+}
+
 void DispatcherState::RegisterDataset(
     const RegisterDatasetUpdate& register_dataset) {
   std::string dataset_id = register_dataset.dataset_id();
@@ -187,7 +436,8 @@ void DispatcherState::ProduceSplit(const ProduceSplitUpdate& produce_split) {
     state.indices[provider_index] = 0;
     return;
   }
-  state.indices[provider_index]++;
+  state.indices[provider_index] +=
+      std::max<int64_t>(produce_split.num_splits(), 1);
 }
 
 void DispatcherState::AcquireIterationClient(
@@ -484,6 +734,16 @@ void DispatcherState::CompressionDisabledAtRuntime(
   });
 }
 
+void DispatcherState::DrainWorker(const DrainWorkerUpdate& drain_worker) {
+  DCHECK(workers_.contains(drain_worker.worker_address()));
+  draining_workers_.insert(drain_worker.worker_address());
+}
+
+bool DispatcherState::IsWorkerDraining(
+    absl::string_view worker_address) const {
+  return draining_workers_.contains(worker_address);
+}
+
 std::optional<bool> DispatcherState::CompressionDisabledAtRuntime(
     const std::string& dataset_id) const {
   if (auto it = compression_disabled_at_runtime_.find(dataset_id);
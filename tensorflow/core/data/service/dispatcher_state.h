@@ -73,6 +73,15 @@ class DispatcherState {
   // Applies the given update to the dispatcher's state.
   Status Apply(const Update& update);
 
+  // Returns a compact snapshot of the state, from which `RestoreStateSnapshot`
+  // rebuilds an equivalent state without replaying the journal which led to
+  // it. The caller is responsible for setting `journal_sequence_number`.
+  DispatcherStateSnapshot ExportStateSnapshot() const;
+
+  // Restores the state from `snapshot`. Must be called on a new state, before
+  // applying any update.
+  Status RestoreStateSnapshot(const DispatcherStateSnapshot& snapshot);
+
   // A dataset registered with the dispatcher.
   struct Dataset {
     explicit Dataset(const std::string& dataset_id,
@@ -305,6 +314,14 @@ class DispatcherState {
   // Returns the current number of registered workers.
   int64_t GetNumberOfRegisteredWorkers() const { return workers_.size(); }
 
+  // Returns whether the worker is being drained before its removal.
+  bool IsWorkerDraining(absl::string_view worker_address) const;
+
+  // Returns the number of workers being drained.
+  int64_t GetNumberOfDrainingWorkers() const {
+    return draining_workers_.size();
+  }
+
  private:
   void RegisterDataset(const RegisterDatasetUpdate& register_dataset);
   void RegisterWorker(const RegisterWorkerUpdate& register_worker);
@@ -325,6 +342,7 @@ class DispatcherState {
   void Snapshot(const SnapshotUpdate& snapshot);
   void CompressionDisabledAtRuntime(const CompressionDisabledAtRuntimeUpdate&
                                         compression_disabled_at_runtime);
+  void DrainWorker(const DrainWorkerUpdate& drain_worker);
 
   // Updates the next available dataset ID.
   void UpdateNextAvailableDatasetId();
@@ -335,6 +353,8 @@ class DispatcherState {
 
   // Registered workers, keyed by address.
   absl::flat_hash_map<std::string, std::shared_ptr<Worker>> workers_;
+  // Addresses of the workers being drained before their removal.
+  absl::flat_hash_set<std::string> draining_workers_;
 
   // Assigns an index to each worker according to worker addresses list
   // specified in the dispatcher config.
@@ -40,6 +40,7 @@ using IterationKey = DispatcherState::IterationKey;
 using Job = DispatcherState::Job;
 using Iteration = DispatcherState::Iteration;
 using Task = DispatcherState::Task;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::IsEmpty;
 using ::testing::SizeIs;
@@ -127,6 +128,13 @@ Status FinishTask(int64_t task_id, DispatcherState& state) {
   return state.Apply(update);
 }
 
+Status DrainWorker(const std::string& worker_address,
+                   DispatcherState& state) {
+  Update update;
+  update.mutable_drain_worker()->set_worker_address(worker_address);
+  return state.Apply(update);
+}
+
 Status Snapshot(const std::string& path, DispatcherState& state) {
   Update update;
   SnapshotUpdate* snapshot = update.mutable_snapshot();
@@ -652,5 +660,211 @@ TEST(DispatcherState, GetNumberOfRegisteredWorkers) {
   EXPECT_EQ(state.GetNumberOfRegisteredWorkers(), 2);
 }
 
+TEST(DispatcherState, DrainWorker) {
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterWorker("worker_1", state));
+  TF_EXPECT_OK(RegisterWorker("worker_2", state));
+  EXPECT_FALSE(state.IsWorkerDraining("worker_1"));
+  EXPECT_EQ(state.GetNumberOfDrainingWorkers(), 0);
+
+  TF_EXPECT_OK(DrainWorker("worker_1", state));
+  EXPECT_TRUE(state.IsWorkerDraining("worker_1"));
+  EXPECT_FALSE(state.IsWorkerDraining("worker_2"));
+  EXPECT_EQ(state.GetNumberOfDrainingWorkers(), 1);
+
+  DispatcherState restored_state;
+  TF_ASSERT_OK(
+      restored_state.RestoreStateSnapshot(state.ExportStateSnapshot()));
+  EXPECT_TRUE(restored_state.IsWorkerDraining("worker_1"));
+  EXPECT_FALSE(restored_state.IsWorkerDraining("worker_2"));
+  EXPECT_EQ(restored_state.GetNumberOfDrainingWorkers(), 1);
+}
+
+TEST(DispatcherState, StateSnapshotRoundTrip) {
+  std::string dataset_id = "dataset_id";
+  int64_t iteration_id = 3;
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterDataset(dataset_id, state));
+  TF_EXPECT_OK(RegisterWorker("worker_1", state));
+  TF_EXPECT_OK(RegisterWorker("worker_2", state));
+  TF_EXPECT_OK(Snapshot("snapshot_path", state));
+  TF_EXPECT_OK(CreateIteration(iteration_id, dataset_id, state));
+  TF_EXPECT_OK(CreateTask(/*task_id=*/10, iteration_id, "worker_1", state));
+  TF_EXPECT_OK(CreateTask(/*task_id=*/11, iteration_id, "worker_2", state));
+  TF_EXPECT_OK(FinishTask(/*task_id=*/10, state));
+  TF_EXPECT_OK(AcquireIterationClientId(iteration_id, 6, state));
+  TF_EXPECT_OK(AcquireIterationClientId(iteration_id, 7, state));
+  TF_EXPECT_OK(ReleaseIterationClientId(7, /*release_time=*/100, state));
+
+  DispatcherState restored_state;
+  TF_ASSERT_OK(
+      restored_state.RestoreStateSnapshot(state.ExportStateSnapshot()));
+  std::shared_ptr<const Dataset> dataset;
+  TF_EXPECT_OK(restored_state.DatasetFromId(dataset_id, dataset));
+  EXPECT_THAT(restored_state.ListWorkers(), SizeIs(2));
+  EXPECT_THAT(restored_state.ListSnapshotPaths(),
+              UnorderedElementsAre("snapshot_path"));
+  std::shared_ptr<const Iteration> iteration;
+  TF_ASSERT_OK(restored_state.IterationFromId(iteration_id, iteration));
+  EXPECT_EQ(iteration->num_clients, 1);
+  EXPECT_EQ(iteration->last_client_released_micros, 100);
+  EXPECT_FALSE(iteration->finished);
+  std::vector<std::shared_ptr<const Task>> tasks;
+  TF_EXPECT_OK(restored_state.TasksForIteration(iteration_id, tasks));
+  EXPECT_THAT(tasks, SizeIs(2));
+  TF_EXPECT_OK(restored_state.TasksForWorker("worker_1", tasks));
+  EXPECT_THAT(tasks, IsEmpty());
+  TF_EXPECT_OK(restored_state.TasksForWorker("worker_2", tasks));
+  EXPECT_THAT(tasks, SizeIs(1));
+  EXPECT_THAT(restored_state.ListActiveClientIds(), UnorderedElementsAre(6));
+  EXPECT_EQ(restored_state.NextAvailableTaskId(), state.NextAvailableTaskId());
+  EXPECT_EQ(restored_state.NextAvailableIterationClientId(),
+            state.NextAvailableIterationClientId());
+  EXPECT_EQ(restored_state.NextAvailableIterationId(),
+            state.NextAvailableIterationId());
+  EXPECT_EQ(restored_state.NextAvailableJobId(), state.NextAvailableJobId());
+}
+
+TEST(DispatcherState, StateSnapshotCompactsSplits) {
+  int64_t job_id = 5;
+  int64_t iteration_id = 3;
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterDataset("dataset_id", state));
+  Update update;
+  CreateJobUpdate* create_job = update.mutable_create_job();
+  create_job->set_job_id(job_id);
+  create_job->set_dataset_id("dataset_id");
+  create_job->set_job_name("job_name");
+  create_job->mutable_processing_mode_def()->set_sharding_policy(
+      ProcessingModeDef::DYNAMIC);
+  TF_EXPECT_OK(state.Apply(update));
+  update.Clear();
+  CreateIterationUpdate* create_iteration = update.mutable_create_iteration();
+  create_iteration->set_iteration_id(iteration_id);
+  create_iteration->set_job_id(job_id);
+  create_iteration->set_num_split_providers(2);
+  TF_EXPECT_OK(state.Apply(update));
+  auto produce_split = [&](int64_t split_provider_index, int64_t repetition,
+                           bool finished) {
+    Update update;
+    ProduceSplitUpdate* produce_split = update.mutable_produce_split();
+    produce_split->set_iteration_id(iteration_id);
+    produce_split->set_split_provider_index(split_provider_index);
+    produce_split->set_repetition(repetition);
+    produce_split->set_finished(finished);
+    return state.Apply(update);
+  };
+  for (int i = 0; i < 100; ++i) {
+    TF_EXPECT_OK(produce_split(/*split_provider_index=*/0, /*repetition=*/0,
+                               /*finished=*/false));
+  }
+  TF_EXPECT_OK(produce_split(/*split_provider_index=*/1, /*repetition=*/0,
+                             /*finished=*/true));
+  TF_EXPECT_OK(produce_split(/*split_provider_index=*/1, /*repetition=*/1,
+                             /*finished=*/false));
+
+  DispatcherStateSnapshot snapshot = state.ExportStateSnapshot();
+  for (const Update& update : snapshot.updates()) {
+    EXPECT_FALSE(update.has_produce_split());
+  }
+  DispatcherState restored_state;
+  TF_ASSERT_OK(restored_state.RestoreStateSnapshot(snapshot));
+  std::shared_ptr<const Iteration> iteration;
+  TF_ASSERT_OK(restored_state.IterationFromId(iteration_id, iteration));
+  ASSERT_TRUE(iteration->distributed_epoch_state.has_value());
+  EXPECT_THAT(iteration->distributed_epoch_state->repetitions,
+              ElementsAre(0, 1));
+  EXPECT_THAT(iteration->distributed_epoch_state->indices,
+              ElementsAre(100, 1));
+}
+
+TEST(DispatcherState, ProduceMultipleSplits) {
+  int64_t job_id = 5;
+  int64_t iteration_id = 3;
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterDataset("dataset_id", state));
+  Update update;
+  CreateJobUpdate* create_job = update.mutable_create_job();
+  create_job->set_job_id(job_id);
+  create_job->set_dataset_id("dataset_id");
+  create_job->set_job_name("job_name");
+  create_job->mutable_processing_mode_def()->set_sharding_policy(
+      ProcessingModeDef::DYNAMIC);
+  TF_EXPECT_OK(state.Apply(update));
+  update.Clear();
+  CreateIterationUpdate* create_iteration = update.mutable_create_iteration();
+  create_iteration->set_iteration_id(iteration_id);
+  create_iteration->set_job_id(job_id);
+  create_iteration->set_num_split_providers(1);
+  TF_EXPECT_OK(state.Apply(update));
+  update.Clear();
+  ProduceSplitUpdate* produce_split = update.mutable_produce_split();
+  produce_split->set_iteration_id(iteration_id);
+  produce_split->set_repetition(0);
+  produce_split->set_num_splits(8);
+  TF_EXPECT_OK(state.Apply(update));
+  TF_EXPECT_OK(state.Apply(update));
+  produce_split->clear_num_splits();
+  TF_EXPECT_OK(state.Apply(update));
+
+  std::shared_ptr<const Iteration> iteration;
+  TF_ASSERT_OK(state.IterationFromId(iteration_id, iteration));
+  ASSERT_TRUE(iteration->distributed_epoch_state.has_value());
+  EXPECT_THAT(iteration->distributed_epoch_state->repetitions, ElementsAre(0));
+  EXPECT_THAT(iteration->distributed_epoch_state->indices, ElementsAre(17));
+}
+
+TEST(DispatcherState, StateSnapshotGarbageCollectedIteration) {
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterDataset("dataset_id", state));
+  TF_EXPECT_OK(RegisterWorker("worker", state));
+  IterationKey iteration_key("job_name", /*repetition=*/0);
+  TF_EXPECT_OK(
+      CreateIteration(/*iteration_id=*/3, "dataset_id", iteration_key, state));
+  TF_EXPECT_OK(CreateTask(/*task_id=*/10, /*iteration_id=*/3, "worker", state));
+  Update update;
+  update.mutable_garbage_collect_iteration()->set_iteration_id(3);
+  TF_EXPECT_OK(state.Apply(update));
+  update.Clear();
+  CreateIterationUpdate* create_iteration = update.mutable_create_iteration();
+  create_iteration->set_iteration_id(4);
+  create_iteration->set_job_id(state.NextAvailableJobId() - 1);
+  TF_EXPECT_OK(state.Apply(update));
+
+  DispatcherState restored_state;
+  TF_ASSERT_OK(
+      restored_state.RestoreStateSnapshot(state.ExportStateSnapshot()));
+  std::shared_ptr<const Iteration> iteration;
+  TF_ASSERT_OK(restored_state.IterationFromId(3, iteration));
+  EXPECT_TRUE(iteration->garbage_collected);
+  EXPECT_TRUE(iteration->finished);
+  TF_ASSERT_OK(restored_state.IterationByKey(iteration_key, iteration));
+  EXPECT_EQ(iteration->iteration_id, 4);
+  std::vector<std::shared_ptr<const Task>> tasks;
+  TF_EXPECT_OK(restored_state.TasksForWorker("worker", tasks));
+  EXPECT_THAT(tasks, IsEmpty());
+}
+
+TEST(DispatcherState, StateSnapshotRemovedTask) {
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterDataset("dataset_id", state));
+  TF_EXPECT_OK(RegisterWorker("worker", state));
+  TF_EXPECT_OK(CreateIteration(/*iteration_id=*/3, "dataset_id", state));
+  TF_EXPECT_OK(
+      CreateTask(/*task_id=*/5000, /*iteration_id=*/3, "worker", state));
+  Update update;
+  update.mutable_remove_task()->set_task_id(5000);
+  TF_EXPECT_OK(state.Apply(update));
+
+  DispatcherState restored_state;
+  TF_ASSERT_OK(
+      restored_state.RestoreStateSnapshot(state.ExportStateSnapshot()));
+  std::shared_ptr<const Task> task;
+  EXPECT_THAT(restored_state.TaskFromId(5000, task),
+              StatusIs(error::NOT_FOUND));
+  // Task IDs are not reused after the task is removed.
+  EXPECT_EQ(restored_state.NextAvailableTaskId(), 5001);
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -69,6 +69,8 @@ HANDLER(Snapshot);
 HANDLER(GetSnapshotSplit);
 HANDLER(GetSnapshotStreams);
 HANDLER(DisableCompressionAtRuntime);
+HANDLER(GetScalingRecommendation);
+HANDLER(DrainWorker);
 #undef HANDLER
 
 }  // namespace data
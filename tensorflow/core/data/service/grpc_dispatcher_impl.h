@@ -63,6 +63,8 @@ class GrpcDispatcherImpl : public DispatcherService::Service {
   HANDLER(GetSnapshotSplit);
   HANDLER(GetSnapshotStreams);
   HANDLER(DisableCompressionAtRuntime);
+  HANDLER(GetScalingRecommendation);
+  HANDLER(DrainWorker);
 #undef HANDLER
 
  private:
@@ -16,12 +16,16 @@ limitations under the License.
 #include "tensorflow/core/data/service/journal.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
@@ -35,6 +39,8 @@ namespace data {
 
 namespace {
 constexpr StringPiece kJournal = "journal";
+constexpr StringPiece kSnapshot = "snapshot";
+constexpr StringPiece kTempFileSuffix = ".tmp";
 
 Status ParseSequenceNumber(const std::string& journal_file,
                            int64_t* sequence_number) {
@@ -44,6 +50,26 @@ Status ParseSequenceNumber(const std::string& journal_file,
   }
   return absl::OkStatus();
 }
+
+// Returns the sequence numbers of the files in `journal_dir` whose names start
+// with `prefix`, ignoring temporary files.
+Status ListSequenceNumbers(Env* env, const std::string& journal_dir,
+                           StringPiece prefix,
+                           std::vector<int64_t>& sequence_numbers) {
+  std::vector<std::string> files;
+  TF_RETURN_IF_ERROR(env->GetChildren(journal_dir, &files));
+  for (const auto& file : files) {
+    if (!absl::StartsWith(file, prefix) ||
+        absl::EndsWith(file, kTempFileSuffix)) {
+      continue;
+    }
+    int64_t sequence_number;
+    TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
+    sequence_numbers.push_back(sequence_number);
+  }
+  std::sort(sequence_numbers.begin(), sequence_numbers.end());
+  return absl::OkStatus();
+}
 }  // namespace
 
 std::string DataServiceJournalFile(const std::string& journal_dir,
@@ -52,6 +78,64 @@ std::string DataServiceJournalFile(const std::string& journal_dir,
                       absl::StrCat(kJournal, "_", sequence_number));
 }
 
+std::string DataServiceJournalSnapshotFile(const std::string& journal_dir,
+                                           int64_t journal_sequence_number) {
+  return io::JoinPath(journal_dir,
+                      absl::StrCat(kSnapshot, "_", journal_sequence_number));
+}
+
+Status WriteJournalSnapshot(Env* env, const std::string& journal_dir,
+                            const DispatcherStateSnapshot& snapshot) {
+  const int64_t journal_sequence_number = snapshot.journal_sequence_number();
+  std::string snapshot_file =
+      DataServiceJournalSnapshotFile(journal_dir, journal_sequence_number);
+  std::string temp_file = absl::StrCat(snapshot_file, kTempFileSuffix);
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_file, snapshot));
+  TF_RETURN_IF_ERROR(env->RenameFile(temp_file, snapshot_file));
+  VLOG(1) << "Wrote dispatcher state snapshot " << snapshot_file;
+
+  // Once the snapshot is committed, recovery no longer reads older journal
+  // files or snapshots.
+  std::vector<int64_t> journal_sequence_numbers, snapshot_sequence_numbers;
+  TF_RETURN_IF_ERROR(ListSequenceNumbers(env, journal_dir, kJournal,
+                                         journal_sequence_numbers));
+  TF_RETURN_IF_ERROR(ListSequenceNumbers(env, journal_dir, kSnapshot,
+                                         snapshot_sequence_numbers));
+  for (int64_t sequence_number : journal_sequence_numbers) {
+    if (sequence_number < journal_sequence_number) {
+      TF_RETURN_IF_ERROR(env->DeleteFile(
+          DataServiceJournalFile(journal_dir, sequence_number)));
+    }
+  }
+  for (int64_t sequence_number : snapshot_sequence_numbers) {
+    if (sequence_number < journal_sequence_number) {
+      TF_RETURN_IF_ERROR(env->DeleteFile(
+          DataServiceJournalSnapshotFile(journal_dir, sequence_number)));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<DispatcherStateSnapshot> ReadLatestJournalSnapshot(
+    Env* env, const std::string& journal_dir) {
+  if (absl::IsNotFound(env->FileExists(journal_dir))) {
+    return errors::NotFound("Journal directory ", journal_dir,
+                            " does not exist.");
+  }
+  std::vector<int64_t> snapshot_sequence_numbers;
+  TF_RETURN_IF_ERROR(ListSequenceNumbers(env, journal_dir, kSnapshot,
+                                         snapshot_sequence_numbers));
+  if (snapshot_sequence_numbers.empty()) {
+    return errors::NotFound("No dispatcher state snapshot in ", journal_dir);
+  }
+  std::string snapshot_file = DataServiceJournalSnapshotFile(
+      journal_dir, snapshot_sequence_numbers.back());
+  DispatcherStateSnapshot snapshot;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(env, snapshot_file, &snapshot));
+  VLOG(1) << "Read dispatcher state snapshot " << snapshot_file;
+  return snapshot;
+}
+
 FileJournalWriter::FileJournalWriter(Env* env, const std::string& journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -59,23 +143,33 @@ Status FileJournalWriter::EnsureInitialized() {
   if (writer_) {
     return absl::OkStatus();
   }
-  std::vector<std::string> journal_files;
   TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(journal_dir_));
-  TF_RETURN_IF_ERROR(env_->GetChildren(journal_dir_, &journal_files));
-  int64_t latest_sequence_number = -1;
-  for (const auto& file : journal_files) {
-    int64_t sequence_number;
-    TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
-    latest_sequence_number = std::max(latest_sequence_number, sequence_number);
-  }
+  std::vector<int64_t> sequence_numbers;
+  TF_RETURN_IF_ERROR(
+      ListSequenceNumbers(env_, journal_dir_, kJournal, sequence_numbers));
+  sequence_number_ = sequence_numbers.empty() ? 0 : sequence_numbers.back() + 1;
+  return OpenFile();
+}
+
+Status FileJournalWriter::OpenFile() {
   std::string journal_file =
-      DataServiceJournalFile(journal_dir_, latest_sequence_number + 1);
+      DataServiceJournalFile(journal_dir_, sequence_number_);
   TF_RETURN_IF_ERROR(env_->NewAppendableFile(journal_file, &file_));
   writer_ = std::make_unique<io::RecordWriter>(file_.get());
   VLOG(1) << "Created journal writer to write to " << journal_file;
   return absl::OkStatus();
 }
 
+absl::StatusOr<int64_t> FileJournalWriter::StartNewFile() {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  TF_RETURN_IF_ERROR(writer_->Close());
+  writer_.reset();
+  TF_RETURN_IF_ERROR(file_->Close());
+  ++sequence_number_;
+  TF_RETURN_IF_ERROR(OpenFile());
+  return sequence_number_;
+}
+
 Status FileJournalWriter::Write(const Update& update) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   std::string s = update.SerializeAsString();
@@ -92,14 +186,17 @@ Status FileJournalWriter::Write(const Update& update) {
   return absl::OkStatus();
 }
 
-FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
-    : env_(env), journal_dir_(journal_dir) {}
+FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir,
+                                     int64_t start_sequence_number)
+    : env_(env),
+      journal_dir_(journal_dir),
+      sequence_number_(start_sequence_number) {}
 
 Status FileJournalReader::EnsureInitialized() {
   if (reader_) {
     return absl::OkStatus();
   }
-  return UpdateFile(DataServiceJournalFile(journal_dir_, 0));
+  return UpdateFile(DataServiceJournalFile(journal_dir_, sequence_number_));
 }
 
 Status FileJournalReader::Read(Update& update, bool& end_of_journal) {
@@ -15,9 +15,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
+#include "absl/status/statusor.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_reader.h"
@@ -31,6 +33,21 @@ namespace data {
 std::string DataServiceJournalFile(const std::string& journal_dir,
                                    int64_t sequence_number);
 
+// Returns the location of the state snapshot within the journal directory
+// which reflects the journal files before `journal_sequence_number`.
+std::string DataServiceJournalSnapshotFile(const std::string& journal_dir,
+                                           int64_t journal_sequence_number);
+
+// Atomically writes `snapshot` to the journal directory, then deletes the
+// journal files and older snapshots which it makes redundant.
+Status WriteJournalSnapshot(Env* env, const std::string& journal_dir,
+                            const DispatcherStateSnapshot& snapshot);
+
+// Reads the latest state snapshot from the journal directory. Returns NotFound
+// if there is no snapshot.
+absl::StatusOr<DispatcherStateSnapshot> ReadLatestJournalSnapshot(
+    Env* env, const std::string& journal_dir);
+
 // Interface for writing to a journal.
 class JournalWriter {
  public:
@@ -39,6 +56,10 @@ class JournalWriter {
   virtual Status Write(const Update& update) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
+  // Closes the current journal file and starts writing to a new one. Returns
+  // the sequence number of the new file: updates written before it are all in
+  // earlier files.
+  virtual absl::StatusOr<int64_t> StartNewFile() = 0;
 };
 
 // FileJournalWriter is not thread-safe, requiring external synchronization when
@@ -57,6 +78,10 @@ class JournalWriter {
 // "journal_0", "journal_1", and "journal_2", the writer will write to
 // "journal_3". The writer will flush updates as they are written, so that they
 // can be stored durably in case of machine failure.
+//
+// The directory may also contain state snapshots, named
+// "snapshot_<sequence number>", which reflect all journal files before the
+// sequence number. See `WriteJournalSnapshot`.
 class FileJournalWriter : public JournalWriter {
  public:
   // Creates a journal writer to write to the given journal directory.
@@ -68,10 +93,15 @@ class FileJournalWriter : public JournalWriter {
 
   Status Write(const Update& update) override;
   Status EnsureInitialized() override;
+  absl::StatusOr<int64_t> StartNewFile() override;
 
  private:
+  // Opens journal file `sequence_number_` for writing.
+  Status OpenFile();
+
   Env* env_;
   const std::string journal_dir_;
+  int64_t sequence_number_ = 0;
   std::unique_ptr<WritableFile> file_;
   std::unique_ptr<io::RecordWriter> writer_;
 };
@@ -88,11 +118,13 @@ class JournalReader {
 // JournalReader is not thread-safe, requiring external synchronization when
 // used by multiple threads.
 //
-// The journal reader reads through all journal files in the configured journal
-// directory, in order of their sequence numbers. See FileJournalWriter above.
+// The journal reader reads through the journal files in the configured journal
+// directory, in order of their sequence numbers, starting from
+// `start_sequence_number`. See FileJournalWriter above.
 class FileJournalReader : public JournalReader {
  public:
-  explicit FileJournalReader(Env* env, StringPiece journal_dir);
+  explicit FileJournalReader(Env* env, StringPiece journal_dir,
+                             int64_t start_sequence_number = 0);
   FileJournalReader(const FileJournalReader&) = delete;
   FileJournalReader& operator=(const FileJournalReader&) = delete;
 
@@ -107,7 +139,7 @@ class FileJournalReader : public JournalReader {
   Env* env_;
   const std::string journal_dir_;
   // Sequence number of current journal file.
-  int64_t sequence_number_ = 0;
+  int64_t sequence_number_;
   std::unique_ptr<RandomAccessFile> file_;
   std::unique_ptr<io::SequentialRecordReader> reader_;
 };
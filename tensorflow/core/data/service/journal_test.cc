@@ -14,12 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/journal.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -33,6 +35,7 @@ namespace data {
 
 namespace {
 using ::testing::HasSubstr;
+using ::testing::UnorderedElementsAre;
 
 bool NewJournalDir(std::string& journal_dir) {
   std::string filename = testing::TmpDir();
@@ -68,8 +71,9 @@ Update MakeRegisterDatasetUpdate() {
 }
 
 Status CheckJournalContent(StringPiece journal_dir,
-                           const std::vector<Update>& expected) {
-  FileJournalReader reader(Env::Default(), journal_dir);
+                           const std::vector<Update>& expected,
+                           int64_t start_sequence_number = 0) {
+  FileJournalReader reader(Env::Default(), journal_dir, start_sequence_number);
   for (const auto& update : expected) {
     Update result;
     bool end_of_journal = true;
@@ -115,6 +119,100 @@ TEST(Journal, AppendExistingJournal) {
   TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
 }
 
+TEST(Journal, StartNewFile) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.Write(MakeCreateIterationUpdate()));
+  absl::StatusOr<int64_t> sequence_number = writer.StartNewFile();
+  TF_ASSERT_OK(sequence_number.status());
+  EXPECT_EQ(*sequence_number, 1);
+  TF_EXPECT_OK(writer.Write(MakeRegisterDatasetUpdate()));
+
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeCreateIterationUpdate(), MakeRegisterDatasetUpdate()}));
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, {MakeRegisterDatasetUpdate()},
+                                   /*start_sequence_number=*/1));
+}
+
+TEST(Journal, WriteSnapshot) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.Write(MakeCreateIterationUpdate()));
+  absl::StatusOr<int64_t> sequence_number = writer.StartNewFile();
+  TF_ASSERT_OK(sequence_number.status());
+  DispatcherStateSnapshot snapshot;
+  snapshot.set_journal_sequence_number(*sequence_number);
+  *snapshot.add_updates() = MakeCreateIterationUpdate();
+  TF_ASSERT_OK(WriteJournalSnapshot(Env::Default(), journal_dir, snapshot));
+  TF_EXPECT_OK(writer.Write(MakeFinishTaskUpdate()));
+
+  // The journal file reflected in the snapshot is deleted.
+  EXPECT_TRUE(absl::IsNotFound(Env::Default()->FileExists(
+      DataServiceJournalFile(journal_dir, /*sequence_number=*/0))));
+  absl::StatusOr<DispatcherStateSnapshot> latest_snapshot =
+      ReadLatestJournalSnapshot(Env::Default(), journal_dir);
+  TF_ASSERT_OK(latest_snapshot.status());
+  EXPECT_EQ(latest_snapshot->SerializeAsString(), snapshot.SerializeAsString());
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, {MakeFinishTaskUpdate()},
+                                   latest_snapshot->journal_sequence_number()));
+}
+
+TEST(Journal, WriteMultipleSnapshots) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  for (int64_t i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(writer.Write(MakeCreateIterationUpdate()));
+    absl::StatusOr<int64_t> sequence_number = writer.StartNewFile();
+    TF_ASSERT_OK(sequence_number.status());
+    DispatcherStateSnapshot snapshot;
+    snapshot.set_journal_sequence_number(*sequence_number);
+    TF_ASSERT_OK(WriteJournalSnapshot(Env::Default(), journal_dir, snapshot));
+  }
+
+  absl::StatusOr<DispatcherStateSnapshot> latest_snapshot =
+      ReadLatestJournalSnapshot(Env::Default(), journal_dir);
+  TF_ASSERT_OK(latest_snapshot.status());
+  EXPECT_EQ(latest_snapshot->journal_sequence_number(), 3);
+  std::vector<std::string> files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(journal_dir, &files));
+  EXPECT_THAT(files, UnorderedElementsAre("journal_3", "snapshot_3"));
+}
+
+TEST(Journal, AppendAfterSnapshot) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    TF_EXPECT_OK(writer.Write(MakeCreateIterationUpdate()));
+    absl::StatusOr<int64_t> sequence_number = writer.StartNewFile();
+    TF_ASSERT_OK(sequence_number.status());
+    DispatcherStateSnapshot snapshot;
+    snapshot.set_journal_sequence_number(*sequence_number);
+    TF_ASSERT_OK(WriteJournalSnapshot(Env::Default(), journal_dir, snapshot));
+    TF_EXPECT_OK(writer.Write(MakeRegisterDatasetUpdate()));
+  }
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.Write(MakeFinishTaskUpdate()));
+
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeRegisterDatasetUpdate(), MakeFinishTaskUpdate()},
+      /*start_sequence_number=*/1));
+}
+
+TEST(Journal, NoSnapshot) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  EXPECT_TRUE(absl::IsNotFound(
+      ReadLatestJournalSnapshot(Env::Default(), journal_dir).status()));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.Write(MakeCreateIterationUpdate()));
+  EXPECT_TRUE(absl::IsNotFound(
+      ReadLatestJournalSnapshot(Env::Default(), journal_dir).status()));
+}
+
 TEST(Journal, MissingFile) {
   std::string journal_dir;
   EXPECT_TRUE(NewJournalDir(journal_dir));
@@ -0,0 +1,85 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/scaling_recommender.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "absl/time/time.h"
+
+namespace tensorflow {
+namespace data {
+
+ScalingRecommender::ScalingRecommender(absl::Duration scale_down_delay,
+                                       double scale_down_tolerance)
+    : scale_down_delay_(scale_down_delay),
+      scale_down_tolerance_(scale_down_tolerance) {}
+
+int64_t ScalingRecommender::Recommend(
+    int64_t current_number_of_workers,
+    std::optional<int64_t> optimal_number_of_workers, absl::Time now) {
+  if (current_number_of_workers != last_number_of_workers_) {
+    // The previous estimates were made for another number of workers.
+    scale_down_since_.reset();
+    last_number_of_workers_ = current_number_of_workers;
+  }
+  if (!optimal_number_of_workers.has_value()) {
+    scale_down_since_.reset();
+    return current_number_of_workers;
+  }
+  const int64_t optimal = std::max<int64_t>(*optimal_number_of_workers, 1);
+  if (optimal >= current_number_of_workers) {
+    scale_down_since_.reset();
+    return optimal;
+  }
+  if (optimal >
+      (1.0 - scale_down_tolerance_) * current_number_of_workers) {
+    scale_down_since_.reset();
+    return current_number_of_workers;
+  }
+  if (!scale_down_since_.has_value()) {
+    scale_down_since_ = now;
+    max_scale_down_estimate_ = optimal;
+  }
+  max_scale_down_estimate_ = std::max(max_scale_down_estimate_, optimal);
+  if (now - *scale_down_since_ < scale_down_delay_) {
+    return current_number_of_workers;
+  }
+  return max_scale_down_estimate_;
+}
+
+std::vector<std::string> CheapestWorkersToRemove(
+    std::vector<WorkerRemovalCost> costs, int64_t number_of_workers) {
+  std::sort(costs.begin(), costs.end(),
+            [](const WorkerRemovalCost& a, const WorkerRemovalCost& b) {
+              return std::tie(a.num_split_reading_tasks,
+                              a.outstanding_requests, a.worker_address) <
+                     std::tie(b.num_split_reading_tasks,
+                              b.outstanding_requests, b.worker_address);
+            });
+  std::vector<std::string> workers;
+  for (int64_t i = 0; i < costs.size() && i < number_of_workers; ++i) {
+    workers.push_back(costs[i].worker_address);
+  }
+  return workers;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,87 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SCALING_RECOMMENDER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SCALING_RECOMMENDER_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+
+namespace tensorflow {
+namespace data {
+
+// Turns the estimates of `MultipleIterationsAutoScaler` into recommendations
+// of the number of workers that a cluster controller can act on.
+//
+// Scaling up is recommended as soon as the estimate exceeds the current number
+// of workers. Scaling down is only recommended once the estimate has stayed
+// below `1 - scale_down_tolerance` times the current number of workers for
+// `scale_down_delay`, and then to the largest estimate seen in that time, so
+// that short drops in the workload don't make workers be removed and added
+// back.
+//
+// ScalingRecommender is not thread-safe.
+class ScalingRecommender {
+ public:
+  static constexpr double kDefaultScaleDownTolerance = 0.1;
+
+  explicit ScalingRecommender(
+      absl::Duration scale_down_delay,
+      double scale_down_tolerance = kDefaultScaleDownTolerance);
+
+  // Returns the recommended number of workers at `now`, when
+  // `current_number_of_workers` workers are running and the optimal number of
+  // workers is estimated as `optimal_number_of_workers`. Without an estimate,
+  // recommends keeping the current number of workers.
+  int64_t Recommend(int64_t current_number_of_workers,
+                    std::optional<int64_t> optimal_number_of_workers,
+                    absl::Time now);
+
+ private:
+  const absl::Duration scale_down_delay_;
+  const double scale_down_tolerance_;
+  // The number of workers when the last recommendation was made.
+  int64_t last_number_of_workers_ = -1;
+  // Since when the estimates have been low enough to scale down, if they are.
+  std::optional<absl::Time> scale_down_since_;
+  // The largest estimate since `scale_down_since_`.
+  int64_t max_scale_down_estimate_ = 0;
+};
+
+// What removing a worker would cost.
+struct WorkerRemovalCost {
+  std::string worker_address;
+  // The number of unfinished tasks of the worker that read splits from the
+  // dispatcher. They need to run to completion before the worker can be
+  // removed without losing splits.
+  int64_t num_split_reading_tasks = 0;
+  // The number of `GetElement` requests the worker is serving.
+  int64_t outstanding_requests = 0;
+};
+
+// Returns the addresses of the `number_of_workers` workers in `costs` which are
+// cheapest to remove: those with the fewest split reading tasks, then the
+// fewest outstanding requests.
+std::vector<std::string> CheapestWorkersToRemove(
+    std::vector<WorkerRemovalCost> costs, int64_t number_of_workers);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SCALING_RECOMMENDER_H_
@@ -0,0 +1,95 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/scaling_recommender.h"
+
+#include <optional>
+
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+constexpr absl::Duration kScaleDownDelay = absl::Minutes(10);
+
+TEST(ScalingRecommenderTest, NoEstimate) {
+  ScalingRecommender recommender(kScaleDownDelay);
+  EXPECT_EQ(recommender.Recommend(10, std::nullopt, absl::UnixEpoch()), 10);
+}
+
+TEST(ScalingRecommenderTest, ScalesUpImmediately) {
+  ScalingRecommender recommender(kScaleDownDelay);
+  EXPECT_EQ(recommender.Recommend(10, 15, absl::UnixEpoch()), 15);
+}
+
+TEST(ScalingRecommenderTest, IgnoresSmallDrops) {
+  ScalingRecommender recommender(kScaleDownDelay);
+  const absl::Time start = absl::UnixEpoch();
+  EXPECT_EQ(recommender.Recommend(10, 10, start), 10);
+  EXPECT_EQ(recommender.Recommend(10, 10, start + kScaleDownDelay), 10);
+  EXPECT_EQ(recommender.Recommend(10, 10, start + 2 * kScaleDownDelay), 10);
+}
+
+TEST(ScalingRecommenderTest, ScalesDownAfterDelay) {
+  ScalingRecommender recommender(kScaleDownDelay);
+  const absl::Time start = absl::UnixEpoch();
+  EXPECT_EQ(recommender.Recommend(10, 5, start), 10);
+  EXPECT_EQ(recommender.Recommend(10, 7, start + kScaleDownDelay / 2), 10);
+  EXPECT_EQ(recommender.Recommend(10, 4, start + kScaleDownDelay), 7);
+}
+
+TEST(ScalingRecommenderTest, HigherEstimateRestartsDelay) {
+  ScalingRecommender recommender(kScaleDownDelay);
+  const absl::Time start = absl::UnixEpoch();
+  EXPECT_EQ(recommender.Recommend(10, 5, start), 10);
+  EXPECT_EQ(recommender.Recommend(10, 10, start + kScaleDownDelay / 2), 10);
+  EXPECT_EQ(recommender.Recommend(10, 5, start + kScaleDownDelay), 10);
+  EXPECT_EQ(recommender.Recommend(10, 5, start + 2 * kScaleDownDelay), 5);
+}
+
+TEST(ScalingRecommenderTest, NewNumberOfWorkersRestartsDelay) {
+  ScalingRecommender recommender(kScaleDownDelay);
+  const absl::Time start = absl::UnixEpoch();
+  EXPECT_EQ(recommender.Recommend(10, 5, start), 10);
+  EXPECT_EQ(recommender.Recommend(10, 5, start + kScaleDownDelay), 5);
+  EXPECT_EQ(recommender.Recommend(5, 2, start + kScaleDownDelay), 5);
+  EXPECT_EQ(recommender.Recommend(5, 2, start + 2 * kScaleDownDelay), 2);
+}
+
+TEST(CheapestWorkersToRemoveTest, PrefersWorkersWithoutSplits) {
+  EXPECT_THAT(CheapestWorkersToRemove({{"a", /*num_split_reading_tasks=*/1,
+                                        /*outstanding_requests=*/0},
+                                       {"b", 0, 5},
+                                       {"c", 0, 2},
+                                       {"d", 2, 0}},
+                                      /*number_of_workers=*/3),
+              ElementsAre("c", "b", "a"));
+}
+
+TEST(CheapestWorkersToRemoveTest, FewerWorkersThanRequested) {
+  EXPECT_THAT(CheapestWorkersToRemove({{"a", 0, 0}}, /*number_of_workers=*/2),
+              ElementsAre("a"));
+  EXPECT_THAT(CheapestWorkersToRemove({{"a", 0, 0}}, /*number_of_workers=*/0),
+              IsEmpty());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
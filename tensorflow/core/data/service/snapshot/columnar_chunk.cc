@@ -0,0 +1,531 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
+#include "tensorflow/core/util/batch_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/tstring.h"
+#include "zstd.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Favors decompression speed: higher levels compress snapshots little more
+// and are much slower to write.
+constexpr int kZstdCompressionLevel = 3;
+
+// The decompressed tensors of one column of a block.
+struct DecodedColumn {
+  // Set if all the tensors of the column have the same shape and are not
+  // serialized: the column decompressed into one tensor batching the elements.
+  std::optional<Tensor> batch;
+  // Otherwise, the tensors of each element.
+  std::vector<Tensor> elements;
+};
+
+// Parses the tensors of a serialized column.
+absl::Status ParseSerializedColumn(absl::string_view data, DataType dtype,
+                                   int64_t num_elements,
+                                   DecodedColumn& column) {
+  column.elements.reserve(num_elements);
+  for (int64_t i = 0; i < num_elements; ++i) {
+    uint64_t size = 0;
+    if (!core::GetVarint64(&data, &size) || size > data.size()) {
+      return absl::DataLossError(absl::StrCat(
+          "Truncated serialized tensor ", i, " in columnar snapshot block."));
+    }
+    TensorProto proto;
+    if (!proto.ParseFromArray(data.data(), size)) {
+      return absl::DataLossError(absl::StrCat(
+          "Failed to parse tensor ", i, " in columnar snapshot block."));
+    }
+    data.remove_prefix(size);
+    Tensor tensor;
+    if (!tensor.FromProto(proto) || tensor.dtype() != dtype) {
+      return absl::DataLossError(absl::StrCat(
+          "Invalid tensor ", i, " in columnar snapshot block: expected dtype ",
+          DataTypeString(dtype), ", got ", proto.ShortDebugString()));
+    }
+    column.elements.push_back(std::move(tensor));
+  }
+  return absl::OkStatus();
+}
+
+// Splits the tensors of a memcpy-able column whose elements have different
+// shapes.
+absl::Status SplitColumn(absl::string_view data,
+                         const ColumnarBlockHeader::Column& header,
+                         int64_t num_elements, DecodedColumn& column) {
+  if (header.shapes_size() != num_elements) {
+    return absl::DataLossError(absl::StrCat(
+        "Expected ", num_elements, " shapes in columnar snapshot block, got ",
+        header.shapes_size()));
+  }
+  column.elements.reserve(num_elements);
+  for (int64_t i = 0; i < num_elements; ++i) {
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(header.shapes(i), &shape));
+    Tensor tensor(header.dtype(), shape);
+    const size_t size = tensor.TotalBytes();
+    if (size > data.size()) {
+      return absl::DataLossError(absl::StrCat(
+          "Truncated tensor ", i, " in columnar snapshot block."));
+    }
+    std::memcpy(const_cast<char*>(tensor.tensor_data().data()), data.data(),
+                size);
+    data.remove_prefix(size);
+    column.elements.push_back(std::move(tensor));
+  }
+  return absl::OkStatus();
+}
+
+// Decompresses `compressed`, the column described by `header`, of a block with
+// `num_elements` elements.
+absl::Status DecodeColumn(absl::string_view compressed,
+                          const ColumnarBlockHeader::Column& header,
+                          int64_t num_elements, DecodedColumn& column) {
+  auto decompress = [&](char* dst, size_t size) -> absl::Status {
+    const size_t decompressed_size =
+        ZSTD_decompress(dst, size, compressed.data(), compressed.size());
+    if (ZSTD_isError(decompressed_size)) {
+      return absl::DataLossError(
+          absl::StrCat("Failed to decompress columnar snapshot block: ",
+                       ZSTD_getErrorName(decompressed_size)));
+    }
+    if (decompressed_size != size) {
+      return absl::DataLossError(absl::StrCat(
+          "Expected ", size, " bytes in columnar snapshot block column, got ",
+          decompressed_size));
+    }
+    return absl::OkStatus();
+  };
+
+  if (!header.serialized() && header.shapes_size() == 1) {
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(header.shapes(0), &shape));
+    TF_RETURN_IF_ERROR(shape.InsertDimWithStatus(0, num_elements));
+    Tensor batch(header.dtype(), shape);
+    if (batch.TotalBytes() != header.uncompressed_size()) {
+      return absl::DataLossError(absl::StrCat(
+          "Expected ", batch.TotalBytes(), " bytes for ", num_elements,
+          " tensors of shape ", header.shapes(0).ShortDebugString(),
+          " in columnar snapshot block, got ", header.uncompressed_size()));
+    }
+    TF_RETURN_IF_ERROR(decompress(
+        const_cast<char*>(batch.tensor_data().data()), batch.TotalBytes()));
+    column.batch = std::move(batch);
+    return absl::OkStatus();
+  }
+
+  std::string data(header.uncompressed_size(), '\0');
+  TF_RETURN_IF_ERROR(decompress(data.data(), data.size()));
+  if (header.serialized()) {
+    return ParseSerializedColumn(data, header.dtype(), num_elements, column);
+  }
+  return SplitColumn(data, header, num_elements, column);
+}
+
+}  // namespace
+
+std::string TFRecordCompression(const std::string& compression) {
+  // Checkpoints are small next to chunks, so they keep the TFRecord format.
+  if (compression == kColumnarZstdCompression) {
+    return io::compression::kSnappy;
+  }
+  return compression;
+}
+
+ColumnarChunkWriter::ColumnarChunkWriter(const std::string& filename,
+                                         int64_t max_block_elements,
+                                         ByteSize max_block_size)
+    : filename_(filename),
+      max_block_elements_(max_block_elements),
+      max_block_size_(max_block_size) {}
+
+ColumnarChunkWriter::~ColumnarChunkWriter() {
+  absl::Status status = Close();
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to close columnar snapshot chunk " << filename_
+               << ": " << status;
+  }
+}
+
+absl::Status ColumnarChunkWriter::Initialize(tsl::Env* env) {
+  TF_RETURN_IF_ERROR(env->NewAppendableFile(filename_, &file_));
+  record_writer_ = std::make_unique<io::RecordWriter>(
+      file_.get(), io::RecordWriterOptions::CreateRecordWriterOptions(
+                       /*compression_type=*/io::compression::kNone));
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkWriter::WriteTensors(
+    const std::vector<Tensor>& tensors) {
+  if (columns_.empty()) {
+    columns_.resize(tensors.size());
+    for (int64_t i = 0; i < tensors.size(); ++i) {
+      columns_[i].dtype = tensors[i].dtype();
+      columns_[i].serialized = !DataTypeCanUseMemcpy(tensors[i].dtype());
+    }
+  }
+  if (tensors.size() != columns_.size()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Failed to write to columnar snapshot chunk ", filename_, ": expected ",
+        columns_.size(), " components, got ", tensors.size(), "."));
+  }
+
+  for (int64_t i = 0; i < tensors.size(); ++i) {
+    const Tensor& tensor = tensors[i];
+    Column& column = columns_[i];
+    if (tensor.dtype() != column.dtype) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Failed to write to columnar snapshot chunk ", filename_,
+          ": expected component ", i, " to have dtype ",
+          DataTypeString(column.dtype), ", got ",
+          DataTypeString(tensor.dtype()), "."));
+    }
+    const size_t column_size = column.data.size();
+    column.shapes.push_back(tensor.shape());
+    if (column.serialized) {
+      TensorProto proto;
+      tensor.AsProtoTensorContent(&proto);
+      core::PutVarint64(&column.data, proto.ByteSizeLong());
+      if (!proto.AppendToString(&column.data)) {
+        return absl::DataLossError(absl::StrCat(
+            "Failed to serialize tensor proto of size ", proto.ByteSizeLong(),
+            " for columnar snapshot chunk ", filename_, "."));
+      }
+    } else {
+      const absl::string_view data = tensor.tensor_data();
+      column.data.append(data.data(), data.size());
+    }
+    block_size_ += ByteSize::Bytes(column.data.size() - column_size);
+  }
+
+  ++num_elements_;
+  if (num_elements_ >= max_block_elements_ || block_size_ >= max_block_size_) {
+    return WriteBlock();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkWriter::WriteBlock() {
+  if (num_elements_ == 0) {
+    return absl::OkStatus();
+  }
+  ColumnarBlockHeader header;
+  header.set_num_elements(num_elements_);
+  std::string columns;
+  for (Column& column : columns_) {
+    ColumnarBlockHeader::Column* column_header = header.add_columns();
+    column_header->set_dtype(column.dtype);
+    column_header->set_serialized(column.serialized);
+    const bool uniform_shapes =
+        std::all_of(column.shapes.begin(), column.shapes.end(),
+                    [&](const TensorShape& shape) {
+                      return shape == column.shapes.front();
+                    });
+    if (uniform_shapes) {
+      column.shapes.front().AsProto(column_header->add_shapes());
+    } else {
+      for (const TensorShape& shape : column.shapes) {
+        shape.AsProto(column_header->add_shapes());
+      }
+    }
+
+    const size_t offset = columns.size();
+    columns.resize(offset + ZSTD_compressBound(column.data.size()));
+    const size_t compressed_size =
+        ZSTD_compress(columns.data() + offset, columns.size() - offset,
+                      column.data.data(), column.data.size(),
+                      kZstdCompressionLevel);
+    if (ZSTD_isError(compressed_size)) {
+      return absl::InternalError(absl::StrCat(
+          "Failed to compress columnar snapshot block for ", filename_, ": ",
+          ZSTD_getErrorName(compressed_size)));
+    }
+    columns.resize(offset + compressed_size);
+    column_header->set_compressed_size(compressed_size);
+    column_header->set_uncompressed_size(column.data.size());
+    column.shapes.clear();
+    column.data.clear();
+  }
+
+  std::string record;
+  core::PutVarint64(&record, header.ByteSizeLong());
+  header.AppendToString(&record);
+  record.append(columns);
+  TF_RETURN_IF_ERROR(record_writer_->WriteRecord(record));
+  num_elements_ = 0;
+  block_size_ = ByteSize::Bytes(0);
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkWriter::Sync() {
+  TF_RETURN_IF_ERROR(WriteBlock());
+  TF_RETURN_IF_ERROR(record_writer_->Flush());
+  return file_->Flush();
+}
+
+absl::Status ColumnarChunkWriter::Close() {
+  if (record_writer_ != nullptr) {
+    TF_RETURN_IF_ERROR(Sync());
+    TF_RETURN_IF_ERROR(record_writer_->Close());
+    TF_RETURN_IF_ERROR(file_->Close());
+    record_writer_ = nullptr;
+    file_ = nullptr;
+  }
+  return absl::OkStatus();
+}
+
+struct ColumnarChunkReader::Block {
+  tstring record;
+  ColumnarBlockHeader header;
+  // The compressed data of each column, pointing into `record`.
+  std::vector<absl::string_view> compressed_columns;
+  std::vector<DecodedColumn> columns;
+
+  absl::Mutex mu;
+  int64_t num_pending_columns ABSL_GUARDED_BY(mu) = 0;
+  absl::Status status ABSL_GUARDED_BY(mu);
+
+  // Waits until the columns are decompressed.
+  absl::Status Wait() {
+    absl::MutexLock l(&mu);
+    mu.Await(absl::Condition(
+        +[](int64_t* num_pending_columns) { return *num_pending_columns == 0; },
+        &num_pending_columns));
+    return status;
+  }
+};
+
+ColumnarChunkReader::ColumnarChunkReader(const std::string& filename,
+                                         const DataTypeVector& dtypes,
+                                         Runner runner,
+                                         int64_t num_prefetched_blocks)
+    : filename_(filename),
+      dtypes_(dtypes),
+      runner_(std::move(runner)),
+      num_prefetched_blocks_(std::max<int64_t>(num_prefetched_blocks, 0)) {}
+
+absl::Status ColumnarChunkReader::Initialize(tsl::Env* env) {
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename_, &file_));
+  record_reader_ = std::make_unique<io::RecordReader>(
+      file_.get(), io::RecordReaderOptions::CreateRecordReaderOptions(
+                       /*compression_type=*/io::compression::kNone));
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::shared_ptr<ColumnarChunkReader::Block>>
+ColumnarChunkReader::ReadBlock(bool decompress) {
+  auto block = std::make_shared<Block>();
+  absl::Status status = record_reader_->ReadRecord(&offset_, &block->record);
+  if (absl::IsOutOfRange(status)) {
+    return nullptr;
+  }
+  TF_RETURN_IF_ERROR(status);
+
+  absl::string_view data = block->record;
+  uint64_t header_size = 0;
+  if (!core::GetVarint64(&data, &header_size) || header_size > data.size() ||
+      !block->header.ParseFromArray(data.data(), header_size)) {
+    return absl::DataLossError(absl::StrCat(
+        "Failed to parse columnar snapshot block header in ", filename_,
+        " before offset ", offset_, "."));
+  }
+  data.remove_prefix(header_size);
+  if (block->header.columns_size() != dtypes_.size()) {
+    return absl::DataLossError(absl::StrCat(
+        "Expected ", dtypes_.size(), " components in columnar snapshot chunk ",
+        filename_, ", got ", block->header.columns_size(), "."));
+  }
+  for (int64_t i = 0; i < dtypes_.size(); ++i) {
+    const ColumnarBlockHeader::Column& column = block->header.columns(i);
+    if (column.dtype() != dtypes_[i]) {
+      return absl::DataLossError(absl::StrCat(
+          "Expected component ", i, " of columnar snapshot chunk ", filename_,
+          " to have dtype ", DataTypeString(dtypes_[i]), ", got ",
+          DataTypeString(column.dtype()), "."));
+    }
+    if (column.compressed_size() > data.size()) {
+      return absl::DataLossError(
+          absl::StrCat("Truncated columnar snapshot block in ", filename_,
+                       " before offset ", offset_, "."));
+    }
+    block->compressed_columns.push_back(
+        data.substr(0, column.compressed_size()));
+    data.remove_prefix(column.compressed_size());
+  }
+
+  if (decompress) {
+    Decompress(block);
+  }
+  return block;
+}
+
+void ColumnarChunkReader::Decompress(std::shared_ptr<Block> block) {
+  const int64_t num_columns = block->compressed_columns.size();
+  block->columns.resize(num_columns);
+  {
+    absl::MutexLock l(&block->mu);
+    block->num_pending_columns = num_columns;
+  }
+  for (int64_t i = 0; i < num_columns; ++i) {
+    runner_([block, i]() {
+      absl::Status status =
+          DecodeColumn(block->compressed_columns[i], block->header.columns(i),
+                       block->header.num_elements(), block->columns[i]);
+      absl::MutexLock l(&block->mu);
+      block->status.Update(status);
+      --block->num_pending_columns;
+    });
+  }
+}
+
+absl::Status ColumnarChunkReader::Prefetch() {
+  while (!end_of_file_ && prefetched_blocks_.size() < num_prefetched_blocks_) {
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<Block> block,
+                        ReadBlock(/*decompress=*/true));
+    if (block == nullptr) {
+      end_of_file_ = true;
+      break;
+    }
+    prefetched_blocks_.push_back(std::move(block));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> ColumnarChunkReader::NextBlock() {
+  do {
+    if (prefetched_blocks_.empty()) {
+      if (end_of_file_) {
+        block_ = nullptr;
+        return false;
+      }
+      TF_ASSIGN_OR_RETURN(block_, ReadBlock(/*decompress=*/true));
+      if (block_ == nullptr) {
+        end_of_file_ = true;
+        return false;
+      }
+    } else {
+      block_ = std::move(prefetched_blocks_.front());
+      prefetched_blocks_.pop_front();
+    }
+    element_index_ = 0;
+    // Reads the next blocks while this one is being decompressed.
+    TF_RETURN_IF_ERROR(Prefetch());
+    TF_RETURN_IF_ERROR(block_->Wait());
+  } while (block_->header.num_elements() == 0);
+  return true;
+}
+
+absl::Status ColumnarChunkReader::ReadTensors(
+    std::vector<Tensor>* read_tensors) {
+  while (block_ == nullptr ||
+         element_index_ >= block_->header.num_elements()) {
+    TF_ASSIGN_OR_RETURN(bool has_block, NextBlock());
+    if (!has_block) {
+      return absl::OutOfRangeError(absl::StrCat(
+          "Reached the end of columnar snapshot chunk ", filename_, "."));
+    }
+  }
+
+  read_tensors->clear();
+  read_tensors->reserve(block_->columns.size());
+  for (int64_t i = 0; i < block_->columns.size(); ++i) {
+    DecodedColumn& column = block_->columns[i];
+    if (!column.batch.has_value()) {
+      read_tensors->push_back(std::move(column.elements[element_index_]));
+      continue;
+    }
+    TensorShape shape = column.batch->shape();
+    shape.RemoveDim(0);
+    Tensor tensor(column.batch->dtype(), shape);
+    TF_RETURN_IF_ERROR(
+        batch_util::CopySliceToElement(*column.batch, &tensor, element_index_));
+    read_tensors->push_back(std::move(tensor));
+  }
+  ++element_index_;
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkReader::SkipRecords(int64_t num_records) {
+  while (num_records > 0) {
+    if (block_ != nullptr && element_index_ < block_->header.num_elements()) {
+      const int64_t num_skipped = std::min<int64_t>(
+          num_records, block_->header.num_elements() - element_index_);
+      element_index_ += num_skipped;
+      num_records -= num_skipped;
+      continue;
+    }
+    if (!prefetched_blocks_.empty() || end_of_file_) {
+      TF_ASSIGN_OR_RETURN(bool has_block, NextBlock());
+      if (!has_block) {
+        return absl::OutOfRangeError(absl::StrCat(
+            "Reached the end of columnar snapshot chunk ", filename_, "."));
+      }
+      continue;
+    }
+
+    // Skips whole blocks by only parsing their headers.
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<Block> block,
+                        ReadBlock(/*decompress=*/false));
+    if (block == nullptr) {
+      end_of_file_ = true;
+      continue;
+    }
+    if (block->header.num_elements() <= num_records) {
+      num_records -= block->header.num_elements();
+      continue;
+    }
+    Decompress(block);
+    TF_RETURN_IF_ERROR(block->Wait());
+    block_ = std::move(block);
+    element_index_ = num_records;
+    num_records = 0;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,153 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COLUMNAR_CHUNK_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COLUMNAR_CHUNK_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tsl/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+
+// The snapshot compression which writes chunks in the columnar format.
+//
+// A columnar chunk is a TFRecord file of blocks. Each block holds many
+// elements, stored component by component: all the tensors of a component are
+// concatenated into a column, which is compressed with zstd. Reading a block
+// decompresses each column, in parallel, straight into one tensor batching the
+// component, instead of decompressing and parsing each element on its own.
+constexpr const char kColumnarZstdCompression[] = "COLUMNAR_ZSTD";
+
+// Returns the compression of the TFRecord files other than chunks, such as
+// checkpoints, for snapshots with `compression`.
+std::string TFRecordCompression(const std::string& compression);
+
+// Writes elements to a columnar chunk.
+class ColumnarChunkWriter : public snapshot_util::Writer {
+ public:
+  static constexpr int64_t kDefaultMaxBlockElements = 1024;
+  static constexpr ByteSize kDefaultMaxBlockSize = ByteSize::MB(16);
+
+  // Blocks hold up to `max_block_elements` elements, and are written once they
+  // reach `max_block_size` before compression.
+  explicit ColumnarChunkWriter(
+      const std::string& filename,
+      int64_t max_block_elements = kDefaultMaxBlockElements,
+      ByteSize max_block_size = kDefaultMaxBlockSize);
+
+  absl::Status Initialize(tsl::Env* env) override;
+  absl::Status WriteTensors(const std::vector<Tensor>& tensors) override;
+  absl::Status Sync() override;
+  absl::Status Close() override;
+  ~ColumnarChunkWriter() override;
+
+ private:
+  // The tensors of one component of the buffered elements.
+  struct Column {
+    DataType dtype = DT_INVALID;
+    bool serialized = false;
+    std::vector<TensorShape> shapes;
+    std::string data;
+  };
+
+  // Compresses and writes the buffered elements as a block.
+  absl::Status WriteBlock();
+
+  const std::string filename_;
+  const int64_t max_block_elements_;
+  const ByteSize max_block_size_;
+  std::unique_ptr<tsl::WritableFile> file_;
+  std::unique_ptr<io::RecordWriter> record_writer_;
+  std::vector<Column> columns_;
+  int64_t num_elements_ = 0;
+  ByteSize block_size_;
+};
+
+// Reads elements from a columnar chunk. Blocks are read ahead of the elements
+// returned, and their columns are decompressed in parallel by `runner`.
+class ColumnarChunkReader : public snapshot_util::Reader {
+ public:
+  using Runner = std::function<void(std::function<void()>)>;
+
+  static constexpr int64_t kDefaultNumPrefetchedBlocks = 2;
+
+  // Reads up to `num_prefetched_blocks` blocks ahead of the current one.
+  ColumnarChunkReader(
+      const std::string& filename, const DataTypeVector& dtypes, Runner runner,
+      int64_t num_prefetched_blocks = kDefaultNumPrefetchedBlocks);
+
+  absl::Status Initialize(tsl::Env* env) override;
+
+  // Reads the tensors of the next element into `read_tensors`. Returns
+  // OutOfRange at the end of the file.
+  absl::Status ReadTensors(std::vector<Tensor>* read_tensors) override;
+
+  // Skips `num_records` elements, without decompressing the blocks skipped
+  // entirely.
+  absl::Status SkipRecords(int64_t num_records) override;
+
+  // Returns the number of bytes read from the file.
+  uint64_t BytesRead() const { return offset_; }
+
+ private:
+  struct Block;
+
+  // Reads the next block of the file, and starts decompressing it if
+  // `decompress` is true. Returns nullptr at the end of the file.
+  absl::StatusOr<std::shared_ptr<Block>> ReadBlock(bool decompress);
+
+  // Decompresses the columns of `block` in parallel.
+  void Decompress(std::shared_ptr<Block> block);
+
+  // Reads blocks until `num_prefetched_blocks_` are buffered.
+  absl::Status Prefetch();
+
+  // Moves to the next block with elements. Returns false at the end of the
+  // file.
+  absl::StatusOr<bool> NextBlock();
+
+  const std::string filename_;
+  const DataTypeVector dtypes_;
+  const Runner runner_;
+  const int64_t num_prefetched_blocks_;
+  std::unique_ptr<tsl::RandomAccessFile> file_;
+  std::unique_ptr<io::RecordReader> record_reader_;
+  uint64_t offset_ = 0;
+  bool end_of_file_ = false;
+
+  std::deque<std::shared_ptr<Block>> prefetched_blocks_;
+  std::shared_ptr<Block> block_;
+  // The index of the next element of `block_`.
+  int64_t element_index_ = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COLUMNAR_CHUNK_H_
@@ -0,0 +1,227 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/lib/io/compression.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tsl::testing::StatusIs;
+
+absl::StatusOr<std::string> TestFile() {
+  std::string test_file;
+  if (!tsl::Env::Default()->LocalTempFilename(&test_file)) {
+    return absl::FailedPreconditionError("Failed to create local temp file.");
+  }
+  return test_file;
+}
+
+void RunInline(std::function<void()> fn) { fn(); }
+
+// Returns element `i`: a scalar, a vector whose size depends on `i`, and a
+// string.
+std::vector<Tensor> Element(int64_t i) {
+  Tensor vector(DT_FLOAT, TensorShape({i % 3}));
+  for (int64_t j = 0; j < i % 3; ++j) {
+    vector.vec<float>()(j) = i + j / 10.0;
+  }
+  return {Tensor(i), std::move(vector), Tensor(tstring(absl::StrCat("e", i)))};
+}
+
+const DataTypeVector& ElementDtypes() {
+  static const DataTypeVector* dtypes =
+      new DataTypeVector{DT_INT64, DT_FLOAT, DT_STRING};
+  return *dtypes;
+}
+
+absl::Status WriteElements(const std::string& filename, int64_t num_elements,
+                           int64_t max_block_elements) {
+  ColumnarChunkWriter writer(filename, max_block_elements);
+  TF_RETURN_IF_ERROR(writer.Initialize(tsl::Env::Default()));
+  for (int64_t i = 0; i < num_elements; ++i) {
+    TF_RETURN_IF_ERROR(writer.WriteTensors(Element(i)));
+  }
+  return writer.Close();
+}
+
+void ExpectElement(const std::vector<Tensor>& tensors, int64_t i) {
+  std::vector<Tensor> expected = Element(i);
+  ASSERT_EQ(tensors.size(), expected.size());
+  for (int64_t j = 0; j < expected.size(); ++j) {
+    test::ExpectEqual(tensors[j], expected[j]);
+  }
+}
+
+class ColumnarChunkRoundTripTest
+    : public ::testing::TestWithParam<std::tuple<int64_t, int64_t>> {
+ protected:
+  int64_t NumElements() const { return std::get<0>(GetParam()); }
+  int64_t MaxBlockElements() const { return std::get<1>(GetParam()); }
+};
+
+TEST_P(ColumnarChunkRoundTripTest, ReadWrite) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  TF_ASSERT_OK(WriteElements(filename, NumElements(), MaxBlockElements()));
+
+  ColumnarChunkReader reader(filename, ElementDtypes(), RunInline);
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  for (int64_t i = 0; i < NumElements(); ++i) {
+    std::vector<Tensor> tensors;
+    TF_ASSERT_OK(reader.ReadTensors(&tensors));
+    ExpectElement(tensors, i);
+  }
+  std::vector<Tensor> tensors;
+  EXPECT_THAT(reader.ReadTensors(&tensors),
+              StatusIs(absl::StatusCode::kOutOfRange));
+  EXPECT_GT(reader.BytesRead(), 0);
+}
+
+TEST_P(ColumnarChunkRoundTripTest, DecompressInParallel) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  TF_ASSERT_OK(WriteElements(filename, NumElements(), MaxBlockElements()));
+
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "decompress", 3);
+  ColumnarChunkReader reader(
+      filename, ElementDtypes(),
+      [&thread_pool](std::function<void()> fn) {
+        thread_pool.Schedule(std::move(fn));
+      },
+      /*num_prefetched_blocks=*/3);
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  for (int64_t i = 0; i < NumElements(); ++i) {
+    std::vector<Tensor> tensors;
+    TF_ASSERT_OK(reader.ReadTensors(&tensors));
+    ExpectElement(tensors, i);
+  }
+}
+
+TEST_P(ColumnarChunkRoundTripTest, SkipRecords) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  TF_ASSERT_OK(WriteElements(filename, NumElements(), MaxBlockElements()));
+
+  for (int64_t num_skipped = 0; num_skipped < NumElements(); ++num_skipped) {
+    ColumnarChunkReader reader(filename, ElementDtypes(), RunInline);
+    TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+    TF_ASSERT_OK(reader.SkipRecords(num_skipped));
+    std::vector<Tensor> tensors;
+    TF_ASSERT_OK(reader.ReadTensors(&tensors));
+    ExpectElement(tensors, num_skipped);
+    TF_ASSERT_OK(reader.SkipRecords(NumElements() - num_skipped - 1));
+    EXPECT_THAT(reader.ReadTensors(&tensors),
+                StatusIs(absl::StatusCode::kOutOfRange));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(NumElementsAndBlockSizes, ColumnarChunkRoundTripTest,
+                         ::testing::Combine(::testing::Values(1, 10, 100),
+                                            ::testing::Values(1, 3, 1024)));
+
+TEST(ColumnarChunkTest, SkipPastEnd) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  TF_ASSERT_OK(WriteElements(filename, /*num_elements=*/5,
+                             /*max_block_elements=*/2));
+  ColumnarChunkReader reader(filename, ElementDtypes(), RunInline);
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  EXPECT_THAT(reader.SkipRecords(6), StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+TEST(ColumnarChunkTest, EmptyChunk) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  TF_ASSERT_OK(WriteElements(filename, /*num_elements=*/0,
+                             /*max_block_elements=*/2));
+  ColumnarChunkReader reader(filename, ElementDtypes(), RunInline);
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  std::vector<Tensor> tensors;
+  EXPECT_THAT(reader.ReadTensors(&tensors),
+              StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+TEST(ColumnarChunkTest, BlockSizeLimit) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  ColumnarChunkWriter writer(filename, /*max_block_elements=*/1024,
+                             /*max_block_size=*/ByteSize::Bytes(16));
+  TF_ASSERT_OK(writer.Initialize(tsl::Env::Default()));
+  for (int64_t i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(writer.WriteTensors({Tensor(i), Tensor(i * 2)}));
+  }
+  TF_ASSERT_OK(writer.Close());
+
+  ColumnarChunkReader reader(filename, {DT_INT64, DT_INT64}, RunInline);
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  for (int64_t i = 0; i < 10; ++i) {
+    std::vector<Tensor> tensors;
+    TF_ASSERT_OK(reader.ReadTensors(&tensors));
+    ASSERT_EQ(tensors.size(), 2);
+    test::ExpectEqual(tensors[0], Tensor(i));
+    test::ExpectEqual(tensors[1], Tensor(i * 2));
+  }
+}
+
+TEST(ColumnarChunkTest, InconsistentElements) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  ColumnarChunkWriter writer(filename);
+  TF_ASSERT_OK(writer.Initialize(tsl::Env::Default()));
+  TF_ASSERT_OK(writer.WriteTensors({Tensor(int64_t{1})}));
+  EXPECT_THAT(writer.WriteTensors({Tensor(int64_t{1}), Tensor(int64_t{2})}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(writer.WriteTensors({Tensor(1.0f)}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ColumnarChunkTest, WrongDtypes) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  TF_ASSERT_OK(WriteElements(filename, /*num_elements=*/5,
+                             /*max_block_elements=*/2));
+  ColumnarChunkReader reader(filename, {DT_INT64}, RunInline);
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  std::vector<Tensor> tensors;
+  EXPECT_THAT(reader.ReadTensors(&tensors),
+              StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST(ColumnarChunkTest, TFRecordCompression) {
+  EXPECT_EQ(TFRecordCompression(kColumnarZstdCompression),
+            tsl::io::compression::kSnappy);
+  EXPECT_EQ(TFRecordCompression(tsl::io::compression::kGzip),
+            tsl::io::compression::kGzip);
+  EXPECT_EQ(TFRecordCompression(tsl::io::compression::kNone),
+            tsl::io::compression::kNone);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
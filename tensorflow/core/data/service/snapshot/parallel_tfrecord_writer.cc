@@ -29,6 +29,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
 #include "tensorflow/core/data/service/snapshot/utils.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -116,12 +117,22 @@ bool ParallelTFRecordWriter::HasNext() const ABSL_LOCKS_EXCLUDED(mu_) {
 
 absl::Status ParallelTFRecordWriter::WriteFile() ABSL_LOCKS_EXCLUDED(mu_) {
   TF_ASSIGN_OR_RETURN(const std::string filename, GetUniqueFile());
-  snapshot_util::TFRecordWriter writer(filename, compression_);
-  TF_RETURN_IF_ERROR(writer.Initialize(env_));
+  // `Initialize` is only public in the concrete writers.
+  std::unique_ptr<snapshot_util::Writer> writer;
+  if (compression_ == kColumnarZstdCompression) {
+    auto columnar_writer = std::make_unique<ColumnarChunkWriter>(filename);
+    TF_RETURN_IF_ERROR(columnar_writer->Initialize(env_));
+    writer = std::move(columnar_writer);
+  } else {
+    auto tfrecord_writer =
+        std::make_unique<snapshot_util::TFRecordWriter>(filename, compression_);
+    TF_RETURN_IF_ERROR(tfrecord_writer->Initialize(env_));
+    writer = std::move(tfrecord_writer);
+  }
   while (ShouldWriteFile(filename)) {
-    TF_RETURN_IF_ERROR(WriteRecord(filename, writer));
+    TF_RETURN_IF_ERROR(WriteRecord(filename, *writer));
   }
-  TF_RETURN_IF_ERROR(writer.Close());
+  TF_RETURN_IF_ERROR(writer->Close());
   return DeleteEmptyFile(filename);
 }
 
@@ -137,7 +148,7 @@ bool ParallelTFRecordWriter::ShouldWriteFile(const std::string& filename) const
 }
 
 absl::Status ParallelTFRecordWriter::WriteRecord(
-    const std::string& filename, snapshot_util::TFRecordWriter& writer) {
+    const std::string& filename, snapshot_util::Writer& writer) {
   TF_ASSIGN_OR_RETURN(std::optional<std::vector<Tensor>> record,
                       GetNextRecord(filename));
   if (!record.has_value()) {
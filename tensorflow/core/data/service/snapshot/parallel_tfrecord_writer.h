@@ -99,7 +99,7 @@ class ParallelTFRecordWriter {
 
   // Writes one record to file.
   absl::Status WriteRecord(const std::string& filename,
-                           snapshot_util::TFRecordWriter& writer);
+                           snapshot_util::Writer& writer);
 
   // Gets the next record from the buffer to write. Returns `std::nullopt` if
   // there are no more records to write.
@@ -80,7 +80,10 @@ absl::StatusOr<std::optional<Tensor>> PrefetchedSplitProvider::GetNext(
   auto it = buffer_.begin();
   SplitAndIndex split = std::move(*it);
   buffer_.erase(it);
-  TF_RETURN_IF_ERROR(env_->RenameFile(split.SplitPath(directory_), split_path));
+  if (WritesSplits()) {
+    TF_RETURN_IF_ERROR(
+        env_->RenameFile(split.SplitPath(directory_), split_path));
+  }
   ++split_index_to_read_;
   ready_to_push_.Signal();
   return std::move(split.split);
@@ -130,9 +133,11 @@ absl::StatusOr<bool> PrefetchedSplitProvider::PrefetchSplit()
   }
 
   // Writes the split without holding a mutex.
-  TF_RETURN_IF_ERROR(
-      AtomicallyWriteTFRecords(split->SplitPath(directory_), {split->split},
-                               tsl::io::compression::kNone, env_));
+  if (WritesSplits()) {
+    TF_RETURN_IF_ERROR(
+        AtomicallyWriteTFRecords(split->SplitPath(directory_), {split->split},
+                                 tsl::io::compression::kNone, env_));
+  }
 
   absl::MutexLock l(&mu_);
   buffer_.insert(std::move(*split));
@@ -196,6 +201,9 @@ void PrefetchedSplitProvider::Cancel() {
 }
 
 absl::Status PrefetchedSplitProvider::InitDirs() {
+  if (!WritesSplits()) {
+    return absl::OkStatus();
+  }
   if (env_->FileExists(directory_).ok()) {
     int64_t undeleted_files, undeleted_dirs;
     TF_RETURN_IF_ERROR(
@@ -56,6 +56,7 @@ class PrefetchedSplitProvider {
   // `buffer_size_per_thread` is the size of the buffer holding the prefetched
   // but unread splits. For every prefetched split, we keep: (1) an in-memory
   // Tensor in the buffer, and (2) an on-disk file representing the same split.
+  // If `directory` is empty, the splits are only prefetched into memory.
   explicit PrefetchedSplitProvider(
       std::unique_ptr<SplitProvider> split_provider,
       const std::string& directory, tsl::Env* env,
@@ -67,6 +68,7 @@ class PrefetchedSplitProvider {
   // Writes the split to `target_split_path` and returns the split. Returns
   // `std::nullopt` if no more splits are available. If there are more available
   // splits but not currently ready for reading, blocks until they are ready.
+  // `split_path` is ignored if the splits are only prefetched into memory.
   absl::StatusOr<std::optional<Tensor>> GetNext(const std::string& split_path);
 
   // Resets the split provider.
@@ -97,6 +99,9 @@ class PrefetchedSplitProvider {
   // `directory_`.
   absl::Status InitDirs();
 
+  // Whether splits are written to files in `directory_`.
+  bool WritesSplits() const { return !directory_.empty(); }
+
   // Runs the prefetch threads.
   std::unique_ptr<tsl::thread::ThreadPool> RunPrefetchThreads();
 
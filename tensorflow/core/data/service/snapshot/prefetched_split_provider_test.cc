@@ -267,6 +267,27 @@ TEST(PrefetchedSplitProviderTest, Cancellation) {
   client_thread.reset();
 }
 
+TEST(PrefetchedSplitProviderTest, PrefetchIntoMemory) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SplitProvider> split_provider,
+                          RangeSplitProvider(100));
+  PrefetchedSplitProvider prefetched_split_provider(
+      std::move(split_provider), /*directory=*/"", tsl::Env::Default(),
+      /*num_write_threads=*/1, /*buffer_size_per_thread=*/10);
+  for (int repetition = 0; repetition < 2; ++repetition) {
+    std::vector<int64_t> splits;
+    while (true) {
+      TF_ASSERT_OK_AND_ASSIGN(std::optional<Tensor> split,
+                              prefetched_split_provider.GetNext(""));
+      if (!split.has_value()) {
+        break;
+      }
+      splits.push_back(GetValue<int64_t>(*split));
+    }
+    EXPECT_THAT(splits, ElementsAreArray(Range(100)));
+    TF_ASSERT_OK(prefetched_split_provider.Reset());
+  }
+}
+
 TEST(PrefetchedSplitProviderTest, ShutdownWithUnreadSplits) {
   TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SplitProvider> split_provider,
                           RangeSplitProvider(100));
@@ -21,6 +21,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -128,10 +129,20 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     ~Iterator() override { RecordBytesRead(); }
 
     absl::Status Initialize(IteratorContext* ctx) override {
-      reader_ = std::make_unique<snapshot_util::TFRecordReader>(
-          TranslateFileName(dataset()->chunk_file_), dataset()->compression_,
-          dataset()->dtypes_, kTFRecordReaderOutputBufferSize);
-      return reader_->Initialize(ctx->env());
+      const std::string chunk_file = TranslateFileName(dataset()->chunk_file_);
+      if (IsColumnar()) {
+        auto reader = std::make_unique<ColumnarChunkReader>(
+            chunk_file, dataset()->dtypes_, *ctx->runner());
+        TF_RETURN_IF_ERROR(reader->Initialize(ctx->env()));
+        reader_ = std::move(reader);
+        return absl::OkStatus();
+      }
+      auto reader = std::make_unique<snapshot_util::TFRecordReader>(
+          chunk_file, dataset()->compression_, dataset()->dtypes_,
+          kTFRecordReaderOutputBufferSize);
+      TF_RETURN_IF_ERROR(reader->Initialize(ctx->env()));
+      reader_ = std::move(reader);
+      return absl::OkStatus();
     }
 
    protected:
@@ -167,24 +178,29 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
-    // TODO(b/250921378): Optimize this to not parse every single element. We
-    // may consider switching the data format to ArrayRecords so we can use the
-    // index to jump straight to the starting record.
+    bool IsColumnar() const {
+      return dataset()->compression_ == kColumnarZstdCompression;
+    }
+
+    // TODO(b/250921378): Optimize this to not parse every single element of
+    // TFRecord chunks. We may consider switching the data format to
+    // ArrayRecords so we can use the index to jump straight to the starting
+    // record. Columnar chunks skip whole blocks without decompressing them.
     absl::Status AdvanceToStartIndex(IteratorContext* ctx) {
-      for (int64_t i = 0; i < start_index_; ++i) {
-        std::vector<Tensor> unused;
-        TF_RETURN_IF_ERROR(reader_->ReadTensors(&unused));
-      }
-      return absl::OkStatus();
+      return reader_->SkipRecords(start_index_);
     }
 
     void RecordBytesRead() {
-      uint64_t bytes_read = reader_->BytesRead();
+      uint64_t bytes_read =
+          IsColumnar()
+              ? static_cast<ColumnarChunkReader*>(reader_.get())->BytesRead()
+              : static_cast<snapshot_util::TFRecordReader*>(reader_.get())
+                    ->BytesRead();
       metrics::GetTFDataBytesReadCounter(kSnapshotChunkDataset)
           ->IncrementBy(bytes_read);
     }
 
-    std::unique_ptr<snapshot_util::TFRecordReader> reader_;
+    std::unique_ptr<snapshot_util::Reader> reader_;
     int64_t start_index_ = 0;
   };
 
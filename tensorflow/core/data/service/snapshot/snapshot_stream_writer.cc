@@ -32,6 +32,7 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/service/common.h"
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
 #include "tensorflow/core/data/service/snapshot/file_utils.h"
 #include "tensorflow/core/data/service/snapshot/parallel_tfrecord_writer.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
@@ -301,7 +302,8 @@ absl::Status SnapshotStreamWriter::Save(
   TF_ASSIGN_OR_RETURN(std::vector<Tensor> serialized_iterator,
                       iterator_->Save());
   TF_RETURN_IF_ERROR(AtomicallyWriteTFRecords(
-      checkpoint_path, serialized_iterator, params_.compression, params_.env));
+      checkpoint_path, serialized_iterator,
+      TFRecordCompression(params_.compression), params_.env));
   absl::Time end_time = absl::FromUnixMicros(params_.env->NowMicros());
   LOG(INFO) << "Wrote checkpoint file " << checkpoint_path << ". "
             << "Checkpointing distributed tf.data snapshot writer took "
@@ -360,7 +362,8 @@ absl::Status SnapshotStreamWriter::Restore() {
   }
   TF_RETURN_IF_ERROR(checkpoint_name.status());
   snapshot_util::TFRecordReaderImpl reader(
-      CheckpointPath(*checkpoint_name), params_.compression,
+      CheckpointPath(*checkpoint_name),
+      TFRecordCompression(params_.compression),
       kTFRecordReaderOutputBufferSize.ToUnsignedBytes());
   TF_RETURN_IF_ERROR(reader.Initialize(params_.env));
   TF_ASSIGN_OR_RETURN(std::vector<Tensor> serialized_tensors,
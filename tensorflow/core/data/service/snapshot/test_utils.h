@@ -16,8 +16,10 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_TEST_UTILS_H_
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
@@ -25,6 +27,7 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
 #include "tensorflow/core/data/service/snapshot/file_utils.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/task_runner.h"
@@ -48,13 +51,23 @@ absl::StatusOr<std::vector<T>> ReadSnapshot(const std::string& base_path,
   for (const std::string& chunk_file : chunk_files) {
     std::string chunk_file_path =
         tsl::io::JoinPath(chunks_directory, chunk_file);
-    snapshot_util::TFRecordReader tfrecord_reader(chunk_file_path, compression,
-                                                  DataTypeVector{DT_INT64});
-    TF_RETURN_IF_ERROR(tfrecord_reader.Initialize(Env::Default()));
+    std::unique_ptr<snapshot_util::Reader> reader;
+    if (compression == kColumnarZstdCompression) {
+      auto columnar_reader = std::make_unique<ColumnarChunkReader>(
+          chunk_file_path, DataTypeVector{DT_INT64},
+          [](std::function<void()> fn) { fn(); });
+      TF_RETURN_IF_ERROR(columnar_reader->Initialize(Env::Default()));
+      reader = std::move(columnar_reader);
+    } else {
+      auto tfrecord_reader = std::make_unique<snapshot_util::TFRecordReader>(
+          chunk_file_path, compression, DataTypeVector{DT_INT64});
+      TF_RETURN_IF_ERROR(tfrecord_reader->Initialize(Env::Default()));
+      reader = std::move(tfrecord_reader);
+    }
 
     while (true) {
       std::vector<Tensor> tensors;
-      absl::Status status = tfrecord_reader.ReadTensors(&tensors);
+      absl::Status status = reader->ReadTensors(&tensors);
       if (absl::IsOutOfRange(status)) {
         break;
       }
@@ -15,14 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/split_provider.h"
 
+#include <cstddef>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/snapshot/prefetched_split_provider.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/env.h"
@@ -30,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tsl/platform/statusor.h"
 
 namespace tensorflow {
 namespace data {
@@ -41,15 +46,19 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
     dispatcher_ =
         std::make_unique<DataServiceDispatcherClient>(address_, protocol_);
   }
-  TF_RETURN_IF_ERROR(grpc_util::Retry(
-      [this, split, end_of_splits]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-        return dispatcher_->GetSplit(iteration_id_, repetition_,
-                                     split_provider_index_, *split,
-                                     *end_of_splits);
-      },
-      "get next split",
-      /*deadline_micros=*/Env::Default()->NowMicros() +
-          (timeout_ms_ * EnvTime::kMillisToMicros)));
+  if (splits_per_request_ > 1) {
+    TF_RETURN_IF_ERROR(GetLeasedSplit(split, end_of_splits));
+  } else {
+    TF_RETURN_IF_ERROR(grpc_util::Retry(
+        [this, split, end_of_splits]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+          return dispatcher_->GetSplit(worker_address_, iteration_id_,
+                                       repetition_, split_provider_index_,
+                                       *split, *end_of_splits);
+        },
+        "get next split",
+        /*deadline_micros=*/Env::Default()->NowMicros() +
+            (timeout_ms_ * EnvTime::kMillisToMicros)));
+  }
   if (*end_of_splits) {
     VLOG(1) << "Reached end of splits for iteration_id=" << iteration_id_
             << ", repetition=" << repetition_;
@@ -61,9 +70,45 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
   return absl::OkStatus();
 }
 
+Status DataServiceSplitProvider::GetLeasedSplit(Tensor* split,
+                                                bool* end_of_splits)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (leased_splits_.empty() && !end_of_splits_after_lease_) {
+    std::vector<Tensor> splits;
+    bool end_of_splits_after_splits = false;
+    TF_RETURN_IF_ERROR(grpc_util::Retry(
+        [this, &splits, &end_of_splits_after_splits]()
+            TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+              splits.clear();
+              return dispatcher_->GetSplits(
+                  worker_address_, iteration_id_, repetition_,
+                  split_provider_index_, splits_per_request_, splits,
+                  end_of_splits_after_splits);
+            },
+        "get next splits",
+        /*deadline_micros=*/Env::Default()->NowMicros() +
+            (timeout_ms_ * EnvTime::kMillisToMicros)));
+    for (Tensor& leased_split : splits) {
+      leased_splits_.push_back(std::move(leased_split));
+    }
+    end_of_splits_after_lease_ = end_of_splits_after_splits;
+  }
+  if (leased_splits_.empty()) {
+    end_of_splits_after_lease_ = false;
+    *end_of_splits = true;
+    return absl::OkStatus();
+  }
+  *split = std::move(leased_splits_.front());
+  leased_splits_.pop_front();
+  *end_of_splits = false;
+  return absl::OkStatus();
+}
+
 Status DataServiceSplitProvider::Reset() TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
   repetition_++;
+  leased_splits_.clear();
+  end_of_splits_after_lease_ = false;
   return absl::OkStatus();
 }
 
@@ -81,6 +126,44 @@ Status DataServiceSplitProvider::Restore(
       "Restore is not implemented for DataServiceSplitProvider");
 }
 
+PrefetchingSplitProvider::PrefetchingSplitProvider(
+    std::unique_ptr<SplitProvider> split_provider, size_t buffer_size)
+    : cardinality_(split_provider->Cardinality()),
+      prefetched_split_provider_(std::move(split_provider),
+                                 /*directory=*/"", Env::Default(),
+                                 /*num_write_threads=*/1,
+                                 /*buffer_size_per_thread=*/buffer_size) {}
+
+Status PrefetchingSplitProvider::GetNext(Tensor* split, bool* end_of_splits) {
+  TF_ASSIGN_OR_RETURN(std::optional<Tensor> next,
+                      prefetched_split_provider_.GetNext(/*split_path=*/""));
+  *end_of_splits = !next.has_value();
+  if (next.has_value()) {
+    *split = *std::move(next);
+  }
+  return absl::OkStatus();
+}
+
+Status PrefetchingSplitProvider::Reset() {
+  return prefetched_split_provider_.Reset();
+}
+
+Status PrefetchingSplitProvider::Save(
+    std::function<std::string(std::string)> full_name,
+    IteratorStateWriter* writer) {
+  return errors::Unimplemented(
+      "Save is not implemented for PrefetchingSplitProvider");
+}
+
+Status PrefetchingSplitProvider::Restore(
+    std::function<std::string(std::string)> full_name,
+    IteratorStateReader* reader) {
+  return errors::Unimplemented(
+      "Restore is not implemented for PrefetchingSplitProvider");
+}
+
+void PrefetchingSplitProvider::Cancel() { prefetched_split_provider_.Cancel(); }
+
 Status CreateSplitProviders(
     const DatasetDef& dataset_def,
     std::vector<std::unique_ptr<SplitProvider>>& split_providers) {
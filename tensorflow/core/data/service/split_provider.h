@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
@@ -23,6 +26,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
+#include "tensorflow/core/data/service/snapshot/prefetched_split_provider.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -35,14 +39,23 @@ namespace data {
 // SplitProvider which reads splits from a tf.data service dispatcher over RPC.
 class DataServiceSplitProvider : public SplitProvider {
  public:
+  // `worker_address` identifies the worker reading the splits to the
+  // dispatcher at `address`. If `splits_per_request` is greater than 1, each
+  // request leases up to that many splits from the dispatcher, which are
+  // returned by the following `GetNext` calls. The dispatcher hands the
+  // unread splits of a lease to other workers if this worker is lost.
   DataServiceSplitProvider(const std::string& address,
-                           const std::string& protocol, int64_t iteration_id,
-                           int64_t split_provider_index, int64_t timeout_ms)
+                           const std::string& protocol,
+                           const std::string& worker_address,
+                           int64_t iteration_id, int64_t split_provider_index,
+                           int64_t timeout_ms, int64_t splits_per_request = 1)
       : address_(address),
         protocol_(protocol),
+        worker_address_(worker_address),
         iteration_id_(iteration_id),
         split_provider_index_(split_provider_index),
-        timeout_ms_(timeout_ms) {}
+        timeout_ms_(timeout_ms),
+        splits_per_request_(splits_per_request) {}
 
   Status GetNext(Tensor* split, bool* end_of_splits) override;
   Status Reset() override;
@@ -52,15 +65,50 @@ class DataServiceSplitProvider : public SplitProvider {
                  IteratorStateReader* reader) override;
 
  private:
+  // Returns the next split of the current lease, leasing more splits from the
+  // dispatcher when the lease is exhausted.
+  Status GetLeasedSplit(Tensor* split, bool* end_of_splits)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const std::string address_;
   const std::string protocol_;
+  const std::string worker_address_;
   const int64_t iteration_id_;
   const int64_t split_provider_index_;
   const int64_t timeout_ms_;
+  const int64_t splits_per_request_;
 
   mutex mu_;
   int64_t repetition_ TF_GUARDED_BY(mu_) = 0;
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_ TF_GUARDED_BY(mu_);
+  // The leased splits which have not been returned yet.
+  std::deque<Tensor> leased_splits_ TF_GUARDED_BY(mu_);
+  // Whether the split provider reaches its end after `leased_splits_`.
+  bool end_of_splits_after_lease_ TF_GUARDED_BY(mu_) = false;
+};
+
+// SplitProvider which generates the splits of another split provider ahead of
+// `GetNext` calls in a background thread, so that callers don't wait for the
+// splits to be generated. Used by the dispatcher to serve `GetSplit` requests
+// under dynamic sharding.
+class PrefetchingSplitProvider : public SplitProvider {
+ public:
+  // Buffers up to `buffer_size` splits of `split_provider`.
+  PrefetchingSplitProvider(std::unique_ptr<SplitProvider> split_provider,
+                           size_t buffer_size);
+
+  Status GetNext(Tensor* split, bool* end_of_splits) override;
+  Status Reset() override;
+  Status Save(std::function<std::string(std::string)> full_name,
+              IteratorStateWriter* writer) override;
+  Status Restore(std::function<std::string(std::string)> full_name,
+                 IteratorStateReader* reader) override;
+  int64_t Cardinality() const override { return cardinality_; }
+  void Cancel() override;
+
+ private:
+  const int64_t cardinality_;
+  PrefetchedSplitProvider prefetched_split_provider_;
 };
 
 // Makes split providers for `dataset_def` and stores them in `split_providers`.
@@ -18,12 +18,14 @@ limitations under the License.
 #include <cstdint>
 #include <memory>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/test_util.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/test.h"
@@ -110,6 +112,47 @@ TEST(SplitProviderTest, SampleFromDatasetsCardinality) {
               UnorderedElementsAre(5, 5, 5, kInfiniteCardinality));
 }
 
+std::vector<int64_t> GetSplits(SplitProvider& split_provider) {
+  std::vector<int64_t> splits;
+  while (true) {
+    Tensor split;
+    bool end_of_splits = false;
+    TF_EXPECT_OK(split_provider.GetNext(&split, &end_of_splits));
+    if (end_of_splits) {
+      return splits;
+    }
+    splits.push_back(split.scalar<int64_t>()());
+  }
+}
+
+TEST(PrefetchingSplitProviderTest, GetSplits) {
+  DatasetDef range_dataset = testing::RangeDataset(10);
+  std::vector<std::unique_ptr<SplitProvider>> split_providers;
+  TF_ASSERT_OK(CreateSplitProviders(range_dataset, split_providers));
+  ASSERT_EQ(split_providers.size(), 1);
+  PrefetchingSplitProvider split_provider(std::move(split_providers[0]),
+                                          /*buffer_size=*/3);
+  EXPECT_EQ(split_provider.Cardinality(), 10);
+  EXPECT_THAT(GetSplits(split_provider),
+              ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+
+  TF_ASSERT_OK(split_provider.Reset());
+  EXPECT_THAT(GetSplits(split_provider),
+              ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+}
+
+TEST(PrefetchingSplitProviderTest, Cancel) {
+  DatasetDef range_dataset = testing::RangeDataset(10);
+  std::vector<std::unique_ptr<SplitProvider>> split_providers;
+  TF_ASSERT_OK(CreateSplitProviders(range_dataset, split_providers));
+  PrefetchingSplitProvider split_provider(std::move(split_providers[0]),
+                                          /*buffer_size=*/3);
+  split_provider.Cancel();
+  Tensor split;
+  bool end_of_splits = false;
+  EXPECT_FALSE(split_provider.GetNext(&split, &end_of_splits).ok());
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
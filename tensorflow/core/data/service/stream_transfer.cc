@@ -0,0 +1,661 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/stream_transfer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/impl/codegen/client_unary_call.h"
+#include "grpcpp/impl/codegen/method_handler.h"
+#include "grpcpp/impl/codegen/rpc_method.h"
+#include "grpcpp/impl/codegen/rpc_service_method.h"
+#include "grpcpp/impl/codegen/service_type.h"
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/byte_buffer.h"
+#include "grpcpp/support/channel_arguments.h"
+#include "grpcpp/support/slice.h"
+#include "grpcpp/support/status.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/data/service/credentials_factory.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/raw_coding.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kGetElementsMethod[] =
+    "/tensorflow.data.StreamTransferService/GetElements";
+
+// Responses start with the size of the header, as a fixed64.
+constexpr size_t kHeaderSizeBytes = sizeof(uint64_t);
+
+constexpr char kSharedMemoryDirEnvVar[] = "TF_DATA_SERVICE_SHARED_MEMORY_DIR";
+constexpr char kDefaultSharedMemoryDir[] = "/dev/shm";
+constexpr char kServerDirectoryPrefix[] = "tf_data_transfer_";
+constexpr char kSegmentPrefix[] = "segment_";
+
+// Tensors in shared memory segments are aligned like those from the CPU
+// allocator.
+constexpr int64_t kSegmentAlignment = Allocator::kAllocatorAlignment;
+
+// Returns the directory holding the shared memory directories of the servers.
+std::string SharedMemoryBaseDirectory() {
+  const char* dir = std::getenv(kSharedMemoryDirEnvVar);
+  return io::CleanPath(dir != nullptr && *dir != '\0'
+                           ? dir
+                           : kDefaultSharedMemoryDir);
+}
+
+// Returns whether `segment` names a segment file created by a server on this
+// host, so that clients never map or delete other files.
+bool IsSharedMemorySegment(absl::string_view segment) {
+  const absl::string_view server_directory = io::Dirname(segment);
+  return io::Dirname(server_directory) == SharedMemoryBaseDirectory() &&
+         absl::StartsWith(io::Basename(server_directory),
+                          kServerDirectoryPrefix) &&
+         absl::StartsWith(io::Basename(segment), kSegmentPrefix);
+}
+
+// A tensor buffer pointing into a mapped shared memory segment. The segment
+// is unmapped once all of its buffers are destroyed.
+class SegmentBuffer : public TensorBuffer {
+ public:
+  SegmentBuffer(std::shared_ptr<ReadOnlyMemoryRegion> segment,
+                const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        segment_(std::move(segment)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("SharedMemorySegment");
+  }
+  // The segment is mapped read-only, so ops must not reuse the buffer for
+  // their outputs.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> segment_;
+  const size_t size_;
+};
+
+// Sequentially reads the bytes of a sequence of slices.
+class SliceReader {
+ public:
+  explicit SliceReader(std::vector<::grpc::Slice> slices)
+      : slices_(std::move(slices)) {}
+
+  // Copies the next `n` bytes to `dst`.
+  Status Read(size_t n, char* dst) {
+    while (n > 0) {
+      if (slice_index_ >= slices_.size()) {
+        return errors::DataLoss("Truncated stream transfer response.");
+      }
+      const ::grpc::Slice& slice = slices_[slice_index_];
+      const size_t num_bytes = std::min(n, slice.size() - slice_offset_);
+      std::memcpy(dst, slice.begin() + slice_offset_, num_bytes);
+      dst += num_bytes;
+      n -= num_bytes;
+      slice_offset_ += num_bytes;
+      if (slice_offset_ == slice.size()) {
+        ++slice_index_;
+        slice_offset_ = 0;
+      }
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  const std::vector<::grpc::Slice> slices_;
+  size_t slice_index_ = 0;
+  size_t slice_offset_ = 0;
+};
+
+Status ParseProto(const ::grpc::ByteBuffer& buffer,
+                  protobuf::MessageLite* proto) {
+  std::vector<::grpc::Slice> slices;
+  ::grpc::Status s = buffer.Dump(&slices);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to read stream transfer request", s);
+  }
+  std::string data;
+  for (const ::grpc::Slice& slice : slices) {
+    data.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+  }
+  if (!proto->ParseFromString(data)) {
+    return errors::DataLoss("Failed to parse stream transfer request.");
+  }
+  return absl::OkStatus();
+}
+
+// Adds `components` to `element`, appending the raw bytes of the tensors to
+// `payload` without copying them.
+void AddComponents(const std::vector<Tensor>& components,
+                   StreamedElement& element,
+                   std::vector<::grpc::Slice>& payload,
+                   int64_t& payload_bytes) {
+  for (const Tensor& tensor : components) {
+    StreamedComponent* component = element.add_components();
+    if (!DataTypeCanUseMemcpy(tensor.dtype())) {
+      tensor.AsProtoTensorContent(component->mutable_tensor());
+      continue;
+    }
+    component->mutable_tensor()->set_dtype(tensor.dtype());
+    tensor.shape().AsProto(component->mutable_tensor()->mutable_tensor_shape());
+    const absl::string_view data = tensor.tensor_data();
+    component->set_num_bytes(data.size());
+    if (data.empty()) {
+      continue;
+    }
+    // The slice keeps the tensor buffer alive until gRPC has sent it.
+    const TensorBuffer* buffer = DMAHelper::buffer(&tensor);
+    buffer->Ref();
+    payload.emplace_back(
+        const_cast<char*>(data.data()), data.size(),
+        [](void* buffer) { static_cast<TensorBuffer*>(buffer)->Unref(); },
+        const_cast<TensorBuffer*>(buffer));
+    payload_bytes += data.size();
+  }
+}
+
+class StreamTransferService : public ::grpc::Service {
+ public:
+  explicit StreamTransferService(DataTransferServer::GetElementT get_element)
+      : get_element_(std::move(get_element)) {
+    AddMethod(new ::grpc::internal::RpcServiceMethod(
+        kGetElementsMethod, ::grpc::internal::RpcMethod::NORMAL_RPC,
+        new ::grpc::internal::RpcMethodHandler<
+            StreamTransferService, ::grpc::ByteBuffer, ::grpc::ByteBuffer>(
+            [](StreamTransferService* service, ::grpc::ServerContext* ctx,
+               const ::grpc::ByteBuffer* request,
+               ::grpc::ByteBuffer* response) {
+              return ToGrpcStatus(service->GetElements(*request, *response));
+            },
+            this)));
+  }
+
+  // Makes the service write large responses to segments in `directory` for
+  // the clients which ask for it. Must be called before the service is
+  // registered.
+  void EnableSharedMemory(std::string directory) {
+    shared_memory_directory_ = std::move(directory);
+  }
+
+ private:
+  Status GetElements(const ::grpc::ByteBuffer& request_buffer,
+                     ::grpc::ByteBuffer& response_buffer) {
+    StreamGetElementsRequest request;
+    TF_RETURN_IF_ERROR(ParseProto(request_buffer, &request));
+    GetElementRequest element_request = request.request();
+    // Consumers reading in rounds must get exactly one element per request.
+    const int64_t max_elements =
+        element_request.has_round_index()
+            ? 1
+            : std::clamp<int64_t>(request.max_elements(), 1,
+                                  kMaxStreamedElementsPerRequest);
+
+    StreamGetElementsResponseHeader header;
+    std::vector<::grpc::Slice> payload;
+    int64_t payload_bytes = 0;
+    for (int64_t i = 0; i < max_elements; ++i) {
+      GetElementResult result;
+      TF_RETURN_IF_ERROR(get_element_(&element_request, &result));
+      if (i > 0 && result.skip) {
+        // No further element is ready.
+        break;
+      }
+      StreamedElement* element = header.add_elements();
+      element->set_element_index(result.element_index);
+      element->set_end_of_sequence(result.end_of_sequence);
+      element->set_skip_task(result.skip);
+      AddComponents(result.components, *element, payload, payload_bytes);
+      if (result.end_of_sequence || result.skip ||
+          payload_bytes >= kMaxStreamedBytesPerRequest) {
+        break;
+      }
+      // Only wait for the first element.
+      element_request.set_allow_skip(true);
+    }
+    if (request.use_shared_memory() && !shared_memory_directory_.empty() &&
+        payload_bytes >= kMinSharedMemoryBytes) {
+      TF_RETURN_IF_ERROR(WriteSegment(payload, header));
+      payload.clear();
+    }
+
+    std::string header_bytes;
+    core::PutFixed64(&header_bytes, header.ByteSizeLong());
+    if (!header.AppendToString(&header_bytes)) {
+      return errors::Internal("Failed to serialize stream transfer header.");
+    }
+    std::vector<::grpc::Slice> slices;
+    slices.reserve(payload.size() + 1);
+    slices.emplace_back(header_bytes);
+    for (::grpc::Slice& slice : payload) {
+      slices.push_back(std::move(slice));
+    }
+    ::grpc::ByteBuffer buffer(slices.data(), slices.size());
+    response_buffer.Swap(&buffer);
+    return absl::OkStatus();
+  }
+
+  // Writes the raw bytes of the components of `header` from `payload` to a
+  // new segment, and records their offsets in `header`.
+  Status WriteSegment(const std::vector<::grpc::Slice>& payload,
+                      StreamGetElementsResponseHeader& header) {
+    const std::string segment =
+        io::JoinPath(shared_memory_directory_,
+                     absl::StrCat(kSegmentPrefix, next_segment_++));
+    Env* env = Env::Default();
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(segment, &file));
+    auto cleanup = gtl::MakeCleanup([env, &segment] {
+      env->DeleteFile(segment).IgnoreError();
+    });
+    const std::string padding(kSegmentAlignment, '\0');
+    int64_t offset = 0;
+    auto slice = payload.begin();
+    for (StreamedElement& element : *header.mutable_elements()) {
+      for (StreamedComponent& component : *element.mutable_components()) {
+        if (!DataTypeCanUseMemcpy(component.tensor().dtype()) ||
+            component.num_bytes() == 0) {
+          continue;
+        }
+        const int64_t aligned_offset =
+            (offset + kSegmentAlignment - 1) / kSegmentAlignment *
+            kSegmentAlignment;
+        TF_RETURN_IF_ERROR(file->Append(
+            absl::string_view(padding.data(), aligned_offset - offset)));
+        TF_RETURN_IF_ERROR(file->Append(absl::string_view(
+            reinterpret_cast<const char*>(slice->begin()), slice->size())));
+        component.set_segment_offset(aligned_offset);
+        offset = aligned_offset + slice->size();
+        ++slice;
+      }
+    }
+    TF_RETURN_IF_ERROR(file->Close());
+    header.set_shared_memory_segment(segment);
+    cleanup.release();
+    return absl::OkStatus();
+  }
+
+  const DataTransferServer::GetElementT get_element_;
+  std::string shared_memory_directory_;
+  std::atomic<int64_t> next_segment_ = 0;
+};
+
+class StreamDataTransferServer : public DataTransferServer {
+ public:
+  StreamDataTransferServer(GetElementT get_element, bool shared_memory)
+      : service_(std::move(get_element)), shared_memory_(shared_memory) {}
+
+  ~StreamDataTransferServer() override {
+    if (server_) {
+      server_->Shutdown();
+    }
+    if (!shared_memory_directory_.empty()) {
+      int64_t undeleted_files, undeleted_dirs;
+      Status s = Env::Default()->DeleteRecursively(
+          shared_memory_directory_, &undeleted_files, &undeleted_dirs);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to delete shared memory directory "
+                     << shared_memory_directory_ << ": " << s;
+      }
+    }
+  }
+
+  Status Start(const experimental::WorkerConfig& config) override {
+    if (shared_memory_) {
+      const std::string directory = io::JoinPath(
+          SharedMemoryBaseDirectory(),
+          absl::StrCat(kServerDirectoryPrefix, absl::Hex(random::New64())));
+      TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(directory));
+      shared_memory_directory_ = directory;
+      service_.EnableSharedMemory(directory);
+    }
+    std::shared_ptr<::grpc::ServerCredentials> credentials;
+    TF_RETURN_IF_ERROR(CredentialsFactory::CreateServerCredentials(
+        config.protocol(), &credentials));
+    ::grpc::ServerBuilder builder;
+    builder.AddListeningPort("0.0.0.0:0", credentials, &port_);
+    builder.SetMaxReceiveMessageSize(-1);
+    builder.RegisterService(&service_);
+    server_ = builder.BuildAndStart();
+    if (!server_) {
+      return errors::Internal("Could not start stream transfer server.");
+    }
+    return absl::OkStatus();
+  }
+
+  int Port() const override { return port_; }
+
+  // Clients are compatible if they can see the shared memory directory.
+  absl::StatusOr<std::string> GetCompatibilityInfo() const override {
+    return shared_memory_directory_;
+  }
+
+ private:
+  StreamTransferService service_;
+  const bool shared_memory_;
+  std::string shared_memory_directory_;
+  std::unique_ptr<::grpc::Server> server_;
+  int port_ = 0;
+};
+
+class StreamDataTransferClient : public DataTransferClient {
+ public:
+  StreamDataTransferClient(
+      std::shared_ptr<::grpc::ChannelCredentials> credentials,
+      const std::string& address, Allocator* allocator, bool shared_memory)
+      : allocator_(allocator != nullptr ? allocator : cpu_allocator()),
+        shared_memory_(shared_memory) {
+    VLOG(2) << "Create StreamDataTransferClient for worker " << address
+            << (shared_memory ? " using shared memory." : ".");
+    ::grpc::ChannelArguments args;
+    args.SetMaxReceiveMessageSize(-1);
+    channel_ = ::grpc::CreateCustomChannel(address, credentials, args);
+    get_elements_method_ = std::make_unique<::grpc::internal::RpcMethod>(
+        kGetElementsMethod, ::grpc::internal::RpcMethod::NORMAL_RPC,
+        channel_);
+  }
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override {
+    VLOG(3) << "GetElement for task " << req.task_id() << " from stream "
+            << "transfer server.";
+    const bool use_buffer = !req.has_round_index();
+    {
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+      auto it = buffered_elements_.find(req.task_id());
+      if (use_buffer && it != buffered_elements_.end()) {
+        result = std::move(it->second.front());
+        it->second.pop_front();
+        if (it->second.empty()) {
+          buffered_elements_.erase(it);
+        }
+        return absl::OkStatus();
+      }
+    }
+
+    StreamGetElementsRequest request;
+    *request.mutable_request() = req;
+    request.set_max_elements(use_buffer ? kMaxStreamedElementsPerRequest : 1);
+    request.set_use_shared_memory(shared_memory_);
+    ::grpc::Slice request_slice(request.SerializeAsString());
+    ::grpc::ByteBuffer request_buffer(&request_slice, 1);
+    ::grpc::ByteBuffer response_buffer;
+
+    ::grpc::ClientContext ctx;
+    gtl::Cleanup<std::function<void()>> cleanup;
+    {
+      mutex_lock l(mu_);
+      active_contexts_.insert(&ctx);
+      cleanup = gtl::MakeCleanup([this, &ctx] {
+        mutex_lock l(mu_);
+        active_contexts_.erase(&ctx);
+      });
+    }
+    int64_t start_time_us = env_->NowMicros();
+    ::grpc::Status s = ::grpc::internal::BlockingUnaryCall(
+        channel_.get(), *get_elements_method_, &ctx, request_buffer,
+        &response_buffer);
+    int64_t end_time_us = env_->NowMicros();
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get element", s);
+    }
+    metrics::RecordTFDataServiceGetElementDuration(
+        shared_memory_ ? kSharedMemoryTransferProtocol
+                       : kStreamTransferProtocol,
+        end_time_us - start_time_us);
+
+    std::deque<GetElementResult> results;
+    TF_RETURN_IF_ERROR(ParseResponse(response_buffer, results));
+    if (results.empty()) {
+      return errors::Internal("Stream transfer response holds no element.");
+    }
+    result = std::move(results.front());
+    results.pop_front();
+    if (!results.empty()) {
+      mutex_lock l(mu_);
+      std::deque<GetElementResult>& buffered =
+          buffered_elements_[req.task_id()];
+      for (GetElementResult& element : results) {
+        buffered.push_back(std::move(element));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel StreamDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
+    }
+  }
+
+  Status CheckCompatibility(
+      const std::string& server_compatibility_info) const override {
+    if (!shared_memory_) {
+      return absl::OkStatus();
+    }
+    if (server_compatibility_info.empty() ||
+        io::Dirname(server_compatibility_info) != SharedMemoryBaseDirectory() ||
+        !env_->IsDirectory(server_compatibility_info).ok()) {
+      return errors::FailedPrecondition(
+          "The shared memory directory ", server_compatibility_info,
+          " of the worker is not on this host.");
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  // Maps `segment` and deletes its file: the memory is freed once the mapping
+  // is destroyed.
+  Status MapSegment(const std::string& segment,
+                    std::shared_ptr<ReadOnlyMemoryRegion>& region) const {
+    if (!IsSharedMemorySegment(segment)) {
+      return errors::DataLoss("Invalid shared memory segment ", segment, ".");
+    }
+    std::unique_ptr<ReadOnlyMemoryRegion> mapped;
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(segment, &mapped);
+    Status delete_status = env_->DeleteFile(segment);
+    TF_RETURN_IF_ERROR(s);
+    TF_RETURN_IF_ERROR(delete_status);
+    region = std::move(mapped);
+    return absl::OkStatus();
+  }
+
+  Status ParseResponse(const ::grpc::ByteBuffer& response_buffer,
+                       std::deque<GetElementResult>& results) const {
+    std::vector<::grpc::Slice> slices;
+    ::grpc::Status s = response_buffer.Dump(&slices);
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to read stream transfer response",
+                                  s);
+    }
+    SliceReader reader(std::move(slices));
+    char header_size_bytes[kHeaderSizeBytes];
+    TF_RETURN_IF_ERROR(reader.Read(kHeaderSizeBytes, header_size_bytes));
+    const uint64_t header_size = core::DecodeFixed64(header_size_bytes);
+    if (header_size > response_buffer.Length()) {
+      return errors::DataLoss("Invalid stream transfer header size ",
+                              header_size, ".");
+    }
+    std::string header_bytes(header_size, '\0');
+    TF_RETURN_IF_ERROR(reader.Read(header_bytes.size(), header_bytes.data()));
+    StreamGetElementsResponseHeader header;
+    if (!header.ParseFromString(header_bytes)) {
+      return errors::DataLoss("Failed to parse stream transfer header.");
+    }
+    std::shared_ptr<ReadOnlyMemoryRegion> segment;
+    if (!header.shared_memory_segment().empty()) {
+      TF_RETURN_IF_ERROR(MapSegment(header.shared_memory_segment(), segment));
+    }
+
+    for (const StreamedElement& element : header.elements()) {
+      GetElementResult& result = results.emplace_back();
+      result.element_index = element.element_index();
+      result.end_of_sequence = element.end_of_sequence();
+      result.skip = element.skip_task();
+      for (const StreamedComponent& component : element.components()) {
+        const TensorProto& proto = component.tensor();
+        if (!DataTypeCanUseMemcpy(proto.dtype())) {
+          Tensor& tensor = result.components.emplace_back();
+          if (!tensor.FromProto(allocator_, proto)) {
+            return errors::Internal("Failed to parse tensor.");
+          }
+          continue;
+        }
+        TensorShape shape;
+        TF_RETURN_IF_ERROR(
+            TensorShape::BuildTensorShape(proto.tensor_shape(), &shape));
+        if (segment != nullptr && component.num_bytes() > 0) {
+          TF_RETURN_IF_ERROR(AddSegmentTensor(segment, proto.dtype(), shape,
+                                              component, result.components));
+          continue;
+        }
+        Tensor& tensor =
+            result.components.emplace_back(allocator_, proto.dtype(), shape);
+        if (static_cast<int64_t>(tensor.TotalBytes()) !=
+            component.num_bytes()) {
+          return errors::DataLoss("Stream transfer tensor has ",
+                                  component.num_bytes(), " bytes, expected ",
+                                  tensor.TotalBytes(), ".");
+        }
+        TF_RETURN_IF_ERROR(reader.Read(
+            component.num_bytes(),
+            const_cast<char*>(tensor.tensor_data().data())));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  // Adds a tensor pointing to the bytes of `component` in `segment`.
+  static Status AddSegmentTensor(
+      const std::shared_ptr<ReadOnlyMemoryRegion>& segment, DataType dtype,
+      const TensorShape& shape, const StreamedComponent& component,
+      std::vector<Tensor>& components) {
+    const int64_t num_bytes = shape.num_elements() * DataTypeSize(dtype);
+    const int64_t offset = component.segment_offset();
+    if (num_bytes != component.num_bytes() || offset < 0 ||
+        offset % kSegmentAlignment != 0 ||
+        offset > static_cast<int64_t>(segment->length()) - num_bytes) {
+      return errors::DataLoss("Invalid tensor in shared memory segment.");
+    }
+    components.emplace_back(
+        dtype, shape,
+        core::RefCountPtr<TensorBuffer>(new SegmentBuffer(
+            segment, static_cast<const char*>(segment->data()) + offset,
+            num_bytes)));
+    return absl::OkStatus();
+  }
+
+  Allocator* const allocator_;
+  const bool shared_memory_;
+  std::shared_ptr<::grpc::Channel> channel_;
+  std::unique_ptr<::grpc::internal::RpcMethod> get_elements_method_;
+
+  mutex mu_;
+  // Elements returned by previous requests, by task ID.
+  absl::flat_hash_map<int64_t, std::deque<GetElementResult>>
+      buffered_elements_ TF_GUARDED_BY(mu_);
+  // Set of all currently active clients contexts. Used to support
+  // cancellation.
+  absl::flat_hash_set<::grpc::ClientContext*> active_contexts_
+      TF_GUARDED_BY(mu_);
+  // Indicates that the client has been cancelled, so no further requests should
+  // be accepted.
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+};
+
+class StreamTransferRegistrar {
+ public:
+  StreamTransferRegistrar() {
+    Register(kStreamTransferProtocol, /*shared_memory=*/false);
+    Register(kSharedMemoryTransferProtocol, /*shared_memory=*/true);
+  }
+
+ private:
+  static void Register(const std::string& name, bool shared_memory) {
+    DataTransferServer::Register(
+        name, [shared_memory](DataTransferServer::GetElementT get_element,
+                              std::shared_ptr<DataTransferServer>* out) {
+          *out = std::make_shared<StreamDataTransferServer>(
+              std::move(get_element), shared_memory);
+          return absl::OkStatus();
+        });
+    DataTransferClient::Register(
+        name, [shared_memory](DataTransferClient::Config config,
+                              std::unique_ptr<DataTransferClient>* out) {
+          std::shared_ptr<::grpc::ChannelCredentials> credentials;
+          TF_RETURN_IF_ERROR(CredentialsFactory::CreateClientCredentials(
+              config.protocol, &credentials));
+          *out = std::make_unique<StreamDataTransferClient>(
+              credentials, config.address, config.allocator, shared_memory);
+          return absl::OkStatus();
+        });
+  }
+};
+static StreamTransferRegistrar stream_transfer_registrar;
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
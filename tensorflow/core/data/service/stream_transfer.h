@@ -0,0 +1,62 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_STREAM_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_STREAM_TRANSFER_H_
+
+#include <cstdint>
+
+namespace tensorflow {
+namespace data {
+
+// The "stream" data transfer protocol sends the tensors of elements as raw
+// bytes instead of as protos: the worker hands the tensor buffers to gRPC
+// without copying them, and the client copies each tensor once, into memory
+// from its allocator. Each request also returns the elements after the
+// requested one that are ready, up to `kMaxStreamedElementsPerRequest`.
+//
+// Tensors whose contents are not raw bytes, such as strings and compressed
+// elements, are sent as `TensorProto`s, so datasets should be read without
+// compression to benefit from the protocol.
+//
+// The server and client are registered with `DataTransferServer::Register`
+// and `DataTransferClient::Register`.
+constexpr const char kStreamTransferProtocol[] = "stream";
+
+// The "shm" data transfer protocol is the "stream" protocol for clients on the
+// same host as the worker. Instead of sending the raw bytes of the tensors over
+// the socket, the worker writes them to a file in a shared memory file system,
+// which the client maps and deletes: the tensors of the client point into the
+// mapping, and the memory is freed once the last of them is destroyed.
+//
+// The files are created in the directory named by the
+// TF_DATA_SERVICE_SHARED_MEMORY_DIR environment variable, /dev/shm by default.
+// Clients on other hosts fail the compatibility check and fall back to gRPC.
+constexpr const char kSharedMemoryTransferProtocol[] = "shm";
+
+// The maximum number of elements returned by a request.
+constexpr int64_t kMaxStreamedElementsPerRequest = 8;
+
+// Requests stop returning further elements once their tensors exceed this
+// many bytes.
+constexpr int64_t kMaxStreamedBytesPerRequest = 64 << 20;
+
+// Responses with fewer bytes of tensors are sent over the socket even by the
+// "shm" protocol, as creating the file would cost more.
+constexpr int64_t kMinSharedMemoryBytes = 64 << 10;
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_STREAM_TRANSFER_H_
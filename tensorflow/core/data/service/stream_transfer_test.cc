@@ -0,0 +1,250 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/stream_transfer.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<Tensor> MakeElement(int64_t i) {
+  return {test::AsTensor<int64_t>({i, i + 1}),
+          test::AsTensor<tstring>({tstring(absl::StrCat("element_", i))}),
+          test::AsTensor<float>({0.5f * i, 1.0f, 2.0f, 3.0f},
+                                TensorShape({2, 2})),
+          Tensor(DT_INT32, TensorShape({0}))};
+}
+
+// Returns an element too large to be sent over the socket by the "shm"
+// protocol.
+std::vector<Tensor> MakeLargeElement(int64_t i) {
+  std::vector<Tensor> element = MakeElement(i);
+  Tensor large(DT_FLOAT, TensorShape({kMinSharedMemoryBytes / 4}));
+  large.flat<float>().setConstant(i);
+  element.push_back(large);
+  return element;
+}
+
+// Serves `num_elements` elements, all of which are ready.
+class TestWorker {
+ public:
+  TestWorker(int64_t num_elements,
+             std::function<std::vector<Tensor>(int64_t)> make_element)
+      : num_elements_(num_elements), make_element_(std::move(make_element)) {}
+
+  Status GetElement(const GetElementRequest* request,
+                    GetElementResult* result) {
+    mutex_lock l(mu_);
+    if (!request->allow_skip()) {
+      ++num_blocking_calls_;
+    }
+    if (next_element_ == num_elements_) {
+      result->end_of_sequence = true;
+      return absl::OkStatus();
+    }
+    result->element_index = next_element_;
+    result->components = make_element_(next_element_++);
+    return absl::OkStatus();
+  }
+
+  // Returns the number of calls that were allowed to wait for an element,
+  // that is the number of requests.
+  int64_t NumBlockingCalls() {
+    mutex_lock l(mu_);
+    return num_blocking_calls_;
+  }
+
+ private:
+  const int64_t num_elements_;
+  const std::function<std::vector<Tensor>(int64_t)> make_element_;
+  mutex mu_;
+  int64_t next_element_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_blocking_calls_ TF_GUARDED_BY(mu_) = 0;
+};
+
+class StreamTransferTest : public ::testing::Test {
+ protected:
+  void StartServer(int64_t num_elements,
+                   const std::string& protocol = kStreamTransferProtocol,
+                   std::function<std::vector<Tensor>(int64_t)> make_element =
+                       MakeElement) {
+    worker_ = std::make_unique<TestWorker>(num_elements,
+                                           std::move(make_element));
+    TF_ASSERT_OK(DataTransferServer::Build(
+        protocol,
+        [this](const GetElementRequest* request, GetElementResult* result) {
+          return worker_->GetElement(request, result);
+        },
+        &server_));
+    experimental::WorkerConfig config;
+    config.set_protocol("grpc");
+    TF_ASSERT_OK(server_->Start(config));
+    TF_ASSERT_OK(DataTransferClient::Build(
+        protocol,
+        {"grpc", absl::StrCat("localhost:", server_->Port()),
+         /*accelerator_device_info=*/nullptr, /*allocator=*/nullptr},
+        &client_));
+  }
+
+  // Reads `num_elements` elements made by `make_element`, then the end of
+  // sequence.
+  void ExpectElements(
+      int64_t num_elements,
+      std::function<std::vector<Tensor>(int64_t)> make_element) {
+    GetElementRequest request;
+    request.set_task_id(1);
+    for (int64_t i = 0; i < num_elements; ++i) {
+      GetElementResult result;
+      TF_ASSERT_OK(client_->GetElement(request, result));
+      ASSERT_FALSE(result.end_of_sequence);
+      EXPECT_EQ(result.element_index, i);
+      std::vector<Tensor> expected = make_element(i);
+      ASSERT_EQ(result.components.size(), expected.size());
+      for (int j = 0; j < expected.size(); ++j) {
+        test::ExpectEqual(result.components[j], expected[j]);
+      }
+    }
+    GetElementResult result;
+    TF_ASSERT_OK(client_->GetElement(request, result));
+    EXPECT_TRUE(result.end_of_sequence);
+  }
+
+  std::unique_ptr<TestWorker> worker_;
+  std::shared_ptr<DataTransferServer> server_;
+  std::unique_ptr<DataTransferClient> client_;
+};
+
+TEST_F(StreamTransferTest, TransfersElements) {
+  constexpr int64_t kNumElements = 20;
+  StartServer(kNumElements);
+  ExpectElements(kNumElements, MakeElement);
+  // Each request returns the ready elements, up to the maximum.
+  EXPECT_EQ(worker_->NumBlockingCalls(),
+            kNumElements / kMaxStreamedElementsPerRequest + 1);
+}
+
+TEST_F(StreamTransferTest, RoundRobinReadsOneElementPerRequest) {
+  constexpr int64_t kNumElements = 5;
+  StartServer(kNumElements);
+  GetElementRequest request;
+  request.set_task_id(1);
+  request.set_consumer_index(0);
+  for (int64_t i = 0; i < kNumElements; ++i) {
+    request.set_round_index(i);
+    GetElementResult result;
+    TF_ASSERT_OK(client_->GetElement(request, result));
+    EXPECT_EQ(result.element_index, i);
+  }
+  EXPECT_EQ(worker_->NumBlockingCalls(), kNumElements);
+}
+
+TEST_F(StreamTransferTest, Cancel) {
+  StartServer(/*num_elements=*/5);
+  client_->TryCancel();
+  GetElementRequest request;
+  GetElementResult result;
+  EXPECT_TRUE(errors::IsCancelled(client_->GetElement(request, result)));
+}
+
+class SharedMemoryTransferTest : public StreamTransferTest {
+ protected:
+  void SetUp() override {
+    directory_ = io::JoinPath(testing::TmpDir(), "shared_memory");
+    TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(directory_));
+    setenv("TF_DATA_SERVICE_SHARED_MEMORY_DIR", directory_.c_str(),
+           /*overwrite=*/1);
+  }
+
+  // Returns the files left in the shared memory directory of the server.
+  std::vector<std::string> SegmentFiles() {
+    absl::StatusOr<std::string> server_directory =
+        server_->GetCompatibilityInfo();
+    TF_CHECK_OK(server_directory.status());
+    std::vector<std::string> children;
+    TF_CHECK_OK(Env::Default()->GetChildren(*server_directory, &children));
+    return children;
+  }
+
+  std::string directory_;
+};
+
+TEST_F(SharedMemoryTransferTest, TransfersLargeElements) {
+  constexpr int64_t kNumElements = 20;
+  StartServer(kNumElements, kSharedMemoryTransferProtocol, MakeLargeElement);
+  TF_ASSERT_OK(
+      client_->CheckCompatibility(*server_->GetCompatibilityInfo()));
+  ExpectElements(kNumElements, MakeLargeElement);
+  // Clients delete the segments once they have mapped them.
+  EXPECT_TRUE(SegmentFiles().empty());
+}
+
+TEST_F(SharedMemoryTransferTest, TransfersSmallElements) {
+  constexpr int64_t kNumElements = 20;
+  StartServer(kNumElements, kSharedMemoryTransferProtocol);
+  ExpectElements(kNumElements, MakeElement);
+  EXPECT_TRUE(SegmentFiles().empty());
+}
+
+TEST_F(SharedMemoryTransferTest, TensorsOutliveResponses) {
+  StartServer(/*num_elements=*/2, kSharedMemoryTransferProtocol,
+              MakeLargeElement);
+  GetElementRequest request;
+  request.set_task_id(1);
+  request.set_consumer_index(0);
+  std::vector<GetElementResult> results(2);
+  for (int64_t i = 0; i < results.size(); ++i) {
+    request.set_round_index(i);
+    TF_ASSERT_OK(client_->GetElement(request, results[i]));
+  }
+  server_.reset();
+  client_.reset();
+  for (int64_t i = 0; i < results.size(); ++i) {
+    test::ExpectEqual(results[i].components.back(),
+                      MakeLargeElement(i).back());
+  }
+}
+
+TEST_F(SharedMemoryTransferTest, IncompatibleWithRemoteWorkers) {
+  StartServer(/*num_elements=*/1, kSharedMemoryTransferProtocol);
+  EXPECT_TRUE(errors::IsFailedPrecondition(client_->CheckCompatibility(
+      io::JoinPath(directory_, "tf_data_transfer_other_host"))));
+  EXPECT_TRUE(errors::IsFailedPrecondition(client_->CheckCompatibility("")));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
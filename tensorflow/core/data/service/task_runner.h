@@ -17,10 +17,13 @@ limitations under the License.
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
+#include "tensorflow/core/data/service/cross_trainer_cache_disk_tier.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/thread_safe_buffer.h"
 #include "tensorflow/core/data/service/worker.pb.h"
@@ -146,15 +149,27 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
   void operator=(const FirstComeFirstServedTaskRunner&) = delete;
 };
 
+// Serializes `element`, including its `end_of_sequence` and `skip` flags, as a
+// `GetElementResponse`. Used to spill elements to a cross-trainer cache disk
+// tier.
+absl::StatusOr<std::string> SerializeGetElementResult(
+    const GetElementResult& element);
+
+// Parses an element serialized by `SerializeGetElementResult`.
+absl::StatusOr<GetElementResult> DeserializeGetElementResult(
+    absl::string_view serialized);
+
 // A task runner which prefetches elements on a first-come first-served basis
 // and caches elements in a sliding-window `CrossTrainerCache`. The cache has a
 // bounded size and progresses when a trainer that has consumed all elements in
 // the cache. Trainers read from a sliding window of the dataset and may not
-// read the full dataset.
+// read the full dataset. With a `disk_tier`, elements evicted from memory are
+// spilled to disk, so trainers which fall behind read them from there.
 class CachingTaskRunner : public TaskRunner {
  public:
-  explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                             size_t max_cache_size_bytes);
+  explicit CachingTaskRunner(
+      std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+      std::unique_ptr<CrossTrainerCacheDiskTier> disk_tier = nullptr);
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -180,6 +195,10 @@ class CachingTaskRunner : public TaskRunner {
         FirstComeFirstServedTaskRunner& fcfs_task_runner);
     absl::StatusOr<GetElementResult> GetNext() override;
     size_t GetElementSizeBytes(const GetElementResult& element) const override;
+    absl::StatusOr<std::string> SerializeElement(
+        const GetElementResult& element) const override;
+    absl::StatusOr<GetElementResult> DeserializeElement(
+        absl::string_view serialized) const override;
 
    private:
     FirstComeFirstServedTaskRunner& fcfs_task_runner_;
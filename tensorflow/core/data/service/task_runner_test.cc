@@ -303,6 +303,40 @@ TEST(FirstComeFirstServedTaskRunnerTest, Error) {
               testing::StatusIs(error::ABORTED));
 }
 
+TEST(GetElementResultSerializationTest, RoundTrip) {
+  GetElementResult element;
+  element.components = {Tensor(int64_t{7}), Tensor(tstring("seven"))};
+  element.element_index = 7;
+  element.skip = true;
+  TF_ASSERT_OK_AND_ASSIGN(std::string serialized,
+                          SerializeGetElementResult(element));
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                          DeserializeGetElementResult(serialized));
+  EXPECT_EQ(result.element_index, 7);
+  EXPECT_FALSE(result.end_of_sequence);
+  EXPECT_TRUE(result.skip);
+  ASSERT_EQ(result.components.size(), 2);
+  test::ExpectEqual(result.components[0], element.components[0]);
+  test::ExpectEqual(result.components[1], element.components[1]);
+}
+
+TEST(GetElementResultSerializationTest, RoundTripEndOfSequence) {
+  GetElementResult element;
+  element.end_of_sequence = true;
+  TF_ASSERT_OK_AND_ASSIGN(std::string serialized,
+                          SerializeGetElementResult(element));
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                          DeserializeGetElementResult(serialized));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_FALSE(result.skip);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST(GetElementResultSerializationTest, InvalidData) {
+  EXPECT_THAT(DeserializeGetElementResult("not a proto"),
+              StatusIs(error::DATA_LOSS));
+}
+
 TEST(CachingTaskRunnerTest, GetNext) {
   size_t range = 10;
   CachingTaskRunner runner(std::make_unique<InfiniteRangeIterator>(),
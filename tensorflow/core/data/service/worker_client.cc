@@ -79,6 +79,12 @@ Status DataServiceWorkerClient::GetElement(const GetElementRequest& req,
   return client_->GetElement(req, result);
 }
 
+Status DataServiceWorkerClient::GetElements(
+    const GetElementRequest& req, std::vector<GetElementResult>& results) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  return client_->GetElements(req, results);
+}
+
 Status DataServiceWorkerClient::EnsureInitialized() {
   mutex_lock l(mu_);
   if (client_) {
@@ -112,6 +118,16 @@ class GrpcDataTransferClient : public DataTransferClient {
 
   Status GetElement(const GetElementRequest& req,
                     GetElementResult& result) override {
+    GetElementRequest single_element_req = req;
+    single_element_req.clear_max_elements();
+    std::vector<GetElementResult> results;
+    TF_RETURN_IF_ERROR(GetElements(single_element_req, results));
+    result = std::move(results.front());
+    return absl::OkStatus();
+  }
+
+  Status GetElements(const GetElementRequest& req,
+                     std::vector<GetElementResult>& results) override {
     VLOG(3) << "GetElement for task " << req.task_id() << " from gRPC worker "
             << "server.";
     {
@@ -139,6 +155,25 @@ class GrpcDataTransferClient : public DataTransferClient {
     }
     metrics::RecordTFDataServiceGetElementDuration(kGrpcTransferProtocol,
                                                    end_time_us - start_time_us);
+    TF_RETURN_IF_ERROR(ParseResponse(resp, results.emplace_back()));
+    for (GetElementResponse& additional : *resp.mutable_additional_elements()) {
+      TF_RETURN_IF_ERROR(ParseResponse(additional, results.emplace_back()));
+    }
+    return absl::OkStatus();
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel GrpcDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
+    }
+  }
+
+ private:
+  static Status ParseResponse(GetElementResponse& resp,
+                              GetElementResult& result) {
     result.end_of_sequence = resp.end_of_sequence();
     result.skip = resp.skip_task();
     switch (resp.element_case()) {
@@ -162,16 +197,6 @@ class GrpcDataTransferClient : public DataTransferClient {
     return absl::OkStatus();
   }
 
-  void TryCancel() override {
-    VLOG(2) << "Cancel GrpcDataTransferClient.";
-    mutex_lock l(mu_);
-    cancelled_ = true;
-    for (const auto& ctx : active_contexts_) {
-      ctx->TryCancel();
-    }
-  }
-
- private:
   mutex mu_;
   std::unique_ptr<WorkerService::Stub> stub_;
   // Set of all currently active clients contexts. Used to support
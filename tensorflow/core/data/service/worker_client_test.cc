@@ -18,6 +18,7 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/substitute.h"
@@ -199,6 +200,39 @@ TEST_F(WorkerClientTest, GrpcRead) {
   }
 }
 
+TEST_F(WorkerClientTest, GrpcReadMultipleElements) {
+  LocalWorkers::Remove(GetWorkerAddress());
+
+  const int64_t range = 10;
+  TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id, RegisterDataset(range));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t iteration_client_id,
+                          CreateIteration(dataset_id));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t task_id,
+                          GetTaskToRead(iteration_client_id));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataServiceWorkerClient> client,
+                          GetWorkerClient(kGrpcTransferProtocol));
+  GetElementRequest request;
+  request.set_task_id(task_id);
+  request.set_max_elements(4);
+  std::vector<int64_t> elements;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<GetElementResult> results;
+    TF_ASSERT_OK(client->GetElements(request, results));
+    ASSERT_GE(results.size(), 1);
+    ASSERT_LE(results.size(), 4);
+    for (const GetElementResult& result : results) {
+      ASSERT_FALSE(end_of_sequence);
+      end_of_sequence = result.end_of_sequence;
+      if (!end_of_sequence) {
+        elements.push_back(result.components[0].scalar<int64_t>()());
+      }
+    }
+  }
+  EXPECT_EQ(elements,
+            std::vector<int64_t>({0, 1, 4, 9, 16, 25, 36, 49, 64, 81}));
+}
+
 TEST_F(WorkerClientTest, LocalServerShutsDown) {
   TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id,
                           RegisterDataset(/*range=*/5));
@@ -76,6 +76,9 @@ namespace {
 constexpr absl::Duration kRetryInterval = absl::Seconds(5);
 constexpr absl::Duration kDefaultHeartBeatInterval = absl::Seconds(30);
 constexpr absl::Duration kDefaultDispatcherTimeout = absl::Hours(1);
+// Requests for several elements stop adding elements once their response
+// exceeds this size.
+constexpr int64_t kMaxBatchedResponseBytes = 16 << 20;
 
 using WorkerConfig = experimental::WorkerConfig;
 
@@ -104,6 +107,18 @@ Status MoveElementToResponse(std::vector<Tensor>&& element,
   return absl::OkStatus();
 }
 
+// Moves `result` into the response.
+Status MoveResultToResponse(GetElementResult&& result,
+                            GetElementResponse& resp) {
+  resp.set_end_of_sequence(result.end_of_sequence);
+  resp.set_skip_task(result.skip);
+  if (!resp.end_of_sequence() && !resp.skip_task()) {
+    TF_RETURN_IF_ERROR(
+        MoveElementToResponse(std::move(result.components), resp));
+  }
+  return absl::OkStatus();
+}
+
 WorkerConfig ApplyWorkerDefaults(const WorkerConfig& config) {
   WorkerConfig new_config(config);
   if (new_config.heartbeat_interval_ms() == 0) {
@@ -450,8 +465,9 @@ DataServiceWorkerImpl::MakeDatasetIterator(standalone::Dataset& dataset,
     split_providers.reserve(task_def.num_split_providers());
     for (int i = 0; i < task_def.num_split_providers(); ++i) {
       split_providers.push_back(std::make_unique<DataServiceSplitProvider>(
-          config_.dispatcher_address(), config_.protocol(),
-          task_def.iteration_id(), i, config_.dispatcher_timeout_ms()));
+          config_.dispatcher_address(), config_.protocol(), worker_address_,
+          task_def.iteration_id(), i, config_.dispatcher_timeout_ms(),
+          config_.splits_per_request()));
     }
     TF_RETURN_IF_ERROR(
         dataset.MakeIterator(std::move(split_providers), &iterator));
@@ -481,12 +497,40 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
   VLOG(3) << "Received GetElement request for task " << request->task_id();
   struct GetElementResult result;
   TF_RETURN_IF_ERROR(GetElementResult(request, &result));
-  response->set_end_of_sequence(result.end_of_sequence);
-  response->set_skip_task(result.skip);
-  if (!response->end_of_sequence() && !response->skip_task()) {
-    TF_RETURN_IF_ERROR(
-        MoveElementToResponse(std::move(result.components), *response));
-    VLOG(3) << "Producing an element for task " << request->task_id();
+  TF_RETURN_IF_ERROR(MoveResultToResponse(std::move(result), *response));
+  if (response->end_of_sequence() || response->skip_task()) {
+    return absl::OkStatus();
+  }
+  VLOG(3) << "Producing an element for task " << request->task_id();
+
+  // Round robin reads get exactly one element per round.
+  const int64_t max_elements =
+      request->has_round_index() ? 1 : request->max_elements();
+  GetElementRequest next_request = *request;
+  // Only wait for the first element.
+  next_request.set_allow_skip(true);
+  int64_t response_bytes = response->ByteSizeLong();
+  while (response->additional_elements_size() + 1 < max_elements &&
+         response_bytes < kMaxBatchedResponseBytes) {
+    struct GetElementResult next;
+    Status s = GetElementResult(&next_request, &next);
+    if (!s.ok()) {
+      // Return the elements already produced; the next request will get the
+      // error.
+      VLOG(1) << "Failed to get an additional element for task "
+              << request->task_id() << ": " << s;
+      break;
+    }
+    if (next.skip) {
+      // No further element is ready.
+      break;
+    }
+    GetElementResponse* additional = response->add_additional_elements();
+    TF_RETURN_IF_ERROR(MoveResultToResponse(std::move(next), *additional));
+    if (additional->end_of_sequence()) {
+      break;
+    }
+    response_bytes += additional->ByteSizeLong();
   }
   return absl::OkStatus();
 }
@@ -666,6 +710,14 @@ WorkerHeartbeatRequest DataServiceWorkerImpl::BuildWorkerHeartbeatRequest()
          snapshot_task_progress});
   }
   *request.mutable_active_tasks() = {active_tasks.begin(), active_tasks.end()};
+  {
+    mutex_lock l(mu_);
+    int64_t outstanding_requests = 0;
+    for (const auto& [task_id, task] : tasks_) {
+      outstanding_requests += task->outstanding_requests;
+    }
+    request.set_outstanding_requests(outstanding_requests);
+  }
   return request;
 }
 
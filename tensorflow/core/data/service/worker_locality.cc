@@ -0,0 +1,111 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/worker_locality.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kClientTagsEnvVar[] = "TF_DATA_SERVICE_CLIENT_TAGS";
+
+// Returns the name of the topology tag of `level` in `tags`, if any.
+std::optional<absl::string_view> TopologyName(
+    absl::Span<const std::string> tags, absl::string_view level) {
+  for (absl::string_view tag : tags) {
+    std::pair<absl::string_view, absl::string_view> level_and_name =
+        absl::StrSplit(tag, absl::MaxSplits(':', 1));
+    if (!level_and_name.second.empty() &&
+        absl::EqualsIgnoreCase(level_and_name.first, level)) {
+      return level_and_name.second;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+std::vector<std::string> ClientTopologyTags() {
+  const char* tags = std::getenv(kClientTagsEnvVar);
+  if (tags == nullptr) {
+    return {};
+  }
+  std::vector<std::string> client_tags;
+  for (absl::string_view tag : absl::StrSplit(tags, ',')) {
+    tag = absl::StripAsciiWhitespace(tag);
+    if (!tag.empty()) {
+      client_tags.emplace_back(tag);
+    }
+  }
+  return client_tags;
+}
+
+int64_t TopologyDistance(absl::Span<const std::string> client_tags,
+                         absl::Span<const std::string> worker_tags) {
+  const absl::string_view levels[] = {kHostTopologyLevel, kRackTopologyLevel,
+                                      kZoneTopologyLevel};
+  for (int64_t distance = 0; distance < kMaxTopologyDistance; ++distance) {
+    std::optional<absl::string_view> client_name =
+        TopologyName(client_tags, levels[distance]);
+    if (client_name.has_value() &&
+        client_name == TopologyName(worker_tags, levels[distance])) {
+      return distance;
+    }
+  }
+  return kMaxTopologyDistance;
+}
+
+void OrderTasksByLocalityAndLoad(
+    absl::Span<const std::string> client_tags,
+    const absl::flat_hash_map<std::string, int64_t>& worker_loads,
+    int64_t client_id, protobuf::RepeatedPtrField<TaskInfo>& tasks) {
+  using Key = std::tuple<int64_t, int64_t, size_t>;
+  absl::flat_hash_map<int64_t, Key> keys;
+  for (const TaskInfo& task : tasks) {
+    const std::vector<std::string> worker_tags(task.worker_tags().begin(),
+                                               task.worker_tags().end());
+    auto load = worker_loads.find(task.worker_address());
+    keys[task.task_id()] = Key(
+        TopologyDistance(client_tags, worker_tags),
+        load == worker_loads.end() ? std::numeric_limits<int64_t>::max()
+                                   : load->second,
+        absl::HashOf(client_id, task.task_id()));
+  }
+  std::sort(tasks.begin(), tasks.end(),
+            [&keys](const TaskInfo& a, const TaskInfo& b) {
+              return keys[a.task_id()] < keys[b.task_id()];
+            });
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,63 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_WORKER_LOCALITY_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_WORKER_LOCALITY_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace data {
+
+// Topology tags describe where a worker or client runs. They are worker tags
+// of the form "<LEVEL>:<name>", where <LEVEL> is HOST, RACK or ZONE, e.g.
+// "ZONE:us-east1-b". Clients read theirs from the TF_DATA_SERVICE_CLIENT_TAGS
+// environment variable, as a comma-separated list of tags.
+constexpr char kHostTopologyLevel[] = "HOST";
+constexpr char kRackTopologyLevel[] = "RACK";
+constexpr char kZoneTopologyLevel[] = "ZONE";
+
+// The distance of workers which share no topology tag with the client.
+constexpr int64_t kMaxTopologyDistance = 3;
+
+// Returns the topology tags of this client.
+std::vector<std::string> ClientTopologyTags();
+
+// Returns the distance between a client and a worker: 0 if they are on the
+// same host, 1 in the same rack, 2 in the same zone, and
+// `kMaxTopologyDistance` otherwise or if either has no topology tags.
+int64_t TopologyDistance(absl::Span<const std::string> client_tags,
+                         absl::Span<const std::string> worker_tags);
+
+// Orders `tasks` by increasing topology distance to the client, then by
+// increasing load of their workers, given by `worker_loads` which maps worker
+// addresses to the number of requests they are serving. Tasks of unknown load
+// come last in their distance. Ties are broken by a hash of `client_id` and
+// the task ID, so that clients don't all prefer the same worker.
+void OrderTasksByLocalityAndLoad(
+    absl::Span<const std::string> client_tags,
+    const absl::flat_hash_map<std::string, int64_t>& worker_loads,
+    int64_t client_id, protobuf::RepeatedPtrField<TaskInfo>& tasks);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_WORKER_LOCALITY_H_
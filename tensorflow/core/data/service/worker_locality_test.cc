@@ -0,0 +1,103 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/worker_locality.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TaskInfo MakeTask(int64_t task_id, const std::string& worker_address,
+                  const std::vector<std::string>& worker_tags) {
+  TaskInfo task;
+  task.set_task_id(task_id);
+  task.set_worker_address(worker_address);
+  for (const std::string& tag : worker_tags) {
+    task.add_worker_tags(tag);
+  }
+  return task;
+}
+
+std::vector<int64_t> TaskIds(
+    const protobuf::RepeatedPtrField<TaskInfo>& tasks) {
+  std::vector<int64_t> task_ids;
+  for (const TaskInfo& task : tasks) {
+    task_ids.push_back(task.task_id());
+  }
+  return task_ids;
+}
+
+TEST(WorkerLocalityTest, TopologyDistance) {
+  const std::vector<std::string> client = {"HOST:a", "RACK:r1", "ZONE:z1"};
+  EXPECT_EQ(TopologyDistance(client, {"HOST:a", "RACK:r1", "ZONE:z1"}), 0);
+  EXPECT_EQ(TopologyDistance(client, {"HOST:b", "RACK:r1", "ZONE:z1"}), 1);
+  EXPECT_EQ(TopologyDistance(client, {"host:b", "rack:r2", "zone:z1"}), 2);
+  EXPECT_EQ(TopologyDistance(client, {"HOST:b", "RACK:r2", "ZONE:z2"}),
+            kMaxTopologyDistance);
+  EXPECT_EQ(TopologyDistance(client, {"COLOCATED"}), kMaxTopologyDistance);
+  EXPECT_EQ(TopologyDistance({}, {"HOST:a"}), kMaxTopologyDistance);
+}
+
+TEST(WorkerLocalityTest, ClientTopologyTags) {
+  setenv("TF_DATA_SERVICE_CLIENT_TAGS", "HOST:a, ZONE:z1,", /*overwrite=*/1);
+  EXPECT_THAT(ClientTopologyTags(), ElementsAre("HOST:a", "ZONE:z1"));
+  unsetenv("TF_DATA_SERVICE_CLIENT_TAGS");
+  EXPECT_THAT(ClientTopologyTags(), IsEmpty());
+}
+
+TEST(WorkerLocalityTest, OrdersByLocalityThenLoad) {
+  protobuf::RepeatedPtrField<TaskInfo> tasks;
+  *tasks.Add() = MakeTask(1, "far_idle", {"ZONE:z2"});
+  *tasks.Add() = MakeTask(2, "zone_busy", {"ZONE:z1"});
+  *tasks.Add() = MakeTask(3, "zone_idle", {"ZONE:z1"});
+  *tasks.Add() = MakeTask(4, "zone_unknown_load", {"ZONE:z1"});
+  *tasks.Add() = MakeTask(5, "local_busy", {"HOST:a", "ZONE:z1"});
+  const absl::flat_hash_map<std::string, int64_t> loads = {
+      {"far_idle", 0}, {"zone_busy", 10}, {"zone_idle", 1}, {"local_busy", 50}};
+  OrderTasksByLocalityAndLoad({"HOST:a", "ZONE:z1"}, loads, /*client_id=*/0,
+                              tasks);
+  EXPECT_THAT(TaskIds(tasks), ElementsAre(5, 3, 2, 4, 1));
+}
+
+TEST(WorkerLocalityTest, ClientsBreakTiesDifferently) {
+  protobuf::RepeatedPtrField<TaskInfo> tasks;
+  for (int64_t i = 0; i < 10; ++i) {
+    *tasks.Add() = MakeTask(i, absl::StrCat("worker_", i), {});
+  }
+  std::vector<std::vector<int64_t>> orders;
+  for (int64_t client_id = 0; client_id < 4; ++client_id) {
+    OrderTasksByLocalityAndLoad({}, /*worker_loads=*/{}, client_id, tasks);
+    orders.push_back(TaskIds(tasks));
+  }
+  EXPECT_TRUE(orders[0] != orders[1] || orders[0] != orders[2] ||
+              orders[0] != orders[3]);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,169 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shared_worker_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/resource.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// A pipeline that had work to run within this period counts as active when
+// dividing the threads.
+constexpr uint64_t kActivePeriodUsec = 10 * EnvTime::kSecondsToMicros;
+
+// The period over which the CPU share of the pipelines is measured.
+constexpr uint64_t kMetricsPeriodUsec = 10 * EnvTime::kSecondsToMicros;
+
+}  // namespace
+
+// static
+SharedWorkerPool* SharedWorkerPool::Global() {
+  static SharedWorkerPool* pool = new SharedWorkerPool(
+      Env::Default(), "tf_data_shared_worker_pool", GetCpuBudget());
+  return pool;
+}
+
+SharedWorkerPool::SharedWorkerPool(Env* env, const std::string& name,
+                                   int num_threads)
+    : env_(env),
+      num_threads_(std::max(num_threads, 1)),
+      last_metrics_usec_(env->NowMicros()),
+      thread_pool_(std::make_unique<thread::ThreadPool>(
+          env, ThreadOptions{}, name, num_threads_)) {}
+
+SharedWorkerPool::~SharedWorkerPool() {
+  mutex_lock l(mu_);
+  DCHECK(pipelines_.empty());
+}
+
+std::unique_ptr<SharedWorkerPool::Pipeline> SharedWorkerPool::RegisterPipeline(
+    const std::string& name) {
+  auto state = std::make_unique<PipelineState>(name);
+  {
+    mutex_lock l(mu_);
+    pipelines_.insert(state.get());
+  }
+  return absl::WrapUnique(new Pipeline(this, std::move(state)));
+}
+
+void SharedWorkerPool::Schedule(PipelineState* pipeline,
+                                std::function<void()> fn) {
+  {
+    mutex_lock l(mu_);
+    if (pipeline->queue.empty()) {
+      ready_.push_back(pipeline);
+    }
+    pipeline->queue.push_back(std::move(fn));
+    ++pipeline->num_pending;
+  }
+  // Each closure runs the next item of work of any pipeline, so there is
+  // always as much work queued as there are closures waiting to run.
+  thread_pool_->Schedule([this]() { RunNext(); });
+}
+
+void SharedWorkerPool::RunNext() {
+  PipelineState* pipeline;
+  std::function<void()> fn;
+  {
+    mutex_lock l(mu_);
+    DCHECK(!ready_.empty());
+    pipeline = ready_.front();
+    ready_.pop_front();
+    fn = std::move(pipeline->queue.front());
+    pipeline->queue.pop_front();
+    if (!pipeline->queue.empty()) {
+      ready_.push_back(pipeline);
+    }
+  }
+  const uint64_t start_usec = env_->NowMicros();
+  {
+    tensorflow::ResourceTagger tag(kTFDataResourceTag, "SharedWorkerPool");
+    fn();
+  }
+  const uint64_t end_usec = env_->NowMicros();
+  mutex_lock l(mu_);
+  pipeline->busy_usec += end_usec - start_usec;
+  pipeline->last_active_usec = end_usec;
+  if (--pipeline->num_pending == 0) {
+    pipeline_done_.notify_all();
+  }
+  MaybeRecordCpuSharesLocked(end_usec);
+}
+
+void SharedWorkerPool::Unregister(PipelineState* pipeline) {
+  mutex_lock l(mu_);
+  while (pipeline->num_pending > 0) {
+    pipeline_done_.wait(l);
+  }
+  pipelines_.erase(pipeline);
+  for (const PipelineState* other : pipelines_) {
+    if (other->name == pipeline->name) {
+      return;
+    }
+  }
+  metrics::RecordTFDataPipelineCpuShare(pipeline->name, 0.0);
+}
+
+int64_t SharedWorkerPool::CpuBudget(PipelineState* pipeline) {
+  mutex_lock l(mu_);
+  const uint64_t now_usec = env_->NowMicros();
+  MaybeRecordCpuSharesLocked(now_usec);
+  int64_t num_active = 0;
+  for (const PipelineState* other : pipelines_) {
+    if (other == pipeline || other->num_pending > 0 ||
+        (other->last_active_usec > 0 &&
+         now_usec - other->last_active_usec < kActivePeriodUsec)) {
+      ++num_active;
+    }
+  }
+  return std::max<int64_t>(1, num_threads_ / num_active);
+}
+
+void SharedWorkerPool::MaybeRecordCpuSharesLocked(uint64_t now_usec) {
+  if (now_usec - last_metrics_usec_ < kMetricsPeriodUsec) {
+    return;
+  }
+  // The share of the pool's capacity, rather than of its busy time, so that
+  // the shares show how much of the pool is left unused.
+  const double capacity_usec =
+      static_cast<double>(now_usec - last_metrics_usec_) * num_threads_;
+  absl::flat_hash_map<std::string, double> shares;
+  for (PipelineState* pipeline : pipelines_) {
+    shares[pipeline->name] += pipeline->busy_usec / capacity_usec;
+    pipeline->busy_usec = 0;
+  }
+  for (const auto& [name, share] : shares) {
+    metrics::RecordTFDataPipelineCpuShare(name, share);
+  }
+  last_metrics_usec_ = now_usec;
+}
+
+}  // namespace data
+}  // namespace tensorflow
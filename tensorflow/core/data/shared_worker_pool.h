@@ -0,0 +1,142 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SHARED_WORKER_POOL_H_
+#define TENSORFLOW_CORE_DATA_SHARED_WORKER_POOL_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+
+// A `SharedWorkerPool` runs the work of many input pipelines on one fixed set
+// of threads, instead of each pipeline running its work on a thread pool of
+// its own. Work is taken from the pipelines in round-robin order, so a
+// pipeline with a deep backlog cannot starve the others.
+//
+// The pool also divides its threads between the pipelines that are active, to
+// be used as their autotuning CPU budget, and records the fraction of the
+// pool's capacity used by the pipelines in the
+// `/tensorflow/data/pipeline_cpu_share` metric.
+class SharedWorkerPool {
+ public:
+  class Pipeline;
+
+  // Returns the process-wide pool, which has `GetCpuBudget()` threads.
+  static SharedWorkerPool* Global();
+
+  SharedWorkerPool(Env* env, const std::string& name, int num_threads);
+
+  // Waits for the scheduled work to complete. All pipelines must have been
+  // unregistered.
+  ~SharedWorkerPool();
+
+  // Registers a pipeline with the pool. `name` labels the pipeline's metric,
+  // which sums the shares of the pipelines with the same name, so it should
+  // take few values, such as the type of the pipeline's dataset.
+  std::unique_ptr<Pipeline> RegisterPipeline(const std::string& name);
+
+  int NumThreads() const { return num_threads_; }
+
+ private:
+  struct PipelineState {
+    explicit PipelineState(const std::string& name) : name(name) {}
+    const std::string name;
+    // Work that has been scheduled but has not started.
+    std::deque<std::function<void()>> queue;
+    // The number of items of work that have not completed.
+    int64_t num_pending = 0;
+    // The time spent running the pipeline's work since the metric was last
+    // recorded.
+    int64_t busy_usec = 0;
+    // The last time the pipeline had work to run.
+    uint64_t last_active_usec = 0;
+  };
+
+  void Schedule(PipelineState* pipeline, std::function<void()> fn)
+      TF_LOCKS_EXCLUDED(mu_);
+  // Runs the next item of work, taking the pipelines in round-robin order.
+  void RunNext() TF_LOCKS_EXCLUDED(mu_);
+  void Unregister(PipelineState* pipeline) TF_LOCKS_EXCLUDED(mu_);
+  // Returns the fair share of the threads for `pipeline`.
+  int64_t CpuBudget(PipelineState* pipeline) TF_LOCKS_EXCLUDED(mu_);
+  // Records the CPU share metric of each pipeline if enough time has passed
+  // since it was last recorded.
+  void MaybeRecordCpuSharesLocked(uint64_t now_usec)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const int num_threads_;
+
+  mutex mu_;
+  condition_variable pipeline_done_;
+  absl::flat_hash_set<PipelineState*> pipelines_ TF_GUARDED_BY(mu_);
+  // The pipelines with work that has not started, in the order in which they
+  // are served.
+  std::deque<PipelineState*> ready_ TF_GUARDED_BY(mu_);
+  uint64_t last_metrics_usec_ TF_GUARDED_BY(mu_) = 0;
+
+  // Must be ordered last, so that it is destroyed (and waits for the scheduled
+  // work) first.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+
+  SharedWorkerPool(const SharedWorkerPool&) = delete;
+  void operator=(const SharedWorkerPool&) = delete;
+};
+
+// The handle of a pipeline registered with a `SharedWorkerPool`. It is
+// unregistered when the handle is destroyed, which waits for the work it
+// scheduled to complete.
+class SharedWorkerPool::Pipeline {
+ public:
+  ~Pipeline() { pool_->Unregister(state_.get()); }
+
+  // Schedules `fn` to run on the pool.
+  void Schedule(std::function<void()> fn) {
+    pool_->Schedule(state_.get(), std::move(fn));
+  }
+
+  // Returns the number of threads this pipeline should plan to use, which is
+  // the pool's threads divided evenly between the active pipelines. A
+  // pipeline is active if it had work to run recently, so idle pipelines do
+  // not reduce the budget of the others.
+  int64_t CpuBudget() { return pool_->CpuBudget(state_.get()); }
+
+  int NumThreads() const { return pool_->NumThreads(); }
+
+ private:
+  friend class SharedWorkerPool;
+
+  Pipeline(SharedWorkerPool* pool, std::unique_ptr<PipelineState> state)
+      : pool_(pool), state_(std::move(state)) {}
+
+  SharedWorkerPool* const pool_;  // Not owned.
+  const std::unique_ptr<PipelineState> state_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SHARED_WORKER_POOL_H_
@@ -0,0 +1,116 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shared_worker_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(SharedWorkerPool, RunsWorkOfAllPipelines) {
+  SharedWorkerPool pool(Env::Default(), "test", /*num_threads=*/4);
+  std::atomic<int> count(0);
+  {
+    auto pipeline1 = pool.RegisterPipeline("1");
+    auto pipeline2 = pool.RegisterPipeline("2");
+    for (int i = 0; i < 100; ++i) {
+      pipeline1->Schedule([&count]() { ++count; });
+      pipeline2->Schedule([&count]() { ++count; });
+    }
+    // Unregistering waits for the scheduled work.
+  }
+  EXPECT_EQ(count, 200);
+}
+
+TEST(SharedWorkerPool, TakesPipelinesInRoundRobinOrder) {
+  SharedWorkerPool pool(Env::Default(), "test", /*num_threads=*/1);
+  auto pipeline1 = pool.RegisterPipeline("1");
+  auto pipeline2 = pool.RegisterPipeline("2");
+
+  Notification started, unblock;
+  mutex mu;
+  std::vector<std::string> order;
+  auto record = [&mu, &order](const std::string& name) {
+    return [&mu, &order, name]() {
+      mutex_lock l(mu);
+      order.push_back(name);
+    };
+  };
+  pipeline1->Schedule([&started, &unblock]() {
+    started.Notify();
+    unblock.WaitForNotification();
+  });
+  started.WaitForNotification();
+  pipeline1->Schedule(record("1a"));
+  pipeline1->Schedule(record("1b"));
+  pipeline1->Schedule(record("1c"));
+  pipeline2->Schedule(record("2a"));
+  unblock.Notify();
+  pipeline1.reset();
+  pipeline2.reset();
+
+  EXPECT_EQ(order, std::vector<std::string>({"1a", "2a", "1b", "1c"}));
+}
+
+TEST(SharedWorkerPool, DividesCpuBudgetBetweenActivePipelines) {
+  SharedWorkerPool pool(Env::Default(), "test", /*num_threads=*/8);
+  auto pipeline1 = pool.RegisterPipeline("1");
+  EXPECT_EQ(pipeline1->CpuBudget(), 8);
+
+  auto pipeline2 = pool.RegisterPipeline("2");
+  // A pipeline that has not run any work does not reduce the budget of the
+  // others.
+  EXPECT_EQ(pipeline1->CpuBudget(), 8);
+  EXPECT_EQ(pipeline2->CpuBudget(), 8);
+
+  BlockingCounter counter(2);
+  pipeline1->Schedule([&counter]() { counter.DecrementCount(); });
+  pipeline2->Schedule([&counter]() { counter.DecrementCount(); });
+  counter.Wait();
+  EXPECT_EQ(pipeline1->CpuBudget(), 4);
+  EXPECT_EQ(pipeline2->CpuBudget(), 4);
+
+  pipeline2.reset();
+  EXPECT_EQ(pipeline1->CpuBudget(), 8);
+}
+
+TEST(SharedWorkerPool, KeepsCpuShareWhilePipelinesWithSameNameRemain) {
+  monitoring::testing::CellReader<double> cell_reader(
+      "/tensorflow/data/pipeline_cpu_share");
+  SharedWorkerPool pool(Env::Default(), "test", /*num_threads=*/2);
+  auto pipeline1 = pool.RegisterPipeline("SameName");
+  auto pipeline2 = pool.RegisterPipeline("SameName");
+  metrics::RecordTFDataPipelineCpuShare("SameName", 0.5);
+
+  pipeline1.reset();
+  EXPECT_EQ(cell_reader.Read("SameName"), 0.5);
+  pipeline2.reset();
+  EXPECT_EQ(cell_reader.Read("SameName"), 0.0);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,362 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shuffle_buffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// The size of the header preceding each record: the index of its slot and the
+// size of its data.
+constexpr int64_t kHeaderBytes = 2 * sizeof(int64_t);
+
+// The size of the first slab. Slabs double in size up to `slab_bytes`, so that
+// small buffers do not allocate a full slab.
+constexpr int64_t kMinSlabBytes = 64 << 10;
+
+}  // namespace
+
+Status VectorShuffleBuffer::Resize(int64_t size) {
+  for (int64_t i = size; i < slots_.size(); ++i) {
+    resident_bytes_ -= GetTotalBytes(slots_[i]);
+  }
+  slots_.resize(size);
+  return absl::OkStatus();
+}
+
+Status VectorShuffleBuffer::Set(int64_t index, std::vector<Tensor> element) {
+  resident_bytes_ += GetTotalBytes(element) - GetTotalBytes(slots_[index]);
+  slots_[index] = std::move(element);
+  return absl::OkStatus();
+}
+
+Status VectorShuffleBuffer::Take(int64_t index, std::vector<Tensor>* out) {
+  resident_bytes_ -= GetTotalBytes(slots_[index]);
+  *out = std::move(slots_[index]);
+  slots_[index].clear();
+  return absl::OkStatus();
+}
+
+Status VectorShuffleBuffer::Get(int64_t index,
+                                std::vector<Tensor>* out) const {
+  *out = slots_[index];
+  return absl::OkStatus();
+}
+
+void VectorShuffleBuffer::Swap(int64_t a, int64_t b) {
+  std::swap(slots_[a], slots_[b]);
+}
+
+CompactShuffleBuffer::CompactShuffleBuffer(Env* env, const Options& options,
+                                           int64_t size)
+    : env_(env), options_(options), locations_(size) {}
+
+CompactShuffleBuffer::~CompactShuffleBuffer() {
+  for (auto& [id, slab] : slabs_) {
+    if (!slab->filename.empty()) {
+      slab->file.reset();
+      env_->DeleteFile(slab->filename).IgnoreError();
+    }
+  }
+}
+
+Status CompactShuffleBuffer::Resize(int64_t size) {
+  for (int64_t i = size; i < locations_.size(); ++i) {
+    if (locations_[i].slab >= 0) {
+      TF_RETURN_IF_ERROR(Release(i));
+    }
+  }
+  locations_.resize(size);
+  return absl::OkStatus();
+}
+
+Status CompactShuffleBuffer::Set(int64_t index, std::vector<Tensor> element) {
+  if (locations_[index].slab >= 0) {
+    TF_RETURN_IF_ERROR(Release(index));
+  }
+  if (element.empty()) {
+    return absl::OkStatus();
+  }
+  std::string data;
+  TF_RETURN_IF_ERROR(Serialize(element, &data));
+  TF_RETURN_IF_ERROR(Append(index, data));
+  return MaybeSpill();
+}
+
+Status CompactShuffleBuffer::Take(int64_t index, std::vector<Tensor>* out) {
+  TF_RETURN_IF_ERROR(Get(index, out));
+  if (locations_[index].slab >= 0) {
+    TF_RETURN_IF_ERROR(Release(index));
+  }
+  return absl::OkStatus();
+}
+
+Status CompactShuffleBuffer::Get(int64_t index,
+                                 std::vector<Tensor>* out) const {
+  out->clear();
+  const Location& location = locations_[index];
+  if (location.slab < 0) {
+    return absl::OkStatus();
+  }
+  std::string scratch;
+  absl::string_view record;
+  TF_RETURN_IF_ERROR(ReadRecord(location, &scratch, &record));
+  return Deserialize(record, out);
+}
+
+void CompactShuffleBuffer::Swap(int64_t a, int64_t b) {
+  std::swap(locations_[a], locations_[b]);
+  // Keep the headers of the records in memory pointing at their slots, so
+  // that the slabs can be compacted. Spilled slabs are never compacted.
+  for (int64_t index : {a, b}) {
+    const Location& location = locations_[index];
+    if (location.slab < 0) {
+      continue;
+    }
+    Slab* slab = slabs_.at(location.slab).get();
+    if (slab->data != nullptr) {
+      std::memcpy(slab->data.get() + location.offset, &index, sizeof(index));
+    }
+  }
+}
+
+int64_t CompactShuffleBuffer::ResidentBytes() const {
+  return slab_resident_bytes_ + locations_.capacity() * sizeof(Location);
+}
+
+Status CompactShuffleBuffer::Serialize(const std::vector<Tensor>& element,
+                                       std::string* out) const {
+  if (options_.compress) {
+    CompressedElement compressed;
+    TF_RETURN_IF_ERROR(CompressElement(element, &compressed));
+    if (!compressed.SerializeToString(out)) {
+      return errors::Internal("Failed to serialize a compressed element.");
+    }
+    return absl::OkStatus();
+  }
+  out->clear();
+  core::PutVarint64(out, element.size());
+  std::string component;
+  for (const Tensor& tensor : element) {
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    if (!proto.SerializeToString(&component)) {
+      return errors::Internal("Failed to serialize a tensor of shape ",
+                              tensor.shape().DebugString());
+    }
+    core::PutVarint64(out, component.size());
+    out->append(component);
+  }
+  return absl::OkStatus();
+}
+
+Status CompactShuffleBuffer::Deserialize(absl::string_view data,
+                                         std::vector<Tensor>* out) const {
+  if (options_.compress) {
+    CompressedElement compressed;
+    if (!compressed.ParseFromArray(data.data(), data.size())) {
+      return errors::DataLoss("Failed to parse a shuffle buffer element.");
+    }
+    return UncompressElement(compressed, out);
+  }
+  uint64_t num_components;
+  if (!core::GetVarint64(&data, &num_components)) {
+    return errors::DataLoss("Failed to parse a shuffle buffer element.");
+  }
+  out->reserve(num_components);
+  for (uint64_t i = 0; i < num_components; ++i) {
+    uint64_t size;
+    TensorProto proto;
+    if (!core::GetVarint64(&data, &size) || size > data.size() ||
+        !proto.ParseFromArray(data.data(), size)) {
+      return errors::DataLoss("Failed to parse a shuffle buffer element.");
+    }
+    data.remove_prefix(size);
+    Tensor tensor;
+    if (!tensor.FromProto(proto)) {
+      return errors::DataLoss("Failed to parse a shuffle buffer element.");
+    }
+    out->push_back(std::move(tensor));
+  }
+  return absl::OkStatus();
+}
+
+Status CompactShuffleBuffer::Append(int64_t index, absl::string_view data) {
+  if (data.size() > std::numeric_limits<int32_t>::max()) {
+    return errors::InvalidArgument(
+        "Shuffle buffer elements must be smaller than 2GB, but got an element "
+        "of ",
+        data.size(), " bytes.");
+  }
+  const int64_t record_bytes = kHeaderBytes + data.size();
+  Slab* active = active_slab_ >= 0 ? slabs_.at(active_slab_).get() : nullptr;
+  if (active == nullptr || active->used + record_bytes > active->capacity) {
+    auto slab = std::make_unique<Slab>();
+    const int64_t previous_capacity = active ? active->capacity : 0;
+    slab->capacity = std::max(
+        record_bytes,
+        std::min(options_.slab_bytes,
+                 std::max(kMinSlabBytes, 2 * previous_capacity)));
+    slab->data.reset(new char[slab->capacity]);
+    slab_resident_bytes_ += slab->capacity;
+    const int32_t previous_slab = active_slab_;
+    active_slab_ = next_slab_id_++;
+    active = slab.get();
+    slabs_[active_slab_] = std::move(slab);
+    if (previous_slab >= 0 && slabs_.at(previous_slab)->live == 0) {
+      TF_RETURN_IF_ERROR(FreeSlab(previous_slab));
+    }
+  }
+  char* header = active->data.get() + active->used;
+  const int64_t size = data.size();
+  std::memcpy(header, &index, sizeof(index));
+  std::memcpy(header + sizeof(index), &size, sizeof(size));
+  std::memcpy(header + kHeaderBytes, data.data(), data.size());
+  Location& location = locations_[index];
+  location.offset = active->used;
+  location.size = data.size();
+  location.slab = active_slab_;
+  active->used += record_bytes;
+  active->live += record_bytes;
+  return absl::OkStatus();
+}
+
+Status CompactShuffleBuffer::ReadRecord(const Location& location,
+                                        std::string* scratch,
+                                        absl::string_view* result) const {
+  const Slab* slab = slabs_.at(location.slab).get();
+  const int64_t offset = location.offset + kHeaderBytes;
+  if (slab->data != nullptr) {
+    *result = absl::string_view(slab->data.get() + offset, location.size);
+    return absl::OkStatus();
+  }
+  scratch->resize(location.size);
+  StringPiece read;
+  TF_RETURN_IF_ERROR(
+      slab->file->Read(offset, location.size, &read, scratch->data()));
+  if (read.size() != location.size) {
+    return errors::DataLoss("Shuffle buffer spill file ", slab->filename,
+                            " is truncated.");
+  }
+  *result = read;
+  return absl::OkStatus();
+}
+
+Status CompactShuffleBuffer::Release(int64_t index) {
+  const Location location = locations_[index];
+  locations_[index] = Location();
+  Slab* slab = slabs_.at(location.slab).get();
+  slab->live -= kHeaderBytes + location.size;
+  if (location.slab == active_slab_) {
+    return absl::OkStatus();
+  }
+  if (slab->live == 0) {
+    return FreeSlab(location.slab);
+  }
+  if (slab->data != nullptr && 2 * slab->live < slab->used) {
+    return Compact(location.slab);
+  }
+  return absl::OkStatus();
+}
+
+Status CompactShuffleBuffer::Compact(int32_t slab_id) {
+  Slab* slab = slabs_.at(slab_id).get();
+  int64_t offset = 0;
+  while (offset < slab->used) {
+    const char* header = slab->data.get() + offset;
+    int64_t index, size;
+    std::memcpy(&index, header, sizeof(index));
+    std::memcpy(&size, header + sizeof(index), sizeof(size));
+    const Location& location = locations_[index];
+    if (location.slab == slab_id && location.offset == offset) {
+      TF_RETURN_IF_ERROR(
+          Append(index, absl::string_view(header + kHeaderBytes, size)));
+    }
+    offset += kHeaderBytes + size;
+  }
+  return FreeSlab(slab_id);
+}
+
+Status CompactShuffleBuffer::FreeSlab(int32_t slab_id) {
+  auto it = slabs_.find(slab_id);
+  Slab* slab = it->second.get();
+  if (slab->data != nullptr) {
+    slab_resident_bytes_ -= slab->capacity;
+  }
+  if (!slab->filename.empty()) {
+    slab->file.reset();
+    TF_RETURN_IF_ERROR(env_->DeleteFile(slab->filename));
+  }
+  slabs_.erase(it);
+  return absl::OkStatus();
+}
+
+Status CompactShuffleBuffer::MaybeSpill() {
+  if (options_.spill_directory.empty() || options_.max_resident_bytes <= 0) {
+    return absl::OkStatus();
+  }
+  while (slab_resident_bytes_ > options_.max_resident_bytes &&
+         oldest_unspilled_slab_ < active_slab_) {
+    auto it = slabs_.find(oldest_unspilled_slab_++);
+    if (it == slabs_.end() || it->second->data == nullptr) {
+      continue;
+    }
+    Slab* slab = it->second.get();
+    std::string filename =
+        io::JoinPath(options_.spill_directory, "shuffle_buffer_slab");
+    if (!env_->CreateUniqueFileName(&filename, ".spill")) {
+      return errors::Internal("Failed to create a spill file name in ",
+                              options_.spill_directory);
+    }
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(filename, &file));
+    TF_RETURN_IF_ERROR(
+        file->Append(StringPiece(slab->data.get(), slab->used)));
+    TF_RETURN_IF_ERROR(file->Close());
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename, &slab->file));
+    slab->filename = std::move(filename);
+    slab->data.reset();
+    slab_resident_bytes_ -= slab->capacity;
+    ++num_spilled_slabs_;
+    VLOG(2) << "Spilled a shuffle buffer slab of " << slab->used
+            << " bytes to " << slab->filename;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,183 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SHUFFLE_BUFFER_H_
+#define TENSORFLOW_CORE_DATA_SHUFFLE_BUFFER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+namespace data {
+
+// The buffer of a shuffle iterator: a resizable array of slots, each of which
+// is empty or holds an element.
+//
+// Implementations are not thread-safe.
+class ShuffleBuffer {
+ public:
+  virtual ~ShuffleBuffer() = default;
+
+  // Returns the number of slots.
+  virtual int64_t size() const = 0;
+
+  // Resizes the buffer to `size` slots. New slots are empty.
+  virtual Status Resize(int64_t size) = 0;
+
+  // Stores `element` in the slot at `index`, replacing its contents. An empty
+  // `element` leaves the slot empty.
+  virtual Status Set(int64_t index, std::vector<Tensor> element) = 0;
+
+  // Removes the element at `index`, leaving the slot empty. `out` is empty if
+  // the slot was empty.
+  virtual Status Take(int64_t index, std::vector<Tensor>* out) = 0;
+
+  // Copies the element at `index` to `out`, without removing it.
+  virtual Status Get(int64_t index, std::vector<Tensor>* out) const = 0;
+
+  // Swaps the contents of the slots at `a` and `b`.
+  virtual void Swap(int64_t a, int64_t b) = 0;
+
+  // Returns the approximate number of bytes of memory used by the buffer.
+  virtual int64_t ResidentBytes() const = 0;
+
+  // Appends a slot holding `element`.
+  Status PushBack(std::vector<Tensor> element) {
+    const int64_t index = size();
+    TF_RETURN_IF_ERROR(Resize(index + 1));
+    return Set(index, std::move(element));
+  }
+};
+
+// Stores each element as a vector of tensors.
+class VectorShuffleBuffer : public ShuffleBuffer {
+ public:
+  explicit VectorShuffleBuffer(int64_t size) : slots_(size) {}
+
+  int64_t size() const override { return slots_.size(); }
+  Status Resize(int64_t size) override;
+  Status Set(int64_t index, std::vector<Tensor> element) override;
+  Status Take(int64_t index, std::vector<Tensor>* out) override;
+  Status Get(int64_t index, std::vector<Tensor>* out) const override;
+  void Swap(int64_t a, int64_t b) override;
+  int64_t ResidentBytes() const override { return resident_bytes_; }
+
+ private:
+  std::vector<std::vector<Tensor>> slots_;
+  int64_t resident_bytes_ = 0;
+};
+
+// Stores the elements serialized, packed back to back into large slabs, so
+// that a buffer of many small elements does not pay for a `Tensor` and its
+// allocation per component. A slot costs 16 bytes, and an element 16 bytes in
+// addition to its serialized form.
+//
+// Taking elements leaves holes in the slabs. A slab is freed once all of its
+// elements have been taken, and its remaining elements are copied to the
+// newest slab once most of it is holes.
+//
+// If `spill_directory` is set, the oldest slabs are written to files in it
+// whenever the slabs use more than `max_resident_bytes` of memory, and their
+// elements are read back from the files when they are taken.
+class CompactShuffleBuffer : public ShuffleBuffer {
+ public:
+  struct Options {
+    // Whether to compress the elements with `CompressElement`.
+    bool compress = false;
+    // The size of the slabs. Elements larger than this get slabs of their own.
+    int64_t slab_bytes = 64 << 20;
+    // The directory to spill slabs to. Slabs are not spilled if empty.
+    std::string spill_directory;
+    // The memory the slabs may use before they are spilled. Zero for no limit.
+    int64_t max_resident_bytes = 0;
+  };
+
+  CompactShuffleBuffer(Env* env, const Options& options, int64_t size);
+  ~CompactShuffleBuffer() override;
+
+  int64_t size() const override { return locations_.size(); }
+  Status Resize(int64_t size) override;
+  Status Set(int64_t index, std::vector<Tensor> element) override;
+  Status Take(int64_t index, std::vector<Tensor>* out) override;
+  Status Get(int64_t index, std::vector<Tensor>* out) const override;
+  void Swap(int64_t a, int64_t b) override;
+  int64_t ResidentBytes() const override;
+
+  // Returns the number of slabs that have been spilled to files.
+  int64_t NumSpilledSlabs() const { return num_spilled_slabs_; }
+
+ private:
+  // Where the record of a slot lives. Each record is preceded by a header
+  // holding the index of its slot and its size, so that the live records of a
+  // slab can be found when compacting it.
+  struct Location {
+    int64_t offset = 0;
+    int32_t size = 0;
+    int32_t slab = -1;  // -1 if the slot is empty.
+  };
+
+  struct Slab {
+    std::unique_ptr<char[]> data;  // Null once spilled.
+    int64_t capacity = 0;
+    int64_t used = 0;
+    // The bytes of the records that are still referenced by a slot.
+    int64_t live = 0;
+    std::string filename;  // Set once spilled.
+    std::unique_ptr<RandomAccessFile> file;
+  };
+
+  Status Serialize(const std::vector<Tensor>& element, std::string* out) const;
+  Status Deserialize(absl::string_view data, std::vector<Tensor>* out) const;
+  // Appends a record holding `data` for the slot at `index`.
+  Status Append(int64_t index, absl::string_view data);
+  // Returns the record at `location`, using `scratch` if it must be read from
+  // a file.
+  Status ReadRecord(const Location& location, std::string* scratch,
+                    absl::string_view* result) const;
+  // Forgets the record of the slot at `index`, which must not be empty.
+  Status Release(int64_t index);
+  // Copies the live records of `slab_id` to the active slab and frees it.
+  Status Compact(int32_t slab_id);
+  Status FreeSlab(int32_t slab_id);
+  // Spills the oldest sealed slabs until the slabs use at most
+  // `max_resident_bytes`.
+  Status MaybeSpill();
+
+  Env* const env_;
+  const Options options_;
+  std::vector<Location> locations_;
+  absl::flat_hash_map<int32_t, std::unique_ptr<Slab>> slabs_;
+  // The slab new records are appended to, or -1 if there is none.
+  int32_t active_slab_ = -1;
+  int32_t next_slab_id_ = 0;
+  // The oldest slab that may not have been spilled or freed.
+  int32_t oldest_unspilled_slab_ = 0;
+  int64_t slab_resident_bytes_ = 0;
+  int64_t num_spilled_slabs_ = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SHUFFLE_BUFFER_H_
@@ -0,0 +1,147 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shuffle_buffer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<Tensor> MakeElement(int64_t i) {
+  return {test::AsScalar<int64_t>(i),
+          test::AsTensor<tstring>({tstring(absl::StrCat("element_", i))})};
+}
+
+void ExpectElement(const std::vector<Tensor>& element, int64_t i) {
+  ASSERT_EQ(element.size(), 2);
+  test::ExpectEqual(element[0], test::AsScalar<int64_t>(i));
+  test::ExpectEqual(element[1], test::AsTensor<tstring>(
+                                    {tstring(absl::StrCat("element_", i))}));
+}
+
+class ShuffleBufferTest : public ::testing::TestWithParam<std::string> {
+ protected:
+  std::unique_ptr<ShuffleBuffer> MakeBuffer(int64_t size) {
+    if (GetParam() == "vector") {
+      return std::make_unique<VectorShuffleBuffer>(size);
+    }
+    CompactShuffleBuffer::Options options;
+    options.compress = GetParam() == "compressed";
+    return std::make_unique<CompactShuffleBuffer>(Env::Default(), options,
+                                                  size);
+  }
+};
+
+TEST_P(ShuffleBufferTest, SetTakeAndSwap) {
+  std::unique_ptr<ShuffleBuffer> buffer = MakeBuffer(10);
+  for (int64_t i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(buffer->Set(i, MakeElement(i)));
+  }
+  buffer->Swap(2, 7);
+  std::vector<Tensor> element;
+  TF_ASSERT_OK(buffer->Get(2, &element));
+  ExpectElement(element, 7);
+  TF_ASSERT_OK(buffer->Take(7, &element));
+  ExpectElement(element, 2);
+  TF_ASSERT_OK(buffer->Take(7, &element));
+  EXPECT_TRUE(element.empty());
+  TF_ASSERT_OK(buffer->PushBack(MakeElement(10)));
+  EXPECT_EQ(buffer->size(), 11);
+  for (int64_t i : {0, 1, 3, 4, 5, 6, 8, 9, 10}) {
+    TF_ASSERT_OK(buffer->Take(i, &element));
+    ExpectElement(element, i);
+  }
+}
+
+TEST_P(ShuffleBufferTest, Overwrite) {
+  std::unique_ptr<ShuffleBuffer> buffer = MakeBuffer(1);
+  TF_ASSERT_OK(buffer->Set(0, MakeElement(0)));
+  TF_ASSERT_OK(buffer->Set(0, MakeElement(1)));
+  std::vector<Tensor> element;
+  TF_ASSERT_OK(buffer->Take(0, &element));
+  ExpectElement(element, 1);
+  EXPECT_EQ(buffer->ResidentBytes() > 0, GetParam() != "vector");
+}
+
+INSTANTIATE_TEST_SUITE_P(ShuffleBuffers, ShuffleBufferTest,
+                         ::testing::Values("vector", "compact", "compressed"));
+
+TEST(CompactShuffleBufferTest, FreesTakenElements) {
+  CompactShuffleBuffer::Options options;
+  options.slab_bytes = 1024;
+  constexpr int64_t kNumElements = 1000;
+  CompactShuffleBuffer buffer(Env::Default(), options, kNumElements);
+  for (int64_t i = 0; i < kNumElements; ++i) {
+    TF_ASSERT_OK(buffer.Set(i, MakeElement(i)));
+  }
+  const int64_t full_bytes = buffer.ResidentBytes();
+  // Taking three out of four elements compacts the slabs.
+  std::vector<Tensor> element;
+  for (int64_t i = 0; i < kNumElements; ++i) {
+    if (i % 4 != 3) {
+      TF_ASSERT_OK(buffer.Take(i, &element));
+      ExpectElement(element, i);
+    }
+  }
+  EXPECT_LT(buffer.ResidentBytes(), full_bytes / 2);
+  for (int64_t i = 3; i < kNumElements; i += 4) {
+    TF_ASSERT_OK(buffer.Take(i, &element));
+    ExpectElement(element, i);
+  }
+}
+
+TEST(CompactShuffleBufferTest, Spills) {
+  CompactShuffleBuffer::Options options;
+  options.slab_bytes = 1024;
+  options.spill_directory = io::JoinPath(testing::TmpDir(), "shuffle_spill");
+  options.max_resident_bytes = 4096;
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(options.spill_directory));
+  constexpr int64_t kNumElements = 1000;
+  {
+    CompactShuffleBuffer buffer(Env::Default(), options, kNumElements);
+    for (int64_t i = 0; i < kNumElements; ++i) {
+      TF_ASSERT_OK(buffer.Set(i, MakeElement(i)));
+    }
+    EXPECT_GT(buffer.NumSpilledSlabs(), 0);
+    EXPECT_LE(buffer.ResidentBytes(),
+              options.max_resident_bytes + options.slab_bytes +
+                  kNumElements * 16);
+    std::vector<Tensor> element;
+    for (int64_t i = kNumElements - 1; i >= 0; --i) {
+      TF_ASSERT_OK(buffer.Take(i, &element));
+      ExpectElement(element, i);
+    }
+  }
+  std::vector<std::string> children;
+  TF_ASSERT_OK(
+      Env::Default()->GetChildren(options.spill_directory, &children));
+  EXPECT_TRUE(children.empty());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
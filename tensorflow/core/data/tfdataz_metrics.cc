@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tsl/platform/thread_annotations.h"
 
@@ -122,6 +123,27 @@ absl::Duration TfDatazMetricsCollector::GetAverageLatencyForLastSixtyMinutes() {
       ApproximateLatencyEstimator::Duration::kSixtyMinutes);
 }
 
+double TfDatazMetricsCollector::GetNextWaitFractionForLastOneMinute() {
+  if (model_ == nullptr) {
+    return 0.0;
+  }
+  const double gap_nsec = model_->ComputeExperimentalTargetTimeNsec();
+  const double latency_nsec = absl::ToDoubleNanoseconds(
+      GetAverageLatencyForLastOneMinute());
+  if (gap_nsec <= 0 || latency_nsec <= 0) {
+    return 0.0;
+  }
+  return latency_nsec / (latency_nsec + gap_nsec);
+}
+
+absl::StatusOr<model::Model::InputBottleneck>
+TfDatazMetricsCollector::GetInputBottleneck() {
+  if (model_ == nullptr) {
+    return errors::FailedPrecondition("The iterator has no model.");
+  }
+  return model_->AnalyzeInputBottleneck();
+}
+
 std::optional<std::string> TfDatazMetricsCollector::DatasetName() {
   auto options = iterator_->dataset()->options();
   if (options.has_dataset_name()) {
@@ -21,6 +21,7 @@ limitations under the License.
 #include <string>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
@@ -110,6 +111,17 @@ class TfDatazMetricsCollector {
   // Returns the average `GetNext` latency for past 60 minutes.
   absl::Duration GetAverageLatencyForLastSixtyMinutes();
 
+  // Returns the fraction of the consumer's step time spent waiting in
+  // `GetNext` over the past minute, i.e. the average `GetNext` latency divided
+  // by the sum of the average `GetNext` latency and the average gap between
+  // `GetNext` calls. Returns 0 if there is not enough data to estimate it.
+  double GetNextWaitFractionForLastOneMinute();
+
+  // Returns the slowest stage of the input pipeline according to the latest
+  // model snapshot, or an error if the iterator has no model or it has not
+  // been optimized yet.
+  absl::StatusOr<model::Model::InputBottleneck> GetInputBottleneck();
+
   // Returns the dataset name if one was set.
   std::optional<std::string> DatasetName();
 
@@ -179,6 +179,24 @@ TEST_F(TfDatazMetricsTest, GetAverageLatencyWithZeroGetNextCalls) {
                   0);
 }
 
+TEST_F(TfDatazMetricsTest, GetNextWaitFractionWithoutModel) {
+  tfdataz_metrics_->RecordGetNextLatency(10);
+  EXPECT_FLOAT_EQ(tfdataz_metrics_->GetNextWaitFractionForLastOneMinute(), 0);
+  EXPECT_FALSE(tfdataz_metrics_->GetInputBottleneck().ok());
+}
+
+TEST_F(TfDatazMetricsTest, GetNextWaitFractionForLastOneMinute) {
+  auto model = std::make_shared<model::Model>();
+  TfDatazMetricsCollector tfdataz_metrics(*env_, iterator_.get(), model);
+  // The model needs a full window of gap times to estimate the consumer time.
+  for (int i = 0; i < 100; ++i) {
+    model->RecordIteratorGapTime(30);
+    tfdataz_metrics.RecordGetNextLatency(10);
+  }
+
+  EXPECT_FLOAT_EQ(tfdataz_metrics.GetNextWaitFractionForLastOneMinute(), 0.25);
+}
+
 class ScopedTfDataMetricsRegistration {
  public:
   explicit ScopedTfDataMetricsRegistration(
@@ -0,0 +1,160 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/tfrecord_index.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/raw_coding.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kTFRecordIndexSuffix[] = ".tfrecord_index";
+constexpr char kTempSuffix[] = ".tmp";
+// Buffer size for scanning a TFRecord file.
+constexpr int64_t kScanBufferSize = 256 << 10;  // 256KB.
+// The smallest record, one with no data.
+constexpr uint64_t kMinRecordSize =
+    io::RecordReader::kHeaderSize + io::RecordReader::kFooterSize;
+
+}  // namespace
+
+std::string TFRecordIndexFilename(const std::string& filename) {
+  return strings::StrCat(filename, kTFRecordIndexSuffix);
+}
+
+Status WriteTFRecordIndex(Env* env, const std::string& filename,
+                          const std::vector<uint64_t>& offsets) {
+  if (offsets.empty()) {
+    return errors::InvalidArgument(
+        "The offsets of a TFRecord index must end with the file size.");
+  }
+  std::string index;
+  index.reserve(offsets.size() * sizeof(uint64_t));
+  for (uint64_t offset : offsets) {
+    core::PutFixed64(&index, offset);
+  }
+  const std::string index_filename = TFRecordIndexFilename(filename);
+  const std::string temp_filename =
+      strings::StrCat(index_filename, kTempSuffix);
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, temp_filename, index));
+  return env->RenameFile(temp_filename, index_filename);
+}
+
+Status CreateTFRecordIndex(Env* env, const std::string& filename) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  io::RecordReaderOptions options;
+  options.buffer_size = kScanBufferSize;
+  io::RecordReader reader(file.get(), options);
+  std::vector<uint64_t> offsets;
+  uint64_t offset = 0;
+  while (true) {
+    const uint64_t record_offset = offset;
+    int num_skipped;
+    Status s = reader.SkipRecords(&offset, /*num_to_skip=*/1, &num_skipped);
+    if (errors::IsOutOfRange(s)) break;
+    TF_RETURN_IF_ERROR(s);
+    offsets.push_back(record_offset);
+  }
+  offsets.push_back(offset);
+  return WriteTFRecordIndex(env, filename, offsets);
+}
+
+Status ReadTFRecordIndex(Env* env, const std::string& filename,
+                         std::vector<uint64_t>* offsets) {
+  const std::string index_filename = TFRecordIndexFilename(filename);
+  std::string index;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, index_filename, &index));
+  if (index.empty() || index.size() % sizeof(uint64_t) != 0) {
+    return errors::DataLoss("TFRecord index ", index_filename,
+                            " is truncated.");
+  }
+  uint64_t file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+
+  offsets->resize(index.size() / sizeof(uint64_t));
+  for (size_t i = 0; i < offsets->size(); ++i) {
+    (*offsets)[i] = core::DecodeFixed64(index.data() + i * sizeof(uint64_t));
+    if (i > 0 && (*offsets)[i] < (*offsets)[i - 1] + kMinRecordSize) {
+      return errors::DataLoss("TFRecord index ", index_filename,
+                              " has overlapping records.");
+    }
+  }
+  if (offsets->front() != 0) {
+    return errors::DataLoss("TFRecord index ", index_filename,
+                            " does not start at the first record.");
+  }
+  if (offsets->back() != file_size) {
+    return errors::DataLoss("TFRecord index ", index_filename,
+                            " is for a file of ", offsets->back(),
+                            " bytes, but ", filename, " has ", file_size,
+                            " bytes.");
+  }
+  return absl::OkStatus();
+}
+
+Status ReadIndexedTFRecord(RandomAccessFile* file, uint64_t offset,
+                           uint64_t end, tstring* record) {
+  if (end < offset + kMinRecordSize) {
+    return errors::InvalidArgument("Invalid TFRecord range [", offset, ", ",
+                                   end, ").");
+  }
+  const size_t size = end - offset;
+  record->resize_uninitialized(size);
+  StringPiece data;
+  TF_RETURN_IF_ERROR(file->Read(offset, size, &data, record->mdata()));
+  if (data.size() != size) {
+    return errors::DataLoss("truncated record at ", offset);
+  }
+
+  const char* header = data.data();
+  const uint64_t length = core::DecodeFixed64(header);
+  if (crc32c::Unmask(core::DecodeFixed32(header + sizeof(uint64_t))) !=
+      crc32c::Value(header, sizeof(uint64_t))) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  if (length != size - kMinRecordSize) {
+    return errors::DataLoss("The record at ", offset, " has ", length,
+                            " bytes, but its index says ",
+                            size - kMinRecordSize, " bytes.");
+  }
+  const char* content = header + io::RecordReader::kHeaderSize;
+  if (crc32c::Unmask(core::DecodeFixed32(content + length)) !=
+      crc32c::Value(content, length)) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  // `data` is either in `record` or in a buffer of the file.
+  std::memmove(record->mdata(), content, length);
+  record->resize(length);
+  return absl::OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
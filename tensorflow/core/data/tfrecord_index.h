@@ -0,0 +1,67 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
+#define TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+
+// A TFRecord index is a sidecar file of an uncompressed TFRecord file that
+// holds the offset of each record, so that any record can be read with one
+// positioned read. The index of `file` is the file `file.tfrecord_index`:
+//
+//   [offset of record 0]...[offset of record n-1][size of the TFRecord file]
+//
+// with each value a little-endian uint64. The size of the TFRecord file lets
+// readers reject an index that does not belong to the current file.
+
+// Returns the name of the index file of the TFRecord file `filename`.
+std::string TFRecordIndexFilename(const std::string& filename);
+
+// Writes the index of the TFRecord file `filename`. `offsets` are the offsets
+// of its records followed by its size, as tracked by a writer of the file.
+// The index is written to a temporary file, which is then renamed, so readers
+// never see a partial index.
+Status WriteTFRecordIndex(Env* env, const std::string& filename,
+                          const std::vector<uint64_t>& offsets);
+
+// Reads the uncompressed TFRecord file `filename` and writes its index.
+Status CreateTFRecordIndex(Env* env, const std::string& filename);
+
+// Reads the index of the TFRecord file `filename` into `offsets`, in the
+// format of `WriteTFRecordIndex`. Returns NotFound if there is no index, and
+// DataLoss if it is malformed or does not match the size of the file.
+Status ReadTFRecordIndex(Env* env, const std::string& filename,
+                         std::vector<uint64_t>* offsets);
+
+// Reads the record of `file` at [`offset`, `end`), two consecutive offsets of
+// its index, with one positioned read into `record`. Unlike
+// `io::RecordReader`, this does not read the header of the record first.
+Status ReadIndexedTFRecord(RandomAccessFile* file, uint64_t offset,
+                           uint64_t end, tstring* record);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
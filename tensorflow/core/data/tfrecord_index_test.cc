@@ -0,0 +1,114 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/tfrecord_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string Record(int i) { return std::string(i * 10, 'a' + i); }
+
+Status WriteRecords(const std::string& filename, int num_records) {
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(filename, &file));
+  io::RecordWriter writer(file.get());
+  for (int i = 0; i < num_records; ++i) {
+    TF_RETURN_IF_ERROR(writer.WriteRecord(Record(i)));
+  }
+  TF_RETURN_IF_ERROR(writer.Close());
+  return file->Close();
+}
+
+TEST(TFRecordIndexTest, ReadsRecordsInAnyOrder) {
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "tfrecord_index_any_order");
+  TF_ASSERT_OK(WriteRecords(filename, 10));
+  TF_ASSERT_OK(CreateTFRecordIndex(Env::Default(), filename));
+
+  std::vector<uint64_t> offsets;
+  TF_ASSERT_OK(ReadTFRecordIndex(Env::Default(), filename, &offsets));
+  ASSERT_EQ(offsets.size(), 11);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+  for (int i : {7, 0, 9, 3}) {
+    tstring record;
+    TF_ASSERT_OK(
+        ReadIndexedTFRecord(file.get(), offsets[i], offsets[i + 1], &record));
+    EXPECT_EQ(record, Record(i));
+  }
+}
+
+TEST(TFRecordIndexTest, EmptyFile) {
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "tfrecord_index_empty");
+  TF_ASSERT_OK(WriteRecords(filename, 0));
+  TF_ASSERT_OK(CreateTFRecordIndex(Env::Default(), filename));
+  std::vector<uint64_t> offsets;
+  TF_ASSERT_OK(ReadTFRecordIndex(Env::Default(), filename, &offsets));
+  EXPECT_EQ(offsets, std::vector<uint64_t>({0}));
+}
+
+TEST(TFRecordIndexTest, MissingIndex) {
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "tfrecord_index_missing");
+  TF_ASSERT_OK(WriteRecords(filename, 3));
+  std::vector<uint64_t> offsets;
+  EXPECT_TRUE(errors::IsNotFound(
+      ReadTFRecordIndex(Env::Default(), filename, &offsets)));
+}
+
+TEST(TFRecordIndexTest, StaleIndex) {
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "tfrecord_index_stale");
+  TF_ASSERT_OK(WriteRecords(filename, 3));
+  TF_ASSERT_OK(CreateTFRecordIndex(Env::Default(), filename));
+  TF_ASSERT_OK(WriteRecords(filename, 4));
+  std::vector<uint64_t> offsets;
+  EXPECT_TRUE(errors::IsDataLoss(
+      ReadTFRecordIndex(Env::Default(), filename, &offsets)));
+}
+
+TEST(TFRecordIndexTest, MismatchedRecord) {
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "tfrecord_index_mismatched");
+  TF_ASSERT_OK(WriteRecords(filename, 3));
+  TF_ASSERT_OK(CreateTFRecordIndex(Env::Default(), filename));
+  std::vector<uint64_t> offsets;
+  TF_ASSERT_OK(ReadTFRecordIndex(Env::Default(), filename, &offsets));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+  tstring record;
+  EXPECT_TRUE(errors::IsDataLoss(
+      ReadIndexedTFRecord(file.get(), offsets[1], offsets[3], &record)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
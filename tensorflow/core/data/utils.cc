@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "tensorflow/core/data/service/stream_transfer.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
 
@@ -43,7 +44,10 @@ std::string LocalityOptimizedPath(const std::string& path) { return path; }
 
 absl::StatusOr<bool> DisableCompressionAtRuntime(
     const std::string& data_transfer_protocol, DeploymentMode deployment_mode) {
-  return false;
+  // Co-located clients reading through shared memory do not send the
+  // elements over the network, so compressing them only costs CPU.
+  return data_transfer_protocol == kSharedMemoryTransferProtocol &&
+         deployment_mode == DEPLOYMENT_MODE_COLOCATED;
 }
 
 void LogFilenames(const std::vector<std::string>& files) {}
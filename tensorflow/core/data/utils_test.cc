@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <gtest/gtest.h>
 
+#include "tensorflow/core/data/service/stream_transfer.h"
+
 namespace tensorflow::data {
 namespace {
 
@@ -55,6 +57,14 @@ TEST(LocalityOptimizedPath, TfDataPath) {
   EXPECT_EQ(LocalityOptimizedPath(file), file);
 }
 
+TEST(DisableCompressionAtRuntime, SharedMemory) {
+  EXPECT_TRUE(*DisableCompressionAtRuntime(kSharedMemoryTransferProtocol,
+                                           DEPLOYMENT_MODE_COLOCATED));
+  EXPECT_FALSE(*DisableCompressionAtRuntime(kSharedMemoryTransferProtocol,
+                                           DEPLOYMENT_MODE_HYBRID));
+  EXPECT_FALSE(*DisableCompressionAtRuntime("grpc", DEPLOYMENT_MODE_COLOCATED));
+}
+
 TEST(LocalityOptimizedPath, LogFilenames) {
   EXPECT_NO_FATAL_FAILURE(LogFilenames(
       std::vector<std::string>({"/path/file1", "file2.txt", "a"})));
@@ -132,6 +132,11 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
     return execution_count_.fetch_add(1);
   }
 
+  // The sequence number of the last step of the session which used this
+  // graph, used to evict the least recently used graphs.
+  int64_t last_use() const { return last_use_.load(); }
+  void set_last_use(int64_t last_use) { last_use_.store(last_use); }
+
   // Turn RPC logging on or off, both at the WorkerCache used by this
   // master process, and at each remote worker in use for the current
   // partitions.
@@ -255,6 +260,7 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   const bool should_deregister_;
   const int64_t collective_graph_key_;
   std::atomic<int64_t> execution_count_ = {0};
+  std::atomic<int64_t> last_use_ = {0};
 
   // Graph partitioned into per-location subgraphs.
   struct Part {
@@ -1544,6 +1550,8 @@ Status MasterSession::StartStep(const BuildGraphOptions& opts, bool is_partial,
                                 ReffedClientGraph** out_rcg,
                                 int64_t* out_count) {
   const uint64 hash = HashBuildGraphOptions(opts);
+  // Graphs evicted from the cache, which are deregistered outside the lock.
+  std::vector<ReffedClientGraph*> to_unref;
   {
     mutex_lock l(mu_);
     // TODO(suharshs): We cache partial run graphs and run graphs separately
@@ -1566,14 +1574,40 @@ Status MasterSession::StartStep(const BuildGraphOptions& opts, bool is_partial,
           !should_delete_worker_sessions_);
       iter = m->insert({hash, entry}).first;
       VLOG(1) << "Preparing to execute new graph";
+      EvictLeastRecentlyUsedGraphs(hash, m, &to_unref);
     }
     *out_rcg = iter->second;
     (*out_rcg)->Ref();
+    (*out_rcg)->set_last_use(++graph_use_count_);
     *out_count = (*out_rcg)->get_and_increment_execution_count();
   }
+  for (ReffedClientGraph* rcg : to_unref) rcg->Unref();
   return absl::OkStatus();
 }
 
+void MasterSession::EvictLeastRecentlyUsedGraphs(
+    uint64 keep, RCGMap* rcg_map, std::vector<ReffedClientGraph*>* to_unref) {
+  const int32_t capacity =
+      session_opts_.config.experimental().session_graph_cache_size();
+  if (capacity <= 0) return;
+  // Inserting a graph evicts at most one, so a linear scan is cheap compared
+  // to building the new graph.
+  while (rcg_map->size() > static_cast<size_t>(capacity)) {
+    auto lru = rcg_map->end();
+    for (auto it = rcg_map->begin(); it != rcg_map->end(); ++it) {
+      if (it->first == keep) continue;
+      if (lru == rcg_map->end() ||
+          it->second->last_use() < lru->second->last_use()) {
+        lru = it;
+      }
+    }
+    VLOG(1) << "Evicting graph " << lru->first << " of session " << handle_;
+    // Steps which still run the graph hold a reference to it.
+    to_unref->push_back(lru->second);
+    rcg_map->erase(lru);
+  }
+}
+
 void MasterSession::ClearRunsTable(std::vector<ReffedClientGraph*>* to_unref,
                                    RCGMap* rcg_map) {
   VLOG(1) << "Discarding all reffed graphs";
@@ -156,6 +156,9 @@ class MasterSession : public core::RefCounted {
   RCGMap partial_run_graphs_ TF_GUARDED_BY(mu_);
   int64_t next_callable_handle_ TF_GUARDED_BY(mu_) = 0;
   RCGMap callables_ TF_GUARDED_BY(mu_);
+  // The number of steps which looked up a graph in `run_graphs_` or
+  // `partial_run_graphs_`, which orders the graphs by their last use.
+  int64_t graph_use_count_ TF_GUARDED_BY(mu_) = 0;
 
   struct PerStepState {
     bool collect_costs = false;
@@ -226,6 +229,12 @@ class MasterSession : public core::RefCounted {
                    ReffedClientGraph** out_rcg, int64_t* out_count);
   void ClearRunsTable(std::vector<ReffedClientGraph*>* to_unref,
                       RCGMap* rcg_map) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Removes the least recently used graphs other than `keep` from `rcg_map`
+  // while it holds more graphs than the session_graph_cache_size option, and
+  // appends them to `to_unref`.
+  void EvictLeastRecentlyUsedGraphs(uint64 keep, RCGMap* rcg_map,
+                                    std::vector<ReffedClientGraph*>* to_unref)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   void FillPerStepState(MasterSession::ReffedClientGraph* rcg,
                         const RunOptions& run_options, uint64 step_id,
                         int64_t count, PerStepState* out_pss,
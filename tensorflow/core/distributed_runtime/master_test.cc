@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/master.pb.h"
 
 namespace tensorflow {
@@ -65,10 +66,12 @@ class MasterTest : public ::testing::Test {
   // rpc calls.
 
   Status CreateSession(const GraphDef& def, string* handle,
-                       int64_t* initial_version) {
+                       int64_t* initial_version,
+                       const ConfigProto& config = ConfigProto()) {
     ::grpc::ClientContext ctx;
     CreateSessionRequest req;
     *(req.mutable_graph_def()) = def;
+    *req.mutable_config() = config;
     // Invokes placement frequently.
     req.mutable_config()->set_placement_period(1);
     CreateSessionResponse resp;
@@ -363,6 +366,37 @@ TEST_F(MasterTest, ConcurrentExtendAndRun) {
   TF_ASSERT_OK(CloseSession(handle));
 }
 
+TEST_F(MasterTest, GraphCacheEviction) {
+  Graph graph(OpRegistry::Global());
+  Tensor a_tensor(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&a_tensor, {3, 2, -1, 0});
+  Node* a_node = test::graph::Constant(&graph, a_tensor);
+  Tensor x_tensor(DT_FLOAT, TensorShape({2, 1}));
+  test::FillValues<float>(&x_tensor, {2, 2});
+  Node* x_node = test::graph::Constant(&graph, x_tensor);
+  Node* y_node = test::graph::Matmul(&graph, a_node, x_node, false, false);
+  GraphDef def;
+  test::graph::ToGraphDef(&graph, &def);
+
+  ConfigProto config;
+  config.mutable_experimental()->set_session_graph_cache_size(1);
+  string handle;
+  int64_t initial_version;
+  TF_ASSERT_OK(CreateSession(def, &handle, &initial_version, config));
+
+  // Each fetch evicts the graph of the other one, which is rebuilt and
+  // registered again when it is fetched next.
+  for (int i = 0; i < 3; ++i) {
+    Tensor a(DT_FLOAT, TensorShape({2, 2}));
+    TF_ASSERT_OK(RunStep(handle, {}, {{a_node->name() + ":0", &a}}));
+    test::ExpectTensorEqual<float>(a, a_tensor);
+    Tensor y(DT_FLOAT, TensorShape({2, 1}));
+    TF_ASSERT_OK(RunStep(handle, {}, {{y_node->name() + ":0", &y}}));
+    test::ExpectTensorEqual<float>(y, test::AsTensor<float>({10, -2}, {2, 1}));
+  }
+  TF_EXPECT_OK(CloseSession(handle));
+}
+
 TEST_F(MasterTest, EigenProblem) {
   // A = [3 2; -1 0]; x = rand(2, 1);
   // for i=1:100; x = A * x; end
@@ -0,0 +1,159 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/recv_tensors_batch.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+RecvTensorsBatch::RecvTensorsBatch(int num_tensors) : slots_(num_tensors) {}
+
+void RecvTensorsBatch::SetTensor(int index, const absl::Status& status,
+                                 const Tensor& tensor, bool is_dead) {
+  std::vector<ReturnedTensor> tensors;
+  RecvTensorsResponse* response = nullptr;
+  StatusCallback done;
+  absl::Status poll_status;
+  {
+    mutex_lock l(mu_);
+    if (!status_.ok()) {
+      return;
+    }
+    if (!status.ok()) {
+      status_ = status;
+      if (done_ == nullptr) {
+        return;
+      }
+      poll_status = status_;
+      response = response_;
+      done = std::move(done_);
+      response_ = nullptr;
+      done_ = nullptr;
+    } else {
+      Slot& slot = slots_[index];
+      if (slot.available) {
+        return;
+      }
+      slot.available = true;
+      slot.tensor = tensor;
+      slot.is_dead = is_dead;
+      ++num_available_;
+      if (!TakeReadyPoll(&tensors, &response, &done)) {
+        return;
+      }
+    }
+  }
+  CompletePoll(poll_status, std::move(tensors), response, std::move(done));
+}
+
+void RecvTensorsBatch::Poll(RecvTensorsResponse* response,
+                            StatusCallback done) {
+  std::vector<ReturnedTensor> tensors;
+  absl::Status status;
+  {
+    mutex_lock l(mu_);
+    if (!status_.ok()) {
+      status = status_;
+    } else if (done_ != nullptr) {
+      status = errors::FailedPrecondition(
+          "Another RecvTensors request is pending for this batch.");
+    } else if (num_returned_ == slots_.size()) {
+      status = errors::FailedPrecondition(
+          "All the tensors of this RecvTensors batch have been returned.");
+    } else {
+      response_ = response;
+      done_ = std::move(done);
+      if (!TakeReadyPoll(&tensors, &response, &done)) {
+        return;
+      }
+    }
+  }
+  CompletePoll(status, std::move(tensors), response, std::move(done));
+}
+
+void RecvTensorsBatch::Cancel(const absl::Status& status) {
+  RecvTensorsResponse* response = nullptr;
+  StatusCallback done;
+  {
+    mutex_lock l(mu_);
+    if (status_.ok()) {
+      status_ = status;
+    }
+    if (done_ == nullptr) {
+      return;
+    }
+    response = response_;
+    done = std::move(done_);
+    response_ = nullptr;
+    done_ = nullptr;
+  }
+  CompletePoll(status, /*tensors=*/{}, response, std::move(done));
+}
+
+bool RecvTensorsBatch::IsFinished() const {
+  mutex_lock l(mu_);
+  return !status_.ok() || num_returned_ == slots_.size();
+}
+
+bool RecvTensorsBatch::TakeReadyPoll(std::vector<ReturnedTensor>* tensors,
+                                     RecvTensorsResponse** response,
+                                     StatusCallback* done)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (done_ == nullptr || num_available_ == num_returned_) {
+    return false;
+  }
+  for (int i = 0; i < slots_.size(); ++i) {
+    Slot& slot = slots_[i];
+    if (slot.available && !slot.returned) {
+      slot.returned = true;
+      tensors->push_back({i, std::move(slot.tensor), slot.is_dead});
+      ++num_returned_;
+    }
+  }
+  *response = response_;
+  *done = std::move(done_);
+  response_ = nullptr;
+  done_ = nullptr;
+  return true;
+}
+
+void RecvTensorsBatch::CompletePoll(const absl::Status& status,
+                                    std::vector<ReturnedTensor> tensors,
+                                    RecvTensorsResponse* response,
+                                    StatusCallback done) {
+  if (status.ok()) {
+    const int64_t send_start_micros = Env::Default()->NowMicros();
+    for (ReturnedTensor& tensor : tensors) {
+      response->add_index(tensor.index);
+      RecvTensorResponse* tensor_response = response->add_tensor();
+      tensor_response->set_is_dead(tensor.is_dead);
+      tensor_response->set_send_start_micros(send_start_micros);
+      tensor.tensor.AsProtoTensorContent(tensor_response->mutable_tensor());
+    }
+  }
+  done(status);
+}
+
+}  // namespace tensorflow
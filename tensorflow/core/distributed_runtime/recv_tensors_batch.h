@@ -0,0 +1,94 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSORS_BATCH_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSORS_BATCH_H_
+
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+#include "tsl/platform/status.h"
+
+namespace tensorflow {
+
+// Holds the tensors of a RecvTensors batch on the sending worker until the
+// receiver polls for them. See `RecvTensorsRequest` in worker.proto.
+//
+// This class is thread-safe.
+class RecvTensorsBatch {
+ public:
+  explicit RecvTensorsBatch(int num_tensors);
+  RecvTensorsBatch(const RecvTensorsBatch&) = delete;
+  RecvTensorsBatch& operator=(const RecvTensorsBatch&) = delete;
+
+  // Called when tensor `index` of the batch is available, or with an error if
+  // it could not be produced. The first error fails the batch.
+  void SetTensor(int index, const absl::Status& status, const Tensor& tensor,
+                 bool is_dead);
+
+  // Runs `done` once at least one tensor which has not been returned yet is
+  // available, after adding all such tensors to `response`. Fails if the batch
+  // has failed, or if another poll is pending.
+  void Poll(RecvTensorsResponse* response, StatusCallback done);
+
+  // Fails the batch with `status`, including a pending poll.
+  void Cancel(const absl::Status& status);
+
+  // Returns true once every tensor has been returned, or the batch has failed.
+  bool IsFinished() const;
+
+ private:
+  struct Slot {
+    bool available = false;
+    bool returned = false;
+    Tensor tensor;
+    bool is_dead = false;
+  };
+
+  struct ReturnedTensor {
+    int index;
+    Tensor tensor;
+    bool is_dead;
+  };
+
+  // If a poll is pending and it can complete, removes it and returns the
+  // tensors to return to it in `tensors`, and the poll in `response` and
+  // `done`. Returns false otherwise.
+  bool TakeReadyPoll(std::vector<ReturnedTensor>* tensors,
+                     RecvTensorsResponse** response, StatusCallback* done)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Fills `response` with `tensors` and runs `done`.
+  static void CompletePoll(const absl::Status& status,
+                           std::vector<ReturnedTensor> tensors,
+                           RecvTensorsResponse* response, StatusCallback done);
+
+  mutable mutex mu_;
+  std::vector<Slot> slots_ TF_GUARDED_BY(mu_);
+  absl::Status status_ TF_GUARDED_BY(mu_);
+  int num_available_ TF_GUARDED_BY(mu_) = 0;
+  int num_returned_ TF_GUARDED_BY(mu_) = 0;
+  // The pending poll, if `done_` is set.
+  RecvTensorsResponse* response_ TF_GUARDED_BY(mu_) = nullptr;
+  StatusCallback done_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSORS_BATCH_H_
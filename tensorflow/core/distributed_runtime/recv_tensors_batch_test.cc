@@ -0,0 +1,118 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/recv_tensors_batch.h"
+
+#include <optional>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::ElementsAre;
+
+Tensor Value(float value) { return test::AsScalar<float>(value); }
+
+Tensor FromResponse(const RecvTensorsResponse& response, int i) {
+  Tensor tensor;
+  CHECK(tensor.FromProto(response.tensor(i).tensor()));
+  return tensor;
+}
+
+TEST(RecvTensorsBatchTest, ReturnsAvailableTensors) {
+  RecvTensorsBatch batch(/*num_tensors=*/3);
+  batch.SetTensor(0, absl::OkStatus(), Value(0), /*is_dead=*/false);
+  batch.SetTensor(2, absl::OkStatus(), Value(2), /*is_dead=*/true);
+
+  RecvTensorsResponse response;
+  std::optional<absl::Status> status;
+  batch.Poll(&response, [&status](const absl::Status& s) { status = s; });
+  ASSERT_TRUE(status.has_value());
+  TF_EXPECT_OK(*status);
+  EXPECT_THAT(response.index(), ElementsAre(0, 2));
+  test::ExpectTensorEqual<float>(FromResponse(response, 0), Value(0));
+  test::ExpectTensorEqual<float>(FromResponse(response, 1), Value(2));
+  EXPECT_FALSE(response.tensor(0).is_dead());
+  EXPECT_TRUE(response.tensor(1).is_dead());
+  EXPECT_FALSE(batch.IsFinished());
+}
+
+TEST(RecvTensorsBatchTest, WaitsForTensor) {
+  RecvTensorsBatch batch(/*num_tensors=*/2);
+  batch.SetTensor(1, absl::OkStatus(), Value(1), /*is_dead=*/false);
+  RecvTensorsResponse first_response;
+  batch.Poll(&first_response, [](const absl::Status& s) { TF_EXPECT_OK(s); });
+  EXPECT_THAT(first_response.index(), ElementsAre(1));
+
+  RecvTensorsResponse second_response;
+  std::optional<absl::Status> status;
+  batch.Poll(&second_response,
+             [&status](const absl::Status& s) { status = s; });
+  EXPECT_FALSE(status.has_value());
+  batch.SetTensor(0, absl::OkStatus(), Value(0), /*is_dead=*/false);
+  ASSERT_TRUE(status.has_value());
+  TF_EXPECT_OK(*status);
+  EXPECT_THAT(second_response.index(), ElementsAre(0));
+  test::ExpectTensorEqual<float>(FromResponse(second_response, 0), Value(0));
+  EXPECT_TRUE(batch.IsFinished());
+}
+
+TEST(RecvTensorsBatchTest, Error) {
+  RecvTensorsBatch batch(/*num_tensors=*/2);
+  RecvTensorsResponse response;
+  std::optional<absl::Status> status;
+  batch.Poll(&response, [&status](const absl::Status& s) { status = s; });
+  batch.SetTensor(0, errors::Aborted("Step aborted"), Tensor(),
+                  /*is_dead=*/false);
+  ASSERT_TRUE(status.has_value());
+  EXPECT_THAT(*status, StatusIs(error::ABORTED));
+  EXPECT_TRUE(batch.IsFinished());
+
+  batch.Poll(&response, [&status](const absl::Status& s) { status = s; });
+  EXPECT_THAT(*status, StatusIs(error::ABORTED));
+}
+
+TEST(RecvTensorsBatchTest, Cancel) {
+  RecvTensorsBatch batch(/*num_tensors=*/1);
+  RecvTensorsResponse response;
+  std::optional<absl::Status> status;
+  batch.Poll(&response, [&status](const absl::Status& s) { status = s; });
+  batch.Cancel(errors::Cancelled("Step cleaned up"));
+  ASSERT_TRUE(status.has_value());
+  EXPECT_THAT(*status, StatusIs(error::CANCELLED));
+  EXPECT_TRUE(batch.IsFinished());
+}
+
+TEST(RecvTensorsBatchTest, ConcurrentPolls) {
+  RecvTensorsBatch batch(/*num_tensors=*/1);
+  RecvTensorsResponse response;
+  batch.Poll(&response, [](const absl::Status& s) {});
+  std::optional<absl::Status> status;
+  batch.Poll(&response, [&status](const absl::Status& s) { status = s; });
+  ASSERT_TRUE(status.has_value());
+  EXPECT_THAT(*status, StatusIs(error::FAILED_PRECONDITION));
+}
+
+}  // namespace
+}  // namespace tensorflow
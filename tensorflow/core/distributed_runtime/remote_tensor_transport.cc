@@ -0,0 +1,34 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/remote_tensor_transport.h"
+
+#include <cstdint>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+
+bool CanUseRemoteTensorTransport(const RemoteTensorTransport& transport,
+                                 const Tensor& tensor, bool is_dead) {
+  if (is_dead || !DataTypeCanUseMemcpy(tensor.dtype())) {
+    return false;
+  }
+  return static_cast<int64_t>(tensor.TotalBytes()) >=
+         transport.MinTensorBytes();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,85 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_REMOTE_TENSOR_TRANSPORT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_REMOTE_TENSOR_TRANSPORT_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#include "tsl/platform/status.h"
+
+namespace tensorflow {
+
+// A RemoteTensorTransport moves the content of tensors received by a remote
+// rendezvous outside of the RecvTensor RPC, e.g. with one-sided RDMA reads.
+// The RPC then only carries the tensor metadata, and a RemoteTensorDescriptor
+// which tells the receiver where to read the content from.
+//
+// The receiver offers its transport in the RecvTensorRequest. If the sender
+// has a transport with the same name and the tensor is eligible (see
+// `CanUseRemoteTensorTransport`), the sender exposes the tensor with
+// `ExposeTensor` and the receiver reads it with `ReadTensorAsync`. Otherwise,
+// the content is sent in the RPC as usual.
+//
+// Implementations must be thread-safe.
+class RemoteTensorTransport {
+ public:
+  // Tensors smaller than this are sent in the RPC by default, since exposing
+  // them costs more than copying them.
+  static constexpr int64_t kDefaultMinTensorBytes = 64 * 1024;
+
+  virtual ~RemoteTensorTransport() = default;
+
+  // The name of the transport. Workers only move tensors with the transport if
+  // both of them have a transport with the same name.
+  virtual std::string Name() const = 0;
+
+  // The size of the smallest tensor moved by the transport.
+  virtual int64_t MinTensorBytes() const { return kDefaultMinTensorBytes; }
+
+  // Called by the sender. Exposes the content of `tensor`, which is sent in
+  // `step_id`, for a read by the receiver, and describes where to read it from
+  // in `descriptor`. The transport keeps `tensor` alive until it is read or
+  // `ReleaseStep(step_id)` is called.
+  virtual absl::Status ExposeTensor(int64_t step_id, const Tensor& tensor,
+                                    RemoteTensorDescriptor* descriptor) = 0;
+
+  // Called by the receiver. Reads the content described by `descriptor` from
+  // `src_worker` into `tensor`, then calls `done`. `tensor` is allocated by the
+  // caller with the type and shape sent in the RPC, and must stay alive until
+  // `done` is called.
+  virtual void ReadTensorAsync(const std::string& src_worker,
+                               const RemoteTensorDescriptor& descriptor,
+                               Tensor* tensor, StatusCallback done) = 0;
+
+  // Called by the sender when `step_id` is cleaned up. Releases the tensors
+  // exposed in `step_id` which have not been read.
+  virtual void ReleaseStep(int64_t step_id) = 0;
+};
+
+// Returns true if the content of `tensor` may be moved by `transport` instead
+// of sent in the RPC. Dead tensors, tensors whose content is not a flat buffer
+// (e.g. strings), and tensors smaller than `transport.MinTensorBytes()` are
+// always sent in the RPC.
+bool CanUseRemoteTensorTransport(const RemoteTensorTransport& transport,
+                                 const Tensor& tensor, bool is_dead);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_REMOTE_TENSOR_TRANSPORT_H_
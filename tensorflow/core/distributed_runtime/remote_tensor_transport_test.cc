@@ -0,0 +1,75 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/remote_tensor_transport.h"
+
+#include <cstdint>
+#include <string>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class TestTransport : public RemoteTensorTransport {
+ public:
+  std::string Name() const override { return "test"; }
+  int64_t MinTensorBytes() const override { return 1024; }
+  absl::Status ExposeTensor(int64_t step_id, const Tensor& tensor,
+                            RemoteTensorDescriptor* descriptor) override {
+    return absl::OkStatus();
+  }
+  void ReadTensorAsync(const std::string& src_worker,
+                       const RemoteTensorDescriptor& descriptor,
+                       Tensor* tensor, StatusCallback done) override {
+    done(absl::OkStatus());
+  }
+  void ReleaseStep(int64_t step_id) override {}
+};
+
+TEST(RemoteTensorTransportTest, LargeTensors) {
+  TestTransport transport;
+  EXPECT_TRUE(CanUseRemoteTensorTransport(
+      transport, Tensor(DT_FLOAT, TensorShape({256})), /*is_dead=*/false));
+  EXPECT_TRUE(CanUseRemoteTensorTransport(
+      transport, Tensor(DT_INT64, TensorShape({16, 16})), /*is_dead=*/false));
+}
+
+TEST(RemoteTensorTransportTest, SmallTensors) {
+  TestTransport transport;
+  EXPECT_FALSE(CanUseRemoteTensorTransport(
+      transport, Tensor(DT_FLOAT, TensorShape({255})), /*is_dead=*/false));
+  EXPECT_FALSE(CanUseRemoteTensorTransport(
+      transport, Tensor(DT_FLOAT, TensorShape({0})), /*is_dead=*/false));
+}
+
+TEST(RemoteTensorTransportTest, StringTensors) {
+  TestTransport transport;
+  EXPECT_FALSE(CanUseRemoteTensorTransport(
+      transport, Tensor(DT_STRING, TensorShape({1024})), /*is_dead=*/false));
+}
+
+TEST(RemoteTensorTransportTest, DeadTensors) {
+  TestTransport transport;
+  EXPECT_FALSE(CanUseRemoteTensorTransport(
+      transport, Tensor(DT_FLOAT, TensorShape({256})), /*is_dead=*/true));
+}
+
+}  // namespace
+}  // namespace tensorflow
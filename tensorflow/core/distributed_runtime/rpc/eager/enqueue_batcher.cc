@@ -0,0 +1,103 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/eager/enqueue_batcher.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace eager {
+
+EnqueueBatcher::EnqueueBatcher(int64_t window_us, int64_t max_items,
+                               SendFn send)
+    : window_us_(window_us), max_items_(max_items), send_(std::move(send)) {}
+
+void EnqueueBatcher::Add(const EnqueueRequest& request,
+                         EnqueueResponse* response, StatusCallback done) {
+  mutex_lock l(mu_);
+  const uint64 context_id = request.context_id();
+  std::unique_ptr<Batch>& batch = batches_[context_id];
+  if (batch == nullptr) {
+    batch = std::make_unique<Batch>();
+    batch->id = next_batch_id_++;
+    batch->request.set_context_id(context_id);
+    // Sends the batch at the end of its window, unless it was already sent.
+    Ref();
+    Env::Default()->SchedClosureAfter(
+        window_us_, [this, context_id, batch_id = batch->id]() {
+          {
+            mutex_lock l(mu_);
+            auto it = batches_.find(context_id);
+            if (it != batches_.end() && it->second->id == batch_id) {
+              SendBatch(context_id);
+            }
+          }
+          this->Unref();
+        });
+  }
+  batch->request.mutable_queue()->MergeFrom(request.queue());
+  batch->pending.push_back({response, request.queue_size(), std::move(done)});
+  if (batch->request.queue_size() >= max_items_) {
+    SendBatch(context_id);
+  }
+}
+
+bool EnqueueBatcher::Cancel(uint64 context_id) {
+  std::unique_ptr<Batch> batch;
+  {
+    mutex_lock l(mu_);
+    auto it = batches_.find(context_id);
+    if (it == batches_.end()) return false;
+    batch = std::move(it->second);
+    batches_.erase(it);
+  }
+  for (PendingEnqueue& pending : batch->pending) {
+    pending.done(errors::Cancelled(
+        "Remote EagerContext was closed before the enqueue request was sent"));
+  }
+  return true;
+}
+
+void EnqueueBatcher::SendBatch(uint64 context_id) {
+  auto it = batches_.find(context_id);
+  Batch* batch = it->second.release();
+  batches_.erase(it);
+  VLOG(3) << "Sending " << batch->pending.size() << " enqueue requests with "
+          << batch->request.queue_size() << " items to remote context "
+          << context_id;
+  send_(batch->request, &batch->response, [batch](const Status& status) {
+    int offset = 0;
+    for (PendingEnqueue& pending : batch->pending) {
+      const int end = std::min(offset + pending.num_items,
+                               batch->response.queue_response_size());
+      for (int i = offset; i < end; ++i) {
+        pending.response->add_queue_response()->Swap(
+            batch->response.mutable_queue_response(i));
+      }
+      offset += pending.num_items;
+      pending.done(status);
+    }
+    delete batch;
+  });
+}
+
+}  // namespace eager
+}  // namespace tensorflow
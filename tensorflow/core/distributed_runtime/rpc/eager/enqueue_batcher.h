@@ -0,0 +1,96 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_ENQUEUE_BATCHER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_ENQUEUE_BATCHER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+
+// Coalesces the requests of streaming enqueue calls to the same remote
+// context. A request waits up to `window_us` microseconds for following ones,
+// or until `max_items` queue items are pending, and all of them are sent as a
+// single EnqueueRequest. Every caller gets its part of the queue responses.
+//
+// Since the server stops at the first failed item, all requests of a batch
+// share its status.
+class EnqueueBatcher : public core::RefCounted {
+ public:
+  // Sends `request` on the streaming enqueue call of its context. The batches
+  // of a context are sent in order, with the batcher's lock held, so `send`
+  // must not call back into the batcher.
+  using SendFn =
+      std::function<void(const EnqueueRequest& request,
+                         EnqueueResponse* response, StatusCallback done)>;
+
+  EnqueueBatcher(int64_t window_us, int64_t max_items, SendFn send);
+
+  // Appends `request` to the batch of its context. `done` is called once the
+  // batch has been sent and `response` holds the responses of the queue items
+  // of `request`, or once the batch is cancelled.
+  void Add(const EnqueueRequest& request, EnqueueResponse* response,
+           StatusCallback done);
+
+  // Fails the requests waiting to be sent to `context_id` with a Cancelled
+  // error. Returns true if there were any.
+  bool Cancel(uint64 context_id);
+
+ private:
+  // A request waiting to be sent in a batch.
+  struct PendingEnqueue {
+    EnqueueResponse* response;
+    int num_items;
+    StatusCallback done;
+  };
+
+  // Requests to the same context which are sent as one.
+  struct Batch {
+    int64_t id;
+    EnqueueRequest request;
+    EnqueueResponse response;
+    std::vector<PendingEnqueue> pending;
+  };
+
+  // Sends the batch of `context_id` and hands every request its part of the
+  // response.
+  void SendBatch(uint64 context_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t window_us_;
+  const int64_t max_items_;
+  const SendFn send_;
+
+  mutex mu_;
+  std::unordered_map<uint64, std::unique_ptr<Batch>> batches_
+      TF_GUARDED_BY(mu_);
+  int64_t next_batch_id_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace eager
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_ENQUEUE_BATCHER_H_
@@ -0,0 +1,270 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/eager/enqueue_batcher.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+namespace {
+
+// Long enough for the batches of a test to never be sent by their timer.
+constexpr int64_t kNoWindow = 600LL * 1000 * 1000;
+
+// A request to send through the batcher, and what it got back.
+struct Call {
+  EnqueueRequest request;
+  EnqueueResponse response;
+  Notification done;
+  Status status;
+};
+
+// A batch the batcher asked to send, which the test completes.
+struct SentBatch {
+  EnqueueRequest request;
+  EnqueueResponse* response;
+  StatusCallback done;
+};
+
+class EnqueueBatcherTest : public ::testing::Test {
+ protected:
+  void CreateBatcher(int64_t window_us, int64_t max_items) {
+    batcher_.reset(new EnqueueBatcher(
+        window_us, max_items,
+        [this](const EnqueueRequest& request, EnqueueResponse* response,
+               StatusCallback done) {
+          mutex_lock l(mu_);
+          sent_.push_back({request, response, std::move(done)});
+          batch_sent_.notify_all();
+        }));
+  }
+
+  // Returns a call to `context_id` whose queue holds one op per id in
+  // `op_ids`.
+  std::unique_ptr<Call> NewCall(uint64 context_id,
+                                const std::vector<int64_t>& op_ids) {
+    auto call = std::make_unique<Call>();
+    call->request.set_context_id(context_id);
+    for (int64_t op_id : op_ids) {
+      call->request.add_queue()->mutable_operation()->set_id(op_id);
+    }
+    return call;
+  }
+
+  void Add(Call* call) {
+    batcher_->Add(call->request, &call->response,
+                  [call](const Status& status) {
+                    call->status = status;
+                    call->done.Notify();
+                  });
+  }
+
+  std::vector<SentBatch> Sent() {
+    mutex_lock l(mu_);
+    return sent_;
+  }
+
+  // Completes `batch` with `status`, after answering its first `num_items`
+  // queue items the way the server does.
+  static void Complete(SentBatch& batch, int num_items, const Status& status) {
+    for (int i = 0; i < num_items; ++i) {
+      batch.response->add_queue_response()->add_shape()->add_dim()->set_size(
+          batch.request.queue(i).operation().id());
+    }
+    batch.done(status);
+  }
+
+  // Returns the op ids of `request` and the ids `Complete` answered in
+  // `response`.
+  static std::vector<int64_t> OpIds(const EnqueueRequest& request) {
+    std::vector<int64_t> op_ids;
+    for (const QueueItem& item : request.queue()) {
+      op_ids.push_back(item.operation().id());
+    }
+    return op_ids;
+  }
+  static std::vector<int64_t> OpIds(const EnqueueResponse& response) {
+    std::vector<int64_t> op_ids;
+    for (const QueueResponse& item : response.queue_response()) {
+      op_ids.push_back(item.shape(0).dim(0).size());
+    }
+    return op_ids;
+  }
+
+  mutex mu_;
+  condition_variable batch_sent_;
+  std::vector<SentBatch> sent_ TF_GUARDED_BY(mu_);
+  core::RefCountPtr<EnqueueBatcher> batcher_;
+};
+
+TEST_F(EnqueueBatcherTest, SendsFullBatchInOrder) {
+  CreateBatcher(kNoWindow, /*max_items=*/4);
+  auto a = NewCall(1, {1});
+  auto b = NewCall(1, {2, 3});
+  auto c = NewCall(1, {4});
+  Add(a.get());
+  Add(b.get());
+  EXPECT_TRUE(Sent().empty());
+  Add(c.get());
+
+  std::vector<SentBatch> sent = Sent();
+  ASSERT_EQ(sent.size(), 1);
+  EXPECT_EQ(sent[0].request.context_id(), 1);
+  EXPECT_EQ(OpIds(sent[0].request), std::vector<int64_t>({1, 2, 3, 4}));
+  EXPECT_FALSE(a->done.HasBeenNotified());
+
+  Complete(sent[0], 4, absl::OkStatus());
+  for (Call* call : {a.get(), b.get(), c.get()}) {
+    ASSERT_TRUE(call->done.HasBeenNotified());
+    TF_EXPECT_OK(call->status);
+    EXPECT_EQ(OpIds(call->response), OpIds(call->request));
+  }
+}
+
+TEST_F(EnqueueBatcherTest, FailedBatchFailsAllRequests) {
+  CreateBatcher(kNoWindow, /*max_items=*/4);
+  auto a = NewCall(1, {1});
+  auto b = NewCall(1, {2, 3});
+  auto c = NewCall(1, {4});
+  Add(a.get());
+  Add(b.get());
+  Add(c.get());
+
+  // The server ran ops 1 and 2 and failed on op 3.
+  std::vector<SentBatch> sent = Sent();
+  ASSERT_EQ(sent.size(), 1);
+  Complete(sent[0], 2, errors::Internal("op 3 failed"));
+
+  for (Call* call : {a.get(), b.get(), c.get()}) {
+    ASSERT_TRUE(call->done.HasBeenNotified());
+    EXPECT_TRUE(errors::IsInternal(call->status)) << call->status;
+  }
+  EXPECT_EQ(OpIds(a->response), std::vector<int64_t>({1}));
+  EXPECT_EQ(OpIds(b->response), std::vector<int64_t>({2}));
+  EXPECT_EQ(c->response.queue_response_size(), 0);
+}
+
+TEST_F(EnqueueBatcherTest, ConsecutiveBatchesKeepOrder) {
+  CreateBatcher(kNoWindow, /*max_items=*/2);
+  std::vector<std::unique_ptr<Call>> calls;
+  for (int64_t op_id = 1; op_id <= 6; ++op_id) {
+    calls.push_back(NewCall(1, {op_id}));
+    Add(calls.back().get());
+  }
+
+  std::vector<SentBatch> sent = Sent();
+  ASSERT_EQ(sent.size(), 3);
+  EXPECT_EQ(OpIds(sent[0].request), std::vector<int64_t>({1, 2}));
+  EXPECT_EQ(OpIds(sent[1].request), std::vector<int64_t>({3, 4}));
+  EXPECT_EQ(OpIds(sent[2].request), std::vector<int64_t>({5, 6}));
+  // A failed batch does not affect the following ones.
+  Complete(sent[0], 2, absl::OkStatus());
+  Complete(sent[1], 0, errors::Internal("op 3 failed"));
+  Complete(sent[2], 2, absl::OkStatus());
+  for (int i = 0; i < calls.size(); ++i) {
+    ASSERT_TRUE(calls[i]->done.HasBeenNotified());
+    EXPECT_EQ(calls[i]->status.ok(), i != 2 && i != 3) << i;
+  }
+  EXPECT_EQ(OpIds(calls[5]->response), std::vector<int64_t>({6}));
+}
+
+TEST_F(EnqueueBatcherTest, BatchesContextsSeparately) {
+  CreateBatcher(kNoWindow, /*max_items=*/2);
+  auto a = NewCall(1, {1});
+  auto b = NewCall(2, {2});
+  auto c = NewCall(2, {3});
+  Add(a.get());
+  Add(b.get());
+  EXPECT_TRUE(Sent().empty());
+  Add(c.get());
+
+  std::vector<SentBatch> sent = Sent();
+  ASSERT_EQ(sent.size(), 1);
+  EXPECT_EQ(sent[0].request.context_id(), 2);
+  EXPECT_EQ(OpIds(sent[0].request), std::vector<int64_t>({2, 3}));
+  Complete(sent[0], 2, absl::OkStatus());
+  EXPECT_FALSE(a->done.HasBeenNotified());
+
+  EXPECT_TRUE(batcher_->Cancel(1));
+  ASSERT_TRUE(a->done.HasBeenNotified());
+}
+
+TEST_F(EnqueueBatcherTest, SendsBatchAtEndOfWindow) {
+  CreateBatcher(/*window_us=*/1000, /*max_items=*/64);
+  auto a = NewCall(1, {1});
+  auto b = NewCall(1, {2});
+  Add(a.get());
+  Add(b.get());
+
+  // The window may end between the two requests, in which case they are sent
+  // in two batches.
+  std::vector<SentBatch> sent;
+  std::vector<int64_t> sent_op_ids;
+  {
+    mutex_lock l(mu_);
+    while (true) {
+      sent_op_ids.clear();
+      for (const SentBatch& batch : sent_) {
+        for (int64_t op_id : OpIds(batch.request)) {
+          sent_op_ids.push_back(op_id);
+        }
+      }
+      if (sent_op_ids.size() == 2) break;
+      batch_sent_.wait(l);
+    }
+    sent = sent_;
+  }
+  EXPECT_EQ(sent_op_ids, std::vector<int64_t>({1, 2}));
+
+  for (SentBatch& batch : sent) {
+    Complete(batch, batch.request.queue_size(), absl::OkStatus());
+  }
+  for (Call* call : {a.get(), b.get()}) {
+    ASSERT_TRUE(call->done.HasBeenNotified());
+    TF_EXPECT_OK(call->status);
+    EXPECT_EQ(OpIds(call->response), OpIds(call->request));
+  }
+}
+
+TEST_F(EnqueueBatcherTest, CancelFailsPendingRequests) {
+  CreateBatcher(kNoWindow, /*max_items=*/64);
+  auto a = NewCall(1, {1});
+  auto b = NewCall(1, {2});
+  Add(a.get());
+  Add(b.get());
+
+  EXPECT_TRUE(batcher_->Cancel(1));
+  EXPECT_FALSE(batcher_->Cancel(1));
+  EXPECT_TRUE(Sent().empty());
+  for (Call* call : {a.get(), b.get()}) {
+    ASSERT_TRUE(call->done.HasBeenNotified());
+    EXPECT_TRUE(errors::IsCancelled(call->status)) << call->status;
+  }
+}
+
+}  // namespace
+}  // namespace eager
+}  // namespace tensorflow
@@ -16,11 +16,14 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "xla/tsl/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/distributed_runtime/rpc/eager/enqueue_batcher.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_service.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
@@ -74,6 +77,35 @@ bool EnableStreaming() {
   return result;
 }
 
+/* Setting environment variable "TF_EAGER_CLIENT_ENQUEUE_BATCH_WINDOW_US" to a
+ * positive value coalesces the requests of streaming enqueue calls to the same
+ * remote context: a request waits up to that many microseconds for following
+ * ones, and all of them are sent as a single EnqueueRequest. This trades a
+ * little latency of the first op for far fewer messages when the client issues
+ * many small remote ops. Disabled by default.
+ */
+int64_t EnqueueBatchWindowMicros() {
+  static const int64_t window_us = [] {
+    int64_t result;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_CLIENT_ENQUEUE_BATCH_WINDOW_US",
+                                    0, &result));
+    return result;
+  }();
+  return window_us;
+}
+
+// A batch is sent as soon as it holds this many queue items, without waiting
+// for the end of its window.
+int64_t EnqueueBatchMaxItems() {
+  static const int64_t max_items = [] {
+    int64_t result;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_CLIENT_ENQUEUE_BATCH_MAX_ITEMS",
+                                    64, &result));
+    return result;
+  }();
+  return max_items;
+}
+
 // Ref-counted thread to handle callbacks for completed requests a GRPC
 // completion queue. The thread might be shared by multiple eager clients, and
 // each one of them should hold a reference count to ensure that the thread
@@ -124,6 +156,16 @@ class GrpcEagerClient : public EagerClient {
     // outlives the client.
     thread_->Ref();
     cq_ = thread->completion_queue();
+    if (EnqueueBatchWindowMicros() > 0) {
+      enqueue_batcher_.reset(new EnqueueBatcher(
+          EnqueueBatchWindowMicros(), EnqueueBatchMaxItems(),
+          [this](const EnqueueRequest& request, EnqueueResponse* response,
+                 StatusCallback done) {
+            mutex_lock l(mu_);
+            GetEnqueueDispatcher(request.context_id())
+                .SendNextRequest(request, response, std::move(done));
+          }));
+    }
   }
   ~GrpcEagerClient() override { thread_->Unref(); }
 
@@ -206,14 +248,18 @@ class GrpcEagerClient : public EagerClient {
     VLOG(1) << "Sending RPC to close remote eager context "
             << request->DebugString();
 
-    mutex_lock l(mu_);
-    const auto& it = enqueue_dispatchers_.find(request->context_id());
-    if (it != enqueue_dispatchers_.end()) {
-      it->second.CancelCall();
-      enqueue_dispatchers_.erase(it);
-    } else if (EnableStreaming()) {
-      LOG(ERROR) << "Remote EagerContext with id " << request->context_id()
-                 << " does not seem to exist.";
+    const bool cancelled_batch =
+        enqueue_batcher_ && enqueue_batcher_->Cancel(request->context_id());
+    {
+      mutex_lock l(mu_);
+      const auto& it = enqueue_dispatchers_.find(request->context_id());
+      if (it != enqueue_dispatchers_.end()) {
+        it->second.CancelCall();
+        enqueue_dispatchers_.erase(it);
+      } else if (EnableStreaming() && !cancelled_batch) {
+        LOG(ERROR) << "Remote EagerContext with id " << request->context_id()
+                   << " does not seem to exist.";
+      }
     }
   }
 
@@ -228,19 +274,14 @@ class GrpcEagerClient : public EagerClient {
     // 2. The flag set in the eager executor.
     // Streaming enqueue is allowed only when the both are enabled.
     if (EnableStreaming() && enable_streaming_enqueue) {
-      mutex_lock l(mu_);
-      auto it = enqueue_dispatchers_.find(request->context_id());
-      if (it == enqueue_dispatchers_.end()) {
-        auto it_and_bool = enqueue_dispatchers_.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(request->context_id()),
-            std::forward_as_tuple(
-                &stub_, cq_,
-                "/tensorflow.eager.EagerService/StreamingEnqueue"));
-        it = it_and_bool.first;
+      if (enqueue_batcher_) {
+        enqueue_batcher_->Add(*request, response, std::move(done_wrapped));
+        return;
       }
+      mutex_lock l(mu_);
       // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
-      it->second.SendNextRequest(*request, response, std::move(done_wrapped));
+      GetEnqueueDispatcher(request->context_id())
+          .SendNextRequest(*request, response, std::move(done_wrapped));
     } else {
       Notification n;
       Status status;
@@ -261,10 +302,28 @@ class GrpcEagerClient : public EagerClient {
 
   ::grpc::CompletionQueue* cq_;
 
+  StreamingRPCDispatcher<EnqueueResponse>& GetEnqueueDispatcher(
+      uint64 context_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    auto it = enqueue_dispatchers_.find(context_id);
+    if (it == enqueue_dispatchers_.end()) {
+      it = enqueue_dispatchers_
+               .emplace(std::piecewise_construct,
+                        std::forward_as_tuple(context_id),
+                        std::forward_as_tuple(
+                            &stub_, cq_,
+                            "/tensorflow.eager.EagerService/StreamingEnqueue"))
+               .first;
+    }
+    return it->second;
+  }
+
   mutable mutex mu_;
 
   std::unordered_map<uint64, StreamingRPCDispatcher<EnqueueResponse>>
       enqueue_dispatchers_ TF_GUARDED_BY(mu_);
+  // Coalesces streaming enqueue requests if
+  // TF_EAGER_CLIENT_ENQUEUE_BATCH_WINDOW_US is set.
+  core::RefCountPtr<EnqueueBatcher> enqueue_batcher_;
 
   StatusCallback callback_wrapper(StatusCallback done) {
     Ref();
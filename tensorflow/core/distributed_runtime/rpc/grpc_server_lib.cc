@@ -47,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 #include "tensorflow/core/distributed_runtime/rpc_collective_executor_mgr.h"
 #include "tensorflow/core/distributed_runtime/server_lib.h"
+#include "tensorflow/core/distributed_runtime/shared_memory_tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/worker_cache_wrapper.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
 #include "tensorflow/core/framework/op.h"
@@ -91,11 +92,6 @@ class ReusePortOption : public ::grpc::ServerBuilderOption {
                          plugins) override {}
 };
 
-// static utility function
-RendezvousMgrInterface* NewRpcRendezvousMgr(const WorkerEnv* env) {
-  return new RpcRendezvousMgr(env);
-}
-
 }  // namespace
 
 GrpcServer::GrpcServer(const ServerDef& server_def, Env* env)
@@ -229,9 +225,26 @@ Status GrpcServer::Init(const GrpcServerOptions& opts) {
   master_env_.experimental_num_shards = std::max(1, num_tasks);
   worker_env_.experimental_num_shards = master_env_.experimental_num_shards;
 
-  worker_env_.rendezvous_mgr = opts.rendezvous_mgr_func == nullptr
-                                   ? new RpcRendezvousMgr(&worker_env_)
-                                   : opts.rendezvous_mgr_func(&worker_env_);
+  worker_env_.rendezvous_mgr =
+      opts.rendezvous_mgr_func == nullptr
+          ? new RpcRendezvousMgr(&worker_env_, config.rpc_options())
+          : opts.rendezvous_mgr_func(&worker_env_);
+  if (opts.remote_tensor_transport_func) {
+    remote_tensor_transport_ = opts.remote_tensor_transport_func(&worker_env_);
+    worker_env_.remote_tensor_transport = remote_tensor_transport_.get();
+  } else {
+    // Workers in different processes on the same host can hand large host
+    // tensors to each other through shared memory instead of the loopback.
+    bool use_shared_memory = false;
+    TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_RENDEZVOUS_USE_SHARED_MEMORY",
+                                          false, &use_shared_memory));
+    if (use_shared_memory) {
+      std::unique_ptr<SharedMemoryTensorTransport> transport;
+      TF_RETURN_IF_ERROR(SharedMemoryTensorTransport::Create(&transport));
+      remote_tensor_transport_ = std::move(transport);
+      worker_env_.remote_tensor_transport = remote_tensor_transport_.get();
+    }
+  }
   string unused;
   string default_worker_name;
   if (!DeviceNameUtils::SplitDeviceName(master_env_.local_devices[0]->name(),
@@ -608,7 +621,6 @@ Status GrpcServer::Create(const ServerDef& server_def, Env* env,
   std::unique_ptr<GrpcServer> ret(
       new GrpcServer(server_def, env == nullptr ? Env::Default() : env));
   GrpcServerOptions options;
-  options.rendezvous_mgr_func = NewRpcRendezvousMgr;
   options.local_device_mgr = local_device_mgr;
   Status s = ret->Init(options);
   if (!s.ok()) {
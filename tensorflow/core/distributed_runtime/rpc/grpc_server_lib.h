@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/stats_publisher_interface.h"
 #include "tensorflow/core/distributed_runtime/master_env.h"
+#include "tensorflow/core/distributed_runtime/remote_tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_channel.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
@@ -59,6 +60,11 @@ typedef std::function<CollectiveExecutorMgrInterface*(
 typedef std::function<void(const WorkerEnv*, ::grpc::ServerBuilder*)>
     ServiceInitFunction;
 
+// function that creates a transport which moves large tensors between workers
+// outside of the RecvTensor RPC.
+typedef std::function<std::unique_ptr<RemoteTensorTransport>(const WorkerEnv*)>
+    RemoteTensorTransportCreationFunction;
+
 // function that creates a grpc based worker implementation.
 typedef std::function<std::unique_ptr<GrpcWorker>(WorkerEnv*,
                                                   const ConfigProto& config)>
@@ -68,6 +74,7 @@ struct GrpcServerOptions {
   ServiceInitFunction service_func = nullptr;
   RendezvousMgrCreationFunction rendezvous_mgr_func = nullptr;
   CollectiveMgrCreationFunction collective_mgr_func = nullptr;
+  RemoteTensorTransportCreationFunction remote_tensor_transport_func = nullptr;
   WorkerCreationFunction worker_func = nullptr;
   StatsPublisherFactory stats_factory = CreateNoOpStatsPublisher;
   GrpcWorkerServiceOptions worker_service_options;
@@ -214,6 +221,7 @@ class GrpcServer : public ServerInterface {
   WorkerEnv worker_env_;
   std::unique_ptr<const DeviceMgr> owned_device_manager_;
   std::unique_ptr<GrpcWorker> worker_impl_;
+  std::unique_ptr<RemoteTensorTransport> remote_tensor_transport_;
   tsl::AsyncServiceInterface* worker_service_ = nullptr;
   std::unique_ptr<Thread> worker_thread_ TF_GUARDED_BY(mu_);
   std::unique_ptr<GrpcWorkerEnv> grpc_worker_env_;
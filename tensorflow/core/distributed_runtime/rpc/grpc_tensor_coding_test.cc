@@ -15,14 +15,22 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 
+#include <memory>
+
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
 
@@ -100,4 +108,26 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, ParseSharesLargeTensorContent) {
+  std::unique_ptr<Device> cpu = DeviceFactory::NewDevice(
+      "CPU", SessionOptions(), "/job:worker/replica:0/task:0");
+  ASSERT_NE(cpu, nullptr);
+  for (int64_t num_elements : {16, 1 << 16}) {
+    Tensor t(DT_FLOAT, TensorShape({num_elements}));
+    test::FillIota<float>(&t, 0.0f);
+    ::grpc::ByteBuffer buf;
+    grpc::EncodeTensorToByteBuffer(/*is_dead=*/false, t, false, &buf);
+
+    TensorResponse response;
+    response.InitAlloc(cpu.get(), AllocatorAttributes());
+    ASSERT_TRUE(GrpcMaybeParseTensorResponse(&buf, &response));
+    test::ExpectTensorEqual<float>(t, response.tensor());
+    // The content of large tensors is sent as a slice of the tensor buffer,
+    // and received without copying it.
+    const bool shared = response.tensor().tensor_data().data() ==
+                        t.tensor_data().data();
+    EXPECT_EQ(shared, num_elements > 16);
+  }
+}
+
 }  // namespace tensorflow
@@ -15,9 +15,57 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "grpcpp/support/slice.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor.h"
 
 namespace tensorflow {
+namespace {
+
+// A tensor buffer pointing into a slice of a received gRPC message.
+class SliceBuffer : public TensorBuffer {
+ public:
+  SliceBuffer(::grpc::Slice slice, const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        slice_(std::move(slice)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("GrpcSlice");
+  }
+  // The slice may share the memory of the sender, e.g. with in-process
+  // channels, so ops must not reuse the buffer for their outputs.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const ::grpc::Slice slice_;
+  const size_t size_;
+};
+
+}  // namespace
+
+TensorBuffer* GrpcByteSource::ShareContents(const char* data, size_t size) {
+  std::vector<::grpc::Slice> slices;
+  if (!buffer_->Dump(&slices).ok()) return nullptr;
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+  for (::grpc::Slice& slice : slices) {
+    const uintptr_t slice_begin = reinterpret_cast<uintptr_t>(slice.begin());
+    if (begin >= slice_begin && begin + size <= slice_begin + slice.size()) {
+      return new SliceBuffer(std::move(slice), data, size);
+    }
+  }
+  // The reader yielded bytes it owns, e.g. decompressed ones.
+  return nullptr;
+}
 
 bool GrpcMaybeParseTensorResponse(::grpc::ByteBuffer* src,
                                   TensorResponse* dst) {
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_UTIL_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_UTIL_H_
 
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -24,6 +25,7 @@ limitations under the License.
 #include "grpcpp/support/byte_buffer.h"
 #include "xla/tsl/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -50,6 +52,10 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  // Shares the bytes if they lie within one slice of the buffer, by holding a
+  // reference to the slice.
+  TensorBuffer* ShareContents(const char* data, size_t size) override;
+
  private:
   void DeleteStream() {
     if (stream_) {
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
+#include "tensorflow/core/distributed_runtime/remote_tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
@@ -145,6 +146,7 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(CompleteInstance, 10, true);
     SETUP_FOR_REQUEST(GetStepSequence, 10, true);
     SETUP_FOR_REQUEST(RecvBuf, 500, true);
+    SETUP_FOR_REQUEST(RecvTensors, 500, true);
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
@@ -301,6 +303,25 @@ class GrpcWorkerServiceThread {
     ENQUEUE_REQUEST(RecvBuf, true);
   }
 
+  void RecvTensorsHandler(
+      WorkerCall<RecvTensorsRequest, RecvTensorsResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorsAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from RecvTensors:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(RecvTensors, true);
+  }
+
   void CompleteGroupHandler(
       WorkerCall<CompleteGroupRequest, CompleteGroupResponse>* call) {
     Schedule([this, call]() {
@@ -434,6 +455,32 @@ void GrpcWorker::EnableResponseCache() {
   response_cache_ = std::make_unique<RpcResponseCache>();
 }
 
+namespace {
+// Exposes `tensor` with `transport` and encodes a response holding only the
+// tensor metadata and its RemoteTensorDescriptor into `result`. Returns false
+// if the tensor could not be exposed, in which case it is sent in the RPC.
+bool EncodeExposedTensorToByteBuffer(RemoteTensorTransport* transport,
+                                     int64_t step_id, const Tensor& tensor,
+                                     bool require_ack,
+                                     ::grpc::ByteBuffer* result) {
+  RemoteTensorDescriptor descriptor;
+  Status s = transport->ExposeTensor(step_id, tensor, &descriptor);
+  if (!s.ok()) {
+    VLOG(1) << "Sending tensor in the RecvTensor RPC since transport "
+            << transport->Name() << " failed to expose it: " << s;
+    return false;
+  }
+  RecvTensorResponse proto;
+  proto.mutable_tensor()->set_dtype(tensor.dtype());
+  tensor.shape().AsProto(proto.mutable_tensor()->mutable_tensor_shape());
+  proto.set_send_start_micros(Env::Default()->NowMicros());
+  proto.set_require_ack(require_ack);
+  proto.mutable_transport_options()->PackFrom(descriptor);
+  grpc::EncodeRecvTensorResponseToByteBuffer(proto, result);
+  return true;
+}
+}  // namespace
+
 // GrpcRecvTensorAsync: unlike the other Worker methods, which use protocol
 // buffers for a response object, to avoid extra protocol buffer serialization
 // overhead we generate our response directly into a ::grpc::ByteBuffer object
@@ -447,11 +494,30 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  // If the receiver offers the same transport as this worker, large tensors
+  // are exposed to the transport instead of being copied into the response.
+  RemoteTensorTransport* transport = nullptr;
+  if (env_->remote_tensor_transport != nullptr &&
+      request->transport_options().Is<RemoteTensorTransportRequest>()) {
+    RemoteTensorTransportRequest transport_request;
+    if (request->transport_options().UnpackTo(&transport_request) &&
+        transport_request.transport() ==
+            env_->remote_tensor_transport->Name()) {
+      transport = env_->remote_tensor_transport;
+    }
+  }
+
+  auto do_response = [response, done, cache_enabled, transport, step_id](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      if (transport == nullptr ||
+          !CanUseRemoteTensorTransport(*transport, tensor, is_dead) ||
+          !EncodeExposedTensorToByteBuffer(transport, step_id, tensor,
+                                           cache_enabled, response)) {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       response);
+      }
     }
     done(status);
   };
@@ -15,10 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/remote_tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
@@ -31,15 +40,34 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+#include "tsl/protobuf/rpc_options.pb.h"
 
 namespace tensorflow {
 
 namespace {
 
+// The default of `RPCOptions.max_coalesced_recv_tensors`.
+constexpr int kDefaultMaxCoalescedRecvTensors = 64;
+
+// A recv waiting to be received in a RecvTensors batch.
+struct CoalescedRecv {
+  Rendezvous::ParsedKey parsed;
+  Rendezvous::Args recv_args;
+  Device* dst_device;
+  Rendezvous::DoneCallback done;
+};
+
+class RpcRecvTensorsCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id,
+                      int64_t coalescing_window_micros, int max_coalesced_recvs)
+      : BaseRemoteRendezvous(env, step_id),
+        coalescing_window_micros_(coalescing_window_micros),
+        max_coalesced_recvs_(max_coalesced_recvs) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -47,8 +75,44 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
                            DoneCallback done) override;
 
  private:
+  // Recvs are coalesced by source worker and cancellation manager. Keeping the
+  // recvs of a batch on the same cancellation manager guarantees that it stays
+  // alive until the last recv of the batch is done.
+  using BatchKey = std::pair<std::string, CancellationManager*>;
+
   ~RpcRemoteRendezvous() override {}
 
+  // Receives the tensor for `parsed` with its own RecvTensor RPC.
+  void RecvTensorAsync(const Rendezvous::ParsedKey& parsed,
+                       const Rendezvous::Args& recv_args, DoneCallback done);
+
+  // Adds the recv to the pending batch of its source worker, which is sent
+  // once it is full, or `coalescing_window_micros_` after it was started.
+  void CoalesceRecvAsync(const Rendezvous::ParsedKey& parsed,
+                         const Rendezvous::Args& recv_args, DoneCallback done);
+
+  // Sends the pending batch for `key`, if any.
+  void FlushRecvs(const BatchKey& key);
+
+  // Receives `recvs` from `src_worker` with RecvTensors RPCs.
+  void SendRecvs(const std::string& src_worker,
+                 std::vector<CoalescedRecv> recvs);
+
+  // Issues the next RecvTensors RPC of `call`, until all of its tensors are
+  // received.
+  void PollRecvs(RpcRecvTensorsCall* call,
+                 std::shared_ptr<WorkerCacheInterface> worker_cache);
+
+  const int64_t coalescing_window_micros_;
+  const int max_coalesced_recvs_;
+
+  mutex coalesced_recvs_mu_;
+  absl::flat_hash_map<BatchKey, std::vector<CoalescedRecv>> coalesced_recvs_
+      TF_GUARDED_BY(coalesced_recvs_mu_);
+  // Source workers which do not support RecvTensors.
+  absl::flat_hash_set<std::string> workers_without_recv_tensors_
+      TF_GUARDED_BY(coalesced_recvs_mu_);
+
   RpcRemoteRendezvous(const RpcRemoteRendezvous&) = delete;
   void operator=(const RpcRemoteRendezvous&) = delete;
 };
@@ -56,11 +120,13 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
 // Used only to retrieve tensors from remote processes.
 class RpcRecvTensorCall : public BaseRecvTensorCall {
  public:
-  RpcRecvTensorCall() : wi_(nullptr), dst_device_(nullptr) {}
+  RpcRecvTensorCall()
+      : wi_(nullptr), dst_device_(nullptr), transport_(nullptr) {}
 
   void Init(WorkerInterface* wi, int64_t step_id, StringPiece key,
             AllocatorAttributes alloc_attrs, Device* dst_device,
-            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done,
+            RemoteTensorTransport* transport) {
     wi_ = wi;
     alloc_attrs_ = alloc_attrs;
     dst_device_ = dst_device;
@@ -69,6 +135,16 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    // The transport only reads tensor content into host memory, so it is not
+    // offered for tensors received directly into device memory.
+    if (transport != nullptr &&
+        (alloc_attrs.on_host() ||
+         dst_device->attributes().device_type() == "CPU")) {
+      transport_ = transport;
+      RemoteTensorTransportRequest transport_request;
+      transport_request.set_transport(transport->Name());
+      req_.mutable_transport_options()->PackFrom(transport_request);
+    }
   }
 
   void Reset() {
@@ -79,6 +155,8 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
     alloc_attrs_ = AllocatorAttributes();
     dst_device_ = nullptr;
+    transport_ = nullptr;
+    transport_tensor_ = Tensor();
     // We don't clear opts_ and assume that Init will set up the state for
     // opts_ appropriately.
     req_.Clear();
@@ -145,6 +223,12 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
       if (!s.ok()) {
         mutex_lock l(mu_);
         status_.Update(s);
+      } else if (transport_ != nullptr &&
+                 resp_.metadata()
+                     .transport_options()
+                     .Is<RemoteTensorDescriptor>()) {
+        ReadFromTransport(recv_done);
+        return;
       }
       recv_done();
     };
@@ -167,6 +251,45 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     abort_checked->Notify();
   }
 
+  // Reads the tensor content left out of the response with `transport_`, into
+  // the tensor allocated when parsing the response.
+  void ReadFromTransport(std::function<void()> recv_done) {
+    RemoteTensorDescriptor descriptor;
+    Status s;
+    if (!resp_.metadata().transport_options().UnpackTo(&descriptor)) {
+      s = errors::Internal("Failed to parse the remote tensor descriptor of ",
+                           req_.rendezvous_key());
+    } else if (descriptor.transport() != transport_->Name()) {
+      s = errors::Internal("Received tensor ", req_.rendezvous_key(),
+                           " exposed by transport ", descriptor.transport(),
+                           ", but this worker uses transport ",
+                           transport_->Name());
+    } else if (descriptor.num_bytes() != resp_.tensor().TotalBytes()) {
+      s = errors::Internal("Remote tensor ", req_.rendezvous_key(), " has ",
+                           descriptor.num_bytes(), " bytes, but expected ",
+                           resp_.tensor().TotalBytes(), " bytes");
+    }
+    if (!s.ok()) {
+      {
+        mutex_lock l(mu_);
+        status_.Update(s);
+      }
+      recv_done();
+      return;
+    }
+
+    // `transport_tensor_` shares the buffer of the parsed tensor.
+    transport_tensor_ = resp_.tensor();
+    transport_->ReadTensorAsync(src_worker_, descriptor, &transport_tensor_,
+                                [this, recv_done](const Status& s) {
+                                  if (!s.ok()) {
+                                    mutex_lock l(mu_);
+                                    status_.Update(s);
+                                  }
+                                  recv_done();
+                                });
+  }
+
   string src_worker_;
   string src_rel_device_;
   WorkerInterface* wi_;  // Not owned.
@@ -177,6 +300,8 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   TensorResponse resp_;
   Rendezvous::Args recv_args_;
   Rendezvous::DoneCallback done_;
+  RemoteTensorTransport* transport_;  // Not owned.
+  Tensor transport_tensor_;
 
   mutable mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
@@ -230,10 +355,158 @@ static RpcRecvTensorFreeList* get_call_freelist() {
   return call_freelist;
 }
 
+// Used to retrieve a batch of tensors from a remote process with RecvTensors
+// RPCs. Each RPC returns some of the tensors, until all of them are received.
+class RpcRecvTensorsCall : public BaseRecvTensorCall {
+ public:
+  RpcRecvTensorsCall(WorkerInterface* wi, std::string src_worker,
+                     int64_t step_id, std::vector<CoalescedRecv> recvs)
+      : wi_(wi),
+        src_worker_(std::move(src_worker)),
+        recvs_(std::move(recvs)),
+        received_(recvs_.size(), false) {
+    req_.set_step_id(step_id);
+    req_.set_batch_id(GetUniqueRequestId());
+    for (const CoalescedRecv& recv : recvs_) {
+      req_.add_rendezvous_key(recv.parsed.FullKey().data(),
+                              recv.parsed.FullKey().size());
+    }
+  }
+
+  ~RpcRecvTensorsCall() override {
+    CHECK_EQ(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "Leaking WorkerInterface in RpcRecvTensorsCall destructor.";
+  }
+
+  // Issues the next RecvTensors RPC, checking for an async abort as in
+  // `RpcRecvTensorCall::StartRTCall()`.
+  void Start(std::function<void()> recv_done) override {
+    resp_.Clear();
+    auto abort_checked = std::make_shared<Notification>();
+    wi_->RecvTensorsAsync(
+        &opts_, &req_, &resp_,
+        [this, abort_checked, recv_done = std::move(recv_done)](
+            const Status& s) {
+          abort_checked->WaitForNotification();
+          if (!s.ok()) {
+            mutex_lock l(mu_);
+            status_.Update(s);
+          }
+          recv_done();
+        });
+    Status s;
+    {
+      mutex_lock l(mu_);
+      s = status_;
+    }
+    if (!s.ok()) {
+      opts_.StartCancel();
+    }
+    abort_checked->Notify();
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  void ReleaseWorker(WorkerCacheInterface* worker_cache) {
+    DCHECK_NE(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "RpcRecvTensorsCall::ReleaseWorker() called twice.";
+    worker_cache->ReleaseWorker(src_worker_, wi_);
+    wi_ = nullptr;
+  }
+
+  // Decodes the tensors of the last response. The recvs which received a
+  // tensor are moved to `received`, with their tensor in `tensors`.
+  Status TakeReceived(std::vector<CoalescedRecv>* received,
+                      std::vector<Tensor>* tensors,
+                      std::vector<bool>* is_dead) {
+    if (resp_.index_size() != resp_.tensor_size()) {
+      return errors::Internal("RecvTensors returned ", resp_.tensor_size(),
+                              " tensors for ", resp_.index_size(),
+                              " indices.");
+    }
+    for (int i = 0; i < resp_.index_size(); ++i) {
+      const int index = resp_.index(i);
+      if (index < 0 || index >= recvs_.size() || received_[index]) {
+        return errors::Internal("RecvTensors returned an invalid index ",
+                                index, " for a batch of ", recvs_.size(),
+                                " tensors.");
+      }
+      CoalescedRecv& recv = recvs_[index];
+      const RecvTensorResponse& response = resp_.tensor(i);
+      Tensor tensor;
+      if (!response.is_dead()) {
+        TF_RETURN_IF_ERROR(recv.dst_device->MakeTensorFromProto(
+            response.tensor(), recv.recv_args.alloc_attrs, &tensor));
+      }
+      received_[index] = true;
+      ++num_received_;
+      received->push_back(std::move(recv));
+      tensors->push_back(std::move(tensor));
+      is_dead->push_back(response.is_dead());
+    }
+    // Follow-up requests only name the batch.
+    req_.clear_rendezvous_key();
+    return absl::OkStatus();
+  }
+
+  // Moves the recvs which have not received a tensor to `remaining`.
+  void TakeRemaining(std::vector<CoalescedRecv>* remaining) {
+    for (int i = 0; i < recvs_.size(); ++i) {
+      if (!received_[i]) {
+        received_[i] = true;
+        remaining->push_back(std::move(recvs_[i]));
+      }
+    }
+    num_received_ = recvs_.size();
+  }
+
+  bool finished() const { return num_received_ == recvs_.size(); }
+  bool received_any() const { return num_received_ > 0; }
+  const std::string& src_worker() const { return src_worker_; }
+  const Rendezvous::Args& recv_args() const { return recvs_[0].recv_args; }
+
+ private:
+  WorkerInterface* wi_;  // Not owned.
+  const std::string src_worker_;
+  std::vector<CoalescedRecv> recvs_;
+  std::vector<bool> received_;
+  int num_received_ = 0;
+  CallOptions opts_;
+  RecvTensorsRequest req_;
+  RecvTensorsResponse resp_;
+
+  mutable mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  RpcRecvTensorsCall(const RpcRecvTensorsCall&) = delete;
+  void operator=(const RpcRecvTensorsCall&) = delete;
+};
+
 void RpcRemoteRendezvous::RecvFromRemoteAsync(
     const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
     DoneCallback done) {
   CHECK(is_initialized());
+  if (coalescing_window_micros_ > 0) {
+    CoalesceRecvAsync(parsed, recv_args, std::move(done));
+  } else {
+    RecvTensorAsync(parsed, recv_args, std::move(done));
+  }
+}
+
+void RpcRemoteRendezvous::RecvTensorAsync(const Rendezvous::ParsedKey& parsed,
+                                          const Rendezvous::Args& recv_args,
+                                          DoneCallback done) {
   Status s;
 
   // Prepare a RecvTensor call that can handle being aborted.
@@ -270,7 +543,7 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   }
 
   call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
-             recv_args, std::move(done));
+             recv_args, std::move(done), env_->remote_tensor_transport);
 
   // Record "call" in calls_ so that it can be aborted cleanly.
   RegisterCall(call, recv_args);
@@ -305,15 +578,181 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   });
 }
 
+void RpcRemoteRendezvous::CoalesceRecvAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
+  string src_worker;
+  string src_rel_device;
+  if (!DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                        &src_rel_device)) {
+    done(errors::Internal(parsed.src_device,
+                          " is invalid remote source device."),
+         Args(), recv_args, Tensor{}, false);
+    return;
+  }
+  Device* dst_device;
+  Status s = session()->device_mgr()->LookupDevice(parsed.dst_device,
+                                                   &dst_device);
+  if (!s.ok()) {
+    done(s, Args(), recv_args, Tensor{}, false);
+    return;
+  }
+
+  BatchKey key(src_worker, recv_args.cancellation_manager);
+  std::vector<CoalescedRecv> full_batch;
+  bool coalesce = false;
+  bool start_batch = false;
+  {
+    mutex_lock l(coalesced_recvs_mu_);
+    coalesce = !workers_without_recv_tensors_.contains(src_worker);
+    if (coalesce) {
+      std::vector<CoalescedRecv>& recvs = coalesced_recvs_[key];
+      start_batch = recvs.empty();
+      recvs.push_back({parsed, recv_args, dst_device, std::move(done)});
+      if (recvs.size() >= max_coalesced_recvs_) {
+        full_batch = std::move(recvs);
+        coalesced_recvs_.erase(key);
+        start_batch = false;
+      }
+    }
+  }
+  if (!coalesce) {
+    RecvTensorAsync(parsed, recv_args, std::move(done));
+    return;
+  }
+  if (!full_batch.empty()) {
+    SendRecvs(src_worker, std::move(full_batch));
+    return;
+  }
+  if (start_batch) {
+    // If the batch fills up before the window ends, this may flush a later
+    // batch early, which is harmless.
+    Ref();
+    env_->env->SchedClosureAfter(coalescing_window_micros_,
+                                 [this, key = std::move(key)]() {
+                                   FlushRecvs(key);
+                                   Unref();
+                                 });
+  }
+}
+
+void RpcRemoteRendezvous::FlushRecvs(const BatchKey& key) {
+  std::vector<CoalescedRecv> recvs;
+  {
+    mutex_lock l(coalesced_recvs_mu_);
+    auto it = coalesced_recvs_.find(key);
+    if (it == coalesced_recvs_.end()) {
+      return;
+    }
+    recvs = std::move(it->second);
+    coalesced_recvs_.erase(it);
+  }
+  SendRecvs(key.first, std::move(recvs));
+}
+
+void RpcRemoteRendezvous::SendRecvs(const std::string& src_worker,
+                                    std::vector<CoalescedRecv> recvs) {
+  WorkerSession* sess = session();
+  std::shared_ptr<WorkerCacheInterface> worker_cache =
+      sess->GetSharedWorkerCache();
+  WorkerInterface* rwi = worker_cache->GetOrCreateWorker(src_worker);
+  if (rwi == nullptr) {
+    Status s = errors::Internal("No worker known as ", src_worker);
+    for (CoalescedRecv& recv : recvs) {
+      recv.done(s, Args(), recv.recv_args, Tensor{}, false);
+    }
+    return;
+  }
+
+  auto* call = new RpcRecvTensorsCall(rwi, src_worker, step_id_,
+                                      std::move(recvs));
+  RegisterCall(call, call->recv_args());
+  if (!call->status().ok()) {
+    DeregisterCall(call, call->recv_args());
+    call->ReleaseWorker(worker_cache.get());
+    std::vector<CoalescedRecv> remaining;
+    call->TakeRemaining(&remaining);
+    for (CoalescedRecv& recv : remaining) {
+      recv.done(call->status(), Args(), recv.recv_args, Tensor{}, false);
+    }
+    delete call;
+    return;
+  }
+  Ref();
+  PollRecvs(call, std::move(worker_cache));
+}
+
+void RpcRemoteRendezvous::PollRecvs(
+    RpcRecvTensorsCall* call,
+    std::shared_ptr<WorkerCacheInterface> worker_cache) {
+  call->Start([this, call, worker_cache = std::move(worker_cache)]() {
+    Status s = call->status();
+    std::vector<CoalescedRecv> received;
+    std::vector<Tensor> tensors;
+    std::vector<bool> is_dead;
+    if (s.ok()) {
+      s = call->TakeReceived(&received, &tensors, &is_dead);
+    }
+    if (s.ok() && !call->finished()) {
+      // The remaining recvs keep the cancellation manager of the batch alive.
+      for (int i = 0; i < received.size(); ++i) {
+        received[i].done(s, Args(), received[i].recv_args, tensors[i],
+                         is_dead[i]);
+      }
+      PollRecvs(call, worker_cache);
+      return;
+    }
+
+    // As in `RecvTensorAsync()`, the call is deregistered and the worker
+    // released before the last recvs are done.
+    DeregisterCall(call, call->recv_args());
+    call->ReleaseWorker(worker_cache.get());
+    std::vector<CoalescedRecv> remaining;
+    call->TakeRemaining(&remaining);
+    const bool fall_back =
+        absl::IsUnimplemented(s) && !call->received_any() && received.empty();
+    if (fall_back) {
+      VLOG(1) << "Worker " << call->src_worker()
+              << " does not support RecvTensors, sending a RecvTensor RPC "
+              << "for each tensor.";
+      mutex_lock l(coalesced_recvs_mu_);
+      workers_without_recv_tensors_.insert(call->src_worker());
+    }
+    delete call;
+    for (int i = 0; i < received.size(); ++i) {
+      received[i].done(s, Args(), received[i].recv_args, tensors[i],
+                       is_dead[i]);
+    }
+    for (CoalescedRecv& recv : remaining) {
+      if (fall_back) {
+        RecvTensorAsync(recv.parsed, recv.recv_args, std::move(recv.done));
+      } else {
+        recv.done(s, Args(), recv.recv_args, Tensor{}, false);
+      }
+    }
+    Unref();
+  });
+}
+
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+    : RpcRendezvousMgr(env, RPCOptions()) {}
+
+RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env,
+                                   const RPCOptions& rpc_options)
+    : BaseRendezvousMgr(env),
+      coalescing_window_micros_(
+          rpc_options.recv_tensor_coalescing_window_micros()),
+      max_coalesced_recvs_(rpc_options.max_coalesced_recv_tensors() > 0
+                               ? rpc_options.max_coalesced_recv_tensors()
+                               : kDefaultMaxCoalescedRecvTensors) {}
 
 tsl::core::RefCountPtr<BaseRemoteRendezvous> RpcRendezvousMgr::Create(
     int64_t step_id, const WorkerEnv* worker_env) {
   return tsl::core::RefCountPtr<BaseRemoteRendezvous>(
-      new RpcRemoteRendezvous(worker_env, step_id));
+      new RpcRemoteRendezvous(worker_env, step_id, coalescing_window_micros_,
+                              max_coalesced_recvs_));
 }
 
 }  // end namespace tensorflow
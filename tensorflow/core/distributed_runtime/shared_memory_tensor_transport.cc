@@ -0,0 +1,172 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/shared_memory_tensor_transport.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kSharedMemoryDirEnvVar[] = "TF_RENDEZVOUS_SHARED_MEMORY_DIR";
+constexpr char kDefaultSharedMemoryDir[] = "/dev/shm";
+constexpr char kTransportDirectoryPrefix[] = "tf_rendezvous_";
+constexpr char kSegmentPrefix[] = "segment_";
+
+// Returns the directory holding the segment directories of the transports.
+std::string SharedMemoryBaseDirectory() {
+  const char* dir = std::getenv(kSharedMemoryDirEnvVar);
+  return io::CleanPath(dir != nullptr && *dir != '\0'
+                           ? dir
+                           : kDefaultSharedMemoryDir);
+}
+
+// Returns whether `segment` names a segment file created by a transport on
+// this host, so that receivers never map or delete other files.
+bool IsSharedMemorySegment(absl::string_view segment) {
+  const absl::string_view transport_directory = io::Dirname(segment);
+  return io::Dirname(transport_directory) == SharedMemoryBaseDirectory() &&
+         absl::StartsWith(io::Basename(transport_directory),
+                          kTransportDirectoryPrefix) &&
+         absl::StartsWith(io::Basename(segment), kSegmentPrefix);
+}
+
+}  // namespace
+
+/*static*/
+absl::Status SharedMemoryTensorTransport::Create(
+    std::unique_ptr<SharedMemoryTensorTransport>* transport) {
+  const std::string base_directory = SharedMemoryBaseDirectory();
+  const std::string directory = io::JoinPath(
+      base_directory,
+      absl::StrCat(kTransportDirectoryPrefix, absl::Hex(random::New64())));
+  TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(directory));
+  transport->reset(new SharedMemoryTensorTransport(
+      absl::StrCat("shared_memory:", port::Hostname(), ":", base_directory),
+      directory));
+  return absl::OkStatus();
+}
+
+SharedMemoryTensorTransport::~SharedMemoryTensorTransport() {
+  int64_t undeleted_files, undeleted_dirs;
+  absl::Status s = Env::Default()->DeleteRecursively(
+      directory_, &undeleted_files, &undeleted_dirs);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete shared memory directory " << directory_
+                 << ": " << s;
+  }
+}
+
+absl::Status SharedMemoryTensorTransport::ExposeTensor(
+    int64_t step_id, const Tensor& tensor,
+    RemoteTensorDescriptor* descriptor) {
+  uint64_t buffer_id;
+  {
+    mutex_lock l(mu_);
+    buffer_id = next_buffer_id_++;
+  }
+  const std::string segment =
+      io::JoinPath(directory_, absl::StrCat(kSegmentPrefix, buffer_id));
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(segment, &file));
+  auto cleanup = gtl::MakeCleanup(
+      [env, &segment] { env->DeleteFile(segment).IgnoreError(); });
+  const absl::string_view data = tensor.tensor_data();
+  TF_RETURN_IF_ERROR(file->Append(data));
+  TF_RETURN_IF_ERROR(file->Close());
+  cleanup.release();
+
+  {
+    mutex_lock l(mu_);
+    step_segments_[step_id].push_back(segment);
+  }
+  descriptor->set_transport(name_);
+  descriptor->set_num_bytes(data.size());
+  descriptor->set_buffer_id(buffer_id);
+  descriptor->set_shared_memory_segment(segment);
+  return absl::OkStatus();
+}
+
+void SharedMemoryTensorTransport::ReadTensorAsync(
+    const std::string& src_worker, const RemoteTensorDescriptor& descriptor,
+    Tensor* tensor, StatusCallback done) {
+  const std::string& segment = descriptor.shared_memory_segment();
+  if (!IsSharedMemorySegment(segment)) {
+    done(errors::DataLoss("Invalid shared memory segment ", segment,
+                          " received from ", src_worker));
+    return;
+  }
+  // The segment is deleted right after it is mapped, whether or not it can be
+  // read, since the sender has no further use for it.
+  Env* env = Env::Default();
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  absl::Status s = env->NewReadOnlyMemoryRegionFromFile(segment, &region);
+  s.Update(env->DeleteFile(segment));
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+  const absl::string_view data = tensor->tensor_data();
+  if (region->length() != data.size()) {
+    done(errors::DataLoss("Shared memory segment ", segment, " has ",
+                          region->length(), " bytes, but expected ",
+                          data.size(), " bytes"));
+    return;
+  }
+  if (!data.empty()) {
+    std::memcpy(const_cast<char*>(data.data()), region->data(), data.size());
+  }
+  done(absl::OkStatus());
+}
+
+void SharedMemoryTensorTransport::ReleaseStep(int64_t step_id) {
+  std::vector<std::string> segments;
+  {
+    mutex_lock l(mu_);
+    auto it = step_segments_.find(step_id);
+    if (it == step_segments_.end()) return;
+    segments = std::move(it->second);
+    step_segments_.erase(it);
+  }
+  // Segments which were read are already deleted by the receiver.
+  Env* env = Env::Default();
+  for (const std::string& segment : segments) {
+    env->DeleteFile(segment).IgnoreError();
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,81 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_TENSOR_TRANSPORT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_TENSOR_TRANSPORT_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "tensorflow/core/distributed_runtime/remote_tensor_transport.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+
+namespace tensorflow {
+
+// A RemoteTensorTransport for workers in different processes on the same
+// host. The sender writes the content of a tensor to a segment file in a
+// tmpfs directory, and the receiver maps the segment, copies the content into
+// its tensor and deletes the file. Tensors are neither serialized nor sent
+// through the gRPC loopback.
+//
+// The directory is TF_RENDEZVOUS_SHARED_MEMORY_DIR, or /dev/shm by default.
+// The name of the transport contains the host name and the directory, so only
+// workers which can open each other's segments use it.
+class SharedMemoryTensorTransport : public RemoteTensorTransport {
+ public:
+  // Creates a transport with its own segment directory.
+  static absl::Status Create(
+      std::unique_ptr<SharedMemoryTensorTransport>* transport);
+
+  // Deletes the segment directory, with the segments which were not read.
+  ~SharedMemoryTensorTransport() override;
+
+  std::string Name() const override { return name_; }
+
+  absl::Status ExposeTensor(int64_t step_id, const Tensor& tensor,
+                            RemoteTensorDescriptor* descriptor) override;
+
+  void ReadTensorAsync(const std::string& src_worker,
+                       const RemoteTensorDescriptor& descriptor,
+                       Tensor* tensor, StatusCallback done) override;
+
+  void ReleaseStep(int64_t step_id) override;
+
+ private:
+  SharedMemoryTensorTransport(std::string name, std::string directory)
+      : name_(std::move(name)), directory_(std::move(directory)) {}
+
+  const std::string name_;
+  const std::string directory_;
+
+  mutex mu_;
+  uint64_t next_buffer_id_ TF_GUARDED_BY(mu_) = 0;
+  // The segments written in each step, which are deleted when the step is
+  // released unless the receiver already deleted them.
+  absl::flat_hash_map<int64_t, std::vector<std::string>> step_segments_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_TENSOR_TRANSPORT_H_
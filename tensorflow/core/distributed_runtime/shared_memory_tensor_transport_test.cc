@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/shared_memory_tensor_transport.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+
+namespace tensorflow {
+namespace {
+
+class SharedMemoryTensorTransportTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    setenv("TF_RENDEZVOUS_SHARED_MEMORY_DIR", testing::TmpDir().c_str(),
+           /*overwrite=*/1);
+    TF_ASSERT_OK(SharedMemoryTensorTransport::Create(&sender_));
+    TF_ASSERT_OK(SharedMemoryTensorTransport::Create(&receiver_));
+  }
+
+  absl::Status Read(const RemoteTensorDescriptor& descriptor, Tensor* tensor) {
+    absl::Status status;
+    receiver_->ReadTensorAsync(
+        "/job:worker/task:0", descriptor, tensor,
+        [&status](const absl::Status& s) { status = s; });
+    return status;
+  }
+
+  std::unique_ptr<SharedMemoryTensorTransport> sender_;
+  std::unique_ptr<SharedMemoryTensorTransport> receiver_;
+};
+
+TEST_F(SharedMemoryTensorTransportTest, NameIsSharedOnTheSameHost) {
+  EXPECT_EQ(sender_->Name(), receiver_->Name());
+}
+
+TEST_F(SharedMemoryTensorTransportTest, ReadExposedTensor) {
+  Tensor tensor = test::AsTensor<float>({1.0f, 2.0f, 3.0f, 4.0f});
+  RemoteTensorDescriptor descriptor;
+  TF_ASSERT_OK(sender_->ExposeTensor(/*step_id=*/1, tensor, &descriptor));
+  EXPECT_EQ(descriptor.transport(), sender_->Name());
+  EXPECT_EQ(descriptor.num_bytes(), tensor.TotalBytes());
+
+  Tensor received(DT_FLOAT, TensorShape({4}));
+  TF_ASSERT_OK(Read(descriptor, &received));
+  test::ExpectTensorEqual<float>(tensor, received);
+  // The receiver deletes the segment once it is read.
+  EXPECT_TRUE(absl::IsNotFound(
+      Env::Default()->FileExists(descriptor.shared_memory_segment())));
+  sender_->ReleaseStep(/*step_id=*/1);
+}
+
+TEST_F(SharedMemoryTensorTransportTest, ReleaseStepDeletesUnreadSegments) {
+  Tensor tensor = test::AsTensor<int32>({1, 2, 3});
+  RemoteTensorDescriptor descriptor;
+  TF_ASSERT_OK(sender_->ExposeTensor(/*step_id=*/2, tensor, &descriptor));
+  TF_EXPECT_OK(Env::Default()->FileExists(descriptor.shared_memory_segment()));
+  sender_->ReleaseStep(/*step_id=*/2);
+  EXPECT_TRUE(absl::IsNotFound(
+      Env::Default()->FileExists(descriptor.shared_memory_segment())));
+}
+
+TEST_F(SharedMemoryTensorTransportTest, SizeMismatch) {
+  Tensor tensor = test::AsTensor<float>({1.0f, 2.0f});
+  RemoteTensorDescriptor descriptor;
+  TF_ASSERT_OK(sender_->ExposeTensor(/*step_id=*/3, tensor, &descriptor));
+  Tensor received(DT_FLOAT, TensorShape({3}));
+  EXPECT_TRUE(absl::IsDataLoss(Read(descriptor, &received)));
+}
+
+TEST_F(SharedMemoryTensorTransportTest, RejectsOtherFiles) {
+  const std::string file = io::JoinPath(testing::TmpDir(), "not_a_segment");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), file, "12345678"));
+  RemoteTensorDescriptor descriptor;
+  descriptor.set_shared_memory_segment(file);
+  Tensor received(DT_FLOAT, TensorShape({2}));
+  EXPECT_TRUE(absl::IsDataLoss(Read(descriptor, &received)));
+  // Files which are not segments are never deleted.
+  TF_EXPECT_OK(Env::Default()->FileExists(file));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <cstddef>
+
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
@@ -143,8 +145,39 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 
 }  // namespace
 
+bool TensorResponse::ShareTensorContent(Source* source,
+                                        protobuf::io::CodedInputStream* input,
+                                        const TensorProto& tensor_meta,
+                                        int num_bytes) {
+  // Memory which the tensor may be DMAed from or to must come from the
+  // allocator.
+  if (num_bytes < kMinSharedContentBytes || alloc_attrs_.gpu_compatible() ||
+      alloc_attrs_.nic_compatible()) {
+    return false;
+  }
+  const void* data;
+  int size;
+  if (!input->GetDirectBufferPointer(&data, &size) || size < num_bytes) {
+    return false;
+  }
+  TensorBuffer* buffer =
+      source->ShareContents(static_cast<const char*>(data), num_bytes);
+  if (buffer == nullptr) return false;
+  Tensor t(tensor_meta.dtype(), TensorShape(tensor_meta.tensor_shape()),
+           buffer);
+  buffer->Unref();
+  if (!t.IsAligned() ||
+      t.TotalBytes() != static_cast<size_t>(num_bytes)) {
+    return false;
+  }
+  if (!input->Skip(num_bytes)) return false;
+  tensor_ = std::move(t);
+  return true;
+}
+
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    Source* source, protobuf::io::CodedInputStream* input,
+    TensorProto* tensor_meta) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -194,13 +227,13 @@ bool TensorResponse::ParseTensorSubmessage(
         int num_bytes;
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
+        if (ShareTensorContent(source, input, *tensor_meta, num_bytes)) {
+          break;
+        }
         TensorShape shape(tensor_meta->tensor_shape());
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -233,7 +266,7 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(source, &input, meta_.mutable_tensor())) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
@@ -63,6 +63,15 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // Returns a buffer which shares the `size` bytes at `data`, yielded by
+    // the stream last returned by contents(), and keeps them alive after the
+    // source is destroyed. Returns nullptr if the bytes cannot be shared, in
+    // which case ParseFrom copies them. The caller owns a reference to the
+    // returned buffer.
+    virtual TensorBuffer* ShareContents(const char* data, size_t size) {
+      return nullptr;
+    }
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -91,8 +100,17 @@ class TensorResponse {
   DeviceBase* device() const { return device_; }
 
  private:
-  bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
+  // Tensor contents of at least this size are shared with the source instead
+  // of copied, when the source and the destination allow it.
+  static constexpr int kMinSharedContentBytes = 64 * 1024;
+
+  bool ParseTensorSubmessage(Source* source,
+                             protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
+  // Returns true and sets `tensor_` if the next `num_bytes` bytes of `input`
+  // can be borrowed from `source` as the content of the tensor.
+  bool ShareTensorContent(Source* source, protobuf::io::CodedInputStream* input,
+                          const TensorProto& tensor_meta, int num_bytes);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
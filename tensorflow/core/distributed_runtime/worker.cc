@@ -15,14 +15,21 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/worker.h"
 
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/collective_executor_mgr.h"
+#include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/distributed_runtime/error_payloads.h"
+#include "tensorflow/core/distributed_runtime/recv_tensors_batch.h"
+#include "tensorflow/core/distributed_runtime/remote_tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
@@ -362,6 +369,21 @@ void Worker::CleanupGraphAsync(const CleanupGraphRequest* request,
                                StatusCallback done) {
   const int64_t step_id = request->step_id();
   env_->rendezvous_mgr->Cleanup(step_id);
+  absl::flat_hash_map<int64_t, std::shared_ptr<RecvTensorsBatch>> batches;
+  {
+    mutex_lock l(recv_tensors_mu_);
+    auto it = recv_tensors_batches_.find(step_id);
+    if (it != recv_tensors_batches_.end()) {
+      batches = std::move(it->second);
+      recv_tensors_batches_.erase(it);
+    }
+  }
+  for (const auto& [batch_id, batch] : batches) {
+    batch->Cancel(errors::Cancelled("Step ", step_id, " was cleaned up."));
+  }
+  if (env_->remote_tensor_transport) {
+    env_->remote_tensor_transport->ReleaseStep(step_id);
+  }
   if (env_->collective_executor_mgr) {
     env_->collective_executor_mgr->Cleanup(step_id);
   }
@@ -502,4 +524,120 @@ void Worker::RecvTensorAsync(CallOptions* opts,
   done(errors::Unimplemented("Worker::RecvTensorAsync()"));
 }
 
+void Worker::RecvTensorsAsync(CallOptions* opts,
+                              const RecvTensorsRequest* request,
+                              RecvTensorsResponse* response,
+                              StatusCallback done) {
+  const int64_t step_id = request->step_id();
+  const int64_t batch_id = request->batch_id();
+  std::shared_ptr<RecvTensorsBatch> batch;
+  if (request->rendezvous_key().empty()) {
+    // A follow-up request for the remaining tensors of a batch.
+    {
+      mutex_lock l(recv_tensors_mu_);
+      auto it = recv_tensors_batches_.find(step_id);
+      if (it != recv_tensors_batches_.end()) {
+        auto batch_it = it->second.find(batch_id);
+        if (batch_it != it->second.end()) {
+          batch = batch_it->second;
+        }
+      }
+    }
+    if (batch == nullptr) {
+      done(errors::FailedPrecondition("RecvTensors batch ", batch_id,
+                                      " of step ", step_id,
+                                      " is unknown or already finished."));
+      return;
+    }
+  } else {
+    const int num_tensors = request->rendezvous_key_size();
+    std::vector<Rendezvous::ParsedKey> parsed(num_tensors);
+    std::vector<Device*> src_devs(num_tensors, nullptr);
+    for (int i = 0; i < num_tensors; ++i) {
+      Status s = Rendezvous::ParseKey(request->rendezvous_key(i), &parsed[i]);
+      if (s.ok()) {
+        s = PrepareRecvTensor(parsed[i], &src_devs[i]);
+      }
+      if (!s.ok()) {
+        done(s);
+        return;
+      }
+    }
+    batch = std::make_shared<RecvTensorsBatch>(num_tensors);
+    bool inserted;
+    {
+      mutex_lock l(recv_tensors_mu_);
+      inserted =
+          recv_tensors_batches_[step_id].emplace(batch_id, batch).second;
+    }
+    if (!inserted) {
+      done(errors::AlreadyExists("RecvTensors batch ", batch_id, " of step ",
+                                 step_id, " already exists."));
+      return;
+    }
+    for (int i = 0; i < num_tensors; ++i) {
+      RecvLocalIntoBatch(step_id, parsed[i], src_devs[i], i, batch);
+    }
+  }
+
+  // As for RecvTensor, a cancellation while waiting for the tensors aborts the
+  // step.
+  opts->SetCancelCallback([this, step_id]() {
+    LOG(WARNING) << "RecvTensors cancelled for " << step_id;
+    AbortStep(step_id);
+  });
+  batch->Poll(response, [this, opts, step_id, batch_id, batch,
+                         done = std::move(done)](const Status& s) {
+    opts->ClearCancelCallback();
+    if (batch->IsFinished()) {
+      RemoveRecvTensorsBatch(step_id, batch_id);
+    }
+    done(s);
+  });
+}
+
+void Worker::RecvLocalIntoBatch(int64_t step_id,
+                                const Rendezvous::ParsedKey& parsed,
+                                Device* src_dev, int index,
+                                std::shared_ptr<RecvTensorsBatch> batch) {
+  env_->rendezvous_mgr->RecvLocalAsync(
+      step_id, parsed,
+      [src_dev, index, batch = std::move(batch),
+       key = std::string(parsed.FullKey())](
+          const Status& status, const Rendezvous::Args& send_args,
+          const Rendezvous::Args& recv_args, const Tensor& val,
+          const bool is_dead) {
+        if (!status.ok() || !src_dev->tensorflow_accelerator_device_info() ||
+            send_args.alloc_attrs.on_host()) {
+          batch->SetTensor(index, status, val, is_dead);
+          return;
+        }
+
+        // Tensors in device memory are copied to the host to be encoded.
+        AllocatorAttributes alloc_attrs;
+        alloc_attrs.set_gpu_compatible(true);
+        alloc_attrs.set_on_host(true);
+        Allocator* alloc = src_dev->GetAllocator(alloc_attrs);
+        Tensor* copy = new Tensor(alloc, val.dtype(), val.shape());
+        CopyDeviceToHost(&val, alloc, alloc, key, src_dev, copy,
+                         send_args.device_context,
+                         [batch, index, copy, is_dead](const Status& s) {
+                           batch->SetTensor(index, s, *copy, is_dead);
+                           delete copy;
+                         });
+      });
+}
+
+void Worker::RemoveRecvTensorsBatch(int64_t step_id, int64_t batch_id) {
+  mutex_lock l(recv_tensors_mu_);
+  auto it = recv_tensors_batches_.find(step_id);
+  if (it == recv_tensors_batches_.end()) {
+    return;
+  }
+  it->second.erase(batch_id);
+  if (it->second.empty()) {
+    recv_tensors_batches_.erase(it);
+  }
+}
+
 }  // namespace tensorflow
@@ -16,11 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_H_
 
+#include <cstdint>
+#include <memory>
 #include <unordered_map>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
 #include "tensorflow/core/distributed_runtime/partial_run_mgr.h"
 #include "tensorflow/core/distributed_runtime/recent_request_ids.h"
+#include "tensorflow/core/distributed_runtime/recv_tensors_batch.h"
 #include "tensorflow/core/distributed_runtime/session_mgr.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -85,6 +89,10 @@ class Worker : public WorkerInterface {
   void RecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
                        TensorResponse* response, StatusCallback done) override;
 
+  void RecvTensorsAsync(CallOptions* opts, const RecvTensorsRequest* request,
+                        RecvTensorsResponse* response,
+                        StatusCallback done) override;
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -122,6 +130,23 @@ class Worker : public WorkerInterface {
 
   CancellationManager cancellation_manager_;
 
+  mutex recv_tensors_mu_;
+  // The RecvTensors batches which have tensors left to return, by step id and
+  // batch id.
+  absl::flat_hash_map<
+      int64_t,
+      absl::flat_hash_map<int64_t, std::shared_ptr<RecvTensorsBatch>>>
+      recv_tensors_batches_ TF_GUARDED_BY(recv_tensors_mu_);
+
+  // Starts receiving the tensor for `parsed` from the local rendezvous, and
+  // stores it at `index` in `batch`.
+  void RecvLocalIntoBatch(int64_t step_id, const Rendezvous::ParsedKey& parsed,
+                          Device* src_dev, int index,
+                          std::shared_ptr<RecvTensorsBatch> batch);
+
+  // Removes the batch `batch_id` of `step_id`.
+  void RemoveRecvTensorsBatch(int64_t step_id, int64_t batch_id);
+
   Status PrepareRunGraph(RunGraphRequestWrapper* req,
                          GraphMgr::NamedTensors* in,
                          GraphMgr::NamedTensors* out);
@@ -36,6 +36,7 @@ using tsl::thread::ThreadPool;
 class CollectiveExecutorMgrInterface;
 class Device;
 class DeviceMgr;
+class RemoteTensorTransport;
 class RendezvousMgrInterface;
 class SessionMgr;
 
@@ -66,6 +67,10 @@ struct WorkerEnv {
   // A set of rendezvous keyed by step ids.
   RendezvousMgrInterface* rendezvous_mgr = nullptr;
 
+  // Optionally moves the content of large tensors received by the rendezvous
+  // outside of the RecvTensor RPC, e.g. with RDMA.
+  RemoteTensorTransport* remote_tensor_transport = nullptr;
+
   // Generates per-step CollectiveExecutors and has access to utilities
   // supporting collective operations.
   std::unique_ptr<CollectiveExecutorMgrInterface> collective_executor_mgr;
@@ -108,6 +108,12 @@ struct CollImplDetails {
   // max_subdivs_per_device = 0 an internal default kMaxSubdivsPerDeviceDefault
   // is used. When max_subdivs_per_device = -1, no subivision is done.
   int max_subdivs_per_device = -1;  // Upper bound on subdivisions per device.
+  // Upper bound on the size of the chunks of dynamically generated
+  // subdivisions.  0 uses an internal default of 4 MiB.
+  int64_t max_chunk_size_bytes = 0;
+  // Name of the CollectiveCodec which encodes the values exchanged with
+  // devices in other tasks, or empty to send them unencoded.
+  string wire_codec;
   std::vector<int> subdiv_offsets;
   std::vector<int> subdiv_source_rank;  // rank of source in each subdiv
   std::vector<int32>
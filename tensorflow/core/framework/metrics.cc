@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/metrics.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <string>
@@ -79,6 +80,32 @@ auto* graph_unused_outputs = tsl::monitoring::Counter<1>::New(
     "/tensorflow/core/graph_unused_outputs",
     "The number of unused outputs for ops of a given type.", "name");
 
+auto* graph_op_execution_time_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/graph_op_execution_time_usecs",
+     "The time spent in sampled kernel executions of ops of a given type, in "
+     "microseconds.",
+     "op_type"},
+    // Power of 2 with bucket count 28 (from 100 nsecs to > 13 secs)
+    {tsl::monitoring::Buckets::Exponential(0.1, 2, 28)});
+
+auto* collective_execution_time_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/collective_execution_time_usecs",
+     "The time spent executing a collective on one device, by collective "
+     "implementation, in microseconds.",
+     "collective"},
+    // Power of 2 with bucket count 28 (from 1 usec to > 2 mins)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 28)});
+
+auto* collective_recv_time_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/collective_recv_time_usecs",
+     "The time from dispatching the receive of a chunk of a ring collective "
+     "until the chunk arrived, by the task of the peer it came from, in "
+     "microseconds. It includes both waiting for the peer to send the chunk "
+     "and the transfer itself.",
+     "peer_task"},
+    // Power of 2 with bucket count 28 (from 1 usec to > 2 mins)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 28)});
+
 auto* tf_data_fetch_op_counter = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/fetch_op",
     "The number of times a tf.data operation that fetches output(s) of a "
@@ -225,6 +252,30 @@ auto* tf_data_service_cross_trainer_cache_size_bytes =
         "/tensorflow/data/service/cross_trainer_cache_size_bytes",
         "tf.data service cross-trainer cache memory usage in bytes.");
 
+auto* tf_data_service_cross_trainer_cache_trainer_queries_counter =
+    tsl::monitoring::Counter<2>::New(
+        "/tensorflow/data/service/cross_trainer_cache_trainer_queries",
+        "tf.data service cross-trainer cache queries by trainer. The result "
+        "can be memory_hit, disk_hit, or miss.",
+        "trainer_id", "result");
+
+auto* tf_data_service_cross_trainer_cache_evicted_elements_counter =
+    tsl::monitoring::Counter<1>::New(
+        "/tensorflow/data/service/cross_trainer_cache_evicted_elements",
+        "Number of elements trainers skipped because they were evicted from "
+        "the tf.data service cross-trainer cache before being read.",
+        "trainer_id");
+
+auto* tf_data_service_cross_trainer_cache_memory_limit_bytes =
+    tsl::monitoring::Gauge<int64_t, 0>::New(
+        "/tensorflow/data/service/cross_trainer_cache_memory_limit_bytes",
+        "tf.data service cross-trainer cache memory budget in bytes.");
+
+auto* tf_data_service_cross_trainer_cache_disk_size_bytes =
+    tsl::monitoring::Gauge<int64_t, 0>::New(
+        "/tensorflow/data/service/cross_trainer_cache_disk_size_bytes",
+        "tf.data service cross-trainer cache disk usage in bytes.");
+
 auto* tf_data_service_snapshot_bytes_committed =
     tsl::monitoring::Counter<0>::New(
         "/tensorflow/data/service/snapshot_bytes_committed",
@@ -269,6 +320,12 @@ auto* tf_data_service_optimal_number_of_workers =
         "Estimated optimal number of tf.data service workers based on the "
         "current workload.");
 
+auto* tf_data_service_dispatcher_recovery_time_usecs =
+    monitoring::Gauge<int64_t, 0>::New(
+        "/tensorflow/data/service/dispatcher_recovery_time_usecs",
+        "Time, in microseconds, the tf.data service dispatcher took to "
+        "restore its state from the journal when it last started.");
+
 auto* tf_data_filename_counter = tsl::monitoring::Counter<2>::New(
     "/tensorflow/data/filename", "The file name read by a tf.data Dataset.",
     "name", "filename");
@@ -305,6 +362,30 @@ auto* tf_data_pipeline_processing_time = tsl::monitoring::Gauge<double, 1>::New(
     "in microseconds",
     "id");
 
+auto* tf_data_pipeline_cpu_share = tsl::monitoring::Gauge<double, 1>::New(
+    "/tensorflow/data/pipeline_cpu_share",
+    "The fraction of the shared tf.data worker pool's capacity used by the "
+    "input pipelines with the same name",
+    "name");
+
+auto* tf_data_input_bottleneck_stage = tsl::monitoring::Gauge<string, 1>::New(
+    "/tensorflow/data/input_bottleneck_stage",
+    "The root of the slowest stage in the input pipeline", "id");
+
+auto* tf_data_input_bottleneck_utilization =
+    tsl::monitoring::Gauge<double, 1>::New(
+        "/tensorflow/data/input_bottleneck_utilization",
+        "The ratio of the per-element time of the slowest stage in the input "
+        "pipeline to the time the consumer spends between GetNext calls",
+        "id");
+
+auto* tf_data_input_bottleneck_parallelism_to_keep_up =
+    tsl::monitoring::Gauge<double, 1>::New(
+        "/tensorflow/data/input_bottleneck_parallelism_to_keep_up",
+        "The estimated parallelism at which the slowest stage in the input "
+        "pipeline keeps up with the consumer",
+        "id");
+
 auto* tf_data_auto_shard = tsl::monitoring::Gauge<int64, 2>::New(
     "/tensorflow/data/autoshard", "tf.data autoshard statistics.", "id",
     "name");
@@ -372,6 +453,12 @@ auto* build_graph_time_usecs = tsl::monitoring::Counter<0>::New(
     "spent optimizing the graph with Grappler, and time spent pruning the "
     "sub-graph.");
 
+auto* graph_import_time_usecs = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/graph_import_time_usecs",
+    "The amount of time TensorFlow has spent converting GraphDefs to Graphs, "
+    "in microseconds, by phase of the conversion.",
+    "phase");
+
 auto* function_graph_optimization_time_usecs = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/function_graph_optimization_time_usecs",
     "The amount of time TensorFlow has spent optimizing function graphs, in "
@@ -409,6 +496,13 @@ auto* graph_optimization_cache_load_count = tsl::monitoring::Counter<1>::New(
     "source"  // graph optimization source
 );
 
+auto* graph_optimization_pass_timeout_count = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/graph_optimization_pass_timeout_count",
+    "The number of runs of each graph optimization pass which were stopped "
+    "by their time budget.",
+    "name"  // graph optimization pass
+);
+
 auto* xla_compilations = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilations",
     "The number of XLA compilations used to collect "
@@ -418,6 +512,27 @@ auto* xla_compilation_time_usecs = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilation_time_usecs",
     "The total time spent on compiling XLA graphs in microseconds.");
 
+auto* tf_trt_engine_build_fallbacks = tsl::monitoring::Counter<0>::New(
+    "/tensorflow/core/tf_trt_engine_build_fallbacks",
+    "The number of TF-TRT op executions which ran the native segment while "
+    "a TensorRT engine was built in the background.");
+
+auto* tf_trt_engine_build_fallback_time_usecs =
+    tsl::monitoring::Counter<0>::New(
+        "/tensorflow/core/tf_trt_engine_build_fallback_time_usecs",
+        "The total time TF-TRT ops spent running the native segment while a "
+        "TensorRT engine was built in the background, in microseconds.");
+
+auto* xla_compilation_cache_size_bytes =
+    tsl::monitoring::Gauge<int64_t, 0>::New(
+        "/tensorflow/core/xla_compilation_cache_size_bytes",
+        "The size of the executables and computations held by the XLA "
+        "compilation caches, in bytes.");
+
+auto* xla_compilation_cache_evictions = tsl::monitoring::Counter<0>::New(
+    "/tensorflow/core/xla_compilation_cache_evictions",
+    "The number of executables evicted from the XLA compilation caches.");
+
 auto* xla_tpu_spmd_cores_per_replica = tsl::monitoring::Counter<1>::New(
     "/tensorflow/tpu/xla_spmd_cores_per_replica",
     "The number of cores used by XLA SPMD-replicated models.", "cores");
@@ -481,6 +596,8 @@ std::string GraphOptimizationSourceMapping(GraphOptimizationSource source) {
       return "jit";
     case GraphOptimizationSource::kAot:
       return "aot";
+    case GraphOptimizationSource::kGrappler:
+      return "grappler";
     case GraphOptimizationSource::kUnknown:
       return "unknown";
     default:
@@ -675,6 +792,30 @@ void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes) {
       static_cast<int64_t>(bytes));
 }
 
+void RecordTFDataServiceCrossTrainerCacheTrainerQuery(
+    const std::string& trainer_id, const std::string& result) {
+  tf_data_service_cross_trainer_cache_trainer_queries_counter
+      ->GetCell(trainer_id, result)
+      ->IncrementBy(1);
+}
+
+void RecordTFDataServiceCrossTrainerCacheEvictedElements(
+    const std::string& trainer_id, int64_t num_elements) {
+  tf_data_service_cross_trainer_cache_evicted_elements_counter
+      ->GetCell(trainer_id)
+      ->IncrementBy(num_elements);
+}
+
+void RecordTFDataServiceCrossTrainerCacheMemoryLimitBytes(size_t bytes) {
+  tf_data_service_cross_trainer_cache_memory_limit_bytes->GetCell()->Set(
+      static_cast<int64_t>(bytes));
+}
+
+void RecordTFDataServiceCrossTrainerCacheDiskSizeBytes(size_t bytes) {
+  tf_data_service_cross_trainer_cache_disk_size_bytes->GetCell()->Set(
+      static_cast<int64_t>(bytes));
+}
+
 void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes) {
   tf_data_service_snapshot_bytes_committed->GetCell()->IncrementBy(bytes);
 }
@@ -688,6 +829,10 @@ void RecordTFDataServiceOptimalNumberOfWorkers(int64_t number_of_workers) {
   tf_data_service_optimal_number_of_workers->GetCell()->Set(number_of_workers);
 }
 
+void RecordTFDataServiceDispatcherRecoveryTime(uint64 duration_us) {
+  tf_data_service_dispatcher_recovery_time_usecs->GetCell()->Set(duration_us);
+}
+
 void RecordTFDataFilename(const string& name, const string& filename) {
   tf_data_filename_counter->GetCell(name, filename)->IncrementBy(1);
 }
@@ -825,6 +970,13 @@ void UpdateGraphBuildTime(const uint64 running_time_usecs) {
   }
 }
 
+void UpdateGraphImportTime(const string& phase,
+                           const uint64 running_time_usecs) {
+  if (running_time_usecs > 0) {
+    graph_import_time_usecs->GetCell(phase)->IncrementBy(running_time_usecs);
+  }
+}
+
 void UpdateFunctionGraphOptimizationTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     static auto* function_graph_optimization_time_usecs_cell =
@@ -904,6 +1056,14 @@ int64_t GetFunctionGraphOptimizationCacheLoadCount(
   return graph_optimization_cache_load_count->GetCell(mapped_source)->value();
 }
 
+void IncrementGraphOptimizationPassTimeoutCount(const string& name) {
+  graph_optimization_pass_timeout_count->GetCell(name)->IncrementBy(1);
+}
+
+int64_t GetGraphOptimizationPassTimeoutCount(const string& name) {
+  return graph_optimization_pass_timeout_count->GetCell(name)->value();
+}
+
 void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs) {
   if (distribution_time_usecs > 0) {
     tpu_variable_distribution_time_usecs->GetCell()->IncrementBy(
@@ -921,15 +1081,63 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void UpdateTfTrtEngineBuildFallbackTime(const uint64 fallback_time_usecs) {
+  static auto* fallbacks_cell = tf_trt_engine_build_fallbacks->GetCell();
+  static auto* fallback_time_usecs_cell =
+      tf_trt_engine_build_fallback_time_usecs->GetCell();
+  fallbacks_cell->IncrementBy(1);
+  fallback_time_usecs_cell->IncrementBy(fallback_time_usecs);
+}
+
+void UpdateXlaCompilationCacheSize(int64_t delta_bytes) {
+  static std::atomic<int64_t>* size_bytes = new std::atomic<int64_t>(0);
+  const int64_t new_size_bytes =
+      size_bytes->fetch_add(delta_bytes) + delta_bytes;
+  xla_compilation_cache_size_bytes->GetCell()->Set(new_size_bytes);
+}
+
+void UpdateXlaCompilationCacheEvictionCount(int64_t evictions) {
+  if (evictions > 0) {
+    xla_compilation_cache_evictions->GetCell()->IncrementBy(evictions);
+  }
+}
+
 void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
 
+void RecordOpExecutionTime(const string& op_type, double duration_usecs) {
+  graph_op_execution_time_usecs->GetCell(op_type)->Add(duration_usecs);
+}
+
+void RecordCollectiveExecutionTime(const string& collective_name,
+                                   double duration_usecs) {
+  collective_execution_time_usecs->GetCell(collective_name)
+      ->Add(duration_usecs);
+}
+
+void RecordCollectiveRecvTime(const string& peer_task, double duration_usecs) {
+  collective_recv_time_usecs->GetCell(peer_task)->Add(duration_usecs);
+}
+
 void RecordPipelineProcessingTime(const string& id,
                                   double pipeline_processing_time_usec) {
   GetTFDataPipelineProcessingTimeGauge(id)->Set(pipeline_processing_time_usec);
 }
 
+void RecordTFDataPipelineCpuShare(const string& name, double cpu_share) {
+  tf_data_pipeline_cpu_share->GetCell(name)->Set(cpu_share);
+}
+
+void RecordTFDataInputBottleneck(const string& id, const string& stage_root,
+                                 double utilization,
+                                 double parallelism_to_keep_up) {
+  tf_data_input_bottleneck_stage->GetCell(id)->Set(stage_root);
+  tf_data_input_bottleneck_utilization->GetCell(id)->Set(utilization);
+  tf_data_input_bottleneck_parallelism_to_keep_up->GetCell(id)->Set(
+      parallelism_to_keep_up);
+}
+
 void IncrementTestCounter(const string& name, const string& label) {
   test_counters->GetCell(name, label)->IncrementBy(1);
 }
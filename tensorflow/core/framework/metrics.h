@@ -34,6 +34,8 @@ enum class GraphOptimizationSource {
   kUnknown,
   kJit,
   kAot,
+  // Graphs optimized by Grappler's RunMetaOptimizer.
+  kGrappler,
 };
 
 // Records when a data-fetching tf.data operation is executed.
@@ -182,6 +184,22 @@ void RecordTFDataServiceCrossTrainerCacheQuery(bool cache_hit);
 // Records tf.data service cross-trainer cache memory usage in bytes.
 void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes);
 
+// Records a tf.data service cross-trainer cache query by `trainer_id`. `result`
+// is "memory_hit", "disk_hit", or "miss".
+void RecordTFDataServiceCrossTrainerCacheTrainerQuery(
+    const std::string& trainer_id, const std::string& result);
+
+// Records that `trainer_id` skipped `num_elements` elements because they were
+// evicted from the tf.data service cross-trainer cache before it read them.
+void RecordTFDataServiceCrossTrainerCacheEvictedElements(
+    const std::string& trainer_id, int64_t num_elements);
+
+// Records the memory budget of the tf.data service cross-trainer cache.
+void RecordTFDataServiceCrossTrainerCacheMemoryLimitBytes(size_t bytes);
+
+// Records tf.data service cross-trainer cache disk usage in bytes.
+void RecordTFDataServiceCrossTrainerCacheDiskSizeBytes(size_t bytes);
+
 // Records tf.data distributed snapshot bytes committed.
 void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes);
 
@@ -192,6 +210,10 @@ void RecordTFDataServiceSnapshotOp(const std::string& path,
 // Records the current estimated optimal number of tf.data service workers.
 void RecordTFDataServiceOptimalNumberOfWorkers(int64_t number_of_workers);
 
+// Records how long the tf.data service dispatcher took to restore its state
+// from the journal when it started.
+void RecordTFDataServiceDispatcherRecoveryTime(uint64 duration_us);
+
 // Records the file name read by a tf.data Dataset.
 //
 // The `name` argument identifies the Dataset type (e.g. "TFRecordDataset").
@@ -272,10 +294,38 @@ void UpdateGraphPendingQueueLength(uint64 len);
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
+// Records the execution time of one sampled kernel invocation of an op of type
+// `op_type`, in microseconds.
+void RecordOpExecutionTime(const string& op_type, double duration_usecs);
+
+// Records the time from the start of a collective implementation
+// `collective_name`, e.g. "RingReduce" or "NcclReduce", until it completed on
+// one device, in microseconds.
+void RecordCollectiveExecutionTime(const string& collective_name,
+                                   double duration_usecs);
+
+// Records the time a ring collective took to receive a chunk from a peer in
+// task `peer_task`, from dispatching the receive until the chunk arrived, in
+// microseconds. This includes waiting for the peer as well as the transfer, so
+// a slow peer and a slow link to it both show up here.
+void RecordCollectiveRecvTime(const string& peer_task, double duration_usecs);
+
 // Records the pipeline processing time in microseconds
 void RecordPipelineProcessingTime(const string& id,
                                   double pipeline_processing_time_usec);
 
+// Records the fraction of the shared tf.data worker pool's capacity used by the
+// input pipelines with the given `name`, such as the type of their dataset.
+void RecordTFDataPipelineCpuShare(const string& name, double cpu_share);
+
+// Records the slowest stage of the input pipeline with the given `id`, the
+// ratio of its per-element time to the consumer's time between `GetNext()`
+// calls, and the parallelism at which it is estimated to keep up with the
+// consumer.
+void RecordTFDataInputBottleneck(const string& id, const string& stage_root,
+                                 double utilization,
+                                 double parallelism_to_keep_up);
+
 // Increments the count of binaries loaded from the persistent cache.
 void UpdatePersistentCacheLoadCount();
 
@@ -300,6 +350,12 @@ void UpdateGraphBuildTime(const uint64 running_time_usecs);
 // Updates the metric stored for time spent optimizing function graphs.
 void UpdateFunctionGraphOptimizationTime(const uint64 running_time_usecs);
 
+// Records the time spent in a `phase` of converting a GraphDef to a Graph,
+// e.g. "index", "prepare_node_defs", "convert", "shape_inference" or
+// "finalize".
+void UpdateGraphImportTime(const string& phase,
+                           const uint64 running_time_usecs);
+
 // Updates the metric stored for time saved by caching graph optimization.
 void UpdateFunctionGraphOptimizationSavingTime(uint64 saving_time_usec,
                                                GraphOptimizationSource source);
@@ -339,6 +395,14 @@ void IncrementFunctionGraphOptimizationCacheLoadCount(
 int64_t GetFunctionGraphOptimizationCacheLoadCount(
     GraphOptimizationSource source);
 
+// Increments the number of runs of the graph optimization pass `name` which
+// were stopped by their time budget.
+void IncrementGraphOptimizationPassTimeoutCount(const string& name);
+
+// Gets the number of runs of the graph optimization pass `name` which were
+// stopped by their time budget.
+int64_t GetGraphOptimizationPassTimeoutCount(const string& name);
+
 // Records the activity of the first phase of the mlir bridge using the
 // tf_metadata.tf_mlir_bridge_first_phase_v2_count metric.
 // bridge_type: replicated, nonreplicated, etc.
@@ -522,6 +586,18 @@ void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs);
 // Updates the metrics stored about time XLA spents compiling graphs.
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 
+// Adds `delta_bytes` to the size of the executables and computations held by
+// the XLA compilation caches of the process.
+void UpdateXlaCompilationCacheSize(int64_t delta_bytes);
+
+// Increments the count of executables evicted from XLA compilation caches.
+void UpdateXlaCompilationCacheEvictionCount(int64_t evictions);
+
+// Updates the metrics stored about time TF-TRT ops spent running their native
+// segment while a TensorRT engine for their input shapes was built in the
+// background.
+void UpdateTfTrtEngineBuildFallbackTime(const uint64 fallback_time_usecs);
+
 // Increments (by 1) a simple integer counter that is exposed for testing.
 void IncrementTestCounter(const string& name, const string& label);
 
@@ -19,11 +19,13 @@ limitations under the License.
 
 #include <gtest/gtest.h>
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/lib/monitoring/test_utils.h"
 
 namespace {
 using ::tensorflow::metrics::IncrementPhase2XlaCompilerCounter;
 using ::tensorflow::metrics::Phase2XlaCompilerMetric;
 using ::tensorflow::monitoring::testing::CellReader;
+using ::tensorflow::monitoring::testing::Histogram;
 
 constexpr char kPhase2CompilationStatusStreamzName[] =
     "/tensorflow/core/tf2xla/api/v2/phase2_compilation_status";
@@ -42,6 +44,12 @@ constexpr char kCompileFunctionXlaBuilderFailure[] =
     "kCompileFunctionXlaBuilderFailure";
 constexpr char kCompileFunctionMlirSuccess[] = "kCompileFunctionMlirSuccess";
 constexpr char kCompileFunctionMlirFailure[] = "kCompileFunctionMlirFailure";
+constexpr char kOpExecutionTimeStreamzName[] =
+    "/tensorflow/core/graph_op_execution_time_usecs";
+constexpr char kCollectiveExecutionTimeStreamzName[] =
+    "/tensorflow/core/collective_execution_time_usecs";
+constexpr char kCollectiveRecvTimeStreamzName[] =
+    "/tensorflow/core/collective_recv_time_usecs";
 
 TEST(Metrics, Phase2XlaCompilerMetric) {
   CellReader<int64_t> counter(kPhase2XlaCompilerStreamzName);
@@ -93,4 +101,44 @@ TEST(Metrics, Phase2ComilationStatusUntouchedCounterNotIncremented) {
   ASSERT_EQ(counter.Read(kMlirWithFallbackModeSuccess), 0);
 }
 
+TEST(Metrics, OpExecutionTimeRecordedPerOpType) {
+  CellReader<Histogram> sampler(kOpExecutionTimeStreamzName);
+
+  tensorflow::metrics::RecordOpExecutionTime("MatMul", 12.5);
+  tensorflow::metrics::RecordOpExecutionTime("MatMul", 0.25);
+  tensorflow::metrics::RecordOpExecutionTime("Add", 1.0);
+
+  Histogram matmul = sampler.Delta("MatMul");
+  EXPECT_FLOAT_EQ(matmul.num(), 2.0);
+  EXPECT_FLOAT_EQ(matmul.sum(), 12.75);
+  EXPECT_FLOAT_EQ(sampler.Delta("Add").num(), 1.0);
+}
+
+TEST(Metrics, CollectiveExecutionTimeRecordedPerCollective) {
+  CellReader<Histogram> sampler(kCollectiveExecutionTimeStreamzName);
+
+  tensorflow::metrics::RecordCollectiveExecutionTime("RingReduce", 300);
+  tensorflow::metrics::RecordCollectiveExecutionTime("RingReduce", 100);
+  tensorflow::metrics::RecordCollectiveExecutionTime("NcclReduce", 50);
+
+  Histogram ring = sampler.Delta("RingReduce");
+  EXPECT_FLOAT_EQ(ring.num(), 2.0);
+  EXPECT_FLOAT_EQ(ring.sum(), 400.0);
+  EXPECT_FLOAT_EQ(sampler.Delta("NcclReduce").num(), 1.0);
+  EXPECT_FLOAT_EQ(sampler.Delta("RingGather").num(), 0.0);
+}
+
+TEST(Metrics, CollectiveRecvTimeRecordedPerPeerTask) {
+  CellReader<Histogram> sampler(kCollectiveRecvTimeStreamzName);
+
+  tensorflow::metrics::RecordCollectiveRecvTime("/job:worker/task:0", 20);
+  tensorflow::metrics::RecordCollectiveRecvTime("/job:worker/task:1", 5000);
+  tensorflow::metrics::RecordCollectiveRecvTime("/job:worker/task:1", 7000);
+
+  EXPECT_FLOAT_EQ(sampler.Delta("/job:worker/task:0").sum(), 20.0);
+  Histogram slow_peer = sampler.Delta("/job:worker/task:1");
+  EXPECT_FLOAT_EQ(slow_peer.num(), 2.0);
+  EXPECT_FLOAT_EQ(slow_peer.sum(), 12000.0);
+}
+
 }  // namespace
@@ -2297,6 +2297,9 @@ Model::~Model() {
   safe_to_collect_metrics_->val = false;
   // Reset the pipeline processing time to 0
   metrics::RecordPipelineProcessingTime(model_id_, 0);
+  metrics::RecordTFDataInputBottleneck(model_id_, /*stage_root=*/"",
+                                       /*utilization=*/0,
+                                       /*parallelism_to_keep_up=*/0);
 }
 
 void Model::AddNode(Node::Factory factory, const string& name,
@@ -2403,6 +2406,10 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
       OptimizeStageBased(snapshot, optimization_params, cancellation_manager,
                          ram_budget_manager);
       break;
+    case AutotuneAlgorithm::COST_BASED:
+      OptimizeCostBased(snapshot, optimization_params, cancellation_manager,
+                        ram_budget_manager);
+      break;
     default:
       VLOG(2) << "Autotuning algorithm was not recognized. Aborting "
                  "optimization.";
@@ -2450,6 +2457,13 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
       }
     }
   }
+  absl::StatusOr<InputBottleneck> bottleneck = AnalyzeInputBottleneck();
+  if (bottleneck.ok()) {
+    VLOG(1) << "Input pipeline bottleneck: " << bottleneck->DebugString();
+    metrics::RecordTFDataInputBottleneck(model_id_, bottleneck->stage_root,
+                                         bottleneck->utilization,
+                                         bottleneck->parallelism_to_keep_up);
+  }
   VLOG(2) << ram_budget_manager.DebugString();
 }
 
@@ -2574,10 +2588,13 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm,
     int64_t start_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     double model_input_time = 0.0;
     // Model input time is set to 0 for all optimization algorithms except for
-    // stage-based optimization algorithm for historical reason. In stage-based
-    // optimization algorithm, the model input time is used as a target
-    // optimization time of all stages in the pipeline.
-    if (algorithm == AutotuneAlgorithm::STAGE_BASED) {
+    // stage-based and cost-based optimization algorithms for historical
+    // reason. In stage-based optimization algorithm, the model input time is
+    // used as a target optimization time of all stages in the pipeline. In
+    // cost-based optimization algorithm, it is used as the consumer time when
+    // estimating the queueing delay of buffers, and as the target output time.
+    if (algorithm == AutotuneAlgorithm::STAGE_BASED ||
+        algorithm == AutotuneAlgorithm::COST_BASED) {
       model_input_time = ComputeTargetTimeNsec();
     }
     Optimize(algorithm, cpu_budget_func, ram_budget_share, fixed_ram_budget,
@@ -2822,6 +2839,49 @@ double Model::ComputeSnapshotProcessingTimeNsec() const {
   return critical_root_status->first;
 }
 
+std::string Model::InputBottleneck::DebugString() const {
+  return strings::StrCat(
+      "stage_root: ", stage_root, ", stage_time_nsec: ", stage_time_nsec,
+      ", target_time_nsec: ", target_time_nsec, ", utilization: ", utilization,
+      ", parallelism: ", parallelism, "/", max_parallelism,
+      ", parallelism_to_keep_up: ", parallelism_to_keep_up);
+}
+
+absl::StatusOr<Model::InputBottleneck> Model::AnalyzeInputBottleneck() {
+  std::unique_ptr<ModelTiming> model_timing = nullptr;
+  {
+    tf_shared_lock l(mu_);
+    if (snapshot_ == nullptr) {
+      return errors::Unavailable(
+          "The model has not been optimized yet, so there is no snapshot to "
+          "analyze.");
+    }
+    model_timing = std::make_unique<ModelTiming>(snapshot_);
+  }
+
+  ModelTimingPriorityQueue priority_queue(*model_timing);
+  TF_ASSIGN_OR_RETURN(auto critical_root, priority_queue.PopSlowestStageRoot());
+  InputBottleneck bottleneck;
+  bottleneck.stage_root = RemoveArrayIndices(critical_root.second->long_name());
+  bottleneck.stage_time_nsec = critical_root.first;
+  bottleneck.target_time_nsec = ComputeTargetTimeNsec();
+  if (bottleneck.target_time_nsec > 0) {
+    bottleneck.utilization =
+        bottleneck.stage_time_nsec / bottleneck.target_time_nsec;
+  }
+  NodeParallelismParameters node_parallelism;
+  Parameter* parallelism = node_parallelism.Get(critical_root.second);
+  if (parallelism != nullptr) {
+    bottleneck.parallelism = parallelism->value;
+    bottleneck.max_parallelism = parallelism->max;
+    if (bottleneck.utilization > 0) {
+      bottleneck.parallelism_to_keep_up =
+          std::ceil(parallelism->value * bottleneck.utilization);
+    }
+  }
+  return bottleneck;
+}
+
 void Model::OptimizeStageBased(std::shared_ptr<Node> snapshot,
                                const OptimizationParams& optimization_params,
                                CancellationManager* cancellation_manager,
@@ -3020,6 +3080,104 @@ void Model::OptimizeStageBasedNonAsyncInterleaveManyNodes(
   }
 }
 
+void Model::OptimizeCostBased(std::shared_ptr<Node> snapshot,
+                              const OptimizationParams& optimization_params,
+                              CancellationManager* cancellation_manager,
+                              RamBudgetManager& ram_budget_manager) {
+  VLOG(2) << "Starting optimization of tunable parameters with Cost-Based "
+             "optimization with a model input time of "
+          << optimization_params.model_input_time() << " nsec.";
+  const double processing_time = TotalProcessingTime(snapshot);
+  auto parameters = CollectTunableParameters(snapshot);
+  if (parameters.empty()) {
+    VLOG(2) << "There are no tunable parameters.";
+    return;
+  }
+  VLOG(2) << "Number of tunable parameters: " << parameters.size();
+
+  // A step is only taken if it decreases the output time by more than this
+  // constant.
+  constexpr double kMinDelta = 1.0L;
+  // Lower bound on the resource used by a step, so that steps which use no
+  // measurable resource are still compared by their output time decrease.
+  constexpr double kMinStepCost = 1.0e-6;
+
+  // Skip buffer size optimization if we are running the new buffering
+  // algorithm.
+  const bool skip_buffer_sizes =
+      experiments_.contains("autotune_buffer_optimization");
+  // Initialize the parameter values to minimal before tuning.
+  for (auto& pair : parameters) {
+    if (skip_buffer_sizes && (pair.second->name == kBufferSize)) {
+      continue;
+    }
+    pair.second->value = pair.second->min;
+  }
+  const double cpu_budget =
+      std::max<double>(optimization_params.cpu_budget(), 1.0);
+  const double ram_budget = optimization_params.ram_budget();
+  const double model_input_time = optimization_params.model_input_time();
+  double output_time =
+      OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+  double buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+  while (!cancellation_manager->IsCancelled()) {
+    if (output_time < processing_time / cpu_budget) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("output_time");
+      break;
+    }
+    if (model_input_time > 0 && output_time <= model_input_time) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("model_input_time");
+      break;
+    }
+    double best_score = 0.0;
+    double best_output_time = output_time;
+    double best_buffered_bytes = buffered_bytes;
+    Parameter* best_parameter = nullptr;
+    for (auto& pair : parameters) {
+      if (pair.second->value >= pair.second->max ||
+          (skip_buffer_sizes && (pair.second->name == kBufferSize))) {
+        continue;
+      }
+      pair.second->value++;
+      const double new_output_time =
+          OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+      const double new_buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+      pair.second->value--;
+      const double delta = output_time - new_output_time;
+      if (delta <= kMinDelta || new_buffered_bytes > ram_budget) {
+        continue;
+      }
+      double cost = 0.0;
+      if (pair.second->name == kParallelism) {
+        cost += 1.0 / cpu_budget;
+      }
+      if (ram_budget > 0) {
+        cost += std::max(new_buffered_bytes - buffered_bytes, 0.0) / ram_budget;
+      }
+      const double score = delta / std::max(cost, kMinStepCost);
+      if (score > best_score) {
+        best_score = score;
+        best_output_time = new_output_time;
+        best_buffered_bytes = new_buffered_bytes;
+        best_parameter = pair.second.get();
+      }
+    }
+    if (!best_parameter) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("local_maximum_reached");
+      VLOG(2) << "Failed to find a tunable parameter that would further "
+                 "decrease the output time within the RAM budget. The "
+                 "optimization attempt will stop now.";
+      break;
+    }
+    best_parameter->value++;
+    output_time = best_output_time;
+    buffered_bytes = best_buffered_bytes;
+  }
+  if (ram_budget_manager.RequestModelAllocation(buffered_bytes)) {
+    UpdateStateValues(&parameters);
+  }
+}
+
 void Model::OptimizeBuffers(std::shared_ptr<Node> snapshot,
                             int64_t ram_budget) {
   VLOG(2) << "Starting optimization of buffer_size parameters.";
@@ -181,7 +181,7 @@ class RamBudgetManager {
   // Returns whether the request succeeded.
   bool RequestModelAllocation(int64_t total_bytes) {
     mutex_lock l(mu_);
-    if (total_bytes > budget_ - legacy_prefetch_allocated_) {
+    if (total_bytes > budget_ - legacy_prefetch_allocated_ - fixed_allocated_) {
       return false;
     }
     model_allocated_ = total_bytes;
@@ -200,9 +200,10 @@ class RamBudgetManager {
     // If `delta_elements` is positive, allocate only up to the available
     // memory.
     if (delta_elements > 0) {
-      int64_t max_delta_elements = static_cast<int64_t>(
-          (budget_ - legacy_prefetch_allocated_ - model_allocated_) /
-          element_size);
+      int64_t max_delta_elements =
+          static_cast<int64_t>((budget_ - legacy_prefetch_allocated_ -
+                                fixed_allocated_ - model_allocated_) /
+                               element_size);
       if (max_delta_elements < 0) {
         return 0;
       }
@@ -224,17 +225,26 @@ class RamBudgetManager {
   // request. If not, no bytes are allocated.
   bool RequestLegacyPrefetchBytes(int64_t delta_bytes) {
     mutex_lock l(mu_);
-    if (delta_bytes > budget_ - legacy_prefetch_allocated_ - model_allocated_) {
+    if (delta_bytes > budget_ - legacy_prefetch_allocated_ - fixed_allocated_ -
+                          model_allocated_) {
       return false;
     }
     legacy_prefetch_allocated_ += delta_bytes;
     return true;
   }
 
+  // Records `delta_bytes` of memory held by buffers whose size is not tuned,
+  // such as shuffle buffers. The memory is always granted, and reduces the
+  // memory available to the model. `delta_bytes` can be negative.
+  void UpdateFixedBytes(int64_t delta_bytes) {
+    mutex_lock l(mu_);
+    fixed_allocated_ += delta_bytes;
+  }
+
   // The total number of bytes that the model could potentially use.
   int64_t AvailableModelRam() const {
     tf_shared_lock l(mu_);
-    return budget_ - legacy_prefetch_allocated_;
+    return budget_ - legacy_prefetch_allocated_ - fixed_allocated_;
   }
 
   void UpdateBudget(int64_t budget) {
@@ -247,6 +257,7 @@ class RamBudgetManager {
     mutex_lock l(mu_);
     return absl::StrCat("RamBudgetManager: budget_: ", budget_,
                         " prefetch allocated: ", legacy_prefetch_allocated_,
+                        " fixed allocated: ", fixed_allocated_,
                         " model allocated: ", model_allocated_);
   }
 
@@ -255,6 +266,8 @@ class RamBudgetManager {
   int64_t budget_ TF_GUARDED_BY(mu_) = 0;
   // Number of bytes allocated by legacy prefetch autotuner.
   int64_t legacy_prefetch_allocated_ TF_GUARDED_BY(mu_) = 0;
+  // Number of bytes held by buffers that are not tuned.
+  int64_t fixed_allocated_ TF_GUARDED_BY(mu_) = 0;
   // Number of bytes allocated by the model.
   int64_t model_allocated_ TF_GUARDED_BY(mu_) = 0;
 };
@@ -1041,6 +1054,37 @@ class Model {
   // having executed an optimization round before.
   double ComputeSnapshotProcessingTimeNsec() const;
 
+  // Describes the slowest stage of the pipeline, i.e. the stage that bounds how
+  // fast the pipeline can produce elements.
+  struct InputBottleneck {
+    // Name of the root node of the slowest stage.
+    std::string stage_root;
+    // Time in nanoseconds the stage takes to produce the elements needed for
+    // one element of the pipeline output.
+    double stage_time_nsec = 0.0;
+    // Time in nanoseconds the consumer spends between `GetNext()` calls. 0 if
+    // there are not sufficient recorded iterator gap times.
+    double target_time_nsec = 0.0;
+    // Ratio of `stage_time_nsec` to `target_time_nsec`. Values above 1 mean the
+    // consumer waits on this stage. 0 if `target_time_nsec` is unknown.
+    double utilization = 0.0;
+    // Current and maximum `parallelism` of the stage root. 0 if the stage root
+    // has no tunable `parallelism`.
+    double parallelism = 0.0;
+    double max_parallelism = 0.0;
+    // Estimated `parallelism` at which the stage would keep up with the
+    // consumer, assuming the stage time scales inversely with parallelism. 0 if
+    // it cannot be estimated.
+    double parallelism_to_keep_up = 0.0;
+
+    std::string DebugString() const;
+  };
+
+  // Returns the slowest stage of the pipeline according to the latest model
+  // snapshot obtained from optimization. Returns an error if there is no
+  // snapshot yet or it has no stages.
+  absl::StatusOr<InputBottleneck> AnalyzeInputBottleneck();
+
  private:
   // Determines whether optimization should stop given total processing time,
   // estimated output time, and estimated number of buffers bytes.
@@ -1150,6 +1194,23 @@ class Model {
       CancellationManager* cancellation_manager,
       RamBudgetManager& ram_budget_manager);
 
+  // This optimization tunes the parallelism and buffer size parameters
+  // together, treating them as consumers of the CPU and RAM budgets. It starts
+  // by setting all tunable parameters to their minimum values. It then
+  // repeatedly increases the parameter with the largest decrease in output
+  // time per unit of resource used, where the resource used by a step is the
+  // fraction of the CPU budget and of the RAM budget that it consumes. Steps
+  // that would exceed the RAM budget are not taken. The output time models the
+  // queueing delay of each buffer given the model input time, which is the
+  // time the consumer takes between requests. The process is repeated until
+  // the output time is below the model input time (i.e. the pipeline keeps up
+  // with its consumer) or the processing time divided by the CPU budget, or no
+  // step decreases the output time.
+  void OptimizeCostBased(std::shared_ptr<Node> snapshot,
+                         const OptimizationParams& optimization_params,
+                         CancellationManager* cancellation_manager,
+                         RamBudgetManager& ram_budget_manager);
+
   // Determines if we should stop the gradient descent optimization iterations
   // based on number of increasable parameters, CPU budget, RAM budget and
   // current resource usage.
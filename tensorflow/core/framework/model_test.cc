@@ -1384,7 +1384,7 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 }
 
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
-                         ::testing::Values(0, 1, 2, 3));
+                         ::testing::Values(0, 1, 2, 3, 5));
 
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
@@ -3158,6 +3158,132 @@ TEST_F(ModelTimingTest, OptimizeStageBased_PipelineRatioLessThanOne) {
   EXPECT_EQ(14, GetNode(/*node_id=*/1)->parameter_value("parallelism"));
 }
 
+TEST_F(ModelTimingTest, OptimizeCostBased_StopsAtModelInputTime) {
+  BuildModelFromProto(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "Prefetch"
+        autotune: true
+        num_elements: 100
+        processing_time: 1000
+        bytes_produced: 10000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+        parameters: {
+          name: "buffer_size"
+          value: 1
+          min: 1
+          max: 64
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 100
+        processing_time: 20000
+        bytes_produced: 10000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 3
+        parameters: {
+          name: "parallelism"
+          value: 1
+          min: 1
+          max: 64
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 3
+      value: {
+        id: 3
+        name: "SSTable"
+        autotune: true
+        num_elements: 100
+        processing_time: 1000
+        node_class: KNOWN_RATIO
+      }
+    }
+    output: 1
+  )pb");
+
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(0);
+  model_->Optimize(AutotuneAlgorithm::COST_BASED, CpuBudgetFunc(64),
+                   /*ram_budget_share=*/1.0,
+                   /*fixed_ram_budget=*/100000,
+                   /*model_input_time=*/50, ram_budget_manager,
+                   &cancellation_manager);
+
+  // The map is the bottleneck, and the pipeline keeps up with its consumer
+  // long before all parameters reach their maximum.
+  const int64_t parallelism =
+      GetNode(/*node_id=*/2)->parameter_value("parallelism");
+  const int64_t buffer_size =
+      GetNode(/*node_id=*/1)->parameter_value("buffer_size");
+  EXPECT_GT(parallelism, 1);
+  EXPECT_LT(parallelism, 64);
+  EXPECT_LT(buffer_size, 64);
+}
+
+TEST_F(ModelTimingTest, OptimizeCostBased_RespectsRamBudget) {
+  BuildModelFromProto(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 100
+        processing_time: 20000
+        bytes_produced: 100000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+        parameters: {
+          name: "parallelism"
+          value: 1
+          min: 1
+          max: 64
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "SSTable"
+        autotune: true
+        num_elements: 100
+        processing_time: 1000
+        node_class: KNOWN_RATIO
+      }
+    }
+    output: 1
+  )pb");
+
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(0);
+  // Each element is 1000 bytes, so at most 5 can be buffered.
+  model_->Optimize(AutotuneAlgorithm::COST_BASED, CpuBudgetFunc(64),
+                   /*ram_budget_share=*/1.0,
+                   /*fixed_ram_budget=*/5000,
+                   /*model_input_time=*/0, ram_budget_manager,
+                   &cancellation_manager);
+
+  EXPECT_EQ(5, GetNode(/*node_id=*/1)->parameter_value("parallelism"));
+}
+
 TEST_F(ModelTimingTest, ComputeTargetTime) {
   model_ = std::make_unique<Model>();
 
@@ -3482,6 +3608,72 @@ TEST_F(ModelTimingTest, ComputeSnapshotProcessingTimeMultipleStages) {
   EXPECT_EQ(model_->ComputeSnapshotProcessingTimeNsec(), 1500.0);
 }
 
+TEST_F(ModelTimingTest, AnalyzeInputBottleneckNullSnapshot) {
+  model::Model model;
+  EXPECT_FALSE(model.AnalyzeInputBottleneck().ok());
+}
+
+TEST_F(ModelTimingTest, AnalyzeInputBottleneckSingleStage) {
+  BuildModelFromProto(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 100
+        processing_time: 20000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+        parameters: {
+          name: "parallelism"
+          value: 2
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "SSTable"
+        autotune: true
+        num_elements: 100
+        processing_time: 100000
+        node_class: KNOWN_RATIO
+        ratio: 1
+      }
+    }
+    output: 1
+  )pb");
+
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(0);
+  // Ensure the model snapshot is populated.
+  model_->Optimize(AutotuneAlgorithm::STAGE_BASED, CpuBudgetFunc(1),
+                   /*ram_budget_share=*/1.0,
+                   /*fixed_ram_budget=*/1,
+                   /*model_input_time=*/1000000, ram_budget_manager,
+                   &cancellation_manager);
+  // The consumer asks for an element every microsecond.
+  for (int i = 0; i < 100; ++i) {
+    model_->RecordIteratorGapTime(1);
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(Model::InputBottleneck bottleneck,
+                          model_->AnalyzeInputBottleneck());
+  EXPECT_EQ(bottleneck.stage_root, "ParallelMapV2(id:1)");
+  EXPECT_DOUBLE_EQ(bottleneck.stage_time_nsec, 1200.0);
+  EXPECT_DOUBLE_EQ(bottleneck.target_time_nsec, 1000.0);
+  EXPECT_DOUBLE_EQ(bottleneck.utilization, 1.2);
+  EXPECT_DOUBLE_EQ(bottleneck.parallelism, 1.0);
+  EXPECT_DOUBLE_EQ(bottleneck.max_parallelism, 16.0);
+  EXPECT_DOUBLE_EQ(bottleneck.parallelism_to_keep_up, 2.0);
+}
+
 TEST_F(ModelTimingTest, SelfTime) {
   BuildModelFromProto(R"pb(
     nodes: {
@@ -378,6 +378,9 @@ Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
   if (TF_PREDICT_FALSE(attr.scope_id > 0)) {
     allocator = params_->device->GetScopedAllocator(attr, step_id());
     CHECK(allocator);
+  } else if (params_->default_allocator_override != nullptr &&
+             attr.value == 0) {
+    allocator = params_->default_allocator_override;
   } else {
     allocator = params_->device->GetAllocator(attr);
   }
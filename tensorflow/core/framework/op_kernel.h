@@ -621,6 +621,10 @@ class OpKernelContext {
     bool track_allocations = false;
     bool log_memory = false;
 
+    // If non-null, allocations with default allocator attributes use this
+    // allocator instead of `device->GetAllocator()`.
+    Allocator* default_allocator_override = nullptr;
+
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
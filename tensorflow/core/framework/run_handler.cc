@@ -791,7 +791,9 @@ class RunHandlerPool::Impl {
         version_(0),
         sub_thread_pool_end_request_percentage_(ParamFromEnvWithDefault(
             "TF_RUN_HANDLER_SUB_THREAD_POOL_END_REQUEST_PERCENTAGE",
-            std::vector<double>({1}))) {
+            std::vector<double>({1}))),
+        priority_aging_ms_(ParamFromEnvWithDefault(
+            "TF_RUN_HANDLER_PRIORITY_AGING_MS", static_cast<double>(0))) {
     VLOG(1) << "Creating a RunHandlerPool with max handlers: " << max_handlers_;
     free_handlers_.reserve(max_handlers_);
     handlers_.reserve(max_handlers_);
@@ -874,12 +876,14 @@ class RunHandlerPool::Impl {
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority();
+      const double priority = options.priority();
+      const uint64 now_us = handler_impl->start_time_us();
       auto it = sorted_active_handlers_.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
-        if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
+        if (!new_handler_inserted &&
+            (it == sorted_active_handlers_.cend() ||
+             priority > EffectivePriority(**it, now_us))) {
           sorted_active_handlers_.insert(it, handler_impl);
           new_handler_inserted = true;
           // Point to the newly added handler.
@@ -943,6 +947,20 @@ class RunHandlerPool::Impl {
 
   void LogInfo() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns the priority of `handler`, raised by one for every
+  // `priority_aging_ms_` that it has been active, so that requests of a low
+  // priority are not starved by a steady stream of requests of a higher
+  // priority. Since all active handlers age at the same rate, aging does not
+  // change their relative order, and sorted_active_handlers_ stays sorted.
+  double EffectivePriority(RunHandler::Impl& handler, uint64 now_us) const {
+    double priority = handler.priority();
+    if (priority_aging_ms_ > 0 && now_us > handler.start_time_us()) {
+      priority += (now_us - handler.start_time_us()) /
+                  (priority_aging_ms_ * 1000.0);
+    }
+    return priority;
+  }
+
   // Maximum number of handlers pre-created during pool construction time. The
   // number has been chosen expecting each handler might at least want 1
   // inter-op thread for execution (during compute intensive workloads like
@@ -954,7 +972,8 @@ class RunHandlerPool::Impl {
 
   std::unique_ptr<internal::RunHandlerThreadPool> run_handler_thread_pool_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
+  // Handlers are sorted by their effective priority (see EffectivePriority()),
+  // and then by start time.
   // TODO(azaks): sort by the remaining latency budget.
   // TODO(chaox): Consider other data structure for maintaining the sorted
   // active handlers if the searching overhead(currently O(n)) becomes the
@@ -970,6 +989,9 @@ class RunHandlerPool::Impl {
   mutex mu_;
   int64_t version_ TF_GUARDED_BY(mu_);
   const std::vector<double> sub_thread_pool_end_request_percentage_;
+  // The time after which the priority of an active request is raised by one.
+  // 0 disables aging.
+  const double priority_aging_ms_;
 };
 
 void RunHandlerPool::Impl::RecomputePoolStats(
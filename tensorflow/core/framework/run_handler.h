@@ -47,6 +47,12 @@ class RunHandler;
 // * Use handler for scheduling all inter-op work by:
 // handler->ScheduleInterOpClosure(closure);
 //
+// Active handlers are ordered by the priority in RunHandlerPoolOptions, so that
+// the work of latency-critical requests is drained first. If the environment
+// variable TF_RUN_HANDLER_PRIORITY_AGING_MS is set, the priority of an active
+// handler is raised by one every that many milliseconds, so that requests of a
+// low priority are not starved.
+//
 // This class is thread safe.
 class RunHandlerPool {
  public:
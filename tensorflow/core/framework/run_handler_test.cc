@@ -113,6 +113,33 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, PriorityAgingTest) {
+  setenv("TF_RUN_HANDLER_PRIORITY_AGING_MS", "1", true);
+  int num_threads = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads));
+  unsetenv("TF_RUN_HANDLER_PRIORITY_AGING_MS");
+
+  RunOptions::Experimental::RunHandlerPoolOptions options =
+      RunOptions::Experimental::RunHandlerPoolOptions();
+  options.set_priority(1);
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  Env::Default()->SleepForMicroseconds(50 * 1000);
+
+  // The first request has aged past the priority of the second one.
+  options.set_priority(5);
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options);
+  options.set_priority(1000000);
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options);
+
+  std::vector<int64_t> sorted_active_list =
+      pool->GetActiveHandlerPrioritiesForTesting();
+  ASSERT_EQ(sorted_active_list.size(), 3);
+  EXPECT_EQ(sorted_active_list[0], 1000000);
+  EXPECT_EQ(sorted_active_list[1], 1);
+  EXPECT_EQ(sorted_active_list[2], 5);
+}
+
 TEST(RunHandlerThreadPool, EnqueueTask) {
   Eigen::MaxSizeVector<mutex> waiters_mu(2);
   waiters_mu.resize(2);
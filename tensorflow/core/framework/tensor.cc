@@ -1119,10 +1119,85 @@ Tensor Tensor::SubSlice(int64_t index) const {
   return ret;
 }
 
+// A buffer that owns the tensor_content bytes of a TensorProto, letting
+// FromProto alias them instead of copying them.
+class ProtoContentBuffer : public TensorBuffer {
+ public:
+  explicit ProtoContentBuffer(std::unique_ptr<std::string> content)
+      : TensorBuffer(content->data()), content_(std::move(content)) {}
+
+  size_t size() const override { return content_->size(); }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size());
+    proto->set_allocator_name("ProtoContentBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+
+ private:
+  const std::unique_ptr<std::string> content_;
+
+  ~ProtoContentBuffer() override = default;
+};
+
+// Moves the tensor_content of `proto` into a buffer for a tensor of `N`
+// elements. Returns nullptr, leaving `proto` unchanged, if the content has the
+// wrong size, is not aligned or needs decoding.
+static TensorBuffer* ReleaseTensorContent(TensorProto* proto, int64_t N) {
+  const DataType dtype = proto->dtype();
+  // Bools are validated element by element while copying them.
+  if (!DataTypeCanUseMemcpy(dtype) || dtype == DT_BOOL) return nullptr;
+  const int64_t elem_size = DataTypeSize(dtype);
+  if (elem_size <= 0 ||
+      proto->tensor_content().size() != static_cast<size_t>(elem_size * N)) {
+    return nullptr;
+  }
+  // Swapping keeps the heap allocation of the string, except for contents
+  // short enough to be stored inline, so the alignment is checked after it.
+  auto content = std::make_unique<std::string>();
+  content->swap(*proto->mutable_tensor_content());
+#if EIGEN_MAX_ALIGN_BYTES > 0
+  if (reinterpret_cast<intptr_t>(content->data()) % EIGEN_MAX_ALIGN_BYTES !=
+      0) {
+    content->swap(*proto->mutable_tensor_content());
+    return nullptr;
+  }
+#endif
+  return new ProtoContentBuffer(std::move(content));
+}
+
 bool Tensor::FromProto(const TensorProto& proto) {
   return FromProto(get_default_cpu_allocator(), proto);
 }
 
+bool Tensor::FromProto(TensorProto&& proto) {
+  return FromProto(get_default_cpu_allocator(), std::move(proto));
+}
+
+bool Tensor::FromProto(Allocator* a, TensorProto&& proto) {
+  CHECK_NOTNULL(a);
+  if (proto.tensor_content().empty() ||
+      !TensorShape::IsValid(proto.tensor_shape())) {
+    return FromProto(a, static_cast<const TensorProto&>(proto));
+  }
+  TensorShape shape(proto.tensor_shape());
+  const int64_t N = shape.num_elements();
+  TensorBuffer* p = N > 0 ? ReleaseTensorContent(&proto, N) : nullptr;
+  if (p == nullptr) return FromProto(a, static_cast<const TensorProto&>(proto));
+  shape_ = shape;
+  set_dtype(proto.dtype());
+  UnrefIfNonNull(buf_);
+  buf_ = p;
+  if (MemoryLoggingEnabled()) {
+    LogMemory::RecordTensorAllocation("Unknown (from Proto)",
+                                      LogMemory::UNKNOWN_STEP_ID, *this);
+  }
+  return true;
+}
+
 bool Tensor::FromProto(Allocator* a, const TensorProto& proto) {
   CHECK_NOTNULL(a);
   TensorBuffer* p = nullptr;
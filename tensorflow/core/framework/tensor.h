@@ -389,6 +389,14 @@ class Tensor {
   bool FromProto(const TensorProto& other) TF_MUST_USE_RESULT;
   bool FromProto(Allocator* a, const TensorProto& other) TF_MUST_USE_RESULT;
 
+  /// \brief Same as above, but takes over the bytes of
+  /// `other.tensor_content()` instead of copying them when the tensor has a
+  /// type that can be memcpy'd (except bool) and the bytes are suitably
+  /// aligned. Otherwise decodes `other` into memory from `a`. On success
+  /// `other.tensor_content()` may be left empty.
+  bool FromProto(TensorProto&& other) TF_MUST_USE_RESULT;
+  bool FromProto(Allocator* a, TensorProto&& other) TF_MUST_USE_RESULT;
+
   /// \brief Fills in `proto` with `*this` tensor's content.
   ///
   /// `AsProtoField()` fills in the repeated field for `proto.dtype()`, while
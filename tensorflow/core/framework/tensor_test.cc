@@ -1414,6 +1414,48 @@ TEST(TensorFromProto, CompressedTensorProto) {
   ASSERT_TRUE(b.FromProto(p));
 }
 
+TEST(TensorFromProto, MovedTensorContent) {
+  Tensor a(DT_FLOAT, TensorShape({4, 256}));
+  for (int i = 0; i < a.NumElements(); ++i) a.flat<float>()(i) = i;
+  TensorProto p;
+  a.AsProtoTensorContent(&p);
+  const char* content = p.tensor_content().data();
+  Tensor b;
+  ASSERT_TRUE(b.FromProto(std::move(p)));
+  test::ExpectTensorEqual<float>(a, b);
+  EXPECT_TRUE(b.IsAligned());
+  // The content is aliased when it is aligned, and copied otherwise.
+  EXPECT_EQ(b.tensor_data().data() == content,
+            reinterpret_cast<intptr_t>(content) % EIGEN_MAX_ALIGN_BYTES == 0);
+}
+
+TEST(TensorFromProto, MovedTensorContentNeedingDecoding) {
+  Tensor a(DT_STRING, TensorShape({2}));
+  a.vec<tstring>()(0) = "foo";
+  a.vec<tstring>()(1) = "bar";
+  TensorProto p;
+  a.AsProtoTensorContent(&p);
+  Tensor b;
+  ASSERT_TRUE(b.FromProto(std::move(p)));
+  test::ExpectTensorEqual<tstring>(a, b);
+
+  Tensor c(DT_BOOL, TensorShape({3}));
+  c.vec<bool>().setConstant(true);
+  c.AsProtoTensorContent(&p);
+  Tensor d;
+  ASSERT_TRUE(d.FromProto(std::move(p)));
+  test::ExpectTensorEqual<bool>(c, d);
+}
+
+TEST(TensorFromProto, MovedTensorContentOfWrongSize) {
+  Tensor a(DT_FLOAT, TensorShape({1024}));
+  TensorProto p;
+  a.AsProtoTensorContent(&p);
+  p.mutable_tensor_shape()->mutable_dim(0)->set_size(1025);
+  Tensor b;
+  EXPECT_FALSE(b.FromProto(std::move(p)));
+}
+
 TEST(Tensor, FailureToAllocate) {
   TensorShape shape({1});
   DummyCPUAllocator allocator;
@@ -1894,6 +1936,36 @@ void BM_Assign(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_Assign);
 
+// Benchmark decoding a float tensor of state.range(0) elements from its
+// tensor_content, copying the proto or moving it when state.range(1) is 1.
+void BM_FromProtoTensorContent(::testing::benchmark::State& state) {
+  const int64_t num_elements = state.range(0);
+  const bool move = state.range(1);
+  Tensor t(DT_FLOAT, TensorShape({num_elements}));
+  t.flat<float>().setConstant(1.0f);
+  TensorProto proto;
+  t.AsProtoTensorContent(&proto);
+  for (auto s : state) {
+    state.PauseTiming();
+    TensorProto input = proto;
+    state.ResumeTiming();
+    Tensor decoded;
+    if (move) {
+      CHECK(decoded.FromProto(std::move(input)));
+    } else {
+      CHECK(decoded.FromProto(input));
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * num_elements * sizeof(float));
+}
+BENCHMARK(BM_FromProtoTensorContent)
+    ->ArgPair(1 << 10, 0)
+    ->ArgPair(1 << 10, 1)
+    ->ArgPair(1 << 20, 0)
+    ->ArgPair(1 << 20, 1)
+    ->ArgPair(1 << 24, 0)
+    ->ArgPair(1 << 24, 1);
+
 // Ensure tensor_data() works on empty tensors
 TEST(Tensor, EmptyTensorData) {
   Tensor empty;
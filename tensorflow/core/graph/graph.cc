@@ -543,6 +543,11 @@ absl::StatusOr<Node*> Graph::AddNode(NodeDef node_def) {
   return out;
 }
 
+void Graph::Reserve(int num_nodes, int num_edges) {
+  nodes_.reserve(nodes_.size() + num_nodes);
+  edges_.reserve(edges_.size() + num_edges);
+}
+
 Node* Graph::AddNode(NodeDef node_def, Status* status) {
   const OpRegistrationData* op_reg_data;
   status->Update(ops_.LookUp(node_def.op(), &op_reg_data));
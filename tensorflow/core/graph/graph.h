@@ -565,6 +565,11 @@ class Graph {
   // Same as above, but using StatusOr. This method is always preferred.
   absl::StatusOr<Node*> AddNode(NodeDef node_def);
 
+  // Reserves space for `num_nodes` more nodes and `num_edges` more edges, so
+  // that building a large graph does not repeatedly grow the node and edge
+  // tables.
+  void Reserve(int num_nodes, int num_edges);
+
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
   // returned instance.
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/hash/hash.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/function.h"
@@ -491,6 +492,39 @@ uint64 NumElementsFromTensorProto(const TensorProto& tensor_proto) {
   return num_elements;
 }
 
+// Returns true if the shapes inferred for `node` depend on nodes which aren't
+// in its transitive fanin, so that they can't be inferred from it alone.
+bool RequiresFullInference(const NodeDef& node) {
+  return IsMerge(node) || IsEnter(node) || IsNextIteration(node) ||
+         IsQueue(node) || IsEnqueue(node) || IsDequeue(node);
+}
+
+// Symbolic dimensions are only meaningful within one inference.
+void ReplaceSymbolicDims(TensorShapeProto* shape) {
+  for (auto& dim : *shape->mutable_dim()) {
+    if (dim.size() < -1) dim.set_size(-1);
+  }
+}
+
+// Returns a node producing a tensor with the given `properties`, which stands
+// in for an output of a node whose properties are already known.
+NodeDef MakeFaninStandIn(const string& name,
+                         const OpInfo::TensorProperties& properties) {
+  NodeDef node;
+  node.set_name(name);
+  (*node.mutable_attr())["dtype"].set_type(properties.dtype());
+  if (properties.has_value()) {
+    node.set_op("Const");
+    *(*node.mutable_attr())["value"].mutable_tensor() = properties.value();
+  } else {
+    node.set_op("Placeholder");
+    TensorShapeProto* shape = (*node.mutable_attr())["shape"].mutable_shape();
+    *shape = properties.shape();
+    ReplaceSymbolicDims(shape);
+  }
+  return node;
+}
+
 }  // namespace
 
 // Note that tensor_as_shape input should not include kUnknownDimFromConst.
@@ -2756,6 +2790,144 @@ Status GraphProperties::InferStatically(bool assume_valid_feeds,
   TF_RETURN_IF_ERROR(VerboseShapeInferenceLogging(item_.graph, refiner.get(),
                                                   shape_manager.get()));
 
+  inferred_statically_ = true;
+  assume_valid_feeds_ = assume_valid_feeds;
+  aggressive_shape_inference_ = aggressive_shape_inference;
+  include_input_tensor_values_ = include_input_tensor_values;
+  include_output_tensor_values_ = include_output_tensor_values;
+  return absl::OkStatus();
+}
+
+Status GraphProperties::InferStaticallyIncrementally(
+    const absl::flat_hash_set<string>& changed_nodes) {
+  if (!inferred_statically_) {
+    return errors::FailedPrecondition(
+        "InferStaticallyIncrementally requires properties inferred by "
+        "InferStatically");
+  }
+  auto infer_all = [this]() {
+    const bool assume_valid_feeds = assume_valid_feeds_;
+    const bool aggressive_shape_inference = aggressive_shape_inference_;
+    const bool include_input_tensor_values = include_input_tensor_values_;
+    const bool include_output_tensor_values = include_output_tensor_values_;
+    Clear();
+    incompatible_shape_nodes_.clear();
+    return InferStatically(assume_valid_feeds, aggressive_shape_inference,
+                           include_input_tensor_values,
+                           include_output_tensor_values);
+  };
+
+  GraphView graph_view(&item_.graph);
+
+  // Forget about the nodes which were removed from the graph.
+  std::vector<string> removed_nodes;
+  for (const auto& properties : output_properties_) {
+    if (graph_view.GetNode(properties.first) == nullptr) {
+      removed_nodes.push_back(properties.first);
+    }
+  }
+  for (const auto& properties : input_properties_) {
+    if (graph_view.GetNode(properties.first) == nullptr) {
+      removed_nodes.push_back(properties.first);
+    }
+  }
+  for (const string& node_name : removed_nodes) {
+    input_properties_.erase(node_name);
+    output_properties_.erase(node_name);
+    incompatible_shape_nodes_.erase(node_name);
+  }
+
+  // Collect the nodes to infer again.
+  absl::flat_hash_set<const NodeDef*> affected;
+  std::vector<const NodeDef*> to_visit;
+  for (const NodeDef& node : item_.graph.node()) {
+    if (changed_nodes.contains(node.name()) ||
+        !HasInputProperties(node.name()) || !HasOutputProperties(node.name())) {
+      affected.insert(&node);
+      to_visit.push_back(&node);
+    }
+  }
+  while (!to_visit.empty()) {
+    const NodeDef* node = to_visit.back();
+    to_visit.pop_back();
+    if (RequiresFullInference(*node)) return infer_all();
+    for (const GraphView::InputPort& fanout :
+         graph_view.GetFanouts(*node, /*include_controlled_nodes=*/false)) {
+      if (affected.insert(fanout.node).second) to_visit.push_back(fanout.node);
+    }
+  }
+  if (affected.empty()) return absl::OkStatus();
+  if (2 * static_cast<int64_t>(affected.size()) > item_.graph.node_size()) {
+    return infer_all();
+  }
+  VLOG(1) << "Inferring the properties of " << affected.size() << " of "
+          << item_.graph.node_size() << " nodes again";
+
+  // Build the subgraph of the affected nodes, in which the outputs of the other
+  // nodes are replaced with nodes producing tensors with their properties.
+  GrapplerItem subgraph_item;
+  subgraph_item.id = item_.id;
+  subgraph_item.feed = item_.feed;
+  GraphDef& subgraph = subgraph_item.graph;
+  *subgraph.mutable_versions() = item_.graph.versions();
+  *subgraph.mutable_library() = item_.graph.library();
+  absl::flat_hash_map<string, string> stand_ins;
+  for (const NodeDef& node : item_.graph.node()) {
+    if (!affected.contains(&node)) continue;
+    NodeDef* new_node = subgraph.add_node();
+    *new_node = node;
+    new_node->clear_input();
+    for (const string& input : node.input()) {
+      const TensorId tensor_id = ParseTensorName(input);
+      const NodeDef* fanin = graph_view.GetNode(tensor_id.node());
+      if (fanin != nullptr && affected.contains(fanin)) {
+        new_node->add_input(input);
+        continue;
+      }
+      // Control dependencies don't matter to shape inference.
+      if (tensor_id.index() < 0) continue;
+      const std::vector<OpInfo::TensorProperties>& fanin_properties =
+          GetOutputProperties(string(tensor_id.node()));
+      if (fanin == nullptr ||
+          tensor_id.index() >= static_cast<int>(fanin_properties.size()) ||
+          fanin_properties[tensor_id.index()].dtype() == DT_INVALID) {
+        return infer_all();
+      }
+      const string fanin_name = tensor_id.ToString();
+      auto it = stand_ins.find(fanin_name);
+      if (it == stand_ins.end()) {
+        const string stand_in_name =
+            strings::StrCat(tensor_id.node(), "/_StandIn_", tensor_id.index());
+        if (graph_view.GetNode(stand_in_name) != nullptr) return infer_all();
+        *subgraph.add_node() = MakeFaninStandIn(
+            stand_in_name, fanin_properties[tensor_id.index()]);
+        it = stand_ins.emplace(fanin_name, stand_in_name).first;
+      }
+      new_node->add_input(it->second);
+    }
+  }
+
+  GraphProperties subgraph_properties(subgraph_item);
+  TF_RETURN_IF_ERROR(subgraph_properties.InferStatically(
+      assume_valid_feeds_, aggressive_shape_inference_,
+      include_input_tensor_values_, include_output_tensor_values_));
+  for (const NodeDef* node : affected) {
+    auto& input_properties = input_properties_[node->name()];
+    input_properties = subgraph_properties.GetInputProperties(node->name());
+    for (auto& properties : input_properties) {
+      ReplaceSymbolicDims(properties.mutable_shape());
+    }
+    auto& output_properties = output_properties_[node->name()];
+    output_properties = subgraph_properties.GetOutputProperties(node->name());
+    for (auto& properties : output_properties) {
+      ReplaceSymbolicDims(properties.mutable_shape());
+    }
+    if (subgraph_properties.CheckShapeIncompatible(node->name())) {
+      incompatible_shape_nodes_.insert(node->name());
+    } else {
+      incompatible_shape_nodes_.erase(node->name());
+    }
+  }
   return absl::OkStatus();
 }
 
@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
@@ -114,6 +115,17 @@ class GraphProperties {
                            /*aggressive_shape_inference=*/false,
                            /*include_tensor_values=*/true);
   }
+  // Update the properties inferred by a previous call to InferStatically, with
+  // the same options, after the graph of the item was rewritten. Only the
+  // nodes in `changed_nodes`, the nodes without properties (e.g. nodes added
+  // to the graph, or invalidated with ClearInputProperties or
+  // ClearOutputProperties) and their transitive fanout are inferred again,
+  // starting from the properties of their fanin. Symbolic dimensions of the
+  // properties inferred again can't be related to the ones of the other nodes,
+  // and are reported as unknown. Falls back to a full inference when loops or
+  // queues are affected, or when most of the graph is.
+  Status InferStaticallyIncrementally(
+      const absl::flat_hash_set<string>& changed_nodes);
   // Infer the shape by running the graph on the specified cluster and recording
   // the shapes of the processed tensors.
   Status InferDynamically(Cluster* cluster);
@@ -156,6 +168,7 @@ class GraphProperties {
   void Clear() {
     input_properties_.clear();
     output_properties_.clear();
+    inferred_statically_ = false;
   }
 
  private:
@@ -202,6 +215,13 @@ class GraphProperties {
 
   // Data members
   const GrapplerItem& item_;
+  // Options of the last successful call to InferStatically, reused by
+  // InferStaticallyIncrementally.
+  bool inferred_statically_ = false;
+  bool assume_valid_feeds_ = false;
+  bool aggressive_shape_inference_ = false;
+  bool include_input_tensor_values_ = false;
+  bool include_output_tensor_values_ = false;
   absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
       input_properties_;
   absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
 #include "tensorflow/core/grappler/inputs/utils.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -233,6 +234,49 @@ TEST_F(GraphPropertiesTest, Clear) {
   EXPECT_FALSE(properties.has_properties());
 }
 
+TEST_F(GraphPropertiesTest, InferStaticallyIncrementally) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {2, 3});
+  Output b = ops::Const(s.WithOpName("b"), 1.0f, {4});
+  Output c = ops::Const(s.WithOpName("c"), 1.0f, {5, 7});
+  Output square_a = ops::Square(s.WithOpName("square_a"), a);
+  Output out = ops::Identity(s.WithOpName("out"), square_a);
+  Output square_b = ops::Square(s.WithOpName("square_b"), b);
+  Output neg_b = ops::Neg(s.WithOpName("neg_b"), square_b);
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  GraphProperties properties(item);
+  EXPECT_FALSE(properties.InferStaticallyIncrementally({}).ok());
+  TF_ASSERT_OK(properties.InferStatically(false));
+  EXPECT_EQ("float: [2,3]",
+            PropToString(properties.GetOutputProperties("out")[0]));
+
+  // Rewire square_a to c and remove a.
+  MutableGraphView graph_view(&item.graph);
+  TF_ASSERT_OK(graph_view.UpdateRegularFaninByPort("square_a", 0, {"c", 0}));
+  TF_ASSERT_OK(graph_view.DeleteNodes({"a"}));
+  TF_ASSERT_OK(properties.InferStaticallyIncrementally({"square_a"}));
+
+  EXPECT_FALSE(properties.HasOutputProperties("a"));
+  const auto& square_a_inputs = properties.GetInputProperties("square_a");
+  ASSERT_EQ(1, square_a_inputs.size());
+  EXPECT_EQ("float: [5,7]", PropToString(square_a_inputs[0]));
+  EXPECT_TRUE(square_a_inputs[0].has_value());
+  EXPECT_EQ("float: [5,7]",
+            PropToString(properties.GetOutputProperties("square_a")[0]));
+  EXPECT_EQ("float: [5,7]",
+            PropToString(properties.GetOutputProperties("out")[0]));
+  EXPECT_EQ("float: [4]",
+            PropToString(properties.GetOutputProperties("neg_b")[0]));
+
+  // Invalidated properties are inferred again.
+  properties.ClearOutputProperties("neg_b");
+  TF_ASSERT_OK(properties.InferStaticallyIncrementally({}));
+  EXPECT_EQ("float: [4]",
+            PropToString(properties.GetOutputProperties("neg_b")[0]));
+}
+
 TEST_F(GraphPropertiesTest, DynamicProperties) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false,
                                           cluster_->GetDeviceNames());
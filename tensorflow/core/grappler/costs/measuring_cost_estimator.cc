@@ -15,16 +15,21 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/costs/measuring_cost_estimator.h"
 
+#include <cstring>
 #include <limits>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/op_cost_profile.h"
 #include "tensorflow/core/grappler/costs/robust_stats.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/public/session.h"
 
 namespace tensorflow {
@@ -146,5 +151,99 @@ Status MeasuringCostEstimator::PredictCosts(const GraphDef& optimized_graph,
 
   return absl::OkStatus();
 }
+namespace {
+
+// Builds a graph which runs an op like `op_info` on `device`.
+Status MakeCalibrationItem(const OpInfo& op_info, const string& device,
+                           GrapplerItem* item) {
+  item->id = absl::StrCat("calibration_", op_info.op());
+  NodeDef* op_node = item->graph.add_node();
+  op_node->set_name("op");
+  op_node->set_op(op_info.op());
+  op_node->set_device(device);
+  *op_node->mutable_attr() = op_info.attr();
+  for (int i = 0; i < op_info.inputs_size(); ++i) {
+    const OpInfo::TensorProperties& input = op_info.inputs(i);
+    NodeDef* input_node = item->graph.add_node();
+    input_node->set_name(absl::StrCat("input_", i));
+    input_node->set_device(device);
+    (*input_node->mutable_attr())["dtype"].set_type(input.dtype());
+    op_node->add_input(input_node->name());
+    if (input.has_value()) {
+      input_node->set_op("Const");
+      *(*input_node->mutable_attr())["value"].mutable_tensor() = input.value();
+      continue;
+    }
+    PartialTensorShape shape(input.shape());
+    TensorShape full_shape;
+    if (!shape.AsTensorShape(&full_shape) ||
+        !DataTypeCanUseMemcpy(input.dtype())) {
+      return errors::InvalidArgument("Cannot feed input ", i, " of ",
+                                     op_info.op(), " of type ",
+                                     DataTypeString(input.dtype()),
+                                     " and shape ", shape.DebugString());
+    }
+    input_node->set_op("Placeholder");
+    full_shape.AsProto((*input_node->mutable_attr())["shape"].mutable_shape());
+    Tensor zeros(input.dtype(), full_shape);
+    std::memset(zeros.data(), 0, zeros.TotalBytes());
+    item->feed.emplace_back(input_node->name(), zeros);
+  }
+  item->fetch.push_back(op_node->name());
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+Status CalibrateOpCosts(Cluster* cluster, const string& device_type,
+                        const std::vector<OpInfo>& ops, int measurement_steps,
+                        OpCostProfile* profile) {
+  const DeviceProperties* device_properties = nullptr;
+  string device;
+  for (const auto& cluster_device : cluster->GetDevices()) {
+    if (cluster_device.second.type() == device_type &&
+        (device.empty() || cluster_device.first < device)) {
+      device = cluster_device.first;
+      device_properties = &cluster_device.second;
+    }
+  }
+  if (device_properties == nullptr) {
+    return errors::NotFound("Cluster has no device of type ", device_type);
+  }
+  profile->set_version(kOpCostProfileVersion);
+  *profile->mutable_device() = *device_properties;
+
+  for (const OpInfo& op_info : ops) {
+    GrapplerItem item;
+    Status s = MakeCalibrationItem(op_info, device, &item);
+    if (s.ok()) {
+      MeasuringCostEstimator estimator(cluster, measurement_steps,
+                                       /*measurement_threads=*/0);
+      s = estimator.Initialize(item);
+      RunMetadata metadata;
+      Costs costs;
+      if (s.ok()) s = estimator.PredictCosts(item.graph, &metadata, &costs);
+      if (s.ok()) {
+        // Prefer the time of the op itself over the time of the whole step,
+        // which includes feeding its inputs.
+        Costs::NanoSeconds execution_time = costs.execution_time;
+        for (const CostGraphDef::Node& node : metadata.cost_graph().node()) {
+          if (node.name() == "op" && node.compute_cost() > 0) {
+            execution_time = Costs::MicroSeconds(node.compute_cost());
+          }
+        }
+        OpPerformance* perf = profile->add_op_performance();
+        *perf->mutable_op() = op_info;
+        perf->mutable_op()->clear_device();
+        perf->set_compute_cost(execution_time.count());
+        continue;
+      }
+    }
+    LOG(WARNING) << "Skipping calibration of " << op_info.ShortDebugString()
+                 << ": " << s;
+  }
+  return absl::OkStatus();
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
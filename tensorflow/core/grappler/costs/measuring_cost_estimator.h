@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/types.h"
@@ -70,6 +71,16 @@ class MeasuringCostEstimator : public CostEstimator {
   std::unique_ptr<thread::ThreadPool> thread_pool_;
 };
 
+// Measures the execution time of each op of `ops` on the first device of
+// `cluster` of type `device_type`, by running a graph holding only the op
+// `measurement_steps` times, and stores them in `profile` for
+// OpCostCalibration. Inputs with a value in their properties are constants;
+// the other ones must have a fully defined shape and are fed with zeros. Ops
+// which fail to run are skipped with a warning.
+Status CalibrateOpCosts(Cluster* cluster, const string& device_type,
+                        const std::vector<OpInfo>& ops, int measurement_steps,
+                        OpCostProfile* profile);
+
 }  // end namespace grappler
 }  // end namespace tensorflow
 
@@ -0,0 +1,159 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/op_cost_profile.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Returns the key of the group of measurements of `op_info` on `device`.
+std::string MeasurementKey(const OpInfo& op_info,
+                           const DeviceProperties& device) {
+  std::string key =
+      absl::StrCat(op_info.op(), ";", device.type(), ";", device.model(), ";");
+  for (const OpInfo::TensorProperties& input : op_info.inputs()) {
+    absl::StrAppend(&key, input.dtype(), ":",
+                    input.shape().unknown_rank() ? -1
+                                                 : input.shape().dim_size(),
+                    ",");
+  }
+  // Attributes starting with an underscore do not change what the op computes.
+  std::map<std::string, const AttrValue*> attrs;
+  for (const auto& attr : op_info.attr()) {
+    if (!attr.first.empty() && attr.first[0] != '_') {
+      attrs.emplace(attr.first, &attr.second);
+    }
+  }
+  for (const auto& attr : attrs) {
+    std::string value;
+    SerializeToStringDeterministic(*attr.second, &value);
+    absl::StrAppend(&key, ";", attr.first, "=", value);
+  }
+  return key;
+}
+
+// Returns the number of elements of the inputs of `op_info`, or -1 if the
+// shape of an input is not fully defined.
+double NumInputElements(const OpInfo& op_info) {
+  double num_elements = 0;
+  for (const OpInfo::TensorProperties& input : op_info.inputs()) {
+    PartialTensorShape shape(input.shape());
+    if (!shape.IsFullyDefined()) return -1;
+    num_elements += shape.num_elements();
+  }
+  return num_elements;
+}
+
+}  // namespace
+
+Status OpCostCalibration::AddProfile(const OpCostProfile& profile) {
+  if (profile.version() != kOpCostProfileVersion) {
+    return errors::FailedPrecondition("Op cost profile has version ",
+                                      profile.version(), ", expected ",
+                                      kOpCostProfileVersion);
+  }
+  for (const OpPerformance& perf : profile.op_performance()) {
+    const double num_elements = NumInputElements(perf.op());
+    if (num_elements < 0 || perf.compute_cost() <= 0) continue;
+    measurements_[MeasurementKey(perf.op(), profile.device())].emplace_back(
+        num_elements, perf.compute_cost());
+  }
+  for (auto& measurements : measurements_) {
+    std::sort(measurements.second.begin(), measurements.second.end());
+  }
+  return OkStatus();
+}
+
+bool OpCostCalibration::PredictExecutionTime(
+    const OpInfo& op_info, Costs::NanoSeconds* execution_time) const {
+  auto it = measurements_.find(MeasurementKey(op_info, op_info.device()));
+  if (it == measurements_.end()) return false;
+  const double num_elements = NumInputElements(op_info);
+  if (num_elements < 0) return false;
+
+  const Measurements& measurements = it->second;
+  auto upper = std::lower_bound(
+      measurements.begin(), measurements.end(), num_elements,
+      [](const std::pair<double, double>& measurement, double n) {
+        return measurement.first < n;
+      });
+  if (upper == measurements.end()) return false;
+  if (upper->first == num_elements) {
+    *execution_time = Costs::NanoSeconds(upper->second);
+    return true;
+  }
+  // Do not extrapolate below the smallest measured size either, where fixed
+  // overheads dominate.
+  if (upper == measurements.begin()) return false;
+  auto lower = std::prev(upper);
+  const double fraction =
+      (num_elements - lower->first) / (upper->first - lower->first);
+  *execution_time = Costs::NanoSeconds(
+      lower->second + fraction * (upper->second - lower->second));
+  return true;
+}
+
+/*static*/ const OpCostCalibration* OpCostCalibration::Global() {
+  static const OpCostCalibration* calibration = []() -> OpCostCalibration* {
+    const char* paths = std::getenv("TF_GRAPPLER_OP_COST_PROFILES");
+    if (paths == nullptr) return nullptr;
+    auto* calibration = new OpCostCalibration;
+    for (absl::string_view path :
+         absl::StrSplit(paths, ',', absl::SkipEmpty())) {
+      OpCostProfile profile;
+      Status s = ReadOpCostProfile(std::string(path), &profile);
+      if (s.ok()) s = calibration->AddProfile(profile);
+      if (!s.ok()) {
+        LOG(WARNING) << "Ignoring op cost profile " << path << ": " << s;
+      }
+    }
+    if (calibration->empty()) {
+      delete calibration;
+      return nullptr;
+    }
+    return calibration;
+  }();
+  return calibration;
+}
+
+Status ReadOpCostProfile(const std::string& path, OpCostProfile* profile) {
+  return ReadBinaryProto(Env::Default(), path, profile);
+}
+
+Status WriteOpCostProfile(const std::string& path,
+                          const OpCostProfile& profile) {
+  return WriteBinaryProto(Env::Default(), path, profile);
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
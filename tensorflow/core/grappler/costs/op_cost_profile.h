@@ -0,0 +1,75 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_PROFILE_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_PROFILE_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Version of the OpCostProfile format.
+constexpr int kOpCostProfileVersion = 1;
+
+// Measured execution times of ops, used by OpLevelCostEstimator in place of
+// its analytical formulas. See CalibrateOpCosts in
+// measuring_cost_estimator.h for building the profiles.
+//
+// Measurements are grouped by op, attributes, input types and ranks, and
+// device type and model. Within a group, the execution time of an op is
+// interpolated linearly in the number of elements of its inputs.
+class OpCostCalibration {
+ public:
+  // Adds the measurements of `profile`. Returns FailedPrecondition if the
+  // profile has another version than kOpCostProfileVersion.
+  Status AddProfile(const OpCostProfile& profile);
+
+  // Returns true and sets `execution_time` if the measurements of ops like
+  // `op_info` cover the size of its inputs.
+  bool PredictExecutionTime(const OpInfo& op_info,
+                            Costs::NanoSeconds* execution_time) const;
+
+  bool empty() const { return measurements_.empty(); }
+
+  // Returns the calibration of the process, read from the comma separated
+  // profile files in the TF_GRAPPLER_OP_COST_PROFILES environment variable, or
+  // nullptr if there is none.
+  static const OpCostCalibration* Global();
+
+ private:
+  // Pairs of number of input elements and execution time in nanoseconds,
+  // sorted by number of input elements.
+  using Measurements = std::vector<std::pair<double, double>>;
+
+  absl::flat_hash_map<std::string, Measurements> measurements_;
+};
+
+Status ReadOpCostProfile(const std::string& path, OpCostProfile* profile);
+Status WriteOpCostProfile(const std::string& path,
+                          const OpCostProfile& profile);
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_PROFILE_H_
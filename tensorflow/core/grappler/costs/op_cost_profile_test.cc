@@ -0,0 +1,104 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/op_cost_profile.h"
+
+#include <string>
+
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+OpInfo MakeReluInfo(DataType dtype, int64_t size) {
+  OpInfo op_info;
+  op_info.set_op("Relu");
+  (*op_info.mutable_attr())["T"].set_type(dtype);
+  (*op_info.mutable_attr())["_class"].mutable_list()->add_s("loc@a");
+  OpInfo::TensorProperties* input = op_info.add_inputs();
+  input->set_dtype(dtype);
+  input->mutable_shape()->add_dim()->set_size(size);
+  op_info.mutable_device()->set_type("GPU");
+  op_info.mutable_device()->set_model("test");
+  return op_info;
+}
+
+OpCostProfile MakeProfile() {
+  OpCostProfile profile;
+  profile.set_version(kOpCostProfileVersion);
+  profile.mutable_device()->set_type("GPU");
+  profile.mutable_device()->set_model("test");
+  for (int64_t size : {100, 300}) {
+    OpPerformance* perf = profile.add_op_performance();
+    *perf->mutable_op() = MakeReluInfo(DT_FLOAT, size);
+    perf->mutable_op()->clear_device();
+    perf->mutable_op()->mutable_attr()->erase("_class");
+    perf->set_compute_cost(size * 10);
+  }
+  return profile;
+}
+
+TEST(OpCostCalibrationTest, InterpolatesMeasurements) {
+  OpCostCalibration calibration;
+  TF_ASSERT_OK(calibration.AddProfile(MakeProfile()));
+
+  Costs::NanoSeconds time;
+  ASSERT_TRUE(
+      calibration.PredictExecutionTime(MakeReluInfo(DT_FLOAT, 100), &time));
+  EXPECT_EQ(time.count(), 1000);
+  ASSERT_TRUE(
+      calibration.PredictExecutionTime(MakeReluInfo(DT_FLOAT, 200), &time));
+  EXPECT_EQ(time.count(), 2000);
+
+  // Sizes outside of the measurements fall back to the formulas.
+  EXPECT_FALSE(
+      calibration.PredictExecutionTime(MakeReluInfo(DT_FLOAT, 50), &time));
+  EXPECT_FALSE(
+      calibration.PredictExecutionTime(MakeReluInfo(DT_FLOAT, 500), &time));
+  // So do other types and devices.
+  EXPECT_FALSE(
+      calibration.PredictExecutionTime(MakeReluInfo(DT_HALF, 100), &time));
+  OpInfo cpu_relu = MakeReluInfo(DT_FLOAT, 100);
+  cpu_relu.mutable_device()->set_type("CPU");
+  EXPECT_FALSE(calibration.PredictExecutionTime(cpu_relu, &time));
+}
+
+TEST(OpCostCalibrationTest, RejectsOtherVersions) {
+  OpCostProfile profile = MakeProfile();
+  profile.set_version(kOpCostProfileVersion + 1);
+  OpCostCalibration calibration;
+  EXPECT_TRUE(errors::IsFailedPrecondition(calibration.AddProfile(profile)));
+  EXPECT_TRUE(calibration.empty());
+}
+
+TEST(OpCostCalibrationTest, ReadWriteProfile) {
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "op_cost_profile.pb");
+  TF_ASSERT_OK(WriteOpCostProfile(path, MakeProfile()));
+  OpCostProfile profile;
+  TF_ASSERT_OK(ReadOpCostProfile(path, &profile));
+  EXPECT_EQ(profile.op_performance_size(), 2);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -655,6 +655,27 @@ OpLevelCostEstimator::OpLevelCostEstimator() {
 
   // By default, use sum of memory_time and compute_time for execution_time.
   compute_memory_overlap_ = false;
+
+  calibration_ = OpCostCalibration::Global();
+}
+
+void OpLevelCostEstimator::ApplyCalibration(const OpInfo& op_info,
+                                            Costs* costs) const {
+  Costs::NanoSeconds measured_time;
+  if (calibration_ == nullptr ||
+      !calibration_->PredictExecutionTime(op_info, &measured_time)) {
+    return;
+  }
+  VLOG(1) << "Operation " << op_info.op() << " takes "
+          << measured_time.count() << " ns according to its measurements.";
+  // The measurements cover compute and memory accesses together.
+  costs->compute_time = measured_time;
+  costs->memory_time = 0;
+  costs->intermediate_memory_time = 0;
+  costs->intermediate_memory_read_time = 0;
+  costs->intermediate_memory_write_time = 0;
+  costs->execution_time = measured_time;
+  costs->inaccurate = false;
 }
 
 Costs OpLevelCostEstimator::PredictCosts(const OpContext& op_context) const {
@@ -662,7 +683,9 @@ Costs OpLevelCostEstimator::PredictCosts(const OpContext& op_context) const {
   NodeCosts node_costs;
   if (PredictNodeCosts(op_context, &node_costs).ok()) {
     if (node_costs.has_costs) {
-      return node_costs.costs;
+      costs = node_costs.costs;
+      ApplyCalibration(op_context.op_info, &costs);
+      return costs;
     }
     // Convert NodeCosts to Costs.
     if (node_costs.minimum_cost_op) {
@@ -693,6 +716,7 @@ Costs OpLevelCostEstimator::PredictCosts(const OpContext& op_context) const {
     costs.num_ops_with_unknown_shapes =
         node_costs.num_nodes_with_unknown_shapes;
     costs.num_ops_total = node_costs.num_nodes;
+    ApplyCalibration(op_context.op_info, &costs);
     return costs;
   }
   // Errors during node cost estimate.
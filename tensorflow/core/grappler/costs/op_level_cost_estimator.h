@@ -27,6 +27,7 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "tensorflow/core/grappler/costs/cost_estimator.h"
 #include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_cost_profile.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/padding.h"
@@ -335,8 +336,15 @@ class OpLevelCostEstimator {
   // compute_time and memory_time, instead of sum of those two.
   bool compute_memory_overlap_;
   std::set<string> persistent_ops_;
+  // Measured execution times which take precedence over the formulas, or
+  // nullptr. Not owned.
+  const OpCostCalibration* calibration_;
 
  private:
+  // Replaces the execution time of `costs` by the one measured for
+  // `op_info`, if any.
+  void ApplyCalibration(const OpInfo& op_info, Costs* costs) const;
+
   friend class OpLevelCostEstimatorTest;
 };
 
@@ -4379,7 +4379,12 @@ Status ArithmeticOptimizer::SimplifyArithmeticOps(bool can_use_shapes) {
           << absl::StrJoin(pipeline.StageNames(), ", ");
 
   while (!nodes_to_simplify.Empty()) {
-    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    if (DeadlineExceeded()) {
+      // Every node is rewritten completely by the stages, so the nodes
+      // simplified so far are kept.
+      set_stopped_at_deadline();
+      break;
+    }
     NodeDef* node = nodes_to_simplify.PopBack();
 
     string simplified_tensor = "";
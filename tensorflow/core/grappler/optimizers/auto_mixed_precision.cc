@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -26,8 +29,10 @@ limitations under the License.
 #include "absl/strings/str_format.h"
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
@@ -1077,6 +1082,8 @@ class AutoMixedPrecisionImpl {
       case AutoMixedPrecisionMode::FP16_CPU:
         return std::make_unique<AutoMixedPrecisionListsFp16>(
             0, 0, AutoMixedPrecisionMode::FP16_CPU);
+      case AutoMixedPrecisionMode::INT8_CPU:
+        return std::make_unique<AutoMixedPrecisionListsInt8>();
     }
   }
   Status PrintDebugLogs(bool preop, size_t timestamp);
@@ -1434,6 +1441,7 @@ Status AutoMixedPrecisionImpl::Optimize() {
       case AutoMixedPrecisionMode::BF16:
       case AutoMixedPrecisionMode::CPU:
       case AutoMixedPrecisionMode::FP16_CPU:
+      case AutoMixedPrecisionMode::INT8_CPU:
         device_type = DEVICE_CPU;
         should_process = !MustPreserve(node) && IsOnDevice(node, device_type);
         break;
@@ -2264,6 +2272,383 @@ Status AutoMixedPrecisionImpl::ChangeTypeAttrsAndAddCasts(
   return absl::OkStatus();
 }
 
+// Relative quantization error of the weights of an op above which it stays in
+// float, unless overridden with TF_AUTO_MIXED_PRECISION_INT8_MAX_WEIGHT_ERROR.
+// Values <= 0 disable this accuracy guard.
+constexpr float kDefaultInt8MaxWeightError = 0.05f;
+
+// Quantizes float `weights` symmetrically to int8 with one scale per slice
+// along `channel_axis`. The int8 values are stored offset by 128 as quint8,
+// which the quint8 kernels read as the range [-128, 127], i.e. as the int8
+// values themselves.
+//
+// Returns the largest RMS quantization error of a channel relative to the
+// median magnitude of its weights. Unlike the error relative to the norm of
+// the weights, this detects channels whose range is stretched by a few
+// outliers, so that most of their weights only get a few int8 levels.
+float QuantizeWeightsPerChannel(const Tensor& weights, int channel_axis,
+                                Tensor* quantized, Tensor* scales) {
+  const int64_t num_channels = weights.dim_size(channel_axis);
+  int64_t inner_size = 1;
+  for (int i = channel_axis + 1; i < weights.dims(); ++i) {
+    inner_size *= weights.dim_size(i);
+  }
+  auto channel = [&](int64_t i) { return (i / inner_size) % num_channels; };
+
+  const auto w = weights.flat<float>();
+  std::vector<std::vector<float>> magnitudes(num_channels);
+  for (int64_t i = 0; i < w.size(); ++i) {
+    magnitudes[channel(i)].push_back(std::abs(w(i)));
+  }
+  *scales = Tensor(DT_FLOAT, TensorShape({num_channels}));
+  auto scale = scales->vec<float>();
+  for (int64_t c = 0; c < num_channels; ++c) {
+    const float max_magnitude =
+        *std::max_element(magnitudes[c].begin(), magnitudes[c].end());
+    scale(c) = max_magnitude > 0 ? max_magnitude / 127.0f : 1.0f;
+  }
+
+  *quantized = Tensor(DT_QUINT8, weights.shape());
+  auto q = quantized->flat<quint8>();
+  std::vector<double> squared_error(num_channels, 0.0);
+  std::vector<double> squared_norm(num_channels, 0.0);
+  for (int64_t i = 0; i < w.size(); ++i) {
+    const int64_t c = channel(i);
+    const float value =
+        std::min(127.0f, std::max(-127.0f, std::round(w(i) / scale(c))));
+    q(i) = quint8(static_cast<uint8>(value + 128));
+    const double error = w(i) - value * scale(c);
+    squared_error[c] += error * error;
+    squared_norm[c] += static_cast<double>(w(i)) * w(i);
+  }
+
+  float max_relative_error = 0.0f;
+  for (int64_t c = 0; c < num_channels; ++c) {
+    std::vector<float>& channel_magnitudes = magnitudes[c];
+    const int64_t size = channel_magnitudes.size();
+    std::nth_element(channel_magnitudes.begin(),
+                     channel_magnitudes.begin() + size / 2,
+                     channel_magnitudes.end());
+    const double median = channel_magnitudes[size / 2];
+    // Mostly zero channels are compared to the RMS of their weights instead.
+    const double magnitude =
+        median > 0 ? median : std::sqrt(squared_norm[c] / size);
+    if (magnitude == 0) continue;
+    max_relative_error = std::max(
+        max_relative_error,
+        static_cast<float>(std::sqrt(squared_error[c] / size) / magnitude));
+  }
+  return max_relative_error;
+}
+
+// Rewrites the float ops on the int8 allow list whose weights are constant to
+// dynamic-range int8, e.g. for MatMul:
+//
+//   x -> Min/Max -> QuantizeV2 -> QuantizedMatMul -> Dequantize -> Mul
+//                      weights (int8 Const) -^           scales -^
+//
+// The ranges of the activations are computed at run time, the weights are
+// quantized once per output channel, and the per-channel scales are applied
+// to the dequantized result, which keeps the name of the original node.
+class AutoMixedPrecisionInt8Impl {
+ public:
+  AutoMixedPrecisionInt8Impl(
+      Cluster* cluster, const std::unordered_set<string>& nodes_to_preserve,
+      GraphDef* graph)
+      : virtual_placer_(GetDevices(cluster)),
+        nodes_to_preserve_(nodes_to_preserve),
+        graph_(graph) {}
+
+  Status Optimize();
+
+ private:
+  // A node to rewrite, with its weights quantized.
+  struct Candidate {
+    int index;
+    Tensor weights;
+    Tensor scales;
+  };
+
+  bool IsOnCpu(const NodeDef& node) const;
+  // Returns the nodes whose outputs are in the dynamic range of a deny op.
+  absl::flat_hash_set<const NodeDef*> FindDenyNodes(
+      const NodeMap& node_map) const;
+  bool IsSupportedConv2D(const NodeDef& node) const;
+  bool GetCandidate(const NodeMap& node_map,
+                    const absl::flat_hash_set<const NodeDef*>& deny_set,
+                    int index, Candidate* candidate) const;
+  void Rewrite(const Candidate& candidate);
+
+  VirtualPlacer virtual_placer_;
+  std::unordered_set<string> nodes_to_preserve_;
+  GraphDef* graph_;
+  gtl::FlatSet<string> int8_allowlist_;
+  gtl::FlatSet<string> int8_denylist_;
+  gtl::FlatSet<string> int8_inferlist_;
+  gtl::FlatSet<string> int8_clearlist_;
+  float max_weight_error_;
+};
+
+bool AutoMixedPrecisionInt8Impl::IsOnCpu(const NodeDef& node) const {
+  const string device_name =
+      node.device().empty() ? virtual_placer_.get_canonical_device_name(node)
+                            : node.device();
+  string not_used;
+  string device;
+  return DeviceNameUtils::SplitDeviceName(device_name, &not_used, &device) &&
+         absl::StrContains(absl::AsciiStrToLower(device),
+                           absl::AsciiStrToLower(DEVICE_CPU));
+}
+
+absl::flat_hash_set<const NodeDef*> AutoMixedPrecisionInt8Impl::FindDenyNodes(
+    const NodeMap& node_map) const {
+  absl::flat_hash_set<const NodeDef*> deny_set;
+  std::vector<const NodeDef*> queue;
+  for (const NodeDef& node : graph_->node()) {
+    if (int8_denylist_.count(node.op()) && deny_set.insert(&node).second) {
+      queue.push_back(&node);
+    }
+  }
+  while (!queue.empty()) {
+    const NodeDef* node = queue.back();
+    queue.pop_back();
+    for (const NodeDef* fanout : node_map.GetOutputs(node->name())) {
+      if ((int8_inferlist_.count(fanout->op()) ||
+           int8_clearlist_.count(fanout->op())) &&
+          deny_set.insert(fanout).second) {
+        queue.push_back(fanout);
+      }
+    }
+  }
+  return deny_set;
+}
+
+bool AutoMixedPrecisionInt8Impl::IsSupportedConv2D(const NodeDef& node) const {
+  // Mirrors the restrictions of the QuantizedConv2D kernel.
+  string data_format;
+  if (TryGetNodeAttr(node, "data_format", &data_format) &&
+      data_format != "NHWC") {
+    return false;
+  }
+  string padding;
+  if (!TryGetNodeAttr(node, "padding", &padding) ||
+      (padding != "SAME" && padding != "VALID")) {
+    return false;
+  }
+  std::vector<int32> strides;
+  if (!TryGetNodeAttr(node, "strides", &strides) || strides.size() != 4 ||
+      strides[0] != 1 || strides[3] != 1 || strides[1] != strides[2]) {
+    return false;
+  }
+  std::vector<int32> dilations;
+  if (TryGetNodeAttr(node, "dilations", &dilations)) {
+    for (int32 dilation : dilations) {
+      if (dilation != 1) return false;
+    }
+  }
+  return true;
+}
+
+bool AutoMixedPrecisionInt8Impl::GetCandidate(
+    const NodeMap& node_map,
+    const absl::flat_hash_set<const NodeDef*>& deny_set, int index,
+    Candidate* candidate) const {
+  const NodeDef& node = graph_->node(index);
+  if (!int8_allowlist_.count(node.op()) ||
+      nodes_to_preserve_.count(node.name())) {
+    return false;
+  }
+  DataType dtype;
+  if (!TryGetNodeAttr(node, "T", &dtype) || dtype != DT_FLOAT ||
+      node.input_size() < 2 || IsControlInput(node.input(1)) ||
+      !IsOnCpu(node)) {
+    return false;
+  }
+  if (node.op() == "Conv2D" && !IsSupportedConv2D(node)) return false;
+
+  // The activations must not be in the dynamic range of a deny op.
+  const NodeDef* activations = node_map.GetNode(node.input(0));
+  if (activations == nullptr || deny_set.count(activations)) {
+    VLOG(2) << "Keeping " << node.name()
+            << " in float since its input follows a denylist op";
+    return false;
+  }
+
+  // The weights must be constant.
+  const TensorId weights_id = ParseTensorName(node.input(1));
+  const NodeDef* weights_node = node_map.GetNode(node.input(1));
+  Tensor weights;
+  if (weights_node == nullptr || !IsConstant(*weights_node) ||
+      weights_id.index() != 0 || !weights_node->attr().count("value") ||
+      !weights.FromProto(weights_node->attr().at("value").tensor()) ||
+      weights.dtype() != DT_FLOAT || weights.NumElements() == 0) {
+    return false;
+  }
+  int channel_axis;
+  if (node.op() == "MatMul") {
+    if (weights.dims() != 2) return false;
+    bool transpose_b = false;
+    TryGetNodeAttr(node, "transpose_b", &transpose_b);
+    channel_axis = transpose_b ? 0 : 1;
+  } else {
+    if (weights.dims() != 4) return false;
+    channel_axis = 3;
+  }
+
+  candidate->index = index;
+  const float error = QuantizeWeightsPerChannel(
+      weights, channel_axis, &candidate->weights, &candidate->scales);
+  if (max_weight_error_ > 0 && error > max_weight_error_) {
+    VLOG(1) << "Keeping " << node.name() << " in float since the relative "
+            << "error of its int8 weights is " << error;
+    return false;
+  }
+  return true;
+}
+
+void AutoMixedPrecisionInt8Impl::Rewrite(const Candidate& candidate) {
+  const NodeDef node = graph_->node(candidate.index);
+  const string prefix = absl::StrCat(node.name(), "/", kSuffix, "Int8/");
+  const string frame_dependency = AsControlDependency(NodeName(node.input(0)));
+  auto add_node = [&](const string& name, const string& op,
+                      const std::vector<string>& inputs) {
+    NodeDef* new_node = graph_->add_node();
+    new_node->set_name(absl::StrCat(prefix, name));
+    new_node->set_op(op);
+    new_node->set_device(node.device());
+    for (const string& input : inputs) new_node->add_input(input);
+    return new_node->mutable_attr();
+  };
+  // Constants depend on the activations so that they are in the same frame.
+  auto add_const = [&](const string& name, const Tensor& value) {
+    auto* attr = add_node(name, "Const", {frame_dependency});
+    SetAttrValue(value.dtype(), &(*attr)["dtype"]);
+    value.AsProtoTensorContent((*attr)["value"].mutable_tensor());
+  };
+
+  const int rank = node.op() == "MatMul" ? 2 : 4;
+  Tensor axes(DT_INT32, TensorShape({rank}));
+  for (int i = 0; i < rank; ++i) axes.vec<int32>()(i) = i;
+  add_const("axes", axes);
+  add_const("weights", candidate.weights);
+  add_const("weights_min", Tensor(-128.0f));
+  add_const("weights_max", Tensor(127.0f));
+  add_const("scales", candidate.scales);
+
+  for (const char* reduction : {"Min", "Max"}) {
+    auto* attr = add_node(absl::AsciiStrToLower(reduction), reduction,
+                          {node.input(0), absl::StrCat(prefix, "axes")});
+    SetAttrValue(DT_FLOAT, &(*attr)["T"]);
+    SetAttrValue(DT_INT32, &(*attr)["Tidx"]);
+    SetAttrValue(false, &(*attr)["keep_dims"]);
+  }
+
+  const string quantized_input = absl::StrCat(prefix, "quantize");
+  {
+    auto* attr = add_node("quantize", "QuantizeV2",
+                          {node.input(0), absl::StrCat(prefix, "min"),
+                           absl::StrCat(prefix, "max")});
+    SetAttrValue(DT_QUINT8, &(*attr)["T"]);
+    SetAttrValue("MIN_FIRST", &(*attr)["mode"]);
+    SetAttrValue("HALF_AWAY_FROM_ZERO", &(*attr)["round_mode"]);
+    SetAttrValue(false, &(*attr)["narrow_range"]);
+    SetAttrValue(-1, &(*attr)["axis"]);
+    SetAttrValue(0.01f, &(*attr)["ensure_minimum_range"]);
+  }
+
+  const string weights = absl::StrCat(prefix, "weights");
+  const std::vector<string> quantized_inputs = {
+      quantized_input,
+      weights,
+      absl::StrCat(quantized_input, ":1"),
+      absl::StrCat(quantized_input, ":2"),
+      absl::StrCat(prefix, "weights_min"),
+      absl::StrCat(prefix, "weights_max")};
+  const string quantized_op = absl::StrCat(prefix, "quantized_", node.op());
+  if (node.op() == "MatMul") {
+    auto* attr = add_node(absl::StrCat("quantized_", node.op()),
+                          "QuantizedMatMul", quantized_inputs);
+    SetAttrValue(DT_QUINT8, &(*attr)["T1"]);
+    SetAttrValue(DT_QUINT8, &(*attr)["T2"]);
+    SetAttrValue(DT_QINT32, &(*attr)["Toutput"]);
+    SetAttrValue(DT_QUINT8, &(*attr)["Tactivation"]);
+    for (const char* transpose : {"transpose_a", "transpose_b"}) {
+      bool value = false;
+      TryGetNodeAttr(node, transpose, &value);
+      SetAttrValue(value, &(*attr)[transpose]);
+    }
+  } else {
+    auto* attr = add_node(absl::StrCat("quantized_", node.op()),
+                          "QuantizedConv2D", quantized_inputs);
+    SetAttrValue(DT_QUINT8, &(*attr)["Tinput"]);
+    SetAttrValue(DT_QUINT8, &(*attr)["Tfilter"]);
+    SetAttrValue(DT_QINT32, &(*attr)["out_type"]);
+    for (const char* copied : {"strides", "padding", "dilations"}) {
+      if (node.attr().count(copied)) (*attr)[copied] = node.attr().at(copied);
+    }
+  }
+
+  {
+    // The output range of the quantized ops is such that SCALED maps each
+    // int32 value to its product of the input and weight quantization steps.
+    auto* attr = add_node("dequantize", "Dequantize",
+                          {quantized_op, absl::StrCat(quantized_op, ":1"),
+                           absl::StrCat(quantized_op, ":2")});
+    SetAttrValue(DT_QINT32, &(*attr)["T"]);
+    SetAttrValue(DT_FLOAT, &(*attr)["dtype"]);
+    SetAttrValue("SCALED", &(*attr)["mode"]);
+    SetAttrValue(false, &(*attr)["narrow_range"]);
+    SetAttrValue(-1, &(*attr)["axis"]);
+  }
+
+  // The original node applies the per-channel scales, which broadcast along
+  // the last dimension of the output.
+  NodeDef* scaled = graph_->mutable_node(candidate.index);
+  scaled->set_op("Mul");
+  scaled->clear_input();
+  scaled->add_input(absl::StrCat(prefix, "dequantize"));
+  scaled->add_input(absl::StrCat(prefix, "scales"));
+  for (const string& input : node.input()) {
+    if (IsControlInput(input)) scaled->add_input(input);
+  }
+  scaled->clear_attr();
+  SetAttrValue(DT_FLOAT, &(*scaled->mutable_attr())["T"]);
+}
+
+Status AutoMixedPrecisionInt8Impl::Optimize() {
+  AutoMixedPrecisionListsInt8 lists;
+  int8_allowlist_ = lists.AllowList();
+  int8_denylist_ = lists.DenyList();
+  int8_inferlist_ = lists.InferList();
+  int8_clearlist_ = lists.ClearList();
+  TF_RETURN_IF_ERROR(ValidateLists(int8_allowlist_, int8_denylist_,
+                                   int8_inferlist_, int8_clearlist_));
+  TF_RETURN_IF_ERROR(
+      ReadFloatFromEnvVar("TF_AUTO_MIXED_PRECISION_INT8_MAX_WEIGHT_ERROR",
+                          kDefaultInt8MaxWeightError, &max_weight_error_));
+
+  // Find all the candidates before changing the graph, which invalidates the
+  // node map.
+  std::vector<Candidate> candidates;
+  {
+    NodeMap node_map(graph_);
+    const absl::flat_hash_set<const NodeDef*> deny_set =
+        FindDenyNodes(node_map);
+    for (int i = 0; i < graph_->node_size(); ++i) {
+      Candidate candidate;
+      if (GetCandidate(node_map, deny_set, i, &candidate)) {
+        candidates.push_back(std::move(candidate));
+      }
+    }
+  }
+  const int num_nodes_preop = graph_->node_size();
+  for (const Candidate& candidate : candidates) Rewrite(candidate);
+
+  LOG(INFO) << "Converted " << candidates.size() << "/" << num_nodes_preop
+            << " nodes to dynamic-range int8";
+  return absl::OkStatus();
+}
+
 int GetNumGPUs(const Cluster& cluster) {
   if (ShouldSimulateGpu()) {
     return 1;
@@ -2322,15 +2707,22 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
                  << " graph optimizer configured for BFloat16 on CPUs";
   }
 
-  // Optimize the output graph in-place.
-  AutoMixedPrecisionImpl optimizer(cluster, item.NodesToPreserve(), output,
-                                   item.id, mode_);
   if (item.id == "tf_graph") {
     LOG(INFO) << "Running " << name() << " graph optimizer";
   } else {
     VLOG(1) << "Running " << name() << " graph optimizer on " << item.id;
   }
-  Status status = optimizer.Optimize();
+  // Optimize the output graph in-place.
+  Status status;
+  if (mode_ == AutoMixedPrecisionMode::INT8_CPU) {
+    AutoMixedPrecisionInt8Impl optimizer(cluster, item.NodesToPreserve(),
+                                         output);
+    status = optimizer.Optimize();
+  } else {
+    AutoMixedPrecisionImpl optimizer(cluster, item.NodesToPreserve(), output,
+                                     item.id, mode_);
+    status = optimizer.Optimize();
+  }
   if (!status.ok()) {
     // Restore the original graph.
     *output = item.graph;
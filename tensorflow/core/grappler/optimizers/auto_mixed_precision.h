@@ -27,15 +27,19 @@ namespace grappler {
 // BF16: convert to bfloat16 on CPU
 // CPU: emulate float16 on CPU without changing operator kernel
 // FP16_CPU : convert to float16 on CPU
-enum class AutoMixedPrecisionMode { CUDA, BF16, CPU, FP16_CPU };
+// INT8_CPU: quantize MatMul and Conv2D with constant weights to dynamic-range
+//           int8 on CPU
+enum class AutoMixedPrecisionMode { CUDA, BF16, CPU, FP16_CPU, INT8_CPU };
 
-// Convert data types to float16 or bfloat16 where appropriate to improve
+// Convert data types to float16, bfloat16 or int8 where appropriate to improve
 // performance on GPUs or CPUs.
 class AutoMixedPrecision : public GraphOptimizer {
  public:
   // If 'mode' is CUDA, converts nodes to float16 on Nvidia GPUs. If BF16 or
   // FP16_CPU, converts nodes to bfloat16/fp16 on CPUs in order to take
-  // advantage of oneDNN performance improvements with bfloat16/fp16.
+  // advantage of oneDNN performance improvements with bfloat16/fp16. If
+  // INT8_CPU, rewrites MatMul and Conv2D nodes with constant weights on CPUs to
+  // the quantized kernels, for post-training serving.
   explicit AutoMixedPrecision(
       AutoMixedPrecisionMode mode = AutoMixedPrecisionMode::CUDA)
       : mode_(mode) {}
@@ -53,6 +57,8 @@ class AutoMixedPrecision : public GraphOptimizer {
       case AutoMixedPrecisionMode::FP16_CPU:
         // Note: using different name than GPU for ease of debugging.
         return "auto_mixed_precision_onednn_float16";
+      case AutoMixedPrecisionMode::INT8_CPU:
+        return "auto_mixed_precision_int8";
       default:
         LOG(FATAL) << "Invalid value for AutoMixedPrecisionMode: "  // Crash Ok
                    << static_cast<int>(mode_);
@@ -0,0 +1,182 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/clusters/single_machine.h"
+#include "tensorflow/core/grappler/graph_view.h"
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class AutoMixedPrecisionInt8Test : public GrapplerTest {
+ protected:
+  void SetUp() override {
+    virtual_cluster_.reset(new SingleMachine(/* timeout_s = */ 10, 1, 0));
+    TF_CHECK_OK(virtual_cluster_->Provision());
+  }
+  void TearDown() override { TF_CHECK_OK(virtual_cluster_->Shutdown()); }
+
+  GraphDef Optimize(const GrapplerItem& item) {
+    AutoMixedPrecision optimizer{AutoMixedPrecisionMode::INT8_CPU};
+    GraphDef output;
+    TF_CHECK_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+    VLOG(1) << output.DebugString();
+    return output;
+  }
+
+  // Checks that the fetched values of the original and the optimized graph are
+  // within `atol` of each other.
+  void ExpectClose(const GrapplerItem& item, const GraphDef& output,
+                   float atol) {
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+    auto tensors = EvaluateNodes(output, item.fetch);
+    ASSERT_EQ(tensors.size(), tensors_expected.size());
+    for (int i = 0; i < tensors.size(); ++i) {
+      test::ExpectClose(tensors_expected[i], tensors[i], atol, /*rtol=*/0.0);
+    }
+  }
+
+  std::unique_ptr<Cluster> virtual_cluster_;
+};
+
+TEST_F(AutoMixedPrecisionInt8Test, MatMul) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"),
+                            GenerateRandomTensor<DT_FLOAT>({8, 32}));
+  Output weights = ops::Const(s.WithOpName("weights"),
+                              GenerateRandomTensor<DT_FLOAT>({16, 32}));
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), input, weights,
+                              ops::MatMul::TransposeB(true));
+  Output fetch = ops::Identity(s.WithOpName("fetch"), matmul);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  GraphDef output = Optimize(item);
+
+  GraphView output_view(&output);
+  const NodeDef* scaled = output_view.GetNode("matmul");
+  ASSERT_NE(scaled, nullptr);
+  EXPECT_EQ(scaled->op(), "Mul");
+  int num_quantized = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "QuantizedMatMul") {
+      EXPECT_EQ(node.input(0), "matmul/AutoMixedPrecisionInt8/quantize");
+      EXPECT_TRUE(node.attr().at("transpose_b").b());
+      ++num_quantized;
+    }
+  }
+  EXPECT_EQ(num_quantized, 1);
+  // The products are sums of 32 products of values in [-1, 1].
+  ExpectClose(item, output, /*atol=*/0.25);
+}
+
+TEST_F(AutoMixedPrecisionInt8Test, Conv2D) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"),
+                            GenerateRandomTensor<DT_FLOAT>({1, 8, 8, 4}));
+  Output filter = ops::Const(s.WithOpName("filter"),
+                             GenerateRandomTensor<DT_FLOAT>({3, 3, 4, 8}));
+  Output conv = ops::Conv2D(s.WithOpName("conv"), input, filter, {1, 1, 1, 1},
+                            "SAME");
+  Output fetch = ops::Identity(s.WithOpName("fetch"), conv);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  GraphDef output = Optimize(item);
+
+  GraphView output_view(&output);
+  EXPECT_EQ(output_view.GetNode("conv")->op(), "Mul");
+  EXPECT_NE(output_view.GetNode("conv/AutoMixedPrecisionInt8/quantized_Conv2D"),
+            nullptr);
+  ExpectClose(item, output, /*atol=*/0.25);
+}
+
+TEST_F(AutoMixedPrecisionInt8Test, KeepsFloatAfterDenylistOp) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"),
+                            GenerateRandomTensor<DT_FLOAT>({8, 16}));
+  Output weights = ops::Const(s.WithOpName("weights"),
+                              GenerateRandomTensor<DT_FLOAT>({16, 16}));
+  Output deny = ops::Exp(s.WithOpName("deny"), input);
+  Output clear = ops::Relu(s.WithOpName("clear"), deny);
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), clear, weights);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), matmul);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  GraphDef output = Optimize(item);
+
+  EXPECT_EQ(output.node_size(), item.graph.node_size());
+  GraphView output_view(&output);
+  EXPECT_EQ(output_view.GetNode("matmul")->op(), "MatMul");
+}
+
+TEST_F(AutoMixedPrecisionInt8Test, KeepsFloatForBadWeightRange) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"),
+                            GenerateRandomTensor<DT_FLOAT>({4, 64}));
+  // A single outlier per channel leaves only a few int8 levels for the other
+  // weights, which have a large relative quantization error.
+  Tensor weights_t = GenerateRandomTensor<DT_FLOAT>({64, 4});
+  for (int j = 0; j < 4; ++j) weights_t.matrix<float>()(0, j) = 1000.0f;
+  Output weights = ops::Const(s.WithOpName("weights"), weights_t);
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), input, weights);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), matmul);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  GraphDef output = Optimize(item);
+
+  GraphView output_view(&output);
+  EXPECT_EQ(output_view.GetNode("matmul")->op(), "MatMul");
+}
+
+TEST_F(AutoMixedPrecisionInt8Test, KeepsFloatForVariableWeights) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"),
+                            GenerateRandomTensor<DT_FLOAT>({8, 16}));
+  Output weights = ops::Const(s.WithOpName("weights"),
+                              GenerateRandomTensor<DT_FLOAT>({16, 16}));
+  Output not_constant = ops::Relu(s.WithOpName("not_constant"), weights);
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), input, not_constant);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), matmul);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  GraphDef output = Optimize(item);
+
+  EXPECT_EQ(output.node_size(), item.graph.node_size());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
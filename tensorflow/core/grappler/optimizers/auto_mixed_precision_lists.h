@@ -593,6 +593,87 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
   }
 };
 
+// Lists for dynamic-range int8 quantization on CPU (INT8_CPU mode). Only ops
+// on the allow list are rewritten to int8: their constant weights are
+// quantized per output channel ahead of time, their activations are quantized
+// at run time, and their results are dequantized back to float. The other
+// lists only decide which allow ops must stay in float: an allow op is not
+// quantized if its activations come from a deny op, directly or through infer
+// and clear ops, since those activations have too large a dynamic range for
+// 8 bits.
+class AutoMixedPrecisionListsInt8 : public AutoMixedPrecisionLists {
+ public:
+  AutoMixedPrecisionListsInt8() {}
+
+  // Only ops which have a quantized CPU kernel should be added to the allow
+  // list.
+  gtl::FlatSet<string> AllowList() override {
+    auto list = gtl::FlatSet<string>{"Conv2D", "MatMul"};
+    UpdateList("ALLOWLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> InferList() override {
+    auto list = gtl::FlatSet<string>{
+        "Add",
+        "AddN",
+        "AddV2",
+        "BiasAdd",
+        "Mean",
+        "Mul",
+        "Prod",
+        "Sigmoid",
+        "Sub",
+        "Sum",
+        "Tanh",
+    };
+    UpdateList("INFERLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> DenyList() override {
+    auto list = gtl::FlatSet<string>{
+        "Exp",
+        "Expm1",
+        "Log",
+        "Pow",
+        "Reciprocal",
+        "RealDiv",
+        "Softplus",
+        "Square",
+    };
+    UpdateList("DENYLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> ClearList() override {
+    auto list = gtl::FlatSet<string>{
+        "Concat",
+        "ConcatV2",
+        "ExpandDims",
+        "Gather",
+        "GatherV2",
+        "Identity",
+        "IdentityN",
+        "MaxPool",
+        "Pad",
+        "PadV2",
+        "Relu",
+        "Relu6",
+        "Reshape",
+        "Slice",
+        "Snapshot",
+        "Squeeze",
+        "StopGradient",
+        "StridedSlice",
+        "Tile",
+        "Transpose",
+    };
+    UpdateList("CLEARLIST", &list);
+    return list;
+  }
+};
+
 }  // end namespace grappler
 }  // end namespace tensorflow
 
@@ -65,6 +65,9 @@ using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 
 // We only fold/materialize constants smaller than 100kB.
 const int64_t kMaxConstantSize = 100 * 1024;
+// Maximum growth of the graph by folding an op that only expands its inputs,
+// when constant_folding_max_growth_bytes is set.
+const int64_t kMaxExpansionGrowth = 1024;
 
 namespace {
 template <typename T>
@@ -193,21 +196,24 @@ float QuantizedTypeMaxAsFloat(DataType data_type) {
 ConstantFolding::ConstantFolding(RewriterConfig::Toggle opt_level,
                                  DeviceBase* cpu_device,
                                  bool disable_compressed_tensor_optimization,
-                                 bool fold_quantization_emulation)
+                                 bool fold_quantization_emulation,
+                                 int64_t max_growth_bytes)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
       disable_compressed_tensor_optimization_(
           disable_compressed_tensor_optimization),
-      fold_quantization_emulation_(fold_quantization_emulation) {
+      fold_quantization_emulation_(fold_quantization_emulation),
+      max_growth_bytes_(max_growth_bytes) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
 ConstantFolding::ConstantFolding(DeviceBase* cpu_device,
                                  bool disable_compressed_tensor_optimization,
-                                 bool fold_quantization_ops)
+                                 bool fold_quantization_ops,
+                                 int64_t max_growth_bytes)
     : ConstantFolding(RewriterConfig::ON, cpu_device,
                       disable_compressed_tensor_optimization,
-                      fold_quantization_ops) {}
+                      fold_quantization_ops, max_growth_bytes) {}
 
 // static
 string ConstantFolding::AddControlDependency(const string& input_name,
@@ -1420,6 +1426,43 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
       outputs->at(i) = NodeDef();
     }
   }
+  Status s = ChargeGrowthBudget(node, *outputs, total_inputs_size);
+  if (!s.ok()) {
+    *result_too_large = true;
+    return s;
+  }
+  return absl::OkStatus();
+}
+
+Status ConstantFolding::ChargeGrowthBudget(const NodeDef& node,
+                                           const std::vector<NodeDef>& outputs,
+                                           size_t total_inputs_size) {
+  if (max_growth_bytes_ <= 0) return absl::OkStatus();
+  int64_t outputs_size = 0;
+  for (const NodeDef& output : outputs) {
+    if (output.name().empty()) continue;
+    outputs_size += output.attr().at("value").tensor().ByteSizeLong();
+  }
+  const int64_t growth =
+      outputs_size - static_cast<int64_t>(total_inputs_size);
+  if (growth <= 0) return absl::OkStatus();
+  // These ops only copy or broadcast their inputs, folding them trades the
+  // copy at run time for a larger constant. Small ones are still folded since
+  // they often enable folding their fanout.
+  if ((IsFill(node) || IsBroadcastTo(node) || IsTile(node) ||
+       IsZerosLike(node) || IsOnesLike(node)) &&
+      growth > kMaxExpansionGrowth) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Not folding ", node.name(), ", it would grow the graph ",
+                     "by ", growth, " bytes without saving compute"));
+  }
+  if (growth_bytes_ + growth > max_growth_bytes_) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Not folding ", node.name(), ", it would grow the graph by ", growth,
+        " bytes and ", growth_bytes_, " of the ", max_growth_bytes_,
+        " bytes of constant_folding_max_growth_bytes are spent"));
+  }
+  growth_bytes_ += growth;
   return absl::OkStatus();
 }
 
@@ -4082,6 +4125,7 @@ Status ConstantFolding::Optimize(Cluster* cluster, const GrapplerItem& item,
   }
 
   has_fetch_ = !item.fetch.empty();
+  growth_bytes_ = 0;
   GrapplerItem item_to_optimize = item;
   GraphProperties properties(item_to_optimize);
   // It's possible to feed a placeholder with a tensor of any shape: make sure
@@ -4100,9 +4144,16 @@ Status ConstantFolding::Optimize(Cluster* cluster, const GrapplerItem& item,
   *optimized_graph = GraphDef();
   item_to_optimize.graph.Swap(optimized_graph);
   int64_t node_count;
+  bool first_pass = true;
 
   do {
+    if (!first_pass && DeadlineExceeded()) {
+      // Keep the graph folded by the completed passes.
+      set_stopped_at_deadline();
+      break;
+    }
     GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    first_pass = false;
     graph_modified_ = false;
     item_to_optimize.graph.Swap(optimized_graph);
     node_count = item_to_optimize.graph.node_size();
@@ -45,12 +45,15 @@ class ConstantFolding : public GraphOptimizer {
   static string AddControlDependency(const string& input_name, GraphDef* graph,
                                      NodeMap* node_map);
 
+  // `max_growth_bytes` is RewriterConfig's constant_folding_max_growth_bytes.
   explicit ConstantFolding(DeviceBase* cpu_device,
                            bool disable_compressed_tensor_optimization = false,
-                           bool fold_quantization_emulation = true);
+                           bool fold_quantization_emulation = true,
+                           int64_t max_growth_bytes = 0);
   ConstantFolding(RewriterConfig::Toggle opt_level, DeviceBase* cpu_device,
                   bool disable_compressed_tensor_optimization = false,
-                  bool fold_quantization_emulation = true);
+                  bool fold_quantization_emulation = true,
+                  int64_t max_growth_bytes = 0);
 
   ~ConstantFolding() override {}
 
@@ -94,6 +97,11 @@ class ConstantFolding : public GraphOptimizer {
 
   Status EvaluateOneFoldable(const NodeDef& node, std::vector<NodeDef>* outputs,
                              bool* result_too_large);
+  // Charges the growth of the graph by folding `node` into `outputs` to the
+  // growth budget, or returns an error if the fold does not fit.
+  Status ChargeGrowthBudget(const NodeDef& node,
+                            const std::vector<NodeDef>& outputs,
+                            size_t total_inputs_size);
 
   Status FoldMergeNode(NodeDef* node, GraphDef* output_graph);
   Status FoldNode(NodeDef* node, GraphDef* output_graph,
@@ -340,6 +348,9 @@ class ConstantFolding : public GraphOptimizer {
   bool graph_contains_assign_or_inplace_op_;
   bool disable_compressed_tensor_optimization_;
   bool fold_quantization_emulation_;
+  const int64_t max_growth_bytes_;
+  // Bytes by which folding grew the graph in the current Optimize call.
+  int64_t growth_bytes_ = 0;
 };
 
 }  // end namespace grappler
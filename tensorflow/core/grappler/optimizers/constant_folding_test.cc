@@ -2939,6 +2939,66 @@ TEST_F(ConstantFoldingTest, LargeConstantNoSizeIncrease) {
   EXPECT_LT(output.ByteSizeLong(), sizeof(float) * large_constant_size + 500);
 }
 
+TEST_F(ConstantFoldingTest, GrowthBudget) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  // Each range is encoded in about 1.9kB.
+  Output r1 = ops::Range(scope.WithOpName("r1"), 0, 1000, 1);
+  Output r2 = ops::Range(scope.WithOpName("r2"), 1, 1001, 1);
+  Output out1 = ops::Identity(scope.WithOpName("out1"), r1);
+  Output out2 = ops::Identity(scope.WithOpName("out2"), r2);
+
+  GrapplerItem item;
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+  item.fetch = {"out1", "out2"};
+
+  for (const int64_t max_growth_bytes : {0, 3000}) {
+    ConstantFolding optimizer(/*cpu_device=*/nullptr,
+                              /*disable_compressed_tensor_optimization=*/false,
+                              /*fold_quantization_emulation=*/true,
+                              max_growth_bytes);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+    int num_ranges = 0;
+    for (const NodeDef& node : output.node()) {
+      if (node.op() == "Range") ++num_ranges;
+    }
+    // Only one of the ranges fits in the budget.
+    EXPECT_EQ(num_ranges, max_growth_bytes == 0 ? 0 : 1) << max_growth_bytes;
+  }
+}
+
+TEST_F(ConstantFoldingTest, GrowthBudgetSkipsLargeExpansions) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  Output range = ops::Range(scope.WithOpName("range"), 0, 100, 1);
+  Output multiples = ops::Const(scope.WithOpName("multiples"), {100});
+  Output tile = ops::Tile(scope.WithOpName("tile"), range, multiples);
+  Output out = ops::Identity(scope.WithOpName("out"), tile);
+
+  GrapplerItem item;
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+  item.fetch = {"out"};
+
+  for (const int64_t max_growth_bytes : {0, 1 << 20}) {
+    ConstantFolding optimizer(/*cpu_device=*/nullptr,
+                              /*disable_compressed_tensor_optimization=*/false,
+                              /*fold_quantization_emulation=*/true,
+                              max_growth_bytes);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+    for (const NodeDef& node : output.node()) {
+      if (node.name() == "range") {
+        EXPECT_EQ(node.op(), "Const");
+      } else if (node.name() == "tile") {
+        // Tiling the range saves no compute, it is only folded without a
+        // budget.
+        EXPECT_EQ(node.op(), max_growth_bytes == 0 ? "Const" : "Tile");
+      }
+    }
+  }
+}
+
 TEST_F(ConstantFoldingTest, MaterializeBroadcastGradientArgs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a =
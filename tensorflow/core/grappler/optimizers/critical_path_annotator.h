@@ -0,0 +1,55 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CRITICAL_PATH_ANNOTATOR_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CRITICAL_PATH_ANNOTATOR_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// The attribute in which the estimated critical path slack of a node, in
+// nanoseconds, is passed to the executor.
+constexpr char kCriticalPathSlackAttr[] = "_critical_path_slack";
+
+// Annotates every node with the time by which its completion can be delayed
+// without delaying the whole graph, as predicted by the static schedule of the
+// graph on the cluster. The executor runs the ready nodes with the least slack
+// first, and keeps the nodes on the critical path on the current thread while
+// the other nodes are dispatched to the thread pool.
+//
+// The graph isn't otherwise changed. This must run after all the optimizers
+// which rewrite the graph, since the nodes they add aren't annotated.
+class CriticalPathAnnotator : public GraphOptimizer {
+ public:
+  CriticalPathAnnotator() {}
+  explicit CriticalPathAnnotator(RewriterConfig::Toggle opt_level) {}
+
+  ~CriticalPathAnnotator() override {}
+
+  string name() const override { return "critical_path_annotator"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CRITICAL_PATH_ANNOTATOR_H_
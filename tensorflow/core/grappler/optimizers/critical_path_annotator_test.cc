@@ -0,0 +1,96 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/critical_path_annotator.h"
+
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class CriticalPathAnnotatorTest : public ::testing::Test {
+ public:
+  std::unique_ptr<VirtualCluster> CreateVirtualCluster() const {
+    // Invent a CPU so that predictions remain the same from machine to machine.
+    DeviceProperties cpu_device;
+    cpu_device.set_type("CPU");
+    cpu_device.set_frequency(1000);
+    cpu_device.set_num_cores(4);
+    cpu_device.set_bandwidth(32);
+    cpu_device.set_l1_cache_size(32 * 1024);
+    cpu_device.set_l2_cache_size(256 * 1024);
+    cpu_device.set_l3_cache_size(4 * 1024 * 1024);
+    std::unordered_map<string, DeviceProperties> devices;
+    devices["/job:localhost/replica:0/task:0/cpu:0"] = cpu_device;
+    return std::unique_ptr<VirtualCluster>(new VirtualCluster(devices));
+  }
+};
+
+TEST_F(CriticalPathAnnotatorTest, AnnotatesSlack) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/cpu:0");
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {256, 256});
+  // A long branch of matrix multiplications, and a short element-wise one.
+  Output b = ops::MatMul(s.WithOpName("b"), a, a);
+  Output c = ops::MatMul(s.WithOpName("c"), b, a);
+  Output d = ops::Neg(s.WithOpName("d"), a);
+  Output e = ops::AddN(s.WithOpName("e"), {c, d});
+
+  GrapplerItem item;
+  item.fetch = {"e"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  CriticalPathAnnotator optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  std::unordered_map<string, int64_t> slacks;
+  for (const NodeDef& node : output.node()) {
+    ASSERT_EQ(1, node.attr().count(kCriticalPathSlackAttr)) << node.name();
+    slacks[node.name()] = node.attr().at(kCriticalPathSlackAttr).i();
+  }
+  for (const string& node : {"a", "b", "c", "e"}) {
+    EXPECT_EQ(0, slacks[node]) << node;
+  }
+  // The short branch can be delayed by the time of the second MatMul at least.
+  EXPECT_GT(slacks["d"], 0);
+}
+
+TEST_F(CriticalPathAnnotatorTest, RequiresCluster) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {2, 2});
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  CriticalPathAnnotator optimizer;
+  GraphDef output;
+  EXPECT_EQ(error::ABORTED,
+            optimizer.Optimize(/*cluster=*/nullptr, item, &output).code());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -68,7 +68,9 @@ const ConfigList& DefaultPluginConfigs() {
        {"auto_mixed_precision_onednn_bfloat16", RewriterConfig::ON},
        {"auto_mixed_precision_mkl", RewriterConfig::ON},
        {"auto_mixed_precision_cpu", RewriterConfig::ON},
+       {"auto_mixed_precision_int8", RewriterConfig::ON},
        {"pin_to_host_optimization", RewriterConfig::ON},
+       {"critical_path_scheduling", RewriterConfig::ON},
        {"layout_optimizer", RewriterConfig::ON},
        {"remapping", RewriterConfig::ON},
        {"loop_optimization", RewriterConfig::ON},
@@ -0,0 +1,625 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kBatchDataset[] = "BatchDataset";
+constexpr char kBatchDatasetV2[] = "BatchDatasetV2";
+constexpr char kChooseFastestBranchDataset[] = "ChooseFastestBranchDataset";
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapDatasetV2[] = "ParallelMapDatasetV2";
+
+// The number of batches produced by each branch of the
+// `ChooseFastestBranchDataset` when it is measured.
+constexpr int64_t kNumElementsPerBranch = 10;
+
+// Ops that compute each element of their output from the corresponding element
+// of their first input. Any other inputs must be unbatched scalars.
+bool IsUnaryOp(const string& op) {
+  static const auto* const kOps = new absl::flat_hash_set<string>({
+      "Abs",
+      "Cast",
+      "Ceil",
+      "Exp",
+      "Floor",
+      "Identity",
+      "Log",
+      "LogicalNot",
+      "Neg",
+      "RegexFullMatch",
+      "RegexReplace",
+      "Round",
+      "Sqrt",
+      "StaticRegexFullMatch",
+      "StaticRegexReplace",
+      "StringLength",
+      "StringLower",
+      "StringStrip",
+      "StringToHashBucket",
+      "StringToHashBucketFast",
+      "StringToHashBucketStrong",
+      "StringToNumber",
+      "StringUpper",
+  });
+  return kOps->contains(op);
+}
+
+// Ops that broadcast their inputs against each other elementwise. One input
+// may be batched if the others are unbatched scalars, which broadcast against
+// a batch the same way as against each of its elements.
+bool IsBinaryOp(const string& op) {
+  static const auto* const kOps = new absl::flat_hash_set<string>({
+      "Add",
+      "AddV2",
+      "Equal",
+      "Greater",
+      "GreaterEqual",
+      "Less",
+      "LessEqual",
+      "LogicalAnd",
+      "LogicalOr",
+      "Maximum",
+      "Minimum",
+      "Mul",
+      "NotEqual",
+      "RealDiv",
+      "Sub",
+  });
+  return kOps->contains(op);
+}
+
+// What is known about a value computed by the function being vectorized.
+struct ValueInfo {
+  // Whether the value has a leading batch dimension in the vectorized
+  // function.
+  bool batched = false;
+  // Whether the value (or each of its elements, if batched) is a scalar.
+  bool scalar = false;
+};
+
+Status GetConstValue(const FunctionDef& function, const string& input,
+                     Tensor* value) {
+  const string node_name =
+      function_utils::FunctionDefTensorDesc(input).node_name;
+  int index = function_utils::FindFunctionNodeWithName(node_name, function);
+  if (index == -1 || function.node_def(index).op() != "Const") {
+    return errors::Unimplemented("Input ", input, " is not a constant.");
+  }
+  if (!value->FromProto(function.node_def(index).attr().at("value").tensor())) {
+    return errors::InvalidArgument("Failed to parse constant ", node_name);
+  }
+  return absl::OkStatus();
+}
+
+// Adds a constant to `function` and returns the name of its output.
+string AddConst(const Tensor& value, FunctionDef* function) {
+  AttrValue value_attr;
+  value.AsProtoTensorContent(value_attr.mutable_tensor());
+  AttrValue dtype_attr;
+  dtype_attr.set_type(value.dtype());
+  NodeDef* node = function_utils::AddNode(
+      /*name=*/"", "Const", /*inputs=*/{},
+      {{"value", value_attr}, {"dtype", dtype_attr}}, function);
+  return strings::StrCat(node->name(), ":output:0");
+}
+
+// Rewrites `node` of `function`, some of whose inputs are batched, to compute
+// all elements of the batch at once, and sets `output` to what is known about
+// its outputs.
+Status VectorizeNode(const std::vector<ValueInfo>& inputs,
+                     FunctionDef* function, NodeDef* node, ValueInfo* output) {
+  const string& op = node->op();
+  output->batched = true;
+  if (IsUnaryOp(op)) {
+    if (!inputs[0].batched) {
+      return errors::Unimplemented("Only the first input of ", op,
+                                   " may be batched.");
+    }
+    for (int i = 1; i < inputs.size(); ++i) {
+      if (inputs[i].batched || !inputs[i].scalar) {
+        return errors::Unimplemented("Input ", i, " of ", op,
+                                     " is not an unbatched scalar.");
+      }
+    }
+    output->scalar = inputs[0].scalar;
+    return absl::OkStatus();
+  }
+  if (IsBinaryOp(op)) {
+    int num_batched = 0;
+    output->scalar = true;
+    for (const ValueInfo& input : inputs) {
+      if (input.batched) {
+        ++num_batched;
+      } else if (!input.scalar) {
+        return errors::Unimplemented("Unbatched inputs of ", op,
+                                     " must be scalars.");
+      }
+      output->scalar &= input.scalar;
+    }
+    if (num_batched > 1) {
+      // The per-element shapes of the inputs are not known, so broadcasting the
+      // batches against each other may not match broadcasting their elements.
+      return errors::Unimplemented("More than one input of ", op,
+                                   " is batched.");
+    }
+    return absl::OkStatus();
+  }
+  if (op == "DecodeRaw") {
+    // The batched output has a leading batch dimension, like the input. All
+    // elements must have the same size, as they would in the original `batch`.
+    return absl::OkStatus();
+  }
+  if (op == "Reshape") {
+    if (!inputs[0].batched || inputs[1].batched) {
+      return errors::Unimplemented("Only the tensor input of Reshape may be "
+                                   "batched.");
+    }
+    Tensor shape;
+    TF_RETURN_IF_ERROR(GetConstValue(*function, node->input(1), &shape));
+    if (shape.dims() != 1) {
+      return errors::Unimplemented("The shape of Reshape is not a vector.");
+    }
+    Tensor batched_shape(shape.dtype(), TensorShape({shape.NumElements() + 1}));
+    for (int64_t i = 0; i < shape.NumElements(); ++i) {
+      int64_t dim = shape.dtype() == DT_INT32 ? shape.vec<int32>()(i)
+                                              : shape.vec<int64_t>()(i);
+      if (dim < 0) {
+        return errors::Unimplemented("The shape of Reshape is not known.");
+      }
+      if (shape.dtype() == DT_INT32) {
+        batched_shape.vec<int32>()(i + 1) = dim;
+      } else {
+        batched_shape.vec<int64_t>()(i + 1) = dim;
+      }
+    }
+    if (shape.dtype() == DT_INT32) {
+      batched_shape.vec<int32>()(0) = -1;
+    } else {
+      batched_shape.vec<int64_t>()(0) = -1;
+    }
+    node->set_input(1, AddConst(batched_shape, function));
+    return absl::OkStatus();
+  }
+  if (op == "Gather" || op == "GatherV2") {
+    int64_t axis = 0;
+    if (op == "GatherV2") {
+      if (inputs[2].batched) {
+        return errors::Unimplemented("The axis of GatherV2 is batched.");
+      }
+      Tensor axis_value;
+      TF_RETURN_IF_ERROR(GetConstValue(*function, node->input(2), &axis_value));
+      axis = axis_value.dtype() == DT_INT32 ? axis_value.scalar<int32>()()
+                                            : axis_value.scalar<int64_t>()();
+      auto it = node->attr().find("batch_dims");
+      if (it != node->attr().end() && it->second.i() != 0) {
+        return errors::Unimplemented("GatherV2 with batch_dims is not "
+                                     "supported.");
+      }
+    }
+    const bool params_batched = inputs[0].batched;
+    const bool indices_batched = inputs[1].batched;
+    int64_t batched_axis = axis < 0 ? axis : axis + 1;
+    int64_t batch_dims = 0;
+    if (!params_batched) {
+      // The batch dimension of the indices becomes the leading dimension of
+      // the output only if it replaces the leading dimension of the params.
+      if (axis != 0) {
+        return errors::Unimplemented("Gather with batched indices requires "
+                                     "axis 0.");
+      }
+      batched_axis = 0;
+    } else if (indices_batched) {
+      batch_dims = 1;
+    }
+    // Gather always gathers along axis 0, so rewrite it to GatherV2.
+    node->set_op("GatherV2");
+    node->mutable_attr()->erase("validate_indices");
+    if (node->input_size() == 3) {
+      node->mutable_input()->RemoveLast();
+    }
+    node->add_input(AddConst(Tensor(static_cast<int32>(batched_axis)),
+                             function));
+    (*node->mutable_attr())["Taxis"].set_type(DT_INT32);
+    (*node->mutable_attr())["batch_dims"].set_i(batch_dims);
+    return absl::OkStatus();
+  }
+  if (op == "ParseExample" || op == "ParseExampleV2") {
+    if (!inputs[0].batched || !inputs[0].scalar) {
+      return errors::Unimplemented(op, " requires the batched input to be "
+                                       "the scalar serialized examples.");
+    }
+    for (int i = 1; i < inputs.size(); ++i) {
+      if (inputs[i].batched) {
+        return errors::Unimplemented("Only the serialized input of ", op,
+                                     " may be batched.");
+      }
+    }
+    // Sparse and ragged outputs gain a batch dimension in their indices and
+    // row splits rather than a leading dimension, so only dense features can
+    // be parsed in batch.
+    const auto& attr = node->attr();
+    if ((op == "ParseExample" && attr.at("Nsparse").i() != 0) ||
+        (op == "ParseExampleV2" &&
+         (attr.at("num_sparse").i() != 0 ||
+          attr.at("ragged_value_types").list().type_size() != 0))) {
+      return errors::Unimplemented(op, " with sparse or ragged features is "
+                                       "not supported.");
+    }
+    // Variable-length dense features are padded to the longest element of
+    // the batch, which would change their shapes.
+    for (const auto& shape : attr.at("dense_shapes").list().shape()) {
+      for (const auto& dim : shape.dim()) {
+        if (dim.size() < 0) {
+          return errors::Unimplemented(op, " with variable-length dense "
+                                           "features is not supported.");
+        }
+      }
+    }
+    return absl::OkStatus();
+  }
+  return errors::Unimplemented("Op ", op, " has no batched form.");
+}
+
+// Sets `vectorized` to a version of `function` that takes batches of the
+// elements as its first `scalar_args.size()` arguments, and returns batches of
+// the outputs. `scalar_args` tells which elements are scalars. The remaining
+// (captured) arguments are unbatched.
+Status VectorizeFunction(const FunctionDef& function,
+                         const std::vector<bool>& scalar_args,
+                         FunctionDef* vectorized) {
+  *vectorized = function;
+  absl::flat_hash_map<string, ValueInfo> values;
+  const auto& args = function.signature().input_arg();
+  for (int i = 0; i < args.size(); ++i) {
+    ValueInfo& info = values[args[i].name()];
+    if (i < scalar_args.size()) {
+      info.batched = true;
+      info.scalar = scalar_args[i];
+    }
+  }
+
+  // The nodes of a function are not sorted, so vectorize each node once all
+  // of its inputs have been.
+  std::vector<NodeDef*> pending;
+  for (NodeDef& node : *vectorized->mutable_node_def()) {
+    pending.push_back(&node);
+  }
+  while (!pending.empty()) {
+    std::vector<NodeDef*> remaining;
+    for (NodeDef* node : pending) {
+      std::vector<ValueInfo> inputs;
+      bool ready = true;
+      bool any_batched = false;
+      for (const string& input : node->input()) {
+        if (IsControlInput(input)) {
+          return errors::Unimplemented("Node ", node->name(),
+                                       " has a control input.");
+        }
+        auto it =
+            values.find(function_utils::FunctionDefTensorDesc(input).node_name);
+        if (it == values.end()) {
+          ready = false;
+          break;
+        }
+        inputs.push_back(it->second);
+        any_batched |= it->second.batched;
+      }
+      if (!ready) {
+        remaining.push_back(node);
+        continue;
+      }
+      ValueInfo output;
+      if (any_batched) {
+        TF_RETURN_IF_ERROR(VectorizeNode(inputs, vectorized, node, &output));
+      } else if (node->op() == "Const") {
+        const auto& shape = node->attr().at("value").tensor().tensor_shape();
+        output.scalar = !shape.unknown_rank() && shape.dim_size() == 0;
+      } else if (IsUnaryOp(node->op()) || IsBinaryOp(node->op())) {
+        output.scalar = true;
+        for (const ValueInfo& input : inputs) output.scalar &= input.scalar;
+      }
+      // The shapes inferred for the original function no longer hold.
+      node->mutable_attr()->erase("_output_shapes");
+      values[node->name()] = output;
+    }
+    if (remaining.size() == pending.size()) {
+      return errors::InvalidArgument("Function ", function.signature().name(),
+                                     " has a cycle or an unknown input.");
+    }
+    pending = std::move(remaining);
+  }
+
+  for (const auto& [output_name, tensor] : vectorized->ret()) {
+    const ValueInfo& info =
+        values[function_utils::FunctionDefTensorDesc(tensor).node_name];
+    if (!info.batched) {
+      return errors::Unimplemented("Output ", output_name,
+                                   " does not depend on the elements.");
+    }
+  }
+  for (auto& [index, arg_attr] : *vectorized->mutable_arg_attr()) {
+    arg_attr.mutable_attr()->erase("_output_shapes");
+  }
+  return absl::OkStatus();
+}
+
+// Returns `shape` with a leading dimension of size `batch_dim`.
+TensorShapeProto BatchedShape(const TensorShapeProto& shape,
+                              int64_t batch_dim) {
+  if (shape.unknown_rank()) return shape;
+  TensorShapeProto batched;
+  batched.add_dim()->set_size(batch_dim);
+  for (const auto& dim : shape.dim()) {
+    *batched.add_dim() = dim;
+  }
+  return batched;
+}
+
+// Creates a branch function for `ChooseFastestBranchDataset`, which applies
+// `map_node` and `batch_node` to its input dataset. If `vectorized_map_node` is
+// set, the branch batches the input first and applies it instead.
+//
+// The branch takes the input dataset, followed by the captured inputs of the
+// map function, the batch size, drop remainder, and the number of parallel
+// calls of a parallel map.
+FunctionDef MakeBranch(const NodeDef& map_node, const NodeDef& batch_node,
+                       const NodeDef* vectorized_map_node,
+                       const DataTypeVector& other_argument_types,
+                       const FunctionDefLibrary& library) {
+  FunctionDef branch;
+  graph_utils::SetUniqueGraphFunctionName(
+      vectorized_map_node ? "vectorized_branch" : "branch", &library, &branch);
+  function_utils::AddFunctionInput("input_dataset", &branch, DT_VARIANT);
+  std::vector<string> args;
+  for (int i = 0; i < other_argument_types.size(); ++i) {
+    args.push_back(strings::StrCat("arg_", i));
+    function_utils::AddFunctionInput(args.back(), &branch,
+                                     other_argument_types[i]);
+  }
+  const int num_captured = map_node.attr().at("Targuments").list().type_size();
+  const string& batch_size = args[num_captured];
+  const string& drop_remainder = args[num_captured + 1];
+
+  auto add_map = [&](const NodeDef& node, const string& input) {
+    NodeDef* map = branch.add_node_def();
+    *map = node;
+    map->set_name("map");
+    map->clear_input();
+    map->add_input(input);
+    for (int i = 0; i < num_captured; ++i) {
+      map->add_input(args[i]);
+    }
+    if (node.op() == kParallelMapDatasetV2) {
+      map->add_input(args.back());
+    }
+    return strings::StrCat(map->name(), ":handle:0");
+  };
+  auto add_batch = [&](const string& input) {
+    NodeDef* batch = branch.add_node_def();
+    batch->set_name("batch");
+    batch->set_op(kBatchDatasetV2);
+    batch->add_input(input);
+    batch->add_input(batch_size);
+    batch->add_input(drop_remainder);
+    if (batch_node.attr().contains("parallel_copy")) {
+      graph_utils::CopyAttribute("parallel_copy", batch_node, batch);
+    }
+    return batch;
+  };
+
+  string output;
+  if (vectorized_map_node) {
+    NodeDef* batch = add_batch("input_dataset");
+    // The batches of the input, which are the elements of the vectorized map.
+    const auto& batch_shapes = batch_node.attr().at("output_shapes").list();
+    int64_t batch_dim = -1;
+    if (batch_shapes.shape_size() > 0 &&
+        !batch_shapes.shape(0).unknown_rank() &&
+        batch_shapes.shape(0).dim_size() > 0) {
+      batch_dim = batch_shapes.shape(0).dim(0).size();
+    }
+    (*batch->mutable_attr())["output_types"] =
+        vectorized_map_node->attr().at("input_types");
+    auto* shapes =
+        (*batch->mutable_attr())["output_shapes"].mutable_list();
+    for (const auto& shape :
+         vectorized_map_node->attr().at("input_shapes").list().shape()) {
+      *shapes->add_shape() = BatchedShape(shape, batch_dim);
+    }
+    NodeDef vectorized_map = *vectorized_map_node;
+    vectorized_map.mutable_attr()->erase("input_types");
+    vectorized_map.mutable_attr()->erase("input_shapes");
+    output =
+        add_map(vectorized_map, strings::StrCat(batch->name(), ":handle:0"));
+  } else {
+    const string map_output = add_map(map_node, "input_dataset");
+    NodeDef* batch = add_batch(map_output);
+    graph_utils::CopyShapesAndTypesAttrs(batch_node, batch);
+    output = strings::StrCat(batch->name(), ":handle:0");
+  }
+  function_utils::AddFunctionOutputWithUniqueName("handle", output, &branch,
+                                                  DT_VARIANT);
+  return branch;
+}
+
+}  // namespace
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != kBatchDataset && node.op() != kBatchDatasetV2) {
+      continue;
+    }
+    const NodeDef& batch_node = node;
+    NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (map_node->op() != kMapDataset &&
+        map_node->op() != kParallelMapDatasetV2) {
+      continue;
+    }
+    if (HasControlInputs(batch_node) || HasControlInputs(*map_node)) {
+      continue;
+    }
+    const NodeDef* input_node = graph_utils::GetInputNode(*map_node, graph);
+    if (input_node == nullptr ||
+        !input_node->attr().contains("output_shapes") ||
+        !input_node->attr().contains("output_types")) {
+      continue;
+    }
+    const FunctionDef* function =
+        function_library.Find(map_node->attr().at("f").func().name());
+    if (function == nullptr ||
+        function_utils::IsFunctionStateful(function_library, *function)) {
+      continue;
+    }
+
+    std::vector<bool> scalar_args;
+    for (const auto& shape :
+         input_node->attr().at("output_shapes").list().shape()) {
+      scalar_args.push_back(!shape.unknown_rank() && shape.dim_size() == 0);
+    }
+    FunctionDef vectorized_function;
+    Status s = VectorizeFunction(*function, scalar_args, &vectorized_function);
+    if (!s.ok()) {
+      VLOG(2) << "Could not vectorize " << function->signature().name() << ": "
+              << s;
+      continue;
+    }
+    graph_utils::SetUniqueGraphFunctionName(
+        strings::StrCat("vectorized_", function->signature().name()),
+        output->mutable_library(), &vectorized_function);
+    *output->mutable_library()->add_function() = vectorized_function;
+
+    // The map of the vectorized branch, with the types and shapes of its input
+    // elements in the `input_types` and `input_shapes` attributes.
+    NodeDef vectorized_map_node = *map_node;
+    auto* f = (*vectorized_map_node.mutable_attr())["f"].mutable_func();
+    f->set_name(vectorized_function.signature().name());
+    graph_utils::CopyShapesAndTypesAttrs(batch_node, &vectorized_map_node);
+    (*vectorized_map_node.mutable_attr())["input_types"] =
+        input_node->attr().at("output_types");
+    (*vectorized_map_node.mutable_attr())["input_shapes"] =
+        input_node->attr().at("output_shapes");
+
+    // The other arguments of each branch.
+    std::vector<string> other_arguments;
+    DataTypeVector other_argument_types;
+    const auto& captured_types = map_node->attr().at("Targuments").list();
+    for (int i = 0; i < captured_types.type_size(); ++i) {
+      other_arguments.push_back(map_node->input(i + 1));
+      other_argument_types.push_back(captured_types.type(i));
+    }
+    other_arguments.push_back(batch_node.input(1));
+    other_argument_types.push_back(DT_INT64);
+    if (batch_node.op() == kBatchDatasetV2) {
+      other_arguments.push_back(batch_node.input(2));
+    } else {
+      other_arguments.push_back(
+          graph_utils::AddScalarConstNode<bool>(false, &graph)->name());
+    }
+    other_argument_types.push_back(DT_BOOL);
+    if (map_node->op() == kParallelMapDatasetV2) {
+      other_arguments.push_back(map_node->input(map_node->input_size() - 1));
+      other_argument_types.push_back(DT_INT64);
+    }
+
+    FunctionDef branch = MakeBranch(*map_node, batch_node,
+                                    /*vectorized_map_node=*/nullptr,
+                                    other_argument_types, output->library());
+    *output->mutable_library()->add_function() = branch;
+    FunctionDef vectorized_branch =
+        MakeBranch(*map_node, batch_node, &vectorized_map_node,
+                   other_argument_types, output->library());
+    *output->mutable_library()->add_function() = vectorized_branch;
+
+    NodeDef choose_node;
+    choose_node.set_op(kChooseFastestBranchDataset);
+    graph_utils::SetUniqueGraphNodeName(kChooseFastestBranchDataset,
+                                        graph.graph(), &choose_node);
+    choose_node.add_input(map_node->input(0));
+    // Each output is one batch of `batch_size` input elements.
+    choose_node.add_input(batch_node.input(1));
+    choose_node.add_input(
+        graph_utils::AddScalarConstNode<int64_t>(1, &graph)->name());
+    AttrValue targuments;
+    for (int i = 0; i < 2; ++i) {
+      for (int j = 0; j < other_arguments.size(); ++j) {
+        choose_node.add_input(other_arguments[j]);
+        targuments.mutable_list()->add_type(other_argument_types[j]);
+      }
+    }
+    auto* attr = choose_node.mutable_attr();
+    (*attr)["Targuments"] = targuments;
+    (*attr)["num_elements_per_branch"].set_i(kNumElementsPerBranch);
+    for (const FunctionDef* fn : {&branch, &vectorized_branch}) {
+      (*attr)["branches"].mutable_list()->add_func()->set_name(
+          fn->signature().name());
+      (*attr)["other_arguments_lengths"].mutable_list()->add_i(
+          other_arguments.size());
+    }
+    graph_utils::CopyShapesAndTypesAttrs(batch_node, &choose_node);
+
+    NodeDef* new_node = graph.AddNode(std::move(choose_node));
+    TF_RETURN_IF_ERROR(
+        graph.UpdateFanouts(batch_node.name(), new_node->name()));
+    // The map stays in the graph for its other consumers, if any.
+    if (graph.NumFanouts(*map_node, /*include_controlled_nodes=*/true) == 1) {
+      nodes_to_delete.insert(map_node->name());
+    }
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return absl::OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
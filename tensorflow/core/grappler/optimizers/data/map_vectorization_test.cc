@@ -0,0 +1,195 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeBatchV2Node;
+using graph_tests_utils::MakeMapNode;
+using test::function::NDef;
+
+// Returns a graph that maps `function_name` over a range of elements of shape
+// `element_shape` and batches the results.
+GrapplerItem MakeMapAndBatchItem(StringPiece function_name,
+                                 const TensorShape& element_shape,
+                                 const std::vector<FunctionDef>& library) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT32}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT32}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT32}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"},
+            {{"output_shapes", absl::Span<const TensorShape>{element_shape}},
+             {"output_types", absl::Span<const DataType>{DT_INT64}}}),
+       MakeMapNode("map", "range", function_name),
+       NDef("batch_size", "Const", {}, {{"value", 5}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", false}, {"dtype", DT_BOOL}}),
+       MakeBatchV2Node("batch", "map", "batch_size", "drop_remainder",
+                       /*parallel_copy=*/false),
+       NDef("Sink", "Identity", {"batch"}, {})},
+      library);
+  item.fetch.push_back("Sink");
+  return item;
+}
+
+const FunctionDef* FindVectorizedFunction(const GraphDef& graph) {
+  for (const FunctionDef& function : graph.library().function()) {
+    if (absl::StartsWith(function.signature().name(), "vectorized_")) {
+      return &function;
+    }
+  }
+  return nullptr;
+}
+
+TEST(MapVectorizationTest, VectorizesElementwiseFunction) {
+  GrapplerItem item = MakeMapAndBatchItem("XTimesTwo", TensorShape({}),
+                                          {test::function::XTimesTwo()});
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  const int index =
+      graph_utils::FindGraphNodeWithOp("ChooseFastestBranchDataset", output);
+  ASSERT_GE(index, 0);
+  const NodeDef& choose_node = output.node(index);
+  EXPECT_EQ(choose_node.input(0), "range");
+  EXPECT_EQ(choose_node.input(1), "batch_size");
+  EXPECT_EQ(choose_node.attr().at("branches").list().func_size(), 2);
+  const NodeDef& sink =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  EXPECT_EQ(sink.input(0), choose_node.name());
+
+  const FunctionDef* vectorized = FindVectorizedFunction(output);
+  ASSERT_NE(vectorized, nullptr);
+  EXPECT_EQ(vectorized->signature().input_arg_size(), 1);
+}
+
+TEST(MapVectorizationTest, RewritesReshapeShape) {
+  FunctionDef reshape_function = FunctionDefHelper::Create(
+      "ReshapeTo2x2", {"x: int64"}, {"y: int64"}, {},
+      {{{"shape"},
+        "Const",
+        {},
+        {{"value", test::AsTensor<int32>({2, 2})}, {"dtype", DT_INT32}}},
+       {{"reshaped"},
+        "Reshape",
+        {"x", "shape:output:0"},
+        {{"T", DT_INT64}, {"Tshape", DT_INT32}}}},
+      {{"y", "reshaped:output:0"}});
+  GrapplerItem item =
+      MakeMapAndBatchItem("ReshapeTo2x2", TensorShape({4}), {reshape_function});
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const FunctionDef* vectorized = FindVectorizedFunction(output);
+  ASSERT_NE(vectorized, nullptr);
+  const NodeDef& reshape = vectorized->node_def(
+      function_utils::FindFunctionNodeWithName("reshaped", *vectorized));
+  const NodeDef& shape =
+      vectorized->node_def(function_utils::FindFunctionNodeWithName(
+          function_utils::FunctionDefTensorDesc(reshape.input(1)).node_name,
+          *vectorized));
+  Tensor shape_value;
+  ASSERT_TRUE(shape_value.FromProto(shape.attr().at("value").tensor()));
+  test::ExpectTensorEqual<int32>(shape_value,
+                                 test::AsTensor<int32>({-1, 2, 2}));
+}
+
+TEST(MapVectorizationTest, KeepsMapWithOtherConsumers) {
+  GrapplerItem item = MakeMapAndBatchItem("XTimesTwo", TensorShape({}),
+                                          {test::function::XTimesTwo()});
+  *item.graph.add_node() = NDef("OtherSink", "Identity", {"map"}, {});
+  item.fetch.push_back("OtherSink");
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  EXPECT_TRUE(
+      graph_utils::ContainsNodeWithOp("ChooseFastestBranchDataset", output));
+  ASSERT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  const NodeDef& other_sink =
+      output.node(graph_utils::FindGraphNodeWithName("OtherSink", output));
+  EXPECT_EQ(other_sink.input(0), "map");
+}
+
+class UnsupportedFunction : public ::testing::TestWithParam<string> {};
+
+TEST_P(UnsupportedFunction, MapVectorizationTest) {
+  GrapplerItem item = MakeMapAndBatchItem(
+      GetParam(), TensorShape({}),
+      {test::function::XTimesTwo(), test::function::XTimesFour(),
+       test::function::RandomUniform()});
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  EXPECT_FALSE(
+      graph_utils::ContainsNodeWithOp("ChooseFastestBranchDataset", output));
+  EXPECT_EQ(FindVectorizedFunction(output), nullptr);
+}
+
+// A stateful function, and one that calls another function.
+INSTANTIATE_TEST_SUITE_P(Test, UnsupportedFunction,
+                         ::testing::Values("RandomUniformFn", "XTimesFour"));
+
+TEST(MapVectorizationTest, MapWithoutBatch) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT32}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT32}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT32}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"},
+            {{"output_shapes", absl::Span<const TensorShape>{{}}},
+             {"output_types", absl::Span<const DataType>{DT_INT64}}}),
+       MakeMapNode("map", "range", "XTimesTwo"),
+       NDef("Sink", "Identity", {"map"}, {})},
+      // FunctionLib
+      {
+          test::function::XTimesTwo(),
+      });
+  item.fetch.push_back("Sink");
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_EQ(FindVectorizedFunction(output), nullptr);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
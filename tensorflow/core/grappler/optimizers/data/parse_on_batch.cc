@@ -0,0 +1,128 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/parse_on_batch.h"
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kParseExampleV2[] = "ParseExampleDatasetV2";
+constexpr char kBatch[] = "BatchDataset";
+constexpr char kBatchV2[] = "BatchDatasetV2";
+constexpr char kBatchSizeAttr[] = "batch_size";
+constexpr char kDropRemainderAttr[] = "drop_remainder";
+
+// Returns whether the elements batched by `batch_node` are scalar strings.
+bool BatchesScalarStrings(const NodeDef& batch_node) {
+  auto types = batch_node.attr().find("output_types");
+  auto shapes = batch_node.attr().find("output_shapes");
+  if (types == batch_node.attr().end() || shapes == batch_node.attr().end() ||
+      types->second.list().type_size() != 1 ||
+      types->second.list().type(0) != DT_STRING ||
+      shapes->second.list().shape_size() != 1) {
+    return false;
+  }
+  const TensorShapeProto& shape = shapes->second.list().shape(0);
+  return !shape.unknown_rank() && shape.dim_size() == 1;
+}
+
+}  // namespace
+
+Status ParseOnBatch::OptimizeAndCollectStats(Cluster* cluster,
+                                             const GrapplerItem& item,
+                                             GraphDef* output,
+                                             OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != kParseExampleV2) {
+      continue;
+    }
+    const NodeDef& parse_node = node;
+    auto batch_size_attr = parse_node.attr().find(kBatchSizeAttr);
+    if (batch_size_attr != parse_node.attr().end() &&
+        batch_size_attr->second.i() > 0) {
+      continue;
+    }
+    NodeDef* batch_node = graph_utils::GetInputNode(parse_node, graph);
+    if (batch_node == nullptr ||
+        (batch_node->op() != kBatch && batch_node->op() != kBatchV2) ||
+        !BatchesScalarStrings(*batch_node) ||
+        graph.NumFanouts(*batch_node, /*include_controlled_nodes=*/true) != 1) {
+      continue;
+    }
+    // The batch size and `drop_remainder` must be constants, as they become
+    // attributes of the fused node.
+    int64_t batch_size;
+    NodeDef* batch_size_node = graph_utils::GetInputNode(*batch_node, graph, 1);
+    if (batch_size_node == nullptr ||
+        !graph_utils::GetScalarConstNodeValue(*batch_size_node, &batch_size)
+             .ok() ||
+        batch_size <= 0) {
+      continue;
+    }
+    bool drop_remainder = false;
+    if (batch_node->op() == kBatchV2) {
+      NodeDef* drop_remainder_node =
+          graph_utils::GetInputNode(*batch_node, graph, 2);
+      if (drop_remainder_node == nullptr ||
+          !graph_utils::GetScalarConstNodeValue(*drop_remainder_node,
+                                                &drop_remainder)
+               .ok()) {
+        continue;
+      }
+    }
+
+    NodeDef fused_node = parse_node;
+    graph_utils::SetUniqueGraphNodeName("parse_on_batch", graph.graph(),
+                                        &fused_node);
+    fused_node.set_input(0, batch_node->input(0));
+    SetAttrValue(batch_size, &(*fused_node.mutable_attr())[kBatchSizeAttr]);
+    SetAttrValue(drop_remainder,
+                 &(*fused_node.mutable_attr())[kDropRemainderAttr]);
+    NodeDef* new_node = graph.AddNode(std::move(fused_node));
+    TF_RETURN_IF_ERROR(
+        graph.UpdateFanouts(parse_node.name(), new_node->name()));
+
+    nodes_to_delete.insert(parse_node.name());
+    nodes_to_delete.insert(batch_node->name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return absl::OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(ParseOnBatch, "parse_on_batch");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,114 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/parse_on_batch.h"
+
+#include <cstdint>
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+NodeDef MakeBatchNode(StringPiece batch_size_node) {
+  return NDef("batch", "BatchDatasetV2",
+              {"range", string(batch_size_node), "drop_remainder"},
+              {{"parallel_copy", false},
+               {"output_shapes", absl::Span<const PartialTensorShape>{
+                                     PartialTensorShape({-1})}},
+               {"output_types", absl::Span<const DataType>{DT_STRING}}});
+}
+
+NodeDef MakeParseNode() {
+  return NDef("parse", "ParseExampleDatasetV2",
+              {"batch", "num_parallel_calls"},
+              {{"output_shapes", absl::Span<const TensorShape>{}},
+               {"output_types", absl::Span<const DataType>{}},
+               {"deterministic", "default"}});
+}
+
+GrapplerItem MakeItem(StringPiece batch_size_node) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT32}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT32}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT32}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"}, {}),
+       NDef("batch_size", "Const", {},
+            {{"value", test::AsScalar<int64_t>(32)}, {"dtype", DT_INT64}}),
+       NDef("placeholder", "Placeholder", {}, {{"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", test::AsScalar<bool>(true)}, {"dtype", DT_BOOL}}),
+       NDef("num_parallel_calls", "Const", {},
+            {{"value", test::AsScalar<int64_t>(4)}, {"dtype", DT_INT64}}),
+       MakeBatchNode(batch_size_node), MakeParseNode(),
+       NDef("Sink", "Identity", {"parse"}, {})},
+      {});
+  return item;
+}
+
+TEST(ParseOnBatchTest, FusesBatchIntoParse) {
+  GrapplerItem item = MakeItem("batch_size");
+  ParseOnBatch optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp("BatchDatasetV2", output));
+  int index = graph_utils::FindGraphNodeWithOp("ParseExampleDatasetV2", output);
+  ASSERT_GE(index, 0);
+  const NodeDef& parse_node = output.node(index);
+  EXPECT_EQ(parse_node.input(0), "range");
+  EXPECT_EQ(parse_node.input(1), "num_parallel_calls");
+  EXPECT_EQ(parse_node.attr().at("batch_size").i(), 32);
+  EXPECT_TRUE(parse_node.attr().at("drop_remainder").b());
+  const NodeDef& sink_node =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  EXPECT_EQ(sink_node.input(0), parse_node.name());
+}
+
+TEST(ParseOnBatchTest, DoesNotFuseNonConstantBatchSize) {
+  GrapplerItem item = MakeItem("placeholder");
+  ParseOnBatch optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("parse", output));
+}
+
+TEST(ParseOnBatchTest, DoesNotFuseSharedBatch) {
+  GrapplerItem item = MakeItem("batch_size");
+  *item.graph.add_node() = NDef("other", "Identity", {"batch"}, {});
+  ParseOnBatch optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("parse", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
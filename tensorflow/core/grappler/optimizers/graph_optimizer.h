@@ -66,17 +66,28 @@ class GraphOptimizer {
   }
 
   // Set deadline in microseconds since epoch. A value of zero means no
-  // deadline.
+  // deadline. This also resets stopped_at_deadline().
   void set_deadline_usec(uint64 deadline_usec) {
     deadline_usec_ = deadline_usec;
+    stopped_at_deadline_ = false;
   }
   uint64 deadline_usec() const { return deadline_usec_; }
   bool DeadlineExceeded() const {
     return deadline_usec_ > 0 && Env::Default()->NowMicros() > deadline_usec_;
   }
 
+  // True iff Optimize exceeded the deadline and returned the graph optimized
+  // so far, instead of a DeadlineExceeded error.
+  bool stopped_at_deadline() const { return stopped_at_deadline_; }
+
+ protected:
+  // Optimizers which can stop at a consistent point when the deadline is
+  // exceeded call this before returning the graph optimized so far.
+  void set_stopped_at_deadline() { stopped_at_deadline_ = true; }
+
  private:
   uint64 deadline_usec_;
+  bool stopped_at_deadline_ = false;
 };
 
 #define GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED()                \
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <queue>
 #include <set>
 #include <unordered_map>
@@ -977,13 +979,11 @@ struct MemInfo {
   bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
 };
 
-static bool IdentifySwappingCandidates(
-    Cluster* cluster, GrapplerItem* item,
-    std::unique_ptr<GraphMemory>* memory_ptr,
-    std::unordered_set<string>* skip_list,
-    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
+// Infers the memory usage of `item` unless `memory_ptr` already holds it.
+static bool InferMemoryUsage(Cluster* cluster, const GrapplerItem& item,
+                             std::unique_ptr<GraphMemory>* memory_ptr) {
   if ((*memory_ptr) == nullptr) {
-    memory_ptr->reset(new GraphMemory(*item));
+    memory_ptr->reset(new GraphMemory(item));
     Status s = (*memory_ptr)->InferStatically(cluster->GetDevices());
     if (!s.ok()) {
       memory_ptr->reset();
@@ -991,6 +991,56 @@ static bool IdentifySwappingCandidates(
       return false;
     }
   }
+  return true;
+}
+
+// Runs `item` on a virtual cluster with the devices of `cluster`, which
+// estimates the cost of each op with the analytical cost model, and returns
+// when each op completes. If `op_compute_times` is not null, also returns how
+// long each op runs.
+static bool SimulateOpTimes(
+    Cluster* cluster, const GrapplerItem& item,
+    std::unordered_map<string, Costs::NanoSeconds>* op_completion_times,
+    std::unordered_map<string, Costs::NanoSeconds>* op_compute_times) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  if (!vcluster.Provision().ok()) {
+    return false;
+  }
+  if (!vcluster.Initialize(item).ok()) {
+    return false;
+  }
+  RunMetadata metadata;
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return false;
+  }
+
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      Costs::NanoSeconds exec_time =
+          Costs::NanoSeconds(1) +
+          Costs::MicroSeconds(node_stats.all_start_micros() +
+                              node_stats.op_end_rel_micros());
+      op_completion_times->emplace(node_stats.node_name(), exec_time);
+      if (op_compute_times != nullptr) {
+        const Costs::NanoSeconds compute_time(
+            Costs::MicroSeconds(node_stats.op_end_rel_micros() -
+                                node_stats.op_start_rel_micros()));
+        op_compute_times->emplace(node_stats.node_name(), compute_time);
+      }
+    }
+  }
+  return true;
+}
+
+static bool IdentifySwappingCandidates(
+    Cluster* cluster, GrapplerItem* item,
+    std::unique_ptr<GraphMemory>* memory_ptr,
+    std::unordered_set<string>* skip_list,
+    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
+  if (!InferMemoryUsage(cluster, *item, memory_ptr)) {
+    return false;
+  }
   const GraphMemory& memory = **memory_ptr;
 
   bool updated_graph = false;
@@ -1012,29 +1062,9 @@ static bool IdentifySwappingCandidates(
     int64_t required_savings = mem_usage.used_memory - prop.memory_size();
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
-    {
-      VirtualCluster vcluster(cluster->GetDevices());
-      if (!vcluster.Provision().ok()) {
-        return false;
-      }
-      if (!vcluster.Initialize(*item).ok()) {
-        return false;
-      }
-      RunMetadata metadata;
-      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
-      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
-        return false;
-      }
-
-      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
-        for (const auto& node_stats : dev_stats.node_stats()) {
-          Costs::NanoSeconds exec_time =
-              Costs::NanoSeconds(1) +
-              Costs::MicroSeconds(node_stats.all_start_micros() +
-                                  node_stats.op_end_rel_micros());
-          op_completion_times.emplace(node_stats.node_name(), exec_time);
-        }
-      }
+    if (!SimulateOpTimes(cluster, *item, &op_completion_times,
+                         /*op_compute_times=*/nullptr)) {
+      return false;
     }
 
     Costs::Duration peak_time = -1;
@@ -1146,16 +1176,285 @@ static bool IdentifySwappingCandidates(
   return updated_graph;
 }
 
+// Returns true if the tensor at `output` can be recomputed for uses which
+// complete at or after `use_time`, without keeping any input of its producer
+// alive for longer than the graph already does.
+static bool IsRecomputable(
+    const MutableGraphView& graph, MutableGraphView::OutputPort output,
+    const std::unordered_set<string>& feeds,
+    const std::unordered_map<string, Costs::NanoSeconds>& op_completion_times,
+    Costs::Duration use_time) {
+  const NodeDef& node = *output.node;
+  // Fed nodes would not take on the fed value, and the outputs of Identity and
+  // Reshape share the buffer of their input.
+  if (feeds.count(node.name()) > 0 || IsPersistent(node) ||
+      IsIdentity(node) || IsReshape(node) || IsSwitch(node) || IsMerge(node) ||
+      ModifiesFrameInfo(node) || !IsFreeOfSideEffect(node)) {
+    return false;
+  }
+  const OpDef* op_def;
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok()) {
+    return false;
+  }
+  DataType dtype;
+  if (!OutputTypeForNode(node, *op_def, output.port_id, &dtype).ok() ||
+      IsRefType(dtype)) {
+    return false;
+  }
+
+  for (int i = 0; i < node.input_size(); ++i) {
+    if (IsControlInput(node.input(i))) {
+      break;
+    }
+    MutableGraphView::InputPort input(output.node, i);
+    MutableGraphView::OutputPort fanin = graph.GetRegularFanin(input);
+    if (fanin.node == nullptr) {
+      return false;
+    }
+    if (IsPersistent(*fanin.node)) {
+      continue;
+    }
+    bool live_at_use = false;
+    for (const MutableGraphView::InputPort& fanout : graph.GetFanout(fanin)) {
+      auto it = op_completion_times.find(fanout.node->name());
+      if (it != op_completion_times.end() && it->second >= use_time) {
+        live_at_use = true;
+        break;
+      }
+    }
+    if (!live_at_use) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A tensor live at peak memory which the cost model heuristics may swap out
+// or recompute.
+struct CostModelCandidate {
+  int64_t memory_used;
+  std::vector<MutableGraphView::InputPort> uses_left;
+  bool recompute;
+  // Time that swapping or recomputing the tensor adds to the step.
+  double cost;
+  // Time it takes to bring the tensor back for its uses.
+  Costs::NanoSeconds time_to_restore;
+};
+
+// Finds tensors to swap out to host memory (`nodes_to_swap`) or recompute
+// (`nodes_to_recompute`) for their uses after peak memory, until peak memory
+// fits the budget of each GPU. For each tensor live at peak memory, the
+// simulated step tells how long its producer runs and how idle the tensor is
+// between its allocation and its next use; the tensor is recomputed if that is
+// cheaper than the part of the PCIe round trip which this idle time does not
+// hide. The cheapest tensors per byte saved are picked first.
+static bool IdentifyCostModelCandidates(
+    Cluster* cluster, GrapplerItem* item, int64_t memory_budget_bytes,
+    std::unique_ptr<GraphMemory>* memory_ptr,
+    std::unordered_set<string>* skip_list,
+    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap,
+    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_recompute) {
+  if (!InferMemoryUsage(cluster, *item, memory_ptr)) {
+    return false;
+  }
+  const GraphMemory& memory = **memory_ptr;
+
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+
+  std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+  std::unordered_map<string, Costs::NanoSeconds> op_compute_times;
+  bool simulated = false;
+  MutableGraphView graph(&item->graph);
+
+  bool updated_graph = false;
+  for (const auto& device : cluster->GetDevices()) {
+    const string& name = device.first;
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU") {
+      continue;
+    }
+    int64_t budget = prop.memory_size();
+    if (memory_budget_bytes > 0 &&
+        (budget <= 0 || memory_budget_bytes < budget)) {
+      budget = memory_budget_bytes;
+    }
+    if (budget <= 0) {
+      VLOG(1) << "Memory budget unknown for device " << name;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= budget) {
+      continue;
+    }
+    int64_t required_savings = mem_usage.used_memory - budget;
+
+    if (!simulated) {
+      if (!SimulateOpTimes(cluster, *item, &op_completion_times,
+                           &op_compute_times)) {
+        return false;
+      }
+      simulated = true;
+    }
+
+    Costs::Duration peak_time = -1;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.allocation_time > peak_time) {
+        peak_time = live_tensor.allocation_time;
+      }
+    }
+
+    std::vector<CostModelCandidate> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used <= 1024) {
+        // Don't bother with small tensors.
+        continue;
+      }
+      if (skip_list->find(live_tensor.node) != skip_list->end()) {
+        continue;
+      }
+      MutableGraphView::OutputPort port =
+          graph.GetOutputPort(live_tensor.node, live_tensor.output_id);
+      if (port.node == nullptr) {
+        continue;
+      }
+
+      CostModelCandidate candidate;
+      candidate.memory_used = live_tensor.memory_used;
+      Costs::Duration earliest_use(Costs::Duration::infinity());
+      bool valid = true;
+      bool swappable = IsSwappable(graph, port);
+      for (MutableGraphView::InputPort input : graph.GetFanout(port)) {
+        auto it = op_completion_times.find(input.node->name());
+        if (it == op_completion_times.end()) {
+          valid = false;
+          break;
+        }
+        if (it->second <= peak_time) {
+          continue;
+        }
+        string input_name =
+            strings::StrCat(input.node->name(), ":", input.port_id);
+        if (skip_list->find(input.node->name()) != skip_list->end() ||
+            skip_list->find(input_name) != skip_list->end()) {
+          valid = false;
+          break;
+        }
+        swappable = swappable && IsSwappable(input);
+        candidate.uses_left.emplace_back(input);
+        earliest_use = std::min(earliest_use, it->second);
+      }
+      if (!valid || candidate.uses_left.empty()) {
+        continue;
+      }
+
+      // Let's assume we're going to swap over PCIe running at 16 GBps.
+      const Costs::NanoSeconds transfer_time(live_tensor.memory_used / 16.0);
+      double swap_cost = std::numeric_limits<double>::infinity();
+      if (swappable) {
+        const Costs::Duration idle_time =
+            earliest_use - live_tensor.allocation_time;
+        swap_cost = std::max<double>(
+            0, 2 * transfer_time.count() - idle_time.count());
+      }
+      double recompute_cost = std::numeric_limits<double>::infinity();
+      auto compute_time = op_compute_times.find(live_tensor.node);
+      if (compute_time != op_compute_times.end() &&
+          IsRecomputable(graph, port, feeds, op_completion_times,
+                         earliest_use)) {
+        recompute_cost = compute_time->second.count();
+      }
+      if (std::isinf(swap_cost) && std::isinf(recompute_cost)) {
+        continue;
+      }
+      candidate.recompute = recompute_cost < swap_cost;
+      candidate.cost = std::min(swap_cost, recompute_cost);
+      candidate.time_to_restore =
+          candidate.recompute ? compute_time->second : transfer_time;
+      candidates.push_back(std::move(candidate));
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const CostModelCandidate& a, const CostModelCandidate& b) {
+                return a.cost / a.memory_used < b.cost / b.memory_used;
+              });
+
+    for (const CostModelCandidate& candidate : candidates) {
+      std::unordered_map<NodeDef*, SwapInfo>* nodes =
+          candidate.recompute ? nodes_to_recompute : nodes_to_swap;
+      for (const MutableGraphView::InputPort use : candidate.uses_left) {
+        VLOG(1) << "Will " << (candidate.recompute ? "recompute" : "swap")
+                << " fanout " << use.node->name() << ":" << use.port_id
+                << " of size " << candidate.memory_used << " at a cost of "
+                << candidate.cost << "ns";
+        SwapInfo& info = (*nodes)[use.node];
+        info.inputs_to_swap.push_back(use.port_id);
+        info.time_to_swap =
+            std::max(info.time_to_swap, candidate.time_to_restore);
+      }
+      required_savings -= candidate.memory_used;
+      updated_graph = true;
+      if (required_savings < 0) {
+        break;
+      }
+    }
+  }
+  return updated_graph;
+}
+
+// Makes `node` read its input `input_id` from a copy of the node producing it,
+// which runs after `trigger`.
+static Status RecomputeInput(
+    NodeDef* node, int input_id, const NodeDef& trigger,
+    const std::unordered_map<string, const NodeDef*>& name_map,
+    GraphDef* graph, NodeDef** recomputed_node) {
+  const TensorId tensor = ParseTensorName(node->input(input_id));
+  auto it = name_map.find(string(tensor.node()));
+  if (it == name_map.end()) {
+    return errors::InvalidArgument("Can't recompute input ", input_id,
+                                   " of node ", node->name(),
+                                   " since its producer is unknown");
+  }
+  const NodeDef& original_node = *it->second;
+  const string recomputed_name = AddPrefixToNodeName(
+      strings::StrCat(node->name(), "_", input_id), kRecomputedNodePrefix);
+  if (name_map.find(recomputed_name) != name_map.end()) {
+    return errors::InvalidArgument("Input ", input_id, " of node ",
+                                   node->name(), " is already recomputed");
+  }
+
+  NodeDef* copied_node = graph->add_node();
+  copied_node->set_name(recomputed_name);
+  copied_node->set_op(original_node.op());
+  *copied_node->mutable_attr() = original_node.attr();
+  copied_node->set_device(original_node.device());
+  *copied_node->mutable_input() = original_node.input();
+  // Delay the recomputation until the tensor is about to be used.
+  *copied_node->add_input() = AsControlDependency(trigger.name());
+  *node->mutable_input(input_id) =
+      TensorIdToString(TensorId(recomputed_name, tensor.index()));
+  *recomputed_node = copied_node;
+  return absl::OkStatus();
+}
+
 bool SwappingPass(RewriterConfig::MemOptType optimization_level,
-                  Cluster* cluster, std::unique_ptr<GraphMemory>* memory,
-                  GrapplerItem* item, std::unordered_set<string>* skip_list) {
+                  int64_t memory_budget_bytes, Cluster* cluster,
+                  std::unique_ptr<GraphMemory>* memory, GrapplerItem* item,
+                  std::unordered_set<string>* skip_list) {
   std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
+  std::unordered_map<NodeDef*, SwapInfo> nodes_to_recompute;
   if (optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
       optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
       optimization_level == RewriterConfig::HEURISTICS) {
     // Use heuristics to figure out what needs to be swapped;
     IdentifySwappingCandidates(cluster, item, memory, skip_list,
                                &nodes_to_swap);
+  } else if (optimization_level == RewriterConfig::COST_MODEL_HEURISTICS) {
+    IdentifyCostModelCandidates(cluster, item, memory_budget_bytes, memory,
+                                skip_list, &nodes_to_swap,
+                                &nodes_to_recompute);
   }
   // Look for manual annotations in the graph.
   for (auto& node : *item->graph.mutable_node()) {
@@ -1172,7 +1471,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
       }
     }
   }
-  if (nodes_to_swap.empty()) {
+  if (nodes_to_swap.empty() && nodes_to_recompute.empty()) {
     // Nothing to do.
     return false;
   }
@@ -1267,6 +1566,36 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
       skip_list->insert(swap_nodes.second->name());
     }
   }
+
+  for (auto& recompute : nodes_to_recompute) {
+    NodeDef* node = recompute.first;
+    const SwapInfo& recompute_info = recompute.second;
+    if (skip_list->find(node->name()) != skip_list->end()) {
+      continue;
+    }
+    // Start the recomputation late enough to not recreate the memory
+    // bottleneck, but early enough to not delay the node.
+    const NodeDef* trigger =
+        FindSwapInTrigger(node, recompute_info, name_map, execution_times);
+    if (!trigger) {
+      skip_list->insert(node->name());
+      continue;
+    }
+    for (int input_id : recompute_info.inputs_to_swap) {
+      string input_name = strings::StrCat(node->name(), ":", input_id);
+      if (!skip_list->insert(input_name).second) {
+        continue;
+      }
+      NodeDef* recomputed_node;
+      if (!RecomputeInput(node, input_id, *trigger, name_map, &item->graph,
+                          &recomputed_node)
+               .ok()) {
+        continue;
+      }
+      skip_list->insert(recomputed_node->name());
+      updated_graph = true;
+    }
+  }
   return updated_graph;
 }
 
@@ -1426,10 +1755,11 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
+           optimization_level_ == RewriterConfig::COST_MODEL_HEURISTICS ||
            optimization_level_ == RewriterConfig::MANUAL) &&
           cluster != nullptr) {
-        if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
-                         &skip_list)) {
+        if (SwappingPass(optimization_level_, memory_budget_bytes_, cluster,
+                         &memory, &optimized_item, &skip_list)) {
           // Reset the inferred memory usage since the graph changed.
           memory.reset();
           updated_graph = true;
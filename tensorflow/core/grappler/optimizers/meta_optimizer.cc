@@ -17,9 +17,11 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
@@ -41,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
 #include "tensorflow/core/grappler/optimizers/common_subgraph_elimination.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
+#include "tensorflow/core/grappler/optimizers/critical_path_annotator.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
 #include "tensorflow/core/grappler/optimizers/debug_stripper.h"
 #include "tensorflow/core/grappler/optimizers/dependency_optimizer.h"
@@ -50,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
@@ -62,7 +66,11 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -81,6 +89,7 @@ namespace {
 constexpr int kDefaultNumberOfIterations = 2;
 constexpr int kDefaultMinGraphNodes = 4;
 constexpr char kGrapplerCategory[] = "Grappler";
+constexpr int kNumSlowestOptimizersToReport = 5;
 
 int64_t NumEdges(const GraphDef& graph) {
   int64_t num_edges = 0;
@@ -218,7 +227,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
          new ConstantFolding(
              cpu_device_,
              cfg_.experimental_disable_compressed_tensor_optimization(),
-             !cfg_.experimental_disable_folding_quantization_emulation()));
+             !cfg_.experimental_disable_folding_quantization_emulation(),
+             cfg_.constant_folding_max_growth_bytes()));
   MK_OPT("shape", "shape_optimization", new ShapeOptimizer());
   MK_OPT("remap", "remapping",
          new Remapper(cfg_.remapping(), cfg_.cpu_layout_conversion(),
@@ -242,6 +252,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
 #endif
   MK_OPT("auto_mixed_precision_cpu", "auto_mixed_precision_cpu",
          new AutoMixedPrecision(AutoMixedPrecisionMode::CPU));
+  MK_OPT("auto_mixed_precision_int8", "auto_mixed_precision_int8",
+         new AutoMixedPrecision(AutoMixedPrecisionMode::INT8_CPU));
   MK_OPT("memory", "memory_optimization",
          new MemoryOptimizer(RewriterConfig::MANUAL));
   MK_OPT("common_subgraph_elimination", "common_subgraph_elimination",
@@ -260,6 +272,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
                                       cfg_.scoped_allocator_opts()));
   MK_OPT("pin_to_host", "pin_to_host_optimization",
          new PinToHostOptimizer(cfg_.pin_to_host_optimization()));
+  MK_OPT("critical_path", "critical_path_scheduling",
+         new CriticalPathAnnotator(cfg_.critical_path_scheduling()));
 
   return std::unique_ptr<GraphOptimizer>();
 }
@@ -407,6 +421,12 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->push_back(
         std::make_unique<AutoMixedPrecision>(AutoMixedPrecisionMode::CPU));
   }
+  if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_int8()) &&
+      AutoMixedPrecisionEnabled(
+          plugin_configs.toggle_config["auto_mixed_precision_int8"])) {
+    optimizers->push_back(std::make_unique<AutoMixedPrecision>(
+        AutoMixedPrecisionMode::INT8_CPU));
+  }
   if (BOTH_ARE_ON(pin_to_host_optimization))
     optimizers->push_back(std::make_unique<PinToHostOptimizer>());
   else if (BOTH_ARE_EXPERIMENTAL_MLIR(pin_to_host_optimization) ||
@@ -472,15 +492,12 @@ Status MetaOptimizer::InitializeOptimizers(
   if (MemoryOptimizerEnabled(cfg_.memory_optimization(),
                              xla_auto_clustering_on_) &&
       PLUGIN_NOT_OFF(memory_optimization)) {
-    if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
-      optimizers->push_back(
-          // Use the default target node name prefix "gradients/"
-          std::make_unique<MemoryOptimizer>(cfg_.memory_optimization()));
-    } else {
-      optimizers->push_back(std::make_unique<MemoryOptimizer>(
-          cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
-    }
+    const string& name_scope = cfg_.memory_optimizer_target_node_name_scope();
+    optimizers->push_back(std::make_unique<MemoryOptimizer>(
+        cfg_.memory_optimization(),
+        // Use the default target node name prefix "gradients/"
+        name_scope.empty() ? "gradients/" : name_scope,
+        cfg_.memory_optimizer_budget_bytes()));
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
     optimizers->push_back(
@@ -496,6 +513,9 @@ Status MetaOptimizer::InitializeOptimizers(
     VLOG(2) << "scoped_allocator_optimization is not implemented in TFG yet";
   }
 #endif
+  if (BOTH_ARE_ON(critical_path_scheduling)) {
+    optimizers->push_back(std::make_unique<CriticalPathAnnotator>());
+  }
 
 #undef USER_IS_ON
 #undef USER_IS_EXPERIMENTAL_MLIR
@@ -641,6 +661,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     PRINT_CFG(loop_optimization)
     PRINT_CFG(dependency_optimization)
     PRINT_CFG(scoped_allocator_optimization)
+    PRINT_CFG(critical_path_scheduling)
 #undef PRINT_CFG
     user_cfg.toggle_config["auto_mixed_precision"] =
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision())
@@ -658,6 +679,10 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu())
             ? RewriterConfig::ON
             : RewriterConfig::OFF;
+    user_cfg.toggle_config["auto_mixed_precision_int8"] =
+        AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_int8())
+            ? RewriterConfig::ON
+            : RewriterConfig::OFF;
     user_cfg.toggle_config["memory_optimization"] =
         MemoryOptimizerEnabled(cfg_.memory_optimization(),
                                config_proto_.graph_options()
@@ -688,6 +713,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
                 "auto_mixed_precision_onednn_bfloat16")
       PRINT_CFG("auto_mixed_precision_mkl", "auto_mixed_precision_mkl")
       PRINT_CFG("auto_mixed_precision_cpu", "auto_mixed_precision_cpu")
+      PRINT_CFG("auto_mixed_precision_int8", "auto_mixed_precision_int8")
       PRINT_CFG("pin_to_host", "pin_to_host_optimization")
       PRINT_CFG("layout", "layout_optimizer")
       PRINT_CFG("remap", "remapping")
@@ -696,6 +722,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
       PRINT_CFG("memory", "memory_optimization")
       PRINT_CFG("autoparallel", "auto_parallel")
       PRINT_CFG("scoped_allocator", "scoped_allocator_optimization")
+      PRINT_CFG("critical_path", "critical_path_scheduling")
 #undef PRINT_CFG
     }
   }
@@ -729,8 +756,10 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         pair.first == "auto_mixed_precision_onednn_bfloat16" ||
         pair.first == "auto_mixed_precision_mkl" ||
         pair.first == "auto_mixed_precision_cpu" ||
+        pair.first == "auto_mixed_precision_int8" ||
         pair.first == "pin_to_host_optimization" ||
-        pair.first == "scoped_allocator_optimization") {
+        pair.first == "scoped_allocator_optimization" ||
+        pair.first == "critical_path_scheduling") {
       // These optimizers are turned off by default.
       // TODO(penporn): Remove the hard-coded length and change it to max length
       // of all option strings.
@@ -806,6 +835,7 @@ Status MetaOptimizer::OptimizeGraph(
 #ifndef ENABLE_MKL
   GraphOptimizer* sa_optimizer = nullptr;
 #endif
+  GraphOptimizer* critical_path_annotator = nullptr;
 
   // Constants in the graph are normally compressed after model_pruner.
   // Do it here if model pruner is disabled.
@@ -841,6 +871,12 @@ Status MetaOptimizer::OptimizeGraph(
         continue;
       }
 #endif
+      if (optimizer->name() == "critical_path_annotator") {
+        if (critical_path_annotator == nullptr) {
+          critical_path_annotator = optimizer.get();
+        }
+        continue;
+      }
 
       TF_RETURN_IF_ERROR(RunOptimizer(optimizer.get(), cluster, &item,
                                       optimized_graph, &optimization_result));
@@ -880,6 +916,13 @@ Status MetaOptimizer::OptimizeGraph(
     GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
   }
 #endif
+  // CriticalPathAnnotator annotates the final graph, so it runs after all the
+  // optimizers which rewrite it.
+  if (critical_path_annotator != nullptr) {
+    TF_RETURN_IF_ERROR(RunOptimizer(critical_path_annotator, cluster, &item,
+                                    optimized_graph, &optimization_result));
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+  }
 
   bool is_optimized = std::find_if(optimization_result.results.begin(),
                                    optimization_result.results.end(),
@@ -888,7 +931,10 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -937,15 +983,37 @@ Status MetaOptimizer::RunOptimizer(
   // resets optimized_graph to an empty graph.
   optimized_item->graph = std::move(*optimized_graph);
   *optimized_graph = GraphDef();
-  optimizer->set_deadline_usec(this->deadline_usec());
+  // The optimizer runs until the earlier of the meta optimizer deadline and
+  // the end of its own time budget.
+  uint64 deadline_usec = this->deadline_usec();
+  if (cfg_.meta_optimizer_pass_timeout_ms() > 0) {
+    const uint64 pass_deadline_usec =
+        Env::Default()->NowMicros() +
+        cfg_.meta_optimizer_pass_timeout_ms() * 1000;
+    if (deadline_usec == 0 || pass_deadline_usec < deadline_usec) {
+      deadline_usec = pass_deadline_usec;
+    }
+  }
+  optimizer->set_deadline_usec(deadline_usec);
   tensorflow::metrics::ScopedCounter<2> timings(
       tensorflow::metrics::GetGraphOptimizationCounter(),
       {kGrapplerCategory, optimizer->name()});
   Status status =
       optimizer->Optimize(cluster, *optimized_item, optimized_graph);
-  auto duration_ms = timings.DurationMicroSec().value() / 1000.0f;
+  const uint64 duration_usecs = timings.DurationMicroSec().value();
+  auto duration_ms = duration_usecs / 1000.0f;
   timings.ReportAndStop();
 
+  // Only the time budget of the optimizer was exceeded, the meta optimizer
+  // moves on to the next optimizer.
+  const bool pass_timed_out =
+      (optimizer->stopped_at_deadline() || absl::IsDeadlineExceeded(status)) &&
+      !DeadlineExceeded();
+  if (pass_timed_out) {
+    tensorflow::metrics::IncrementGraphOptimizationPassTimeoutCount(
+        optimizer->name());
+  }
+
   string message;
   if (!status.ok()) {
     *optimized_graph = std::move(optimized_item->graph);
@@ -956,6 +1024,12 @@ Status MetaOptimizer::RunOptimizer(
                                 " did nothing. time = ", duration_ms, "ms.");
       // Swallow the non-critical error.
       status = absl::OkStatus();
+    } else if (pass_timed_out) {
+      message = strings::StrCat(optimizer->name(),
+                                " timed out and did nothing. time = ",
+                                duration_ms, "ms.");
+      LOG_EVERY_N_SEC(WARNING, 60) << message;
+      status = absl::OkStatus();
     } else if (absl::IsDeadlineExceeded(status)) {
       message =
           strings::StrCat(status.ToString(), ", time = ", duration_ms, "ms.");
@@ -969,6 +1043,11 @@ Status MetaOptimizer::RunOptimizer(
     message = strings::StrCat(
         PrintSizesBeforeAfter(optimized_item->graph, *optimized_graph),
         ", time = ", duration_ms, "ms.");
+    if (optimizer->stopped_at_deadline()) {
+      absl::StrAppend(&message, " Stopped at the deadline.");
+      LOG_EVERY_N_SEC(WARNING, 60)
+          << optimizer->name() << " timed out: " << message;
+    }
     VLOG(1) << optimizer->name() << ": " << message;
   }
 
@@ -978,7 +1057,8 @@ Status MetaOptimizer::RunOptimizer(
         optimized_graph_function_library.release());
   }
 
-  OptimizerResult optimizer_result{optimizer->name(), message, status};
+  OptimizerResult optimizer_result{optimizer->name(), message, status,
+                                   duration_usecs};
   optimization_result->results.push_back(optimizer_result);
 
   if (!status.ok()) {
@@ -1055,7 +1135,10 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       {kGrapplerCategory, "*"});
 
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
-  optimization_results_.clear();
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.clear();
+  }
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -1164,15 +1247,67 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  // Functions of a batch are optimized concurrently, each one against the
+  // function library as it was before the batch. Their optimized bodies are
+  // merged into the library in library order, so that the result does not
+  // depend on scheduling.
+  const int batch_size =
+      std::max(1, cfg_.function_optimization_parallelism());
+  std::unique_ptr<thread::ThreadPool> thread_pool;
+  if (batch_size > 1) {
+    thread_pool = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "grappler_function_optimization", batch_size);
+  }
+
+  struct FunctionOptimization {
+    const FunctionDef* func;
+    GrapplerFunctionItem func_item;
+    GraphDef optimized_func_graph;
+    Status status;
+  };
+
+  // Optimize function body graph.
+  const auto optimize_function = [&](FunctionOptimization& optimization) {
+    GrapplerFunctionItem& func_item = optimization.func_item;
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item.graph.release_library());
+      *func_item.graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      optimization.status = implementation_selector.Optimize(
+          cluster, func_item, &optimization.optimized_func_graph);
+    } else {
+      GrapplerFunctionItem func_item_copy = func_item;
+      optimization.status =
+          OptimizeGraph(cluster, std::move(func_item_copy),
+                        &optimization.optimized_func_graph);
+    }
+  };
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
-    int function_idx = 0;
+    // Functions to optimize in this pass over the library.
+    std::vector<const FunctionDef*> funcs;
     for (const FunctionDef& func : optimized_graph->library().function()) {
-      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
-
       const string& func_name = func.signature().name();
 
       // Skip functions that are not reachable from the optimized graph.
@@ -1192,87 +1327,92 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       // and in function instantiation.
       if (data::IsTFDataFunction(func)) continue;
 
-      VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
-              << optimized_graph->library().function_size() << "]";
-
       // Function optimization might specialize nested function calls, so we
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs.push_back(&func);
+    }
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    for (int batch_start = 0; batch_start < funcs.size();
+         batch_start += batch_size) {
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+
+      const int batch_end =
+          std::min<int>(batch_start + batch_size, funcs.size());
+      std::vector<FunctionOptimization> batch(batch_end - batch_start);
+      for (int i = 0; i < batch.size(); ++i) {
+        const FunctionDef& func = *funcs[batch_start + i];
+        const string& func_name = func.signature().name();
+        VLOG(3) << "Optimize function: function=" << func_name << " ["
+                << batch_start + i << " of " << funcs.size() << "]";
+
+        // Make a GrapplerItem from a FunctionDef.
+        FunctionOptimization& optimization = batch[i];
+        optimization.func = &func;
+        GrapplerFunctionItem& func_item = optimization.func_item;
+        TF_RETURN_IF_ERROR(
+            MakeGrapplerFunctionItem(func, flib, producer, &func_item));
+
+        // If we need to compute the gradient of optimized function at runtime,
+        // we can't perform non-differentiable rewrites.
+        func_item.optimization_options().allow_non_differentiable_rewrites =
+            !differentiable_functions.contains(func_name);
+
+        // Device set available to the function is defined only by the runtime,
+        // when we instantiate and execute the function. We can't use all
+        // devices available to the main graph, because after partitioning the
+        // function call node might execute on a remote worker.
+        if (!func_item.devices().empty()) {
+          return errors::Internal(
+              "GrapplerFunctionItem devices must be empty.");
+        }
+
+        // We are not allowed to prune certain types of ops from the graph
+        // instantiated by the function definition, because we must guarantee
+        // function execution semantics wrt side effects (see
+        // function_optimizer.cc).
+        func_item.optimization_options()
+            .allow_pruning_stateful_and_dataset_ops = false;
       }
 
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
+      if (batch.size() == 1) {
+        optimize_function(batch[0]);
       } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+        BlockingCounter counter(batch.size());
+        for (FunctionOptimization& optimization : batch) {
+          thread_pool->Schedule([&optimize_function, &optimization, &counter] {
+            optimize_function(optimization);
+            counter.DecrementCount();
+          });
+        }
+        counter.Wait();
       }
 
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      for (FunctionOptimization& optimization : batch) {
+        TF_RETURN_IF_ERROR(optimization.status);
+        const string& func_name = optimization.func->signature().name();
+        GraphDef& optimized_func_graph = optimization.optimized_func_graph;
+
+        // Function body optimization might have created new specialized
+        // functions for each instantiation context. Add them to the library.
+        for (const FunctionDef& func_def :
+             optimized_func_graph.library().function()) {
+          if (flib.Find(func_def.signature().name()) == nullptr) {
+            TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+          }
         }
-      }
 
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
+        // Convert optimized graph back to FunctionDef.
+        FunctionDef optimized_func;
+        optimization.func_item.SwapFunctionBody(
+            std::move(optimized_func_graph));
+        TF_RETURN_IF_ERROR(
+            MakeFunctionDef(optimization.func_item, flib, &optimized_func));
 
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+        // Replace optimized function with a new FunctionDef.
+        TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+      }
     }
 
     // If optimized at least one function, update the graph library.
@@ -1321,6 +1461,7 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
 
 string MetaOptimizer::GetResultString() const {
   std::string result_string;
+  mutex_lock l(optimization_results_mu_);
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     absl::StrAppend(&result_string,
                     "Optimization results for grappler item: ", graph_result.id,
@@ -1329,6 +1470,29 @@ string MetaOptimizer::GetResultString() const {
       absl::StrAppend(&result_string, "  ", result.optimizer_name, ": ",
                       result.message, "\n");
     }
+
+    // The optimizers which took the most time, to tell which one makes the
+    // graph slow to load.
+    std::vector<const OptimizerResult*> slowest;
+    for (const OptimizerResult& result : graph_result.results) {
+      slowest.push_back(&result);
+    }
+    const int num_slowest =
+        std::min<int>(slowest.size(), kNumSlowestOptimizersToReport);
+    std::partial_sort(slowest.begin(), slowest.begin() + num_slowest,
+                      slowest.end(),
+                      [](const OptimizerResult* a, const OptimizerResult* b) {
+                        return a->duration_usecs > b->duration_usecs;
+                      });
+    if (num_slowest > 0) {
+      absl::StrAppend(&result_string, "  Slowest optimizers:");
+      for (int i = 0; i < num_slowest; ++i) {
+        absl::StrAppend(&result_string, i > 0 ? "," : "", " ",
+                        slowest[i]->optimizer_name, " (",
+                        slowest[i]->duration_usecs / 1000.0f, "ms)");
+      }
+      absl::StrAppend(&result_string, "\n");
+    }
   }
   return result_string;
 }
@@ -1357,11 +1521,13 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
 #endif
          rewrite_cfg.pin_to_host_optimization() == RewriterConfig::ON ||
+         rewrite_cfg.critical_path_scheduling() == RewriterConfig::ON ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision()) ||
          AutoMixedPrecisionEnabled(
              rewrite_cfg.auto_mixed_precision_onednn_bfloat16()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_mkl()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_cpu()) ||
+         AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_int8()) ||
          !rewrite_cfg.optimizers().empty() ||
          !rewrite_cfg.custom_optimizers().empty();
 }
@@ -1369,11 +1535,43 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
 Status RunMetaOptimizer(GrapplerItem&& item, const ConfigProto& cfg,
                         DeviceBase* cpu_device, Cluster* cluster,
                         GraphDef* optimized_graph) {
+  const string cache_dir = OptimizedGraphCacheDir();
+  string cache_key;
+  if (!cache_dir.empty()) {
+    cache_key = OptimizedGraphCacheKey(item, cfg, cluster);
+    Status s = ReadOptimizedGraph(cache_dir, cache_key, optimized_graph);
+    if (s.ok()) {
+      VLOG(1) << "Read optimized graph of item " << item.id
+              << " from the cache: " << cache_key;
+      metrics::IncrementFunctionGraphOptimizationCacheHitCount(
+          1, metrics::GraphOptimizationSource::kGrappler);
+      return absl::OkStatus();
+    }
+    if (absl::IsNotFound(s)) {
+      metrics::IncrementFunctionGraphOptimizationCacheMissCount(
+          1, metrics::GraphOptimizationSource::kGrappler);
+    } else {
+      LOG(WARNING) << "Failed to read optimized graph " << cache_key
+                   << " from the cache, optimizing it again: " << s;
+      metrics::IncrementFunctionGraphOptimizationCacheFailureCount(
+          1, metrics::GraphOptimizationSource::kGrappler);
+    }
+    optimized_graph->Clear();
+  }
+
   MetaOptimizer optimizer(cpu_device, cfg);
   optimizer.set_deadline_usec(
       DeadlineMicroSeconds(cfg.graph_options().rewrite_options()));
-  return optimizer.OptimizeConsumeItem(cluster, std::move(item),
-                                       optimized_graph);
+  TF_RETURN_IF_ERROR(optimizer.OptimizeConsumeItem(cluster, std::move(item),
+                                                   optimized_graph));
+  if (!cache_dir.empty()) {
+    Status s = WriteOptimizedGraph(cache_dir, cache_key, *optimized_graph);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to write optimized graph " << cache_key
+                   << " to the cache: " << s;
+    }
+  }
+  return absl::OkStatus();
 }
 
 Status OptimizeGraph(
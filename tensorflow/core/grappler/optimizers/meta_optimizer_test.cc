@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
@@ -420,6 +421,95 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryInParallel) {
+  using test::function::NDef;
+
+  // Function library where the main graph calls two noinline functions, each
+  // of which is specialized and optimized in the same pass:
+  //
+  //   MyMul(x, y)    = x * y
+  //  *MySquare(x)    = MyMul(x, x)
+  //  *MyQuadratic(x) = MySquare(MySquare(x))
+  //
+  //  * - marked as noinline
+  FunctionDef mul_func = FunctionDefHelper::Create(
+      "MyMul", {"x:T", "y:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"mul"}, "Mul", {"x", "y"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}});
+
+  FunctionDef square_func = FunctionDefHelper::Create(
+      "MySquare", {"x:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"my_mul"}, "MyMul", {"x", "x"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "my_mul:z:0"}});
+  (*square_func.mutable_attr())["_noinline"].set_b(true);
+
+  FunctionDef quadratic_func = FunctionDefHelper::Create(
+      "MyQuadratic", {"x:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"square"}, "MySquare", {"x"}, {{"T", "$T"}}},
+       {{"quadratic"}, "MySquare", {"square:z"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "quadratic:z:0"}});
+  (*quadratic_func.mutable_attr())["_noinline"].set_b(true);
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("b", "Placeholder", {}, {{"dtype", DT_INT32}}, kDevice),
+       NDef("square", "MySquare", {"a"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("quadratic", "MyQuadratic", {"b"}, {{"T", DT_INT32}}, kDevice),
+       NDef("out_s", "Identity", {"square:0"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("out_q", "Identity", {"quadratic:0"}, {{"T", DT_INT32}}, kDevice)},
+      /*funcs=*/
+      {mul_func, square_func, quadratic_func});
+
+  const auto optimize = [&item](int parallelism) {
+    ConfigProto config_proto;
+    auto& rewriter_config =
+        *config_proto.mutable_graph_options()->mutable_rewrite_options();
+    rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+    rewriter_config.set_function_optimization(RewriterConfig::ON);
+    rewriter_config.add_optimizers("function");
+    rewriter_config.set_min_graph_nodes(-1);
+    rewriter_config.set_function_optimization_parallelism(parallelism);
+
+    MetaOptimizer optimizer(nullptr, config_proto);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+    return output;
+  };
+
+  // Optimizing functions in parallel gives the same library as optimizing
+  // them one at a time.
+  GraphDef serial_output = optimize(/*parallelism=*/1);
+  GraphDef parallel_output = optimize(/*parallelism=*/4);
+  FunctionLibraryDefinition serial_flib(OpRegistry::Global(),
+                                        serial_output.library());
+  FunctionLibraryDefinition parallel_flib(OpRegistry::Global(),
+                                          parallel_output.library());
+  EXPECT_EQ(3, parallel_flib.num_functions());
+  ASSERT_EQ(serial_flib.num_functions(), parallel_flib.num_functions());
+  for (const string& name : serial_flib.ListFunctionNames()) {
+    const FunctionDef* parallel_func = parallel_flib.Find(name);
+    ASSERT_NE(parallel_func, nullptr) << name;
+    EXPECT_EQ(serial_flib.Find(name)->DebugString(),
+              parallel_func->DebugString());
+  }
+
+  item.fetch = {"out_s", "out_q"};
+  item.feed.emplace_back("a", test::AsScalar<float>(2.0f));
+  item.feed.emplace_back("b", test::AsScalar<int>(4));
+  auto tensors_expected = EvaluateFetchNodes(item);
+
+  GrapplerItem optimized = item.WithGraph(std::move(parallel_output));
+  auto tensors = EvaluateFetchNodes(optimized);
+
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+  test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneUnusedOutputs) {
   using test::function::NDef;
 
@@ -792,6 +882,90 @@ TEST_F(MetaOptimizerTest, OptimizerDoesNotTimeOut) {
   EXPECT_EQ(original_node_size + 2, output.node_size());
 }
 
+TEST_F(MetaOptimizerTest, OptimizerPassTimesOut) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config;
+  RewriterConfig& rewriter_config =
+      *config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("SleepingOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_pass_timeout_ms(500);
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+  rewriter_config.set_fail_on_optimizer_errors(true);
+
+  const int64_t timeouts =
+      metrics::GetGraphOptimizationPassTimeoutCount("test_optimizer");
+  GraphDef output;
+  GraphDef original = item.graph;
+  MetaOptimizer optimizer(nullptr, config);
+  // Only the pass timed out, which isn't an error of the meta optimizer.
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  CompareGraphs(original, output);
+  EXPECT_EQ(timeouts + 1,
+            metrics::GetGraphOptimizationPassTimeoutCount("test_optimizer"));
+  EXPECT_TRUE(absl::StrContains(optimizer.GetResultString(),
+                                "test_optimizer timed out and did nothing"));
+}
+
+// Adds a node, then stops at the deadline with the node added so far.
+class StoppingOptimizer : public CustomGraphOptimizer {
+ public:
+  StoppingOptimizer() {}
+  string name() const override { return "stopping_optimizer"; }
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return absl::OkStatus();
+  }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override {
+    *optimized_graph = item.graph;
+    optimized_graph->add_node();
+    Env::Default()->SleepForMicroseconds(1000000);
+    if (DeadlineExceeded()) {
+      set_stopped_at_deadline();
+      return absl::OkStatus();
+    }
+    optimized_graph->add_node();
+    return absl::OkStatus();
+  }
+};
+
+REGISTER_GRAPH_OPTIMIZER(StoppingOptimizer);
+
+TEST_F(MetaOptimizerTest, OptimizerPassKeepsWorkAtTimeOut) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config;
+  RewriterConfig& rewriter_config =
+      *config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("StoppingOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_pass_timeout_ms(500);
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+
+  const int64_t timeouts =
+      metrics::GetGraphOptimizationPassTimeoutCount("stopping_optimizer");
+  GraphDef output;
+  const int original_node_size = item.graph.node_size();
+  MetaOptimizer optimizer(nullptr, config);
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(original_node_size + 1, output.node_size());
+  EXPECT_EQ(timeouts + 1, metrics::GetGraphOptimizationPassTimeoutCount(
+                              "stopping_optimizer"));
+  const string result = optimizer.GetResultString();
+  EXPECT_TRUE(absl::StrContains(result, "Stopped at the deadline."));
+  EXPECT_TRUE(
+      absl::StrContains(result, "Slowest optimizers: stopping_optimizer ("));
+}
+
 TEST_F(MetaOptimizerTest, RunPostOptimizationVerifiersOnValidGraph) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
   GrapplerItem item;
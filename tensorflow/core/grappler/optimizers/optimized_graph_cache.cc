@@ -0,0 +1,163 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kCacheDirEnvVar[] = "TF_GRAPPLER_OPTIMIZED_GRAPH_CACHE_DIR";
+
+// Accumulates the fingerprint of a sequence of strings and messages.
+class KeyBuilder {
+ public:
+  void Add(absl::string_view s) {
+    fingerprint_ = FingerprintCat128(fingerprint_, Fingerprint128(s));
+  }
+
+  void Add(int64_t v) { fingerprint_ = FingerprintCat128(fingerprint_, v); }
+
+  void Add(const protobuf::MessageLite& message) {
+    std::string serialized;
+    SerializeToStringDeterministic(message, &serialized);
+    Add(serialized);
+  }
+
+  void AddSorted(std::vector<std::string> strings) {
+    std::sort(strings.begin(), strings.end());
+    Add(static_cast<int64_t>(strings.size()));
+    for (const std::string& s : strings) Add(s);
+  }
+
+  std::string Key() const {
+    return absl::StrFormat("%016x%016x", fingerprint_.high64,
+                           fingerprint_.low64);
+  }
+
+ private:
+  Fprint128 fingerprint_ = {0x6f7074696d697a65ull, 0x645f67726170685full};
+};
+
+std::string EntryPath(const std::string& dir, const std::string& key) {
+  return io::JoinPath(dir, absl::StrCat(key, ".pb"));
+}
+
+}  // namespace
+
+std::string OptimizedGraphCacheDir() {
+  const char* dir = std::getenv(kCacheDirEnvVar);
+  return dir == nullptr ? "" : dir;
+}
+
+std::string OptimizedGraphCacheKey(const GrapplerItem& item,
+                                   const ConfigProto& config,
+                                   const Cluster* cluster) {
+  KeyBuilder key;
+  key.Add(TF_VERSION_STRING);
+  key.Add(static_cast<int64_t>(TF_GRAPH_DEF_VERSION));
+  key.Add(item.graph);
+
+  key.Add(static_cast<int64_t>(item.feed.size()));
+  for (const auto& feed : item.feed) {
+    key.Add(feed.first);
+    key.Add(static_cast<int64_t>(feed.second.dtype()));
+    TensorShapeProto shape;
+    feed.second.shape().AsProto(&shape);
+    key.Add(shape);
+  }
+  key.AddSorted(item.fetch);
+  key.AddSorted(item.init_ops);
+  key.AddSorted(item.keep_ops);
+  key.Add(item.save_op);
+  key.Add(item.restore_op);
+  key.Add(item.save_restore_loc_tensor);
+  key.Add(static_cast<int64_t>(item.queue_runners.size()));
+  for (const QueueRunnerDef& queue_runner : item.queue_runners) {
+    key.Add(queue_runner);
+  }
+  key.AddSorted(
+      std::vector<std::string>(item.devices().begin(), item.devices().end()));
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  key.Add(static_cast<int64_t>(options.allow_non_differentiable_rewrites));
+  key.Add(
+      static_cast<int64_t>(options.allow_pruning_stateful_and_dataset_ops));
+  key.Add(static_cast<int64_t>(options.optimize_function_library));
+  key.Add(static_cast<int64_t>(options.is_eager_mode));
+  key.Add(static_cast<int64_t>(options.intra_op_parallelism_threads));
+
+  key.Add(config);
+  if (cluster != nullptr) {
+    std::vector<std::string> devices;
+    for (const auto& device : cluster->GetDevices()) {
+      std::string properties;
+      SerializeToStringDeterministic(device.second, &properties);
+      devices.push_back(absl::StrCat(device.first, "=", properties));
+    }
+    key.AddSorted(std::move(devices));
+  }
+  return key.Key();
+}
+
+Status ReadOptimizedGraph(const std::string& dir, const std::string& key,
+                          GraphDef* optimized_graph) {
+  const std::string path = EntryPath(dir, key);
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->FileExists(path));
+  return ReadBinaryProto(env, path, optimized_graph);
+}
+
+Status WriteOptimizedGraph(const std::string& dir, const std::string& key,
+                           const GraphDef& optimized_graph) {
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir));
+  const std::string path = EntryPath(dir, key);
+  std::string temp_path = path;
+  if (!env->CreateUniqueFileName(&temp_path, ".tmp")) {
+    return errors::Unavailable("Could not create a unique file inside ", dir);
+  }
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, optimized_graph));
+  Status s = env->RenameFile(temp_path, path);
+  if (!s.ok()) {
+    env->DeleteFile(temp_path).IgnoreError();
+  }
+  return s;
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
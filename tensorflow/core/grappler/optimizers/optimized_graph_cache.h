@@ -0,0 +1,65 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
+
+#include <string>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// A persistent cache of the graphs optimized by RunMetaOptimizer, so that
+// restarted processes, e.g. new serving replicas, skip the optimization of
+// the graphs and functions which they already optimized.
+//
+// The cache is enabled by setting the environment variable
+// TF_GRAPPLER_OPTIMIZED_GRAPH_CACHE_DIR to a directory, which may be shared
+// by processes. Entries are keyed by a fingerprint of everything
+// RunMetaOptimizer is given: the input graph with its function library, the
+// feeds, fetches and other nodes to preserve, the optimization options, the
+// available devices, the ConfigProto (which holds the RewriterConfig) and the
+// TensorFlow version. Custom optimizers and environment variables which
+// change optimizers behind the ConfigProto are not part of the key; the cache
+// must be cleared when they change.
+
+// Returns the directory of the cache, or an empty string if it is disabled.
+std::string OptimizedGraphCacheDir();
+
+// Returns the key of the optimized graph of `item`.
+std::string OptimizedGraphCacheKey(const GrapplerItem& item,
+                                   const ConfigProto& config,
+                                   const Cluster* cluster);
+
+// Reads the optimized graph stored under `key` in `dir`. Returns NotFound if
+// there is none.
+Status ReadOptimizedGraph(const std::string& dir, const std::string& key,
+                          GraphDef* optimized_graph);
+
+// Stores `optimized_graph` under `key` in `dir`. The entry is written to a
+// temporary file first, so that concurrent readers never see a partial entry.
+Status WriteOptimizedGraph(const std::string& dir, const std::string& key,
+                           const GraphDef& optimized_graph);
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
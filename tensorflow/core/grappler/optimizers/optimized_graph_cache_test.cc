@@ -0,0 +1,102 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+GrapplerItem MakeItem() {
+  GrapplerItem item;
+  item.id = "item";
+  NodeDef* node = item.graph.add_node();
+  node->set_name("a");
+  node->set_op("NoOp");
+  item.fetch.push_back("a");
+  return item;
+}
+
+TEST(OptimizedGraphCacheTest, KeyDependsOnInputs) {
+  GrapplerItem item = MakeItem();
+  ConfigProto config;
+  const std::string key = OptimizedGraphCacheKey(item, config, nullptr);
+  EXPECT_EQ(key, OptimizedGraphCacheKey(MakeItem(), config, nullptr));
+
+  // The id of an item does not change its optimized graph.
+  GrapplerItem renamed = MakeItem();
+  renamed.id = "renamed";
+  EXPECT_EQ(key, OptimizedGraphCacheKey(renamed, config, nullptr));
+
+  GrapplerItem other_graph = MakeItem();
+  other_graph.graph.mutable_node(0)->set_name("b");
+  EXPECT_NE(key, OptimizedGraphCacheKey(other_graph, config, nullptr));
+
+  GrapplerItem other_fetch = MakeItem();
+  other_fetch.fetch.clear();
+  EXPECT_NE(key, OptimizedGraphCacheKey(other_fetch, config, nullptr));
+
+  GrapplerItem other_options = MakeItem();
+  other_options.optimization_options().allow_non_differentiable_rewrites =
+      !item.optimization_options().allow_non_differentiable_rewrites;
+  EXPECT_NE(key, OptimizedGraphCacheKey(other_options, config, nullptr));
+
+  ConfigProto other_config;
+  other_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  EXPECT_NE(key, OptimizedGraphCacheKey(item, other_config, nullptr));
+}
+
+TEST(OptimizedGraphCacheTest, WriteAndRead) {
+  const std::string dir =
+      io::JoinPath(testing::TmpDir(), "optimized_graph_cache_test");
+  GrapplerItem item = MakeItem();
+  const std::string key = OptimizedGraphCacheKey(item, ConfigProto(), nullptr);
+
+  GraphDef graph;
+  EXPECT_TRUE(errors::IsNotFound(ReadOptimizedGraph(dir, key, &graph)));
+
+  TF_ASSERT_OK(WriteOptimizedGraph(dir, key, item.graph));
+  TF_ASSERT_OK(ReadOptimizedGraph(dir, key, &graph));
+  EXPECT_EQ(graph.DebugString(), item.graph.DebugString());
+
+  // Entries are replaced as a whole.
+  item.graph.mutable_node(0)->set_name("b");
+  TF_ASSERT_OK(WriteOptimizedGraph(dir, key, item.graph));
+  TF_ASSERT_OK(ReadOptimizedGraph(dir, key, &graph));
+  EXPECT_EQ(graph.node(0).name(), "b");
+
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+  EXPECT_EQ(children.size(), 1);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -25,9 +25,12 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/graph_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
@@ -82,6 +85,29 @@ namespace grappler {
 //
 // _FusedConv2D/_FusedConv3D + <Activation> -> _FusedConv2D/_FusedConv3D
 // Supported Activations: LeakyRelu, Mish
+//
+// Layer normalization subgraph -> _FusedLayerNorm  // Only on CPU without
+//   oneDNN, which uses _MklLayerNorm instead.
+//
+// BatchMatMulV2 + [Mul|RealDiv] + [Add|AddV2] + Softmax + BatchMatMulV2 ->
+//   _FusedAttention
+//   Scaled dot-product attention with an optional additive mask on GPU, and
+//   on CPU without oneDNN, computed in blocks without materializing the score
+//   matrix.
+//
+// GatherV2|ResourceGather + SparseSegment[Sum|Mean|SqrtN] ->
+//   _FusedSparseEmbeddingLookup|_FusedResourceSparseEmbeddingLookup
+//   Sparse embedding lookups on CPU, which reduce the rows of the table
+//   without materializing them.
+//
+// Independent MatMuls of the same shapes -> BatchMatMulV3 (horizontal fusion)
+//   Small MatMuls on GPU are packed into a single batched kernel, to save the
+//   overhead of launching one kernel per MatMul.
+//
+// ResourceApply[Adam|Momentum|KerasMomentum|AdagradV2] of the same
+// hyperparameters -> _ResourceMultiApply[...] (multi-tensor apply)
+//   Optimizer updates of many variables on CPU run in one kernel, which
+//   updates them in chunks, instead of one op per variable.
 
 namespace {
 
@@ -106,6 +132,15 @@ constexpr char kFill[] = "fill";
 
 constexpr int kMissingIndex = -1;
 
+// MatMuls on GPU which are estimated to run for less than this are dominated
+// by the overhead of launching their kernel, and are fused horizontally.
+constexpr int64_t kMaxHorizontalFusionMatMulNanos = 10000;
+// Upper bound on the number of MatMuls fused into one BatchMatMulV3.
+constexpr int kMaxHorizontalFusionSize = 64;
+// Upper bound on the number of variables updated by one multi-tensor apply,
+// whose kernel locks all of them at once.
+constexpr int kMaxMultiTensorApplySize = 128;
+
 struct RemapperContext {
   explicit RemapperContext(GrapplerItem* item, Status* status,
                            RewriterConfig::CpuLayout cpu_layout_conversion,
@@ -170,6 +205,17 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// GatherV2 or ResourceGather of the rows of an embedding table followed by a
+// SparseSegmentSum, SparseSegmentMean or SparseSegmentSqrtN.
+struct SparseEmbeddingLookup {
+  SparseEmbeddingLookup() = default;
+  SparseEmbeddingLookup(int gather, int segment_reduction)
+      : gather(gather), segment_reduction(segment_reduction) {}
+
+  int gather = kMissingIndex;
+  int segment_reduction = kMissingIndex;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -388,6 +434,18 @@ bool BlasLtMatmulEnabled() {
   return is_enabled;
 }
 
+// The GPU kernel of _FusedAttention is opt-in until it is tuned on more
+// devices.
+bool FusedAttentionOnGpuEnabled() {
+  static bool is_enabled = [] {
+    bool is_enabled = false;
+    TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar(
+        "TF_USE_GPU_FUSED_ATTENTION", /*default_val=*/false, &is_enabled));
+    return is_enabled;
+  }();
+  return is_enabled;
+}
+
 bool IsGpuCompatibleDataFormat(const RemapperContext& ctx,
                                const NodeDef* conv2d) {
   DCHECK(IsConv2D(*conv2d)) << "Expected Conv2D op";
@@ -2316,6 +2374,411 @@ bool FindMklLayerNorm(RemapperContext* ctx, int node_index,
   return found_op_type_match;
 }
 
+// Returns true if the Const node `axis_node` holds a single reduction axis
+// which is the last dimension of a tensor of rank `rank`.
+bool IsLastAxisReduction(const NodeDef& axis_node, int rank) {
+  Tensor axis_tensor;
+  if (!axis_node.attr().count("value") ||
+      !axis_tensor.FromProto(axis_node.attr().at("value").tensor()) ||
+      axis_tensor.NumElements() != 1) {
+    return false;
+  }
+  int64_t axis;
+  if (axis_tensor.dtype() == DT_INT32) {
+    axis = axis_tensor.flat<int32>()(0);
+  } else if (axis_tensor.dtype() == DT_INT64) {
+    axis = axis_tensor.flat<int64_t>()(0);
+  } else {
+    return false;
+  }
+  return axis == rank - 1 || axis == -1;
+}
+
+// Returns the scalar float value of a Const node in `value`.
+bool GetScalarFloatConst(const NodeDef& const_node, float* value) {
+  Tensor const_tensor;
+  if (!const_node.attr().count("value") ||
+      !const_tensor.FromProto(const_node.attr().at("value").tensor()) ||
+      const_tensor.dtype() != DT_FLOAT || const_tensor.NumElements() != 1) {
+    return false;
+  }
+  *value = const_tensor.flat<float>()(0);
+  return true;
+}
+
+// Without oneDNN, the layer normalization subgraphs matched by
+// IsCommonNormPattern are remapped on CPU to _FusedLayerNorm, which
+// normalizes the last dimension of its input with a single pass over memory
+// for the statistics and one for the output.
+bool FindFusedLayerNorm(RemapperContext* ctx, int node_index,
+                        std::map<string, int>* matched_nodes_map,
+                        std::set<int>* remove_node_indices,
+                        std::vector<string>* input_node_names,
+                        float* epsilon) {
+  if (IsMKLEnabled() || ctx->xla_cpu_jit_disable_fusion) return false;
+  const auto* node_def = ctx->graph_view.GetNode(node_index)->node();
+  if (!NodeIsOnCpu(node_def) || !HasDataType(node_def, DT_FLOAT)) return false;
+
+  if (!IsCommonNormPattern(ctx, node_index, matched_nodes_map,
+                           remove_node_indices)) {
+    return false;
+  }
+  for (int index : *remove_node_indices) {
+    if (IsInPreserveSet(*ctx, ctx->graph_view.GetNode(index)->node()))
+      return false;
+  }
+  auto get_node = [&](const string& label) {
+    return ctx->graph_view.GetNode(matched_nodes_map->at(label))->node();
+  };
+
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/true,
+        /*include_output_tensor_values=*/true);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+
+  // Both means must reduce the last dimension only, keeping it for the
+  // broadcasts which follow.
+  const NodeDef* mean0_node = get_node("mean0");
+  const NodeDef* mean1_node = get_node("mean1");
+  const auto& input_props =
+      ctx->graph_properties.GetInputProperties(mean1_node->name());
+  const auto& output_props =
+      ctx->graph_properties.GetOutputProperties(node_def->name());
+  if (input_props.empty() || output_props.empty()) return false;
+  const TensorShapeProto& input_shape = input_props[0].shape();
+  if (input_shape.unknown_rank() || input_shape.dim_size() < 1 ||
+      !ShapesSymbolicallyEqual(input_shape, output_props[0].shape())) {
+    return false;
+  }
+  const int rank = input_shape.dim_size();
+  for (const NodeDef* mean_node : {mean0_node, mean1_node}) {
+    bool keep_dims = false;
+    if (!TryGetNodeAttr(*mean_node, "keep_dims", &keep_dims) || !keep_dims)
+      return false;
+  }
+  if (!IsLastAxisReduction(*get_node("r_indices0"), rank) ||
+      !IsLastAxisReduction(*get_node("r_indices1"), rank)) {
+    return false;
+  }
+
+  // The scale and offset are applied along the last dimension, and must not
+  // broadcast.
+  const int64_t depth = input_shape.dim(rank - 1).size();
+  if (depth < 0) return false;
+  for (const char* label : {"gamma", "beta"}) {
+    const auto& props =
+        ctx->graph_properties.GetOutputProperties(get_node(label)->name());
+    if (props.empty() || props[0].dtype() != DT_FLOAT) return false;
+    const TensorShapeProto& shape = props[0].shape();
+    if (shape.unknown_rank() || shape.dim_size() != 1 ||
+        shape.dim(0).size() != depth) {
+      return false;
+    }
+  }
+  if (!GetScalarFloatConst(*get_node("epsilon"), epsilon)) return false;
+
+  input_node_names->clear();
+  input_node_names->push_back(mean1_node->input(0));
+  input_node_names->push_back(get_node("gamma")->name());
+  input_node_names->push_back(get_node("beta")->name());
+  return true;
+}
+
+// Scaled dot-product attention is remapped to _FusedAttention, which never
+// materializes the score matrix, on CPU without oneDNN and, with
+// TF_USE_GPU_FUSED_ATTENTION=true, on GPU:
+//
+//   BatchMatMulV2(
+//       Softmax(BatchMatMulV2(query, key, adj_y=true) [* scale] [+ bias]),
+//       value)
+//
+// where the optional scale is a scalar Const multiplied or divided by, and the
+// optional bias, such as a padding mask, broadcasts to the scores.
+bool FindFusedAttention(RemapperContext* ctx, int node_index,
+                        std::map<string, int>* matched_nodes_map,
+                        std::set<int>* remove_node_indices, float* scale) {
+  // The most batch dimensions of a bias, and the largest depth on GPU, which
+  // the fused kernels support.
+  constexpr int kMaxBiasBatchDims = 6;
+  constexpr int64_t kMaxGpuDepth = 128;
+  const auto* node_def = ctx->graph_view.GetNode(node_index)->node();
+  if (node_def->op() != "BatchMatMulV2") return false;
+  const DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+  const bool on_gpu = NodeIsOnGpu(node_def);
+  if (on_gpu) {
+    if (!FusedAttentionOnGpuEnabled() || ctx->xla_auto_clustering_on ||
+        (dtype != DT_FLOAT && dtype != DT_HALF)) {
+      return false;
+    }
+  } else if (!NodeIsOnCpu(node_def) || IsMKLEnabled() ||
+             ctx->xla_cpu_jit_disable_fusion || dtype != DT_FLOAT) {
+    return false;
+  }
+
+  using utils::MatchingDirection;
+  using utils::NodeStatus;
+  // clang-format off
+  const utils::OpTypePattern scores_pattern =
+    {"BatchMatMulV2", "scores", NodeStatus::kRemove,
+      {
+        {"*", "query", NodeStatus::kRemain},
+        {"*", "key", NodeStatus::kRemain}
+      }
+    };
+  auto attention_pattern = [](const utils::OpTypePattern& logits_pattern) {
+    return utils::OpTypePattern{
+      "BatchMatMulV2", "output", NodeStatus::kReplace,
+      {
+        {"Softmax", "softmax", NodeStatus::kRemove, {logits_pattern}},
+        {"*", "value", NodeStatus::kRemain}
+      }
+    };
+  };
+  const utils::OpTypePattern scaled_scores_pattern =
+    {"Mul|RealDiv", "scaled_scores", NodeStatus::kRemove,
+      {
+        scores_pattern,
+        {"Const", "scale", NodeStatus::kRemain}
+      }
+    };
+  auto biased_pattern = [](const utils::OpTypePattern& logits_pattern) {
+    return utils::OpTypePattern{
+      "Add|AddV2", "biased_scores", NodeStatus::kRemove,
+      {
+        logits_pattern,
+        {"*", "bias", NodeStatus::kRemain}
+      }
+    };
+  };
+  // clang-format on
+
+  utils::SubGraphMatcher<MatchingDirection::kFollowInputs> graph_matcher(
+      &(ctx->graph_view));
+  bool found_op_type_match = false;
+  for (const auto& pattern :
+       {attention_pattern(biased_pattern(scaled_scores_pattern)),
+        attention_pattern(biased_pattern(scores_pattern)),
+        attention_pattern(scaled_scores_pattern),
+        attention_pattern(scores_pattern)}) {
+    matched_nodes_map->clear();
+    remove_node_indices->clear();
+    found_op_type_match = graph_matcher.GetMatchedNodes(
+        pattern, ctx->nodes_to_preserve, ctx->graph_view.GetNode(node_index),
+        matched_nodes_map, remove_node_indices);
+    if (found_op_type_match) break;
+  }
+  if (!found_op_type_match) return false;
+  auto get_node = [&](const string& label) {
+    return ctx->graph_view.GetNode(matched_nodes_map->at(label))->node();
+  };
+
+  const NodeDef* scores_node = get_node("scores");
+  bool adj_x = true;
+  bool adj_y = false;
+  if (!TryGetNodeAttr(*scores_node, "adj_x", &adj_x) || adj_x ||
+      !TryGetNodeAttr(*scores_node, "adj_y", &adj_y) || !adj_y ||
+      !TryGetNodeAttr(*node_def, "adj_x", &adj_x) || adj_x ||
+      !TryGetNodeAttr(*node_def, "adj_y", &adj_y) || adj_y ||
+      !HasDataType(scores_node, dtype) ||
+      !HasDataType(get_node("softmax"), dtype)) {
+    return false;
+  }
+
+  *scale = 1.0f;
+  if (matched_nodes_map->count("scaled_scores")) {
+    const NodeDef* scaled_scores_node = get_node("scaled_scores");
+    if (!HasDataType(scaled_scores_node, dtype) ||
+        !GetScalarFloatConst(*get_node("scale"), scale)) {
+      return false;
+    }
+    if (scaled_scores_node->op() == "RealDiv") {
+      // The scores must be the dividend.
+      if (scaled_scores_node->input(1) != get_node("scale")->name() ||
+          *scale == 0.0f) {
+        return false;
+      }
+      *scale = 1.0f / *scale;
+    }
+  }
+
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/true,
+        /*include_output_tensor_values=*/true);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+
+  // The fused kernel does not broadcast, so query, key and value must have
+  // the same batch dimensions.
+  const auto& scores_props =
+      ctx->graph_properties.GetInputProperties(scores_node->name());
+  const auto& output_props =
+      ctx->graph_properties.GetInputProperties(node_def->name());
+  if (scores_props.size() != 2 || output_props.size() != 2) return false;
+  const TensorShapeProto& query_shape = scores_props[0].shape();
+  const TensorShapeProto& key_shape = scores_props[1].shape();
+  const TensorShapeProto& value_shape = output_props[1].shape();
+  if (query_shape.unknown_rank() || key_shape.unknown_rank() ||
+      value_shape.unknown_rank()) {
+    return false;
+  }
+  const int rank = query_shape.dim_size();
+  if (rank < 2 || key_shape.dim_size() != rank ||
+      value_shape.dim_size() != rank) {
+    return false;
+  }
+  for (int i = 0; i < rank - 2; ++i) {
+    const int64_t size = query_shape.dim(i).size();
+    // Unknown dimensions (-1) might broadcast, symbolic ones are equal.
+    if (size == -1 || key_shape.dim(i).size() != size ||
+        value_shape.dim(i).size() != size) {
+      return false;
+    }
+  }
+  if (on_gpu) {
+    const int64_t depth = query_shape.dim(rank - 1).size();
+    const int64_t value_depth = value_shape.dim(rank - 1).size();
+    if (depth < 0 || depth > kMaxGpuDepth || value_depth < 0 ||
+        value_depth > kMaxGpuDepth) {
+      return false;
+    }
+  }
+
+  if (matched_nodes_map->count("biased_scores")) {
+    const NodeDef* biased_scores_node = get_node("biased_scores");
+    if (!HasDataType(biased_scores_node, dtype)) return false;
+    const auto& biased_props =
+        ctx->graph_properties.GetInputProperties(biased_scores_node->name());
+    if (biased_props.size() != 2) return false;
+    // The bias must have the rank of the scores, and every one of its
+    // dimensions must be 1 or match the scores.
+    const TensorShapeProto& bias_shape = biased_props[1].shape();
+    if (bias_shape.unknown_rank() || bias_shape.dim_size() != rank ||
+        rank - 2 > kMaxBiasBatchDims) {
+      return false;
+    }
+    for (int i = 0; i < rank; ++i) {
+      const int64_t scores_size = i == rank - 1
+                                      ? key_shape.dim(rank - 2).size()
+                                      : query_shape.dim(i).size();
+      const int64_t size = bias_shape.dim(i).size();
+      if (size != 1 && (size == -1 || size != scores_size)) return false;
+    }
+  }
+  return true;
+}
+
+// Returns true if `target` is a transitive regular or control fanin of
+// `node`.
+bool IsTransitiveFanin(const utils::MutableNodeView& node,
+                       const utils::MutableNodeView& target) {
+  std::vector<const utils::MutableNodeView*> stack = {&node};
+  absl::flat_hash_set<const utils::MutableNodeView*> visited;
+  while (!stack.empty()) {
+    const utils::MutableNodeView* current = stack.back();
+    stack.pop_back();
+    if (!visited.insert(current).second) continue;
+    if (current == &target) return true;
+    for (const auto& fanin : current->GetRegularFanins()) {
+      stack.push_back(fanin.node_view());
+    }
+    for (const auto& fanin : current->GetControllingFanins()) {
+      stack.push_back(fanin.node_view());
+    }
+  }
+  return false;
+}
+
+// The sparse embedding lookups of tf.nn.embedding_lookup_sparse without
+// weights are remapped on CPU to _FusedSparseEmbeddingLookup, or to
+// _FusedResourceSparseEmbeddingLookup for resource variables, which reduce
+// the rows of the table without materializing the gathered rows:
+//
+//   SparseSegment[Sum|Mean|SqrtN](GatherV2|ResourceGather(params, ids),
+//                                 indices, segment_ids)
+bool FindSparseEmbeddingLookup(RemapperContext* ctx, int node_index,
+                               SparseEmbeddingLookup* matched) {
+  if (ctx->xla_cpu_jit_disable_fusion) return false;
+  const auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if ((node_def->op() != "SparseSegmentSum" &&
+       node_def->op() != "SparseSegmentMean" &&
+       node_def->op() != "SparseSegmentSqrtN") ||
+      !NodeIsOnCpu(node_def) || !HasDataType(node_def, DT_FLOAT) ||
+      node_view->NumRegularFanins() != 3) {
+    return false;
+  }
+
+  const auto& data_fanin = node_view->GetRegularFanin(0);
+  auto* gather_view = data_fanin.node_view();
+  const auto* gather_def = gather_view->node();
+  if (data_fanin.index() != 0 || !NodeIsOnCpu(gather_def) ||
+      !HasAtMostOneFanoutAtPort0(*gather_view) ||
+      IsInPreserveSet(*ctx, gather_def)) {
+    return false;
+  }
+  int batch_dims = 0;
+  if (TryGetNodeAttr(*gather_def, "batch_dims", &batch_dims) &&
+      batch_dims != 0) {
+    return false;
+  }
+  if (gather_def->op() == "GatherV2") {
+    if (!HasDataType(gather_def, DT_FLOAT, "Tparams") ||
+        gather_view->NumRegularFanins() != 3) {
+      return false;
+    }
+    // Only gathers of rows.
+    const NodeDef* axis_node =
+        gather_view->GetRegularFanin(2).node_view()->node();
+    Tensor axis;
+    if (!IsConstant(*axis_node) || !axis_node->attr().count("value") ||
+        !axis.FromProto(axis_node->attr().at("value").tensor()) ||
+        axis.NumElements() != 1 ||
+        (axis.dtype() == DT_INT32 ? axis.flat<int32>()(0)
+                                  : axis.flat<int64_t>()(0)) != 0) {
+      return false;
+    }
+  } else if (gather_def->op() == "ResourceGather") {
+    if (!HasDataType(gather_def, DT_FLOAT, "dtype")) return false;
+  } else {
+    return false;
+  }
+
+  // The fused node waits for the control fanouts of the gather instead, which
+  // must then not be fanins of the segment reduction.
+  for (const auto& fanout : gather_view->GetControlledFanouts()) {
+    if (IsTransitiveFanin(*node_view, *fanout.node_view())) return false;
+  }
+
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/true,
+        /*include_output_tensor_values=*/true);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+  // The fused kernels look up a vector of ids.
+  const auto& gather_props =
+      ctx->graph_properties.GetInputProperties(gather_def->name());
+  if (gather_props.size() < 2 || gather_props[1].shape().unknown_rank() ||
+      gather_props[1].shape().dim_size() != 1) {
+    return false;
+  }
+
+  *matched = SparseEmbeddingLookup(gather_view->node_index(), node_index);
+  return true;
+}
+
 bool FindFusedBatchNorm(const RemapperContext& ctx, int node_index,
                         FusedBatchNorm* matched) {
   const auto* node_view = ctx.graph_view.GetNode(node_index);
@@ -3878,6 +4341,133 @@ Status AddMklLayerNorm(RemapperContext* ctx,
   return absl::OkStatus();
 }
 
+Status AddFusedLayerNorm(RemapperContext* ctx,
+                         const std::map<string, int>& matched_nodes_map,
+                         const std::set<int>& remove_node_indices,
+                         const std::vector<string>& input_node_names,
+                         std::vector<bool>* invalidated_nodes,
+                         std::vector<bool>* nodes_to_delete,
+                         const float epsilon) {
+  auto* output_node =
+      ctx->graph_view.GetNode(matched_nodes_map.at("output"))->node();
+
+  NodeDef fused_node;
+  fused_node.set_name(output_node->name());
+  fused_node.set_op("_FusedLayerNorm");
+  fused_node.set_device(output_node->device());
+  for (const auto& name : input_node_names) fused_node.add_input(name);
+  auto* attr = fused_node.mutable_attr();
+  (*attr)["T"] = output_node->attr().at("T");
+  SetAttrValue(epsilon, &(*attr)["epsilon"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_node), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+  (*invalidated_nodes)[matched_nodes_map.at("output")] = true;
+
+  for (const auto& node_idx : remove_node_indices) {
+    (*nodes_to_delete)[node_idx] = true;
+  }
+  return absl::OkStatus();
+}
+
+Status AddFusedAttention(RemapperContext* ctx,
+                         const std::map<string, int>& matched_nodes_map,
+                         const std::set<int>& remove_node_indices,
+                         std::vector<bool>* invalidated_nodes,
+                         std::vector<bool>* nodes_to_delete,
+                         const float scale) {
+  auto* output_node =
+      ctx->graph_view.GetNode(matched_nodes_map.at("output"))->node();
+  auto* scores_node =
+      ctx->graph_view.GetNode(matched_nodes_map.at("scores"))->node();
+
+  NodeDef fused_node;
+  fused_node.set_name(output_node->name());
+  fused_node.set_op("_FusedAttention");
+  fused_node.set_device(output_node->device());
+  fused_node.add_input(scores_node->input(0));  // 0: query
+  fused_node.add_input(scores_node->input(1));  // 1: key
+  fused_node.add_input(output_node->input(1));  // 2: value
+  const bool has_bias = matched_nodes_map.count("biased_scores") > 0;
+  if (has_bias) {
+    auto* biased_scores_node =
+        ctx->graph_view.GetNode(matched_nodes_map.at("biased_scores"))->node();
+    fused_node.add_input(biased_scores_node->input(1));  // 3: bias
+  }
+  auto* attr = fused_node.mutable_attr();
+  (*attr)["T"] = output_node->attr().at("T");
+  SetAttrValue(has_bias ? 1 : 0, &(*attr)["num_bias"]);
+  SetAttrValue(scale, &(*attr)["scale"]);
+  SetAttrValue(false, &(*attr)["causal"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_node), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+  (*invalidated_nodes)[matched_nodes_map.at("output")] = true;
+
+  for (const auto& node_idx : remove_node_indices) {
+    (*nodes_to_delete)[node_idx] = true;
+  }
+  return absl::OkStatus();
+}
+
+Status AddFusedSparseEmbeddingLookup(RemapperContext* ctx,
+                                     const SparseEmbeddingLookup& matched,
+                                     std::vector<bool>* invalidated_nodes,
+                                     std::vector<bool>* nodes_to_delete) {
+  auto* gather_view = ctx->graph_view.GetNode(matched.gather);
+  const NodeDef& gather = *gather_view->node();
+  const NodeDef& reduction =
+      *ctx->graph_view.GetNode(matched.segment_reduction)->node();
+
+  NodeDef fused_node;
+  fused_node.set_name(reduction.name());
+  const bool is_resource = gather.op() == "ResourceGather";
+  fused_node.set_op(is_resource ? "_FusedResourceSparseEmbeddingLookup"
+                                : "_FusedSparseEmbeddingLookup");
+  fused_node.set_device(reduction.device());
+  fused_node.add_input(gather.input(0));     // 0: params or resource
+  fused_node.add_input(gather.input(1));     // 1: ids
+  fused_node.add_input(reduction.input(1));  // 2: indices
+  fused_node.add_input(reduction.input(2));  // 3: segment_ids
+  for (const NodeDef* node : {&gather, &reduction}) {
+    for (const string& input : node->input()) {
+      if (IsControlInput(input)) fused_node.add_input(input);
+    }
+  }
+
+  auto* attr = fused_node.mutable_attr();
+  (*attr)[is_resource ? "dtype" : "T"] = reduction.attr().at("T");
+  (*attr)["Tids"] = gather.attr().at("Tindices");
+  for (const char* name : {"Tidx", "Tsegmentids"}) {
+    if (reduction.attr().count(name)) (*attr)[name] = reduction.attr().at(name);
+  }
+  SetAttrValue(0, &(*attr)["num_weights"]);
+  const string combiner = reduction.op() == "SparseSegmentSum"    ? "sum"
+                          : reduction.op() == "SparseSegmentMean" ? "mean"
+                                                                  : "sqrtn";
+  SetAttrValue(combiner, &(*attr)["combiner"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_node), &status);
+  TF_RETURN_IF_ERROR(status);
+  for (const auto& fanout : gather_view->GetControlledFanouts()) {
+    mutation->RemoveControllingFanin(fanout.node_view(), gather.name());
+    mutation->AddControllingFanin(fanout.node_view(), reduction.name());
+  }
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.segment_reduction] = true;
+  (*nodes_to_delete)[matched.gather] = true;
+  return absl::OkStatus();
+}
+
 Status ReplaceMulMaximumWithLeakyRelu(
     RemapperContext* ctx, const std::map<string, int>& matched_nodes_map,
     const std::set<int>& remove_node_indices,
@@ -4822,6 +5412,439 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
          is_act_biasadd_matmul_candidate();
 }
 
+// Returns true if `node_view` is a MatMul which may be fused horizontally with
+// other MatMuls, without looking at its shapes.
+bool IsHorizontalFusionCandidate(const RemapperContext& ctx,
+                                 const utils::MutableNodeView& node_view) {
+  const NodeDef* node = node_view.node();
+  return IsMatMul(*node) && NodeIsOnGpu(node) &&
+         IsGpuCompatibleDataType(node) && !IsInPreserveSet(ctx, node) &&
+         node_view.NumControllingFanins() == 0;
+}
+
+// Returns true if `properties` describe a matrix of a known shape.
+bool IsKnownMatrix(const OpInfo::TensorProperties& properties) {
+  const TensorShapeProto& shape = properties.shape();
+  if (shape.unknown_rank() || shape.dim_size() != 2) return false;
+  for (const auto& dim : shape.dim()) {
+    if (dim.size() < 0) return false;
+  }
+  return true;
+}
+
+// Returns the key of the MatMuls `node` can be fused horizontally with, or an
+// empty string if it's not worth fusing it.
+string HorizontalFusionKey(const GraphProperties& properties,
+                           const OpLevelCostEstimator& estimator,
+                           const NodeDef& node) {
+  const auto& inputs = properties.GetInputProperties(node.name());
+  if (inputs.size() != 2 || !IsKnownMatrix(inputs[0]) ||
+      !IsKnownMatrix(inputs[1])) {
+    return "";
+  }
+  OpContext op_context;
+  op_context.name = node.name();
+  op_context.op_info.set_op(node.op());
+  *op_context.op_info.mutable_attr() = node.attr();
+  for (const auto& input : inputs) {
+    *op_context.op_info.add_inputs() = input;
+  }
+  for (const auto& output : properties.GetOutputProperties(node.name())) {
+    *op_context.op_info.add_outputs() = output;
+  }
+  *op_context.op_info.mutable_device() = GetDeviceInfo(node.device());
+  const Costs costs = estimator.PredictCosts(op_context);
+  if (costs.inaccurate ||
+      costs.execution_time.count() > kMaxHorizontalFusionMatMulNanos) {
+    return "";
+  }
+  const auto& attr = node.attr();
+  return absl::StrCat(
+      node.device(), "|", DataTypeString(GetDataTypeFromAttr(node, "T")), "|",
+      attr.count("transpose_a") > 0 && attr.at("transpose_a").b(), "|",
+      attr.count("transpose_b") > 0 && attr.at("transpose_b").b(), "|",
+      inputs[0].shape().dim(0).size(), "x", inputs[0].shape().dim(1).size(),
+      "|", inputs[1].shape().dim(0).size(), "x",
+      inputs[1].shape().dim(1).size());
+}
+
+// Returns true if one of the nodes in `batch` is in the transitive fanin of
+// the node `node_index`. Nodes must be sorted topologically, and `batch`
+// holds nodes preceding `node_index`.
+bool DependsOnBatch(const RemapperContext& ctx, const std::vector<int>& batch,
+                    int node_index) {
+  const absl::flat_hash_set<int> members(batch.begin(), batch.end());
+  const int first = batch.front();
+  absl::flat_hash_set<int> visited;
+  std::vector<int> to_visit = {node_index};
+  while (!to_visit.empty()) {
+    const auto* node_view = ctx.graph_view.GetNode(to_visit.back());
+    to_visit.pop_back();
+    auto visit = [&](int fanin) {
+      if (members.contains(fanin)) return true;
+      if (fanin > first && visited.insert(fanin).second) {
+        to_visit.push_back(fanin);
+      }
+      return false;
+    };
+    for (const auto& fanin : node_view->GetRegularFanins()) {
+      if (visit(fanin.node_index())) return true;
+    }
+    for (const auto& fanin : node_view->GetControllingFanins()) {
+      if (visit(fanin.node_index())) return true;
+    }
+  }
+  return false;
+}
+
+// Finds the first batch of at least two independent MatMuls which can be fused
+// horizontally.
+bool FindHorizontalMatMulBatch(const RemapperContext& ctx,
+                               const GraphProperties& properties,
+                               const OpLevelCostEstimator& estimator,
+                               std::vector<int>* batch) {
+  std::map<string, std::vector<int>> groups;
+  const int num_nodes = ctx.graph_view.NumNodes();
+  for (int i = 0; i < num_nodes; ++i) {
+    const auto* node_view = ctx.graph_view.GetNode(i);
+    if (!IsHorizontalFusionCandidate(ctx, *node_view)) continue;
+    string key = HorizontalFusionKey(properties, estimator, *node_view->node());
+    if (!key.empty()) groups[key].push_back(i);
+  }
+  for (const auto& group : groups) {
+    const std::vector<int>& matmuls = group.second;
+    for (int first = 0; first + 1 < matmuls.size(); ++first) {
+      batch->assign({matmuls[first]});
+      for (int i = first + 1;
+           i < matmuls.size() && batch->size() < kMaxHorizontalFusionSize;
+           ++i) {
+        if (!DependsOnBatch(ctx, *batch, matmuls[i])) {
+          batch->push_back(matmuls[i]);
+        }
+      }
+      if (batch->size() > 1) return true;
+    }
+  }
+  batch->clear();
+  return false;
+}
+
+// Replaces the MatMuls of `batch` with a BatchMatMulV3 of their packed inputs.
+// The outputs are unpacked into Identity nodes which take the names of the
+// MatMuls.
+Status AddHorizontalMatMulFusion(RemapperContext* ctx,
+                                 const std::vector<int>& batch,
+                                 bool* fused) {
+  const NodeDef& first = *ctx->graph_view.GetNode(batch.front())->node();
+  const string prefix = absl::StrCat(first.name(), "/HorizontalFusion");
+  const string pack_a_name = absl::StrCat(prefix, "/pack_a");
+  const string pack_b_name = absl::StrCat(prefix, "/pack_b");
+  const string batch_matmul_name = absl::StrCat(prefix, "/batch_matmul");
+  const string unpack_name = absl::StrCat(prefix, "/unpack");
+  for (const string& name :
+       {pack_a_name, pack_b_name, batch_matmul_name, unpack_name}) {
+    if (ctx->graph_view.HasNode(name)) {
+      *fused = false;
+      return absl::OkStatus();
+    }
+  }
+  VLOG(2) << "Fuse " << batch.size() << " MatMuls horizontally into "
+          << batch_matmul_name << " on device=" << first.device();
+
+  const int num_matmuls = batch.size();
+  const auto& dtype = first.attr().at("T");
+  NodeDef pack_a;
+  pack_a.set_name(pack_a_name);
+  pack_a.set_op("Pack");
+  pack_a.set_device(first.device());
+  NodeDef pack_b = pack_a;
+  pack_b.set_name(pack_b_name);
+  for (int index : batch) {
+    const NodeDef& matmul = *ctx->graph_view.GetNode(index)->node();
+    pack_a.add_input(matmul.input(0));
+    pack_b.add_input(matmul.input(1));
+  }
+  for (NodeDef* pack : {&pack_a, &pack_b}) {
+    auto* attr = pack->mutable_attr();
+    (*attr)["T"] = dtype;
+    (*attr)["N"].set_i(num_matmuls);
+    (*attr)["axis"].set_i(0);
+  }
+
+  NodeDef batch_matmul;
+  batch_matmul.set_name(batch_matmul_name);
+  batch_matmul.set_op("BatchMatMulV3");
+  batch_matmul.set_device(first.device());
+  batch_matmul.add_input(pack_a_name);
+  batch_matmul.add_input(pack_b_name);
+  {
+    auto* attr = batch_matmul.mutable_attr();
+    (*attr)["Ta"] = dtype;
+    (*attr)["Tb"] = dtype;
+    (*attr)["Tout"] = dtype;
+    (*attr)["adj_x"].set_b(first.attr().count("transpose_a") > 0 &&
+                           first.attr().at("transpose_a").b());
+    (*attr)["adj_y"].set_b(first.attr().count("transpose_b") > 0 &&
+                           first.attr().at("transpose_b").b());
+  }
+
+  NodeDef unpack;
+  unpack.set_name(unpack_name);
+  unpack.set_op("Unpack");
+  unpack.set_device(first.device());
+  unpack.add_input(batch_matmul_name);
+  {
+    auto* attr = unpack.mutable_attr();
+    (*attr)["T"] = dtype;
+    (*attr)["num"].set_i(num_matmuls);
+    (*attr)["axis"].set_i(0);
+  }
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  for (NodeDef* node : {&pack_a, &pack_b, &batch_matmul, &unpack}) {
+    mutation->AddNode(std::move(*node), &status);
+    TF_RETURN_IF_ERROR(status);
+  }
+  for (int i = 0; i < num_matmuls; ++i) {
+    const NodeDef& matmul = *ctx->graph_view.GetNode(batch[i])->node();
+    NodeDef identity;
+    identity.set_name(matmul.name());
+    identity.set_op("Identity");
+    identity.set_device(matmul.device());
+    identity.add_input(absl::StrCat(unpack_name, ":", i));
+    (*identity.mutable_attr())["T"] = dtype;
+    mutation->AddNode(std::move(identity), &status);
+    TF_RETURN_IF_ERROR(status);
+  }
+  TF_RETURN_IF_ERROR(mutation->Apply());
+  *fused = true;
+  return absl::OkStatus();
+}
+
+// Fuses independent small MatMuls of the same shapes horizontally, until no
+// more of them can be fused.
+Status FuseHorizontalMatMuls(RemapperContext* ctx, const GrapplerItem& item) {
+  int num_candidates = 0;
+  for (int i = 0; i < ctx->graph_view.NumNodes(); ++i) {
+    if (IsHorizontalFusionCandidate(*ctx, *ctx->graph_view.GetNode(i))) {
+      ++num_candidates;
+    }
+  }
+  if (num_candidates < 2) return absl::OkStatus();
+
+  // The properties of the MatMuls were not changed by the other rewrites, but
+  // may not have been inferred yet.
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(
+      /*assume_valid_feeds=*/false,
+      /*aggressive_shape_inference=*/false,
+      /*include_input_tensor_values=*/false,
+      /*include_output_tensor_values=*/false));
+  OpLevelCostEstimator estimator;
+  std::vector<int> batch;
+  while (true) {
+    // Fusing a batch adds dependencies between the nodes of the graph, so the
+    // order and independence of the MatMuls are checked again each time.
+    TF_RETURN_IF_ERROR(
+        ctx->graph_view.SortTopologically(/*ignore_cycles=*/false, {}));
+    if (!FindHorizontalMatMulBatch(*ctx, properties, estimator, &batch)) break;
+    bool fused = false;
+    TF_RETURN_IF_ERROR(AddHorizontalMatMulFusion(ctx, batch, &fused));
+    if (!fused) break;
+  }
+  return absl::OkStatus();
+}
+
+// Describes an optimizer apply op which can be fused with other applies of
+// the same op and hyperparameters into a multi-tensor apply. Its first
+// `num_variable_lists` inputs are the variable and its slots, and the other
+// inputs but `grad_index` are the scalar hyperparameters.
+struct MultiTensorApply {
+  const char* op;
+  const char* fused_op;
+  int num_inputs;
+  int num_variable_lists;
+  int grad_index;
+  const char* bool_attr;
+  bool bool_attr_default;
+};
+
+const MultiTensorApply* FindMultiTensorApply(const NodeDef& node) {
+  static const MultiTensorApply kMultiTensorApplies[] = {
+      {"ResourceApplyAdam", "_ResourceMultiApplyAdam", 10, 3, 9,
+       "use_nesterov", false},
+      {"ResourceApplyMomentum", "_ResourceMultiApplyMomentum", 5, 2, 3,
+       "use_nesterov", false},
+      {"ResourceApplyKerasMomentum", "_ResourceMultiApplyKerasMomentum", 5, 2,
+       3, "use_nesterov", false},
+      {"ResourceApplyAdagradV2", "_ResourceMultiApplyAdagradV2", 5, 2, 4,
+       "update_slots", true},
+  };
+  for (const auto& apply : kMultiTensorApplies) {
+    if (node.op() == apply.op) return &apply;
+  }
+  return nullptr;
+}
+
+// Returns the key of the applies `node` can be fused with, or an empty string
+// if it can't be fused.
+string MultiTensorApplyKey(const RemapperContext& ctx,
+                           const utils::MutableNodeView& node_view) {
+  const NodeDef* node = node_view.node();
+  const MultiTensorApply* apply = FindMultiTensorApply(*node);
+  if (apply == nullptr || !NodeIsOnCpu(node) || IsInPreserveSet(ctx, node) ||
+      node_view.NumRegularFanins() != apply->num_inputs) {
+    return "";
+  }
+  const DataType dtype = GetDataTypeFromAttr(*node, "T");
+  if (dtype != DT_HALF && dtype != DT_BFLOAT16 && dtype != DT_FLOAT &&
+      dtype != DT_DOUBLE) {
+    return "";
+  }
+  const auto& attr = node->attr();
+  const bool bool_attr = attr.count(apply->bool_attr) > 0
+                             ? attr.at(apply->bool_attr).b()
+                             : apply->bool_attr_default;
+  string key = absl::StrCat(
+      node->op(), "|", node->device(), "|", DataTypeString(dtype), "|",
+      attr.count("use_locking") > 0 && attr.at("use_locking").b(), "|",
+      bool_attr);
+  for (int i = apply->num_variable_lists; i < apply->num_inputs; ++i) {
+    if (i != apply->grad_index) absl::StrAppend(&key, "|", node->input(i));
+  }
+  return key;
+}
+
+// Finds the first batch of at least two independent applies which can be
+// fused into a multi-tensor apply, and which update distinct variables.
+bool FindMultiTensorApplyBatch(const RemapperContext& ctx,
+                               std::vector<int>* batch) {
+  std::map<string, std::vector<int>> groups;
+  const int num_nodes = ctx.graph_view.NumNodes();
+  for (int i = 0; i < num_nodes; ++i) {
+    string key = MultiTensorApplyKey(ctx, *ctx.graph_view.GetNode(i));
+    if (!key.empty()) groups[key].push_back(i);
+  }
+  for (const auto& group : groups) {
+    const std::vector<int>& applies = group.second;
+    const int num_variable_lists =
+        FindMultiTensorApply(*ctx.graph_view.GetNode(applies.front())->node())
+            ->num_variable_lists;
+    for (int first = 0; first + 1 < applies.size(); ++first) {
+      batch->assign({applies[first]});
+      absl::flat_hash_set<string> variables;
+      auto add_variables = [&](const NodeDef& node) {
+        for (int i = 0; i < num_variable_lists; ++i) {
+          if (!variables.insert(node.input(i)).second) return false;
+        }
+        return true;
+      };
+      if (!add_variables(*ctx.graph_view.GetNode(applies[first])->node())) {
+        continue;
+      }
+      for (int i = first + 1;
+           i < applies.size() && batch->size() < kMaxMultiTensorApplySize;
+           ++i) {
+        const NodeDef& node = *ctx.graph_view.GetNode(applies[i])->node();
+        bool distinct = true;
+        for (int j = 0; j < num_variable_lists; ++j) {
+          distinct = distinct && !variables.contains(node.input(j));
+        }
+        if (distinct && !DependsOnBatch(ctx, *batch, applies[i])) {
+          add_variables(node);
+          batch->push_back(applies[i]);
+        }
+      }
+      if (batch->size() > 1) return true;
+    }
+  }
+  batch->clear();
+  return false;
+}
+
+// Replaces the applies of `batch` with a multi-tensor apply. The applies are
+// replaced by NoOps of the same names, which depend on the fused node, so that
+// their control fanouts still wait for the update.
+Status AddMultiTensorApply(RemapperContext* ctx, const std::vector<int>& batch,
+                           bool* fused) {
+  const NodeDef& first = *ctx->graph_view.GetNode(batch.front())->node();
+  const MultiTensorApply& apply = *FindMultiTensorApply(first);
+  const string fused_name = absl::StrCat(first.name(), "/MultiTensorApply");
+  if (ctx->graph_view.HasNode(fused_name)) {
+    *fused = false;
+    return absl::OkStatus();
+  }
+  VLOG(2) << "Fuse " << batch.size() << " " << first.op() << " into "
+          << fused_name << " on device=" << first.device();
+
+  NodeDef fused_node;
+  fused_node.set_name(fused_name);
+  fused_node.set_op(apply.fused_op);
+  fused_node.set_device(first.device());
+  // The inputs of the fused op are those of the apply, where the variable
+  // lists and the gradient are lists of the inputs of all the applies.
+  for (int i = 0; i < apply.num_inputs; ++i) {
+    if (i < apply.num_variable_lists || i == apply.grad_index) {
+      for (int index : batch) {
+        fused_node.add_input(ctx->graph_view.GetNode(index)->node()->input(i));
+      }
+    } else {
+      fused_node.add_input(first.input(i));
+    }
+  }
+  std::set<string> control_inputs;
+  for (int index : batch) {
+    const NodeDef& node = *ctx->graph_view.GetNode(index)->node();
+    for (int i = apply.num_inputs; i < node.input_size(); ++i) {
+      control_inputs.insert(node.input(i));
+    }
+  }
+  for (const string& input : control_inputs) fused_node.add_input(input);
+  const auto& first_attr = first.attr();
+  auto* attr = fused_node.mutable_attr();
+  (*attr)["T"] = first_attr.at("T");
+  (*attr)["N"].set_i(batch.size());
+  (*attr)["use_locking"].set_b(first_attr.count("use_locking") > 0 &&
+                               first_attr.at("use_locking").b());
+  (*attr)[apply.bool_attr].set_b(first_attr.count(apply.bool_attr) > 0
+                                     ? first_attr.at(apply.bool_attr).b()
+                                     : apply.bool_attr_default);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_node), &status);
+  TF_RETURN_IF_ERROR(status);
+  for (int index : batch) {
+    const NodeDef& node = *ctx->graph_view.GetNode(index)->node();
+    NodeDef no_op;
+    no_op.set_name(node.name());
+    no_op.set_op("NoOp");
+    no_op.set_device(node.device());
+    no_op.add_input(AsControlDependency(fused_name));
+    mutation->AddNode(std::move(no_op), &status);
+    TF_RETURN_IF_ERROR(status);
+  }
+  TF_RETURN_IF_ERROR(mutation->Apply());
+  *fused = true;
+  return absl::OkStatus();
+}
+
+// Fuses the optimizer applies of variables on CPU into multi-tensor applies,
+// until no more of them can be fused.
+Status FuseMultiTensorApplies(RemapperContext* ctx) {
+  std::vector<int> batch;
+  while (true) {
+    TF_RETURN_IF_ERROR(
+        ctx->graph_view.SortTopologically(/*ignore_cycles=*/false, {}));
+    if (!FindMultiTensorApplyBatch(*ctx, &batch)) break;
+    bool fused = false;
+    TF_RETURN_IF_ERROR(AddMultiTensorApply(ctx, batch, &fused));
+    if (!fused) break;
+  }
+  return absl::OkStatus();
+}
+
 inline bool IsXlaCpuGlobalJitOn() {
   std::vector<string> tf_xla_flags;
   const std::string tf_xla_cpu_global_jit = "--tf_xla_cpu_global_jit";
@@ -5091,6 +6114,40 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    if (allow_non_differentiable_rewrites) {
+      // Remap layer normalization subgraphs into _FusedLayerNorm on CPU.
+      std::vector<string> input_node_names;
+      float epsilon = 0.001;
+      if (FindFusedLayerNorm(&ctx, i, &matched_nodes_map, &remove_node_indices,
+                             &input_node_names, &epsilon)) {
+        TF_RETURN_IF_ERROR(AddFusedLayerNorm(
+            &ctx, matched_nodes_map, remove_node_indices, input_node_names,
+            &invalidated_nodes, &nodes_to_delete, epsilon));
+        continue;
+      }
+
+      // Remap scaled dot-product attention into _FusedAttention.
+      float scale = 1.0f;
+      if (FindFusedAttention(&ctx, i, &matched_nodes_map, &remove_node_indices,
+                             &scale)) {
+        TF_RETURN_IF_ERROR(AddFusedAttention(&ctx, matched_nodes_map,
+                                             remove_node_indices,
+                                             &invalidated_nodes,
+                                             &nodes_to_delete, scale));
+        continue;
+      }
+
+      // Remap sparse embedding lookups into _FusedSparseEmbeddingLookup or
+      // _FusedResourceSparseEmbeddingLookup on CPU.
+      SparseEmbeddingLookup sparse_embedding_lookup;
+      if (FindSparseEmbeddingLookup(&ctx, i, &sparse_embedding_lookup)) {
+        TF_RETURN_IF_ERROR(AddFusedSparseEmbeddingLookup(
+            &ctx, sparse_embedding_lookup, &invalidated_nodes,
+            &nodes_to_delete));
+        continue;
+      }
+    }
+
     // Fusions are disabled on XLA CPU in IsCpuCompatible(...) invoked by the
     // following fusions.
     //
@@ -5200,6 +6257,13 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   }
   TF_RETURN_IF_ERROR(mutation->Apply());
 
+  // Leave the small MatMuls and the optimizer updates to XLA when it clusters
+  // the graph.
+  if (!xla_auto_clustering_on_) {
+    TF_RETURN_IF_ERROR(FuseHorizontalMatMuls(&ctx, mutable_item));
+    TF_RETURN_IF_ERROR(FuseMultiTensorApplies(&ctx));
+  }
+
   *optimized_graph = std::move(mutable_item.graph);
 
   return absl::OkStatus();
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/cc/ops/nn_ops_internal.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -1428,6 +1430,143 @@ TEST_F(RemapperTest, FuseConv2DWithAdd) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
 }
 
+TEST_F(RemapperTest, FuseIndependentMatMulsHorizontally) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto a0 = ops::Const(s.WithOpName("a0"),
+                      GenerateRandomTensor<DT_FLOAT>({2, 3}));
+  auto b0 = ops::Const(s.WithOpName("b0"),
+                      GenerateRandomTensor<DT_FLOAT>({3, 4}));
+  auto a1 = ops::Const(s.WithOpName("a1"),
+                      GenerateRandomTensor<DT_FLOAT>({2, 3}));
+  auto b1 = ops::Const(s.WithOpName("b1"),
+                      GenerateRandomTensor<DT_FLOAT>({3, 4}));
+  auto b2 = ops::Const(s.WithOpName("b2"),
+                      GenerateRandomTensor<DT_FLOAT>({3, 4}));
+  auto matmul0 = ops::MatMul(s.WithOpName("matmul0"), a0, b0);
+  auto matmul1 = ops::MatMul(s.WithOpName("matmul1"), a1, b1);
+  // matmul2 depends on matmul0, so it can't be fused with it.
+  auto a2 = ops::Slice(s.WithOpName("a2"), matmul0, {0, 0}, {2, 3});
+  auto matmul2 = ops::MatMul(s.WithOpName("matmul2"), a2, b2);
+  auto fetch0 = ops::Identity(s.WithOpName("fetch0"), matmul0);
+  auto fetch1 = ops::Identity(s.WithOpName("fetch1"), matmul1);
+  auto fetch2 = ops::Identity(s.WithOpName("fetch2"), matmul2);
+
+  GrapplerItem item;
+  item.fetch = {"fetch0", "fetch1", "fetch2"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on GPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:GPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "matmul0" || node.name() == "matmul1") {
+      EXPECT_EQ(node.op(), "Identity");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_TRUE(
+          absl::StrContains(node.input(0), "/HorizontalFusion/unpack"));
+      found++;
+    } else if (node.name() == "matmul2") {
+      EXPECT_EQ(node.op(), "MatMul");
+      found++;
+    } else if (node.op() == "BatchMatMulV3") {
+      ASSERT_EQ(node.input_size(), 2);
+      EXPECT_TRUE(
+          absl::StrContains(node.input(0), "/HorizontalFusion/pack_a"));
+      EXPECT_TRUE(
+          absl::StrContains(node.input(1), "/HorizontalFusion/pack_b"));
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 4);
+
+  if (GetNumAvailableGPUs() > 0) {
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+    ASSERT_EQ(tensors_expected.size(), 3);
+    auto tensors = EvaluateNodes(output, item.fetch);
+    ASSERT_EQ(tensors.size(), 3);
+    for (int i = 0; i < 3; ++i) {
+      test::ExpectTensorNear<float>(tensors[i], tensors_expected[i], 1e-6);
+    }
+  }
+}
+
+TEST_F(RemapperTest, FuseResourceAppliesIntoMultiTensorApply) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto lr = ops::Const(s.WithOpName("lr"), 0.1f);
+  auto momentum = ops::Const(s.WithOpName("momentum"), 0.9f);
+  auto other_lr = ops::Const(s.WithOpName("other_lr"), 0.2f);
+  auto grad = ops::Const(s.WithOpName("grad"), 1.0f, {4});
+  std::vector<Output> vars, accums;
+  for (int i = 0; i < 4; ++i) {
+    vars.push_back(
+        ops::Placeholder(s.WithOpName(absl::StrCat("var", i)), DT_RESOURCE));
+    accums.push_back(ops::Placeholder(s.WithOpName(absl::StrCat("accum", i)),
+                                      DT_RESOURCE));
+  }
+  auto apply0 = ops::ResourceApplyMomentum(s.WithOpName("apply0"), vars[0],
+                                           accums[0], lr, grad, momentum);
+  auto apply1 = ops::ResourceApplyMomentum(s.WithOpName("apply1"), vars[1],
+                                           accums[1], lr, grad, momentum);
+  // apply2 has another learning rate, and apply3 updates var0 again.
+  auto apply2 = ops::ResourceApplyMomentum(s.WithOpName("apply2"), vars[2],
+                                           accums[2], other_lr, grad,
+                                           momentum);
+  auto apply3 = ops::ResourceApplyMomentum(s.WithOpName("apply3"), vars[0],
+                                           accums[3], lr, grad, momentum);
+  auto fetch = ops::NoOp(s.WithOpName("fetch")
+                             .WithControlDependencies(apply0.operation)
+                             .WithControlDependencies(apply1.operation)
+                             .WithControlDependencies(apply2.operation)
+                             .WithControlDependencies(apply3.operation));
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "apply0" || node.name() == "apply1") {
+      EXPECT_EQ(node.op(), "NoOp");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "^apply0/MultiTensorApply");
+      found++;
+    } else if (node.name() == "apply2" || node.name() == "apply3") {
+      EXPECT_EQ(node.op(), "ResourceApplyMomentum");
+      found++;
+    } else if (node.name() == "apply0/MultiTensorApply") {
+      EXPECT_EQ(node.op(), "_ResourceMultiApplyMomentum");
+      EXPECT_EQ(node.attr().at("N").i(), 2);
+      ASSERT_EQ(node.input_size(), 8);
+      EXPECT_EQ(node.input(0), "var0");
+      EXPECT_EQ(node.input(1), "var1");
+      EXPECT_EQ(node.input(2), "accum0");
+      EXPECT_EQ(node.input(3), "accum1");
+      EXPECT_EQ(node.input(4), "lr");
+      EXPECT_EQ(node.input(5), "grad");
+      EXPECT_EQ(node.input(6), "grad");
+      EXPECT_EQ(node.input(7), "momentum");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 5);
+}
+
 // Fuse  matmul + add {1,C}
 TEST_F(RemapperTest, FuseMatmulWithAdd) {
   if (!IsMKLEnabled()) GTEST_SKIP() << "Test only applicable to MKL.";
@@ -1699,6 +1838,346 @@ class FuseMklLayerNormPattern : public RemapperTest {
 
 TEST_F(FuseMklLayerNormPattern, F32) { RunTest<DT_FLOAT>(); }
 
+TEST_F(RemapperTest, FuseLayerNorm) {
+  if (IsMKLEnabled()) GTEST_SKIP() << "oneDNN uses _MklLayerNorm instead.";
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input = Placeholder(s.WithOpName("input"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 3, 8}));
+  auto r_indices = ops::Const(s.WithOpName("r_indices"), {2}, {1});
+  ops::Mean::Attrs attrs;
+  attrs = attrs.KeepDims(true);
+  auto mean = ops::Mean(s.WithOpName("mean"), input, r_indices, attrs);
+  auto s_diff = ops::SquaredDifference(s.WithOpName("s_diff"), input, mean);
+  auto variance = ops::Mean(s.WithOpName("variance"), s_diff, r_indices, attrs);
+  auto e_const = ops::Const(s.WithOpName("e_const"), {0.01f}, {});
+  auto add = ops::AddV2(s.WithOpName("add"), variance, e_const);
+  auto rsqrt = ops::Rsqrt(s.WithOpName("rsqrt"), add);
+  auto g_const = ops::Const(s.WithOpName("g_const"),
+                            GenerateRandomTensor<DT_FLOAT>({8}));
+  auto mul_1 = ops::Mul(s.WithOpName("mul_1"), rsqrt, g_const);
+  auto mul_0 = ops::Mul(s.WithOpName("mul_0"), input, mul_1);
+  auto mul_2 = ops::Mul(s.WithOpName("mul_2"), mean, mul_1);
+  auto b_const = ops::Const(s.WithOpName("b_const"),
+                            GenerateRandomTensor<DT_FLOAT>({8}));
+  auto sub = ops::Sub(s.WithOpName("sub"), b_const, mul_2);
+  auto output = ops::AddV2(s.WithOpName("output"), mul_0, sub);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), output);
+
+  auto input_t = GenerateRandomTensor<DT_FLOAT>({2, 3, 8});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"input", input_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output_graph;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output_graph));
+
+  int found = 0;
+  for (const NodeDef& node : output_graph.node()) {
+    EXPECT_NE(node.op(), "Rsqrt");
+    if (node.name() == "output") {
+      EXPECT_EQ(node.op(), "_FusedLayerNorm");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "input");
+      EXPECT_EQ(node.input(1), "g_const");
+      EXPECT_EQ(node.input(2), "b_const");
+      EXPECT_FLOAT_EQ(node.attr().at("epsilon").f(), 0.01f);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output_graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-4);
+}
+
+class RemapperFuseAttentionTest : public RemapperTest {
+ public:
+  // Builds attention with the scores scaled by `scale_op` ("Mul", "RealDiv"
+  // or "" for no scaling), and checks it is fused into _FusedAttention.
+  void RunTest(const string& scale_op, float expected_scale) {
+    if (IsMKLEnabled()) GTEST_SKIP() << "Test not applicable to oneDNN.";
+    using ::tensorflow::ops::Placeholder;
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    const TensorShape shape({2, 3, 70, 16});
+    auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                             ops::Placeholder::Shape(shape));
+    auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                           ops::Placeholder::Shape(shape));
+    auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                             ops::Placeholder::Shape(shape));
+    auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                                     ops::BatchMatMulV2::AdjY(true));
+    Output logits = scores;
+    auto scale = ops::Const(s.WithOpName("scale"), 4.0f, {});
+    if (scale_op == "Mul") {
+      logits = ops::Mul(s.WithOpName("scaled"), scale, scores);
+    } else if (scale_op == "RealDiv") {
+      logits = ops::RealDiv(s.WithOpName("scaled"), scores, scale);
+    }
+    auto softmax = ops::Softmax(s.WithOpName("softmax"), logits);
+    auto attention =
+        ops::BatchMatMulV2(s.WithOpName("attention"), softmax, value);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"query", GenerateRandomTensor<DT_FLOAT>(shape)},
+                 {"key", GenerateRandomTensor<DT_FLOAT>(shape)},
+                 {"value", GenerateRandomTensor<DT_FLOAT>(shape)}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.op(), "Softmax");
+      if (node.name() == "attention") {
+        EXPECT_EQ(node.op(), "_FusedAttention");
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "query");
+        EXPECT_EQ(node.input(1), "key");
+        EXPECT_EQ(node.input(2), "value");
+        EXPECT_FLOAT_EQ(node.attr().at("scale").f(), expected_scale);
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-4);
+  }
+};
+
+TEST_F(RemapperFuseAttentionTest, Unscaled) { RunTest("", 1.0f); }
+TEST_F(RemapperFuseAttentionTest, Mul) { RunTest("Mul", 4.0f); }
+TEST_F(RemapperFuseAttentionTest, RealDiv) { RunTest("RealDiv", 0.25f); }
+
+TEST_F(RemapperTest, FuseMaskedAttention) {
+  if (IsMKLEnabled()) GTEST_SKIP() << "Test not applicable to oneDNN.";
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  const TensorShape shape({2, 8, 4});
+  const TensorShape mask_shape({2, 1, 8});
+  auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                           ops::Placeholder::Shape(shape));
+  auto mask = Placeholder(s.WithOpName("mask"), DT_FLOAT,
+                          ops::Placeholder::Shape(mask_shape));
+  auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), query, query,
+                                   ops::BatchMatMulV2::AdjY(true));
+  auto scale = ops::Const(s.WithOpName("scale"), 0.5f, {});
+  auto scaled = ops::Mul(s.WithOpName("scaled"), scores, scale);
+  auto masked = ops::AddV2(s.WithOpName("masked"), scaled, mask);
+  auto softmax = ops::Softmax(s.WithOpName("softmax"), masked);
+  auto attention =
+      ops::BatchMatMulV2(s.WithOpName("attention"), softmax, query);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"query", GenerateRandomTensor<DT_FLOAT>(shape)},
+               {"mask", GenerateRandomTensor<DT_FLOAT>(mask_shape)}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "Softmax");
+    if (node.name() == "attention") {
+      EXPECT_EQ(node.op(), "_FusedAttention");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(3), "mask");
+      EXPECT_EQ(node.attr().at("num_bias").i(), 1);
+      EXPECT_FLOAT_EQ(node.attr().at("scale").f(), 0.5f);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-4);
+}
+
+TEST_F(RemapperTest, DoNotFuseAttentionWithLowRankMask) {
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // The mask broadcasts to the scores, but not along all of its dimensions.
+  auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 8, 4}));
+  auto mask = Placeholder(s.WithOpName("mask"), DT_FLOAT,
+                          ops::Placeholder::Shape({8}));
+  auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), query, query,
+                                   ops::BatchMatMulV2::AdjY(true));
+  auto masked = ops::AddV2(s.WithOpName("masked"), scores, mask);
+  auto softmax = ops::Softmax(s.WithOpName("softmax"), masked);
+  auto attention =
+      ops::BatchMatMulV2(s.WithOpName("attention"), softmax, query);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedAttention");
+  }
+}
+
+TEST_F(RemapperTest, DoNotFuseAttentionOnGpuByDefault) {
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // TF_USE_GPU_FUSED_ATTENTION is not set.
+  auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 8, 4}));
+  auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), query, query,
+                                   ops::BatchMatMulV2::AdjY(true));
+  auto softmax = ops::Softmax(s.WithOpName("softmax"), scores);
+  auto attention =
+      ops::BatchMatMulV2(s.WithOpName("attention"), softmax, query);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:GPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedAttention");
+  }
+}
+
+TEST_F(RemapperTest, FuseSparseEmbeddingLookup) {
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto params = Placeholder(s.WithOpName("params"), DT_FLOAT,
+                            ops::Placeholder::Shape({10, 4}));
+  auto ids = Placeholder(s.WithOpName("ids"), DT_INT64,
+                         ops::Placeholder::Shape({6}));
+  auto axis = ops::Const(s.WithOpName("axis"), 0);
+  auto gather = ops::GatherV2(s.WithOpName("gather"), params, ids, axis);
+  auto indices = ops::Const(s.WithOpName("indices"), {0, 1, 2, 3, 4, 5});
+  auto segment_ids =
+      ops::Const(s.WithOpName("segment_ids"), {0, 0, 1, 3, 3, 3});
+  auto mean = ops::SparseSegmentMean(s.WithOpName("mean"), gather, indices,
+                                     segment_ids);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), mean);
+
+  auto params_t = GenerateRandomTensor<DT_FLOAT>({10, 4});
+  Tensor ids_t = test::AsTensor<int64_t>({9, 0, 3, 3, 7, 1});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"params", params_t}, {"ids", ids_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output_graph;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output_graph));
+
+  int found = 0;
+  for (const NodeDef& node : output_graph.node()) {
+    EXPECT_NE(node.name(), "gather");
+    if (node.name() == "mean") {
+      EXPECT_EQ(node.op(), "_FusedSparseEmbeddingLookup");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "params");
+      EXPECT_EQ(node.input(1), "ids");
+      EXPECT_EQ(node.input(2), "indices");
+      EXPECT_EQ(node.input(3), "segment_ids");
+      EXPECT_EQ(node.attr().at("combiner").s(), "mean");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output_graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+}
+
+TEST_F(RemapperTest, DoNotFuseSparseEmbeddingLookupOfMatrixIds) {
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // The gathered rows are [2, 3, 4], and the segments reduce [3, 4] slices.
+  auto params = Placeholder(s.WithOpName("params"), DT_FLOAT,
+                            ops::Placeholder::Shape({10, 4}));
+  auto ids = Placeholder(s.WithOpName("ids"), DT_INT32,
+                         ops::Placeholder::Shape({2, 3}));
+  auto axis = ops::Const(s.WithOpName("axis"), 0);
+  auto gather = ops::GatherV2(s.WithOpName("gather"), params, ids, axis);
+  auto indices = ops::Const(s.WithOpName("indices"), {0, 1});
+  auto segment_ids = ops::Const(s.WithOpName("segment_ids"), {0, 0});
+  auto sum = ops::SparseSegmentSum(s.WithOpName("sum"), gather, indices,
+                                   segment_ids);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), sum);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedSparseEmbeddingLookup");
+  }
+}
+
 class RemapperTensorToHashBucketTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -130,10 +130,13 @@ Status EstimateEarliestExecutionTimes(
   return absl::OkStatus();
 }
 
-Status EstimateRequiredTimes(
+// Nodes without fanouts are required to complete by `deadline` if it is not
+// null, and by their execution time otherwise.
+static Status EstimateRequiredTimesBefore(
     const GrapplerItem& item, const Cluster* cluster,
     const std::unordered_map<const NodeDef*, Costs::NanoSeconds>&
         execution_times,
+    const Costs::NanoSeconds* deadline,
     std::unordered_map<const NodeDef*, Costs::NanoSeconds>* required_times) {
   std::unordered_map<string, const NodeDef*> name_map;
   for (const NodeDef& node : item.graph.node()) {
@@ -159,7 +162,7 @@ Status EstimateRequiredTimes(
     if (pending_fanouts[&node] == 0) {
       auto it = execution_times.find(&node);
       if (it != execution_times.end()) {
-        (*required_times)[&node] = it->second;
+        (*required_times)[&node] = deadline ? *deadline : it->second;
       }
       ready_nodes.push_back(&node);
     }
@@ -199,5 +202,41 @@ Status EstimateRequiredTimes(
   return absl::OkStatus();
 }
 
+Status EstimateRequiredTimes(
+    const GrapplerItem& item, const Cluster* cluster,
+    const std::unordered_map<const NodeDef*, Costs::NanoSeconds>&
+        execution_times,
+    std::unordered_map<const NodeDef*, Costs::NanoSeconds>* required_times) {
+  return EstimateRequiredTimesBefore(item, cluster, execution_times,
+                                     /*deadline=*/nullptr, required_times);
+}
+
+Status EstimateCriticalPathSlacks(
+    const GrapplerItem& item, const Cluster* cluster,
+    std::unordered_map<const NodeDef*, Costs::NanoSeconds>* slacks) {
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> execution_times;
+  TF_RETURN_IF_ERROR(
+      EstimateEarliestExecutionTimes(item, cluster, &execution_times));
+  Costs::NanoSeconds makespan = 0;
+  for (const auto& node_time : execution_times) {
+    makespan = std::max(makespan, node_time.second);
+  }
+
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> required_times;
+  TF_RETURN_IF_ERROR(EstimateRequiredTimesBefore(
+      item, cluster, execution_times, &makespan, &required_times));
+  for (const auto& node_time : execution_times) {
+    auto it = required_times.find(node_time.first);
+    if (it == required_times.end() ||
+        it->second == Costs::NanoSeconds::max()) {
+      // Nodes in loops are not reached by the backward traversal.
+      continue;
+    }
+    const Costs::NanoSeconds slack = it->second - node_time.second;
+    (*slacks)[node_time.first] = std::max(slack, Costs::NanoSeconds(0));
+  }
+  return absl::OkStatus();
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
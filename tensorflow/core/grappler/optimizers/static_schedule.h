@@ -44,6 +44,14 @@ Status EstimateRequiredTimes(
         execution_times,
     std::unordered_map<const NodeDef*, Costs::NanoSeconds>* required_times);
 
+// Compute by how much the completion of each node can be delayed past its
+// earliest execution time without delaying the completion of the whole graph.
+// The nodes on the critical path have a slack of zero. Nodes whose required
+// time can't be estimated, e.g. because they are part of a loop, are left out.
+Status EstimateCriticalPathSlacks(
+    const GrapplerItem& item, const Cluster* cluster,
+    std::unordered_map<const NodeDef*, Costs::NanoSeconds>* slacks);
+
 }  // namespace grappler
 }  // end namespace tensorflow
 
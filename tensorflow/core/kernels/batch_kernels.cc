@@ -313,6 +313,17 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
                                  &enable_large_batch_splitting_));
     has_attribute_enable_large_batch_splitting_ = true;
   }
+  if (c->HasAttr("ragged_dimension")) {
+    OP_REQUIRES_OK(c, c->GetAttr("ragged_dimension", &ragged_dimension_));
+    OP_REQUIRES_OK(c, c->GetAttr("ragged_bucket_boundaries",
+                                 &ragged_bucket_boundaries_));
+    OP_REQUIRES_OK(c, c->GetAttr("ragged_bucket_max_batch_sizes",
+                                 &ragged_bucket_max_batch_sizes_));
+  }
+  if (c->HasAttr("assemble_batches_in_place")) {
+    OP_REQUIRES_OK(c, c->GetAttr("assemble_batches_in_place",
+                                 &assemble_batches_in_place_));
+  }
 
   // Helper function `SetAdaptiveBatchSchedulerOptions` calls
   // `OP_REQUIRES_OK`, which exits the current function upon error.
@@ -417,6 +428,11 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           adaptive_shared_batch_scheduler_options, max_batch_size_,
           batch_timeout_micros_, max_enqueued_batches_, allowed_batch_sizes_,
           &new_resource));
+      if (ragged_dimension_ >= 0) {
+        TF_RETURN_IF_ERROR(new_resource->SetRaggedBucketing(
+            ragged_dimension_, ragged_bucket_boundaries_,
+            ragged_bucket_max_batch_sizes_));
+      }
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
       }
@@ -439,6 +455,12 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           low_priority_max_enqueued_batches_, low_priority_allowed_batch_sizes_,
           mixed_priority_batching_policy, enable_large_batch_splitting_,
           &new_resource));
+      if (ragged_dimension_ >= 0) {
+        TF_RETURN_IF_ERROR(new_resource->SetRaggedBucketing(
+            ragged_dimension_, ragged_bucket_boundaries_,
+            ragged_bucket_max_batch_sizes_));
+      }
+      new_resource->set_assemble_batches_in_place(assemble_batches_in_place_);
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
       }
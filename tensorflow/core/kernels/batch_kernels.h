@@ -116,6 +116,10 @@ class BatchFunctionKernel : public AsyncOpKernel {
   bool enable_large_batch_splitting_ = false;
   bool has_attribute_enable_large_batch_splitting_ = false;
   bool enable_adaptive_batch_threads_ = false;
+  int32 ragged_dimension_ = -1;
+  std::vector<int32> ragged_bucket_boundaries_;
+  std::vector<int32> ragged_bucket_max_batch_sizes_;
+  bool assemble_batches_in_place_ = false;
 
   mutex mu_;
 
@@ -92,7 +92,8 @@ class BatchFunctionTestState : public SharedBatchFunctionTestState {
   // the device pointer is valid throughout the life of this class.
   absl::Status Init(Device *device, bool enable_low_priority_queue,
                     absl::string_view mixed_priority_policy,
-                    int64_t expected_batch_size) {
+                    int64_t expected_batch_size,
+                    bool assemble_batches_in_place = false) {
     // Override the per-test/per-op device with a given device so that it can
     // be shared between ops.
     device_ = device;
@@ -139,6 +140,8 @@ class BatchFunctionTestState : public SharedBatchFunctionTestState {
                            .Attr("low_priority_max_enqueued_batches",
                                  enable_low_priority_queue ? 2 : 0)
                            .Attr("mixed_priority_policy", mixed_priority_policy)
+                           .Attr("assemble_batches_in_place",
+                                 assemble_batches_in_place)
                            .Attr("Tin", {DataType::DT_INT64})
                            .Input(inputs)
                            .Attr("Tcaptured", std::vector<DataType>{})
@@ -235,6 +238,68 @@ TEST_P(BatchFunctionTest, PaddingWorksWithoutCriticality) {
   }
 }
 
+TEST_P(BatchFunctionTest, PaddingWorksWithInPlaceBatchAssembly) {
+  bool enable_low_priority_queue = GetParam();
+  {
+    tsl::BlockingCounter blocking_counter(3);
+    // 3 threads run the batch op and copy their inputs into the buffer of the
+    // batch, which is padded to form a tensor with [4, 2] shape which is
+    // verified within the function. Each thread gets its own rows back.
+    for (int i = 0; i < 3; ++i) {
+      Env::Default()->SchedClosure([&, i]() {
+        BatchFunctionTestState test_state;
+        TF_ASSERT_OK(test_state.Init(
+            cpu_device_.get(), enable_low_priority_queue,
+            serving::kLowPriorityPaddingWithMaxBatchSizeAttrValue,
+            /*expected_batch_size=*/4, /*assemble_batches_in_place=*/true));
+        test_state.AddInputFromList<int64_t>(TensorShape({1, 2}),
+                                             {10 * i, 10 * i + 1});
+        TF_EXPECT_OK(test_state.RunOpKernel());
+
+        test::ExpectTensorEqual<int64_t>(
+            *test_state.GetOutput(0),
+            test::AsTensor<int64_t>({10 * i, 10 * i + 1}, TensorShape({1, 2})));
+        blocking_counter.DecrementCount();
+      });
+    }
+
+    blocking_counter.Wait();
+  }
+}
+
+TEST_P(BatchFunctionTest, SplitOutputsAreCopiedIntoPreallocatedOutput) {
+  bool enable_low_priority_queue = GetParam();
+  {
+    const std::vector<int64_t> sizes = {6, 6, 4};
+    tsl::BlockingCounter blocking_counter(sizes.size());
+    // 3 threads run the batch op, which form two full batches with [8, 2]
+    // shape which is verified within the function, whatever their order. One
+    // of the inputs is split across both batches, and the outputs of its
+    // splits are copied into its preallocated output.
+    for (int i = 0; i < sizes.size(); ++i) {
+      Env::Default()->SchedClosure([&, i]() {
+        BatchFunctionTestState test_state;
+        TF_ASSERT_OK(test_state.Init(
+            cpu_device_.get(), enable_low_priority_queue,
+            serving::kLowPriorityPaddingWithMaxBatchSizeAttrValue,
+            /*expected_batch_size=*/8));
+        std::vector<int64_t> values(2 * sizes[i]);
+        for (int j = 0; j < values.size(); ++j) values[j] = 100 * i + j;
+        test_state.AddInputFromArray<int64_t>(TensorShape({sizes[i], 2}),
+                                              values);
+        TF_EXPECT_OK(test_state.RunOpKernel());
+
+        test::ExpectTensorEqual<int64_t>(
+            *test_state.GetOutput(0),
+            test::AsTensor<int64_t>(values, TensorShape({sizes[i], 2})));
+        blocking_counter.DecrementCount();
+      });
+    }
+
+    blocking_counter.Wait();
+  }
+}
+
 #if defined(PLATFORM_GOOGLE)
 TEST_P(BatchFunctionTest,
        LowPriorityTaskPaddingHighPriorityBatchUptoMaxBatchSize) {
@@ -560,6 +625,96 @@ TEST_F(BatchFunctionTest, LowPriorityBatchPaddedToLowPriorityAllowedBatchSize) {
 }
 #endif
 
+class RaggedBatchFunctionTestState : public SharedBatchFunctionTestState {
+ public:
+  // Init test fixture with a batch kernel instance which buckets its input by
+  // length, and checks that batches have the shape `expected_batch_shape`.
+  absl::Status Init(Device *device, const TensorShape &expected_batch_shape) {
+    device_ = device;
+
+    NameAttrList f;
+    f.set_name("RaggedShapeEnforcingFunction");
+    FunctionDef func = FunctionDefHelper::Create(
+        // function_name
+        f.name(),
+        // in_def
+        {"x:int64"},
+        // out_def
+        {"o:int64"},
+        // attr_def
+        {},
+        // node_def
+        {{{"o"},
+          "EnsureShape",
+          {"x"},
+          {{"T", DataType::DT_INT64}, {"shape", expected_batch_shape}}}},
+        // ret_def
+        {{"o", "o:output"}});
+    TF_RETURN_IF_ERROR(flib_def_->AddFunctionDef(func));
+    SharedBatchFunctionTestState::CreateFunctionLibraryRuntime();
+
+    std::vector<NodeDefBuilder::NodeOut> inputs(
+        {NodeDefBuilder::NodeOut({"n1", 0, DataType::DT_INT64})});
+    TF_RETURN_IF_ERROR(NodeDefBuilder("BatchTPUInput", "BatchFunction")
+                           .Attr("max_batch_size", 8)
+                           .Attr("num_batch_threads", 8)
+                           .Attr("allowed_batch_sizes", {2, 4, 8})
+                           .Attr("batch_timeout_micros", 1000000)
+                           .Attr("max_enqueued_batches", 10)
+                           .Attr("ragged_dimension", 1)
+                           .Attr("ragged_bucket_boundaries", {4, 8})
+                           .Attr("ragged_bucket_max_batch_sizes", {8, 4})
+                           .Attr("Tin", {DataType::DT_INT64})
+                           .Input(inputs)
+                           .Attr("Tcaptured", std::vector<DataType>{})
+                           .Input(std::vector<NodeDefBuilder::NodeOut>{})
+                           .Attr("Tout", std::vector<DataType>{DT_INT64})
+                           .Attr("f", f)
+                           .Finalize(node_def()));
+    return OpsTestBase::InitOp();
+  }
+
+  void TestBody() override {}
+};
+
+TEST_F(BatchFunctionTest, RaggedInputsArePaddedToTheirBucket) {
+  tsl::BlockingCounter blocking_counter(4);
+  // 4 threads run the batch op with inputs of lengths 5 and 7, which share the
+  // bucket of length 8, whose batches are limited to 4 entries. They are
+  // batched and padded to form a tensor with [4, 8] shape which is verified
+  // within the function, and each gets the output of its own length back.
+  for (int i = 0; i < 4; ++i) {
+    Env::Default()->SchedClosure([&, i]() {
+      const int64_t length = i % 2 == 0 ? 5 : 7;
+      std::vector<int64_t> values(length);
+      for (int64_t j = 0; j < length; ++j) values[j] = i * 10 + j;
+
+      RaggedBatchFunctionTestState test_state;
+      TF_ASSERT_OK(test_state.Init(cpu_device_.get(),
+                                   /*expected_batch_shape=*/{4, 8}));
+      test_state.AddInputFromArray<int64_t>(TensorShape({1, length}), values);
+      TF_EXPECT_OK(test_state.RunOpKernel());
+
+      test::ExpectTensorEqual<int64_t>(
+          *test_state.GetOutput(0),
+          test::AsTensor<int64_t>(values, TensorShape({1, length})));
+      blocking_counter.DecrementCount();
+    });
+  }
+
+  blocking_counter.Wait();
+}
+
+TEST_F(BatchFunctionTest, RaggedInputLongerThanLastBucketIsRejected) {
+  RaggedBatchFunctionTestState test_state;
+  TF_ASSERT_OK(test_state.Init(cpu_device_.get(),
+                               /*expected_batch_shape=*/{4, 8}));
+  test_state.AddInputFromList<int64_t>(TensorShape({1, 9}),
+                                       {0, 1, 2, 3, 4, 5, 6, 7, 8});
+  EXPECT_EQ(test_state.RunOpKernel().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
 class BatchFunctionKernelParallelWarmupTestState
     : public SharedBatchFunctionTestState {
  public:
@@ -47,6 +47,51 @@ class ASBSBatch;
 
 template <typename TaskType>
 class ASBSQueue;
+
+// Online estimate of the processing time of the batches of a queue as an
+// affine function of their size, fitted by least squares to the recent
+// batches with exponentially decaying weights.
+class BatchCostModel {
+ public:
+  // Records that a batch of `batch_size` took `latency_micros` to process.
+  void Record(double batch_size, double latency_micros) {
+    sum_weights_ = sum_weights_ * kDecay + 1;
+    sum_sizes_ = sum_sizes_ * kDecay + batch_size;
+    sum_latencies_ = sum_latencies_ * kDecay + latency_micros;
+    sum_squared_sizes_ = sum_squared_sizes_ * kDecay + batch_size * batch_size;
+    sum_products_ = sum_products_ * kDecay + batch_size * latency_micros;
+  }
+
+  // Returns the predicted processing time of a batch of `batch_size`, or a
+  // negative value if no batch was recorded yet.
+  double PredictMicros(double batch_size) const {
+    if (sum_weights_ == 0) return -1;
+    const double mean_size = sum_sizes_ / sum_weights_;
+    const double mean_latency = sum_latencies_ / sum_weights_;
+    const double size_variance =
+        sum_squared_sizes_ / sum_weights_ - mean_size * mean_size;
+    // Until batches of different sizes were seen, the latency is assumed not
+    // to depend on the size, which is the common case for small batches on
+    // accelerators.
+    if (size_variance <= 1e-6 * (1 + mean_size * mean_size)) {
+      return mean_latency;
+    }
+    const double slope = std::max(
+        0.0,
+        (sum_products_ / sum_weights_ - mean_size * mean_latency) /
+            size_variance);
+    return std::max(0.0, mean_latency + slope * (batch_size - mean_size));
+  }
+
+ private:
+  static constexpr double kDecay = 0.99;
+
+  double sum_weights_ = 0;
+  double sum_sizes_ = 0;
+  double sum_latencies_ = 0;
+  double sum_squared_sizes_ = 0;
+  double sum_products_ = 0;
+};
 }  // namespace internal
 
 // Shared batch scheduler designed to minimize latency. The scheduler keeps
@@ -74,6 +119,13 @@ class ASBSQueue;
 // CPU utilization - If the batch processing is cpu dominated, you can reap
 //   latency gains when underutilized by increasing the processing rate, but
 //   back the rate off when the load increases to avoid overload.
+//
+// With Options::cost_aware_scheduling, several models sharing a device are
+// scheduled by the predicted processing time of their batches rather than by
+// age alone: every queue learns the latency of its batches as a function of
+// their size, the queues get device time in proportion to their
+// QueueOptions::scheduling_share, and the in flight limit bounds the predicted
+// work on the device instead of the number of batches.
 
 template <typename TaskType>
 class AdaptiveSharedBatchScheduler
@@ -132,6 +184,20 @@ class AdaptiveSharedBatchScheduler
     // full_batch_scheduling_boost_micros==zero) for backward compatibility of
     // API.
     bool fifo_scheduling = false;
+
+    // If true, batches are scheduled according to their predicted processing
+    // time, as learned online per queue from the latencies of its previous
+    // batches:
+    // 1) The next batch comes from the queue which used the least predicted
+    //    processing time relative to its QueueOptions::scheduling_share
+    //    (start-time fair queuing), and among its batches by age and
+    //    full_batch_scheduling_boost_micros as usual.
+    // 2) in_flight_batches_limit_ bounds the predicted processing time of the
+    //    in flight batches, in units of the average batch, rather than their
+    //    number. A few expensive batches thus saturate a device as much as
+    //    many cheap ones, and the limit is tuned as usual.
+    // Requires that `fifo_scheduling` is false.
+    bool cost_aware_scheduling = false;
   };
 
   // Ownership is shared between the caller of Create() and any queues created
@@ -171,6 +237,12 @@ class AdaptiveSharedBatchScheduler
 
     // If true, the padding will not be appended.
     bool disable_padding = false;
+
+    // Relative share of the processing time which this queue gets when the
+    // scheduler uses `Options::cost_aware_scheduling`; e.g. a queue with a
+    // share of 2 gets twice the time of a queue with a share of 1 when both
+    // are backlogged. Must be positive.
+    double scheduling_share = 1.0;
   };
 
   using BatchProcessor = std::function<void(std::unique_ptr<Batch<TaskType>>)>;
@@ -189,11 +261,36 @@ class AdaptiveSharedBatchScheduler
   // access to AddBatch, MaybeScheduleClosedBatches, RemoveQueue, GetEnv.
   friend class internal::ASBSQueue<TaskType>;
 
+  // Scheduling state of a queue under cost_aware_scheduling. Shared with the
+  // in flight batches of the queue, which may outlive it.
+  struct QueueState {
+    explicit QueueState(double share) : share(share) {}
+
+    const double share;
+    // Learned processing time of the batches of the queue.
+    internal::BatchCostModel cost_model;
+    // Predicted processing time used by the queue, divided by its share.
+    double virtual_time_micros = 0;
+  };
+
   explicit AdaptiveSharedBatchScheduler(const Options& options);
 
   // Tracks processing latency and adjusts in_flight_batches_limit to minimize.
+  // `work` is the contribution of the batch to in_flight_work_.
   void CallbackWrapper(const internal::ASBSBatch<TaskType>* batch,
-                       BatchProcessor callback, bool is_express);
+                       BatchProcessor callback, bool is_express,
+                       std::shared_ptr<QueueState> queue_state, double work);
+
+  // Releases batch from its queue and schedules its processing, charging its
+  // predicted processing time to its queue under cost_aware_scheduling.
+  void ScheduleBatch(const internal::ASBSBatch<TaskType>* batch,
+                     bool is_express) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the load compared against in_flight_batches_limit_.
+  double InFlightLoad() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return options_.cost_aware_scheduling ? in_flight_work_
+                                          : in_flight_batches_;
+  }
 
   // Schedules batch if in_flight_batches_limit_ is not met.
   void MaybeScheduleNextBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -237,6 +334,21 @@ class AdaptiveSharedBatchScheduler
   std::unordered_map<const internal::ASBSQueue<TaskType>*, BatchProcessor>
       queues_and_callbacks_ TF_GUARDED_BY(mu_);
 
+  // Scheduling state of the queues under cost_aware_scheduling.
+  std::unordered_map<const internal::ASBSQueue<TaskType>*,
+                     std::shared_ptr<QueueState>>
+      queue_states_ TF_GUARDED_BY(mu_);
+
+  // Virtual time of the last batch scheduled under cost_aware_scheduling. A
+  // queue which is behind it, e.g. since it was idle, starts from it instead
+  // of catching up with a burst of batches.
+  double virtual_time_micros_ TF_GUARDED_BY(mu_) = 0;
+
+  // Exponential moving average of the processing time of the batches under
+  // cost_aware_scheduling, the unit of in_flight_work_. Zero until the first
+  // batch was processed.
+  double average_batch_cost_micros_ TF_GUARDED_BY(mu_) = 0;
+
   mutex mu_;
 
   // Responsible for running the batch processing callbacks.
@@ -253,6 +365,9 @@ class AdaptiveSharedBatchScheduler
   int64_t in_flight_batches_ TF_GUARDED_BY(mu_) = 0;
   // Number of express batches currently being processed.
   int64_t in_flight_express_batches_ TF_GUARDED_BY(mu_) = 0;
+  // Predicted processing time of the regular batches currently being
+  // processed, in units of average_batch_cost_micros_.
+  double in_flight_work_ TF_GUARDED_BY(mu_) = 0;
 
   // RNG engine and distribution.
   std::default_random_engine rand_engine_;
@@ -423,6 +538,10 @@ Status AdaptiveSharedBatchScheduler<TaskType>::Create(
         "greater than or equal to 1; was ",
         options.batches_to_average_over);
   }
+  if (options.cost_aware_scheduling && options.fifo_scheduling) {
+    return errors::InvalidArgument(
+        "cost_aware_scheduling and fifo_scheduling can't both be enabled");
+  }
   scheduler->reset(new AdaptiveSharedBatchScheduler<TaskType>(options));
   return absl::OkStatus();
 }
@@ -467,11 +586,19 @@ Status AdaptiveSharedBatchScheduler<TaskType>::AddQueue(
           options.max_batch_size);
     }
   }
+  if (!(options.scheduling_share > 0)) {
+    return errors::InvalidArgument("scheduling_share must be positive; was ",
+                                   options.scheduling_share);
+  }
   internal::ASBSQueue<TaskType>* asbs_queue_raw;
   queue->reset(asbs_queue_raw = new internal::ASBSQueue<TaskType>(
                    this->shared_from_this(), options));
   mutex_lock l(mu_);
   queues_and_callbacks_[asbs_queue_raw] = process_batch_callback;
+  if (options_.cost_aware_scheduling) {
+    queue_states_[asbs_queue_raw] =
+        std::make_shared<QueueState>(options.scheduling_share);
+  }
   return absl::OkStatus();
 }
 
@@ -507,6 +634,39 @@ void AdaptiveSharedBatchScheduler<TaskType>::RemoveQueue(
     const internal::ASBSQueue<TaskType>* queue) {
   mutex_lock l(mu_);
   queues_and_callbacks_.erase(queue);
+  queue_states_.erase(queue);
+}
+
+template <typename TaskType>
+void AdaptiveSharedBatchScheduler<TaskType>::ScheduleBatch(
+    const internal::ASBSBatch<TaskType>* batch, bool is_express) {
+  std::shared_ptr<QueueState> queue_state;
+  double work = is_express ? 0 : 1;
+  auto state_it = queue_states_.find(batch->queue());
+  if (state_it != queue_states_.end()) {
+    queue_state = state_it->second;
+    double cost_micros = queue_state->cost_model.PredictMicros(batch->size());
+    if (cost_micros < 0) cost_micros = average_batch_cost_micros_;
+    if (!is_express && average_batch_cost_micros_ > 0) {
+      work = cost_micros / average_batch_cost_micros_;
+    }
+    virtual_time_micros_ =
+        std::max(queue_state->virtual_time_micros, virtual_time_micros_);
+    queue_state->virtual_time_micros =
+        virtual_time_micros_ + cost_micros / queue_state->share;
+  }
+  // Queue may destroy itself after ReleaseBatch is called.
+  batch->queue()->ReleaseBatch(batch);
+  batch_thread_pool_->Schedule(
+      std::bind(&AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper, this,
+                batch, queues_and_callbacks_[batch->queue()], is_express,
+                std::move(queue_state), work));
+  if (is_express) {
+    in_flight_express_batches_++;
+  } else {
+    in_flight_batches_++;
+    in_flight_work_ += work;
+  }
 }
 
 template <typename TaskType>
@@ -516,12 +676,7 @@ void AdaptiveSharedBatchScheduler<TaskType>::MaybeScheduleNextBatchFIFO() {
     return;
   }
   fifo_batches_.pop_front();
-  // Queue may destroy itself after ReleaseBatch is called.
-  batch->queue()->ReleaseBatch(batch);
-  batch_thread_pool_->Schedule(std::bind(
-      &AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper, this, batch,
-      queues_and_callbacks_[batch->queue()], false /* is express */));
-  in_flight_batches_++;
+  ScheduleBatch(batch, /*is_express=*/false);
 }
 
 template <typename TaskType>
@@ -537,11 +692,7 @@ void AdaptiveSharedBatchScheduler<
     if ((*it)->IsClosed()) {
       const internal::ASBSBatch<TaskType>* batch = *it;
       fifo_batches_.pop_front();
-      batch->queue()->ReleaseBatch(batch);
-      batch_thread_pool_->Schedule(
-          std::bind(&AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper,
-                    this, batch, queues_and_callbacks_[batch->queue()], true));
-      in_flight_express_batches_++;
+      ScheduleBatch(batch, /*is_express=*/true);
       available_threads--;
     } else {
       // Batches are FIFO, so stop iteration after finding the first non-closed
@@ -555,11 +706,16 @@ template <typename TaskType>
 void AdaptiveSharedBatchScheduler<TaskType>::MaybeScheduleNextBatch() {
   bool batch_empty =
       options_.fifo_scheduling ? fifo_batches_.empty() : batches_.empty();
-  if (batch_empty || in_flight_batches_ >= in_flight_batches_limit_) return;
+  const double load = InFlightLoad();
+  if (batch_empty || load >= in_flight_batches_limit_) return;
+  // Predicted work may be arbitrarily small, but every batch takes a thread.
+  if (options_.cost_aware_scheduling &&
+      in_flight_batches_ >= options_.num_batch_threads) {
+    return;
+  }
   // Non-integer limit handled probabilistically.
-  if (in_flight_batches_limit_ - in_flight_batches_ < 1 &&
-      rand_double_(rand_engine_) >
-          in_flight_batches_limit_ - in_flight_batches_) {
+  if (in_flight_batches_limit_ - load < 1 &&
+      rand_double_(rand_engine_) > in_flight_batches_limit_ - load) {
     return;
   }
 
@@ -569,15 +725,28 @@ void AdaptiveSharedBatchScheduler<TaskType>::MaybeScheduleNextBatch() {
   }
 
   auto best_it = batches_.end();
+  double best_virtual_time = 0;
   double best_score = (std::numeric_limits<double>::max)();
   int64_t now_micros = GetEnv()->NowMicros();
   for (auto it = batches_.begin(); it != batches_.end(); it++) {
     if ((*it)->schedulable_time_micros() > now_micros) continue;
+    // Under cost_aware_scheduling, the queue furthest behind in virtual time
+    // goes first.
+    double virtual_time = 0;
+    if (options_.cost_aware_scheduling) {
+      auto state_it = queue_states_.find((*it)->queue());
+      if (state_it != queue_states_.end()) {
+        virtual_time = std::max(state_it->second->virtual_time_micros,
+                                virtual_time_micros_);
+      }
+    }
     const double score =
         (*it)->creation_time_micros() -
         options_.full_batch_scheduling_boost_micros * (*it)->size() /
             static_cast<double>((*it)->queue()->max_task_size());
-    if (best_it == batches_.end() || score < best_score) {
+    if (best_it == batches_.end() || virtual_time < best_virtual_time ||
+        (virtual_time == best_virtual_time && score < best_score)) {
+      best_virtual_time = virtual_time;
       best_score = score;
       best_it = it;
     }
@@ -586,12 +755,7 @@ void AdaptiveSharedBatchScheduler<TaskType>::MaybeScheduleNextBatch() {
   if (best_it == batches_.end()) return;
   const internal::ASBSBatch<TaskType>* batch = *best_it;
   batches_.erase(best_it);
-  // Queue may destroy itself after ReleaseBatch is called.
-  batch->queue()->ReleaseBatch(batch);
-  batch_thread_pool_->Schedule(
-      std::bind(&AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper, this,
-                batch, queues_and_callbacks_[batch->queue()], false));
-  in_flight_batches_++;
+  ScheduleBatch(batch, /*is_express=*/false);
 }
 
 template <typename TaskType>
@@ -616,11 +780,7 @@ void AdaptiveSharedBatchScheduler<
     if ((*it)->IsClosed()) {
       const internal::ASBSBatch<TaskType>* batch = *it;
       it = batches_.erase(it);
-      batch->queue()->ReleaseBatch(batch);
-      batch_thread_pool_->Schedule(
-          std::bind(&AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper,
-                    this, batch, queues_and_callbacks_[batch->queue()], true));
-      in_flight_express_batches_++;
+      ScheduleBatch(batch, /*is_express=*/true);
       available_threads--;
     } else {
       ++it;
@@ -632,7 +792,7 @@ template <typename TaskType>
 void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
     const internal::ASBSBatch<TaskType>* batch,
     AdaptiveSharedBatchScheduler<TaskType>::BatchProcessor callback,
-    bool is_express) {
+    bool is_express, std::shared_ptr<QueueState> queue_state, double work) {
   tsl::profiler::TraceMeConsumer trace_me(
       [&] {
         return profiler::TraceMeEncode(
@@ -642,16 +802,28 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
       tsl::profiler::ContextType::kAdaptiveSharedBatchScheduler,
       batch->traceme_context_id());
   const int64_t start_time = batch->creation_time_micros();
+  const size_t batch_size = batch->size();
+  const int64_t processing_start_time = GetEnv()->NowMicros();
   callback(std::unique_ptr<Batch<TaskType>>(
       const_cast<internal::ASBSBatch<TaskType>*>(batch)));
   int64_t end_time = GetEnv()->NowMicros();
   mutex_lock l(mu_);
+  if (queue_state != nullptr) {
+    const double processing_micros = end_time - processing_start_time;
+    queue_state->cost_model.Record(batch_size, processing_micros);
+    average_batch_cost_micros_ =
+        average_batch_cost_micros_ == 0
+            ? processing_micros
+            : 0.99 * average_batch_cost_micros_ + 0.01 * processing_micros;
+  }
   if (is_express) {
     in_flight_express_batches_--;
     MaybeScheduleClosedBatchesLocked();
     return;
   }
   in_flight_batches_--;
+  // Avoid accumulating rounding errors once the device is idle.
+  in_flight_work_ = in_flight_batches_ == 0 ? 0 : in_flight_work_ - work;
   batch_count_++;
   batch_delay_stats_.batch_latency_sum += end_time - start_time;
 
@@ -96,6 +96,10 @@ TEST(AdaptiveSharedBatchSchedulerTest, BadOptions) {
   options.min_in_flight_batches_limit = 2;
   options.num_batch_threads = 3;
   EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = Scheduler::Options();
+  options.cost_aware_scheduling = true;
+  options.fifo_scheduling = true;
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
 }
 
 TEST(AdaptiveSharedBatchSchedulerTest, InFlightBatchesLimit) {
@@ -517,6 +521,99 @@ TEST(AdaptiveSharedBatchSchedulerTest, MaxTasksPerBatch) {
     if (processed_batches == 3) break;
   }
 }
+
+TEST(AdaptiveSharedBatchSchedulerTest, BatchCostModel) {
+  internal::BatchCostModel model;
+  EXPECT_LT(model.PredictMicros(10), 0);
+  // Without batches of different sizes, the latency doesn't depend on size.
+  model.Record(10, 500);
+  model.Record(10, 700);
+  EXPECT_NEAR(model.PredictMicros(40), 600, 1);
+  // Fits latency = 400 + 20 * size.
+  for (int i = 0; i < 100; ++i) {
+    model.Record(10, 600);
+    model.Record(30, 1000);
+  }
+  EXPECT_NEAR(model.PredictMicros(20), 800, 5);
+  EXPECT_NEAR(model.PredictMicros(50), 1400, 20);
+  EXPECT_GE(model.PredictMicros(0), 0);
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, BadSchedulingShare) {
+  std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(AdaptiveSharedBatchScheduler<FakeTask>::Create({}, &scheduler));
+  AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.scheduling_share = 0;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  EXPECT_FALSE(scheduler
+                   ->AddQueue(queue_options,
+                              [](std::unique_ptr<Batch<FakeTask>> batch) {},
+                              &queue)
+                   .ok());
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, CostAwareSchedulingShares) {
+  test_util::FakeClockEnv env(Env::Default());
+  AdaptiveSharedBatchScheduler<FakeTask>::Options options;
+  options.env = &env;
+  options.num_batch_threads = 1;
+  options.initial_in_flight_batches_limit = 1;
+  options.batches_to_average_over = 1000;
+  options.cost_aware_scheduling = true;
+  mutex mu;
+  string processing_order;
+  Notification first_batch_started, finish_first_batch;
+  // Every batch takes 100us of (fake) processing time.
+  auto callback_for = [&](char queue_name) {
+    return [&, queue_name](std::unique_ptr<Batch<FakeTask>> batch) {
+      {
+        mutex_lock l(mu);
+        processing_order += queue_name;
+      }
+      if (!first_batch_started.HasBeenNotified()) {
+        first_batch_started.Notify();
+        finish_first_batch.WaitForNotification();
+      }
+      env.AdvanceByMicroseconds(100);
+    };
+  };
+  {
+    std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(
+        AdaptiveSharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 10;
+    queue_options.max_enqueued_batches = 20;
+    queue_options.scheduling_share = 4;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue_a;
+    TF_ASSERT_OK(
+        scheduler->AddQueue(queue_options, callback_for('a'), &queue_a));
+    queue_options.scheduling_share = 1;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue_b;
+    TF_ASSERT_OK(
+        scheduler->AddQueue(queue_options, callback_for('b'), &queue_b));
+
+    // The first batch blocks processing until all other batches are enqueued.
+    TF_ASSERT_OK(ScheduleTask(10, queue_a.get()));
+    first_batch_started.WaitForNotification();
+    for (int i = 0; i < 12; ++i) {
+      TF_ASSERT_OK(ScheduleTask(10, queue_a.get()));
+    }
+    for (int i = 0; i < 4; ++i) {
+      TF_ASSERT_OK(ScheduleTask(10, queue_b.get()));
+    }
+    finish_first_batch.Notify();
+    // Wait for all batches to be processed, so that the queues don't need the
+    // fake clock to advance when they are destroyed.
+    while (true) {
+      mutex_lock l(mu);
+      if (processing_order.size() == 17) break;
+    }
+  }
+  // Although all of its batches are newer, queue b gets one batch for every
+  // four batches of queue a.
+  EXPECT_EQ(processing_order.substr(0, 13), "aabaaaabaaaab");
+}
 }  // namespace anonymous
 }  // namespace serving
 }  // namespace tensorflow
@@ -0,0 +1,119 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_input_buffer.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace serving {
+
+void BatchInputBuffer::AddPendingCopy() {
+  mutex_lock l(mu_);
+  ++num_pending_copies_;
+}
+
+void BatchInputBuffer::CopyIn(Allocator* allocator, int64_t offset,
+                              const std::vector<Tensor>& inputs) {
+  std::vector<Tensor> buffers;
+  {
+    mutex_lock l(mu_);
+    if (usable_ && buffers_.empty()) usable_ = Allocate(allocator, inputs);
+    usable_ = usable_ && Fits(offset, inputs);
+    // The tasks copy to disjoint rows, so the copies run without the lock.
+    if (usable_) buffers = buffers_;
+  }
+  for (int i = 0; i < buffers.size(); ++i) {
+    const Tensor& input = inputs[i];
+    if (input.NumElements() == 0) continue;
+    const int64_t row_bytes = input.TotalBytes() / input.dim_size(0);
+    char* dst = const_cast<char*>(buffers[i].tensor_data().data());
+    std::memcpy(dst + offset * row_bytes, input.tensor_data().data(),
+                input.TotalBytes());
+  }
+
+  mutex_lock l(mu_);
+  if (!inputs.empty()) num_copied_rows_ += inputs[0].dim_size(0);
+  if (--num_pending_copies_ == 0) copies_done_.notify_all();
+}
+
+bool BatchInputBuffer::Finish(int64_t batch_size, int64_t padded_batch_size,
+                              std::vector<Tensor>* batch_inputs) {
+  mutex_lock l(mu_);
+  while (num_pending_copies_ > 0) copies_done_.wait(l);
+  if (!usable_ || buffers_.empty() || batch_size == 0 ||
+      num_copied_rows_ != batch_size || padded_batch_size < batch_size ||
+      padded_batch_size > capacity_) {
+    return false;
+  }
+  batch_inputs->reserve(batch_inputs->size() + buffers_.size());
+  for (const Tensor& buffer : buffers_) {
+    if (buffer.NumElements() > 0) {
+      const int64_t row_bytes = buffer.TotalBytes() / capacity_;
+      char* data = const_cast<char*>(buffer.tensor_data().data());
+      for (int64_t row = batch_size; row < padded_batch_size; ++row) {
+        std::memcpy(data + row * row_bytes, data, row_bytes);
+      }
+    }
+    batch_inputs->push_back(buffer.Slice(0, padded_batch_size));
+  }
+  return true;
+}
+
+bool BatchInputBuffer::Allocate(Allocator* allocator,
+                                const std::vector<Tensor>& inputs) {
+  for (const Tensor& input : inputs) {
+    if (input.dims() == 0 || !DataTypeCanUseMemcpy(input.dtype())) {
+      buffers_.clear();
+      return false;
+    }
+    TensorShape shape = input.shape();
+    shape.set_dim(0, capacity_);
+    buffers_.emplace_back(allocator, input.dtype(), shape);
+    if (!buffers_.back().IsInitialized()) {
+      buffers_.clear();
+      return false;
+    }
+  }
+  return !buffers_.empty();
+}
+
+bool BatchInputBuffer::Fits(int64_t offset,
+                            const std::vector<Tensor>& inputs) const {
+  if (inputs.size() != buffers_.size()) return false;
+  for (int i = 0; i < inputs.size(); ++i) {
+    const Tensor& input = inputs[i];
+    const Tensor& buffer = buffers_[i];
+    if (input.dtype() != buffer.dtype() || input.dims() != buffer.dims() ||
+        offset < 0 || offset + input.dim_size(0) > capacity_) {
+      return false;
+    }
+    for (int d = 1; d < input.dims(); ++d) {
+      if (input.dim_size(d) != buffer.dim_size(d)) return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,101 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_INPUT_BUFFER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_INPUT_BUFFER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace serving {
+
+// The inputs of a batch, concatenated along the 0th dimension while the batch
+// is still open instead of once it is closed. Every task copies its inputs to
+// its offset in the buffer as soon as it joined the batch, in parallel with
+// the other tasks and with the wait for the batch to fill up, and the thread
+// which processes the batch only waits for the copies to finish.
+//
+// Example Usage:
+//   // When a task joins the batch, with the lock of the batch held:
+//   buffer->AddPendingCopy();
+//   // Then, on the thread of the task:
+//   buffer->CopyIn(allocator, offset, task_inputs);
+//   // On the batch thread, once the batch is closed:
+//   std::vector<Tensor> batch_inputs;
+//   if (!buffer->Finish(batch_size, padded_batch_size, &batch_inputs)) {
+//     // Concatenate the inputs of the tasks instead.
+//   }
+class BatchInputBuffer {
+ public:
+  // A copy which a task has to make into a buffer once it joined its batch.
+  struct PendingCopy {
+    std::shared_ptr<BatchInputBuffer> buffer;
+    int64_t offset;
+    std::vector<Tensor> inputs;
+  };
+
+  // `capacity` is the largest padded batch size the buffer is used for.
+  explicit BatchInputBuffer(int64_t capacity) : capacity_(capacity) {}
+
+  // Announces a task which will call `CopyIn`. `Finish` waits until every
+  // announced task did.
+  void AddPendingCopy() TF_LOCKS_EXCLUDED(mu_);
+
+  // Copies `inputs` to the rows of the buffer starting at `offset`. The first
+  // call allocates the buffer with `allocator`, with the shapes of `inputs`
+  // except for the 0th dimension. Inputs which don't match those shapes, or
+  // whose type can't be copied with memcpy, make the buffer unusable.
+  void CopyIn(Allocator* allocator, int64_t offset,
+              const std::vector<Tensor>& inputs) TF_LOCKS_EXCLUDED(mu_);
+
+  // Waits for all the pending copies, and returns the first
+  // `padded_batch_size` rows of every input of the batch in `batch_inputs`,
+  // with the rows from `batch_size` on filled with copies of the first row.
+  // Returns false, and leaves `batch_inputs` untouched, if the tasks did not
+  // copy exactly `batch_size` rows or the buffer is unusable.
+  bool Finish(int64_t batch_size, int64_t padded_batch_size,
+              std::vector<Tensor>* batch_inputs) TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Allocates `buffers_` for inputs shaped like `inputs`, or returns false.
+  bool Allocate(Allocator* allocator, const std::vector<Tensor>& inputs)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns true iff `inputs` fit into `buffers_` at `offset`.
+  bool Fits(int64_t offset, const std::vector<Tensor>& inputs) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t capacity_;
+
+  mutex mu_;
+  condition_variable copies_done_;
+  int num_pending_copies_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_copied_rows_ TF_GUARDED_BY(mu_) = 0;
+  bool usable_ TF_GUARDED_BY(mu_) = true;
+  // One tensor with `capacity_` rows per input, once allocated.
+  std::vector<Tensor> buffers_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_INPUT_BUFFER_H_
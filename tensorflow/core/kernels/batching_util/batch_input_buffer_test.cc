@@ -0,0 +1,108 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_input_buffer.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+TEST(BatchInputBufferTest, ConcatenatesAndPads) {
+  BatchInputBuffer buffer(/*capacity=*/8);
+  buffer.AddPendingCopy();
+  buffer.AddPendingCopy();
+  // The tasks may copy in any order.
+  buffer.CopyIn(cpu_allocator(), /*offset=*/1,
+                {test::AsTensor<int32>({3, 4, 5, 6}, TensorShape({2, 2}))});
+  buffer.CopyIn(cpu_allocator(), /*offset=*/0,
+                {test::AsTensor<int32>({1, 2}, TensorShape({1, 2}))});
+
+  std::vector<Tensor> batch_inputs;
+  ASSERT_TRUE(buffer.Finish(/*batch_size=*/3, /*padded_batch_size=*/4,
+                            &batch_inputs));
+  ASSERT_EQ(batch_inputs.size(), 1);
+  test::ExpectTensorEqual<int32>(
+      batch_inputs[0],
+      test::AsTensor<int32>({1, 2, 3, 4, 5, 6, 1, 2}, TensorShape({4, 2})));
+}
+
+TEST(BatchInputBufferTest, WaitsForPendingCopies) {
+  BatchInputBuffer buffer(/*capacity=*/2);
+  buffer.AddPendingCopy();
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      ThreadOptions(), "copy_in", [&buffer] {
+        Env::Default()->SleepForMicroseconds(10 * 1000);
+        buffer.CopyIn(cpu_allocator(), /*offset=*/0,
+                      {test::AsTensor<float>({1, 2}, TensorShape({2}))});
+      }));
+
+  std::vector<Tensor> batch_inputs;
+  ASSERT_TRUE(buffer.Finish(/*batch_size=*/2, /*padded_batch_size=*/2,
+                            &batch_inputs));
+  test::ExpectTensorEqual<float>(batch_inputs[0],
+                                 test::AsTensor<float>({1, 2}));
+}
+
+TEST(BatchInputBufferTest, MismatchedShapesAreUnusable) {
+  BatchInputBuffer buffer(/*capacity=*/4);
+  buffer.AddPendingCopy();
+  buffer.AddPendingCopy();
+  buffer.CopyIn(cpu_allocator(), /*offset=*/0,
+                {test::AsTensor<int32>({1, 2}, TensorShape({1, 2}))});
+  buffer.CopyIn(cpu_allocator(), /*offset=*/1,
+                {test::AsTensor<int32>({3, 4, 5}, TensorShape({1, 3}))});
+
+  std::vector<Tensor> batch_inputs;
+  EXPECT_FALSE(buffer.Finish(/*batch_size=*/2, /*padded_batch_size=*/2,
+                             &batch_inputs));
+  EXPECT_TRUE(batch_inputs.empty());
+}
+
+TEST(BatchInputBufferTest, MissingRowsAreUnusable) {
+  BatchInputBuffer buffer(/*capacity=*/4);
+  buffer.AddPendingCopy();
+  buffer.CopyIn(cpu_allocator(), /*offset=*/0,
+                {test::AsTensor<int32>({1, 2}, TensorShape({1, 2}))});
+
+  std::vector<Tensor> batch_inputs;
+  EXPECT_FALSE(buffer.Finish(/*batch_size=*/2, /*padded_batch_size=*/2,
+                             &batch_inputs));
+}
+
+TEST(BatchInputBufferTest, StringsAreUnusable) {
+  BatchInputBuffer buffer(/*capacity=*/1);
+  buffer.AddPendingCopy();
+  buffer.CopyIn(cpu_allocator(), /*offset=*/0,
+                {test::AsTensor<tstring>({"a"}, TensorShape({1}))});
+
+  std::vector<Tensor> batch_inputs;
+  EXPECT_FALSE(buffer.Finish(/*batch_size=*/1, /*padded_batch_size=*/1,
+                             &batch_inputs));
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
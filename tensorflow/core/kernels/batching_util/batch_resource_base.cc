@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -32,6 +33,7 @@ limitations under the License.
 #include "absl/functional/bind_front.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/synchronization/mutex.h"
@@ -51,8 +53,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/batching_util/batch_input_buffer.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler_utils.h"
+#include "tensorflow/core/kernels/batching_util/batch_size_profiler.h"
 #include "tensorflow/core/kernels/batching_util/concat_split_util.h"
 #include "tensorflow/core/kernels/batching_util/input_split_metadata.h"
 #include "tensorflow/core/kernels/batching_util/threadsafe_status.h"
@@ -213,6 +218,76 @@ void RecordBatchDelayUsV2(int64_t batch_delay_us, const string& model_name,
       ->Add(static_cast<double>(batch_delay_us));
 }
 
+// Record the padding relative to the real size of the batch.
+void RecordPaddingFraction(double padding_fraction, const string& model_name,
+                           int32_t execution_batch_size,
+                           const string& op_name) {
+  static auto* cell = tensorflow::monitoring::Sampler<3>::New(
+      {"/tensorflow/serving/batching/padding_fraction",
+       "Tracks the distribution of the number of padded slots per real slot "
+       "on batches by model_name (if available).",
+       "model_name", "execution_batch_size", "op_name"},
+      monitoring::Buckets::Explicit(
+          {0.01, 0.05, 0.1, 0.2, 0.3, 0.5, 0.75, 1, 2, 4, 8}));
+  cell->GetCell(model_name, absl::StrCat(execution_batch_size), op_name)
+      ->Add(padding_fraction);
+}
+
+// Record the time from the registration of the oldest input of a batch until
+// the batch was closed.
+void RecordBatchFormationUs(int64_t batch_formation_us,
+                            const string& model_name, const string& op_name,
+                            int32_t batch_size) {
+  static auto* cell = tensorflow::monitoring::Sampler<3>::New(
+      {"/tensorflow/serving/batching/batch_formation_us",
+       "Tracks the time (in microseconds) batches are open by model_name (if "
+       "available).",
+       "model_name", "op_name", "processed_batch_size"},
+      monitoring::Buckets::Exponential(1, 2, 27));
+  cell->GetCell(model_name, op_name, std::to_string(batch_size))
+      ->Add(static_cast<double>(batch_formation_us));
+}
+
+// Record the time from the closing of a batch until its processing starts.
+void RecordBatchQueueWaitUs(int64_t batch_queue_wait_us,
+                            const string& model_name, const string& op_name,
+                            int32_t batch_size) {
+  static auto* cell = tensorflow::monitoring::Sampler<3>::New(
+      {"/tensorflow/serving/batching/batch_queue_wait_us",
+       "Tracks the time (in microseconds) closed batches wait for a batch "
+       "thread by model_name (if available).",
+       "model_name", "op_name", "processed_batch_size"},
+      monitoring::Buckets::Exponential(1, 2, 27));
+  cell->GetCell(model_name, op_name, std::to_string(batch_size))
+      ->Add(static_cast<double>(batch_queue_wait_us));
+}
+
+// Record the time the batch function takes to process a batch.
+void RecordBatchExecutionUs(int64_t batch_execution_us,
+                            const string& model_name, const string& op_name,
+                            int32_t batch_size) {
+  static auto* cell = tensorflow::monitoring::Sampler<3>::New(
+      {"/tensorflow/serving/batching/batch_execution_us",
+       "Tracks the time (in microseconds) the batch function runs by "
+       "model_name (if available).",
+       "model_name", "op_name", "processed_batch_size"},
+      monitoring::Buckets::Exponential(1, 2, 27));
+  cell->GetCell(model_name, op_name, std::to_string(batch_size))
+      ->Add(static_cast<double>(batch_execution_us));
+}
+
+// Record the number of splits large inputs are split into.
+void RecordInputSplits(int32_t num_splits, const string& model_name,
+                       const string& op_name) {
+  static auto* cell = tensorflow::monitoring::Sampler<2>::New(
+      {"/tensorflow/serving/batching/input_splits",
+       "Tracks the number of splits of the inputs which are split by "
+       "model_name (if available).",
+       "model_name", "op_name"},
+      monitoring::Buckets::Exponential(1, 2, 14));
+  cell->GetCell(model_name, op_name)->Add(static_cast<double>(num_splits));
+}
+
 void RecordBatchParamBatchTimeoutMicros(int64_t batch_timeout_micros,
                                         const string& model_name,
                                         const string& op_name) {
@@ -287,8 +362,134 @@ int GetTotalTaskSize(
   return tasks_size;
 }
 
+// Copies `from` into `to`, which has the same shape except along `dimension`.
+// Along it, every row is truncated or zero padded to the size of `to`.
+// Requires a type which can be copied with memcpy.
+void CopyAlongDimension(const Tensor& from, int dimension, Tensor* to) {
+  if (from.NumElements() == 0 || to->NumElements() == 0) return;
+  int64_t num_rows = 1;
+  for (int i = 0; i < dimension; ++i) num_rows *= from.dim_size(i);
+  int64_t slice_bytes = DataTypeSize(from.dtype());
+  for (int i = dimension + 1; i < from.dims(); ++i) {
+    slice_bytes *= from.dim_size(i);
+  }
+  const int64_t from_row_bytes = from.dim_size(dimension) * slice_bytes;
+  const int64_t to_row_bytes = to->dim_size(dimension) * slice_bytes;
+  const int64_t copy_bytes = std::min(from_row_bytes, to_row_bytes);
+  const char* src = from.tensor_data().data();
+  char* dst = const_cast<char*>(to->tensor_data().data());
+  for (int64_t row = 0; row < num_rows; ++row) {
+    std::memcpy(dst + row * to_row_bytes, src + row * from_row_bytes,
+                copy_bytes);
+    std::memset(dst + row * to_row_bytes + copy_bytes, 0,
+                to_row_bytes - copy_bytes);
+  }
+}
+
+// Slices the padding of the ragged bucket of `task` off `output`, if it has
+// the size of the bucket boundary along `ragged_dimension`.
+Status RemoveRaggedPadding(const BatchResourceBase::BatchTask& task,
+                           int ragged_dimension, int64_t bucket_boundary,
+                           Tensor* output) {
+  if (task.ragged_bucket < 0 || output->dims() <= ragged_dimension ||
+      output->dim_size(ragged_dimension) != bucket_boundary ||
+      task.ragged_dimension_size == bucket_boundary) {
+    return absl::OkStatus();
+  }
+  TensorShape shape = output->shape();
+  shape.set_dim(ragged_dimension, task.ragged_dimension_size);
+  Tensor sliced;
+  TF_RETURN_IF_ERROR(
+      task.context->allocate_temp(output->dtype(), shape, &sliced));
+  CopyAlongDimension(*output, ragged_dimension, &sliced);
+  *output = std::move(sliced);
+  return absl::OkStatus();
+}
+
+// Splits `tensor` into slices of `sizes` rows which share its buffer, unless
+// one of them would not be aligned.
+bool SliceAlongBatchDimension(const Tensor& tensor,
+                              absl::Span<const int64_t> sizes,
+                              std::vector<Tensor>* slices) {
+  int64_t start = 0;
+  for (int64_t size : sizes) {
+    Tensor slice = tensor.Slice(start, start + size);
+    if (!slice.IsAligned()) {
+      slices->clear();
+      return false;
+    }
+    slices->push_back(std::move(slice));
+    start += size;
+  }
+  return true;
+}
+
 }  // namespace
 
+struct BatchResourceBase::SplitOutputBuffers {
+  SplitOutputBuffers(int64_t batch_size, int num_outputs)
+      : batch_size(batch_size),
+        outputs(num_outputs, nullptr),
+        not_preallocated(num_outputs, false) {}
+
+  // Copies `split_output`, output `i` of the split `task`, into the
+  // preallocated output `i`, allocating it first if needed. Leaves `*copied`
+  // false if the output can't be preallocated.
+  Status CopyIn(const BatchTask& task, int i, const Tensor& split_output,
+                bool* copied) {
+    *copied = false;
+    Tensor* output;
+    {
+      mutex_lock l(mu);
+      if (outputs[i] == nullptr) {
+        if (not_preallocated[i]) return absl::OkStatus();
+        if (task.forced_warmup_batch_size != 0 || split_output.dims() < 1 ||
+            !DataTypeCanUseMemcpy(split_output.dtype())) {
+          not_preallocated[i] = true;
+          return absl::OkStatus();
+        }
+        TensorShape shape = split_output.shape();
+        shape.set_dim(0, batch_size);
+        TF_RETURN_IF_ERROR(
+            task.context->allocate_output(i, shape, &outputs[i]));
+      }
+      output = outputs[i];
+    }
+    bool compatible = split_output.dtype() == output->dtype() &&
+                      split_output.dims() == output->dims() &&
+                      task.split_offset + split_output.dim_size(0) <=
+                          batch_size;
+    for (int d = 1; compatible && d < output->dims(); ++d) {
+      compatible = split_output.dim_size(d) == output->dim_size(d);
+    }
+    if (!compatible) {
+      return errors::Internal("Output ", i, " of split ", task.split_index,
+                              " has shape ", split_output.shape().DebugString(),
+                              " which is incompatible with the output shape ",
+                              output->shape().DebugString());
+    }
+    if (split_output.TotalBytes() > 0) {
+      const size_t row_bytes = output->TotalBytes() / batch_size;
+      char* dst = const_cast<char*>(output->tensor_data().data());
+      std::memcpy(dst + task.split_offset * row_bytes,
+                  split_output.tensor_data().data(), split_output.TotalBytes());
+    }
+    *copied = true;
+    return absl::OkStatus();
+  }
+
+  // Returns whether output `i` was preallocated.
+  bool IsPreallocated(int i) {
+    mutex_lock l(mu);
+    return outputs[i] != nullptr;
+  }
+
+  const int64_t batch_size;
+  mutex mu;
+  std::vector<Tensor*> outputs TF_GUARDED_BY(mu);
+  std::vector<bool> not_preallocated TF_GUARDED_BY(mu);
+};
+
 std::unique_ptr<BatchResourceBase::BatchTask>
 BatchResourceBase::BatchTask::CreateSplitTask(
     int split_index, AsyncOpKernel::DoneCallback done_callback) {
@@ -307,6 +508,11 @@ BatchResourceBase::BatchTask::CreateSplitTask(
   task->start_time = this->start_time;
   task->request_cost = this->request_cost;
   task->forced_warmup_batch_size = this->forced_warmup_batch_size;
+  task->ragged_bucket = this->ragged_bucket;
+  task->ragged_dimension_size = this->ragged_dimension_size;
+  task->pending_input_copies = this->pending_input_copies;
+  task->split_output_buffers = this->split_output_buffers;
+  task->partial_output_callback = this->partial_output_callback;
 
   return task;
 }
@@ -340,16 +546,22 @@ Status BatchResourceBase::RegisterWarmupInputs(
     (*batch_task)->status = shared_status;
     return batch_task;
   };
+  // A profiled model is warmed up at the batch sizes to profile instead.
+  const BatchSizeProfiler* profiler = GetBatchSizeProfiler(context);
+  const std::vector<int32>& warmup_batch_sizes =
+      profiler != nullptr && !profiler->batch_sizes().empty()
+          ? profiler->batch_sizes()
+          : allowed_batch_sizes_;
   auto warmup_counter =
-      std::make_shared<absl::BlockingCounter>(allowed_batch_sizes_.size());
+      std::make_shared<absl::BlockingCounter>(warmup_batch_sizes.size());
   // Enqueue warmup batches.
-  for (int i = 0; i < allowed_batch_sizes_.size(); ++i) {
+  for (int i = 0; i < warmup_batch_sizes.size(); ++i) {
     Status status = RegisterInput(
         guid, context, batcher_queue_name, create_batch_task_fn_share_status,
         [warmup_counter = warmup_counter.get()]() {
           warmup_counter->DecrementCount();
         },
-        allowed_batch_sizes_[i]);
+        warmup_batch_sizes[i]);
     if (!status.ok()) return status;
   }
   // Enqueue real batch if the other batches were enqueued successfully.
@@ -470,9 +682,30 @@ Status BatchResourceBase::RegisterInput(
     batch_components->request_cost = request_cost_accessor->GetRequestCost();
   }
 
+  string queue_name = batcher_queue_name;
+  if (ragged_dimension_ >= 0) {
+    TF_RETURN_IF_ERROR(AssignRaggedBucket(context, batch_components.get()));
+    absl::StrAppend(
+        &queue_name, "/ragged_bucket_",
+        ragged_bucket_boundaries_[batch_components->ragged_bucket]);
+  }
   BatcherQueueT* batcher_queue;
-  TF_RETURN_IF_ERROR(
-      LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+  TF_RETURN_IF_ERROR(LookupOrCreateBatcherQueue(
+      queue_name, batch_components->ragged_bucket, &batcher_queue));
+
+  // Filled in by the batcher queue while the task joins batches, see
+  // `LookupOrCreateBatcherQueue`.
+  std::shared_ptr<std::vector<BatchInputBuffer::PendingCopy>>
+      pending_input_copies;
+  Allocator* host_allocator = nullptr;
+  if (assemble_batches_in_place_ && forced_warmup_batch_size == 0) {
+    pending_input_copies =
+        std::make_shared<std::vector<BatchInputBuffer::PendingCopy>>();
+    batch_components->pending_input_copies = pending_input_copies;
+    AllocatorAttributes host_alloc_attrs;
+    host_alloc_attrs.set_on_host(true);
+    host_allocator = context->get_allocator(host_alloc_attrs);
+  }
 
   if (!session_metadata().name().empty()) {
     absl::MutexLock lock(&outstanding_batch_mu_);
@@ -487,7 +720,121 @@ Status BatchResourceBase::RegisterInput(
     num_outstanding_batched_items_ += batch_components->size();
   }
 
-  return batcher_queue->Schedule(&batch_components);
+  const Status status = batcher_queue->Schedule(&batch_components);
+  if (pending_input_copies != nullptr) {
+    // The batches of the task wait for these copies before they are
+    // processed, so they have to be made even if scheduling failed.
+    for (const BatchInputBuffer::PendingCopy& copy : *pending_input_copies) {
+      copy.buffer->CopyIn(host_allocator, copy.offset, copy.inputs);
+    }
+    pending_input_copies->clear();
+  }
+  return status;
+}
+
+Status BatchResourceBase::SetRaggedBucketing(
+    int ragged_dimension, std::vector<int32> bucket_boundaries,
+    std::vector<int32> bucket_max_batch_sizes) {
+  if (!has_process_batch_function_ || !batcher_) {
+    return errors::Unimplemented(
+        "Ragged bucketing is only supported for batch functions which use the "
+        "shared batch scheduler.");
+  }
+  if (ragged_dimension < 1) {
+    return errors::InvalidArgument(
+        "The ragged dimension must not be the batch dimension, but is ",
+        ragged_dimension);
+  }
+  if (bucket_boundaries.empty()) {
+    return errors::InvalidArgument("Ragged bucket boundaries must be given.");
+  }
+  for (int i = 0; i < bucket_boundaries.size(); ++i) {
+    if (bucket_boundaries[i] <= (i == 0 ? 0 : bucket_boundaries[i - 1])) {
+      return errors::InvalidArgument(
+          "Ragged bucket boundaries must be positive and strictly increasing, "
+          "but are [",
+          absl::StrJoin(bucket_boundaries, ","), "]");
+    }
+  }
+  if (!bucket_max_batch_sizes.empty()) {
+    if (bucket_max_batch_sizes.size() != bucket_boundaries.size()) {
+      return errors::InvalidArgument(
+          "There must be one maximum batch size per ragged bucket, but there "
+          "are ",
+          bucket_max_batch_sizes.size(), " for ", bucket_boundaries.size(),
+          " buckets.");
+    }
+    const int32 max_batch_size =
+        batcher_queue_options_.enable_large_batch_splitting
+            ? batcher_queue_options_.max_execution_batch_size
+            : batcher_queue_options_.input_batch_size_limit;
+    for (int32 bucket_max_batch_size : bucket_max_batch_sizes) {
+      if (bucket_max_batch_size <= 0 ||
+          bucket_max_batch_size > max_batch_size ||
+          (!allowed_batch_sizes_.empty() &&
+           std::find(allowed_batch_sizes_.begin(), allowed_batch_sizes_.end(),
+                     bucket_max_batch_size) == allowed_batch_sizes_.end())) {
+        return errors::InvalidArgument(
+            "The maximum batch size ", bucket_max_batch_size,
+            " of a ragged bucket must be positive, at most ", max_batch_size,
+            " and one of the allowed batch sizes [", allowed_batch_sizes_str_,
+            "] if any.");
+      }
+    }
+  }
+  ragged_dimension_ = ragged_dimension;
+  ragged_bucket_boundaries_ = std::move(bucket_boundaries);
+  ragged_bucket_max_batch_sizes_ = std::move(bucket_max_batch_sizes);
+  return absl::OkStatus();
+}
+
+Status BatchResourceBase::AssignRaggedBucket(OpKernelContext* context,
+                                             BatchTask* task) const {
+  int64_t size = -1;
+  for (const Tensor& input : task->inputs) {
+    if (input.dims() <= ragged_dimension_) continue;
+    if (size >= 0 && input.dim_size(ragged_dimension_) != size) {
+      return errors::InvalidArgument(
+          "Batching input tensors supplied in a given op invocation must have "
+          "equal sizes along the ragged dimension ",
+          ragged_dimension_, ", but got ", size, " and ",
+          input.dim_size(ragged_dimension_));
+    }
+    if (!DataTypeCanUseMemcpy(input.dtype())) {
+      return errors::Unimplemented(
+          "Ragged bucketing does not support batching input tensors of type ",
+          DataTypeString(input.dtype()));
+    }
+    size = input.dim_size(ragged_dimension_);
+  }
+  if (size < 0) {
+    return errors::InvalidArgument(
+        "None of the batching input tensors has the ragged dimension ",
+        ragged_dimension_);
+  }
+  const auto bucket = std::lower_bound(ragged_bucket_boundaries_.begin(),
+                                       ragged_bucket_boundaries_.end(), size);
+  if (bucket == ragged_bucket_boundaries_.end()) {
+    return errors::InvalidArgument(
+        "The size ", size, " of the batching input tensors along the ragged "
+        "dimension exceeds the largest ragged bucket boundary ",
+        ragged_bucket_boundaries_.back());
+  }
+  task->ragged_bucket = bucket - ragged_bucket_boundaries_.begin();
+  task->ragged_dimension_size = size;
+  if (size == *bucket) return absl::OkStatus();
+
+  for (Tensor& input : task->inputs) {
+    if (input.dims() <= ragged_dimension_) continue;
+    TensorShape padded_shape = input.shape();
+    padded_shape.set_dim(ragged_dimension_, *bucket);
+    Tensor padded;
+    TF_RETURN_IF_ERROR(
+        context->allocate_temp(input.dtype(), padded_shape, &padded));
+    CopyAlongDimension(input, ragged_dimension_, &padded);
+    input = std::move(padded);
+  }
+  return absl::OkStatus();
 }
 
 /*static*/ BatchResourceBase::BatcherT::QueueOptions
@@ -684,6 +1031,21 @@ Status BatchResourceBase::ConcatInputTensors(
                              context->op_kernel().name());
   RecordBatchSize(batch.size(), GetModelName(context),
                   context->op_kernel().name());
+  if (!just_for_warmup) {
+    RecordPaddingFraction(
+        static_cast<double>(padding_amount) /
+            (batch.size() + unbatched_tasks_size),
+        GetModelName(context), padded_batch_size, context->op_kernel().name());
+  }
+
+  // With in-place batch assembly, the tasks copied their inputs into the
+  // buffer of the batch while it was open.
+  if (!just_for_warmup && unbatched_tasks.empty() &&
+      batch.task(0).input_buffer != nullptr &&
+      batch.task(0).input_buffer->Finish(batch.size(), padded_batch_size,
+                                         concatenated_tensors)) {
+    return absl::OkStatus();
+  }
 
   // All tasks should have the same number of input edges.
   const int num_inputs = batch.task(0).inputs.size();
@@ -747,16 +1109,20 @@ Status BatchResourceBase::ConcatInputTensors(
   DCHECK_GT(input_task_size, 0);
 
   std::shared_ptr<ThreadSafeStatus> shared_status = input_task.status;
+  auto split_output_buffers = std::make_shared<SplitOutputBuffers>(
+      input_task_size, input_task.context->num_outputs());
 
   // `split_task_done_callback` runs only after all splitted tasks are
   // complete.
   std::function<void()> split_task_done_callback =
       [done_callback = input_task.done_callback, output = input_task.output,
        forced_warmup_batch_size = input_task.forced_warmup_batch_size,
-       op_kernel_context = input_task.context,
-       status = shared_status]() mutable {
+       op_kernel_context = input_task.context, status = shared_status,
+       split_output_buffers]() mutable {
         const int num_output = op_kernel_context->num_outputs();
         for (int i = 0; i < num_output; ++i) {
+          // The splits already copied their outputs into this one.
+          if (split_output_buffers->IsPreallocated(i)) continue;
           Tensor output_tensor;
 
           // Concat would memcpy each input tensor to one output tensor.
@@ -786,6 +1152,8 @@ Status BatchResourceBase::ConcatInputTensors(
 
   const absl::FixedArray<int>& task_sizes = input_split_metadata.task_sizes();
   const int num_batches = task_sizes.size();
+  RecordInputSplits(num_batches, GetModelName(input_task.context),
+                    input_task.context->op_kernel().name());
   std::vector<int64_t> output_task_sizes;
   output_task_sizes.resize(num_batches);
   for (int i = 0; i < num_batches; i++) {
@@ -797,9 +1165,13 @@ Status BatchResourceBase::ConcatInputTensors(
     (*input_task.output)[i].resize(input_task.context->num_outputs());
   }
 
+  input_task.split_output_buffers = split_output_buffers;
   output_tasks->reserve(num_batches);
+  int64_t split_offset = input_task.split_offset;
   for (int i = 0; i < num_batches; i++) {
     output_tasks->push_back(input_task.CreateSplitTask(i, barrier.Inc()));
+    output_tasks->back()->split_offset = split_offset;
+    split_offset += output_task_sizes[i];
   }
 
   const int num_input_tensors = input_task.inputs.size();
@@ -870,6 +1242,11 @@ Status BatchResourceBase::SplitOutputTensors(
     return errors::Internal("Wrong number of batched output tensors");
   }
 
+  // Outputs of the tasks with a `partial_output_callback`, to be streamed
+  // once all outputs are split.
+  std::vector<std::vector<Tensor>> streamed_outputs(
+      batch->num_tasks() + unbatched_tasks.size());
+
   // Split each element of `combined_outputs` according to task sizes
   // within the batch, and use this to populate context outputs.
   for (int i = 0, iter_limit = combined_outputs.size(); i < iter_limit; ++i) {
@@ -887,8 +1264,15 @@ Status BatchResourceBase::SplitOutputTensors(
     }
 
     std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+    Status split_status;
+    if (!assemble_batches_in_place_ ||
+        !SliceAlongBatchDimension(output_tensor,
+                                  task_sizes_plus_optional_padding,
+                                  &split_tensor)) {
+      split_status = tensor::Split(output_tensor,
+                                   task_sizes_plus_optional_padding,
+                                   &split_tensor);
+    }
     DCHECK(split_status.ok()) << split_status;
     if (!split_status.ok()) {
       return errors::Internal("Tensor split operation failed: ",
@@ -905,18 +1289,52 @@ Status BatchResourceBase::SplitOutputTensors(
     // Ignore a possible final split_tensors entry containing the padding.
     for (int j = 0; j < batch->num_tasks(); ++j) {
       BatchTask& task = *(batch->mutable_task(j));
+      if (task.ragged_bucket >= 0) {
+        TF_RETURN_IF_ERROR(RemoveRaggedPadding(
+            task, ragged_dimension_,
+            ragged_bucket_boundaries_[task.ragged_bucket], &split_tensor[j]));
+      }
+      if (task.partial_output_callback) {
+        streamed_outputs[j].push_back(split_tensor[j]);
+      }
       if (task.is_partial) {
-        std::vector<Tensor>& tensor_vector = (*task.output)[task.split_index];
-        tensor_vector[i] = std::move(split_tensor[j]);
+        bool copied = false;
+        if (task.split_output_buffers != nullptr) {
+          TF_RETURN_IF_ERROR(task.split_output_buffers->CopyIn(
+              task, i, split_tensor[j], &copied));
+        }
+        if (!copied) {
+          std::vector<Tensor>& tensor_vector =
+              (*task.output)[task.split_index];
+          tensor_vector[i] = std::move(split_tensor[j]);
+        }
       } else {
         task.context->set_output(i, split_tensor[j]);
       }
     }
     for (int j = 0; j < unbatched_tasks.size(); ++j) {
+      const BatchTask& task = *unbatched_tasks[j];
+      Tensor& output = split_tensor[batch->num_tasks() + j];
+      if (task.ragged_bucket >= 0) {
+        TF_RETURN_IF_ERROR(RemoveRaggedPadding(
+            task, ragged_dimension_,
+            ragged_bucket_boundaries_[task.ragged_bucket], &output));
+      }
+      if (task.partial_output_callback) {
+        streamed_outputs[batch->num_tasks() + j].push_back(output);
+      }
       // The unbatched tasks are not split, so no need to handle the partial
       // case separately.
-      unbatched_tasks[j]->context->set_output(
-          i, split_tensor[batch->num_tasks() + j]);
+      task.context->set_output(i, output);
+    }
+  }
+
+  for (int j = 0; j < streamed_outputs.size(); ++j) {
+    const BatchTask& task = j < batch->num_tasks()
+                                ? batch->task(j)
+                                : *unbatched_tasks[j - batch->num_tasks()];
+    if (task.partial_output_callback) {
+      task.partial_output_callback(task.split_offset, streamed_outputs[j]);
     }
   }
 
@@ -1011,6 +1429,7 @@ void BatchResourceBase::ProcessFuncBatch(
   args.insert(args.end(), captured_inputs.begin(), captured_inputs.end());
 
   uint64 current_time = EnvTime::NowNanos();
+  uint64 oldest_start_time = current_time;
   for (int i = 0; i < batch->num_tasks(); ++i) {
     RecordBatchDelayUs((current_time - batch->task(i).start_time) * 1e-3,
                        model_name, last_task_context->op_kernel().name(),
@@ -1018,12 +1437,49 @@ void BatchResourceBase::ProcessFuncBatch(
     RecordBatchDelayUsV2((current_time - batch->task(i).start_time) * 1e-3,
                          model_name, last_task_context->op_kernel().name(),
                          processed_size);
+    oldest_start_time = std::min(oldest_start_time, batch->task(i).start_time);
+  }
+  // Breaks the delay of the batch down into the time it was open and the
+  // time it waited for a batch thread once closed.
+  const int64_t close_time_micros = batch->close_time_micros();
+  int64_t batch_formation_us = 0;
+  if (close_time_micros > 0) {
+    batch_formation_us = std::max<int64_t>(
+        0, close_time_micros - static_cast<int64_t>(oldest_start_time / 1000));
+    RecordBatchFormationUs(batch_formation_us, model_name,
+                           last_task_context->op_kernel().name(),
+                           processed_size);
+    RecordBatchQueueWaitUs(
+        std::max<int64_t>(
+            0, static_cast<int64_t>(current_time / 1000) - close_time_micros),
+        model_name, last_task_context->op_kernel().name(), processed_size);
   }
   // Releases the cleanup method here, because the callback of the function
   // library runtime will handle it now.
   finally.release();
+  tsl::profiler::TraceMe trace_me([&] {
+    return profiler::TraceMeEncode(
+        "ProcessFuncBatch",
+        {{"batch_size", batch->size()},
+         {"processed_batch_size", processed_size},
+         {"batch_formation_us", batch_formation_us},
+         {"num_tasks", batch->num_tasks()}});
+  });
   ProcessFuncBatchImpl(
       last_task, args, &combined_outputs, [&](const Status& run_status) {
+        const int64_t execution_us =
+            (EnvTime::NowNanos() - current_time) / 1000;
+        RecordBatchExecutionUs(execution_us, model_name,
+                               last_task_context->op_kernel().name(),
+                               processed_size);
+        if (last_task.forced_warmup_batch_size > 0 && run_status.ok()) {
+          BatchSizeProfiler* profiler =
+              GetBatchSizeProfiler(last_task_context);
+          if (profiler != nullptr) {
+            profiler->Record(last_task_context->op_kernel().name(),
+                             last_task.forced_warmup_batch_size, execution_us);
+          }
+        }
         Status final_status;
         auto run_finally = gtl::MakeCleanup([&]() {
           // We do the cleanup here as an optimization, so that
@@ -1169,6 +1625,7 @@ void BatchResourceBase::ProcessBatchCallBack(
 // Looks up the batcher queue for 'queue_name'. If it didn't previously exist,
 // creates it.
 Status BatchResourceBase::LookupOrCreateBatcherQueue(const string& queue_name,
+                                                     int ragged_bucket,
                                                      BatcherQueueT** queue) {
   mutex_lock l(batcher_queues_mu_);
 
@@ -1180,8 +1637,50 @@ Status BatchResourceBase::LookupOrCreateBatcherQueue(const string& queue_name,
 
   std::unique_ptr<BatcherQueueT> new_queue;
   if (batcher_) {
+    BatcherT::QueueOptions queue_options = batcher_queue_options_;
+    if (ragged_bucket >= 0 && !ragged_bucket_max_batch_sizes_.empty()) {
+      // Batches of the bucket stop at its maximum size, and are padded to the
+      // allowed batch sizes up to it.
+      const int32 max_batch_size =
+          ragged_bucket_max_batch_sizes_[ragged_bucket];
+      if (queue_options.enable_large_batch_splitting) {
+        queue_options.max_execution_batch_size = max_batch_size;
+        queue_options.high_priority_queue_options.max_execution_batch_size =
+            max_batch_size;
+        std::vector<int32>& allowed_batch_sizes =
+            queue_options.allowed_batch_sizes;
+        allowed_batch_sizes.erase(
+            std::remove_if(
+                allowed_batch_sizes.begin(), allowed_batch_sizes.end(),
+                [max_batch_size](int32 size) { return size > max_batch_size; }),
+            allowed_batch_sizes.end());
+      } else {
+        queue_options.input_batch_size_limit = max_batch_size;
+        queue_options.high_priority_queue_options.input_batch_size_limit =
+            max_batch_size;
+      }
+    }
+    if (assemble_batches_in_place_) {
+      const int64_t capacity = queue_options.enable_large_batch_splitting
+                                   ? queue_options.max_execution_batch_size
+                                   : queue_options.input_batch_size_limit;
+      // The first task of a batch creates its buffer, and every task records
+      // the copy of its inputs, which it makes once it is scheduled.
+      queue_options.add_task_to_open_batch_callback =
+          [capacity](const BatchT& batch, size_t offset, BatchTask* task) {
+            if (task->pending_input_copies == nullptr) return;
+            task->input_buffer =
+                offset == 0 ? std::make_shared<BatchInputBuffer>(capacity)
+                            : batch.task(0).input_buffer;
+            if (task->input_buffer == nullptr) return;
+            task->input_buffer->AddPendingCopy();
+            task->pending_input_copies->push_back(
+                {task->input_buffer, static_cast<int64_t>(offset),
+                 task->inputs});
+          };
+    }
     TF_RETURN_IF_ERROR(batcher_->AddQueue(
-        batcher_queue_options_,
+        queue_options,
         absl::bind_front(&BatchResourceBase::ProcessBatchCallBack, this),
         &new_queue));
   } else if (adaptive_batcher_) {
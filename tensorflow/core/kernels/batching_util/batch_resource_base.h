@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/batching_util/adaptive_shared_batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/batch_input_buffer.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/threadsafe_status.h"
@@ -69,6 +70,10 @@ class BatchResourceBase : public ResourceBase {
   // concatenating tensors along the 2nd dimension gives a output tensor.
   typedef std::vector<std::vector<Tensor>> TensorMatrix;
 
+  // Preallocated outputs of an op invocation whose task is split; see
+  // BatchTask::split_output_buffers.
+  struct SplitOutputBuffers;
+
   // One task to be batched, corresponds to a `slice` of input from one batch-op
   // invocation.
   //
@@ -109,8 +114,40 @@ class BatchResourceBase : public ResourceBase {
 
     bool is_partial = false;
 
+    // Outputs of the op invocation, shared by its splits, which are allocated
+    // when the first split is processed and into which every split copies
+    // its outputs at `split_offset` along the 0-th dimension. The outputs
+    // which can't be preallocated, e.g. since their type can't be copied with
+    // memcpy, go through `output` and are concatenated once all splits are
+    // done.
+    std::shared_ptr<SplitOutputBuffers> split_output_buffers;
+    int64_t split_offset = 0;
+
+    // If set, called with the outputs of this task as soon as its batch was
+    // processed successfully, and the offset of the task along the 0-th
+    // dimension of the inputs of the op invocation. Splits of a task inherit
+    // it, so that the outputs of a large invocation can be streamed split by
+    // split, instead of only once all of them are done.
+    std::function<void(int64_t offset, const std::vector<Tensor>& outputs)>
+        partial_output_callback;
+
     uint64 start_time;
 
+    // The index of the ragged bucket of this task, or -1 if the resource does
+    // not bucket its inputs. The inputs are padded up to the boundary of the
+    // bucket along the ragged dimension, and `ragged_dimension_size` is their
+    // size along it before the padding.
+    int ragged_bucket = -1;
+    int64_t ragged_dimension_size = 0;
+
+    // With in-place batch assembly, the buffer of the batch this task joined,
+    // and the copies into batch buffers which the thread that registered the
+    // task makes once it is scheduled. The latter are shared by the splits of
+    // a task, which may join different batches.
+    std::shared_ptr<BatchInputBuffer> input_buffer;
+    std::shared_ptr<std::vector<BatchInputBuffer::PendingCopy>>
+        pending_input_copies;
+
     size_t size() const override { return inputs[0].shape().dim_size(0); }
 
     // Create a split task from this one. The caller needs to setup the inputs
@@ -183,6 +220,34 @@ class BatchResourceBase : public ResourceBase {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // Groups the inputs by their size along `ragged_dimension`, so that a batch
+  // only mixes inputs of similar lengths instead of paying for the longest
+  // one. An input goes to the first bucket whose entry in `bucket_boundaries`
+  // is at least its size, and is zero padded up to that boundary. Every
+  // bucket has its own batcher queue, whose batches are limited to the
+  // corresponding entry of `bucket_max_batch_sizes` if it is not empty.
+  // Outputs with the size of the boundary along `ragged_dimension` are sliced
+  // back to the size of the input.
+  //
+  // Must be called before any input is registered, and is only supported for
+  // batch functions on the non-adaptive batcher.
+  Status SetRaggedBucketing(int ragged_dimension,
+                            std::vector<int32> bucket_boundaries,
+                            std::vector<int32> bucket_max_batch_sizes);
+
+  // If true, every batch gets a buffer for its inputs of its maximum size
+  // when it opens, and the tasks copy their inputs into it as they join the
+  // batch rather than being concatenated once it closed. The outputs are
+  // handed to the tasks as slices of the outputs of the batch, which keep
+  // them alive, instead of copies.
+  //
+  // Must be set before any input is registered. Only applies to the
+  // non-adaptive batcher, and to batches which are not padded with low
+  // priority tasks; the others are concatenated.
+  void set_assemble_batches_in_place(bool assemble_batches_in_place) {
+    assemble_batches_in_place_ = assemble_batches_in_place;
+  }
+
   using CreateBatchTaskFn =
       std::function<StatusOr<std::unique_ptr<BatchTask>>()>;
 
@@ -332,10 +397,14 @@ class BatchResourceBase : public ResourceBase {
   static Status EmitIndexTensor(OpKernelContext* context, const BatchT& batch,
                                 int output_index);
 
+  // Pads the inputs of 'task' up to the boundary of their ragged bucket, and
+  // records the bucket in the task.
+  Status AssignRaggedBucket(OpKernelContext* context, BatchTask* task) const;
+
   // Looks up the batcher queue for 'queue_name'. If it did't previously exist,
-  // creates it.
+  // creates it, with the batch sizes of 'ragged_bucket' if it isn't -1.
   Status LookupOrCreateBatcherQueue(const string& queue_name,
-                                    BatcherQueueT** queue);
+                                    int ragged_bucket, BatcherQueueT** queue);
 
   SessionMetadata session_metadata_;
 
@@ -363,6 +432,15 @@ class BatchResourceBase : public ResourceBase {
   // A concatenated string of <allowed_batch_sizes_>, separated by ",". This is
   // used to record batching parameter.
   string allowed_batch_sizes_str_;
+
+  // See `SetRaggedBucketing`. Inputs are not bucketed if `ragged_dimension_`
+  // is negative.
+  int ragged_dimension_ = -1;
+  std::vector<int32> ragged_bucket_boundaries_;
+  std::vector<int32> ragged_bucket_max_batch_sizes_;
+
+  // See `set_assemble_batches_in_place`.
+  bool assemble_batches_in_place_ = false;
 };
 
 }  // namespace serving
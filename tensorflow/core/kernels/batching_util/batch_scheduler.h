@@ -42,6 +42,7 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -58,11 +59,13 @@ const absl::string_view kLowPriorityPaddingWithMaxBatchSizeAttrValue =
 const absl::string_view kLowPriorityPaddingWithNextAllowedBatchSizeAttrValue =
     "low_priority_padding_with_next_allowed_batch_size";
 const absl::string_view kPriorityIsolationAttrValue = "priority_isolation";
+const absl::string_view kPriorityPreemptionAttrValue = "priority_preemption";
 
 enum class MixedPriorityBatchingPolicy {
   kLowPriorityPaddingWithMaxBatchSize,
   kLowPriorityPaddingWithNextAllowedBatchSize,
-  kPriorityIsolation
+  kPriorityIsolation,
+  kPriorityPreemption
 };
 
 absl::StatusOr<MixedPriorityBatchingPolicy> GetMixedPriorityBatchingPolicy(
@@ -92,6 +95,13 @@ class BatchTask {
   virtual tsl::criticality::Criticality criticality() const {
     return tsl::criticality::Criticality::kCritical;
   }
+
+  // Returns the time, in Env::NowMicros() microseconds, by which the results
+  // of the task are due, if it has a deadline. See
+  // SharedBatchScheduler::QueueOptions::enable_deadline_aware_batching.
+  virtual std::optional<uint64> deadline_micros() const {
+    return std::nullopt;
+  }
 };
 
 // A thread-safe collection of BatchTasks. Tasks can be either added or removed
@@ -301,6 +311,10 @@ class Batch {
   // Marks the batch as closed. Dies if called more than once.
   void Close();
 
+  // Returns the time, in EnvTime::NowMicros() microseconds, at which the batch
+  // was closed, or 0 if it is open.
+  uint64 close_time_micros() const;
+
   // Returns the TraceMe context id of this batch.
   uint64 traceme_context_id() const;
 
@@ -318,6 +332,9 @@ class Batch {
   // Whether the batch has been closed.
   Notification closed_;
 
+  // When the batch was closed; see close_time_micros().
+  std::atomic<uint64> close_time_micros_{0};
+
   // The TracMe context id.
   const uint64 traceme_context_id_;
 
@@ -497,9 +514,15 @@ void Batch<TaskType>::WaitUntilClosed() const {
 
 template <typename TaskType>
 void Batch<TaskType>::Close() {
+  close_time_micros_.store(EnvTime::NowMicros(), std::memory_order_relaxed);
   closed_.Notify();
 }
 
+template <typename TaskType>
+uint64 Batch<TaskType>::close_time_micros() const {
+  return close_time_micros_.load(std::memory_order_relaxed);
+}
+
 template <typename TaskType>
 uint64 Batch<TaskType>::traceme_context_id() const {
   return traceme_context_id_;
@@ -26,6 +26,7 @@ limitations under the License.
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -71,7 +72,10 @@ INSTANTIATE_TEST_SUITE_P(
                 kLowPriorityPaddingWithNextAllowedBatchSize),
         std::make_tuple(
             /*attr_name=*/kPriorityIsolationAttrValue,
-            /*policy=*/MixedPriorityBatchingPolicy::kPriorityIsolation)));
+            /*policy=*/MixedPriorityBatchingPolicy::kPriorityIsolation),
+        std::make_tuple(
+            /*attr_name=*/kPriorityPreemptionAttrValue,
+            /*policy=*/MixedPriorityBatchingPolicy::kPriorityPreemption)));
 
 class FakeTask : public BatchTask {
  public:
@@ -360,6 +364,15 @@ TEST(BatchTest, DeletionBlocksUntilClosed) {
   deleted.WaitForNotification();
 }
 
+TEST(BatchTest, CloseTime) {
+  Batch<FakeTask> batch;
+  EXPECT_EQ(batch.close_time_micros(), 0);
+  const uint64 before_close = EnvTime::NowMicros();
+  batch.Close();
+  EXPECT_GE(batch.close_time_micros(), before_close);
+  EXPECT_LE(batch.close_time_micros(), EnvTime::NowMicros());
+}
+
 TEST(BatchTest, RemoveAllTasks) {
   Batch<FakeTask> batch;
 
@@ -0,0 +1,140 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_size_profiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace serving {
+
+void BatchSizeProfiler::Record(const std::string& op_name, int batch_size,
+                               int64_t latency_micros) {
+  mutex_lock l(mu_);
+  LatencySum& sum = latencies_[op_name][batch_size];
+  sum.total_micros += latency_micros;
+  ++sum.count;
+}
+
+std::map<int, double> BatchSizeProfiler::MeanLatencies(
+    const std::string& op_name) const {
+  std::map<int, double> mean_latencies;
+  mutex_lock l(mu_);
+  auto it = latencies_.find(op_name);
+  if (it == latencies_.end()) return mean_latencies;
+  for (const auto& [batch_size, sum] : it->second) {
+    mean_latencies[batch_size] = sum.total_micros / sum.count;
+  }
+  return mean_latencies;
+}
+
+std::vector<int> BatchSizeProfiler::SelectAllowedBatchSizes(
+    const std::string& op_name, int64_t latency_slo_micros) const {
+  const std::map<int, double> latencies = MeanLatencies(op_name);
+  if (latencies.empty()) return {};
+
+  std::vector<std::pair<int, double>> candidates;
+  for (const auto& [batch_size, latency] : latencies) {
+    if (latency_slo_micros <= 0 || latency <= latency_slo_micros) {
+      candidates.emplace_back(batch_size, latency);
+    }
+  }
+  if (candidates.empty()) {
+    auto fastest = std::min_element(
+        latencies.begin(), latencies.end(),
+        [](const auto& a, const auto& b) { return a.second < b.second; });
+    return {fastest->first};
+  }
+
+  auto throughput = [](const std::pair<int, double>& candidate) {
+    return candidate.first / std::max(candidate.second, 1.0);
+  };
+  std::vector<int> selected;
+  for (const auto& candidate : candidates) {
+    bool dominated = false;
+    for (const auto& other : candidates) {
+      if (other.second <= candidate.second &&
+          throughput(other) >= throughput(candidate) &&
+          (other.second < candidate.second ||
+           throughput(other) > throughput(candidate))) {
+        dominated = true;
+        break;
+      }
+    }
+    if (!dominated) selected.push_back(candidate.first);
+  }
+  return selected;
+}
+
+void BatchSizeProfiler::SetAllowedBatchSizes(int64_t latency_slo_micros,
+                                             bool override_existing,
+                                             GraphDef* graph) const {
+  for (NodeDef& node : *graph->mutable_node()) {
+    SetAllowedBatchSizes(latency_slo_micros, override_existing, &node);
+  }
+  for (FunctionDef& function : *graph->mutable_library()->mutable_function()) {
+    for (NodeDef& node : *function.mutable_node_def()) {
+      SetAllowedBatchSizes(latency_slo_micros, override_existing, &node);
+    }
+  }
+}
+
+void BatchSizeProfiler::SetAllowedBatchSizes(int64_t latency_slo_micros,
+                                             bool override_existing,
+                                             NodeDef* node) const {
+  if (node->op() != "BatchFunction") return;
+  auto& attrs = *node->mutable_attr();
+  auto allowed_it = attrs.find("allowed_batch_sizes");
+  if (!override_existing && allowed_it != attrs.end() &&
+      allowed_it->second.list().i_size() > 0) {
+    return;
+  }
+  auto max_it = attrs.find("max_batch_size");
+  const int64_t max_batch_size =
+      max_it == attrs.end() ? 0 : max_it->second.i();
+  auto splitting_it = attrs.find("enable_large_batch_splitting");
+  const bool enable_large_batch_splitting =
+      splitting_it != attrs.end() && splitting_it->second.b();
+
+  std::vector<int64_t> allowed_batch_sizes;
+  for (int batch_size :
+       SelectAllowedBatchSizes(node->name(), latency_slo_micros)) {
+    if (max_batch_size <= 0 || batch_size <= max_batch_size) {
+      allowed_batch_sizes.push_back(batch_size);
+    }
+  }
+  if (allowed_batch_sizes.empty()) return;
+  if (!enable_large_batch_splitting && max_batch_size > 0 &&
+      allowed_batch_sizes.back() != max_batch_size) {
+    allowed_batch_sizes.push_back(max_batch_size);
+  }
+  AttrValue::ListValue* list = attrs["allowed_batch_sizes"].mutable_list();
+  list->Clear();
+  for (int64_t batch_size : allowed_batch_sizes) list->add_i(batch_size);
+}
+
+}  // namespace serving
+}  // namespace tensorflow
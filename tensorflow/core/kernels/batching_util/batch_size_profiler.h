@@ -0,0 +1,105 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_PROFILER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_PROFILER_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Measures the latency of batch ops at a sweep of batch sizes while a model
+// is warmed up, and derives `allowed_batch_sizes` from the measurements.
+//
+// When the WarmupStateRegistry entry of a model has a profiler, the warmup
+// requests of its BatchFunction ops process padding-only batches of every
+// size in `batch_sizes()` instead of every allowed batch size, and record how
+// long the batch function took for each of them.
+//
+// Example Usage:
+//   auto profiler = std::make_shared<BatchSizeProfiler>(
+//       std::vector<int>{1, 2, 4, 8, 16, 32, 64});
+//   auto per_model_data =
+//       std::make_unique<WarmupStateRegistry::PerModelData>();
+//   per_model_data->warmup_all_batch_sizes = true;
+//   per_model_data->batch_size_profiler = profiler;
+//   // Register the model, issue its warmup requests and release the handle.
+//   // Then, before loading the model for serving:
+//   profiler->SetAllowedBatchSizes(/*latency_slo_micros=*/20000,
+//                                  /*override_existing=*/false, &graph_def);
+class BatchSizeProfiler {
+ public:
+  // `batch_sizes` are the batch sizes to profile. If empty, the allowed batch
+  // sizes of every op are profiled.
+  explicit BatchSizeProfiler(std::vector<int> batch_sizes)
+      : batch_sizes_(std::move(batch_sizes)) {}
+
+  const std::vector<int>& batch_sizes() const { return batch_sizes_; }
+
+  // Records that the batch op `op_name` processed a batch of `batch_size` in
+  // `latency_micros`.
+  void Record(const std::string& op_name, int batch_size,
+              int64_t latency_micros);
+
+  // Returns the mean latency by batch size of the batch op `op_name`.
+  std::map<int, double> MeanLatencies(const std::string& op_name) const;
+
+  // Returns the profiled batch sizes of `op_name`, in increasing order, whose
+  // latency is at most `latency_slo_micros` (if positive) and on the Pareto
+  // frontier of latency and throughput, i.e. no other batch size is both
+  // faster and processes more items per second. If no batch size meets the
+  // SLO, returns the fastest one. Returns an empty list if `op_name` was not
+  // profiled.
+  std::vector<int> SelectAllowedBatchSizes(const std::string& op_name,
+                                           int64_t latency_slo_micros) const;
+
+  // Sets the `allowed_batch_sizes` of the BatchFunction nodes of `graph` and
+  // its function library to the batch sizes selected for them. Nodes which
+  // already have allowed batch sizes keep them unless `override_existing`.
+  // Without `enable_large_batch_splitting`, `max_batch_size` is kept as the
+  // largest allowed batch size, as the op requires.
+  void SetAllowedBatchSizes(int64_t latency_slo_micros, bool override_existing,
+                            GraphDef* graph) const;
+
+ private:
+  struct LatencySum {
+    double total_micros = 0;
+    int64_t count = 0;
+  };
+
+  // Rewrites `node` if it is a profiled BatchFunction.
+  void SetAllowedBatchSizes(int64_t latency_slo_micros, bool override_existing,
+                            NodeDef* node) const;
+
+  const std::vector<int> batch_sizes_;
+
+  mutable mutex mu_;
+  std::map<std::string, std::map<int, LatencySum>> latencies_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_PROFILER_H_
@@ -0,0 +1,126 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_size_profiler.h"
+
+#include <map>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Latencies of a device which is underutilized up to batches of 8, and
+// saturated beyond.
+void RecordProfile(BatchSizeProfiler* profiler, const string& op_name) {
+  profiler->Record(op_name, 1, 1000);
+  profiler->Record(op_name, 2, 1000);
+  profiler->Record(op_name, 4, 1000);
+  profiler->Record(op_name, 8, 1100);
+  profiler->Record(op_name, 16, 2000);
+  // A slower batch size than a larger one.
+  profiler->Record(op_name, 32, 5000);
+  profiler->Record(op_name, 64, 4500);
+}
+
+NodeDef BatchFunctionNode(const string& name, int64_t max_batch_size,
+                          const std::vector<int64_t>& allowed_batch_sizes,
+                          bool enable_large_batch_splitting) {
+  NodeDef node;
+  node.set_name(name);
+  node.set_op("BatchFunction");
+  auto& attrs = *node.mutable_attr();
+  attrs["max_batch_size"].set_i(max_batch_size);
+  attrs["enable_large_batch_splitting"].set_b(enable_large_batch_splitting);
+  for (int64_t batch_size : allowed_batch_sizes) {
+    attrs["allowed_batch_sizes"].mutable_list()->add_i(batch_size);
+  }
+  return node;
+}
+
+std::vector<int64_t> AllowedBatchSizes(const NodeDef& node) {
+  const auto& list = node.attr().at("allowed_batch_sizes").list();
+  return std::vector<int64_t>(list.i().begin(), list.i().end());
+}
+
+TEST(BatchSizeProfilerTest, MeanLatencies) {
+  BatchSizeProfiler profiler({});
+  profiler.Record("op", 4, 100);
+  profiler.Record("op", 4, 300);
+  profiler.Record("op", 8, 500);
+  EXPECT_EQ(profiler.MeanLatencies("op"),
+            (std::map<int, double>{{4, 200}, {8, 500}}));
+  EXPECT_THAT(profiler.MeanLatencies("other_op"), IsEmpty());
+}
+
+TEST(BatchSizeProfilerTest, SelectsParetoFrontier) {
+  BatchSizeProfiler profiler({});
+  RecordProfile(&profiler, "op");
+  // 1 and 2 are as slow as 4 for fewer items, and 32 is slower than 64.
+  EXPECT_THAT(profiler.SelectAllowedBatchSizes("op", 0),
+              ElementsAre(4, 8, 16, 64));
+  EXPECT_THAT(profiler.SelectAllowedBatchSizes("unknown_op", 0), IsEmpty());
+}
+
+TEST(BatchSizeProfilerTest, SelectsBatchSizesWithinLatencySlo) {
+  BatchSizeProfiler profiler({});
+  RecordProfile(&profiler, "op");
+  EXPECT_THAT(profiler.SelectAllowedBatchSizes("op", 3000),
+              ElementsAre(4, 8, 16));
+  // Without any batch size within the SLO, the fastest one is picked.
+  EXPECT_THAT(profiler.SelectAllowedBatchSizes("op", 500), ElementsAre(1));
+}
+
+TEST(BatchSizeProfilerTest, SetAllowedBatchSizes) {
+  BatchSizeProfiler profiler({});
+  RecordProfile(&profiler, "splitting");
+  RecordProfile(&profiler, "not_splitting");
+  RecordProfile(&profiler, "configured");
+  RecordProfile(&profiler, "in_function");
+  GraphDef graph;
+  *graph.add_node() = BatchFunctionNode("splitting", 32, {}, true);
+  *graph.add_node() = BatchFunctionNode("not_splitting", 32, {}, false);
+  *graph.add_node() = BatchFunctionNode("configured", 32, {32}, false);
+  *graph.add_node() = BatchFunctionNode("not_profiled", 32, {}, false);
+  *graph.mutable_library()->add_function()->add_node_def() =
+      BatchFunctionNode("in_function", 16, {}, true);
+
+  profiler.SetAllowedBatchSizes(/*latency_slo_micros=*/0,
+                                /*override_existing=*/false, &graph);
+  // Batch sizes above max_batch_size are left out.
+  EXPECT_THAT(AllowedBatchSizes(graph.node(0)), ElementsAre(4, 8, 16));
+  // Without splitting, max_batch_size has to be the largest one.
+  EXPECT_THAT(AllowedBatchSizes(graph.node(1)), ElementsAre(4, 8, 16, 32));
+  EXPECT_THAT(AllowedBatchSizes(graph.node(2)), ElementsAre(32));
+  EXPECT_EQ(graph.node(3).attr().count("allowed_batch_sizes"), 0);
+  EXPECT_THAT(AllowedBatchSizes(graph.library().function(0).node_def(0)),
+              ElementsAre(4, 8, 16));
+
+  profiler.SetAllowedBatchSizes(/*latency_slo_micros=*/1500,
+                                /*override_existing=*/true, &graph);
+  EXPECT_THAT(AllowedBatchSizes(graph.node(2)), ElementsAre(4, 8, 32));
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,295 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
+
+namespace tensorflow {
+namespace serving {
+
+// A scheduler for iterative computations, such as autoregressive decoding,
+// which batches tasks per iteration ("step") rather than per call. It runs a
+// single batch with a fixed number of slots. Before every step, tasks waiting
+// for a slot join the batch. After every step, the tasks which are done
+// leave it, and their slots are free for the next tasks. Tasks thus don't
+// wait for the longest task of their batch, and the batch stays full as long
+// as tasks keep arriving.
+//
+// A task keeps its slot for all of its steps, and slots are reused once their
+// tasks are done. The state of tasks across steps, e.g. the KV caches of
+// decoding, can thus be held per slot, e.g. in a resource with one row per
+// slot, which the step callback initializes for the tasks which joined at the
+// step.
+//
+// The steps run one after the other on a thread owned by the scheduler. The
+// destructor blocks until all scheduled tasks are done.
+template <typename TaskType>
+class ContinuousBatchScheduler {
+ public:
+  struct Options {
+    // The number of slots of the batch, i.e. the maximum number of tasks
+    // which run a step together.
+    int max_batch_size = 16;
+
+    // The maximum number of tasks which wait for a slot. Once it is reached,
+    // Schedule() returns an UNAVAILABLE error.
+    size_t max_enqueued_tasks = 1000;
+
+    // The name of the thread which runs the steps.
+    string thread_name = "continuous_batch_thread";
+
+    // The environment to use (typically only overridden by test code).
+    Env* env = Env::Default();
+  };
+
+  // The tasks of the batch at one step.
+  struct Step {
+    // The slots in use, in increasing order, and their tasks.
+    std::vector<int> slots;
+    std::vector<TaskType*> tasks;
+
+    // Whether each task joined the batch at this step, i.e. whether this is
+    // its first step.
+    std::vector<bool> joined;
+
+    // Whether each task is done after this step, i.e. leaves the batch. Set
+    // by the step callback; initially false for all tasks.
+    std::vector<bool> done;
+  };
+
+  // Runs one step of the tasks of `step`, and marks those which are done. If
+  // it returns an error, all the tasks of the step are done with it.
+  using StepCallback = std::function<Status(Step* step)>;
+
+  // Called with every task once it is done and has left the batch, with the
+  // error of its last step, if any.
+  using DoneCallback =
+      std::function<void(std::unique_ptr<TaskType> task, const Status& status)>;
+
+  static Status Create(const Options& options, StepCallback step_callback,
+                       DoneCallback done_callback,
+                       std::unique_ptr<ContinuousBatchScheduler>* scheduler);
+
+  ~ContinuousBatchScheduler();
+
+  // Submits a task, which joins the batch at the first step with a free slot.
+  // Takes ownership of `task` iff it returns OK.
+  Status Schedule(std::unique_ptr<TaskType>* task);
+
+  // Returns the number of tasks which wait for a slot.
+  size_t NumEnqueuedTasks() const;
+
+  // Returns the number of tasks in the batch.
+  size_t NumRunningTasks() const;
+
+ private:
+  ContinuousBatchScheduler(const Options& options, StepCallback step_callback,
+                           DoneCallback done_callback);
+
+  // The code executed in `step_thread_`. Runs steps until the scheduler is
+  // destroyed and all of its tasks are done.
+  void ThreadLogic();
+
+  // Fills the free slots with waiting tasks. Returns false iff the scheduler
+  // is being destroyed and has no tasks left.
+  bool AdmitTasks(std::vector<bool>* joined);
+
+  // Runs a step of the tasks in `slots_`, and releases those which are done.
+  void RunStep(const std::vector<bool>& joined);
+
+  const Options options_;
+  const StepCallback step_callback_;
+  const DoneCallback done_callback_;
+
+  mutable mutex mu_;
+  condition_variable tasks_available_cv_;
+
+  // The tasks waiting for a slot.
+  std::deque<std::unique_ptr<TaskType>> enqueued_tasks_ TF_GUARDED_BY(mu_);
+
+  // The number of slots in use.
+  size_t num_running_tasks_ TF_GUARDED_BY(mu_) = 0;
+
+  // Set by the destructor.
+  bool stopped_ TF_GUARDED_BY(mu_) = false;
+
+  // The task in each slot, or null for free slots. Only accessed by
+  // `step_thread_`.
+  std::vector<std::unique_ptr<TaskType>> slots_;
+
+  std::unique_ptr<Thread> step_thread_;
+
+  ContinuousBatchScheduler(const ContinuousBatchScheduler&) = delete;
+  void operator=(const ContinuousBatchScheduler&) = delete;
+};
+
+//////////
+// Implementation details follow. API users need not read.
+
+template <typename TaskType>
+Status ContinuousBatchScheduler<TaskType>::Create(
+    const Options& options, StepCallback step_callback,
+    DoneCallback done_callback,
+    std::unique_ptr<ContinuousBatchScheduler>* scheduler) {
+  if (options.max_batch_size <= 0) {
+    return errors::InvalidArgument("max_batch_size must be positive; was ",
+                                   options.max_batch_size);
+  }
+  if (step_callback == nullptr || done_callback == nullptr) {
+    return errors::InvalidArgument(
+        "step_callback and done_callback must be set");
+  }
+  scheduler->reset(new ContinuousBatchScheduler<TaskType>(
+      options, std::move(step_callback), std::move(done_callback)));
+  return absl::OkStatus();
+}
+
+template <typename TaskType>
+ContinuousBatchScheduler<TaskType>::ContinuousBatchScheduler(
+    const Options& options, StepCallback step_callback,
+    DoneCallback done_callback)
+    : options_(options),
+      step_callback_(std::move(step_callback)),
+      done_callback_(std::move(done_callback)),
+      slots_(options.max_batch_size) {
+  step_thread_.reset(options_.env->StartThread(
+      {}, options_.thread_name, [this] { ThreadLogic(); }));
+}
+
+template <typename TaskType>
+ContinuousBatchScheduler<TaskType>::~ContinuousBatchScheduler() {
+  {
+    mutex_lock l(mu_);
+    stopped_ = true;
+  }
+  tasks_available_cv_.notify_all();
+  // Joins the thread once it has run the steps of all tasks.
+  step_thread_.reset();
+}
+
+template <typename TaskType>
+Status ContinuousBatchScheduler<TaskType>::Schedule(
+    std::unique_ptr<TaskType>* task) {
+  {
+    mutex_lock l(mu_);
+    DCHECK(!stopped_);
+    if (enqueued_tasks_.size() >= options_.max_enqueued_tasks) {
+      return errors::Unavailable(
+          "The continuous batch scheduler is full; ", enqueued_tasks_.size(),
+          " tasks are waiting for one of its ", options_.max_batch_size,
+          " slots");
+    }
+    enqueued_tasks_.push_back(std::move(*task));
+  }
+  tasks_available_cv_.notify_one();
+  return absl::OkStatus();
+}
+
+template <typename TaskType>
+size_t ContinuousBatchScheduler<TaskType>::NumEnqueuedTasks() const {
+  mutex_lock l(mu_);
+  return enqueued_tasks_.size();
+}
+
+template <typename TaskType>
+size_t ContinuousBatchScheduler<TaskType>::NumRunningTasks() const {
+  mutex_lock l(mu_);
+  return num_running_tasks_;
+}
+
+template <typename TaskType>
+void ContinuousBatchScheduler<TaskType>::ThreadLogic() {
+  std::vector<bool> joined(slots_.size());
+  while (AdmitTasks(&joined)) {
+    RunStep(joined);
+  }
+}
+
+template <typename TaskType>
+bool ContinuousBatchScheduler<TaskType>::AdmitTasks(
+    std::vector<bool>* joined) {
+  mutex_lock l(mu_);
+  while (num_running_tasks_ == 0 && enqueued_tasks_.empty()) {
+    if (stopped_) return false;
+    tasks_available_cv_.wait(l);
+  }
+  for (int slot = 0; slot < options_.max_batch_size; ++slot) {
+    (*joined)[slot] = slots_[slot] == nullptr && !enqueued_tasks_.empty();
+    if ((*joined)[slot]) {
+      slots_[slot] = std::move(enqueued_tasks_.front());
+      enqueued_tasks_.pop_front();
+      ++num_running_tasks_;
+    }
+  }
+  return true;
+}
+
+template <typename TaskType>
+void ContinuousBatchScheduler<TaskType>::RunStep(
+    const std::vector<bool>& joined) {
+  Step step;
+  for (int slot = 0; slot < options_.max_batch_size; ++slot) {
+    if (slots_[slot] == nullptr) continue;
+    step.slots.push_back(slot);
+    step.tasks.push_back(slots_[slot].get());
+    step.joined.push_back(joined[slot]);
+  }
+  step.done.assign(step.tasks.size(), false);
+
+  Status status;
+  {
+    profiler::TraceMe trace_me([&step] {
+      return profiler::TraceMeEncode("ContinuousBatchStep",
+                                     {{"batch_size", step.tasks.size()}});
+    });
+    status = step_callback_(&step);
+  }
+
+  std::vector<std::unique_ptr<TaskType>> done_tasks;
+  for (int i = 0; i < step.slots.size(); ++i) {
+    if (status.ok() && !step.done[i]) continue;
+    done_tasks.push_back(std::move(slots_[step.slots[i]]));
+  }
+  if (!done_tasks.empty()) {
+    mutex_lock l(mu_);
+    num_running_tasks_ -= done_tasks.size();
+  }
+  for (std::unique_ptr<TaskType>& task : done_tasks) {
+    done_callback_(std::move(task), status);
+  }
+}
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
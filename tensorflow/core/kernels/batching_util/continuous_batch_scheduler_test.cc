@@ -0,0 +1,179 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/continuous_batch_scheduler.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// A task which is done after `num_steps` steps.
+struct FakeTask {
+  FakeTask(std::string name, int num_steps)
+      : name(std::move(name)), num_steps(num_steps) {}
+
+  const std::string name;
+  const int num_steps;
+  int steps_run = 0;
+};
+
+using Scheduler = ContinuousBatchScheduler<FakeTask>;
+
+Status ScheduleTask(const std::string& name, int num_steps,
+                    Scheduler* scheduler) {
+  auto task = std::make_unique<FakeTask>(name, num_steps);
+  Status status = scheduler->Schedule(&task);
+  CHECK_EQ(status.ok(), task == nullptr);
+  return status;
+}
+
+// Runs a step of every task, recording the slots and names of the tasks of
+// each step, with a "+" for those which joined at the step.
+Status RunStep(std::vector<std::string>* steps, Scheduler::Step* step) {
+  std::string tasks;
+  for (int i = 0; i < step->tasks.size(); ++i) {
+    FakeTask* task = step->tasks[i];
+    EXPECT_EQ(step->joined[i], task->steps_run == 0);
+    absl::StrAppend(&tasks, tasks.empty() ? "" : " ", step->slots[i], ":",
+                    task->name, step->joined[i] ? "+" : "");
+    step->done[i] = ++task->steps_run == task->num_steps;
+  }
+  steps->push_back(tasks);
+  return absl::OkStatus();
+}
+
+TEST(ContinuousBatchSchedulerTest, TasksJoinAndLeaveBetweenSteps) {
+  mutex mu;
+  std::vector<std::string> steps;
+  std::vector<std::string> done_tasks;
+  Notification first_step_started, all_tasks_scheduled;
+  {
+    Scheduler::Options options;
+    options.max_batch_size = 2;
+    std::unique_ptr<Scheduler> scheduler;
+    TF_ASSERT_OK(Scheduler::Create(
+        options,
+        [&](Scheduler::Step* step) {
+          if (!first_step_started.HasBeenNotified()) {
+            first_step_started.Notify();
+            all_tasks_scheduled.WaitForNotification();
+          }
+          mutex_lock l(mu);
+          return RunStep(&steps, step);
+        },
+        [&](std::unique_ptr<FakeTask> task, const Status& status) {
+          TF_EXPECT_OK(status);
+          EXPECT_EQ(task->steps_run, task->num_steps);
+          mutex_lock l(mu);
+          done_tasks.push_back(task->name);
+        },
+        &scheduler));
+
+    TF_ASSERT_OK(ScheduleTask("a", 3, scheduler.get()));
+    first_step_started.WaitForNotification();
+    TF_ASSERT_OK(ScheduleTask("b", 1, scheduler.get()));
+    TF_ASSERT_OK(ScheduleTask("c", 2, scheduler.get()));
+    EXPECT_EQ(scheduler->NumEnqueuedTasks(), 2);
+    EXPECT_EQ(scheduler->NumRunningTasks(), 1);
+    all_tasks_scheduled.Notify();
+  }
+
+  // "c" takes the slot of "b" as soon as "b" is done, and "a" keeps its slot
+  // until it is done.
+  EXPECT_EQ(steps, std::vector<std::string>(
+                       {"0:a+", "0:a 1:b+", "0:a 1:c+", "1:c"}));
+  EXPECT_EQ(done_tasks, std::vector<std::string>({"b", "a", "c"}));
+}
+
+TEST(ContinuousBatchSchedulerTest, FailedStepFinishesItsTasks) {
+  mutex mu;
+  std::vector<Status> statuses;
+  {
+    std::unique_ptr<Scheduler> scheduler;
+    TF_ASSERT_OK(Scheduler::Create(
+        Scheduler::Options(),
+        [](Scheduler::Step* step) {
+          return errors::Internal("step failed");
+        },
+        [&](std::unique_ptr<FakeTask> task, const Status& status) {
+          mutex_lock l(mu);
+          statuses.push_back(status);
+        },
+        &scheduler));
+    TF_ASSERT_OK(ScheduleTask("a", 3, scheduler.get()));
+  }
+  ASSERT_EQ(statuses.size(), 1);
+  EXPECT_EQ(statuses[0].code(), error::INTERNAL);
+}
+
+TEST(ContinuousBatchSchedulerTest, FullQueue) {
+  Notification step_started, release_step;
+  {
+    Scheduler::Options options;
+    options.max_batch_size = 1;
+    options.max_enqueued_tasks = 1;
+    std::unique_ptr<Scheduler> scheduler;
+    TF_ASSERT_OK(Scheduler::Create(
+        options,
+        [&](Scheduler::Step* step) {
+          if (!step_started.HasBeenNotified()) {
+            step_started.Notify();
+            release_step.WaitForNotification();
+          }
+          step->done.assign(step->done.size(), true);
+          return absl::OkStatus();
+        },
+        [](std::unique_ptr<FakeTask> task, const Status& status) {},
+        &scheduler));
+
+    TF_ASSERT_OK(ScheduleTask("a", 1, scheduler.get()));
+    step_started.WaitForNotification();
+    TF_ASSERT_OK(ScheduleTask("b", 1, scheduler.get()));
+    EXPECT_EQ(ScheduleTask("c", 1, scheduler.get()).code(),
+              error::UNAVAILABLE);
+    release_step.Notify();
+  }
+}
+
+TEST(ContinuousBatchSchedulerTest, InvalidOptions) {
+  Scheduler::Options options;
+  options.max_batch_size = 0;
+  std::unique_ptr<Scheduler> scheduler;
+  EXPECT_EQ(Scheduler::Create(
+                options, [](Scheduler::Step* step) { return absl::OkStatus(); },
+                [](std::unique_ptr<FakeTask> task, const Status& status) {},
+                &scheduler)
+                .code(),
+            error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
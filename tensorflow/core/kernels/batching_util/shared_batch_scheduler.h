@@ -18,13 +18,18 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <functional>
+#include <limits>
 #include <list>
+#include <map>
 #include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <type_traits>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -42,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/notification.h"
@@ -179,6 +185,18 @@ class SharedBatchScheduler
     // avoid latency spikes.
     int64_t batch_timeout_micros = 0;
 
+    // If true, the open batch is also scheduled as soon as its most urgent
+    // task can't wait any longer, i.e. when the earliest deadline of its tasks
+    // (see BatchTask::deadline_micros()) minus the predicted time to process a
+    // batch of its size is reached. The processing times are learned online,
+    // per allowed batch size, from the batches processed by the queue.
+    //
+    // Batches then close early when few tasks arrive and fill up when many
+    // do, without tuning `batch_timeout_micros` to the load: it still bounds
+    // the wait of every task, and should be set to the longest acceptable
+    // wait. Low priority tasks are not affected.
+    bool enable_deadline_aware_batching = false;
+
     // The maximum allowable number of enqueued (accepted by Schedule() but
     // not yet being processed on a batch thread) tasks in terms of batches.
     // If this limit is reached, Schedule() will return an UNAVAILABLE error.
@@ -240,6 +258,30 @@ class SharedBatchScheduler
     // If true, the padding will not be appended.
     bool disable_padding = false;
 
+    // If set, called with every high priority task right before it is added
+    // to an open batch, along with the batch and the offset of the task in
+    // it, i.e. the size of the batch before the task. This lets the caller
+    // lay out the inputs of a batch while it is still being filled, e.g. to
+    // copy them into a buffer for the whole batch. Not called with lazy
+    // splitting, whose batches are formed once they are processed.
+    //
+    // Runs with the queue locked, and thus must not block.
+    std::function<void(const Batch<TaskType>& batch, size_t offset,
+                       TaskType* task)>
+        add_task_to_open_batch_callback;
+
+    // If true, high priority tasks which fit into the open batch are added to
+    // it without locking the queue: concurrent Schedule() calls reserve their
+    // slots in the batch with an atomic counter, and only take the lock to
+    // start a batch, i.e. for the first task of a batch and for tasks which
+    // don't fit into it. This reduces the contention of queues to which many
+    // threads submit small tasks.
+    //
+    // Can't be combined with `enable_lazy_split`,
+    // `enable_deadline_aware_batching` or `add_task_to_open_batch_callback`,
+    // which need the queue locked to add a task.
+    bool enable_lock_free_enqueue = false;
+
     // If true, queue implementation would split high priority and low priority
     // inputs into two sub queues.
     bool enable_priority_queue = false;
@@ -257,6 +299,11 @@ class SharedBatchScheduler
       size_t max_enqueued_batches = 0;
       // See QueueOptions.allowed_batch_sizes
       std::vector<int32> allowed_batch_sizes;
+      // With MixedPriorityBatchingPolicy::kPriorityPreemption, low priority
+      // tasks which have waited for this long are scheduled ahead of the high
+      // priority batches. Zero means no bound, i.e. low priority tasks wait
+      // for as long as high priority ones keep arriving.
+      int64_t max_starvation_micros = 0;
     };
     // A subset of queue options for high priority input. These options are
     // currently not being used in favor of the equivalents options at the
@@ -349,6 +396,14 @@ namespace internal {
 template <typename TaskType>
 class Queue {
  public:
+  static constexpr uint64 kNoDeadline = std::numeric_limits<uint64>::max();
+  // The weight of the latest processing time of a batch in the moving
+  // average which predicts the processing time of the next ones.
+  static constexpr double kProcessingTimeDecay = 0.2;
+  // The reserved size of the open batch while it doesn't accept lock-free
+  // enqueues. Reservations from half of it on fail.
+  static constexpr int64_t kSealedReservation = int64_t{1} << 62;
+
   using ProcessBatchCallbackWithoutPaddingTasks =
       std::function<void(std::unique_ptr<Batch<TaskType>>)>;
   using ProcessBatchCallbackWithPaddingTasks =
@@ -457,6 +512,18 @@ class Queue {
   Status ScheduleWithoutOrEagerSplitImpl(std::unique_ptr<TaskType>* task)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Adds `task` to the open batch without locking the queue, if
+  // `enable_lock_free_enqueue` is true and the task fits into the batch.
+  // Otherwise returns false and leaves `task` to be scheduled with the lock.
+  bool TryScheduleWithoutLock(std::unique_ptr<TaskType>* task);
+
+  // Stops lock-free enqueues into the open batch, and waits until the ones in
+  // flight have added their tasks to it.
+  void SealOpenBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Lets lock-free enqueues add tasks to the open batch, if it has any.
+  void UnsealOpenBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Closes the open batch residing at the back of std::deque, and inserts a
   // fresh open batch behind it.
   void StartNewBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -471,6 +538,25 @@ class Queue {
   // 'high_priority_batches_' is currently schedulable.
   bool IsOpenBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns the deadline of `task`, or kNoDeadline if it has none.
+  static uint64 GetTaskDeadlineMicros(const TaskType& task);
+
+  // Returns the predicted time to process a batch of `batch_size`, from the
+  // processing times of the batches of the same or the next larger measured
+  // size, or extrapolated from the largest measured one.
+  double PredictedProcessingTimeMicros(size_t batch_size) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns true iff `enable_deadline_aware_batching` is set and the most
+  // urgent task of the open batch, of `batch_size`, can't wait any longer.
+  bool IsOpenBatchDeadlineDue(size_t batch_size) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Folds the `processing_time_micros` of a batch of `batch_size` into the
+  // moving average of its allowed batch size.
+  void RecordProcessingTime(size_t batch_size, uint64 processing_time_micros)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // A variant of `IsOpenBatchSchedulable`; used when batches are formed at
   // task enqueue time, and open batch is `high_priority_batches_.back()`.
   bool IsOpenBatchSchedulableAfterEagerSplit() const
@@ -482,6 +568,10 @@ class Queue {
   std::unique_ptr<Batch<TaskType>> ScheduleLowPriorityBatch()
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns true iff the policy is kPriorityPreemption and the oldest low
+  // priority task has waited for longer than `max_starvation_micros`.
+  bool IsLowPriorityTaskQueueStarving() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Same as SchedulingCapacity(), but assumes the caller already holds a
   // lock on 'mu_'.
   size_t SchedulingCapacityInternal() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -582,6 +672,19 @@ class Queue {
   std::deque<std::unique_ptr<Batch<TaskType>>> high_priority_batches_
       TF_GUARDED_BY(mu_);
 
+  // The open batch of 'high_priority_batches_' as seen by lock-free
+  // enqueues, and the total size of the tasks added or being added to it, or
+  // at least half of kSealedReservation while it is sealed. Changed with the
+  // lock held, and only once no lock-free enqueue is in flight.
+  //
+  // Used iff `QueueOptions.enable_lock_free_enqueue` is true.
+  std::atomic<Batch<TaskType>*> lock_free_open_batch_{nullptr};
+  std::atomic<int64_t> open_batch_reserved_size_{kSealedReservation};
+
+  // The number of lock-free enqueues in flight. Incremented before reserving
+  // a slot in the open batch, and decremented once the task is added to it.
+  std::atomic<int> num_lock_free_enqueues_{0};
+
   // The counter of the TraceMe context ids.
   uint64 traceme_context_id_counter_ TF_GUARDED_BY(mu_) = 0;
 
@@ -590,6 +693,14 @@ class Queue {
   // task.
   uint64 open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
 
+  // The earliest deadline of the tasks in the open batch, or kNoDeadline.
+  // Valid iff that batch contains at least one task.
+  uint64 open_batch_deadline_micros_ TF_GUARDED_BY(mu_) = kNoDeadline;
+
+  // The moving averages of the time to process a batch, keyed by allowed
+  // batch size. Used iff `enable_deadline_aware_batching` is true.
+  std::map<size_t, double> processing_time_micros_ TF_GUARDED_BY(mu_);
+
   // Whether this queue contains a batch that is eligible to be scheduled.
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
@@ -598,6 +709,13 @@ class Queue {
   // Incremented in ScheduleBatch() and decremented in ProcessBatch().
   int num_batches_being_processed_ TF_GUARDED_BY(mu_) = 0;
 
+  // The low priority only batch being processed, if any. With
+  // kPriorityPreemption, low priority tasks are batched one batch at a time,
+  // so that they can't take up batch threads which high priority tasks
+  // arriving in the meantime need.
+  const Batch<TaskType>* low_priority_batch_being_processed_
+      TF_GUARDED_BY(mu_) = nullptr;
+
   // Used by CloseAndWaitUntilEmpty() to wait until the queue is empty, for
   // the case in which the queue is not empty when CloseAndWaitUntilEmpty()
   // starts. When ProcessBatch() dequeues the last batch and makes the queue
@@ -732,6 +850,14 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         options.max_execution_batch_size);
   }
 
+  if (options.enable_lock_free_enqueue &&
+      (options.enable_lazy_split || options.enable_deadline_aware_batching ||
+       options.add_task_to_open_batch_callback)) {
+    return errors::InvalidArgument(
+        "enable_lock_free_enqueue can't be combined with enable_lazy_split, "
+        "enable_deadline_aware_batching or add_task_to_open_batch_callback.");
+  }
+
   auto schedulable_batch_callback = [this] {
     mutex_lock l(mu_);
     schedulable_batch_cv_.notify_one();
@@ -906,6 +1032,7 @@ Queue<TaskType>::~Queue() {
   if (options_.enable_lazy_split) {
     task_handle_batches_.back()->Close();
   } else {
+    SealOpenBatch();
     GetBatches().back()->Close();
   }
 }
@@ -938,6 +1065,7 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
 
     const int64 open_batch_capacity =
         max_execution_batch_size - this->tail_batch_task_size();
+    const uint64 deadline_micros = GetTaskDeadlineMicros(**task);
 
     auto input_batch = std::make_shared<BatchInputTask<TaskType>>(
         std::move(*task), open_batch_capacity, max_execution_batch_size,
@@ -953,7 +1081,10 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
       }
       if (task_handle_batches_.back()->empty()) {
         open_batch_start_time_micros_ = env_->NowMicros();
+        open_batch_deadline_micros_ = kNoDeadline;
       }
+      open_batch_deadline_micros_ =
+          std::min(open_batch_deadline_micros_, deadline_micros);
       tsl::profiler::TraceMeProducer trace_me(
           [&task_handles, i] {
             return profiler::TraceMeEncode("ScheduleOutputTask",
@@ -1016,6 +1147,8 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplitImpl(
       max_execution_batch_size() - batches.back()->size();
 
   const int64_t input_task_size = (*task)->size();
+  // Split tasks are due when the input task is.
+  const uint64 deadline_micros = GetTaskDeadlineMicros(**task);
 
   std::vector<std::unique_ptr<TaskType>> output_tasks;
 
@@ -1034,7 +1167,10 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplitImpl(
     }
     if (batches.back()->empty()) {
       open_batch_start_time_micros_ = env_->NowMicros();
+      open_batch_deadline_micros_ = kNoDeadline;
     }
+    open_batch_deadline_micros_ =
+        std::min(open_batch_deadline_micros_, deadline_micros);
     tsl::profiler::TraceMeProducer trace_me(
         [&output_tasks, i] {
           return profiler::TraceMeEncode("ScheduleOutputTask",
@@ -1042,6 +1178,10 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplitImpl(
         },
         tsl::profiler::ContextType::kSharedBatchScheduler,
         batches.back()->traceme_context_id());
+    if (options_.add_task_to_open_batch_callback) {
+      options_.add_task_to_open_batch_callback(
+          *batches.back(), batches.back()->size(), output_tasks[i].get());
+    }
     batches.back()->AddTask(std::move(output_tasks[i]));
   }
 
@@ -1062,6 +1202,10 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
         {{"batching_input_task_size", (*task)->size()}});
   });
 
+  if (TryScheduleWithoutLock(task)) {
+    return absl::OkStatus();
+  }
+
   bool notify_of_schedulable_batch = false;
   {
     mutex_lock l(mu_);
@@ -1074,7 +1218,10 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
       TF_RETURN_IF_ERROR(ValidateLowPriorityTaskQueueCapacity(**task));
       low_priority_tasks_.AddTask(std::move(*task), env_->NowMicros());
     } else {
-      TF_RETURN_IF_ERROR(ScheduleWithoutOrEagerSplitImpl(task));
+      SealOpenBatch();
+      const Status status = ScheduleWithoutOrEagerSplitImpl(task);
+      UnsealOpenBatch();
+      TF_RETURN_IF_ERROR(status);
     }
 
     // Check if the batch queue has a schedulable batch and mark it schedulable
@@ -1094,6 +1241,81 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
   return absl::OkStatus();
 }
 
+template <typename TaskType>
+bool Queue<TaskType>::TryScheduleWithoutLock(std::unique_ptr<TaskType>* task) {
+  if (!options_.enable_lock_free_enqueue || IsLowPriorityTask(task)) {
+    return false;
+  }
+  const int64_t task_size = (*task)->size();
+  const int64_t batch_size_limit = max_execution_batch_size();
+
+  // The enqueue is counted before it reserves its slot, so that sealing the
+  // open batch, which fails all later reservations, waits for it.
+  num_lock_free_enqueues_.fetch_add(1);
+  const int64_t offset = open_batch_reserved_size_.fetch_add(task_size);
+  if (offset >= kSealedReservation / 2 ||
+      offset + task_size > batch_size_limit) {
+    open_batch_reserved_size_.fetch_sub(task_size);
+    num_lock_free_enqueues_.fetch_sub(1);
+    return false;
+  }
+  Batch<TaskType>* open_batch = lock_free_open_batch_.load();
+  {
+    tsl::profiler::TraceMeProducer trace_me(
+        [task_size] {
+          return profiler::TraceMeEncode("ScheduleOutputTask",
+                                         {{"size", task_size}});
+        },
+        tsl::profiler::ContextType::kSharedBatchScheduler,
+        open_batch->traceme_context_id());
+    open_batch->AddTask(std::move(*task));
+  }
+  num_lock_free_enqueues_.fetch_sub(1);
+
+  if (offset + task_size < batch_size_limit) {
+    // Batches which aren't full are scheduled once they time out, which the
+    // batch threads poll for.
+    return true;
+  }
+  bool notify_of_schedulable_batch = false;
+  {
+    mutex_lock l(mu_);
+    if (!schedulable_batch_) {
+      if (GetBatches().size() > 1 || IsOpenBatchSchedulable()) {
+        schedulable_batch_ = true;
+        notify_of_schedulable_batch = true;
+      }
+    }
+  }
+  if (notify_of_schedulable_batch) {
+    schedulable_batch_callback_();
+  }
+  return true;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::SealOpenBatch() {
+  if (!options_.enable_lock_free_enqueue) return;
+  open_batch_reserved_size_.store(kSealedReservation);
+  // The enqueues which reserved their slots before only have to add their
+  // tasks to the batch.
+  while (num_lock_free_enqueues_.load() > 0) {
+    std::this_thread::yield();
+  }
+  lock_free_open_batch_.store(nullptr);
+}
+
+template <typename TaskType>
+void Queue<TaskType>::UnsealOpenBatch() {
+  if (!options_.enable_lock_free_enqueue) return;
+  Batch<TaskType>* open_batch = GetBatches().back().get();
+  // The first task of a batch starts its timeout, and is added with the lock.
+  if (open_batch->empty()) return;
+  // A successful reservation sees the batch stored before it.
+  lock_free_open_batch_.store(open_batch);
+  open_batch_reserved_size_.store(open_batch->size());
+}
+
 template <typename TaskType>
 size_t Queue<TaskType>::NumEnqueuedTasks() const {
   size_t num_enqueued_tasks = 0;
@@ -1220,16 +1442,24 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
   {
     mutex_lock l(mu_);
 
-    std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
-    // Consider closing the open batch at this time, to schedule it.
-    if (batches.size() == 1 && IsOpenBatchSchedulable()) {
-      StartNewBatch();
+    if (IsLowPriorityTaskQueueStarving()) {
+      // Low priority tasks which have waited for too long are scheduled
+      // ahead of the high priority batches.
+      batch_to_schedule = ScheduleLowPriorityBatch();
     }
 
-    if (batches.size() >= 2) {
-      // There is at least one closed batch that is ready to be scheduled.
-      batch_to_schedule = std::move(batches.front());
-      batches.pop_front();
+    std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
+    if (batch_to_schedule == nullptr) {
+      // Consider closing the open batch at this time, to schedule it.
+      if (batches.size() == 1 && IsOpenBatchSchedulable()) {
+        StartNewBatch();
+      }
+
+      if (batches.size() >= 2) {
+        // There is at least one closed batch that is ready to be scheduled.
+        batch_to_schedule = std::move(batches.front());
+        batches.pop_front();
+      }
     }
 
     if (batch_to_schedule == nullptr) {
@@ -1329,12 +1559,19 @@ void Queue<TaskType>::ProcessBatch(
   tsl::profiler::TraceMeConsumer trace_me(
       [&] {
         return profiler::TraceMeEncode(
-            "ProcessBatch", {{"batch_size_before_padding", batch->size()},
-                             {"_r", 2} /*root_event*/});
+            "ProcessBatch",
+            {{"batch_size_before_padding", batch->size()},
+             {"batch_queue_wait_us",
+              EnvTime::NowMicros() - batch->close_time_micros()},
+             {"_r", 2} /*root_event*/});
       },
       tsl::profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
 
+  const Batch<TaskType>* const processed_batch = batch.get();
+  size_t batch_size = batch->size();
+  for (const auto& task : padding_task) batch_size += task->size();
+  const uint64 start_time_micros = env_->NowMicros();
   if (std::holds_alternative<ProcessBatchCallbackWithoutPaddingTasks>(
           process_batch_callback_)) {
     std::get<ProcessBatchCallbackWithoutPaddingTasks>(process_batch_callback_)(
@@ -1343,10 +1580,17 @@ void Queue<TaskType>::ProcessBatch(
     std::get<ProcessBatchCallbackWithPaddingTasks>(process_batch_callback_)(
         std::move(batch), std::move(padding_task));
   }
+  const uint64 processing_time_micros = env_->NowMicros() - start_time_micros;
 
   {
     mutex_lock l(mu_);
+    if (options_.enable_deadline_aware_batching) {
+      RecordProcessingTime(batch_size, processing_time_micros);
+    }
     --num_batches_being_processed_;
+    if (low_priority_batch_being_processed_ == processed_batch) {
+      low_priority_batch_being_processed_ = nullptr;
+    }
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
     }
@@ -1396,6 +1640,7 @@ void Queue<TaskType>::StartNewBatch() {
     return;
   }
   std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
+  SealOpenBatch();
   batches.back()->Close();
   batches.emplace_back(new Batch<TaskType>(++traceme_context_id_counter_));
 }
@@ -1419,7 +1664,8 @@ bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
   }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + options_.batch_timeout_micros ||
+         IsOpenBatchDeadlineDue(open_batch->size());
 }
 
 template <typename TaskType>
@@ -1434,7 +1680,51 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + options_.batch_timeout_micros ||
+         IsOpenBatchDeadlineDue(open_batch->size());
+}
+
+template <typename TaskType>
+uint64 Queue<TaskType>::GetTaskDeadlineMicros(const TaskType& task) {
+  // Deadlines are defined only when the task is a derived class of BatchTask.
+  if constexpr (std::is_base_of_v<BatchTask, TaskType>) {
+    return task.deadline_micros().value_or(kNoDeadline);
+  }
+  return kNoDeadline;
+}
+
+template <typename TaskType>
+double Queue<TaskType>::PredictedProcessingTimeMicros(
+    size_t batch_size) const {
+  if (processing_time_micros_.empty()) return 0;
+  const size_t allowed_batch_size = GetNextAllowedBatchSize(
+      batch_size, options_.allowed_batch_sizes, options_.disable_padding);
+  auto it = processing_time_micros_.lower_bound(allowed_batch_size);
+  if (it != processing_time_micros_.end()) return it->second;
+  --it;
+  return it->second * allowed_batch_size / it->first;
+}
+
+template <typename TaskType>
+bool Queue<TaskType>::IsOpenBatchDeadlineDue(size_t batch_size) const {
+  if (!options_.enable_deadline_aware_batching ||
+      open_batch_deadline_micros_ == kNoDeadline) {
+    return false;
+  }
+  return env_->NowMicros() + PredictedProcessingTimeMicros(batch_size) >=
+         open_batch_deadline_micros_;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::RecordProcessingTime(size_t batch_size,
+                                           uint64 processing_time_micros) {
+  const size_t allowed_batch_size = GetNextAllowedBatchSize(
+      batch_size, options_.allowed_batch_sizes, options_.disable_padding);
+  auto [it, inserted] = processing_time_micros_.emplace(
+      allowed_batch_size, processing_time_micros);
+  if (!inserted) {
+    it->second += kProcessingTimeDecay * (processing_time_micros - it->second);
+  }
 }
 
 template <typename TaskType>
@@ -1445,7 +1735,15 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleLowPriorityBatch() {
     // task.
     return batch_to_schedule;
   }
-  if (env_->NowMicros() <
+  const bool preemption = options_.mixed_priority_batching_policy ==
+                          MixedPriorityBatchingPolicy::kPriorityPreemption;
+  if (preemption && low_priority_batch_being_processed_ != nullptr) {
+    // Return early if a low priority batch is already being processed.
+    return batch_to_schedule;
+  }
+  const bool starving = IsLowPriorityTaskQueueStarving();
+  if (!starving &&
+      env_->NowMicros() <
           *low_priority_tasks_.EarliestTaskStartTime() +
               options_.low_priority_queue_options.batch_timeout_micros &&
       low_priority_tasks_.size() <
@@ -1454,7 +1752,7 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleLowPriorityBatch() {
     // and the earliest task didn't time out.
     return batch_to_schedule;
   }
-  if (!GetBatches().empty() && !GetBatches().front()->empty()) {
+  if (!starving && !GetBatches().empty() && !GetBatches().front()->empty()) {
     // Return early if there is a non-empty high priority batch in the queue.
     return batch_to_schedule;
   }
@@ -1465,10 +1763,26 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleLowPriorityBatch() {
     batch_to_schedule->AddTask(std::move(task));
   }
   batch_to_schedule->Close();
+  if (preemption) {
+    low_priority_batch_being_processed_ = batch_to_schedule.get();
+  }
 
   return batch_to_schedule;
 }
 
+template <typename TaskType>
+bool Queue<TaskType>::IsLowPriorityTaskQueueStarving() const {
+  const int64_t max_starvation_micros =
+      options_.low_priority_queue_options.max_starvation_micros;
+  if (options_.mixed_priority_batching_policy !=
+          MixedPriorityBatchingPolicy::kPriorityPreemption ||
+      max_starvation_micros <= 0 || low_priority_tasks_.empty()) {
+    return false;
+  }
+  return env_->NowMicros() >=
+         *low_priority_tasks_.EarliestTaskStartTime() + max_starvation_micros;
+}
+
 template <typename TaskType>
 size_t Queue<TaskType>::tail_batch_task_size() const {
   if (options_.enable_lazy_split) {
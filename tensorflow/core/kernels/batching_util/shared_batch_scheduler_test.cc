@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <memory>
+#include <optional>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <tuple>
@@ -51,8 +52,11 @@ using ::testing::HasSubstr;
 class FakeTask : public BatchTask {
  public:
   explicit FakeTask(size_t size, tsl::criticality::Criticality criticality =
-                                     tsl::criticality::Criticality::kCritical)
-      : size_(size), criticality_(criticality) {}
+                                     tsl::criticality::Criticality::kCritical,
+                    std::optional<uint64> deadline_micros = std::nullopt)
+      : size_(size),
+        criticality_(criticality),
+        deadline_micros_(deadline_micros) {}
 
   ~FakeTask() override = default;
 
@@ -62,9 +66,14 @@ class FakeTask : public BatchTask {
     return criticality_;
   }
 
+  std::optional<uint64> deadline_micros() const override {
+    return deadline_micros_;
+  }
+
  private:
   const size_t size_;
   const tsl::criticality::Criticality criticality_;
+  const std::optional<uint64> deadline_micros_;
 
   FakeTask(const FakeTask&) = delete;
   void operator=(const FakeTask&) = delete;
@@ -108,6 +117,18 @@ Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler,
   return status;
 }
 
+// Creates a FakeTask of size 'task_size' which is due at 'deadline_micros',
+// and calls 'scheduler->Schedule()' on that task. Returns the resulting
+// status.
+Status ScheduleTaskWithDeadline(size_t task_size, uint64 deadline_micros,
+                                BatchScheduler<FakeTask>* scheduler) {
+  std::unique_ptr<FakeTask> task(new FakeTask(
+      task_size, tsl::criticality::Criticality::kCritical, deadline_micros));
+  Status status = scheduler->Schedule(&task);
+  CHECK_EQ(status.ok(), task == nullptr);
+  return status;
+}
+
 // Helper function similar to the function above. Creates a FakeTask of size
 // 'task_size' and calls 'scheduler->Schedule()' on that task. Returns the
 // resulting status.
@@ -657,6 +678,73 @@ TEST_P(SharedBatchSchedulerTest, ObeysTimeout) {
   stop_teardown.Notify();
 }
 
+TEST_P(SharedBatchSchedulerTest, ObeysDeadlines) {
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification first_batch_processed, second_batch_processed;
+    bool notify_first_batch = false, notify_second_batch = false;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      if (notify_first_batch && (!first_batch_processed.HasBeenNotified())) {
+        // Processing the first batch takes 30 microseconds.
+        env.AdvanceByMicroseconds(30);
+        first_batch_processed.Notify();
+        return;
+      }
+      if (notify_second_batch && (!second_batch_processed.HasBeenNotified())) {
+        second_batch_processed.Notify();
+        return;
+      }
+
+      EXPECT_TRUE(false) << "Unexpected condition";
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+
+    const size_t input_batch_size_limit = 4;
+    const size_t batch_timeout_micros = 1000 * 1000;
+    const size_t max_enqueued_batches = 2;
+    QueueOptions options =
+        CreateQueueOptions(input_batch_size_limit, input_batch_size_limit,
+                           batch_timeout_micros, max_enqueued_batches);
+    options.enable_deadline_aware_batching = true;
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    // Without a processing time to predict from, an underfull batch is
+    // processed when the deadline of its task is reached, well before the
+    // timeout.
+    TF_ASSERT_OK(
+        ScheduleTaskWithDeadline(1, env.NowMicros() + 100, queue.get()));
+    env.AdvanceByMicroseconds(99);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(first_batch_processed.HasBeenNotified());
+    notify_first_batch = true;
+    env.AdvanceByMicroseconds(1);
+    first_batch_processed.WaitForNotification();
+    // Let the queue record the processing time of the first batch.
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+
+    // The next batch of the same size is processed early enough to finish by
+    // the deadline of its task.
+    TF_ASSERT_OK(
+        ScheduleTaskWithDeadline(1, env.NowMicros() + 100, queue.get()));
+    env.AdvanceByMicroseconds(69);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(second_batch_processed.HasBeenNotified());
+    notify_second_batch = true;
+    env.AdvanceByMicroseconds(1);
+    second_batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 TEST_P(SharedBatchSchedulerTest, ObeysTimeoutWithRealClock) {
   Notification first_batch_processed, second_batch_processed;
   auto callback = [&first_batch_processed, &second_batch_processed](
@@ -1052,6 +1140,96 @@ TEST_P(SharedBatchSchedulerTest, ZeroQueueRewrittenToOneQueue) {
   }
 }
 
+TEST_P(SharedBatchSchedulerTest, AddTaskToOpenBatchCallback) {
+  if (enable_lazy_split()) {
+    // Lazily split tasks are batched when the batch is processed.
+    return;
+  }
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {
+    // do nothing.
+  };
+
+  std::vector<size_t> offsets;
+  {
+    auto scheduler = CreateSharedBatchScheduler(1);
+    QueueOptions queue_options = CreateQueueOptions(
+        /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+        /*batch_timeout_micros=*/1000 * 1000, /*max_enqueued_batches=*/2);
+    queue_options.add_task_to_open_batch_callback =
+        [&offsets](const Batch<FakeTask>& batch, size_t offset,
+                   FakeTask* task) {
+          EXPECT_FALSE(batch.IsClosed());
+          EXPECT_EQ(batch.size(), offset);
+          offsets.push_back(offset);
+        };
+    auto queue = CreateQueue(scheduler, queue_options, callback);
+    TF_ASSERT_OK(ScheduleTask(3, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(5, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(4, queue.get()));
+  }
+
+  if (enable_input_batch_split()) {
+    // The last task is split to fill up the first batch.
+    EXPECT_EQ(offsets, std::vector<size_t>({0, 3, 8, 0}));
+  } else {
+    EXPECT_EQ(offsets, std::vector<size_t>({0, 3, 0}));
+  }
+}
+
+TEST_P(SharedBatchSchedulerTest, LockFreeEnqueue) {
+  auto scheduler = CreateSharedBatchScheduler(2);
+  mutex mu;
+  size_t num_tasks_processed = 0;
+  size_t size_processed = 0;
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    EXPECT_LE(batch->size(), 10);
+    mutex_lock l(mu);
+    num_tasks_processed += batch->num_tasks();
+    size_processed += batch->size();
+  };
+  QueueOptions queue_options = CreateQueueOptions(
+      /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+      /*batch_timeout_micros=*/1000, /*max_enqueued_batches=*/100000);
+  queue_options.enable_lock_free_enqueue = true;
+  if (enable_lazy_split()) {
+    std::unique_ptr<Queue> queue;
+    EXPECT_THAT(scheduler->AddQueue(queue_options, callback, &queue),
+                testing::StatusIs(error::INVALID_ARGUMENT,
+                                  HasSubstr("enable_lock_free_enqueue")));
+    return;
+  }
+
+  constexpr int kNumThreads = 8;
+  constexpr int kNumTasksPerThread = 500;
+  {
+    auto queue = CreateQueue(scheduler, queue_options, callback);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+      threads.emplace_back([&queue, i] {
+        for (int j = 0; j < kNumTasksPerThread; ++j) {
+          TF_ASSERT_OK(ScheduleTask(1 + (i + j) % 3, queue.get()));
+        }
+      });
+    }
+    for (std::thread& thread : threads) thread.join();
+  }
+
+  // The queue destructor waits until all tasks are processed. Tasks which
+  // don't fit into the open batch are split if splitting is enabled.
+  size_t expected_size = 0;
+  for (int i = 0; i < kNumThreads; ++i) {
+    for (int j = 0; j < kNumTasksPerThread; ++j) {
+      expected_size += 1 + (i + j) % 3;
+    }
+  }
+  mutex_lock l(mu);
+  EXPECT_EQ(size_processed, expected_size);
+  if (!enable_input_batch_split()) {
+    EXPECT_EQ(num_tasks_processed, kNumThreads * kNumTasksPerThread);
+  }
+}
+
 // TODO(b/161857471):
 // Add test coverage when input-split and no-split returns differently.
 INSTANTIATE_TEST_SUITE_P(
@@ -1602,6 +1780,130 @@ TEST_P(SharedBatchSchedulerPriorityPolicyTest,
   EXPECT_EQ(queue_callback_counter, 2);
 }
 
+TEST_P(SharedBatchSchedulerPriorityPolicyTest,
+       PriorityPreemptionSchedulesOneLowPriorityBatchAtATime) {
+  mutex mu;
+  int queue_callback_counter = 0;
+  Notification first_batch_started, release_first_batch;
+  auto queue_callback = [&](std::unique_ptr<Batch<FakeTask>> batch,
+                            std::vector<std::unique_ptr<FakeTask>> tasks) {
+    ASSERT_TRUE(batch->IsClosed());
+    EXPECT_EQ(10, batch->size());
+    EXPECT_TRUE(tasks.empty());
+    int counter;
+    {
+      mutex_lock l(mu);
+      counter = queue_callback_counter++;
+    }
+    if (counter == 0) {
+      first_batch_started.Notify();
+      release_first_batch.WaitForNotification();
+    }
+  };
+
+  {
+    std::shared_ptr<Scheduler> scheduler =
+        CreateSharedBatchScheduler(/*num_batch_threads=*/3);
+
+    QueueOptions queue_options = CreateQueueOptions(
+        /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+        /*batch_timeout_micros=*/1 * 1000 * 1000, /*max_enqueued_batches=*/2,
+        /*enable_priority_queue=*/true);
+    queue_options.low_priority_queue_options.max_execution_batch_size = 10;
+    queue_options.low_priority_queue_options.batch_timeout_micros =
+        1 * 1000 * 1000;
+    queue_options.low_priority_queue_options.input_batch_size_limit = 10;
+    queue_options.low_priority_queue_options.max_enqueued_batches = 2;
+    queue_options.mixed_priority_batching_policy =
+        MixedPriorityBatchingPolicy::kPriorityPreemption;
+    std::unique_ptr<Queue> queue =
+        CreateQueue(scheduler, queue_options, queue_callback);
+
+    // Enough low priority tasks for two full batches, of which only one is
+    // processed at a time although there are idle batch threads.
+    for (int i = 0; i < 4; ++i) {
+      TF_ASSERT_OK(ScheduleTask(5, queue.get(),
+                                tsl::criticality::Criticality::kSheddable));
+    }
+    first_batch_started.WaitForNotification();
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ(queue_callback_counter, 1);
+    }
+    release_first_batch.Notify();
+  }
+  EXPECT_EQ(queue_callback_counter, 2);
+}
+
+TEST_P(SharedBatchSchedulerPriorityPolicyTest,
+       PriorityPreemptionBoundsLowPriorityStarvation) {
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    mutex mu;
+    std::vector<size_t> batch_sizes;
+    Notification low_priority_batch_processed;
+    auto queue_callback = [&](std::unique_ptr<Batch<FakeTask>> batch,
+                              std::vector<std::unique_ptr<FakeTask>> tasks) {
+      ASSERT_TRUE(batch->IsClosed());
+      EXPECT_TRUE(tasks.empty());
+      {
+        mutex_lock l(mu);
+        batch_sizes.push_back(batch->size());
+      }
+      if (batch->size() == 6) low_priority_batch_processed.Notify();
+    };
+
+    std::shared_ptr<Scheduler> scheduler =
+        CreateSharedBatchScheduler(/*num_batch_threads=*/2, &env);
+
+    QueueOptions queue_options = CreateQueueOptions(
+        /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+        /*batch_timeout_micros=*/1 * 1000 * 1000, /*max_enqueued_batches=*/2,
+        /*enable_priority_queue=*/true);
+    queue_options.low_priority_queue_options.max_execution_batch_size = 10;
+    queue_options.low_priority_queue_options.batch_timeout_micros =
+        1 * 1000 * 1000;
+    queue_options.low_priority_queue_options.input_batch_size_limit = 10;
+    queue_options.low_priority_queue_options.max_enqueued_batches = 2;
+    queue_options.low_priority_queue_options.max_starvation_micros = 100;
+    queue_options.mixed_priority_batching_policy =
+        MixedPriorityBatchingPolicy::kPriorityPreemption;
+    std::unique_ptr<Queue> queue =
+        CreateQueue(scheduler, queue_options, queue_callback);
+
+    // The open high priority batch holds back the low priority tasks until
+    // they have waited for `max_starvation_micros`, even though neither the
+    // high nor the low priority tasks have timed out.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(),
+                              tsl::criticality::Criticality::kCriticalPlus));
+    TF_ASSERT_OK(ScheduleTask(3, queue.get(),
+                              tsl::criticality::Criticality::kSheddable));
+    TF_ASSERT_OK(ScheduleTask(3, queue.get(),
+                              tsl::criticality::Criticality::kSheddable));
+    env.AdvanceByMicroseconds(99);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    {
+      mutex_lock l(mu);
+      EXPECT_TRUE(batch_sizes.empty());
+    }
+    env.AdvanceByMicroseconds(1);
+    low_priority_batch_processed.WaitForNotification();
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ(batch_sizes, std::vector<size_t>({6}));
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 // Lazy split is to be removed. The mixed priority batching is only supported
 // when the lazy split is not enabled.
 INSTANTIATE_TEST_SUITE_P(
@@ -1692,6 +1994,16 @@ void CreateQueues() {
                          split_func_for_size_one_task),
       process_batch_callback));
   queue_labels->push_back(std::string("LazySplit"));
+
+  QueueOptions lock_free_queue_options = CreateQueueOptions(
+      max_execution_batch_size, input_batch_size_limit, batch_timeout_micros,
+      INT_MAX /* unbounded queue */, false /* enable_large_batch_splitting */,
+      false /* enable_lazy_split */, nullptr /* no func */);
+  lock_free_queue_options.enable_lock_free_enqueue = true;
+  queues->push_back(CreateQueue(CreateSharedBatchScheduler(5),
+                                lock_free_queue_options,
+                                process_batch_callback));
+  queue_labels->push_back(std::string("LockFreeNoSplit"));
 }
 
 void BM_QueueSchedule(::testing::benchmark::State& state) {
@@ -1718,7 +2030,7 @@ BENCHMARK(BM_QueueSchedule)->Apply([](benchmark::internal::Benchmark* b) {
   b->ThreadRange(1,
                  port::NumSchedulableCPUs() * tensorflow::port::CPUIDNumSMT());
 
-  for (int queue_index : {0, 1, 2}) {
+  for (int queue_index : {0, 1, 2, 3}) {
     b->ArgPair(10000, queue_index);
   }
 });
@@ -78,5 +78,15 @@ bool ShouldWarmupAllBatchSizes(const OpKernelContext* c) {
   return per_model_data && per_model_data->warmup_all_batch_sizes;
 }
 
+BatchSizeProfiler* GetBatchSizeProfiler(const OpKernelContext* c) {
+  auto metadata = c->session_metadata();
+  if (metadata == nullptr || metadata->name().empty()) {
+    return nullptr;
+  }
+  serving::WarmupStateRegistry::Key key(metadata->name(), metadata->version());
+  auto per_model_data = serving::GetGlobalWarmupStateRegistry().Lookup(key);
+  return per_model_data ? per_model_data->batch_size_profiler.get() : nullptr;
+}
+
 }  // namespace serving
 }  // namespace tensorflow
@@ -26,6 +26,7 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/kernels/batching_util/batch_size_profiler.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tsl/platform/logging.h"
 
@@ -59,6 +60,10 @@ class WarmupStateRegistry {
     // for all `allowed_batch_sizes` of that batch op. This removes the
     // need to issue separate warmup requests for each batch size.
     bool warmup_all_batch_sizes = false;
+    // If set along with `warmup_all_batch_sizes`, the dummy batches have the
+    // batch sizes to profile instead, and their latencies are recorded in
+    // the profiler to derive `allowed_batch_sizes` from.
+    std::shared_ptr<BatchSizeProfiler> batch_size_profiler;
   };
 
   // RAII handle for registered models.
@@ -126,6 +131,10 @@ WarmupStateRegistry& GetGlobalWarmupStateRegistry();
 // based on the state of WarmupStateRegistry.
 bool ShouldWarmupAllBatchSizes(const OpKernelContext* c);
 
+// Returns the batch size profiler of the model which is warmed up, or nullptr
+// if the model isn't profiled.
+BatchSizeProfiler* GetBatchSizeProfiler(const OpKernelContext* c);
+
 }  // namespace serving
 }  // namespace tensorflow
 
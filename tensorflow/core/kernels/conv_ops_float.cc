@@ -16,12 +16,52 @@ limitations under the License.
 // See docs in ../ops/nn_ops.cc.
 
 #include "tensorflow/core/kernels/conv_ops_impl.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Caches whether DeepConv2D is faster than the Eigen implementation, for the
+// shapes of convolution for which both were timed.
+class DeepConv2DAutotuneMap {
+ public:
+  static DeepConv2DAutotuneMap* Global() {
+    static DeepConv2DAutotuneMap* map = new DeepConv2DAutotuneMap;
+    return map;
+  }
+
+  bool Find(const Conv2DArgs& args, bool* use_deep_conv) const {
+    tf_shared_lock lock(mu_);
+    auto it = map_.find(Key(args));
+    if (it == map_.end()) return false;
+    *use_deep_conv = it->second;
+    return true;
+  }
+
+  void Insert(const Conv2DArgs& args, bool use_deep_conv) {
+    mutex_lock lock(mu_);
+    map_[Key(args)] = use_deep_conv;
+  }
+
+ private:
+  static std::array<int, 11> Key(const Conv2DArgs& args) {
+    return {args.batch,       args.in_rows,     args.in_cols,
+            args.in_depth,    args.filter_rows, args.filter_cols,
+            args.pad_rows,    args.pad_cols,    args.out_rows,
+            args.out_cols,    args.out_depth};
+  }
+
+  mutable mutex mu_;
+  std::map<std::array<int, 11>, bool> map_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
 // Conditionally launches DeepConv operation based on convolution parameters.
 template <>
 class LaunchDeepConvOp<CPUDevice, float> {
@@ -32,7 +72,7 @@ class LaunchDeepConvOp<CPUDevice, float> {
                   int filter_cols, int pad_rows, int pad_cols, int out_rows,
                   int out_cols, int out_depth, int dilation_rows,
                   int dilation_cols, int stride_rows, int stride_cols,
-                  Tensor* output, TensorFormat data_format) {
+                  Tensor* output, TensorFormat data_format, bool use_autotune) {
     if (data_format != FORMAT_NHWC || dilation_rows != 1 ||
         dilation_cols != 1 ||
         !CanUseDeepConv2D(stride_rows, stride_cols, filter_rows, filter_cols,
@@ -57,6 +97,38 @@ class LaunchDeepConvOp<CPUDevice, float> {
     auto filter_ptr = filter.template flat<float>().data();
     auto output_ptr = output->template flat<float>().data();
 
+    // The cost model only counts flops, so the first convolution of every
+    // shape is also computed by the Eigen implementation to check that
+    // DeepConv2D is actually faster.
+    bool use_deep_conv = true;
+    if (use_autotune &&
+        !DeepConv2DAutotuneMap::Global()->Find(args, &use_deep_conv)) {
+      Env* env = Env::Default();
+      const uint64 deep_conv_start = env->NowMicros();
+      functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
+                                              output_ptr);
+      const uint64 eigen_start = env->NowMicros();
+      if (!ctx->status().ok()) return true;
+      // Both implementations compute the same output, so it is overwritten.
+      const int pad_rows_after =
+          out_rows - 1 + filter_rows - input_rows - pad_rows;
+      const int pad_cols_after =
+          out_cols - 1 + filter_cols - input_cols - pad_cols;
+      LaunchGeneric<CPUDevice, float>()(
+          ctx, input, filter, /*row_stride=*/1, /*col_stride=*/1,
+          /*row_dilation=*/1, /*col_dilation=*/1, EXPLICIT,
+          {0, 0, pad_rows, pad_rows_after, pad_cols, pad_cols_after, 0, 0},
+          output, data_format);
+      const uint64 eigen_end = env->NowMicros();
+      use_deep_conv = eigen_start - deep_conv_start < eigen_end - eigen_start;
+      VLOG(2) << "DeepConv2D autotuning: deep_conv_us: "
+              << eigen_start - deep_conv_start
+              << " eigen_us: " << eigen_end - eigen_start;
+      DeepConv2DAutotuneMap::Global()->Insert(args, use_deep_conv);
+      return true;
+    }
+    if (!use_deep_conv) return false;
+
     functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
                                             output_ptr);
     return true;
@@ -33,12 +33,14 @@ limitations under the License.
 
 #include <string.h>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <functional>
 #include <limits>
 #include <map>
 #include <numeric>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -69,6 +71,7 @@ limitations under the License.
 #include "tensorflow/core/util/padding.h"
 #include "tensorflow/core/util/tensor_format.h"
 #include "tensorflow/core/util/use_cudnn.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/kernels/cast_op.h"
@@ -255,6 +258,91 @@ struct LaunchGrouped {
   }
 };
 
+// Computes depthwise 2D convolutions on CPU, i.e. grouped convolutions with a
+// single input channel per group, directly in NHWC. Each output pixel is the
+// sum over the filter window of the input pixels scaled by the filter, which
+// is vectorized along the contiguous channels. This avoids the shuffles and
+// the per-group convolutions of LaunchGrouped, and the im2col packing of the
+// Eigen convolution, which dominate for the small depth of each group.
+template <typename T>
+struct LaunchDepthwiseDirect {
+  void operator()(OpKernelContext* ctx, const Tensor& input,
+                  const Tensor& filter, int row_stride, int col_stride,
+                  int row_dilation, int col_dilation, const Padding& padding,
+                  const std::vector<int64_t>& explicit_paddings,
+                  Tensor* output) {
+    const int64_t in_rows = input.dim_size(1);
+    const int64_t in_cols = input.dim_size(2);
+    const int64_t in_depth = input.dim_size(3);
+    const int64_t filter_rows = filter.dim_size(0);
+    const int64_t filter_cols = filter.dim_size(1);
+    const int64_t out_rows = output->dim_size(1);
+    const int64_t out_cols = output->dim_size(2);
+    const int64_t out_depth = output->dim_size(3);
+    const int64_t depth_multiplier = out_depth / in_depth;
+
+    int64_t pad_top = 0;
+    int64_t pad_left = 0;
+    if (padding == EXPLICIT) {
+      pad_top = explicit_paddings[2];
+      pad_left = explicit_paddings[4];
+    } else if (padding == SAME) {
+      pad_top = std::max<int64_t>(
+          0, ((out_rows - 1) * row_stride + (filter_rows - 1) * row_dilation +
+              1 - in_rows) /
+                 2);
+      pad_left = std::max<int64_t>(
+          0, ((out_cols - 1) * col_stride + (filter_cols - 1) * col_dilation +
+              1 - in_cols) /
+                 2);
+    }
+
+    const T* input_data = input.flat<T>().data();
+    const T* filter_data = filter.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+
+    auto convolve_rows = [&](int64_t start, int64_t limit) {
+      for (int64_t unit = start; unit < limit; ++unit) {
+        const int64_t b = unit / out_rows;
+        const int64_t out_r = unit % out_rows;
+        const T* image = input_data + b * in_rows * in_cols * in_depth;
+        for (int64_t out_c = 0; out_c < out_cols; ++out_c) {
+          T* out = output_data + (unit * out_cols + out_c) * out_depth;
+          std::fill(out, out + out_depth, T(0));
+          for (int64_t f_r = 0; f_r < filter_rows; ++f_r) {
+            const int64_t in_r =
+                out_r * row_stride - pad_top + f_r * row_dilation;
+            if (in_r < 0 || in_r >= in_rows) continue;
+            for (int64_t f_c = 0; f_c < filter_cols; ++f_c) {
+              const int64_t in_c =
+                  out_c * col_stride - pad_left + f_c * col_dilation;
+              if (in_c < 0 || in_c >= in_cols) continue;
+              const T* in = image + (in_r * in_cols + in_c) * in_depth;
+              const T* weights =
+                  filter_data + (f_r * filter_cols + f_c) * out_depth;
+              if (depth_multiplier == 1) {
+                for (int64_t d = 0; d < out_depth; ++d) {
+                  out[d] += in[d] * weights[d];
+                }
+              } else {
+                for (int64_t d = 0; d < out_depth; ++d) {
+                  out[d] += in[d / depth_multiplier] * weights[d];
+                }
+              }
+            }
+          }
+        }
+      }
+    };
+
+    const int64_t cost_per_unit =
+        out_cols * filter_rows * filter_cols * out_depth * 2;
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          input.dim_size(0) * out_rows, cost_per_unit, convolve_rows);
+  }
+};
+
 template <typename Device, typename T>
 struct LaunchConvOp;
 
@@ -612,7 +700,12 @@ struct LaunchConv2DOp<CPUDevice, T> {
       return;
     }
 
-    if (in_depth != patch_depth) {
+    if (patch_depth == 1 && in_depth > 1 &&
+        (std::is_same<T, float>::value || std::is_same<T, double>::value)) {
+      LaunchDepthwiseDirect<T>()(ctx, input, filter, row_stride, col_stride,
+                                 row_dilation, col_dilation, padding,
+                                 explicit_paddings, output);
+    } else if (in_depth != patch_depth) {
       LaunchGrouped<T>()(ctx, input, filter, row_stride, col_stride,
                          row_dilation, col_dilation, padding, explicit_paddings,
                          output, data_format);
@@ -639,7 +732,7 @@ class LaunchDeepConvOp {
                   int /*out_cols*/, int /*out_depth*/, int /*dilation_rows*/,
                   int /*dilation_cols*/, int /*stride_rows*/,
                   int /*stride_cols*/, Tensor* /*output*/,
-                  TensorFormat /*data_format*/) {
+                  TensorFormat /*data_format*/, bool /*use_autotune*/) {
     return false;
   }
 };
@@ -712,7 +805,8 @@ class Conv2DOp : public BinaryOp<T> {
             dimensions.pad_cols_before, dimensions.out_rows,
             dimensions.out_cols, dimensions.out_depth, dimensions.dilation_rows,
             dimensions.dilation_cols, dimensions.stride_rows,
-            dimensions.stride_cols, output, params_.data_format)) {
+            dimensions.stride_cols, output, params_.data_format,
+            cudnn_use_autotune_)) {
       return;
     }
 
@@ -473,12 +473,106 @@ class ConvOpTest : public OpsTestBase {
     const Tensor& output = *GetOutput(0);
     test::ExpectTensorNear<float>(expected, output, 1e-5);
   }
+
+  // Compares Conv2D with a direct computation of the convolution, for a
+  // [filter_size, filter_size, filter_depth, out_depth] filter.
+  void CompareWithReference(const TensorShape& input_shape, int filter_size,
+                            int filter_depth, int out_depth, int stride,
+                            const string& padding) {
+    TF_EXPECT_OK(NodeDefBuilder("conv_op", "Conv2D")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("T", DT_FLOAT)
+                     .Attr("strides", {1, stride, stride, 1})
+                     .Attr("padding", padding)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+    AddInput<float>(input_shape, [](int i) { return (i * 7 % 13) / 13.0f; });
+    AddInput<float>(
+        TensorShape({filter_size, filter_size, filter_depth, out_depth}),
+        [](int i) { return (i * 5 % 11) / 11.0f - 0.5f; });
+    TF_ASSERT_OK(RunOpKernel());
+
+    const int batch = input_shape.dim_size(0);
+    const int in_rows = input_shape.dim_size(1);
+    const int in_cols = input_shape.dim_size(2);
+    const int in_depth = input_shape.dim_size(3);
+    int64_t out_rows, out_cols, pad_rows, pad_cols;
+    const Padding padding_type = padding == "SAME" ? SAME : VALID;
+    TF_ASSERT_OK(GetWindowedOutputSize(in_rows, filter_size,
+                                       /*dilation_rate=*/1, stride,
+                                       padding_type, &out_rows, &pad_rows));
+    TF_ASSERT_OK(GetWindowedOutputSize(in_cols, filter_size,
+                                       /*dilation_rate=*/1, stride,
+                                       padding_type, &out_cols, &pad_cols));
+    auto in = GetInput(0).tensor<float, 4>();
+    auto filter = GetInput(1).tensor<float, 4>();
+    const int group_out_depth = out_depth / (in_depth / filter_depth);
+    Tensor expected(DT_FLOAT,
+                    TensorShape({batch, out_rows, out_cols, out_depth}));
+    auto out = expected.tensor<float, 4>();
+    for (int b = 0; b < batch; ++b) {
+      for (int r = 0; r < out_rows; ++r) {
+        for (int c = 0; c < out_cols; ++c) {
+          for (int o = 0; o < out_depth; ++o) {
+            float sum = 0;
+            for (int fr = 0; fr < filter_size; ++fr) {
+              for (int fc = 0; fc < filter_size; ++fc) {
+                const int64_t in_r = r * stride - pad_rows + fr;
+                const int64_t in_c = c * stride - pad_cols + fc;
+                if (in_r < 0 || in_r >= in_rows || in_c < 0 ||
+                    in_c >= in_cols) {
+                  continue;
+                }
+                for (int d = 0; d < filter_depth; ++d) {
+                  sum += in(b, in_r, in_c,
+                            o / group_out_depth * filter_depth + d) *
+                         filter(fr, fc, d, o);
+                }
+              }
+            }
+            out(b, r, c, o) = sum;
+          }
+        }
+      }
+    }
+    test::ExpectClose(expected, *GetOutput(0), /*atol=*/1e-4,
+                      /*rtol=*/1e-4);
+  }
 };
 
 TEST_F(ConvOpTest, HandwrittenConv) { HandwrittenConv(); }
 
 TEST_F(ConvOpTest, AnisotropicStride) { AnisotropicStrides(); }
 
+TEST_F(ConvOpTest, Depthwise) {
+  CompareWithReference(TensorShape({2, 7, 6, 8}), /*filter_size=*/3,
+                       /*filter_depth=*/1, /*out_depth=*/8, /*stride=*/1,
+                       "SAME");
+}
+
+TEST_F(ConvOpTest, DepthwiseWithMultiplier) {
+  CompareWithReference(TensorShape({1, 9, 8, 3}), /*filter_size=*/3,
+                       /*filter_depth=*/1, /*out_depth=*/6, /*stride=*/2,
+                       "SAME");
+}
+
+TEST_F(ConvOpTest, DepthwiseValid) {
+  CompareWithReference(TensorShape({1, 6, 6, 4}), /*filter_size=*/2,
+                       /*filter_depth=*/1, /*out_depth=*/4, /*stride=*/1,
+                       "VALID");
+}
+
+TEST_F(ConvOpTest, DeepConv2D) {
+  // Deep enough for the Winograd F(4x4, 3x3) transform, which is timed
+  // against the Eigen implementation on the first run.
+  setenv("TF_USE_DEEP_CONV2D", "1", 1 /* replace */);
+  CompareWithReference(TensorShape({1, 18, 17, 64}), /*filter_size=*/3,
+                       /*filter_depth=*/64, /*out_depth=*/64, /*stride=*/1,
+                       "SAME");
+  unsetenv("TF_USE_DEEP_CONV2D");
+}
+
 template <typename T>
 class FusedConv2DOpTest : public OpsTestBase {
  protected:
@@ -23,7 +23,9 @@ limitations under the License.
 #include <vector>
 
 #include "absl/status/status.h"
+#include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/global_shuffle_utils.h"
+#include "tensorflow/core/data/indexed_cache.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -70,6 +72,7 @@ constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
+constexpr char kIndexedFileCacheExperiment[] = "indexed_file_cache";
 constexpr char kIncompleteCacheErrorMessage[] =
     "The calling iterator did not fully read the dataset being cached. In "
     "order to avoid unexpected truncation of the dataset, the partially cached "
@@ -178,7 +181,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         item_index_padding_size_(StringPaddingSize(kMaxItems)),
         tensor_format_string_(strings::Printf(kKeyStrFormat,
                                               item_index_padding_size_,
-                                              tensor_index_padding_size_)) {
+                                              tensor_index_padding_size_)),
+        write_indexed_cache_(
+            GetExperiments().contains(kIndexedFileCacheExperiment)) {
     input_->Ref();
     DCHECK_EQ(item_index_padding_size_, 7);
   }
@@ -220,11 +225,61 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
     return input_->CheckExternalState();
   }
 
+  // Once an indexed cache has been written, elements are read from it.
+  // Otherwise, they are computed by the input.
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<const IndexedCacheReader> reader,
+                        GetIndexedCacheReader());
+    if (reader == nullptr) {
+      return DatasetBase::Get(ctx, index, out_tensors);
+    }
+    return reader->Read(index, out_tensors);
+  }
+
+  Status Get(AnyContext ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<const IndexedCacheReader> reader,
+                        GetIndexedCacheReader());
+    if (reader == nullptr) {
+      return input_->Get(ctx, index, out_tensors);
+    }
+    return reader->Read(index, out_tensors);
+  }
+
+  absl::Status RandomIndexingCompatible() const override {
+    if (env_->FileExists(IndexedCacheFilename(filename_)).ok()) {
+      return absl::OkStatus();
+    }
+    return input_->RandomIndexingCompatible();
+  }
+
  protected:
   const DatasetBase* const input_;
   const tstring filename_;
 
  private:
+  // Returns whether a complete cache with prefix `prefix` exists, in either
+  // format.
+  bool CacheExists(const string& prefix) const {
+    return env_->FileExists(MetaFilename(prefix)).ok() ||
+           env_->FileExists(IndexedCacheFilename(prefix)).ok();
+  }
+
+  // Returns the reader of the indexed cache, or nullptr if it has not been
+  // written.
+  absl::StatusOr<std::shared_ptr<const IndexedCacheReader>>
+  GetIndexedCacheReader() const {
+    mutex_lock l(mu_);
+    if (indexed_cache_reader_ == nullptr &&
+        env_->FileExists(IndexedCacheFilename(filename_)).ok()) {
+      TF_ASSIGN_OR_RETURN(
+          indexed_cache_reader_,
+          IndexedCacheReader::Open(env_, IndexedCacheFilename(filename_)));
+    }
+    return indexed_cache_reader_;
+  }
+
   static size_t StringPaddingSize(size_t num_tensors) {
     return strings::Printf(kPaddingSizeStrFormat, num_tensors - 1).size();
   }
@@ -237,10 +292,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
   class FileIterator : public DatasetIterator<FileDatasetBase> {
    public:
     explicit FileIterator(const Params& params)
-        : DatasetIterator<FileDatasetBase>(params) {
-      if (params.dataset->env_
-              ->FileExists(MetaFilename(params.dataset->filename_))
-              .ok()) {
+        : DatasetIterator<FileDatasetBase>(params),
+          global_shuffle_iterator_(dataset()) {
+      if (params.dataset->CacheExists(params.dataset->filename_)) {
         mode_ = Mode::read;
       } else {
         mode_ = Mode::write;
@@ -255,6 +309,10 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
+      if (ctx->index_mapper() != nullptr) {
+        return global_shuffle_iterator_.GetNext(ctx, out_tensors,
+                                                end_of_sequence);
+      }
       mutex_lock l(mu_);
       return iterator_->GetNext(ctx, out_tensors, end_of_sequence);
     }
@@ -274,6 +332,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
     }
     Status RestoreInternal(IteratorContext* ctx,
                            IteratorStateReader* reader) override {
+      if (ctx->restored_element_count().has_value()) {
+        return global_shuffle_iterator_.Restore(ctx);
+      }
       mutex_lock l(mu_);
       {
         int64_t temp;
@@ -281,9 +342,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         mode_ = static_cast<Mode>(temp);
       }
       if (mode_ == Mode::write &&
-          dataset()
-              ->env_->FileExists(MetaFilename(dataset()->filename_))
-              .ok()) {
+          dataset()->CacheExists(dataset()->filename_)) {
         // This could happen if the cache was completely written after the
         // checkpoint was saved.
         LOG(WARNING)
@@ -315,6 +374,10 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
     // partial cache gets flushed to disk in files with prefix
     // <filename>_<shard_id> where shard_id is unique for each checkpoint.
     // When all elements have been produced, these shards get coalesced.
+    //
+    // If the `indexed_file_cache` experiment is enabled, the elements are
+    // instead written to an indexed cache (see data/indexed_cache.h), which
+    // can be memory-mapped and read in any order.
     class FileWriterIterator : public DatasetIterator<FileDatasetBase> {
      public:
       explicit FileWriterIterator(const Params& params)
@@ -328,7 +391,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
             iteration_completed_(false) {}
 
       ~FileWriterIterator() override {
-        if (!dataset()->env_->FileExists(MetaFilename(filename_)).ok()) {
+        if (!dataset()->CacheExists(filename_)) {
           LOG(WARNING) << kIncompleteCacheErrorMessage;
           std::vector<string> cache_files;
           Status s = dataset()->env_->GetMatchingPaths(
@@ -361,7 +424,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           return absl::OkStatus();
         }
-        TF_RETURN_IF_ERROR(writer_->status());
+        if (writer_ != nullptr) {
+          TF_RETURN_IF_ERROR(writer_->status());
+        }
         if (cur_index_ >= kMaxItems) {
           // As a courtesy, close the [truncated] cache file.
           Status s = Finish();
@@ -386,11 +451,15 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
               "Expected ",
               dataset()->num_tensors_, " got: ", out_tensors->size());
         }
-        size_t tensor_index = 0;
-        for (const Tensor& t : *out_tensors) {
-          DCHECK_LT(tensor_index, dataset()->num_tensors_);
-          string key = dataset()->FormatName(cur_index_, tensor_index++);
-          TF_RETURN_IF_ERROR(writer_->Add(key, t));
+        if (indexed_writer_ != nullptr) {
+          TF_RETURN_IF_ERROR(indexed_writer_->Add(*out_tensors));
+        } else {
+          size_t tensor_index = 0;
+          for (const Tensor& t : *out_tensors) {
+            DCHECK_LT(tensor_index, dataset()->num_tensors_);
+            string key = dataset()->FormatName(cur_index_, tensor_index++);
+            TF_RETURN_IF_ERROR(writer_->Add(key, t));
+          }
         }
         if (*end_of_sequence) {
           TF_RETURN_IF_ERROR(Finish());
@@ -424,8 +493,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // about flushing the current shard. This ensures that we never write
         // empty shards.
         if (lockfile_created_) {
-          // Flush the current bundle.
-          TF_RETURN_IF_ERROR(writer_->Finish());
+          // Flush the current shard.
+          TF_RETURN_IF_ERROR(FinishShard());
 
           // Note: We do not delete the lockfile here. We keep lockfiles of
           // all shards around until the entire cache has been written to
@@ -474,11 +543,30 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         }
         filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
         lockfile_ = strings::StrCat(filename_, kLockFileSuffix);
-        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
-        return absl::OkStatus();
+        return CreateWriter();
       }
 
      private:
+      // Creates the writer of the current shard.
+      Status CreateWriter() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (dataset()->write_indexed_cache_) {
+          TF_ASSIGN_OR_RETURN(
+              indexed_writer_,
+              IndexedCacheWriter::Create(dataset()->env_,
+                                         IndexedCacheFilename(filename_)));
+        } else {
+          writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        }
+        return absl::OkStatus();
+      }
+
+      Status FinishShard() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (indexed_writer_ != nullptr) {
+          return indexed_writer_->Finish();
+        }
+        return writer_->Finish();
+      }
+
       Status EnsureLockFileExists(bool* end_of_sequence)
           TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         if (iteration_completed_) {
@@ -494,7 +582,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
 
         // 1. Check that a checkpoint for the shard has not already been
         // written.
-        if (dataset()->env_->FileExists(MetaFilename(filename_)).ok()) {
+        if (dataset()->CacheExists(filename_)) {
           return errors::AlreadyExists("Existing cache files found: \n",
                                        MetaFilename(filename_), "\n",
                                        DataFilename(filename_, 0, 1), "\n",
@@ -536,15 +624,15 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // conditions are not met since BundleWriter's constructor creates
         // new temp files which can delete the temp files created by a
         // BundleWriter in another Session.
-        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        TF_RETURN_IF_ERROR(CreateWriter());
         lockfile_created_ = true;
         return absl::OkStatus();
       }
 
       Status Finish() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         iteration_completed_ = true;
-        // Flush the current bundle.
-        TF_RETURN_IF_ERROR(writer_->Finish());
+        // Flush the current shard.
+        TF_RETURN_IF_ERROR(FinishShard());
         // Merge all the bundles.
         // Currently there are `shard_id_ + 1` bundles, one for each
         // checkpoint. Each bundle has prefix <filename>_<id> where `id` is an
@@ -552,7 +640,17 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // We merge all these bundles into a bundle with prefix <filename> so
         // that the next call to `MakeIterator` can build a
         // `FileReaderIterator`.
-        {
+        if (indexed_writer_ != nullptr) {
+          std::vector<string> filenames;
+          filenames.reserve(shard_id_ + 1);
+          for (size_t i = 0; i <= shard_id_; ++i) {
+            filenames.push_back(IndexedCacheFilename(
+                strings::StrCat(dataset()->filename_, "_", i)));
+          }
+          TF_RETURN_IF_ERROR(
+              MergeIndexedCaches(dataset()->env_, filenames,
+                                 IndexedCacheFilename(dataset()->filename_)));
+        } else {
           std::vector<tstring> prefixes;
           prefixes.reserve(shard_id_ + 1);
           for (size_t i = 0; i <= shard_id_; ++i) {
@@ -580,6 +678,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       // `StrCat(dataset()->filename_, "_", shard_id_)`.
       string filename_;
       std::unique_ptr<BundleWriter> writer_ TF_GUARDED_BY(mu_);
+      std::unique_ptr<IndexedCacheWriter> indexed_writer_ TF_GUARDED_BY(mu_);
       string lockfile_ TF_GUARDED_BY(mu_);
       bool lockfile_created_ TF_GUARDED_BY(mu_);
       bool iteration_completed_ TF_GUARDED_BY(mu_);
@@ -674,6 +773,68 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       bool iterator_restored_ TF_GUARDED_BY(mu_);
     };  // FileReaderIterator
 
+    // IndexedFileReaderIterator reads the elements of an indexed cache in
+    // order. The tensors it produces refer to the memory-mapped file.
+    class IndexedFileReaderIterator
+        : public DatasetIterator<FileDatasetBase> {
+     public:
+      explicit IndexedFileReaderIterator(const Params& params)
+          : DatasetIterator<FileDatasetBase>(params) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        TF_ASSIGN_OR_RETURN(reader_, dataset()->GetIndexedCacheReader());
+        if (reader_ == nullptr) {
+          return errors::NotFound("Indexed cache ",
+                                  IndexedCacheFilename(dataset()->filename_),
+                                  " not found.");
+        }
+        return absl::OkStatus();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (cur_index_ >= reader_->NumElements()) {
+          *end_of_sequence = true;
+          return absl::OkStatus();
+        }
+        *end_of_sequence = false;
+        TF_RETURN_IF_ERROR(reader_->Read(cur_index_, out_tensors));
+        cur_index_++;
+        return absl::OkStatus();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kCurIndex, cur_index_));
+        return absl::OkStatus();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(prefix(), kCurIndex, &cur_index_));
+        return absl::OkStatus();
+      }
+
+     private:
+      mutex mu_;
+      int64_t cur_index_ TF_GUARDED_BY(mu_) = 0;
+      std::shared_ptr<const IndexedCacheReader> reader_ TF_GUARDED_BY(mu_);
+    };  // IndexedFileReaderIterator
+
     Status InitializeIterator(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       // We intentionally use the same prefix for both `FileReaderIterator` and
@@ -686,9 +847,18 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       // `cur_index`.
       switch (mode_) {
         case Mode::read:
-          iterator_ =
-              std::make_unique<FileReaderIterator>(FileReaderIterator::Params{
-                  dataset(), strings::StrCat(prefix(), kImpl)});
+          if (dataset()
+                  ->env_
+                  ->FileExists(IndexedCacheFilename(dataset()->filename_))
+                  .ok()) {
+            iterator_ = std::make_unique<IndexedFileReaderIterator>(
+                IndexedFileReaderIterator::Params{
+                    dataset(), strings::StrCat(prefix(), kImpl)});
+          } else {
+            iterator_ = std::make_unique<FileReaderIterator>(
+                FileReaderIterator::Params{dataset(),
+                                           strings::StrCat(prefix(), kImpl)});
+          }
           break;
         case Mode::write:
           iterator_ =
@@ -703,6 +873,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
     enum Mode { read, write };
     Mode mode_ TF_GUARDED_BY(mu_);
     std::unique_ptr<IteratorBase> iterator_ TF_GUARDED_BY(mu_);
+    GlobalShuffleIterator global_shuffle_iterator_;
   };  // FileIterator
 
   Env* const env_;
@@ -711,6 +882,11 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
   static constexpr size_t kMaxItems = 10000000;  // 10 million
   const size_t item_index_padding_size_;
   const string tensor_format_string_;
+  // Whether new caches are written as indexed caches.
+  const bool write_indexed_cache_;
+  mutable mutex mu_;
+  mutable std::shared_ptr<const IndexedCacheReader> indexed_cache_reader_
+      TF_GUARDED_BY(mu_);
 };  // FileDatasetBase
 
 class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
@@ -11,12 +11,18 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include <stdlib.h>
+
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/status/statusor.h"
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/indexed_cache.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/path.h"
 
 namespace tensorflow {
@@ -370,6 +376,155 @@ INSTANTIATE_TEST_CASE_P(CacheDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+// Runs the tests of the indexed file cache with the `indexed_file_cache`
+// experiment enabled, if experiments are supported.
+class IndexedFileCacheTest : public CacheDatasetOpTest {
+ protected:
+  void SetUp() override {
+    setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+    setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+    setenv("TF_DATA_EXPERIMENT_OPT_IN", "indexed_file_cache", /*overwrite=*/1);
+    if (!GetExperiments().contains("indexed_file_cache")) {
+      GTEST_SKIP() << "Experiments are not supported.";
+    }
+  }
+
+  void TearDown() override {
+    unsetenv("TF_JOB_NAME");
+    unsetenv("TF_TASK_ID");
+    unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+  }
+
+  // Writes the cache of `dataset_params` by iterating through it.
+  void WriteCache(const CacheDatasetParams& dataset_params) {
+    TF_ASSERT_OK(Initialize(dataset_params));
+    TF_ASSERT_OK(ReadAll(iterator_ctx_.get()).status());
+    TF_ASSERT_OK(device_->env()->FileExists(
+        IndexedCacheFilename(dataset_params.filename())));
+  }
+
+  // Returns all the elements produced by `iterator_`.
+  absl::StatusOr<std::vector<Tensor>> ReadAll(IteratorContext* ctx) {
+    std::vector<Tensor> out_tensors;
+    bool end_of_sequence = false;
+    while (!end_of_sequence) {
+      std::vector<Tensor> next;
+      TF_RETURN_IF_ERROR(iterator_->GetNext(ctx, &next, &end_of_sequence));
+      out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+    }
+    return out_tensors;
+  }
+
+  // Removes the last `num_bytes` bytes of `filename`.
+  void Truncate(const string& filename, int64_t num_bytes) {
+    string contents;
+    TF_ASSERT_OK(ReadFileToString(device_->env(), filename, &contents));
+    ASSERT_GE(contents.size(), num_bytes);
+    contents.resize(contents.size() - num_bytes);
+    TF_ASSERT_OK(WriteStringToFile(device_->env(), filename, contents));
+  }
+};
+
+TEST_F(IndexedFileCacheTest, WriteThenRead) {
+  auto dataset_params = CacheDatasetParams1();
+  WriteCache(dataset_params);
+
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator_));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> out_tensors,
+                          ReadAll(iterator_ctx_.get()));
+  TF_EXPECT_OK(ExpectEqual(
+      out_tensors,
+      CreateTensors<int64_t>(TensorShape({3, 1}),
+                             {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}}),
+      /*compare_order=*/true));
+}
+
+TEST_F(IndexedFileCacheTest, RandomAccess) {
+  auto dataset_params = CacheDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  // Elements are computed by the input until the cache is written.
+  TF_EXPECT_OK(dataset_->RandomIndexingCompatible());
+  WriteCache(dataset_params);
+
+  TF_EXPECT_OK(dataset_->RandomIndexingCompatible());
+  const std::vector<Tensor> expected = CreateTensors<int64_t>(
+      TensorShape({3, 1}), {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}});
+  for (int64_t i : {2, 0, 1}) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(
+        dataset_->Get(AnyContext(iterator_ctx_.get()), i, &out_tensors));
+    TF_EXPECT_OK(ExpectEqual(out_tensors, {expected[i]},
+                             /*compare_order=*/true));
+  }
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      dataset_->Get(AnyContext(iterator_ctx_.get()), 3, &out_tensors).code(),
+      absl::StatusCode::kOutOfRange);
+}
+
+TEST_F(IndexedFileCacheTest, GlobalShuffle) {
+  auto dataset_params = CacheDatasetParams1();
+  WriteCache(dataset_params);
+
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator_));
+  IteratorContext::Params params(iterator_ctx_.get());
+  params.index_mapper = [](size_t index) -> absl::StatusOr<size_t> {
+    const std::vector<size_t> shuffled = {2, 0, 1};
+    return index < shuffled.size() ? shuffled[index] : index;
+  };
+  IteratorContext ctx(std::move(params));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> out_tensors, ReadAll(&ctx));
+  TF_EXPECT_OK(ExpectEqual(
+      out_tensors,
+      CreateTensors<int64_t>(TensorShape({3, 1}),
+                             {{6, 7, 8}, {0, 1, 2}, {3, 4, 5}}),
+      /*compare_order=*/true));
+}
+
+TEST_F(IndexedFileCacheTest, TruncatedFooter) {
+  auto dataset_params = CacheDatasetParams1();
+  WriteCache(dataset_params);
+  Truncate(IndexedCacheFilename(dataset_params.filename()), /*num_bytes=*/1);
+
+  // The reader of the new dataset opens the truncated file.
+  EXPECT_EQ(Initialize(dataset_params).code(), absl::StatusCode::kDataLoss);
+}
+
+TEST_F(IndexedFileCacheTest, MissingIndex) {
+  auto dataset_params = CacheDatasetParams1();
+  WriteCache(dataset_params);
+  // The index holds an 8 byte offset per element, and is followed by a 32 byte
+  // footer.
+  Truncate(IndexedCacheFilename(dataset_params.filename()),
+           /*num_bytes=*/3 * 8 + 32);
+
+  EXPECT_EQ(Initialize(dataset_params).code(), absl::StatusCode::kDataLoss);
+}
+
+TEST_F(IndexedFileCacheTest, MissingCacheIsRewritten) {
+  auto dataset_params = CacheDatasetParams1();
+  WriteCache(dataset_params);
+  TF_ASSERT_OK(device_->env()->DeleteFile(
+      IndexedCacheFilename(dataset_params.filename())));
+
+  // Without a cache file, the new dataset writes the cache again.
+  WriteCache(dataset_params);
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator_));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> out_tensors,
+                          ReadAll(iterator_ctx_.get()));
+  TF_EXPECT_OK(ExpectEqual(
+      out_tensors,
+      CreateTensors<int64_t>(TensorShape({3, 1}),
+                             {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}}),
+      /*compare_order=*/true));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -0,0 +1,709 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_sequence_length_dataset_op.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
+#include "tensorflow/core/data/captured_function.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kOtherArguments;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kBucketBoundaries;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kBucketBatchSizes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kPaddedShapes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kMaxBufferedBytes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kMaxWindowAge;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kElementLengthFunc;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kTarguments;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kToutputTypes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kNumPaddedShapes;
+
+namespace {
+
+// When `max_buffered_bytes` is autotuned, the buckets may hold up to this
+// fraction of the RAM available to the autotuning model.
+constexpr double kMaxBufferedRamFraction = 0.25;
+
+constexpr char kEndOfInput[] = "end_of_input";
+constexpr char kNumElements[] = "num_elements";
+constexpr char kBucket[] = "bucket";
+constexpr char kReady[] = "ready";
+constexpr char kSize[] = "_size";
+constexpr char kStart[] = "_start";
+
+int64_t ElementBytes(const std::vector<Tensor>& element) {
+  int64_t bytes = 0;
+  for (const Tensor& component : element) {
+    bytes += component.TotalBytes();
+  }
+  return bytes;
+}
+
+}  // namespace
+
+class BucketBySequenceLengthDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input,
+          std::unique_ptr<CapturedFunction> captured_func,
+          std::vector<int64_t> bucket_boundaries,
+          std::vector<int64_t> bucket_batch_sizes,
+          std::vector<PartialTensorShape> padded_shapes,
+          std::vector<Tensor> padding_values, int64_t max_buffered_bytes,
+          int64_t max_window_age)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        captured_func_(std::move(captured_func)),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        bucket_batch_sizes_(std::move(bucket_batch_sizes)),
+        padded_shapes_(std::move(padded_shapes)),
+        padding_values_(std::move(padding_values)),
+        max_buffered_bytes_(max_buffered_bytes),
+        max_window_age_(max_window_age) {
+    input_->Ref();
+    output_shapes_.reserve(padded_shapes_.size());
+    for (const PartialTensorShape& padded_shape : padded_shapes_) {
+      output_shapes_.push_back(
+          PartialTensorShape({-1}).Concatenate(padded_shape));
+    }
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    int64_t n = input_->Cardinality(options);
+    if (n == kInfiniteCardinality) {
+      return n;
+    }
+    return kUnknownCardinality;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return absl::OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    TF_RETURN_IF_ERROR(captured_func_->CheckExternalState());
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+
+    std::vector<Node*> other_arguments;
+    DataTypeVector other_arguments_types;
+    TF_RETURN_IF_ERROR(captured_func_->AddToGraph(ctx, b, &other_arguments,
+                                                  &other_arguments_types));
+
+    Node* bucket_boundaries = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_boundaries_, &bucket_boundaries));
+    Node* bucket_batch_sizes = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_batch_sizes_, &bucket_batch_sizes));
+
+    std::vector<Node*> padded_shapes;
+    padded_shapes.reserve(padded_shapes_.size());
+    for (const PartialTensorShape& padded_shape : padded_shapes_) {
+      Node* node;
+      Tensor t(DT_INT64, TensorShape({padded_shape.dims()}));
+      for (int j = 0; j < padded_shape.dims(); j++) {
+        t.vec<int64_t>()(j) = padded_shape.dim_size(j);
+      }
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padded_shapes.emplace_back(node);
+    }
+
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.emplace_back(node);
+    }
+
+    Node* max_buffered_bytes = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(max_buffered_bytes_, &max_buffered_bytes));
+    Node* max_window_age = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(max_window_age_, &max_window_age));
+
+    AttrValue func;
+    b->BuildAttrValue(captured_func_->func(), &func);
+    AttrValue other_arguments_types_attr;
+    b->BuildAttrValue(other_arguments_types, &other_arguments_types_attr);
+    AttrValue output_types;
+    b->BuildAttrValue(output_dtypes(), &output_types);
+    AttrValue N;
+    b->BuildAttrValue<int64_t>(padded_shapes_.size(), &N);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {{0, input_graph_node},
+         {2, bucket_boundaries},
+         {3, bucket_batch_sizes},
+         {6, max_buffered_bytes},
+         {7, max_window_age}},
+        {{1, other_arguments}, {4, padded_shapes}, {5, padding_values}},
+        {{kElementLengthFunc, func},
+         {kTarguments, other_arguments_types_attr},
+         {kToutputTypes, output_types},
+         {kNumPaddedShapes, N}},
+        output));
+    return absl::OkStatus();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          buckets_(params.dataset->bucket_batch_sizes_.size()) {}
+
+    ~Iterator() override {
+      if (ram_budget_manager_) {
+        ram_budget_manager_->UpdateFixedBytes(-reported_ram_bytes_);
+      }
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      max_buffered_bytes_ = dataset()->max_buffered_bytes_;
+      if (ctx->ram_budget_manager()) {
+        ram_budget_manager_ = ctx->ram_budget_manager();
+        if (max_buffered_bytes_ == model::kAutotune) {
+          max_buffered_bytes_ = static_cast<int64_t>(
+              kMaxBufferedRamFraction *
+              ram_budget_manager_->AvailableModelRam());
+        }
+      }
+      if (max_buffered_bytes_ == model::kAutotune) {
+        max_buffered_bytes_ = 0;
+      }
+      TF_RETURN_IF_ERROR(
+          dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+      return dataset()->captured_func_->Instantiate(ctx,
+                                                    &instantiated_func_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      while (ready_.empty() && !end_of_input_) {
+        std::vector<Tensor> element;
+        TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &element, &end_of_input_));
+        if (end_of_input_) {
+          input_impl_.reset();
+        } else {
+          TF_RETURN_IF_ERROR(AddElement(ctx, std::move(element)));
+        }
+      }
+      if (ready_.empty()) {
+        // We have consumed all of the input, so flush the remaining buckets
+        // in order.
+        for (int64_t i = 0; i < buckets_.size(); ++i) {
+          if (!buckets_[i].elements.empty()) {
+            TF_RETURN_IF_ERROR(FlushBucket(ctx, i));
+            break;
+          }
+        }
+      }
+      ReportRam();
+      if (ready_.empty()) {
+        *end_of_sequence = true;
+        return absl::OkStatus();
+      }
+      *out_tensors = std::move(ready_.front());
+      ready_.pop_front();
+      *end_of_sequence = false;
+      return absl::OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeUnknownRatioNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      TF_RETURN_IF_ERROR(ctx->HandleCheckExternalStateStatus(
+          dataset()->captured_func_->CheckExternalState()));
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kEndOfInput, static_cast<int64_t>(end_of_input_)));
+      if (!end_of_input_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kNumElements, num_elements_));
+      for (int64_t i = 0; i < buckets_.size(); ++i) {
+        const Bucket& bucket = buckets_[i];
+        const string name = strings::StrCat(kBucket, "[", i, "]");
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), strings::StrCat(name, kSize), bucket.elements.size()));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), strings::StrCat(name, kStart), bucket.start));
+        for (int64_t j = 0; j < bucket.elements.size(); ++j) {
+          TF_RETURN_IF_ERROR(SaveElement(
+              writer, strings::StrCat(name, "[", j, "]"), bucket.elements[j]));
+        }
+      }
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), strings::StrCat(kReady, kSize), ready_.size()));
+      for (int64_t i = 0; i < ready_.size(); ++i) {
+        TF_RETURN_IF_ERROR(SaveElement(
+            writer, strings::StrCat(kReady, "[", i, "]"), ready_[i]));
+      }
+      return absl::OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t end_of_input;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kEndOfInput, &end_of_input));
+      end_of_input_ = static_cast<bool>(end_of_input);
+      if (end_of_input_) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kNumElements, &num_elements_));
+      buffered_bytes_ = 0;
+      for (int64_t i = 0; i < buckets_.size(); ++i) {
+        Bucket& bucket = buckets_[i];
+        const string name = strings::StrCat(kBucket, "[", i, "]");
+        int64_t size;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            prefix(), strings::StrCat(name, kSize), &size));
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            prefix(), strings::StrCat(name, kStart), &bucket.start));
+        bucket.elements.resize(size);
+        bucket.bytes = 0;
+        for (int64_t j = 0; j < size; ++j) {
+          TF_RETURN_IF_ERROR(RestoreElement(ctx, reader,
+                                            strings::StrCat(name, "[", j, "]"),
+                                            &bucket.elements[j]));
+          bucket.bytes += ElementBytes(bucket.elements[j]);
+        }
+        buffered_bytes_ += bucket.bytes;
+      }
+      int64_t ready_size;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(
+          prefix(), strings::StrCat(kReady, kSize), &ready_size));
+      ready_.resize(ready_size);
+      for (int64_t i = 0; i < ready_size; ++i) {
+        TF_RETURN_IF_ERROR(RestoreElement(
+            ctx, reader, strings::StrCat(kReady, "[", i, "]"), &ready_[i]));
+      }
+      ReportRam();
+      return absl::OkStatus();
+    }
+
+   private:
+    // The elements of one bucket that have not been batched yet.
+    struct Bucket {
+      std::vector<std::vector<Tensor>> elements;
+      // The total size of `elements`, in bytes.
+      int64_t bytes = 0;
+      // The number of input elements consumed before the first of `elements`.
+      int64_t start = 0;
+    };
+
+    Status AddElement(IteratorContext* ctx, std::vector<Tensor> element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64_t index;
+      TF_RETURN_IF_ERROR(GetBucketIndex(ctx, element, &index));
+      Bucket& bucket = buckets_[index];
+      if (bucket.elements.empty()) {
+        bucket.start = num_elements_;
+      }
+      const int64_t bytes = ElementBytes(element);
+      bucket.bytes += bytes;
+      buffered_bytes_ += bytes;
+      bucket.elements.push_back(std::move(element));
+      ++num_elements_;
+      if (bucket.elements.size() == dataset()->bucket_batch_sizes_[index]) {
+        TF_RETURN_IF_ERROR(FlushBucket(ctx, index));
+      }
+
+      // Flush the buckets whose oldest element has waited for more than
+      // `max_window_age` input elements, so that sparse buckets do not hold
+      // their elements indefinitely.
+      const int64_t max_window_age = dataset()->max_window_age_;
+      if (max_window_age > 0) {
+        for (int64_t i = 0; i < buckets_.size(); ++i) {
+          if (!buckets_[i].elements.empty() &&
+              num_elements_ - buckets_[i].start > max_window_age) {
+            TF_RETURN_IF_ERROR(FlushBucket(ctx, i));
+          }
+        }
+      }
+
+      // Flush the largest buckets, oldest first among equally large ones,
+      // until the buffered elements fit in `max_buffered_bytes_`.
+      while (max_buffered_bytes_ > 0 && buffered_bytes_ > max_buffered_bytes_) {
+        int64_t largest = -1;
+        for (int64_t i = 0; i < buckets_.size(); ++i) {
+          if (buckets_[i].elements.empty()) continue;
+          if (largest < 0 || buckets_[i].bytes > buckets_[largest].bytes ||
+              (buckets_[i].bytes == buckets_[largest].bytes &&
+               buckets_[i].start < buckets_[largest].start)) {
+            largest = i;
+          }
+        }
+        TF_RETURN_IF_ERROR(FlushBucket(ctx, largest));
+      }
+      return absl::OkStatus();
+    }
+
+    // Runs `element_length_func` on `element` and returns the index of the
+    // bucket whose boundaries contain its length.
+    Status GetBucketIndex(IteratorContext* ctx,
+                          const std::vector<Tensor>& element, int64_t* index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::vector<Tensor> length_output;
+      TF_RETURN_IF_ERROR(instantiated_func_->RunWithBorrowedArgs(
+          ctx, element, &length_output, model_node()));
+      if (length_output.size() != 1 ||
+          (length_output[0].dtype() != DT_INT32 &&
+           length_output[0].dtype() != DT_INT64) ||
+          length_output[0].NumElements() != 1) {
+        return errors::InvalidArgument(
+            "`element_length_func` must return a scalar int32 or int64.");
+      }
+      const int64_t length = length_output[0].dtype() == DT_INT32
+                                 ? length_output[0].scalar<int32>()()
+                                 : length_output[0].scalar<int64_t>()();
+      const std::vector<int64_t>& boundaries = dataset()->bucket_boundaries_;
+      *index = std::upper_bound(boundaries.begin(), boundaries.end(), length) -
+               boundaries.begin();
+      return absl::OkStatus();
+    }
+
+    // Pads the elements of bucket `index` into a batch, which is appended to
+    // `ready_`.
+    Status FlushBucket(IteratorContext* ctx, int64_t index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Bucket& bucket = buckets_[index];
+      std::vector<Tensor> batch;
+      TF_RETURN_IF_ERROR(CopyBatch(ctx, bucket.elements, &batch));
+      ready_.push_back(std::move(batch));
+      buffered_bytes_ -= bucket.bytes;
+      bucket.elements.clear();
+      bucket.bytes = 0;
+      return absl::OkStatus();
+    }
+
+    // Copies `batch_elements` into one output tensor per tuple component,
+    // padding each component to `padded_shapes_` as PaddedBatchDataset does.
+    Status CopyBatch(IteratorContext* ctx,
+                     const std::vector<std::vector<Tensor>>& batch_elements,
+                     std::vector<Tensor>* out_tensors) {
+      const int64_t num_batch_elements = batch_elements.size();
+      for (size_t component_index = 0;
+           component_index < dataset()->padded_shapes_.size();
+           ++component_index) {
+        const PartialTensorShape& padded_shape =
+            dataset()->padded_shapes_[component_index];
+        TensorShape component_shape;
+        for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+          TF_RETURN_IF_ERROR(component_shape.AddDimWithStatus(
+              std::max<int64_t>(padded_shape.dim_size(dim), 0)));
+        }
+        for (const std::vector<Tensor>& element : batch_elements) {
+          const TensorShape& element_shape = element[component_index].shape();
+          if (element_shape.dims() != padded_shape.dims()) {
+            return errors::InvalidArgument(
+                "All elements in a batch must have the same rank as the "
+                "padded shape for component",
+                component_index, ": expected rank ", padded_shape.dims(),
+                " but got element with rank ", element_shape.dims());
+          }
+          for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+            if (element_shape.dim_size(dim) <= component_shape.dim_size(dim)) {
+              continue;
+            }
+            if (padded_shape.dim_size(dim) != -1) {
+              return errors::DataLoss(
+                  "Attempted to pad to a smaller size than the input "
+                  "element.");
+            }
+            component_shape.set_dim(dim, element_shape.dim_size(dim));
+          }
+        }
+
+        TensorShape batch_component_shape({num_batch_elements});
+        batch_component_shape.AppendShape(component_shape);
+        out_tensors->emplace_back(ctx->allocator({}),
+                                  output_dtypes()[component_index],
+                                  batch_component_shape);
+        Tensor& batch_component = out_tensors->back();
+        TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+            &batch_component, dataset()->padding_values_[component_index]));
+        for (int64_t i = 0; i < num_batch_elements; ++i) {
+          const Tensor& component = batch_elements[i][component_index];
+          if (component.shape() == component_shape) {
+            TF_RETURN_IF_ERROR(
+                batch_util::CopyElementToSlice(component, &batch_component, i));
+          } else {
+            TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+                component, &batch_component, i));
+          }
+        }
+      }
+      return absl::OkStatus();
+    }
+
+    // Reports the memory held by `buckets_` to the RAM budget manager, so that
+    // the memory available for autotuning accounts for it.
+    void ReportRam() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (ram_budget_manager_ && buffered_bytes_ != reported_ram_bytes_) {
+        ram_budget_manager_->UpdateFixedBytes(buffered_bytes_ -
+                                              reported_ram_bytes_);
+        reported_ram_bytes_ = buffered_bytes_;
+      }
+    }
+
+    Status SaveElement(IteratorStateWriter* writer, const string& name,
+                       const std::vector<Tensor>& element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), strings::StrCat(name, kSize), element.size()));
+      for (int64_t i = 0; i < element.size(); ++i) {
+        TF_RETURN_IF_ERROR(writer->WriteTensor(
+            prefix(), strings::StrCat(name, "[", i, "]"), element[i]));
+      }
+      return absl::OkStatus();
+    }
+
+    Status RestoreElement(IteratorContext* ctx, IteratorStateReader* reader,
+                          const string& name, std::vector<Tensor>* element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64_t size;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), strings::StrCat(name, kSize), &size));
+      element->resize(size);
+      for (int64_t i = 0; i < size; ++i) {
+        TF_RETURN_IF_ERROR(
+            reader->ReadTensor(ctx->flr(), prefix(),
+                               strings::StrCat(name, "[", i, "]"),
+                               &(*element)[i]));
+      }
+      return absl::OkStatus();
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    bool end_of_input_ TF_GUARDED_BY(mu_) = false;
+    // The number of input elements consumed so far, which measures the age
+    // of the buckets.
+    int64_t num_elements_ TF_GUARDED_BY(mu_) = 0;
+    std::vector<Bucket> buckets_ TF_GUARDED_BY(mu_);
+    // Padded batches that are ready to be returned.
+    std::deque<std::vector<Tensor>> ready_ TF_GUARDED_BY(mu_);
+    // The total size of the elements in `buckets_`, in bytes.
+    int64_t buffered_bytes_ TF_GUARDED_BY(mu_) = 0;
+    // The byte budget of `buckets_`, or 0 if it is unbounded.
+    int64_t max_buffered_bytes_ TF_GUARDED_BY(mu_) = 0;
+    std::shared_ptr<model::RamBudgetManager> ram_budget_manager_;
+    int64_t reported_ram_bytes_ TF_GUARDED_BY(mu_) = 0;
+    std::unique_ptr<InstantiatedCapturedFunction> instantiated_func_;
+  };
+
+  const DatasetBase* const input_;
+  const std::unique_ptr<CapturedFunction> captured_func_;
+  const std::vector<int64_t> bucket_boundaries_;
+  const std::vector<int64_t> bucket_batch_sizes_;
+  const std::vector<PartialTensorShape> padded_shapes_;
+  const std::vector<Tensor> padding_values_;
+  const int64_t max_buffered_bytes_;
+  const int64_t max_window_age_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+BucketBySequenceLengthDatasetOp::BucketBySequenceLengthDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, FunctionMetadata::Create(ctx, kElementLengthFunc,
+                                               /*params=*/{}, &func_metadata_));
+}
+
+void BucketBySequenceLengthDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                                  DatasetBase* input,
+                                                  DatasetBase** output) {
+  std::vector<int64_t> bucket_boundaries;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<int64_t>(ctx, kBucketBoundaries,
+                                                   &bucket_boundaries));
+  for (int i = 1; i < bucket_boundaries.size(); ++i) {
+    OP_REQUIRES(ctx, bucket_boundaries[i - 1] < bucket_boundaries[i],
+                errors::InvalidArgument(
+                    "Bucket boundaries must be strictly increasing."));
+  }
+  std::vector<int64_t> bucket_batch_sizes;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<int64_t>(ctx, kBucketBatchSizes,
+                                                   &bucket_batch_sizes));
+  OP_REQUIRES(
+      ctx, bucket_batch_sizes.size() == bucket_boundaries.size() + 1,
+      errors::InvalidArgument("There must be one more bucket batch size (",
+                              bucket_batch_sizes.size(),
+                              ") than bucket boundaries (",
+                              bucket_boundaries.size(), ")."));
+  for (int64_t batch_size : bucket_batch_sizes) {
+    OP_REQUIRES(ctx, batch_size > 0,
+                errors::InvalidArgument(
+                    "Bucket batch sizes must be greater than zero."));
+  }
+
+  OpInputList padded_shape_tensors;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddedShapes, &padded_shape_tensors));
+  OP_REQUIRES(ctx, padded_shape_tensors.size() == input->output_shapes().size(),
+              errors::InvalidArgument("Number of padded shapes (",
+                                      padded_shape_tensors.size(),
+                                      ") must match the number of components "
+                                      "in the input dataset's elements (",
+                                      input->output_shapes().size(), ")"));
+  std::vector<PartialTensorShape> padded_shapes;
+  padded_shapes.reserve(padded_shape_tensors.size());
+  for (const Tensor& padded_shape_t : padded_shape_tensors) {
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(padded_shape_t.shape()),
+                errors::InvalidArgument("All padded shapes must be vectors"));
+    PartialTensorShape padded_shape;
+    OP_REQUIRES_OK(ctx, PartialTensorShape::MakePartialShape(
+                            padded_shape_t.vec<int64_t>().data(),
+                            padded_shape_t.NumElements(), &padded_shape));
+    padded_shapes.push_back(std::move(padded_shape));
+  }
+
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == input->output_shapes().size(),
+              errors::InvalidArgument(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  input->output_shapes().size(), ")"));
+  std::vector<Tensor> padding_values;
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+                errors::InvalidArgument("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                errors::InvalidArgument(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input->output_dtypes()[i])));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  int64_t max_buffered_bytes;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kMaxBufferedBytes,
+                                                   &max_buffered_bytes));
+  OP_REQUIRES(ctx,
+              max_buffered_bytes >= 0 || max_buffered_bytes == model::kAutotune,
+              errors::InvalidArgument(
+                  "max_buffered_bytes must be non-negative or autotuned."));
+  int64_t max_window_age;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kMaxWindowAge,
+                                                   &max_window_age));
+  OP_REQUIRES(ctx, max_window_age >= 0,
+              errors::InvalidArgument("max_window_age must be non-negative."));
+
+  std::unique_ptr<CapturedFunction> captured_func;
+  OP_REQUIRES_OK(ctx, CapturedFunction::Create(ctx, func_metadata_,
+                                               kOtherArguments,
+                                               &captured_func));
+
+  *output = new Dataset(ctx, input, std::move(captured_func),
+                        std::move(bucket_boundaries),
+                        std::move(bucket_batch_sizes), std::move(padded_shapes),
+                        std::move(padding_values), max_buffered_bytes,
+                        max_window_age);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(
+    Name("BucketBySequenceLengthDataset").Device(DEVICE_CPU),
+    BucketBySequenceLengthDatasetOp);
+
+REGISTER_INPUT_COLOCATION_EXEMPTION("BucketBySequenceLengthDataset");
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
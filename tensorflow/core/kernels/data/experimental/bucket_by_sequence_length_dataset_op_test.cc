@@ -0,0 +1,233 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_sequence_length_dataset_op.h"
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "bucket_by_sequence_length_dataset";
+
+class BucketBySequenceLengthDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  BucketBySequenceLengthDatasetParams(
+      T input_dataset_params, std::vector<int64_t> bucket_boundaries,
+      std::vector<int64_t> bucket_batch_sizes,
+      std::vector<Tensor> padded_shapes, std::vector<Tensor> padding_values,
+      int64_t max_buffered_bytes, int64_t max_window_age,
+      FunctionDefHelper::AttrValueWrapper func,
+      std::vector<FunctionDef> func_lib, DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes, string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        bucket_batch_sizes_(std::move(bucket_batch_sizes)),
+        padded_shapes_(std::move(padded_shapes)),
+        padding_values_(std::move(padding_values)),
+        max_buffered_bytes_(max_buffered_bytes),
+        max_window_age_(max_window_age),
+        func_(std::move(func)),
+        func_lib_(std::move(func_lib)) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> inputs;
+    inputs.push_back(CreateTensor<int64_t>(
+        TensorShape({static_cast<int64_t>(bucket_boundaries_.size())}),
+        bucket_boundaries_));
+    inputs.push_back(CreateTensor<int64_t>(
+        TensorShape({static_cast<int64_t>(bucket_batch_sizes_.size())}),
+        bucket_batch_sizes_));
+    inputs.insert(inputs.end(), padded_shapes_.begin(), padded_shapes_.end());
+    inputs.insert(inputs.end(), padding_values_.begin(),
+                  padding_values_.end());
+    inputs.push_back(
+        CreateTensor<int64_t>(TensorShape({}), {max_buffered_bytes_}));
+    inputs.push_back(CreateTensor<int64_t>(TensorShape({}), {max_window_age_}));
+    return inputs;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {BucketBySequenceLengthDatasetOp::kInputDataset,
+                    BucketBySequenceLengthDatasetOp::kBucketBoundaries,
+                    BucketBySequenceLengthDatasetOp::kBucketBatchSizes};
+    for (int i = 0; i < padded_shapes_.size(); ++i) {
+      input_names->emplace_back(strings::StrCat(
+          BucketBySequenceLengthDatasetOp::kPaddedShapes, "_", i));
+    }
+    for (int i = 0; i < padding_values_.size(); ++i) {
+      input_names->emplace_back(strings::StrCat(
+          BucketBySequenceLengthDatasetOp::kPaddingValues, "_", i));
+    }
+    input_names->emplace_back(
+        BucketBySequenceLengthDatasetOp::kMaxBufferedBytes);
+    input_names->emplace_back(BucketBySequenceLengthDatasetOp::kMaxWindowAge);
+    return absl::OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {
+        {"element_length_func", func_},
+        {"Telement_length_func_other_arguments", DataTypeVector{}},
+        {"Toutput_types", output_dtypes_},
+        {"output_shapes", output_shapes_},
+        {"N", static_cast<int64_t>(padded_shapes_.size())},
+        {"metadata", ""}};
+    return absl::OkStatus();
+  }
+
+  std::vector<FunctionDef> func_lib() const override { return func_lib_; }
+
+  string dataset_type() const override {
+    return BucketBySequenceLengthDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<int64_t> bucket_boundaries_;
+  std::vector<int64_t> bucket_batch_sizes_;
+  std::vector<Tensor> padded_shapes_;
+  std::vector<Tensor> padding_values_;
+  int64_t max_buffered_bytes_;
+  int64_t max_window_age_;
+  FunctionDefHelper::AttrValueWrapper func_;
+  std::vector<FunctionDef> func_lib_;
+};
+
+class BucketBySequenceLengthDatasetOpTest : public DatasetOpsTestBase {};
+
+// Buckets the elements of range(10) by the length `2 * x` into the buckets
+// [0, 6), [6, 12) and [12, inf), which hold {0, 1, 2}, {3, 4, 5} and
+// {6, 7, 8, 9}.
+BucketBySequenceLengthDatasetParams RangeBucketParams(
+    int64_t max_buffered_bytes, int64_t max_window_age,
+    std::vector<int64_t> bucket_batch_sizes = {2, 2, 3}) {
+  return BucketBySequenceLengthDatasetParams(
+      RangeDatasetParams(0, 10, 1),
+      /*bucket_boundaries=*/{6, 12}, std::move(bucket_batch_sizes),
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape({0}), {})},
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape({}), {-1})},
+      max_buffered_bytes, max_window_age,
+      /*func=*/FunctionDefHelper::FunctionRef("XTimesTwo", {{"T", DT_INT64}}),
+      /*func_lib=*/{test::function::XTimesTwo()},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1})},
+      /*node_name=*/kNodeName);
+}
+
+// Each bucket is batched when it is full, and the remaining buckets in order
+// at the end of the input.
+BucketBySequenceLengthDatasetParams UnboundedParams() {
+  return RangeBucketParams(/*max_buffered_bytes=*/0, /*max_window_age=*/0);
+}
+
+// A bucket is batched once two input elements arrived after its oldest one.
+BucketBySequenceLengthDatasetParams MaxWindowAgeParams() {
+  return RangeBucketParams(/*max_buffered_bytes=*/0, /*max_window_age=*/2);
+}
+
+// The buckets hold at most two int64 scalars, beyond which the largest and
+// then oldest bucket is batched.
+BucketBySequenceLengthDatasetParams MaxBufferedBytesParams() {
+  return RangeBucketParams(/*max_buffered_bytes=*/16, /*max_window_age=*/0);
+}
+
+std::vector<Tensor> ExpectedBatches(
+    const std::vector<std::vector<int64_t>>& batches) {
+  std::vector<Tensor> tensors;
+  for (const std::vector<int64_t>& batch : batches) {
+    tensors.push_back(CreateTensor<int64_t>(
+        TensorShape({static_cast<int64_t>(batch.size())}), batch));
+  }
+  return tensors;
+}
+
+std::vector<GetNextTestCase<BucketBySequenceLengthDatasetParams>>
+GetNextTestCases() {
+  return {{/*dataset_params=*/UnboundedParams(),
+           /*expected_outputs=*/
+           ExpectedBatches({{0, 1}, {3, 4}, {6, 7, 8}, {2}, {5}, {9}})},
+          {/*dataset_params=*/MaxWindowAgeParams(),
+           /*expected_outputs=*/
+           ExpectedBatches({{0, 1}, {3, 4}, {2}, {5}, {6, 7, 8}, {9}})},
+          {/*dataset_params=*/MaxBufferedBytesParams(),
+           /*expected_outputs=*/
+           ExpectedBatches({{0, 1}, {3, 4}, {2}, {6, 7}, {8, 9}, {5}})}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(BucketBySequenceLengthDatasetOpTest,
+                         BucketBySequenceLengthDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = UnboundedParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = UnboundedParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(BucketBySequenceLengthDatasetOp::kDatasetType)));
+}
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, DatasetOutputShapes) {
+  auto dataset_params = UnboundedParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputShapes({PartialTensorShape({-1})}));
+}
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, Cardinality) {
+  auto dataset_params = UnboundedParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<BucketBySequenceLengthDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/UnboundedParams(),
+           /*breakpoints=*/{0, 2, 5},
+           /*expected_outputs=*/
+           ExpectedBatches({{0, 1}, {3, 4}, {6, 7, 8}, {2}, {5}, {9}})},
+          {/*dataset_params=*/MaxWindowAgeParams(),
+           /*breakpoints=*/{0, 3, 4},
+           /*expected_outputs=*/
+           ExpectedBatches({{0, 1}, {3, 4}, {2}, {5}, {6, 7, 8}, {9}})}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(BucketBySequenceLengthDatasetOpTest,
+                                 BucketBySequenceLengthDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, InvalidBucketBatchSizes) {
+  auto dataset_params = RangeBucketParams(
+      /*max_buffered_bytes=*/0, /*max_window_age=*/0,
+      /*bucket_batch_sizes=*/{2, 2});
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -15,7 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/experimental/compression_ops.h"
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/compression_autotuner.h"
 #include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/platform/errors.h"
@@ -25,7 +33,31 @@ namespace data {
 namespace experimental {
 
 CompressElementOp::CompressElementOp(OpKernelConstruction* ctx)
-    : OpKernel(ctx) {}
+    : OpKernel(ctx) {
+  // Graphs from before the codecs were added don't have the attributes.
+  std::string codec = "snappy";
+  if (ctx->HasAttr(kCodec)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kCodec, &codec));
+  }
+  int64_t link_bandwidth_bytes_per_second = 0;
+  if (ctx->HasAttr(kLinkBandwidthBytesPerSecond)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kLinkBandwidthBytesPerSecond,
+                                     &link_bandwidth_bytes_per_second));
+  }
+  if (codec == "autotune") {
+    CompressionAutotuner::Options options;
+    if (link_bandwidth_bytes_per_second > 0) {
+      options.link_bandwidth_bytes_per_second = link_bandwidth_bytes_per_second;
+    }
+    autotuner_ = std::make_unique<CompressionAutotuner>(options);
+  } else if (codec == "none") {
+    codec_ = COMPRESSION_CODEC_NONE;
+  } else if (codec == "zstd") {
+    codec_ = COMPRESSION_CODEC_ZSTD;
+  } else if (codec == "byte_shuffle_zstd") {
+    codec_ = COMPRESSION_CODEC_BYTE_SHUFFLE_ZSTD;
+  }
+}
 
 void CompressElementOp::Compute(OpKernelContext* ctx) {
   std::vector<Tensor> components;
@@ -33,7 +65,22 @@ void CompressElementOp::Compute(OpKernelContext* ctx) {
     components.push_back(ctx->input(i));
   }
   CompressedElement compressed;
-  OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  if (autotuner_) {
+    OP_REQUIRES_OK(ctx, autotuner_->CompressElement(components, &compressed));
+  } else if (codec_ == COMPRESSION_CODEC_UNSPECIFIED) {
+    OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  } else {
+    std::vector<CompressionCodec> codecs;
+    codecs.reserve(components.size());
+    for (const Tensor& component : components) {
+      // Byte shuffling only applies to values with a fixed size.
+      codecs.push_back(codec_ == COMPRESSION_CODEC_BYTE_SHUFFLE_ZSTD &&
+                               !DataTypeCanUseMemcpy(component.dtype())
+                           ? COMPRESSION_CODEC_ZSTD
+                           : codec_);
+    }
+    OP_REQUIRES_OK(ctx, CompressElement(components, codecs, &compressed));
+  }
 
   Tensor* output;
   OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
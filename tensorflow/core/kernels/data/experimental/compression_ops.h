@@ -15,7 +15,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COMPRESSION_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COMPRESSION_OPS_H_
 
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/data/compression_autotuner.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 
 namespace tensorflow {
 namespace data {
@@ -23,9 +28,21 @@ namespace experimental {
 
 class CompressElementOp : public OpKernel {
  public:
+  static constexpr const char* const kCodec = "codec";
+  static constexpr const char* const kLinkBandwidthBytesPerSecond =
+      "link_bandwidth_bytes_per_second";
+
   explicit CompressElementOp(OpKernelConstruction* ctx);
 
   void Compute(OpKernelContext* ctx) override;
+
+ private:
+  // The codec of all components, or `COMPRESSION_CODEC_UNSPECIFIED` to
+  // compress the components together with snappy. Unused if `autotuner_` is
+  // set.
+  CompressionCodec codec_ = COMPRESSION_CODEC_UNSPECIFIED;
+  // Chooses the codec of each component if the codec is "autotune".
+  std::unique_ptr<CompressionAutotuner> autotuner_;
 };
 
 class UncompressElementOp : public OpKernel {
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include <deque>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/data/dataset_utils.h"
@@ -38,6 +39,8 @@ constexpr char kSizeSuffix[] = ".size";
 constexpr char kEndOfInputSuffix[] = ".end_of_input";
 constexpr char kCodeSuffix[] = ".code";
 constexpr char kErrorMessage[] = ".error_message";
+constexpr char kBatchSize[] = "batch_size";
+constexpr char kDropRemainder[] = "drop_remainder";
 
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
@@ -83,6 +86,12 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
       OP_REQUIRES_OK(ctx,
                      ctx->GetAttr("ragged_split_types", &ragged_split_types_));
     }
+    if (ctx->HasAttr(kBatchSize)) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr(kBatchSize, &batch_size_));
+      OP_REQUIRES_OK(ctx, ctx->GetAttr(kDropRemainder, &drop_remainder_));
+      OP_REQUIRES(ctx, batch_size_ >= 0,
+                  errors::InvalidArgument("batch_size must not be negative."));
+    }
     for (int i = 0; i < dense_shapes_.size(); ++i) {
       bool shape_ok = true;
       if (dense_shapes_[i].dims() == -1) {
@@ -203,7 +212,8 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         std::move(key_to_output_index), std::move(config), num_parallel_calls,
         sparse_types_, dense_types_, dense_shapes_, output_types_,
         output_shapes_, deterministic_, has_ragged_keys_, ragged_keys_,
-        ragged_value_types_, ragged_split_types_, op_version_);
+        ragged_value_types_, ragged_split_types_, op_version_, batch_size_,
+        drop_remainder_);
   }
 
  private:
@@ -222,7 +232,8 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
             const DeterminismPolicy& deterministic, bool has_ragged_keys,
             std::vector<string> ragged_keys,
             const DataTypeVector& ragged_value_types,
-            const DataTypeVector& ragged_split_types, int op_version)
+            const DataTypeVector& ragged_split_types, int op_version,
+            int64_t batch_size, bool drop_remainder)
         : DatasetBase(DatasetContext(ctx)),
           input_(input),
           dense_defaults_(std::move(dense_defaults)),
@@ -241,7 +252,9 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
           output_shapes_(output_shapes),
           deterministic_(deterministic),
           has_ragged_keys_(has_ragged_keys),
-          op_version_(op_version) {
+          op_version_(op_version),
+          batch_size_(batch_size),
+          drop_remainder_(drop_remainder) {
       input_->Ref();
     }
 
@@ -270,7 +283,13 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
     }
 
     int64_t CardinalityInternal(CardinalityOptions options) const override {
-      return input_->Cardinality(options);
+      int64_t n = input_->Cardinality(options);
+      if (batch_size_ == 0 || n == kInfiniteCardinality ||
+          n == kUnknownCardinality) {
+        return n;
+      }
+      return n / batch_size_ +
+             (n % batch_size_ == 0 || drop_remainder_ ? 0 : 1);
     }
 
     Status InputDatasets(
@@ -350,6 +369,16 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         attrs.emplace_back("ragged_split_types", ragged_split_types_attr);
       }
 
+      if (batch_size_ > 0) {
+        AttrValue batch_size_attr;
+        b->BuildAttrValue(batch_size_, &batch_size_attr);
+        attrs.emplace_back(kBatchSize, batch_size_attr);
+
+        AttrValue drop_remainder_attr;
+        b->BuildAttrValue(drop_remainder_, &drop_remainder_attr);
+        attrs.emplace_back(kDropRemainder, drop_remainder_attr);
+      }
+
       TF_RETURN_IF_ERROR(b->AddDataset(this,
                                        {
                                            {0, input_graph_node},
@@ -587,8 +616,13 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         });
         // Get the next input element.
         std::vector<Tensor> input_element;
-        result->status = input_impl_->GetNext(ctx.get(), &input_element,
-                                              &result->end_of_input);
+        if (dataset()->batch_size_ > 0) {
+          result->status =
+              GetNextBatch(ctx.get(), &input_element, &result->end_of_input);
+        } else {
+          result->status = input_impl_->GetNext(ctx.get(), &input_element,
+                                                &result->end_of_input);
+        }
         if (result->end_of_input || !result->status.ok()) {
           CallCompleted(ctx, result);
           return;
@@ -626,6 +660,38 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         RecordStart(ctx.get());
       }
 
+      // Gets the serialized examples of the next batch from the input when
+      // batching is fused into this op. Each example is kept as the scalar
+      // tensor it was produced in, so that `ParseExample` can parse them
+      // without first copying them into a batch tensor.
+      Status GetNextBatch(IteratorContext* ctx, std::vector<Tensor>* batch,
+                          bool* end_of_input) {
+        const int64_t batch_size = dataset()->batch_size_;
+        batch->reserve(batch_size);
+        std::vector<Tensor> element;
+        bool end_of_sequence = false;
+        while (batch->size() < batch_size) {
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &element, &end_of_sequence));
+          if (end_of_sequence) {
+            break;
+          }
+          if (element.size() != 1 || element[0].dtype() != DT_STRING ||
+              element[0].NumElements() != 1) {
+            return errors::InvalidArgument(
+                "ParseExample with a fused batch expects the input elements "
+                "to be scalar strings, but got an element with ",
+                element.size(), " components.");
+          }
+          batch->push_back(std::move(element[0]));
+          element.clear();
+        }
+        *end_of_input =
+            batch->empty() ||
+            (dataset()->drop_remainder_ && batch->size() < batch_size);
+        return absl::OkStatus();
+      }
+
       Status CheckOutputTensor(const Tensor& tensor, size_t value_index,
                                size_t output_index) const {
         if (tensor.dtype() != dataset()->output_dtypes()[output_index]) {
@@ -650,13 +716,27 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
                           std::vector<Tensor>* output) {
         thread::ThreadPool* device_threadpool =
             ctx->flr()->device()->tensorflow_cpu_worker_threads()->workers;
+        // Parse the serialized examples in place when they are in a single
+        // tensor, and through views of them otherwise.
+        absl::Span<const tstring> serialized;
         std::vector<tstring> slice_vec;
-        for (const Tensor& t : input) {
-          auto serialized_t = t.flat<tstring>();
-          absl::Span<const tstring> slice(serialized_t.data(),
-                                          serialized_t.size());
-          for (auto it = slice.begin(); it != slice.end(); it++)
-            slice_vec.push_back(*it);
+        if (input.size() == 1) {
+          serialized = absl::Span<const tstring>(
+              input[0].flat<tstring>().data(), input[0].NumElements());
+        } else {
+          int64_t num_examples = 0;
+          for (const Tensor& t : input) {
+            num_examples += t.NumElements();
+          }
+          slice_vec.reserve(num_examples);
+          for (const Tensor& t : input) {
+            const tstring* examples = t.flat<tstring>().data();
+            for (int64_t i = 0; i < t.NumElements(); ++i) {
+              slice_vec.emplace_back();
+              slice_vec.back().assign_as_view(examples[i]);
+            }
+          }
+          serialized = slice_vec;
         }
         example::FastParseExampleConfig config = dataset()->config_;
         // local copy of config_ for modification.
@@ -666,7 +746,7 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         }
         example::Result example_result;
         TF_RETURN_IF_ERROR(FastParseExample(
-            config, slice_vec, {}, device_threadpool, &example_result));
+            config, serialized, {}, device_threadpool, &example_result));
         (*output).resize(dataset()->key_to_output_index_.size());
         for (int d = 0; d < dataset()->dense_keys_.size(); ++d) {
           int output_index =
@@ -934,6 +1014,9 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
     const DeterminismPolicy deterministic_;
     const bool has_ragged_keys_;
     const int op_version_;
+    // If positive, the input elements are batched by this dataset.
+    const int64_t batch_size_;
+    const bool drop_remainder_;
   };
 
   const int graph_def_version_;
@@ -952,6 +1035,8 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
   std::vector<std::size_t> elements_per_stride_;
   bool has_ragged_keys_;
   const int op_version_;
+  int64_t batch_size_ = 0;
+  bool drop_remainder_ = false;
 };
 
 REGISTER_KERNEL_BUILDER(Name("ParseExampleDataset").Device(DEVICE_CPU),
@@ -15,31 +15,62 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <vector>
 
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/model.h"
 
 namespace tensorflow {
 namespace data {
+namespace {
+// Determines what strategy to use for increasing the buffer size limit. For
+// limits less than the threshold, an exponential increase is used, while for
+// limits greater than or equal to the threshold, a linear increase is used.
+size_t kBufferLimitThreshold = 2048;
+
+// The number of producer latencies the latency-aware mode keeps.
+constexpr size_t kLatencyWindow = 128;
+// The number of latencies needed before they are used to size the buffer.
+constexpr size_t kMinLatencySamples = 16;
+// The number of consumptions between two tunings of the buffer.
+constexpr int64_t kTuningPeriod = 32;
+// The number of consecutive tunings that must find the buffer larger than
+// needed before it is shrunk.
+constexpr int64_t kOversizedTuningsBeforeShrink = 4;
+// The weight of a new sample in the moving average of the consumer period.
+constexpr double kConsumerPeriodDecay = 0.1;
+
+// Returns the `percentile`th percentile of `values`.
+int64_t Percentile(std::vector<int64_t> values, double percentile) {
+  const size_t index = std::min(
+      values.size() - 1, static_cast<size_t>(percentile / 100 * values.size()));
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+}  // namespace
 
 PrefetchAutotuner::PrefetchAutotuner(
     int64_t initial_buffer_size, int64_t buffer_size_min,
-    std::shared_ptr<model::RamBudgetManager> ram_budget_manager)
+    std::shared_ptr<model::RamBudgetManager> ram_budget_manager,
+    bool latency_aware)
     : buffer_limit_(initial_buffer_size),
+      min_buffer_limit_(std::max(int64_t{1}, buffer_size_min)),
       ram_budget_manager_(ram_budget_manager) {
   if (initial_buffer_size == model::kAutotune) {
-    mode_ = Mode::kUpswing;
-    buffer_limit_ = std::max(int64_t{1}, buffer_size_min);
+    mode_ = latency_aware ? Mode::kLatencyAware : Mode::kUpswing;
+    buffer_limit_ = min_buffer_limit_;
   }
 }
 
-namespace {
-// Determines what strategy to use for increasing the buffer size limit. For
-// limits less than the threshold, an exponential increase is used, while for
-// limits greater than or equal to the threshold, a linear increase is used.
-size_t kBufferLimitThreshold = 2048;
-}  // namespace
+PrefetchAutotuner::~PrefetchAutotuner() {
+  if (mode_ == Mode::kLatencyAware && ram_budget_manager_ &&
+      allocated_bytes_ > 0) {
+    ram_budget_manager_->RequestLegacyPrefetchBytes(-allocated_bytes_);
+  }
+}
 
 void PrefetchAutotuner::SetElementSize(int64_t element_size_bytes) {
   // Once we know the element size we can allocate the right number of bytes for
@@ -57,15 +88,31 @@ void PrefetchAutotuner::SetElementSize(int64_t element_size_bytes) {
         << "This already causes the autotune ram budget to be exceeded. To "
         << "stay within the ram budget, either increase the ram budget or "
         << "reduce element size";
+  } else {
+    allocated_bytes_ += element_size_bytes * buffer_limit_;
   }
 
   element_size_bytes_ = element_size_bytes;
 }
 
-void PrefetchAutotuner::RecordConsumption(size_t current_buffer_size) {
+void PrefetchAutotuner::RecordProduction(int64_t latency_us) {
+  if (mode_ != Mode::kLatencyAware) return;
+  if (producer_latencies_us_.size() < kLatencyWindow) {
+    producer_latencies_us_.push_back(latency_us);
+  } else {
+    producer_latencies_us_[next_latency_index_] = latency_us;
+    next_latency_index_ = (next_latency_index_ + 1) % kLatencyWindow;
+  }
+}
+
+void PrefetchAutotuner::RecordConsumption(size_t current_buffer_size,
+                                          int64_t now_us) {
   switch (mode_) {
     case Mode::kDisabled:
       return;
+    case Mode::kLatencyAware:
+      RecordLatencyAwareConsumption(current_buffer_size, now_us);
+      return;
     case Mode::kUpswing:
       if (static_cast<int64_t>(current_buffer_size) == buffer_limit_) {
         mode_ = Mode::kDownswing;
@@ -104,5 +151,97 @@ void PrefetchAutotuner::RecordConsumption(size_t current_buffer_size) {
   }
 }
 
+void PrefetchAutotuner::RecordLatencyAwareConsumption(
+    size_t current_buffer_size, int64_t now_us) {
+  if (current_buffer_size == 0) {
+    // The consumer is waiting for the producer. Only react once per wait.
+    if (!waiting_) {
+      waiting_ = true;
+      TuneFromLatencies(/*stalled=*/true);
+    }
+    return;
+  }
+  if (static_cast<int64_t>(current_buffer_size) >= buffer_limit_) {
+    filled_ = true;
+  }
+  // The time between consumptions reflects the consumer rate only if the
+  // consumer did not have to wait.
+  if (last_consumption_us_ >= 0 && !waiting_) {
+    const double period_us = now_us - last_consumption_us_;
+    consumer_period_us_ =
+        consumer_period_us_ == 0.0
+            ? period_us
+            : (1 - kConsumerPeriodDecay) * consumer_period_us_ +
+                  kConsumerPeriodDecay * period_us;
+  }
+  last_consumption_us_ = now_us;
+  waiting_ = false;
+  if (++consumptions_since_tuning_ >= kTuningPeriod) {
+    TuneFromLatencies(/*stalled=*/false);
+  }
+}
+
+void PrefetchAutotuner::TuneFromLatencies(bool stalled) {
+  consumptions_since_tuning_ = 0;
+  const bool filled = filled_;
+  filled_ = false;
+  if (!element_size_bytes_.has_value()) {
+    return;
+  }
+  if (producer_latencies_us_.size() < kMinLatencySamples ||
+      consumer_period_us_ <= 0.0) {
+    // Not enough data yet: grow like the default mode does.
+    if (stalled && filled) {
+      ResizeBuffer(buffer_limit_ * 2);
+    }
+    return;
+  }
+  const int64_t p50_us = Percentile(producer_latencies_us_, 50);
+  const int64_t p99_us = Percentile(producer_latencies_us_, 99);
+  // If the producer is slower than the consumer on average, the pipeline is
+  // throughput bound and a larger buffer would never fill.
+  if (p50_us >= consumer_period_us_) {
+    num_oversized_tunings_ = 0;
+    return;
+  }
+  int64_t target = std::max(
+      min_buffer_limit_,
+      static_cast<int64_t>(std::ceil(p99_us / consumer_period_us_)));
+  if (stalled && filled) {
+    // The latencies seen so far underestimate the tail.
+    target = std::max(target, buffer_limit_ + 1);
+  }
+  VLOG(3) << "Prefetch autotuner: producer p50 " << p50_us << "us, p99 "
+          << p99_us << "us, consumer period " << consumer_period_us_
+          << "us, buffer limit " << buffer_limit_ << ", target " << target;
+  if (target > buffer_limit_) {
+    num_oversized_tunings_ = 0;
+    // Only grow a buffer the producer manages to fill.
+    if (filled) {
+      ResizeBuffer(target);
+    }
+  } else if (target < buffer_limit_ && !stalled) {
+    if (++num_oversized_tunings_ >= kOversizedTuningsBeforeShrink) {
+      num_oversized_tunings_ = 0;
+      ResizeBuffer(std::max(target, buffer_limit_ / 2));
+    }
+  } else {
+    num_oversized_tunings_ = 0;
+  }
+}
+
+void PrefetchAutotuner::ResizeBuffer(int64_t new_limit) {
+  new_limit = std::max(new_limit, min_buffer_limit_);
+  const int64_t delta_bytes =
+      (new_limit - buffer_limit_) * element_size_bytes_.value_or(0);
+  if (ram_budget_manager_) {
+    if (!ram_budget_manager_->RequestLegacyPrefetchBytes(delta_bytes)) {
+      return;
+    }
+    allocated_bytes_ += delta_bytes;
+  }
+  buffer_limit_ = new_limit;
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -19,8 +19,10 @@ limitations under the License.
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -38,15 +40,24 @@ namespace data {
 // if the prefetching thread is able to successfully fill the buffer at its
 // current size.
 //
-// Note: in the current implementation, we never decrease the buffer_limit().
-// This should change in the future!
+// Note: by default, we never decrease the buffer_limit().
+//
+// If `latency_aware` is set, the buffer is instead sized from the observed
+// producer latencies and consumer rate: the buffer must hold enough elements
+// for the consumer to keep going while the producer takes its 99th percentile
+// latency to produce one. The buffer grows to that size when the consumer
+// catches up with the producer, and shrinks back towards it once it has been
+// larger than needed for a while. Memory for the buffer is requested from, and
+// returned to, the `RamBudgetManager`.
 //
 // PrefetchAutotuner is NOT thread safe.
 class PrefetchAutotuner {
  public:
   explicit PrefetchAutotuner(
       int64_t initial_buffer_size, int64_t buffer_size_min,
-      std::shared_ptr<model::RamBudgetManager> ram_budget_manager);
+      std::shared_ptr<model::RamBudgetManager> ram_budget_manager,
+      bool latency_aware = false);
+  ~PrefetchAutotuner();
 
   int64_t buffer_limit() const { return buffer_limit_; }
 
@@ -55,7 +66,14 @@ class PrefetchAutotuner {
   // Sets the element size to use for predicting memory usage. Element size must
   // be set before the autotuner can increase the buffer size.
   void SetElementSize(int64_t element_size_bytes);
-  void RecordConsumption(size_t current_buffer_size);
+  // Records that the producer took `latency_us` to produce an element. Only
+  // used if `latency_aware` is set.
+  void RecordProduction(int64_t latency_us);
+  void RecordConsumption(size_t current_buffer_size) {
+    RecordConsumption(current_buffer_size, EnvTime::NowMicros());
+  }
+  // Records a consumption that happened at `now_us`.
+  void RecordConsumption(size_t current_buffer_size, int64_t now_us);
   void RecordEmpty() { RecordConsumption(0); }
 
  private:
@@ -71,13 +89,45 @@ class PrefetchAutotuner {
     // We have successfully filled a buffer of this size. If we ever block the
     // downstream iterator, we should increase the buffer size.
     kDownswing,
+
+    // The buffer is sized from the producer latencies and consumer rate.
+    kLatencyAware,
   };
 
+  void RecordLatencyAwareConsumption(size_t current_buffer_size,
+                                     int64_t now_us);
+  // Recomputes the buffer limit from the recorded latencies. `stalled` is set
+  // if the consumer found the buffer empty.
+  void TuneFromLatencies(bool stalled);
+  // Changes the buffer limit to `new_limit` if the RAM budget allows it.
+  void ResizeBuffer(int64_t new_limit);
+
   int64_t buffer_limit_;
+  const int64_t min_buffer_limit_;
   // Estimated per-element size.
   std::optional<int64_t> element_size_bytes_;
   Mode mode_ = Mode::kDisabled;
   std::shared_ptr<model::RamBudgetManager> ram_budget_manager_;
+
+  // State of the `kLatencyAware` mode.
+  //
+  // The most recent producer latencies, used as a ring buffer.
+  std::vector<int64_t> producer_latencies_us_;
+  size_t next_latency_index_ = 0;
+  // Moving average of the time between consumptions that did not wait.
+  double consumer_period_us_ = 0.0;
+  int64_t last_consumption_us_ = -1;
+  // Whether the consumer has found the buffer empty since its last
+  // consumption.
+  bool waiting_ = false;
+  // Whether the buffer has been full since the last tuning.
+  bool filled_ = false;
+  int64_t consumptions_since_tuning_ = 0;
+  // The number of consecutive tunings that found the buffer larger than
+  // needed.
+  int64_t num_oversized_tunings_ = 0;
+  // The bytes requested from `ram_budget_manager_`.
+  int64_t allocated_bytes_ = 0;
 };
 
 }  // namespace data
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/framework/model.h"
@@ -158,6 +160,102 @@ TEST(PrefetchAutotuner, RespectRamManagerWhenThereIsModelAllocation) {
   EXPECT_EQ(16, t.buffer_limit());
 }
 
+// Records `num_latencies` producer latencies of `latency_us`, with every
+// `tail_period`th one `tail_latency_us` instead.
+void RecordLatencies(PrefetchAutotuner& t, int num_latencies,
+                     int64_t latency_us, int tail_period = 0,
+                     int64_t tail_latency_us = 0) {
+  for (int i = 0; i < num_latencies; ++i) {
+    t.RecordProduction(tail_period > 0 && i % tail_period == 0
+                           ? tail_latency_us
+                           : latency_us);
+  }
+}
+
+// Records `num_consumptions` consumptions from a full buffer, `period_us`
+// apart, starting at `*now_us`.
+void ConsumeFromFullBuffer(PrefetchAutotuner& t, int num_consumptions,
+                           int64_t period_us, int64_t* now_us) {
+  for (int i = 0; i < num_consumptions; ++i) {
+    *now_us += period_us;
+    t.RecordConsumption(t.buffer_limit(), *now_us);
+  }
+}
+
+TEST(PrefetchAutotuner, LatencyAwareCoversTailLatency) {
+  auto ram_manager = std::make_shared<model::RamBudgetManager>(/*budget=*/1000);
+  PrefetchAutotuner t(model::kAutotune, 0, ram_manager,
+                      /*latency_aware=*/true);
+  t.SetElementSize(10);
+  EXPECT_EQ(1, t.buffer_limit());
+  // The producer usually takes 10us, but 1000us for one element in 32. The
+  // consumer takes an element every 100us, so the buffer must hold 10.
+  RecordLatencies(t, 128, 10, /*tail_period=*/32, /*tail_latency_us=*/1000);
+  int64_t now_us = 0;
+  ConsumeFromFullBuffer(t, 32, 100, &now_us);
+  EXPECT_EQ(10, t.buffer_limit());
+  EXPECT_EQ(900, ram_manager->AvailableModelRam());
+  ConsumeFromFullBuffer(t, 64, 100, &now_us);
+  EXPECT_EQ(10, t.buffer_limit());
+}
+
+TEST(PrefetchAutotuner, LatencyAwareShrinksWhenSteady) {
+  auto ram_manager = std::make_shared<model::RamBudgetManager>(/*budget=*/1000);
+  PrefetchAutotuner t(model::kAutotune, 2, ram_manager,
+                      /*latency_aware=*/true);
+  t.SetElementSize(10);
+  RecordLatencies(t, 128, 10, /*tail_period=*/32, /*tail_latency_us=*/1600);
+  int64_t now_us = 0;
+  ConsumeFromFullBuffer(t, 32, 100, &now_us);
+  EXPECT_EQ(16, t.buffer_limit());
+  // The tail latency goes away. The buffer halves after four tunings, down to
+  // the minimum buffer size.
+  RecordLatencies(t, 128, 10);
+  ConsumeFromFullBuffer(t, 3 * 32, 100, &now_us);
+  EXPECT_EQ(16, t.buffer_limit());
+  ConsumeFromFullBuffer(t, 32, 100, &now_us);
+  EXPECT_EQ(8, t.buffer_limit());
+  ConsumeFromFullBuffer(t, 8 * 32, 100, &now_us);
+  EXPECT_EQ(2, t.buffer_limit());
+  EXPECT_EQ(980, ram_manager->AvailableModelRam());
+}
+
+TEST(PrefetchAutotuner, LatencyAwareThroughputBound) {
+  auto ram_manager = std::make_shared<model::RamBudgetManager>(/*budget=*/1000);
+  PrefetchAutotuner t(model::kAutotune, 0, ram_manager,
+                      /*latency_aware=*/true);
+  t.SetElementSize(10);
+  // The producer is slower than the consumer: prefetching more cannot help.
+  RecordLatencies(t, 128, 200, /*tail_period=*/32, /*tail_latency_us=*/2000);
+  int64_t now_us = 0;
+  ConsumeFromFullBuffer(t, 2, 100, &now_us);
+  for (int i = 0; i < 64; ++i) {
+    now_us += 100;
+    t.RecordConsumption(1, now_us);
+    t.RecordEmpty();
+    now_us += 100;
+    t.RecordConsumption(1, now_us);
+  }
+  EXPECT_EQ(1, t.buffer_limit());
+}
+
+TEST(PrefetchAutotuner, LatencyAwareRespectRamManager) {
+  auto ram_manager = std::make_shared<model::RamBudgetManager>(/*budget=*/50);
+  {
+    PrefetchAutotuner t(model::kAutotune, 0, ram_manager,
+                        /*latency_aware=*/true);
+    t.SetElementSize(10);
+    RecordLatencies(t, 128, 10, /*tail_period=*/32, /*tail_latency_us=*/1000);
+    int64_t now_us = 0;
+    ConsumeFromFullBuffer(t, 32, 100, &now_us);
+    // A buffer of 10 elements does not fit in the budget.
+    EXPECT_EQ(1, t.buffer_limit());
+    EXPECT_EQ(40, ram_manager->AvailableModelRam());
+  }
+  // The memory is returned when the autotuner is destroyed.
+  EXPECT_EQ(50, ram_manager->AvailableModelRam());
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
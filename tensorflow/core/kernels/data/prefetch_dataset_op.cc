@@ -64,6 +64,8 @@ constexpr char kStatus[] = "status";
 constexpr char kSizeSuffix[] = ".size";
 constexpr char kCodeSuffix[] = ".code";
 constexpr char kErrorMessageSuffix[] = ".error_message";
+// Sizes legacy-autotuned buffers from the producer latencies and consumer rate.
+constexpr char kLatencyAwarePrefetchExperiment[] = "latency_aware_prefetch";
 
 }  // namespace
 
@@ -179,7 +181,9 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       mutex_lock l(*mu_);
       auto_tuner_ = std::make_unique<PrefetchAutotuner>(
           dataset()->buffer_size_, dataset()->buffer_size_min_,
-          ctx->ram_budget_manager());
+          ctx->ram_budget_manager(),
+          /*latency_aware=*/legacy_autotune_ &&
+              GetExperiments().contains(kLatencyAwarePrefetchExperiment));
       interleave_depth_ = ctx->interleave_depth();
 
       if (buffer_size_->value == model::kAutotune) {
@@ -551,6 +555,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         mutex_lock input_l(input_mu_);
         bool end_of_sequence = false;
         BufferElement buffer_element(ctx.get());
+        const int64_t start_us = EnvTime::NowMicros();
         {
           tsl::profiler::TraceMe traceme(
               [&] {
@@ -574,6 +579,10 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           mutex_lock l(*mu_);
           RecordBufferEnqueue(ctx.get(), buffer_element.value);
           buffer_element.created_us = EnvTime::NowMicros();
+          if (legacy_autotune_) {
+            auto_tuner_->RecordProduction(buffer_element.created_us -
+                                          start_us);
+          }
           buffer_.push_back(std::move(buffer_element));
           cond_var_->notify_all();
         }
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <deque>
 #include <memory>
@@ -28,7 +29,9 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/data/shuffle_buffer.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -39,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/lib/random/random_distributions.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -81,6 +85,17 @@ constexpr char kShuffleDatasetV3[] = "ShuffleDatasetV3";
 constexpr char kShuffleAndRepeatDatasetV1[] = "ShuffleAndRepeatDataset";
 constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
 
+// Experiments that store the shuffle buffer in a `CompactShuffleBuffer`,
+// optionally compressing its elements.
+constexpr char kCompactShuffleBufferExperiment[] = "compact_shuffle_buffer";
+constexpr char kCompressedShuffleBufferExperiment[] =
+    "compressed_shuffle_buffer";
+// The directory a compact shuffle buffer spills to, if set.
+constexpr char kShuffleSpillDirEnvVar[] = "TF_DATA_SHUFFLE_SPILL_DIR";
+// The fraction of the memory available to the model that a compact shuffle
+// buffer may use before spilling.
+constexpr double kMaxShuffleBufferRamFraction = 0.5;
+
 ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx) {}
 
@@ -190,12 +205,11 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         : DatasetIterator<ShuffleDatasetBase>(params),
           seed_generator_(seed_generator),
           parent_generator_(seed_generator->seed(), seed_generator->seed2()),
-          generator_(&parent_generator_) {
-      if (params.dataset->buffer_size_ == kUnknownCardinality) {
-        buffer_ = std::make_unique<std::vector<std::vector<Tensor>>>();
-      } else {
-        buffer_ = std::make_unique<std::vector<std::vector<Tensor>>>(
-            params.dataset->buffer_size_);
+          generator_(&parent_generator_) {}
+
+    ~Iterator() override {
+      if (ram_budget_manager_) {
+        ram_budget_manager_->UpdateFixedBytes(-reported_ram_bytes_);
       }
     }
 
@@ -205,6 +219,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       mutex_lock l(mu_);
       seed_generator_->GenerateSeeds(&seed_, &seed2_);
       ResetRngs();
+      buffer_ = MakeBuffer(ctx, IsShuffleAll() ? 0 : dataset()->buffer_size_);
       // Initialize checkpoint_indices_ to the entire buffer.
       if (ctx->symbolic_checkpoint()) {
         for (int64_t i = 0; i < buffer_->size(); ++i) {
@@ -233,14 +248,14 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       int64_t offset =
           Random() % (slices_.front()->end - slices_.front()->start);
       int64_t index = (slices_.front()->start + offset) % buffer_->size();
-      *out_tensors = std::move(buffer_->at(index));
+      TF_RETURN_IF_ERROR(buffer_->Take(index, out_tensors));
       this->RecordBufferDequeue(ctx, *out_tensors);
-      std::swap(buffer_->at(index),
-                buffer_->at(slices_.front()->start % buffer_->size()));
+      buffer_->Swap(index, slices_.front()->start % buffer_->size());
       checkpoint_indices_.insert(index);
       checkpoint_indices_.insert(slices_.front()->start % buffer_->size());
       slices_.front()->start++;
       num_elements_--;
+      ReportRam();
       return absl::OkStatus();
     }
 
@@ -284,17 +299,22 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(prefix(), kNumElements, num_elements_));
       const std::string key_prefix = absl::StrCat(prefix(), kColon, "buffer");
+      auto get_element = [this](int64_t index, std::vector<Tensor>* element)
+                             TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+                               return buffer_->Get(index, element);
+                             };
       if (ctx->symbolic_checkpoint()) {
         // When symbolic checkpointing is turned on, `writer`
         // already contains checkpoint of the shuffle buffer created by the
         // previous invocation of this instance and the indices that need to be
         // updated are stored in `checkpoint_indices`.
-        TF_RETURN_IF_ERROR(UpdateCheckpointElements(
-            writer, key_prefix, *buffer_, checkpoint_indices_));
+        TF_RETURN_IF_ERROR(
+            UpdateCheckpointElements(writer, key_prefix, buffer_->size(),
+                                     get_element, checkpoint_indices_));
         checkpoint_indices_.clear();
       } else {
-        TF_RETURN_IF_ERROR(
-            WriteElementsToCheckpoint(writer, key_prefix, *buffer_));
+        TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+            writer, key_prefix, buffer_->size(), get_element));
       }
 
       TF_RETURN_IF_ERROR(
@@ -357,22 +377,26 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             reader->ReadScalar(this->prefix(), kSlicesSize, &temp));
         slices_size = static_cast<size_t>(temp);
       }
-      buffer_ = std::make_unique<std::vector<std::vector<Tensor>>>();
+      std::vector<std::vector<Tensor>> elements;
       TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
-          ctx, reader, absl::StrCat(prefix(), kColon, "buffer"),
-          buffer_.get()));
+          ctx, reader, absl::StrCat(prefix(), kColon, "buffer"), &elements));
       if (ctx->symbolic_checkpoint()) {
         DCHECK(checkpoint_indices_.empty());
-        for (size_t i = 0; i < buffer_->size(); ++i) {
+        for (size_t i = 0; i < elements.size(); ++i) {
           checkpoint_indices_.insert(i);
         }
       }
-      for (const auto& element : *buffer_) {
+      for (const auto& element : elements) {
         RecordBufferEnqueue(ctx, element);
       }
-      if (!IsShuffleAll()) {
-        buffer_->resize(dataset()->buffer_size_);
+      buffer_ = MakeBuffer(
+          ctx, IsShuffleAll() ? elements.size()
+                              : std::max<int64_t>(elements.size(),
+                                                  dataset()->buffer_size_));
+      for (size_t i = 0; i < elements.size(); ++i) {
+        TF_RETURN_IF_ERROR(buffer_->Set(i, std::move(elements[i])));
       }
+      ReportRam();
       slices_.clear();
       for (size_t i = 0; i < slices_size; ++i) {
         int64_t start;
@@ -439,6 +463,54 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       return dataset()->buffer_size_ == kUnknownCardinality;
     }
 
+    // Returns an empty buffer with `size` slots. Under the compact shuffle
+    // buffer experiments, the elements are stored serialized in a
+    // `CompactShuffleBuffer`, which spills to `TF_DATA_SHUFFLE_SPILL_DIR` (if
+    // set) once it uses a fraction of the memory available to the model.
+    std::unique_ptr<ShuffleBuffer> MakeBuffer(IteratorContext* ctx,
+                                              int64_t size)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const auto experiments = GetExperiments();
+      const bool compress =
+          experiments.contains(kCompressedShuffleBufferExperiment);
+      if (!compress && !experiments.contains(kCompactShuffleBufferExperiment)) {
+        return std::make_unique<VectorShuffleBuffer>(size);
+      }
+      CompactShuffleBuffer::Options options;
+      options.compress = compress;
+      Status s = ReadStringFromEnvVar(kShuffleSpillDirEnvVar, "",
+                                      &options.spill_directory);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to read " << kShuffleSpillDirEnvVar << ": "
+                     << s;
+      }
+      if (ctx->ram_budget_manager()) {
+        options.max_resident_bytes = static_cast<int64_t>(
+            kMaxShuffleBufferRamFraction *
+            ctx->ram_budget_manager()->AvailableModelRam());
+        if (!ram_budget_manager_) {
+          ram_budget_manager_ = ctx->ram_budget_manager();
+        }
+      }
+      VLOG(1) << "Using a compact shuffle buffer"
+              << (compress ? " with compression" : "") << ". Spill directory: "
+              << options.spill_directory;
+      return std::make_unique<CompactShuffleBuffer>(ctx->env(), options, size);
+    }
+
+    // Reports the memory used by `buffer_` to the RAM budget manager, so that
+    // the memory available for autotuning accounts for it.
+    void ReportRam() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!ram_budget_manager_) {
+        return;
+      }
+      const int64_t bytes = buffer_->ResidentBytes();
+      if (bytes != reported_ram_bytes_) {
+        ram_budget_manager_->UpdateFixedBytes(bytes - reported_ram_bytes_);
+        reported_ram_bytes_ = bytes;
+      }
+    }
+
     // Fills the shuffle buffer, preparing the buffer for sampling.
     Status FillBuffer(IteratorContext* ctx) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       int64_t start_micros = EnvTime::NowMicros();
@@ -463,7 +535,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           slices_.back()->reached_end_of_sequence = true;
         }
         if (!end_of_input_sequence) {
-          AddToShuffleBuffer(ctx, std::move(input_element));
+          TF_RETURN_IF_ERROR(AddToShuffleBuffer(ctx, std::move(input_element)));
           continue;
         }
         input_impl_.reset();
@@ -520,7 +592,8 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       return absl::OkStatus();
     }
 
-    void AddToShuffleBuffer(IteratorContext* ctx, std::vector<Tensor>&& element)
+    Status AddToShuffleBuffer(IteratorContext* ctx,
+                              std::vector<Tensor>&& element)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       data_produced_ = true;
       if (num_elements_ == 0) {
@@ -531,14 +604,15 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       if (num_elements_ == buffer_->size()) {
         DCHECK(IsShuffleAll());
         checkpoint_indices_.insert(buffer_->size());
-        buffer_->push_back(element);
+        TF_RETURN_IF_ERROR(buffer_->PushBack(std::move(element)));
       } else {
         size_t index = slices_.back()->end % buffer_->size();
         checkpoint_indices_.insert(index);
-        buffer_->at(index) = std::move(element);
+        TF_RETURN_IF_ERROR(buffer_->Set(index, std::move(element)));
       }
       num_elements_++;
       slices_.back()->end++;
+      return absl::OkStatus();
     }
 
     void ClearEmptySlices() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -558,8 +632,12 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
 
     mutex mu_;
     SeedGenerator* const seed_generator_ TF_GUARDED_BY(mu_);  // Not owned.
-    std::unique_ptr<std::vector<std::vector<Tensor>>> buffer_
+    std::unique_ptr<ShuffleBuffer> buffer_ TF_GUARDED_BY(mu_);
+    // Set if `buffer_` reports its memory usage, which it does when it is a
+    // `CompactShuffleBuffer`.
+    std::shared_ptr<model::RamBudgetManager> ram_budget_manager_
         TF_GUARDED_BY(mu_);
+    int64_t reported_ram_bytes_ TF_GUARDED_BY(mu_) = 0;
     // Holds the indices of `buffer_` that have changed since the previous
     // `SaveInternal()` and need to be updated in the MemoryCheckpoint
     // (if symbolic checkpointing is used) in the next `SaveInternal()`.
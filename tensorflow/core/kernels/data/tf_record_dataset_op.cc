@@ -14,7 +14,20 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/global_shuffle_utils.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/tfrecord_index.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
@@ -25,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
@@ -45,6 +59,14 @@ constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
+// With the "tfrecord_readahead" experiment, each file is read with this many
+// blocks of this size in flight.
+constexpr int kReadaheadBlocks = 8;
+constexpr int64_t kReadaheadBlockSize = 1LL << 20;  // 1MB.
+constexpr char kReadaheadExperiment[] = "tfrecord_readahead";
+// With the "tfrecord_index" experiment, the dataset supports random access and
+// global shuffling if every file has an index, see tfrecord_index.h.
+constexpr char kIndexExperiment[] = "tfrecord_index";
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -54,21 +76,71 @@ bool is_cloud_tpu_gcs_fs() {
   return false;
 }
 
+// Reads the indexes of `filenames` into `record_offsets`. Returns
+// FailedPrecondition if the records of the files cannot be read by their
+// offsets.
+Status ReadTFRecordIndexes(Env* env, const std::vector<string>& filenames,
+                           const tstring& compression_type,
+                           const std::vector<int64_t>& byte_offsets,
+                           std::vector<std::vector<uint64_t>>* record_offsets) {
+  if (io::RecordReaderOptions::CreateRecordReaderOptions(compression_type)
+          .compression_type != io::RecordReaderOptions::NONE) {
+    return errors::FailedPrecondition(
+        "Compressed TFRecord files do not support random access.");
+  }
+  if (!byte_offsets.empty()) {
+    return errors::FailedPrecondition(
+        "TFRecord datasets with byte offsets do not support random access.");
+  }
+  record_offsets->resize(filenames.size());
+  for (size_t i = 0; i < filenames.size(); ++i) {
+    Status s = ReadTFRecordIndex(env, TranslateFileName(filenames[i]),
+                                 &(*record_offsets)[i]);
+    if (errors::IsNotFound(s)) {
+      record_offsets->clear();
+      return errors::FailedPrecondition(
+          "TFRecord file ", filenames[i],
+          " has no index, so it does not support random access.");
+    }
+    TF_RETURN_IF_ERROR(s);
+  }
+  return absl::OkStatus();
+}
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
                    const string& compression_type, int64_t buffer_size,
-                   std::vector<int64_t> byte_offsets, int op_version)
+                   std::vector<int64_t> byte_offsets, int op_version,
+                   std::vector<std::vector<uint64_t>> record_offsets,
+                   absl::Status random_indexing_compatible)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)),
         byte_offsets_(std::move(byte_offsets)),
-        op_version_(op_version) {
+        op_version_(op_version),
+        env_(ctx->env()),
+        record_offsets_(std::move(record_offsets)),
+        random_indexing_compatible_(std::move(random_indexing_compatible)) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
+    if (GetExperiments().contains(kReadaheadExperiment)) {
+      options_.readahead_blocks = kReadaheadBlocks;
+      options_.readahead_block_size = kReadaheadBlockSize;
+    }
+    int64_t num_records = 0;
+    for (const std::vector<uint64_t>& offsets : record_offsets_) {
+      num_records += offsets.size() - 1;
+      record_ends_.push_back(num_records);
+    }
+    files_.resize(record_offsets_.size());
+  }
+
+  absl::Status RandomIndexingCompatible() const override {
+    return random_indexing_compatible_;
   }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
@@ -102,6 +174,44 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   Status CheckExternalState() const override { return absl::OkStatus(); }
 
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (!random_indexing_compatible_.ok()) {
+      return kUnknownCardinality;
+    }
+    return record_ends_.empty() ? 0 : record_ends_.back();
+  }
+
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    return Get(AnyContext(ctx), index, out_tensors);
+  }
+
+  Status Get(AnyContext ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    const size_t file_index =
+        std::upper_bound(record_ends_.begin(), record_ends_.end(), index) -
+        record_ends_.begin();
+    const int64_t record_index =
+        file_index == 0 ? index : index - record_ends_[file_index - 1];
+    const uint64_t begin = record_offsets_[file_index][record_index];
+    const uint64_t end = record_offsets_[file_index][record_index + 1];
+    TF_ASSIGN_OR_RETURN(RandomAccessFile * file, GetFile(file_index));
+    out_tensors->clear();
+    out_tensors->emplace_back(ctx.allocator, DT_STRING, TensorShape({}));
+    tstring& record = out_tensors->back().scalar<tstring>()();
+    Status s = ReadIndexedTFRecord(file, begin, end, &record);
+    if (!s.ok()) {
+      return errors::CreateWithUpdatedMessage(
+          s, absl::StrCat("Failed to read TFRecord file ",
+                          filenames_[file_index], ": ", s.message()));
+    }
+    static monitoring::CounterCell* bytes_counter =
+        metrics::GetTFDataBytesReadCounter(kDatasetType);
+    bytes_counter->IncrementBy(record.size());
+    return absl::OkStatus();
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -123,13 +233,28 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
-        : DatasetIterator<Dataset>(params) {}
+        : DatasetIterator<Dataset>(params),
+          global_shuffle_iterator_(dataset()) {}
 
     bool SymbolicCheckpointCompatible() const override { return true; }
 
+    Status Initialize(IteratorContext* ctx) override {
+      if (dataset()->options_.readahead_blocks > 0) {
+        // The reads of a file block on storage, so they run on a dedicated
+        // pool rather than on the tf.data runner threads.
+        readahead_thread_pool_ = ctx->CreateThreadPool(
+            "tf_record_readahead", dataset()->options_.readahead_blocks);
+      }
+      return absl::OkStatus();
+    }
+
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
+      if (ctx->index_mapper() != nullptr) {
+        return global_shuffle_iterator_.GetNext(ctx, out_tensors,
+                                                end_of_sequence);
+      }
       out_tensors->reserve(1);
       mutex_lock l(mu_);
       do {
@@ -235,6 +360,9 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
     Status RestoreInternal(IteratorContext* ctx,
                            IteratorStateReader* reader) override {
+      if (ctx->restored_element_count().has_value()) {
+        return global_shuffle_iterator_.Restore(ctx);
+      }
       mutex_lock l(mu_);
       ResetStreamsLocked();
       int64_t current_file_index;
@@ -263,8 +391,10 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
           TranslateFileName(dataset()->filenames_[current_file_index_]),
           &file_));
-      reader_ = std::make_unique<io::SequentialRecordReader>(
-          file_.get(), dataset()->options_);
+      io::RecordReaderOptions options = dataset()->options_;
+      options.readahead_thread_pool = readahead_thread_pool_.get();
+      reader_ = std::make_unique<io::SequentialRecordReader>(file_.get(),
+                                                             options);
       if (!dataset()->byte_offsets_.empty()) {
         TF_RETURN_IF_ERROR(
             reader_->SeekOffset(dataset()->byte_offsets_[current_file_index_]));
@@ -281,17 +411,49 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
 
+    // Runs the reads of `reader_` if the dataset reads ahead. Declared before
+    // `reader_`, which waits for its outstanding reads when destroyed.
+    std::unique_ptr<thread::ThreadPool> readahead_thread_pool_;
+
     // `reader_` will borrow the object that `file_` points to, so
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+
+    GlobalShuffleIterator global_shuffle_iterator_;
   };
 
+  // Returns the file at `file_index` for random access, opening it on first
+  // use.
+  absl::StatusOr<RandomAccessFile*> GetFile(size_t file_index) const {
+    mutex_lock l(files_mu_);
+    std::unique_ptr<RandomAccessFile>& file = files_[file_index];
+    if (file == nullptr) {
+      TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+          TranslateFileName(filenames_[file_index]), &file));
+    }
+    return file.get();
+  }
+
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
   const std::vector<int64_t> byte_offsets_;
   const int op_version_;
+  Env* const env_;
+
+  // The record offsets of each file followed by its size, if the dataset
+  // supports random access.
+  const std::vector<std::vector<uint64_t>> record_offsets_;
+  const absl::Status random_indexing_compatible_;
+  // The number of records in the files up to and including each file.
+  std::vector<int64_t> record_ends_;
+
+  // The files opened for random access. `RandomAccessFile` is safe for
+  // concurrent reads.
+  mutable mutex files_mu_;
+  mutable std::vector<std::unique_ptr<RandomAccessFile>> files_
+      TF_GUARDED_BY(files_mu_);
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
@@ -361,8 +523,26 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
+  std::vector<std::vector<uint64_t>> record_offsets;
+  absl::Status random_indexing_compatible = errors::FailedPrecondition(
+      "TFRecord datasets only support random access with the \"",
+      kIndexExperiment, "\" experiment.");
+  if (GetExperiments().contains(kIndexExperiment)) {
+    random_indexing_compatible =
+        ReadTFRecordIndexes(ctx->env(), filenames, compression_type,
+                            byte_offsets, &record_offsets);
+    // Indexes that do not match their files fail the dataset rather than
+    // silently disabling random access.
+    OP_REQUIRES(ctx,
+                random_indexing_compatible.ok() ||
+                    errors::IsFailedPrecondition(random_indexing_compatible),
+                random_indexing_compatible);
+  }
+
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        buffer_size, std::move(byte_offsets), op_version_);
+                        buffer_size, std::move(byte_offsets), op_version_,
+                        std::move(record_offsets),
+                        std::move(random_indexing_compatible));
 }
 
 namespace {
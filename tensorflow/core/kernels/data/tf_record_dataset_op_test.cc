@@ -15,6 +15,8 @@ limitations under the License.
 #include <string>
 
 #include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/tfrecord_index.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
@@ -87,6 +89,8 @@ class TFRecordDatasetParams : public DatasetParams {
     return TFRecordDatasetOp::kDatasetType;
   }
 
+  const std::vector<tstring>& filenames() const { return filenames_; }
+
  private:
   std::vector<tstring> filenames_;
   CompressionType compression_type_;
@@ -333,6 +337,53 @@ TEST_F(TFRecordDatasetOpTest, InvalidByteOffsetsToSeek) {
       absl::StatusCode::kDataLoss);
 }
 
+TEST_F(TFRecordDatasetOpTest, RandomAccessWithIndex) {
+  setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+  setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+  setenv("TF_DATA_EXPERIMENT_OPT_IN", "tfrecord_index", /*overwrite=*/1);
+  auto dataset_params = TFRecordDatasetParams3();
+  for (const tstring& filename : dataset_params.filenames()) {
+    TF_ASSERT_OK(CreateTFRecordIndex(Env::Default(), filename));
+  }
+  TF_ASSERT_OK(Initialize(dataset_params));
+  if (GetExperiments().contains("tfrecord_index")) {
+    TF_EXPECT_OK(dataset_->RandomIndexingCompatible());
+    TF_ASSERT_OK(CheckDatasetCardinality(6));
+    const std::vector<tstring> expected = {"1", "22", "333", "a", "bb", "ccc"};
+    for (int64_t i : {4, 0, 5, 2, 3, 1}) {
+      std::vector<Tensor> out_tensors;
+      TF_ASSERT_OK(
+          dataset_->Get(AnyContext(iterator_ctx_.get()), i, &out_tensors));
+      ASSERT_EQ(out_tensors.size(), 1);
+      EXPECT_EQ(out_tensors[0].scalar<tstring>()(), expected[i]);
+    }
+    std::vector<Tensor> out_tensors;
+    EXPECT_EQ(
+        dataset_->Get(AnyContext(iterator_ctx_.get()), 6, &out_tensors).code(),
+        absl::StatusCode::kOutOfRange);
+  }
+  for (const tstring& filename : dataset_params.filenames()) {
+    TF_ASSERT_OK(Env::Default()->DeleteFile(TFRecordIndexFilename(filename)));
+  }
+  unsetenv("TF_JOB_NAME");
+  unsetenv("TF_TASK_ID");
+  unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+}
+
+TEST_F(TFRecordDatasetOpTest, NoRandomAccessWithoutIndex) {
+  setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+  setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+  setenv("TF_DATA_EXPERIMENT_OPT_IN", "tfrecord_index", /*overwrite=*/1);
+  auto dataset_params = TFRecordDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  EXPECT_EQ(dataset_->RandomIndexingCompatible().code(),
+            absl::StatusCode::kFailedPrecondition);
+  TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
+  unsetenv("TF_JOB_NAME");
+  unsetenv("TF_TASK_ID");
+  unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<TFRecordDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {
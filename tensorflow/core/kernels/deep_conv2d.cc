@@ -20,6 +20,8 @@ limitations under the License.
 
 #include <stdlib.h>
 
+#include <memory>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/winograd_transform.h"
 #include "tensorflow/core/util/work_sharder.h"
@@ -91,10 +93,37 @@ static bool ReadBoolFromEnvVar(const char* env_var_name, bool default_val) {
   return default_val;
 }
 
+// Returns the cost of DeepConv2D with 'transform'.
+template <typename T>
+static int64_t GetDeepConvCost(const DeepConv2DTransform<T>& transform,
+                               int in_depth, int out_depth, int out_rows,
+                               int out_cols) {
+  return GetDeepConvCost(
+      transform.input_shape().rows, transform.input_shape().cols,
+      transform.output_shape().rows, transform.output_shape().cols, in_depth,
+      out_depth, out_rows, out_cols);
+}
+
+// Returns the transform of DeepConv2D with the lowest cost for 'args'.
+// Larger output tiles take fewer multiplications per output, but have more
+// expensive transforms, and waste more outputs at the image boundaries.
+template <typename T>
+static std::unique_ptr<DeepConv2DTransform<T>> NewDeepConv2DTransform(
+    int in_depth, int out_depth, int out_rows, int out_cols) {
+  std::unique_ptr<DeepConv2DTransform<T>> transform(new WinogradTransform<T>);
+  std::unique_ptr<DeepConv2DTransform<T>> transform_4x4(
+      new Winograd4x4Transform<T>);
+  if (GetDeepConvCost(*transform_4x4, in_depth, out_depth, out_rows,
+                      out_cols) <
+      GetDeepConvCost(*transform, in_depth, out_depth, out_rows, out_cols)) {
+    return transform_4x4;
+  }
+  return transform;
+}
+
 // Returns true if convolution can be computed efficiently by DeepConv2D,
 // returns false otherwise.
 // TODO(andydavis) Add support for other filter sizes and strides.
-// TODO(andydavis) Add support for autotuning.
 bool CanUseDeepConv2D(int stride_rows, int stride_cols, int filter_rows,
                       int filter_cols, int in_depth, int out_depth,
                       int out_rows, int out_cols) {
@@ -112,10 +141,9 @@ bool CanUseDeepConv2D(int stride_rows, int stride_cols, int filter_rows,
   }
 
   // Check if flop cost of deep convolution is less than direct convolution.
-  WinogradTransform<float> t;
   const int64_t deep_conv_cost = GetDeepConvCost(
-      t.input_shape().rows, t.input_shape().cols, t.output_shape().rows,
-      t.output_shape().cols, in_depth, out_depth, out_rows, out_cols);
+      *NewDeepConv2DTransform<float>(in_depth, out_depth, out_rows, out_cols),
+      in_depth, out_depth, out_rows, out_cols);
   const int64_t direct_conv_cost = GetDirectConvCost(
       filter_rows, filter_cols, in_depth, out_depth, out_rows, out_cols);
 
@@ -951,8 +979,9 @@ template <typename T>
 struct DeepConv2D<CPUDevice, T> {
   void operator()(OpKernelContext* ctx, const Conv2DArgs& args, const T* input,
                   const T* filter, T* output) {
-    // TODO(andydavis) Add function to select transform based on conv params.
-    std::unique_ptr<DeepConv2DTransform<T>> transform(new WinogradTransform<T>);
+    std::unique_ptr<DeepConv2DTransform<T>> transform =
+        NewDeepConv2DTransform<T>(args.in_depth, args.out_depth, args.out_rows,
+                                  args.out_cols);
 
     const int64_t in_depth = args.in_depth;
     const int64_t out_depth = args.out_depth;
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/kernels/winograd_transform.h"
+
+#include <vector>
+
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -155,5 +158,62 @@ TEST(DeepConv2DTransformTest, WingradOutputTransformMatrix) {
   }
 }
 
+// Checks that 'transform' computes the correlation of an input tile with a
+// 3x3 filter: y = C[Ad * Bg].
+static void ExpectTransformComputesCorrelation(
+    const DeepConv2DTransform<float>& transform) {
+  const int tile_rows = transform.input_shape().rows;
+  const int tile_size = tile_rows * transform.input_shape().cols;
+  const int out_tile_rows = transform.output_shape().rows;
+  const int out_tile_size = out_tile_rows * transform.output_shape().cols;
+
+  std::vector<float> filter_transform(tile_size * 9);
+  std::vector<float> input_transform(tile_size * tile_size);
+  std::vector<float> output_transform(out_tile_size * tile_size);
+  transform.GetFilterTransformMatrix(tile_size, 9, filter_transform.data());
+  transform.GetInputTransformMatrix(tile_size, tile_size,
+                                    input_transform.data());
+  transform.GetOutputTransformMatrix(out_tile_size, tile_size,
+                                     output_transform.data());
+
+  std::vector<float> d(tile_size);
+  for (int i = 0; i < tile_size; ++i) d[i] = (i * 7 % 11) / 11.0f - 0.5f;
+  const float g[9] = {0.5f, -1.0f, 0.25f, 2.0f, 1.0f, -0.5f, 0.0f, 1.5f, -2.0f};
+
+  std::vector<float> product(tile_size);
+  for (int i = 0; i < tile_size; ++i) {
+    float ad = 0;
+    for (int j = 0; j < tile_size; ++j) {
+      ad += input_transform[i * tile_size + j] * d[j];
+    }
+    float bg = 0;
+    for (int j = 0; j < 9; ++j) bg += filter_transform[i * 9 + j] * g[j];
+    product[i] = ad * bg;
+  }
+  for (int o = 0; o < out_tile_size; ++o) {
+    float y = 0;
+    for (int i = 0; i < tile_size; ++i) {
+      y += output_transform[o * tile_size + i] * product[i];
+    }
+    const int r = o / out_tile_rows;
+    const int c = o % out_tile_rows;
+    float expected = 0;
+    for (int fr = 0; fr < 3; ++fr) {
+      for (int fc = 0; fc < 3; ++fc) {
+        expected += d[(r + fr) * tile_rows + c + fc] * g[fr * 3 + fc];
+      }
+    }
+    EXPECT_NEAR(expected, y, 1e-4);
+  }
+}
+
+TEST(DeepConv2DTransformTest, WinogradComputesCorrelation) {
+  ExpectTransformComputesCorrelation(WinogradTransform<float>());
+}
+
+TEST(DeepConv2DTransformTest, Winograd4x4ComputesCorrelation) {
+  ExpectTransformComputesCorrelation(Winograd4x4Transform<float>());
+}
+
 }  // namespace
 }  // namespace tensorflow
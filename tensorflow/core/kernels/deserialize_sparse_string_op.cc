@@ -219,7 +219,7 @@ class DeserializeSparseOp : public OpKernel {
       return errors::InvalidArgument("Could not parse serialized proto");
     }
     Tensor tensor;
-    if (!tensor.FromProto(proto)) {
+    if (!tensor.FromProto(std::move(proto))) {
       return errors::InvalidArgument("Could not construct tensor from proto");
     }
     *result = tensor;
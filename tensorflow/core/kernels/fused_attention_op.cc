@@ -0,0 +1,340 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/fused_attention_op.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace functor {
+
+// Computes Softmax(scale * query * key^T + bias) * value without
+// materializing the [num_queries, num_keys] score matrix.
+//
+// The queries of a batch are processed in blocks of kQueryBlockSize rows, and
+// the keys and values in blocks of kKeyBlockSize rows, so that a block of keys
+// and values stays in cache while it is used by all the queries of a block.
+// The softmax is computed online: every query keeps the running maximum of its
+// scores, the running sum of their exponentials, and the running weighted sum
+// of the values, which are rescaled whenever the maximum increases.
+template <typename T>
+struct FusedAttention<CPUDevice, T> {
+  static constexpr int64_t kQueryBlockSize = 16;
+  static constexpr int64_t kKeyBlockSize = 64;
+
+  Status operator()(OpKernelContext* context,
+                    const FusedAttentionParams& params, const T* query_data,
+                    const T* key_data, const T* value_data, const T* bias_data,
+                    T* output_data) {
+    const int64_t num_queries = params.num_queries;
+    const int64_t num_keys = params.num_keys;
+    const int64_t depth = params.depth;
+    const int64_t value_depth = params.value_depth;
+    const float scale = params.scale;
+    const bool causal = params.causal;
+    const FusedAttentionBiasLayout bias_layout = params.bias_layout;
+    const int64_t num_query_blocks =
+        (num_queries + kQueryBlockSize - 1) / kQueryBlockSize;
+
+    auto attend = [=](int64_t start, int64_t limit) {
+      std::vector<float> scores(kQueryBlockSize * kKeyBlockSize);
+      std::vector<float> max_score(kQueryBlockSize);
+      std::vector<float> sum_exp(kQueryBlockSize);
+      std::vector<float> accumulator(kQueryBlockSize * value_depth);
+      for (int64_t unit = start; unit < limit; ++unit) {
+        const int64_t batch = unit / num_query_blocks;
+        const int64_t first_query = (unit % num_query_blocks) * kQueryBlockSize;
+        const int64_t block_queries =
+            std::min(kQueryBlockSize, num_queries - first_query);
+        const T* queries =
+            query_data + (batch * num_queries + first_query) * depth;
+        const T* keys = key_data + batch * num_keys * depth;
+        const T* values = value_data + batch * num_keys * value_depth;
+        const T* biases =
+            bias_data == nullptr
+                ? nullptr
+                : bias_data + bias_layout.BatchOffset(batch) +
+                      first_query * bias_layout.query_stride;
+        std::fill(max_score.begin(), max_score.end(),
+                  -std::numeric_limits<float>::infinity());
+        std::fill(sum_exp.begin(), sum_exp.end(), 0.0f);
+        std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+
+        // With a causal mask, no query of the block attends to the keys after
+        // its last query.
+        const int64_t key_limit =
+            causal ? std::min(num_keys, first_query + block_queries)
+                   : num_keys;
+        for (int64_t first_key = 0; first_key < key_limit;
+             first_key += kKeyBlockSize) {
+          const int64_t block_keys =
+              std::min(kKeyBlockSize, key_limit - first_key);
+          for (int64_t q = 0; q < block_queries; ++q) {
+            const T* query_row = queries + q * depth;
+            float* score_row = scores.data() + q * kKeyBlockSize;
+            float block_max = -std::numeric_limits<float>::infinity();
+            for (int64_t k = 0; k < block_keys; ++k) {
+              if (causal && first_key + k > first_query + q) {
+                score_row[k] = -std::numeric_limits<float>::infinity();
+                continue;
+              }
+              const T* key_row = keys + (first_key + k) * depth;
+              float dot = 0;
+              for (int64_t d = 0; d < depth; ++d) {
+                dot += query_row[d] * key_row[d];
+              }
+              score_row[k] = dot * scale;
+              if (biases != nullptr) {
+                score_row[k] += static_cast<float>(
+                    biases[q * bias_layout.query_stride +
+                           (first_key + k) * bias_layout.key_stride]);
+              }
+              block_max = std::max(block_max, score_row[k]);
+            }
+
+            // Rescale what was accumulated for the previous blocks to the new
+            // maximum score. Nothing is accumulated while all the scores so
+            // far are masked.
+            const float new_max = std::max(max_score[q], block_max);
+            if (new_max == -std::numeric_limits<float>::infinity()) continue;
+            const float correction = std::exp(max_score[q] - new_max);
+            max_score[q] = new_max;
+            sum_exp[q] *= correction;
+            float* accumulator_row = accumulator.data() + q * value_depth;
+            for (int64_t d = 0; d < value_depth; ++d) {
+              accumulator_row[d] *= correction;
+            }
+            for (int64_t k = 0; k < block_keys; ++k) {
+              const float weight = std::exp(score_row[k] - new_max);
+              sum_exp[q] += weight;
+              const T* value_row = values + (first_key + k) * value_depth;
+              for (int64_t d = 0; d < value_depth; ++d) {
+                accumulator_row[d] += weight * value_row[d];
+              }
+            }
+          }
+        }
+
+        T* outputs =
+            output_data + (batch * num_queries + first_query) * value_depth;
+        for (int64_t q = 0; q < block_queries; ++q) {
+          const float inv_sum = 1.0f / sum_exp[q];
+          const float* accumulator_row = accumulator.data() + q * value_depth;
+          for (int64_t d = 0; d < value_depth; ++d) {
+            outputs[q * value_depth + d] =
+                static_cast<T>(accumulator_row[d] * inv_sum);
+          }
+        }
+      }
+    };
+
+    const int64_t cost_per_unit =
+        kQueryBlockSize * num_keys * (2 * depth + 2 * value_depth + 20);
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          params.batch_size * num_query_blocks, cost_per_unit, attend);
+    return absl::OkStatus();
+  }
+};
+
+}  // namespace functor
+
+template <typename Device, typename T>
+class FusedAttentionOp : public OpKernel {
+ public:
+  explicit FusedAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale_));
+    OP_REQUIRES_OK(context, context->GetAttr("causal", &causal_));
+    int num_bias;
+    OP_REQUIRES_OK(context, context->GetAttr("num_bias", &num_bias));
+    OP_REQUIRES(context, num_bias <= 1,
+                errors::InvalidArgument("num_bias must be 0 or 1 but is ",
+                                        num_bias));
+    has_bias_ = num_bias == 1;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+    OP_REQUIRES(context, query.dims() >= 2,
+                errors::InvalidArgument("query must be at least rank 2 but is ",
+                                        query.shape().DebugString()));
+    const int rank = query.dims();
+    OP_REQUIRES(
+        context, key.dims() == rank && value.dims() == rank,
+        errors::InvalidArgument("query, key and value must have the same rank "
+                                "but have shapes ",
+                                query.shape().DebugString(), ", ",
+                                key.shape().DebugString(), " and ",
+                                value.shape().DebugString()));
+    for (int i = 0; i < rank - 2; ++i) {
+      OP_REQUIRES(context,
+                  query.dim_size(i) == key.dim_size(i) &&
+                      query.dim_size(i) == value.dim_size(i),
+                  errors::InvalidArgument(
+                      "query, key and value must have the same batch "
+                      "dimensions but have shapes ",
+                      query.shape().DebugString(), ", ",
+                      key.shape().DebugString(), " and ",
+                      value.shape().DebugString()));
+    }
+    FusedAttentionParams params;
+    params.num_queries = query.dim_size(rank - 2);
+    params.depth = query.dim_size(rank - 1);
+    params.num_keys = key.dim_size(rank - 2);
+    params.value_depth = value.dim_size(rank - 1);
+    params.scale = scale_;
+    params.causal = causal_;
+    OP_REQUIRES(context,
+                key.dim_size(rank - 1) == params.depth &&
+                    value.dim_size(rank - 2) == params.num_keys,
+                errors::InvalidArgument(
+                    "Incompatible shapes for attention: query ",
+                    query.shape().DebugString(), ", key ",
+                    key.shape().DebugString(), ", value ",
+                    value.shape().DebugString()));
+
+    const T* bias_data = nullptr;
+    if (has_bias_) {
+      const Tensor& bias = context->input(3);
+      OP_REQUIRES_OK(context, GetBiasLayout(query.shape(), params.num_keys,
+                                            bias.shape(),
+                                            &params.bias_layout));
+      bias_data = bias.flat<T>().data();
+    }
+
+    TensorShape output_shape = query.shape();
+    output_shape.set_dim(rank - 1, params.value_depth);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+    if (params.num_keys == 0 && std::is_same<Device, CPUDevice>::value) {
+      // The softmax of an empty row is empty, and so is the weighted sum.
+      output->flat<T>().setZero();
+      return;
+    }
+
+    params.batch_size =
+        output->NumElements() / (params.num_queries * params.value_depth);
+    OP_REQUIRES_OK(context,
+                   functor::FusedAttention<Device, T>()(
+                       context, params, query.flat<T>().data(),
+                       key.flat<T>().data(), value.flat<T>().data(), bias_data,
+                       output->flat<T>().data()));
+  }
+
+ private:
+  // The bias must have the rank of the scores, and every one of its
+  // dimensions must either match the scores or be 1 to broadcast.
+  static Status GetBiasLayout(const TensorShape& query_shape,
+                              int64_t num_keys, const TensorShape& bias_shape,
+                              FusedAttentionBiasLayout* layout) {
+    const int rank = query_shape.dims();
+    TensorShape scores_shape = query_shape;
+    scores_shape.set_dim(rank - 1, num_keys);
+    if (bias_shape.dims() != rank ||
+        rank - 2 > FusedAttentionBiasLayout::kMaxBatchDims) {
+      return errors::InvalidArgument(
+          "bias must have the rank of the scores ", scores_shape.DebugString(),
+          " and at most ", FusedAttentionBiasLayout::kMaxBatchDims,
+          " batch dimensions but is ", bias_shape.DebugString());
+    }
+    int64_t strides[TensorShape::MaxDimensions()];
+    int64_t stride = 1;
+    for (int i = rank - 1; i >= 0; --i) {
+      if (bias_shape.dim_size(i) != scores_shape.dim_size(i) &&
+          bias_shape.dim_size(i) != 1) {
+        return errors::InvalidArgument(
+            "bias of shape ", bias_shape.DebugString(),
+            " does not broadcast to the scores of shape ",
+            scores_shape.DebugString());
+      }
+      strides[i] = bias_shape.dim_size(i) == 1 ? 0 : stride;
+      stride *= bias_shape.dim_size(i);
+    }
+    layout->num_batch_dims = rank - 2;
+    for (int i = 0; i < rank - 2; ++i) {
+      layout->batch_sizes[i] = scores_shape.dim_size(i);
+      layout->batch_strides[i] = strides[i];
+    }
+    layout->query_stride = strides[rank - 2];
+    layout->key_stride = strides[rank - 1];
+    return absl::OkStatus();
+  }
+
+  float scale_;
+  bool causal_;
+  bool has_bias_;
+};
+
+#define REGISTER_FUSED_ATTENTION(T)                                     \
+  REGISTER_KERNEL_BUILDER(                                              \
+      Name("_FusedAttention").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedAttentionOp<CPUDevice, T>)
+
+REGISTER_FUSED_ATTENTION(float);
+#undef REGISTER_FUSED_ATTENTION
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                                 \
+  template <>                                                               \
+  Status FusedAttention<GPUDevice, T>::operator()(                          \
+      OpKernelContext* context, const FusedAttentionParams& params,         \
+      const T* query, const T* key, const T* value, const T* bias,          \
+      T* output);                                                           \
+  extern template struct FusedAttention<GPUDevice, T>;
+
+DECLARE_GPU_SPEC(Eigen::half);
+DECLARE_GPU_SPEC(float);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+#define REGISTER_GPU_FUSED_ATTENTION(T)                                 \
+  REGISTER_KERNEL_BUILDER(                                              \
+      Name("_FusedAttention").Device(DEVICE_GPU).TypeConstraint<T>("T"), \
+      FusedAttentionOp<GPUDevice, T>)
+
+REGISTER_GPU_FUSED_ATTENTION(Eigen::half);
+REGISTER_GPU_FUSED_ATTENTION(float);
+#undef REGISTER_GPU_FUSED_ATTENTION
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace tensorflow
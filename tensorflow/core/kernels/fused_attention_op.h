@@ -0,0 +1,77 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FUSED_ATTENTION_OP_H_
+#define TENSORFLOW_CORE_KERNELS_FUSED_ATTENTION_OP_H_
+
+#include <cstdint>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+
+namespace tensorflow {
+
+// Locates the elements of the optional bias added to the scaled scores, which
+// may broadcast along any of its dimensions. The strides along broadcast
+// dimensions are 0.
+struct FusedAttentionBiasLayout {
+  static constexpr int kMaxBatchDims = 6;
+
+  int num_batch_dims = 0;
+  // Sizes of the batch dimensions of the scores, and the strides of the bias
+  // along them.
+  int64_t batch_sizes[kMaxBatchDims] = {};
+  int64_t batch_strides[kMaxBatchDims] = {};
+  int64_t query_stride = 0;
+  int64_t key_stride = 0;
+
+  // Returns the offset of the bias of the flattened batch `batch`.
+  EIGEN_DEVICE_FUNC int64_t BatchOffset(int64_t batch) const {
+    int64_t offset = 0;
+    for (int i = num_batch_dims - 1; i >= 0; --i) {
+      offset += (batch % batch_sizes[i]) * batch_strides[i];
+      batch /= batch_sizes[i];
+    }
+    return offset;
+  }
+};
+
+struct FusedAttentionParams {
+  int64_t batch_size;
+  int64_t num_queries;
+  int64_t num_keys;
+  int64_t depth;
+  int64_t value_depth;
+  float scale;
+  // Query i only attends to keys 0 to i.
+  bool causal;
+  FusedAttentionBiasLayout bias_layout;
+};
+
+namespace functor {
+
+// Computes the attention of `params.batch_size` batches of row major queries,
+// keys and values into `output`. `bias` may be null.
+template <typename Device, typename T>
+struct FusedAttention {
+  Status operator()(OpKernelContext* context,
+                    const FusedAttentionParams& params, const T* query,
+                    const T* key, const T* value, const T* bias, T* output);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FUSED_ATTENTION_OP_H_
@@ -0,0 +1,216 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/kernels/fused_attention_op.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+namespace {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+constexpr int kWarpSize = 32;
+// Every warp of a block computes the attention of one query, and all the
+// warps of the block share the tiles of keys and values in shared memory.
+constexpr int kQueriesPerBlock = 4;
+// Every lane of a warp computes the score of one key of a tile.
+constexpr int kKeysPerTile = kWarpSize;
+// Every lane accumulates up to kMaxValuesPerLane elements of the output row.
+constexpr int kMaxDepth = 128;
+constexpr int kMaxValuesPerLane = kMaxDepth / kWarpSize;
+
+__device__ float WarpMax(float value) {
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    value = fmaxf(value, GpuShuffleXorSync(kCudaWarpAll, value, offset));
+  }
+  return value;
+}
+
+__device__ float WarpSum(float value) {
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    value += GpuShuffleXorSync(kCudaWarpAll, value, offset);
+  }
+  return value;
+}
+
+// Flash-style attention: the scores of a query are computed one tile of keys
+// at a time and folded into an online softmax, so neither the score matrix
+// nor a tile of it is ever written to global memory. The tiles are converted
+// to float in shared memory, and the rows of keys are padded by one element
+// so that the lanes reading different keys hit different banks.
+template <typename T>
+__global__ void __launch_bounds__(kQueriesPerBlock* kWarpSize)
+    FusedAttentionKernel(FusedAttentionParams params,
+                         const T* __restrict__ query,
+                         const T* __restrict__ key,
+                         const T* __restrict__ value,
+                         const T* __restrict__ bias, T* __restrict__ output) {
+  GPU_DYNAMIC_SHARED_MEM_DECL(sizeof(float), float, shared_memory);
+  const int64_t depth = params.depth;
+  const int64_t value_depth = params.value_depth;
+  const int64_t key_row_size = depth + 1;
+  float* query_tile = shared_memory;
+  float* key_tile = query_tile + kQueriesPerBlock * depth;
+  float* value_tile = key_tile + kKeysPerTile * key_row_size;
+
+  const int64_t num_query_blocks =
+      (params.num_queries + kQueriesPerBlock - 1) / kQueriesPerBlock;
+  const int64_t batch = blockIdx.x / num_query_blocks;
+  const int64_t first_query =
+      (blockIdx.x % num_query_blocks) * kQueriesPerBlock;
+  const int64_t block_queries =
+      min(static_cast<int64_t>(kQueriesPerBlock),
+          params.num_queries - first_query);
+  const int warp = threadIdx.x / kWarpSize;
+  const int lane = threadIdx.x % kWarpSize;
+  const int64_t q = first_query + warp;
+  const bool active = warp < block_queries;
+
+  const T* queries = query + (batch * params.num_queries + first_query) * depth;
+  for (int64_t i = threadIdx.x; i < block_queries * depth; i += blockDim.x) {
+    query_tile[i] = static_cast<float>(queries[i]);
+  }
+  const T* keys = key + batch * params.num_keys * depth;
+  const T* values = value + batch * params.num_keys * value_depth;
+  const T* biases = bias == nullptr || !active
+                        ? nullptr
+                        : bias + params.bias_layout.BatchOffset(batch) +
+                              q * params.bias_layout.query_stride;
+  const float* query_row = query_tile + warp * depth;
+
+  float max_score = -std::numeric_limits<float>::infinity();
+  float sum_exp = 0;
+  float accumulator[kMaxValuesPerLane] = {};
+  const int64_t key_limit =
+      params.causal ? min(params.num_keys, first_query + block_queries)
+                    : params.num_keys;
+  for (int64_t first_key = 0; first_key < key_limit;
+       first_key += kKeysPerTile) {
+    const int tile_keys =
+        min(static_cast<int64_t>(kKeysPerTile), key_limit - first_key);
+    // Wait until the previous tile is used before it is overwritten.
+    __syncthreads();
+    for (int64_t i = threadIdx.x; i < tile_keys * depth; i += blockDim.x) {
+      key_tile[(i / depth) * key_row_size + i % depth] =
+          static_cast<float>(keys[first_key * depth + i]);
+    }
+    for (int64_t i = threadIdx.x; i < tile_keys * value_depth;
+         i += blockDim.x) {
+      value_tile[i] = static_cast<float>(values[first_key * value_depth + i]);
+    }
+    __syncthreads();
+    if (!active) continue;
+
+    const int64_t k = first_key + lane;
+    float score = -std::numeric_limits<float>::infinity();
+    if (lane < tile_keys && !(params.causal && k > q)) {
+      const float* key_row = key_tile + lane * key_row_size;
+      float dot = 0;
+      for (int64_t d = 0; d < depth; ++d) dot += query_row[d] * key_row[d];
+      score = dot * params.scale;
+      if (biases != nullptr) {
+        score +=
+            static_cast<float>(biases[k * params.bias_layout.key_stride]);
+      }
+    }
+    const float new_max = fmaxf(max_score, WarpMax(score));
+    // Nothing is accumulated while all the scores so far are masked.
+    if (new_max == -std::numeric_limits<float>::infinity()) continue;
+    const float correction = expf(max_score - new_max);
+    const float weight = expf(score - new_max);
+    max_score = new_max;
+    sum_exp = sum_exp * correction + WarpSum(weight);
+    for (int i = 0; i < kMaxValuesPerLane; ++i) accumulator[i] *= correction;
+    for (int j = 0; j < tile_keys; ++j) {
+      const float key_weight = GpuShuffleSync(kCudaWarpAll, weight, j);
+      const float* value_row = value_tile + j * value_depth;
+      for (int i = 0; i < kMaxValuesPerLane; ++i) {
+        const int64_t d = lane + i * kWarpSize;
+        if (d < value_depth) accumulator[i] += key_weight * value_row[d];
+      }
+    }
+  }
+
+  if (!active) return;
+  T* output_row = output + (batch * params.num_queries + q) * value_depth;
+  const float inv_sum = 1.0f / sum_exp;
+  for (int i = 0; i < kMaxValuesPerLane; ++i) {
+    const int64_t d = lane + i * kWarpSize;
+    if (d < value_depth) {
+      output_row[d] = static_cast<T>(accumulator[i] * inv_sum);
+    }
+  }
+}
+
+}  // namespace
+
+namespace functor {
+
+template <typename T>
+struct FusedAttention<GPUDevice, T> {
+  Status operator()(OpKernelContext* context,
+                    const FusedAttentionParams& params, const T* query,
+                    const T* key, const T* value, const T* bias, T* output) {
+    const GPUDevice& d = context->eigen_gpu_device();
+    if (params.num_keys == 0) {
+      // The softmax of an empty row is empty, and so is the weighted sum.
+      d.memset(output, 0,
+               params.batch_size * params.num_queries * params.value_depth *
+                   sizeof(T));
+      return absl::OkStatus();
+    }
+    if (params.depth > kMaxDepth || params.value_depth > kMaxDepth) {
+      return errors::Unimplemented(
+          "_FusedAttention on GPU supports depths of at most ", kMaxDepth,
+          " but the queries have depth ", params.depth,
+          " and the values have depth ", params.value_depth);
+    }
+    const int64_t num_query_blocks =
+        (params.num_queries + kQueriesPerBlock - 1) / kQueriesPerBlock;
+    const int64_t num_blocks = params.batch_size * num_query_blocks;
+    if (num_blocks > std::numeric_limits<int32_t>::max()) {
+      return errors::InvalidArgument(
+          "Too many queries for _FusedAttention on GPU: ",
+          params.batch_size * params.num_queries);
+    }
+    const size_t shared_memory_size =
+        (kQueriesPerBlock * params.depth +
+         kKeysPerTile * (params.depth + 1) +
+         kKeysPerTile * params.value_depth) *
+        sizeof(float);
+    return GpuLaunchKernel(FusedAttentionKernel<T>, num_blocks,
+                           kQueriesPerBlock * kWarpSize, shared_memory_size,
+                           d.stream(), params, query, key, value, bias,
+                           output);
+  }
+};
+
+template struct FusedAttention<GPUDevice, Eigen::half>;
+template struct FusedAttention<GPUDevice, float>;
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -0,0 +1,394 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/default_device.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedAttentionOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(float scale, bool has_bias = false, bool causal = false) {
+    TF_ASSERT_OK(NodeDefBuilder("fused_attention", "_FusedAttention")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(has_bias ? 1 : 0, DT_FLOAT))
+                     .Attr("scale", scale)
+                     .Attr("causal", causal)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Compares the op with a reference which materializes the scores, for
+  // `batch` batches of `num_queries` queries and `num_keys` keys. With
+  // `bias_shape`, a bias which broadcasts to the scores is added to them.
+  void RunAndCompare(int batch, int num_queries, int num_keys, int depth,
+                     int value_depth, float scale, bool causal = false,
+                     const std::vector<int64_t>& bias_shape = {}) {
+    const bool has_bias = !bias_shape.empty();
+    MakeOp(scale, has_bias, causal);
+    auto pseudo_random = [](int i) { return std::sin(i * 0.37f); };
+    AddInput<float>(TensorShape({batch, num_queries, depth}), pseudo_random);
+    AddInput<float>(TensorShape({batch, num_keys, depth}), pseudo_random);
+    AddInput<float>(TensorShape({batch, num_keys, value_depth}),
+                    pseudo_random);
+    if (has_bias) {
+      AddInput<float>(TensorShape(bias_shape),
+                      [](int i) { return i % 3 == 0 ? -1e9f : i * 0.1f; });
+    }
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(DT_FLOAT, TensorShape({batch, num_queries, value_depth}));
+    auto q = GetInput(0).tensor<float, 3>();
+    auto k = GetInput(1).tensor<float, 3>();
+    auto v = GetInput(2).tensor<float, 3>();
+    auto out = expected.tensor<float, 3>();
+    for (int b = 0; b < batch; ++b) {
+      for (int i = 0; i < num_queries; ++i) {
+        std::vector<float> scores(num_keys);
+        for (int j = 0; j < num_keys; ++j) {
+          scores[j] = 0;
+          for (int d = 0; d < depth; ++d) scores[j] += q(b, i, d) * k(b, j, d);
+          scores[j] *= scale;
+          if (has_bias) {
+            scores[j] += GetInput(3).tensor<float, 3>()(
+                bias_shape[0] == 1 ? 0 : b, bias_shape[1] == 1 ? 0 : i,
+                bias_shape[2] == 1 ? 0 : j);
+          }
+          if (causal && j > i) {
+            scores[j] = -std::numeric_limits<float>::infinity();
+          }
+        }
+        const float max_score =
+            *std::max_element(scores.begin(), scores.end());
+        float sum = 0;
+        for (float& score : scores) {
+          score = std::exp(score - max_score);
+          sum += score;
+        }
+        for (int d = 0; d < value_depth; ++d) {
+          out(b, i, d) = 0;
+          for (int j = 0; j < num_keys; ++j) {
+            out(b, i, d) += scores[j] / sum * v(b, j, d);
+          }
+        }
+      }
+    }
+    test::ExpectClose(expected, *GetOutput(0), /*atol=*/1e-5, /*rtol=*/1e-4);
+  }
+};
+
+TEST_F(FusedAttentionOpTest, SingleBlock) {
+  RunAndCompare(/*batch=*/2, /*num_queries=*/3, /*num_keys=*/5, /*depth=*/4,
+                /*value_depth=*/6, /*scale=*/0.5f);
+}
+
+TEST_F(FusedAttentionOpTest, MultipleBlocks) {
+  // Neither the queries nor the keys are a multiple of the block sizes.
+  RunAndCompare(/*batch=*/3, /*num_queries=*/37, /*num_keys=*/150,
+                /*depth=*/8, /*value_depth=*/8, /*scale=*/0.125f);
+}
+
+TEST_F(FusedAttentionOpTest, Causal) {
+  RunAndCompare(/*batch=*/2, /*num_queries=*/70, /*num_keys=*/70,
+                /*depth=*/8, /*value_depth=*/4, /*scale=*/0.5f,
+                /*causal=*/true);
+}
+
+TEST_F(FusedAttentionOpTest, PaddingMask) {
+  // The mask of the keys of every batch broadcasts along the queries.
+  RunAndCompare(/*batch=*/2, /*num_queries=*/20, /*num_keys=*/70,
+                /*depth=*/8, /*value_depth=*/4, /*scale=*/0.5f,
+                /*causal=*/false, /*bias_shape=*/{2, 1, 70});
+}
+
+TEST_F(FusedAttentionOpTest, CausalWithBias) {
+  RunAndCompare(/*batch=*/3, /*num_queries=*/37, /*num_keys=*/40,
+                /*depth=*/4, /*value_depth=*/8, /*scale=*/1.0f,
+                /*causal=*/true, /*bias_shape=*/{1, 37, 40});
+}
+
+TEST_F(FusedAttentionOpTest, BiasDoesNotBroadcast) {
+  MakeOp(/*scale=*/1.0f, /*has_bias=*/true);
+  AddInputFromArray<float>(TensorShape({1, 2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 2, 3}), {0, 0, 0, 0, 0, 0});
+  EXPECT_EQ(RunOpKernel().code(), error::INVALID_ARGUMENT);
+}
+
+TEST_F(FusedAttentionOpTest, IncompatibleShapes) {
+  MakeOp(/*scale=*/1.0f);
+  AddInputFromArray<float>(TensorShape({1, 2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({1, 2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 2, 2}), {1, 2, 3, 4});
+  EXPECT_EQ(RunOpKernel().code(), error::INVALID_ARGUMENT);
+}
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Compares the GPU kernel with the subgraph which the remapper fuses, both run
+// on the GPU.
+class FusedAttentionGpuTest : public ::testing::Test {
+ protected:
+  template <typename T>
+  void RunAndCompare(int batch, int num_queries, int num_keys, int depth,
+                     int value_depth, float scale, bool causal = false,
+                     const std::vector<int64_t>& bias_shape = {},
+                     double atol = 1e-5, double rtol = 1e-4) {
+    const DataType dtype = DataTypeToEnum<T>::value;
+    auto make_tensor = [](const TensorShape& shape, auto fn) {
+      Tensor tensor(DataTypeToEnum<T>::value, shape);
+      for (int64_t i = 0; i < tensor.NumElements(); ++i) {
+        tensor.flat<T>()(i) = static_cast<T>(fn(i));
+      }
+      return tensor;
+    };
+    auto pseudo_random = [](int64_t i) { return std::sin(i * 0.37f); };
+    std::vector<std::pair<string, Tensor>> feeds = {
+        {"query", make_tensor(TensorShape({batch, num_queries, depth}),
+                              pseudo_random)},
+        {"key",
+         make_tensor(TensorShape({batch, num_keys, depth}), pseudo_random)},
+        {"value", make_tensor(TensorShape({batch, num_keys, value_depth}),
+                              pseudo_random)}};
+    const bool has_bias = !bias_shape.empty();
+    if (has_bias) {
+      feeds.push_back({"bias", make_tensor(TensorShape(bias_shape),
+                                           [](int64_t i) {
+                                             return i % 3 == 0 ? -1e9f
+                                                               : i * 0.1f;
+                                           })});
+    }
+
+    Graph g(OpRegistry::Global());
+    auto placeholder = [&](const string& name) {
+      Node* node;
+      TF_CHECK_OK(NodeBuilder(name, "Placeholder")
+                      .Attr("dtype", dtype)
+                      .Finalize(&g, &node));
+      return node;
+    };
+    Node* query = placeholder("query");
+    Node* key = placeholder("key");
+    Node* value = placeholder("value");
+    std::vector<NodeBuilder::NodeOut> bias;
+    if (has_bias) bias.push_back(placeholder("bias"));
+    TF_CHECK_OK(NodeBuilder("fused", "_FusedAttention")
+                    .Input(query)
+                    .Input(key)
+                    .Input(value)
+                    .Input(bias)
+                    .Attr("scale", scale)
+                    .Attr("causal", causal)
+                    .Finalize(&g, nullptr));
+
+    auto binary_op = [&](const string& op, Node* x, Node* y) {
+      Node* node;
+      TF_CHECK_OK(NodeBuilder(g.NewName("n"), op)
+                      .Input(x)
+                      .Input(y)
+                      .Finalize(&g, &node));
+      return node;
+    };
+    Node* scores;
+    TF_CHECK_OK(NodeBuilder(g.NewName("n"), "BatchMatMulV2")
+                    .Input(query)
+                    .Input(key)
+                    .Attr("adj_y", true)
+                    .Finalize(&g, &scores));
+    const Tensor scale_tensor =
+        make_tensor(TensorShape({}), [scale](int64_t) { return scale; });
+    scores = binary_op("Mul", scores, test::graph::Constant(&g, scale_tensor));
+    if (has_bias) scores = binary_op("AddV2", scores, bias[0].node);
+    if (causal) {
+      const Tensor mask = make_tensor(
+          TensorShape({num_queries, num_keys}), [num_keys](int64_t i) {
+            return i % num_keys > i / num_keys
+                       ? -std::numeric_limits<float>::infinity()
+                       : 0.0f;
+          });
+      scores = binary_op("AddV2", scores, test::graph::Constant(&g, mask));
+    }
+    Node* probabilities;
+    TF_CHECK_OK(NodeBuilder(g.NewName("n"), "Softmax")
+                    .Input(scores)
+                    .Finalize(&g, &probabilities));
+    TF_CHECK_OK(NodeBuilder("unfused", "BatchMatMulV2")
+                    .Input(probabilities)
+                    .Input(value)
+                    .Finalize(&g, nullptr));
+
+    GraphDef graph_def;
+    g.ToGraphDef(&graph_def);
+    graph::SetDefaultDevice("/device:GPU:0", &graph_def);
+    // Keep the graph as built, so that neither output is computed on the host.
+    SessionOptions options;
+    options.config.mutable_graph_options()
+        ->mutable_optimizer_options()
+        ->set_opt_level(OptimizerOptions::L0);
+    options.config.mutable_graph_options()
+        ->mutable_rewrite_options()
+        ->set_disable_meta_optimizer(true);
+    std::unique_ptr<Session> session(NewSession(options));
+    TF_ASSERT_OK(session->Create(graph_def));
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run(feeds, {"fused", "unfused"}, {}, &outputs));
+    ASSERT_EQ(outputs.size(), 2);
+    test::ExpectClose(outputs[0], outputs[1], atol, rtol);
+  }
+};
+
+TEST_F(FusedAttentionGpuTest, MultipleTiles) {
+  // Neither the queries nor the keys are a multiple of the tile sizes.
+  RunAndCompare<float>(/*batch=*/3, /*num_queries=*/37, /*num_keys=*/150,
+                       /*depth=*/64, /*value_depth=*/64, /*scale=*/0.125f);
+}
+
+TEST_F(FusedAttentionGpuTest, LargeValueDepth) {
+  RunAndCompare<float>(/*batch=*/2, /*num_queries=*/20, /*num_keys=*/70,
+                       /*depth=*/16, /*value_depth=*/128, /*scale=*/0.25f);
+}
+
+TEST_F(FusedAttentionGpuTest, Causal) {
+  RunAndCompare<float>(/*batch=*/2, /*num_queries=*/70, /*num_keys=*/70,
+                       /*depth=*/32, /*value_depth=*/32, /*scale=*/0.5f,
+                       /*causal=*/true);
+}
+
+TEST_F(FusedAttentionGpuTest, PaddingMask) {
+  RunAndCompare<float>(/*batch=*/2, /*num_queries=*/20, /*num_keys=*/70,
+                       /*depth=*/32, /*value_depth=*/32, /*scale=*/0.5f,
+                       /*causal=*/false, /*bias_shape=*/{2, 1, 70});
+}
+
+TEST_F(FusedAttentionGpuTest, CausalWithBias) {
+  RunAndCompare<float>(/*batch=*/3, /*num_queries=*/37, /*num_keys=*/40,
+                       /*depth=*/8, /*value_depth=*/8, /*scale=*/1.0f,
+                       /*causal=*/true, /*bias_shape=*/{1, 37, 40});
+}
+
+TEST_F(FusedAttentionGpuTest, Half) {
+  RunAndCompare<Eigen::half>(/*batch=*/2, /*num_queries=*/37,
+                             /*num_keys=*/70, /*depth=*/64,
+                             /*value_depth=*/64, /*scale=*/0.125f,
+                             /*causal=*/true, /*bias_shape=*/{2, 1, 70},
+                             /*atol=*/1e-2, /*rtol=*/1e-2);
+}
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Performance benchmarks below.
+
+Node* BatchMatMul(Graph* g, Node* x, Node* y, bool adj_y) {
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "BatchMatMulV2")
+                  .Input(x)
+                  .Input(y)
+                  .Attr("T", DT_FLOAT)
+                  .Attr("adj_x", false)
+                  .Attr("adj_y", adj_y)
+                  .Finalize(g, &node));
+  return node;
+}
+
+// Self attention of `batch` heads over `seq_len` tokens, either as the
+// subgraph which the remapper fuses or fused.
+static Graph* Attention(int batch, int seq_len, int depth, bool fused) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor t(DT_FLOAT, TensorShape({batch, seq_len, depth}));
+  t.flat<float>().setRandom();
+  Node* query = test::graph::Constant(g, t);
+  Node* key = test::graph::Constant(g, t);
+  Node* value = test::graph::Constant(g, t);
+  const float scale = 1.0f / std::sqrt(static_cast<float>(depth));
+
+  if (fused) {
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "_FusedAttention")
+                    .Input(query)
+                    .Input(key)
+                    .Input(value)
+                    .Input(std::vector<NodeBuilder::NodeOut>())
+                    .Attr("T", DT_FLOAT)
+                    .Attr("scale", scale)
+                    .Finalize(g, nullptr));
+    return g;
+  }
+  Node* scores;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Mul")
+                  .Input(BatchMatMul(g, query, key, /*adj_y=*/true))
+                  .Input(test::graph::Constant(g, test::AsScalar<float>(scale)))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &scores));
+  Node* probabilities;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Softmax")
+                  .Input(scores)
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &probabilities));
+  BatchMatMul(g, probabilities, value, /*adj_y=*/false);
+  return g;
+}
+
+#define BM_Attention(BATCH, SEQ_LEN, DEPTH, FUSED)                        \
+  static void BM_Attention##_##BATCH##_##SEQ_LEN##_##DEPTH##_##FUSED(     \
+      ::testing::benchmark::State& state) {                               \
+    test::Benchmark("cpu", Attention(BATCH, SEQ_LEN, DEPTH, FUSED),       \
+                    /*old_benchmark_api*/ false)                          \
+        .Run(state);                                                      \
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *    \
+                            BATCH * SEQ_LEN * SEQ_LEN * DEPTH * 2);       \
+  }                                                                       \
+  BENCHMARK(BM_Attention##_##BATCH##_##SEQ_LEN##_##DEPTH##_##FUSED)       \
+      ->UseRealTime();
+
+// BM_Attention(batch * heads, sequence length, depth per head, fused)
+
+BM_Attention(12, 128, 64, false);
+BM_Attention(12, 128, 64, true);
+
+BM_Attention(12, 512, 64, false);
+BM_Attention(12, 512, 64, true);
+
+BM_Attention(12, 1024, 64, false);
+BM_Attention(12, 1024, 64, true);
+
+BM_Attention(12, 2048, 64, false);
+BM_Attention(12, 2048, 64, true);
+
+}  // namespace
+}  // namespace tensorflow
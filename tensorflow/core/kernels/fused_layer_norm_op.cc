@@ -0,0 +1,106 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#include <cmath>
+#include <cstdint>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Normalizes every row of the last dimension of the input in a single pass
+// over memory for the statistics and one for the output, instead of the
+// chain of reductions and element-wise ops of the original subgraph, which
+// each materialize a tensor of the size of the input.
+template <typename T>
+class FusedLayerNormOp : public OpKernel {
+ public:
+  explicit FusedLayerNormOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("epsilon", &epsilon_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    const Tensor& scale = context->input(1);
+    const Tensor& offset = context->input(2);
+    OP_REQUIRES(context, x.dims() >= 1,
+                errors::InvalidArgument("x must be at least rank 1 but is ",
+                                        x.shape().DebugString()));
+    const int64_t depth = x.dim_size(x.dims() - 1);
+    OP_REQUIRES(context,
+                scale.dims() == 1 && scale.dim_size(0) == depth &&
+                    offset.dims() == 1 && offset.dim_size(0) == depth,
+                errors::InvalidArgument(
+                    "scale and offset must be vectors of size ", depth,
+                    " but are ", scale.shape().DebugString(), " and ",
+                    offset.shape().DebugString()));
+
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x.shape(), &y));
+    if (x.NumElements() == 0 || depth == 0) return;
+
+    const T* x_data = x.flat<T>().data();
+    const T* scale_data = scale.flat<T>().data();
+    const T* offset_data = offset.flat<T>().data();
+    T* y_data = y->flat<T>().data();
+    const float epsilon = epsilon_;
+    auto normalize_rows = [=](int64_t start, int64_t limit) {
+      for (int64_t row = start; row < limit; ++row) {
+        const T* in = x_data + row * depth;
+        T* out = y_data + row * depth;
+        double sum = 0;
+        for (int64_t i = 0; i < depth; ++i) sum += in[i];
+        const T mean = static_cast<T>(sum / depth);
+        double squared_sum = 0;
+        for (int64_t i = 0; i < depth; ++i) {
+          const double diff = in[i] - mean;
+          squared_sum += diff * diff;
+        }
+        const T inv_stddev =
+            static_cast<T>(1.0 / std::sqrt(squared_sum / depth + epsilon));
+        for (int64_t i = 0; i < depth; ++i) {
+          out[i] = (in[i] - mean) * inv_stddev * scale_data[i] + offset_data[i];
+        }
+      }
+    };
+
+    const int64_t num_rows = x.NumElements() / depth;
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          /*cost_per_unit=*/8 * depth, normalize_rows);
+  }
+
+ private:
+  float epsilon_;
+};
+
+#define REGISTER_FUSED_LAYER_NORM(T)                                    \
+  REGISTER_KERNEL_BUILDER(                                              \
+      Name("_FusedLayerNorm").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedLayerNormOp<T>)
+
+REGISTER_FUSED_LAYER_NORM(float);
+#undef REGISTER_FUSED_LAYER_NORM
+
+}  // namespace tensorflow
@@ -0,0 +1,172 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedLayerNormOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(float epsilon) {
+    TF_ASSERT_OK(NodeDefBuilder("fused_layer_norm", "_FusedLayerNorm")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("epsilon", epsilon)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(FusedLayerNormOpTest, NormalizesLastDimension) {
+  MakeOp(/*epsilon=*/0.001f);
+  AddInputFromArray<float>(TensorShape({2, 4}),
+                           {1, 2, 3, 4, -1, -1, 3, 3});
+  AddInputFromArray<float>(TensorShape({4}), {1, 2, 1, 0.5});
+  AddInputFromArray<float>(TensorShape({4}), {0, 0, 1, -1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<float> expected;
+  const std::vector<std::vector<float>> rows = {{1, 2, 3, 4}, {-1, -1, 3, 3}};
+  const std::vector<float> scale = {1, 2, 1, 0.5};
+  const std::vector<float> offset = {0, 0, 1, -1};
+  for (const auto& row : rows) {
+    const float mean = (row[0] + row[1] + row[2] + row[3]) / 4;
+    float variance = 0;
+    for (float value : row) variance += (value - mean) * (value - mean) / 4;
+    for (int i = 0; i < 4; ++i) {
+      expected.push_back((row[i] - mean) / std::sqrt(variance + 0.001f) *
+                             scale[i] +
+                         offset[i]);
+    }
+  }
+  Tensor expected_tensor(DT_FLOAT, TensorShape({2, 4}));
+  test::FillValues<float>(&expected_tensor, expected);
+  test::ExpectClose(expected_tensor, *GetOutput(0), /*atol=*/1e-5);
+}
+
+TEST_F(FusedLayerNormOpTest, InvalidScale) {
+  MakeOp(/*epsilon=*/0.001f);
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({3}), {1, 1, 1});
+  AddInputFromArray<float>(TensorShape({2}), {0, 0});
+  EXPECT_EQ(RunOpKernel().code(), error::INVALID_ARGUMENT);
+}
+
+// Performance benchmarks below.
+
+Node* Unary(Graph* g, const string& op, Node* x) {
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), op)
+                  .Input(x)
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+  return node;
+}
+
+Node* Binary(Graph* g, const string& op, Node* x, Node* y) {
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), op)
+                  .Input(x)
+                  .Input(y)
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+  return node;
+}
+
+// Layer normalizations as the subgraph of element-wise ops and reductions
+// which the remapper fuses.
+static Graph* LayerNormSubgraph(int rows, int depth, bool fused) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor x_t(DT_FLOAT, TensorShape({rows, depth}));
+  x_t.flat<float>().setRandom();
+  Tensor scale_t(DT_FLOAT, TensorShape({depth}));
+  scale_t.flat<float>().setRandom();
+  Tensor offset_t(DT_FLOAT, TensorShape({depth}));
+  offset_t.flat<float>().setRandom();
+  Node* x = test::graph::Constant(g, x_t);
+  Node* scale = test::graph::Constant(g, scale_t);
+  Node* offset = test::graph::Constant(g, offset_t);
+
+  if (fused) {
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "_FusedLayerNorm")
+                    .Input(x)
+                    .Input(scale)
+                    .Input(offset)
+                    .Attr("T", DT_FLOAT)
+                    .Attr("epsilon", 0.001f)
+                    .Finalize(g, nullptr));
+    return g;
+  }
+  Node* axis = test::graph::Constant(g, test::AsScalar<int32>(-1));
+  auto mean = [&](Node* input) {
+    Node* node;
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Mean")
+                    .Input(input)
+                    .Input(axis)
+                    .Attr("T", DT_FLOAT)
+                    .Attr("keep_dims", true)
+                    .Finalize(g, &node));
+    return node;
+  };
+  Node* mean1 = mean(x);
+  Node* variance = mean(Binary(g, "SquaredDifference", x, mean1));
+  Node* epsilon = test::graph::Constant(g, test::AsScalar<float>(0.001f));
+  Node* mul1 = Binary(
+      g, "Mul", Unary(g, "Rsqrt", Binary(g, "AddV2", variance, epsilon)),
+      scale);
+  Node* mul0 = Binary(g, "Mul", x, mul1);
+  Node* sub = Binary(g, "Sub", offset, Binary(g, "Mul", mul1, mean1));
+  Binary(g, "AddV2", mul0, sub);
+  return g;
+}
+
+#define BM_LayerNorm(ROWS, DEPTH, FUSED)                                     \
+  static void BM_LayerNorm##_##ROWS##_##DEPTH##_##FUSED(                     \
+      ::testing::benchmark::State& state) {                                  \
+    test::Benchmark("cpu", LayerNormSubgraph(ROWS, DEPTH, FUSED),            \
+                    /*old_benchmark_api*/ false)                             \
+        .Run(state);                                                         \
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * ROWS * \
+                            DEPTH);                                          \
+  }                                                                          \
+  BENCHMARK(BM_LayerNorm##_##ROWS##_##DEPTH##_##FUSED)->UseRealTime();
+
+// BM_LayerNorm(rows, depth, fused)
+
+BM_LayerNorm(128, 768, false);
+BM_LayerNorm(128, 768, true);
+
+BM_LayerNorm(512, 768, false);
+BM_LayerNorm(512, 768, true);
+
+BM_LayerNorm(2048, 1024, false);
+BM_LayerNorm(2048, 1024, true);
+
+}  // namespace
+}  // namespace tensorflow
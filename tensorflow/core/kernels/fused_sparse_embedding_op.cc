@@ -0,0 +1,247 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "absl/base/prefetch.h"
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/training_op_helpers.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+// Computes SparseSegmentSum, SparseSegmentMean or SparseSegmentSqrtN of
+// Gather(params, ids), optionally weighting the rows, without materializing
+// the [num_indices, ...] gathered rows: every output row accumulates the rows
+// of params of its segment directly, prefetching the rows which come next.
+//
+// If `is_resource`, params is the value of a resource variable, which is
+// locked for the whole lookup as in ResourceGather.
+template <typename T, typename Tids, typename Tidx, typename Tsegmentids,
+          bool is_resource>
+class FusedSparseEmbeddingLookupOp : public OpKernel {
+ public:
+  // Number of rows ahead of the one being reduced which are prefetched.
+  static constexpr int64_t kPrefetchDistance = 8;
+
+  enum class Combiner { kSum, kMean, kSqrtN };
+
+  explicit FusedSparseEmbeddingLookupOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    string combiner;
+    OP_REQUIRES_OK(context, context->GetAttr("combiner", &combiner));
+    if (combiner == "sum") {
+      combiner_ = Combiner::kSum;
+    } else if (combiner == "mean") {
+      combiner_ = Combiner::kMean;
+    } else {
+      combiner_ = Combiner::kSqrtN;
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    if (!is_resource) {
+      Lookup(context, context->input(0));
+      return;
+    }
+    core::RefCountPtr<Var> variable;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &variable));
+    OP_REQUIRES_OK(context, EnsureSparseVariableAccess<CPUDevice, T>(
+                                context, variable.get()));
+    tf_shared_lock ml(*variable->mu());
+    const Tensor& params = *variable->tensor();
+    OP_REQUIRES(context, params.dtype() == DataTypeToEnum<T>::v(),
+                errors::InvalidArgument(
+                    "Trying to read variable with wrong dtype. Expected ",
+                    DataTypeString(DataTypeToEnum<T>::v()), " got ",
+                    DataTypeString(params.dtype())));
+    Lookup(context, params);
+  }
+
+ private:
+  void Lookup(OpKernelContext* context, const Tensor& params) {
+    const Tensor& ids = context->input(1);
+    const Tensor& indices = context->input(2);
+    const Tensor& segment_ids = context->input(3);
+    OpInputList weights;
+    OP_REQUIRES_OK(context, context->input_list("weights", &weights));
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+        errors::InvalidArgument("params must be at least 1 dimensional"));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids must be a vector but is ",
+                                        ids.shape().DebugString()));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(indices.shape()) &&
+                    indices.shape() == segment_ids.shape(),
+                errors::InvalidArgument(
+                    "indices and segment_ids must be vectors of the same "
+                    "size but have shapes ",
+                    indices.shape().DebugString(), " and ",
+                    segment_ids.shape().DebugString()));
+    OP_REQUIRES(context, weights.size() <= 1,
+                errors::InvalidArgument("At most one weights tensor expected "
+                                        "but got ",
+                                        weights.size()));
+    const T* weights_data = nullptr;
+    if (weights.size() == 1) {
+      OP_REQUIRES(context, weights[0].shape() == indices.shape(),
+                  errors::InvalidArgument(
+                      "weights must have the shape of indices ",
+                      indices.shape().DebugString(), " but have shape ",
+                      weights[0].shape().DebugString()));
+      weights_data = weights[0].flat<T>().data();
+    }
+
+    const int64_t num_indices = indices.NumElements();
+    const int64_t num_ids = ids.NumElements();
+    const int64_t num_rows = params.dim_size(0);
+    const auto ids_flat = ids.flat<Tids>();
+    const auto indices_flat = indices.flat<Tidx>();
+    const auto segment_ids_flat = segment_ids.flat<Tsegmentids>();
+
+    const int64_t num_segments =
+        num_indices == 0 ? 0
+                         : internal::SubtleMustCopy(
+                               segment_ids_flat(num_indices - 1)) +
+                               1;
+    OP_REQUIRES(context, num_segments >= 0,
+                errors::InvalidArgument("segment ids must be >= 0"));
+    TensorShape output_shape = params.shape();
+    output_shape.set_dim(0, num_segments);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+
+    // Validates the inputs, resolves the row of params of every index, and
+    // finds the first index of every segment. segment_starts[s + 1] is the end
+    // of segment s.
+    std::vector<int64_t> rows(num_indices);
+    std::vector<int64_t> segment_starts(num_segments + 1);
+    int64_t next_segment = 0;
+    int64_t previous_segment = 0;
+    for (int64_t i = 0; i < num_indices; ++i) {
+      const int64_t segment = internal::SubtleMustCopy(segment_ids_flat(i));
+      OP_REQUIRES(context,
+                  segment >= previous_segment && segment < num_segments,
+                  errors::InvalidArgument("segment ids are not increasing"));
+      while (next_segment <= segment) segment_starts[next_segment++] = i;
+      previous_segment = segment;
+
+      const int64_t index = internal::SubtleMustCopy(indices_flat(i));
+      OP_REQUIRES(context, FastBoundsCheck(index, num_ids),
+                  errors::InvalidArgument("indices[", i, "] = ", index,
+                                          " is not in [0, ", num_ids, ")"));
+      const int64_t row = internal::SubtleMustCopy(ids_flat(index));
+      OP_REQUIRES(context, FastBoundsCheck(row, num_rows),
+                  errors::InvalidArgument("ids[", index, "] = ", row,
+                                          " is not in [0, ", num_rows, ")"));
+      rows[i] = row;
+    }
+    while (next_segment <= num_segments) {
+      segment_starts[next_segment++] = num_indices;
+    }
+    if (output->NumElements() == 0) return;
+
+    const int64_t row_size = output->NumElements() / num_segments;
+    const T* params_data = params.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+    const Combiner combiner = combiner_;
+    auto reduce = [&](int64_t start, int64_t limit) {
+      const int64_t end = segment_starts[limit];
+      for (int64_t segment = start; segment < limit; ++segment) {
+        T* out = output_data + segment * row_size;
+        std::fill(out, out + row_size, T(0));
+        T weight_sum = 0;
+        for (int64_t i = segment_starts[segment];
+             i < segment_starts[segment + 1]; ++i) {
+          if (i + kPrefetchDistance < end) {
+            absl::PrefetchToLocalCache(params_data +
+                                       rows[i + kPrefetchDistance] * row_size);
+          }
+          const T weight = weights_data == nullptr ? T(1) : weights_data[i];
+          const T* in = params_data + rows[i] * row_size;
+          for (int64_t j = 0; j < row_size; ++j) out[j] += weight * in[j];
+          weight_sum += combiner == Combiner::kSqrtN ? weight * weight : weight;
+        }
+        if (combiner == Combiner::kSum || weight_sum == T(0)) continue;
+        const T scale = combiner == Combiner::kMean
+                            ? T(1) / weight_sum
+                            : T(1) / std::sqrt(weight_sum);
+        for (int64_t j = 0; j < row_size; ++j) out[j] *= scale;
+      }
+    };
+
+    const int64_t rows_per_segment = std::max<int64_t>(
+        1, num_indices / num_segments);
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, num_segments,
+          /*cost_per_unit=*/rows_per_segment * row_size * 3, reduce);
+  }
+
+  Combiner combiner_;
+};
+
+#define REGISTER_FUSED_SPARSE_EMBEDDING_LOOKUP(T, Tids, Tidx, Tsegmentids) \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedSparseEmbeddingLookup")                                  \
+          .Device(DEVICE_CPU)                                              \
+          .TypeConstraint<T>("T")                                          \
+          .TypeConstraint<Tids>("Tids")                                    \
+          .TypeConstraint<Tidx>("Tidx")                                    \
+          .TypeConstraint<Tsegmentids>("Tsegmentids"),                     \
+      FusedSparseEmbeddingLookupOp<T, Tids, Tidx, Tsegmentids, false>);    \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedResourceSparseEmbeddingLookup")                          \
+          .Device(DEVICE_CPU)                                              \
+          .HostMemory("resource")                                          \
+          .TypeConstraint<T>("dtype")                                      \
+          .TypeConstraint<Tids>("Tids")                                    \
+          .TypeConstraint<Tidx>("Tidx")                                    \
+          .TypeConstraint<Tsegmentids>("Tsegmentids"),                     \
+      FusedSparseEmbeddingLookupOp<T, Tids, Tidx, Tsegmentids, true>)
+
+#define REGISTER_FUSED_SPARSE_EMBEDDING_LOOKUP_SEGMENT_IDS(T, Tids, Tidx) \
+  REGISTER_FUSED_SPARSE_EMBEDDING_LOOKUP(T, Tids, Tidx, int32);           \
+  REGISTER_FUSED_SPARSE_EMBEDDING_LOOKUP(T, Tids, Tidx, int64_t)
+
+#define REGISTER_FUSED_SPARSE_EMBEDDING_LOOKUP_INDICES(T, Tids)         \
+  REGISTER_FUSED_SPARSE_EMBEDDING_LOOKUP_SEGMENT_IDS(T, Tids, int32);   \
+  REGISTER_FUSED_SPARSE_EMBEDDING_LOOKUP_SEGMENT_IDS(T, Tids, int64_t)
+
+REGISTER_FUSED_SPARSE_EMBEDDING_LOOKUP_INDICES(float, int32);
+REGISTER_FUSED_SPARSE_EMBEDDING_LOOKUP_INDICES(float, int64_t);
+#undef REGISTER_FUSED_SPARSE_EMBEDDING_LOOKUP_INDICES
+#undef REGISTER_FUSED_SPARSE_EMBEDDING_LOOKUP_SEGMENT_IDS
+#undef REGISTER_FUSED_SPARSE_EMBEDDING_LOOKUP
+
+}  // namespace tensorflow
@@ -0,0 +1,210 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedSparseEmbeddingLookupOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const string& combiner, int num_weights,
+              bool is_resource = false) {
+    NodeDefBuilder builder("lookup", is_resource
+                                         ? "_FusedResourceSparseEmbeddingLookup"
+                                         : "_FusedSparseEmbeddingLookup");
+    builder.Input(FakeInput(is_resource ? DT_RESOURCE : DT_FLOAT))
+        .Input(FakeInput(DT_INT64))
+        .Input(FakeInput(DT_INT32))
+        .Input(FakeInput(DT_INT32))
+        .Input(FakeInput(num_weights, DT_FLOAT))
+        .Attr("combiner", combiner);
+    if (is_resource) builder.Attr("dtype", DT_FLOAT);
+    TF_ASSERT_OK(builder.Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Adds the ids, indices and segment ids of two segments of rows {4, 1, 4}
+  // and {0}, and an empty segment in between.
+  void AddIds() {
+    AddInputFromArray<int64_t>(TensorShape({3}), {1, 4, 0});
+    AddInputFromArray<int32>(TensorShape({4}), {1, 0, 1, 2});
+    AddInputFromArray<int32>(TensorShape({4}), {0, 0, 0, 2});
+  }
+
+  Tensor Params() {
+    Tensor params(DT_FLOAT, TensorShape({5, 2}));
+    test::FillValues<float>(&params, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+    return params;
+  }
+
+  void ExpectOutput(const std::vector<float>& values) {
+    Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2}));
+    test::FillValues<float>(&expected, values);
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+  }
+};
+
+TEST_F(FusedSparseEmbeddingLookupOpTest, Sum) {
+  MakeOp("sum", /*num_weights=*/0);
+  AddInputFromArray<float>(TensorShape({5, 2}), {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  AddIds();
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectOutput({18, 21, 0, 0, 0, 1});
+}
+
+TEST_F(FusedSparseEmbeddingLookupOpTest, Mean) {
+  MakeOp("mean", /*num_weights=*/0);
+  AddInputFromArray<float>(TensorShape({5, 2}), {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  AddIds();
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectOutput({6, 7, 0, 0, 0, 1});
+}
+
+TEST_F(FusedSparseEmbeddingLookupOpTest, WeightedSqrtN) {
+  MakeOp("sqrtn", /*num_weights=*/1);
+  AddInputFromArray<float>(TensorShape({5, 2}), {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  AddIds();
+  AddInputFromArray<float>(TensorShape({4}), {1, 2, 2, 3});
+  TF_ASSERT_OK(RunOpKernel());
+  // The first segment is (8 + 2 * 2 + 2 * 8) / sqrt(1 + 4 + 4) for the first
+  // column, and the second one is 3 * 0 / sqrt(9).
+  ExpectOutput({28.0f / 3, 33.0f / 3, 0, 0, 0, 1});
+}
+
+TEST_F(FusedSparseEmbeddingLookupOpTest, ResourceVariable) {
+  MakeOp("sum", /*num_weights=*/0, /*is_resource=*/true);
+  Var* var = new Var(DT_FLOAT);
+  *var->tensor() = Params();
+  var->is_initialized = true;
+  AddResourceInput<Var>("", "embeddings", var);
+  AddIds();
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectOutput({18, 21, 0, 0, 0, 1});
+}
+
+TEST_F(FusedSparseEmbeddingLookupOpTest, IdOutOfRange) {
+  MakeOp("sum", /*num_weights=*/0);
+  AddInputFromArray<float>(TensorShape({5, 2}), {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  AddInputFromArray<int64_t>(TensorShape({2}), {1, 5});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.ToString(), "ids[1] = 5 is not in [0, 5)"))
+      << s;
+}
+
+TEST_F(FusedSparseEmbeddingLookupOpTest, UnsortedSegmentIds) {
+  MakeOp("sum", /*num_weights=*/0);
+  AddInputFromArray<float>(TensorShape({5, 2}), {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  AddInputFromArray<int64_t>(TensorShape({2}), {1, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 0});
+  EXPECT_EQ(RunOpKernel().code(), error::INVALID_ARGUMENT);
+}
+
+// Performance benchmarks below.
+
+// Sum of embeddings of `ids_per_example` ids for each of `batch` examples, in
+// a table of `rows` rows of `dim` elements, as SparseSegmentSum of GatherV2 or
+// fused.
+static Graph* SparseEmbeddingLookup(int rows, int dim, int batch,
+                                    int ids_per_example, bool fused) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor params(DT_FLOAT, TensorShape({rows, dim}));
+  params.flat<float>().setRandom();
+  const int num_ids = batch * ids_per_example;
+  Tensor ids(DT_INT64, TensorShape({num_ids}));
+  Tensor indices(DT_INT32, TensorShape({num_ids}));
+  Tensor segment_ids(DT_INT32, TensorShape({num_ids}));
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  for (int i = 0; i < num_ids; ++i) {
+    ids.flat<int64_t>()(i) = rnd.Uniform(rows);
+    indices.flat<int32>()(i) = i;
+    segment_ids.flat<int32>()(i) = i / ids_per_example;
+  }
+  Node* params_node = test::graph::Constant(g, params);
+  Node* ids_node = test::graph::Constant(g, ids);
+  Node* indices_node = test::graph::Constant(g, indices);
+  Node* segment_ids_node = test::graph::Constant(g, segment_ids);
+
+  if (fused) {
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "_FusedSparseEmbeddingLookup")
+                    .Input(params_node)
+                    .Input(ids_node)
+                    .Input(indices_node)
+                    .Input(segment_ids_node)
+                    .Input(std::vector<NodeBuilder::NodeOut>())
+                    .Attr("T", DT_FLOAT)
+                    .Attr("Tids", DT_INT64)
+                    .Attr("num_weights", 0)
+                    .Attr("combiner", "sum")
+                    .Finalize(g, nullptr));
+    return g;
+  }
+  Node* gather = test::graph::Gather(
+      g, params_node, ids_node,
+      test::graph::HostConstant(g, test::AsScalar<int32>(0)));
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+                  .Input(gather)
+                  .Input(indices_node)
+                  .Input(segment_ids_node)
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, nullptr));
+  return g;
+}
+
+#define BM_SparseEmbeddingLookup(ROWS, DIM, BATCH, IDS, FUSED)                \
+  static void                                                                 \
+      BM_SparseEmbeddingLookup##_##ROWS##_##DIM##_##BATCH##_##IDS##_##FUSED(  \
+          ::testing::benchmark::State& state) {                               \
+    test::Benchmark("cpu",                                                    \
+                    SparseEmbeddingLookup(ROWS, DIM, BATCH, IDS, FUSED),      \
+                    /*old_benchmark_api*/ false)                              \
+        .Run(state);                                                          \
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *        \
+                            BATCH * IDS * DIM);                               \
+  }                                                                           \
+  BENCHMARK(                                                                  \
+      BM_SparseEmbeddingLookup##_##ROWS##_##DIM##_##BATCH##_##IDS##_##FUSED)  \
+      ->UseRealTime();
+
+// BM_SparseEmbeddingLookup(rows, dim, batch, ids per example, fused)
+
+BM_SparseEmbeddingLookup(1000000, 64, 512, 32, false);
+BM_SparseEmbeddingLookup(1000000, 64, 512, 32, true);
+
+BM_SparseEmbeddingLookup(1000000, 128, 2048, 64, false);
+BM_SparseEmbeddingLookup(1000000, 128, 2048, 64, true);
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "absl/base/prefetch.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/bounds_check.h"
@@ -108,6 +112,68 @@ SliceIndex HandleCopies(OpKernelContext* ctx,
   return result;
 }
 
+// Gathers of at least kSortedGatherMinIndices rows of at most
+// kSortedGatherMaxSliceBytes bytes from params of at least
+// kSortedGatherMinParamsBytes bytes use HandleSortedCopies.
+constexpr int64_t kSortedGatherMinIndices = 1024;
+constexpr int64_t kSortedGatherMinParamsBytes = 32 << 20;
+constexpr int64_t kSortedGatherMaxSliceBytes = 4096;
+// Number of rows ahead of the one being copied which HandleSortedCopies
+// prefetches.
+constexpr int64_t kSortedGatherPrefetchDistance = 8;
+
+// Helper method to copy using memcpy, for params with a batch size of 1 which
+// are much larger than the cache (e.g. embedding tables).
+//
+// Unlike HandleCopies, the rows are copied in the order of their index in
+// params rather than of their position in indices, and each shard prefetches
+// the rows it is going to copy next. The accesses to params are then
+// monotonic, and the rows of duplicate indices, which are adjacent, are only
+// read from memory once. The rows are still written to the position of their
+// index in indices.
+template <typename T, typename Index>
+int64_t HandleSortedCopies(OpKernelContext* ctx,
+                           typename TTypes<T, 3>::ConstTensor params,
+                           typename TTypes<Index>::ConstFlat indices,
+                           typename TTypes<T, 3>::Tensor out) {
+  const int64_t indices_size = indices.dimension(0);
+  const int64_t slice_elems = params.dimension(2);
+  const Index limit = static_cast<Index>(params.dimension(1));
+  const size_t slice_bytes = slice_elems * sizeof(T);
+
+  // Pairs of index and position, sorted by index.
+  std::vector<std::pair<Index, int64_t>> order(indices_size);
+  for (int64_t i = 0; i < indices_size; ++i) {
+    order[i] = {internal::SubtleMustCopy(indices(i)), i};
+  }
+  std::sort(order.begin(), order.end());
+  // Invalid indices are either at the front or at the back.
+  if (!FastBoundsCheck(order.front().first, limit)) {
+    return order.front().second;
+  }
+  if (!FastBoundsCheck(order.back().first, limit)) {
+    return order.back().second;
+  }
+
+  T* out_base = out.data();
+  const T* params_base = params.data();
+  auto work = [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; ++i) {
+      const int64_t next = i + kSortedGatherPrefetchDistance;
+      if (next < end && order[next].first != order[next - 1].first) {
+        absl::PrefetchToLocalCache(params_base +
+                                   order[next].first * slice_elems);
+      }
+      memcpy(out_base + order[i].second * slice_elems,
+             params_base + order[i].first * slice_elems, slice_bytes);
+    }
+  };
+  auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, indices_size,
+        slice_bytes, work);
+  return -1;
+}
+
 template <typename T, typename Index>
 struct GatherFunctorCPU {
   int64_t operator()(OpKernelContext* ctx,
@@ -125,6 +191,12 @@ struct GatherFunctorCPU {
                       indices_size > std::numeric_limits<int32>::max() ||
                       batch_size * indices_size * slice_size >
                           std::numeric_limits<int32>::max());
+    if (is_simple_type<T>::value && batch_size == 1 &&
+        indices_size >= kSortedGatherMinIndices &&
+        params.size() * sizeof(T) >= kSortedGatherMinParamsBytes &&
+        slice_size * sizeof(T) <= kSortedGatherMaxSliceBytes) {
+      return HandleSortedCopies<T, Index>(ctx, params, indices, out);
+    }
 #define CALL(elems)                                                        \
   do {                                                                     \
     if (use_large) {                                                       \
@@ -176,6 +176,51 @@ TEST_F(GatherOpTest, HighRank) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(GatherOpTest, LargeParamsWithDuplicateIndices) {
+  MakeOp(DT_FLOAT, DT_INT32);
+
+  // Large enough for the rows to be gathered in sorted order.
+  const int kRows = 1 << 16;
+  const int kDim = 128;
+  const int kNumIndices = 4096;
+  AddInput<float>(TensorShape({kRows, kDim}), [](int i) { return i; });
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<int32> indices;
+  for (int i = 0; i < kNumIndices; ++i) {
+    // Every other index is one of a few hot rows.
+    indices.push_back(i % 2 ? rnd.Uniform(4) : rnd.Uniform(kRows));
+  }
+  AddInputFromArray<int32>(TensorShape({kNumIndices}), indices);
+  AddInputFromArray<int32>(TensorShape({}), {0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kNumIndices, kDim}));
+  auto expected_matrix = expected.matrix<float>();
+  for (int i = 0; i < kNumIndices; ++i) {
+    for (int j = 0; j < kDim; ++j) {
+      expected_matrix(i, j) = indices[i] * kDim + j;
+    }
+  }
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(GatherOpTest, Error_IndexOutOfRangeLargeParams) {
+  MakeOp(DT_FLOAT, DT_INT32);
+
+  const int kRows = 1 << 16;
+  const int kNumIndices = 2048;
+  AddInput<float>(TensorShape({kRows, 128}), [](int i) { return i; });
+  std::vector<int32> indices(kNumIndices, 3);
+  indices[1000] = kRows;
+  AddInputFromArray<int32>(TensorShape({kNumIndices}), indices);
+  AddInputFromArray<int32>(TensorShape({}), {0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.ToString(),
+                                "indices[1000] = 65536 is not in [0, 65536)"))
+      << s;
+}
+
 TEST_F(GatherOpTest, Error_IndexOutOfRange) {
   MakeOp(DT_FLOAT, DT_INT32);
 
@@ -205,9 +250,13 @@ TEST_F(GatherOpTest, Error_BatchDimsOutOfRange) {
 }
 
 constexpr int kLookups = 2000;
+// Number of lookups of a batch of embeddings, a third of which are for a small
+// set of popular rows.
+constexpr int kEmbeddingLookups = 1 << 16;
 
 template <typename Index>
-static Graph* Gather(int dim) {
+static Graph* Gather(int dim, int lookups = kLookups,
+                     bool popular_rows = false) {
   Graph* g = new Graph(OpRegistry::Global());
   // Always use a 512MB buffer.
   const int kRows = ((512 << 20) / sizeof(float)) / dim;
@@ -217,11 +266,12 @@ static Graph* Gather(int dim) {
   random::PhiloxRandom philox(301, 17);
   random::SimplePhilox rnd(&philox);
   std::vector<Index> indices_vec;
-  indices_vec.reserve(kLookups);
-  for (int i = 0; i < kLookups; i++) {
-    indices_vec.push_back(rnd.Uniform(kRows));
+  indices_vec.reserve(lookups);
+  for (int i = 0; i < lookups; i++) {
+    indices_vec.push_back(popular_rows && i % 3 == 0 ? rnd.Uniform(1024)
+                                                     : rnd.Uniform(kRows));
   }
-  Tensor indices(DataTypeToEnum<Index>::value, TensorShape({kLookups}));
+  Tensor indices(DataTypeToEnum<Index>::value, TensorShape({lookups}));
   for (int i = 0; i < indices_vec.size(); i++) {
     indices.flat<Index>()(i) = indices_vec[i];
   }
@@ -261,5 +311,28 @@ BM_GATHER(gpu, int32);
 BM_GATHER(cpu, int64_t);
 BM_GATHER(gpu, int64_t);
 
+#define BM_EMBEDDING_GATHER(DEVICE, INDEX)                                   \
+  static void BM_##DEVICE##_embedding_gather_##INDEX(                        \
+      ::testing::benchmark::State& state) {                                  \
+    const int dim = state.range(0);                                          \
+    test::Benchmark(#DEVICE,                                                 \
+                    Gather<INDEX>(dim, kEmbeddingLookups,                    \
+                                  /*popular_rows=*/true),                    \
+                    /*old_benchmark_api=*/false)                             \
+        .Run(state);                                                         \
+    const int64_t tot =                                                      \
+        static_cast<int64_t>(state.iterations()) * kEmbeddingLookups * dim;  \
+    state.SetItemsProcessed(tot);                                            \
+    state.SetBytesProcessed(tot * sizeof(float));                            \
+  }                                                                          \
+  BENCHMARK(BM_##DEVICE##_embedding_gather_##INDEX)                          \
+      ->UseRealTime()                                                        \
+      ->Arg(16)                                                              \
+      ->Arg(64)                                                              \
+      ->Arg(256)
+
+BM_EMBEDDING_GATHER(cpu, int32);
+BM_EMBEDDING_GATHER(cpu, int64_t);
+
 }  // namespace
 }  // namespace tensorflow
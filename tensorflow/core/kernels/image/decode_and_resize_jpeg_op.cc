@@ -0,0 +1,235 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/util/image_resizer_state.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Source rows or columns and weight of one output row or column.
+struct Interpolation {
+  int64_t lower;
+  int64_t upper;
+  float lerp;
+};
+
+// Same sampling as ResizeBilinear's CPU kernel.
+template <typename Scaler>
+void ComputeInterpolation(const Scaler scaler, int64_t out_size,
+                          int64_t in_size, std::vector<Interpolation>* out) {
+  const float scale = CalculateResizeScale(in_size, out_size,
+                                           /*align_corners=*/false);
+  out->resize(out_size);
+  for (int64_t i = 0; i < out_size; ++i) {
+    const float in = scaler(i, scale);
+    const float in_f = std::floor(in);
+    (*out)[i].lower =
+        std::max(static_cast<int64_t>(in_f), static_cast<int64_t>(0));
+    (*out)[i].upper =
+        std::min(static_cast<int64_t>(std::ceil(in)), in_size - 1);
+    (*out)[i].lerp = in - in_f;
+  }
+}
+
+// Returns the largest libjpeg scaling denominator that decodes the image to at
+// least the output size, so the bilinear resize still only downsamples.
+int DctScalingRatio(int in_height, int in_width, int out_height,
+                    int out_width) {
+  for (int ratio : {8, 4, 2}) {
+    // libjpeg rounds the scaled dimensions up.
+    if ((in_height + ratio - 1) / ratio >= out_height &&
+        (in_width + ratio - 1) / ratio >= out_width) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
+}  // namespace
+
+// Decodes a batch of JPEG images and resizes them to the same size with
+// bilinear interpolation, writing the images directly into the output batch.
+// The images are decoded in parallel, and with `dct_scaling` libjpeg decodes
+// large images at 1/2, 1/4 or 1/8 of their size, skipping most of the work of
+// decoding pixels that the resize would drop.
+class BatchDecodeAndResizeJpegOp : public OpKernel {
+ public:
+  explicit BatchDecodeAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 1 or 3, got ",
+                                        channels_));
+    OP_REQUIRES_OK(
+        context, context->GetAttr("half_pixel_centers", &half_pixel_centers_));
+    OP_REQUIRES_OK(context, context->GetAttr("dct_scaling", &dct_scaling_));
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale_));
+    OP_REQUIRES_OK(context, context->GetAttr("offset", &offset_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(contents.shape()),
+                errors::InvalidArgument("contents must be a vector, got shape ",
+                                        contents.shape().DebugString()));
+    const Tensor& size = context->input(1);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(size.shape()) &&
+                    size.NumElements() == 2,
+                errors::InvalidArgument("size must be 1-dimensional with 2 "
+                                        "elements, got shape ",
+                                        size.shape().DebugString()));
+    const int out_height = size.vec<int32>()(0);
+    const int out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("output dimensions must be positive, "
+                                        "got [",
+                                        out_height, ", ", out_width, "]"));
+
+    const int64_t batch_size = contents.NumElements();
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0,
+                       TensorShape({batch_size, out_height, out_width,
+                                    channels_}),
+                       &output));
+    if (batch_size == 0) return;
+
+    const auto inputs = contents.vec<tstring>();
+    float* const output_data = output->flat<float>().data();
+    const int64_t image_size =
+        static_cast<int64_t>(out_height) * out_width * channels_;
+    std::vector<Status> statuses(batch_size);
+    auto decode_and_resize = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        statuses[i] = DecodeAndResize(inputs(i), out_height, out_width,
+                                      output_data + i * image_size);
+        if (!statuses[i].ok()) {
+          statuses[i] = errors::InvalidArgument(
+              "Failed to decode image ", i, ": ", statuses[i].message());
+        }
+      }
+    };
+
+    // Decoding costs roughly a few hundred cycles per compressed byte.
+    int64_t input_bytes = 0;
+    for (int64_t i = 0; i < batch_size; ++i) input_bytes += inputs(i).size();
+    const int64_t cost_per_image =
+        input_bytes / batch_size * 200 + image_size * 20;
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          cost_per_image, decode_and_resize);
+    for (const Status& status : statuses) {
+      OP_REQUIRES_OK(context, status);
+    }
+  }
+
+ private:
+  // Decodes `input` and writes it resized to `out_height` x `out_width` to
+  // `output`.
+  Status DecodeAndResize(StringPiece input, int out_height, int out_width,
+                         float* output) const {
+    if (input.size() > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument("JPEG contents are too large for int: ",
+                                     input.size());
+    }
+    int in_height, in_width;
+    if (!jpeg::GetImageInfo(input.data(), input.size(), &in_width, &in_height,
+                            nullptr)) {
+      return errors::InvalidArgument("Invalid JPEG data, size ", input.size());
+    }
+
+    jpeg::UncompressFlags flags;
+    flags.components = channels_;
+    if (dct_scaling_) {
+      flags.ratio =
+          DctScalingRatio(in_height, in_width, out_height, out_width);
+    }
+    int height, width;
+    std::unique_ptr<uint8[]> image(jpeg::Uncompress(
+        input.data(), input.size(), flags, &width, &height,
+        /*components=*/nullptr, /*nwarn=*/nullptr));
+    if (image == nullptr) {
+      return errors::InvalidArgument(
+          "jpeg::Uncompress failed. Invalid JPEG data.");
+    }
+
+    std::vector<Interpolation> ys, xs;
+    if (half_pixel_centers_) {
+      ComputeInterpolation(HalfPixelScaler(), out_height, height, &ys);
+      ComputeInterpolation(HalfPixelScaler(), out_width, width, &xs);
+    } else {
+      ComputeInterpolation(LegacyScaler(), out_height, height, &ys);
+      ComputeInterpolation(LegacyScaler(), out_width, width, &xs);
+    }
+    // Scale the column indices to byte offsets once.
+    for (Interpolation& x : xs) {
+      x.lower *= channels_;
+      x.upper *= channels_;
+    }
+
+    const int64_t in_row_size = static_cast<int64_t>(width) * channels_;
+    for (int y = 0; y < out_height; ++y) {
+      const uint8* top = image.get() + ys[y].lower * in_row_size;
+      const uint8* bottom = image.get() + ys[y].upper * in_row_size;
+      const float y_lerp = ys[y].lerp;
+      float* out_row = output + static_cast<int64_t>(y) * out_width * channels_;
+      for (int x = 0; x < out_width; ++x) {
+        const int64_t lower = xs[x].lower;
+        const int64_t upper = xs[x].upper;
+        const float x_lerp = xs[x].lerp;
+        for (int c = 0; c < channels_; ++c) {
+          const float top_left = top[lower + c];
+          const float top_right = top[upper + c];
+          const float bottom_left = bottom[lower + c];
+          const float bottom_right = bottom[upper + c];
+          const float top_value = top_left + (top_right - top_left) * x_lerp;
+          const float bottom_value =
+              bottom_left + (bottom_right - bottom_left) * x_lerp;
+          const float value = top_value + (bottom_value - top_value) * y_lerp;
+          out_row[x * channels_ + c] = value * scale_ + offset_;
+        }
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  int channels_;
+  bool half_pixel_centers_;
+  bool dct_scaling_;
+  float scale_;
+  float offset_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("BatchDecodeAndResizeJpeg").Device(DEVICE_CPU),
+                        BatchDecodeAndResizeJpegOp);
+
+}  // namespace tensorflow
@@ -0,0 +1,139 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Encodes a width x height RGB image whose pixel values grow by 4 per column.
+tstring HorizontalGradientJpeg(int width, int height) {
+  std::vector<uint8> pixels(width * height * 3);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      for (int c = 0; c < 3; ++c) pixels[(y * width + x) * 3 + c] = 4 * x;
+    }
+  }
+  jpeg::CompressFlags flags;
+  flags.format = jpeg::FORMAT_RGB;
+  flags.quality = 100;
+  flags.chroma_downsampling = false;
+  return jpeg::Compress(pixels.data(), width, height, flags);
+}
+
+class BatchDecodeAndResizeJpegOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int channels, bool dct_scaling, float scale, float offset) {
+    TF_ASSERT_OK(NodeDefBuilder("op", "BatchDecodeAndResizeJpeg")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("channels", channels)
+                     .Attr("dct_scaling", dct_scaling)
+                     .Attr("scale", scale)
+                     .Attr("offset", offset)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Resizes two 64x64 gradient images to 8x8. With half pixel centers, output
+  // column x samples input column 8 * x + 3.5 when decoded at full size, and
+  // libjpeg's 1/8 scaling averages columns 8 * x to 8 * x + 7, so both give
+  // about 4 * (8 * x + 3.5).
+  void TestGradient(bool dct_scaling) {
+    MakeOp(3, dct_scaling, 0.5f, -1.0f);
+    const tstring image = HorizontalGradientJpeg(64, 64);
+    AddInputFromArray<tstring>(TensorShape({2}), {image, image});
+    AddInputFromArray<int32>(TensorShape({2}), {8, 8});
+    TF_ASSERT_OK(RunOpKernel());
+
+    const Tensor& output = *GetOutput(0);
+    ASSERT_EQ(output.shape(), TensorShape({2, 8, 8, 3}));
+    const auto images = output.tensor<float, 4>();
+    for (int b = 0; b < 2; ++b) {
+      for (int y = 0; y < 8; ++y) {
+        for (int x = 0; x < 8; ++x) {
+          for (int c = 0; c < 3; ++c) {
+            EXPECT_NEAR(images(b, y, x, c), 4 * (8 * x + 3.5) * 0.5f - 1.0f,
+                        2.0f)
+                << b << " " << y << " " << x << " " << c;
+          }
+        }
+      }
+    }
+  }
+};
+
+TEST_F(BatchDecodeAndResizeJpegOpTest, Resize) { TestGradient(false); }
+
+TEST_F(BatchDecodeAndResizeJpegOpTest, ResizeWithDctScaling) {
+  TestGradient(true);
+}
+
+TEST_F(BatchDecodeAndResizeJpegOpTest, Grayscale) {
+  MakeOp(1, true, 1.0f, 0.0f);
+  AddInputFromArray<tstring>(TensorShape({1}),
+                             {HorizontalGradientJpeg(40, 30)});
+  AddInputFromArray<int32>(TensorShape({2}), {3, 5});
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(GetOutput(0)->shape(), TensorShape({1, 3, 5, 1}));
+}
+
+TEST_F(BatchDecodeAndResizeJpegOpTest, EmptyBatch) {
+  MakeOp(3, true, 1.0f, 0.0f);
+  AddInputFromArray<tstring>(TensorShape({0}), {});
+  AddInputFromArray<int32>(TensorShape({2}), {4, 4});
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(GetOutput(0)->shape(), TensorShape({0, 4, 4, 3}));
+}
+
+TEST_F(BatchDecodeAndResizeJpegOpTest, InvalidImage) {
+  MakeOp(3, true, 1.0f, 0.0f);
+  AddInputFromArray<tstring>(TensorShape({2}),
+                             {HorizontalGradientJpeg(8, 8), "not a jpeg"});
+  AddInputFromArray<int32>(TensorShape({2}), {4, 4});
+  Status status = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(status));
+  EXPECT_TRUE(absl::StrContains(status.message(), "Failed to decode image 1"))
+      << status;
+}
+
+TEST_F(BatchDecodeAndResizeJpegOpTest, InvalidSize) {
+  MakeOp(3, true, 1.0f, 0.0f);
+  AddInputFromArray<tstring>(TensorShape({1}), {HorizontalGradientJpeg(8, 8)});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 4});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(BatchDecodeAndResizeJpegOpTest, InvalidChannels) {
+  TF_ASSERT_OK(NodeDefBuilder("op", "BatchDecodeAndResizeJpeg")
+                   .Input(FakeInput(DT_STRING))
+                   .Input(FakeInput(DT_INT32))
+                   .Attr("channels", 4)
+                   .Finalize(node_def()));
+  EXPECT_TRUE(errors::IsInvalidArgument(InitOp()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -95,6 +95,7 @@ Status InitializableLookupTable::Initialize(
   if (!errors::IsOutOfRange(iter.status())) {
     return iter.status();
   }
+  TF_RETURN_IF_ERROR(DoFinishInitialization());
 
   initializer_serializer_ = std::move(serializer);
   is_initialized_.store(true, std::memory_order_release);
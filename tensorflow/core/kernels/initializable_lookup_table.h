@@ -195,6 +195,11 @@ class InitializableLookupTable : public LookupInterface {
   // underlying data structure.
   virtual Status DoInsert(const Tensor& keys, const Tensor& values) = 0;
 
+  // Called once all entries are inserted, before the table is marked as
+  // initialized. Implementations can build lookup structures here that are
+  // cheaper to build in one go than entry by entry.
+  virtual Status DoFinishInitialization() { return absl::OkStatus(); }
+
   // Performs the batch find operation on the underlying data structure.
   virtual Status DoFind(const Tensor& keys, Tensor* values,
                         const Tensor& default_value) = 0;
@@ -15,16 +15,29 @@ limitations under the License.
 
 // Tests kernels of lookup ops.
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/public/session.h"
 
 namespace tensorflow {
 namespace {
@@ -100,5 +113,332 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+TEST(FrozenStringMapTest, FindsAddedEntries) {
+  lookup::FrozenStringMap<int64_t> map;
+  map.Reserve(1000);
+  for (int64_t i = 0; i < 1000; ++i) map.Add(strings::StrCat("key", i), i);
+  map.Add("", -1);
+  TF_ASSERT_OK(map.Freeze());
+  EXPECT_EQ(map.size(), 1001);
+  for (int64_t i = 0; i < 1000; ++i) {
+    const int64_t* value = map.Find(strings::StrCat("key", i));
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(*value, i);
+  }
+  ASSERT_NE(map.Find(""), nullptr);
+  EXPECT_EQ(*map.Find(""), -1);
+  EXPECT_EQ(map.Find("key1000"), nullptr);
+  EXPECT_EQ(map.Find("key"), nullptr);
+}
+
+TEST(FrozenStringMapTest, DropsRepeatedEntries) {
+  lookup::FrozenStringMap<tstring> map;
+  map.Add("a", "x");
+  map.Add("b", "y");
+  map.Add("a", "x");
+  TF_ASSERT_OK(map.Freeze());
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map.key(0), "a");
+  EXPECT_EQ(map.key(1), "b");
+  EXPECT_EQ(*map.Find("a"), "x");
+  EXPECT_EQ(*map.Find("b"), "y");
+}
+
+TEST(FrozenStringMapTest, RejectsDifferentValuesForSameKey) {
+  lookup::FrozenStringMap<int32> map;
+  map.Add("a", 1);
+  map.Add("a", 2);
+  EXPECT_TRUE(errors::IsFailedPrecondition(map.Freeze()));
+}
+
+TEST(FrozenStringMapTest, Empty) {
+  lookup::FrozenStringMap<float> map;
+  TF_ASSERT_OK(map.Freeze());
+  EXPECT_EQ(map.size(), 0);
+  EXPECT_EQ(map.Find("a"), nullptr);
+}
+
+TEST(HashTableTest, StringKeys) {
+  auto* table = new lookup::HashTable<tstring, int64_t>(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  Tensor keys = test::AsTensor<tstring>({"a", "b", "c", "b"});
+  Tensor values = test::AsTensor<int64_t>({1, 2, 3, 2});
+  TF_ASSERT_OK(table->ImportValues(nullptr, keys, values));
+  EXPECT_EQ(table->size(), 3);
+
+  Tensor lookup_keys = test::AsTensor<tstring>({"c", "d", "a"});
+  Tensor lookup_values(DT_INT64, TensorShape({3}));
+  TF_ASSERT_OK(table->Find(nullptr, lookup_keys, &lookup_values,
+                           test::AsScalar<int64_t>(-1)));
+  test::ExpectTensorEqual<int64_t>(lookup_values,
+                                   test::AsTensor<int64_t>({3, -1, 1}));
+}
+
+TEST(HashTableTest, StringKeysWithDifferentValues) {
+  auto* table = new lookup::HashTable<tstring, int64_t>(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  Tensor keys = test::AsTensor<tstring>({"a", "a"});
+  Tensor values = test::AsTensor<int64_t>({1, 2});
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      table->ImportValues(nullptr, keys, values)));
+  EXPECT_EQ(table->size(), 0);
+}
+
+// Runs the ops of a MutableHashTableV2, or of a MutableHashTableOfTensorsV2
+// with values of shape [GetParam()] if GetParam() is positive, from int64 keys
+// to int64 values. The value of key k is {10 * k, 10 * k + 1, ...}.
+class MutableHashTableTest : public ::testing::TestWithParam<int> {
+ protected:
+  void SetUp() override {
+    Graph g(OpRegistry::Global());
+    Node* table;
+    if (GetParam() > 0) {
+      TF_ASSERT_OK(NodeBuilder("table", "MutableHashTableOfTensorsV2")
+                       .Attr("key_dtype", DT_INT64)
+                       .Attr("value_dtype", DT_INT64)
+                       .Attr("value_shape", TensorShape({GetParam()}))
+                       .Attr("shared_name", "table")
+                       .Finalize(&g, &table));
+    } else {
+      TF_ASSERT_OK(NodeBuilder("table", "MutableHashTableV2")
+                       .Attr("key_dtype", DT_INT64)
+                       .Attr("value_dtype", DT_INT64)
+                       .Attr("shared_name", "table")
+                       .Finalize(&g, &table));
+    }
+    Node* keys = Placeholder(&g, "keys");
+    Node* values = Placeholder(&g, "values");
+    Node* default_value = Placeholder(&g, "default_value");
+    Node* node;
+    TF_ASSERT_OK(NodeBuilder("insert", "LookupTableInsertV2")
+                     .Input(table)
+                     .Input(keys)
+                     .Input(values)
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("remove", "LookupTableRemoveV2")
+                     .Input(table)
+                     .Input(keys)
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("find", "LookupTableFindV2")
+                     .Input(table)
+                     .Input(keys)
+                     .Input(default_value)
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("export", "LookupTableExportV2")
+                     .Input(table)
+                     .Attr("Tkeys", DT_INT64)
+                     .Attr("Tvalues", DT_INT64)
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("size", "LookupTableSizeV2")
+                     .Input(table)
+                     .Finalize(&g, &node));
+    GraphDef graph_def;
+    g.ToGraphDef(&graph_def);
+    session_.reset(NewSession(SessionOptions()));
+    TF_ASSERT_OK(session_->Create(graph_def));
+  }
+
+  static Node* Placeholder(Graph* g, const string& name) {
+    Node* node;
+    TF_CHECK_OK(NodeBuilder(name, "Placeholder")
+                    .Attr("dtype", DT_INT64)
+                    .Finalize(g, &node));
+    return node;
+  }
+
+  int ValueSize() const { return std::max(GetParam(), 1); }
+
+  // Returns the values of `keys`, where `offset` is added to every value.
+  Tensor Values(const std::vector<int64_t>& keys, int64_t offset = 0) const {
+    TensorShape shape({static_cast<int64_t>(keys.size())});
+    if (GetParam() > 0) shape.AddDim(GetParam());
+    Tensor values(DT_INT64, shape);
+    auto flat = values.flat<int64_t>();
+    for (int i = 0; i < keys.size(); ++i) {
+      for (int j = 0; j < ValueSize(); ++j) {
+        flat(i * ValueSize() + j) = 10 * keys[i] + j + offset;
+      }
+    }
+    return values;
+  }
+
+  void Insert(const std::vector<int64_t>& keys, int64_t offset = 0) {
+    TF_CHECK_OK(session_->Run({{"keys", test::AsTensor<int64_t>(keys)},
+                               {"values", Values(keys, offset)}},
+                              {}, {"insert"}, nullptr));
+  }
+
+  void Remove(const std::vector<int64_t>& keys) {
+    TF_CHECK_OK(session_->Run({{"keys", test::AsTensor<int64_t>(keys)}}, {},
+                              {"remove"}, nullptr));
+  }
+
+  // Returns the values of `keys` in the table, -1 for missing keys.
+  Tensor Find(const std::vector<int64_t>& keys) {
+    Tensor default_value(DT_INT64, GetParam() > 0 ? TensorShape({GetParam()})
+                                                  : TensorShape({}));
+    default_value.flat<int64_t>().setConstant(-1);
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session_->Run({{"keys", test::AsTensor<int64_t>(keys)},
+                               {"default_value", default_value}},
+                              {"find"}, {}, &outputs));
+    return outputs[0];
+  }
+
+  // Returns the exported keys and values.
+  std::vector<Tensor> Export() {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session_->Run({}, {"export:0", "export:1"}, {}, &outputs));
+    return outputs;
+  }
+
+  int64_t Size() {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session_->Run({}, {"size"}, {}, &outputs));
+    return outputs[0].scalar<int64_t>()();
+  }
+
+  // Returns the exported entries as a map, checking that every key is
+  // exported once, with its own value.
+  std::unordered_map<int64_t, int64_t> ExportedOffsets() {
+    std::vector<Tensor> exported = Export();
+    const auto keys = exported[0].flat<int64_t>();
+    const auto values = exported[1].flat<int64_t>();
+    EXPECT_EQ(values.size(), keys.size() * ValueSize());
+    std::unordered_map<int64_t, int64_t> offsets;
+    for (int i = 0; i < keys.size(); ++i) {
+      const int64_t offset = values(i * ValueSize()) - 10 * keys(i);
+      for (int j = 1; j < ValueSize(); ++j) {
+        EXPECT_EQ(values(i * ValueSize() + j) - j - 10 * keys(i), offset);
+      }
+      EXPECT_TRUE(offsets.emplace(keys(i), offset).second) << keys(i);
+    }
+    return offsets;
+  }
+
+  std::unique_ptr<Session> session_;
+};
+
+TEST_P(MutableHashTableTest, ExportMatchesUnshardedTable) {
+  // The same updates applied to a single unordered_map, as the table used to
+  // keep its entries, with the offset of the value of each key.
+  std::unordered_map<int64_t, int64_t> expected;
+  for (int64_t batch = 0; batch < 20; ++batch) {
+    std::vector<int64_t> keys;
+    for (int64_t key = batch * 7; key < batch * 7 + 50; ++key) {
+      keys.push_back(key);
+      expected[key] = batch;
+    }
+    Insert(keys, /*offset=*/batch);
+  }
+  Remove({0, 3, 70, 1000});
+  for (int64_t key : {0, 3, 70, 1000}) expected.erase(key);
+
+  EXPECT_EQ(Size(), expected.size());
+  std::vector<Tensor> exported = Export();
+  EXPECT_EQ(exported[0].NumElements(), expected.size());
+  EXPECT_EQ(ExportedOffsets(), expected);
+  // The order of the exported keys only changes with the table.
+  test::ExpectTensorEqual<int64_t>(Export()[0], exported[0]);
+}
+
+TEST_P(MutableHashTableTest, ConcurrentInsertFindAndExport) {
+  constexpr int kNumWriters = 4;
+  constexpr int kNumBatches = 50;
+  constexpr int kBatchSize = 40;
+  std::atomic<int> num_done_writers = 0;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumWriters + 2);
+    // Every writer inserts keys of all the shards, which no other writer
+    // inserts.
+    for (int w = 0; w < kNumWriters; ++w) {
+      pool.Schedule([&, w] {
+        for (int b = 0; b < kNumBatches; ++b) {
+          std::vector<int64_t> keys;
+          for (int i = 0; i < kBatchSize; ++i) {
+            keys.push_back((b * kBatchSize + i) * kNumWriters + w);
+          }
+          Insert(keys);
+        }
+        ++num_done_writers;
+      });
+    }
+    // Finds see either the value of a key or the default value.
+    pool.Schedule([&] {
+      std::vector<int64_t> keys;
+      for (int64_t key = 0; key < 1000; key += 3) keys.push_back(key);
+      while (num_done_writers < kNumWriters) {
+        const auto values = Find(keys).flat<int64_t>();
+        for (int i = 0; i < keys.size(); ++i) {
+          const int64_t value = values(i * ValueSize());
+          EXPECT_TRUE(value == -1 || value == 10 * keys[i]) << value;
+        }
+      }
+    });
+    // Exports see every key at most once, with its value, and never shrink.
+    pool.Schedule([&] {
+      int64_t last_size = 0;
+      while (num_done_writers < kNumWriters) {
+        std::unordered_map<int64_t, int64_t> offsets = ExportedOffsets();
+        EXPECT_GE(offsets.size(), last_size);
+        last_size = offsets.size();
+        for (const auto& [key, offset] : offsets) EXPECT_EQ(offset, 0) << key;
+      }
+    });
+  }
+
+  constexpr int64_t kNumKeys = kNumWriters * kNumBatches * kBatchSize;
+  EXPECT_EQ(Size(), kNumKeys);
+  std::unordered_map<int64_t, int64_t> offsets = ExportedOffsets();
+  EXPECT_EQ(offsets.size(), kNumKeys);
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < kNumKeys; ++key) {
+    EXPECT_EQ(offsets.count(key), 1) << key;
+    keys.push_back(key);
+  }
+  test::ExpectTensorEqual<int64_t>(Find(keys), Values(keys));
+}
+
+TEST_P(MutableHashTableTest, InsertsAreAtomic) {
+  constexpr int kNumRounds = 200;
+  // Keys of all the shards, all inserted by each round with the offset of the
+  // round.
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 64; ++key) keys.push_back(key);
+  Insert(keys);
+  std::atomic<bool> done = false;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 3);
+    pool.Schedule([&] {
+      for (int round = 1; round <= kNumRounds; ++round) Insert(keys, round);
+      done = true;
+    });
+    // Finds and exports see all the keys from the same round.
+    pool.Schedule([&] {
+      while (!done) {
+        const auto values = Find(keys).flat<int64_t>();
+        const int64_t offset = values(0);
+        for (int i = 0; i < keys.size(); ++i) {
+          EXPECT_EQ(values(i * ValueSize()) - 10 * keys[i], offset);
+        }
+      }
+    });
+    pool.Schedule([&] {
+      while (!done) {
+        std::unordered_map<int64_t, int64_t> offsets = ExportedOffsets();
+        EXPECT_EQ(offsets.size(), keys.size());
+        const int64_t offset = offsets[0];
+        for (const auto& [key, key_offset] : offsets) {
+          EXPECT_EQ(key_offset, offset) << key;
+        }
+      }
+    });
+  }
+  test::ExpectTensorEqual<int64_t>(Find(keys), Values(keys, kNumRounds));
+}
+
+INSTANTIATE_TEST_SUITE_P(ValueShapes, MutableHashTableTest,
+                         ::testing::Values(0, 2));
+
 }  // namespace
 }  // namespace tensorflow
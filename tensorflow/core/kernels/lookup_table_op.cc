@@ -16,14 +16,18 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <array>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/random.h"
@@ -36,11 +40,169 @@ std::string UniqueNodeName(const std::string& base) {
   return strings::StrCat(base, "/", counter.fetch_add(1), "/", random::New64());
 }
 
+// Hash map for the MutableHashTable* tables, partitioned by the hash of the
+// keys into kNumShards shards which are locked independently. Each operation
+// locks all the shards it accesses up front, in increasing shard order, and
+// keeps them locked until it is done, so operations stay atomic:
+// - Find and Update lock the shards of their keys, for reading and writing
+//   respectively. Ops on keys of different shards run concurrently, but a
+//   lookup sees either all or none of the keys of an update.
+// - Operations on the whole map (size, export) lock all the shards for
+//   reading. They see a consistent snapshot and run concurrently with lookups.
+// - Clearing locks all the shards for writing.
+template <class K, class V>
+class ShardedHashMap {
+ public:
+  using Map = std::unordered_map<K, V>;
+  static constexpr int kNumShards = 16;
+  using Maps = std::array<const Map*, kNumShards>;
+
+  size_t size() const {
+    return WithAllShards([](const Maps& maps) { return TotalSize(maps); });
+  }
+
+  // Calls `fn(map, i)` for every index `i` of `keys`, with `map` the map of
+  // the shard of keys(i), locked for reading.
+  template <typename Fn>
+  void Find(typename TTypes<K>::ConstFlat keys, Fn fn) const {
+    const KeysByShard keys_by_shard(keys);
+    WithShardsLocked(
+        /*exclusive=*/false, [&](int s) { return keys_by_shard.HasKeys(s); },
+        [&] {
+          keys_by_shard.ForEach([&](int s, int64_t i) { fn(map(s), i); });
+        });
+  }
+
+  // Same as Find, with `map` locked for writing. If `clear`, all the maps are
+  // first cleared.
+  template <typename Fn>
+  void Update(typename TTypes<K>::ConstFlat keys, bool clear, Fn fn) {
+    const KeysByShard keys_by_shard(keys);
+    WithShardsLocked(
+        /*exclusive=*/true,
+        [&](int s) { return clear || keys_by_shard.HasKeys(s); },
+        [&] {
+          if (clear) {
+            for (int s = 0; s < kNumShards; ++s) map(s).clear();
+          }
+          keys_by_shard.ForEach([&](int s, int64_t i) { fn(map(s), i); });
+        });
+  }
+
+  // Returns `fn(maps)`, with `maps` the maps of all the shards, locked for
+  // reading.
+  template <typename Fn>
+  decltype(auto) WithAllShards(Fn fn) const {
+    return WithShardsLocked(/*exclusive=*/false, [](int) { return true; }, [&] {
+      Maps maps;
+      for (int s = 0; s < kNumShards; ++s) maps[s] = &map(s);
+      return fn(maps);
+    });
+  }
+
+  static int64_t TotalSize(const Maps& maps) {
+    int64_t size = 0;
+    for (const Map* map : maps) size += map->size();
+    return size;
+  }
+
+ private:
+  struct Shard {
+    mutable mutex mu;
+    Map map TF_GUARDED_BY(mu);
+  };
+
+  // The indices of some keys, grouped by shard.
+  class KeysByShard {
+   public:
+    explicit KeysByShard(typename TTypes<K>::ConstFlat keys)
+        : indices_(keys.size()) {
+      const int64_t num_keys = keys.size();
+      gtl::InlinedVector<int, 1> key_shards(num_keys);
+      for (int64_t i = 0; i < num_keys; ++i) {
+        key_shards[i] =
+            ShardHash(SubtleMustCopyIfIntegral(keys(i))) % kNumShards;
+        ++starts_[key_shards[i] + 1];
+      }
+      for (int s = 0; s < kNumShards; ++s) starts_[s + 1] += starts_[s];
+      std::array<int64_t, kNumShards> next;
+      std::copy(starts_.begin(), starts_.end() - 1, next.begin());
+      for (int64_t i = 0; i < num_keys; ++i) {
+        indices_[next[key_shards[i]]++] = i;
+      }
+    }
+
+    bool HasKeys(int s) const { return starts_[s] != starts_[s + 1]; }
+
+    // Calls `fn(s, i)` for every index `i`, with `s` the shard of its key.
+    template <typename Fn>
+    void ForEach(Fn fn) const {
+      for (int s = 0; s < kNumShards; ++s) {
+        for (int64_t j = starts_[s]; j < starts_[s + 1]; ++j) {
+          fn(s, indices_[j]);
+        }
+      }
+    }
+
+   private:
+    // The indices of the keys of shard `s` are in [starts_[s], starts_[s + 1])
+    // of `indices_`.
+    std::array<int64_t, kNumShards + 1> starts_ = {};
+    gtl::InlinedVector<int64_t, 1> indices_;
+  };
+
+  // The map of shard `s`. The caller must hold the lock of the shard.
+  Map& map(int s) TF_NO_THREAD_SAFETY_ANALYSIS { return shards_[s].map; }
+  const Map& map(int s) const TF_NO_THREAD_SAFETY_ANALYSIS {
+    return shards_[s].map;
+  }
+
+  template <typename T>
+  static uint64 ShardHash(const T& key) {
+    return Hash64(reinterpret_cast<const char*>(&key), sizeof(key));
+  }
+  static uint64 ShardHash(const tstring& key) {
+    return Hash64(key.data(), key.size());
+  }
+
+  // Locks every shard `s` for which `locked(s)`, in increasing order so that
+  // concurrent operations can't deadlock, and returns `fn()`.
+  template <typename Locked, typename Fn>
+  decltype(auto) WithShardsLocked(bool exclusive, Locked locked, Fn fn) const
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (int s = 0; s < kNumShards; ++s) {
+      if (!locked(s)) continue;
+      if (exclusive) {
+        shards_[s].mu.lock();
+      } else {
+        shards_[s].mu.lock_shared();
+      }
+    }
+    auto unlock = gtl::MakeCleanup([&]() TF_NO_THREAD_SAFETY_ANALYSIS {
+      for (int s = kNumShards - 1; s >= 0; --s) {
+        if (!locked(s)) continue;
+        if (exclusive) {
+          shards_[s].mu.unlock();
+        } else {
+          shards_[s].mu.unlock_shared();
+        }
+      }
+    });
+    return fn();
+  }
+
+  std::array<Shard, kNumShards> shards_;
+};
+
 // Lookup table that wraps an unordered_map, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// The keys are partitioned between the locked shards of a ShardedHashMap, so
+// that concurrent lookups and inserts only contend on the same shards. Each
+// Find, Insert and Remove is still atomic, and exports see a consistent
+// snapshot of the table.
 //
 // Sample use case:
 //
@@ -55,10 +217,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
  public:
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -70,8 +229,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    table_.Find(key_values, [&](const Map& map, int64_t i) {
       // is_full_size_default is true:
       //   Each key has an independent default value, key_values(i)
       //   corresponding uses default_flat(i) as its default value.
@@ -79,9 +237,9 @@ class MutableHashTableOfScalars final : public LookupInterface {
       // is_full_size_default is false:
       //   All keys will share the default_flat(0) as default value.
       value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
+          map, SubtleMustCopyIfIntegral(key_values(i)),
           is_full_size_default ? default_flat(i) : default_flat(0));
-    }
+    });
 
     return absl::OkStatus();
   }
@@ -90,14 +248,10 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
+    table_.Update(key_values, clear, [&](Map& map, int64_t i) {
+      gtl::InsertOrUpdate(&map, SubtleMustCopyIfIntegral(key_values(i)),
                           SubtleMustCopyIfIntegral(value_values(i)));
-    }
+    });
     return absl::OkStatus();
   }
 
@@ -109,10 +263,9 @@ class MutableHashTableOfScalars final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.Update(key_values, /*clear=*/false, [&](Map& map, int64_t i) {
+      map.erase(SubtleMustCopyIfIntegral(key_values(i)));
+    });
     return absl::OkStatus();
   }
 
@@ -122,17 +275,18 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-    ExportKeysAndValues(keys, values);
-    return absl::OkStatus();
+    return table_.WithAllShards([&](const Maps& maps) -> Status {
+      int64_t size = Table::TotalSize(maps);
+
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("values", TensorShape({size}), &values));
+      ExportKeysAndValues(maps, keys, values);
+      return absl::OkStatus();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -144,25 +298,32 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
+    int64_t ret = table_.WithAllShards([](const Maps& maps) {
+      int64_t ret = 0;
+      for (const Map* map : maps) {
+        for (unsigned i = 0; i < map->bucket_count(); ++i) {
+          size_t bucket_size = map->bucket_size(i);
+          if (bucket_size == 0) {
+            ret++;
+          } else {
+            ret += bucket_size;
+          }
+        }
       }
-    }
+      return ret;
+    });
     return sizeof(MutableHashTableOfScalars) + ret;
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    table_.WithAllShards([&](const Maps& maps) {
+      int64_t size = Table::TotalSize(maps);
+      keys = Tensor(key_dtype(), TensorShape({size}));
+      values = Tensor(value_dtype(), TensorShape({size}));
+      ExportKeysAndValues(maps, &keys, &values);
+    });
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableV2 kernel. This means that the lifetime
@@ -195,21 +356,26 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  using Table = ShardedHashMap<K, V>;
+  using Map = typename Table::Map;
+  using Maps = typename Table::Maps;
+
+  // Writes all keys and values of `maps` into `keys` and `values`. `keys` and
+  // `values` must point to tensors of size `Table::TotalSize(maps)`.
+  static void ExportKeysAndValues(const Maps& maps, Tensor* keys,
+                                  Tensor* values) {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (const Map* map : maps) {
+      for (auto it = map->begin(); it != map->end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
+      }
     }
   }
 
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  Table table_;
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
@@ -226,10 +392,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
                                 value_shape_.DebugString()));
   }
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -242,10 +405,9 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
+    table_.Find(key_values, [&](const Map& map, int64_t i) {
+      const ValueArray* value_vec =
+          gtl::FindOrNull(map, SubtleMustCopyIfIntegral(key_values(i)));
       if (value_vec != nullptr) {
         for (int64_t j = 0; j < value_dim; j++) {
           value_values(i, j) = value_vec->at(j);
@@ -262,7 +424,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
               is_full_size_default ? default_flat(i, j) : default_flat(0, j);
         }
       }
-    }
+    });
 
     return absl::OkStatus();
   }
@@ -272,19 +434,15 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64_t value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    table_.Update(key_values, clear, [&](Map& map, int64_t i) {
       ValueArray value_vec;
       for (int64_t j = 0; j < value_dim; j++) {
         V value = value_values(i, j);
         value_vec.push_back(value);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
+      gtl::InsertOrUpdate(&map, SubtleMustCopyIfIntegral(key_values(i)),
                           value_vec);
-    }
+    });
     return absl::OkStatus();
   }
 
@@ -296,10 +454,9 @@ class MutableHashTableOfTensors final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.Update(key_values, /*clear=*/false, [&](Map& map, int64_t i) {
+      map.erase(SubtleMustCopyIfIntegral(key_values(i)));
+    });
     return absl::OkStatus();
   }
 
@@ -309,18 +466,19 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    int64_t value_dim = value_shape_.dim_size(0);
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(ctx->allocate_output(
-        "values", TensorShape({size, value_dim}), &values));
-    ExportKeysAndValues(keys, values);
-    return absl::OkStatus();
+    return table_.WithAllShards([&](const Maps& maps) -> Status {
+      int64_t size = Table::TotalSize(maps);
+      int64_t value_dim = value_shape_.dim_size(0);
+
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(ctx->allocate_output(
+          "values", TensorShape({size, value_dim}), &values));
+      ExportKeysAndValues(maps, keys, values);
+      return absl::OkStatus();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -332,25 +490,33 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
+    int64_t ret = table_.WithAllShards([](const Maps& maps) {
+      int64_t ret = 0;
+      for (const Map* map : maps) {
+        for (unsigned i = 0; i < map->bucket_count(); ++i) {
+          size_t bucket_size = map->bucket_size(i);
+          if (bucket_size == 0) {
+            ret++;
+          } else {
+            ret += bucket_size;
+          }
+        }
       }
-    }
+      return ret;
+    });
     return sizeof(MutableHashTableOfTensors) + ret;
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    table_.WithAllShards([&](const Maps& maps) {
+      int64_t size = Table::TotalSize(maps);
+      keys = Tensor(key_dtype(), TensorShape({size}));
+      values =
+          Tensor(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
+      ExportKeysAndValues(maps, &keys, &values);
+    });
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableOfTensorsV2 kernel. This means that the
@@ -384,28 +550,33 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+  using Table = ShardedHashMap<K, ValueArray>;
+  using Map = typename Table::Map;
+  using Maps = typename Table::Maps;
+
+  // Writes all keys and values of `maps` into `keys` and `values`. `keys` and
+  // `values` must point to tensors of size `Table::TotalSize(maps)`.
+  void ExportKeysAndValues(const Maps& maps, Tensor* keys,
+                           Tensor* values) const {
     int64_t value_dim = value_shape_.dim_size(0);
     auto keys_data = keys->flat<K>();
     auto values_data = values->matrix<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64_t j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
+    for (const Map* map : maps) {
+      for (auto it = map->begin(); it != map->end(); ++it, ++i) {
+        K key = it->first;
+        const ValueArray& value = it->second;
+        keys_data(i) = key;
+        for (int64_t j = 0; j < value_dim; j++) {
+          values_data(i, j) = value[j];
+        }
       }
     }
   }
 
   TensorShape value_shape_;
-  mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  Table table_;
 };
 
 namespace {
@@ -16,7 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 #define TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -29,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/hash.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 
@@ -216,6 +224,146 @@ std::string UniqueNodeName(const std::string& base);
 // table.Initialize(...);
 // table.Find(in_t, &out_t, default_t)
 //
+// An immutable map from strings to values of type V, built in one go from
+// entries added in any order. The keys are stored back to back in a single
+// string and found through an open addressing index of 8 byte slots, which
+// takes a fraction of the memory of a hash map of tstrings and needs no
+// allocation per key.
+template <class V>
+class FrozenStringMap {
+ public:
+  void Reserve(size_t num_entries) {
+    key_offsets_.reserve(num_entries + 1);
+    values_.reserve(num_entries);
+  }
+
+  // Appends an entry. Must not be called after Freeze().
+  void Add(StringPiece key, const V& value) {
+    keys_.append(key.data(), key.size());
+    key_offsets_.push_back(keys_.size());
+    values_.push_back(value);
+  }
+
+  // Builds the index over the added entries. Repeated entries are dropped,
+  // and a key added with different values is an error.
+  Status Freeze() {
+    if (values_.size() >= std::numeric_limits<uint32>::max()) {
+      return errors::InvalidArgument("Too many entries for a frozen table: ",
+                                     values_.size());
+    }
+    size_t num_slots = 1;
+    while (num_slots < 2 * values_.size()) num_slots *= 2;
+    slots_.assign(num_slots, Slot());
+    std::vector<bool> repeated;
+    for (uint32 i = 0; i < values_.size(); ++i) {
+      const Slot* existing = Index(i);
+      if (existing == nullptr) continue;
+      const V& value = values_[existing->entry - 1];
+      if (value != values_[i]) {
+        return errors::FailedPrecondition(
+            "HashTable has different value for same key. Key ", key(i),
+            " has ", value, " and trying to add value ", values_[i]);
+      }
+      repeated.resize(values_.size());
+      repeated[i] = true;
+    }
+    if (!repeated.empty()) {
+      RemoveEntries(repeated);
+      slots_.assign(num_slots, Slot());
+      for (uint32 i = 0; i < values_.size(); ++i) Index(i);
+    }
+    keys_.shrink_to_fit();
+    key_offsets_.shrink_to_fit();
+    values_.shrink_to_fit();
+    return absl::OkStatus();
+  }
+
+  size_t size() const { return values_.size(); }
+
+  StringPiece key(size_t i) const {
+    const uint64 begin = i == 0 ? 0 : key_offsets_[i - 1];
+    return StringPiece(keys_.data() + begin, key_offsets_[i] - begin);
+  }
+  const V& value(size_t i) const { return values_[i]; }
+
+  // Returns the value of `key`, or nullptr if it is absent.
+  const V* Find(StringPiece k) const {
+    if (slots_.empty()) return nullptr;
+    const uint64 hash = Hash64(k.data(), k.size());
+    const uint32 tag = static_cast<uint32>(hash >> 32);
+    const size_t mask = slots_.size() - 1;
+    for (size_t s = hash & mask;; s = (s + 1) & mask) {
+      const Slot& slot = slots_[s];
+      if (slot.entry == 0) return nullptr;
+      if (slot.tag == tag && key(slot.entry - 1) == k) {
+        return &values_[slot.entry - 1];
+      }
+    }
+  }
+
+  int64_t MemoryUsed() const {
+    int64_t bytes = keys_.capacity() +
+                    key_offsets_.capacity() * sizeof(uint64) +
+                    values_.capacity() * sizeof(V) +
+                    slots_.capacity() * sizeof(Slot);
+    if constexpr (std::is_same_v<V, tstring>) {
+      for (const tstring& value : values_) bytes += value.capacity();
+    }
+    return bytes;
+  }
+
+ private:
+  struct Slot {
+    // The upper half of the key's hash, to skip most key comparisons.
+    uint32 tag = 0;
+    // 1 + the index of the entry, or 0 for an empty slot.
+    uint32 entry = 0;
+  };
+
+  // Adds entry `i` to the index, unless its key is already there. Returns the
+  // slot of the existing key, or nullptr if the entry was added.
+  const Slot* Index(uint32 i) {
+    const StringPiece k = key(i);
+    const uint64 hash = Hash64(k.data(), k.size());
+    const uint32 tag = static_cast<uint32>(hash >> 32);
+    const size_t mask = slots_.size() - 1;
+    for (size_t s = hash & mask;; s = (s + 1) & mask) {
+      Slot& slot = slots_[s];
+      if (slot.entry == 0) {
+        slot.tag = tag;
+        slot.entry = i + 1;
+        return nullptr;
+      }
+      if (slot.tag == tag && key(slot.entry - 1) == k) return &slot;
+    }
+  }
+
+  void RemoveEntries(const std::vector<bool>& remove) {
+    std::string keys;
+    std::vector<uint64> key_offsets;
+    Values values;
+    for (size_t i = 0; i < values_.size(); ++i) {
+      if (remove[i]) continue;
+      const StringPiece k = key(i);
+      keys.append(k.data(), k.size());
+      key_offsets.push_back(keys.size());
+      values.push_back(std::move(values_[i]));
+    }
+    keys_ = std::move(keys);
+    key_offsets_ = std::move(key_offsets);
+    values_ = std::move(values);
+  }
+
+  std::string keys_;
+  // The end offset of each key in `keys_`.
+  std::vector<uint64> key_offsets_;
+  // Not a std::vector, whose bool specialization cannot hand out `const V*`.
+  using Values = absl::InlinedVector<V, 1>;
+  Values values_;
+  // A power of two number of slots, at most half of them used.
+  std::vector<Slot> slots_;
+};
+
 template <class K, class V>
 class HashTable : public InitializableLookupTable {
  public:
@@ -234,7 +382,7 @@ class HashTable : public InitializableLookupTable {
                            .WithAttr("key_dtype", key_dtype())
                            .WithAttr("value_dtype", value_dtype())
                            .WithAttr("use_node_name_sharing", true));
-    if (table_.empty()) {
+    if (num_entries() == 0) {
       *out = hash_table_node;
       return absl::OkStatus();
     }
@@ -258,7 +406,7 @@ class HashTable : public InitializableLookupTable {
     if (!is_initialized())
       return 0;
     else
-      return table_.size();
+      return num_entries();
   }
 
   Status ExportValues(OpKernelContext* context) override {
@@ -266,7 +414,7 @@ class HashTable : public InitializableLookupTable {
       return errors::Aborted("HashTable is not initialized.");
     }
 
-    const int64_t size = table_.size();
+    const int64_t size = num_entries();
 
     Tensor* keys;
     Tensor* values;
@@ -277,10 +425,17 @@ class HashTable : public InitializableLookupTable {
 
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
-    int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    if constexpr (kFrozen) {
+      for (int64_t i = 0; i < size; ++i) {
+        keys_data(i) = tstring(frozen_table_.key(i));
+        values_data(i) = frozen_table_.value(i);
+      }
+    } else {
+      int64_t i = 0;
+      for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
+      }
     }
     return absl::OkStatus();
   }
@@ -294,7 +449,10 @@ class HashTable : public InitializableLookupTable {
     if (is_initialized()) {
       return errors::Aborted("HashTable already initialized.");
     }
-    if (size > 0) {
+    if constexpr (kFrozen) {
+      frozen_table_ = FrozenStringMap<V>();
+      frozen_table_.Reserve(size);
+    } else if (size > 0) {
       table_.reserve(size);
     }
     return absl::OkStatus();
@@ -307,6 +465,13 @@ class HashTable : public InitializableLookupTable {
   Status DoInsert(const Tensor& keys, const Tensor& values) override {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
+    if constexpr (kFrozen) {
+      // Repeated keys are found once all entries are added.
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        frozen_table_.Add(key_values(i), value_values(i));
+      }
+      return absl::OkStatus();
+    }
     for (int64_t i = 0; i < key_values.size(); ++i) {
       auto&& key = SubtleMustCopyIfIntegral(key_values(i));
       auto&& value = SubtleMustCopyIfIntegral(value_values(i));
@@ -320,12 +485,24 @@ class HashTable : public InitializableLookupTable {
     return absl::OkStatus();
   }
 
+  Status DoFinishInitialization() override {
+    if constexpr (kFrozen) return frozen_table_.Freeze();
+    return absl::OkStatus();
+  }
+
   Status DoFind(const Tensor& key, Tensor* value,
                 const Tensor& default_value) override {
     const V default_val = default_value.flat<V>()(0);
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
+    if constexpr (kFrozen) {
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        const V* found = frozen_table_.Find(key_values(i));
+        value_values(i) = found != nullptr ? *found : default_val;
+      }
+      return absl::OkStatus();
+    }
     for (int64_t i = 0; i < key_values.size(); ++i) {
       value_values(i) = gtl::FindWithDefault(
           table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
@@ -337,12 +514,23 @@ class HashTable : public InitializableLookupTable {
     if (!is_initialized()) {
       return 0;
     }
+    if constexpr (kFrozen) return frozen_table_.MemoryUsed();
     const int64_t num_elements = table_.size();
     return num_elements * (sizeof(K) + sizeof(V));
   }
 
  private:
+  // String keys are kept in a FrozenStringMap, which is indexed once all
+  // entries are inserted.
+  static constexpr bool kFrozen = std::is_same_v<K, tstring>;
+
+  size_t num_entries() const {
+    if constexpr (kFrozen) return frozen_table_.size();
+    return table_.size();
+  }
+
   absl::flat_hash_map<K, V> table_;
+  FrozenStringMap<V> frozen_table_;
 };
 
 }  // namespace lookup
@@ -473,22 +473,6 @@ struct LaunchBatchMatMul<CPUDevice, Scalar> {
   }
 };
 
-#if GOOGLE_CUDA || TF_HIPBLASLT
-
-namespace {
-// A dummy type to group matmul autotune results together.
-struct BlasLtMatmulAutoTuneGroup {
-  static string name() { return "MatmulLt"; }
-};
-
-typedef AutotuneSingleton<BlasLtMatmulAutoTuneGroup, BlasLtMatmulPlanParams,
-                          se::blas::AlgorithmConfig,
-                          absl::Hash<BlasLtMatmulPlanParams>>
-    AutoTuneBatchMatmul;
-
-}  // namespace
-
-#endif  // GOOGLE_CUDA
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 class BlasScratchAllocator : public se::ScratchAllocator {
@@ -53,6 +53,21 @@ bool BlasLtMatmulPlanParams::operator==(
   return internal::AsTuple(*this) == internal::AsTuple(other);
 }
 
+int MatmulMaxAutotuneAlgorithmCount() {
+  int64_t value;
+  Status status =
+      ReadInt64FromEnvVar("TF_MATMUL_AUTOTUNE_MAX_ALGORITHMS", 10, &value);
+  if (!status.ok()) {
+    LOG(ERROR) << status.message();
+  }
+  static constexpr const int kMaxValue = std::numeric_limits<int>::max();
+  if (value < 1 || value > kMaxValue) {
+    LOG(ERROR) << "Invalid value for TF_MATMUL_AUTOTUNE_MAX_ALGORITHMS: "
+               << value << " is not in range [1, " << kMaxValue << "]";
+  }
+  return value;
+}
+
 namespace {
 
 // Thread-safe map from matmul parameters to their corresponding plan and
@@ -71,21 +86,6 @@ struct BlasLtMatmulPlanMap {
       ABSL_GUARDED_BY(mu);
 };
 
-int MatmulMaxAutotuneAlgorithmCount() {
-  int64_t value;
-  Status status =
-      ReadInt64FromEnvVar("TF_MATMUL_AUTOTUNE_MAX_ALGORITHMS", 10, &value);
-  if (!status.ok()) {
-    LOG(ERROR) << status.message();
-  }
-  static constexpr const int kMaxValue = std::numeric_limits<int>::max();
-  if (value < 1 || value > kMaxValue) {
-    LOG(ERROR) << "Invalid value for TF_MATMUL_AUTOTUNE_MAX_ALGORITHMS: "
-               << value << " is not in range [1, " << kMaxValue << "]";
-  }
-  return value;
-}
-
 StatusOr<se::blas::ComputationType> GetBlasComputationType(
     se::blas::DataType dtype) {
   using se::blas::ComputationType;
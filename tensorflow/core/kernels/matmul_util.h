@@ -25,6 +25,7 @@ limitations under the License.
 #include "xla/stream_executor/device_memory.h"
 #include "xla/stream_executor/gpu/gpu_blas_lt.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/gpu_utils.h"
 #include "tsl/platform/types.h"
 
 namespace tensorflow {
@@ -35,6 +36,11 @@ namespace tensorflow {
 int64_t GetWorkspaceLimit(int64_t default_value_in_bytes);
 
 struct BlasLtMatmulPlanParams {
+  // A positive number that denotes the version of this struct. Should be
+  // incremented everytime this struct is updated in a way that may invalidate
+  // the serialized autotune results.
+  static constexpr int kVersion = 1;
+
   std::string ToString() const;
   bool operator==(const BlasLtMatmulPlanParams& other) const;
 
@@ -71,6 +77,21 @@ H AbslHashValue(H h, const BlasLtMatmulPlanParams& params) {
   return H::combine(std::move(h), internal::AsTuple(params));
 }
 
+// Returns the maximum number of algorithms of a matmul which are autotuned.
+int MatmulMaxAutotuneAlgorithmCount();
+
+// A dummy type to group matmul autotune results together.
+struct BlasLtMatmulAutoTuneGroup {
+  static string name() { return "MatmulLt"; }
+};
+
+// The autotuned algorithms of the matmuls, as indices into the algorithms of
+// their PlanAndAlgorithms.
+typedef AutotuneSingleton<BlasLtMatmulAutoTuneGroup, BlasLtMatmulPlanParams,
+                          se::blas::AlgorithmConfig,
+                          absl::Hash<BlasLtMatmulPlanParams>>
+    AutoTuneBatchMatmul;
+
 StatusOr<const PlanAndAlgorithms*> GetPlanAndAlgorithms(
     se::Stream* stream, const BlasLtMatmulPlanParams& params, absl::Mutex** pmu,
     std::optional<int> max_algorithm_count = std::nullopt);
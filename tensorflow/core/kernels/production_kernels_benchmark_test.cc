@@ -0,0 +1,344 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks for the kernels that dominate CPU time in production models, run
+// over a fixed shape matrix so that results are comparable across TensorFlow
+// versions. Run with
+//
+//   bazel run -c opt \
+//     //tensorflow/core/kernels:production_kernels_benchmark_test -- \
+//     --benchmark_filter=all --benchmark_format=json \
+//     --benchmark_out=/tmp/before.json
+//
+// and compare two runs with //tensorflow/tools/test:compare_kernel_benchmarks.
+//
+// The shapes below are part of the contract of this suite: changing them
+// makes results incomparable with earlier runs, so add new shapes instead of
+// editing existing ones.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// All inputs are generated from a fixed seed so that every run of the suite
+// processes the same data.
+constexpr uint64_t kSeed = 301;
+
+Tensor RandomFloatTensor(const TensorShape& shape) {
+  Tensor tensor(DT_FLOAT, shape);
+  random::PhiloxRandom philox(kSeed, 17);
+  random::SimplePhilox rnd(&philox);
+  auto flat = tensor.flat<float>();
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    flat(i) = rnd.RandFloat() * 2.0f - 1.0f;
+  }
+  return tensor;
+}
+
+Tensor RandomIndexTensor(int64_t size, int64_t limit) {
+  Tensor tensor(DT_INT32, TensorShape({size}));
+  random::PhiloxRandom philox(kSeed, 23);
+  random::SimplePhilox rnd(&philox);
+  auto flat = tensor.flat<int32>();
+  for (int64_t i = 0; i < size; ++i) {
+    flat(i) = rnd.Uniform(limit);
+  }
+  return tensor;
+}
+
+Tensor ScalarInt32(int32_t value) {
+  Tensor tensor(DT_INT32, TensorShape({}));
+  tensor.scalar<int32>()() = value;
+  return tensor;
+}
+
+// Runs `graph` on the CPU and reports `items_per_iter` items and
+// `bytes_per_iter` bytes for every iteration.
+void RunCpuBenchmark(::testing::benchmark::State& state, Graph* graph,
+                     int64_t items_per_iter, int64_t bytes_per_iter) {
+  test::Benchmark("cpu", graph, /*old_benchmark_api=*/false).Run(state);
+  const int64_t iterations = static_cast<int64_t>(state.iterations());
+  state.SetItemsProcessed(iterations * items_per_iter);
+  state.SetBytesProcessed(iterations * bytes_per_iter);
+}
+
+// MatMul: [m, k] x [k, n]. Items are multiply-adds.
+void BM_MatMul(::testing::benchmark::State& state) {
+  const int m = state.range(0);
+  const int k = state.range(1);
+  const int n = state.range(2);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Matmul(
+      g, test::graph::Constant(g, RandomFloatTensor(TensorShape({m, k}))),
+      test::graph::Constant(g, RandomFloatTensor(TensorShape({k, n}))),
+      /*transpose_a=*/false, /*transpose_b=*/false);
+  RunCpuBenchmark(state, g, static_cast<int64_t>(m) * k * n,
+                  (static_cast<int64_t>(m) * k + k * n + m * n) *
+                      sizeof(float));
+}
+BENCHMARK(BM_MatMul)
+    ->Args({1, 512, 512})       // Single-example serving, dense layer.
+    ->Args({32, 768, 3072})     // Transformer FFN, small batch.
+    ->Args({512, 1024, 1024})   // Transformer projection.
+    ->Args({2048, 256, 256})    // Ranking tower.
+    ->Args({4096, 128, 1024});  // Wide embedding projection.
+
+// Conv2D in NHWC with SAME padding and unit strides: input [b, h, w, c_in],
+// filter [f, f, c_in, c_out]. Items are multiply-adds.
+void BM_Conv2D(::testing::benchmark::State& state) {
+  const int batch = state.range(0);
+  const int size = state.range(1);
+  const int in_depth = state.range(2);
+  const int filter = state.range(3);
+  const int out_depth = state.range(4);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Conv2D(
+      g,
+      test::graph::Constant(
+          g, RandomFloatTensor(TensorShape({batch, size, size, in_depth}))),
+      test::graph::Constant(g, RandomFloatTensor(TensorShape(
+                                   {filter, filter, in_depth, out_depth}))));
+  const int64_t outputs = static_cast<int64_t>(batch) * size * size * out_depth;
+  RunCpuBenchmark(state, g, outputs * filter * filter * in_depth,
+                  (static_cast<int64_t>(batch) * size * size * in_depth +
+                   outputs) *
+                      sizeof(float));
+}
+BENCHMARK(BM_Conv2D)
+    ->Args({32, 56, 64, 3, 64})     // ResNet stage 1.
+    ->Args({32, 28, 128, 3, 128})   // ResNet stage 2.
+    ->Args({32, 14, 256, 1, 1024})  // ResNet bottleneck expansion.
+    ->Args({32, 7, 512, 3, 512})    // ResNet stage 4.
+    ->Args({1, 112, 32, 3, 32});    // Mobile vision serving.
+
+// GatherV2 on axis 0 from a [vocab, dim] table. Items are gathered floats.
+void BM_Gather(::testing::benchmark::State& state) {
+  const int vocab = state.range(0);
+  const int dim = state.range(1);
+  const int lookups = state.range(2);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Gather(
+      g, test::graph::Constant(g, RandomFloatTensor(TensorShape({vocab, dim}))),
+      test::graph::Constant(g, RandomIndexTensor(lookups, vocab)),
+      test::graph::Constant(g, ScalarInt32(0)));
+  const int64_t items = static_cast<int64_t>(lookups) * dim;
+  RunCpuBenchmark(state, g, items, items * sizeof(float));
+}
+BENCHMARK(BM_Gather)
+    ->Args({100000, 16, 4096})
+    ->Args({100000, 64, 4096})
+    ->Args({1000000, 128, 16384})
+    ->Args({32000, 768, 512});  // Token embedding lookup.
+
+// SparseSegmentSum over a [vocab, dim] table into `num_segments` sorted
+// segments of `ids_per_segment` ids each, as produced by embedding bag lookups.
+void BM_SparseSegmentSum(::testing::benchmark::State& state) {
+  const int vocab = state.range(0);
+  const int dim = state.range(1);
+  const int num_segments = state.range(2);
+  const int ids_per_segment = state.range(3);
+  const int num_ids = num_segments * ids_per_segment;
+  Tensor segment_ids(DT_INT32, TensorShape({num_ids}));
+  auto segment_ids_flat = segment_ids.flat<int32>();
+  for (int i = 0; i < num_ids; ++i) {
+    segment_ids_flat(i) = i / ids_per_segment;
+  }
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* node;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+          .Input(test::graph::Constant(
+              g, RandomFloatTensor(TensorShape({vocab, dim}))))
+          .Input(test::graph::Constant(g, RandomIndexTensor(num_ids, vocab)))
+          .Input(test::graph::Constant(g, segment_ids))
+          .Finalize(g, &node));
+  const int64_t items = static_cast<int64_t>(num_ids) * dim;
+  RunCpuBenchmark(state, g, items, items * sizeof(float));
+}
+BENCHMARK(BM_SparseSegmentSum)
+    ->Args({100000, 16, 512, 16})
+    ->Args({100000, 64, 512, 16})
+    ->Args({1000000, 32, 4096, 50})
+    ->Args({100000, 256, 128, 4});
+
+// Softmax over the last dimension of a [rows, classes] tensor.
+void BM_Softmax(::testing::benchmark::State& state) {
+  const int rows = state.range(0);
+  const int classes = state.range(1);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Unary(g, "Softmax",
+                     test::graph::Constant(
+                         g, RandomFloatTensor(TensorShape({rows, classes}))));
+  const int64_t items = static_cast<int64_t>(rows) * classes;
+  RunCpuBenchmark(state, g, items, 2 * items * sizeof(float));
+}
+BENCHMARK(BM_Softmax)
+    ->Args({512, 1000})    // Image classification head.
+    ->Args({4096, 128})    // Attention scores, short sequences.
+    ->Args({1024, 1024})   // Attention scores, long sequences.
+    ->Args({32, 32000});   // Language model vocabulary head.
+
+// Layer normalization as emitted by Keras when it is not fused:
+//   mean = Mean(x, -1), var = Mean(Square(x - mean), -1),
+//   y = (x - mean) * Rsqrt(var + epsilon).
+void BM_LayerNormPattern(::testing::benchmark::State& state) {
+  const int rows = state.range(0);
+  const int dim = state.range(1);
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* x = test::graph::Constant(
+      g, RandomFloatTensor(TensorShape({rows, dim})));
+  Node* axis = test::graph::Constant(g, ScalarInt32(-1));
+  Node* mean = test::graph::Reduce(g, "Mean", x, axis, /*keep_dims=*/true);
+  Node* centered = test::graph::Binary(g, "Sub", x, mean);
+  Node* var = test::graph::Reduce(
+      g, "Mean", test::graph::Unary(g, "Square", centered), axis,
+      /*keep_dims=*/true);
+  Tensor epsilon(DT_FLOAT, TensorShape({}));
+  epsilon.scalar<float>()() = 1e-6f;
+  Node* inv_stddev = test::graph::Unary(
+      g, "Rsqrt",
+      test::graph::Binary(g, "AddV2", var, test::graph::Constant(g, epsilon)));
+  test::graph::Binary(g, "Mul", centered, inv_stddev);
+  const int64_t items = static_cast<int64_t>(rows) * dim;
+  RunCpuBenchmark(state, g, items, 2 * items * sizeof(float));
+}
+BENCHMARK(BM_LayerNormPattern)
+    ->Args({4096, 768})
+    ->Args({512, 1024})
+    ->Args({16384, 256});
+
+// ParseExampleV2 of a batch of serialized Examples, each holding `num_keys`
+// dense float features of `feature_size` values.
+void BM_ParseExample(::testing::benchmark::State& state) {
+  const int batch_size = state.range(0);
+  const int num_keys = state.range(1);
+  const int feature_size = state.range(2);
+
+  Example example;
+  auto* features = example.mutable_features()->mutable_feature();
+  Tensor keys(DT_STRING, TensorShape({num_keys}));
+  Graph* g = new Graph(OpRegistry::Global());
+  std::vector<NodeBuilder::NodeOut> dense_defaults;
+  std::vector<PartialTensorShape> dense_shapes;
+  for (int k = 0; k < num_keys; ++k) {
+    const std::string key = strings::StrCat("feature_", k);
+    keys.flat<tstring>()(k) = key;
+    auto* values = (*features)[key].mutable_float_list();
+    for (int i = 0; i < feature_size; ++i) {
+      values->add_value(static_cast<float>(i));
+    }
+    dense_defaults.emplace_back(test::graph::Constant(
+        g, RandomFloatTensor(TensorShape({feature_size}))));
+    dense_shapes.push_back(PartialTensorShape({feature_size}));
+  }
+  Tensor serialized(DT_STRING, TensorShape({batch_size}));
+  const std::string serialized_example = example.SerializeAsString();
+  for (int b = 0; b < batch_size; ++b) {
+    serialized.flat<tstring>()(b) = serialized_example;
+  }
+  Tensor names(DT_STRING, TensorShape({batch_size}));
+  Tensor empty_keys(DT_STRING, TensorShape({0}));
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "ParseExampleV2")
+                  .Input(test::graph::Constant(g, serialized))
+                  .Input(test::graph::Constant(g, names))
+                  .Input(test::graph::Constant(g, empty_keys))
+                  .Input(test::graph::Constant(g, keys))
+                  .Input(test::graph::Constant(g, empty_keys))
+                  .Input(dense_defaults)
+                  .Attr("num_sparse", 0)
+                  .Attr("sparse_types", DataTypeVector())
+                  .Attr("ragged_value_types", DataTypeVector())
+                  .Attr("ragged_split_types", DataTypeVector())
+                  .Attr("dense_shapes", dense_shapes)
+                  .Finalize(g, &node));
+  RunCpuBenchmark(
+      state, g, static_cast<int64_t>(batch_size) * num_keys * feature_size,
+      static_cast<int64_t>(batch_size) * serialized_example.size());
+}
+BENCHMARK(BM_ParseExample)
+    ->Args({128, 10, 1})
+    ->Args({128, 100, 1})
+    ->Args({512, 20, 16})
+    ->Args({32, 10, 1024});
+
+// Unique over `size` int64 ids drawn from `distinct` possible values.
+void BM_Unique(::testing::benchmark::State& state) {
+  const int size = state.range(0);
+  const int distinct = state.range(1);
+  Tensor ids(DT_INT64, TensorShape({size}));
+  random::PhiloxRandom philox(kSeed, 29);
+  random::SimplePhilox rnd(&philox);
+  auto ids_flat = ids.flat<int64_t>();
+  for (int i = 0; i < size; ++i) {
+    ids_flat(i) = rnd.Uniform(distinct);
+  }
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Unique")
+                  .Input(test::graph::Constant(g, ids))
+                  .Attr("T", DT_INT64)
+                  .Attr("out_idx", DT_INT32)
+                  .Finalize(g, &node));
+  RunCpuBenchmark(state, g, size, static_cast<int64_t>(size) * sizeof(int64_t));
+}
+BENCHMARK(BM_Unique)
+    ->Args({4096, 1000})
+    ->Args({100000, 1000})
+    ->Args({1000000, 100000});
+
+// TopKV2 over the last dimension of a [rows, cols] tensor.
+void BM_TopK(::testing::benchmark::State& state) {
+  const int rows = state.range(0);
+  const int cols = state.range(1);
+  const int k = state.range(2);
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "TopKV2")
+                  .Input(test::graph::Constant(
+                      g, RandomFloatTensor(TensorShape({rows, cols}))))
+                  .Input(test::graph::Constant(g, ScalarInt32(k)))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+  const int64_t items = static_cast<int64_t>(rows) * cols;
+  RunCpuBenchmark(state, g, items, items * sizeof(float));
+}
+BENCHMARK(BM_TopK)
+    ->Args({128, 1000, 10})    // Classification top-k.
+    ->Args({32, 100000, 100})  // Retrieval candidates.
+    ->Args({1024, 512, 5});    // Beam search.
+
+}  // namespace
+}  // namespace tensorflow
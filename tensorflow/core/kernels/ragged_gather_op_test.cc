@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/shape_inference.h"
@@ -20,9 +21,13 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -278,5 +283,55 @@ TEST_F(RaggedGatherOpTest, ShapeFn) {
   INFER_OK(op, "[?];[?];[]", "[?]");
 }
 
+// Gathers `num_indices` of 16384 ragged rows of up to `max_row_length` values
+// of `value_size` floats.
+static Graph* RaggedGather(int num_indices, int max_row_length,
+                           int value_size) {
+  constexpr int kNumParams = 16384;
+  Graph* g = new Graph(OpRegistry::Global());
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  Tensor params_splits(DT_INT64, TensorShape({kNumParams + 1}));
+  auto splits = params_splits.vec<int64_t>();
+  splits(0) = 0;
+  for (int i = 0; i < kNumParams; ++i) {
+    splits(i + 1) = splits(i) + rnd.Uniform(max_row_length + 1);
+  }
+  Tensor params_values(DT_FLOAT, TensorShape({splits(kNumParams), value_size}));
+  params_values.flat<float>().setRandom();
+  Tensor indices(DT_INT32, TensorShape({num_indices}));
+  for (int i = 0; i < num_indices; ++i) {
+    indices.vec<int32>()(i) = rnd.Uniform(kNumParams);
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "RaggedGather")
+                  .Input(std::vector<NodeBuilder::NodeOut>{
+                      test::graph::Constant(g, params_splits)})
+                  .Input(test::graph::Constant(g, params_values))
+                  .Input(test::graph::Constant(g, indices))
+                  .Attr("OUTPUT_RAGGED_RANK", 1)
+                  .Finalize(g, &node));
+  return g;
+}
+
+static void BM_RaggedGather(::testing::benchmark::State& state) {
+  const int num_indices = state.range(0);
+  const int max_row_length = state.range(1);
+  const int value_size = state.range(2);
+  test::Benchmark("cpu", RaggedGather(num_indices, max_row_length, value_size),
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_indices);
+}
+
+BENCHMARK(BM_RaggedGather)
+    ->UseRealTime()
+    ->Args({1024, 16, 1})
+    ->Args({1024, 16, 64})
+    ->Args({16384, 64, 1})
+    ->Args({16384, 64, 16});
+
 }  // namespace
 }  // namespace tensorflow
@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/bcast.h"
 #include "tensorflow/core/util/ragged_to_dense_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -117,6 +118,21 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
     return max_width;
   }
 
+  // Returns whether `row_split` starts at zero and is sorted, so that each row
+  // covers its own range of the values.
+  static bool IsValidRowSplit(const RowPartitionTensor& row_split) {
+    const INDEX_TYPE tensor_length = row_split.size();
+    if (tensor_length == 0 || row_split(0) != 0) {
+      return false;
+    }
+    for (INDEX_TYPE i = 1; i < tensor_length; ++i) {
+      if (row_split(i) < row_split(i - 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   static INDEX_TYPE GetMaxWidthValueRowID(
       const RowPartitionTensor& value_rowids) {
     const INDEX_TYPE index_length = value_rowids.size();
@@ -208,11 +224,42 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
   }
 
   Status CalculateOutputIndexRowSplit(
-      const RowPartitionTensor& row_split,
+      OpKernelContext* context, const RowPartitionTensor& row_split,
       const vector<INDEX_TYPE>& parent_output_index,
       INDEX_TYPE output_index_multiplier, INDEX_TYPE output_size,
       vector<INDEX_TYPE>* result) {
     INDEX_TYPE row_split_size = row_split.size();
+    if (IsValidRowSplit(row_split)) {
+      // Every row writes its own range of `result`, so the rows are decoded
+      // in parallel.
+      result->resize(row_split(row_split_size - 1));
+      INDEX_TYPE* const result_base = result->data();
+      auto decode_rows = [&](int64_t start, int64_t limit) {
+        for (int64_t i = start; i < limit; ++i) {
+          INDEX_TYPE* out = result_base + row_split(i);
+          const INDEX_TYPE row_length = row_split(i + 1) - row_split(i);
+          INDEX_TYPE parent_output_index_current = parent_output_index[i];
+          const INDEX_TYPE real_length =
+              parent_output_index_current == -1
+                  ? 0
+                  : std::min(output_size, row_length);
+          for (INDEX_TYPE j = 0; j < real_length; ++j) {
+            out[j] = parent_output_index_current;
+            parent_output_index_current += output_index_multiplier;
+          }
+          std::fill(out + real_length, out + row_length, -1);
+        }
+      };
+      const int64_t num_rows = row_split_size - 1;
+      const int64_t cost_per_row =
+          num_rows == 0 ? 0
+                        : 2 * static_cast<int64_t>(result->size()) / num_rows;
+      auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+      Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+            cost_per_row, decode_rows);
+      return absl::OkStatus();
+    }
+
     if (row_split_size > 0) {
       result->reserve(row_split(row_split_size - 1));
     }
@@ -336,8 +383,8 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
               parent_output_index.size());
         }
         return CalculateOutputIndexRowSplit(
-            row_partition_tensor, parent_output_index, output_index_multiplier,
-            output_size, result);
+            context, row_partition_tensor, parent_output_index,
+            output_index_multiplier, output_size, result);
       default:
         return errors::InvalidArgument(
             "Unsupported partition type:",
@@ -397,8 +444,25 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
                    context->allocate_output(0, output_shape, &output_tensor));
     const INDEX_TYPE full_size = multiplier[0] * output_size[0];
     if (full_size > 0) {
-      vector<INDEX_TYPE> output_index, new_output_index;
       int nvals = context->input(kValueInputIndex).shape().dim_size(0);
+      // The common case of a single ragged dimension given by row splits
+      // copies each row directly, without computing an output index for
+      // every value.
+      if (row_partition_types_.size() == 1 &&
+          row_partition_types_[0] == RowPartitionType::ROW_SPLITS) {
+        const RowPartitionTensor row_split =
+            GetRowPartitionTensor(context, 0);
+        if (IsValidRowSplit(row_split)) {
+          OP_REQUIRES(context, row_split(row_split.size() - 1) <= nvals,
+                      errors::InvalidArgument(
+                          "Row splits point past the values: ",
+                          row_split(row_split.size() - 1), " > ", nvals));
+          SetOutputFromRowSplit(context, row_split, output_tensor);
+          return;
+        }
+      }
+
+      vector<INDEX_TYPE> output_index, new_output_index;
       output_index.reserve(nvals);
       new_output_index.reserve(nvals);
 
@@ -419,6 +483,12 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
                          const vector<INDEX_TYPE>& output_index,
                          Tensor* output_tensor) = 0;
 
+  // Writes the output of a tensor with one ragged dimension, whose rows are
+  // given by the valid `row_split`.
+  virtual void SetOutputFromRowSplit(OpKernelContext* context,
+                                     const RowPartitionTensor& row_split,
+                                     Tensor* output_tensor) = 0;
+
  private:
   vector<RowPartitionType> row_partition_types_;
   int ragged_rank_;
@@ -466,9 +536,92 @@ void copy_array<Eigen::half, int32>(Eigen::half* dst, const Eigen::half* src,
 template <typename VALUE_TYPE, typename INDEX_TYPE>
 class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
  public:
+  using typename RaggedTensorToTensorBaseOp<INDEX_TYPE>::RowPartitionTensor;
+
   explicit RaggedTensorToTensorOp(OpKernelConstruction* context)
       : RaggedTensorToTensorBaseOp<INDEX_TYPE>(context) {}
 
+  // Sets `*default_value` to the default value broadcast to `element_shape`,
+  // which may be stored in `bcast_default`. Skips the broadcast if the
+  // default value is a scalar, which the callers fill with std::fill.
+  Status GetDefaultValue(OpKernelContext* context,
+                         const TensorShape& element_shape,
+                         Tensor* bcast_default,
+                         const VALUE_TYPE** default_value) {
+    const auto& default_value_tensor = context->input(kDefaultValueInputIndex);
+    *default_value = default_value_tensor.flat<VALUE_TYPE>().data();
+    if (default_value_tensor.NumElements() != element_shape.num_elements() &&
+        default_value_tensor.NumElements() != 1) {
+      const auto& src_shape = default_value_tensor.shape();
+      BCast bcast(BCast::FromShape(src_shape), BCast::FromShape(element_shape),
+                  /*fewer_dims_optimization=*/true);
+      // Note: bcast should always be valid, since we rejected any incompatible
+      // shapes when we called ValidateDefaultValueShape().
+      if (!bcast.IsValid()) {
+        return errors::InvalidArgument("Error broadcasting default_value");
+      }
+      TF_RETURN_IF_ERROR(context->allocate_temp(default_value_tensor.dtype(),
+                                                element_shape, bcast_default));
+      const CPUDevice& device = context->eigen_device<CPUDevice>();
+      functor::BroadcastTo<CPUDevice, VALUE_TYPE>()(
+          device, context, *bcast_default, element_shape, default_value_tensor,
+          src_shape, bcast);
+      *default_value = bcast_default->flat<VALUE_TYPE>().data();
+    }
+    return absl::OkStatus();
+  }
+
+  void SetOutputFromRowSplit(OpKernelContext* context,
+                             const RowPartitionTensor& row_split,
+                             Tensor* output_tensor) override {
+    if (output_tensor->NumElements() == 0) return;
+
+    const VALUE_TYPE* values_base =
+        context->input(kValueInputIndex).flat<VALUE_TYPE>().data();
+    VALUE_TYPE* output_base = output_tensor->flat<VALUE_TYPE>().data();
+    TensorShape element_shape = output_tensor->shape();
+    element_shape.RemoveDimRange(0, 2);
+    const int64_t value_element_size = element_shape.num_elements();
+    const bool scalar_default =
+        context->input(kDefaultValueInputIndex).NumElements() == 1;
+    Tensor bcast_default;
+    const VALUE_TYPE* default_value;
+    OP_REQUIRES_OK(context, GetDefaultValue(context, element_shape,
+                                            &bcast_default, &default_value));
+
+    const int64_t num_rows = output_tensor->dim_size(0);
+    const int64_t num_columns = output_tensor->dim_size(1);
+    const int64_t row_size = num_columns * value_element_size;
+    const int64_t num_value_rows = row_split.size() - 1;
+    // Each output row is a block copy of the start of a ragged row, followed
+    // by padding. Rows beyond the ragged rows are all padding.
+    auto write_rows = [&](int64_t start, int64_t limit) {
+      for (int64_t row = start; row < limit; ++row) {
+        VALUE_TYPE* dst = output_base + row * row_size;
+        int64_t num_copied = 0;
+        if (row < num_value_rows) {
+          const int64_t row_length = row_split(row + 1) - row_split(row);
+          num_copied = std::min(row_length, num_columns) * value_element_size;
+          copy_array<VALUE_TYPE, INDEX_TYPE>(
+              dst, values_base + row_split(row) * value_element_size,
+              static_cast<INDEX_TYPE>(num_copied));
+        }
+        if (scalar_default) {
+          std::fill(dst + num_copied, dst + row_size, *default_value);
+        } else {
+          for (int64_t i = num_copied; i < row_size; i += value_element_size) {
+            copy_array<VALUE_TYPE, INDEX_TYPE>(dst + i, default_value,
+                                               value_element_size);
+          }
+        }
+      }
+    };
+    const int64_t cost_per_row = row_size * sizeof(VALUE_TYPE);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+          cost_per_row, write_rows);
+  }
+
   void SetOutput(OpKernelContext* context, int ragged_rank,
                  const vector<INDEX_TYPE>& output_index,
                  Tensor* output_tensor) override {
@@ -488,30 +641,11 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
     int value_element_size = element_shape.num_elements();
     size_t output_index_size = output_index.size();
 
-    // Broadcast the default value to value_element_size.  (We can skip this
-    // if default_value_tensor.NumElements() == 1, since we use std::fill
-    // when that's true.)
-    const VALUE_TYPE* default_value =
-        default_value_tensor.flat<VALUE_TYPE>().data();
+    // Broadcast the default value to value_element_size.
+    const VALUE_TYPE* default_value;
     Tensor bcast_default;  // Temporary tensor for result of broadcast
-    if (default_value_tensor.NumElements() != value_element_size &&
-        default_value_tensor.NumElements() != 1) {
-      const auto& src_shape = default_value_tensor.shape();
-      BCast bcast(BCast::FromShape(src_shape), BCast::FromShape(element_shape),
-                  /*fewer_dims_optimization=*/true);
-      // Note: bcast should always be valid, since we rejected any incompatible
-      // shapes when we called ValidateDefaultValueShape().
-      OP_REQUIRES(context, bcast.IsValid(),
-                  errors::InvalidArgument("Error broadcasting default_value"));
-      OP_REQUIRES_OK(context,
-                     context->allocate_temp(default_value_tensor.dtype(),
-                                            element_shape, &bcast_default));
-      const CPUDevice& device = context->eigen_device<CPUDevice>();
-      functor::BroadcastTo<CPUDevice, VALUE_TYPE>()(
-          device, context, bcast_default, element_shape, default_value_tensor,
-          src_shape, bcast);
-      default_value = bcast_default.flat<VALUE_TYPE>().data();
-    }
+    OP_REQUIRES_OK(context, GetDefaultValue(context, element_shape,
+                                            &bcast_default, &default_value));
 
     // Loop through the output_index vector, finding contiguous regions that
     // should be copied.  Once we find the end of a contiguous region, copy it
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
@@ -21,9 +22,13 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -135,6 +140,41 @@ TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorRowSplits) {
       0.01);
 }
 
+TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorRowSplitsPadded) {
+  // params = [[[1, 2]], [], [[3, 4], [5, 6], [7, 8]]]
+  // padded and truncated to (4, 2, 2) with a vector default value.
+  BuildRaggedTensorToTensorGraph<int32, int32>(
+      TensorShape({4, 2, 2}),  // shape
+      {"ROW_SPLITS"},          // row_partition_types
+      {TensorShape({4, 2}), {1, 2, 3, 4, 5, 6, 7, 8}},  // values
+      createVector<int32>({8, 9}),                      // default_value
+      {createVector<int32>({0, 1, 1, 4})}               // row_partition_tensors
+  );
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<int32>(*GetOutput(0),
+                                 test::AsTensor<int32>(
+                                     {
+                                         1, 2, 8, 9,  //
+                                         8, 9, 8, 9,  //
+                                         3, 4, 5, 6,  //
+                                         8, 9, 8, 9   //
+                                     },
+                                     TensorShape({4, 2, 2})));
+}
+
+TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorRowSplitsPastValues) {
+  BuildRaggedTensorToTensorGraph<float, int32>(
+      TensorShape({2, 3}),                   // shape
+      {"ROW_SPLITS"},                        // row_partition_types
+      createVector<float>({.1, .2, .3, .4}),  // values
+      createScalar<float>(1.5),              // default_value
+      {createVector<int32>({0, 2, 5})}       // row_partition_tensors
+  );
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
 TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensor_3DParams) {
   // params = [
   //           [[]],
@@ -555,5 +595,53 @@ TEST_F(RaggedTensorToTensorOpUnknownShapeTest, RowSplits) {
   INFER_OK(*op_, "?;[3,2,7];[2,7];[6]", "[?,?,2,7]");
 }
 
+// Converts `num_rows` ragged rows of up to `max_row_length` floats.
+static Graph* RaggedTensorToTensor(int num_rows, int max_row_length) {
+  Graph* g = new Graph(OpRegistry::Global());
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  Tensor row_splits(DT_INT64, TensorShape({num_rows + 1}));
+  auto splits = row_splits.vec<int64_t>();
+  splits(0) = 0;
+  for (int i = 0; i < num_rows; ++i) {
+    splits(i + 1) = splits(i) + rnd.Uniform(max_row_length + 1);
+  }
+  Tensor values(DT_FLOAT, TensorShape({splits(num_rows)}));
+  values.flat<float>().setRandom();
+  Tensor shape(DT_INT64, TensorShape({2}));
+  shape.vec<int64_t>()(0) = num_rows;
+  shape.vec<int64_t>()(1) = max_row_length;
+  Tensor default_value(DT_FLOAT, TensorShape({}));
+  default_value.scalar<float>()() = 0;
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "RaggedTensorToTensor")
+                  .Input(test::graph::Constant(g, shape))
+                  .Input(test::graph::Constant(g, values))
+                  .Input(test::graph::Constant(g, default_value))
+                  .Input(std::vector<NodeBuilder::NodeOut>{
+                      test::graph::Constant(g, row_splits)})
+                  .Attr("row_partition_types", {"ROW_SPLITS"})
+                  .Finalize(g, &node));
+  return g;
+}
+
+static void BM_RaggedTensorToTensor(::testing::benchmark::State& state) {
+  const int num_rows = state.range(0);
+  const int max_row_length = state.range(1);
+  test::Benchmark("cpu", RaggedTensorToTensor(num_rows, max_row_length),
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_rows * max_row_length);
+}
+
+BENCHMARK(BM_RaggedTensorToTensor)
+    ->UseRealTime()
+    ->ArgPair(128, 16)
+    ->ArgPair(1024, 16)
+    ->ArgPair(1024, 256)
+    ->ArgPair(16384, 64);
+
 }  // namespace
 }  // namespace tensorflow
@@ -72,6 +72,20 @@ struct FillPhiloxRandom {
   }
 };
 
+// A generator returning the groups of random bits computed ahead by
+// PhiloxRandom::Generate, in order.
+class GeneratedBits {
+ public:
+  using ResultType = PhiloxRandom::ResultType;
+
+  explicit GeneratedBits(const ResultType* bits) : next_(bits) {}
+
+  ResultType operator()() { return *next_++; }
+
+ private:
+  const ResultType* next_;
+};
+
 // A class to fill a specified range of random groups
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
@@ -88,12 +102,22 @@ struct FillPhiloxRandomTask<Distribution, false> {
     gen.Skip(start_group);
     int64_t offset = start_group * kGroupSize;
 
-    // First fill all the full-size groups
+    // First fill all the full-size groups. The random bits of several groups
+    // are computed at once, which PhiloxRandom can vectorize, and the
+    // distribution consumes one of them per group.
     int64_t limit_group_full = std::min(limit_group, size / kGroupSize);
-    for (int64_t index = start_group; index < limit_group_full; ++index) {
-      auto samples = dist(&gen);
-      std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
-      offset += kGroupSize;
+    PhiloxRandom::ResultType bits[PhiloxRandom::kBatchSize];
+    for (int64_t index = start_group; index < limit_group_full;
+         index += PhiloxRandom::kBatchSize) {
+      const int num_groups = std::min<int64_t>(PhiloxRandom::kBatchSize,
+                                               limit_group_full - index);
+      gen.Generate(bits, num_groups);
+      GeneratedBits generated_bits(bits);
+      for (int i = 0; i < num_groups; ++i) {
+        auto samples = dist(&generated_bits);
+        std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
+        offset += kGroupSize;
+      }
     }
 
     // If there are any remaining elements that need to be filled, process them
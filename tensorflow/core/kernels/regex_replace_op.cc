@@ -45,13 +45,18 @@ Status InternalCompute(const RE2& regex, const string& rewrite,
   } else {
     TF_RETURN_IF_ERROR(
         ctx->allocate_output("output", input_tensor->shape(), &output_tensor));
-    output_tensor->flat<tstring>() = input_tensor->flat<tstring>();
   }
+  const auto input_flat = input_tensor->flat<tstring>();
   auto output_flat = output_tensor->flat<tstring>();
   for (size_t i = 0; i < output_flat.size(); ++i) {
+    // A forwarded output already holds the strings, so the ones without any
+    // match are skipped without copying them into the temporary string.
+    if (maybe_forwarded && !RE2::PartialMatch(input_flat(i), regex)) {
+      continue;
+    }
     // TODO(dero): Mitigate copy; Global and GlobalReplace below currently only
     // accept std::string.
-    string buf = output_flat(i);
+    string buf = input_flat(i);
     if (replace_global) {
       RE2::GlobalReplace(&buf, regex, rewrite);
     } else {
@@ -134,4 +134,61 @@ BENCHMARK(BM_StaticRegexReplace)
     ->Arg(128)
     ->Arg(256);
 
+class RegexReplaceOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(bool replace_global) {
+    TF_ASSERT_OK(NodeDefBuilder("regex_replace_op", "RegexReplace")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_STRING))
+                     .Attr("replace_global", replace_global)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void Run(const std::vector<tstring>& input, const string& pattern,
+           const string& rewrite) {
+    AddInputFromArray<tstring>(
+        TensorShape({static_cast<int64_t>(input.size())}), input);
+    AddInputFromArray<tstring>(TensorShape({}), {pattern});
+    AddInputFromArray<tstring>(TensorShape({}), {rewrite});
+    TF_ASSERT_OK(RunOpKernel());
+  }
+};
+
+TEST_F(RegexReplaceOpTest, ReplacesAllMatches) {
+  MakeOp(/*replace_global=*/true);
+  Run({"a.b.c", "abc"}, "\\.", "-");
+  test::ExpectTensorEqual<tstring>(
+      *GetOutput(0), test::AsTensor<tstring>({"a-b-c", "abc"}));
+}
+
+TEST_F(RegexReplaceOpTest, ReplacesFirstMatch) {
+  MakeOp(/*replace_global=*/false);
+  Run({"a.b.c", "abc"}, "\\.", "-");
+  test::ExpectTensorEqual<tstring>(
+      *GetOutput(0), test::AsTensor<tstring>({"a-b.c", "abc"}));
+}
+
+TEST_F(RegexReplaceOpTest, NoMatchKeepsInputs) {
+  MakeOp(/*replace_global=*/true);
+  Run({"abc", "", "def"}, "x+", "-");
+  test::ExpectTensorEqual<tstring>(
+      *GetOutput(0), test::AsTensor<tstring>({"abc", "", "def"}));
+}
+
+TEST_F(RegexReplaceOpTest, NoMatchKeepsInputsReplaceFirst) {
+  MakeOp(/*replace_global=*/false);
+  Run({"abc", "", "def"}, "x+", "-");
+  test::ExpectTensorEqual<tstring>(
+      *GetOutput(0), test::AsTensor<tstring>({"abc", "", "def"}));
+}
+
+TEST_F(RegexReplaceOpTest, EmptyMatchIsReplaced) {
+  MakeOp(/*replace_global=*/false);
+  Run({"abc"}, "x*", "-");
+  test::ExpectTensorEqual<tstring>(*GetOutput(0),
+                                   test::AsTensor<tstring>({"-abc"}));
+}
+
 }  // end namespace tensorflow
@@ -58,6 +58,7 @@ limitations under the License.
 #endif
 
 #include <memory>
+#include <optional>
 #include <type_traits>
 #include <vector>
 
@@ -86,6 +87,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/determinism.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
@@ -707,6 +709,66 @@ REGISTER_KERNEL_BUILDER(Name("VarIsInitializedOp")
                             .HostMemory("is_initialized"),
                         VarIsInitializedOp);
 
+namespace {
+
+// Whether gathers read variables through a snapshot, see
+// `SparseReadVariable`.
+bool GatherUsesSnapshotReads() {
+  static const bool snapshot_reads = [] {
+    bool value;
+    Status status = ReadBoolFromEnvVar("TF_RESOURCE_GATHER_SNAPSHOT_READS",
+                                       /*default_val=*/false, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      return false;
+    }
+    return value;
+  }();
+  return snapshot_reads;
+}
+
+// Gives a gather read access to the tensor of a variable.
+//
+// By default the variable is switched to copy-on-read mode and its mutex is
+// held in shared mode while this object lives, which blocks writers for the
+// whole gather and makes every later dense read copy the variable.
+//
+// With snapshot reads, a variable still in copy-on-write mode is instead read
+// through an alias of its tensor taken under a short shared lock. The gather
+// then runs without the lock, writers that find the alias copy the buffer
+// before updating it (or update it in place once the gather is done), and the
+// old buffer is freed with the last alias. Variables that are already in
+// copy-on-read mode, e.g. because of sparse writes, are read as by default.
+template <typename Device, typename T>
+class SparseReadVariable {
+ public:
+  SparseReadVariable(OpKernelContext* c, Var* var, bool snapshot_reads) {
+    if (snapshot_reads) {
+      tf_shared_lock ml(*var->mu());
+      if (!var->copy_on_read_mode.load()) {
+        snapshot_ = *var->tensor();
+        tensor_ = &snapshot_;
+        return;
+      }
+    }
+    status_ = EnsureSparseVariableAccess<Device, T>(c, var);
+    if (!status_.ok()) return;
+    lock_.emplace(*var->mu());
+    tensor_ = var->tensor();
+  }
+
+  const Status& status() const { return status_; }
+  const Tensor& tensor() const { return *tensor_; }
+
+ private:
+  Status status_;
+  Tensor snapshot_;
+  std::optional<tf_shared_lock> lock_;
+  const Tensor* tensor_ = nullptr;
+};
+
+}  // namespace
+
 template <typename Device, typename T, typename Index>
 class ResourceGatherOp : public OpKernel {
  public:
@@ -715,19 +777,20 @@ class ResourceGatherOp : public OpKernel {
     OP_REQUIRES(c, batch_dims_ >= 0,
                 absl::InvalidArgumentError(absl::StrCat(
                     "batch_dims is negative (", batch_dims_, ")")));
+    snapshot_reads_ = GatherUsesSnapshotReads();
   }
 
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
-    // NOTE: We hold the lock for the whole gather operation instead
-    // of increasing the reference count of v->tensor() to avoid a
-    // situation where a write to the same variable will see a
-    // reference count greater than one and make a copy of the
+    // NOTE: Unless snapshot reads are enabled, we hold the lock for the whole
+    // gather operation instead of increasing the reference count of
+    // v->tensor() to avoid a situation where a write to the same variable will
+    // see a reference count greater than one and make a copy of the
     // (potentially very large) tensor buffer.
-    tf_shared_lock ml(*v->mu());
-    const Tensor& params = *v->tensor();
+    SparseReadVariable<Device, T> variable(c, v.get(), snapshot_reads_);
+    OP_REQUIRES_OK(c, variable.status());
+    const Tensor& params = variable.tensor();
     const Tensor& indices = c->input(1);
     OP_REQUIRES(
         c, TensorShapeUtils::IsVectorOrHigher(params.shape()),
@@ -839,6 +902,7 @@ class ResourceGatherOp : public OpKernel {
   }
 
   int32 batch_dims_ = 0;
+  bool snapshot_reads_ = false;
 };
 
 #define REGISTER_GATHER_FULL(dev, type, index_type)                    \
@@ -893,19 +957,16 @@ REGISTER_KERNEL_BUILDER(Name("ResourceGather")
 template <typename Device, typename T, typename Index>
 class ResourceGatherNdOp : public OpKernel {
  public:
-  explicit ResourceGatherNdOp(OpKernelConstruction* c) : OpKernel(c) {}
+  explicit ResourceGatherNdOp(OpKernelConstruction* c)
+      : OpKernel(c), snapshot_reads_(GatherUsesSnapshotReads()) {}
 
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
-    // NOTE: We hold the lock for the whole gather operation instead
-    // of increasing the reference count of v->tensor() to avoid a
-    // situation where a write to the same variable will see a
-    // reference count greater than one and make a copy of the
-    // (potentially very large) tensor buffer.
-    tf_shared_lock ml(*v->mu());
-    const Tensor& params = *v->tensor();
+    // NOTE: See ResourceGatherOp for why the lock is held for the whole gather.
+    SparseReadVariable<Device, T> variable(c, v.get(), snapshot_reads_);
+    OP_REQUIRES_OK(c, variable.status());
+    const Tensor& params = variable.tensor();
     const Tensor& indices = c->input(1);
 
     Tensor out;
@@ -913,6 +974,9 @@ class ResourceGatherNdOp : public OpKernel {
         c, functor::DoGatherNd<Device, T, Index>(c, params, indices, &out));
     c->set_output(0, out);
   }
+
+ private:
+  bool snapshot_reads_;
 };
 
 #define REGISTER_GATHER_ND_FULL(dev, type, index_type)                 \
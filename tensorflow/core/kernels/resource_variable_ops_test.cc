@@ -0,0 +1,173 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kNumRows = 4;
+constexpr int kNumCols = 2;
+constexpr int kNumWrites = 100;
+
+// Runs ResourceGather with TF_RESOURCE_GATHER_SNAPSHOT_READS set on a float
+// variable of shape [kNumRows, kNumCols]. The "assign" target assigns the fed
+// "value" to the variable, "scatter" writes the fed "updates" to all its rows
+// and "gather" gathers rows 1 and 3.
+class ResourceGatherSnapshotReadsTest : public ::testing::Test {
+ protected:
+  // The flag is read once, when the first ResourceGather kernel is created.
+  static void SetUpTestSuite() {
+    setenv("TF_RESOURCE_GATHER_SNAPSHOT_READS", "true", /*overwrite=*/1);
+  }
+
+  void SetUp() override {
+    Graph g(OpRegistry::Global());
+    Node* var;
+    TF_ASSERT_OK(NodeBuilder("var", "VarHandleOp")
+                     .Attr("dtype", DT_FLOAT)
+                     .Attr("shape", TensorShape({kNumRows, kNumCols}))
+                     .Attr("shared_name", "var")
+                     .Finalize(&g, &var));
+    Node* value;
+    TF_ASSERT_OK(NodeBuilder("value", "Placeholder")
+                     .Attr("dtype", DT_FLOAT)
+                     .Finalize(&g, &value));
+    Node* assign;
+    TF_ASSERT_OK(NodeBuilder("assign", "AssignVariableOp")
+                     .Input(var)
+                     .Input(value)
+                     .Attr("dtype", DT_FLOAT)
+                     .Finalize(&g, &assign));
+    Node* all_rows;
+    TF_ASSERT_OK(NodeBuilder("all_rows", "Const")
+                     .Attr("dtype", DT_INT32)
+                     .Attr("value", test::AsTensor<int32>({0, 1, 2, 3}))
+                     .Finalize(&g, &all_rows));
+    Node* updates;
+    TF_ASSERT_OK(NodeBuilder("updates", "Placeholder")
+                     .Attr("dtype", DT_FLOAT)
+                     .Finalize(&g, &updates));
+    Node* scatter;
+    TF_ASSERT_OK(NodeBuilder("scatter", "ResourceScatterUpdate")
+                     .Input(var)
+                     .Input(all_rows)
+                     .Input(updates)
+                     .Attr("dtype", DT_FLOAT)
+                     .Attr("Tindices", DT_INT32)
+                     .Finalize(&g, &scatter));
+    Node* indices;
+    TF_ASSERT_OK(NodeBuilder("indices", "Const")
+                     .Attr("dtype", DT_INT32)
+                     .Attr("value", test::AsTensor<int32>({1, 3}))
+                     .Finalize(&g, &indices));
+    Node* gather;
+    TF_ASSERT_OK(NodeBuilder("gather", "ResourceGather")
+                     .Input(var)
+                     .Input(indices)
+                     .Attr("dtype", DT_FLOAT)
+                     .Attr("Tindices", DT_INT32)
+                     .Finalize(&g, &gather));
+    GraphDef graph_def;
+    g.ToGraphDef(&graph_def);
+    session_.reset(NewSession(SessionOptions()));
+    TF_ASSERT_OK(session_->Create(graph_def));
+    Assign(0);
+  }
+
+  static Tensor Filled(int rows, float value) {
+    Tensor tensor(DT_FLOAT, TensorShape({rows, kNumCols}));
+    tensor.flat<float>().setConstant(value);
+    return tensor;
+  }
+
+  void Assign(float value) {
+    TF_CHECK_OK(session_->Run({{"value", Filled(kNumRows, value)}}, {},
+                              {"assign"}, nullptr));
+  }
+
+  void Scatter(float value) {
+    TF_CHECK_OK(session_->Run({{"updates", Filled(kNumRows, value)}}, {},
+                              {"scatter"}, nullptr));
+  }
+
+  Tensor Gather() {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session_->Run({}, {"gather"}, {}, &outputs));
+    return outputs[0];
+  }
+
+  // Gathers while `write` is called with 1, ..., kNumWrites on another
+  // thread, and checks that every gather sees a single write.
+  void ExpectConsistentGathers(std::function<void(float)> write) {
+    std::atomic<bool> done = false;
+    {
+      thread::ThreadPool writer(Env::Default(), "writer", 1);
+      writer.Schedule([&] {
+        for (int i = 1; i <= kNumWrites; ++i) write(i);
+        done = true;
+      });
+      while (!done) {
+        const Tensor output = Gather();
+        const float value = output.flat<float>()(0);
+        EXPECT_GE(value, 0);
+        EXPECT_LE(value, kNumWrites);
+        test::ExpectTensorEqual<float>(output, Filled(2, value));
+      }
+    }
+    test::ExpectTensorEqual<float>(Gather(), Filled(2, kNumWrites));
+  }
+
+  std::unique_ptr<Session> session_;
+};
+
+TEST_F(ResourceGatherSnapshotReadsTest, GatherDuringAssign) {
+  ExpectConsistentGathers([this](float value) { Assign(value); });
+}
+
+TEST_F(ResourceGatherSnapshotReadsTest, GatherDuringScatterUpdate) {
+  // The first scatter switches the variable to copy-on-read mode, from which
+  // on gathers hold its lock instead of taking a snapshot.
+  ExpectConsistentGathers([this](float value) { Scatter(value); });
+}
+
+TEST_F(ResourceGatherSnapshotReadsTest, CopyOnReadVariable) {
+  test::ExpectTensorEqual<float>(Gather(), Filled(2, 0));
+  Scatter(1);
+  test::ExpectTensorEqual<float>(Gather(), Filled(2, 1));
+  Assign(2);
+  test::ExpectTensorEqual<float>(Gather(), Filled(2, 2));
+  Scatter(3);
+  test::ExpectTensorEqual<float>(Gather(), Filled(2, 3));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -300,48 +300,96 @@ class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
                                              const Tensor& rhs,
                                              Tensor* output) {
     // Parallelize matrix multiplication across batch dimensions and across
-    // rows in each batch.
+    // rows in each batch. The rows are split into shards of about the same
+    // number of nonzeros, since the cost of a row is proportional to its
+    // number of nonzeros and row lengths are often very skewed, e.g. for the
+    // adjacency matrices of power law graphs.
     auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
     const int32_t num_threads = worker_threads.num_threads;
-    const int64_t block_size =
-        num_lhs_rows / std::max(kMaxShards, kNumShardsPerThread * num_threads);
+    const int64_t num_shards_per_batch =
+        std::max(kMaxShards, kNumShardsPerThread * num_threads);
+    std::vector<RowShard> shards;
+    for (int64_t batch_idx = 0; batch_idx < batch_size; ++batch_idx) {
+      PartitionRowsByNnz(lhs, batch_idx, num_lhs_rows, num_shards_per_batch,
+                         &shards);
+    }
     const int64_t num_rhs_rows = rhs.dim_size(rhs.dims() - 2);
     const int64_t num_rhs_cols = rhs.dim_size(rhs.dims() - 1);
     worker_threads.workers->ParallelFor(
-        batch_size * num_lhs_rows /* total */,
+        shards.size() /* total */,
         thread::ThreadPool::SchedulingParams(
             thread::ThreadPool::SchedulingStrategy::
                 kFixedBlockSize /* strategy */,
-            absl::nullopt /* cost_per_unit */, block_size),
-        [&](int64_t batch_and_row_begin, int64_t batch_and_row_end) {
-          HandleBatchAndRowRange(
-              num_lhs_rows, batch_and_row_begin, batch_and_row_end,
-              [&](int64_t batch_idx, int64_t row_begin, int64_t row_end) {
-                const int64_t num_shard_rows = row_end - row_begin;
-
-                // Define an Eigen::SparseMatrix over the row range:
-                // [row_begin, row_end) of the CSR SparseMatrix A.
-                std::vector<int32> row_ptrs;
-                auto sparse_matrix = GetSparseMatrixRef(
-                    lhs, batch_idx, row_begin, num_shard_rows, &row_ptrs);
-
-                // Map the corresponding rows of the rhs.
-                ConstMatrixMap rhs_map(rhs.flat<T>().data() + batch_idx *
-                                                                  num_rhs_rows *
-                                                                  num_rhs_cols,
-                                       num_rhs_rows, num_rhs_cols);
-
-                // Write to the corresponding rows of the output matrix.
-                MatrixMap output_map(
-                    output->flat<T>().data() +
-                        batch_idx * num_lhs_rows * num_rhs_cols +
-                        row_begin * num_rhs_cols,
-                    num_shard_rows, num_rhs_cols);
-                output_map.noalias() = sparse_matrix * rhs_map;
-              });
+            absl::nullopt /* cost_per_unit */, 1 /* block_size */),
+        [&](int64_t shard_begin, int64_t shard_end) {
+          for (int64_t shard_idx = shard_begin; shard_idx < shard_end;
+               ++shard_idx) {
+            const RowShard& shard = shards[shard_idx];
+            const int64_t batch_idx = shard.batch_idx;
+            const int64_t row_begin = shard.row_begin;
+            const int64_t num_shard_rows = shard.row_end - shard.row_begin;
+
+            // Define an Eigen::SparseMatrix over the row range:
+            // [row_begin, row_end) of the CSR SparseMatrix A.
+            std::vector<int32> row_ptrs;
+            auto sparse_matrix = GetSparseMatrixRef(
+                lhs, batch_idx, row_begin, num_shard_rows, &row_ptrs);
+
+            // Map the corresponding rows of the rhs.
+            ConstMatrixMap rhs_map(
+                rhs.flat<T>().data() + batch_idx * num_rhs_rows * num_rhs_cols,
+                num_rhs_rows, num_rhs_cols);
+
+            // Write to the corresponding rows of the output matrix. Both the
+            // rhs and the output are row major, so Eigen's product adds
+            // vectorized multiples of whole rhs rows to each output row.
+            MatrixMap output_map(output->flat<T>().data() +
+                                     batch_idx * num_lhs_rows * num_rhs_cols +
+                                     row_begin * num_rhs_cols,
+                                 num_shard_rows, num_rhs_cols);
+            output_map.noalias() = sparse_matrix * rhs_map;
+          }
         });
   }
 
+  // A contiguous range of rows of one batch of a CSR Sparse Matrix.
+  struct RowShard {
+    int64_t batch_idx;
+    int64_t row_begin;
+    int64_t row_end;
+  };
+
+  // Splits the rows of batch `batch_idx` of `csr_matrix` into at most
+  // `num_shards` contiguous ranges of about the same cost, and appends the
+  // non-empty ranges to `shards`. The cost of a row is its number of nonzeros
+  // plus one for writing its output row.
+  void PartitionRowsByNnz(const CSRSparseMatrix& csr_matrix,
+                          const int64_t batch_idx, const int64_t num_rows,
+                          const int64_t num_shards,
+                          std::vector<RowShard>* shards) {
+    if (num_rows == 0) return;
+    auto row_ptrs = csr_matrix.row_pointers_vec(batch_idx);
+    const int64_t row_offset = row_ptrs(0);
+    const int64_t total_cost = row_ptrs(num_rows) - row_offset + num_rows;
+    int64_t row_begin = 0;
+    for (int64_t shard_idx = 1; shard_idx <= num_shards; ++shard_idx) {
+      // Cost of the rows [0, row_end) must reach this shard's share.
+      const int64_t target_cost = total_cost * shard_idx / num_shards;
+      int64_t row_end = row_begin;
+      while (row_end < num_rows &&
+             row_ptrs(row_end) - row_offset + row_end < target_cost) {
+        ++row_end;
+      }
+      if (row_end > row_begin) {
+        shards->push_back({batch_idx, row_begin, row_end});
+        row_begin = row_end;
+      }
+    }
+    if (row_begin < num_rows) {
+      shards->push_back({batch_idx, row_begin, num_rows});
+    }
+  }
+
   // Sparse-Dense Matrix Multiplication assuming the CSRSparseMatrix (LHS) is
   // to be transposed before the operation.
   void SparseDenseMatMulWithTransposedLHS(OpKernelContext* ctx,
@@ -97,9 +97,11 @@ void ConcatHelper(OpKernelContext* context, const std::vector<Tensor>& inputs,
 // TODO(anudhyan): Consider exposing whether to prune zeros as an attribute in
 // the op's interface.
 //
-// If multiple threads are available, we parallelize across multiple batches
-// using Eigen ThreadPool. Within a single batch, we run in single threaded mode
-// because Eigen's Sparse-Sparse matmul doesn't support multithreading.
+// If neither input is transposed or adjointed, the product is computed row by
+// row and parallelized across the rows of all batches. Otherwise, we
+// parallelize across multiple batches using Eigen ThreadPool. Within a single
+// batch, we run in single threaded mode because Eigen's Sparse-Sparse matmul
+// doesn't support multithreading.
 //
 // TODO(b/126472741): Due to the multiple batches of a 3D CSRSparseMatrix being
 // laid out in contiguous memory, this implementation allocates memory to store
@@ -186,9 +188,69 @@ class CSRSparseMatMulCPUOp : public OpKernel {
     output_shape_vec(row_dim) = a_shape.dim_size(row_dim);
     output_shape_vec(row_dim + 1) = b_shape.dim_size(row_dim + 1);
 
-    // Set batch pointers.
+    // Estimate the cost per output row as the product of the average number
+    // of nonzeros per row.
+    const int64_t num_output_rows = output_shape_vec(row_dim);
+    const double avg_nnz_per_row_a =
+        input_matrix_a->total_nnz() /
+        static_cast<double>(a_shape.dim_size(row_dim) * batch_size);
+    const double avg_nnz_per_row_b =
+        input_matrix_b->total_nnz() /
+        static_cast<double>(b_shape.dim_size(row_dim) * batch_size);
+    const int64_t matmul_cost_per_row =
+        std::max<int64_t>(avg_nnz_per_row_a * avg_nnz_per_row_b, 1);
+
     Tensor batch_ptr(cpu_allocator(), DT_INT32, TensorShape({batch_size + 1}));
-    auto batch_ptr_vec = batch_ptr.vec<int32>();
+    Tensor output_row_ptr(cpu_allocator(), DT_INT32,
+                          TensorShape({(num_output_rows + 1) * batch_size}));
+    Tensor output_col_ind;
+    Tensor output_values;
+    if (!transpose_a_ && !adjoint_a_ && !transpose_b_ && !adjoint_b_) {
+      RowParallelSparseMatMul(ctx, *input_matrix_a, *input_matrix_b,
+                              batch_size, broadcast_batch_a, broadcast_batch_b,
+                              num_output_rows, output_shape_vec(row_dim + 1),
+                              matmul_cost_per_row, &batch_ptr, &output_row_ptr,
+                              &output_col_ind, &output_values);
+    } else {
+      EigenSparseMatMul(ctx, *input_matrix_a, *input_matrix_b, rank,
+                        batch_size, broadcast_batch_a, broadcast_batch_b,
+                        num_output_rows, num_output_rows * matmul_cost_per_row,
+                        &batch_ptr, &output_row_ptr, &output_col_ind,
+                        &output_values);
+    }
+
+    // Create the CSRSparseMatrix object from its component Tensors and prepare
+    // the Variant output Tensor.
+    CSRSparseMatrix output_csr_matrix;
+    OP_REQUIRES_OK(ctx, CSRSparseMatrix::CreateCSRSparseMatrix(
+                            DataTypeToEnum<T>::value, output_shape, batch_ptr,
+                            output_row_ptr, output_col_ind, output_values,
+                            &output_csr_matrix));
+    Tensor* output_csr_matrix_tensor;
+    AllocatorAttributes cpu_alloc;
+    cpu_alloc.set_on_host(true);
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output(0, TensorShape({}), &output_csr_matrix_tensor,
+                                  cpu_alloc));
+    output_csr_matrix_tensor->scalar<Variant>()() =
+        std::move(output_csr_matrix);
+  }
+
+ private:
+  // Computes the matrix products of the batches of `a` and `b` with Eigen's
+  // Sparse-Sparse matmul, which handles transposed and adjointed inputs.
+  // Parallelizes across batches only, since Eigen's Sparse-Sparse matmul
+  // doesn't support multithreading.
+  void EigenSparseMatMul(OpKernelContext* ctx, const CSRSparseMatrix& a,
+                         const CSRSparseMatrix& b, const int rank,
+                         const int batch_size, const bool broadcast_batch_a,
+                         const bool broadcast_batch_b,
+                         const int64_t num_output_rows,
+                         const int64_t matmul_cost_per_batch,
+                         Tensor* batch_ptr, Tensor* output_row_ptr,
+                         Tensor* output_col_ind, Tensor* output_values) {
+    // Set batch pointers.
+    auto batch_ptr_vec = batch_ptr->vec<int32>();
     batch_ptr_vec(0) = 0;
 
     // Store intermediate matrix products for each batch.
@@ -198,17 +260,6 @@ class CSRSparseMatMulCPUOp : public OpKernel {
     std::vector<SparseMatrix> output_matrices(batch_size);
 
     auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
-    // Estimate the cost per batch per as num_output_rows times the product of
-    // average number of nonzeros per row.
-    const int64_t num_output_rows = output_shape_vec(row_dim);
-    const double avg_nnz_per_row_a =
-        input_matrix_a->total_nnz() /
-        static_cast<double>(a_shape.dim_size(row_dim) * batch_size);
-    const double avg_nnz_per_row_b =
-        input_matrix_b->total_nnz() /
-        static_cast<double>(b_shape.dim_size(row_dim) * batch_size);
-    const int64_t matmul_cost_per_batch =
-        num_output_rows * (avg_nnz_per_row_a * avg_nnz_per_row_b);
 
     // Parallelize matrix multiplication across batches.
     Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
@@ -219,10 +270,10 @@ class CSRSparseMatMulCPUOp : public OpKernel {
               int batch_b = broadcast_batch_b ? 0 : batch_idx;
               // For each batch, map the CSRSparseMatrix as Eigen SparseMatrix
               // without copying the underlying data.
-              auto a_ref = GetSparseMatrixRef(*input_matrix_a, rank, batch_a,
-                                              transpose_a_, adjoint_a_);
-              auto b_ref = GetSparseMatrixRef(*input_matrix_b, rank, batch_b,
-                                              transpose_b_, adjoint_b_);
+              auto a_ref = GetSparseMatrixRef(a, rank, batch_a, transpose_a_,
+                                              adjoint_a_);
+              auto b_ref = GetSparseMatrixRef(b, rank, batch_b, transpose_b_,
+                                              adjoint_b_);
 
               // Matrix multiply while *not* pruning numerical zeros on the fly.
               // Allocates output SparseMatrix and moves it to our list of
@@ -243,14 +294,13 @@ class CSRSparseMatMulCPUOp : public OpKernel {
     const int64_t total_nnz = batch_ptr_vec(batch_size);
 
     // Allocate output tensors.
-    Tensor output_row_ptr(cpu_allocator(), DT_INT32,
-                          TensorShape({(num_output_rows + 1) * batch_size}));
-    Tensor output_col_ind(cpu_allocator(), DT_INT32, TensorShape({total_nnz}));
-    Tensor output_values(cpu_allocator(), DataTypeToEnum<T>::value,
-                         TensorShape({total_nnz}));
-    auto output_row_ptr_ptr = output_row_ptr.flat<int32>().data();
-    auto output_col_ind_ptr = output_col_ind.flat<int32>().data();
-    auto output_values_ptr = output_values.flat<T>().data();
+    *output_col_ind =
+        Tensor(cpu_allocator(), DT_INT32, TensorShape({total_nnz}));
+    *output_values = Tensor(cpu_allocator(), DataTypeToEnum<T>::value,
+                            TensorShape({total_nnz}));
+    auto output_row_ptr_ptr = output_row_ptr->flat<int32>().data();
+    auto output_col_ind_ptr = output_col_ind->flat<int32>().data();
+    auto output_values_ptr = output_values->flat<T>().data();
 
     // Copy the output matrices from each batch into the CSRSparseMatrix
     // tensors.
@@ -272,25 +322,129 @@ class CSRSparseMatMulCPUOp : public OpKernel {
                         output_values_ptr + batch_ptr_vec(batch_idx));
             }
           });
+  }
 
-    // Create the CSRSparseMatrix object from its component Tensors and prepare
-    // the Variant output Tensor.
-    CSRSparseMatrix output_csr_matrix;
-    OP_REQUIRES_OK(ctx, CSRSparseMatrix::CreateCSRSparseMatrix(
-                            DataTypeToEnum<T>::value, output_shape, batch_ptr,
-                            output_row_ptr, output_col_ind, output_values,
-                            &output_csr_matrix));
-    Tensor* output_csr_matrix_tensor;
-    AllocatorAttributes cpu_alloc;
-    cpu_alloc.set_on_host(true);
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_output(0, TensorShape({}), &output_csr_matrix_tensor,
-                                  cpu_alloc));
-    output_csr_matrix_tensor->scalar<Variant>()() =
-        std::move(output_csr_matrix);
+  // Computes the matrix products of the batches of `a` and `b`, neither of
+  // which may be transposed or adjointed, parallelized across the rows of all
+  // batches so that a single large batch uses all threads.
+  //
+  // Uses Gustavson's row by row algorithm in two passes. The symbolic pass
+  // counts the nonzeros of every output row, which gives the row pointers and
+  // the size of the outputs. The numeric pass then writes each row into its
+  // final position, so the threads never need to merge their results. Like
+  // EigenSparseMatMul, numeric zeros are not pruned.
+  void RowParallelSparseMatMul(OpKernelContext* ctx, const CSRSparseMatrix& a,
+                               const CSRSparseMatrix& b, const int batch_size,
+                               const bool broadcast_batch_a,
+                               const bool broadcast_batch_b,
+                               const int64_t num_output_rows,
+                               const int64_t num_output_cols,
+                               const int64_t matmul_cost_per_row,
+                               Tensor* batch_ptr, Tensor* output_row_ptr,
+                               Tensor* output_col_ind, Tensor* output_values) {
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    const int64_t total_rows = batch_size * num_output_rows;
+    auto row_ptr_vec = output_row_ptr->vec<int32>();
+
+    // Symbolic pass: store the number of nonzeros of each output row at the
+    // position of its end pointer. `last_row[j]` is the last output row in
+    // which column j was seen, so columns are counted once per row.
+    Shard(worker_threads.num_threads, worker_threads.workers, total_rows,
+          matmul_cost_per_row, [&](int64_t begin, int64_t end) {
+            std::vector<int64_t> last_row(num_output_cols, -1);
+            for (int64_t i = begin; i < end; ++i) {
+              const int batch_idx = i / num_output_rows;
+              const int64_t row = i % num_output_rows;
+              auto a_row_ptrs =
+                  a.row_pointers_vec(broadcast_batch_a ? 0 : batch_idx);
+              auto a_col_inds =
+                  a.col_indices_vec(broadcast_batch_a ? 0 : batch_idx);
+              auto b_row_ptrs =
+                  b.row_pointers_vec(broadcast_batch_b ? 0 : batch_idx);
+              auto b_col_inds =
+                  b.col_indices_vec(broadcast_batch_b ? 0 : batch_idx);
+              int32 row_nnz = 0;
+              for (int32 p = a_row_ptrs(row); p < a_row_ptrs(row + 1); ++p) {
+                const int32 k = a_col_inds(p);
+                for (int32 q = b_row_ptrs(k); q < b_row_ptrs(k + 1); ++q) {
+                  const int32 j = b_col_inds(q);
+                  if (last_row[j] != i) {
+                    last_row[j] = i;
+                    ++row_nnz;
+                  }
+                }
+              }
+              row_ptr_vec(batch_idx * (num_output_rows + 1) + row + 1) =
+                  row_nnz;
+            }
+          });
+
+    // Compute the cumulative sums to obtain the row and batch pointers.
+    auto batch_ptr_vec = batch_ptr->vec<int32>();
+    batch_ptr_vec(0) = 0;
+    for (int batch_idx = 0; batch_idx < batch_size; ++batch_idx) {
+      int32* batch_row_ptr =
+          row_ptr_vec.data() + batch_idx * (num_output_rows + 1);
+      batch_row_ptr[0] = 0;
+      std::partial_sum(batch_row_ptr, batch_row_ptr + num_output_rows + 1,
+                       batch_row_ptr);
+      batch_ptr_vec(batch_idx + 1) =
+          batch_ptr_vec(batch_idx) + batch_row_ptr[num_output_rows];
+    }
+    const int64_t total_nnz = batch_ptr_vec(batch_size);
+
+    *output_col_ind =
+        Tensor(cpu_allocator(), DT_INT32, TensorShape({total_nnz}));
+    *output_values = Tensor(cpu_allocator(), DataTypeToEnum<T>::value,
+                            TensorShape({total_nnz}));
+    int32* output_col_ind_ptr = output_col_ind->flat<int32>().data();
+    T* output_values_ptr = output_values->flat<T>().data();
+
+    // Numeric pass: accumulate each output row in a dense row `accumulator`,
+    // then write its column indices in increasing order with their values.
+    Shard(worker_threads.num_threads, worker_threads.workers, total_rows,
+          matmul_cost_per_row, [&](int64_t begin, int64_t end) {
+            std::vector<int64_t> last_row(num_output_cols, -1);
+            std::vector<T> accumulator(num_output_cols);
+            for (int64_t i = begin; i < end; ++i) {
+              const int batch_idx = i / num_output_rows;
+              const int64_t row = i % num_output_rows;
+              const int batch_a = broadcast_batch_a ? 0 : batch_idx;
+              const int batch_b = broadcast_batch_b ? 0 : batch_idx;
+              auto a_row_ptrs = a.row_pointers_vec(batch_a);
+              auto a_col_inds = a.col_indices_vec(batch_a);
+              auto a_values = a.values_vec<T>(batch_a);
+              auto b_row_ptrs = b.row_pointers_vec(batch_b);
+              auto b_col_inds = b.col_indices_vec(batch_b);
+              auto b_values = b.values_vec<T>(batch_b);
+              const int64_t row_begin =
+                  batch_ptr_vec(batch_idx) +
+                  row_ptr_vec(batch_idx * (num_output_rows + 1) + row);
+              int32* row_col_inds = output_col_ind_ptr + row_begin;
+              int64_t row_nnz = 0;
+              for (int32 p = a_row_ptrs(row); p < a_row_ptrs(row + 1); ++p) {
+                const int32 k = a_col_inds(p);
+                const T a_value = a_values(p);
+                for (int32 q = b_row_ptrs(k); q < b_row_ptrs(k + 1); ++q) {
+                  const int32 j = b_col_inds(q);
+                  if (last_row[j] != i) {
+                    last_row[j] = i;
+                    accumulator[j] = a_value * b_values(q);
+                    row_col_inds[row_nnz++] = j;
+                  } else {
+                    accumulator[j] += a_value * b_values(q);
+                  }
+                }
+              }
+              std::sort(row_col_inds, row_col_inds + row_nnz);
+              for (int64_t n = 0; n < row_nnz; ++n) {
+                output_values_ptr[row_begin + n] =
+                    accumulator[row_col_inds[n]];
+              }
+            }
+          });
   }
 
- private:
   // Returns an Eigen::Ref expression of a SparseMatrix; which points to the
   // underlying memory of the given CSRSparseMatrix.
   Eigen::Ref<const SparseMatrix> GetSparseMatrixRef(
@@ -0,0 +1,265 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/sparse/sparse_matrix.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// A batch of dense row major matrices.
+struct DenseMatrices {
+  int batch_size;
+  int rows;
+  int cols;
+  std::vector<float> values;
+
+  float at(int batch, int row, int col) const {
+    return values[(batch * rows + row) * cols + col];
+  }
+};
+
+// Returns the rank 3 CSRSparseMatrix with the nonzeros of `dense`.
+CSRSparseMatrix ToCSR(const DenseMatrices& dense) {
+  Tensor dense_shape = test::AsTensor<int64_t>(
+      {dense.batch_size, dense.rows, dense.cols});
+  Tensor batch_ptr(DT_INT32, TensorShape({dense.batch_size + 1}));
+  Tensor row_ptr(DT_INT32,
+                 TensorShape({dense.batch_size * (dense.rows + 1)}));
+  std::vector<int32> col_ind;
+  std::vector<float> values;
+  batch_ptr.vec<int32>()(0) = 0;
+  for (int batch = 0; batch < dense.batch_size; ++batch) {
+    const int32 batch_begin = col_ind.size();
+    for (int row = 0; row < dense.rows; ++row) {
+      row_ptr.vec<int32>()(batch * (dense.rows + 1) + row) =
+          col_ind.size() - batch_begin;
+      for (int col = 0; col < dense.cols; ++col) {
+        if (dense.at(batch, row, col) != 0) {
+          col_ind.push_back(col);
+          values.push_back(dense.at(batch, row, col));
+        }
+      }
+    }
+    row_ptr.vec<int32>()(batch * (dense.rows + 1) + dense.rows) =
+        col_ind.size() - batch_begin;
+    batch_ptr.vec<int32>()(batch + 1) = col_ind.size();
+  }
+  CSRSparseMatrix matrix;
+  TF_CHECK_OK(CSRSparseMatrix::CreateCSRSparseMatrix(
+      DT_FLOAT, dense_shape, batch_ptr, row_ptr,
+      test::AsTensor<int32>(col_ind), test::AsTensor<float>(values), &matrix));
+  return matrix;
+}
+
+// Returns the transposes of the matrices in `dense`.
+DenseMatrices Transpose(const DenseMatrices& dense) {
+  DenseMatrices transposed = {dense.batch_size, dense.cols, dense.rows, {}};
+  for (int batch = 0; batch < dense.batch_size; ++batch) {
+    for (int row = 0; row < dense.cols; ++row) {
+      for (int col = 0; col < dense.rows; ++col) {
+        transposed.values.push_back(dense.at(batch, col, row));
+      }
+    }
+  }
+  return transposed;
+}
+
+void ExpectCSREqual(const CSRSparseMatrix& actual,
+                    const CSRSparseMatrix& expected) {
+  test::ExpectTensorEqual<int64_t>(actual.dense_shape(),
+                                   expected.dense_shape());
+  test::ExpectTensorEqual<int32>(actual.batch_pointers(),
+                                 expected.batch_pointers());
+  test::ExpectTensorEqual<int32>(actual.row_pointers(),
+                                 expected.row_pointers());
+  test::ExpectTensorEqual<int32>(actual.col_indices(),
+                                 expected.col_indices());
+  test::ExpectTensorEqual<float>(actual.values(), expected.values());
+}
+
+class SparseMatrixSparseMatMulOpTest : public OpsTestBase {
+ protected:
+  // Returns the product of `a` and `b` computed by SparseMatrixSparseMatMul
+  // with the given attributes.
+  CSRSparseMatrix MatMul(const CSRSparseMatrix& a, const CSRSparseMatrix& b,
+                         bool transpose_a = false, bool transpose_b = false,
+                         bool adjoint_a = false, bool adjoint_b = false) {
+    inputs_.clear();
+    TF_CHECK_OK(NodeDefBuilder("sparse_mat_mul", "SparseMatrixSparseMatMul")
+                    .Input(FakeInput(DT_VARIANT))
+                    .Input(FakeInput(DT_VARIANT))
+                    .Attr("type", DT_FLOAT)
+                    .Attr("transpose_a", transpose_a)
+                    .Attr("transpose_b", transpose_b)
+                    .Attr("adjoint_a", adjoint_a)
+                    .Attr("adjoint_b", adjoint_b)
+                    .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+    AddInputFromArray<Variant>(TensorShape({}), {a});
+    AddInputFromArray<Variant>(TensorShape({}), {b});
+    TF_CHECK_OK(RunOpKernel());
+    const CSRSparseMatrix* c =
+        GetOutput(0)->scalar<Variant>()().get<CSRSparseMatrix>();
+    CHECK(c != nullptr);
+    return *c;
+  }
+
+  // Checks that the row parallel product of `a` and `b` matches the Eigen
+  // product, which is used when either input is transposed, and the dense
+  // product `expected`.
+  void ExpectProduct(const DenseMatrices& a, const DenseMatrices& b,
+                     const DenseMatrices& expected) {
+    const CSRSparseMatrix product = MatMul(ToCSR(a), ToCSR(b));
+    ExpectCSREqual(product, ToCSR(expected));
+    ExpectCSREqual(product,
+                   MatMul(ToCSR(Transpose(a)), ToCSR(b), /*transpose_a=*/true));
+    ExpectCSREqual(product, MatMul(ToCSR(a), ToCSR(Transpose(b)),
+                                   /*transpose_a=*/false,
+                                   /*transpose_b=*/true));
+  }
+};
+
+TEST_F(SparseMatrixSparseMatMulOpTest, SingleBatch) {
+  const DenseMatrices a = {1, 2, 3, {1, 0, 2,  //
+                                     0, 3, 0}};
+  const DenseMatrices b = {1, 3, 2, {0, 4,  //
+                                     5, 0,  //
+                                     0, 6}};
+  ExpectProduct(a, b, {1, 2, 2, {0, 16,  //
+                                 15, 0}});
+}
+
+TEST_F(SparseMatrixSparseMatMulOpTest, BroadcastsBatches) {
+  const DenseMatrices a = {1, 2, 2, {1, 0,  //
+                                     0, 2}};
+  const DenseMatrices b = {3, 2, 2, {1, 2,  //
+                                     0, 0,  //
+                                     //
+                                     0, 0,  //
+                                     3, 4,  //
+                                     //
+                                     5, 0,  //
+                                     0, 6}};
+  ExpectProduct(a, b, {3, 2, 2, {1, 2,  //
+                                 0, 0,  //
+                                 //
+                                 0, 0,  //
+                                 6, 8,  //
+                                 //
+                                 5, 0,  //
+                                 0, 12}});
+  // Broadcasting `b` instead of `a`.
+  ExpectProduct(Transpose(b), Transpose(a),
+                Transpose({3, 2, 2, {1, 2,  //
+                                     0, 0,  //
+                                     //
+                                     0, 0,  //
+                                     6, 8,  //
+                                     //
+                                     5, 0,  //
+                                     0, 12}}));
+}
+
+TEST_F(SparseMatrixSparseMatMulOpTest, EmptyRowsAndMatrices) {
+  // The second row of `a` and the first batch of `b` are empty, and so are
+  // the products of the first and last batches.
+  const DenseMatrices a = {3, 2, 2, {1, 1,  //
+                                     0, 0,  //
+                                     //
+                                     0, 2,  //
+                                     0, 0,  //
+                                     //
+                                     0, 0,  //
+                                     0, 0}};
+  const DenseMatrices b = {3, 2, 2, {0, 0,  //
+                                     0, 0,  //
+                                     //
+                                     1, 0,  //
+                                     0, 3,  //
+                                     //
+                                     1, 1,  //
+                                     1, 1}};
+  ExpectProduct(a, b, {3, 2, 2, {0, 0,  //
+                                 0, 0,  //
+                                 //
+                                 0, 6,  //
+                                 0, 0,  //
+                                 //
+                                 0, 0,  //
+                                 0, 0}});
+}
+
+TEST_F(SparseMatrixSparseMatMulOpTest, AccumulatesDuplicateColumns) {
+  // Every row of `b` contributes to columns 0 and 2 of the product.
+  const DenseMatrices a = {1, 1, 3, {1, 2, 3}};
+  const DenseMatrices b = {1, 3, 3, {1, 0, 1,  //
+                                     2, 0, 1,  //
+                                     3, 1, 1}};
+  const DenseMatrices expected = {1, 1, 3, {14, 3, 6}};
+  ExpectProduct(a, b, expected);
+
+  // Numeric zeros are kept in the product.
+  const CSRSparseMatrix product = MatMul(
+      ToCSR({1, 1, 2, {1, 1}}), ToCSR({1, 2, 1, {1, -1}}));
+  test::ExpectTensorEqual<int32>(product.col_indices(),
+                                 test::AsTensor<int32>({0}));
+  test::ExpectTensorEqual<float>(product.values(), test::AsTensor<float>({0}));
+}
+
+TEST_F(SparseMatrixSparseMatMulOpTest, TransposesAndAdjointsInputs) {
+  const DenseMatrices a = {2, 2, 3, {1, 0, 2,  //
+                                     0, 3, 0,  //
+                                     //
+                                     0, 0, 4,  //
+                                     5, 0, 0}};
+  const DenseMatrices b = {2, 3, 2, {0, 4,  //
+                                     5, 0,  //
+                                     0, 6,  //
+                                     //
+                                     1, 0,  //
+                                     0, 2,  //
+                                     3, 0}};
+  const CSRSparseMatrix product = MatMul(ToCSR(a), ToCSR(b));
+  const CSRSparseMatrix a_t = ToCSR(Transpose(a));
+  const CSRSparseMatrix b_t = ToCSR(Transpose(b));
+  // The adjoint of a real matrix is its transpose.
+  ExpectCSREqual(product, MatMul(a_t, ToCSR(b), /*transpose_a=*/true));
+  ExpectCSREqual(product, MatMul(a_t, ToCSR(b), /*transpose_a=*/false,
+                                 /*transpose_b=*/false, /*adjoint_a=*/true));
+  ExpectCSREqual(product, MatMul(ToCSR(a), b_t, /*transpose_a=*/false,
+                                 /*transpose_b=*/true));
+  ExpectCSREqual(product,
+                 MatMul(ToCSR(a), b_t, /*transpose_a=*/false,
+                        /*transpose_b=*/false, /*adjoint_a=*/false,
+                        /*adjoint_b=*/true));
+  ExpectCSREqual(product, MatMul(a_t, b_t, /*transpose_a=*/true,
+                                 /*transpose_b=*/true));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -19,11 +19,17 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_xent_op.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/xent_op_cpu_impl.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/env_var.h"
 
@@ -109,8 +115,9 @@ class SparseSoftmaxXentWithLogitsOp : public OpKernel {
   }
 };
 
-// Partial specialization for a CPUDevice, that uses the Eigen implementation
-// from XentEigenImpl.
+// Partial specialization for a CPUDevice, that computes the loss and the
+// gradient of the rows of logits in two passes over them. See
+// xent_op_cpu_impl.h.
 namespace functor {
 template <typename T, typename Index>
 struct SparseXentFunctor<CPUDevice, T, Index> {
@@ -118,8 +125,45 @@ struct SparseXentFunctor<CPUDevice, T, Index> {
                   typename TTypes<Index>::ConstVec labels,
                   typename TTypes<T>::Vec scratch, typename TTypes<T>::Vec loss,
                   typename TTypes<T>::Matrix backprop) {
-    SparseXentEigenImpl<CPUDevice, T, Index>::Compute(ctx, logits, labels,
-                                                      scratch, loss, backprop);
+    using A = xent_cpu::Acc<T>;
+    const int64_t num_classes = logits.dimension(1);
+    const T* logits_data = logits.data();
+    T* backprop_data = backprop.data();
+    // The loss is the negative log of the softmax of the label, and the
+    // gradient the softmax minus the one-hot encoding of the label. `backprop`
+    // may alias `logits`, so the logit of the label is read before the
+    // gradients of its chunk are written.
+    auto grad_fn = [&](int64_t row, const xent_cpu::SoftmaxStats<A>& stats,
+                       int64_t begin, int64_t end) {
+      const Index label = internal::SubtleMustCopy(labels(row));
+      T* out = backprop_data + row * num_classes;
+      if (!FastBoundsCheck(label, num_classes)) {
+        std::fill(out + begin, out + end,
+                  Eigen::NumTraits<T>::quiet_NaN());
+        return std::numeric_limits<A>::quiet_NaN();
+      }
+      const T* in = logits_data + row * num_classes;
+      const bool has_label = begin <= label && label < end;
+      A label_loss = 0;
+      A label_grad = 0;
+      if (has_label) {
+        const A shifted_logit = static_cast<A>(in[label]) - stats.max;
+        label_loss = std::log(stats.sum_exp) - shifted_logit;
+        label_grad = std::exp(shifted_logit) / stats.sum_exp - A(1);
+      }
+      const A inv_sum_exp = A(1) / stats.sum_exp;
+      xent_cpu::ArrayMap<T>(out + begin, end - begin) =
+          ((xent_cpu::ConstArrayMap<T>(in + begin, end - begin)
+                .template cast<A>() -
+            stats.max)
+               .exp() *
+           inv_sum_exp)
+              .template cast<T>();
+      if (has_label) out[label] = static_cast<T>(label_grad);
+      return label_loss;
+    };
+    xent_cpu::Compute(ctx->eigen_device<CPUDevice>(), logits_data,
+                      logits.dimension(0), num_classes, loss.data(), grad_fn);
   }
 };
 }  // namespace functor
@@ -13,16 +13,83 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <cmath>
 #include <random>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/xent_op.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
+class SparseXentOpTest : public OpsTestBase {
+ protected:
+  // Compares the op with a reference computed in double precision.
+  void RunAndCompare(int batch_size, int num_classes) {
+    TF_ASSERT_OK(NodeDefBuilder("sparse_xent",
+                                "SparseSoftmaxCrossEntropyWithLogits")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    auto logit = [](int i) { return 10 * std::sin(i * 0.37f); };
+    auto label = [num_classes](int i) { return (i * 7919) % num_classes; };
+    AddInput<float>(TensorShape({batch_size, num_classes}), logit);
+    AddInput<int32>(TensorShape({batch_size}), label);
+    TF_ASSERT_OK(RunOpKernel());
+
+    // The backprop may be computed in place of the logits.
+    Tensor logits_t(DT_FLOAT, TensorShape({batch_size, num_classes}));
+    test::FillFn<float>(&logits_t, logit);
+    Tensor labels_t(DT_INT32, TensorShape({batch_size}));
+    test::FillFn<int32>(&labels_t, label);
+    Tensor expected_loss(DT_FLOAT, TensorShape({batch_size}));
+    Tensor expected_backprop(DT_FLOAT,
+                             TensorShape({batch_size, num_classes}));
+    auto logits = logits_t.matrix<float>();
+    auto labels = labels_t.vec<int32>();
+    for (int b = 0; b < batch_size; ++b) {
+      double max_logit = logits(b, 0);
+      for (int c = 0; c < num_classes; ++c) {
+        max_logit = std::max<double>(max_logit, logits(b, c));
+      }
+      double sum_exp = 0;
+      for (int c = 0; c < num_classes; ++c) {
+        sum_exp += std::exp(logits(b, c) - max_logit);
+      }
+      expected_loss.vec<float>()(b) =
+          std::log(sum_exp) - (logits(b, labels(b)) - max_logit);
+      for (int c = 0; c < num_classes; ++c) {
+        expected_backprop.matrix<float>()(b, c) =
+            std::exp(logits(b, c) - max_logit) / sum_exp -
+            (c == labels(b) ? 1 : 0);
+      }
+    }
+    test::ExpectClose(expected_loss, *GetOutput(0), /*atol=*/1e-5,
+                      /*rtol=*/1e-5);
+    test::ExpectClose(expected_backprop, *GetOutput(1), /*atol=*/1e-6,
+                      /*rtol=*/1e-4);
+  }
+};
+
+TEST_F(SparseXentOpTest, NarrowRows) {
+  RunAndCompare(/*batch_size=*/5, /*num_classes=*/3000);
+}
+
+TEST_F(SparseXentOpTest, WideRows) {
+  // Wide enough for the rows to be split into chunks.
+  RunAndCompare(/*batch_size=*/1, /*num_classes=*/100000);
+}
+
 template <class T>
 static Graph* SparseXent(int batch_size, int num_classes, DataType type) {
   Graph* g = new Graph(OpRegistry::Global());
@@ -80,7 +147,9 @@ BM_SparseXentDev(64, 100000, gpu, float, DT_FLOAT);
   BM_SparseXentDev(32, 10000, cpu, C_TYPE, TF_TYPE);  \
   BM_SparseXentDev(32, 100000, cpu, C_TYPE, TF_TYPE); \
   BM_SparseXentDev(64, 10000, cpu, C_TYPE, TF_TYPE);  \
-  BM_SparseXentDev(64, 100000, cpu, C_TYPE, TF_TYPE);
+  BM_SparseXentDev(64, 100000, cpu, C_TYPE, TF_TYPE); \
+  BM_SparseXentDev(8, 250000, cpu, C_TYPE, TF_TYPE);  \
+  BM_SparseXentDev(64, 250000, cpu, C_TYPE, TF_TYPE);
 
 BM_SparseXentDev_CPU(float, DT_FLOAT);
 BM_SparseXentDev_CPU(bfloat16, DT_BFLOAT16);
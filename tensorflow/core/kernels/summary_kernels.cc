@@ -59,9 +59,13 @@ class CreateSummaryFileWriterOp : public OpKernel {
                             ctx, HandleFromInput(ctx, 0), &s,
                             [max_queue, flush_millis, logdir, filename_suffix,
                              ctx](SummaryWriterInterface** s) {
+                              SummaryFileWriterOptions options =
+                                  SummaryFileWriterOptions::FromEnv();
+                              options.max_queue = max_queue;
+                              options.flush_millis = flush_millis;
                               return CreateSummaryFileWriter(
-                                  max_queue, flush_millis, logdir,
-                                  filename_suffix, ctx->env(), s);
+                                  options, logdir, filename_suffix,
+                                  ctx->env(), s);
                             }));
   }
 };
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/topk_op.h"
 
 #include <algorithm>
+#include <memory>
 #include <numeric>
 #include <vector>
 
@@ -37,6 +38,82 @@ namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Number of columns which are compared with the threshold of the heap before
+// checking whether any of them must be pushed. The compares of a block don't
+// depend on each other, so they are vectorized.
+constexpr int64_t kTopKFilterBlockSize = 16;
+
+// Minimum number of columns of the chunks which a row is split into when there
+// are fewer rows than threads.
+constexpr int64_t kTopKMinColsPerChunk = 1 << 15;
+
+// Orders the columns of a row by decreasing values, and columns with the same
+// value by increasing indices.
+template <typename T, typename Tidx>
+struct StableGreater {
+  bool operator()(const Tidx a, const Tidx b) const {
+    if (input_data[b] < input_data[a]) {
+      return true;
+    } else if (input_data[b] > input_data[a]) {
+      return false;
+    } else {
+      return a < b;
+    }
+  }
+
+  const T* input_data;
+};
+
+template <typename T, typename Tidx>
+using TopKFilter = gtl::TopN<Tidx, StableGreater<T, Tidx>>;
+
+// Pushes the columns [begin, end) of a row into `filter`, in increasing order.
+// Once the filter is full, only the columns whose value is greater than the
+// lowest one of the filter are pushed: the other ones would be dropped since
+// they come after all the columns in the filter. This skips the heap for most
+// of the columns of rows much wider than k.
+template <typename T, typename Tidx>
+void PushAboveThreshold(const T* input_data, int64_t begin, int64_t end,
+                        TopKFilter<T, Tidx>* filter) {
+  int64_t c = begin;
+  for (; c < end && filter->size() < filter->limit(); ++c) {
+    filter->push(static_cast<Tidx>(c));
+  }
+  if (c == end) return;
+  T threshold = input_data[filter->peek_bottom()];
+  auto push = [&](int64_t c) {
+    if (input_data[c] > threshold) {
+      filter->push(static_cast<Tidx>(c));
+      threshold = input_data[filter->peek_bottom()];
+    }
+  };
+  for (; c + kTopKFilterBlockSize <= end; c += kTopKFilterBlockSize) {
+    bool any_above = false;
+    for (int64_t i = 0; i < kTopKFilterBlockSize; ++i) {
+      any_above |= input_data[c + i] > threshold;
+    }
+    if (!any_above) continue;
+    for (int64_t i = 0; i < kTopKFilterBlockSize; ++i) push(c + i);
+  }
+  for (; c < end; ++c) push(c);
+}
+
+// Writes the columns of `filter` into `indices`, in decreasing order if
+// `sorted`.
+template <typename T, typename Tidx>
+void ExtractIndices(bool sorted, TopKFilter<T, Tidx>* filter, Tidx* indices) {
+  if (sorted) {
+    std::unique_ptr<std::vector<Tidx>> top_k(filter->Extract());
+    std::copy(top_k->begin(), top_k->end(), indices);
+  } else {
+    std::copy(filter->unsorted_begin(), filter->unsorted_end(), indices);
+  }
+}
+
+}  // namespace
+
 template <typename Device, typename T, typename Tidx>
 class TopK : public OpKernel {
  public:
@@ -164,24 +241,9 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
-        const auto stable_comp = [input_data](const int32_t a,
-                                              const int32_t b) {
-          if (input_data[b] < input_data[a]) {
-            return true;
-          } else if (input_data[b] > input_data[a]) {
-            return false;
-          } else {
-            return a < b;
-          }
-        };
         const auto comp = [input_data](const int32_t a, const int32_t b) {
           return input_data[b] < input_data[a];
         };
-        // TODO(ebrevdo): For large k < num_cols, instead of using
-        // TopN, it may be faster to create a temporary vector of
-        // values 0..num_cols - 1 and then use std::partial_sort_copy
-        // of this into indices. Choosing the appropriate minimum k or
-        // ratio of k/num_cols will require some experimentation.
         if (k == num_cols) {
           auto* begin = &indices(b, 0);
           auto* end = &indices(b, k);
@@ -206,25 +268,10 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
           }
         } else {
           // Use the TopN heap object to sort.
-          gtl::TopN<Tidx, decltype(stable_comp)> filter(k, stable_comp);
+          TopKFilter<T, Tidx> filter(k, StableGreater<T, Tidx>{input_data});
           filter.reserve(num_cols);
-          for (Tidx c = 0; c < num_cols; ++c) {
-            filter.push(c);
-          }
-
-          int32_t i = 0;
-          if (sorted) {
-            std::unique_ptr<std::vector<Tidx>> top_k(filter.Extract());
-            for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
-                 ++top_k_it, ++i) {
-              indices(b, i) = *top_k_it;
-            }
-          } else {
-            for (auto top_k_it = filter.unsorted_begin();
-                 top_k_it != filter.unsorted_end(); ++top_k_it, ++i) {
-              indices(b, i) = *top_k_it;
-            }
-          }
+          PushAboveThreshold(input_data, 0, num_cols, &filter);
+          ExtractIndices(sorted, &filter, &indices(b, 0));
         }
         // Now that the indices are sorted, copy the values over in
         // sorted order.
@@ -237,6 +284,58 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
     // If K == N, assume the cost is N*log(K + 1).
     const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<Tidx>() +
                             Eigen::TensorOpCost::AddCost<T>();
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+    // When there are fewer rows than threads, rows much wider than k are split
+    // into chunks which select their top k in parallel, and the top k of a row
+    // is then selected among the ones of its chunks.
+    const int64_t num_chunks =
+        k == num_cols
+            ? 1
+            : std::min<int64_t>(
+                  (worker_threads.num_threads + num_rows - 1) / num_rows,
+                  num_cols / std::max<int64_t>(kTopKMinColsPerChunk, 8 * k));
+    if (num_chunks > 1) {
+      const int64_t chunk_cols = (num_cols + num_chunks - 1) / num_chunks;
+      std::vector<std::vector<Tidx>> candidates(num_rows * num_chunks);
+      auto select_in_chunks = [&](int64_t start, int64_t limit) {
+        for (int64_t unit = start; unit < limit; ++unit) {
+          const T* input_data = &input(unit / num_chunks, 0);
+          const int64_t begin = (unit % num_chunks) * chunk_cols;
+          const int64_t end = std::min(begin + chunk_cols, num_cols);
+          TopKFilter<T, Tidx> filter(k, StableGreater<T, Tidx>{input_data});
+          PushAboveThreshold(input_data, begin, end, &filter);
+          std::unique_ptr<std::vector<Tidx>> top_k(filter.ExtractUnsorted());
+          // The chunks are merged in increasing order of the columns, as if
+          // the row had not been split.
+          std::sort(top_k->begin(), top_k->end());
+          candidates[unit] = std::move(*top_k);
+        }
+      };
+      Shard(worker_threads.num_threads, worker_threads.workers,
+            num_rows * num_chunks, 4 * cmp_cost * chunk_cols,
+            select_in_chunks);
+
+      auto merge_chunks = [&](int64_t start_batch, int64_t limit_batch) {
+        for (int64_t b = start_batch; b < limit_batch; ++b) {
+          const T* input_data = &input(b, 0);
+          TopKFilter<T, Tidx> filter(k, StableGreater<T, Tidx>{input_data});
+          for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+            for (const Tidx c : candidates[b * num_chunks + chunk]) {
+              filter.push(c);
+            }
+          }
+          ExtractIndices(sorted, &filter, &indices(b, 0));
+          std::transform(
+              &indices(b, 0), &indices(b, k), &values(b, 0),
+              [b, &input](const Tidx loc) { return input(b, loc); });
+        }
+      };
+      Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+            4 * cmp_cost * num_chunks * k, merge_chunks);
+      return OkStatus();
+    }
+
     const double base_cost =
         cmp_cost *
         static_cast<double>(num_cols *
@@ -247,7 +346,6 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
@@ -17,6 +17,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -40,6 +42,37 @@ inline T sgn(const T x) {
   T one(1);
   return (x == zero ? zero : (x < zero ? -one : one));
 }
+
+// Groups the offsets of `indices` by index, in increasing order of index, so
+// that the updates of distinct rows of a sparse apply can run in parallel, in
+// the order of the rows in memory. `rows` holds the (index, offset) pairs, and
+// the offsets of the r-th distinct index are in rows[row_starts[r]] to
+// rows[row_starts[r + 1] - 1], in the order of `indices`.
+template <typename Tindex>
+Status GroupIndicesByRow(typename TTypes<Tindex>::ConstVec indices,
+                         Tindex first_dim_size,
+                         std::vector<std::pair<Tindex, Tindex>>* rows,
+                         std::vector<Tindex>* row_starts) {
+  const Tindex N = static_cast<Tindex>(indices.dimension(0));
+  rows->resize(N);
+  for (Tindex i = 0; i < N; ++i) {
+    const Tindex index = internal::SubtleMustCopy(indices(i));
+    if (!FastBoundsCheck(index, first_dim_size)) {
+      return errors::InvalidArgument(strings::StrCat(
+          "Index ", index, " at offset ", i, " in indices is out of range"));
+    }
+    (*rows)[i] = {index, i};
+  }
+  std::sort(rows->begin(), rows->end());
+  row_starts->clear();
+  for (Tindex i = 0; i < N; ++i) {
+    if (i == 0 || (*rows)[i].first != (*rows)[i - 1].first) {
+      row_starts->push_back(i);
+    }
+  }
+  row_starts->push_back(N);
+  return OkStatus();
+}
 }  // namespace
 
 namespace functor {
@@ -181,61 +214,58 @@ struct SparseApplyAdagrad<CPUDevice, T, Tindex, has_epsilon> {
                                     Eigen::TensorOpCost::MulCost<T>() * 2);
     const Eigen::TensorOpCost cost(in_bytes, out_bytes, cycles);
 
-    if (inner_dim > 1) {
-      for (Tindex i = 0; i < N; ++i) {
-        const Tindex index = internal::SubtleMustCopy(indices(i));
-        if (!FastBoundsCheck(index, first_dim_size)) {
-          return errors::InvalidArgument(
-              strings::StrCat("Index ", index, " at offset ", i,
-                              " in indices is out of range"));
-        }
-      }
+    // Duplicate indices update the same row, so the updates are applied in
+    // parallel across distinct rows, and in order for each row.
+    std::vector<std::pair<Tindex, Tindex>> rows;
+    std::vector<Tindex> row_starts;
+    TF_RETURN_IF_ERROR(
+        GroupIndicesByRow<Tindex>(indices, first_dim_size, &rows, &row_starts));
+    const Tindex num_rows = static_cast<Tindex>(row_starts.size()) - 1;
+    const double updates_per_row = static_cast<double>(N) / num_rows;
 
-      const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
-        for (Tindex i = start_idx; i < end_idx; ++i) {
-          const Tindex index = internal::SubtleMustCopy(indices(i));
+    if (inner_dim > 1) {
+      const auto shard = [&](Tindex start_row, Tindex end_row) -> void {
+        for (Tindex r = start_row; r < end_row; ++r) {
+          const Tindex index = rows[row_starts[r]].first;
           auto a = accum.template chip<0>(index);
-          auto g = grad.template chip<0>(i);
           auto v = var.template chip<0>(index);
-          if (update_slots) {
-            a += g.square();
-          }
-          if (has_epsilon) {
-            v -= g.constant(lr_scalar) * g / (a.sqrt() + a.constant(epsilon()));
-          } else {
-            v -= g.constant(lr_scalar) * g * a.rsqrt();
+          for (Tindex j = row_starts[r]; j < row_starts[r + 1]; ++j) {
+            auto g = grad.template chip<0>(rows[j].second);
+            if (update_slots) {
+              a += g.square();
+            }
+            if (has_epsilon) {
+              v -= g.constant(lr_scalar) * g /
+                   (a.sqrt() + a.constant(epsilon()));
+            } else {
+              v -= g.constant(lr_scalar) * g * a.rsqrt();
+            }
           }
         }
       };
 
-      d.parallelFor(N, cost, shard);
+      d.parallelFor(num_rows, cost * updates_per_row, shard);
     } else {
-      for (Tindex i = 0; i < N; ++i) {
-        const Tindex index = internal::SubtleMustCopy(indices(i));
-        if (!FastBoundsCheck(index, first_dim_size)) {
-          return errors::InvalidArgument(
-              strings::StrCat("Index ", index, " at offset ", i,
-                              " in indices is out of range"));
-        }
-      }
-
-      const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
-        for (Tindex i = start_idx; i < end_idx; ++i) {
-          const Tindex index = internal::SubtleMustCopy(indices(i));
+      const auto shard = [&](Tindex start_row, Tindex end_row) -> void {
+        for (Tindex r = start_row; r < end_row; ++r) {
+          const Tindex index = rows[row_starts[r]].first;
           T& a = accum(index);
-          const T& g = grad(i);
-          if (update_slots) {
-            a += g * g;
-          }
-          if (has_epsilon) {
-            var(index) -= lr_scalar * g / (Eigen::numext::sqrt(a) + epsilon());
-          } else {
-            var(index) -= lr_scalar * g / Eigen::numext::sqrt(a);
+          for (Tindex j = row_starts[r]; j < row_starts[r + 1]; ++j) {
+            const T& g = grad(rows[j].second);
+            if (update_slots) {
+              a += g * g;
+            }
+            if (has_epsilon) {
+              var(index) -=
+                  lr_scalar * g / (Eigen::numext::sqrt(a) + epsilon());
+            } else {
+              var(index) -= lr_scalar * g / Eigen::numext::sqrt(a);
+            }
           }
         }
       };
 
-      d.parallelFor(N, cost, shard);
+      d.parallelFor(num_rows, cost * updates_per_row, shard);
     }
 
     return OkStatus();
@@ -608,75 +638,92 @@ struct SparseApplyFtrl<CPUDevice, T, Tindex, has_l2_shrinkage> {
         l2_shrinkage_scalar = l2_shrinkage();
       }
       T lr_power_scalar = lr_power();
-      if (inner_dim > 1) {
-        const Tindex first_dim_size =
-            static_cast<Tindex>(var_flat.dimension(0));
+      const Tindex first_dim_size =
+          inner_dim > 1 ? static_cast<Tindex>(var_flat.dimension(0))
+                        : static_cast<Tindex>(accum_flat.size());
+      // Duplicate indices update the same row, so the updates are applied in
+      // parallel across distinct rows, and in order for each row.
+      std::vector<std::pair<Tindex, Tindex>> rows;
+      std::vector<Tindex> row_starts;
+      TF_RETURN_IF_ERROR(GroupIndicesByRow<Tindex>(indices_vec, first_dim_size,
+                                                   &rows, &row_starts));
+      const Tindex num_rows = static_cast<Tindex>(row_starts.size()) - 1;
+      const double updates_per_row = static_cast<double>(N) / num_rows;
+      const int in_bytes = inner_dim * sizeof(T) * 4;
+      const int out_bytes = inner_dim * sizeof(T) * 3;
+      const int cycles = inner_dim * (Eigen::TensorOpCost::AddCost<T>() * 8 +
+                                      Eigen::TensorOpCost::MulCost<T>() * 8 +
+                                      Eigen::TensorOpCost::DivCost<T>() * 2);
+      const Eigen::TensorOpCost cost(in_bytes, out_bytes, cycles);
 
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          if (!FastBoundsCheck(index, first_dim_size)) {
-            return errors::InvalidArgument(
-                strings::StrCat("Index ", index, " at offset ", i,
-                                " in indices is out of range"));
-          }
-          auto accum = accum_flat.template chip<0>(index);
-          auto linear = linear_flat.template chip<0>(index);
-          auto grad = grad_flat.template chip<0>(i);
-          auto var = var_flat.template chip<0>(index);
-
-          if (has_l2_shrinkage) {
-            auto grad_with_shrinkage =
-                grad + static_cast<T>(2) * l2_shrinkage_scalar * var;
-            ComputeFtrl(/*grad=*/grad,
-                        /*grad_maybe_with_shrinkage=*/grad_with_shrinkage,
-                        /*accum=*/accum, /*linear=*/linear, /*var=*/var,
-                        /*l1_scalar=*/l1_scalar, /*l2_scalar=*/l2_scalar,
-                        /*multiply_linear_by_lr=*/multiply_linear_by_lr,
-                        /*lr_power_scalar=*/lr_power_scalar,
-                        /*lr_scalar=*/lr_scalar);
-          } else {
-            ComputeFtrl(/*grad=*/grad, /*grad_maybe_with_shrinkage=*/grad,
-                        /*accum=*/accum, /*linear=*/linear, /*var=*/var,
-                        /*l1_scalar=*/l1_scalar, /*l2_scalar=*/l2_scalar,
-                        /*multiply_linear_by_lr=*/multiply_linear_by_lr,
-                        /*lr_power_scalar=*/lr_power_scalar,
-                        /*lr_scalar=*/lr_scalar);
+      if (inner_dim > 1) {
+        const auto shard = [&](Tindex start_row, Tindex end_row) -> void {
+          for (Tindex r = start_row; r < end_row; ++r) {
+            const Tindex index = rows[row_starts[r]].first;
+            auto accum = accum_flat.template chip<0>(index);
+            auto linear = linear_flat.template chip<0>(index);
+            auto var = var_flat.template chip<0>(index);
+            for (Tindex j = row_starts[r]; j < row_starts[r + 1]; ++j) {
+              auto grad = grad_flat.template chip<0>(rows[j].second);
+              if (has_l2_shrinkage) {
+                auto grad_with_shrinkage =
+                    grad + static_cast<T>(2) * l2_shrinkage_scalar * var;
+                ComputeFtrl(/*grad=*/grad,
+                            /*grad_maybe_with_shrinkage=*/grad_with_shrinkage,
+                            /*accum=*/accum, /*linear=*/linear, /*var=*/var,
+                            /*l1_scalar=*/l1_scalar, /*l2_scalar=*/l2_scalar,
+                            /*multiply_linear_by_lr=*/multiply_linear_by_lr,
+                            /*lr_power_scalar=*/lr_power_scalar,
+                            /*lr_scalar=*/lr_scalar);
+              } else {
+                ComputeFtrl(/*grad=*/grad, /*grad_maybe_with_shrinkage=*/grad,
+                            /*accum=*/accum, /*linear=*/linear, /*var=*/var,
+                            /*l1_scalar=*/l1_scalar, /*l2_scalar=*/l2_scalar,
+                            /*multiply_linear_by_lr=*/multiply_linear_by_lr,
+                            /*lr_power_scalar=*/lr_power_scalar,
+                            /*lr_scalar=*/lr_scalar);
+              }
+            }
           }
-        }
-      } else {
-        const Tindex first_dim_size = accum_flat.size();
+        };
 
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          if (!FastBoundsCheck(index, first_dim_size)) {
-            return errors::InvalidArgument(
-                strings::StrCat("Index ", index, " at offset ", i,
-                                " in indices is out of range"));
-          }
-          T& a = accum_flat(index);
-          T& l = linear_flat(index);
-          T& v = var_flat(index);
-          T g;
-          if (has_l2_shrinkage) {
-            g = grad_flat(i) +
-                (static_cast<T>(2) * l2_shrinkage_scalar * var_flat(index));
-          } else {
-            g = grad_flat(i);
+        d.parallelFor(num_rows, cost * updates_per_row, shard);
+      } else {
+        const auto shard = [&](Tindex start_row, Tindex end_row) -> void {
+          for (Tindex r = start_row; r < end_row; ++r) {
+            const Tindex index = rows[row_starts[r]].first;
+            T& a = accum_flat(index);
+            T& l = linear_flat(index);
+            T& v = var_flat(index);
+            for (Tindex j = row_starts[r]; j < row_starts[r + 1]; ++j) {
+              const T& grad = grad_flat(rows[j].second);
+              T g;
+              if (has_l2_shrinkage) {
+                g = grad + (static_cast<T>(2) * l2_shrinkage_scalar * v);
+              } else {
+                g = grad;
+              }
+
+              T updated_a = a + grad * grad;
+              using Eigen::numext::pow;
+              T sigma =
+                  pow(updated_a, -lr_power_scalar) - pow(a, -lr_power_scalar);
+              if (!multiply_linear_by_lr) {
+                sigma /= lr_scalar;
+              }
+              T updated_l =
+                  (multiply_linear_by_lr ? l + g * lr_scalar - sigma * v
+                                         : l + g - sigma * v);
+              v = FtrlCompute(updated_a, updated_l, lr_scalar, l1_scalar,
+                              l2_scalar, lr_power_scalar,
+                              multiply_linear_by_lr);
+              a = updated_a;
+              l = updated_l;
+            }
           }
+        };
 
-          T updated_a = a + grad_flat(i) * grad_flat(i);
-          using Eigen::numext::pow;
-          T sigma = pow(updated_a, -lr_power_scalar) - pow(a, -lr_power_scalar);
-          if (!multiply_linear_by_lr) {
-            sigma /= lr_scalar;
-          }
-          T updated_l = (multiply_linear_by_lr ? l + g * lr_scalar - sigma * v
-                                               : l + g - sigma * v);
-          v = FtrlCompute(updated_a, updated_l, lr_scalar, l1_scalar, l2_scalar,
-                          lr_power_scalar, multiply_linear_by_lr);
-          a = updated_a;
-          l = updated_l;
-        }
+        d.parallelFor(num_rows, cost * updates_per_row, shard);
       }
     }
     return OkStatus();
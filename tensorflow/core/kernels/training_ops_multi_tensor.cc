@@ -0,0 +1,311 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/training_ops.cc.
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/training_op_helpers.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// The variables are updated in chunks of at most kMultiApplyChunkSize
+// elements, which are the units of work of the thread pool. Small variables
+// are a single chunk, so that a step over many of them runs in a handful of
+// pool tasks instead of a kernel launch per variable.
+constexpr int64_t kMultiApplyChunkSize = 16 << 10;
+
+template <typename T>
+Status GetScalar(OpKernelContext* ctx, StringPiece name, T* value) {
+  const Tensor* tensor;
+  TF_RETURN_IF_ERROR(ctx->input(name, &tensor));
+  if (!TensorShapeUtils::IsScalar(tensor->shape())) {
+    return errors::InvalidArgument(name, " is not a scalar: ",
+                                   tensor->shape().DebugString());
+  }
+  *value = tensor->scalar<T>()();
+  return absl::OkStatus();
+}
+
+// The updaters compute the same expressions as the functors of the
+// corresponding ResourceApply* ops on CPU, on `size` elements starting at
+// `vars[i]` for each of the kNumVariableLists variable lists.
+template <typename T>
+struct AdamUpdater {
+  static constexpr int kNumVariableLists = 3;
+  struct Params {
+    T alpha, beta1, beta2, epsilon;
+    bool use_nesterov;
+  };
+
+  static Status GetParams(OpKernelConstruction* ctx, Params* params) {
+    return ctx->GetAttr("use_nesterov", &params->use_nesterov);
+  }
+
+  static Status GetScalars(OpKernelContext* ctx, Params* params) {
+    T beta1_power, beta2_power, lr;
+    TF_RETURN_IF_ERROR(GetScalar(ctx, "beta1_power", &beta1_power));
+    TF_RETURN_IF_ERROR(GetScalar(ctx, "beta2_power", &beta2_power));
+    TF_RETURN_IF_ERROR(GetScalar(ctx, "lr", &lr));
+    TF_RETURN_IF_ERROR(GetScalar(ctx, "beta1", &params->beta1));
+    TF_RETURN_IF_ERROR(GetScalar(ctx, "beta2", &params->beta2));
+    TF_RETURN_IF_ERROR(GetScalar(ctx, "epsilon", &params->epsilon));
+    params->alpha = lr * Eigen::numext::sqrt(T(1) - beta2_power) /
+                    (T(1) - beta1_power);
+    return absl::OkStatus();
+  }
+
+  static void Update(const Params& p, T* const* vars, const T* grad,
+                     int64_t size) {
+    auto var = typename TTypes<T>::UnalignedTensor(vars[0], size);
+    auto m = typename TTypes<T>::UnalignedTensor(vars[1], size);
+    auto v = typename TTypes<T>::UnalignedTensor(vars[2], size);
+    auto g = typename TTypes<T>::UnalignedConstTensor(grad, size);
+    m += (g - m) * (T(1) - p.beta1);
+    v += (g.square() - v) * (T(1) - p.beta2);
+    if (p.use_nesterov) {
+      var -= ((g * (T(1) - p.beta1) + p.beta1 * m) * p.alpha) /
+             (v.sqrt() + p.epsilon);
+    } else {
+      var -= (m * p.alpha) / (v.sqrt() + p.epsilon);
+    }
+  }
+};
+
+template <typename T>
+struct MomentumUpdater {
+  static constexpr int kNumVariableLists = 2;
+  struct Params {
+    T lr, momentum;
+    bool use_nesterov;
+  };
+
+  static Status GetParams(OpKernelConstruction* ctx, Params* params) {
+    return ctx->GetAttr("use_nesterov", &params->use_nesterov);
+  }
+
+  static Status GetScalars(OpKernelContext* ctx, Params* params) {
+    TF_RETURN_IF_ERROR(GetScalar(ctx, "lr", &params->lr));
+    return GetScalar(ctx, "momentum", &params->momentum);
+  }
+
+  static void Update(const Params& p, T* const* vars, const T* grad,
+                     int64_t size) {
+    auto var = typename TTypes<T>::UnalignedTensor(vars[0], size);
+    auto accum = typename TTypes<T>::UnalignedTensor(vars[1], size);
+    auto g = typename TTypes<T>::UnalignedConstTensor(grad, size);
+    accum = accum * p.momentum + g;
+    if (p.use_nesterov) {
+      var -= g * p.lr + accum * p.momentum * p.lr;
+    } else {
+      var -= accum * p.lr;
+    }
+  }
+};
+
+template <typename T>
+struct KerasMomentumUpdater : MomentumUpdater<T> {
+  using Params = typename MomentumUpdater<T>::Params;
+
+  static void Update(const Params& p, T* const* vars, const T* grad,
+                     int64_t size) {
+    auto var = typename TTypes<T>::UnalignedTensor(vars[0], size);
+    auto accum = typename TTypes<T>::UnalignedTensor(vars[1], size);
+    auto g = typename TTypes<T>::UnalignedConstTensor(grad, size);
+    accum = accum * p.momentum - g * p.lr;
+    if (p.use_nesterov) {
+      var += accum * p.momentum - g * p.lr;
+    } else {
+      var += accum;
+    }
+  }
+};
+
+template <typename T>
+struct AdagradV2Updater {
+  static constexpr int kNumVariableLists = 2;
+  struct Params {
+    T lr, epsilon;
+    bool update_slots;
+  };
+
+  static Status GetParams(OpKernelConstruction* ctx, Params* params) {
+    return ctx->GetAttr("update_slots", &params->update_slots);
+  }
+
+  static Status GetScalars(OpKernelContext* ctx, Params* params) {
+    TF_RETURN_IF_ERROR(GetScalar(ctx, "lr", &params->lr));
+    return GetScalar(ctx, "epsilon", &params->epsilon);
+  }
+
+  static void Update(const Params& p, T* const* vars, const T* grad,
+                     int64_t size) {
+    auto var = typename TTypes<T>::UnalignedTensor(vars[0], size);
+    auto accum = typename TTypes<T>::UnalignedTensor(vars[1], size);
+    auto g = typename TTypes<T>::UnalignedConstTensor(grad, size);
+    if (p.update_slots) {
+      accum += g.square();
+    }
+    var -= g * p.lr / (accum.sqrt() + p.epsilon);
+  }
+};
+
+}  // namespace
+
+// Applies an optimizer to `N` resource variables, whose variable lists (the
+// variables and their slots) are the first Updater::kNumVariableLists input
+// lists, and whose gradients are the "grad" input list.
+template <typename T, typename Updater>
+class MultiApplyOp : public OpKernel {
+ public:
+  explicit MultiApplyOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_variables_));
+    OP_REQUIRES_OK(ctx, Updater::GetParams(ctx, &params_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    constexpr int kNumLists = Updater::kNumVariableLists;
+    const bool sparse = false;
+    const int n = num_variables_;
+    std::vector<int> variable_inputs(kNumLists * n);
+    for (int i = 0; i < kNumLists * n; ++i) variable_inputs[i] = i;
+    auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
+        ctx, use_exclusive_lock_, sparse, variable_inputs);
+
+    std::vector<Tensor> variables(kNumLists * n);
+    absl::flat_hash_set<const void*> buffers;
+    for (int i = 0; i < kNumLists * n; ++i) {
+      OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                              ctx, i, use_exclusive_lock_, sparse,
+                              &variables[i]));
+      OP_REQUIRES(ctx, variables[i].IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(i)));
+      // The chunks of a variable are updated concurrently with the other
+      // variables, so no two of them may share a buffer.
+      OP_REQUIRES(ctx,
+                  variables[i].NumElements() == 0 ||
+                      buffers.insert(variables[i].tensor_data().data())
+                          .second,
+                  errors::InvalidArgument(
+                      "Input ", i, " aliases another variable input: ",
+                      requested_input(i)));
+    }
+
+    OpInputList grads;
+    OP_REQUIRES_OK(ctx, ctx->input_list("grad", &grads));
+    for (int i = 0; i < n; ++i) {
+      const Tensor& var = variables[i];
+      for (int list = 1; list < kNumLists; ++list) {
+        const Tensor& slot = variables[list * n + i];
+        OP_REQUIRES(
+            ctx, var.shape().IsSameSize(slot.shape()),
+            errors::InvalidArgument("var and ", requested_input(list * n + i),
+                                    " do not have the same shape",
+                                    var.shape().DebugString(), " ",
+                                    slot.shape().DebugString()));
+      }
+      OP_REQUIRES(
+          ctx, var.shape().IsSameSize(grads[i].shape()),
+          errors::InvalidArgument("var and grad do not have the same shape",
+                                  var.shape().DebugString(), " ",
+                                  grads[i].shape().DebugString()));
+    }
+
+    typename Updater::Params params = params_;
+    OP_REQUIRES_OK(ctx, Updater::GetScalars(ctx, &params));
+
+    struct Chunk {
+      int variable;
+      int64_t begin;
+      int64_t end;
+    };
+    std::vector<Chunk> chunks;
+    for (int i = 0; i < n; ++i) {
+      const int64_t size = variables[i].NumElements();
+      for (int64_t begin = 0; begin < size; begin += kMultiApplyChunkSize) {
+        chunks.push_back(
+            {i, begin, std::min(size, begin + kMultiApplyChunkSize)});
+      }
+    }
+
+    auto update_chunks = [&](int64_t start, int64_t limit) {
+      T* vars[kNumLists];
+      for (int64_t c = start; c < limit; ++c) {
+        const Chunk& chunk = chunks[c];
+        const int variable = chunk.variable;
+        for (int list = 0; list < kNumLists; ++list) {
+          vars[list] =
+              variables[list * n + variable].flat<T>().data() + chunk.begin;
+        }
+        Updater::Update(params, vars,
+                        grads[variable].flat<T>().data() + chunk.begin,
+                        chunk.end - chunk.begin);
+      }
+    };
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, chunks.size(),
+          /*cost_per_unit=*/kMultiApplyChunkSize * 8 * kNumLists,
+          update_chunks);
+  }
+
+ private:
+  bool use_exclusive_lock_;
+  int num_variables_;
+  typename Updater::Params params_;
+};
+
+#define REGISTER_KERNELS(T)                                                  \
+  REGISTER_KERNEL_BUILDER(Name("_ResourceMultiApplyAdam")                    \
+                              .Device(DEVICE_CPU)                            \
+                              .TypeConstraint<T>("T"),                       \
+                          MultiApplyOp<T, AdamUpdater<T>>);                  \
+  REGISTER_KERNEL_BUILDER(Name("_ResourceMultiApplyMomentum")                \
+                              .Device(DEVICE_CPU)                            \
+                              .TypeConstraint<T>("T"),                       \
+                          MultiApplyOp<T, MomentumUpdater<T>>);              \
+  REGISTER_KERNEL_BUILDER(Name("_ResourceMultiApplyKerasMomentum")           \
+                              .Device(DEVICE_CPU)                            \
+                              .TypeConstraint<T>("T"),                       \
+                          MultiApplyOp<T, KerasMomentumUpdater<T>>);         \
+  REGISTER_KERNEL_BUILDER(Name("_ResourceMultiApplyAdagradV2")               \
+                              .Device(DEVICE_CPU)                            \
+                              .TypeConstraint<T>("T"),                       \
+                          MultiApplyOp<T, AdagradV2Updater<T>>);
+
+TF_CALL_half(REGISTER_KERNELS);
+TF_CALL_bfloat16(REGISTER_KERNELS);
+TF_CALL_float(REGISTER_KERNELS);
+TF_CALL_double(REGISTER_KERNELS);
+#undef REGISTER_KERNELS
+
+}  // namespace tensorflow
@@ -0,0 +1,163 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class MultiApplyOpTest : public OpsTestBase {
+ protected:
+  // Adds a resource input of a variable of `size` elements, and returns it.
+  Var* AddVariable(const string& name, int size, float offset) {
+    Var* var = new Var(DT_FLOAT);
+    *var->tensor() = Tensor(DT_FLOAT, TensorShape({size}));
+    auto values = var->tensor()->flat<float>();
+    for (int i = 0; i < size; ++i) values(i) = std::sin(i * 0.1f) + offset;
+    var->is_initialized = true;
+    AddResourceInput<Var>("", name, var);
+    return var;
+  }
+
+  void AddGradient(int size) {
+    AddInput<float>(TensorShape({size}),
+                    [](int i) { return std::cos(i * 0.3f); });
+  }
+};
+
+TEST_F(MultiApplyOpTest, Momentum) {
+  // The second variable is updated in more than one chunk.
+  const std::vector<int> sizes = {3, 40000};
+  TF_ASSERT_OK(NodeDefBuilder("apply", "_ResourceMultiApplyMomentum")
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(2, DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("use_nesterov", true)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  std::vector<Var*> vars, accums;
+  for (int i = 0; i < 2; ++i) {
+    vars.push_back(AddVariable(absl::StrCat("var", i), sizes[i], 1));
+  }
+  for (int i = 0; i < 2; ++i) {
+    accums.push_back(AddVariable(absl::StrCat("accum", i), sizes[i], 0));
+  }
+  const float lr = 0.1f, momentum = 0.9f;
+  AddInputFromArray<float>(TensorShape({}), {lr});
+  for (int size : sizes) AddGradient(size);
+  AddInputFromArray<float>(TensorShape({}), {momentum});
+
+  std::vector<Tensor> expected_vars, expected_accums;
+  for (int i = 0; i < 2; ++i) {
+    Tensor var = tensor::DeepCopy(*vars[i]->tensor());
+    Tensor accum = tensor::DeepCopy(*accums[i]->tensor());
+    auto g = GetInput(5 + i).flat<float>();
+    for (int j = 0; j < sizes[i]; ++j) {
+      float& accum_j = accum.flat<float>()(j);
+      accum_j = accum_j * momentum + g(j);
+      var.flat<float>()(j) -= g(j) * lr + accum_j * momentum * lr;
+    }
+    expected_vars.push_back(var);
+    expected_accums.push_back(accum);
+  }
+
+  TF_ASSERT_OK(RunOpKernel());
+  for (int i = 0; i < 2; ++i) {
+    test::ExpectClose(expected_vars[i], *vars[i]->tensor());
+    test::ExpectClose(expected_accums[i], *accums[i]->tensor());
+  }
+}
+
+TEST_F(MultiApplyOpTest, Adam) {
+  const int size = 5;
+  TF_ASSERT_OK(NodeDefBuilder("apply", "_ResourceMultiApplyAdam")
+                   .Input(FakeInput(1, DT_RESOURCE))
+                   .Input(FakeInput(1, DT_RESOURCE))
+                   .Input(FakeInput(1, DT_RESOURCE))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(1, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  Var* var = AddVariable("var", size, 1);
+  Var* m = AddVariable("m", size, 0);
+  Var* v = AddVariable("v", size, 2);
+  const float beta1_power = 0.81f, beta2_power = 0.998f, lr = 0.01f,
+              beta1 = 0.9f, beta2 = 0.999f, epsilon = 1e-7f;
+  for (float scalar : {beta1_power, beta2_power, lr, beta1, beta2, epsilon}) {
+    AddInputFromArray<float>(TensorShape({}), {scalar});
+  }
+  AddGradient(size);
+
+  Tensor expected_var = tensor::DeepCopy(*var->tensor());
+  Tensor expected_m = tensor::DeepCopy(*m->tensor());
+  Tensor expected_v = tensor::DeepCopy(*v->tensor());
+  const float alpha = lr * std::sqrt(1 - beta2_power) / (1 - beta1_power);
+  auto g = GetInput(9).flat<float>();
+  for (int i = 0; i < size; ++i) {
+    float& m_i = expected_m.flat<float>()(i);
+    float& v_i = expected_v.flat<float>()(i);
+    m_i += (g(i) - m_i) * (1 - beta1);
+    v_i += (g(i) * g(i) - v_i) * (1 - beta2);
+    expected_var.flat<float>()(i) -= m_i * alpha / (std::sqrt(v_i) + epsilon);
+  }
+
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectClose(expected_var, *var->tensor());
+  test::ExpectClose(expected_m, *m->tensor());
+  test::ExpectClose(expected_v, *v->tensor());
+}
+
+TEST_F(MultiApplyOpTest, AliasedVariables) {
+  TF_ASSERT_OK(NodeDefBuilder("apply", "_ResourceMultiApplyAdagradV2")
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(2, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  Var* var = AddVariable("var", 4, 1);
+  var->Ref();
+  AddResourceInput<Var>("", "var_again", var);
+  AddVariable("accum0", 4, 0);
+  AddVariable("accum1", 4, 0);
+  AddInputFromArray<float>(TensorShape({}), {0.1f});
+  AddInputFromArray<float>(TensorShape({}), {1e-7f});
+  AddGradient(4);
+  AddGradient(4);
+  EXPECT_EQ(RunOpKernel().code(), error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace tensorflow
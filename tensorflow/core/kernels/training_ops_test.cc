@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session_options.h"
@@ -80,6 +81,16 @@ static Node* Iota(Graph* g, int n) {
   return test::graph::Constant(g, data);
 }
 
+// Returns `n` random indices in [0, m), with duplicates.
+static Node* RandomIndices(Graph* g, int n, int m) {
+  Tensor data(DT_INT32, TensorShape({n}));
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  int32* base = data.flat<int32>().data();
+  for (int i = 0; i < n; ++i) base[i] = rnd.Uniform(m);
+  return test::graph::Constant(g, data);
+}
+
 static Node* Scalar(Graph* g, float val) {
   Tensor data(DT_FLOAT, TensorShape({}));
   data.flat<float>()(0) = val;
@@ -199,6 +210,102 @@ BENCHMARK(BM_SparseAdagrad)
     ->ArgPair(128, 32 << 10)
     ->ArgPair(128, 128 << 10);
 
+// Sparse updates of `nnz` rows of a table of `rows` rows of `dim` elements,
+// picked at random with duplicates, as for embedding tables.
+static void SparseAdagradWithDuplicates(int32_t rows, int32_t dim, int32_t nnz,
+                                        Graph** init_g, Graph** train_g) {
+  {
+    Graph* g = new Graph(OpRegistry::Global());
+    auto var = Var(g, rows, dim);
+    auto accum = Var(g, rows, dim);
+    auto zero = Zeros(g, rows, dim);
+    test::graph::Assign(g, var, zero);
+    test::graph::Assign(g, accum, zero);
+    *init_g = g;
+  }
+  {
+    Graph* g = new Graph(OpRegistry::Global());
+    auto var = Var(g, rows, dim);
+    auto accum = Var(g, rows, dim);
+    auto lr = Scalar(g, 0.01);
+    auto grad = Random(g, nnz, dim);
+    auto indices = RandomIndices(g, nnz, rows);
+    test::graph::Multi(g, "SparseApplyAdagrad",
+                       {var, accum, lr, grad, indices});
+    *train_g = g;
+  }
+}
+static void BM_SparseAdagradWithDuplicates(
+    ::testing::benchmark::State& state) {
+  const int dim = state.range(0);
+  const int nnz = state.range(1);
+
+  Graph* init;
+  Graph* train;
+  SparseAdagradWithDuplicates(1 << 20, dim, nnz, &init, &train);
+  test::Benchmark("cpu", train, GetMultiThreadedOptions(), init, nullptr, "",
+                  /*old_benchmark_api*/ false)
+      .Run(state);
+  const int64_t tot = static_cast<int64_t>(state.iterations()) * nnz * dim;
+  state.SetItemsProcessed(tot);
+  state.SetBytesProcessed(tot * sizeof(float));
+}
+BENCHMARK(BM_SparseAdagradWithDuplicates)
+    ->UseRealTime()
+    ->ArgPair(16, 64 << 10)
+    ->ArgPair(64, 64 << 10)
+    ->ArgPair(64, 256 << 10);
+
+static void SparseFtrl(int32_t rows, int32_t dim, int32_t nnz, Graph** init_g,
+                       Graph** train_g) {
+  {
+    Graph* g = new Graph(OpRegistry::Global());
+    auto var = Var(g, rows, dim);
+    auto accum = Var(g, rows, dim);
+    auto linear = Var(g, rows, dim);
+    auto zero = Zeros(g, rows, dim);
+    test::graph::Assign(g, var, zero);
+    test::graph::Assign(g, accum, zero);
+    test::graph::Assign(g, linear, zero);
+    *init_g = g;
+  }
+  {
+    Graph* g = new Graph(OpRegistry::Global());
+    auto var = Var(g, rows, dim);
+    auto accum = Var(g, rows, dim);
+    auto linear = Var(g, rows, dim);
+    auto grad = Random(g, nnz, dim);
+    auto indices = RandomIndices(g, nnz, rows);
+    auto lr = Scalar(g, 0.01);
+    auto l1 = Scalar(g, 0.001);
+    auto l2 = Scalar(g, 0.001);
+    auto lr_power = Scalar(g, -0.5);
+    test::graph::Multi(
+        g, "SparseApplyFtrl",
+        {var, accum, linear, grad, indices, lr, l1, l2, lr_power});
+    *train_g = g;
+  }
+}
+static void BM_SparseFtrl(::testing::benchmark::State& state) {
+  const int dim = state.range(0);
+  const int nnz = state.range(1);
+
+  Graph* init;
+  Graph* train;
+  SparseFtrl(1 << 20, dim, nnz, &init, &train);
+  test::Benchmark("cpu", train, GetMultiThreadedOptions(), init, nullptr, "",
+                  /*old_benchmark_api*/ false)
+      .Run(state);
+  const int64_t tot = static_cast<int64_t>(state.iterations()) * nnz * dim;
+  state.SetItemsProcessed(tot);
+  state.SetBytesProcessed(tot * sizeof(float));
+}
+BENCHMARK(BM_SparseFtrl)
+    ->UseRealTime()
+    ->ArgPair(1, 64 << 10)
+    ->ArgPair(16, 64 << 10)
+    ->ArgPair(64, 256 << 10);
+
 static void Momentum(int32_t n, Graph** init_g, Graph** train_g) {
   TensorShape shape({n});
   {
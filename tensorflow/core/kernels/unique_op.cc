@@ -13,9 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
+#include <memory>
+#include <numeric>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +73,9 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Vectors of at least this many elements are uniquified in parallel.
+constexpr int64_t kParallelUniqueMinSize = 1 << 18;
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -142,6 +150,15 @@ class UniqueOp : public OpKernel {
                                 1, TensorShape({new_sizes[1]}), &idx));
     auto idx_vec = idx->template vec<TIndex>();
 
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    if (new_sizes[0] == 1 && new_sizes[2] == 1 &&
+        new_sizes[1] >= kParallelUniqueMinSize &&
+        worker_threads.num_threads > 1) {
+      ComputeParallel(context, input, axis, idx_vec);
+      return;
+    }
+
     int64_t uniq_size;
     if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
@@ -237,6 +254,158 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  // Same as the specialized implementation for single elements, in parallel.
+  //
+  // The positions of the elements are partitioned by the hash of the
+  // elements, and every partition is uniquified independently, in increasing
+  // order of the positions, which finds the first occurrence of every unique
+  // element. The index of a unique element in the output is then the number
+  // of first occurrences before its own, as in the sequential implementation.
+  void ComputeParallel(OpKernelContext* context, const Tensor& input,
+                       int64_t axis, typename TTypes<TIndex>::Vec idx_vec) {
+    using Map = typename UniqueOpHashMap<T, int32>::map_type;
+    auto Tin = input.flat<T>();
+    const int64_t N = Tin.size();
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int num_threads = worker_threads.num_threads;
+    int log2_partitions = 1;
+    while ((1 << log2_partitions) < 4 * num_threads && log2_partitions < 8) {
+      ++log2_partitions;
+    }
+    const int num_partitions = 1 << log2_partitions;
+    auto partition_of = [&](int64_t i) {
+      const uint64 hash =
+          typename Map::hasher()(typename Map::key_type(Tin(i)));
+      // The high bits of the mixed hash are used, so that the hash maps of
+      // the partitions don't all see the same low bits of the hash.
+      return static_cast<uint8>((hash * 0x9E3779B97F4A7C15ULL) >>
+                                (64 - log2_partitions));
+    };
+    const int64_t num_blocks = 4 * num_threads;
+    const int64_t block_size = (N + num_blocks - 1) / num_blocks;
+    auto block_range = [&](int64_t block) {
+      return std::make_pair(std::min(block * block_size, N),
+                            std::min((block + 1) * block_size, N));
+    };
+    auto sharded = [&](int64_t total, int64_t cost_per_unit, auto fn) {
+      Shard(num_threads, worker_threads.workers, total, cost_per_unit,
+            [&fn](int64_t start, int64_t limit) {
+              for (int64_t unit = start; unit < limit; ++unit) fn(unit);
+            });
+    };
+
+    // Sorts the positions by partition, in increasing order within every
+    // partition. `first_index` is zeroed for later.
+    std::vector<uint8> partitions(N);
+    std::vector<int32> block_counts(num_blocks * num_partitions, 0);
+    std::unique_ptr<int32[]> first_index(new int32[N]);
+    sharded(num_blocks, 20 * block_size, [&](int64_t block) {
+      const auto range = block_range(block);
+      int32* counts = &block_counts[block * num_partitions];
+      for (int64_t i = range.first; i < range.second; ++i) {
+        partitions[i] = partition_of(i);
+        ++counts[partitions[i]];
+      }
+      std::fill(&first_index[range.first], &first_index[range.second], 0);
+    });
+    std::vector<int32> partition_starts(num_partitions + 1);
+    int32 offset = 0;
+    for (int p = 0; p < num_partitions; ++p) {
+      partition_starts[p] = offset;
+      for (int64_t block = 0; block < num_blocks; ++block) {
+        const int32 count = block_counts[block * num_partitions + p];
+        block_counts[block * num_partitions + p] = offset;
+        offset += count;
+      }
+    }
+    partition_starts[num_partitions] = offset;
+    std::vector<int32> positions(N);
+    sharded(num_blocks, 4 * block_size, [&](int64_t block) {
+      const auto range = block_range(block);
+      int32* next = &block_counts[block * num_partitions];
+      for (int64_t i = range.first; i < range.second; ++i) {
+        positions[next[partitions[i]]++] = i;
+      }
+    });
+
+    // Uniquifies every partition. `local_ids` are the indices of the elements
+    // of `positions` among the unique elements of their partition, and
+    // `first_positions` the positions of the first occurrences of the unique
+    // elements of every partition, which are flagged in `first_index`.
+    std::vector<int32> local_ids(N);
+    std::vector<std::vector<int32>> first_positions(num_partitions);
+    const int64_t partition_cost = 100 * (N / num_partitions + 1);
+    sharded(num_partitions, partition_cost, [&](int64_t p) {
+      Map uniq;
+      uniq.reserve(2 * (partition_starts[p + 1] - partition_starts[p]));
+      std::vector<int32>& firsts = first_positions[p];
+      for (int32 k = partition_starts[p]; k < partition_starts[p + 1]; ++k) {
+        auto it = uniq.emplace(Tin(positions[k]), firsts.size());
+        local_ids[k] = it.first->second;
+        if (it.second) {
+          firsts.push_back(positions[k]);
+          first_index[positions[k]] = 1;
+        }
+      }
+    });
+
+    // Replaces the flags of the first occurrences by their indices among all
+    // the first occurrences.
+    std::vector<int32> block_firsts(num_blocks);
+    sharded(num_blocks, 2 * block_size, [&](int64_t block) {
+      const auto range = block_range(block);
+      block_firsts[block] = std::accumulate(&first_index[range.first],
+                                            &first_index[range.second], 0);
+    });
+    int32 uniq_size = 0;
+    for (int64_t block = 0; block < num_blocks; ++block) {
+      const int32 count = block_firsts[block];
+      block_firsts[block] = uniq_size;
+      uniq_size += count;
+    }
+    sharded(num_blocks, 2 * block_size, [&](int64_t block) {
+      const auto range = block_range(block);
+      int32 next = block_firsts[block];
+      for (int64_t i = range.first; i < range.second; ++i) {
+        if (first_index[i]) first_index[i] = next++;
+      }
+    });
+
+    TensorShape output_shape(input.shape());
+    output_shape.set_dim(axis, uniq_size);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+    Tensor* count_output = nullptr;
+    if (num_outputs() > 2) {
+      OP_REQUIRES_OK(context, context->allocate_output(
+                                  2, TensorShape({uniq_size}), &count_output));
+    }
+
+    // Writes the outputs of every partition. The unique elements of different
+    // partitions are different, so the partitions update disjoint counts.
+    sharded(num_partitions, partition_cost / 4, [&](int64_t p) {
+      const std::vector<int32>& firsts = first_positions[p];
+      std::vector<int32> uniq_index(firsts.size());
+      for (size_t u = 0; u < firsts.size(); ++u) {
+        uniq_index[u] = first_index[firsts[u]];
+        Tout(uniq_index[u]) = Tin(firsts[u]);
+      }
+      if (count_output != nullptr) {
+        auto counts = count_output->vec<TIndex>();
+        for (const int32 index : uniq_index) counts(index) = 0;
+        for (int32 k = partition_starts[p]; k < partition_starts[p + 1]; ++k) {
+          ++counts(uniq_index[local_ids[k]]);
+        }
+      }
+      for (int32 k = partition_starts[p]; k < partition_starts[p + 1]; ++k) {
+        idx_vec(positions[k]) = uniq_index[local_ids[k]];
+      }
+    });
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                      \
@@ -15,11 +15,16 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
@@ -37,6 +42,42 @@ namespace {
 
 const int kMaxStrLen = 40;
 
+class UniqueOpTest : public OpsTestBase {};
+
+TEST_F(UniqueOpTest, LargeInputWithCounts) {
+  // Large enough to be uniquified in parallel.
+  const int dim = 1 << 19;
+  TF_ASSERT_OK(NodeDefBuilder("unique", "UniqueWithCounts")
+                   .Input(FakeInput(DT_INT32))
+                   .Attr("out_idx", DT_INT32)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInput<int32>(TensorShape({dim}),
+                  [](int i) { return (i * 7919) % 10007 - (i % 3) * 5000; });
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::unordered_map<int32, int32> first_index;
+  std::vector<int32> expected_values;
+  std::vector<int32> expected_indices;
+  std::vector<int32> expected_counts;
+  auto input = GetInput(0).vec<int32>();
+  for (int i = 0; i < dim; ++i) {
+    auto it = first_index.emplace(input(i), expected_values.size());
+    if (it.second) {
+      expected_values.push_back(input(i));
+      expected_counts.push_back(0);
+    }
+    expected_indices.push_back(it.first->second);
+    ++expected_counts[it.first->second];
+  }
+  test::ExpectTensorEqual<int32>(*GetOutput(0),
+                                 test::AsTensor<int32>(expected_values));
+  test::ExpectTensorEqual<int32>(*GetOutput(1),
+                                 test::AsTensor<int32>(expected_indices));
+  test::ExpectTensorEqual<int32>(*GetOutput(2),
+                                 test::AsTensor<int32>(expected_counts));
+}
+
 TensorProto GetRandomInt32TensorProto(int dim, int max_int) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_INT32);
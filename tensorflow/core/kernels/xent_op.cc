@@ -19,11 +19,15 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/xent_op.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/xent_op_cpu_impl.h"
 #include "tensorflow/core/util/bcast.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/env_var.h"
@@ -122,8 +126,63 @@ struct XentFunctorBase {
   }
 };
 
+// Without broadcasting, the CPU computes the loss and the gradient of the rows
+// of logits in two passes over them instead. See xent_op_cpu_impl.h.
 template <typename T>
-struct XentFunctor<CPUDevice, T> : XentFunctorBase<CPUDevice, T> {};
+struct XentFunctor<CPUDevice, T> : XentFunctorBase<CPUDevice, T> {
+  void operator()(const CPUDevice& d,
+                  const Eigen::DSizes<Eigen::DenseIndex, 2>& shape,
+                  const Eigen::array<Eigen::DenseIndex, 2>& logits_bcast,
+                  const Eigen::array<Eigen::DenseIndex, 2>& labels_bcast,
+                  typename TTypes<T>::ConstMatrix logits,
+                  typename TTypes<T>::ConstMatrix labels,
+                  typename TTypes<T>::Matrix scratch,
+                  typename TTypes<T>::Vec loss,
+                  typename TTypes<T>::Matrix backprop) {
+    const bool broadcasts = logits_bcast[0] != 1 || logits_bcast[1] != 1 ||
+                            labels_bcast[0] != 1 || labels_bcast[1] != 1;
+    if (broadcasts) {
+      XentFunctorBase<CPUDevice, T>::operator()(
+          d, shape, logits_bcast, labels_bcast, logits, labels, scratch, loss,
+          backprop);
+      return;
+    }
+
+    using A = xent_cpu::Acc<T>;
+    const int64_t num_classes = shape[1];
+    const T* logits_data = logits.data();
+    const T* labels_data = labels.data();
+    T* backprop_data = backprop.data();
+    // loss = sum(labels * (log(sum_exp) - (logits - max))), and
+    // backprop = softmax(logits) - labels. `backprop` may alias `logits`, so
+    // the loss of every tile is computed before its gradients are written.
+    auto grad_fn = [&](int64_t row, const xent_cpu::SoftmaxStats<A>& stats,
+                       int64_t begin, int64_t end) {
+      const A log_sum_exp = std::log(stats.sum_exp);
+      const A inv_sum_exp = A(1) / stats.sum_exp;
+      A row_loss = 0;
+      const int64_t offset = row * num_classes;
+      for (int64_t start = begin; start < end; start += xent_cpu::kTileSize) {
+        const int64_t size = std::min(xent_cpu::kTileSize, end - start);
+        const xent_cpu::ConstArrayMap<T> tile_logits(
+            logits_data + offset + start, size);
+        const xent_cpu::ConstArrayMap<T> tile_labels(
+            labels_data + offset + start, size);
+        const auto shifted_logits = tile_logits.template cast<A>() - stats.max;
+        row_loss += (tile_labels.template cast<A>() *
+                     (log_sum_exp - shifted_logits))
+                        .sum();
+        xent_cpu::ArrayMap<T>(backprop_data + offset + start, size) =
+            (shifted_logits.exp() * inv_sum_exp -
+             tile_labels.template cast<A>())
+                .template cast<T>();
+      }
+      return row_loss;
+    };
+    xent_cpu::Compute(d, logits_data, shape[0], num_classes, loss.data(),
+                      grad_fn);
+  }
+};
 
 }  // namespace functor
 
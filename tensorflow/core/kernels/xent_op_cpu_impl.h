@@ -0,0 +1,159 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_XENT_OP_CPU_IMPL_H_
+#define TENSORFLOW_CORE_KERNELS_XENT_OP_CPU_IMPL_H_
+
+// Tiled CPU implementation of the softmax cross entropy kernels.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+
+namespace tensorflow {
+namespace xent_cpu {
+
+// Number of classes of the tiles in which the rows of logits are processed.
+// A tile stays in cache between the reductions over it.
+constexpr int64_t kTileSize = 1024;
+
+// Minimum number of classes of the chunks in which the rows are split when
+// there are fewer rows than threads.
+constexpr int64_t kMinChunkSize = 16 * 1024;
+
+// Estimate of the cycles spent per class by each of the two passes.
+constexpr int kCyclesPerClass = 24;
+
+// Type in which the softmax statistics and the losses are accumulated.
+template <typename T>
+using Acc = typename std::conditional<std::is_same<T, double>::value, double,
+                                      float>::type;
+
+template <typename T>
+using ConstArrayMap = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+template <typename T>
+using ArrayMap = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+
+// Maximum of a range of logits, and sum of their exponentials relative to the
+// maximum.
+template <typename A>
+struct SoftmaxStats {
+  A max = -std::numeric_limits<A>::infinity();
+  A sum_exp = 0;
+
+  // Makes sum_exp relative to `new_max`, which must be >= max.
+  void Rescale(A new_max) {
+    if (new_max == max) return;
+    sum_exp *= std::exp(max - new_max);
+    max = new_max;
+  }
+
+  void Merge(SoftmaxStats other) {
+    if (other.max > max) {
+      Rescale(other.max);
+    } else {
+      other.Rescale(max);
+    }
+    sum_exp += other.sum_exp;
+  }
+};
+
+// Computes the softmax statistics of `logits[0, size)` in a single pass over
+// memory: the maximum of a tile is computed first, and the sum of the
+// exponentials of the tile is added to the ones of the previous tiles, after
+// they are rescaled to the new maximum.
+template <typename T>
+SoftmaxStats<Acc<T>> ComputeStats(const T* logits, int64_t size) {
+  using A = Acc<T>;
+  SoftmaxStats<A> stats;
+  for (int64_t start = 0; start < size; start += kTileSize) {
+    ConstArrayMap<T> tile(logits + start, std::min(kTileSize, size - start));
+    stats.Rescale(std::max(stats.max, static_cast<A>(tile.maxCoeff())));
+    // Only logits of -inf have been seen if the maximum still is -inf, their
+    // exponentials are 0 whatever the maximum.
+    const A offset =
+        stats.max == -std::numeric_limits<A>::infinity() ? A(0) : stats.max;
+    stats.sum_exp += (tile.template cast<A>() - offset).exp().sum();
+  }
+  return stats;
+}
+
+// Computes the softmax cross entropy losses of the rows of `logits`, of shape
+// [batch_size, num_classes], into `loss`.
+//
+// The softmax statistics of all the rows are computed first. Then
+// `grad_fn(row, stats, begin, end)` is called for chunks [begin, end) of the
+// classes of every row. It must write the gradients of these classes, and
+// return their contribution to the loss of the row. The rows are split into
+// chunks when there are fewer rows than threads, and both passes run in
+// parallel over all the chunks.
+template <typename T, typename GradFn>
+void Compute(const Eigen::ThreadPoolDevice& d, const T* logits,
+             int64_t batch_size, int64_t num_classes, T* loss,
+             GradFn grad_fn) {
+  using A = Acc<T>;
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>((d.numThreads() + batch_size - 1) / batch_size,
+                           num_classes / kMinChunkSize));
+  const int64_t chunk_size = (num_classes + num_chunks - 1) / num_chunks;
+  const int64_t num_units = batch_size * num_chunks;
+  const Eigen::TensorOpCost cost(chunk_size * sizeof(T), chunk_size * sizeof(T),
+                                 chunk_size * kCyclesPerClass);
+
+  std::vector<SoftmaxStats<A>> stats(num_units);
+  d.parallelFor(num_units, cost, [&](Eigen::Index first, Eigen::Index last) {
+    for (Eigen::Index unit = first; unit < last; ++unit) {
+      const int64_t begin = (unit % num_chunks) * chunk_size;
+      const int64_t end = std::min(begin + chunk_size, num_classes);
+      stats[unit] = ComputeStats(
+          logits + (unit / num_chunks) * num_classes + begin, end - begin);
+    }
+  });
+  for (int64_t row = 0; row < batch_size; ++row) {
+    for (int64_t chunk = 1; chunk < num_chunks; ++chunk) {
+      stats[row * num_chunks].Merge(stats[row * num_chunks + chunk]);
+    }
+  }
+
+  std::vector<A> losses(num_units);
+  d.parallelFor(num_units, cost, [&](Eigen::Index first, Eigen::Index last) {
+    for (Eigen::Index unit = first; unit < last; ++unit) {
+      const int64_t row = unit / num_chunks;
+      const int64_t begin = (unit % num_chunks) * chunk_size;
+      const int64_t end = std::min(begin + chunk_size, num_classes);
+      losses[unit] = grad_fn(row, stats[row * num_chunks], begin, end);
+    }
+  });
+  for (int64_t row = 0; row < batch_size; ++row) {
+    A row_loss = 0;
+    for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+      row_loss += losses[row * num_chunks + chunk];
+    }
+    loss[row] = static_cast<T>(row_loss);
+  }
+}
+
+}  // namespace xent_cpu
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_XENT_OP_CPU_IMPL_H_
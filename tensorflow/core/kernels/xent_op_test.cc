@@ -14,13 +14,81 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/kernels/xent_op.h"
+
+#include <algorithm>
+#include <cmath>
+
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
+class XentOpTest : public OpsTestBase {
+ protected:
+  // Compares the op with a reference computed in double precision.
+  void RunAndCompare(int batch_size, int num_classes) {
+    TF_ASSERT_OK(NodeDefBuilder("xent", "SoftmaxCrossEntropyWithLogits")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    auto logit = [](int i) { return 10 * std::sin(i * 0.37f); };
+    // Not normalized, the loss does not require the labels to sum to 1.
+    auto label = [](int i) { return std::abs(std::cos(i * 0.11f)); };
+    const TensorShape shape({batch_size, num_classes});
+    AddInput<float>(shape, logit);
+    AddInput<float>(shape, label);
+    TF_ASSERT_OK(RunOpKernel());
+
+    // The backprop may be computed in place of the logits.
+    Tensor logits_t(DT_FLOAT, shape);
+    test::FillFn<float>(&logits_t, logit);
+    Tensor labels_t(DT_FLOAT, shape);
+    test::FillFn<float>(&labels_t, label);
+    auto logits = logits_t.matrix<float>();
+    auto labels = labels_t.matrix<float>();
+    Tensor expected_loss(DT_FLOAT, TensorShape({batch_size}));
+    Tensor expected_backprop(DT_FLOAT, shape);
+    for (int b = 0; b < batch_size; ++b) {
+      double max_logit = logits(b, 0);
+      for (int c = 0; c < num_classes; ++c) {
+        max_logit = std::max<double>(max_logit, logits(b, c));
+      }
+      double sum_exp = 0;
+      for (int c = 0; c < num_classes; ++c) {
+        sum_exp += std::exp(logits(b, c) - max_logit);
+      }
+      double loss = 0;
+      for (int c = 0; c < num_classes; ++c) {
+        loss += labels(b, c) * (std::log(sum_exp) - (logits(b, c) - max_logit));
+        expected_backprop.matrix<float>()(b, c) =
+            std::exp(logits(b, c) - max_logit) / sum_exp - labels(b, c);
+      }
+      expected_loss.vec<float>()(b) = loss;
+    }
+    test::ExpectClose(expected_loss, *GetOutput(0), /*atol=*/1e-5,
+                      /*rtol=*/1e-4);
+    test::ExpectClose(expected_backprop, *GetOutput(1), /*atol=*/1e-6,
+                      /*rtol=*/1e-4);
+  }
+};
+
+TEST_F(XentOpTest, NarrowRows) {
+  RunAndCompare(/*batch_size=*/5, /*num_classes=*/3000);
+}
+
+TEST_F(XentOpTest, WideRows) {
+  // Wide enough for the rows to be split into chunks.
+  RunAndCompare(/*batch_size=*/1, /*num_classes=*/100000);
+}
+
 template <class T>
 static Graph* Xent(int batch_size, int num_classes, DataType type) {
   Graph* g = new Graph(OpRegistry::Global());
@@ -65,18 +133,19 @@ BM_XentDev(64, 100000, gpu, float, DT_FLOAT);
 #endif  // GOOGLE_CUDA
 
 /// Only the smaller tests for CPU. Otherwise, it's too slow
-#define BM_XentDev_CPU(C_TYPE, TF_TYPE)         \
-  BM_XentDev(1, 10000, cpu, C_TYPE, TF_TYPE);   \
-  BM_XentDev(2, 10000, cpu, C_TYPE, TF_TYPE);   \
-  BM_XentDev(4, 10000, cpu, C_TYPE, TF_TYPE);   \
-  BM_XentDev(8, 10000, cpu, C_TYPE, TF_TYPE);   \
-  BM_XentDev(16, 10000, cpu, C_TYPE, TF_TYPE);  \
-  BM_XentDev(32, 10000, cpu, C_TYPE, TF_TYPE);  \
-  BM_XentDev(64, 10000, cpu, C_TYPE, TF_TYPE);  \
-  BM_XentDev(128, 10000, cpu, C_TYPE, TF_TYPE); \
-  BM_XentDev(256, 10000, cpu, C_TYPE, TF_TYPE); \
-  BM_XentDev(512, 10000, cpu, C_TYPE, TF_TYPE); \
-  BM_XentDev(1024, 10000, cpu, C_TYPE, TF_TYPE)
+#define BM_XentDev_CPU(C_TYPE, TF_TYPE)          \
+  BM_XentDev(1, 10000, cpu, C_TYPE, TF_TYPE);    \
+  BM_XentDev(2, 10000, cpu, C_TYPE, TF_TYPE);    \
+  BM_XentDev(4, 10000, cpu, C_TYPE, TF_TYPE);    \
+  BM_XentDev(8, 10000, cpu, C_TYPE, TF_TYPE);    \
+  BM_XentDev(16, 10000, cpu, C_TYPE, TF_TYPE);   \
+  BM_XentDev(32, 10000, cpu, C_TYPE, TF_TYPE);   \
+  BM_XentDev(64, 10000, cpu, C_TYPE, TF_TYPE);   \
+  BM_XentDev(128, 10000, cpu, C_TYPE, TF_TYPE);  \
+  BM_XentDev(256, 10000, cpu, C_TYPE, TF_TYPE);  \
+  BM_XentDev(512, 10000, cpu, C_TYPE, TF_TYPE);  \
+  BM_XentDev(1024, 10000, cpu, C_TYPE, TF_TYPE); \
+  BM_XentDev(8, 250000, cpu, C_TYPE, TF_TYPE)
 
 BM_XentDev_CPU(float, DT_FLOAT);
 BM_XentDev_CPU(bfloat16, DT_BFLOAT16);
@@ -66,11 +66,15 @@ REGISTER_OP("BatchFunction")
     // same batch, i.e., no low priority input padding high priority batches.
     // Low priority inputs get scheduled only as part of low priority only
     // batches as described above.
+    // priority_preemption: Same as above, but low priority only batches are
+    // formed one at a time, so that high priority inputs which arrive in the
+    // meantime run ahead of the remaining low priority inputs.
     .Attr(
         "mixed_priority_policy: "
         "{'low_priority_padding_with_max_batch_size', "
         "'low_priority_padding_with_next_allowed_batch_size', "
-        "'priority_isolation'} = 'low_priority_padding_with_max_batch_size'")
+        "'priority_isolation', 'priority_preemption'} = "
+        "'low_priority_padding_with_max_batch_size'")
     .Attr("Tin: list(type)")
     .Attr("Tcaptured: list(type) >= 0")
     .Attr("Tout: list(type)")
@@ -80,6 +84,22 @@ REGISTER_OP("BatchFunction")
     // NOTE: Support for `enable_large_batch_splitting == true` is still
     // developed in progress.
     .Attr("enable_large_batch_splitting: bool = false")
+    // If 'ragged_dimension' is not negative, inputs are grouped into buckets
+    // by their size along this dimension, and only inputs of the same bucket
+    // are batched together. An input goes to the first bucket whose entry in
+    // 'ragged_bucket_boundaries' is at least its size, and is zero padded up
+    // to that size. Outputs which have the size of the bucket along the
+    // dimension are sliced back to the size of the input.
+    // 'ragged_bucket_max_batch_sizes', if not empty, bounds the batch size of
+    // every bucket, and must list values of "allowed_batch_sizes".
+    .Attr("ragged_dimension: int = -1")
+    .Attr("ragged_bucket_boundaries: list(int) = []")
+    .Attr("ragged_bucket_max_batch_sizes: list(int) = []")
+    // If 'assemble_batches_in_place' is true, inputs are copied into a buffer
+    // of the batch as soon as they join it instead of being concatenated once
+    // the batch is closed, and outputs are slices of the batch outputs
+    // instead of copies.
+    .Attr("assemble_batches_in_place: bool = false")
     // TODO(apassos): Fix this shape inference function. It requires shape
     // inference of function calls.
     .SetShapeFn(shape_inference::UnknownShape)
@@ -175,6 +175,10 @@ REGISTER_OP("CompressElement")
     .Input("components: input_types")
     .Output("compressed: variant")
     .Attr("input_types: list(type) >= 1")
+    .Attr(
+        "codec: {'snappy', 'none', 'zstd', 'byte_shuffle_zstd', 'autotune'} = "
+        "'snappy'")
+    .Attr("link_bandwidth_bytes_per_second: int = 0")
     .SetShapeFn(shape_inference::ScalarShape);
 
 REGISTER_OP("UncompressElement")
@@ -475,6 +479,41 @@ REGISTER_OP("GroupByWindowDataset")
                                                            "output_types"))
     .SetShapeFn(shape_inference::ScalarShape);
 
+REGISTER_OP("BucketBySequenceLengthDataset")
+    .Input("input_dataset: variant")
+    .Input("element_length_func_other_arguments: "
+           "Telement_length_func_other_arguments")
+    .Input("bucket_boundaries: int64")
+    .Input("bucket_batch_sizes: int64")
+    .Input("padded_shapes: N * int64")
+    .Input("padding_values: Toutput_types")
+    .Input("max_buffered_bytes: int64")
+    .Input("max_window_age: int64")
+    .Output("handle: variant")
+    .Attr("element_length_func: func")
+    .Attr("Telement_length_func_other_arguments: list(type) >= 0")
+    .Attr("Toutput_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .Attr("N: int >= 1")
+    .Attr("metadata: string = ''")
+    .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
+                                                           "Toutput_types"))
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      std::vector<shape_inference::ShapeHandle> shapes;
+      // bucket_boundaries and bucket_batch_sizes should be vectors.
+      TF_RETURN_IF_ERROR(c->input("bucket_boundaries", &shapes));
+      TF_RETURN_IF_ERROR(c->WithRank(shapes[0], 1, &unused));
+      TF_RETURN_IF_ERROR(c->input("bucket_batch_sizes", &shapes));
+      TF_RETURN_IF_ERROR(c->WithRank(shapes[0], 1, &unused));
+      // max_buffered_bytes and max_window_age should be scalars.
+      TF_RETURN_IF_ERROR(
+          c->WithRank(c->input(c->num_inputs() - 2), 0, &unused));
+      TF_RETURN_IF_ERROR(
+          c->WithRank(c->input(c->num_inputs() - 1), 0, &unused));
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("GetElementAtIndex")
     .Input("dataset: variant")
     .Input("index: int64")
@@ -867,6 +906,10 @@ REGISTER_OP("ParseExampleDatasetV2")
     .Attr("ragged_keys: list(string) >= 0 = []")
     .Attr("ragged_value_types: list({float,int64,string}) >= 0 = []")
     .Attr("ragged_split_types: list({int32,int64}) >= 0 = []")
+    // If positive, the elements of `input_dataset` are scalar serialized
+    // `Example`s, which are batched by this op before being parsed.
+    .Attr("batch_size: int = 0")
+    .Attr("drop_remainder: bool = false")
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
     .SetShapeFn(shape_inference::ScalarShape);
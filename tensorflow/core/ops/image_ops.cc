@@ -560,6 +560,30 @@ REGISTER_OP("ExtractJpegShape")
       return absl::OkStatus();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("BatchDecodeAndResizeJpeg")
+    .Input("contents: string")
+    .Input("size: int32")
+    .Attr("channels: int = 3")
+    .Attr("half_pixel_centers: bool = true")
+    .Attr("dct_scaling: bool = true")
+    .Attr("scale: float = 1.0")
+    .Attr("offset: float = 0.0")
+    .Output("images: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle contents;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &contents));
+      int32_t channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels != 1 && channels != 3) {
+        return errors::InvalidArgument("channels must be 1 or 3, got ",
+                                       channels);
+      }
+      return SetOutputToSizedImage(c, c->Dim(contents, 0),
+                                   1 /* size_input_idx */,
+                                   c->MakeDim(channels));
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("AdjustContrast")
     .Input("images: T")
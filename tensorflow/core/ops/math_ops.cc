@@ -1473,6 +1473,102 @@ REGISTER_OP("SparseSegmentSqrtNGradV2")
     .Attr("Tsegmentids: {int32, int64} = DT_INT32")
     .SetShapeFn(SparseSegmentReductionGradV2ShapeFn);
 
+namespace {
+
+// Shape function of the fused sparse embedding lookups, for an embedding
+// table of shape `params_shape`.
+Status FusedSparseEmbeddingLookupShapeFn(InferenceContext* c,
+                                         ShapeHandle params_shape) {
+  TF_RETURN_IF_ERROR(c->WithRankAtLeast(params_shape, 1, &params_shape));
+  ShapeHandle unused;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+  ShapeHandle indices_shape;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &indices_shape));
+  ShapeHandle segment_ids_shape;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &segment_ids_shape));
+  // indices, segment_ids and the weights should merge cleanly.
+  TF_RETURN_IF_ERROR(c->Merge(indices_shape, segment_ids_shape, &unused));
+  int num_weights;
+  TF_RETURN_IF_ERROR(c->GetAttr("num_weights", &num_weights));
+  if (num_weights > 1) {
+    return errors::InvalidArgument("num_weights must be 0 or 1 but is ",
+                                   num_weights);
+  }
+  if (num_weights == 1) {
+    ShapeHandle weights_shape;
+    TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 1, &weights_shape));
+    TF_RETURN_IF_ERROR(c->Merge(indices_shape, weights_shape, &unused));
+  }
+
+  ShapeHandle subshape;
+  TF_RETURN_IF_ERROR(c->Subshape(params_shape, 1, &subshape));
+  ShapeHandle out;
+  TF_RETURN_IF_ERROR(
+      c->Concatenate(c->Vector(InferenceContext::kUnknownDim), subshape, &out));
+  c->set_output(0, out);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+REGISTER_OP("_FusedSparseEmbeddingLookup")
+    .Input("params: T")
+    .Input("ids: Tids")
+    .Input("indices: Tidx")
+    .Input("segment_ids: Tsegmentids")
+    .Input("weights: num_weights * T")
+    .Output("output: T")
+    .Attr("T: {float}")
+    .Attr("Tids: {int32, int64} = DT_INT32")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .Attr("num_weights: int >= 0 = 0")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'sum'")
+    .SetShapeFn([](InferenceContext* c) {
+      return FusedSparseEmbeddingLookupShapeFn(c, c->input(0));
+    })
+    .Doc(R"doc(
+Internal sparse embedding lookup: reserved for internal use.
+
+Computes the same output as SparseSegmentSum, SparseSegmentMean or
+SparseSegmentSqrtN (for the `combiner` sum, mean or sqrtn) of
+`Gather(params, ids)`, with the rows optionally multiplied by `weights`, without
+materializing the gathered rows.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
+REGISTER_OP("_FusedResourceSparseEmbeddingLookup")
+    .Input("resource: resource")
+    .Input("ids: Tids")
+    .Input("indices: Tidx")
+    .Input("segment_ids: Tsegmentids")
+    .Input("weights: num_weights * dtype")
+    .Output("output: dtype")
+    .Attr("dtype: {float}")
+    .Attr("Tids: {int32, int64} = DT_INT32")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .Attr("num_weights: int >= 0 = 0")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'sum'")
+    .SetShapeFn([](InferenceContext* c) {
+      std::vector<shape_inference::ShapeAndType> handle_shape_and_type;
+      TF_RETURN_IF_ERROR(shape_inference::ValidateVariableResourceHandle(
+          c, &handle_shape_and_type));
+      return FusedSparseEmbeddingLookupShapeFn(c,
+                                               handle_shape_and_type[0].shape);
+    })
+    .Doc(R"doc(
+Internal sparse embedding lookup in a resource variable: reserved for internal
+use.
+
+Same as _FusedSparseEmbeddingLookup for the value of the variable `resource`.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("All")
     .Input("input: bool")
     .Input("reduction_indices: Tidx")
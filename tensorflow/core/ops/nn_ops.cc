@@ -260,6 +260,95 @@ Do not invoke this operator directly in Python. A fusion optimization is
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedLayerNorm")
+    .Input("x: T")
+    .Input("scale: T")
+    .Input("offset: T")
+    .Output("y: T")
+    .Attr("T: {float}")
+    .Attr("epsilon: float = 0.001")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle x;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &x));
+      ShapeHandle scale;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &scale));
+      ShapeHandle offset;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &offset));
+      DimensionHandle depth = c->Dim(x, -1);
+      TF_RETURN_IF_ERROR(c->Merge(depth, c->Dim(scale, 0), &depth));
+      TF_RETURN_IF_ERROR(c->Merge(depth, c->Dim(offset, 0), &depth));
+      c->set_output(0, x);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Internal layer normalization over the last dimension of `x`, followed by
+`scale` and `offset`: reserved for internal use.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
+REGISTER_OP("_FusedAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Input("bias: num_bias * T")
+    .Output("output: T")
+    .Attr("T: {half, float}")
+    .Attr("num_bias: int >= 0 = 0")
+    .Attr("scale: float = 1.0")
+    .Attr("causal: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle query;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 2, &query));
+      ShapeHandle key = c->input(1);
+      ShapeHandle value = c->input(2);
+      int num_bias;
+      TF_RETURN_IF_ERROR(c->GetAttr("num_bias", &num_bias));
+      if (num_bias > 1) {
+        return errors::InvalidArgument("num_bias must be 0 or 1 but is ",
+                                       num_bias);
+      }
+      if (c->RankKnown(query)) {
+        TF_RETURN_IF_ERROR(c->WithRank(key, c->Rank(query), &key));
+        TF_RETURN_IF_ERROR(c->WithRank(value, c->Rank(query), &value));
+        if (num_bias == 1) {
+          ShapeHandle unused;
+          TF_RETURN_IF_ERROR(
+              c->WithRank(c->input(3), c->Rank(query), &unused));
+        }
+      }
+      if (!c->RankKnown(query) || !c->RankKnown(value)) {
+        c->set_output(0, c->UnknownShape());
+        return absl::OkStatus();
+      }
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(query, -1), c->Dim(key, -1), &unused));
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(key, -2), c->Dim(value, -2), &unused));
+      ShapeHandle batch_and_rows;
+      TF_RETURN_IF_ERROR(c->Subshape(query, 0, -1, &batch_and_rows));
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          batch_and_rows, c->Vector(c->Dim(value, -1)), &output));
+      c->set_output(0, output);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Internal scaled dot-product attention,
+Softmax(scale * query * key^T + bias) * value over the last two dimensions,
+with the same leading batch dimensions for query, key and value: reserved for
+internal use.
+
+The optional bias, such as a padding mask, has the rank of the scores and
+broadcasts along its dimensions of size 1. With causal, query i only attends
+to keys 0 to i.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("FusedBatchNormGrad")
     .Input("y_backprop: T")
     .Input("x: T")
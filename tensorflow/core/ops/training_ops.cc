@@ -1153,6 +1153,132 @@ static Status ApplyPowerSignShapeFn(InferenceContext* c) {
   return absl::OkStatus();
 }
 
+// Shape function of the fused ops which apply an optimizer to `N` variables.
+// The `num_variable_lists` lists of `N` resources (the variables and their
+// slots) come first, and the `N` gradients start at input `grad_idx`. All the
+// other inputs are scalars.
+static Status MultiApplyShapeFn(InferenceContext* c, int num_variable_lists,
+                                int grad_idx) {
+  int n;
+  TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+  for (int i = 0; i < n; ++i) {
+    ShapeHandle s = ShapeOrHandleShape</*is_resource=*/true>(c, i);
+    for (int list = 1; list < num_variable_lists; ++list) {
+      TF_RETURN_IF_ERROR(c->Merge(
+          s, ShapeOrHandleShape</*is_resource=*/true>(c, list * n + i), &s));
+    }
+    TF_RETURN_IF_ERROR(c->Merge(s, c->input(grad_idx + i), &s));
+  }
+  ShapeHandle unused;
+  for (int i = num_variable_lists * n; i < c->num_inputs(); ++i) {
+    if (i < grad_idx || i >= grad_idx + n) {
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// The _ResourceMultiApply* ops are ResourceApply* ops of `N` variables with
+// the same hyperparameters, into which the remapper groups them.
+REGISTER_OP("_ResourceMultiApplyAdam")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("T: {half, bfloat16, float, double}")
+    .Attr("N: int >= 1")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      return MultiApplyShapeFn(c, /*num_variable_lists=*/3,
+                               /*grad_idx=*/3 * n + 6);
+    })
+    .Doc(R"doc(
+Updates `N` variables according to the Adam algorithm, as ResourceApplyAdam.
+
+This is an internal op, which the remapper creates from ResourceApplyAdam ops.
+)doc");
+
+REGISTER_OP("_ResourceMultiApplyMomentum")
+    .Input("var: N * resource")
+    .Input("accum: N * resource")
+    .Input("lr: T")
+    .Input("grad: N * T")
+    .Input("momentum: T")
+    .Attr("T: {half, bfloat16, float, double}")
+    .Attr("N: int >= 1")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      return MultiApplyShapeFn(c, /*num_variable_lists=*/2,
+                               /*grad_idx=*/2 * n + 1);
+    })
+    .Doc(R"doc(
+Updates `N` variables according to the momentum scheme, as
+ResourceApplyMomentum.
+
+This is an internal op, which the remapper creates from ResourceApplyMomentum
+ops.
+)doc");
+
+REGISTER_OP("_ResourceMultiApplyKerasMomentum")
+    .Input("var: N * resource")
+    .Input("accum: N * resource")
+    .Input("lr: T")
+    .Input("grad: N * T")
+    .Input("momentum: T")
+    .Attr("T: {half, bfloat16, float, double}")
+    .Attr("N: int >= 1")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      return MultiApplyShapeFn(c, /*num_variable_lists=*/2,
+                               /*grad_idx=*/2 * n + 1);
+    })
+    .Doc(R"doc(
+Updates `N` variables according to the momentum scheme, as
+ResourceApplyKerasMomentum.
+
+This is an internal op, which the remapper creates from
+ResourceApplyKerasMomentum ops.
+)doc");
+
+REGISTER_OP("_ResourceMultiApplyAdagradV2")
+    .Input("var: N * resource")
+    .Input("accum: N * resource")
+    .Input("lr: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("T: {half, bfloat16, float, double}")
+    .Attr("N: int >= 1")
+    .Attr("use_locking: bool = false")
+    .Attr("update_slots: bool = true")
+    .SetShapeFn([](InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      return MultiApplyShapeFn(c, /*num_variable_lists=*/2,
+                               /*grad_idx=*/2 * n + 2);
+    })
+    .Doc(R"doc(
+Updates `N` variables according to the adagrad scheme, as
+ResourceApplyAdagradV2.
+
+This is an internal op, which the remapper creates from ResourceApplyAdagradV2
+ops.
+)doc");
+
 REGISTER_OP("ApplyPowerSign")
     .Input("var: Ref(T)")
     .Input("m: Ref(T)")
@@ -213,6 +213,17 @@ TEST(InterPlanetaryFileSystemTest, MatchOnlyNeeded) {
   EXPECT_EQ(Match(&ipfs, "abcd"), "abcd");
 }
 
+// Matches of the last pattern are not stat'ed, so evil_directory is only
+// listed.
+TEST(InterPlanetaryFileSystemTest, MatchDoesNotStatResults) {
+  InterPlanetaryFileSystem ipfs;
+  TF_EXPECT_OK(ipfs.CreateDir(ipfs.JoinPath(kPrefix, "abcd"), nullptr));
+  TF_EXPECT_OK(
+      ipfs.CreateDir(ipfs.JoinPath(kPrefix, "evil_directory"), nullptr));
+
+  EXPECT_EQ(Match(&ipfs, "[ae]*"), "abcd,evil_directory");
+}
+
 TEST(InterPlanetaryFileSystemTest, MatchDirectory) {
   InterPlanetaryFileSystem ipfs;
   TF_EXPECT_OK(ipfs.RecursivelyCreateDir(
@@ -273,6 +284,18 @@ TEST(InterPlanetaryFileSystemTest, HasAtomicMove) {
   EXPECT_EQ(has_atomic_move, true);
 }
 
+TEST(InterPlanetaryFileSystemTest, MatchUsesListingCache) {
+  InterPlanetaryFileSystem ipfs;
+  TF_EXPECT_OK(ipfs.CreateDir(ipfs.JoinPath(kPrefix, "Planet0"), nullptr));
+  setenv("TF_FILE_LISTING_CACHE_MAX_AGE", "3600", 1);
+  EXPECT_EQ(Match(&ipfs, "Planet?"), "Planet0");
+  // The new directory is not seen until the cached listing expires.
+  TF_EXPECT_OK(ipfs.CreateDir(ipfs.JoinPath(kPrefix, "Planet1"), nullptr));
+  EXPECT_EQ(Match(&ipfs, "Planet?"), "Planet0");
+  unsetenv("TF_FILE_LISTING_CACHE_MAX_AGE");
+  EXPECT_EQ(Match(&ipfs, "Planet?"), "Planet0,Planet1");
+}
+
 // A simple file system with a root directory and a single file underneath it.
 class TestFileSystem : public NullFileSystem {
  public:
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
+#include "tensorflow/core/tfrt/fallback/request_trace.h"
 #include "tensorflow/core/tfrt/graph_executor/config.h"
 #include "tensorflow/core/tfrt/utils/fallback_tensor.h"
 #include "tfrt/host_context/async_value_ref.h"  // from @tf_runtime
@@ -163,6 +164,14 @@ class KernelFallbackCompatRequestState {
     cost_recorder_ = cost_recorder;
   }
 
+  // Nullable.
+  tensorflow::tfrt_stub::RequestTrace* request_trace() const {
+    return request_trace_;
+  }
+  void set_request_trace(tensorflow::tfrt_stub::RequestTrace* request_trace) {
+    request_trace_ = request_trace;
+  }
+
   // Nullable.
   tfrt::ResourceContext* client_graph_resource_context() const {
     return client_graph_resource_context_;
@@ -220,6 +229,9 @@ class KernelFallbackCompatRequestState {
   // Records the cost per op.
   tensorflow::tfrt_stub::CostRecorder* cost_recorder_ = nullptr;
 
+  // Records the timeline of the ops if the request is sampled for tracing.
+  tensorflow::tfrt_stub::RequestTrace* request_trace_ = nullptr;
+
   tfrt::ResourceContext* client_graph_resource_context_ = nullptr;
 
   const tensorflow::tfrt_stub::RuntimeConfig* runtime_config_ = nullptr;
@@ -24,6 +24,7 @@ limitations under the License.
 #include <utility>
 
 #include "absl/base/casts.h"
+#include "absl/time/clock.h"
 #include "llvm/ADT/StringRef.h"
 #include "tensorflow/core/framework/logging.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -43,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/fallback/device_with_custom_allocator.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
+#include "tensorflow/core/tfrt/fallback/request_trace.h"
 #include "tensorflow/core/tfrt/utils/fallback_tensor.h"
 #include "tensorflow/core/tfrt/utils/tensor_util.h"
 #include "tensorflow/core/tfrt/utils/utils.h"
@@ -498,6 +500,13 @@ TF_ATTRIBUTE_ALWAYS_INLINE static void KernelFallbackExecuteOp(
     run_start_time = tfrt::GetCpuClockCycle();
     if (op_chain == nullptr) op_chain = &cost_chain;
   }
+  // Likewise for the timeline of the request, given a non-null trace.
+  auto* request_trace = fallback_request_state->request_trace();
+  int64_t trace_start_ns = 0;
+  if (request_trace != nullptr) {
+    trace_start_ns = absl::GetCurrentTimeNanos();
+    if (op_chain == nullptr) op_chain = &cost_chain;
+  }
 
   auto* runner_table = fallback_request_state->runner_table();
   DCHECK(runner_table);
@@ -526,6 +535,14 @@ TF_ATTRIBUTE_ALWAYS_INLINE static void KernelFallbackExecuteOp(
           cost_recorder->RecordCost(op_key, run_finish_time - run_start_time);
         });
   }
+  if (request_trace != nullptr) {
+    op_chain->AndThen([request_trace, trace_start_ns, kernel_runner, device] {
+      const auto* op_kernel = kernel_runner->op_kernel();
+      request_trace->RecordOp(op_kernel->name(), op_kernel->type_string(),
+                              device->name(), trace_start_ns,
+                              absl::GetCurrentTimeNanos() - trace_start_ns);
+    });
+  }
 }
 
 // The BEF kernel for creating tensorflow::OpKernel to be used in kernel
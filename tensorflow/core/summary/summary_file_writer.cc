@@ -14,7 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <algorithm>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -22,21 +27,30 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/summary.pb.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/summary/summary_converter.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/events_writer.h"
 
 namespace tensorflow {
 namespace {
 
+auto* dropped_summaries = monitoring::Counter<0>::New(
+    "/tensorflow/core/summary/dropped_summaries",
+    "Number of summaries dropped by asynchronous summary writers because "
+    "their background thread fell behind.");
+
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
-  SummaryFileWriter(int max_queue, int flush_millis, Env* env)
+  SummaryFileWriter(const SummaryFileWriterOptions& options, Env* env)
       : SummaryWriterInterface(),
         is_initialized_(false),
-        max_queue_(max_queue),
-        flush_millis_(flush_millis),
+        options_(options),
+        max_queue_(options.max_queue),
+        flush_millis_(options.flush_millis),
         env_(env) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
@@ -63,98 +77,114 @@ class SummaryFileWriter : public SummaryWriterInterface {
         "Could not initialize events writer.");
     last_flush_ = env_->NowMicros();
     is_initialized_ = true;
+    if (options_.async) {
+      thread_.reset(env_->StartThread(ThreadOptions(), "summary_file_writer",
+                                      [this]() { BackgroundThread(); }));
+    }
     return absl::OkStatus();
   }
 
   Status Flush() override {
+    Status async_status;
+    if (options_.async) {
+      mutex_lock l(pending_mu_);
+      while (!pending_.empty() || converting_) {
+        pending_cv_.wait(l);
+      }
+      std::swap(async_status, async_status_);
+    }
     mutex_lock ml(mu_);
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
+    TF_RETURN_IF_ERROR(async_status);
     return InternalFlush();
   }
 
   ~SummaryFileWriter() override {
     (void)Flush();  // Ignore errors.
+    if (thread_ != nullptr) {
+      {
+        mutex_lock l(pending_mu_);
+        shutdown_ = true;
+      }
+      pending_cv_.notify_all();
+      thread_.reset();
+    }
   }
 
   Status WriteTensor(int64_t global_step, Tensor t, const string& tag,
                      const string& serialized_metadata) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    Summary::Value* v = e->mutable_summary()->add_value();
-
-    if (t.dtype() == DT_STRING) {
-      // Treat DT_STRING specially, so that tensor_util.MakeNdarray in Python
-      // can convert the TensorProto to string-type numpy array. MakeNdarray
-      // does not work with strings encoded by AsProtoTensorContent() in
-      // tensor_content.
-      t.AsProtoField(v->mutable_tensor());
-    } else {
-      t.AsProtoTensorContent(v->mutable_tensor());
-    }
-    v->set_tag(tag);
-    if (!serialized_metadata.empty()) {
-      v->mutable_metadata()->ParseFromString(serialized_metadata);
-    }
-    return WriteEvent(std::move(e));
+    return WriteSummary(
+        global_step, [t = Snapshot(t), tag, serialized_metadata](Event* e) {
+          Summary::Value* v = e->mutable_summary()->add_value();
+
+          if (t.dtype() == DT_STRING) {
+            // Treat DT_STRING specially, so that tensor_util.MakeNdarray in
+            // Python can convert the TensorProto to string-type numpy array.
+            // MakeNdarray does not work with strings encoded by
+            // AsProtoTensorContent() in tensor_content.
+            t.AsProtoField(v->mutable_tensor());
+          } else {
+            t.AsProtoTensorContent(v->mutable_tensor());
+          }
+          v->set_tag(tag);
+          if (!serialized_metadata.empty()) {
+            v->mutable_metadata()->ParseFromString(serialized_metadata);
+          }
+          return absl::OkStatus();
+        });
   }
 
   Status WriteScalar(int64_t global_step, Tensor t,
                      const string& tag) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(
-        AddTensorAsScalarToSummary(t, tag, e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return WriteSummary(global_step, [t = Snapshot(t), tag](Event* e) {
+      return AddTensorAsScalarToSummary(t, tag, e->mutable_summary());
+    });
   }
 
   Status WriteHistogram(int64_t global_step, Tensor t,
                         const string& tag) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(
-        AddTensorAsHistogramToSummary(t, tag, e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return WriteSummary(global_step, [t = Snapshot(t), tag](Event* e) {
+      return AddTensorAsHistogramToSummary(t, tag, e->mutable_summary());
+    });
   }
 
   Status WriteImage(int64_t global_step, Tensor t, const string& tag,
                     int max_images, Tensor bad_color) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(AddTensorAsImageToSummary(t, tag, max_images, bad_color,
-                                                 e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return WriteSummary(global_step, [t = Snapshot(t), tag, max_images,
+                                      bad_color = Snapshot(bad_color)](
+                                         Event* e) {
+      return AddTensorAsImageToSummary(t, tag, max_images, bad_color,
+                                       e->mutable_summary());
+    });
   }
 
   Status WriteAudio(int64_t global_step, Tensor t, const string& tag,
                     int max_outputs, float sample_rate) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(AddTensorAsAudioToSummary(
-        t, tag, max_outputs, sample_rate, e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return WriteSummary(global_step, [t = Snapshot(t), tag, max_outputs,
+                                      sample_rate](Event* e) {
+      return AddTensorAsAudioToSummary(t, tag, max_outputs, sample_rate,
+                                       e->mutable_summary());
+    });
   }
 
   Status WriteGraph(int64_t global_step,
                     std::unique_ptr<GraphDef> graph) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    graph->SerializeToString(e->mutable_graph_def());
-    return WriteEvent(std::move(e));
+    std::shared_ptr<GraphDef> shared_graph(std::move(graph));
+    return WriteSummary(global_step, [shared_graph](Event* e) {
+      shared_graph->SerializeToString(e->mutable_graph_def());
+      return absl::OkStatus();
+    });
   }
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
+    if (options_.async) {
+      return Enqueue(std::move(event), nullptr);
+    }
     mutex_lock ml(mu_);
     queue_.emplace_back(std::move(event));
-    if (queue_.size() > max_queue_ ||
-        env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
+    if (ShouldFlush()) {
       return InternalFlush();
     }
     return absl::OkStatus();
@@ -163,10 +193,119 @@ class SummaryFileWriter : public SummaryWriterInterface {
   string DebugString() const override { return "SummaryFileWriter"; }
 
  private:
+  // Fills the summary of an event.
+  using ConvertFn = std::function<Status(Event*)>;
+
+  struct PendingEvent {
+    std::unique_ptr<Event> event;
+    ConvertFn convert;  // May be null.
+  };
+
   double GetWallTime() {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
+  // Returns a tensor the background thread can read after the summary op
+  // returned. The op's input may alias a variable that is updated in place by
+  // the following step.
+  Tensor Snapshot(const Tensor& t) const {
+    return options_.async ? tensor::DeepCopy(t) : t;
+  }
+
+  // Writes an event of `global_step` whose summary is filled by `convert`,
+  // on the background thread if the writer is asynchronous.
+  Status WriteSummary(int64_t global_step, ConvertFn convert) {
+    std::unique_ptr<Event> e{new Event};
+    e->set_step(global_step);
+    e->set_wall_time(GetWallTime());
+    if (options_.async) {
+      return Enqueue(std::move(e), std::move(convert));
+    }
+    TF_RETURN_IF_ERROR(convert(e.get()));
+    return WriteEvent(std::move(e));
+  }
+
+  // Hands an event to the background thread, waiting for room or dropping the
+  // event if max_pending events are pending. Returns the first error of the
+  // background thread since the last call.
+  Status Enqueue(std::unique_ptr<Event> event, ConvertFn convert) {
+    mutex_lock l(pending_mu_);
+    if (pending_.size() >= options_.max_pending) {
+      if (options_.drop_when_full) {
+        dropped_summaries->GetCell()->IncrementBy(1);
+        LOG_EVERY_N_SEC(WARNING, 60)
+            << "Dropping summaries, the summary writer can not keep up. "
+               "Increase TF_SUMMARY_WRITER_MAX_PENDING or write fewer "
+               "summaries.";
+      } else {
+        while (pending_.size() >= options_.max_pending) {
+          pending_cv_.wait(l);
+        }
+      }
+    }
+    if (pending_.size() < options_.max_pending) {
+      pending_.push_back({std::move(event), std::move(convert)});
+      pending_cv_.notify_all();
+    }
+    Status status;
+    std::swap(status, async_status_);
+    return status;
+  }
+
+  // Converts the pending events and writes them to the events file in
+  // batches, until the writer is destroyed.
+  void BackgroundThread() {
+    while (true) {
+      std::deque<PendingEvent> batch;
+      {
+        mutex_lock l(pending_mu_);
+        while (pending_.empty() && !shutdown_) {
+          pending_cv_.wait(l);
+        }
+        if (pending_.empty()) return;
+        batch.swap(pending_);
+        converting_ = true;
+      }
+      // Wakes up the writers waiting for room.
+      pending_cv_.notify_all();
+
+      Status status;
+      std::vector<std::unique_ptr<Event>> events;
+      events.reserve(batch.size());
+      for (PendingEvent& pending : batch) {
+        if (pending.convert != nullptr) {
+          Status convert_status = pending.convert(pending.event.get());
+          if (!convert_status.ok()) {
+            status.Update(convert_status);
+            continue;
+          }
+        }
+        events.push_back(std::move(pending.event));
+      }
+      {
+        mutex_lock ml(mu_);
+        for (std::unique_ptr<Event>& e : events) {
+          queue_.push_back(std::move(e));
+        }
+        if (ShouldFlush()) {
+          status.Update(InternalFlush());
+        }
+      }
+
+      {
+        mutex_lock l(pending_mu_);
+        async_status_.Update(status);
+        converting_ = false;
+      }
+      pending_cv_.notify_all();
+    }
+  }
+
+  bool ShouldFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return queue_.size() > max_queue_ ||
+           env_->NowMicros() - last_flush_ > 1000 * flush_millis_;
+  }
+
   Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     for (const std::unique_ptr<Event>& e : queue_) {
       events_writer_->WriteEvent(*e);
@@ -179,6 +318,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   bool is_initialized_;
+  const SummaryFileWriterOptions options_;
   const int max_queue_;
   const int flush_millis_;
   uint64 last_flush_;
@@ -189,15 +329,59 @@ class SummaryFileWriter : public SummaryWriterInterface {
   std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
+
+  // Events waiting for the background thread of asynchronous writers.
+  mutex pending_mu_;
+  condition_variable pending_cv_;
+  std::deque<PendingEvent> pending_ TF_GUARDED_BY(pending_mu_);
+  // Whether the background thread is converting and writing events.
+  bool converting_ TF_GUARDED_BY(pending_mu_) = false;
+  bool shutdown_ TF_GUARDED_BY(pending_mu_) = false;
+  Status async_status_ TF_GUARDED_BY(pending_mu_);
+  std::unique_ptr<Thread> thread_;
 };
 
 }  // namespace
 
+SummaryFileWriterOptions SummaryFileWriterOptions::FromEnv() {
+  SummaryFileWriterOptions options;
+  int64_t max_pending;
+  Status status = [&]() -> Status {
+    TF_RETURN_IF_ERROR(
+        ReadBoolFromEnvVar("TF_SUMMARY_WRITER_ASYNC", false, &options.async));
+    TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_SUMMARY_WRITER_MAX_PENDING",
+                                           options.max_pending, &max_pending));
+    return ReadBoolFromEnvVar("TF_SUMMARY_WRITER_DROP_WHEN_FULL", false,
+                              &options.drop_when_full);
+  }();
+  if (!status.ok()) {
+    LOG(ERROR) << "Asynchronous summary writers are disabled: " << status;
+    return SummaryFileWriterOptions();
+  }
+  options.max_pending = std::max<int64_t>(max_pending, 1);
+  return options;
+}
+
 Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& logdir,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result) {
-  SummaryFileWriter* w = new SummaryFileWriter(max_queue, flush_millis, env);
+  SummaryFileWriterOptions options;
+  options.max_queue = max_queue;
+  options.flush_millis = flush_millis;
+  return CreateSummaryFileWriter(options, logdir, filename_suffix, env,
+                                 result);
+}
+
+Status CreateSummaryFileWriter(const SummaryFileWriterOptions& options,
+                               const string& logdir,
+                               const string& filename_suffix, Env* env,
+                               SummaryWriterInterface** result) {
+  if (options.async && options.max_pending < 1) {
+    return errors::InvalidArgument("max_pending must be positive, got ",
+                                   options.max_pending);
+  }
+  SummaryFileWriter* w = new SummaryFileWriter(options, env);
   const Status s = w->Initialize(logdir, filename_suffix);
   if (!s.ok()) {
     w->Unref();
@@ -22,6 +22,31 @@ limitations under the License.
 
 namespace tensorflow {
 
+/// \brief Options of the summary writers created by CreateSummaryFileWriter.
+struct SummaryFileWriterOptions {
+  /// Number of summaries queued before the file is flushed.
+  int max_queue = 10;
+  /// Maximum time between two flushes of the file.
+  int flush_millis = 2 * 60 * 1000;
+
+  /// If true, the summary ops only take a copy of their tensor, and the
+  /// summaries are converted to events and written on a background thread.
+  /// Conversion and write errors are returned by the following write or
+  /// Flush call. Flush waits for the background thread.
+  bool async = false;
+  /// Maximum number of summaries waiting for the background thread.
+  int max_pending = 1000;
+  /// If true, summaries are dropped rather than waiting for the background
+  /// thread when max_pending summaries are waiting. The number of dropped
+  /// summaries is exported as /tensorflow/core/summary/dropped_summaries.
+  bool drop_when_full = false;
+
+  /// Reads the async options from the TF_SUMMARY_WRITER_ASYNC,
+  /// TF_SUMMARY_WRITER_MAX_PENDING and TF_SUMMARY_WRITER_DROP_WHEN_FULL
+  /// environment variables.
+  static SummaryFileWriterOptions FromEnv();
+};
+
 /// \brief Creates SummaryWriterInterface which writes to a file.
 ///
 /// The file is an append-only records file of tf.Event protos. That
@@ -38,6 +63,12 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result);
 
+/// \brief Same as above, with all options.
+Status CreateSummaryFileWriter(const SummaryFileWriterOptions& options,
+                               const string& logdir,
+                               const string& filename_suffix, Env* env,
+                               SummaryWriterInterface** result);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_SUMMARY_SUMMARY_FILE_WRITER_H_
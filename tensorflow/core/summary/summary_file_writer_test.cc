@@ -14,14 +14,18 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <limits>
+
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/event.pb.h"
@@ -29,6 +33,8 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+using ::tensorflow::monitoring::testing::CellReader;
+
 class FakeClockEnv : public EnvWrapper {
  public:
   FakeClockEnv() : EnvWrapper(Env::Default()), current_millis_(0) {}
@@ -87,6 +93,28 @@ class SummaryFileWriterTest : public ::testing::Test {
     return absl::OkStatus();
   }
 
+  // Returns the events written to the file of `test_name`, including the
+  // leading file version event.
+  std::vector<Event> ReadEvents(const string& test_name) {
+    std::vector<string> files;
+    TF_CHECK_OK(env_.GetChildren(testing::TmpDir(), &files));
+    std::vector<Event> events;
+    for (const string& f : files) {
+      if (!absl::StrContains(f, test_name)) continue;
+      std::unique_ptr<RandomAccessFile> read_file;
+      TF_CHECK_OK(env_.NewRandomAccessFile(io::JoinPath(testing::TmpDir(), f),
+                                           &read_file));
+      io::RecordReader reader(read_file.get(), io::RecordReaderOptions());
+      tstring record;
+      uint64 offset = 0;
+      while (reader.ReadRecord(&offset, &record).ok()) {
+        events.emplace_back();
+        events.back().ParseFromString(record);
+      }
+    }
+    return events;
+  }
+
   FakeClockEnv env_;
 };
 
@@ -281,5 +309,67 @@ TEST_F(SummaryFileWriterTest, AvoidFilenameCollision) {
       << "files = [" << absl::StrJoin(files, ", ") << "]";
 }
 
+TEST_F(SummaryFileWriterTest, AsyncWritesAllSummaries) {
+  SummaryFileWriterOptions options;
+  options.async = true;
+  options.max_pending = 4;
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateSummaryFileWriter(options, testing::TmpDir(),
+                                      "async_test", &env_, &writer));
+  Tensor t(DT_FLOAT, TensorShape({100}));
+  for (int i = 0; i < 100; ++i) {
+    t.flat<float>().setConstant(i);
+    TF_CHECK_OK(writer->WriteHistogram(i, t, "name"));
+  }
+  TF_CHECK_OK(writer->Flush());
+  writer->Unref();
+
+  std::vector<Event> events = ReadEvents("async_test");
+  ASSERT_EQ(events.size(), 101);
+  for (int i = 0; i < 100; ++i) {
+    const Event& e = events[i + 1];
+    EXPECT_EQ(e.step(), i);
+    ASSERT_EQ(e.summary().value_size(), 1);
+    // The histograms are of the tensor at the time of the write.
+    EXPECT_EQ(e.summary().value(0).histo().max(), i);
+  }
+}
+
+TEST_F(SummaryFileWriterTest, AsyncReportsErrorsLater) {
+  SummaryFileWriterOptions options;
+  options.async = true;
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateSummaryFileWriter(options, testing::TmpDir(),
+                                      "async_error_test", &env_, &writer));
+  core::ScopedUnref deleter(writer);
+  Tensor nan(DT_FLOAT, TensorShape({}));
+  nan.scalar<float>()() = std::numeric_limits<float>::quiet_NaN();
+  TF_EXPECT_OK(writer->WriteHistogram(1, nan, "name"));
+  EXPECT_TRUE(errors::IsInvalidArgument(writer->Flush()));
+  TF_EXPECT_OK(writer->Flush());
+}
+
+TEST_F(SummaryFileWriterTest, AsyncDropsSummariesWhenFull) {
+  CellReader<int64_t> dropped("/tensorflow/core/summary/dropped_summaries");
+  SummaryFileWriterOptions options;
+  options.async = true;
+  options.max_pending = 1;
+  options.drop_when_full = true;
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateSummaryFileWriter(options, testing::TmpDir(),
+                                      "async_drop_test", &env_, &writer));
+  Tensor one(DT_FLOAT, TensorShape({}));
+  one.scalar<float>()() = 1.0;
+  for (int i = 0; i < 1000; ++i) {
+    TF_CHECK_OK(writer->WriteScalar(i, one, "name"));
+  }
+  TF_CHECK_OK(writer->Flush());
+  writer->Unref();
+
+  const int64_t written = ReadEvents("async_drop_test").size() - 1;
+  EXPECT_GE(written, 1);
+  EXPECT_EQ(written + dropped.Delta(), 1000);
+}
+
 }  // namespace
 }  // namespace tensorflow
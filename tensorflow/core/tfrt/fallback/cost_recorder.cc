@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <limits>
 #include <string>
 
@@ -51,6 +54,36 @@ uint64_t CostRecorder::GetCost(int64_t op_key) const {
   return r;
 }
 
+double CostRecorder::GetDrift(const CostRecorder& reference) const {
+  absl::flat_hash_map<int64_t, uint64_t> costs;
+  {
+    tf_shared_lock l(op_cost_map_mutex_);
+    for (const auto& [op_key, op_cost] : op_cost_map_) {
+      costs[op_key] = std::max(static_cast<uint64_t>(1),
+                               static_cast<uint64_t>(op_cost.first /
+                                                     op_cost.second));
+    }
+  }
+
+  double reference_cost = 0;
+  double cost_difference = 0;
+  tf_shared_lock l(reference.op_cost_map_mutex_);
+  for (const auto& [op_key, cost] : costs) {
+    const auto iter = reference.op_cost_map_.find(op_key);
+    if (iter == reference.op_cost_map_.end()) {
+      return std::numeric_limits<double>::infinity();
+    }
+    const uint64_t op_reference_cost =
+        std::max(static_cast<uint64_t>(1),
+                 static_cast<uint64_t>(iter->second.first /
+                                       iter->second.second));
+    reference_cost += op_reference_cost;
+    cost_difference += std::abs(static_cast<double>(cost) -
+                                static_cast<double>(op_reference_cost));
+  }
+  return reference_cost == 0 ? 0 : cost_difference / reference_cost;
+}
+
 Status CostRecorder::WriteToFile() const {
   OpCostMapProto op_cost_map_proto;
   {
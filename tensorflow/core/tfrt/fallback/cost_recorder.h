@@ -42,6 +42,13 @@ class CostRecorder {
   // otherwise adding op costs would cause overflow.
   uint64_t GetCost(int64_t op_key) const;
 
+  // Returns how much the costs recorded here drifted from the ones of
+  // `reference`: the sum of the absolute differences of the normalized
+  // average execution durations of the ops recorded here, relative to the sum
+  // of their durations in `reference`. Returns infinity if `reference` has no
+  // record for one of these ops.
+  double GetDrift(const CostRecorder& reference) const;
+
   // Writes the op cost map (in format of `OpCostMapProto`) to a file specified
   // by the env var name `MesuredCostPathEnvVarName()`.
   // TODO(b/263837451): Fix the op_key unstableness during serialization.
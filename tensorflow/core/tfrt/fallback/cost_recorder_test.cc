@@ -56,6 +56,25 @@ TEST(CostRecorderTest, GetCostDefaultValueTest) {
             std::numeric_limits<uint32_t>::max());
 }
 
+TEST(CostRecorderTest, GetDriftTest) {
+  CostRecorder reference;
+  reference.RecordCost(kTestOpKey, 100);
+  reference.RecordCost(kTestOpKey + 1, 300);
+
+  CostRecorder recorder;
+  EXPECT_EQ(recorder.GetDrift(reference), 0);
+
+  recorder.RecordCost(kTestOpKey, 150);
+  EXPECT_DOUBLE_EQ(recorder.GetDrift(reference), 0.5);
+  recorder.RecordCost(kTestOpKey + 1, 250);
+  EXPECT_DOUBLE_EQ(recorder.GetDrift(reference), 100.0 / 400);
+
+  // The reference costs are unknown for new ops.
+  recorder.RecordCost(kTestOpKey + 2, 10);
+  EXPECT_EQ(recorder.GetDrift(reference),
+            std::numeric_limits<double>::infinity());
+}
+
 TEST(CostRecorderTest, WriteToFileTest) {
   CostRecorder recorder;
   ASSERT_EQ(recorder.size(), 0);
@@ -14,15 +14,32 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
 #include <utility>
 
 #include "absl/base/casts.h"
+#include "absl/hash/hash.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 namespace tfrt_stub {
+namespace {
+
+auto* op_kernel_runner_creation_time = monitoring::Sampler<1>::New(
+    {"/tensorflow/tfrt/fallback/kernel_creation_time",
+     "Tracks the time (in microseconds) to create fallback kernels on their "
+     "first use.",
+     "op_name"},
+    monitoring::Buckets::Exponential(10, 1.5, 33));
+
+}  // namespace
 
 absl::StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
     tfrt::Location loc, absl::string_view op_name,
@@ -32,21 +49,34 @@ absl::StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
     const tensorflow::ProcessFunctionLibraryRuntime&
         process_function_library_runtime) {
   OpLocationKey key(loc);
+  // Use the high bits of the hash for sharding, as the hash map of the shard
+  // uses the low bits.
+  Shard& shard =
+      shards_[(static_cast<uint64_t>(absl::HashOf(key)) >> 32) % kNumShards];
+
+  Entry* entry = nullptr;
   {
-    tf_shared_lock lock(mu_);
-    auto it = map_.find(key);
-    if (it != map_.end()) {
-      DCHECK_EQ(it->second->op_kernel()->def().op(), op_name);
-      return it->second.get();
+    tf_shared_lock lock(shard.mu);
+    auto it = shard.map.find(key);
+    if (it != shard.map.end()) entry = it->second.get();
+  }
+  if (entry != nullptr) {
+    if (auto* runner = entry->runner_ptr.load(std::memory_order_acquire)) {
+      DCHECK_EQ(runner->op_kernel()->def().op(), op_name);
+      return runner;
     }
+  } else {
+    mutex_lock lock(shard.mu);
+    auto& new_entry = shard.map[key];
+    if (new_entry == nullptr) new_entry = std::make_unique<Entry>();
+    entry = new_entry.get();
   }
 
-  mutex_lock lock(mu_);
+  mutex_lock lock(entry->mu);
 
-  auto it = map_.find(key);
-  if (it != map_.end()) {
-    DCHECK_EQ(it->second->op_kernel()->def().op(), op_name);
-    return it->second.get();
+  if (entry->runner != nullptr) {
+    DCHECK_EQ(entry->runner->op_kernel()->def().op(), op_name);
+    return entry->runner.get();
   }
 
   VLOG(1) << "KernelFallbackExecuteCompat creating op " << op_name
@@ -55,18 +85,18 @@ absl::StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
   std::string node_name = absl::StrCat(
       op_name, "_", loc.data, "_", absl::bit_cast<uintptr_t>(loc.GetHandler()));
 
+  const absl::Time start_time = absl::Now();
   TF_ASSIGN_OR_RETURN(
       auto runner, OpKernelRunner::Create(
                        op_name, node_name, device_name, num_args, attr_builder,
                        device_manager, process_function_library_runtime));
+  op_kernel_runner_creation_time->GetCell(std::string(op_name))
+      ->Add(absl::ToDoubleMicroseconds(absl::Now() - start_time));
 
-  auto runner_uptr = std::make_unique<OpKernelRunner>(std::move(runner));
-
-  auto* runner_ptr = runner_uptr.get();
-  auto r = map_.emplace(key, std::move(runner_uptr)).second;
-  DCHECK(r);
+  entry->runner = std::make_unique<OpKernelRunner>(std::move(runner));
+  entry->runner_ptr.store(entry->runner.get(), std::memory_order_release);
 
-  return runner_ptr;
+  return entry->runner.get();
 }
 
 }  // namespace tfrt_stub
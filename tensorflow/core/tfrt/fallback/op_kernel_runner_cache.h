@@ -15,10 +15,15 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 #define TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 
+#include <array>
+#include <atomic>
 #include <functional>
 #include <memory>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
 #include "tfrt/host_context/location.h"  // from @tf_runtime
 
@@ -47,6 +52,10 @@ class OpLocationKey {
 };
 
 // OpKernelRunnerCache is similar to OpKernelRunnerTable but thread-safe.
+//
+// The cache is sharded by location and kernels are created outside of the
+// shard locks, so that the first requests after loading, which create most of
+// the kernels, only contend if they create the same kernel.
 class OpKernelRunnerCache {
  public:
   OpKernelRunnerCache() = default;
@@ -60,9 +69,25 @@ class OpKernelRunnerCache {
           process_function_library_runtime);
 
  private:
-  mutable mutex mu_;
-  absl::flat_hash_map<OpLocationKey, std::unique_ptr<OpKernelRunner>> map_
-      TF_GUARDED_BY(mu_);
+  static constexpr int kNumShards = 16;
+
+  struct Entry {
+    // Held while creating the kernel, so that concurrent requests for the same
+    // kernel wait for a single creation.
+    mutex mu;
+    std::unique_ptr<OpKernelRunner> runner TF_GUARDED_BY(mu);
+    // The same as `runner` once it is created, for lookups without `mu`.
+    std::atomic<OpKernelRunner*> runner_ptr = nullptr;
+  };
+
+  struct Shard {
+    mutable mutex mu;
+    // For pointer stability of the entries, which are used outside of `mu`.
+    absl::flat_hash_map<OpLocationKey, std::unique_ptr<Entry>> map
+        TF_GUARDED_BY(mu);
+  };
+
+  std::array<Shard, kNumShards> shards_;
 };
 
 }  // namespace tfrt_stub
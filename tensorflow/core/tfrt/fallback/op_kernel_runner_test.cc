@@ -18,6 +18,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/device_factory.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -25,7 +26,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
@@ -126,6 +129,50 @@ TEST(OpKernelRunnerTest, OpKernelRunnerCache) {
   EXPECT_EQ(runner->op_kernel()->name(), "TestOp_100_0");
 }
 
+TEST(OpKernelRunnerTest, OpKernelRunnerCacheConcurrentCreation) {
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state,
+                          FallbackState::Create(session_options, fdef_lib));
+
+  OpKernelRunnerCache cache;
+
+  // Every location is requested by several threads at once, which must all get
+  // the same kernel.
+  constexpr int kNumLocations = 64;
+  constexpr int kNumRequestsPerLocation = 4;
+  std::vector<OpKernelRunner*> runners(kNumLocations * kNumRequestsPerLocation);
+  {
+    thread::ThreadPool thread_pool(Env::Default(), "test", /*num_threads=*/8);
+    for (int i = 0; i < runners.size(); ++i) {
+      thread_pool.Schedule([&, i]() {
+        tfrt::Location loc(/*handler=*/nullptr,
+                           /*data=*/i % kNumLocations);
+        runners[i] =
+            cache
+                .GetOrCreate(
+                    loc,
+                    /*op_name=*/"TestOp",
+                    /*device_name=*/
+                    "/job:localhost/replica:0/task:0/device:CPU:0",
+                    /*num_args=*/1,
+                    /*attr_builder=*/
+                    [](tensorflow::AttrValueMap*) { return absl::OkStatus(); },
+                    fallback_state->device_manager(),
+                    fallback_state->process_function_library_runtime())
+                .value();
+      });
+    }
+  }
+
+  for (int i = 0; i < runners.size(); ++i) {
+    ASSERT_TRUE(runners[i]);
+    EXPECT_EQ(runners[i], runners[i % kNumLocations]);
+    EXPECT_EQ(runners[i]->op_kernel()->name(),
+              absl::StrCat("TestOp_", i % kNumLocations, "_0"));
+  }
+}
+
 TEST(OpKernelRunnerTest, OpKernelRunState) {
   SessionOptions options;
   auto* device_count = options.config.mutable_device_count();
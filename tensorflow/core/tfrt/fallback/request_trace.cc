@@ -0,0 +1,145 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/tfrt/fallback/request_trace.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace tfrt_stub {
+namespace {
+
+void AppendJsonString(absl::string_view value, std::string* json) {
+  json->push_back('"');
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        json->append("\\\"");
+        break;
+      case '\\':
+        json->append("\\\\");
+        break;
+      case '\n':
+        json->append("\\n");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          absl::StrAppendFormat(json, "\\u%04x", static_cast<int>(c));
+        } else {
+          json->push_back(c);
+        }
+    }
+  }
+  json->push_back('"');
+}
+
+// Appends a complete event ("ph": "X") of the Chrome trace event format, whose
+// timestamps are in microseconds.
+void AppendCompleteEvent(absl::string_view name, absl::string_view category,
+                         int64_t pid, int64_t tid, int64_t start_ns,
+                         int64_t duration_ns, absl::string_view args_json,
+                         std::string* json) {
+  if (json->back() != '[') json->push_back(',');
+  json->append("{\"name\":");
+  AppendJsonString(name, json);
+  json->append(",\"cat\":");
+  AppendJsonString(category, json);
+  absl::StrAppendFormat(json,
+                        ",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,"
+                        "\"dur\":%.3f,\"args\":{%s}}",
+                        pid, tid, start_ns / 1000.0, duration_ns / 1000.0,
+                        args_json);
+}
+
+}  // namespace
+
+void RequestTrace::RecordOp(absl::string_view op_name,
+                            absl::string_view op_type,
+                            absl::string_view device, int64_t start_ns,
+                            int64_t duration_ns) {
+  OpTraceEvent event;
+  event.op_name = std::string(op_name);
+  event.op_type = std::string(op_type);
+  event.device = std::string(device);
+  event.start_ns = start_ns;
+  event.duration_ns = duration_ns;
+  event.thread_id = Env::Default()->GetCurrentThreadId();
+  mutex_lock l(mu_);
+  events_.push_back(std::move(event));
+}
+
+std::vector<OpTraceEvent> RequestTrace::events() const {
+  mutex_lock l(mu_);
+  return events_;
+}
+
+RequestTraceBuffer& RequestTraceBuffer::Global() {
+  static RequestTraceBuffer* const buffer = new RequestTraceBuffer();
+  return *buffer;
+}
+
+void RequestTraceBuffer::Add(std::shared_ptr<const RequestTrace> trace) {
+  mutex_lock l(mu_);
+  traces_.push_back(std::move(trace));
+  while (traces_.size() > static_cast<size_t>(capacity_)) {
+    traces_.pop_front();
+  }
+}
+
+std::vector<std::shared_ptr<const RequestTrace>> RequestTraceBuffer::GetTraces()
+    const {
+  mutex_lock l(mu_);
+  return {traces_.begin(), traces_.end()};
+}
+
+void RequestTraceBuffer::Clear() {
+  mutex_lock l(mu_);
+  traces_.clear();
+}
+
+std::string RequestTraceBuffer::ExportToChromeTraceJson() const {
+  std::string json = "{\"traceEvents\":[";
+  for (const auto& trace : GetTraces()) {
+    const int64_t pid = trace->request_id();
+    std::string args;
+    absl::StrAppend(&args, "\"model\":");
+    AppendJsonString(trace->model_name(), &args);
+    AppendCompleteEvent(trace->function_name(), "request", pid, /*tid=*/0,
+                        trace->start_ns(), trace->duration_ns(), args, &json);
+    for (const auto& event : trace->events()) {
+      args.clear();
+      absl::StrAppend(&args, "\"type\":");
+      AppendJsonString(event.op_type, &args);
+      absl::StrAppend(&args, ",\"device\":");
+      AppendJsonString(event.device, &args);
+      AppendCompleteEvent(event.op_name, "op", pid, event.thread_id,
+                          event.start_ns, event.duration_ns, args, &json);
+    }
+  }
+  json.append("]}");
+  return json;
+}
+
+}  // namespace tfrt_stub
+}  // namespace tensorflow
@@ -0,0 +1,119 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// This file defines the per-op timelines recorded for sampled requests.
+
+#ifndef TENSORFLOW_CORE_TFRT_FALLBACK_REQUEST_TRACE_H_
+#define TENSORFLOW_CORE_TFRT_FALLBACK_REQUEST_TRACE_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace tfrt_stub {
+
+// The execution of an op in a traced request.
+struct OpTraceEvent {
+  std::string op_name;
+  std::string op_type;
+  std::string device;
+  int64_t start_ns = 0;
+  int64_t duration_ns = 0;
+  int64_t thread_id = 0;
+};
+
+// Thread-safe.
+// The timeline of the ops executed by a request. Ops are recorded by the
+// kernels running them, which may run concurrently.
+class RequestTrace {
+ public:
+  RequestTrace(absl::string_view model_name, absl::string_view function_name,
+               int64_t start_ns)
+      : model_name_(model_name),
+        function_name_(function_name),
+        start_ns_(start_ns) {}
+
+  // Records an execution of the op `op_name` of type `op_type` on `device`,
+  // which started at `start_ns` and ran for `duration_ns` on the current
+  // thread.
+  void RecordOp(absl::string_view op_name, absl::string_view op_type,
+                absl::string_view device, int64_t start_ns,
+                int64_t duration_ns);
+
+  int64_t request_id() const { return request_id_; }
+  void set_request_id(int64_t request_id) { request_id_ = request_id; }
+
+  const std::string& model_name() const { return model_name_; }
+  const std::string& function_name() const { return function_name_; }
+  int64_t start_ns() const { return start_ns_; }
+
+  int64_t duration_ns() const { return duration_ns_; }
+  void set_duration_ns(int64_t duration_ns) { duration_ns_ = duration_ns; }
+
+  // Returns the ops recorded so far, in the order they completed.
+  std::vector<OpTraceEvent> events() const;
+
+ private:
+  int64_t request_id_ = 0;
+  const std::string model_name_;
+  const std::string function_name_;
+  const int64_t start_ns_;
+  int64_t duration_ns_ = 0;
+
+  mutable tensorflow::mutex mu_;
+  std::vector<OpTraceEvent> events_ TF_GUARDED_BY(mu_);
+};
+
+// Thread-safe.
+// Keeps the traces of the last `capacity` sampled requests, so that the
+// latency of slow requests can be attributed to ops after the fact.
+class RequestTraceBuffer {
+ public:
+  explicit RequestTraceBuffer(int capacity = 64) : capacity_(capacity) {}
+
+  // The buffer the graph executor adds the traces of sampled requests to.
+  static RequestTraceBuffer& Global();
+
+  // Adds `trace`, dropping the oldest trace if the buffer is full.
+  void Add(std::shared_ptr<const RequestTrace> trace);
+
+  // Returns the traces in the buffer, oldest first.
+  std::vector<std::shared_ptr<const RequestTrace>> GetTraces() const;
+
+  void Clear();
+
+  // Returns the traces in the buffer in the Chrome trace event format, which
+  // can be loaded in chrome://tracing or Perfetto. Every request gets its own
+  // process row, with a thread row for every thread that ran its ops.
+  std::string ExportToChromeTraceJson() const;
+
+ private:
+  const int capacity_;
+
+  mutable tensorflow::mutex mu_;
+  std::deque<std::shared_ptr<const RequestTrace>> traces_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tfrt_stub
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_TFRT_FALLBACK_REQUEST_TRACE_H_
@@ -0,0 +1,87 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/tfrt/fallback/request_trace.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace tensorflow {
+namespace tfrt_stub {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::HasSubstr;
+
+TEST(RequestTraceTest, RecordOp) {
+  RequestTrace trace("model", "signature", /*start_ns=*/100);
+  trace.RecordOp("matmul", "MatMul", "/device:CPU:0", /*start_ns=*/110,
+                 /*duration_ns=*/20);
+  trace.RecordOp("relu", "Relu", "/device:CPU:0", /*start_ns=*/130,
+                 /*duration_ns=*/5);
+
+  auto events = trace.events();
+  EXPECT_THAT(events, ElementsAre(Field(&OpTraceEvent::op_name, "matmul"),
+                                  Field(&OpTraceEvent::op_name, "relu")));
+  EXPECT_EQ(events[0].op_type, "MatMul");
+  EXPECT_EQ(events[0].device, "/device:CPU:0");
+  EXPECT_EQ(events[0].start_ns, 110);
+  EXPECT_EQ(events[0].duration_ns, 20);
+}
+
+TEST(RequestTraceBufferTest, KeepsLatestTraces) {
+  RequestTraceBuffer buffer(/*capacity=*/2);
+  for (int i = 0; i < 3; ++i) {
+    auto trace = std::make_shared<RequestTrace>("model", "signature",
+                                                /*start_ns=*/0);
+    trace->set_request_id(i);
+    buffer.Add(std::move(trace));
+  }
+
+  auto traces = buffer.GetTraces();
+  ASSERT_EQ(traces.size(), 2);
+  EXPECT_EQ(traces[0]->request_id(), 1);
+  EXPECT_EQ(traces[1]->request_id(), 2);
+
+  buffer.Clear();
+  EXPECT_TRUE(buffer.GetTraces().empty());
+}
+
+TEST(RequestTraceBufferTest, ExportToChromeTraceJson) {
+  RequestTraceBuffer buffer;
+  auto trace = std::make_shared<RequestTrace>("model", "sig\"nature",
+                                              /*start_ns=*/1000);
+  trace->set_request_id(7);
+  trace->RecordOp("matmul", "MatMul", "/device:CPU:0", /*start_ns=*/2000,
+                  /*duration_ns=*/3000);
+  trace->set_duration_ns(5000);
+  buffer.Add(trace);
+
+  std::string json = buffer.ExportToChromeTraceJson();
+  EXPECT_THAT(json, HasSubstr("\"name\":\"sig\\\"nature\",\"cat\":\"request\","
+                              "\"ph\":\"X\",\"pid\":7,\"tid\":0,\"ts\":1.000,"
+                              "\"dur\":5.000,\"args\":{\"model\":\"model\"}"));
+  EXPECT_THAT(json, HasSubstr("\"name\":\"matmul\",\"cat\":\"op\""));
+  EXPECT_THAT(json, HasSubstr("\"ts\":2.000,\"dur\":3.000,\"args\":{\"type\":"
+                              "\"MatMul\",\"device\":\"/device:CPU:0\"}"));
+}
+
+}  // namespace
+}  // namespace tfrt_stub
+}  // namespace tensorflow
@@ -96,10 +96,26 @@ struct GraphExecutionOptions {
     // Number of times to record costs before resetting Op cost estimates.
     // However, a reset always occurs after the first execution.
     int updates_per_interval = 1;
+
+    // With kPeriodic, the executable is only recompiled upon a reset if the
+    // op costs recorded since the previous reset drifted by at least this
+    // fraction from the ones it was compiled with (see
+    // CostRecorder::GetDrift). Zero recompiles upon every reset.
+    double recompilation_cost_drift = 0;
+
+    // With kPeriodic, recompiles on a background thread instead of in the
+    // execution which triggers the reset. Executions keep using the current
+    // executable until the recompiled one is swapped in.
+    bool recompile_in_background = false;
   };
 
   CostAnalysisOptions cost_analysis_options;
 
+  // If positive, one in every `request_trace_sampling_period` requests records
+  // the timeline of the ops it runs, which is kept in
+  // `RequestTraceBuffer::Global()`.
+  int request_trace_sampling_period = 0;
+
   // If true, the MLRT interpreter will be used instead of the BEF executor.
   // This option is experimental.
   bool enable_mlrt = false;
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -77,6 +78,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
+#include "tensorflow/core/tfrt/fallback/request_trace.h"
 #include "tensorflow/core/tfrt/graph_executor/executable_context.h"
 #include "tensorflow/core/tfrt/graph_executor/export_mlir.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
@@ -232,7 +234,7 @@ absl::StatusOr<std::unique_ptr<RequestInfo>> CreateRequestInfo(
     tensorflow::tfrt_stub::FallbackState& fallback_state,
     const tensorflow::ProcessFunctionLibraryRuntime&
         process_function_library_runtime,
-    CostRecorder* cost_recorder) {
+    CostRecorder* cost_recorder, RequestTrace* request_trace) {
   auto request_info = std::make_unique<RequestInfo>();
 
   DCHECK(options.runtime);
@@ -280,6 +282,7 @@ absl::StatusOr<std::unique_ptr<RequestInfo>> CreateRequestInfo(
               &process_function_library_runtime);
 
   fallback_request_state.set_cost_recorder(cost_recorder);
+  fallback_request_state.set_request_trace(request_trace);
   fallback_request_state.set_client_graph_resource_context(
       client_graph_resource_context);
   fallback_request_state.set_runtime_config(&options.runtime_config);
@@ -318,14 +321,37 @@ tensorflow::Status GraphExecutionRunOnFunction(
     tfrt::RequestDeadlineTracker* req_deadline_tracker,
     std::optional<StreamCallbackId> stream_callback_id,
     CostRecorder* cost_recorder) {
+  // Sample the request for recording the timeline of its ops, given a positive
+  // sampling period.
+  std::shared_ptr<RequestTrace> request_trace;
+  if (options.request_trace_sampling_period > 0) {
+    static std::atomic<int64_t> num_requests{0};
+    if (num_requests.fetch_add(1, std::memory_order_relaxed) %
+            options.request_trace_sampling_period ==
+        0) {
+      request_trace = std::make_shared<RequestTrace>(
+          options.model_metadata.name(), signature_name,
+          absl::GetCurrentTimeNanos());
+    }
+  }
+
   TF_ASSIGN_OR_RETURN(
       auto request_info,
       CreateRequestInfo(options, run_options, run_options.work_queue,
                         resource_context, client_graph_resource_context,
                         runner_table, resource_array, fallback_state,
-                        process_function_library_runtime, cost_recorder));
+                        process_function_library_runtime, cost_recorder,
+                        request_trace.get()));
 
   int64_t request_id = request_info->tfrt_request_context->id();
+  // Publish the trace once the request finished, whether it succeeded or not.
+  auto add_request_trace = tensorflow::gtl::MakeCleanup([&request_trace] {
+    if (request_trace == nullptr) return;
+    request_trace->set_duration_ns(absl::GetCurrentTimeNanos() -
+                                   request_trace->start_ns());
+    RequestTraceBuffer::Global().Add(std::move(request_trace));
+  });
+  if (request_trace != nullptr) request_trace->set_request_id(request_id);
   // The top level traceme root for this request. The thread pool used later
   // will add TraceMeProducer and TraceMeConsumer to connect async tasks.
   tsl::profiler::TraceMe traceme(
@@ -654,10 +680,7 @@ tensorflow::Status GraphExecutor::Run(
       cost_recorder));
 
   if (do_recompilation) {
-    TF_RETURN_IF_ERROR(
-        loaded_client_graph.UpdateCost(*cost_recorder, runtime()));
-    tensorflow::mutex_lock l(num_recompilations_mu_);
-    num_recompilations_ += 1;
+    TF_RETURN_IF_ERROR(loaded_client_graph.MaybeRecompile(runtime()));
   }
   if (cost_recorder != nullptr) {
     loaded_client_graph.UpdateCostAnalysisData(now, do_recompilation);
@@ -1110,6 +1133,67 @@ Status GraphExecutor::LoadedClientGraph::UpdateCost(
   return absl::OkStatus();
 }
 
+Status GraphExecutor::LoadedClientGraph::MaybeRecompile(
+    const Runtime& runtime) {
+  const auto& options = graph_executor_->options().cost_analysis_options;
+  const bool is_periodic =
+      options.version == Options::CostAnalysisOptions::kPeriodic;
+  std::shared_ptr<CostRecorder> cost_recorder;
+  {
+    tensorflow::mutex_lock lock(cost_analysis_data_.mu);
+    cost_recorder = cost_analysis_data_.cost_recorder;
+    if (is_periodic && cost_analysis_data_.compiled_cost_recorder != nullptr) {
+      const double drift = cost_recorder->GetDrift(
+          *cost_analysis_data_.compiled_cost_recorder);
+      if (drift < options.recompilation_cost_drift) {
+        VLOG(1) << "TFRT skips recompiling loaded client graph (" << this
+                << ") " << name_ << " as its op costs only drifted by "
+                << drift;
+        return absl::OkStatus();
+      }
+    }
+    if (is_periodic && options.recompile_in_background) {
+      // Costs keep being recorded while a recompilation is running, and are
+      // used by the next one.
+      if (cost_analysis_data_.is_recompiling) return absl::OkStatus();
+      cost_analysis_data_.is_recompiling = true;
+    }
+  }
+
+  auto recompile = [this, cost_recorder, &runtime]() {
+    Status status = UpdateCost(*cost_recorder, runtime);
+    if (status.ok()) {
+      tensorflow::mutex_lock l(graph_executor_->num_recompilations_mu_);
+      graph_executor_->num_recompilations_ += 1;
+    }
+    tensorflow::mutex_lock lock(cost_analysis_data_.mu);
+    if (status.ok()) {
+      cost_analysis_data_.compiled_cost_recorder = cost_recorder;
+    }
+    cost_analysis_data_.is_recompiling = false;
+    cost_analysis_data_.recompilation_done.notify_all();
+    return status;
+  };
+  if (!is_periodic || !options.recompile_in_background) {
+    return recompile();
+  }
+  graph_executor_->fallback_state().session_options().env->SchedClosure(
+      [this, recompile = std::move(recompile)]() {
+        Status status = recompile();
+        LOG_IF(ERROR, !status.ok())
+            << "TFRT failed to recompile loaded client graph (" << this << ") "
+            << name_ << " in the background: " << status;
+      });
+  return absl::OkStatus();
+}
+
+GraphExecutor::LoadedClientGraph::~LoadedClientGraph() {
+  tensorflow::mutex_lock lock(cost_analysis_data_.mu);
+  while (cost_analysis_data_.is_recompiling) {
+    cost_analysis_data_.recompilation_done.wait(lock);
+  }
+}
+
 GraphExecutor::LoadedClientGraph::LoadedClientGraph(
     std::string name, SymbolUids symbol_uids, GraphExecutor* graph_executor,
     std::unique_ptr<mlir::MLIRContext> mlir_context,
@@ -1150,7 +1234,7 @@ GraphExecutor::LoadedClientGraph::LoadedClientGraph(
     cost_analysis_data_.start_time = absl::Now() - options.reset_interval;
     cost_analysis_data_.is_available = true;
     cost_analysis_data_.num_cost_updates = options.updates_per_interval - 1;
-    cost_analysis_data_.cost_recorder = std::make_unique<CostRecorder>();
+    cost_analysis_data_.cost_recorder = std::make_shared<CostRecorder>();
     if (executable_context_->IsForMlrt()) {
       cost_analysis_data_.tf_mlir_with_op_keys =
           std::move(tf_mlir_with_op_keys);
@@ -1177,7 +1261,7 @@ void GraphExecutor::LoadedClientGraph::UpdateCostAnalysisData(
     cost_analysis_data_.cost_recorder = nullptr;
   } else {
     // Update cost analysis data.
-    cost_analysis_data_.cost_recorder = std::make_unique<CostRecorder>();
+    cost_analysis_data_.cost_recorder = std::make_shared<CostRecorder>();
     cost_analysis_data_.is_available = true;
     cost_analysis_data_.start_time = now;
     cost_analysis_data_.num_cost_updates = 0;
@@ -47,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
+#include "tensorflow/core/tfrt/fallback/request_trace.h"
 #include "tensorflow/core/tfrt/graph_executor/executable_context.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
 #include "tensorflow/core/tfrt/graph_executor/sync_resource_state.h"
@@ -105,7 +106,8 @@ absl::StatusOr<std::unique_ptr<RequestInfo>> CreateRequestInfo(
     OpKernelRunnerTable* runner_table,
     tfd::FallbackResourceArray* resource_array, FallbackState& fallback_state,
     const ProcessFunctionLibraryRuntime& process_function_library_runtime,
-    CostRecorder* cost_recorder = nullptr);
+    CostRecorder* cost_recorder = nullptr,
+    RequestTrace* request_trace = nullptr);
 
 // Runs on a function given input/output and other info.
 // Note: `resource_context` is per-graph-executor and
@@ -160,6 +162,8 @@ class GraphExecutor {
                       std::optional<StreamCallbackId> stream_callback_id,
                       bool is_restore, FunctionLibraryDefinition flib_def,
                       tsl::monitoring::SamplerCell* latency_sampler);
+    // Waits for a recompilation in the background, if any.
+    ~LoadedClientGraph();
 
     // Returns this instance's CostRecorder if it is time to update costs,
     // else returns nullptr. Only allows one non-null return value at a time
@@ -170,6 +174,10 @@ class GraphExecutor {
     // `cost_recorder`.
     Status UpdateCost(const CostRecorder& cost_recorder,
                       const Runtime& runtime);
+    // Recompiles with the costs recorded since the last reset, unless they
+    // didn't drift enough from the ones of the current executable, either
+    // right away or in the background, as per `CostAnalysisOptions`.
+    Status MaybeRecompile(const Runtime& runtime);
     // Updates `cost_analysis_data_` to make it accurate for the next execution.
     // Assumes a cost update occurred this cycle.
     void UpdateCostAnalysisData(absl::Time now, bool do_recompilation);
@@ -211,7 +219,14 @@ class GraphExecutor {
       // Ensures only one GraphExecutor thread updates costs at a time.
       bool is_available TF_GUARDED_BY(mu) = false;
       // Maintains the book-keeping of op costs.
-      std::unique_ptr<CostRecorder> cost_recorder;
+      std::shared_ptr<CostRecorder> cost_recorder;
+      // The costs which the current executable was compiled with, if any.
+      std::shared_ptr<const CostRecorder> compiled_cost_recorder
+          TF_GUARDED_BY(mu);
+      // Whether a recompilation is running in the background, and notified
+      // once it is done.
+      bool is_recompiling TF_GUARDED_BY(mu) = false;
+      tensorflow::condition_variable recompilation_done;
       // For recompilation in MLRT, TFRT respectively.
       mlir::OwningOpRef<mlir::ModuleOp> tf_mlir_with_op_keys;
       mlir::OwningOpRef<mlir::ModuleOp> tfrt_mlir;
@@ -23,6 +23,7 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_shared_loaded_variable_cache.h"
 #include "tsl/platform/statusor.h"
 
 namespace tensorflow {
@@ -52,5 +53,11 @@ IfrtLoadedVariableRegistry::GetLoadedVariable(const Key& key) const {
   return it->second;
 }
 
+void IfrtLoadedVariableRegistry::RetainSharedLoadedVariable(
+    IfrtSharedLoadedVariableCache::Handle handle) {
+  absl::MutexLock lock(&mutex_);
+  shared_loaded_variables_.push_back(std::move(handle));
+}
+
 }  // namespace ifrt_serving
 }  // namespace tensorflow
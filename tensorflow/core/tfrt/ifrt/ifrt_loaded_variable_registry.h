@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_TFRT_IFRT_IFRT_LOADED_VARIABLE_REGISTRY_H_
 
 #include <string>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
@@ -28,6 +29,7 @@ limitations under the License.
 #include "xla/python/ifrt/array.h"
 #include "xla/python/ifrt/future.h"
 #include "xla/tsl/concurrency/ref_count.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_shared_loaded_variable_cache.h"
 
 namespace tensorflow {
 namespace ifrt_serving {
@@ -72,10 +74,17 @@ class IfrtLoadedVariableRegistry {
   absl::StatusOr<LoadedVariable> GetLoadedVariable(const Key& key) const
       ABSL_LOCKS_EXCLUDED(mutex_);
 
+  // Keeps a loaded variable shared with other models for the lifetime of this
+  // registry.
+  void RetainSharedLoadedVariable(IfrtSharedLoadedVariableCache::Handle handle)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
  private:
   mutable absl::Mutex mutex_;
   absl::flat_hash_map<Key, LoadedVariable> loaded_variable_map_
       ABSL_GUARDED_BY(mutex_);
+  std::vector<IfrtSharedLoadedVariableCache::Handle> shared_loaded_variables_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace ifrt_serving
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_utils.h"
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -38,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_restore_tensor_registry.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_shared_loaded_variable_cache.h"
 #include "tensorflow/core/tfrt/ifrt/sharding_utils.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/statusor.h"
@@ -63,6 +65,40 @@ absl::StatusOr<tsl::RCReference<xla::ifrt::Array>> LoadIfrtVariable(
       thread_pool);
 }
 
+// Loads `variable`, or reuses the array of another model which loaded the same
+// contents with the same sharding to the same devices.
+void LoadOrShareIfrtVariable(
+    std::shared_ptr<xla::ifrt::Client> ifrt_client,
+    const tsl::thread::ThreadPool& thread_pool,
+    const tensorflow::Tensor& variable,
+    const VariableDeviceShardingConfigProto& sharding_config,
+    IfrtLoadedVariableRegistry& ifrt_loaded_variable_registry,
+    xla::ifrt::Promise<tsl::RCReference<xla::ifrt::Array>>
+        loaded_variable_promise) {
+  absl::StatusOr<IfrtSharedLoadedVariableCache::Key> key =
+      IfrtSharedLoadedVariableCache::MakeKey(*ifrt_client, variable,
+                                             sharding_config);
+  if (!key.ok()) {
+    VLOG(1) << "Not sharing loaded variable: " << key.status();
+    loaded_variable_promise.Set(
+        LoadIfrtVariable(ifrt_client, thread_pool, variable, sharding_config));
+    return;
+  }
+  std::optional<IfrtSharedLoadedVariableCache::ArrayPromise> shared_promise;
+  IfrtSharedLoadedVariableCache::Handle handle =
+      IfrtSharedLoadedVariableCache::Global().GetOrCreate(*key,
+                                                          &shared_promise);
+  if (shared_promise.has_value()) {
+    shared_promise->Set(
+        LoadIfrtVariable(ifrt_client, thread_pool, variable, sharding_config));
+  }
+  handle->OnReady(
+      [loaded_variable_promise = std::move(loaded_variable_promise)](
+          const absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>&
+              array) mutable { loaded_variable_promise.Set(array); });
+  ifrt_loaded_variable_registry.RetainSharedLoadedVariable(std::move(handle));
+}
+
 }  // namespace
 
 absl::StatusOr<ifrt_serving::DtypeAndShape> GetDtypeAndShape(
@@ -132,6 +168,7 @@ absl::Status AsyncLoadRestoredTensorAsIfrtLoadedVariable(
       }));
   restored_tensor_future.OnReady(
       [ifrt_client = std::move(ifrt_client), &thread_pool = thread_pool,
+       &ifrt_loaded_variable_registry = ifrt_loaded_variable_registry,
        checkpoint_loader_queue = checkpoint_loader_queue,
        sharding_config = sharding_config,
        loaded_variable_promise = std::move(loaded_variable_promise)](
@@ -144,15 +181,15 @@ absl::Status AsyncLoadRestoredTensorAsIfrtLoadedVariable(
         // Transfer tensor to array in a separate thread.
         checkpoint_loader_queue->AddTask(
             [ifrt_client = ifrt_client, &thread_pool = thread_pool,
+             &ifrt_loaded_variable_registry = ifrt_loaded_variable_registry,
              sharding_config = std::move(sharding_config),
              restored_tensor = std::move(*restored_tensor),
              loaded_variable_promise =
                  std::move(loaded_variable_promise)]() mutable {
-              absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>
-                  variable_array =
-                      LoadIfrtVariable(ifrt_client, thread_pool,
-                                       restored_tensor, sharding_config);
-              loaded_variable_promise.Set(std::move(variable_array));
+              LoadOrShareIfrtVariable(ifrt_client, thread_pool,
+                                      restored_tensor, sharding_config,
+                                      ifrt_loaded_variable_registry,
+                                      std::move(loaded_variable_promise));
             });
       });
   return absl::OkStatus();
@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/tfrt/ifrt/ifrt_shared_loaded_variable_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/python/ifrt/client.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_config.pb.h"
+#include "tsl/lib/strings/proto_serialization.h"
+#include "tsl/platform/fingerprint.h"
+
+namespace tensorflow {
+namespace ifrt_serving {
+
+IfrtSharedLoadedVariableCache& IfrtSharedLoadedVariableCache::Global() {
+  static auto* const cache = new IfrtSharedLoadedVariableCache();
+  return *cache;
+}
+
+absl::StatusOr<IfrtSharedLoadedVariableCache::Key>
+IfrtSharedLoadedVariableCache::MakeKey(
+    const xla::ifrt::Client& client, const tensorflow::Tensor& variable,
+    const VariableDeviceShardingConfigProto& sharding_config) {
+  if (!DataTypeCanUseMemcpy(variable.dtype())) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Variables of type ", DataTypeString(variable.dtype()),
+                     " can not be shared."));
+  }
+  std::string serialized_sharding_config;
+  if (!tsl::SerializeToStringDeterministic(sharding_config,
+                                           &serialized_sharding_config)) {
+    return absl::InternalError("Failed to serialize the sharding config.");
+  }
+  const tsl::Fprint128 metadata_fingerprint = tsl::Fingerprint128(
+      absl::StrCat(DataTypeString(variable.dtype()), ";",
+                   variable.shape().DebugString(), ";",
+                   serialized_sharding_config));
+  return Key{
+      .client = &client,
+      .fingerprint = tsl::FingerprintCat128(
+          tsl::Fingerprint128(variable.tensor_data()), metadata_fingerprint),
+  };
+}
+
+IfrtSharedLoadedVariableCache::Handle
+IfrtSharedLoadedVariableCache::GetOrCreate(
+    const Key& key, std::optional<ArrayPromise>* promise) {
+  // Destroyed after the mutex is released, as destroying the last handle to a
+  // loaded variable acquires it.
+  Handle existing;
+  absl::MutexLock lock(&mutex_);
+  std::weak_ptr<const ArrayFuture>& shared = arrays_[key];
+  existing = shared.lock();
+  if (existing != nullptr) {
+    ArrayFuture array = *existing;
+    if (!array.IsReady() || array.Await().ok()) {
+      VLOG(1) << "Sharing a loaded variable with another model.";
+      promise->reset();
+      return existing;
+    }
+  }
+  *promise = ArrayFuture::CreatePromise();
+  Handle handle(new ArrayFuture(**promise),
+                [this, key](const ArrayFuture* array) {
+                  delete array;
+                  Release(key);
+                });
+  shared = handle;
+  return handle;
+}
+
+int64_t IfrtSharedLoadedVariableCache::size() const {
+  absl::MutexLock lock(&mutex_);
+  return arrays_.size();
+}
+
+void IfrtSharedLoadedVariableCache::Release(const Key& key) {
+  absl::MutexLock lock(&mutex_);
+  auto it = arrays_.find(key);
+  // The key may have been taken over by a new loaded variable meanwhile.
+  if (it != arrays_.end() && it->second.expired()) {
+    arrays_.erase(it);
+  }
+}
+
+}  // namespace ifrt_serving
+}  // namespace tensorflow
@@ -0,0 +1,97 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_TFRT_IFRT_IFRT_SHARED_LOADED_VARIABLE_CACHE_H_
+#define TENSORFLOW_CORE_TFRT_IFRT_IFRT_SHARED_LOADED_VARIABLE_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/python/ifrt/array.h"
+#include "xla/python/ifrt/client.h"
+#include "xla/python/ifrt/future.h"
+#include "xla/tsl/concurrency/ref_count.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_config.pb.h"
+#include "tsl/platform/fingerprint.h"
+
+namespace tensorflow {
+namespace ifrt_serving {
+
+// Shares the loaded variables with identical contents and shardings between
+// all the models served by the same IFRT client, e.g. between the versions of
+// a model during a rollover, so that unchanged weights are only loaded to the
+// devices once. A loaded variable is shared as long as any model holds on to
+// a handle to it.
+//
+// This class is thread safe.
+class IfrtSharedLoadedVariableCache {
+ public:
+  // The key is the fingerprint of the variable's contents, dtype, shape and
+  // sharding config, per IFRT client.
+  struct Key {
+    const xla::ifrt::Client* client = nullptr;
+    tsl::Fprint128 fingerprint = {0, 0};
+
+    template <typename H>
+    friend H AbslHashValue(H h, const Key& key) {
+      return H::combine(std::move(h), key.client, key.fingerprint.low64,
+                        key.fingerprint.high64);
+    }
+
+    friend bool operator==(const Key& x, const Key& y) {
+      return x.client == y.client && x.fingerprint == y.fingerprint;
+    }
+  };
+
+  using ArrayFuture = xla::ifrt::Future<tsl::RCReference<xla::ifrt::Array>>;
+  using ArrayPromise = xla::ifrt::Promise<tsl::RCReference<xla::ifrt::Array>>;
+  using Handle = std::shared_ptr<const ArrayFuture>;
+
+  // Returns the cache shared by all the models of the process.
+  static IfrtSharedLoadedVariableCache& Global();
+
+  static absl::StatusOr<Key> MakeKey(
+      const xla::ifrt::Client& client, const tensorflow::Tensor& variable,
+      const VariableDeviceShardingConfigProto& sharding_config);
+
+  // Returns a handle to the loaded variable shared for `key`. If there is none
+  // yet, or loading the shared one failed, a new one is created and
+  // `promise` is set, which the caller must fulfil with the loaded array.
+  Handle GetOrCreate(const Key& key, std::optional<ArrayPromise>* promise)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of loaded variables which are currently shared.
+  int64_t size() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  // Forgets `key` once the last handle to its loaded variable is destroyed.
+  void Release(const Key& key) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<Key, std::weak_ptr<const ArrayFuture>> arrays_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace ifrt_serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_TFRT_IFRT_IFRT_SHARED_LOADED_VARIABLE_CACHE_H_
@@ -0,0 +1,135 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/tfrt/ifrt/ifrt_shared_loaded_variable_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "xla/python/ifrt/client.h"
+#include "xla/python/ifrt/test_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_config.pb.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace ifrt_serving {
+namespace {
+
+using tsl::testing::StatusIs;
+
+VariableDeviceShardingConfigProto MakeShardingConfig(int device_id) {
+  VariableDeviceShardingConfigProto sharding_config;
+  sharding_config.add_device_ids(device_id);
+  return sharding_config;
+}
+
+TEST(IfrtSharedLoadedVariableCacheTest, KeyDependsOnContentsAndSharding) {
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+  auto variable = test::AsTensor<int32_t>({1, 2, 3, 4}, TensorShape({2, 2}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto key, IfrtSharedLoadedVariableCache::MakeKey(*client, variable,
+                                                       MakeShardingConfig(0)));
+
+  // Equal contents loaded by another model.
+  auto same_variable =
+      test::AsTensor<int32_t>({1, 2, 3, 4}, TensorShape({2, 2}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto same_key, IfrtSharedLoadedVariableCache::MakeKey(
+                         *client, same_variable, MakeShardingConfig(0)));
+  EXPECT_EQ(key, same_key);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto other_device_key, IfrtSharedLoadedVariableCache::MakeKey(
+                                 *client, variable, MakeShardingConfig(1)));
+  EXPECT_FALSE(key == other_device_key);
+  auto reshaped_variable =
+      test::AsTensor<int32_t>({1, 2, 3, 4}, TensorShape({4}));
+  TF_ASSERT_OK_AND_ASSIGN(auto reshaped_key,
+                          IfrtSharedLoadedVariableCache::MakeKey(
+                              *client, reshaped_variable,
+                              MakeShardingConfig(0)));
+  EXPECT_FALSE(key == reshaped_key);
+  auto other_variable =
+      test::AsTensor<int32_t>({1, 2, 3, 5}, TensorShape({2, 2}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto other_key, IfrtSharedLoadedVariableCache::MakeKey(
+                          *client, other_variable, MakeShardingConfig(0)));
+  EXPECT_FALSE(key == other_key);
+}
+
+TEST(IfrtSharedLoadedVariableCacheTest, StringVariablesAreNotShared) {
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+  auto variable = test::AsTensor<tstring>({"a", "b"}, TensorShape({2}));
+  EXPECT_THAT(IfrtSharedLoadedVariableCache::MakeKey(*client, variable,
+                                                     MakeShardingConfig(0)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(IfrtSharedLoadedVariableCacheTest, SharesUntilLastHandleIsDestroyed) {
+  IfrtSharedLoadedVariableCache cache;
+  const IfrtSharedLoadedVariableCache::Key key{.fingerprint = {1, 2}};
+
+  std::optional<IfrtSharedLoadedVariableCache::ArrayPromise> promise;
+  auto handle = cache.GetOrCreate(key, &promise);
+  ASSERT_TRUE(promise.has_value());
+  EXPECT_EQ(cache.size(), 1);
+
+  // Another model gets the same loaded variable, while it is still loading.
+  std::optional<IfrtSharedLoadedVariableCache::ArrayPromise> other_promise;
+  auto other_handle = cache.GetOrCreate(key, &other_promise);
+  EXPECT_FALSE(other_promise.has_value());
+  EXPECT_EQ(handle, other_handle);
+
+  handle.reset();
+  EXPECT_EQ(cache.size(), 1);
+  other_handle.reset();
+  EXPECT_EQ(cache.size(), 0);
+
+  cache.GetOrCreate(key, &promise);
+  EXPECT_TRUE(promise.has_value());
+}
+
+TEST(IfrtSharedLoadedVariableCacheTest, FailedLoadIsNotShared) {
+  IfrtSharedLoadedVariableCache cache;
+  const IfrtSharedLoadedVariableCache::Key key{.fingerprint = {1, 2}};
+
+  std::optional<IfrtSharedLoadedVariableCache::ArrayPromise> promise;
+  auto handle = cache.GetOrCreate(key, &promise);
+  ASSERT_TRUE(promise.has_value());
+  promise->Set(absl::InternalError("Failed to load"));
+
+  std::optional<IfrtSharedLoadedVariableCache::ArrayPromise> other_promise;
+  auto other_handle = cache.GetOrCreate(key, &other_promise);
+  EXPECT_TRUE(other_promise.has_value());
+  EXPECT_NE(handle, other_handle);
+
+  // Destroying the failed handle keeps the new one shared.
+  handle.reset();
+  EXPECT_EQ(cache.size(), 1);
+}
+
+}  // namespace
+}  // namespace ifrt_serving
+}  // namespace tensorflow
@@ -3198,5 +3198,154 @@ void BM_SequentialAddAttributes(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_SequentialAddAttributes);
 
+// Returns an executable whose "main" function runs `num_kernels` kernels that
+// do nothing, to measure the dispatch cost of a kernel.
+bc::Buffer CreateEmptyKernelsExecutable(int num_kernels) {
+  bc::Buffer buffer;
+  bc::Allocator allocator(&buffer);
+
+  auto executable_ctor = bc::New<bc::Executable>(&allocator);
+
+  testing::SymbolTable kernels;
+  std::vector<std::string> names = {"noop", "return"};
+  executable_ctor.construct_kernel_names(2).Assign(names);
+  kernels.Def(names);
+
+  auto functions_ctor = executable_ctor.construct_functions(1);
+  auto function_ctor = functions_ctor.ConstructAt(0);
+
+  testing::SymbolTable regs;
+
+  function_ctor.construct_name("main");
+  function_ctor.construct_input_regs(1).Assign({regs.Def("r0")});
+  function_ctor.construct_output_last_uses(1).Assign({true});
+
+  auto kernels_ctor = function_ctor.construct_kernels(num_kernels + 1);
+  for (int i = 0; i < num_kernels; ++i) {
+    kernels_ctor.ConstructAt(i).set_code(kernels.Use("noop"));
+  }
+
+  auto kernel_ctor = kernels_ctor.ConstructAt(num_kernels);
+  kernel_ctor.set_code(kernels.Use("return"));
+  kernel_ctor.construct_arguments(1).Assign({regs.Use("r0")});
+
+  function_ctor.construct_output_regs(1).Assign({regs.Use("r0")});
+  function_ctor.set_num_regs(regs.size());
+
+  return buffer;
+}
+
+// Returns an executable whose "main" function calls a function that returns
+// its argument `num_calls` times in a chain, to measure the overhead of a
+// function call.
+bc::Buffer CreateSequentialCallExecutable(int num_calls) {
+  bc::Buffer buffer;
+  bc::Allocator allocator(&buffer);
+
+  auto executable_ctor = bc::New<bc::Executable>(&allocator);
+
+  testing::AttributeTable attributes(executable_ctor.construct_attributes(1));
+  attributes.Add("callee", 1);
+
+  testing::SymbolTable kernels;
+  std::vector<std::string> names = {"call", "return"};
+  executable_ctor.construct_kernel_names(2).Assign(names);
+  kernels.Def(names);
+
+  auto functions_ctor = executable_ctor.construct_functions(2);
+
+  {
+    testing::SymbolTable regs;
+
+    auto main_ctor = functions_ctor.ConstructAt(0);
+    main_ctor.construct_name("main");
+    main_ctor.construct_input_regs(1).Assign({regs.Def("r0")});
+    main_ctor.construct_output_last_uses(1).Assign({true});
+
+    auto kernels_ctor = main_ctor.construct_kernels(num_calls + 1);
+    for (int i = 0; i < num_calls; ++i) {
+      auto kernel_ctor = kernels_ctor.ConstructAt(i);
+      kernel_ctor.set_code(kernels.Use("call"));
+      kernel_ctor.construct_arguments(1).Assign(
+          {regs.Use(absl::StrCat("r", i % 2))});
+      kernel_ctor.construct_last_uses(1).Assign({true});
+      kernel_ctor.construct_results(1).Assign(
+          {regs.Def(absl::StrCat("r", (i + 1) % 2))});
+      kernel_ctor.construct_attributes(1).Assign(
+          {attributes.GetHandle("callee")});
+    }
+
+    auto kernel_ctor = kernels_ctor.ConstructAt(num_calls);
+    kernel_ctor.set_code(kernels.Use("return"));
+    kernel_ctor.construct_arguments(1).Assign(
+        {regs.Use(absl::StrCat("r", num_calls % 2))});
+
+    main_ctor.construct_output_regs(1).Assign(
+        {regs.Use(absl::StrCat("r", num_calls % 2))});
+    main_ctor.set_num_regs(regs.size());
+  }
+
+  {
+    testing::SymbolTable regs;
+
+    auto callee_ctor = functions_ctor.ConstructAt(1);
+    callee_ctor.construct_name("callee");
+    callee_ctor.construct_input_regs(1).Assign({regs.Def("arg")});
+    callee_ctor.construct_output_last_uses(1).Assign({true});
+
+    auto kernels_ctor = callee_ctor.construct_kernels(1);
+    auto kernel_ctor = kernels_ctor.ConstructAt(0);
+    kernel_ctor.set_code(kernels.Use("return"));
+    kernel_ctor.construct_arguments(1).Assign({regs.Use("arg")});
+
+    callee_ctor.construct_output_regs(1).Assign({regs.Use("arg")});
+    callee_ctor.set_num_regs(regs.size());
+  }
+
+  return buffer;
+}
+
+// Runs the "main" function of `buffer` once per iteration, with the kernels
+// processed per iteration reported as items.
+void RunMainBenchmark(::testing::benchmark::State& state,
+                      const bc::Buffer& buffer, int kernels_per_iteration) {
+  bc::Executable executable(buffer.data());
+
+  KernelRegistry kernel_registry;
+  RegisterBuiltinKernels(kernel_registry);
+  kernel_registry.Register("noop", [](KernelFrame frame) {});
+
+  LoadedExecutable loaded_executable(executable, kernel_registry);
+
+  auto function = loaded_executable.GetFunction("main");
+  CHECK(function);
+
+  Value arg(1);
+  Value result;
+  std::vector<uint8_t> last_uses = {false};
+  for (auto s : state) {
+    ExecutionContext execution_context(&loaded_executable);
+    execution_context.Call(function, last_uses, absl::Span<Value>(&arg, 1),
+                           absl::Span<Value>(&result, 1));
+    Execute(execution_context);
+  }
+  CHECK_EQ(result.Get<int>(), 1);
+  state.SetItemsProcessed(state.iterations() * kernels_per_iteration);
+}
+
+void BM_EmptyKernels(::testing::benchmark::State& state) {
+  const int num_kernels = state.range(0);
+  RunMainBenchmark(state, CreateEmptyKernelsExecutable(num_kernels),
+                   num_kernels + 1);
+}
+BENCHMARK(BM_EmptyKernels)->Arg(1)->Arg(16)->Arg(256);
+
+void BM_SequentialCall(::testing::benchmark::State& state) {
+  const int num_calls = state.range(0);
+  RunMainBenchmark(state, CreateSequentialCallExecutable(num_calls),
+                   2 * num_calls + 1);
+}
+BENCHMARK(BM_SequentialCall)->Arg(1)->Arg(16)->Arg(256);
+
 }  // namespace
 }  // namespace mlrt
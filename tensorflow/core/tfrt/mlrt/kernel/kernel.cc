@@ -28,10 +28,12 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
 #include "absl/types/span.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/tfrt/fallback/request_trace.h"
 #include "tensorflow/core/tfrt/mlrt/bytecode/function.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/async_handle.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/attribute_span.h"
@@ -729,6 +731,10 @@ void ExecuteOpInternal(Frame& frame) {
   auto* cost_recorder = fallback_request_state.cost_recorder();
   uint64_t run_start_time = 0;
   if (cost_recorder != nullptr) run_start_time = tfrt::GetCpuClockCycle();
+  // Likewise for the timeline of the request, given a non-null trace.
+  auto* request_trace = fallback_request_state.request_trace();
+  int64_t trace_start_ns = 0;
+  if (request_trace != nullptr) trace_start_ns = absl::GetCurrentTimeNanos();
 
   auto* kernel_runner =
       fallback_request_state.runner_table()->GetUnsafe(op_key);
@@ -746,6 +752,12 @@ void ExecuteOpInternal(Frame& frame) {
     const uint64_t run_finish_time = tfrt::GetCpuClockCycle();
     cost_recorder->RecordCost(op_key, run_finish_time - run_start_time);
   }
+  if (request_trace != nullptr) {
+    const auto* op_kernel = kernel_runner->op_kernel();
+    request_trace->RecordOp(op_kernel->name(), op_kernel->type_string(),
+                            kernel_runner->device()->name(), trace_start_ns,
+                            absl::GetCurrentTimeNanos() - trace_start_ns);
+  }
 }
 
 struct ExecuteOp : mlrt::KernelFrame {
@@ -15,12 +15,14 @@ limitations under the License.
 #include "tensorflow/core/tfrt/saved_model/saved_model.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <iterator>
 #include <memory>
 #include <optional>
+#include <sstream>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -32,15 +34,21 @@ limitations under the License.
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "mlir/Dialect/Func/Extensions/AllExtensions.h"  // from @llvm-project
 #include "mlir/IR/DialectRegistry.h"  // from @llvm-project
 #include "mlir/IR/MLIRContext.h"  // from @llvm-project
 #include "mlir/IR/OwningOpRef.h"  // from @llvm-project
+#include "tensorflow/cc/saved_model/fingerprinting.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/mlir/tensorflow/translate/import_model.h"
 #include "tensorflow/compiler/mlir/tensorflow/translate/mlir_roundtrip_flags.h"
@@ -64,6 +72,7 @@ limitations under the License.
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_compat_request_state.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
@@ -81,6 +90,8 @@ limitations under the License.
 #include "tensorflow/core/tfrt/stubs/model_config_stub.h"
 #include "tensorflow/core/tfrt/utils/utils.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
+#include "tsl/platform/path.h"
 #include "tsl/platform/statusor.h"
 #include "tfrt/bef/bef_buffer.h"  // from @tf_runtime
 #include "tfrt/bef_executor/bef_file.h"  // from @tf_runtime
@@ -119,6 +130,12 @@ auto* saved_model_init_time_seconds =
         "/tensorflow/tfrt/saved_model/init_time",
         "Record the initialization time for the savedmodel.", "model_name");
 
+auto* saved_model_load_phase_time_ms =
+    tensorflow::monitoring::Gauge<int64_t, 2>::New(
+        "/tensorflow/tfrt/saved_model/load_phase_time_ms",
+        "Record the time of each phase of loading the savedmodel in ms.",
+        "model_name", "phase");
+
 // TODO(b/279197040) clean up this retention after input spec validation is
 // enabled everywhere.
 auto* saved_model_input_spec_validation_failure =
@@ -354,6 +371,45 @@ bool AotPackageExists(absl::string_view saved_model_dir) {
          env->FileExists(aot_bef_path).ok();
 }
 
+// Returns the signatures in the profile at `path` that are in `signatures`,
+// most invoked first. Each line of the profile is a signature name and its
+// invocation count, separated by a tab. Errors are logged and result in the
+// affected lines, or the whole profile, being ignored.
+std::vector<std::string> ReadSignatureProfile(const std::string& path,
+                                              const SignatureMap& signatures) {
+  std::string contents;
+  if (Env::Default()->FileExists(path).ok()) {
+    absl::Status status = ReadFileToString(Env::Default(), path, &contents);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to read the signature profile " << path << ": "
+                   << status;
+      return {};
+    }
+  }
+
+  std::vector<std::pair<int64_t, std::string>> counts;
+  for (absl::string_view line : absl::StrSplit(contents, '\n')) {
+    if (line.empty()) continue;
+    const std::vector<absl::string_view> fields = absl::StrSplit(line, '\t');
+    int64_t count = 0;
+    if (fields.size() != 2 || !absl::SimpleAtoi(fields[1], &count)) {
+      LOG(WARNING) << "Ignoring malformed line in the signature profile "
+                   << path << ": " << line;
+      continue;
+    }
+    if (!signatures.contains(fields[0])) continue;
+    counts.push_back({count, std::string(fields[0])});
+  }
+  std::stable_sort(
+      counts.begin(), counts.end(),
+      [](const auto& a, const auto& b) { return a.first > b.first; });
+
+  std::vector<std::string> names;
+  names.reserve(counts.size());
+  for (auto& [count, name] : counts) names.push_back(std::move(name));
+  return names;
+}
+
 }  // namespace
 
 SavedModel::~SavedModel() = default;  // Out-of-line C++ key function.
@@ -421,6 +477,65 @@ void GetDefaultInputValue(
   GetDefaultInputsFromModelConfig(context, signatures);
 }
 
+// Returns whether the MLRT bytecode of the model can be cached in
+// `options.compilation_cache_dir`.
+bool UseCompilationCache(const SavedModel::Options& options) {
+  const auto& compile_options = options.graph_execution_options.compile_options;
+  return !options.compilation_cache_dir.empty() &&
+         options.graph_execution_options.enable_mlrt &&
+         !options.aot_generation &&
+         compile_options.backend_compiler == nullptr &&
+         compile_options.device_target != TfrtDeviceInfraTarget::kGpu;
+}
+
+// Returns the path of the MLRT bytecode of the SavedModel in `saved_model_dir`
+// in the compilation cache. Besides the fingerprint of the SavedModel, the key
+// covers the options which affect the compilation, the devices and the TF
+// build, so that the bytecode is never reused for a different compilation.
+absl::StatusOr<std::string> GetCompilationCachePath(
+    const SavedModel::Options& options, absl::string_view saved_model_dir,
+    const FallbackState& fallback_state) {
+  auto fingerprint =
+      saved_model::fingerprinting::ReadSavedModelFingerprint(saved_model_dir);
+  if (!fingerprint.ok()) {
+    // Older SavedModels have no fingerprint file.
+    fingerprint =
+        saved_model::fingerprinting::CreateFingerprintDef(saved_model_dir);
+  }
+  TF_RETURN_IF_ERROR(fingerprint.status());
+
+  std::ostringstream key;
+  key << saved_model::fingerprinting::Singleprint(*fingerprint) << ";"
+      << options.graph_execution_options.compile_options
+      << ";saved_model_dir = " << saved_model_dir
+      << ";enable_lazy_loading = " << options.enable_lazy_loading
+      << ";run_placer_grappler_on_functions = "
+      << options.graph_execution_options.run_placer_grappler_on_functions
+      << ";enable_grappler_function_optimizer = "
+      << options.graph_execution_options.enable_grappler_function_optimizer
+      << ";" << TF_VERSION_STRING << ";" << tf_git_version();
+  for (const auto* device : fallback_state.device_manager().ListDevices()) {
+    key << ";" << device->name();
+  }
+  return tsl::io::JoinPath(
+      options.compilation_cache_dir,
+      absl::StrFormat("%016x.mlrt", tsl::Fingerprint64(key.str())));
+}
+
+// Writes `bytecode` to `path` through a temporary file, so that concurrent
+// loads never read a partially written entry.
+absl::Status WriteCompilationCache(const mlrt::bc::Buffer& bytecode,
+                                   const std::string& path) {
+  TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(
+      std::string(tsl::io::Dirname(path))));
+  const std::string tmp_path =
+      absl::StrCat(path, ".tmp.", Env::Default()->NowMicros());
+  TF_RETURN_IF_ERROR(WriteStringToFile(
+      Env::Default(), tmp_path,
+      absl::string_view(bytecode.data(), bytecode.size())));
+  return Env::Default()->RenameFile(tmp_path, path);
+}
+
 void UpdateCompileOptions(SavedModel::Options& options) {
   // Disable DecomposeResourceOpsPass for now, as DecomposeResourceGather does
   // not work well with GPU (b/232819415).
@@ -483,7 +598,31 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
   RegisterMlirDialect(
       registry,
       options.graph_execution_options.compile_options.backend_compiler);
-  mlir::MLIRContext context(registry);
+  // The pass managers run function passes on the functions of the module in
+  // parallel on the thread pool of the context. Use a dedicated one if
+  // requested, so that the number of threads used by loading is bounded.
+  std::unique_ptr<llvm::DefaultThreadPool> compile_thread_pool;
+  mlir::MLIRContext context(registry,
+                            options.num_compile_threads > 0
+                                ? mlir::MLIRContext::Threading::DISABLED
+                                : mlir::MLIRContext::Threading::ENABLED);
+  if (options.num_compile_threads > 0) {
+    llvm::ThreadPoolStrategy strategy;
+    strategy.ThreadsRequested = options.num_compile_threads;
+    compile_thread_pool = std::make_unique<llvm::DefaultThreadPool>(strategy);
+    context.setThreadPool(*compile_thread_pool);
+  }
+
+  const std::string saved_model_dir_string = std::string(saved_model_dir);
+  auto record_phase_time = [&saved_model_dir_string](
+                               absl::string_view phase, absl::Time start_time) {
+    const auto duration = absl::Now() - start_time;
+    saved_model_load_phase_time_ms
+        ->GetCell(saved_model_dir_string, std::string(phase))
+        ->Set(absl::ToInt64Milliseconds(duration));
+    VLOG(1) << "TFRT savedmodel loading phase " << phase << " took "
+            << absl::ToInt64Milliseconds(duration) << " ms.";
+  };
 
   // Step 1: Import saved model from a proto to an MLIR module.
   const auto import_start_time = absl::Now();
@@ -506,6 +645,7 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
   const auto& fdef_lib = meta_graph_def.graph_def().library();
 
   std::unique_ptr<FallbackState> fallback_state;
+  const auto fallback_state_start_time = absl::Now();
   if (options.graph_execution_options.compile_options.device_target ==
       TfrtDeviceInfraTarget::kCpu) {
     ASSIGN_OR_RETURN_IN_IMPORT(
@@ -515,8 +655,21 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
     ASSIGN_OR_RETURN_IN_IMPORT(
         fallback_state, FallbackState::Create(session_options, fdef_lib));
   }
+  record_phase_time("fallback_state", fallback_state_start_time);
+
+  std::string compilation_cache_path;
+  if (!aot_exist && UseCompilationCache(options)) {
+    auto path =
+        GetCompilationCachePath(options, saved_model_dir, *fallback_state);
+    if (path.ok()) {
+      compilation_cache_path = *std::move(path);
+    } else {
+      LOG(WARNING) << "Not using the compilation cache: " << path.status();
+    }
+  }
 
   mlir::OwningOpRef<mlir::ModuleOp> mlir_module;
+  const auto graph_import_start_time = absl::Now();
   if (aot_exist) {
     LOG(INFO) << "Found AOT package. Load and deserialize MLIR module.";
 
@@ -531,11 +684,11 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
             /*import_user_signatures=*/!options.enable_lazy_loading,
             options.graph_execution_options.run_placer_grappler_on_functions));
   }
+  record_phase_time("graph_import", graph_import_start_time);
   // TODO(b/278143179): Upload module w/o control flow.
   SymbolUids symbol_uids;
   symbol_uids.tf_symbol_uid = MaybeUploadMlirToXsymbol(mlir_module.get());
 
-  const std::string saved_model_dir_string = std::string(saved_model_dir);
   const auto import_duration = absl::Now() - import_start_time;
   saved_model_import_time_seconds->GetCell(saved_model_dir_string)
       ->Set(absl::ToInt64Seconds(import_duration));
@@ -573,6 +726,7 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
                                     resource_context.get());
 
   {
+    const auto runtime_resources_start_time = absl::Now();
     CallableOptions callable_options =
         CombineSignatureDefs(meta_graph_def.signature_def());
     model_context.set_graph_def(&meta_graph_def.graph_def());
@@ -586,6 +740,7 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
     // since meta_graph_def will be moved.
     model_context.set_graph_def(nullptr);
     model_context.set_callable_options(nullptr);
+    record_phase_time("runtime_resources", runtime_resources_start_time);
   }
 
   GetDefaultInputValue(meta_graph_def.signature_def(), model_context,
@@ -593,6 +748,7 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
 
   mlrt::bc::Buffer bytecode;
   tfrt::BefBuffer bef;
+  const auto lowering_start_time = absl::Now();
   if (aot_exist) {
     LOG(INFO) << "Found AoT package. Load and deserialize BEF.";
     if (options.graph_execution_options.enable_mlrt) {
@@ -619,10 +775,34 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
     tensorflow::tf_mlrt::RegisterTfMlrtBatchKernels(*kernel_registry);
 
     if (options.graph_execution_options.enable_mlrt) {
-      ASSIGN_OR_RETURN_IN_COMPILE(
-          bytecode, tensorflow::mlrt_compiler::ConvertTfMlirToBytecode(
-                        options.graph_execution_options.compile_options,
-                        *fallback_state, mlir_module.get(), model_context));
+      if (!compilation_cache_path.empty() &&
+          Env::Default()->FileExists(compilation_cache_path).ok()) {
+        auto cached_bytecode =
+            DeserializeMlrtBytecodeBuffer(compilation_cache_path);
+        if (cached_bytecode.ok() && !cached_bytecode->empty()) {
+          LOG(INFO) << "Found the compiled model in the compilation cache: "
+                    << compilation_cache_path;
+          bytecode = *std::move(cached_bytecode);
+        } else {
+          LOG(WARNING) << "Failed to read the compilation cache entry "
+                       << compilation_cache_path << ": "
+                       << cached_bytecode.status();
+        }
+      }
+      if (bytecode.empty()) {
+        ASSIGN_OR_RETURN_IN_COMPILE(
+            bytecode, tensorflow::mlrt_compiler::ConvertTfMlirToBytecode(
+                          options.graph_execution_options.compile_options,
+                          *fallback_state, mlir_module.get(), model_context));
+        if (!compilation_cache_path.empty()) {
+          if (auto status =
+                  WriteCompilationCache(bytecode, compilation_cache_path);
+              !status.ok()) {
+            LOG(WARNING) << "Failed to write the compilation cache entry "
+                         << compilation_cache_path << ": " << status;
+          }
+        }
+      }
     } else {
       RETURN_IF_ERROR_IN_COMPILE(tensorflow::ConvertTfMlirToBef(
           options.graph_execution_options.compile_options, mlir_module.get(),
@@ -635,6 +815,9 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
     }
   }
 
+  record_phase_time("lowering", lowering_start_time);
+
+  const auto graph_executor_start_time = absl::Now();
   ASSIGN_OR_RETURN_WITH_STAGE_INFO(
       "graph_executor creation", auto graph_executor,
       GraphExecutor::Create(options.graph_execution_options,
@@ -642,6 +825,7 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
                             std::move(resource_context),
                             std::move(*meta_graph_def.mutable_graph_def()),
                             std::move(kernel_registry)));
+  record_phase_time("graph_executor_creation", graph_executor_start_time);
 
   symbol_uids.tfrt_symbol_uid = MaybeUploadMlirToXsymbol(mlir_module.get());
   const auto compile_duration = absl::Now() - compile_start_time;
@@ -682,6 +866,7 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
         aot_exist || options.aot_generation));
   }
 
+  record_phase_time("init", init_start_time);
   const auto init_duration = absl::Now() - init_start_time;
   saved_model_init_time_seconds->GetCell(saved_model_dir_string)
       ->Set(absl::ToInt64Seconds(init_duration));
@@ -733,9 +918,92 @@ SavedModelImpl::SavedModelImpl(
   if (!options_.enable_lazy_loading) {
     bytecode_ = std::move(bytecode);
     loaded_executable_ = std::move(loaded_executable);
+    return;
+  }
+  if (options_.lazy_loading_use_graph_executor) return;
+
+  std::vector<std::string> prefetch_names;
+  const std::string& profile_path =
+      options_.lazy_loading_signature_profile_path;
+  if (!profile_path.empty()) {
+    for (const auto& [name, signature] : signatures_) {
+      signature_call_counts_.try_emplace(name, 0);
+    }
+    prefetch_names = ReadSignatureProfile(profile_path, signatures_);
+  }
+  if (options_.lazy_loading_prefetch_all_signatures) {
+    absl::flat_hash_set<std::string> profiled(prefetch_names.begin(),
+                                              prefetch_names.end());
+    for (const auto& [name, signature] : signatures_) {
+      if (!profiled.contains(name)) prefetch_names.push_back(name);
+    }
+  }
+  if (prefetch_names.empty()) return;
+
+  // Signatures are loaded in the background one at a time, so an invocation
+  // of a signature that isn't loaded yet waits for at most one other loading.
+  prefetch_thread_.reset(Env::Default()->StartThread(
+      tensorflow::ThreadOptions(), "tfrt_signature_prefetch",
+      [this, prefetch_names = std::move(prefetch_names)]() {
+        PrefetchSignatures(prefetch_names);
+      }));
+}
+
+SavedModelImpl::~SavedModelImpl() {
+  prefetch_cancelled_.store(true, std::memory_order_relaxed);
+  prefetch_thread_.reset();
+
+  if (!options_.lazy_loading_signature_profile_path.empty()) {
+    absl::Status status = WriteSignatureProfile();
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to write the signature profile "
+                   << options_.lazy_loading_signature_profile_path << ": "
+                   << status;
+    }
   }
 }
 
+void SavedModelImpl::PrefetchSignatures(
+    const std::vector<std::string>& names) {
+  LOG(INFO) << "TFRT prefetching " << names.size() << " signatures.";
+  RunOptions run_options;
+  for (const auto& name : names) {
+    if (prefetch_cancelled_.load(std::memory_order_relaxed)) return;
+    auto loading_result = GetOrCreateLoadingResult(run_options, {name});
+    if (!loading_result.ok()) {
+      LOG(WARNING) << "Failed to prefetch signature " << name << ": "
+                   << loading_result.status();
+    }
+  }
+}
+
+absl::Status SavedModelImpl::WriteSignatureProfile() const {
+  std::vector<std::pair<int64_t, absl::string_view>> counts;
+  int64_t total_count = 0;
+  for (const auto& [name, count] : signature_call_counts_) {
+    const int64_t value = count.load(std::memory_order_relaxed);
+    if (value == 0) continue;
+    counts.push_back({value, name});
+    total_count += value;
+  }
+  // Keep the profile of a previous process if this one wasn't invoked at all,
+  // e.g. if it was shut down right after loading.
+  if (total_count == 0) return absl::OkStatus();
+
+  std::sort(counts.begin(), counts.end(), std::greater<>());
+  std::string contents;
+  for (const auto& [count, name] : counts) {
+    absl::StrAppend(&contents, name, "\t", count, "\n");
+  }
+
+  // Write to a temporary file first so that a concurrently loading process
+  // never reads a partial profile.
+  const std::string& path = options_.lazy_loading_signature_profile_path;
+  const std::string tmp_path = absl::StrCat(path, ".tmp");
+  TF_RETURN_IF_ERROR(WriteStringToFile(Env::Default(), tmp_path, contents));
+  return Env::Default()->RenameFile(tmp_path, path);
+}
+
 std::vector<std::string> SavedModelImpl::GetFunctionNames() const {
   std::vector<std::string> result;
   for (const auto& entry : signatures_) {
@@ -770,6 +1038,11 @@ tensorflow::Status SavedModelImpl::Run(
   const tensorflow::SessionMetadata& model_metadata =
       options_.graph_execution_options.model_metadata;
 
+  if (auto count_iter = signature_call_counts_.find(name);
+      count_iter != signature_call_counts_.end()) {
+    count_iter->second.fetch_add(1, std::memory_order_relaxed);
+  }
+
   if (options_.enable_lazy_loading &&
       options_.lazy_loading_use_graph_executor) {
     lazy_loading_count
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_SAVED_MODEL_SAVED_MODEL_H_
 #define TENSORFLOW_CORE_TFRT_SAVED_MODEL_SAVED_MODEL_H_
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <limits>
@@ -26,10 +27,12 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
@@ -107,9 +110,40 @@ class SavedModel {
     // TODO(b/216379787): Remove this option once b/279197040 is unblocked.
     bool lazy_loading_use_graph_executor = false;
 
+    // If non-empty and lazy loading is enabled, the path of a file where the
+    // number of invocations of each signature is recorded when the saved model
+    // is destroyed. If the file exists when the saved model is loaded, the
+    // recorded signatures are loaded in the background, the most invoked ones
+    // first, so that they are likely loaded before their first invocation.
+    //
+    // This is not supported with `lazy_loading_use_graph_executor`.
+    std::string lazy_loading_signature_profile_path;
+
+    // If true and lazy loading is enabled, all the signatures are loaded in
+    // the background after the ones in the profile above, so that only the
+    // invocations arriving before their signatures are loaded pay for the
+    // loading.
+    //
+    // This is not supported with `lazy_loading_use_graph_executor`.
+    bool lazy_loading_prefetch_all_signatures = false;
+
     // True if and only if SavedModel is being loaded to generate AOT results.
     bool aot_generation = false;
 
+    // If positive, the MLIR passes which import and lower the model run on a
+    // dedicated pool of this many threads, which processes the functions of
+    // the model in parallel. Otherwise, they run on the process-wide MLIR
+    // thread pool.
+    int num_compile_threads = 0;
+
+    // If non-empty, the MLRT bytecode compiled for the model is stored in this
+    // directory and reused by later loads of the same model with the same
+    // options and TF build, which then skip lowering the model. The entries
+    // are keyed by the fingerprint of the SavedModel. Only used with MLRT on
+    // targets without a backend compiler, as the lowering for the other
+    // targets also populates runtime state.
+    std::string compilation_cache_dir;
+
     GraphExecutionOptions graph_execution_options;
   };
 
@@ -228,7 +262,7 @@ class SavedModelImpl final : public SavedModel {
       std::unique_ptr<tfd::FallbackResourceArray> resource_array,
       std::unique_ptr<GraphExecutor> graph_executor);
 
-  ~SavedModelImpl() override = default;
+  ~SavedModelImpl() override;
 
   SavedModelImpl(const SavedModelImpl&) = delete;
   SavedModelImpl& operator=(const SavedModelImpl&) = delete;
@@ -300,6 +334,15 @@ class SavedModelImpl final : public SavedModel {
                            absl::Span<const std::string> names)
       TF_LOCKS_EXCLUDED(loading_result_cache_mu_);
 
+  // Loads the signatures in `names` one after another, for the background
+  // prefetching of lazy loading.
+  void PrefetchSignatures(const std::vector<std::string>& names)
+      TF_LOCKS_EXCLUDED(loading_result_cache_mu_);
+
+  // Writes the invocation counts in `signature_call_counts_` to
+  // `options_.lazy_loading_signature_profile_path`.
+  absl::Status WriteSignatureProfile() const;
+
   SymbolUids symbol_uids_;
   // `meta_graph_def_` only contains metadata of the model. The graph_def field
   // is removed.
@@ -324,6 +367,16 @@ class SavedModelImpl final : public SavedModel {
   absl::flat_hash_map<std::string /*joined_name*/,
                       std::unique_ptr<LoadingResult>>
       loading_result_cache_ TF_GUARDED_BY(loading_result_cache_mu_);
+
+  // The number of invocations of each signature, only populated if
+  // `options_.lazy_loading_signature_profile_path` is set. The keys are fixed
+  // at construction so that `Run()` can update the counts without locking.
+  absl::node_hash_map<std::string, std::atomic<int64_t>>
+      signature_call_counts_;
+  std::atomic<bool> prefetch_cancelled_ = false;
+  // The thread loading the signatures in the background, if any. It is joined
+  // in the destructor before any other member is destroyed.
+  std::unique_ptr<tensorflow::Thread> prefetch_thread_;
 };
 
 class SavedModelMiraImpl;
@@ -37,6 +37,8 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/resource_loader.h"
 #include "tensorflow/core/tfrt/graph_executor/config.h"
 #include "tensorflow/core/tfrt/graph_executor/test_config.pb.h"
@@ -137,6 +139,30 @@ TEST(SavedModelTest, BasicV2) {
   EXPECT_EQ(output.flat<int32_t>()(0), 6);
 }
 
+TEST(SavedModelTest, CompileThreadPool) {
+  std::string saved_model_dir = tensorflow::GetDataDependencyFilepath(
+      "tensorflow/core/tfrt/saved_model/tests/toy_v1/1");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto options = DefaultSavedModelOptions(runtime.get());
+  options.num_compile_threads = 2;
+
+  auto saved_model = SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                                    /*tags=*/{"serve"});
+  TF_ASSERT_OK(saved_model.status());
+
+  std::vector<tensorflow::Tensor> inputs;
+  inputs.push_back(
+      CreateTfTensor<int32_t>(/*shape=*/{1, 3}, /*data=*/{1, 1, 1}));
+
+  std::vector<tensorflow::Tensor> outputs;
+  TF_ASSERT_OK((*saved_model)->Run({}, "toy", inputs, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({6}));
+}
+
 TEST_P(SavedModelTest, OnlineCostAnalysis) {
   // SavedModel toy contains a graph of a single 'tf.AddV2' op. It is generated
   // using the following python code:
@@ -1071,6 +1097,93 @@ TEST(SavedModelTest, DisableCompilation) {
   TF_ASSERT_OK((*saved_model)->Run(run_options, "toy", inputs, &outputs));
 }
 
+TEST(SavedModelTest, LazyLoadingSignatureProfile) {
+  std::string saved_model_dir = tensorflow::GetDataDependencyFilepath(
+      "tensorflow/core/tfrt/saved_model/tests/toy_v1/1");
+  const std::string profile_path =
+      tensorflow::io::JoinPath(testing::TmpDir(), "signature_profile");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto options = DefaultSavedModelOptions(runtime.get());
+  options.enable_lazy_loading = true;
+  options.lazy_loading_signature_profile_path = profile_path;
+
+  // Set input 'x' to [[1, 1, 1]]
+  std::vector<tensorflow::Tensor> inputs;
+  inputs.push_back(
+      CreateTfTensor<int32_t>(/*shape=*/{1, 3}, /*data=*/{1, 1, 1}));
+  std::vector<tensorflow::Tensor> outputs;
+  tfrt::SavedModel::RunOptions run_options;
+
+  {
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto saved_model,
+        SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                       /*tags=*/{"serve"}));
+    TF_ASSERT_OK(saved_model->Run(run_options, "toy", inputs, &outputs));
+    TF_ASSERT_OK(saved_model->Run(run_options, "toy", inputs, &outputs));
+  }
+
+  // The invocations are recorded when the saved model is destroyed.
+  std::string profile;
+  TF_ASSERT_OK(
+      ReadFileToString(tensorflow::Env::Default(), profile_path, &profile));
+  EXPECT_EQ(profile, "toy\t2\n");
+
+  // The recorded signature is then loaded in the background, so that it can
+  // eventually be run without compilation.
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto saved_model, SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                                       /*tags=*/{"serve"}));
+  run_options.disable_compilation = true;
+  const absl::Time deadline = absl::Now() + absl::Minutes(1);
+  absl::Status status;
+  do {
+    status = saved_model->Run(run_options, "toy", inputs, &outputs);
+    if (status.ok()) break;
+    absl::SleepFor(absl::Milliseconds(10));
+  } while (absl::Now() < deadline);
+  TF_ASSERT_OK(status);
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({6}));
+}
+
+TEST(SavedModelTest, CompilationCache) {
+  std::string saved_model_dir = tensorflow::GetDataDependencyFilepath(
+      "tensorflow/core/tfrt/saved_model/tests/toy_v1/1");
+  const std::string cache_dir =
+      tensorflow::io::JoinPath(testing::TmpDir(), "compilation_cache");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto options = DefaultSavedModelOptions(runtime.get());
+  options.graph_execution_options.enable_mlrt = true;
+  options.compilation_cache_dir = cache_dir;
+
+  // Set input 'x' to [[1, 1, 1]]
+  std::vector<tensorflow::Tensor> inputs;
+  inputs.push_back(
+      CreateTfTensor<int32_t>(/*shape=*/{1, 3}, /*data=*/{1, 1, 1}));
+
+  // The first load compiles the model and stores the bytecode, which the
+  // second load reuses.
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto saved_model,
+        SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                       /*tags=*/{"serve"}));
+    std::vector<std::string> entries;
+    TF_ASSERT_OK(
+        tensorflow::Env::Default()->GetChildren(cache_dir, &entries));
+    EXPECT_EQ(entries.size(), 1);
+
+    std::vector<tensorflow::Tensor> outputs;
+    TF_ASSERT_OK(saved_model->Run({}, "toy", inputs, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+                ::testing::ElementsAreArray({6}));
+  }
+}
+
 TEST(SavedModelTest, CustomModelConfig) {
   // SavedModel toy contains a graph of a single 'tf.AddV2' op. It is generated
   // using the following python code:
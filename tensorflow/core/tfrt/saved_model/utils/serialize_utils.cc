@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/tfrt/mlrt/bytecode/bytecode.h"
 #include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
 #include "tfrt/bef/bef_buffer.h"  // from @tf_runtime
 
 namespace tensorflow {
@@ -67,7 +68,8 @@ absl::Status SerializeMLRTBytecode(const mlrt::bc::Buffer &bytecode,
 absl::StatusOr<mlrt::bc::Buffer> DeserializeMlrtBytecodeBuffer(
     const std::string &filepath) {
   std::string bytecode_data;
-  TF_CHECK_OK(ReadFileToString(tsl::Env::Default(), filepath, &bytecode_data));
+  TF_RETURN_IF_ERROR(
+      ReadFileToString(tsl::Env::Default(), filepath, &bytecode_data));
   // Convert the string to a byte array.
   mlrt::bc::Buffer buffer;
   mlrt::bc::Allocator allocator(&buffer);
@@ -42,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/tstring.h"
@@ -51,6 +52,22 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+auto* preprocessed_ids = monitoring::Counter<2>::New(
+    "/tensorflow/tpu/embedding/preprocessed_ids",
+    "Number of ids sorted for each table on the host, by stage: 'input' ids, "
+    "'deduplicated' ids sent to the sparse cores and 'unique' column ids. The "
+    "ratio of 'unique' to 'input' is the deduplication ratio of the table.",
+    "table", "stage");
+
+auto* preprocessed_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/tpu/embedding/preprocessed_bytes",
+    "Bytes of sorted ids and gains produced for each table on the host.",
+    "table");
+
+}  // namespace
+
 bool IsPowerOfTwo(int32_t x) { return x > 0 && (x & (x - 1)) == 0; }
 
 Status ValidateInputs(const Tensor& indices_or_row_splits, const Tensor& values,
@@ -1481,6 +1498,17 @@ void SortListOfSparseCoreCooTensorsOp::Compute(OpKernelContext* ctx) {
   const int32_t updated_total_id_count =
       absl::c_accumulate(total_id_counter, 0);
 
+  preprocessed_ids->GetCell(table_name_, "input")
+      ->IncrementBy(absl::c_accumulate(total_id_counts, int64_t{0}));
+  preprocessed_ids->GetCell(table_name_, "deduplicated")
+      ->IncrementBy(updated_total_id_count);
+  preprocessed_ids->GetCell(table_name_, "unique")
+      ->IncrementBy(absl::c_accumulate(total_unique_id_counter, int64_t{0}));
+  preprocessed_bytes->GetCell(table_name_)
+      ->IncrementBy(static_cast<int64_t>(updated_total_id_count) *
+                        (sizeof(int32_t) * 2 + sizeof(float)) +
+                    id_counts_tensor->TotalBytes());
+
   Tensor* sorted_row_ids_tensor;
   OP_REQUIRES_OK(ctx,
                  ctx->allocate_output("sorted_row_ids",
@@ -0,0 +1,83 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::monitoring::testing::CellReader;
+
+class SortListOfSparseCoreCooTensorsOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const std::string& table_name) {
+    TF_ASSERT_OK(NodeDefBuilder("sort", "SortListOfSparseCoreCooTensors")
+                     .Input(FakeInput(1, DT_INT32))
+                     .Input(FakeInput(1, DT_INT32))
+                     .Input(FakeInput(1, DT_FLOAT))
+                     .Attr("sample_count_list", {2})
+                     .Attr("col_offset_list", {0})
+                     .Attr("num_replica", 1)
+                     .Attr("table_vocab_size", 8)
+                     .Attr("feature_width", 4)
+                     .Attr("num_sc_per_chip", 1)
+                     .Attr("max_ids_per_sparse_core", 16)
+                     .Attr("max_unique_ids_per_sparse_core", 16)
+                     .Attr("table_name", table_name)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(SortListOfSparseCoreCooTensorsOpTest, ExportsDeduplicationMetrics) {
+  CellReader<int64_t> preprocessed_ids(
+      "/tensorflow/tpu/embedding/preprocessed_ids");
+  CellReader<int64_t> preprocessed_bytes(
+      "/tensorflow/tpu/embedding/preprocessed_bytes");
+  MakeOp("table_a");
+
+  // Sample 0 looks up id 3 twice, sample 1 looks up ids 3 and 5.
+  AddInputFromArray<int32_t>(TensorShape({4}), {0, 0, 1, 1});
+  AddInputFromArray<int32_t>(TensorShape({4}), {3, 3, 3, 5});
+  AddInputFromArray<float>(TensorShape({4}), {1, 1, 1, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  EXPECT_EQ(preprocessed_ids.Delta("table_a", "input"), 4);
+  EXPECT_EQ(preprocessed_ids.Delta("table_a", "deduplicated"), 3);
+  EXPECT_EQ(preprocessed_ids.Delta("table_a", "unique"), 2);
+  // Three sorted (row id, col id, gain) triples and two id counts.
+  EXPECT_EQ(preprocessed_bytes.Delta("table_a"), 3 * 12 + 2 * 4);
+  EXPECT_EQ(preprocessed_ids.Delta("table_b", "input"), 0);
+  EXPECT_EQ(preprocessed_bytes.Delta("table_b"), 0);
+
+  // The counters accumulate across steps.
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(preprocessed_ids.Delta("table_a", "input"), 4);
+  EXPECT_EQ(preprocessed_ids.Read("table_a", "input"), 8);
+  EXPECT_EQ(preprocessed_bytes.Read("table_a"), 2 * (3 * 12 + 2 * 4));
+}
+
+}  // namespace
+}  // namespace tensorflow
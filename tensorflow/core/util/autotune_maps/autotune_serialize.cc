@@ -16,22 +16,28 @@ limitations under the License.
 // For Google-internal use only.
 #include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 
+#include <cstdlib>
 #include <map>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "xla/status_macros.h"
 #include "xla/stream_executor/dnn.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "xla/stream_executor/platform_manager.h"
+#include "tensorflow/core/kernels/matmul_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/str_util.h"
+#include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/util/activation_mode.h"
 #include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
 #include "tsl/lib/strings/proto_serialization.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/protobuf/dnn.pb.h"
 
 namespace tensorflow {
@@ -170,17 +176,160 @@ Status PopulateConvMap(
   return OkStatus();
 }
 
+#if GOOGLE_CUDA || TF_HIPBLASLT
+StatusOr<BlasLtMatmulMapProto> BlasLtMatmulMapToProto() {
+  BlasLtMatmulMapProto proto;
+  proto.set_version(BlasLtMatmulPlanParams::kVersion);
+
+  // Sorted by the serialized entries for a deterministic serialization, as in
+  // ConvMapToProto.
+  std::map<string, BlasLtMatmulMapProto::Entry> sorted_map;
+  for (auto const &p : AutoTuneBatchMatmul::GetInstance()->GetMap()) {
+    const BlasLtMatmulPlanParams &params = p.first;
+    // The matmuls for which no algorithm worked are autotuned again.
+    if (p.second.algorithm() == se::blas::kNoAlgorithm) continue;
+
+    BlasLtMatmulMapProto::Entry kv;
+    kv.set_dtype(static_cast<int32>(params.dtype));
+    kv.set_m(params.m);
+    kv.set_n(params.n);
+    kv.set_k(params.k);
+    kv.set_trans_a(static_cast<int32>(params.trans_a));
+    kv.set_trans_b(static_cast<int32>(params.trans_b));
+    kv.set_batch_count(params.batch_count);
+    kv.set_broadcast_a(params.broadcast_a);
+    kv.set_broadcast_b(params.broadcast_b);
+    kv.set_epilogue(static_cast<int32>(params.epilogue));
+    kv.set_algorithm(p.second.algorithm());
+
+    std::string serialized_entry;
+    TF_RET_CHECK(tsl::SerializeToStringDeterministic(kv, &serialized_entry));
+    sorted_map.insert(std::make_pair(std::move(serialized_entry), kv));
+  }
+
+  for (auto const &p : sorted_map) {
+    *proto.add_kv_pairs() = p.second;
+  }
+  return proto;
+}
+
+Status PopulateBlasLtMatmulMap(const BlasLtMatmulMapProto &m) {
+  if (m.kv_pairs().size() == 0) {
+    return OkStatus();
+  }
+  if (m.version() != BlasLtMatmulPlanParams::kVersion) {
+    return errors::Aborted(
+        "Aborted because the loaded autotune results for matmul operations "
+        "have a version different from runtime's version. Expected version: ",
+        BlasLtMatmulPlanParams::kVersion, ". Actual version: ", m.version());
+  }
+
+  for (const BlasLtMatmulMapProto::Entry &kv : m.kv_pairs()) {
+    BlasLtMatmulPlanParams params{
+        static_cast<se::blas::DataType>(kv.dtype()),
+        kv.m(),
+        kv.n(),
+        kv.k(),
+        static_cast<se::blas::Transpose>(kv.trans_a()),
+        static_cast<se::blas::Transpose>(kv.trans_b()),
+        kv.batch_count(),
+        kv.broadcast_a(),
+        kv.broadcast_b(),
+        static_cast<se::gpu::BlasLt::Epilogue>(kv.epilogue())};
+    AutoTuneBatchMatmul::GetInstance()->Insert(
+        params, se::blas::AlgorithmConfig(kv.algorithm()));
+  }
+  return OkStatus();
+}
+#endif  // GOOGLE_CUDA || TF_HIPBLASLT
+
+// Returns a description of the GPUs and of the libraries the autotuned
+// algorithms depend on, which is the same for all the runs of a binary on the
+// same machine.
+StatusOr<std::string> ComputeRuntimeFingerprint() {
+  TF_ASSIGN_OR_RETURN(
+      se::Platform * platform,
+      se::PlatformManager::PlatformWithName(se::GpuPlatformName()));
+  std::vector<std::string> parts = {platform->Name()};
+  for (int i = 0; i < platform->VisibleDeviceCount(); i++) {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<se::DeviceDescription> device_desc,
+                        platform->DescriptionForDevice(i));
+    parts.push_back(absl::StrCat(device_desc->model_str(), " driver ",
+                                 device_desc->driver_version(), " runtime ",
+                                 device_desc->runtime_version()));
+  }
+  if (platform->VisibleDeviceCount() > 0) {
+    TF_ASSIGN_OR_RETURN(se::StreamExecutor * executor,
+                        platform->ExecutorForDevice(0));
+    if (auto *dnn = executor->AsDnn()) {
+      TF_ASSIGN_OR_RETURN(se::dnn::VersionInfo version, dnn->GetVersion());
+      parts.push_back(absl::StrCat("dnn ", version.major_version(), ".",
+                                   version.minor_version(), ".",
+                                   version.patch()));
+    }
+    if (auto *blas = executor->AsBlas()) {
+      std::string version;
+      TF_RETURN_IF_ERROR(blas->GetVersion(&version));
+      parts.push_back(absl::StrCat("blas ", version));
+    }
+  }
+#if GOOGLE_CUDA || TF_HIPBLASLT
+  // The matmul algorithms are indices into the first algorithms of cuBLASLt.
+  parts.push_back(absl::StrCat("matmul algorithms ",
+                               MatmulMaxAutotuneAlgorithmCount()));
+#endif  // GOOGLE_CUDA || TF_HIPBLASLT
+  return str_util::Join(parts, "; ");
+}
+
 }  // namespace
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
-Status SerializeAutotuneMaps(std::string *output) {
+namespace {
+
+StatusOr<AutotuneMapsProto> AutotuneMapsToProto() {
   AutotuneMapsProto proto;
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   TF_ASSIGN_OR_RETURN(*proto.mutable_conv_map(),
                       ConvMapToProto(*ConvAutotuneMap::GetInstance()));
   TF_ASSIGN_OR_RETURN(*proto.mutable_fused_conv_map(),
                       ConvMapToProto(*FusedConvAutotuneMap::GetInstance()));
+#if GOOGLE_CUDA || TF_HIPBLASLT
+  TF_ASSIGN_OR_RETURN(*proto.mutable_blas_lt_matmul_map(),
+                      BlasLtMatmulMapToProto());
+#endif  // GOOGLE_CUDA || TF_HIPBLASLT
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  return proto;
+}
+
+Status PopulateAutotuneMaps(const AutotuneMapsProto &proto) {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  TF_RETURN_IF_ERROR(
+      PopulateConvMap(proto.conv_map(), ConvAutotuneMap::GetInstance()));
+  TF_RETURN_IF_ERROR(PopulateConvMap(proto.fused_conv_map(),
+                                     FusedConvAutotuneMap::GetInstance()));
+#if GOOGLE_CUDA || TF_HIPBLASLT
+  TF_RETURN_IF_ERROR(PopulateBlasLtMatmulMap(proto.blas_lt_matmul_map()));
+#endif  // GOOGLE_CUDA || TF_HIPBLASLT
+  // TODO(b/189530096): Populate autotune maps for more ops.
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  return absl::OkStatus();
+}
+
+// The fingerprint of the runtime, computed once.
+StatusOr<std::string> GetRuntimeFingerprint() {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  static const auto *fingerprint =
+      new StatusOr<std::string>(ComputeRuntimeFingerprint());
+  return *fingerprint;
+#else
+  return std::string();
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
+}  // namespace
+
+Status SerializeAutotuneMaps(std::string *output) {
+  TF_ASSIGN_OR_RETURN(AutotuneMapsProto proto, AutotuneMapsToProto());
   TF_RET_CHECK(tsl::SerializeToStringDeterministic(proto, output));
   return absl::OkStatus();
 }
@@ -195,19 +344,81 @@ Status LoadSerializedAutotuneMaps(absl::string_view s) {
     return errors::InvalidArgument(
         "Failed to parse the autotune maps from string.");
   }
-  TF_RETURN_IF_ERROR(
-      PopulateConvMap(proto.conv_map(), ConvAutotuneMap::GetInstance()));
-  TF_RETURN_IF_ERROR(PopulateConvMap(proto.fused_conv_map(),
-                                     FusedConvAutotuneMap::GetInstance()));
-  // TODO(b/189530096): Populate autotune maps for more ops.
+  TF_RETURN_IF_ERROR(PopulateAutotuneMaps(proto));
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   return absl::OkStatus();
 }
 
+Status SaveAutotuneMapsToFile(const std::string &path) {
+  TF_ASSIGN_OR_RETURN(AutotuneMapsProto proto, AutotuneMapsToProto());
+  TF_ASSIGN_OR_RETURN(*proto.mutable_runtime_fingerprint(),
+                      GetRuntimeFingerprint());
+  std::string serialized;
+  TF_RET_CHECK(tsl::SerializeToStringDeterministic(proto, &serialized));
+
+  // Replicas may share the file, so it is replaced atomically.
+  Env *env = Env::Default();
+  std::string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            path);
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, serialized));
+  return env->RenameFile(tmp_path, path);
+}
+
+Status LoadAutotuneMapsFromFile(const std::string &path) {
+  std::string serialized;
+  TF_RETURN_IF_ERROR(ReadFileToString(Env::Default(), path, &serialized));
+  AutotuneMapsProto proto;
+  if (!proto.ParseFromString(serialized)) {
+    return errors::InvalidArgument("Failed to parse the autotune maps in ",
+                                   path);
+  }
+  TF_ASSIGN_OR_RETURN(std::string fingerprint, GetRuntimeFingerprint());
+  if (proto.runtime_fingerprint() != fingerprint) {
+    return errors::FailedPrecondition(
+        "The autotune maps in ", path, " were autotuned for \"",
+        proto.runtime_fingerprint(), "\" but the runtime is \"", fingerprint,
+        "\"");
+  }
+  return PopulateAutotuneMaps(proto);
+}
+
+void MaybeUseAutotuneMapsFile() {
+  static const bool initialized = [] {
+    std::string path;
+    Status status = ReadStringFromEnvVar("TF_AUTOTUNE_MAPS_FILE", "", &path);
+    if (!status.ok() || path.empty()) return true;
+    if (Env::Default()->FileExists(path).ok()) {
+      status = LoadAutotuneMapsFromFile(path);
+      if (status.ok()) {
+        VLOG(1) << "Loaded the autotune maps from " << path;
+      } else {
+        LOG(WARNING) << "Not using the autotune maps in " << path << ": "
+                     << status;
+      }
+    }
+    static const std::string *file = new std::string(path);
+    std::atexit([] {
+      Status save_status = SaveAutotuneMapsToFile(*file);
+      if (!save_status.ok()) {
+        LOG(WARNING) << "Failed to save the autotune maps to " << *file
+                     << ": " << save_status;
+      }
+    });
+    return true;
+  }();
+  (void)initialized;
+}
+
 void ResetAutotuneMaps() {
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   ConvAutotuneMap::GetInstance()->ClearMap();
   FusedConvAutotuneMap::GetInstance()->ClearMap();
+#if GOOGLE_CUDA || TF_HIPBLASLT
+  AutoTuneBatchMatmul::GetInstance()->ClearMap();
+#endif  // GOOGLE_CUDA || TF_HIPBLASLT
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 }
 
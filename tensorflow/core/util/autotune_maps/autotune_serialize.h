@@ -40,6 +40,21 @@ Status LoadSerializedAutotuneMaps(absl::string_view s);
 // LoadSerializedAutotuneMaps.
 Status SerializeAutotuneMaps(std::string* output);
 
+// Saves all the autotune maps to the file `path`, together with the
+// fingerprint of the GPUs, driver and libraries they were autotuned with.
+Status SaveAutotuneMapsToFile(const std::string& path);
+
+// Loads the autotune maps saved by SaveAutotuneMapsToFile to `path`. Fails
+// with FailedPrecondition if they were autotuned with other GPUs, driver or
+// libraries than the runtime's.
+Status LoadAutotuneMapsFromFile(const std::string& path);
+
+// If the environment variable TF_AUTOTUNE_MAPS_FILE names a file, loads the
+// autotune maps from it if it exists, and saves them to it at exit, so that
+// the runs of a model don't autotune the same ops again. Does nothing after
+// the first call.
+void MaybeUseAutotuneMapsFile();
+
 // Resets all autotune maps. For test use only.
 void ResetAutotuneMaps();
 
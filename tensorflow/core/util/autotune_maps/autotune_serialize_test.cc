@@ -20,8 +20,12 @@ limitations under the License.
 #include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 #include "xla/stream_executor/gpu/gpu_driver.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
+#include "tensorflow/core/kernels/matmul_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
@@ -181,6 +185,49 @@ TEST(AutotuneSerializeTest, VersionControl) {
                HasSubstr("Aborted because the loaded autotune results")));
   EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 0);
 }
+
+#if GOOGLE_CUDA || TF_HIPBLASLT
+// Tests that the matmul autotune map is saved to and loaded from a file.
+TEST(AutotuneSerializeTest, MatmulFileConsistency) {
+  TF_CHECK_OK(GpuDriver::Init());
+  ResetAutotuneMaps();
+  BlasLtMatmulPlanParams params{se::blas::DataType::kFloat,
+                                /*m=*/128,
+                                /*n=*/256,
+                                /*k=*/64,
+                                se::blas::Transpose::kNoTranspose,
+                                se::blas::Transpose::kTranspose,
+                                /*batch_count=*/4,
+                                /*broadcast_a=*/false,
+                                /*broadcast_b=*/true};
+  AutoTuneBatchMatmul::GetInstance()->Insert(params,
+                                             se::blas::AlgorithmConfig(3));
+
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "matmul_autotune_maps");
+  TF_CHECK_OK(SaveAutotuneMapsToFile(path));
+  ResetAutotuneMaps();
+  TF_CHECK_OK(LoadAutotuneMapsFromFile(path));
+  se::blas::AlgorithmConfig config;
+  ASSERT_TRUE(AutoTuneBatchMatmul::GetInstance()->Find(params, &config));
+  EXPECT_EQ(config.algorithm(), 3);
+}
+#endif  // GOOGLE_CUDA || TF_HIPBLASLT
+
+// Tests that the maps autotuned with another runtime are not loaded.
+TEST(AutotuneSerializeTest, FileOfAnotherRuntime) {
+  TF_CHECK_OK(GpuDriver::Init());
+  ResetAutotuneMaps();
+  AutotuneMapsProto proto;
+  proto.set_runtime_fingerprint("another GPU");
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "other_autotune_maps");
+  TF_CHECK_OK(
+      WriteStringToFile(Env::Default(), path, proto.SerializeAsString()));
+  EXPECT_THAT(LoadAutotuneMapsFromFile(path),
+              StatusIs(error::FAILED_PRECONDITION,
+                       HasSubstr("were autotuned for \"another GPU\"")));
+}
 }  // namespace
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -15,13 +15,17 @@ limitations under the License.
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <limits>
 #include <optional>
 #include <utility>
 #include <vector>
 
 #include "absl/base/casts.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/numeric/bits.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -35,11 +39,22 @@ limitations under the License.
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/util/presized_cuckoo_map.h"
 #include "tensorflow/core/util/sparse/sparse_tensor.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 namespace tensorflow {
 namespace example {
 
@@ -117,6 +132,251 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Bulk decoding of packed varints.
+//
+// Packed `Int64List`s are decoded by scanning the bytes for the varint
+// terminators (the bytes with a clear high bit) a block at a time. A block
+// made only of terminators holds one-byte varints, which are widened straight
+// into the output; other blocks are decoded one varint at a time.
+//
+// The widest block decoder supported by the CPU is chosen at runtime.
+
+// Decodes one varint from `p`, which must be followed by a terminator before
+// the end of the buffer. Returns nullptr if the varint is longer than 10
+// bytes.
+inline const uint8* DecodeVarint64(const uint8* p, uint64* value) {
+  uint64 result = 0;
+  for (int shift = 0; shift < 70; shift += 7) {
+    const uint8 byte = *p++;
+    result |= static_cast<uint64>(byte & 0x7f) << shift;
+    if (byte < 0x80) {
+      *value = result;
+      return p;
+    }
+  }
+  return nullptr;
+}
+
+int64_t CountVarintsScalar(const uint8* begin, const uint8* end) {
+  int64_t count = 0;
+  for (const uint8* p = begin; p < end; ++p) {
+    count += *p < 0x80;
+  }
+  return count;
+}
+
+// Decodes the varints in [p, end) until `p` reaches `block_end`.
+inline const uint8* DecodeVarintsUntil(const uint8* p, const uint8* block_end,
+                                       int64_t** out) {
+  while (p < block_end) {
+    uint64 value;
+    p = DecodeVarint64(p, &value);
+    if (p == nullptr) return nullptr;
+    *(*out)++ = static_cast<int64_t>(value);
+  }
+  return p;
+}
+
+const uint8* DecodeVarintsScalar(const uint8* p, const uint8* end,
+                                 int64_t* out) {
+  return DecodeVarintsUntil(p, end, &out);
+}
+
+#if defined(__SSE2__) || defined(_M_X64)
+int64_t CountVarintsSse2(const uint8* begin, const uint8* end) {
+  int64_t count = 0;
+  const uint8* p = begin;
+  for (; end - p >= 16; p += 16) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    count += 16 - absl::popcount(
+                      static_cast<uint32>(_mm_movemask_epi8(bytes)));
+  }
+  return count + CountVarintsScalar(p, end);
+}
+
+const uint8* DecodeVarintsSse2(const uint8* p, const uint8* end,
+                               int64_t* out) {
+  const __m128i zero = _mm_setzero_si128();
+  while (p != nullptr && end - p >= 16) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    if (_mm_movemask_epi8(bytes) != 0) {
+      p = DecodeVarintsUntil(p, p + 16, &out);
+      continue;
+    }
+    // Widen the 16 one-byte varints to 64 bits.
+    const __m128i lo16 = _mm_unpacklo_epi8(bytes, zero);
+    const __m128i hi16 = _mm_unpackhi_epi8(bytes, zero);
+    const __m128i words[4] = {
+        _mm_unpacklo_epi16(lo16, zero), _mm_unpackhi_epi16(lo16, zero),
+        _mm_unpacklo_epi16(hi16, zero), _mm_unpackhi_epi16(hi16, zero)};
+    __m128i* dst = reinterpret_cast<__m128i*>(out);
+    for (int i = 0; i < 4; ++i) {
+      _mm_storeu_si128(dst++, _mm_unpacklo_epi32(words[i], zero));
+      _mm_storeu_si128(dst++, _mm_unpackhi_epi32(words[i], zero));
+    }
+    out += 16;
+    p += 16;
+  }
+  return p == nullptr ? nullptr : DecodeVarintsScalar(p, end, out);
+}
+#endif  // defined(__SSE2__) || defined(_M_X64)
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TF_EXAMPLE_PARSING_HAVE_AVX2 1
+__attribute__((target("avx2"))) int64_t CountVarintsAvx2(const uint8* begin,
+                                                         const uint8* end) {
+  int64_t count = 0;
+  const uint8* p = begin;
+  for (; end - p >= 32; p += 32) {
+    const __m256i bytes =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    count += 32 - absl::popcount(
+                      static_cast<uint32>(_mm256_movemask_epi8(bytes)));
+  }
+  return count + CountVarintsScalar(p, end);
+}
+
+__attribute__((target("avx2"))) const uint8* DecodeVarintsAvx2(
+    const uint8* p, const uint8* end, int64_t* out) {
+  while (p != nullptr && end - p >= 32) {
+    const __m256i bytes =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    if (_mm256_movemask_epi8(bytes) != 0) {
+      p = DecodeVarintsUntil(p, p + 32, &out);
+      continue;
+    }
+    // Widen the 32 one-byte varints to 64 bits, four at a time.
+    for (int i = 0; i < 32; i += 4) {
+      uint32 four;
+      std::memcpy(&four, p + i, sizeof(four));
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(out + i),
+          _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(static_cast<int>(four))));
+    }
+    out += 32;
+    p += 32;
+  }
+  return p == nullptr ? nullptr : DecodeVarintsScalar(p, end, out);
+}
+#endif  // defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+int64_t CountVarintsNeon(const uint8* begin, const uint8* end) {
+  int64_t count = 0;
+  const uint8* p = begin;
+  for (; end - p >= 16; p += 16) {
+    count += 16 - vaddvq_u8(vshrq_n_u8(vld1q_u8(p), 7));
+  }
+  return count + CountVarintsScalar(p, end);
+}
+
+const uint8* DecodeVarintsNeon(const uint8* p, const uint8* end,
+                               int64_t* out) {
+  while (p != nullptr && end - p >= 16) {
+    const uint8x16_t bytes = vld1q_u8(p);
+    if (vmaxvq_u8(bytes) >= 0x80) {
+      p = DecodeVarintsUntil(p, p + 16, &out);
+      continue;
+    }
+    // Widen the 16 one-byte varints to 64 bits.
+    const uint16x8_t halves[2] = {vmovl_u8(vget_low_u8(bytes)),
+                                  vmovl_u8(vget_high_u8(bytes))};
+    for (int i = 0; i < 2; ++i) {
+      const uint32x4_t lo = vmovl_u16(vget_low_u16(halves[i]));
+      const uint32x4_t hi = vmovl_u16(vget_high_u16(halves[i]));
+      uint64* dst = reinterpret_cast<uint64*>(out + 8 * i);
+      vst1q_u64(dst, vmovl_u32(vget_low_u32(lo)));
+      vst1q_u64(dst + 2, vmovl_u32(vget_high_u32(lo)));
+      vst1q_u64(dst + 4, vmovl_u32(vget_low_u32(hi)));
+      vst1q_u64(dst + 6, vmovl_u32(vget_high_u32(hi)));
+    }
+    out += 16;
+    p += 16;
+  }
+  return p == nullptr ? nullptr : DecodeVarintsScalar(p, end, out);
+}
+#endif  // defined(__ARM_NEON) && defined(__aarch64__)
+
+struct VarintDecoder {
+  int64_t (*count)(const uint8* begin, const uint8* end);
+  const uint8* (*decode)(const uint8* p, const uint8* end, int64_t* out);
+};
+
+VarintDecoder ChooseVarintDecoder() {
+#ifdef TF_EXAMPLE_PARSING_HAVE_AVX2
+  if (port::TestCPUFeature(port::CPUFeature::AVX2)) {
+    return {CountVarintsAvx2, DecodeVarintsAvx2};
+  }
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+  return {CountVarintsSse2, DecodeVarintsSse2};
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  return {CountVarintsNeon, DecodeVarintsNeon};
+#else
+  return {CountVarintsScalar, DecodeVarintsScalar};
+#endif
+}
+
+const VarintDecoder& GetVarintDecoder() {
+  static const VarintDecoder decoder = ChooseVarintDecoder();
+  return decoder;
+}
+
+// Returns the number of varints in the packed varints [begin, end), or -1 if
+// the last one is truncated.
+int64_t CountPackedVarints(const uint8* begin, const uint8* end) {
+  if (begin != end && end[-1] >= 0x80) return -1;
+  return GetVarintDecoder().count(begin, end);
+}
+
+// Decodes the `CountPackedVarints(begin, end)` varints in [begin, end) into
+// `out`. Returns false if a varint is longer than 10 bytes.
+bool DecodePackedVarints(const uint8* begin, const uint8* end, int64_t* out) {
+  if (begin == end) return true;
+  return GetVarintDecoder().decode(begin, end, out) != nullptr;
+}
+
+// Points `begin` at the next `length` bytes of `stream`, without consuming
+// them.
+bool PeekBytes(protobuf::io::CodedInputStream* stream, uint32 length,
+               const uint8** begin) {
+  const void* data = nullptr;
+  int size = 0;
+  if (length > 0 && (!stream->GetDirectBufferPointer(&data, &size) ||
+                     size < 0 || static_cast<uint32>(size) < length)) {
+    return false;
+  }
+  *begin = static_cast<const uint8*>(data);
+  return true;
+}
+
+// Reads the `packed_length` bytes of packed varints at the current position of
+// `stream`, appending them to `list`.
+template <typename Result>
+bool ReadPackedVarints(protobuf::io::CodedInputStream* stream,
+                       uint32 packed_length, Result* list) {
+  const uint8* begin;
+  if (!PeekBytes(stream, packed_length, &begin)) return false;
+  const uint8* end = begin + packed_length;
+  const int64_t count = CountPackedVarints(begin, end);
+  if (count < 0) return false;
+  const size_t initial_size = list->size();
+  list->resize(initial_size + count);
+  if (list->size() == initial_size + count) {
+    if (!DecodePackedVarints(begin, end, list->data() + initial_size)) {
+      return false;
+    }
+  } else {
+    // The list is a `LimitedArraySlice` that is too small to hold the values,
+    // which the caller reports as an error. Decode the values that fit.
+    std::vector<int64_t> values(count);
+    if (!DecodePackedVarints(begin, end, values.data())) return false;
+    std::copy_n(values.begin(), list->size() - initial_size,
+                list->data() + initial_size);
+  }
+  return stream->Skip(packed_length);
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -303,15 +563,9 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64_t>(n));
+        if (!ReadPackedVarints(&stream, packed_length, int64_list)) {
+          return false;
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -1924,18 +2178,29 @@ inline int ParseFloatFeature(protobuf::io::CodedInputStream* stream,
           !stream->ReadVarint32(&packed_length)) {
         return -1;
       }
-      auto packed_limit = stream->PushLimit(packed_length);
-      while (!stream->ExpectAtEnd()) {
-        uint32 buffer32;
-        if (!stream->ReadLittleEndian32(&buffer32)) {
+      constexpr uint32 kNumFloatBytes = 4;
+      if (packed_length % kNumFloatBytes != 0) {
+        return -1;
+      }
+      num_elements = packed_length / kNumFloatBytes;
+      if (out == nullptr) {
+        if (!stream->Skip(packed_length)) {
           return -1;
         }
-        if (out != nullptr) {
+      } else if (port::kLittleEndian) {
+        // Copy the values straight from the serialized proto.
+        if (!stream->ReadRaw(out, packed_length)) {
+          return -1;
+        }
+      } else {
+        for (int i = 0; i < num_elements; ++i) {
+          uint32 buffer32;
+          if (!stream->ReadLittleEndian32(&buffer32)) {
+            return -1;
+          }
           *out++ = absl::bit_cast<float>(buffer32);
         }
-        num_elements++;
       }
-      stream->PopLimit(packed_limit);
     } else if (peek_tag == kFixed32Tag(1)) {
       while (!stream->ExpectAtEnd()) {
         uint32 buffer32;
@@ -1975,18 +2240,18 @@ inline int ParseInt64Feature(protobuf::io::CodedInputStream* stream,
           !stream->ReadVarint32(&packed_length)) {
         return -1;
       }
-      auto packed_limit = stream->PushLimit(packed_length);
-      while (!stream->ExpectAtEnd()) {
-        protobuf_uint64 n;  // There is no API for int64
-        if (!stream->ReadVarint64(&n)) {
-          return -1;
-        }
-        if (out != nullptr) {
-          *out++ = n;
-        }
-        num_elements++;
+      const uint8* begin;
+      if (!PeekBytes(stream, packed_length, &begin)) {
+        return -1;
+      }
+      const int64_t count = CountPackedVarints(begin, begin + packed_length);
+      if (count < 0 || count > std::numeric_limits<int>::max() ||
+          (out != nullptr &&
+           !DecodePackedVarints(begin, begin + packed_length, out)) ||
+          !stream->Skip(packed_length)) {
+        return -1;
       }
-      stream->PopLimit(packed_limit);
+      num_elements = count;
     } else if (peek_tag == kVarintTag(1)) {
       while (!stream->ExpectAtEnd()) {
         protobuf_uint64 n;  // There is no API for int64
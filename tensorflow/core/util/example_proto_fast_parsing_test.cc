@@ -15,12 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <cstdint>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -419,6 +421,121 @@ TEST(FastParse, FuzzTest) {
   }
 }
 
+// Returns a value that takes `num_bytes` bytes as a varint. Negative values
+// always take 10 bytes.
+int64_t VarintOfSize(int num_bytes, int64_t i) {
+  if (num_bytes >= 10) return -1 - i;
+  if (num_bytes == 1) return i % 64;
+  return (int64_t{1} << (7 * num_bytes - 7)) + i % 64;
+}
+
+Example ExampleWithPackedLists(int num_values, int int64_bytes) {
+  Example example;
+  auto& features = *example.mutable_features()->mutable_feature();
+  Int64List* int64_list = features[kDenseInt64Key].mutable_int64_list();
+  FloatList* float_list = features[kDenseFloatKey].mutable_float_list();
+  for (int i = 0; i < num_values; ++i) {
+    int64_list->add_value(VarintOfSize(int64_bytes, i));
+    float_list->add_value(0.5f * i);
+  }
+  return example;
+}
+
+TEST(FastParse, PackedInt64ListLengths) {
+  for (int num_values : {1, 15, 16, 17, 31, 32, 33, 100}) {
+    for (int int64_bytes : {1, 2, 5, 10}) {
+      TestCorrectness(
+          Serialize(ExampleWithPackedLists(num_values, int64_bytes)));
+    }
+  }
+}
+
+TEST(FastParse, PackedInt64ListMixedSizes) {
+  Example example;
+  Int64List* int64_list =
+      (*example.mutable_features()->mutable_feature())[kDenseInt64Key]
+          .mutable_int64_list();
+  for (int i = 0; i < 200; ++i) {
+    int64_list->add_value(VarintOfSize(i % 7 == 0 ? 1 + i % 10 : 1, i));
+  }
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, PackedInt64ListOverlongVarint) {
+  // An Int64List with a single packed 11-byte varint.
+  const string int64_list =
+      strings::StrCat("\x0a\x0b", string(10, '\x80'), "\x01");
+  const string feature = strings::StrCat("\x1a\x0d", int64_list);
+  const string entry = strings::StrCat("\x0a\x01" "a" "\x12\x0f", feature);
+  const string features = strings::StrCat("\x0a\x14", entry);
+  const string serialized = strings::StrCat("\x0a\x16", features);
+  Example example;
+  EXPECT_FALSE(example.ParseFromString(serialized));
+  EXPECT_FALSE(TestFastParse(serialized, &example));
+}
+
+TEST(FastParse, DensePackedInt64List) {
+  constexpr int kNumValues = 50;
+  const Example example = ExampleWithPackedLists(kNumValues, 3);
+  std::vector<tstring> serialized(2, Serialize(example));
+  FastParseExampleConfig config;
+  AddDenseFeature(kDenseInt64Key, DT_INT64, {kNumValues}, false, kNumValues,
+                  &config);
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  ASSERT_EQ(result.dense_values.size(), 1);
+  const auto values = result.dense_values[0].flat<int64_t>();
+  ASSERT_EQ(values.size(), 2 * kNumValues);
+  for (int i = 0; i < 2 * kNumValues; ++i) {
+    EXPECT_EQ(values(i), VarintOfSize(3, i % kNumValues));
+  }
+
+  // A dense feature too small for the list is an error.
+  FastParseExampleConfig small_config;
+  AddDenseFeature(kDenseInt64Key, DT_INT64, {kNumValues - 1}, false,
+                  kNumValues - 1, &small_config);
+  EXPECT_FALSE(
+      FastParseExample(small_config, serialized, {}, nullptr, &result).ok());
+}
+
+// Parses batches of examples holding a packed list of `state.range(0)` values
+// of `state.range(1)` varint bytes.
+void BM_ParsePackedList(::testing::benchmark::State& state, DataType dtype,
+                        const char* key) {
+  const int num_values = state.range(0);
+  constexpr int kBatchSize = 128;
+  const Example example = ExampleWithPackedLists(num_values, state.range(1));
+  std::vector<tstring> serialized(kBatchSize, Serialize(example));
+  FastParseExampleConfig config;
+  AddDenseFeature(key, dtype, {num_values}, false, num_values, &config);
+  for (auto s : state) {
+    Result result;
+    TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          kBatchSize * num_values);
+}
+
+void BM_ParsePackedInt64List(::testing::benchmark::State& state) {
+  BM_ParsePackedList(state, DT_INT64, kDenseInt64Key);
+}
+BENCHMARK(BM_ParsePackedInt64List)
+    ->ArgPair(16, 1)
+    ->ArgPair(16, 3)
+    ->ArgPair(256, 1)
+    ->ArgPair(256, 3)
+    ->ArgPair(256, 10)
+    ->ArgPair(4096, 1)
+    ->ArgPair(4096, 3);
+
+void BM_ParsePackedFloatList(::testing::benchmark::State& state) {
+  BM_ParsePackedList(state, DT_FLOAT, kDenseFloatKey);
+}
+BENCHMARK(BM_ParsePackedFloatList)
+    ->ArgPair(16, 1)
+    ->ArgPair(256, 1)
+    ->ArgPair(4096, 1);
+
 TEST(TestFastParseExample, Empty) {
   Result result;
   FastParseExampleConfig config;
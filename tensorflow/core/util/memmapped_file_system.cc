@@ -179,8 +179,17 @@ Status MemmappedFileSystem::GetChildren(const string& filename,
 Status MemmappedFileSystem::GetMatchingPaths(const string& pattern,
                                              TransactionToken* token,
                                              std::vector<string>* results) {
-  return errors::Unimplemented(
-      "memmapped format doesn't support GetMatchingPaths");
+  if (!mapped_memory_) {
+    return errors::FailedPrecondition("MemmappedEnv is not initialized");
+  }
+  results->clear();
+  for (const auto& element : directory_) {
+    if (Match(element.first, pattern)) {
+      results->push_back(element.first);
+    }
+  }
+  std::sort(results->begin(), results->end());
+  return absl::OkStatus();
 }
 
 Status MemmappedFileSystem::DeleteFile(const string& filename,
@@ -266,7 +275,8 @@ bool MemmappedFileSystem::IsMemmappedPackageFilename(const string& filename) {
 namespace {
 bool IsValidRegionChar(char c) {
   return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
-         (c >= '0' && c <= '9') || c == '_' || c == '.';
+         (c >= '0' && c <= '9') || c == '_' || c == '.' || c == '-' ||
+         c == '/';
 }
 }  // namespace
 
@@ -28,8 +28,8 @@ namespace tensorflow {
 // A file system that uses a graph saved in memmapped format by
 // MemmappedEnvWriter as a file system.
 //
-// The format supports saved tensors and protos. Tensors are saved at aligned
-// offsets.
+// The format supports saved tensors, protos and raw files. Tensors and raw
+// files are saved at aligned offsets.
 //
 // Format specification:
 // - last 8 bytes of a package is encoded offset to the directory. The encoding
@@ -44,7 +44,9 @@ namespace tensorflow {
 // Region naming:
 // Region naming is up to the application, all of them starts from
 // kMemmappedPackagePrefix. The default graph usually has name
-// kMemmappedPackageDefaultGraphDef;
+// kMemmappedPackageDefaultGraphDef; Names may contain '/', so that files of a
+// directory, e.g. the checkpoint and assets of a SavedModel, can be stored
+// under their relative paths and read through MemmappedEnv without copies.
 //
 // A "frozen" GraphDef can be converted into this format using
 // tensorflow/contrib/util/convert_graphdef_memmapped_format
@@ -15,6 +15,8 @@ limitations under the License.
 #include "tensorflow/core/util/memmapped_file_system.h"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/versions.pb.h"
@@ -116,6 +118,63 @@ TEST(MemmappedFileSystemTest, SimpleTest) {
             memmapped_env.FileExists("bla-bla-bla").code());
 }
 
+TEST(MemmappedFileSystemTest, AlignedFiles) {
+  constexpr char kIndexFileName[] =
+      "memmapped_package://variables/variables.index";
+  constexpr char kDataFileName[] =
+      "memmapped_package://variables/variables.data-00000-of-00001";
+  constexpr uint64 kPageSize = 4096;
+  const string filename = io::JoinPath(testing::TmpDir(), "memmapped_files");
+  Tensor test_tensor(DT_FLOAT, {10});
+  test::FillFn<float>(&test_tensor, [](int i) { return i; });
+  {
+    MemmappedFileSystemWriter writer;
+    TF_ASSERT_OK(writer.InitializeToFile(Env::Default(), filename));
+    TF_ASSERT_OK(writer.SaveFile("index", kIndexFileName));
+    TF_ASSERT_OK(writer.SaveFile("data", kDataFileName, kPageSize));
+    TF_ASSERT_OK(writer.SaveTensor(test_tensor, kTensor1FileName, kPageSize));
+    EXPECT_TRUE(
+        errors::IsInvalidArgument(writer.SaveFile("x", kTensor2FileName, 3)));
+    EXPECT_TRUE(
+        errors::IsInvalidArgument(writer.SaveTensor(test_tensor,
+                                                    kTensor2FileName, 2)));
+    TF_ASSERT_OK(writer.FlushAndClose());
+  }
+
+  MemmappedEnv memmapped_env(Env::Default());
+  TF_ASSERT_OK(memmapped_env.InitializeFromFile(filename));
+  std::unique_ptr<ReadOnlyMemoryRegion> index_region, data_region,
+      tensor_region;
+  TF_ASSERT_OK(memmapped_env.NewReadOnlyMemoryRegionFromFile(kIndexFileName,
+                                                             &index_region));
+  TF_ASSERT_OK(memmapped_env.NewReadOnlyMemoryRegionFromFile(kDataFileName,
+                                                             &data_region));
+  TF_ASSERT_OK(memmapped_env.NewReadOnlyMemoryRegionFromFile(kTensor1FileName,
+                                                             &tensor_region));
+  const char* start = static_cast<const char*>(index_region->data());
+  EXPECT_EQ(StringPiece(start, index_region->length()), "index");
+  const char* data = static_cast<const char*>(data_region->data());
+  EXPECT_EQ(StringPiece(data, data_region->length()), "data");
+  EXPECT_EQ((data - start) % kPageSize, 0);
+  const char* tensor = static_cast<const char*>(tensor_region->data());
+  EXPECT_EQ((tensor - start) % kPageSize, 0);
+  EXPECT_EQ(StringPiece(tensor, tensor_region->length()),
+            test_tensor.tensor_data());
+
+  // Reads return the mapped memory instead of copying to the scratch buffer.
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(memmapped_env.NewRandomAccessFile(kDataFileName, &file));
+  char scratch[4];
+  StringPiece result;
+  TF_ASSERT_OK(file->Read(0, 4, &result, scratch));
+  EXPECT_EQ(result.data(), data);
+
+  std::vector<string> paths;
+  TF_ASSERT_OK(memmapped_env.GetMatchingPaths(
+      "memmapped_package://variables/variables.*", &paths));
+  EXPECT_EQ(paths, std::vector<string>({kDataFileName, kIndexFileName}));
+}
+
 TEST(MemmappedFileSystemTest, NotInitialized) {
   MemmappedEnv memmapped_env(Env::Default());
   std::unique_ptr<ReadOnlyMemoryRegion> memory_region;
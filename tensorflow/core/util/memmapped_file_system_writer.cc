@@ -27,18 +27,30 @@ Status MemmappedFileSystemWriter::InitializeToFile(Env* env,
   return status;
 }
 
+Status MemmappedFileSystemWriter::CheckElementName(
+    const string& element_name) const {
+  if (!MemmappedFileSystem::IsWellFormedMemmappedPackageFilename(
+          element_name)) {
+    return errors::InvalidArgument(
+        "MemmappedEnvWritter: element_name is invalid: must have memmapped ",
+        "package prefix ", MemmappedFileSystem::kMemmappedPackagePrefix,
+        " and include [A-Za-z0-9_./-]");
+  }
+  return absl::OkStatus();
+}
+
 Status MemmappedFileSystemWriter::SaveTensor(const Tensor& tensor,
-                                             const string& element_name) {
+                                             const string& element_name,
+                                             uint64 alignment) {
   if (!output_file_) {
     return errors::FailedPrecondition(
         "MemmappedEnvWritter: saving tensor into not opened file");
   }
-  if (!MemmappedFileSystem::IsWellFormedMemmappedPackageFilename(
-          element_name)) {
+  TF_RETURN_IF_ERROR(CheckElementName(element_name));
+  if (alignment < Allocator::kAllocatorAlignment) {
     return errors::InvalidArgument(
-        "MemmappedEnvWritter: element_name is invalid: must have memmapped ",
-        "package prefix ", MemmappedFileSystem::kMemmappedPackagePrefix,
-        " and include [A-Za-z0-9_.]");
+        "MemmappedEnvWritter: tensor alignment ", alignment,
+        " is smaller than ", Allocator::kAllocatorAlignment);
   }
   const auto tensor_data = tensor.tensor_data();
   if (tensor_data.empty()) {
@@ -46,7 +58,7 @@ Status MemmappedFileSystemWriter::SaveTensor(const Tensor& tensor,
         "MemmappedEnvWritter: saving tensor with 0 size");
   }
   // Adds pad for correct alignment after memmapping.
-  TF_RETURN_IF_ERROR(AdjustAlignment(Allocator::kAllocatorAlignment));
+  TF_RETURN_IF_ERROR(AdjustAlignment(alignment));
   AddToDirectoryElement(element_name, tensor_data.size());
   const auto result = output_file_->Append(tensor_data);
   if (result.ok()) {
@@ -55,20 +67,35 @@ Status MemmappedFileSystemWriter::SaveTensor(const Tensor& tensor,
   return result;
 }
 
+Status MemmappedFileSystemWriter::SaveFile(StringPiece contents,
+                                           const string& element_name,
+                                           uint64 alignment) {
+  if (!output_file_) {
+    return errors::FailedPrecondition(
+        "MemmappedEnvWritter: saving file into not opened file");
+  }
+  TF_RETURN_IF_ERROR(CheckElementName(element_name));
+  // The reader requires increasing offsets, so regions can't be empty.
+  if (contents.empty()) {
+    return errors::InvalidArgument(
+        "MemmappedEnvWritter: saving file with 0 size");
+  }
+  TF_RETURN_IF_ERROR(AdjustAlignment(alignment));
+  AddToDirectoryElement(element_name, contents.size());
+  const auto result = output_file_->Append(contents);
+  if (result.ok()) {
+    output_file_offset_ += contents.size();
+  }
+  return result;
+}
+
 Status MemmappedFileSystemWriter::SaveProtobuf(
     const protobuf::MessageLite& message, const string& element_name) {
   if (!output_file_) {
     return errors::FailedPrecondition(
         "MemmappedEnvWritter: saving protobuf into not opened file");
   }
-  if (!MemmappedFileSystem::IsWellFormedMemmappedPackageFilename(
-          element_name)) {
-    return errors::InvalidArgument(
-        "MemmappedEnvWritter: element_name is invalid: must have memmapped "
-        "package prefix ",
-        MemmappedFileSystem::kMemmappedPackagePrefix,
-        " and include [A-Za-z0-9_.]");
-  }
+  TF_RETURN_IF_ERROR(CheckElementName(element_name));
   const string encoded = message.SerializeAsString();
   AddToDirectoryElement(element_name, encoded.size());
   const auto res = output_file_->Append(encoded);
@@ -110,6 +137,11 @@ Status MemmappedFileSystemWriter::FlushAndClose() {
 }
 
 Status MemmappedFileSystemWriter::AdjustAlignment(uint64 alignment) {
+  if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+    return errors::InvalidArgument(
+        "MemmappedEnvWritter: alignment must be a power of two, got ",
+        alignment);
+  }
   const uint64 alignment_rest = output_file_offset_ % alignment;
   const uint64 to_write_for_alignment =
       (alignment_rest == 0) ? 0 : alignment - (output_file_offset_ % alignment);
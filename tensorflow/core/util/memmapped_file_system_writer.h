@@ -32,14 +32,24 @@ class MemmappedFileSystemWriter {
   MemmappedFileSystemWriter() = default;
   ~MemmappedFileSystemWriter() = default;
   Status InitializeToFile(Env* env, const string& filename);
-  Status SaveTensor(const Tensor& tensor, const string& element_name);
+  // Saves the data of `tensor` at an offset that is a multiple of `alignment`,
+  // which must be a power of two and at least
+  // Allocator::kAllocatorAlignment. Page aligned tensors can be used directly
+  // by users that map or advise memory by pages.
+  Status SaveTensor(const Tensor& tensor, const string& element_name,
+                    uint64 alignment = Allocator::kAllocatorAlignment);
   Status SaveProtobuf(const protobuf::MessageLite& message,
                       const string& element_name);
+  // Saves `contents`, e.g. a file of a checkpoint, at an offset that is a
+  // multiple of `alignment`, which must be a power of two.
+  Status SaveFile(StringPiece contents, const string& element_name,
+                  uint64 alignment = Allocator::kAllocatorAlignment);
   // Writes out the directory of regions and closes the output file.
   Status FlushAndClose();
 
  private:
   Status AdjustAlignment(uint64 alignment);
+  Status CheckElementName(const string& element_name) const;
   void AddToDirectoryElement(const string& element_name, uint64 length);
   MemmappedFileSystemDirectory directory_;
   // The current offset in the file, to support alignment.
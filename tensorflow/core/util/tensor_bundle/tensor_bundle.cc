@@ -15,14 +15,20 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/base/call_once.h"
+#include "absl/crc/crc32c.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/tsl/util/byte_swap_array.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -46,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/platform/tstring.h"
@@ -76,11 +83,11 @@ static const int kBufferSize = 1024 * 1024;
 const char* const kHeaderEntryKey = "";
 
 // The size threshold for multi-threaded tensor loading.
-const int64_t kLargeTensorThreshold = static_cast<int64_t>(1) << 32;
+const int64_t kLargeTensorThreshold = static_cast<int64_t>(1) << 28;
 // Maximum number of threads to load the tensor from the file.
 const int kMaxFileReadThreads = 8;
 // Minimum size of a file section handled by each thread.
-const int64_t kMinSectionSize = static_cast<int64_t>(1) << 31;
+const int64_t kMinSectionSize = static_cast<int64_t>(1) << 26;
 
 namespace {
 
@@ -424,17 +431,106 @@ Status PadAlignment(tsl::BufferedWritableFile* out, int alignment,
   return status;
 }
 
+// Reads file[offset, offset+size) into "destination" in "num_sections"
+// sections, which are read and checksummed in parallel, and stores the
+// checksum of the whole range into "actual_crc32c". The sections but the
+// first start at offsets in the file aligned to kBufferSize, which file
+// systems serve fastest.
+Status ReadSectionsInParallel(Env* env, const string& filename, int64_t offset,
+                              int64_t size, int num_sections,
+                              char* destination, uint32* actual_crc32c) {
+  const int64_t section_size = (size + num_sections - 1) / num_sections;
+  std::vector<int64_t> section_starts(num_sections + 1, size);
+  section_starts[0] = 0;
+  for (int i = 1; i < num_sections; ++i) {
+    int64_t start = i * section_size;
+    if (section_size >= kBufferSize) {
+      start = (offset + start) / kBufferSize * kBufferSize - offset;
+    }
+    section_starts[i] = std::min(start, size);
+  }
+
+  std::vector<Status> statuses(num_sections);
+  std::vector<uint32> section_crc32cs(num_sections, 0);
+  {
+    thread::ThreadPool reader_pool(env, "restore_large_tensor", num_sections);
+    for (int i = 0; i < num_sections; ++i) {
+      const int64_t section_offset = section_starts[i];
+      const int64_t section_length = section_starts[i + 1] - section_offset;
+      if (section_length == 0) continue;
+      reader_pool.Schedule([&, i, section_offset, section_length]() {
+        std::unique_ptr<RandomAccessFile> section_reader;
+        if (auto file_status = env->NewRandomAccessFile(filename,
+                                                        &section_reader);
+            !file_status.ok()) {
+          statuses[i] = file_status;
+          return;
+        }
+        char* section_destination = destination + section_offset;
+        StringPiece sp;
+        statuses[i] = section_reader->Read(offset + section_offset,
+                                           section_length, &sp,
+                                           section_destination);
+        if (sp.data() != section_destination) {
+          memmove(section_destination, sp.data(), section_length);
+        }
+        section_crc32cs[i] = crc32c::Value(section_destination, section_length);
+      });
+    }
+    // Waits for the reads to finish.
+  }
+
+  absl::crc32c_t combined_crc32c{0};
+  for (int i = 0; i < num_sections; ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
+    combined_crc32c = absl::ConcatCrc32c(
+        combined_crc32c, absl::crc32c_t{section_crc32cs[i]},
+        section_starts[i + 1] - section_starts[i]);
+  }
+  *actual_crc32c = static_cast<uint32>(combined_crc32c);
+  return absl::OkStatus();
+}
+
+// The read-only contents of a tensor in a memory mapped data file, which is
+// kept mapped as long as the buffer is alive.
+class MemmappedTensorBuffer : public TensorBuffer {
+ public:
+  MemmappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                        uint64 offset, uint64 size)
+      : TensorBuffer(const_cast<char*>(
+                         static_cast<const char*>(region->data()) + offset)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("MemmappedTensorBuffer");
+  }
+  // Prevents the read-only buffer from being forwarded to outputs and written
+  // to.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
-    : env_(env), options_(options), prefix_(prefix), out_(nullptr), size_(0) {
+    : env_(env), options_(options), prefix_(prefix) {
   status_ = env_->HasAtomicMove(prefix_, &use_temp_file_);
   if (!status_.ok()) return;
+  if (options_.num_data_files < 1) {
+    status_ = errors::InvalidArgument("num_data_files must be >= 1 but is ",
+                                      options_.num_data_files);
+    return;
+  }
 
-  data_path_ = DataFilename(prefix_, 0, 1);
   metadata_path_ = MetaFilename(prefix_);
   if (use_temp_file_) {
-    data_path_ = strings::StrCat(data_path_, ".tempstate", random::New64());
     metadata_path_ =
         strings::StrCat(metadata_path_, ".tempstate", random::New64());
   }
@@ -444,50 +540,93 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
     return;
   }
 
-  std::unique_ptr<WritableFile> wrapper;
-  status_ = env_->NewWritableFile(data_path_, &wrapper);
-  if (!status_.ok()) return;
-  out_ = std::make_unique<tsl::BufferedWritableFile>(
-      std::move(wrapper), 8 << 20 /* 8MB write buffer */);
+  data_files_.resize(options_.num_data_files);
+  for (int i = 0; i < data_files_.size(); ++i) {
+    DataFile& data_file = data_files_[i];
+    data_file.path = DataFilename(prefix_, i, data_files_.size());
+    if (use_temp_file_) {
+      data_file.path =
+          strings::StrCat(data_file.path, ".tempstate", random::New64());
+    }
+    std::unique_ptr<WritableFile> wrapper;
+    status_ = env_->NewWritableFile(data_file.path, &wrapper);
+    if (!status_.ok()) return;
+    data_file.out = std::make_unique<tsl::BufferedWritableFile>(
+        std::move(wrapper), 8 << 20 /* 8MB write buffer */);
+    if (data_files_.size() > 1) {
+      data_file.writer = std::make_unique<thread::ThreadPool>(
+          env_, "bundle_writer", /*num_threads=*/1);
+    }
 
-  VLOG(1) << "Writing to file " << data_path_;
+    VLOG(1) << "Writing to file " << data_file.path;
+  }
 }
 
 Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   if (!status_.ok()) return status_;
   CHECK_NE(key, kHeaderEntryKey);
   const string key_string(key);
-  if (entries_.find(key_string) != entries_.end()) {
-    status_ = errors::InvalidArgument("Adding duplicate key: ", key);
-    return status_;
+
+  int shard_id = 0;
+  for (int i = 1; i < data_files_.size(); ++i) {
+    if (data_files_[i].queued_bytes < data_files_[shard_id].queued_bytes) {
+      shard_id = i;
+    }
   }
+  {
+    absl::MutexLock lock(&mu_);
+    if (entries_.find(key_string) != entries_.end()) {
+      status_ = errors::InvalidArgument("Adding duplicate key: ", key);
+      return status_;
+    }
 
-  BundleEntryProto* entry = &entries_[key_string];
-  entry->set_dtype(val.dtype());
-  val.shape().AsProto(entry->mutable_shape());
-  entry->set_shard_id(0);
-  entry->set_offset(size_);
+    BundleEntryProto* entry = &entries_[key_string];
+    entry->set_dtype(val.dtype());
+    val.shape().AsProto(entry->mutable_shape());
+    entry->set_shard_id(shard_id);
+  }
 
-  // Updates the data file.
+  DataFile& data_file = data_files_[shard_id];
+  data_file.queued_bytes += val.TotalBytes();
+  if (data_file.writer == nullptr) {
+    status_ = WriteToDataFile(key_string, val, &data_file);
+    return status_;
+  }
+  data_file.writer->Schedule([this, key_string, val, &data_file]() {
+    if (data_file.status.ok()) {
+      data_file.status = WriteToDataFile(key_string, val, &data_file);
+    }
+  });
+  return absl::OkStatus();
+}
+
+Status BundleWriter::WriteToDataFile(const string& key, const Tensor& val,
+                                     DataFile* data_file) {
+  tsl::BufferedWritableFile* out = data_file->out.get();
+  const int64_t offset = data_file->size;
   size_t data_bytes_written = 0;
   uint32 crc32c = 0;
-  out_->reset_crc32();
+  out->reset_crc32();
   if (val.dtype() == DT_STRING) {
-    status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
+    TF_RETURN_IF_ERROR(
+        WriteStringTensor(val, out, &data_bytes_written, &crc32c));
   } else if (val.dtype() == DT_VARIANT) {
-    status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
+    TF_RETURN_IF_ERROR(
+        WriteVariantTensor(val, out, &data_bytes_written, &crc32c));
   } else {
-    status_ = WriteTensor(val, out_.get(), &data_bytes_written);
-    crc32c = out_->crc32();
+    TF_RETURN_IF_ERROR(WriteTensor(val, out, &data_bytes_written));
+    crc32c = out->crc32();
   }
 
-  if (status_.ok()) {
-    entry->set_size(data_bytes_written);
-    entry->set_crc32c(crc32c::Mask(crc32c));
-    size_ += data_bytes_written;
-    status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
+  {
+    absl::MutexLock lock(&mu_);
+    BundleEntryProto& entry = entries_[key];
+    entry.set_offset(offset);
+    entry.set_size(data_bytes_written);
+    entry.set_crc32c(crc32c::Mask(crc32c));
   }
-  return status_;
+  data_file->size += data_bytes_written;
+  return PadAlignment(out, options_.data_alignment, &data_file->size);
 }
 
 Status BundleWriter::AddSlice(StringPiece full_tensor_key,
@@ -508,20 +647,23 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
   // the "slices" field of multiple metadata entries corresponding to the same
   // full tensor.
   const string full_tensor_key_string(full_tensor_key);
-  BundleEntryProto* full_entry = &entries_[full_tensor_key_string];
-  if (full_entry->dtype() != DT_INVALID) {
-    CHECK_EQ(full_entry->dtype(), slice_tensor.dtype());
-  }
-  if (full_entry->has_shape()) {
-    CHECK(TensorShape(full_entry->shape()) == full_tensor_shape);
-  }
+  {
+    absl::MutexLock lock(&mu_);
+    BundleEntryProto* full_entry = &entries_[full_tensor_key_string];
+    if (full_entry->dtype() != DT_INVALID) {
+      CHECK_EQ(full_entry->dtype(), slice_tensor.dtype());
+    }
+    if (full_entry->has_shape()) {
+      CHECK(TensorShape(full_entry->shape()) == full_tensor_shape);
+    }
 
-  // Populates dtype, shape, and slices.  Intentionally leaving out shard_id and
-  // offset, which do not make sense for this full tensor entry.
-  full_entry->set_dtype(slice_tensor.dtype());
-  full_tensor_shape.AsProto(full_entry->mutable_shape());
-  TensorSliceProto* slice_proto = full_entry->add_slices();
-  slice_spec.AsProto(slice_proto);
+    // Populates dtype, shape, and slices.  Intentionally leaving out shard_id
+    // and offset, which do not make sense for this full tensor entry.
+    full_entry->set_dtype(slice_tensor.dtype());
+    full_tensor_shape.AsProto(full_entry->mutable_shape());
+    TensorSliceProto* slice_proto = full_entry->add_slices();
+    slice_spec.AsProto(slice_proto);
+  }
 
   // The slice itself is handled by a regular Add(), which includes adding its
   // own metadata entry, and writing out the slice's values.
@@ -534,16 +676,28 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
 Status BundleWriter::Finish() {
-  if (out_) {
-    status_.Update(out_->Close());
-    out_ = nullptr;
-    if (status_.ok()) {
-      if (use_temp_file_) {
-        status_ =
-            Env::Default()->RenameFile(data_path_, DataFilename(prefix_, 0, 1));
+  bool closed_data_files = false;
+  for (DataFile& data_file : data_files_) {
+    // Waits for the writes to the data file to finish.
+    data_file.writer = nullptr;
+    if (data_file.out) {
+      status_.Update(data_file.status);
+      status_.Update(data_file.out->Close());
+      data_file.out = nullptr;
+      closed_data_files = true;
+    }
+  }
+  if (closed_data_files) {
+    for (int i = 0; i < data_files_.size(); ++i) {
+      if (status_.ok()) {
+        if (use_temp_file_) {
+          status_ = Env::Default()->RenameFile(
+              data_files_[i].path,
+              DataFilename(prefix_, i, data_files_.size()));
+        }
+      } else {
+        Env::Default()->DeleteFile(data_files_[i].path).IgnoreError();
       }
-    } else {
-      Env::Default()->DeleteFile(data_path_).IgnoreError();
     }
   }
   if (!status_.ok()) return status_;
@@ -559,7 +713,7 @@ Status BundleWriter::Finish() {
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
-    header.set_num_shards(1);
+    header.set_num_shards(data_files_.size());
     header.set_endianness(BundleHeaderProto::LITTLE);
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
@@ -569,6 +723,7 @@ Status BundleWriter::Finish() {
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
 
     // All others.
+    absl::MutexLock lock(&mu_);
     for (const auto& p : entries_) {
       builder.Add(p.first, p.second.SerializeAsString());
     }
@@ -590,9 +745,6 @@ Status BundleWriter::Finish() {
 
 // Accumulator of metadata states during a merge.
 struct MergeState {
-  // Accumulated from the header entries.
-  int num_shards = 0;
-
   // Derives "endianness" and "version" from the first bundle merged (hence the
   // "seen_first_bundle" guard).  The two fields must be the same for all
   // bundles in a merge.
@@ -635,7 +787,6 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
     Status s = ParseEntryProto(iter->key(), iter->value(), &header);
     if (!s.ok()) return CorruptFileError(s, filename, "unable to parse header");
 
-    merge_state->num_shards += header.num_shards();
     if (!merge_state->seen_first_bundle) {
       merge_state->seen_first_bundle = true;
       merge_state->endianness = header.endianness();
@@ -744,9 +895,10 @@ Status MergeBundles(Env* env, absl::Span<const tstring> prefixes,
       env->NewWritableFile(MetaFilename(merged_prefix), &merged_metadata));
   {
     table::TableBuilder builder(TableBuilderOptions(), merged_metadata.get());
-    // Header entry.
+    // Header entry. Only counts the data files which tensors were written to,
+    // as the others are not renamed.
     BundleHeaderProto header;
-    header.set_num_shards(merge.num_shards);
+    header.set_num_shards(merge.shard_ids.size());
     header.set_endianness(merge.endianness);
     *header.mutable_version() = merge.version;
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
@@ -785,7 +937,8 @@ BundleReader::BundleReader(Env* env, StringPiece prefix, Options options)
       iter_(nullptr),
       need_to_swap_bytes_(false),
       enable_multi_threading_for_testing_(
-          options.enable_multi_threading_for_testing) {
+          options.enable_multi_threading_for_testing),
+      memmap_tensors_(options.memmap_tensors) {
   if (cache_ == nullptr) {
     // Make a cache for use just by this BundleReader.
     owned_cache_ = std::make_unique<BundleCache>(env);
@@ -877,7 +1030,48 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return absl::OkStatus();
 }
 
+bool BundleReader::GetMemmappedValue(const BundleEntryProto& entry,
+                                     Tensor* val) {
+  if (!memmap_tensors_ || !DataTypeCanUseMemcpy(entry.dtype()) ||
+      need_to_swap_bytes_ || entry.size() == 0) {
+    return false;
+  }
+  const TensorShape stored_shape(entry.shape());
+  if (entry.size() !=
+      stored_shape.num_elements() * DataTypeSize(entry.dtype())) {
+    return false;
+  }
+
+  auto it = memmapped_data_.find(entry.shard_id());
+  if (it == memmapped_data_.end()) {
+    const string filename =
+        DataFilename(prefix_, entry.shard_id(), num_shards_);
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    if (Status status =
+            env_->NewReadOnlyMemoryRegionFromFile(filename, &region);
+        !status.ok()) {
+      VLOG(1) << "Reading " << filename
+              << " without memory mapping it: " << status;
+      region = nullptr;
+    }
+    it = memmapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region = it->second;
+  if (region == nullptr || entry.offset() + entry.size() > region->length() ||
+      (reinterpret_cast<uintptr_t>(region->data()) + entry.offset()) %
+              Allocator::kAllocatorAlignment !=
+          0) {
+    return false;
+  }
+  core::RefCountPtr<TensorBuffer> buffer(
+      new MemmappedTensorBuffer(region, entry.offset(), entry.size()));
+  *val = Tensor(entry.dtype(), stored_shape, std::move(buffer));
+  return true;
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
+  if (GetMemmappedValue(entry, val)) return absl::OkStatus();
+
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
   if (val->NumElements() == 0) {
@@ -923,6 +1117,8 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   if (DataTypeCanUseMemcpy(entry.dtype())) {
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
     size_t unused_bytes_read;
+    // Note that we compute the checksum *before* byte-swapping. The checksum
+    // should be on the bytes in the order they appear in the file.
     if (entry.size() > kBufferSize || enable_multi_threading_for_testing_) {
       StringPiece sp;
       if (!enable_multi_threading_for_testing_ &&
@@ -932,58 +1128,24 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
         if (sp.data() != backing_buffer) {
           memmove(backing_buffer, sp.data(), entry.size());
         }
+        actual_crc32c = crc32c::Value(backing_buffer, entry.size());
       } else {
-        int64_t section_size = kMinSectionSize;
-        int64_t thread_pool_size =
+        int64_t num_sections =
             (entry.size() + kMinSectionSize - 1) / kMinSectionSize;
-        if (thread_pool_size > kMaxFileReadThreads ||
+        if (num_sections > kMaxFileReadThreads ||
             enable_multi_threading_for_testing_) {
-          thread_pool_size = kMaxFileReadThreads;
-          section_size =
-              (entry.size() + kMaxFileReadThreads - 1) / kMaxFileReadThreads;
-        }
-
-        std::vector<Status> statuses(thread_pool_size);
-        auto reader_pool = std::make_unique<thread::ThreadPool>(
-            Env::Default(), "restore_large_tensor", thread_pool_size);
-
-        for (int i = 0; i < thread_pool_size; ++i) {
-          reader_pool->Schedule([&, i]() {
-            int64_t offset = i * section_size;
-            int64_t size = i == thread_pool_size - 1 ? entry.size() - offset
-                                                     : section_size;
-            std::unique_ptr<RandomAccessFile> section_reader = nullptr;
-            StringPiece sp;
-            if (auto file_status = env_->NewRandomAccessFile(
-                    DataFilename(prefix_, entry.shard_id(), num_shards_),
-                    &section_reader);
-                !file_status.ok()) {
-              statuses[i] = file_status;
-              return;
-            }
-
-            auto backing_buffer_current_pos = backing_buffer + offset;
-            auto status = section_reader->Read(entry.offset() + offset, size,
-                                               &sp, backing_buffer_current_pos);
-            if (sp.data() != backing_buffer_current_pos) {
-              memmove(backing_buffer_current_pos, sp.data(), size);
-            }
-            statuses[i] = std::move(status);
-          });
-        }
-        reader_pool = nullptr;  // Wait for reads to finish
-
-        for (const auto& status : statuses) {
-          TF_RETURN_IF_ERROR(status);
+          num_sections = kMaxFileReadThreads;
         }
+        TF_RETURN_IF_ERROR(ReadSectionsInParallel(
+            env_, DataFilename(prefix_, entry.shard_id(), num_shards_),
+            entry.offset(), entry.size(), num_sections, backing_buffer,
+            &actual_crc32c));
       }
     } else {
       TF_RETURN_IF_ERROR(buffered_file->ReadNBytes(entry.size(), backing_buffer,
                                                    &unused_bytes_read));
+      actual_crc32c = crc32c::Value(backing_buffer, entry.size());
     }
-    // Note that we compute the checksum *before* byte-swapping. The checksum
-    // should be on the bytes in the order they appear in the file.
-    actual_crc32c = crc32c::Value(backing_buffer, entry.size());
     if (need_to_swap_bytes_) {
       TF_RETURN_IF_ERROR(ByteSwapTensor(ret));
     }
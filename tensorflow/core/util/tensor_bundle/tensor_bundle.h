@@ -72,9 +72,11 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/function_ref.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/io/cache.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
@@ -119,6 +121,13 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // Number of data files, which are written and checksummed in parallel,
+    // each by its own thread. Each tensor is written to the data file with
+    // the fewest bytes queued.
+    // Must be >= 1. With more than 1, Add() returns before the tensor is
+    // written, so it must not be modified until Finish() returns, which also
+    // reports the errors of the writes.
+    int num_data_files{1};
   };
   BundleWriter(Env* env, absl::string_view prefix,
                const Options& options = Options());
@@ -153,16 +162,31 @@ class BundleWriter {
   Status status() const { return status_; }
 
  private:
+  struct DataFile {
+    std::string path;
+    std::unique_ptr<tsl::BufferedWritableFile> out;
+    int64_t size = 0;          // Number of bytes written into out.
+    int64_t queued_bytes = 0;  // Number of bytes added, written or not.
+    Status status;             // Status of the writes by "writer".
+    // The thread writing to the data file, if there are several of them.
+    std::unique_ptr<thread::ThreadPool> writer;
+  };
+
+  // Writes "val" to "data_file", and updates the entry of "key".
+  Status WriteToDataFile(const std::string& key, const Tensor& val,
+                         DataFile* data_file);
+
   Env* const env_;  // Not owned.
   const Options options_;
   const std::string prefix_;
   std::string metadata_path_;
-  std::string data_path_;
   bool use_temp_file_;
-  std::unique_ptr<tsl::BufferedWritableFile> out_;
-  int64_t size_;  // Number of bytes written into out_.
-  std::map<std::string, BundleEntryProto> entries_;
+  absl::Mutex mu_;
+  std::map<std::string, BundleEntryProto> entries_ TF_GUARDED_BY(mu_);
   Status status_;
+  // Destroyed first, so that the writes finish before the entries and mutex
+  // they use are destroyed.
+  std::vector<DataFile> data_files_;
 
   BundleWriter(const BundleWriter&) = delete;
   void operator=(const BundleWriter&) = delete;
@@ -212,6 +236,14 @@ class BundleReader {
 
     // For tests only.
     bool enable_multi_threading_for_testing = false;
+
+    // If true, tensors which are stored aligned, e.g. by a BundleWriter with
+    // a data_alignment of at least 64, are not copied but backed by the memory
+    // mapped data file, which stays mapped as long as they are alive. Such
+    // tensors are read-only, and their checksums are not validated. Other
+    // tensors, and all tensors on file systems which do not support memory
+    // mapping, are read as usual.
+    bool memmap_tensors = false;
   };
   BundleReader(Env* env, absl::string_view prefix, Options options);
 
@@ -322,6 +354,11 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Sets "val" to a tensor backed by the memory mapped data file if
+  // "memmap_tensors_" and the tensor described by "entry" can be, and returns
+  // whether it did.
+  bool GetMemmappedValue(const BundleEntryProto& entry, Tensor* val);
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -344,6 +381,11 @@ class BundleReader {
   // Owned InputBuffer objects. cache_ owns the underlying RandomAccessFiles.
   std::unordered_map<int32_t, io::InputBuffer*> data_;
 
+  // The memory mapped data files if "memmap_tensors_", shared with the tensors
+  // backed by them. Null for the files which can not be memory mapped.
+  std::unordered_map<int32_t, std::shared_ptr<ReadOnlyMemoryRegion>>
+      memmapped_data_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<std::string, checkpoint::TensorSliceSet*> tensor_slices_;
@@ -360,6 +402,8 @@ class BundleReader {
 
   bool enable_multi_threading_for_testing_ = false;
 
+  bool memmap_tensors_ = false;
+
   BundleReader(const BundleReader&) = delete;
   void operator=(const BundleReader&) = delete;
 };
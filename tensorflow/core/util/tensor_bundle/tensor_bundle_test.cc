@@ -24,6 +24,7 @@ limitations under the License.
 #endif  // _WIN32
 
 #include "absl/status/status.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -1151,6 +1152,26 @@ TEST(TensorBundleTest, LargeVariableLoadingTest) {
   }
 }
 
+TEST(TensorBundleTest, LargeVariableLoadingAlignedSectionsTest) {
+  // The sections of the large tensor are big enough to be aligned in the
+  // file, which the small tensor stored before it is not.
+  Tensor large(DT_FLOAT, TensorShape({2000, 2000}));
+  large.flat<float>().setRandom();
+  {
+    BundleWriter writer(Env::Default(), Prefix("foo"));
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", large));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleReader reader(Env::Default(), Prefix("foo"),
+                        /* enable_multi_threading_for_testing = */ true);
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "foo_000", Constant_2x3<float>(0));
+    Expect<float>(&reader, "foo_001", large);
+  }
+}
+
 absl::Status CreateFile(Env* env, const std::string& fname) {
   std::unique_ptr<WritableFile> file;
   TF_RETURN_IF_ERROR(env->NewWritableFile(fname, &file));
@@ -1270,6 +1291,115 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST(TensorBundleTest, MultipleDataFiles) {
+  Tensor large(DT_FLOAT, TensorShape({1000, 1000}));
+  large.flat<float>().setRandom();
+  {
+    BundleWriter::Options opts;
+    opts.num_data_files = 3;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", large));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_100x100<float>(1)));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<tstring>("foo")));
+    TF_EXPECT_OK(writer.Add("foo_003", Constant_100x100<float>(3)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  for (int i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(Env::Default()->FileExists(DataFilename(Prefix("foo"), i, 3)));
+  }
+  {
+    BundleReader reader(Env::Default(), Prefix("foo"));
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "foo_000", large);
+    Expect<float>(&reader, "foo_001", Constant_100x100<float>(1));
+    Expect<tstring>(&reader, "foo_002", Constant_2x3<tstring>("foo"));
+    Expect<float>(&reader, "foo_003", Constant_100x100<float>(3));
+  }
+}
+
+TEST(TensorBundleTest, MergeBundlesWithUnusedDataFiles) {
+  {
+    // Only 2 of the 4 data files are written to.
+    BundleWriter::Options opts;
+    opts.num_data_files = 4;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("bar"));
+    TF_EXPECT_OK(writer.Add("bar_000", Constant_2x3<float>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(MergeBundles(Env::Default(), {Prefix("foo"), Prefix("bar")},
+                            Prefix("merged")));
+  BundleReader reader(Env::Default(), Prefix("merged"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "foo_000", Constant_2x3<float>(0));
+  Expect<float>(&reader, "foo_001", Constant_2x3<float>(1));
+  Expect<float>(&reader, "bar_000", Constant_2x3<float>(2));
+}
+
+TEST(TensorBundleTest, InvalidNumDataFiles) {
+  BundleWriter::Options opts;
+  opts.num_data_files = 0;
+  BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+  EXPECT_EQ(writer.status().code(), error::INVALID_ARGUMENT);
+}
+
+bool IsMemmapped(const Tensor& tensor) {
+  TensorDescription description;
+  tensor.FillDescription(&description);
+  return description.allocation_description().allocator_name() ==
+         "MemmappedTensorBuffer";
+}
+
+TEST(TensorBundleTest, MemmappedTensors) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = 64;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant(true, TensorShape({1}))));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_100x100<float>(1)));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<tstring>("foo")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor memmapped;
+  Tensor copied;
+  {
+    BundleReader::Options options;
+    options.memmap_tensors = true;
+    BundleReader reader(Env::Default(), Prefix("foo"), options);
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.Lookup("foo_001", &memmapped));
+    TF_ASSERT_OK(reader.Lookup("foo_002", &copied));
+  }
+  // The tensor stays valid after the reader is destroyed.
+  EXPECT_TRUE(IsMemmapped(memmapped));
+  test::ExpectTensorEqual<float>(memmapped, Constant_100x100<float>(1));
+  // Strings can not be memory mapped.
+  EXPECT_FALSE(IsMemmapped(copied));
+  test::ExpectTensorEqual<tstring>(copied, Constant_2x3<tstring>("foo"));
+}
+
+TEST(TensorBundleTest, MemmappedTensorsNotAligned) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("foo"));
+    TF_EXPECT_OK(writer.Add("foo_000", Constant(true, TensorShape({1}))));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_100x100<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::Options options;
+  options.memmap_tensors = true;
+  BundleReader reader(Env::Default(), Prefix("foo"), options);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("foo_001", &val));
+  EXPECT_FALSE(IsMemmapped(val));
+  test::ExpectTensorEqual<float>(val, Constant_100x100<float>(1));
+}
+
 static void BM_BundleAlignment(::testing::benchmark::State& state) {
   {
     const int alignment = state.range(0);
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/c/eager/c_api.h"
 #include "tensorflow/c/eager/c_api_internal.h"
 #include "tensorflow/c/eager/parallel_device/parallel_device_lib.h"
+#include "tensorflow/c/eager/tfe_context_internal.h"
 #include "tensorflow/c/eager/tfe_tensorhandle_internal.h"
 #include "tensorflow/c/tf_datatype.h"
 #include "tensorflow/c/tf_status.h"
@@ -43,6 +44,8 @@ limitations under the License.
 #include "tensorflow/c/tf_tensor.h"
 #include "tensorflow/c/tf_tensor_internal.h"
 #include "xla/status_macros.h"
+#include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/core/common_runtime/eager/eager_executor.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/shape_refiner.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -57,6 +60,9 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/llvm_rtti/llvm_rtti.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/status.h"
@@ -94,18 +100,52 @@ std::vector<TensorHandlePtr> BroadcastTensorHandleToParallelTensor(
   absl::Span<const std::string> local_devices = target_mesh.local_devices();
   const int num_local_devices = local_devices.size();
 
-  std::vector<TensorHandlePtr> components;
-  components.reserve(num_local_devices);
-  for (int i = 0; i < num_local_devices; ++i) {
-    // Create tensor copies to each local devices specifie by `target_mesh`.
-    components.emplace_back(TFE_TensorHandleCopyToDevice(
-        tensor, context, local_devices[i].c_str(), status));
-    if (TF_GetCode(status) != TF_OK) {
+  std::vector<TensorHandlePtr> components(num_local_devices);
+  std::vector<Status> copy_statuses(num_local_devices);
+  // Create tensor copies to each local devices specified by `target_mesh`.
+  auto copy_to_device = [&](int i) {
+    TF_StatusPtr copy_status(TF_NewStatus(), internal::TF_StatusDeleter());
+    components[i].reset(TFE_TensorHandleCopyToDevice(
+        tensor, context, local_devices[i].c_str(), copy_status.get()));
+    copy_statuses[i] = StatusFromTF_Status(copy_status.get());
+  };
+  // Synchronous copies block until they reach the device, so they are issued
+  // concurrently from the inter-op threads of the context instead of one
+  // device after the other. Asynchronous copies are only enqueued, in order.
+  EagerContext* eager_context =
+      tensorflow::dyn_cast<EagerContext>(tensorflow::unwrap(context));
+  thread::ThreadPool* thread_pool =
+      eager_context != nullptr ? eager_context->GetThreadPool() : nullptr;
+  // Waiting on the inter-op threads from one of them could deadlock.
+  if (num_local_devices > 1 && thread_pool != nullptr &&
+      thread_pool->CurrentThreadId() < 0 &&
+      !eager_context->Executor().Async()) {
+    EagerExecutor* executor = &eager_context->Executor();
+    BlockingCounter counter(num_local_devices - 1);
+    for (int i = 1; i < num_local_devices; ++i) {
+      thread_pool->Schedule([&, i]() {
+        // The copies run under the executor of the calling thread, not under
+        // the one of the inter-op thread.
+        EagerExecutor* thread_executor = &eager_context->Executor();
+        eager_context->SetExecutorForThread(executor);
+        copy_to_device(i);
+        eager_context->SetExecutorForThread(thread_executor);
+        counter.DecrementCount();
+      });
+    }
+    copy_to_device(0);
+    counter.Wait();
+  } else {
+    for (int i = 0; i < num_local_devices; ++i) copy_to_device(i);
+  }
+
+  for (const Status& copy_status : copy_statuses) {
+    if (!copy_status.ok()) {
       TF_SetStatus(
           status, TF_INTERNAL,
           absl::StrCat(
               "Unable to copy tensor value for broadcast. Original message: ",
-              TF_Message(status))
+              copy_status.message())
               .c_str());
       return {};
     }
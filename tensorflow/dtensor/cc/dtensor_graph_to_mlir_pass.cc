@@ -16,8 +16,11 @@ limitations under the License.
 #include "tensorflow/dtensor/cc/dtensor_graph_to_mlir_pass.h"
 
 #include <memory>
+#include <string>
 #include <utility>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "mlir/IR/Builders.h"  // from @llvm-project
 #include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
@@ -36,12 +39,17 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tensorflow/utils/convert_type.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/device_util.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/error_util.h"
+#include "tensorflow/compiler/mlir/tensorflow/utils/serialize_mlir_module_utils.h"
 #include "xla/status_macros.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/dtensor/cc/constants.h"
 #include "tensorflow/dtensor/cc/dtensor_utils.h"
@@ -52,6 +60,14 @@ limitations under the License.
 #include "tsl/platform/statusor.h"
 
 namespace tensorflow {
+namespace {
+
+std::string PersistentCachePath(const std::string& cache_dir, Fprint128 key) {
+  return io::JoinPath(
+      cache_dir, absl::StrCat("spmd_", key.high64, "_", key.low64, ".mlir"));
+}
+
+}  // namespace
 
 DTensorMlirPassRunner::DTensorMlirPassRunner()
     : pass_manager_(&context_), logging_enabled_(false) {
@@ -73,6 +89,17 @@ DTensorMlirPassRunner::DTensorMlirPassRunner()
   // Creates a pipeline that include each DTensor related passes.
   mlir::TF::StandardPipelineOptions pipeline_options;
   dtensor::CreateDTensorMLIRPass(pipeline_options, &pass_manager_);
+
+  const std::string cache_dir = dtensor::SpmdExpansionCacheDir();
+  if (!cache_dir.empty()) {
+    Status status = Env::Default()->RecursivelyCreateDir(cache_dir);
+    if (status.ok()) {
+      persistent_cache_dir_ = cache_dir;
+    } else {
+      LOG(WARNING) << "SPMD expansion cache in " << cache_dir
+                   << " is disabled: " << status;
+    }
+  }
 }
 
 absl::StatusOr<mlir::OwningOpRef<mlir::ModuleOp>>
@@ -141,7 +168,71 @@ DTensorMlirPassRunner::ImportGraphToMlir(
   return module_ref;
 }
 
+Fprint128 DTensorMlirPassRunner::PersistentCacheKey(
+    mlir::ModuleOp module) const {
+  Fprint128 key = Fingerprint128(SerializeMlirModule(module));
+  // The DTensor flags that change the pipeline but are not attributes of the
+  // module.
+  const std::string flags = absl::StrCat(
+      TF_VERSION_STRING, ";", TF_GRAPH_DEF_VERSION, ";",
+      dtensor::LayoutPropagationMaxSteps(), ";",
+      dtensor::EnableMixedPrecisionReduce(), ";",
+      dtensor::DoNotFuseReduceScatter(), ";",
+      dtensor::ReduceInBfloat16MaxGroupSize(), ";",
+      dtensor::LowerCollectiveGatherToCollectiveGatherV2(), ";",
+      dtensor::EnableAllToAllForRelayout(), ";",
+      dtensor::EnableMultiDeviceMode(), ";",
+      absl::StrJoin(dtensor::ReplicatedSpmdAsDefaultFlags(), ";"));
+  return FingerprintCat128(key, Fingerprint128(flags));
+}
+
+bool DTensorMlirPassRunner::LoadFromPersistentCache(Fprint128 key,
+                                                    mlir::ModuleOp module) {
+  const std::string path = PersistentCachePath(persistent_cache_dir_, key);
+  Env* env = Env::Default();
+  if (!env->FileExists(path).ok()) return false;
+  std::string serialized;
+  mlir::OwningOpRef<mlir::ModuleOp> cached;
+  Status status = ReadFileToString(env, path, &serialized);
+  if (status.ok()) {
+    status = DeserializeMlirModule(serialized, &context_, &cached);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Ignoring SPMD expansion cache entry " << path << ": "
+                 << status;
+    return false;
+  }
+  module.getBodyRegion().takeBody(cached->getBodyRegion());
+  module->setAttrs(cached->getAttrDictionary());
+  VLOG(1) << "Loaded SPMD expansion from " << path;
+  return true;
+}
+
+void DTensorMlirPassRunner::SaveToPersistentCache(Fprint128 key,
+                                                  mlir::ModuleOp module) {
+  const std::string path = PersistentCachePath(persistent_cache_dir_, key);
+  // Other processes may read the entry concurrently, so it is written to a
+  // temporary file first.
+  const std::string tmp_path = absl::StrCat(path, ".tmp", random::New64());
+  Env* env = Env::Default();
+  Status status = WriteStringToFile(env, tmp_path, SerializeMlirModule(module));
+  if (status.ok()) status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    LOG(WARNING) << "Could not write SPMD expansion cache entry " << path
+                 << ": " << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+}
+
 Status DTensorMlirPassRunner::Run(mlir::ModuleOp module) {
+  Fprint128 persistent_cache_key;
+  if (!persistent_cache_dir_.empty()) {
+    persistent_cache_key = PersistentCacheKey(module);
+    if (LoadFromPersistentCache(persistent_cache_key, module)) {
+      return absl::OkStatus();
+    }
+  }
+
   // Executes and collects results from the passes.
   mlir::StatusScopedDiagnosticHandler diag_handler(&context_);
 
@@ -152,6 +243,10 @@ Status DTensorMlirPassRunner::Run(mlir::ModuleOp module) {
   TF_RETURN_IF_ERROR(diag_handler.ConsumeStatus());
 
   if (logging_enabled_) pass_manager_.getContext()->enableMultithreading();
+
+  if (!persistent_cache_dir_.empty()) {
+    SaveToPersistentCache(persistent_cache_key, module);
+  }
   return absl::OkStatus();
 }
 
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_DTENSOR_CC_DTENSOR_GRAPH_TO_MLIR_PASS_H_
 
 #include <memory>
+#include <string>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
@@ -41,10 +42,22 @@ class DTensorMlirPassRunner {
       const FunctionLibraryDefinition& flib_def, const Graph& graph,
       Fprint128 cache_key);
 
-  // Transforms input MLIR module with DTensor Pass pipeline.
+  // Transforms input MLIR module with DTensor Pass pipeline. If
+  // DTENSOR_SPMD_EXPANSION_CACHE_DIR is set, the transformed modules are
+  // cached there, keyed by the input module, the DTensor flags and the
+  // TensorFlow version, so later processes skip the pipeline.
   Status Run(mlir::ModuleOp module);
 
  private:
+  friend class DTensorMlirPassRunnerTest;
+
+  // Returns the key of `module` in the persistent cache.
+  Fprint128 PersistentCacheKey(mlir::ModuleOp module) const;
+  // Replaces `module` with the cached transformation of it, if any. Returns
+  // whether it was found.
+  bool LoadFromPersistentCache(Fprint128 key, mlir::ModuleOp module);
+  void SaveToPersistentCache(Fprint128 key, mlir::ModuleOp module);
+
   // N.B. op_registration_ must be initialized before context/pass-manager to
   // ensure DTensor operations are available during optimization passes.
   bool op_registration_ = mlir::TF::RegisterDTensorTFOps();
@@ -52,6 +65,9 @@ class DTensorMlirPassRunner {
   mlir::PassManager pass_manager_;
 
   bool logging_enabled_;
+
+  // Empty if the persistent cache is disabled.
+  std::string persistent_cache_dir_;
 };
 
 }  // namespace tensorflow
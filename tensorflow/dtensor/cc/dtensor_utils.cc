@@ -21,13 +21,28 @@ limitations under the License.
 #include <vector>
 
 #include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_split.h"
 #include "xla/tsl/util/env_var.h"
 #include "tensorflow/core/platform/logging.h"
 
+#ifndef _WIN32
+extern "C" {
+
+extern char** environ;
+
+}  // extern "C"
+#endif  // _WIN32
+
 namespace tensorflow {
 namespace dtensor {
+namespace {
+
+constexpr char kReplicatedSpmdAsDefaultPrefix[] =
+    "DTENSOR_ENABLE_REPLICATED_SPMD_AS_DEFAULT_";
+
+}  // namespace
 
 // LINT.IfChange
 int ClientId() {
@@ -129,13 +144,29 @@ bool EnableReplicatedSpmdAsDefault(const std::string& op_name) {
   //
   // For example, to enroll tf.Mod, set
   //   DTENSOR_ENABLE_REPLICATED_SPMD_AS_DEFAULT_TF.MOD = 1
-  std::string env_name = "DTENSOR_ENABLE_REPLICATED_SPMD_AS_DEFAULT_" +
-                         absl::AsciiStrToUpper(op_name);
+  std::string env_name =
+      kReplicatedSpmdAsDefaultPrefix + absl::AsciiStrToUpper(op_name);
   char* dtensor_enable_replicated_spmd_as_default =
       std::getenv(env_name.c_str());
   return dtensor_enable_replicated_spmd_as_default != nullptr;
 }
 
+std::vector<std::string> ReplicatedSpmdAsDefaultFlags() {
+#ifdef _WIN32
+  char** env = _environ;
+#else
+  char** env = environ;
+#endif  // _WIN32
+  std::vector<std::string> flags;
+  for (; env != nullptr && *env != nullptr; ++env) {
+    if (absl::StartsWith(*env, kReplicatedSpmdAsDefaultPrefix)) {
+      flags.push_back(*env);
+    }
+  }
+  std::sort(flags.begin(), flags.end());
+  return flags;
+}
+
 bool EnableAllToAllForRelayout() {
   // Whether to use all-to-all collective for relayout when possible.
   static bool is_enabled = [] {
@@ -182,5 +213,12 @@ bool EnableMultiDeviceMode() {
       "DTENSOR_ENABLE_MULTI_DEVICE_EXPANSION", false, &multi_device_mode);
   return status.ok() && multi_device_mode;
 }
+
+std::string SpmdExpansionCacheDir() {
+  std::string cache_dir;
+  absl::Status status = tsl::ReadStringFromEnvVar(
+      "DTENSOR_SPMD_EXPANSION_CACHE_DIR", "", &cache_dir);
+  return status.ok() ? cache_dir : "";
+}
 }  // namespace dtensor
 }  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_DTENSOR_CC_DTENSOR_UTILS_H_
 
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 
@@ -63,6 +64,10 @@ bool LowerCollectiveGatherToCollectiveGatherV2();
 // implementation to default to the ReplicatedOpSpmdExpander.
 bool EnableReplicatedSpmdAsDefault(const std::string& op_name);
 
+// Returns the DTENSOR_ENABLE_REPLICATED_SPMD_AS_DEFAULT_* environment variables
+// that are set, as sorted "NAME=VALUE" strings.
+std::vector<std::string> ReplicatedSpmdAsDefaultFlags();
+
 // Returns whether to use all-to-all collective for relayout when possible.
 bool EnableAllToAllForRelayout();
 
@@ -86,6 +91,11 @@ int AllReduceCombineOptimizationTopologicalDistance();
 
 // Returns whether to perform multi-device expansion.
 bool EnableMultiDeviceMode();
+
+// Returns the directory of the persistent cache of SPMD expanded modules, or
+// an empty string if the cache is disabled. Set with
+// DTENSOR_SPMD_EXPANSION_CACHE_DIR.
+std::string SpmdExpansionCacheDir();
 }  // namespace dtensor
 }  // namespace tensorflow
 
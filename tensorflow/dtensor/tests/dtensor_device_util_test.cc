@@ -0,0 +1,128 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/dtensor/cc/dtensor_device_util.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "tensorflow/c/c_api_experimental.h"
+#include "tensorflow/c/eager/c_api.h"
+#include "tensorflow/c/eager/c_api_experimental.h"
+#include "tensorflow/c/eager/c_api_test_util.h"
+#include "tensorflow/c/eager/tfe_context_internal.h"
+#include "tensorflow/c/tf_status.h"
+#include "tensorflow/c/tf_tensor.h"
+#include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/dtensor/cc/tensor_layout.h"
+
+namespace tensorflow {
+namespace dtensor {
+namespace {
+
+constexpr int kNumDevices = 4;
+
+std::string CpuDevice(int i) {
+  return absl::StrCat("/job:localhost/replica:0/task:0/device:CPU:", i);
+}
+
+Mesh CpuMesh() {
+  std::vector<std::int64_t> device_ids;
+  std::vector<std::string> devices;
+  for (int i = 0; i < kNumDevices; ++i) {
+    device_ids.push_back(i);
+    devices.push_back(CpuDevice(i));
+  }
+  return Mesh::CreateMesh("CpuMesh", /*dim_names=*/{"x"},
+                          /*mesh_shape=*/{kNumDevices}, device_ids, devices,
+                          device_ids, devices, /*use_xla_spmd=*/false);
+}
+
+// Broadcasts a scalar to a mesh of CPU devices, with the context and the
+// executor of the calling thread being synchronous or asynchronous.
+class BroadcastTest
+    : public ::testing::TestWithParam<std::tuple<bool, bool>> {
+ protected:
+  bool async_context() const { return std::get<0>(GetParam()); }
+  bool async_thread_executor() const { return std::get<1>(GetParam()); }
+};
+
+TEST_P(BroadcastTest, CopiesToEveryLocalDevice) {
+  std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> status(
+      TF_NewStatus(), TF_DeleteStatus);
+  std::unique_ptr<TFE_ContextOptions, decltype(&TFE_DeleteContextOptions)> opts(
+      TFE_NewContextOptions(), TFE_DeleteContextOptions);
+  std::unique_ptr<TF_Buffer, decltype(&TF_DeleteBuffer)> config(
+      TF_CreateConfig(
+          /*enable_xla_compilation=*/false,
+          /*gpu_memory_allow_growth=*/true, /*num_cpu_devices=*/kNumDevices),
+      TF_DeleteBuffer);
+  TFE_ContextOptionsSetConfig(opts.get(), config->data, config->length,
+                              status.get());
+  TFE_ContextOptionsSetAsync(opts.get(), async_context());
+  std::unique_ptr<TFE_Context, decltype(&TFE_DeleteContext)> context(
+      TFE_NewContext(opts.get(), status.get()), TFE_DeleteContext);
+  ASSERT_EQ(TF_GetCode(status.get()), TF_OK) << TF_Message(status.get());
+
+  std::unique_ptr<TFE_Executor, decltype(&TFE_DeleteExecutor)>
+      default_executor(TFE_ContextGetExecutorForThread(context.get()),
+                       TFE_DeleteExecutor);
+  std::unique_ptr<TFE_Executor, decltype(&TFE_DeleteExecutor)> executor(
+      TFE_NewExecutor(async_thread_executor(),
+                      /*enable_streaming_enqueue=*/true,
+                      /*in_flight_nodes_limit=*/0),
+      TFE_DeleteExecutor);
+  TFE_ContextSetExecutorForThread(context.get(), executor.get());
+  EagerExecutor* caller_executor =
+      &tensorflow::unwrap(context.get())->Executor();
+
+  std::unique_ptr<TFE_TensorHandle, decltype(&TFE_DeleteTensorHandle)> scalar(
+      TestScalarTensorHandle(context.get(), 3.0f), TFE_DeleteTensorHandle);
+  std::unique_ptr<TensorWithLayoutTf> broadcast = TensorWithLayoutTf::Broadcast(
+      context.get(), scalar.get(), CpuMesh(), status.get());
+  ASSERT_EQ(TF_GetCode(status.get()), TF_OK) << TF_Message(status.get());
+  // Broadcasting does not change the executor of the calling thread.
+  EXPECT_EQ(&tensorflow::unwrap(context.get())->Executor(), caller_executor);
+
+  ASSERT_EQ(broadcast->num_tensors(), kNumDevices);
+  for (int i = 0; i < kNumDevices; ++i) {
+    TFE_TensorHandle* component = broadcast->get_tensor(i);
+    EXPECT_EQ(TFE_TensorHandleDeviceName(component, status.get()),
+              CpuDevice(i));
+    std::unique_ptr<TF_Tensor, decltype(&TF_DeleteTensor)> value(
+        TFE_TensorHandleResolve(component, status.get()), TF_DeleteTensor);
+    ASSERT_EQ(TF_GetCode(status.get()), TF_OK) << TF_Message(status.get());
+    EXPECT_EQ(*static_cast<float*>(TF_TensorData(value.get())), 3.0f);
+  }
+
+  broadcast.reset();
+  scalar.reset();
+  TFE_ExecutorWaitForAllPendingNodes(executor.get(), status.get());
+  ASSERT_EQ(TF_GetCode(status.get()), TF_OK) << TF_Message(status.get());
+  TFE_ContextSetExecutorForThread(context.get(), default_executor.get());
+}
+
+INSTANTIATE_TEST_SUITE_P(Executors, BroadcastTest,
+                         ::testing::Combine(::testing::Bool(),
+                                            ::testing::Bool()));
+
+}  // namespace
+}  // namespace dtensor
+}  // namespace tensorflow
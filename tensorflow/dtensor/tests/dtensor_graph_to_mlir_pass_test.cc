@@ -0,0 +1,112 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/dtensor/cc/dtensor_graph_to_mlir_pass.h"
+
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "mlir/IR/Builders.h"  // from @llvm-project
+#include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
+#include "mlir/IR/BuiltinOps.h"  // from @llvm-project
+#include "mlir/IR/Location.h"  // from @llvm-project
+#include "mlir/IR/OwningOpRef.h"  // from @llvm-project
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+class DTensorMlirPassRunnerTest : public ::testing::Test {
+ protected:
+  static constexpr char kReplicatedSpmdFlag[] =
+      "DTENSOR_ENABLE_REPLICATED_SPMD_AS_DEFAULT_TF.MOD";
+
+  void SetUp() override {
+    setenv("DTENSOR_SPMD_EXPANSION_CACHE_DIR",
+           io::JoinPath(testing::TmpDir(), "spmd_expansion_cache").c_str(),
+           /*overwrite=*/1);
+    unsetenv(kReplicatedSpmdFlag);
+    runner_ = std::make_unique<DTensorMlirPassRunner>();
+  }
+
+  void TearDown() override {
+    unsetenv("DTENSOR_SPMD_EXPANSION_CACHE_DIR");
+    unsetenv(kReplicatedSpmdFlag);
+  }
+
+  // Returns an empty module with the attribute "test" set to `value`.
+  mlir::OwningOpRef<mlir::ModuleOp> CreateModule(const std::string& value) {
+    mlir::OwningOpRef<mlir::ModuleOp> module =
+        mlir::ModuleOp::create(mlir::UnknownLoc::get(&runner_->context_));
+    if (!value.empty()) {
+      module.get()->setAttr(
+          "test", mlir::StringAttr::get(&runner_->context_, value));
+    }
+    return module;
+  }
+
+  Fprint128 CacheKey(mlir::ModuleOp module) {
+    return runner_->PersistentCacheKey(module);
+  }
+
+  bool Load(Fprint128 key, mlir::ModuleOp module) {
+    return runner_->LoadFromPersistentCache(key, module);
+  }
+
+  void Save(Fprint128 key, mlir::ModuleOp module) {
+    runner_->SaveToPersistentCache(key, module);
+  }
+
+  std::unique_ptr<DTensorMlirPassRunner> runner_;
+};
+
+TEST_F(DTensorMlirPassRunnerTest, LoadsSavedModule) {
+  mlir::OwningOpRef<mlir::ModuleOp> module = CreateModule("expanded");
+  const Fprint128 key = CacheKey(*module);
+  Save(key, *module);
+
+  mlir::OwningOpRef<mlir::ModuleOp> loaded = CreateModule("");
+  ASSERT_TRUE(Load(key, *loaded));
+  EXPECT_EQ(loaded.get()->getAttr("test"), module.get()->getAttr("test"));
+}
+
+TEST_F(DTensorMlirPassRunnerTest, KeyCoversModule) {
+  EXPECT_FALSE(CacheKey(*CreateModule("a")) == CacheKey(*CreateModule("b")));
+}
+
+TEST_F(DTensorMlirPassRunnerTest, KeyCoversReplicatedSpmdFlags) {
+  mlir::OwningOpRef<mlir::ModuleOp> module = CreateModule("expanded");
+  const Fprint128 key = CacheKey(*module);
+  Save(key, *module);
+
+  setenv(kReplicatedSpmdFlag, "1", /*overwrite=*/1);
+  const Fprint128 flag_key = CacheKey(*module);
+  EXPECT_FALSE(flag_key == key);
+  mlir::OwningOpRef<mlir::ModuleOp> loaded = CreateModule("");
+  EXPECT_FALSE(Load(flag_key, *loaded));
+
+  setenv(kReplicatedSpmdFlag, "0", /*overwrite=*/1);
+  EXPECT_FALSE(CacheKey(*module) == flag_key);
+
+  unsetenv(kReplicatedSpmdFlag);
+  EXPECT_TRUE(CacheKey(*module) == key);
+  EXPECT_TRUE(Load(key, *loaded));
+}
+
+}  // namespace tensorflow
@@ -33,6 +33,8 @@ constexpr int32_t kLastActiveNodeUndefined =
     std::numeric_limits<int32_t>::max();
 constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 constexpr int32_t kScalarTensorBytes = 4;
+// Maximum number of plans in `cached_plans_`.
+constexpr size_t kMaxCachedPlans = 8;
 
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
@@ -211,6 +213,8 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   nodes_to_tensors_.clear();
   nodes_to_tensors_.resize(
       std::max(graph_info_->num_execution_nodes(), (size_t)1), {});
+  // The graph or the lifetimes of its tensors may have changed.
+  cached_plans_.clear();
 
   // Keeps track of references to each tensor.
   refcounts_.assign(num_tensors, 0);
@@ -232,7 +236,9 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       return kTfLiteOk;
     }
     TF_LITE_ENSURE(context_, dealloc_node_[tensor] == kNodeNotAssigned);
-    dealloc_node_[tensor] = node;
+    // The memory is only reused once the nodes which may run concurrently with
+    // the last one using the tensor are done.
+    dealloc_node_[tensor] = graph_info_->last_concurrent_node(node);
     return kTfLiteOk;
   };
 
@@ -355,18 +361,52 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
       alloc_node_[tensor_index] = i;
       nodes_to_tensors_[i].insert(tensor_index);
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = graph_info_->last_concurrent_node(i);
       }
     }
   }
 
+  // Planning all the nodes after `ResetAllocations` only depends on the
+  // sizes and lifetimes of the tensors, so a plan calculated before for the
+  // same ones is reused as is.
+  const bool plans_all_nodes = first_node == 0 &&
+                               last_node >= num_execution_nodes - 1 &&
+                               last_active_node_ == kLastActiveNodeUndefined;
+  TfLiteTensor* tensors = graph_info_->tensors();
+  CachedPlan plan;
+  if (plans_all_nodes) {
+    plan = CreatePlanKey();
+    auto it = std::find_if(cached_plans_.begin(), cached_plans_.end(),
+                           [&plan](const CachedPlan& cached_plan) {
+                             return SamePlanKey(plan, cached_plan);
+                           });
+    if (it != cached_plans_.end()) {
+      std::rotate(it, it + 1, cached_plans_.end());
+      RestorePlan(cached_plans_.back());
+      bool arena_reallocated = false;
+      TF_LITE_ENSURE_STATUS(Commit(&arena_reallocated));
+      for (int i = 0; i < static_cast<int>(num_tensors); ++i) {
+        TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(i, tensors));
+      }
+      last_active_node_ = last_node;
+      return kTfLiteOk;
+    }
+  }
+
   std::vector<int32_t> tensors_allocated;
   TF_LITE_ENSURE_STATUS(
       CalculateAllocations(first_node, last_node, &tensors_allocated));
   bool arena_reallocated = false;
   TF_LITE_ENSURE_STATUS(Commit(&arena_reallocated));
+  if (plans_all_nodes) {
+    plan.allocs = allocs_;
+    plan.actual_tensor_id = actual_tensor_id_;
+    if (cached_plans_.size() == kMaxCachedPlans) {
+      cached_plans_.erase(cached_plans_.begin());
+    }
+    cached_plans_.push_back(std::move(plan));
+  }
 
-  TfLiteTensor* tensors = graph_info_->tensors();
   if (arena_reallocated) {
     for (int i = 0; i < static_cast<int>(num_tensors); ++i) {
       TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(i, tensors));
@@ -381,6 +421,47 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   return kTfLiteOk;
 }
 
+ArenaPlanner::CachedPlan ArenaPlanner::CreatePlanKey() const {
+  const size_t num_tensors = graph_info_->num_tensors();
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  CachedPlan plan;
+  plan.allocation_types.reserve(num_tensors);
+  plan.bytes.reserve(num_tensors);
+  for (size_t i = 0; i < num_tensors; ++i) {
+    const TfLiteAllocationType type = tensors[i].allocation_type;
+    plan.allocation_types.push_back(type);
+    plan.bytes.push_back(
+        type == kTfLiteArenaRw || type == kTfLiteArenaRwPersistent
+            ? tensors[i].bytes
+            : 0);
+  }
+  plan.alloc_node = alloc_node_;
+  plan.dealloc_node = dealloc_node_;
+  return plan;
+}
+
+bool ArenaPlanner::SamePlanKey(const CachedPlan& a, const CachedPlan& b) {
+  return a.allocation_types == b.allocation_types && a.bytes == b.bytes &&
+         a.alloc_node == b.alloc_node && a.dealloc_node == b.dealloc_node;
+}
+
+void ArenaPlanner::RestorePlan(const CachedPlan& plan) {
+  allocs_ = plan.allocs;
+  actual_tensor_id_ = plan.actual_tensor_id;
+  std::vector<ArenaAllocWithUsageInterval> arena_allocs;
+  std::vector<ArenaAllocWithUsageInterval> persistent_allocs;
+  for (size_t i = 0; i < allocs_.size(); ++i) {
+    if (allocs_[i].size == 0) continue;
+    if (plan.allocation_types[i] == kTfLiteArenaRw) {
+      arena_allocs.push_back(allocs_[i]);
+    } else if (plan.allocation_types[i] == kTfLiteArenaRwPersistent) {
+      persistent_allocs.push_back(allocs_[i]);
+    }
+  }
+  arena_.RestorePlan(arena_allocs);
+  persistent_arena_.RestorePlan(persistent_allocs);
+}
+
 TfLiteStatus ArenaPlanner::ReleaseNonPersistentMemory() {
   // Clear non-persistent arena's buffer.
   TF_LITE_ENSURE_STATUS(arena_.ReleaseBuffer());
@@ -413,7 +494,7 @@ TfLiteStatus ArenaPlanner::AcquireNonPersistentMemory() {
 }
 
 bool ArenaPlanner::HasNonPersistentMemory() {
-  return has_nonpersistent_memory_;
+  return has_nonpersistent_memory_ && !arena_.SharedBufferMoved();
 }
 
 void ArenaPlanner::DumpDebugInfo(const std::vector<int>& execution_plan) const {
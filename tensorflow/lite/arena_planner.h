@@ -72,6 +72,15 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // Allocates the non-persistent tensors in `shared_buffer`, which is shared
+  // with planners of subgraphs which are never invoked concurrently with this
+  // one. This must be called before `ExecuteAllocations`. Once another planner
+  // moved the buffer, `HasNonPersistentMemory` returns false until
+  // `AcquireNonPersistentMemory` resolves the tensors again.
+  void SetSharedArenaBuffer(SharedArenaBuffer* shared_buffer) {
+    arena_.SetSharedBuffer(shared_buffer);
+  }
+
  private:
   // Check whether the input tensor's memory may be shared the output tensor.
   // tensor_changed: true if the output tensor modifies the tensor data. For
@@ -120,6 +129,29 @@ class ArenaPlanner : public MemoryPlanner {
   // Return the index of the tensor owing `tensor_index's` buffer.
   int FindSharedTensor(int tensor_index);
 
+  // An allocation plan of all the nodes, along with the tensor sizes and
+  // lifetimes it was calculated for.
+  struct CachedPlan {
+    std::vector<TfLiteAllocationType> allocation_types;
+    // Zero for tensors which are not allocated in an arena.
+    std::vector<size_t> bytes;
+    std::vector<int32_t> alloc_node;
+    std::vector<int32_t> dealloc_node;
+
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+    // NOLINTNEXTLINE - absl::flat_hash_map increases binary size by 106kB.
+    std::unordered_map<int32_t, int32_t> actual_tensor_id;
+  };
+
+  // Returns a plan without allocations for the current tensors.
+  CachedPlan CreatePlanKey() const;
+
+  // Returns true if `a` and `b` were calculated for the same tensors.
+  static bool SamePlanKey(const CachedPlan& a, const CachedPlan& b);
+
+  // Replaces the allocations of both arenas with those of `plan`.
+  void RestorePlan(const CachedPlan& plan);
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -166,6 +198,12 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Store number of references to each tensor.
   std::vector<int> refcounts_;
+
+  // Plans of all the nodes for the most recently used tensor sizes, so that
+  // models whose inputs alternate between a few shapes don't search for
+  // offsets again every time they are resized. The most recently used plan
+  // is last.
+  std::vector<CachedPlan> cached_plans_;
 };
 
 }  // namespace tflite
@@ -370,6 +370,56 @@ TEST_F(ArenaPlannerTest, AllocsCorrectlyReset) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, AlternatingTensorSizes) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<std::ptrdiff_t> small_offsets;
+  for (int i = 0; i <= 5; ++i) small_offsets.push_back(GetOffset(i));
+
+  // Plans for other sizes place the tensors elsewhere.
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  ResetAllocations();
+  tensors[0].bytes = 1000;
+  tensors[5].bytes = 2000;
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<std::ptrdiff_t> large_offsets;
+  for (int i = 0; i <= 5; ++i) large_offsets.push_back(GetOffset(i));
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(0));
+  EXPECT_NE(large_offsets, small_offsets);
+
+  // Going back to the first sizes reuses their plan.
+  ResetAllocations();
+  tensors[0].bytes = 3;
+  tensors[5].bytes = 18;
+  Execute(0, graph.nodes().size() - 1);
+  for (int i = 0; i <= 5; ++i) {
+    EXPECT_EQ(GetOffset(i), small_offsets[i]) << "tensor " << i;
+  }
+  EXPECT_EQ(GetOffset(5), 12);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(4));
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(4));
+  EXPECT_EQ(GetOffset(1), 4);
+
+  // And back to the second ones.
+  ResetAllocations();
+  tensors[0].bytes = 1000;
+  tensors[5].bytes = 2000;
+  Execute(0, graph.nodes().size() - 1);
+  for (int i = 0; i <= 5; ++i) {
+    EXPECT_EQ(GetOffset(i), large_offsets[i]) << "tensor " << i;
+  }
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphInputsPreserved) {
   TestGraph graph({0, 1},
                   {
@@ -63,6 +63,16 @@ class Profiler {
     TELEMETRY_DELEGATE_EVENT = 1 << 7,
     // A telemetry event that reports delegate settings.
     TELEMETRY_DELEGATE_REPORT_SETTINGS = 1 << 8,
+
+    // The event reports memory allocated on behalf of an operator while it was
+    // prepared or invoked, e.g. growth of the tensor arena or (re)allocation of
+    // a kTfLiteDynamic output. It's recorded via AddEvent: `metric` is the
+    // number of bytes, `event_metadata1` the index of the operator node and
+    // `event_metadata2` the index of the subgraph. The tag names the kind of
+    // allocation. Delegates can report their own allocations with
+    // TFLITE_ADD_OPERATOR_MEMORY_EVENT, which attributes them to the delegate
+    // kernel node being invoked.
+    OPERATOR_MEMORY_EVENT = 1 << 9,
   };
 
   virtual ~Profiler() {}
@@ -236,6 +246,17 @@ class ScopedRuntimeInstrumentationProfile {
   tflite::ScopedDelegateProfiledOperatorProfile TFLITE_VARNAME_UNIQ(    \
       _profile_, __COUNTER__)((profiler), (tag), (node_index))
 
+// Reports `bytes` of memory allocated by the operator node currently being
+// invoked in the subgraph that owns `profiler` (i.e. `context->profiler`).
+#define TFLITE_ADD_OPERATOR_MEMORY_EVENT(profiler, tag, bytes)             \
+  do {                                                                     \
+    if (profiler) {                                                        \
+      profiler->AddEvent(tag, Profiler::EventType::OPERATOR_MEMORY_EVENT,  \
+                         bytes, /*event_metadata1=*/-1,                    \
+                         /*event_metadata2=*/0);                           \
+    }                                                                      \
+  } while (false);
+
 #define TFLITE_ADD_RUNTIME_INSTRUMENTATION_EVENT(                          \
     profiler, tag, event_metadata1, event_metadata2)                       \
   do {                                                                     \
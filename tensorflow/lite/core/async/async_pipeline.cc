@@ -0,0 +1,83 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/core/async/async_pipeline.h"
+
+#include <functional>
+#include <utility>
+
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+
+namespace tflite {
+namespace async {
+
+AsyncPipeline::AsyncPipeline(AsyncSignatureRunner* runner, int depth,
+                             CompletionCallback on_complete)
+    : runner_(runner), on_complete_(std::move(on_complete)) {
+  slots_.resize(depth > 0 ? depth : 1);
+  for (Slot& slot : slots_) {
+    slot.task = runner_->CreateTask();
+  }
+}
+
+AsyncPipeline::~AsyncPipeline() {
+  Flush();
+  for (Slot& slot : slots_) {
+    if (slot.task != nullptr) {
+      runner_->Finish(slot.task);
+    }
+  }
+}
+
+TfLiteStatus AsyncPipeline::Complete(Slot& slot) {
+  if (!slot.in_flight) return kTfLiteOk;
+  const TfLiteStatus status = runner_->Wait(slot.task);
+  slot.in_flight = false;
+  --num_in_flight_;
+  if (on_complete_) {
+    on_complete_(slot.task, status);
+  }
+  return status;
+}
+
+TfLiteStatus AsyncPipeline::Submit(
+    const std::function<TfLiteStatus(TfLiteExecutionTask*)>& fill) {
+  Slot& slot = slots_[next_slot_];
+  if (slot.task == nullptr) return kTfLiteError;
+  // The status of the previous execution was reported to the callback.
+  Complete(slot);
+  if (fill(slot.task) != kTfLiteOk) return kTfLiteError;
+  // A task whose scheduling failed must still be waited for.
+  const TfLiteStatus status = runner_->InvokeAsync(slot.task);
+  slot.in_flight = true;
+  ++num_in_flight_;
+  next_slot_ = (next_slot_ + 1) % slots_.size();
+  return status;
+}
+
+TfLiteStatus AsyncPipeline::Flush() {
+  TfLiteStatus status = kTfLiteOk;
+  for (int i = 0; i < slots_.size(); ++i) {
+    if (Complete(slots_[(next_slot_ + i) % slots_.size()]) != kTfLiteOk) {
+      status = kTfLiteError;
+    }
+  }
+  return status;
+}
+
+}  // namespace async
+}  // namespace tflite
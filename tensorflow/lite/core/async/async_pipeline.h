@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_CORE_ASYNC_ASYNC_PIPELINE_H_
+#define TENSORFLOW_LITE_CORE_ASYNC_ASYNC_PIPELINE_H_
+
+#include <functional>
+#include <vector>
+
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+
+namespace tflite {
+namespace async {
+
+// WARNING: Experimental interface, subject to change
+//
+// Keeps up to `depth` executions of an AsyncSignatureRunner in flight, so that
+// the application prepares the inputs of the next execution and reads back the
+// outputs of the previous one while the backend computes the current one.
+//
+// The pipeline owns one task per slot and uses the slots in turn. Before a
+// slot is reused, its previous execution is waited for and handed to the
+// completion callback. The application rotates its buffers accordingly, e.g.
+// by registering `depth` sets of I/O buffers and setting the buffers of the
+// slot in the fill callback of `Submit`. Synchronizations set on the tasks
+// are forwarded to the backend as usual.
+//
+// The pipeline isn't thread-safe.
+class AsyncPipeline {
+ public:
+  // Called with a task and the status of its execution when the execution is
+  // done. The outputs of the task can be read until the task is filled again.
+  using CompletionCallback =
+      std::function<void(TfLiteExecutionTask* task, TfLiteStatus status)>;
+
+  // Creates the tasks of the `depth` slots. `runner` must be prepared and
+  // outlive the pipeline.
+  AsyncPipeline(AsyncSignatureRunner* runner, int depth,
+                CompletionCallback on_complete);
+
+  // Waits for the executions in flight and finishes the tasks.
+  ~AsyncPipeline();
+
+  AsyncPipeline(const AsyncPipeline&) = delete;
+  AsyncPipeline& operator=(const AsyncPipeline&) = delete;
+
+  // Schedules an execution in the next slot. If the slot is still in flight,
+  // waits for it first and calls the completion callback. Then `fill` sets the
+  // buffers and synchronizations of the task for the new execution.
+  // Returns kTfLiteError if `fill` or the scheduling fails.
+  TfLiteStatus Submit(
+      const std::function<TfLiteStatus(TfLiteExecutionTask*)>& fill);
+
+  // Waits for all the executions in flight, oldest first, and calls the
+  // completion callback for each of them.
+  // Returns kTfLiteError if any of them failed.
+  TfLiteStatus Flush();
+
+  int depth() const { return slots_.size(); }
+
+  // Returns the number of executions in flight.
+  int num_in_flight() const { return num_in_flight_; }
+
+ private:
+  struct Slot {
+    TfLiteExecutionTask* task = nullptr;
+    bool in_flight = false;
+  };
+
+  // Waits for the execution of `slot` if it is in flight.
+  TfLiteStatus Complete(Slot& slot);
+
+  AsyncSignatureRunner* runner_;
+  CompletionCallback on_complete_;
+  std::vector<Slot> slots_;
+  // The slot of the next submission, which is the oldest one in flight.
+  int next_slot_ = 0;
+  int num_in_flight_ = 0;
+};
+
+}  // namespace async
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_ASYNC_ASYNC_PIPELINE_H_
@@ -0,0 +1,130 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/core/async/async_pipeline.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/task.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/testing/mock_async_kernel.h"
+#include "tensorflow/lite/core/async/testing/test_backend.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/kernels/builtin_op_kernels.h"
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Return;
+
+namespace tflite {
+namespace async {
+namespace {
+
+class AsyncPipelineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    kernel_ = std::make_unique<::testing::NiceMock<testing::MockAsyncKernel>>();
+    backend_ = std::make_unique<testing::TestBackend>(kernel_->kernel());
+
+    interpreter_ = std::make_unique<Interpreter>();
+    interpreter_->AddTensors(2);
+    interpreter_->SetInputs({0});
+    interpreter_->SetOutputs({1});
+    TfLiteQuantizationParams quant;
+    interpreter_->SetTensorParametersReadWrite(0, kTfLiteFloat32, "x", {3},
+                                               quant);
+    interpreter_->SetTensorParametersReadWrite(1, kTfLiteFloat32, "a", {3},
+                                               quant);
+    TfLiteRegistration* reg = ops::builtin::Register_ADD();
+    void* builtin_data = malloc(sizeof(int));
+    interpreter_->AddNodeWithParameters({0, 0}, {1}, nullptr, 0, builtin_data,
+                                        reg);
+    interpreter_->ModifyGraphWithDelegate(backend_->get_delegate());
+    runner_ = interpreter_->GetAsyncSignatureRunner(nullptr);
+    ASSERT_NE(runner_, nullptr);
+  }
+
+  std::unique_ptr<::testing::NiceMock<testing::MockAsyncKernel>> kernel_;
+  std::unique_ptr<testing::TestBackend> backend_;
+  std::unique_ptr<Interpreter> interpreter_;
+  AsyncSignatureRunner* runner_ = nullptr;
+};
+
+TEST_F(AsyncPipelineTest, RotatesSlots) {
+  EXPECT_CALL(*kernel_, Eval(_, _, _))
+      .Times(5)
+      .WillRepeatedly(Return(kTfLiteOk));
+  EXPECT_CALL(*kernel_, Wait(_, _)).Times(5).WillRepeatedly(Return(kTfLiteOk));
+  EXPECT_CALL(*kernel_, Finish(_, _)).Times(2);
+
+  std::vector<TfLiteBufferHandle> completed;
+  {
+    AsyncPipeline pipeline(
+        runner_, /*depth=*/2,
+        [&completed](TfLiteExecutionTask* task, TfLiteStatus status) {
+          EXPECT_EQ(status, kTfLiteOk);
+          completed.push_back(TfLiteExecutionTaskGetBufferByIndex(task, 0));
+        });
+    EXPECT_EQ(pipeline.depth(), 2);
+    for (TfLiteBufferHandle buffer = 1; buffer <= 5; ++buffer) {
+      auto fill = [buffer](TfLiteExecutionTask* task) {
+        return TfLiteExecutionTaskSetBufferByIndex(task, 0, buffer);
+      };
+      ASSERT_EQ(pipeline.Submit(fill), kTfLiteOk);
+      // The oldest execution is only waited for when its slot is reused.
+      EXPECT_EQ(pipeline.num_in_flight(), buffer == 1 ? 1 : 2);
+      EXPECT_EQ(completed.size(), buffer < 3 ? 0 : buffer - 2u);
+    }
+    EXPECT_EQ(pipeline.Flush(), kTfLiteOk);
+    EXPECT_EQ(pipeline.num_in_flight(), 0);
+  }
+  EXPECT_THAT(completed, ElementsAre(1, 2, 3, 4, 5));
+}
+
+TEST_F(AsyncPipelineTest, ReportsFailedExecutions) {
+  EXPECT_CALL(*kernel_, Eval(_, _, _)).WillOnce(Return(kTfLiteOk));
+  EXPECT_CALL(*kernel_, Wait(_, _)).WillOnce(Return(kTfLiteError));
+
+  std::vector<TfLiteStatus> statuses;
+  AsyncPipeline pipeline(runner_, /*depth=*/2,
+                         [&statuses](TfLiteExecutionTask*,
+                                     TfLiteStatus status) {
+                           statuses.push_back(status);
+                         });
+  ASSERT_EQ(pipeline.Submit([](TfLiteExecutionTask*) { return kTfLiteOk; }),
+            kTfLiteOk);
+  EXPECT_EQ(pipeline.Flush(), kTfLiteError);
+  EXPECT_THAT(statuses, ElementsAre(kTfLiteError));
+}
+
+TEST_F(AsyncPipelineTest, FillFailureDoesNotSchedule) {
+  EXPECT_CALL(*kernel_, Eval(_, _, _)).Times(0);
+
+  AsyncPipeline pipeline(runner_, /*depth=*/1, nullptr);
+  EXPECT_EQ(pipeline.Submit([](TfLiteExecutionTask*) { return kTfLiteError; }),
+            kTfLiteError);
+  EXPECT_EQ(pipeline.num_in_flight(), 0);
+}
+
+}  // namespace
+}  // namespace async
+}  // namespace tflite
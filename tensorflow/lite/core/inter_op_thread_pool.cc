@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/inter_op_thread_pool.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+namespace internal {
+namespace {
+
+thread_local ExternalCpuBackendContext* worker_cpu_backend_context = nullptr;
+
+}  // namespace
+
+InterOpThreadPool::InterOpThreadPool(int num_threads) {
+  for (int i = 1; i < num_threads; ++i) {
+    cpu_backend_contexts_.push_back(
+        std::make_unique<ExternalCpuBackendContext>());
+    threads_.emplace_back(&InterOpThreadPool::WorkerLoop, this,
+                          cpu_backend_contexts_.back().get());
+  }
+}
+
+InterOpThreadPool::~InterOpThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& thread : threads_) thread.join();
+}
+
+void InterOpThreadPool::Run(const std::vector<std::function<void()>>& tasks) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  tasks_ = &tasks;
+  next_task_ = 0;
+  num_pending_tasks_ = tasks.size();
+  work_available_.notify_all();
+  RunTasks(lock);
+  work_done_.wait(lock, [this] { return num_pending_tasks_ == 0; });
+  tasks_ = nullptr;
+}
+
+TfLiteExternalContext* InterOpThreadPool::WorkerCpuBackendContext() {
+  return worker_cpu_backend_context;
+}
+
+void InterOpThreadPool::RunTasks(std::unique_lock<std::mutex>& lock) {
+  while (tasks_ != nullptr && next_task_ < tasks_->size()) {
+    const std::function<void()>& task = (*tasks_)[next_task_++];
+    lock.unlock();
+    task();
+    lock.lock();
+    if (--num_pending_tasks_ == 0) work_done_.notify_all();
+  }
+}
+
+void InterOpThreadPool::WorkerLoop(
+    ExternalCpuBackendContext* cpu_backend_context) {
+  worker_cpu_backend_context = cpu_backend_context;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_available_.wait(lock, [this] {
+      return stopping_ || (tasks_ != nullptr && next_task_ < tasks_->size());
+    });
+    if (stopping_) return;
+    RunTasks(lock);
+  }
+}
+
+}  // namespace internal
+}  // namespace tflite
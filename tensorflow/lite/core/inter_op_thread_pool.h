@@ -0,0 +1,77 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_INTER_OP_THREAD_POOL_H_
+#define TENSORFLOW_LITE_CORE_INTER_OP_THREAD_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+namespace internal {
+
+// Threads which run independent nodes of a subgraph concurrently. Every thread
+// has a CPU backend context of its own, since kernels must not use the one of
+// the interpreter from several threads at once.
+class InterOpThreadPool {
+ public:
+  // Starts `num_threads - 1` threads, the thread calling `Run` being the last
+  // one.
+  explicit InterOpThreadPool(int num_threads);
+  ~InterOpThreadPool();
+
+  InterOpThreadPool(const InterOpThreadPool&) = delete;
+  InterOpThreadPool& operator=(const InterOpThreadPool&) = delete;
+
+  // Runs all the `tasks`, some of them on the calling thread, and returns once
+  // they are all done. It must not be called concurrently.
+  void Run(const std::vector<std::function<void()>>& tasks);
+
+  // Returns the CPU backend context of the calling thread if it is a thread of
+  // a pool, or null.
+  static TfLiteExternalContext* WorkerCpuBackendContext();
+
+ private:
+  // Runs tasks of `tasks_` until all of them are started. `lock` holds
+  // `mutex_`.
+  void RunTasks(std::unique_lock<std::mutex>& lock);
+
+  void WorkerLoop(ExternalCpuBackendContext* cpu_backend_context);
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  // The tasks of the ongoing `Run`, or null.
+  const std::vector<std::function<void()>>* tasks_ = nullptr;
+  size_t next_task_ = 0;
+  size_t num_pending_tasks_ = 0;
+  bool stopping_ = false;
+
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      cpu_backend_contexts_;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace internal
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_INTER_OP_THREAD_POOL_H_
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/flatbuffer_conversions.h"
 #include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/interpreter.h"
 #include "tensorflow/lite/core/macros.h"
@@ -856,11 +857,19 @@ TfLiteStatus InterpreterBuilder::operator()(
     // Finally setup nodes and tensors
     // Parse tensors before nodes as ParseNodes checks input tensors for the
     // nodes.
-    if (ParseTensors(buffers, tensors, modified_subgraph, subgraph_info) !=
-        kTfLiteOk)
-      return cleanup_and_error();
-    if (operators && ParseNodes(operators, modified_subgraph) != kTfLiteOk)
-      return cleanup_and_error();
+    TfLiteStatus parse_status;
+    {
+      // The profiler is owned by the interpreter, so the event must end before
+      // the interpreter is deleted on errors.
+      TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE((*interpreter)->GetProfiler(),
+                                           "ParseSubgraph");
+      parse_status =
+          ParseTensors(buffers, tensors, modified_subgraph, subgraph_info);
+      if (parse_status == kTfLiteOk && operators) {
+        parse_status = ParseNodes(operators, modified_subgraph);
+      }
+    }
+    if (parse_status != kTfLiteOk) return cleanup_and_error();
 
     std::vector<int> variables;
     for (int i = 0; i < modified_subgraph->tensors_size(); ++i) {
@@ -896,7 +905,12 @@ TfLiteStatus InterpreterBuilder::operator()(
     (*interpreter)->ReportTelemetrySettings(kTelemetryBuilderEventName);
   }
 
-  TfLiteStatus status = ApplyDelegates(interpreter->get());
+  TfLiteStatus status;
+  {
+    TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE((*interpreter)->GetProfiler(),
+                                         "ApplyDelegates");
+    status = ApplyDelegates(interpreter->get());
+  }
   if (status != kTfLiteOk) {
     interpreter->reset();
   }
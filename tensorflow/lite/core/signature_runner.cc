@@ -15,9 +15,13 @@ limitations under the License.
 
 #include "tensorflow/lite/core/signature_runner.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 #include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/util.h"
 
 namespace tflite {
 namespace impl {
@@ -113,5 +117,58 @@ TfLiteStatus SignatureRunner::SetCustomAllocationForOutputTensor(
   return subgraph_->SetCustomAllocationForTensor(it->second, allocation, flags);
 }
 
+TfLiteStatus SignatureRunner::BindInputBuffer(const char* input_name,
+                                              const void* data, size_t bytes) {
+  const auto& it = signature_def_->inputs.find(input_name);
+  if (it == signature_def_->inputs.end()) {
+    subgraph_->ReportError("Input name %s was not found", input_name);
+    return kTfLiteError;
+  }
+  // Inputs are only read by the kernels.
+  return BindBuffer(it->second, const_cast<void*>(data), bytes);
+}
+
+TfLiteStatus SignatureRunner::BindOutputBuffer(const char* output_name,
+                                               void* data, size_t bytes) {
+  const auto& it = signature_def_->outputs.find(output_name);
+  if (it == signature_def_->outputs.end()) {
+    subgraph_->ReportError("Output name %s was not found", output_name);
+    return kTfLiteError;
+  }
+  return BindBuffer(it->second, data, bytes);
+}
+
+TfLiteStatus SignatureRunner::BindBuffer(int tensor_index, void* data,
+                                         size_t bytes) {
+  const TfLiteTensor* tensor = subgraph_->tensor(tensor_index);
+  if (tensor->buffer_handle != kTfLiteNullBufferHandle) {
+    subgraph_->ReportError(
+        "Tensor %d is held by a delegate buffer handle and can't be bound to "
+        "a buffer",
+        tensor_index);
+    return kTfLiteError;
+  }
+  if (reinterpret_cast<uintptr_t>(data) % kDefaultTensorAlignment != 0) {
+    subgraph_->ReportError(
+        "Buffer bound to tensor %d is not aligned to %d bytes", tensor_index,
+        kDefaultTensorAlignment);
+    return kTfLiteError;
+  }
+  // Once the tensors are allocated, Invoke() doesn't check the custom
+  // allocations again unless the tensors are resized.
+  if (subgraph_->state_ != Subgraph::kStateUninvokable &&
+      bytes < tensor->bytes) {
+    subgraph_->ReportError(
+        "Buffer of %zu bytes bound to tensor %d is smaller than its %zu bytes",
+        bytes, tensor_index, tensor->bytes);
+    return kTfLiteError;
+  }
+  // A custom allocation is never part of the arena, or shared with arena
+  // tensors, so it can be swapped without planning the arena again.
+  const TfLiteCustomAllocation allocation = {data, bytes};
+  return subgraph_->SetCustomAllocationForTensor(
+      tensor_index, allocation, kTfLiteCustomAllocationFlagsSkipAlignCheck);
+}
+
 }  // namespace impl
 }  // namespace tflite
@@ -207,6 +207,35 @@ class SignatureRunner {
       const char* output_name, const TfLiteCustomAllocation& allocation,
       int64_t flags = kTfLiteCustomAllocationFlagsNone);
 
+  /// \brief Binds the caller-owned buffer `data` of `bytes` bytes to the input
+  /// tensor identified by `input_name`, so that the next invocations read the
+  /// input from it instead of copying it to `input_tensor(input_name)`.
+  /// The runtime does NOT take ownership of the buffer, which must stay valid
+  /// until it is rebound or the Interpreter is destroyed.
+  ///
+  /// Unlike `SetCustomAllocationForInputTensor`, a buffer can be bound again
+  /// before every call to `Invoke()` without calling `AllocateTensors()`, the
+  /// memory plan of the other tensors being left as is. Delegates which read
+  /// their inputs from `tensor->data` (e.g. XNNPACK) use the buffer in place.
+  ///
+  /// Returns an error if:
+  /// 1. `data` is not aligned to kDefaultTensorAlignment defined in
+  ///    lite/util.h (currently 64 bytes).
+  /// 2. The tensor is allocated, and `bytes` is smaller than its size. If the
+  ///    tensor is resized, the size is checked again by `AllocateTensors()`.
+  /// 3. The tensor data is held by a delegate buffer handle.
+  /// \warning This is an experimental API and subject to change. \n
+  TfLiteStatus BindInputBuffer(const char* input_name, const void* data,
+                               size_t bytes);
+
+  /// \brief Binds the caller-owned buffer `data` of `bytes` bytes to the
+  /// output tensor identified by `output_name`, so that the next invocations
+  /// write the output to it. See `BindInputBuffer` for the requirements on the
+  /// buffer.
+  /// \warning This is an experimental API and subject to change. \n
+  TfLiteStatus BindOutputBuffer(const char* output_name, void* data,
+                                size_t bytes);
+
   /// \brief Set if buffer handle output is allowed.
   ///
   /// When using hardware delegation, Interpreter will make the data of output
@@ -226,6 +255,9 @@ class SignatureRunner {
   // SignatureRunner objects don't outlive their corresponding Subgraph objects.
   SignatureRunner(const internal::SignatureDef* signature_def,
                   Subgraph* subgraph);
+
+  // Binds `data` to the tensor at `tensor_index`, see `BindInputBuffer`.
+  TfLiteStatus BindBuffer(int tensor_index, void* data, size_t bytes);
   friend class ::tflite::impl::Interpreter;
   friend class ::tflite::SignatureRunnerHelper;
   friend class ::tflite::SignatureRunnerJNIHelper;
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/lite/core/interpreter_builder.h"
 #include "tensorflow/lite/core/kernels/register.h"
 #include "tensorflow/lite/testing/util.h"
+#include "tensorflow/lite/util.h"
 
 namespace tflite {
 namespace impl {
@@ -96,6 +97,57 @@ TEST(SignatureRunnerTest, TestMultiSignatures) {
   ASSERT_EQ(sub_output->data.f[2], 3);
 }
 
+TEST(SignatureRunnerTest, BindBuffers) {
+  TestErrorReporter reporter;
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_signatures.bin", &reporter);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolver resolver;
+  InterpreterBuilder builder(*model, resolver);
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(builder(&interpreter), kTfLiteOk);
+  SignatureRunner* add_runner = interpreter->GetSignatureRunner("add");
+  ASSERT_NE(add_runner, nullptr);
+  ASSERT_EQ(add_runner->ResizeInputTensor("x", {2}), kTfLiteOk);
+  ASSERT_EQ(add_runner->AllocateTensors(), kTfLiteOk);
+
+  alignas(kDefaultTensorAlignment) float inputs[2][16];
+  alignas(kDefaultTensorAlignment) float outputs[2][16];
+  // Buffers can be swapped before every invocation.
+  for (int i = 0; i < 4; ++i) {
+    float* input = inputs[i % 2];
+    float* output = outputs[i % 2];
+    input[0] = i;
+    input[1] = 2 * i;
+    ASSERT_EQ(add_runner->BindInputBuffer("x", input, 2 * sizeof(float)),
+              kTfLiteOk);
+    ASSERT_EQ(
+        add_runner->BindOutputBuffer("output_0", output, 2 * sizeof(float)),
+        kTfLiteOk);
+    ASSERT_EQ(add_runner->Invoke(), kTfLiteOk);
+    EXPECT_EQ(add_runner->output_tensor("output_0")->data.f, output);
+    EXPECT_EQ(output[0], i + 2);
+    EXPECT_EQ(output[1], 2 * i + 2);
+  }
+
+  EXPECT_EQ(add_runner->BindInputBuffer("dummy", inputs[0], sizeof(float)),
+            kTfLiteError);
+  EXPECT_EQ(add_runner->BindInputBuffer("x", inputs[0] + 1, 2 * sizeof(float)),
+            kTfLiteError);
+  EXPECT_EQ(add_runner->BindInputBuffer("x", inputs[0], sizeof(float)),
+            kTfLiteError);
+
+  // A larger input is checked against the buffer after the resize.
+  ASSERT_EQ(add_runner->ResizeInputTensor("x", {4}), kTfLiteOk);
+  EXPECT_NE(add_runner->AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(add_runner->BindInputBuffer("x", inputs[0], 4 * sizeof(float)),
+            kTfLiteOk);
+  ASSERT_EQ(
+      add_runner->BindOutputBuffer("output_0", outputs[0], 4 * sizeof(float)),
+      kTfLiteOk);
+  ASSERT_EQ(add_runner->AllocateTensors(), kTfLiteOk);
+}
+
 }  // namespace
 }  // namespace impl
 }  // namespace tflite
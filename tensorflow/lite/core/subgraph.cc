@@ -22,8 +22,10 @@ limitations under the License.
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <iterator>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -40,6 +42,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/tensor_utils.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/inter_op_thread_pool.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
@@ -125,6 +128,54 @@ bool HasDynamicTensorImpl(const TfLiteContext& context,
   return false;
 }
 
+// Tags of the OPERATOR_MEMORY_EVENTs recorded by the subgraph.
+constexpr char kArenaGrowthTag[] = "ArenaGrowth";
+constexpr char kDynamicTensorAllocationTag[] = "DynamicTensorAllocation";
+
+// The buffer and size of a node output, used to find out which dynamic
+// outputs a node (re)allocated.
+struct OutputBuffer {
+  const void* data;
+  size_t bytes;
+};
+
+std::vector<OutputBuffer> GetOutputBuffers(const TfLiteContext& context,
+                                           const TfLiteNode& node) {
+  std::vector<OutputBuffer> buffers;
+  buffers.reserve(node.outputs->size);
+  for (int i : TfLiteIntArrayView(node.outputs)) {
+    if (i == kTfLiteOptionalTensor) {
+      buffers.push_back({nullptr, 0});
+      continue;
+    }
+    const TfLiteTensor& tensor = context.tensors[i];
+    buffers.push_back({tensor.data.raw, tensor.bytes});
+  }
+  return buffers;
+}
+
+// Returns the number of bytes of the kTfLiteDynamic outputs of `node` whose
+// buffer changed compared to `buffers_before`.
+size_t GetReallocatedDynamicOutputBytes(
+    const TfLiteContext& context, const TfLiteNode& node,
+    const std::vector<OutputBuffer>& buffers_before) {
+  size_t allocated_bytes = 0;
+  for (int i = 0; i < node.outputs->size; ++i) {
+    const int tensor_index = node.outputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    const TfLiteTensor& tensor = context.tensors[tensor_index];
+    if (tensor.allocation_type != kTfLiteDynamic ||
+        tensor.data.raw == nullptr) {
+      continue;
+    }
+    if (tensor.data.raw != buffers_before[i].data ||
+        tensor.bytes != buffers_before[i].bytes) {
+      allocated_bytes += tensor.bytes;
+    }
+  }
+  return allocated_bytes;
+}
+
 bool HasDynamicTensor(const TfLiteContext& context,
                       const TfLiteIntArray* int_array,
                       int* dynamic_tensor_index) {
@@ -242,6 +293,10 @@ class InterpreterInfo : public GraphInfo {
     return subgraph_->variables();
   }
 
+  size_t last_concurrent_node(size_t index) const override {
+    return subgraph_->last_concurrent_node(index);
+  }
+
  public:
   Subgraph* subgraph_;
 };
@@ -616,6 +671,14 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext) {
+    // Nodes running concurrently on other threads than the one invoking the
+    // subgraph use the context of their thread.
+    if (TfLiteExternalContext* worker_context =
+            internal::InterOpThreadPool::WorkerCpuBackendContext()) {
+      return worker_context;
+    }
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -1500,6 +1563,8 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
 }
 
 TfLiteStatus Subgraph::PrepareOpsAndTensors() {
+  TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(),
+                                       "PrepareOpsAndTensors");
   // Prepare original execution plan if any applied delegate wants it.
   // If any of the delegates is immutable, this won't be triggered
   // post-delegation (since we undo/redo delegation). For all other cases, other
@@ -1533,10 +1598,19 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
 #else
-    memory_planner_ = std::make_unique<ArenaPlanner>(
+    auto arena_planner = std::make_unique<ArenaPlanner>(
         &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
         kDefaultTensorAlignment, subgraph_index_);
+    arena_planner->SetSharedArenaBuffer(GetSharedArenaBuffer());
+    memory_planner_ = std::move(arena_planner);
 #endif
+    // The nodes are only reordered once all of them are prepared, since the
+    // remaining ones are prepared in execution plan order.
+    if (next_execution_plan_index_to_prepare_ == execution_plan_.size()) {
+      ScheduleConcurrentNodes();
+    } else {
+      last_concurrent_node_.clear();
+    }
     memory_planner_->PlanAllocations();
   }
 
@@ -1601,6 +1675,12 @@ TfLiteStatus Subgraph::InvokeImpl() {
   }
 
   TfLiteStatus status = kTfLiteOk;
+  if (state_ != kStateUninvokable && GetSharedArenaBuffer() != nullptr &&
+      memory_planner_ && !memory_planner_->HasNonPersistentMemory()) {
+    // Another interpreter sharing the arena moved it since the tensors were
+    // last allocated.
+    TF_LITE_ENSURE_STATUS(memory_planner_->AcquireNonPersistentMemory());
+  }
   if (state_ == kStateUninvokable) {
     ReportError("Invoke called on model that is not ready.");
     return kTfLiteError;
@@ -1621,9 +1701,38 @@ TfLiteStatus Subgraph::InvokeImpl() {
   for (int execution_plan_index = 0;
        execution_plan_index < execution_plan_.size(); execution_plan_index++) {
     if (execution_plan_index == next_execution_plan_index_to_prepare_) {
+      const size_t arena_size_before = profiler_ ? ArenaSize() : 0;
       TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
       TF_LITE_ENSURE(&context_, next_execution_plan_index_to_prepare_ >=
                                     execution_plan_index);
+      // Attribute the arena growth caused by re-planning the remaining nodes
+      // to the node whose dynamic outputs triggered it.
+      if (profiler_ && ArenaSize() > arena_size_before) {
+        profiler_->AddEvent(kArenaGrowthTag,
+                            Profiler::EventType::OPERATOR_MEMORY_EVENT,
+                            ArenaSize() - arena_size_before,
+                            execution_plan_[execution_plan_index],
+                            subgraph_index_);
+      }
+    }
+    const int last_concurrent = last_concurrent_node(execution_plan_index);
+    if (last_concurrent > execution_plan_index && !profiler_ &&
+        next_execution_plan_index_to_prepare_ > last_concurrent) {
+      bool has_dynamic_outputs = false;
+      for (int i = execution_plan_index; i <= last_concurrent; ++i) {
+        const TfLiteNode& node =
+            nodes_and_registration_[execution_plan_[i]].first;
+        has_dynamic_outputs |=
+            HasDynamicTensor(context_, node.outputs,
+                             /*dynamic_tensor_index=*/nullptr);
+      }
+      // Nodes with dynamic outputs may need to prepare the next ones.
+      if (!has_dynamic_outputs) {
+        TF_LITE_ENSURE_STATUS(
+            InvokeConcurrentNodes(execution_plan_index, last_concurrent));
+        execution_plan_index = last_concurrent;
+        continue;
+      }
     }
     int node_index = execution_plan_[execution_plan_index];
     TfLiteNode& node = nodes_and_registration_[node_index].first;
@@ -1648,60 +1757,36 @@ TfLiteStatus Subgraph::InvokeImpl() {
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(
         profile_op ? profiler_.get() : nullptr, op_name, node_index);
 
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
-            tensor->dims->size != 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is
-          // sometimes only used for the shape, not for the data. Thus, null
-          // buffer is ok in this situation.
-          // The situation where null buffer is not ok for reshape operator is
-          // only when there are 2 inputs given to the node and the one
-          // corresponding to the shape (i == 1) is a vector that contains all
-          // dimensions. See `GetOutputShape()` function in
-          // `tensorflow/lite/kernels/reshape.cc`
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
+    TF_LITE_ENSURE_STATUS(EnsureOpInputsAreReadable(node, registration));
+    std::vector<OutputBuffer> output_buffers_before;
+    if (profiler_) {
+      output_buffers_before = GetOutputBuffers(context_, node);
+      profiler_->set_current_node_index(node_index);
     }
     // Allocate dynamic tensors which memory is required to be allocated
     // before executing the node.
     MayAllocateOpOutput(&node);
 
-    if (check_cancelled_func_ != nullptr &&
-        check_cancelled_func_(cancellation_data_)) {
-      ReportError("Client requested cancel during Invoke()");
-      return kTfLiteError;
-    }
-
-    if (continue_invocation_ && !continue_invocation_->test_and_set()) {
-      // `Cancel` is called and cancellation flag is flipped.
-      ReportError("Client requested cancel during Invoke()");
-      return kTfLiteCancelled;
-    }
+    TF_LITE_ENSURE_STATUS(CheckCancelled());
 
     EnsureTensorsVectorCapacity();
     tensor_resized_since_op_invoke_ = false;
     if (auto s = OpInvoke(registration, &node); s != kTfLiteOk) {
+      if (profiler_) profiler_->set_current_node_index(-1);
       auto err = ReportOpError(&context_, node, registration, node_index,
                                "failed to invoke");
       return s == kTfLiteCancelled ? s : err;
     }
+    if (profiler_) {
+      profiler_->set_current_node_index(-1);
+      const size_t dynamic_bytes = GetReallocatedDynamicOutputBytes(
+          context_, node, output_buffers_before);
+      if (dynamic_bytes > 0) {
+        profiler_->AddEvent(kDynamicTensorAllocationTag,
+                            Profiler::EventType::OPERATOR_MEMORY_EVENT,
+                            dynamic_bytes, node_index, subgraph_index_);
+      }
+    }
 
     // Force execution prep for downstream ops if the latest op triggered the
     // resize of a dynamic tensor.
@@ -1735,6 +1820,221 @@ TfLiteStatus Subgraph::InvokeImpl() {
   return status;
 }
 
+TfLiteStatus Subgraph::EnsureOpInputsAreReadable(
+    const TfLiteNode& node, const TfLiteRegistration& registration) {
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor->dims->size != 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is
+        // sometimes only used for the shape, not for the data. Thus, null
+        // buffer is ok in this situation.
+        // The situation where null buffer is not ok for reshape operator is
+        // only when there are 2 inputs given to the node and the one
+        // corresponding to the shape (i == 1) is a vector that contains all
+        // dimensions. See `GetOutputShape()` function in
+        // `tensorflow/lite/kernels/reshape.cc`
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::CheckCancelled() {
+  if (check_cancelled_func_ != nullptr &&
+      check_cancelled_func_(cancellation_data_)) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteError;
+  }
+
+  if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+    // `Cancel` is called and cancellation flag is flipped.
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteCancelled;
+  }
+  return kTfLiteOk;
+}
+
+bool Subgraph::CanRunConcurrently(
+    const TfLiteNode& node, const TfLiteRegistration& registration) const {
+  // Delegates, custom ops and ops invoking other subgraphs may not be thread
+  // safe, and ops using resources must keep their order.
+  if (node.delegate != nullptr || node.might_have_side_effect) return false;
+  if (registration.builtin_code == kTfLiteBuiltinCustom ||
+      registration.builtin_code == kTfLiteBuiltinStablehloWhile ||
+      registration.builtin_code == kTfLiteBuiltinStablehloComposite) {
+    return false;
+  }
+  for (const TfLiteIntArray* tensor_indices : {node.inputs, node.outputs}) {
+    for (int i = 0; i < tensor_indices->size; ++i) {
+      const int tensor_index = tensor_indices->data[i];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      if (tensor.is_variable || tensor.type == kTfLiteResource ||
+          tensor.type == kTfLiteVariant ||
+          tensor.allocation_type == kTfLiteDynamic) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void Subgraph::ScheduleConcurrentNodes() {
+  last_concurrent_node_.clear();
+  const int num_threads = options_ ? options_->GetNumInterOpThreads() : 1;
+  if (num_threads <= 1) return;
+
+  const int num_nodes = execution_plan_.size();
+  std::vector<int> position(nodes_and_registration_.size(), -1);
+  for (int i = 0; i < num_nodes; ++i) position[execution_plan_[i]] = i;
+  auto position_of = [&position](int node_index) {
+    return node_index >= 0 && node_index < position.size()
+               ? position[node_index]
+               : -1;
+  };
+  std::vector<std::vector<int>> control_predecessors(num_nodes);
+  if (control_edges_ != nullptr) {
+    for (const ControlEdge& edge : *control_edges_) {
+      const int from = position_of(edge.first);
+      const int to = position_of(edge.second);
+      if (from >= 0 && to >= 0) control_predecessors[to].push_back(from);
+    }
+  }
+
+  // Nodes which may run concurrently are grouped in runs of consecutive nodes,
+  // separated by the ones which may not. Within a run, every node is placed
+  // one level after the nodes it depends on, and the nodes of every level run
+  // concurrently.
+  std::vector<int> producer(tensors_.size(), -1);
+  std::vector<int> level(num_nodes, 0);
+  std::vector<int> new_execution_plan;
+  new_execution_plan.reserve(num_nodes);
+  last_concurrent_node_.reserve(num_nodes);
+  bool runs_concurrently = false;
+  int run_begin = 0;
+  while (run_begin < num_nodes) {
+    int run_end = run_begin;
+    for (; run_end < num_nodes; ++run_end) {
+      const auto& node_and_registration =
+          nodes_and_registration_[execution_plan_[run_end]];
+      const TfLiteNode& node = node_and_registration.first;
+      if (!CanRunConcurrently(node, node_and_registration.second)) break;
+      for (int i = 0; i < node.inputs->size; ++i) {
+        const int tensor_index = node.inputs->data[i];
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        if (producer[tensor_index] >= run_begin) {
+          level[run_end] =
+              std::max(level[run_end], level[producer[tensor_index]] + 1);
+        }
+      }
+      for (int predecessor : control_predecessors[run_end]) {
+        if (predecessor >= run_begin && predecessor < run_end) {
+          level[run_end] = std::max(level[run_end], level[predecessor] + 1);
+        }
+      }
+      for (int i = 0; i < node.outputs->size; ++i) {
+        const int tensor_index = node.outputs->data[i];
+        if (tensor_index != kTfLiteOptionalTensor) {
+          producer[tensor_index] = run_end;
+        }
+      }
+    }
+    if (run_end == run_begin) {
+      // The node runs alone.
+      last_concurrent_node_.push_back(new_execution_plan.size());
+      new_execution_plan.push_back(execution_plan_[run_begin]);
+      run_begin = run_end + 1;
+      continue;
+    }
+    std::vector<int> run(run_end - run_begin);
+    std::iota(run.begin(), run.end(), run_begin);
+    std::stable_sort(run.begin(), run.end(),
+                     [&level](int a, int b) { return level[a] < level[b]; });
+    for (int i = 0; i < run.size(); ++i) {
+      int last = i;
+      while (last + 1 < run.size() && level[run[last + 1]] == level[run[i]]) {
+        ++last;
+      }
+      runs_concurrently |= last > i;
+      for (int j = i; j <= last; ++j) {
+        last_concurrent_node_.push_back(new_execution_plan.size() + last - i);
+      }
+      for (int j = i; j <= last; ++j) {
+        new_execution_plan.push_back(execution_plan_[run[j]]);
+      }
+      i = last;
+    }
+    run_begin = run_end;
+  }
+  if (!runs_concurrently) {
+    last_concurrent_node_.clear();
+    return;
+  }
+  execution_plan_ = std::move(new_execution_plan);
+  if (!inter_op_thread_pool_) {
+    inter_op_thread_pool_ =
+        std::make_unique<internal::InterOpThreadPool>(num_threads);
+  }
+}
+
+TfLiteStatus Subgraph::InvokeConcurrentNodes(int first, int last) {
+  for (int i = first; i <= last; ++i) {
+    TfLiteNode& node = nodes_and_registration_[execution_plan_[i]].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[execution_plan_[i]].second;
+    TF_LITE_ENSURE_STATUS(EnsureOpInputsAreReadable(node, registration));
+    MayAllocateOpOutput(&node);
+  }
+  TF_LITE_ENSURE_STATUS(CheckCancelled());
+  EnsureTensorsVectorCapacity();
+
+  std::vector<TfLiteStatus> statuses(last - first + 1, kTfLiteOk);
+  std::vector<std::function<void()>> tasks;
+  tasks.reserve(statuses.size());
+  for (int i = first; i <= last; ++i) {
+    tasks.push_back([this, &statuses, first, i] {
+      auto& node_and_registration = nodes_and_registration_[execution_plan_[i]];
+      statuses[i - first] = OpInvoke(node_and_registration.second,
+                                     &node_and_registration.first);
+    });
+  }
+  inter_op_thread_pool_->Run(tasks);
+
+  for (int i = first; i <= last; ++i) {
+    const int node_index = execution_plan_[i];
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    if (statuses[i - first] != kTfLiteOk) {
+      auto err = ReportOpError(&context_, node,
+                               nodes_and_registration_[node_index].second,
+                               node_index, "failed to invoke");
+      return statuses[i - first] == kTfLiteCancelled ? kTfLiteCancelled : err;
+    }
+  }
+  for (int i = first; i <= last; ++i) {
+    const int node_index = execution_plan_[i];
+    MaybeReleaseDynamicTensors(nodes_and_registration_[node_index].first,
+                               node_index);
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -2223,6 +2523,7 @@ void Subgraph::EnsureTensorsVectorCapacity() {
 TfLiteStatus Subgraph::EnsureMemoryAllocations() {
   if (memory_planner_) {
     state_ = kStateUninvokable;
+    ScheduleConcurrentNodes();
     TF_LITE_ENSURE_OK(&context_, memory_planner_->PlanAllocations());
   }
   TF_LITE_ENSURE_OK(&context_, AllocateTensors());
@@ -2392,6 +2693,14 @@ void Subgraph::DumpMemoryPlannerDebugInfo() const {
   memory_planner_->DumpDebugInfo(execution_plan());
 }
 
+size_t Subgraph::ArenaSize() const {
+  if (memory_planner_ == nullptr) return 0;
+  size_t arena_size = 0;
+  size_t arena_persist_size = 0;
+  memory_planner_->GetAllocInfo(&arena_size, &arena_persist_size);
+  return arena_size + arena_persist_size;
+}
+
 void Subgraph::GetMemoryAllocInfo(SubgraphAllocInfo* alloc_info) const {
   memset(alloc_info, 0, sizeof(SubgraphAllocInfo));
   if (memory_planner_ == nullptr) return;
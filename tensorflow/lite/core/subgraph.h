@@ -50,6 +50,7 @@ class SingleOpModel;  // Class for friend declarations.
 
 namespace internal {
 class CommonOpaqueConversionUtil;  // Class for friend declarations.
+class InterOpThreadPool;
 }
 
 namespace async {
@@ -241,6 +242,16 @@ class Subgraph {
     return pre_delegation_execution_plan_;
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Returns the index in the execution plan of the last node which may run
+  // concurrently with the node at `execution_plan_index`. See
+  // `InterpreterOptions::SetNumInterOpThreads`.
+  int last_concurrent_node(int execution_plan_index) const {
+    return last_concurrent_node_.size() == execution_plan_.size()
+               ? last_concurrent_node_[execution_plan_index]
+               : execution_plan_index;
+  }
+
   const std::vector<std::pair<TfLiteNode, TfLiteRegistration>>&
   nodes_and_registration() const {
     return nodes_and_registration_;
@@ -481,6 +492,22 @@ class Subgraph {
     return (options_ && (options_->GetDynamicAllocationForLargeTensors() > 0));
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // True if control flow ops should only prepare their subgraphs when they are
+  // first invoked. See `InterpreterOptions::SetLazySubgraphPreparation`.
+  bool ShouldPrepareSubgraphsLazily() const {
+    return options_ && options_->GetLazySubgraphPreparation();
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Returns the buffer which the non-persistent tensors are allocated in if it
+  // is shared with other subgraphs, or null. Only primary subgraphs share it,
+  // since the other ones are invoked while their callers are.
+  SharedArenaBuffer* GetSharedArenaBuffer() const {
+    return options_ && subgraph_index_ == 0 ? options_->GetSharedArenaBuffer()
+                                            : nullptr;
+  }
+
   // WARNING: This is an experimental API and subject to change.
   // Remove unused inputs of the subgraph. It checks usage of inputs and mark it
   // as kTfLiteOptionalTensor if the input is not used in graph execution.
@@ -634,6 +661,12 @@ class Subgraph {
     void AddEvent(const char* tag, EventType event_type, uint64_t elapsed_time,
                   int64_t event_metadata1, int64_t event_metadata2) override {
       if (!profiler_) return;
+      // Memory events reported without a node index (e.g. by a delegate
+      // kernel) belong to the node being invoked.
+      if (event_type == EventType::OPERATOR_MEMORY_EVENT &&
+          event_metadata1 < 0) {
+        event_metadata1 = current_node_index_;
+      }
       profiler_->AddEvent(tag, event_type, elapsed_time, event_metadata1,
                           subgraph_index_);
     }
@@ -644,10 +677,16 @@ class Subgraph {
       profiler_->AddEventWithData(tag, event_type, data);
     }
 
+    // Sets the index of the node being invoked, or -1 outside of a node.
+    void set_current_node_index(int64_t node_index) {
+      current_node_index_ = node_index;
+    }
+
    private:
     // Not own the memory.
     Profiler* const profiler_;
     const int64_t subgraph_index_;
+    int64_t current_node_index_ = -1;
   };
 
   // Ensure the internal node storage memory allocates at least `count`
@@ -947,6 +986,30 @@ class Subgraph {
   // tensors if configured.
   void MaybeReleaseDynamicTensors(const TfLiteNode& node, size_t node_index);
 
+  // Returns the total size of the (non-persistent and persistent) tensor
+  // arenas, or 0 if there's no memory planner.
+  size_t ArenaSize() const;
+
+  // Makes sure that the kernel of `node` can read the data of its inputs.
+  TfLiteStatus EnsureOpInputsAreReadable(
+      const TfLiteNode& node, const TfLiteRegistration& registration);
+
+  // Returns an error if the client requested to cancel the invocation.
+  TfLiteStatus CheckCancelled();
+
+  // Returns true if `node` may run concurrently with other nodes.
+  bool CanRunConcurrently(const TfLiteNode& node,
+                          const TfLiteRegistration& registration) const;
+
+  // If inter-op parallelism is enabled, reorders the execution plan so that
+  // nodes which don't depend on each other are consecutive, and sets
+  // `last_concurrent_node_` accordingly. Otherwise clears it.
+  void ScheduleConcurrentNodes();
+
+  // Invokes the nodes at execution plan indices `first` to `last`
+  // concurrently.
+  TfLiteStatus InvokeConcurrentNodes(int first, int last);
+
   // The state of the Subgraph.
   enum State {
     // The Subgraph isn't ready to be invoked.
@@ -1068,6 +1131,14 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // For every node of the execution plan, the index of the last node which may
+  // run concurrently with it. Empty if the nodes run one after the other.
+  std::vector<int> last_concurrent_node_;
+
+  // Runs the nodes which run concurrently, created along with
+  // `last_concurrent_node_`.
+  std::unique_ptr<internal::InterOpThreadPool> inter_op_thread_pool_;
+
   // Maps tensor index to custom allocation for all applicable tensors.
   std::map<int, TfLiteCustomAllocation> custom_allocations_;
 
@@ -254,6 +254,26 @@ class Delegate {
     }
   }
 
+  // Enables serialization with a model token derived from the constant
+  // tensors of the model, if serialization was requested without a token and
+  // TFLITE_GPU_EXPERIMENTAL_FLAGS_DERIVE_MODEL_TOKEN is set. The serialization
+  // entries already fingerprint the graph and the tensor shapes, but not the
+  // tensor data.
+  void MaybeDeriveModelToken(TfLiteContext* context) {
+    constexpr int64_t kFlags =
+        TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION |
+        TFLITE_GPU_EXPERIMENTAL_FLAGS_DERIVE_MODEL_TOKEN;
+    if (serialization_ || (options_.experimental_flags & kFlags) != kFlags ||
+        !options_.serialization_dir || options_.model_token) {
+      return;
+    }
+    derived_model_token_ = delegates::ModelTokenFromConstantTensors(context);
+    SerializationParams params;
+    params.model_token = derived_model_token_.c_str();
+    params.cache_dir = options_.serialization_dir;
+    serialization_ = std::make_unique<Serialization>(params);
+  }
+
   TfLiteDelegate* tflite_delegate() { return &delegate_; }
   Serialization* serialization() { return serialization_.get(); }
   const TfLiteGpuDelegateOptionsV2& options() const { return options_; }
@@ -277,6 +297,8 @@ class Delegate {
   std::atomic<int> num_delegate_kernels_ = 0;
 
   std::unique_ptr<Serialization> serialization_;
+  // The model token of `serialization_` if it wasn't given in the options.
+  std::string derived_model_token_;
 
   std::unique_ptr<TfLiteTelemetryGpuDelegateSettings> telemetry_settings_;
 
@@ -1528,6 +1550,7 @@ TfLiteRegistration CreateAsyncRegistration() {
 
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
   auto* gpu_delegate = GetDelegate(delegate);
+  gpu_delegate->MaybeDeriveModelToken(context);
 
   const TfLiteRegistration kRegistration =
 #if defined(__ANDROID__)
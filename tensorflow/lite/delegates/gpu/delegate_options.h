@@ -68,9 +68,17 @@ enum TfLiteGpuExperimentalFlags {
   // ModifyGraphWithDelegate will fail if data cannot be serialized.
   //
   // NOTE: User also needs to set serialization_dir & model_token in
-  // TfLiteGpuDelegateOptionsV2.
+  // TfLiteGpuDelegateOptionsV2, or set
+  // TFLITE_GPU_EXPERIMENTAL_FLAGS_DERIVE_MODEL_TOKEN.
   // Currently works only if CL backend is used.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3,
+  // With serialization enabled and no model_token, derives the model_token
+  // from the weights of the model when the delegate is applied.
+  //
+  // NOTE: This hashes every constant tensor of the model on each
+  // initialization, which takes time proportional to the model size. Setting
+  // model_token avoids that cost.
+  TFLITE_GPU_EXPERIMENTAL_FLAGS_DERIVE_MODEL_TOKEN = 1 << 4,
 };
 
 // IMPORTANT: Always use TfLiteGpuDelegateOptionsV2Default() method to create
@@ -134,7 +142,8 @@ typedef struct {
   // StrFingerprint() in lite/delegates/serialization.h.
   //
   // Set to nullptr in TfLiteGpuDelegateOptionsV2Default(), which implies the
-  // delegate will not try serialization.
+  // delegate will not try serialization unless
+  // TFLITE_GPU_EXPERIMENTAL_FLAGS_DERIVE_MODEL_TOKEN is set.
   const char* model_token;
 
 #ifdef TFLITE_DEBUG_DELEGATE
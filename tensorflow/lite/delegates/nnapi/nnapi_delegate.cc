@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
 #include <cinttypes>
 #include <cstdarg>
 #include <cstddef>
@@ -88,6 +89,28 @@ std::string NnApiBackendId(
   return delegate_id;
 }
 
+// Returns a model token for the compilation cache derived from the data of
+// the constant tensors of the model and the options which change the result
+// of the compilation. The cache entries already fingerprint the graph and
+// the tensor shapes, but not the tensor data.
+std::string DeriveModelToken(
+    const TfLiteContext* context,
+    const StatefulNnApiDelegate::Options& delegate_options) {
+  std::string fingerprints = NnApiBackendId(delegate_options);
+  fingerprints += ";" + std::to_string(delegate_options.execution_preference) +
+                  ";" + std::to_string(delegate_options.allow_fp16) + ";" +
+                  std::to_string(delegate_options.disallow_nnapi_cpu) + ";";
+  for (int i = 0; i < context->tensors_size; ++i) {
+    const TfLiteTensor& tensor = context->tensors[i];
+    if (tensor.allocation_type == kTfLiteMmapRo && tensor.data.raw) {
+      fingerprints += std::to_string(i) + ":" +
+                      delegates::StrFingerprint(tensor.data.raw, tensor.bytes) +
+                      ";";
+    }
+  }
+  return delegates::StrFingerprint(fingerprints.data(), fingerprints.size());
+}
+
 // Returns the enum name corresponding to the given error code if the given
 // value corresponds to an of the error codes in the enumeration above or
 // an message with the unknown code.
@@ -4757,8 +4780,13 @@ TfLiteStatus NNAPIDelegateKernel::Prepare(TfLiteContext* context,
     TF_LITE_ENSURE_STATUS(vendor_plugin_->ConfigureCompilationHints(
         delegate_options.vendor_compilation_hints, compilation));
   }
+  const auto compilation_start = std::chrono::steady_clock::now();
   const int finish_result =
       nnapi_->ANeuralNetworksCompilation_finish(compilation);
+  const int64_t compilation_time_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - compilation_start)
+          .count();
   if (finish_result != ANEURALNETWORKS_NO_ERROR) {
     nnapi_->ANeuralNetworksCompilation_free(compilation);
     compilation = nullptr;
@@ -4766,6 +4794,10 @@ TfLiteStatus NNAPIDelegateKernel::Prepare(TfLiteContext* context,
   RETURN_TFLITE_ERROR_IF_NN_ERROR(context, finish_result,
                                   "completing NNAPI compilation", nnapi_errno);
   nn_compilation_.reset(compilation);
+  StatefulNnApiDelegate::RecordCompilation(node->delegate,
+                                           compilation_time_us);
+  TFLITE_LOG_PROD(TFLITE_LOG_VERBOSE, "NNAPI compilation took %" PRId64 " us.",
+                  compilation_time_us);
 
   bool should_use_burst_mode = delegate_options.use_burst_computation;
   // Override should_use_burst_mode to true if the selected NNAPI devices are of
@@ -6611,6 +6643,20 @@ delegates::Serialization* StatefulNnApiDelegate::GetCache(
   return delegate_data->cache.get();
 }
 
+StatefulNnApiDelegate::CompilationStats
+StatefulNnApiDelegate::GetCompilationStats() const {
+  return delegate_data_.compilation_stats;
+}
+
+// static
+void StatefulNnApiDelegate::RecordCompilation(TfLiteDelegate* delegate,
+                                              int64_t compilation_time_us) {
+  auto delegate_data = reinterpret_cast<Data*>(delegate->data_);
+  ++delegate_data->compilation_stats.num_compilations;
+  delegate_data->compilation_stats.total_compilation_time_us +=
+      compilation_time_us;
+}
+
 TfLiteBufferHandle StatefulNnApiDelegate::RegisterNnapiMemory(
     ANeuralNetworksMemory* memory, CopyToHostTensorFnPtr callback,
     void* callback_context) {
@@ -6960,9 +7006,13 @@ TfLiteStatus StatefulNnApiDelegate::DoPrepare(TfLiteContext* context,
   // Initialize caching, if applicable, from Options.
   const char* cache_dir = delegate_options.cache_dir;
   const char* model_token = delegate_options.model_token;
+  if (cache_dir && !model_token) {
+    delegate_data->derived_model_token =
+        DeriveModelToken(context, delegate_options);
+    model_token = delegate_data->derived_model_token.c_str();
+  }
   delegates::SerializationParams params = {model_token, cache_dir};
-  if (nnapi->android_sdk_version >= kMinSdkVersionForNNAPI12 && cache_dir &&
-      model_token) {
+  if (nnapi->android_sdk_version >= kMinSdkVersionForNNAPI12 && cache_dir) {
     delegate_data->cache = std::make_unique<delegates::Serialization>(params);
   }
 
@@ -6974,12 +7024,14 @@ TfLiteStatus StatefulNnApiDelegate::DoPrepare(TfLiteContext* context,
     TfLiteIntArray* cached_nodes_to_delegate = nullptr;
     if (delegates::GetDelegatedNodes(context, cache_ptr, accelerator_id,
                                      &cached_nodes_to_delegate) == kTfLiteOk) {
+      ++delegate_data->compilation_stats.num_cache_hits;
       if (cached_nodes_to_delegate->size == 0) return kTfLiteOk;
       auto status = context->ReplaceNodeSubsetsWithDelegateKernels(
           context, nnapi_delegate_kernel, cached_nodes_to_delegate, delegate);
       TfLiteIntArrayFree(cached_nodes_to_delegate);
       return status;
     }
+    ++delegate_data->compilation_stats.num_cache_misses;
   }
 
   std::vector<int> nodes_to_delegate;
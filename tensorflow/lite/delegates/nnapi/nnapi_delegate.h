@@ -71,9 +71,10 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     const char* cache_dir = nullptr;
 
     // The unique nul-terminated token string for NNAPI model.
-    // Default to nullptr, which implies the NNAPI will not try caching the
-    // compilation. It is the caller's responsibility to ensure there is no
-    // clash of the tokens.
+    // Default to nullptr, in which case a token is derived from the data of
+    // the constant tensors of the model and the options affecting the
+    // compilation when cache_dir is set. It is the caller's responsibility to
+    // ensure there is no clash of the tokens.
     // NOTE: when using compilation caching, it is not recommended to use the
     // same delegate instance for multiple models.
     const char* model_token = nullptr;
@@ -280,9 +281,32 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
       TfLiteDelegate* delegate);
 
   // Returns ptr to delegates::Serialization, if caching is enabled by user via
-  // cache_dir & model_token.
+  // cache_dir.
   static delegates::Serialization* GetCache(TfLiteDelegate* delegate);
 
+  // Statistics about the compilations done by this delegate instance since
+  // its construction.
+  struct CompilationStats {
+    // Number of times the delegation decision for a model was found in, or
+    // missing from, the cache in cache_dir.
+    int num_cache_hits = 0;
+    int num_cache_misses = 0;
+    // Number of NNAPI compilations and the total time spent on them. On a
+    // hit of the NNAPI compilation cache the compilation is mostly the
+    // loading of the cached artifact, so it is much faster.
+    int num_compilations = 0;
+    int64_t total_compilation_time_us = 0;
+  };
+
+  // Returns the statistics about the compilations of this delegate.
+  // WARNING: This is an experimental interface that is subject to change.
+  CompilationStats GetCompilationStats() const;
+
+  // Records an NNAPI compilation which took the given time.
+  // Note: this function is not intended to be called by developers.
+  static void RecordCompilation(TfLiteDelegate* delegate,
+                                int64_t compilation_time_us);
+
   // Returns the int value of the ResultCode returned by the latest
   // failed call to NNAPI, if any. Zero only in case of NO failed calls since
   // the construction of this instance of StatefulNnApiDelegate.
@@ -363,6 +387,10 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     // TFLite Serialization in case caching has been enabled by the user through
     // Options.
     std::unique_ptr<delegates::Serialization> cache;
+    // Token used by the cache when the user did not provide model_token.
+    std::string derived_model_token;
+    // Statistics returned by GetCompilationStats().
+    CompilationStats compilation_stats;
 
     // Controls disabling of the default diagnostics callbacks that only print
     // debug logs, which are otherwise enabled by default.
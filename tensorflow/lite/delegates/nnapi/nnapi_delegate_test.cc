@@ -402,6 +402,26 @@ TEST(NNAPIDelegate, StatefulDelegateWithCompilationCaching) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray({-1.9, 0.4, 1.0, 1.3}));
 }
 
+// Compilation caching is enabled with a derived model token when only the
+// cache directory is given.
+TEST(NNAPIDelegate, StatefulDelegateWithDerivedModelToken) {
+  StatefulNnApiDelegate::Options options;
+  options.cache_dir = "/data/local/tmp";
+
+  FloatAddOpModel m(options, {TensorType_FLOAT32, {1, 2, 2, 1}},
+                    {TensorType_FLOAT32, {1, 2, 2, 1}},
+                    {TensorType_FLOAT32, {}}, ActivationFunctionType_NONE);
+  m.PopulateTensor<float>(m.input1(), {-2.0, 0.2, 0.7, 0.8});
+  m.PopulateTensor<float>(m.input2(), {0.1, 0.2, 0.3, 0.5});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({-1.9, 0.4, 1.0, 1.3}));
+
+  const StatefulNnApiDelegate::CompilationStats stats =
+      m.GetDelegate()->GetCompilationStats();
+  EXPECT_EQ(stats.num_cache_hits + stats.num_cache_misses, 1);
+  EXPECT_EQ(stats.num_compilations, 1);
+}
+
 // Sanity check for the state-ful NNAPI delegate with QoS hints.
 TEST(NNAPIDelegate, StatefulDelegateWithQoS) {
   StatefulNnApiDelegate::Options options;
@@ -77,6 +77,18 @@ std::string StrFingerprint(const void* data, const size_t num_bytes) {
       ::util::Fingerprint64(reinterpret_cast<const char*>(data), num_bytes));
 }
 
+std::string ModelTokenFromConstantTensors(const TfLiteContext* context) {
+  uint64_t fingerprint = 0;
+  for (int i = 0; i < context->tensors_size; ++i) {
+    const TfLiteTensor& tensor = context->tensors[i];
+    if (tensor.allocation_type != kTfLiteMmapRo || !tensor.data.raw) continue;
+    fingerprint = CombineFingerprints(fingerprint, i);
+    fingerprint = CombineFingerprints(
+        fingerprint, ::util::Fingerprint64(tensor.data.raw, tensor.bytes));
+  }
+  return std::to_string(fingerprint);
+}
+
 SerializationEntry::SerializationEntry(const std::string& cache_dir,
                                        const std::string& model_token,
                                        const uint64_t fingerprint)
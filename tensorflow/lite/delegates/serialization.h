@@ -80,6 +80,15 @@ namespace delegates {
 //    model_token.
 std::string StrFingerprint(const void* data, const size_t num_bytes);
 
+// Helper to generate a model_token from the data of the read-only
+// (kTfLiteMmapRo) tensors in `context`, i.e. the weights of the model, for
+// delegates whose clients did not provide one.
+//
+// NOTE: This reads every byte of the weights, so it costs time proportional to
+// the model size on every call. Clients that can compute a token once, e.g.
+// with StrFingerprint() on the model flatbuffer, should prefer that.
+std::string ModelTokenFromConstantTensors(const TfLiteContext* context);
+
 // Encapsulates a unique blob of data serialized by a delegate.
 // Needs to be initialized with a Serialization instance.
 // Any data set with this entry is 'keyed' by a 64-bit fingerprint unique to the
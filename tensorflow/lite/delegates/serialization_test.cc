@@ -88,6 +88,17 @@ class SerializationTest : public ::testing::Test {
     return params;
   }
 
+  // Generates a context whose first tensor is a read-only weight holding
+  // `weights`, as it would be for a model mapped from a file.
+  TfLiteContext GenerateTfLiteContextWithWeights(std::vector<float>* weights) {
+    TfLiteContext context = GenerateTfLiteContext(/*num_tensors*/ 4);
+    TfLiteTensor& tensor = context.tensors[0];
+    tensor.allocation_type = kTfLiteMmapRo;
+    tensor.data.raw = reinterpret_cast<char*>(weights->data());
+    tensor.bytes = weights->size() * sizeof(float);
+    return context;
+  }
+
   std::vector<TfLiteIntArray*> owned_arrays_;
   std::vector<std::vector<TfLiteTensor>> owned_tensor_vecs_;
 };
@@ -232,6 +243,81 @@ TEST_F(SerializationTest, ModelTokenFingerprint) {
   ASSERT_EQ(entry1.GetFingerprint(), entry3.GetFingerprint());
 }
 
+TEST_F(SerializationTest, ModelTokenFromConstantTensors) {
+  std::vector<float> weights = {1, 2, 3};
+  std::vector<float> weights_copy = weights;
+  std::vector<float> other_weights = {1, 2, 4};
+  TfLiteContext context = GenerateTfLiteContextWithWeights(&weights);
+  TfLiteContext context_copy = GenerateTfLiteContextWithWeights(&weights_copy);
+  TfLiteContext other_context =
+      GenerateTfLiteContextWithWeights(&other_weights);
+
+  // The token depends on the weights, not on where they are loaded.
+  EXPECT_EQ(ModelTokenFromConstantTensors(&context),
+            ModelTokenFromConstantTensors(&context_copy));
+  EXPECT_NE(ModelTokenFromConstantTensors(&context),
+            ModelTokenFromConstantTensors(&other_context));
+
+  // Tensors that are not read-only, like activations, are ignored.
+  std::vector<float> activations = {5, 6};
+  context_copy.tensors[1].allocation_type = kTfLiteArenaRw;
+  context_copy.tensors[1].data.raw =
+      reinterpret_cast<char*>(activations.data());
+  EXPECT_EQ(ModelTokenFromConstantTensors(&context),
+            ModelTokenFromConstantTensors(&context_copy));
+}
+
+TEST_F(SerializationTest, DerivedModelTokenHitsCacheOnSecondInit) {
+  float value = 456.24;
+  const std::string test_dir = getSerializationDir();
+  const std::string delegate = "gpu";
+  TfLiteDelegateParams partition = GenerateTfLiteDelegateParams(
+      /*num_nodes=*/2, /*num_input_tensors=*/3, /*num_output_tensors=*/1);
+
+  // The first initialization misses the cache and populates it.
+  std::vector<float> weights = {0.5, -1.25, 3};
+  TfLiteContext context = GenerateTfLiteContextWithWeights(&weights);
+  const std::string model_token = ModelTokenFromConstantTensors(&context);
+  SerializationParams serialization_params = {model_token.c_str(),
+                                              test_dir.c_str()};
+  Serialization serialization(serialization_params);
+  auto entry = serialization.GetEntryForKernel(delegate, &context, &partition);
+  std::string read_back;
+  ASSERT_EQ(entry.GetData(&context, &read_back), kTfLiteDelegateDataNotFound);
+  ASSERT_EQ(entry.SetData(&context, reinterpret_cast<const char*>(&value),
+                          sizeof(value)),
+            kTfLiteOk);
+
+  // A second initialization with the same model loaded again derives the same
+  // token and hits the cache.
+  std::vector<float> reloaded_weights = weights;
+  TfLiteContext reloaded_context =
+      GenerateTfLiteContextWithWeights(&reloaded_weights);
+  const std::string reloaded_model_token =
+      ModelTokenFromConstantTensors(&reloaded_context);
+  SerializationParams reloaded_params = {reloaded_model_token.c_str(),
+                                         test_dir.c_str()};
+  Serialization reloaded_serialization(reloaded_params);
+  auto reloaded_entry = reloaded_serialization.GetEntryForKernel(
+      delegate, &reloaded_context, &partition);
+  ASSERT_EQ(reloaded_entry.GetData(&reloaded_context, &read_back), kTfLiteOk);
+  ASSERT_FLOAT_EQ(*reinterpret_cast<float*>(&read_back[0]), value);
+
+  // A model with the same graph but retrained weights misses it.
+  std::vector<float> retrained_weights = {0.5, -1.25, 3.5};
+  TfLiteContext retrained_context =
+      GenerateTfLiteContextWithWeights(&retrained_weights);
+  const std::string retrained_model_token =
+      ModelTokenFromConstantTensors(&retrained_context);
+  SerializationParams retrained_params = {retrained_model_token.c_str(),
+                                          test_dir.c_str()};
+  Serialization retrained_serialization(retrained_params);
+  auto retrained_entry = retrained_serialization.GetEntryForKernel(
+      delegate, &retrained_context, &partition);
+  EXPECT_EQ(retrained_entry.GetData(&retrained_context, &read_back),
+            kTfLiteDelegateDataNotFound);
+}
+
 TEST_F(SerializationTest, SerializationData) {
   // Sample data to store in serialization.
   float value1 = 456.24;
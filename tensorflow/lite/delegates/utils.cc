@@ -16,10 +16,12 @@ limitations under the License.
 #include "tensorflow/lite/delegates/utils.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/builtin_ops.h"
@@ -29,6 +31,24 @@ limitations under the License.
 
 namespace tflite {
 namespace delegates {
+namespace {
+
+// Returns the number of bytes of the non-constant tensors in `tensors`.
+size_t NonConstantTensorBytes(const TfLiteContext* context,
+                              const TfLiteIntArray* tensors) {
+  size_t bytes = 0;
+  if (tensors == nullptr) return bytes;
+  for (int tensor_index : TfLiteIntArrayView(tensors)) {
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    const TfLiteTensor& tensor = context->tensors[tensor_index];
+    if (tensor.allocation_type != kTfLiteMmapRo) {
+      bytes += tensor.bytes;
+    }
+  }
+  return bytes;
+}
+
+}  // namespace
 
 TfLiteStatus CreateNewTensorWithDifferentType(TfLiteContext* context,
                                               const int original_tensor_index,
@@ -135,6 +155,50 @@ std::vector<int> GraphPartitionHelper::GetNodesOfFirstNLargestPartitionsImpl(
   return ops_to_replace;
 }
 
+std::vector<int> GraphPartitionHelper::GetNodesOfProfitablePartitions(
+    const NodeDelegationGainFn& node_gain, double cost_per_byte,
+    int n) const {
+  std::vector<std::pair<double, TfLiteDelegateParams*>> profitable_partitions;
+  for (TfLiteDelegateParams* partition : partitions_) {
+    double gain = 0;
+    bool has_all_nodes = true;
+    for (int node_id : TfLiteIntArrayView(partition->nodes_to_replace)) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      if (context_->GetNodeAndRegistration(context_, node_id, &node,
+                                           &registration) != kTfLiteOk) {
+        TF_LITE_KERNEL_LOG(
+            context_, "Couldn't get node and registration info for op: %d\n",
+            node_id);
+        has_all_nodes = false;
+        break;
+      }
+      gain += node_gain(context_, node_id, node, registration);
+    }
+    const double transfer_cost =
+        cost_per_byte *
+        (NonConstantTensorBytes(context_, partition->input_tensors) +
+         NonConstantTensorBytes(context_, partition->output_tensors));
+    if (has_all_nodes && gain > transfer_cost) {
+      profitable_partitions.emplace_back(gain - transfer_cost, partition);
+    }
+  }
+  std::stable_sort(profitable_partitions.begin(), profitable_partitions.end(),
+                   [](const auto& left, const auto& right) {
+                     return left.first > right.first;
+                   });
+
+  std::vector<int> ops_to_replace;
+  const int num_partitions = std::min<int>(n, profitable_partitions.size());
+  for (int i = 0; i < num_partitions; ++i) {
+    const TfLiteIntArray* nodes =
+        profitable_partitions[i].second->nodes_to_replace;
+    ops_to_replace.insert(ops_to_replace.end(), nodes->data,
+                          nodes->data + nodes->size);
+  }
+  return ops_to_replace;
+}
+
 TfLiteStatus GraphPartitionHelper::PrepareSupportedNodes(
     std::set<std::string>* unsupported_nodes_info, int start_node_index,
     int end_node_index) {
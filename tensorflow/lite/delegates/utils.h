@@ -96,6 +96,12 @@ using IsNodeSupportedFn =
     std::function<bool(TfLiteContext*, TfLiteNode*, TfLiteRegistration*,
                        std::string* unsupported_details)>;
 
+// Returns the estimated cost, in units of time, that delegating the node saves
+// compared to running it on the CPU.
+using NodeDelegationGainFn =
+    std::function<double(TfLiteContext*, int node_index, TfLiteNode*,
+                         TfLiteRegistration*)>;
+
 // A utility class to help model graph parition.
 // Note the class *needs* to be used in TfLiteDelegate::Prepare.
 class GraphPartitionHelper {
@@ -160,6 +166,17 @@ class GraphPartitionHelper {
     return GetNodesOfFirstNLargestPartitionsImpl(n, min_nodes_per_partition);
   }
 
+  // Returns a list of node indices of all nodes from the partitions which are
+  // worth delegating, keeping at most the `n` most profitable ones.
+  // Delegating a partition saves the sum of the `node_gain` of its nodes, and
+  // costs `cost_per_byte` for every byte of its non-constant input and output
+  // tensors, which are transferred between the CPU and the delegate at the
+  // partition boundaries. Partitions whose gain doesn't exceed that cost,
+  // like a few cheap ops between unsupported ones, are left on the CPU.
+  std::vector<int> GetNodesOfProfitablePartitions(
+      const NodeDelegationGainFn& node_gain, double cost_per_byte,
+      int n = std::numeric_limits<int>::max()) const;
+
   int num_total_nodes() const { return num_total_nodes_; }
   int num_supported_nodes() const { return num_supported_nodes_; }
   int num_partitions() const { return partitions_.size(); }
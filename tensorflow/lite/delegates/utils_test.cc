@@ -24,6 +24,7 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/util.h"
 
 namespace tflite {
 namespace delegates {
@@ -295,6 +296,45 @@ TEST(GraphPartitionHelper, CheckPartitionsWithSupportedNodeList) {
   EXPECT_THAT(nodes, testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9}));
 }
 
+TEST(GraphPartitionHelper, CheckProfitablePartitions) {
+  // The mocked TfLiteContext has 4 partitions: {1}, {0,3,7,8}, {2,4,9}, {5,6}.
+  // Each partition reads tensor i and writes tensor i + 4 for partition i.
+  MockTfLiteContext mocked_context;
+  TfLiteTensor tensors[8] = {};
+  for (int i = 0; i < 8; ++i) tensors[i].bytes = 100;
+  // The input of the last partition is a constant, which isn't transferred.
+  tensors[3].allocation_type = kTfLiteMmapRo;
+  mocked_context.tensors = tensors;
+  mocked_context.tensors_size = 8;
+  TfLiteDelegateParams* params = mocked_context.delegate_params();
+  for (int i = 0; i < 4; ++i) {
+    params[i].input_tensors = ConvertVectorToTfLiteIntArray({i});
+    params[i].output_tensors = ConvertVectorToTfLiteIntArray({i + 4});
+  }
+  GraphPartitionHelper helper(&mocked_context, IsNodeSupported);
+  EXPECT_EQ(kTfLiteOk, helper.Partition(nullptr));
+
+  // Nodes 0 to 4 save 60 each, nodes 5 to 9 save 20 each.
+  auto node_gain = [](TfLiteContext*, int node_index, TfLiteNode*,
+                      TfLiteRegistration*) -> double {
+    return node_index < 5 ? 60 : 20;
+  };
+  // Transferring a tensor costs 50. Partition {1} saves 60 but costs 100,
+  // {0,3,7,8} saves 160, {2,4,9} saves 140, and {5,6} saves 40 while its
+  // output alone costs 50.
+  EXPECT_THAT(helper.GetNodesOfProfitablePartitions(node_gain,
+                                                    /*cost_per_byte=*/0.5),
+              testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9}));
+  EXPECT_THAT(helper.GetNodesOfProfitablePartitions(
+                  node_gain, /*cost_per_byte=*/0.5, /*n=*/1),
+              testing::ElementsAreArray({0, 3, 7, 8}));
+  // Without transfer cost, every partition is worth delegating, the most
+  // profitable ones first.
+  EXPECT_THAT(helper.GetNodesOfProfitablePartitions(node_gain,
+                                                    /*cost_per_byte=*/0),
+              testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9, 1, 5, 6}));
+}
+
 }  // namespace
 }  // namespace delegates
 }  // namespace tflite
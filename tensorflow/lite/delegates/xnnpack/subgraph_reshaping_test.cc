@@ -0,0 +1,169 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/builtin_op_data.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace xnnpack {
+namespace {
+
+// Counts the calls to TfLiteContext::ResizeTensor made through a copy of the
+// context of an interpreter, and fails them if `fail` is set.
+struct ResizeTensorCounter {
+  static TfLiteStatus ResizeTensor(TfLiteContext* context,
+                                   TfLiteTensor* tensor,
+                                   TfLiteIntArray* new_size) {
+    ++num_calls;
+    if (fail) {
+      TfLiteIntArrayFree(new_size);
+      return kTfLiteError;
+    }
+    return resize_tensor(context, tensor, new_size);
+  }
+
+  static inline int num_calls = 0;
+  static inline bool fail = false;
+  static inline TfLiteStatus (*resize_tensor)(TfLiteContext*, TfLiteTensor*,
+                                              TfLiteIntArray*) = nullptr;
+};
+
+// Adds two float tensors in a partition of the XNNPack delegate with subgraph
+// reshaping enabled.
+class SubgraphReshapingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    TfLiteXNNPackDelegateOptions options =
+        TfLiteXNNPackDelegateOptionsDefault();
+    options.flags |= TFLITE_XNNPACK_DELEGATE_FLAG_ENABLE_SUBGRAPH_RESHAPING;
+    delegate_.reset(TfLiteXNNPackDelegateCreate(&options));
+
+    ASSERT_EQ(interpreter_.AddTensors(3), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetInputs({0, 1}), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetOutputs({2}), kTfLiteOk);
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(
+                    i, kTfLiteFloat32, "", {1, 2, 2, 3},
+                    TfLiteQuantizationParams()),
+                kTfLiteOk);
+    }
+    ops::builtin::BuiltinOpResolver resolver;
+    auto* params =
+        static_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+    params->activation = kTfLiteActNone;
+    params->pot_scale_int16 = false;
+    ASSERT_EQ(interpreter_.AddNodeWithParameters(
+                  {0, 1}, {2}, nullptr, 0, params,
+                  resolver.FindOp(BuiltinOperator_ADD, 1)),
+              kTfLiteOk);
+
+    ASSERT_EQ(interpreter_.ModifyGraphWithDelegate(delegate_.get()),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_.execution_plan().size(), 1);
+    ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  }
+
+  // Prepares the delegate kernel again and returns how many output tensors
+  // it resized, which it does after reshaping its XNNPack runtime. Resizing
+  // fails if `fail_resizes` is set.
+  int PrepareAndCountResizes(bool fail_resizes = false) {
+    const int node_index = interpreter_.execution_plan()[0];
+    const auto* node_and_registration =
+        interpreter_.node_and_registration(node_index);
+    TfLiteContext context = *interpreter_.primary_subgraph().context();
+    ResizeTensorCounter::num_calls = 0;
+    ResizeTensorCounter::fail = fail_resizes;
+    ResizeTensorCounter::resize_tensor = context.ResizeTensor;
+    context.ResizeTensor = ResizeTensorCounter::ResizeTensor;
+    EXPECT_EQ(node_and_registration->second.prepare(
+                  &context, const_cast<TfLiteNode*>(
+                                &node_and_registration->first)),
+              fail_resizes ? kTfLiteError : kTfLiteOk);
+    return ResizeTensorCounter::num_calls;
+  }
+
+  // Checks that invoking the interpreter adds inputs of `shape`.
+  void ExpectAdds(const std::vector<int>& shape) {
+    ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+    const TfLiteTensor* output = interpreter_.tensor(2);
+    ASSERT_EQ(output->dims->size, shape.size());
+    int size = 1;
+    for (int i = 0; i < shape.size(); ++i) {
+      EXPECT_EQ(output->dims->data[i], shape[i]);
+      size *= shape[i];
+    }
+    float* input1 = interpreter_.typed_input_tensor<float>(0);
+    float* input2 = interpreter_.typed_input_tensor<float>(1);
+    for (int i = 0; i < size; ++i) {
+      input1[i] = i;
+      input2[i] = 100 * i;
+    }
+    ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+    const float* sum = interpreter_.typed_output_tensor<float>(0);
+    for (int i = 0; i < size; ++i) EXPECT_EQ(sum[i], 101 * i) << i;
+  }
+
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      delegate_{nullptr, TfLiteXNNPackDelegateDelete};
+  Interpreter interpreter_;
+};
+
+TEST_F(SubgraphReshapingTest, ResizeToSameShape) {
+  ExpectAdds({1, 2, 2, 3});
+  ASSERT_EQ(interpreter_.ResizeInputTensor(0, {1, 2, 2, 3}), kTfLiteOk);
+  ASSERT_EQ(interpreter_.ResizeInputTensor(1, {1, 2, 2, 3}), kTfLiteOk);
+  EXPECT_EQ(PrepareAndCountResizes(), 0);
+  ExpectAdds({1, 2, 2, 3});
+}
+
+TEST_F(SubgraphReshapingTest, ResizeToDifferentShape) {
+  ExpectAdds({1, 2, 2, 3});
+  ASSERT_EQ(interpreter_.ResizeInputTensor(0, {2, 3, 2, 3}), kTfLiteOk);
+  ASSERT_EQ(interpreter_.ResizeInputTensor(1, {2, 3, 2, 3}), kTfLiteOk);
+  EXPECT_EQ(PrepareAndCountResizes(), 1);
+  // The runtime is only reshaped again when the shapes change again.
+  EXPECT_EQ(PrepareAndCountResizes(), 0);
+  ExpectAdds({2, 3, 2, 3});
+
+  ASSERT_EQ(interpreter_.ResizeInputTensor(0, {1, 2, 2, 3}), kTfLiteOk);
+  ASSERT_EQ(interpreter_.ResizeInputTensor(1, {1, 2, 2, 3}), kTfLiteOk);
+  EXPECT_EQ(PrepareAndCountResizes(), 1);
+  ExpectAdds({1, 2, 2, 3});
+}
+
+TEST_F(SubgraphReshapingTest, RetriesFailedReshape) {
+  ExpectAdds({1, 2, 2, 3});
+  ASSERT_EQ(interpreter_.ResizeInputTensor(0, {2, 3, 2, 3}), kTfLiteOk);
+  ASSERT_EQ(interpreter_.ResizeInputTensor(1, {2, 3, 2, 3}), kTfLiteOk);
+  EXPECT_EQ(PrepareAndCountResizes(/*fail_resizes=*/true), 1);
+  // The failed Prepare did not record the new shapes, so the next one
+  // reshapes the runtime and resizes the output again.
+  EXPECT_EQ(PrepareAndCountResizes(), 1);
+  EXPECT_EQ(PrepareAndCountResizes(), 0);
+  ExpectAdds({2, 3, 2, 3});
+}
+
+}  // namespace
+}  // namespace xnnpack
+}  // namespace tflite
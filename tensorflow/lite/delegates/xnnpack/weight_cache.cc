@@ -32,8 +32,11 @@ limitations under the License.
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <memory>
+#include <random>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_map>
 #include <utility>
 
@@ -83,6 +86,71 @@ bool FileExists(const char* path) {
   return access(path, F_OK) != -1;
 }
 
+// Identifies the XNNPack packing code, which doesn't expose a version at
+// runtime. This must be updated along with the XNNPack commit in
+// tensorflow/workspace2.bzl so that caches of other versions aren't loaded.
+constexpr char kXNNPackVersion[] = "bfea23551ac47c9d71b82120b299ff6173fc9097";
+
+// Combines `size` bytes of `data` into `hash` (FNV-1a over 8 byte words).
+uint64_t HashBytes(const void* data, size_t size, uint64_t hash) {
+  constexpr uint64_t kPrime = 0x100000001b3;
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (; size >= sizeof(uint64_t);
+       size -= sizeof(uint64_t), bytes += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    hash = (hash ^ word) * kPrime;
+  }
+  for (; size > 0; --size, ++bytes) {
+    hash = (hash ^ *bytes) * kPrime;
+  }
+  return hash;
+}
+
+// Returns a description of the CPU features of the host, since the packing
+// algorithms XNNPack chooses depend on them.
+std::string GetHostCpuFeatures() {
+  std::string features;
+#if defined(__linux__) || defined(__ANDROID__)
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  for (std::string line; std::getline(cpuinfo, line);) {
+    // x86 lists the features as `flags`, Arm as `Features`.
+    if (line.rfind("flags", 0) == 0 || line.rfind("Features", 0) == 0) {
+      features = line;
+      break;
+    }
+  }
+#endif
+  return features;
+}
+
+// Returns the name of the cache file of the model whose constant tensors are
+// given by `tensor_index_to_identifier`.
+std::string GetCacheFileName(
+    const TfLiteTensor* tensors,
+    const std::unordered_map<size_t, size_t>& tensor_index_to_identifier) {
+  // The map isn't ordered, so the hashes of the tensors are summed up.
+  uint64_t model_hash = tensor_index_to_identifier.size();
+  for (const auto [index, identifier] : tensor_index_to_identifier) {
+    const TfLiteTensor& tensor = tensors[index];
+    uint64_t hash = HashBytes(&identifier, sizeof(identifier),
+                              /*hash=*/0xcbf29ce484222325);
+    hash = HashBytes(&tensor.type, sizeof(tensor.type), hash);
+    if (tensor.data.data != nullptr) {
+      hash = HashBytes(tensor.data.data, tensor.bytes, hash);
+    }
+    model_hash += hash;
+  }
+  const std::string host = GetHostCpuFeatures() + kXNNPackVersion;
+  const uint64_t host_hash =
+      HashBytes(host.data(), host.size(), /*hash=*/0xcbf29ce484222325);
+  char name[64];
+  snprintf(name, sizeof(name), "%016llx-%016llx.xnn_weights",
+           static_cast<unsigned long long>(model_hash),  // NOLINT(runtime/int)
+           static_cast<unsigned long long>(host_hash));  // NOLINT(runtime/int)
+  return name;
+}
+
 }  // namespace
 
 void swap(MMapHandle& a, MMapHandle& b) {
@@ -311,9 +379,27 @@ MMapWeightCacheProvider& MMapWeightCacheProvider::operator=(
   swap(mmap_handle_, other.mmap_handle_);
   swap(mmap_buffer_base_offset_, other.mmap_buffer_base_offset_);
   swap(builder_, other.builder_);
+  swap(cache_directory_, other.cache_directory_);
+  swap(finalized_builder_, other.finalized_builder_);
+  swap(writer_, other.writer_);
   return *this;
 }
 
+MMapWeightCacheProvider::~MMapWeightCacheProvider() { JoinWriter(); }
+
+void MMapWeightCacheProvider::JoinWriter() {
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+}
+
+void MMapWeightCacheProvider::SetCacheDirectory(const char* directory) {
+  XNNPACK_ABORT_CHECK(
+      !IsFinalized(),
+      "Cannot change the directory of a cache that has already been loaded.");
+  cache_directory_ = directory;
+}
+
 void MMapWeightCacheProvider::SetFilePath(const char* path) {
   XNNPACK_ABORT_CHECK(
       !IsFinalized(),
@@ -394,6 +480,24 @@ void MMapWeightCacheProvider::MapTensorIdentifiers(
                         "Tensor index corresponds to a non existing tensor.");
     buffer_address_to_identifier_[tensors[index].data.data] = identifier;
   }
+
+  if (file_path_.empty() && !cache_directory_.empty()) {
+    SetFilePath(
+        (cache_directory_ + "/" +
+         GetCacheFileName(tensors, tensor_index_to_identifier))
+            .c_str());
+    if (Load()) {
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_INFO,
+                      "XNNPack weight cache: loaded '%s'.", file_path_.c_str());
+    } else {
+      // An invalid file is replaced once the cache is built.
+      mmap_handle_.UnMap();
+      cache_key_to_offset_.clear();
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_INFO,
+                      "XNNPack weight cache: building '%s'.",
+                      file_path_.c_str());
+    }
+  }
 }
 
 size_t MMapWeightCacheProvider::LookUp(
@@ -441,6 +545,11 @@ void* MMapWeightCacheProvider::OffsetToAddr(const size_t offset) {
   XNNPACK_ABORT_CHECK(
       IsFinalized(),
       "Cannot get the address of a buffer in a non finalized cache.");
+  if (finalized_builder_) {
+    // XNNPack only reads the packed weights.
+    return const_cast<uint8_t*>(finalized_builder_->BufferData().data()) +
+           offset;
+  }
   return mmap_handle_.data() + mmap_buffer_base_offset_ + offset;
 }
 
@@ -450,6 +559,8 @@ void MMapWeightCacheProvider::Release() {
   mmap_handle_ = MMapHandle();
   mmap_buffer_base_offset_ = 0;
   builder_ = WeightCacheBuilder();
+  // The writer keeps its own reference to the builder.
+  finalized_builder_.reset();
 }
 
 bool MMapWeightCacheProvider::Finalize() {
@@ -462,6 +573,31 @@ bool MMapWeightCacheProvider::Finalize() {
                     "finalize the cache.");
     return false;
   }
+  if (!cache_directory_.empty()) {
+    JoinWriter();
+    finalized_builder_ =
+        std::make_shared<WeightCacheBuilder>(std::move(builder_));
+    builder_ = WeightCacheBuilder();
+    // The file is written under a temporary name and then renamed, so that
+    // other processes never map a partially written cache.
+    const std::string temporary_path =
+        file_path_ + "." + std::to_string(std::random_device()()) + ".tmp";
+    writer_ = std::thread([builder = finalized_builder_, temporary_path,
+                           path = file_path_] {
+      if (!builder->Write(temporary_path.c_str())) {
+        unlink(temporary_path.c_str());
+        return;
+      }
+      if (rename(temporary_path.c_str(), path.c_str()) != 0) {
+        TFLITE_LOG_PROD(tflite::TFLITE_LOG_ERROR,
+                        "XNNPack weight cache: could not rename '%s' to '%s': "
+                        "%s.",
+                        temporary_path.c_str(), path.c_str(), strerror(errno));
+        unlink(temporary_path.c_str());
+      }
+    });
+    return true;
+  }
   if (!builder_.Write(file_path_.c_str())) {
     return false;
   }
@@ -471,7 +607,7 @@ bool MMapWeightCacheProvider::Finalize() {
 }
 
 bool MMapWeightCacheProvider::IsFinalized() const {
-  return mmap_handle_.IsMapped();
+  return mmap_handle_.IsMapped() || finalized_builder_ != nullptr;
 }
 
 size_t MMapWeightCacheProvider::look_up(
@@ -18,7 +18,9 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_map>
 #include <vector>
 
@@ -166,9 +168,15 @@ class WeightCacheBuilder {
 //  - Load the cache file.
 //  - Finalize the cache before calling the run functions of XNNPack (setup and
 //    reshape are ok).
+//
+// With `SetCacheDirectory`, the cache file is instead chosen and loaded by
+// `MapTensorIdentifiers`. If it doesn't exist yet, `Finalize` serves the
+// packed weights from memory and writes the file in the background for the
+// next runs, or other processes, to map.
 class MMapWeightCacheProvider {
  public:
   MMapWeightCacheProvider() = default;
+  ~MMapWeightCacheProvider();
   MMapWeightCacheProvider(const MMapWeightCacheProvider&) = delete;
   MMapWeightCacheProvider& operator=(const MMapWeightCacheProvider&) = delete;
   MMapWeightCacheProvider(MMapWeightCacheProvider&&);
@@ -181,6 +189,15 @@ class MMapWeightCacheProvider {
 
   const std::string& GetFilePath() const { return file_path_; }
 
+  // Enables the automatic cache mode: the cache file is stored in `directory`
+  // and named after the hash of the model weights and of the host CPU
+  // features.
+  //
+  // WARNING: Can only be called if the cache isn't finalized.
+  void SetCacheDirectory(const char* directory);
+
+  const std::string& GetCacheDirectory() const { return cache_directory_; }
+
   // Set the weight file path and loads it.
   [[nodiscard /*Loading a cache file may fail.*/]]
   bool Load(const std::string& path);
@@ -190,6 +207,9 @@ class MMapWeightCacheProvider {
   bool Load();
 
   // Creates the tensor map.
+  //
+  // In the automatic cache mode, this also loads the cache file of the model
+  // the first time it's called.
   void MapTensorIdentifiers(
       const TfLiteTensor* tensors, size_t size,
       const std::unordered_map<size_t, size_t>& tensor_index_to_identifier);
@@ -230,7 +250,8 @@ class MMapWeightCacheProvider {
   // Ensures that the cache is ready.
   //
   // If the cache file already exists, this is a no-op. Otherwise, this writes
-  // the file to disk and reloads it.
+  // the file to disk and reloads it. In the automatic cache mode, the file is
+  // written by a background thread instead.
   [[nodiscard /*Writing the cache file may fail.*/]]
   bool Finalize();
 
@@ -240,8 +261,10 @@ class MMapWeightCacheProvider {
   // Returns true if any weights have been added to the underlying builder.
   bool IsBuilding() const { return !IsFinalized() && !file_path_.empty(); };
 
-  // Returns true if a file is mapped or a file path is set.
-  bool IsActive() const { return IsFinalized() || !file_path_.empty(); };
+  // Returns true if a file is mapped or a file path or directory is set.
+  bool IsActive() const {
+    return IsFinalized() || !file_path_.empty() || !cache_directory_.empty();
+  };
 
   // Returns the cache provider expected by XNNPack.
   xnn_weights_cache_provider& GetCacheProvider() { return cache_provider_; }
@@ -271,6 +294,9 @@ class MMapWeightCacheProvider {
   // Hashes a cache key to lookup in `cache_key_to_identifier_`.
   PackIdentifier BuildPackIdentifier(const xnn_weights_cache_look_up_key& key);
 
+  // Waits for the background write of the cache file, if any.
+  void JoinWriter();
+
   // Cache provider implementation for XNNPack.
   xnn_weights_cache_provider cache_provider_{
       .context = this,
@@ -284,6 +310,9 @@ class MMapWeightCacheProvider {
   // Path to the cache file.
   std::string file_path_;
 
+  // Directory of the cache files in the automatic cache mode, or empty.
+  std::string cache_directory_;
+
   // Maps buffer addresses to buffer identifiers.
   std::unordered_map<const void*, uint64_t> buffer_address_to_identifier_;
 
@@ -299,6 +328,13 @@ class MMapWeightCacheProvider {
 
   // Used to build the cache.
   WeightCacheBuilder builder_;
+
+  // In the automatic cache mode, holds the packed weights after `Finalize`
+  // until the cache file is mapped by the next run. Shared with `writer_`.
+  std::shared_ptr<WeightCacheBuilder> finalized_builder_;
+
+  // Writes `finalized_builder_` to `file_path_`.
+  std::thread writer_;
 };
 
 }  // namespace xnnpack
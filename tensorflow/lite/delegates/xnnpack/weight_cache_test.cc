@@ -726,5 +726,71 @@ TEST(MMapWeightCacheProviderTest, XnnpackCApiJourney) {
   }
 }
 
+TEST(MMapWeightCacheProviderTest, CacheDirectoryBuildsThenLoads) {
+  // The weights are the unique temporary file name so that the cache file
+  // name doesn't collide with other runs of the test.
+  TempFileDesc temp_fd(TempFileDesc::kAutoCLose);
+  const std::string& weights = temp_fd.GetPath();
+  const std::string directory = weights.substr(0, weights.find_last_of("/\\"));
+  const int32_t fake_packing_algo_seed = 0xBA0BAB;
+  const char packed_data_ref[] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+  TfLiteTensor tensors[2] = {};
+  std::unordered_map<size_t, size_t> tensor_buffer_identifiers;
+  for (int i = 0; i < 2; ++i) {
+    tensors[i].type = kTfLiteUInt8;
+    tensors[i].data.data = const_cast<char*>(weights.data()) + i;
+    tensors[i].bytes = weights.size() - i;
+    tensor_buffer_identifiers[i] = i;
+  }
+  const xnn_weights_cache_look_up_key look_up_key{
+      .seed = fake_packing_algo_seed,
+      .kernel = tensors[0].data.data,
+      .bias = tensors[1].data.data};
+
+  std::string cache_file_path;
+  {  // Build scenario.
+    MMapWeightCacheProvider cache_provider;
+    cache_provider.SetCacheDirectory(directory.c_str());
+    ASSERT_TRUE(cache_provider.IsActive());
+    cache_provider.MapTensorIdentifiers(tensors, std::size(tensors),
+                                        tensor_buffer_identifiers);
+    ASSERT_FALSE(cache_provider.IsFinalized());
+    cache_file_path = cache_provider.GetFilePath();
+    EXPECT_EQ(cache_file_path.rfind(directory, 0), 0);
+
+    xnn_weights_cache_t cache = &cache_provider.GetCacheProvider();
+    const size_t offset = cache->look_up_or_insert(
+        cache, &look_up_key, (void*)packed_data_ref, sizeof(packed_data_ref));
+    ASSERT_TRUE(cache_provider.Finalize());
+    ASSERT_TRUE(cache->is_finalized(cache));
+
+    // The packed data is served from memory while the file is written.
+    ASSERT_EQ(cache->look_up(cache, &look_up_key), offset);
+    const void* const packed_data = cache->offset_to_addr(cache, offset);
+    ASSERT_NE(packed_data, nullptr);
+    EXPECT_THAT(LightSpan<const char>(packed_data, sizeof(packed_data_ref)),
+                ElementsAreArray(packed_data_ref));
+  }
+
+  {  // Load scenario: the same weights map the file written above.
+    MMapWeightCacheProvider cache_provider;
+    cache_provider.SetCacheDirectory(directory.c_str());
+    cache_provider.MapTensorIdentifiers(tensors, std::size(tensors),
+                                        tensor_buffer_identifiers);
+    ASSERT_TRUE(cache_provider.IsFinalized());
+    EXPECT_EQ(cache_provider.GetFilePath(), cache_file_path);
+
+    xnn_weights_cache_t cache = &cache_provider.GetCacheProvider();
+    const size_t offset = cache->look_up(cache, &look_up_key);
+    ASSERT_NE(offset, SIZE_MAX);
+    const void* const packed_data = cache->offset_to_addr(cache, offset);
+    ASSERT_NE(packed_data, nullptr);
+    EXPECT_THAT(LightSpan<const char>(packed_data, sizeof(packed_data_ref)),
+                ElementsAreArray(packed_data_ref));
+  }
+  std::remove(cache_file_path.c_str());
+}
+
 }  // namespace
 }  // namespace tflite::xnnpack
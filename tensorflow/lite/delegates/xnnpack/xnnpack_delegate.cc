@@ -47,6 +47,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/utils/sparsity_format_converter.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/kernels/shared_thread_pools.h"
 #include "tensorflow/lite/logger.h"
 #include "tensorflow/lite/minimal_logging.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -516,8 +517,20 @@ class Delegate {
     } else {
       own_threadpool_ = true;
       if (options != nullptr && options->num_threads > 1) {
-        threadpool_.reset(
-            pthreadpool_create(static_cast<size_t>(options->num_threads)));
+        if (shared_thread_pools::IsEnabled()) {
+          // The shared threadpool is kept alive by `shared_threadpool_`.
+          shared_threadpool_ = shared_thread_pools::GetOrCreate<pthreadpool>(
+              options->num_threads, [](int num_threads) {
+                return std::shared_ptr<pthreadpool>(
+                    pthreadpool_create(static_cast<size_t>(num_threads)),
+                    &pthreadpool_destroy);
+              });
+          threadpool_.reset(shared_threadpool_.get());
+          own_threadpool_ = false;
+        } else {
+          threadpool_.reset(
+              pthreadpool_create(static_cast<size_t>(options->num_threads)));
+        }
         threadpool = threadpool_.get();
       }
     }
@@ -549,6 +562,18 @@ class Delegate {
                 weight_cache_provider_.GetCacheProvider().context);
         options_.experimental_weight_cache_file_path =
             weight_cache_provider_.GetFilePath().data();
+      } else if (options_.experimental_weight_cache_directory) {
+        // The cache file is chosen once the weights are known.
+        weight_cache_provider_.SetCacheDirectory(
+            options_.experimental_weight_cache_directory);
+        TFLITE_LOG(tflite::TFLITE_LOG_INFO,
+                   "XNNPack weight cache enabled in '%s'.",
+                   options_.experimental_weight_cache_directory);
+        options_.weights_cache =
+            reinterpret_cast<TfLiteXNNPackDelegateWeightsCache*>(
+                weight_cache_provider_.GetCacheProvider().context);
+        options_.experimental_weight_cache_directory =
+            weight_cache_provider_.GetCacheDirectory().data();
       } else {
         TFLITE_LOG(tflite::TFLITE_LOG_INFO,
                    "XNNPack weight cache not enabled.");
@@ -729,6 +754,9 @@ class Delegate {
       nullptr, &pthreadpool_destroy};
   // Boolean that indicates if threadpool_ was created by xnnpack_delegate.
   bool own_threadpool_;
+  // The process-wide threadpool in `threadpool_`, if `shared_thread_pools` is
+  // enabled.
+  std::shared_ptr<pthreadpool> shared_threadpool_;
 #endif
   std::unique_ptr<xnn_workspace, decltype(&xnn_release_workspace)> workspace_{
       nullptr, &xnn_release_workspace};
@@ -1167,10 +1195,23 @@ class Subgraph {
     }
 
     if (enable_subgraph_reshaping) {
+      // The interpreter prepares all the nodes again whenever any tensor is
+      // resized. Reshaping the runtime invalidates its setup, so it only
+      // happens when the shapes of the inputs of the partition changed.
+      if (InputShapesMatchRuntime(context)) {
+        return kTfLiteOk;
+      }
+      // The shapes are only recorded once every step succeeded, so that a
+      // failed Prepare is retried in full for the same shapes.
+      runtime_reshaped_ = false;
+      std::vector<std::vector<int>> input_shapes;
+      input_shapes.reserve(inputs_.size());
       xnn_status status = xnn_status_invalid_state;
       for (int i = 0; i < inputs_.size(); ++i) {
         const TfLiteTensor* tensor = &context->tensors[inputs_[i]];
         const int dims_count = NumDimensions(tensor);
+        input_shapes.emplace_back(&tensor->dims->data[0],
+                                  &tensor->dims->data[dims_count]);
         std::array<size_t, XNN_MAX_TENSOR_DIMS> xnn_dims;
         std::copy(&tensor->dims->data[0], &tensor->dims->data[dims_count],
                   xnn_dims.begin());
@@ -1215,10 +1256,29 @@ class Subgraph {
           return kTfLiteError;
         }
       }
+      runtime_input_shapes_ = std::move(input_shapes);
+      runtime_reshaped_ = true;
     }
     return kTfLiteOk;
   }
 
+  // Returns true if the runtime was last reshaped for the current shapes of
+  // the inputs of the partition.
+  bool InputShapesMatchRuntime(TfLiteContext* context) const {
+    if (!runtime_reshaped_ || runtime_input_shapes_.size() != inputs_.size()) {
+      return false;
+    }
+    for (int i = 0; i < inputs_.size(); ++i) {
+      const TfLiteIntArray* dims = context->tensors[inputs_[i]].dims;
+      const std::vector<int>& runtime_dims = runtime_input_shapes_[i];
+      if (dims->size != runtime_dims.size() ||
+          !std::equal(runtime_dims.begin(), runtime_dims.end(), dims->data)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   TfLiteStatus Invoke(TfLiteContext* context, bool enable_subgraph_reshaping,
                       Delegate* delegate) {
     std::lock_guard<std::mutex> lock(delegate->workspace_mutex_);
@@ -7400,6 +7460,10 @@ class Subgraph {
   // The output tensors to the XNNPack partition. Not all node output tensors
   // are consumed by XNNPack.
   std::vector<int> outputs_;
+  // The shapes of `inputs_` the runtime was last reshaped for, if
+  // `runtime_reshaped_`. Only set once Prepare fully succeeded.
+  std::vector<std::vector<int>> runtime_input_shapes_;
+  bool runtime_reshaped_ = false;
   // Mapping from TFLite Tensor IDs for tensors in the delegated subgraph to
   // the XNNPACK ID.
   std::unordered_map<int, uint32_t> tflite_tensor_to_xnnpack_;
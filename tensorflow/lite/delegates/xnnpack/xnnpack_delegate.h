@@ -72,6 +72,13 @@ typedef struct {
   //
   // WARNING this is an experimental flag.
   const char* experimental_weight_cache_file_path;
+  // Directory of the weight caches to use if neither `weight_cache` nor
+  // `experimental_weight_cache_file_path` are defined. The cache of a model is
+  // named after its weights and the host CPU. It is built by the first run and
+  // mapped by the next ones, which share its memory across processes.
+  //
+  // WARNING this is an experimental flag.
+  const char* experimental_weight_cache_directory;
 } TfLiteXNNPackDelegateOptions;
 
 // Returns a structure with the default XNNPack delegate options.
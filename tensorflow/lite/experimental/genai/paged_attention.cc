@@ -0,0 +1,99 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/genai/paged_attention.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace llm {
+
+TfLiteStatus PagedAttention(const resource::PagedCacheBuffer& key_cache,
+                            const resource::PagedCacheBuffer& value_cache,
+                            int layer, const float* query, int num_queries,
+                            int first_position, int num_query_heads,
+                            int head_dim, float scale, float* output) {
+  const int entry_size = key_cache.entry_size();
+  if (value_cache.entry_size() != entry_size || head_dim <= 0 ||
+      entry_size % head_dim != 0) {
+    return kTfLiteError;
+  }
+  const int num_kv_heads = entry_size / head_dim;
+  if (num_query_heads % num_kv_heads != 0) return kTfLiteError;
+  const int num_queries_per_kv_head = num_query_heads / num_kv_heads;
+  const int64_t num_entries = std::min(key_cache.GetNumEntries(layer),
+                                       value_cache.GetNumEntries(layer));
+  if (first_position < 0 || first_position + num_queries > num_entries) {
+    return kTfLiteError;
+  }
+
+  std::vector<float> key(entry_size);
+  std::vector<float> value(entry_size);
+  // The running maximum and sum of the exponentials of the scores of every
+  // query head.
+  std::vector<float> max_score(num_query_heads);
+  std::vector<float> sum(num_query_heads);
+  for (int i = 0; i < num_queries; ++i) {
+    const float* q = query + i * num_query_heads * head_dim;
+    float* out = output + i * num_query_heads * head_dim;
+    std::fill(out, out + num_query_heads * head_dim, 0.0f);
+    std::fill(max_score.begin(), max_score.end(),
+              -std::numeric_limits<float>::infinity());
+    std::fill(sum.begin(), sum.end(), 0.0f);
+    for (int slot = 0; slot <= first_position + i; ++slot) {
+      key_cache.ReadEntry(layer, slot, key.data());
+      value_cache.ReadEntry(layer, slot, value.data());
+      for (int h = 0; h < num_query_heads; ++h) {
+        const int kv_offset = (h / num_queries_per_kv_head) * head_dim;
+        const float* q_head = q + h * head_dim;
+        float score = 0.0f;
+        for (int d = 0; d < head_dim; ++d) {
+          score += q_head[d] * key[kv_offset + d];
+        }
+        score *= scale;
+        // Rescale what was accumulated so far when the maximum changes.
+        const float new_max = std::max(max_score[h], score);
+        const float correction = std::exp(max_score[h] - new_max);
+        const float weight = std::exp(score - new_max);
+        float* out_head = out + h * head_dim;
+        for (int d = 0; d < head_dim; ++d) {
+          out_head[d] =
+              out_head[d] * correction + weight * value[kv_offset + d];
+        }
+        sum[h] = sum[h] * correction + weight;
+        max_score[h] = new_max;
+      }
+    }
+    for (int h = 0; h < num_query_heads; ++h) {
+      float* out_head = out + h * head_dim;
+      for (int d = 0; d < head_dim; ++d) out_head[d] /= sum[h];
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace llm
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
@@ -0,0 +1,46 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_GENAI_PAGED_ATTENTION_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_GENAI_PAGED_ATTENTION_H_
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace llm {
+
+// Computes the causal scaled dot product attention of the `num_queries`
+// queries at positions [first_position, first_position + num_queries) to the
+// entries of `layer` of the key and value caches. The query has shape
+// <num_queries, num_query_heads, head_dim> and the cache entries have shape
+// <num_kv_heads, head_dim>, where num_query_heads is a multiple of
+// num_kv_heads. The output has the shape of the query.
+// The entries are read page by page with an online softmax, so that neither a
+// contiguous copy of the caches nor the attention scores are materialized.
+TfLiteStatus PagedAttention(const resource::PagedCacheBuffer& key_cache,
+                            const resource::PagedCacheBuffer& value_cache,
+                            int layer, const float* query, int num_queries,
+                            int first_position, int num_query_heads,
+                            int head_dim, float scale, float* output);
+
+}  // namespace llm
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_GENAI_PAGED_ATTENTION_H_
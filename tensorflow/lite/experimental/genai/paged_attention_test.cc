@@ -0,0 +1,151 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/genai/paged_attention.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace llm {
+namespace {
+
+using ::tflite::resource::PagedCacheBuffer;
+
+std::vector<float> PseudoRandom(int size, float phase) {
+  std::vector<float> values(size);
+  for (int i = 0; i < size; ++i) values[i] = std::sin(i * 0.37f + phase);
+  return values;
+}
+
+// Materializes the causal attention scores of every query head.
+std::vector<float> ReferenceAttention(const std::vector<float>& query,
+                                      const std::vector<float>& keys,
+                                      const std::vector<float>& values,
+                                      int num_queries, int first_position,
+                                      int num_query_heads, int num_kv_heads,
+                                      int head_dim, float scale) {
+  const int group = num_query_heads / num_kv_heads;
+  std::vector<float> output(query.size(), 0.0f);
+  for (int i = 0; i < num_queries; ++i) {
+    const int num_slots = first_position + i + 1;
+    for (int h = 0; h < num_query_heads; ++h) {
+      const float* q = &query[(i * num_query_heads + h) * head_dim];
+      const int kv_offset = (h / group) * head_dim;
+      std::vector<float> scores(num_slots);
+      for (int s = 0; s < num_slots; ++s) {
+        scores[s] = 0.0f;
+        for (int d = 0; d < head_dim; ++d) {
+          scores[s] += q[d] * keys[s * num_kv_heads * head_dim + kv_offset + d];
+        }
+        scores[s] *= scale;
+      }
+      const float max_score = *std::max_element(scores.begin(), scores.end());
+      float sum = 0.0f;
+      for (float& score : scores) {
+        score = std::exp(score - max_score);
+        sum += score;
+      }
+      float* out = &output[(i * num_query_heads + h) * head_dim];
+      for (int s = 0; s < num_slots; ++s) {
+        for (int d = 0; d < head_dim; ++d) {
+          out[d] += scores[s] / sum *
+                    values[s * num_kv_heads * head_dim + kv_offset + d];
+        }
+      }
+    }
+  }
+  return output;
+}
+
+void RunAndCompare(PagedCacheBuffer::Storage storage, float tolerance) {
+  const int num_entries = 37, num_queries = 3, num_query_heads = 4,
+            num_kv_heads = 2, head_dim = 8, layer = 1;
+  const int first_position = num_entries - num_queries;
+  const float scale = 1.0f / std::sqrt(static_cast<float>(head_dim));
+  const std::vector<float> keys =
+      PseudoRandom(num_entries * num_kv_heads * head_dim, 0.0f);
+  const std::vector<float> values =
+      PseudoRandom(num_entries * num_kv_heads * head_dim, 1.0f);
+  const std::vector<float> query =
+      PseudoRandom(num_queries * num_query_heads * head_dim, 2.0f);
+
+  PagedCacheBuffer key_cache;
+  PagedCacheBuffer value_cache;
+  for (PagedCacheBuffer* cache : {&key_cache, &value_cache}) {
+    ASSERT_EQ(cache->Initialize(/*num_layers=*/2, /*max_num_entries=*/128,
+                                num_kv_heads * head_dim, /*page_size=*/16,
+                                storage),
+              kTfLiteOk);
+  }
+  ASSERT_EQ(key_cache.Write(layer, 0, num_entries, keys.data()), kTfLiteOk);
+  ASSERT_EQ(value_cache.Write(layer, 0, num_entries, values.data()),
+            kTfLiteOk);
+
+  std::vector<float> output(query.size());
+  ASSERT_EQ(PagedAttention(key_cache, value_cache, layer, query.data(),
+                           num_queries, first_position, num_query_heads,
+                           head_dim, scale, output.data()),
+            kTfLiteOk);
+  const std::vector<float> expected =
+      ReferenceAttention(query, keys, values, num_queries, first_position,
+                         num_query_heads, num_kv_heads, head_dim, scale);
+  for (size_t i = 0; i < output.size(); ++i) {
+    EXPECT_NEAR(output[i], expected[i], tolerance) << i;
+  }
+}
+
+TEST(PagedAttentionTest, Float32) {
+  RunAndCompare(PagedCacheBuffer::Storage::kFloat32, 1e-5f);
+}
+
+TEST(PagedAttentionTest, Float16) {
+  RunAndCompare(PagedCacheBuffer::Storage::kFloat16, 1e-2f);
+}
+
+TEST(PagedAttentionTest, Int8) {
+  RunAndCompare(PagedCacheBuffer::Storage::kInt8, 3e-2f);
+}
+
+TEST(PagedAttentionTest, QueriesBeyondCacheFail) {
+  PagedCacheBuffer key_cache;
+  PagedCacheBuffer value_cache;
+  for (PagedCacheBuffer* cache : {&key_cache, &value_cache}) {
+    ASSERT_EQ(cache->Initialize(/*num_layers=*/1, /*max_num_entries=*/8,
+                                /*entry_size=*/4, /*page_size=*/4,
+                                PagedCacheBuffer::Storage::kFloat32),
+              kTfLiteOk);
+  }
+  std::vector<float> query(4);
+  std::vector<float> output(4);
+  EXPECT_EQ(PagedAttention(key_cache, value_cache, /*layer=*/0, query.data(),
+                           /*num_queries=*/1, /*first_position=*/0,
+                           /*num_query_heads=*/1, /*head_dim=*/4,
+                           /*scale=*/1.0f, output.data()),
+            kTfLiteError);
+}
+
+}  // namespace
+}  // namespace llm
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
@@ -0,0 +1,173 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "fp16.h"  // from @FP16
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+
+namespace tflite {
+namespace resource {
+
+TfLiteStatus PagedCacheBuffer::Initialize(int num_layers, int max_num_entries,
+                                          int entry_size, int page_size,
+                                          Storage storage) {
+  if (num_layers <= 0 || max_num_entries <= 0 || entry_size <= 0 ||
+      page_size <= 0) {
+    return kTfLiteError;
+  }
+  max_num_entries_ = max_num_entries;
+  entry_size_ = entry_size;
+  page_size_ = page_size;
+  storage_ = storage;
+  const int max_num_pages = (max_num_entries + page_size - 1) / page_size;
+  pages_.clear();
+  pages_.resize(num_layers);
+  for (auto& layer_pages : pages_) layer_pages.resize(max_num_pages);
+  num_entries_.assign(num_layers, 0);
+  is_initialized_ = true;
+  return kTfLiteOk;
+}
+
+size_t PagedCacheBuffer::BytesPerElement() const {
+  switch (storage_) {
+    case Storage::kFloat32:
+      return sizeof(float);
+    case Storage::kFloat16:
+      return sizeof(uint16_t);
+    case Storage::kInt8:
+      return sizeof(int8_t);
+  }
+  return sizeof(float);
+}
+
+size_t PagedCacheBuffer::BytesPerPage() const {
+  size_t bytes =
+      static_cast<size_t>(page_size_) * entry_size_ * BytesPerElement();
+  if (storage_ == Storage::kInt8) bytes += page_size_ * sizeof(float);
+  return bytes;
+}
+
+size_t PagedCacheBuffer::GetMemoryUsage() {
+  size_t num_pages = 0;
+  for (int layer = 0; layer < static_cast<int>(pages_.size()); ++layer) {
+    num_pages += GetNumPages(layer);
+  }
+  return num_pages * BytesPerPage();
+}
+
+int PagedCacheBuffer::GetNumPages(int layer) const {
+  return std::count_if(pages_[layer].begin(), pages_[layer].end(),
+                       [](const Page& page) { return page.data != nullptr; });
+}
+
+TfLiteStatus PagedCacheBuffer::Write(int layer, int slot, int num_entries,
+                                     const float* data) {
+  if (!is_initialized_ || layer < 0 ||
+      layer >= static_cast<int>(pages_.size()) || slot < 0 || num_entries < 0 ||
+      slot + num_entries > max_num_entries_) {
+    return kTfLiteError;
+  }
+  for (int i = 0; i < num_entries; ++i, data += entry_size_) {
+    Page& page = pages_[layer][(slot + i) / page_size_];
+    if (page.data == nullptr) {
+      page.data.reset(
+          new uint8_t[page_size_ * entry_size_ * BytesPerElement()]);
+      if (storage_ == Storage::kInt8) page.scales.reset(new float[page_size_]);
+    }
+    const int offset = (slot + i) % page_size_;
+    switch (storage_) {
+      case Storage::kFloat32: {
+        memcpy(page.data.get() + offset * entry_size_ * sizeof(float), data,
+               entry_size_ * sizeof(float));
+        break;
+      }
+      case Storage::kFloat16: {
+        uint16_t* entry =
+            reinterpret_cast<uint16_t*>(page.data.get()) + offset * entry_size_;
+        for (int j = 0; j < entry_size_; ++j) {
+          entry[j] = fp16_ieee_from_fp32_value(data[j]);
+        }
+        break;
+      }
+      case Storage::kInt8: {
+        int8_t* entry =
+            reinterpret_cast<int8_t*>(page.data.get()) + offset * entry_size_;
+        float max_abs = 0.0f;
+        for (int j = 0; j < entry_size_; ++j) {
+          max_abs = std::max(max_abs, std::abs(data[j]));
+        }
+        const float scale = max_abs / 127.0f;
+        const float inverse_scale = scale > 0.0f ? 1.0f / scale : 0.0f;
+        for (int j = 0; j < entry_size_; ++j) {
+          entry[j] = static_cast<int8_t>(std::round(data[j] * inverse_scale));
+        }
+        page.scales[offset] = scale;
+        break;
+      }
+    }
+  }
+  num_entries_[layer] =
+      std::max(num_entries_[layer], static_cast<size_t>(slot + num_entries));
+  return kTfLiteOk;
+}
+
+void PagedCacheBuffer::ReadEntry(int layer, int slot, float* output) const {
+  const Page& page = pages_[layer][slot / page_size_];
+  TFLITE_DCHECK(page.data != nullptr);
+  const int offset = slot % page_size_;
+  switch (storage_) {
+    case Storage::kFloat32: {
+      memcpy(output, page.data.get() + offset * entry_size_ * sizeof(float),
+             entry_size_ * sizeof(float));
+      break;
+    }
+    case Storage::kFloat16: {
+      const uint16_t* entry =
+          reinterpret_cast<const uint16_t*>(page.data.get()) +
+          offset * entry_size_;
+      for (int j = 0; j < entry_size_; ++j) {
+        output[j] = fp16_ieee_to_fp32_value(entry[j]);
+      }
+      break;
+    }
+    case Storage::kInt8: {
+      const int8_t* entry =
+          reinterpret_cast<const int8_t*>(page.data.get()) +
+          offset * entry_size_;
+      const float scale = page.scales[offset];
+      for (int j = 0; j < entry_size_; ++j) output[j] = entry[j] * scale;
+      break;
+    }
+  }
+}
+
+void PagedCacheBuffer::Clear() {
+  for (auto& layer_pages : pages_) {
+    for (Page& page : layer_pages) page = Page();
+  }
+  std::fill(num_entries_.begin(), num_entries_.end(), 0);
+}
+
+}  // namespace resource
+}  // namespace tflite
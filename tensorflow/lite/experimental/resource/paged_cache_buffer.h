@@ -0,0 +1,96 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+
+namespace tflite {
+namespace resource {
+
+/// WARNING: Experimental interface, subject to change.
+// A paged version of CacheBuffer. Instead of one buffer sized for the maximum
+// number of entries of every layer, the entries of each layer are stored in
+// pages of `page_size` entries which are only allocated once an entry of the
+// page is written, so the memory scales with the number of entries actually
+// in the cache. The entries can be stored as float32, float16 or int8; int8
+// entries are quantized symmetrically with one scale per entry.
+class PagedCacheBuffer : public ResourceBase {
+ public:
+  enum class Storage { kFloat32, kFloat16, kInt8 };
+
+  PagedCacheBuffer() = default;
+  PagedCacheBuffer(const PagedCacheBuffer &) = delete;
+  ~PagedCacheBuffer() override = default;
+  PagedCacheBuffer &operator=(const PagedCacheBuffer &) = delete;
+
+  // Initializes an empty cache of `num_layers` layers of up to
+  // `max_num_entries` entries of `entry_size` elements each.
+  TfLiteStatus Initialize(int num_layers, int max_num_entries, int entry_size,
+                          int page_size, Storage storage);
+  bool IsInitialized() override { return is_initialized_; }
+  // Returns the number of bytes of the allocated pages.
+  size_t GetMemoryUsage() override;
+
+  // Stores `num_entries` entries from `data` at slots [slot, slot +
+  // num_entries) of `layer`, allocating the pages needed for them.
+  TfLiteStatus Write(int layer, int slot, int num_entries, const float *data);
+  // Copies the entry at `slot` of `layer` to the `entry_size()` floats at
+  // `output`. The entry must have been written before.
+  void ReadEntry(int layer, int slot, float *output) const;
+  // Returns one past the largest slot written in `layer`.
+  size_t GetNumEntries(int layer) const { return num_entries_[layer]; }
+  // Returns the number of allocated pages of `layer`.
+  int GetNumPages(int layer) const;
+  // Releases the pages of all the layers.
+  void Clear();
+
+  int entry_size() const { return entry_size_; }
+  int page_size() const { return page_size_; }
+  int max_num_entries() const { return max_num_entries_; }
+  Storage storage() const { return storage_; }
+
+ private:
+  struct Page {
+    std::unique_ptr<uint8_t[]> data;
+    // The scale of every entry of the page for kInt8 storage.
+    std::unique_ptr<float[]> scales;
+  };
+
+  size_t BytesPerElement() const;
+  size_t BytesPerPage() const;
+
+  bool is_initialized_ = false;
+  int max_num_entries_ = 0;
+  int entry_size_ = 0;
+  int page_size_ = 0;
+  Storage storage_ = Storage::kFloat32;
+  // The pages of every layer, indexed by slot / page_size. Pages which were
+  // not written yet are null.
+  std::vector<std::vector<Page>> pages_;
+  std::vector<size_t> num_entries_;
+};
+
+}  // namespace resource
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
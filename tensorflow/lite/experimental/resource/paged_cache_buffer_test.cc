@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace resource {
+namespace {
+
+std::vector<float> Entries(int num_entries, int entry_size, float offset) {
+  std::vector<float> entries(num_entries * entry_size);
+  for (size_t i = 0; i < entries.size(); ++i) entries[i] = offset + 0.25f * i;
+  return entries;
+}
+
+TEST(PagedCacheBufferTest, AllocatesPagesOnDemand) {
+  PagedCacheBuffer cache;
+  ASSERT_EQ(cache.Initialize(/*num_layers=*/2, /*max_num_entries=*/100,
+                             /*entry_size=*/4, /*page_size=*/16,
+                             PagedCacheBuffer::Storage::kFloat32),
+            kTfLiteOk);
+  EXPECT_TRUE(cache.IsInitialized());
+  EXPECT_EQ(cache.GetMemoryUsage(), 0);
+
+  const std::vector<float> entries = Entries(20, 4, 0.0f);
+  ASSERT_EQ(cache.Write(/*layer=*/1, /*slot=*/0, 20, entries.data()),
+            kTfLiteOk);
+  EXPECT_EQ(cache.GetNumEntries(0), 0);
+  EXPECT_EQ(cache.GetNumEntries(1), 20);
+  EXPECT_EQ(cache.GetNumPages(0), 0);
+  EXPECT_EQ(cache.GetNumPages(1), 2);
+  EXPECT_EQ(cache.GetMemoryUsage(), 2 * 16 * 4 * sizeof(float));
+
+  std::vector<float> entry(4);
+  cache.ReadEntry(/*layer=*/1, /*slot=*/17, entry.data());
+  EXPECT_EQ(entry, std::vector<float>(entries.begin() + 17 * 4,
+                                      entries.begin() + 18 * 4));
+
+  cache.Clear();
+  EXPECT_EQ(cache.GetNumEntries(1), 0);
+  EXPECT_EQ(cache.GetMemoryUsage(), 0);
+}
+
+TEST(PagedCacheBufferTest, WriteBeyondMaxNumEntriesFails) {
+  PagedCacheBuffer cache;
+  ASSERT_EQ(cache.Initialize(/*num_layers=*/1, /*max_num_entries=*/10,
+                             /*entry_size=*/2, /*page_size=*/4,
+                             PagedCacheBuffer::Storage::kFloat32),
+            kTfLiteOk);
+  const std::vector<float> entries = Entries(3, 2, 0.0f);
+  EXPECT_EQ(cache.Write(/*layer=*/0, /*slot=*/8, 3, entries.data()),
+            kTfLiteError);
+  EXPECT_EQ(cache.Write(/*layer=*/1, /*slot=*/0, 3, entries.data()),
+            kTfLiteError);
+}
+
+TEST(PagedCacheBufferTest, ReducedPrecisionStorage) {
+  for (auto storage : {PagedCacheBuffer::Storage::kFloat16,
+                       PagedCacheBuffer::Storage::kInt8}) {
+    PagedCacheBuffer cache;
+    ASSERT_EQ(cache.Initialize(/*num_layers=*/1, /*max_num_entries=*/8,
+                               /*entry_size=*/8, /*page_size=*/4, storage),
+              kTfLiteOk);
+    const std::vector<float> entries = Entries(5, 8, -3.0f);
+    ASSERT_EQ(cache.Write(/*layer=*/0, /*slot=*/0, 5, entries.data()),
+              kTfLiteOk);
+    EXPECT_LT(cache.GetMemoryUsage(), 2 * 4 * 8 * sizeof(float));
+
+    std::vector<float> entry(8);
+    for (int slot = 0; slot < 5; ++slot) {
+      cache.ReadEntry(/*layer=*/0, slot, entry.data());
+      for (int i = 0; i < 8; ++i) {
+        EXPECT_NEAR(entry[i], entries[slot * 8 + i], 0.05f);
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace resource
+}  // namespace tflite
@@ -70,6 +70,11 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the index in the execution plan of the last node which may run
+  // concurrently with the node at `index`. Nodes which run concurrently are
+  // consecutive in the execution plan.
+  virtual size_t last_concurrent_node(size_t index) const { return index; }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
@@ -21,6 +21,8 @@ limitations under the License.
 
 namespace tflite {
 
+class SharedArenaBuffer;
+
 /// Options class for `Interpreter`.
 /// WARNING: This is an experimental API and subject to change.
 class InterpreterOptions {
@@ -103,12 +105,82 @@ class InterpreterOptions {
     return experimental_cache_constant_cast_op_;
   }
 
+  /// Allocates the non-persistent tensors of the primary subgraph in
+  /// `shared_arena_buffer`, which is not owned and may be shared with other
+  /// interpreters which are never invoked concurrently with this one. See
+  /// `SharedArenaBuffer` in simple_memory_arena.h for when the tensors of
+  /// interpreters sharing a buffer are valid. This must be set before the
+  /// first call to `AllocateTensors()`.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetSharedArenaBuffer(SharedArenaBuffer* shared_arena_buffer) {
+    experimental_shared_arena_buffer_ = shared_arena_buffer;
+  }
+
+  /// Returns the buffer set by `SetSharedArenaBuffer`, or null.
+  /// WARNING: This is an experimental API and subject to change.
+  SharedArenaBuffer* GetSharedArenaBuffer() const {
+    return experimental_shared_arena_buffer_;
+  }
+
+  /// Runs independent nodes of the model concurrently on up to `num_threads`
+  /// threads, including the one calling `Invoke()`. The nodes are reordered so
+  /// that independent ones are consecutive, which may increase the arena size.
+  /// Nodes of delegates, custom ops, control flow ops and ops using resources
+  /// or variables always run alone, as well as all nodes while a profiler is
+  /// set. Every thread running nodes has its own CPU backend context with
+  /// `SetNumThreads()` threads, so the intra-op threads may need to be
+  /// lowered. This must be set before the first call to `AllocateTensors()`.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetNumInterOpThreads(int num_threads) {
+    experimental_num_inter_op_threads_ = num_threads;
+  }
+
+  /// Returns the number of threads set by `SetNumInterOpThreads`, or 1 if
+  /// nodes run one after the other.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetNumInterOpThreads() const {
+    return experimental_num_inter_op_threads_;
+  }
+
+  /// If `true`, the subgraphs of control flow ops such as WHILE and IF are
+  /// only prepared when the op is first invoked instead of by
+  /// `AllocateTensors()`, so that the subgraphs which are never reached cost
+  /// nothing at startup. The outputs of these ops become dynamic tensors.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetLazySubgraphPreparation(bool value = true) {
+    experimental_lazy_subgraph_preparation_ = value;
+  }
+
+  /// Returns true if the subgraphs of control flow ops are prepared on their
+  /// first invocation, see `SetLazySubgraphPreparation`.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetLazySubgraphPreparation() const {
+    return experimental_lazy_subgraph_preparation_;
+  }
+
+  /// If `true`, the GEMMs of the CPU kernels choose between the default
+  /// backend and ruy for each shape, by timing both on the first calls with
+  /// that shape. This only pays off for models invoked many times.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetGemmAutotuning(bool value = true) {
+    experimental_gemm_autotuning_ = value;
+  }
+
+  /// Returns true if the GEMM backend is chosen per shape, see
+  /// `SetGemmAutotuning`.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetGemmAutotuning() const { return experimental_gemm_autotuning_; }
+
  private:
   bool experimental_preserve_all_tensors_ = false;
   bool experimental_ensure_dynamic_tensors_are_released_ = false;
   int experimental_optimize_memory_for_large_tensors_ = 0;
   bool experimental_disable_delegate_clustering_ = false;
   bool experimental_cache_constant_cast_op_ = false;
+  SharedArenaBuffer* experimental_shared_arena_buffer_ = nullptr;
+  int experimental_num_inter_op_threads_ = 1;
+  bool experimental_lazy_subgraph_preparation_ = false;
+  bool experimental_gemm_autotuning_ = false;
 };
 
 }  // namespace tflite
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/interpreter_test_util.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/testing/util.h"
@@ -1129,6 +1130,116 @@ TEST(BasicInterpreter, ReleaseDynamicTensors) {
   ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 6 * 6);
 }
 
+TEST(BasicInterpreter, InterOpThreads) {
+  // Assemble a graph where two nodes only depend on the input, and a third
+  // one on both of them.
+  Interpreter interpreter;
+  interpreter.AddTensors(4);
+  interpreter.SetInputs({0});
+  interpreter.SetOutputs({3});
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 4; ++i) {
+    interpreter.SetTensorParametersReadWrite(
+        /*tensor_index=*/i, /*type=*/kTfLiteFloat32, /*name=*/"",
+        /*dims=*/{2}, /*quantization=*/quant);
+  }
+  interpreter.AddNodeWithParameters(
+      /*inputs=*/{0}, /*outputs=*/{1}, /*init_data=*/nullptr,
+      /*init_data_size=*/0, /*builtin_data=*/nullptr,
+      /*registration=*/tflite::ops::builtin::Register_NEG());
+  interpreter.AddNodeWithParameters(
+      /*inputs=*/{0}, /*outputs=*/{2}, /*init_data=*/nullptr,
+      /*init_data_size=*/0, /*builtin_data=*/nullptr,
+      /*registration=*/tflite::ops::builtin::Register_ABS());
+  interpreter.AddNodeWithParameters(
+      /*inputs=*/{1, 2}, /*outputs=*/{3}, /*init_data=*/nullptr,
+      /*init_data_size=*/0, /*builtin_data=*/nullptr,
+      /*registration=*/tflite::ops::builtin::Register_SQUARED_DIFFERENCE());
+
+  InterpreterOptions options;
+  options.SetNumInterOpThreads(2);
+  interpreter.ApplyOptions(&options);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  const Subgraph& subgraph = interpreter.primary_subgraph();
+  EXPECT_EQ(subgraph.last_concurrent_node(0), 1);
+  EXPECT_EQ(subgraph.last_concurrent_node(1), 1);
+  EXPECT_EQ(subgraph.last_concurrent_node(2), 2);
+  // The outputs of the nodes running concurrently don't share memory.
+  EXPECT_NE(interpreter.tensor(1)->data.raw, interpreter.tensor(2)->data.raw);
+
+  for (int i = 0; i < 10; ++i) {
+    interpreter.typed_tensor<float>(0)[0] = 1.0f + i;
+    interpreter.typed_tensor<float>(0)[1] = -2.0f;
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    EXPECT_FLOAT_EQ(interpreter.typed_tensor<float>(3)[0],
+                    4.0f * (1.0f + i) * (1.0f + i));
+    EXPECT_FLOAT_EQ(interpreter.typed_tensor<float>(3)[1], 0.0f);
+  }
+}
+
+TEST(BasicInterpreter, GemmAutotuning) {
+  // Assemble a fully connected layer computing its output with a GEMM.
+  constexpr int kBatches = 4;
+  constexpr int kInputDepth = 8;
+  constexpr int kOutputDepth = 16;
+  Interpreter interpreter;
+  interpreter.AddTensors(3);
+  interpreter.SetInputs({0, 1});
+  interpreter.SetOutputs({2});
+  TfLiteQuantizationParams quant;
+  interpreter.SetTensorParametersReadWrite(
+      /*tensor_index=*/0, /*type=*/kTfLiteFloat32, /*name=*/"input",
+      /*dims=*/{kBatches, kInputDepth}, /*quantization=*/quant);
+  interpreter.SetTensorParametersReadWrite(
+      /*tensor_index=*/1, /*type=*/kTfLiteFloat32, /*name=*/"weights",
+      /*dims=*/{kOutputDepth, kInputDepth}, /*quantization=*/quant);
+  interpreter.SetTensorParametersReadWrite(
+      /*tensor_index=*/2, /*type=*/kTfLiteFloat32, /*name=*/"output",
+      /*dims=*/{kBatches, kOutputDepth}, /*quantization=*/quant);
+  auto* params = reinterpret_cast<TfLiteFullyConnectedParams*>(
+      malloc(sizeof(TfLiteFullyConnectedParams)));
+  *params = TfLiteFullyConnectedParams();
+  params->activation = kTfLiteActNone;
+  params->weights_format = kTfLiteFullyConnectedWeightsFormatDefault;
+  interpreter.AddNodeWithParameters(
+      /*inputs=*/{0, 1, kTfLiteOptionalTensor}, /*outputs=*/{2},
+      /*init_data=*/nullptr, /*init_data_size=*/0, /*builtin_data=*/params,
+      /*registration=*/tflite::ops::builtin::Register_FULLY_CONNECTED());
+
+  InterpreterOptions options;
+  options.SetGemmAutotuning();
+  interpreter.ApplyOptions(&options);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // The first invocations time both backends, and the later ones use the
+  // faster one.
+  for (int i = 0; i < 10; ++i) {
+    for (int j = 0; j < kBatches * kInputDepth; ++j) {
+      interpreter.typed_tensor<float>(0)[j] = (i + j) % 5 - 2;
+    }
+    for (int j = 0; j < kOutputDepth * kInputDepth; ++j) {
+      interpreter.typed_tensor<float>(1)[j] = j % 3 - 1;
+    }
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    const float* input = interpreter.typed_tensor<float>(0);
+    const float* weights = interpreter.typed_tensor<float>(1);
+    const float* output = interpreter.typed_tensor<float>(2);
+    for (int b = 0; b < kBatches; ++b) {
+      for (int o = 0; o < kOutputDepth; ++o) {
+        float expected = 0.0f;
+        for (int d = 0; d < kInputDepth; ++d) {
+          expected +=
+              input[b * kInputDepth + d] * weights[o * kInputDepth + d];
+        }
+        EXPECT_FLOAT_EQ(output[b * kOutputDepth + o], expected);
+      }
+    }
+  }
+  CpuBackendContext* cpu_backend_context = CpuBackendContext::GetFromContext(
+      interpreter.primary_subgraph().context());
+  EXPECT_TRUE(cpu_backend_context->use_gemm_autotuning());
+}
+
 TEST(InterpreterTensorsCapacityTest, TestWithinHeadroom) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(Interpreter::kTensorsReservedCapacity),
@@ -20,12 +20,15 @@ limitations under the License.
 #include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <memory>
+#include <vector>
 
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/optimized/batch_matmul.h"
+#include "tensorflow/lite/kernels/internal/optimized/fully_connected_4bit.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/reference/reference_ops.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
@@ -45,6 +48,9 @@ static const int kOutputTensor = 0;
 
 static const int kNumTempTensorsForAdjoints = 2;
 static const int kNumTempTensorsForHybrid = 5;
+// The 4-bit path reuses the first hybrid temporaries for the quantized LHS,
+// its scaling factors, the accumulators and the input offsets.
+static const int kNumTempTensorsFor4Bit = 4;
 
 // This file has two implementations of Transpose.
 enum KernelType {
@@ -65,6 +71,8 @@ struct OpData {
   int scratch_tensor_index;
   bool rhs_transposed;
   bool compute_row_sums = false;
+  // Used for the 4-bit hybrid path, with a float LHS and a constant int4 RHS.
+  std::unique_ptr<optimized_4bit::OpData4Bit> op_data_4bit = nullptr;
 };
 
 struct OpContext {
@@ -122,9 +130,123 @@ TfLiteStatus ResizeOutputTensor(TfLiteContext* context,
   return stat;
 }
 
+// Initializes the temp tensors of the 4-bit hybrid path, which multiplies the
+// LHS, flattened to rows of its last dimension, with the single matrix of a
+// constant int4 RHS through the 4-bit fully connected kernels.
+TfLiteStatus InitializeTemporaries4Bit(TfLiteContext* context,
+                                       TfLiteNode* node,
+                                       OpContext* op_context) {
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  const TfLiteTensor* lhs = op_context->lhs;
+  const TfLiteTensor* rhs = op_context->rhs;
+  TF_LITE_ENSURE_TYPES_EQ(context, lhs->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_MSG(context, IsConstantTensor(rhs),
+                     "BatchMatMul only supports a constant int4 RHS.");
+  TF_LITE_ENSURE(context, !op_context->params->adj_x);
+  const int lhs_rank = NumDimensions(lhs);
+  const int rhs_rank = NumDimensions(rhs);
+  TF_LITE_ENSURE(context, lhs_rank >= 2);
+  TF_LITE_ENSURE(context, rhs_rank >= 2);
+  // The weights can't be broadcast, as they are prepacked as a single matrix.
+  for (int i = 0; i < rhs_rank - 2; ++i) {
+    TF_LITE_ENSURE_EQ(context, rhs->dims->data[i], 1);
+  }
+  const int cols = lhs->dims->data[lhs_rank - 1];
+  const int num_units = op_context->params->adj_y
+                            ? rhs->dims->data[rhs_rank - 2]
+                            : rhs->dims->data[rhs_rank - 1];
+  TF_LITE_ENSURE_EQ(context, cols % 2, 0);
+  TF_LITE_ENSURE(context, cols >= optimized_4bit::FilterDepth);
+  TF_LITE_ENSURE(context, num_units >= optimized_4bit::FilterWidth);
+  const auto* affine_quantization =
+      reinterpret_cast<TfLiteAffineQuantization*>(rhs->quantization.params);
+  if (affine_quantization && affine_quantization->scale) {
+    TF_LITE_ENSURE(context, affine_quantization->scale->size == 1 ||
+                                affine_quantization->scale->size == num_units);
+  }
+
+  const int batch_size = NumElements(lhs) / cols;
+  if (!op_data->op_data_4bit) {
+    op_data->op_data_4bit = std::make_unique<optimized_4bit::OpData4Bit>();
+  }
+  op_data->op_data_4bit->batch_size = batch_size;
+  op_data->op_data_4bit->rows_right = optimized_4bit::GetRowsRight(batch_size);
+  const int rhs_width = op_data->op_data_4bit->rows_right;
+  const int lhs_width = optimized_4bit::FilterWidth;
+  const int depth = optimized_4bit::FilterDepth;
+  const int layout_cols = (cols + (depth - 1)) & ~(depth - 1);
+  const int layout_rows = (batch_size + (rhs_width - 1)) & ~(rhs_width - 1);
+  const int dst_layout_cols = (num_units + (lhs_width - 1)) & ~(lhs_width - 1);
+
+  TfLiteIntArrayFree(node->temporaries);
+  node->temporaries = TfLiteIntArrayCreate(kNumTempTensorsFor4Bit);
+  for (int i = 0; i < kNumTempTensorsFor4Bit; ++i) {
+    node->temporaries->data[i] =
+        op_data->scratch_tensor_index + kNumTempTensorsForAdjoints + i;
+  }
+
+  TfLiteTensor* input_quantized;
+  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, /*index=*/0,
+                                              &input_quantized));
+  input_quantized->type = kTfLiteInt8;
+  input_quantized->allocation_type = kTfLiteArenaRw;
+  const int input_quantized_dims[2] = {layout_rows, layout_cols};
+  if (!TfLiteIntArrayEqualsArray(input_quantized->dims, 2,
+                                 input_quantized_dims)) {
+    TfLiteIntArray* input_quantized_size = TfLiteIntArrayCreate(2);
+    input_quantized_size->data[0] = input_quantized_dims[0];
+    input_quantized_size->data[1] = input_quantized_dims[1];
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, input_quantized,
+                                                     input_quantized_size));
+  }
+
+  TfLiteTensor* scaling_factors;
+  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, /*index=*/1,
+                                              &scaling_factors));
+  scaling_factors->type = kTfLiteFloat32;
+  scaling_factors->allocation_type = kTfLiteArenaRw;
+  const int scaling_dims[1] = {layout_rows};
+  if (!TfLiteIntArrayEqualsArray(scaling_factors->dims, 1, scaling_dims)) {
+    TfLiteIntArray* scaling_factors_size = TfLiteIntArrayCreate(1);
+    scaling_factors_size->data[0] = scaling_dims[0];
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scaling_factors,
+                                                     scaling_factors_size));
+  }
+
+  TfLiteTensor* accum_scratch;
+  TF_LITE_ENSURE_OK(
+      context, GetTemporarySafe(context, node, /*index=*/2, &accum_scratch));
+  accum_scratch->type = kTfLiteInt32;
+  accum_scratch->allocation_type = kTfLiteArenaRw;
+  const int accum_scratch_dims[2] = {layout_rows, dst_layout_cols};
+  if (!TfLiteIntArrayEqualsArray(accum_scratch->dims, 2, accum_scratch_dims)) {
+    TfLiteIntArray* accum_size = TfLiteIntArrayCreate(2);
+    accum_size->data[0] = accum_scratch_dims[0];
+    accum_size->data[1] = accum_scratch_dims[1];
+    TF_LITE_ENSURE_OK(
+        context, context->ResizeTensor(context, accum_scratch, accum_size));
+  }
+
+  TfLiteTensor* input_offsets;
+  TF_LITE_ENSURE_OK(
+      context, GetTemporarySafe(context, node, /*index=*/3, &input_offsets));
+  input_offsets->type = kTfLiteInt32;
+  input_offsets->allocation_type = kTfLiteArenaRw;
+  if (!TfLiteIntArrayEqualsArray(input_offsets->dims, 1, scaling_dims)) {
+    TfLiteIntArray* input_offsets_size = TfLiteIntArrayCreate(1);
+    input_offsets_size->data[0] = scaling_dims[0];
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, input_offsets,
+                                                     input_offsets_size));
+  }
+  return kTfLiteOk;
+}
+
 // Initializes temp tensors to store transposed operands.
 TfLiteStatus InitializeTemporaries(TfLiteContext* context, TfLiteNode* node,
                                    OpContext* op_context) {
+  if (op_context->rhs->type == kTfLiteInt4) {
+    return InitializeTemporaries4Bit(context, node, op_context);
+  }
   // Create temporary tensors to hold transposed LHS/RHS.
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
   const TfLiteTensor* lhs = op_context->lhs;
@@ -345,11 +467,13 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                               lhs_data->type == kTfLiteInt16);
   TF_LITE_ENSURE(context, rhs_data->type == kTfLiteFloat32 ||
                               rhs_data->type == kTfLiteInt8 ||
-                              rhs_data->type == kTfLiteInt16);
-  // Either we have a hybrid quantization with a float32 and an int8 input,
-  // otherwise both inputs should be of the same type.
+                              rhs_data->type == kTfLiteInt16 ||
+                              rhs_data->type == kTfLiteInt4);
+  // Either we have a hybrid quantization with a float32 and an int8 or int4
+  // input, otherwise both inputs should be of the same type.
   TF_LITE_ENSURE(context, (lhs_data->type == kTfLiteFloat32 &&
-                           rhs_data->type == kTfLiteInt8) ||
+                           (rhs_data->type == kTfLiteInt8 ||
+                            rhs_data->type == kTfLiteInt4)) ||
                               lhs_data->type == rhs_data->type);
   // Support dimensions between 2 and 5, inclusive.
   TF_LITE_ENSURE(context, NumDimensions(lhs_data) >= 2);
@@ -441,6 +565,110 @@ RuntimeShape SwapRowColumnDims(const RuntimeShape& shape) {
   return swapped_shape;
 }
 
+// Transposes a <rows, cols> matrix of densely packed int4 values, with the
+// first of every two values in the low nibble, to a <cols, rows> matrix packed
+// the same way.
+std::vector<int8_t> TransposeInt4(const int8_t* input, int rows, int cols) {
+  std::vector<int8_t> unpacked(rows * cols);
+  tensor_utils::UnpackDenseInt4IntoInt8(input, rows * cols, unpacked.data());
+  std::vector<int8_t> transposed((rows * cols + 1) / 2, 0);
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      const int index = j * rows + i;
+      const uint8_t value = static_cast<uint8_t>(unpacked[i * cols + j]) & 0xf;
+      transposed[index / 2] |=
+          static_cast<int8_t>(index % 2 == 0 ? value : value << 4);
+    }
+  }
+  return transposed;
+}
+
+// Multiplies the LHS with the 4-bit RHS, which is prepacked on the first run.
+// The fully connected kernels expect <units, cols> weights, so an RHS which
+// isn't adjoint is transposed once before being packed.
+TfLiteStatus EvalHybrid4Bit(TfLiteContext* context, TfLiteNode* node,
+                            OpData* data, const TfLiteTensor* lhs,
+                            const TfLiteTensor* rhs, TfLiteTensor* output) {
+  const auto* params =
+      reinterpret_cast<TfLiteBatchMatMulParams*>(node->builtin_data);
+  optimized_4bit::OpData4Bit* op_data_4bit = data->op_data_4bit.get();
+  TfLiteTensor* input_quantized;
+  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, /*index=*/0,
+                                              &input_quantized));
+  TfLiteTensor* scaling_factors;
+  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, /*index=*/1,
+                                              &scaling_factors));
+  TfLiteTensor* accum_scratch;
+  TF_LITE_ENSURE_OK(
+      context, GetTemporarySafe(context, node, /*index=*/2, &accum_scratch));
+  TfLiteTensor* input_offsets;
+  TF_LITE_ENSURE_OK(
+      context, GetTemporarySafe(context, node, /*index=*/3, &input_offsets));
+
+  const int rhs_rank = NumDimensions(rhs);
+  const int cols = params->adj_y ? rhs->dims->data[rhs_rank - 1]
+                                 : rhs->dims->data[rhs_rank - 2];
+  const int output_depth = params->adj_y ? rhs->dims->data[rhs_rank - 2]
+                                         : rhs->dims->data[rhs_rank - 1];
+  const int batch_size = op_data_4bit->batch_size;
+  const int rhs_width = op_data_4bit->rows_right;
+  const int depth = optimized_4bit::FilterDepth;
+  const int lhs_width = optimized_4bit::FilterWidth;
+  const int lhs_layout_rows =
+      (output_depth + (lhs_width - 1)) & ~(lhs_width - 1);
+  const int lhs_layout_cols = (cols + (depth - 1)) & ~(depth - 1);
+  const int rhs_layout_rows = (batch_size + (rhs_width - 1)) & ~(rhs_width - 1);
+  const int rhs_layout_cols = lhs_layout_cols;
+  const int dst_layout_rows = rhs_layout_rows;
+  const int dst_layout_cols = lhs_layout_rows;
+  if (op_data_4bit->needs_prepack) {
+    const int8_t* weight_ptr = GetTensorData<int8_t>(rhs);
+    std::vector<int8_t> transposed_weights;
+    if (!params->adj_y) {
+      transposed_weights = TransposeInt4(weight_ptr, cols, output_depth);
+      weight_ptr = transposed_weights.data();
+    }
+    const int weight_size = lhs_layout_rows * lhs_layout_cols / 2;
+    op_data_4bit->AllocatePackedRegion(
+        optimized_4bit::kDefaultAlignmentPadding + weight_size);
+    optimized_4bit::api::Prepack(op_data_4bit->prepacked_cache, weight_ptr,
+                                 lhs_layout_rows, lhs_layout_cols,
+                                 output_depth, cols, lhs_width, depth);
+    op_data_4bit->needs_prepack = false;
+  }
+
+  std::vector<float> filter_scales(lhs_layout_rows, rhs->params.scale);
+  const auto* rhs_params =
+      reinterpret_cast<TfLiteAffineQuantization*>(rhs->quantization.params);
+  if (rhs_params && rhs_params->scale && rhs_params->scale->size > 0) {
+    if (rhs_params->scale->size == 1) {
+      std::fill(filter_scales.begin(), filter_scales.end(),
+                rhs_params->scale->data[0]);
+    } else {
+      for (int i = 0; i < rhs_params->scale->size; ++i) {
+        filter_scales[i] = rhs_params->scale->data[i];
+      }
+    }
+  }
+  float* scaling_factors_ptr = GetTensorData<float>(scaling_factors);
+  int8_t* quant_data = GetTensorData<int8_t>(input_quantized);
+  int32_t* input_offset_ptr = GetTensorData<int32_t>(input_offsets);
+  optimized_4bit::api::BatchQuantizeFloats4Bit(
+      GetTensorData<float>(lhs), batch_size, cols, quant_data,
+      scaling_factors_ptr, rhs_width, depth, input_offset_ptr);
+  optimized_4bit::api::AssignBiasAndComputeOffsets(
+      input_offset_ptr, scaling_factors_ptr, filter_scales.data(),
+      /*bias_ptr=*/nullptr, GetTensorData<float>(output), output_depth,
+      batch_size);
+  optimized_4bit::api::RunAndUnpack(
+      rhs_width, op_data_4bit->prepacked_cache, quant_data,
+      GetTensorData<int32_t>(accum_scratch), output_depth, batch_size,
+      lhs_layout_rows, lhs_layout_cols, rhs_layout_rows, rhs_layout_cols,
+      dst_layout_rows, dst_layout_cols, GetTensorData<float>(output),
+      scaling_factors_ptr, filter_scales.data());
+  return kTfLiteOk;
+}
+
 template <KernelType kernel_type>
 TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node, OpData* data,
                         const RuntimeShape& input_shape,
@@ -717,6 +945,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TfLiteTensor* output;
   TF_LITE_ENSURE_OK(context,
                     GetOutputSafe(context, node, kOutputTensor, &output));
+  if (rhs->type == kTfLiteInt4) {
+    return EvalHybrid4Bit(context, node, op_data, lhs, rhs, output);
+  }
   RuntimeShape orig_lhs_shape = GetTensorShape(lhs);
   RuntimeShape orig_rhs_shape = GetTensorShape(rhs);
 
@@ -1003,6 +1003,117 @@ INSTANTIATE_TEST_SUITE_P(
     HybridSymmetricBatchMatMulOpTest, HybridSymmetricBatchMatMulOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
 
+// In the 4-bit hybrid model the weights are constant int4 values, densely
+// packed two per byte. The input and output are in float precision.
+class Hybrid4BitBatchMatMulOpModel : public SingleOpModel {
+ public:
+  Hybrid4BitBatchMatMulOpModel(const TensorData& lhs, const TensorData& rhs,
+                               const std::vector<int8_t>& weights,
+                               bool adj_y = false) {
+    lhs_id_ = AddInput(lhs);
+    std::vector<int8_t> packed_weights((weights.size() + 1) / 2, 0);
+    for (size_t i = 0; i < weights.size(); ++i) {
+      packed_weights[i / 2] |= (weights[i] & 0xf) << (i % 2 == 0 ? 0 : 4);
+    }
+    rhs_id_ = AddConstInput<int8_t>(rhs, packed_weights.data(),
+                                    packed_weights.size());
+    output_id_ = AddOutput(TensorType_FLOAT32);
+    SetBuiltinOp(BuiltinOperator_BATCH_MATMUL,
+                 BuiltinOptions_BatchMatMulOptions,
+                 CreateBatchMatMulOptions(builder_, /*adj_x=*/false, adj_y)
+                     .Union());
+    BuildInterpreter({GetShape(lhs_id_), GetShape(rhs_id_)});
+  }
+
+  void SetInput(const std::vector<float>& f) { PopulateTensor(lhs_id_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_id_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_id_); }
+
+ protected:
+  int lhs_id_;
+  int rhs_id_;
+  int output_id_;
+};
+
+class Hybrid4BitBatchMatMulOpTest : public SingleOpTest {
+ protected:
+  const std::map<string, TfLiteRegistration*>& GetKernelMap() override {
+    return *kKernelMap;
+  }
+
+  // Runs a <2, 3, cols> x <cols, units> matmul, with `adj_y` weights given as
+  // <units, cols>, and compares it with the product of the float values.
+  void RunAndCompare(int cols, int units, bool adj_y,
+                     const std::vector<float>& scales) {
+    std::vector<int8_t> weights(cols * units);
+    for (int i = 0; i < cols * units; ++i) {
+      weights[i] = (i * 5) % 15 - 7;
+    }
+    std::vector<float> input(2 * 3 * cols);
+    for (int i = 0; i < 2 * 3 * cols; ++i) {
+      input[i] = ((i * 7) % 19 - 9) / 9.0f;
+    }
+    const std::vector<int> rhs_shape =
+        adj_y ? std::vector<int>{units, cols} : std::vector<int>{cols, units};
+    TensorData rhs = {TensorType_INT4, rhs_shape, 0, 0, scales[0]};
+    if (scales.size() > 1) {
+      rhs = {TensorType_INT4,
+             rhs_shape,
+             0,
+             0,
+             0,
+             0,
+             /*per_channel_quantization=*/true,
+             scales,
+             std::vector<int64_t>(scales.size(), 0),
+             /*channel_index=*/adj_y ? 0 : 1};
+    }
+    Hybrid4BitBatchMatMulOpModel m({TensorType_FLOAT32, {2, 3, cols}}, rhs,
+                                   weights, adj_y);
+    m.SetInput(input);
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+    std::vector<float> expected;
+    for (int b = 0; b < 2 * 3; ++b) {
+      for (int u = 0; u < units; ++u) {
+        float sum = 0;
+        for (int c = 0; c < cols; ++c) {
+          const int weight = adj_y ? weights[u * cols + c]
+                                   : weights[c * units + u];
+          sum += input[b * cols + c] * weight *
+                 scales[scales.size() > 1 ? u : 0];
+        }
+        expected.push_back(sum);
+      }
+    }
+    EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                   expected, /*max_abs_error=*/0.1f)));
+    EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 3, units}));
+  }
+};
+
+TEST_P(Hybrid4BitBatchMatMulOpTest, SimpleTestInt4) {
+  RunAndCompare(/*cols=*/64, /*units=*/6, /*adj_y=*/false, {0.25f});
+}
+
+TEST_P(Hybrid4BitBatchMatMulOpTest, SimpleTestInt4AdjRHS) {
+  RunAndCompare(/*cols=*/64, /*units=*/6, /*adj_y=*/true, {0.25f});
+}
+
+TEST_P(Hybrid4BitBatchMatMulOpTest, PerChannelInt4) {
+  RunAndCompare(/*cols=*/48, /*units=*/5, /*adj_y=*/false,
+                {0.1f, 0.2f, 0.3f, 0.4f, 0.5f});
+}
+
+TEST_P(Hybrid4BitBatchMatMulOpTest, PerChannelInt4AdjRHS) {
+  RunAndCompare(/*cols=*/48, /*units=*/5, /*adj_y=*/true,
+                {0.1f, 0.2f, 0.3f, 0.4f, 0.5f});
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Hybrid4BitBatchMatMulOpTest, Hybrid4BitBatchMatMulOpTest,
+    ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
+
 class QuantizedBatchMatMulOpModel : public SingleOpModel {
  public:
   QuantizedBatchMatMulOpModel(int units, int batches, const TensorData& lhs,
@@ -1198,6 +1198,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
           /*recurrent_to_output_is_diag=*/false,
+          /*input_projection_scratch=*/nullptr,
           CpuBackendContext::GetFromContext(context));
       TF_LITE_ENSURE_OK(context, fw_pass_status);
 
@@ -1224,6 +1225,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
           /*recurrent_to_output_is_diag=*/false,
+          /*input_projection_scratch=*/nullptr,
           CpuBackendContext::GetFromContext(context));
       TF_LITE_ENSURE_OK(context, bw_pass_status);
       return kTfLiteOk;
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <vector>
@@ -37,6 +38,7 @@ limitations under the License.
 #if defined(TFLITE_WITH_MULTITHREADED_EIGEN)
 #include "tensorflow/lite/kernels/internal/optimized/multithreaded_conv.h"
 #endif
+#include "tensorflow/lite/kernels/internal/optimized/fully_connected_4bit.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/conv.h"
@@ -123,6 +125,9 @@ struct OpData {
   int32_t groups = 1;
 
   TfLiteType quantized_bias_type = kTfLiteNoType;
+
+  // Used for 1x1 convolutions with a constant int4 filter and a float input.
+  std::unique_ptr<optimized_4bit::OpData4Bit> op_data_4bit = nullptr;
 };
 
 inline PaddingType RuntimePaddingType(TfLitePadding padding) {
@@ -311,12 +316,15 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(
       }
       ++temporaries_count;
 
-      data->row_sums_index = temporaries_count;
-      if (data->row_sums_id == kTensorNotAllocated) {
-        TF_LITE_ENSURE_OK(context,
-                          context->AddTensors(context, 1, &data->row_sums_id));
+      // The 4-bit kernels fold the filter sums into the input offsets.
+      if (!data->op_data_4bit) {
+        data->row_sums_index = temporaries_count;
+        if (data->row_sums_id == kTensorNotAllocated) {
+          TF_LITE_ENSURE_OK(
+              context, context->AddTensors(context, 1, &data->row_sums_id));
+        }
+        ++temporaries_count;
       }
-      ++temporaries_count;
     }
   }
 
@@ -326,6 +334,87 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(
   return kTfLiteOk;
 }
 
+// Sizes the temporaries of the 4-bit hybrid path, in the layouts of the 4-bit
+// fully connected kernels, for `batch_size` pixels of `cols` input channels
+// and `units` output channels.
+TfLiteStatus Prepare4Bit(TfLiteContext* context, TfLiteNode* node,
+                         int batch_size, int cols, int units) {
+  OpData* data = reinterpret_cast<OpData*>(node->user_data);
+  data->op_data_4bit->batch_size = batch_size;
+  data->op_data_4bit->rows_right = optimized_4bit::GetRowsRight(batch_size);
+  const int rhs_width = data->op_data_4bit->rows_right;
+  const int lhs_width = optimized_4bit::FilterWidth;
+  const int depth = optimized_4bit::FilterDepth;
+  const int layout_cols = (cols + (depth - 1)) & ~(depth - 1);
+  const int layout_rows = (batch_size + (rhs_width - 1)) & ~(rhs_width - 1);
+  const int dst_layout_cols = (units + (lhs_width - 1)) & ~(lhs_width - 1);
+
+  node->temporaries->data[data->input_quantized_index] =
+      data->input_quantized_id;
+  TfLiteTensor* input_quantized;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node, data->input_quantized_index,
+                                     &input_quantized));
+  input_quantized->type = kTfLiteInt8;
+  input_quantized->allocation_type = kTfLiteArenaRw;
+  const int input_quantized_dims[2] = {layout_rows, layout_cols};
+  if (!TfLiteIntArrayEqualsArray(input_quantized->dims, 2,
+                                 input_quantized_dims)) {
+    TfLiteIntArray* input_quantized_size = TfLiteIntArrayCreate(2);
+    input_quantized_size->data[0] = input_quantized_dims[0];
+    input_quantized_size->data[1] = input_quantized_dims[1];
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, input_quantized,
+                                                     input_quantized_size));
+  }
+
+  node->temporaries->data[data->scaling_factors_index] =
+      data->scaling_factors_id;
+  TfLiteTensor* scaling_factors;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node, data->scaling_factors_index,
+                                     &scaling_factors));
+  scaling_factors->type = kTfLiteFloat32;
+  scaling_factors->allocation_type = kTfLiteArenaRw;
+  const int scaling_dims[1] = {layout_rows};
+  if (!TfLiteIntArrayEqualsArray(scaling_factors->dims, 1, scaling_dims)) {
+    TfLiteIntArray* scaling_factors_size = TfLiteIntArrayCreate(1);
+    scaling_factors_size->data[0] = scaling_dims[0];
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scaling_factors,
+                                                     scaling_factors_size));
+  }
+
+  node->temporaries->data[data->accum_scratch_index] = data->accum_scratch_id;
+  TfLiteTensor* accum_scratch;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node, data->accum_scratch_index,
+                                     &accum_scratch));
+  accum_scratch->type = kTfLiteInt32;
+  accum_scratch->allocation_type = kTfLiteArenaRw;
+  const int accum_scratch_dims[2] = {layout_rows, dst_layout_cols};
+  if (!TfLiteIntArrayEqualsArray(accum_scratch->dims, 2, accum_scratch_dims)) {
+    TfLiteIntArray* accum_scratch_size = TfLiteIntArrayCreate(2);
+    accum_scratch_size->data[0] = accum_scratch_dims[0];
+    accum_scratch_size->data[1] = accum_scratch_dims[1];
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, accum_scratch,
+                                                     accum_scratch_size));
+  }
+
+  node->temporaries->data[data->input_offset_index] = data->input_offset_id;
+  TfLiteTensor* input_offsets;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node, data->input_offset_index,
+                                     &input_offsets));
+  input_offsets->type = kTfLiteInt32;
+  input_offsets->allocation_type = kTfLiteArenaRw;
+  if (!TfLiteIntArrayEqualsArray(input_offsets->dims, 1, scaling_dims)) {
+    TfLiteIntArray* input_offsets_size = TfLiteIntArrayCreate(1);
+    input_offsets_size->data[0] = scaling_dims[0];
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, input_offsets,
+                                                     input_offsets_size));
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
                      TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLiteConvParams*>(node->builtin_data);
@@ -432,11 +521,42 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     }
   }
 
+  // A 1x1 convolution of a float input with a constant int4 filter is a fully
+  // connected layer over the pixels of the input, and uses the 4-bit hybrid
+  // fully connected kernels.
+  const bool is_4bit =
+      input->type == kTfLiteFloat32 && filter->type == kTfLiteInt4 &&
+      IsConstantTensor(filter) && data->groups == 1 &&
+      filter->dims->data[1] == 1 && filter->dims->data[2] == 1 &&
+      params->stride_width == 1 && params->stride_height == 1 &&
+      params->dilation_width_factor == 1 &&
+      params->dilation_height_factor == 1 && filter->dims->data[3] % 2 == 0 &&
+      filter->dims->data[3] >= optimized_4bit::FilterDepth &&
+      filter->dims->data[0] >= optimized_4bit::FilterWidth;
+  if (input->type == kTfLiteFloat32 && filter->type == kTfLiteInt4 &&
+      !is_4bit) {
+    TF_LITE_KERNEL_LOG(context,
+                       "Hybrid int4 convolutions are only supported for "
+                       "constant 1x1 filters without strides or dilation, "
+                       "with an even number of at least %d input channels "
+                       "and at least %d output channels.",
+                       optimized_4bit::FilterDepth,
+                       optimized_4bit::FilterWidth);
+    return kTfLiteError;
+  }
+  if (is_4bit) {
+    if (!data->op_data_4bit) {
+      data->op_data_4bit = std::make_unique<optimized_4bit::OpData4Bit>();
+    }
+  } else {
+    data->op_data_4bit.reset();
+  }
+
   // The multi-threaded kernel supports neither dilation nor hybrid kernels, and
   // is incompatible with mutable input filters that might change between evals.
   data->supports_multithreaded_kernel =
       (kernel_type == kMultithreadOptimized) &&
-      (context->recommended_num_threads != 1) && !is_hybrid &&
+      (context->recommended_num_threads != 1) && !is_hybrid && !is_4bit &&
       (params->dilation_width_factor == 1) &&
       (params->dilation_height_factor == 1) &&
       (filter->allocation_type != kTfLiteArenaRw) && !IsDynamicTensor(filter);
@@ -465,8 +585,8 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
                               out_width * channels_in * filter_height *
                               filter_width * im2col_type_size;
   TF_LITE_ENSURE_STATUS(AllocateTemporaryTensorsIfRequired(
-      context, node, is_hybrid, data->is_hybrid_per_channel, kernel_type,
-      im2col_bytes));
+      context, node, is_hybrid || is_4bit,
+      data->is_hybrid_per_channel || is_4bit, kernel_type, im2col_bytes));
 
   TF_LITE_ENSURE(context, has_bias);
 
@@ -503,6 +623,11 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
 
   if (output_status != kTfLiteOk) return output_status;
 
+  if (is_4bit) {
+    return Prepare4Bit(context, node, batches * out_height * out_width,
+                       channels_in, channels_out);
+  }
+
   if (data->need_im2col) {
     node->temporaries->data[data->im2col_index] = data->im2col_id;
 
@@ -1190,6 +1315,91 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Runs a 1x1 convolution as a fully connected layer with the 4-bit hybrid
+// kernels. The filter is a <channels_out, channels_in> matrix, which is
+// prepacked on the first run.
+TfLiteStatus EvalHybrid4Bit(TfLiteContext* context, TfLiteNode* node,
+                            TfLiteConvParams* params, OpData* data,
+                            const TfLiteTensor* input,
+                            const TfLiteTensor* filter,
+                            const TfLiteTensor* bias, TfLiteTensor* output) {
+  optimized_4bit::OpData4Bit* op_data_4bit = data->op_data_4bit.get();
+  TfLiteTensor* input_quantized;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node, data->input_quantized_index,
+                                     &input_quantized));
+  TfLiteTensor* scaling_factors;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node, data->scaling_factors_index,
+                                     &scaling_factors));
+  TfLiteTensor* accum_scratch;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node, data->accum_scratch_index,
+                                     &accum_scratch));
+  TfLiteTensor* input_offsets;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node, data->input_offset_index,
+                                     &input_offsets));
+
+  const int output_depth = filter->dims->data[0];
+  const int cols = filter->dims->data[3];
+  const int batch_size = op_data_4bit->batch_size;
+  const int rhs_width = op_data_4bit->rows_right;
+  const int depth = optimized_4bit::FilterDepth;
+  const int lhs_width = optimized_4bit::FilterWidth;
+  const int lhs_layout_rows =
+      (output_depth + (lhs_width - 1)) & ~(lhs_width - 1);
+  const int lhs_layout_cols = (cols + (depth - 1)) & ~(depth - 1);
+  const int rhs_layout_rows = (batch_size + (rhs_width - 1)) & ~(rhs_width - 1);
+  const int rhs_layout_cols = lhs_layout_cols;
+  const int dst_layout_rows = rhs_layout_rows;
+  const int dst_layout_cols = lhs_layout_rows;
+  if (op_data_4bit->needs_prepack) {
+    const int weight_size = lhs_layout_rows * lhs_layout_cols / 2;
+    op_data_4bit->AllocatePackedRegion(
+        optimized_4bit::kDefaultAlignmentPadding + weight_size);
+    optimized_4bit::api::Prepack(
+        op_data_4bit->prepacked_cache, GetTensorData<int8_t>(filter),
+        lhs_layout_rows, lhs_layout_cols, output_depth, cols, lhs_width, depth);
+    op_data_4bit->needs_prepack = false;
+  }
+
+  std::vector<float> filter_scales(lhs_layout_rows, filter->params.scale);
+  const auto* filter_params =
+      reinterpret_cast<TfLiteAffineQuantization*>(filter->quantization.params);
+  if (filter_params && filter_params->scale && filter_params->scale->size > 0) {
+    if (filter_params->scale->size == 1) {
+      std::fill(filter_scales.begin(), filter_scales.end(),
+                filter_params->scale->data[0]);
+    } else {
+      TF_LITE_ENSURE_EQ(context, filter_params->scale->size, output_depth);
+      for (int i = 0; i < filter_params->scale->size; ++i) {
+        filter_scales[i] = filter_params->scale->data[i];
+      }
+    }
+  }
+  float* scaling_factors_ptr = GetTensorData<float>(scaling_factors);
+  int8_t* quant_data = GetTensorData<int8_t>(input_quantized);
+  int32_t* input_offset_ptr = GetTensorData<int32_t>(input_offsets);
+  optimized_4bit::api::BatchQuantizeFloats4Bit(
+      GetTensorData<float>(input), batch_size, cols, quant_data,
+      scaling_factors_ptr, rhs_width, depth, input_offset_ptr);
+  optimized_4bit::api::AssignBiasAndComputeOffsets(
+      input_offset_ptr, scaling_factors_ptr, filter_scales.data(),
+      GetTensorData<float>(bias), GetTensorData<float>(output), output_depth,
+      batch_size);
+  optimized_4bit::api::RunAndUnpack(
+      rhs_width, op_data_4bit->prepacked_cache, quant_data,
+      GetTensorData<int32_t>(accum_scratch), output_depth, batch_size,
+      lhs_layout_rows, lhs_layout_cols, rhs_layout_rows, rhs_layout_cols,
+      dst_layout_rows, dst_layout_cols, GetTensorData<float>(output),
+      scaling_factors_ptr, filter_scales.data());
+  tensor_utils::ApplyActivationToVector(
+      GetTensorData<float>(output), batch_size * output_depth,
+      params->activation, GetTensorData<float>(output));
+  return kTfLiteOk;
+}
+
 template <KernelType kernel_type, TfLiteType input_type>
 TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLiteConvParams*>(node->builtin_data);
@@ -1220,7 +1430,11 @@ TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node) {
   TFLITE_DCHECK_EQ(input_type, input->type);
   switch (input_type) {  // Already know in/outtypes are same.
     case kTfLiteFloat32:
-      if (filter->type == kTfLiteUInt8 || filter->type == kTfLiteInt8) {
+      if (data->op_data_4bit) {
+        TF_LITE_ENSURE_OK(context,
+                          EvalHybrid4Bit(context, node, params, data, input,
+                                         filter, bias, output));
+      } else if (filter->type == kTfLiteUInt8 || filter->type == kTfLiteInt8) {
         if (data->is_hybrid_per_channel ||
             // TODO(b/162870360): Fallback to PerChannel implementation
             // before we have grouped hybrid convolution.
@@ -15,6 +15,7 @@ limitations under the License.
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <initializer_list>
 #include <map>
 #include <memory>
@@ -1954,6 +1955,93 @@ TEST_P(ConvolutionOpTest, Simple4bitPerChannelTest) {
   EXPECT_THAT(m.GetOutput<int8_t>(), ElementsAreArray({61, 127, -115, -93}));
 }
 
+// A 1x1 convolution with a constant int4 filter, densely packed two values per
+// byte, of a float input.
+class Hybrid4BitConvolutionOpModel : public SingleOpModel {
+ public:
+  Hybrid4BitConvolutionOpModel(
+      TfLiteRegistration* registration, const TensorData& input,
+      const TensorData& filter, const std::vector<int8_t>& filter_data,
+      enum ActivationFunctionType activation = ActivationFunctionType_NONE) {
+    input_ = AddInput(input);
+    std::vector<int8_t> packed_filter((filter_data.size() + 1) / 2, 0);
+    for (size_t i = 0; i < filter_data.size(); ++i) {
+      packed_filter[i / 2] |= (filter_data[i] & 0xf) << (i % 2 == 0 ? 0 : 4);
+    }
+    filter_ = AddConstInput<int8_t>(filter, packed_filter.data(),
+                                    packed_filter.size());
+    bias_ = AddInput({TensorType_FLOAT32, {filter.shape[0]}});
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(builder_, Padding_VALID,
+                                     /*stride_w=*/1, /*stride_h=*/1, activation)
+                     .Union());
+    resolver_ = std::make_unique<SingleOpResolver>(BuiltinOperator_CONV_2D,
+                                                   registration);
+    BuildInterpreter({GetShape(input_), GetShape(filter_), GetShape(bias_)});
+  }
+
+  void SetInput(const std::vector<float>& data) {
+    PopulateTensor(input_, data);
+  }
+  void SetBias(const std::vector<float>& data) { PopulateTensor(bias_, data); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ protected:
+  int input_;
+  int filter_;
+  int bias_;
+  int output_;
+};
+
+TEST_P(ConvolutionOpTest, PointwiseHybrid4bitPerChannel) {
+  const int channels_in = 64;
+  const int channels_out = 5;
+  const std::vector<float> scales = {0.1, 0.2, 0.3, 0.4, 0.5};
+  std::vector<int8_t> filter(channels_out * channels_in);
+  for (int i = 0; i < channels_out * channels_in; ++i) {
+    filter[i] = (i * 5) % 15 - 7;
+  }
+  Hybrid4BitConvolutionOpModel m(
+      GetRegistration(), {TensorType_FLOAT32, {2, 2, 3, channels_in}},
+      {TensorType_INT4,
+       {channels_out, 1, 1, channels_in},
+       0,
+       0,
+       0,
+       0,
+       /*per_channel_quantization=*/true,
+       /*per_channel_quantization_scales=*/scales,
+       /*per_channel_quantization_offsets=*/{0, 0, 0, 0, 0},
+       /*channel_index=*/0},
+      filter, ActivationFunctionType_RELU);
+  const int pixels = 2 * 2 * 3;
+  std::vector<float> input(pixels * channels_in);
+  for (int i = 0; i < pixels * channels_in; ++i) {
+    input[i] = ((i * 7) % 19 - 9) / 9.0f;
+  }
+  const std::vector<float> bias = {1, -1, 0.5, 2, -0.5};
+  m.SetInput(input);
+  m.SetBias(bias);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  std::vector<float> expected;
+  for (int p = 0; p < pixels; ++p) {
+    for (int o = 0; o < channels_out; ++o) {
+      float sum = bias[o];
+      for (int c = 0; c < channels_in; ++c) {
+        sum += input[p * channels_in + c] * filter[o * channels_in + c] *
+               scales[o];
+      }
+      expected.push_back(std::max(sum, 0.0f));
+    }
+  }
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                 expected, /*max_abs_error=*/0.1f)));
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 2, 3, channels_out}));
+}
+
 class HybridPerChannelConvolutionOpModel
     : public BaseConvolutionOpModel<int8_t> {
  public:
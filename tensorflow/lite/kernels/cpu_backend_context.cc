@@ -28,9 +28,12 @@ limitations under the License.
 #include "ruy/path.h"  // from @ruy
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/macros.h"
+#include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/op_macros.h"
+#include "tensorflow/lite/kernels/shared_thread_pools.h"
 
 namespace {
 const int kDefaultNumThreadpoolThreads = 1;
@@ -121,6 +124,16 @@ CpuBackendContext* CpuBackendContext::GetFromContext(TfLiteContext* context) {
         std::unique_ptr<TfLiteInternalBackendContext>(cpu_backend_context));
   }
 
+  // A context shared with other interpreters keeps GEMM autotuning once one of
+  // them enabled it.
+  if (context->impl_ != nullptr) {
+    const InterpreterOptions* options =
+        static_cast<Subgraph*>(context->impl_)->GetOptions();
+    if (options != nullptr && options->GetGemmAutotuning()) {
+      cpu_backend_context->SetUseGemmAutotuning(true);
+    }
+  }
+
   return cpu_backend_context;
 }
 
@@ -151,8 +164,16 @@ void CpuBackendContext::SetUseCaching(bool flag) { use_caching_ = flag; }
 
 pthreadpool_t CpuBackendContext::get_xnnpack_threadpool() {
   if (!xnnpack_threadpool_ && max_num_threads_ > 1) {
-    xnnpack_threadpool_.reset(
-        pthreadpool_create(static_cast<size_t>(max_num_threads_)));
+    auto create = [](int num_threads) {
+      return std::shared_ptr<pthreadpool>(
+          pthreadpool_create(static_cast<size_t>(num_threads)),
+          &pthreadpool_destroy);
+    };
+    xnnpack_threadpool_ =
+        shared_thread_pools::IsEnabled()
+            ? shared_thread_pools::GetOrCreate<pthreadpool>(max_num_threads_,
+                                                            create)
+            : create(max_num_threads_);
   }
   return xnnpack_threadpool_.get();
 }
@@ -28,6 +28,7 @@ limitations under the License.
 #include "ruy/context.h"  // from @ruy
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm_autotuner.h"
 
 namespace tflite {
 
@@ -54,6 +55,14 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
 
   bool use_caching() const { return use_caching_; }
 
+  // Lets CpuBackendGemm::Gemm choose between the default backend and ruy for
+  // each GEMM shape by timing both on the first calls with that shape.
+  void SetUseGemmAutotuning(bool flag) { use_gemm_autotuning_ = flag; }
+
+  bool use_gemm_autotuning() const { return use_gemm_autotuning_; }
+
+  cpu_backend_gemm::GemmAutotuner* gemm_autotuner() { return &gemm_autotuner_; }
+
   pthreadpool_t get_xnnpack_threadpool();
 
   void ClearCaches() override { ruy_context_->ClearPrepackedCache(); }
@@ -118,10 +127,16 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
   // (currently the Ruy library only).
   bool use_caching_;
 
+  // Off by default: the first calls of each GEMM shape run on both backends,
+  // which is only worth it for models invoked many times.
+  bool use_gemm_autotuning_ = false;
+  cpu_backend_gemm::GemmAutotuner gemm_autotuner_;
+
   // A smart pointer for the xnnpack threadpool. Is created by a call from the
   // interpreter, and then consumed by xnnpack, possibly via a TFLite kernel.
-  std::unique_ptr<pthreadpool, decltype(&pthreadpool_destroy)>
-      xnnpack_threadpool_{nullptr, &pthreadpool_destroy};
+  // It is shared with the other interpreters if `shared_thread_pools` is
+  // enabled.
+  std::shared_ptr<pthreadpool> xnnpack_threadpool_;
 
   CpuBackendContext(const CpuBackendContext&) = delete;
 };
@@ -16,10 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_H_
 #define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_H_
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <cstdint>
 
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm_autotuner.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_custom_gemv.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_ruy.h"
@@ -109,6 +111,60 @@ struct GemmImpl<float, float, float, float, QuantizationFlavor::kFloatingPoint>
 
 #endif  // not TFLITE_WITH_RUY and TFLITE_X86_PLATFORM
 
+namespace detail {
+
+// Identifies the scalar types and quantization flavor of a GEMM, see
+// GemmShape::types.
+template <typename LhsScalar, typename RhsScalar, typename AccumScalar,
+          typename DstScalar, QuantizationFlavor quantization_flavor>
+struct GemmTypesKey {
+  static constexpr char kKey = 0;
+};
+
+// Runs the GEMM on the backend chosen for its shape by the context's
+// GemmAutotuner, timing it while the autotuner is still comparing backends.
+template <typename LhsScalar, typename RhsScalar, typename AccumScalar,
+          typename DstScalar, QuantizationFlavor quantization_flavor>
+void AutotunedGemm(
+    const MatrixParams<LhsScalar>& lhs_params, const LhsScalar* lhs_data,
+    const MatrixParams<RhsScalar>& rhs_params, const RhsScalar* rhs_data,
+    const MatrixParams<DstScalar>& dst_params, DstScalar* dst_data,
+    const GemmParams<AccumScalar, DstScalar, quantization_flavor>& params,
+    CpuBackendContext* context) {
+  const GemmShape shape{
+      dst_params.rows, lhs_params.cols, dst_params.cols,
+      &GemmTypesKey<LhsScalar, RhsScalar, AccumScalar, DstScalar,
+                    quantization_flavor>::kKey,
+      context->max_num_threads()};
+  GemmAutotuner* autotuner = context->gemm_autotuner();
+  bool measure;
+  const GemmBackend backend = autotuner->Choose(shape, &measure);
+  ruy::profiler::ScopeLabel label(
+      backend == GemmBackend::kRuy
+          ? "cpu_backend_gemm::Gemm: autotuned ruy"
+          : "cpu_backend_gemm::Gemm: autotuned default");
+  const auto start = std::chrono::steady_clock::now();
+  if (backend == GemmBackend::kRuy) {
+    GemmImplUsingRuy<LhsScalar, RhsScalar, AccumScalar, DstScalar,
+                     quantization_flavor>::Run(lhs_params, lhs_data,
+                                               rhs_params, rhs_data,
+                                               dst_params, dst_data, params,
+                                               context);
+  } else {
+    GemmImpl<LhsScalar, RhsScalar, AccumScalar, DstScalar,
+             quantization_flavor>::Run(lhs_params, lhs_data, rhs_params,
+                                       rhs_data, dst_params, dst_data, params,
+                                       context);
+  }
+  if (measure) {
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    autotuner->Record(shape, backend, elapsed.count());
+  }
+}
+
+}  // namespace detail
+
 /* Public entry point */
 
 template <typename LhsScalar, typename RhsScalar, typename AccumScalar,
@@ -165,6 +221,14 @@ void Gemm(const MatrixParams<LhsScalar>& lhs_params, const LhsScalar* lhs_data,
       return;
     }
   }
+#if !defined(TFLITE_WITH_RUY)
+  // With ruy as the only backend there is nothing to choose from.
+  if (context->use_gemm_autotuning()) {
+    detail::AutotunedGemm(lhs_params, lhs_data, rhs_params, rhs_data,
+                          dst_params, dst_data, params, context);
+    return;
+  }
+#endif
   // Generic case: dispatch to any backend as a general GEMM.
   GemmImpl<LhsScalar, RhsScalar, AccumScalar, DstScalar,
            quantization_flavor>::Run(lhs_params, lhs_data, rhs_params, rhs_data,
@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/cpu_backend_gemm_autotuner.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace cpu_backend_gemm {
+
+const char* GemmBackendName(GemmBackend backend) {
+  switch (backend) {
+    case GemmBackend::kDefault:
+      return "default";
+    case GemmBackend::kRuy:
+      return "ruy";
+  }
+  return "unknown";
+}
+
+size_t GemmAutotuner::ShapeHash::operator()(const GemmShape& shape) const {
+  size_t hash = std::hash<const void*>()(shape.types);
+  for (int value :
+       {shape.rows, shape.depth, shape.cols, shape.num_threads}) {
+    hash = hash * 31 + std::hash<int>()(value);
+  }
+  return hash;
+}
+
+GemmBackend GemmAutotuner::Choose(const GemmShape& shape, bool* measure) {
+  const Entry& entry = entries_[shape];
+  *measure = !entry.chosen;
+  if (entry.chosen) return entry.backend;
+  // Alternate between the backends, so that caches are warmed equally.
+  return entry.trials[0] <= entry.trials[1] ? GemmBackend::kDefault
+                                            : GemmBackend::kRuy;
+}
+
+void GemmAutotuner::Record(const GemmShape& shape, GemmBackend backend,
+                           double seconds) {
+  Entry& entry = entries_[shape];
+  if (entry.chosen) return;
+  const int i = static_cast<int>(backend);
+  if (entry.trials[i] == 0 || seconds < entry.best_seconds[i]) {
+    entry.best_seconds[i] = seconds;
+  }
+  ++entry.trials[i];
+  if (entry.trials[0] < kTrialsPerBackend ||
+      entry.trials[1] < kTrialsPerBackend) {
+    return;
+  }
+  entry.chosen = true;
+  entry.backend = entry.best_seconds[1] < entry.best_seconds[0]
+                      ? GemmBackend::kRuy
+                      : GemmBackend::kDefault;
+  TFLITE_LOG(TFLITE_LOG_VERBOSE,
+             "Chose the %s GEMM backend for rows=%d depth=%d cols=%d "
+             "threads=%d (default: %g us, ruy: %g us).",
+             GemmBackendName(entry.backend), shape.rows, shape.depth,
+             shape.cols, shape.num_threads, entry.best_seconds[0] * 1e6,
+             entry.best_seconds[1] * 1e6);
+}
+
+bool GemmAutotuner::GetChoice(const GemmShape& shape,
+                              GemmBackend* backend) const {
+  auto it = entries_.find(shape);
+  if (it == entries_.end() || !it->second.chosen) return false;
+  *backend = it->second.backend;
+  return true;
+}
+
+}  // namespace cpu_backend_gemm
+}  // namespace tflite
@@ -0,0 +1,87 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_AUTOTUNER_H_
+#define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_AUTOTUNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace tflite {
+namespace cpu_backend_gemm {
+
+// The backends that CpuBackendGemm::Gemm can choose between at runtime.
+enum class GemmBackend {
+  // The backend selected at compile time for the types, see GemmImpl.
+  kDefault,
+  kRuy,
+};
+
+const char* GemmBackendName(GemmBackend backend);
+
+// Identifies the GEMMs that get the same backend.
+struct GemmShape {
+  int rows;
+  int depth;
+  int cols;
+  // Distinguishes the scalar types and quantization flavors.
+  const void* types;
+  int num_threads;
+
+  bool operator==(const GemmShape& other) const {
+    return rows == other.rows && depth == other.depth && cols == other.cols &&
+           types == other.types && num_threads == other.num_threads;
+  }
+};
+
+// Chooses the faster backend for each GEMM shape by timing every candidate on
+// the first few calls with that shape. Not thread safe, like the
+// CpuBackendContext owning it.
+class GemmAutotuner {
+ public:
+  // The number of timed calls per backend before choosing one.
+  static constexpr int kTrialsPerBackend = 3;
+
+  // Returns the backend to run the next GEMM of `shape` with. Sets `*measure`
+  // if the run must be timed and passed to Record().
+  GemmBackend Choose(const GemmShape& shape, bool* measure);
+
+  // Records that running `backend` on `shape` took `seconds`.
+  void Record(const GemmShape& shape, GemmBackend backend, double seconds);
+
+  // Returns whether a backend was chosen for `shape`, and which in `*backend`.
+  bool GetChoice(const GemmShape& shape, GemmBackend* backend) const;
+
+ private:
+  struct ShapeHash {
+    size_t operator()(const GemmShape& shape) const;
+  };
+
+  struct Entry {
+    int trials[2] = {0, 0};
+    // The fastest time of each backend, in seconds.
+    double best_seconds[2] = {0, 0};
+    bool chosen = false;
+    GemmBackend backend = GemmBackend::kDefault;
+  };
+
+  std::unordered_map<GemmShape, Entry, ShapeHash> entries_;
+};
+
+}  // namespace cpu_backend_gemm
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_AUTOTUNER_H_
@@ -33,6 +33,7 @@ limitations under the License.
 #include "ruy/matrix.h"  // from @ruy
 #include "ruy/reference_mul.h"  // from @ruy
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm_autotuner.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_ruy.h"
 
@@ -632,6 +633,78 @@ TEST(CpuBackendGemmSimpleTestAgainstGolden, Int8Int16) {
       3, 5, 4, {19, 48, 77, 48, 149, 250, 76, 249, 422, 105, 350, 595});
 }
 
+TEST(CpuBackendGemmAutotunerTest, ChoosesFasterBackend) {
+  using cpu_backend_gemm::GemmAutotuner;
+  using cpu_backend_gemm::GemmBackend;
+  GemmAutotuner autotuner;
+  static constexpr char kTypes = 0;
+  const cpu_backend_gemm::GemmShape shape{8, 16, 4, &kTypes, 1};
+  GemmBackend backend;
+  for (int i = 0; i < 2 * GemmAutotuner::kTrialsPerBackend; ++i) {
+    EXPECT_FALSE(autotuner.GetChoice(shape, &backend));
+    bool measure;
+    backend = autotuner.Choose(shape, &measure);
+    EXPECT_TRUE(measure);
+    autotuner.Record(shape, backend, backend == GemmBackend::kRuy ? 1 : 2);
+  }
+  ASSERT_TRUE(autotuner.GetChoice(shape, &backend));
+  EXPECT_EQ(backend, GemmBackend::kRuy);
+  bool measure;
+  EXPECT_EQ(autotuner.Choose(shape, &measure), GemmBackend::kRuy);
+  EXPECT_FALSE(measure);
+
+  // Other shapes are tuned separately.
+  const cpu_backend_gemm::GemmShape other_shape{8, 16, 4, &kTypes, 2};
+  EXPECT_FALSE(autotuner.GetChoice(other_shape, &backend));
+}
+
+TEST(CpuBackendGemmAutotuningTest, Float) {
+  CpuBackendContext cpu_backend_context;
+  cpu_backend_context.SetUseCaching(false);
+  cpu_backend_context.SetUseGemmAutotuning(true);
+  const int rows = 5, depth = 7, cols = 3;
+  std::vector<float> lhs_data;
+  std::vector<float> rhs_data;
+  MakeVectorFilledWithConsecutiveInts(rows * depth, &lhs_data);
+  MakeVectorFilledWithConsecutiveInts(depth * cols, &rhs_data);
+  MatrixParams<float> lhs_params;
+  lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.rows = rows;
+  lhs_params.cols = depth;
+  MatrixParams<float> rhs_params;
+  rhs_params.order = cpu_backend_gemm::Order::kColMajor;
+  rhs_params.rows = depth;
+  rhs_params.cols = cols;
+  MatrixParams<float> dst_params;
+  dst_params.order = cpu_backend_gemm::Order::kColMajor;
+  dst_params.rows = rows;
+  dst_params.cols = cols;
+  GemmParams<float, float> params;
+
+  // Both backends compute the small integer products exactly.
+  std::vector<float> expected(rows * cols);
+  Gemm(lhs_params, lhs_data.data(), rhs_params, rhs_data.data(), dst_params,
+       expected.data(), params, &cpu_backend_context);
+  const int num_calls =
+      2 * cpu_backend_gemm::GemmAutotuner::kTrialsPerBackend + 2;
+  for (int i = 0; i < num_calls; ++i) {
+    std::vector<float> dst_data(rows * cols);
+    Gemm(lhs_params, lhs_data.data(), rhs_params, rhs_data.data(), dst_params,
+         dst_data.data(), params, &cpu_backend_context);
+    EXPECT_EQ(dst_data, expected);
+  }
+#if !defined(TFLITE_WITH_RUY)
+  cpu_backend_gemm::GemmBackend backend;
+  EXPECT_TRUE(cpu_backend_context.gemm_autotuner()->GetChoice(
+      {rows, depth, cols,
+       &cpu_backend_gemm::detail::GemmTypesKey<
+           float, float, float, float,
+           QuantizationFlavor::kFloatingPoint>::kKey,
+       cpu_backend_context.max_num_threads()},
+      &backend));
+#endif
+}
+
 template <typename tLhsScalar, typename tRhsScalar, typename tAccumScalar,
           typename tDstScalar>
 struct TypesTuple {
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/kernels/internal/optimized/eigen_spatial_convolutions.h"
 #include "tensorflow/lite/kernels/op_macros.h"
+#include "tensorflow/lite/kernels/shared_thread_pools.h"
 
 #ifndef EIGEN_DONT_ALIGN
 #include "tensorflow/lite/util.h"
@@ -70,7 +71,13 @@ class EigenThreadPoolWrapper : public Eigen::ThreadPoolInterface {
   explicit EigenThreadPoolWrapper(int num_threads) {
     // Avoid creating any threads for the single-threaded case.
     if (num_threads > 1) {
-      pool_ = std::make_unique<Eigen::ThreadPool>(num_threads);
+      auto create = [](int num_threads) {
+        return std::make_shared<Eigen::ThreadPool>(num_threads);
+      };
+      pool_ = shared_thread_pools::IsEnabled()
+                  ? shared_thread_pools::GetOrCreate<Eigen::ThreadPool>(
+                        num_threads, create)
+                  : create(num_threads);
     }
   }
   ~EigenThreadPoolWrapper() override {}
@@ -88,8 +95,9 @@ class EigenThreadPoolWrapper : public Eigen::ThreadPoolInterface {
   }
 
  private:
-  // May be null if num_threads <= 1.
-  std::unique_ptr<Eigen::ThreadPool> pool_;
+  // May be null if num_threads <= 1. Shared with the other interpreters if
+  // `shared_thread_pools` is enabled.
+  std::shared_ptr<Eigen::ThreadPool> pool_;
 };
 
 // Utility class for lazily creating an Eigen thread pool/device only when used.
@@ -32,9 +32,12 @@ limitations under the License.
 #include <stdint.h>
 
 #include <cstring>
+#include <unordered_map>
 
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 
 namespace tflite {
@@ -42,6 +45,30 @@ namespace ops {
 namespace builtin {
 namespace embedding_lookup {
 
+struct OpData {
+  // Maps the rows already dequantized by the current lookup to their position
+  // in the output. Kept between invocations to reuse its buckets.
+  std::unordered_map<int32_t, int> dequantized_rows;
+};
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  return new OpData();
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
+// Prefetches the table row of the next lookup, so that it is in cache once
+// the current row is copied. Rows of large (often mmapped) tables are rarely
+// cached otherwise.
+inline void PrefetchRow(const char* row, int row_bytes) {
+  constexpr int kCacheLineSize = 64;
+  for (int offset = 0; offset < row_bytes; offset += kCacheLineSize) {
+    optimized_ops_preload_l1_stream(row + offset);
+  }
+}
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 2);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
@@ -97,7 +124,8 @@ TfLiteStatus EvalSimple(TfLiteContext* context, TfLiteNode* node,
   char* output_raw = GetTensorData<char>(output);
   const char* value_raw = GetTensorData<char>(value);
   const int32_t* lookup_data = GetTensorData<int32_t>(lookup);
-  for (int i = 0; i < SizeOfDimension(lookup, 0); i++) {
+  const int num_lookups = SizeOfDimension(lookup, 0);
+  for (int i = 0; i < num_lookups; i++) {
     int idx = lookup_data[i];
     if (idx >= row_size || idx < 0) {
       TF_LITE_KERNEL_LOG(context,
@@ -106,6 +134,12 @@ TfLiteStatus EvalSimple(TfLiteContext* context, TfLiteNode* node,
                          idx, row_size - 1);
       return kTfLiteError;
     } else {
+      if (i + 1 < num_lookups) {
+        const int next_idx = lookup_data[i + 1];
+        if (next_idx < row_size && next_idx >= 0) {
+          PrefetchRow(value_raw + next_idx * row_bytes, row_bytes);
+        }
+      }
       std::memcpy(output_raw + i * row_bytes, value_raw + idx * row_bytes,
                   row_bytes);
     }
@@ -128,8 +162,21 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
   float* output_ptr = GetTensorData<float>(output);
   const int8_t* value_ptr = GetTensorData<int8_t>(value);
   const int32_t* lookup_data = GetTensorData<int32_t>(lookup);
+  const int num_lookups = SizeOfDimension(lookup, 0);
+
+  const TfLiteAffineQuantization* qparams = nullptr;
+  if (value->quantization.type == kTfLiteAffineQuantization) {
+    qparams = static_cast<const TfLiteAffineQuantization*>(
+        value->quantization.params);
+  }
 
-  for (int i = 0; i < SizeOfDimension(lookup, 0); i++) {
+  // Repeated ids (e.g. in a batch of recommendation features) copy the row
+  // that was already dequantized instead of reading the table again.
+  auto& dequantized_rows =
+      reinterpret_cast<OpData*>(node->user_data)->dequantized_rows;
+  dequantized_rows.clear();
+
+  for (int i = 0; i < num_lookups; i++) {
     int idx = lookup_data[i];
     if (idx >= row_size || idx < 0) {
       TF_LITE_KERNEL_LOG(context,
@@ -137,23 +184,37 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
                          "Got %d, and bounds are [0, %d]",
                          idx, row_size - 1);
       return kTfLiteError;
-    } else {
-      // Dequantize embedding values.
-      // TODO(alanchiao): refactor scalar multiply into separate function
-      // for ease of adding a neon equivalent if ever necessary.
-      double scaling_factor = value->params.scale;
-      if (value->quantization.type == kTfLiteAffineQuantization) {
-        const auto qparams = static_cast<const TfLiteAffineQuantization*>(
-            value->quantization.params);
-        if (qparams->scale->size > 1) {
-          // get this row's scale for per-axis quantization
-          scaling_factor = qparams->scale->data[idx];
-        }
+    }
+    float* output_row = output_ptr + i * col_size;
+    const auto inserted = dequantized_rows.emplace(idx, i);
+    if (!inserted.second) {
+      std::memcpy(output_row, output_ptr + inserted.first->second * col_size,
+                  col_size * sizeof(float));
+      continue;
+    }
+    if (i + 1 < num_lookups) {
+      const int next_idx = lookup_data[i + 1];
+      if (next_idx < row_size && next_idx >= 0) {
+        PrefetchRow(reinterpret_cast<const char*>(value_ptr) +
+                        next_idx * col_size,
+                    col_size);
       }
+    }
 
+    // Dequantize embedding values.
+    float scaling_factor = value->params.scale;
+    if (qparams != nullptr && qparams->scale->size > 1) {
+      // get this row's scale for per-axis quantization
+      scaling_factor = qparams->scale->data[idx];
+    }
+    const int8_t* value_row = value_ptr + idx * col_size;
+    if (reinterpret_cast<uintptr_t>(value_row) % sizeof(int32_t) == 0) {
+      // The vectorized kernels need 4-byte aligned rows.
+      tensor_utils::VectorScalarMultiply(value_row, col_size, scaling_factor,
+                                         output_row);
+    } else {
       for (int j = 0; j < col_size; j++) {
-        output_ptr[j + i * col_size] =
-            value_ptr[j + idx * col_size] * scaling_factor;
+        output_row[j] = value_row[j] * scaling_factor;
       }
     }
   }
@@ -187,7 +248,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 }  // namespace embedding_lookup
 
 TfLiteRegistration* Register_EMBEDDING_LOOKUP() {
-  static TfLiteRegistration r = {nullptr, nullptr, embedding_lookup::Prepare,
+  static TfLiteRegistration r = {embedding_lookup::Init, embedding_lookup::Free,
+                                 embedding_lookup::Prepare,
                                  embedding_lookup::Eval};
   return &r;
 }
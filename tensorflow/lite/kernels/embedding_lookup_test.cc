@@ -228,6 +228,29 @@ TEST(HybridEmbeddingLookupHybridOpTest, Simple2DTestInt8) {
                   kTestTolerance)));
 }
 
+TEST(HybridEmbeddingLookupHybridOpTest, RepeatedUnalignedRowsTestInt8) {
+  HybridEmbeddingLookupOpModel m({5}, {3, 3}, TensorType_INT8);
+  m.SetInput({2, 0, 2, 2, 1});
+  m.SetSignedWeight({
+      0.00, 0.01,  0.02,  // Row 0
+      1.00, -1.01, 1.02,  // Row 1
+      2.00, 2.01,  2.02,  // Row 2
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput<float>(),
+              ElementsAreArray(ArrayFloatNear(
+                  {
+                      2.00, 2.01,  2.02,  // Row 2
+                      0.00, 0.01,  0.02,  // Row 0
+                      2.00, 2.01,  2.02,  // Row 2
+                      2.00, 2.01,  2.02,  // Row 2
+                      1.00, -1.01, 1.02,  // Row 1
+                  },
+                  kTestTolerance)));
+}
+
 TEST(HybridEmbeddingLookupHybridOpTest, Simple3DTestInt8) {
   HybridEmbeddingLookupOpModel m({3}, {3, 2, 4}, TensorType_INT8);
   m.SetInput({1, 0, 2});
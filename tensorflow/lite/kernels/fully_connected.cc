@@ -65,6 +65,47 @@ bool SupportedSparsityFormat(const TfLiteSparsity& sparsity) {
 static const int kDimMetadataSizeRandomSparse = 2;
 static const int kDimMetadataSizeBlockSparse = 3;
 
+// Packs a random sparse filter into the 2:4 structured sparse format of
+// tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate2of4. Returns false if
+// some group of 4 consecutive columns of a row holds more than 2 non-zeros.
+template <typename T>
+bool PackSparseWeight2of4(const TfLiteSparsity& sparsity,
+                          const T* weights_data, int rows, int cols,
+                          std::vector<T>* packed_weights,
+                          std::vector<uint8_t>* packed_indices) {
+  constexpr int kGroupSize = 4;
+  if (sparsity.dim_metadata_size != kDimMetadataSizeRandomSparse ||
+      cols % kGroupSize != 0 ||
+      sparsity.dim_metadata[1].array_segments->size != rows + 1) {
+    return false;
+  }
+  const int num_groups = cols / kGroupSize;
+  const int* segments = sparsity.dim_metadata[1].array_segments->data;
+  const int* indices = sparsity.dim_metadata[1].array_indices->data;
+  // Groups with less than 2 non-zeros are padded with zeros at positions 0 and
+  // 1.
+  packed_weights->assign(rows * num_groups * 2, 0);
+  packed_indices->assign(rows * num_groups, 1 << 2);
+  std::vector<int> group_counts(num_groups);
+  for (int row = 0; row < rows; ++row) {
+    std::fill(group_counts.begin(), group_counts.end(), 0);
+    for (int i = segments[row]; i < segments[row + 1]; ++i) {
+      const int col = indices[i];
+      if (col < 0 || col >= cols) return false;
+      const int group = col / kGroupSize;
+      const int slot = group_counts[group]++;
+      if (slot >= 2) return false;
+      const int packed_group = row * num_groups + group;
+      (*packed_weights)[packed_group * 2 + slot] = weights_data[i];
+      const int shift = slot * 2;
+      uint8_t& group_indices = (*packed_indices)[packed_group];
+      group_indices = static_cast<uint8_t>((group_indices & ~(3 << shift)) |
+                                           ((col % kGroupSize) << shift));
+    }
+  }
+  return true;
+}
+
 TfLiteStatus CreateLedgerTensor(const TfLiteSparsity* sparsity,
                                 TfLiteContext* context, TfLiteTensor* ledger) {
   TF_LITE_ENSURE(context, sparsity != nullptr);
@@ -157,6 +198,13 @@ struct OpData {
   bool compute_row_sums = false;
   // Only used for sparse hybrid fully connected kernels.
   bool ledger_initialized;
+  // Only used for sparse fully connected kernels. Filters with 2:4 structured
+  // sparsity are packed on the first invocation.
+  bool sparse_2of4_initialized = false;
+  bool is_sparse_2of4 = false;
+  std::vector<float> sparse_2of4_float_weights;
+  std::vector<int8_t> sparse_2of4_int8_weights;
+  std::vector<uint8_t> sparse_2of4_indices;
   // Used for 4bit hybrid
   std::unique_ptr<optimized_4bit::OpData4Bit> op_data_4bit = nullptr;
   TfLiteType quantized_bias_type = kTfLiteNoType;
@@ -525,13 +573,8 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
         return kTfLiteOk;
       }
       data->op_data_4bit->batch_size = batch_size;
-      for (int packed_rows = optimized_4bit::GetMaxSupportedRows();
-           packed_rows > 0; packed_rows /= 2) {
-        if (batch_size >= packed_rows) {
-          data->op_data_4bit->rows_right = packed_rows;
-          break;
-        }
-      }
+      data->op_data_4bit->rows_right =
+          optimized_4bit::GetRowsRight(batch_size);
       return PrepareImpl4Bit(context, node, optimized_4bit::FilterWidth,
                              data->op_data_4bit->rows_right,
                              optimized_4bit::FilterDepth, batch_size, cols,
@@ -1368,8 +1411,26 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
           }
           // Int4 support for sparse filter tensor is currently not supported
           TF_LITE_ENSURE(context, filter->type != kTfLiteInt4);
-          if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
-              sparsity.dim_metadata[2].dense_size == 16) {
+          if (!data->sparse_2of4_initialized) {
+            data->is_sparse_2of4 = PackSparseWeight2of4(
+                sparsity, GetTensorData<int8_t>(filter), filter_shape.Dims(0),
+                filter_shape.Dims(1), &data->sparse_2of4_int8_weights,
+                &data->sparse_2of4_indices);
+            data->sparse_2of4_initialized = true;
+          }
+          if (data->is_sparse_2of4) {
+            // Random sparse with at most 2 non-zeros in every group of 4.
+            optimized_ops::FullyConnectedSparseWeight2of4(
+                op_params, input_shape, GetTensorData<int8_t>(input),
+                filter_shape, data->sparse_2of4_int8_weights.data(),
+                data->sparse_2of4_indices.data(),
+                data->per_channel_output_multiplier.data(),
+                data->per_channel_output_shift.data(), bias_shape,
+                GetTensorData<int32_t>(bias), output_shape,
+                GetTensorData<int8_t>(output));
+          } else if (sparsity.dim_metadata_size ==
+                         kDimMetadataSizeBlockSparse &&
+                     sparsity.dim_metadata[2].dense_size == 16) {
             // Block sparse with block size of 1x16.
             optimized_ops::FullyConnectedSparseWeight1x16(
                 sparsity, op_params, input_shape, GetTensorData<int8_t>(input),
@@ -1552,7 +1613,24 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
         return kTfLiteError;
       }
 
-      if (sparsity.dim_metadata_size == kDimMetadataSizeRandomSparse) {
+      if (!data->sparse_2of4_initialized) {
+        data->is_sparse_2of4 = PackSparseWeight2of4(
+            sparsity, GetTensorData<float>(filter), filter_shape.Dims(0),
+            filter_shape.Dims(1), &data->sparse_2of4_float_weights,
+            &data->sparse_2of4_indices);
+        data->sparse_2of4_initialized = true;
+      }
+
+      if (data->is_sparse_2of4) {
+        // Random sparse with at most 2 non-zeros in every group of 4.
+        optimized_ops::FullyConnectedSparseWeight2of4(
+            op_params, input_shape, GetTensorData<float>(input),
+            filter_shape, data->sparse_2of4_float_weights.data(),
+            data->sparse_2of4_indices.data(), bias_shape,
+            GetTensorData<float>(bias), output_shape,
+            GetTensorData<float>(output),
+            CpuBackendContext::GetFromContext(context));
+      } else if (sparsity.dim_metadata_size == kDimMetadataSizeRandomSparse) {
         // Random sparse.
         optimized_ops::FullyConnectedSparseWeight(
             sparsity, op_params,                         // Disable formatting
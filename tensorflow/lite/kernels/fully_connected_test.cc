@@ -2016,6 +2016,71 @@ TEST_P(SparseFullyConnectedOpTest, Simple1x4TestMultiThreadedMoreBatches) {
   }
 }
 
+TEST_P(SparseFullyConnectedOpTest, Simple2of4Test) {
+  // At most 2 non-zeros in every group of 4 columns.
+  std::initializer_list<float> weight_data = {
+      1, 0, 2, 0,  0, 3, 0,  4, 5, 0, 0, 6,  // u = 0
+      0, 0, -1, 1, 2, 0, -2, 0, 0, 0, 0, 3,  // u = 1
+      0, 0, 0, 0,  1, 1, 0,  0, 0, 0, 1, 1,  // u = 2
+  };
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {3, 12};
+  weight.traversal_order = {0, 1};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  SparseFullyConnectedOpModel<float> m(GetRegistration(),
+                                       /*units=*/3, /*batches=*/2,
+                                       /*input=*/{TensorType_FLOAT32, {2, 12}},
+                                       weight, weight_data);
+  m.SetBias({1, 2, 3});
+
+  m.SetInput({
+      1, 2, 3, 4, 5, 6, 7, 8,  -9, -10, 11,  12,  // b = 0
+      1, 2, 3, 4, 5, 6, 7, -8, 9,  -10, -11, 12,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(85, 35, 37, 111, 35, 15));
+}
+
+TEST_P(SparseFullyConnectedOpTest, Simple2of4TestMultiThreaded) {
+  std::initializer_list<float> weight_data = {
+      1, 0, 2, 0,  0, 3, 0,  4, 5, 0, 0, 6,  // u = 0
+      0, 0, -1, 1, 2, 0, -2, 0, 0, 0, 0, 3,  // u = 1
+      0, 0, 0, 0,  1, 1, 0,  0, 0, 0, 1, 1,  // u = 2
+  };
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {3, 12};
+  weight.traversal_order = {0, 1};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  for (int num_threads = 1; num_threads <= 4; num_threads++) {
+    SparseFullyConnectedOpModel<float> m(
+        GetRegistration(),
+        /*units=*/3, /*batches=*/3,
+        /*input=*/{TensorType_FLOAT32, {3, 12}}, weight, weight_data,
+        /*output=*/{TensorType_FLOAT32},
+        /*bias_tensor_optional=*/false, /*num_threads=*/num_threads);
+    m.SetBias({1, 2, 3});
+
+    m.SetInput({
+        1,  2,  3,  4,  5, 6, 7, 8,  -9, -10, 11,  12,  // b = 0
+        1,  2,  3,  4,  5, 6, 7, -8, 9,  -10, -11, 12,  // b = 1
+        -1, -2, -3, -4, 5, 6, 7, 8,  9,  10,  11,  12,  // b = 2
+    });
+
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+    EXPECT_THAT(m.GetOutputShape(), ElementsAre(3, 3));
+    EXPECT_THAT(m.GetOutput(), ElementsAre(85, 35, 37,   // b = 0
+                                           111, 35, 15,  // b = 1
+                                           161, 33, 37   // b = 2
+                                           ));
+  }
+}
+
 TEST_P(SparseHybridFullyConnectedOpTest, SparseHybrid1x16Test) {
   std::initializer_list<float> weight_data = {
       /* 1st row */
@@ -2377,6 +2442,34 @@ TEST_P(SparseQuantizedFullyConnectedOpTest,
   EXPECT_THAT(m.GetOutput(), ElementsAre(11, 1, 25, 0, 1, 21));
 }
 
+TEST_P(SparseQuantizedFullyConnectedOpTest, Simple2of4Test) {
+  // At most 2 non-zeros in every group of 4 columns.
+  std::vector<float> weight_data = {
+      1, 2,  0,  0, 0, 0, 3, -4, 1,  0, 0,  4, 4, 0, 0, -1,  // u = 0
+      0, 0,  0,  0, 0, 0, 0, 0,  0,  0, 0,  0, 0, 0, 0, 0,   // u = 1
+      0, -2, -3, 0, 4, 0, 0, 1,  -1, 0, -3, 0, 0, 2, 0, 4,   // u = 2
+  };
+  TensorData weight = {TensorType_INT8, {3, 16}, 0, 0, 1};
+  weight.traversal_order = {0, 1};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  SparseQuantizedFullyConnectedOpModel m(
+      GetRegistration(),
+      /*units=*/3, /*batches=*/2,
+      /*input=*/{TensorType_INT8, {2, 16}, 0, 0, 1, -1}, weight, weight_data,
+      /*output=*/{TensorType_INT8, {}, 0, 0, 1});
+
+  m.SetBias({1, 2, 3});
+  m.SetInput({
+      1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4,  // b = 0
+      4, 3, 2, 1, 4, 3, 2, 1, 4, 3, 2, 1, 4, 3, 2, 1,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(16, 2, 8, 36, 2, 8));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     SparseQuantizedFullyConnectedOpTest, SparseQuantizedFullyConnectedOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMapNoPie)));
@@ -38,6 +38,8 @@ struct OpData {
   int then_subgraph_index;
   int else_subgraph_index;
   bool subgraph_has_dynamic_output_tensors;
+  // True if the branch subgraphs are only prepared when they are invoked.
+  bool prepare_subgraphs_lazily;
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -46,6 +48,7 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   op_data->then_subgraph_index = params->then_subgraph_index;
   op_data->else_subgraph_index = params->else_subgraph_index;
   op_data->subgraph_has_dynamic_output_tensors = false;
+  op_data->prepare_subgraphs_lazily = false;
   return op_data;
 }
 
@@ -91,6 +94,29 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   then_subgraph->RemoveUnusedInputs();
   else_subgraph->RemoveUnusedInputs();
 
+  op_data->prepare_subgraphs_lazily =
+      this_subgraph->ShouldPrepareSubgraphsLazily();
+  if (op_data->prepare_subgraphs_lazily) {
+    // The active branch is prepared by Eval_dynamic() once it is known.
+    for (auto* subgraph : {then_subgraph, else_subgraph}) {
+      for (int input_idx : subgraph->inputs()) {
+        if (input_idx == kTfLiteOptionalTensor) continue;
+        TfLiteTensor* subgraph_input = subgraph->tensor(input_idx);
+        if (!IsResourceOrVariant(subgraph_input)) {
+          subgraph_input->allocation_type = kTfLiteCustom;
+        }
+      }
+    }
+    op_data->subgraph_has_dynamic_output_tensors = true;
+    for (int i = 0; i < num_outputs; ++i) {
+      if (node->outputs->data[i] == kTfLiteOptionalTensor) continue;
+      TfLiteTensor* output;
+      TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, i, &output));
+      SetTensorToDynamic(output);
+    }
+    return kTfLiteOk;
+  }
+
   const int* const start = node->inputs->data + 1;
   std::vector<int> node_inputs(start, start + num_inputs);
   // Prepare and check the subgraphs.
@@ -151,12 +177,22 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 TfLiteStatus Eval_dynamic(TfLiteContext* context, TfLiteNode* node,
                           Subgraph* active_branch_subgraph) {
   Subgraph* this_subgraph = reinterpret_cast<Subgraph*>(context->impl_);
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
 
-  TF_LITE_ENSURE_OK(context, active_branch_subgraph->AllocateTensors());
   const int num_inputs = node->inputs->size - 1;
   const int num_outputs = node->outputs->size;
   const int* const start = node->inputs->data + 1;
   std::vector<int> node_inputs(start, start + num_inputs);
+  if (op_data->prepare_subgraphs_lazily) {
+    // The branch inputs have the shapes of the model until the branch is
+    // first prepared.
+    TF_LITE_ENSURE_OK(context,
+                      CopyTensorsShapeAndType(
+                          context, this_subgraph, node_inputs,
+                          active_branch_subgraph,
+                          active_branch_subgraph->inputs(), true));
+  }
+  TF_LITE_ENSURE_OK(context, active_branch_subgraph->AllocateTensors());
   // node->inputs -> subgraph->inputs
   TF_LITE_ENSURE_OK(
       context, DeepOrShallowCopyTensorsShapeTypeData(
@@ -121,6 +121,33 @@ TEST_F(SimpleIfTest, TestIfFalseWithLargeInputsTwice) {
   CheckIntTensor(output, {kNumLargeTensors}, expected2);
 }
 
+TEST_F(ControlFlowOpTest, TestIfWithLazySubgraphPreparation) {
+  AddSubgraphs(2);
+  builder_->BuildAddSubgraph(interpreter_->subgraph(1));
+  builder_->BuildMulSubgraph(interpreter_->subgraph(2));
+  builder_->BuildIfSubgraph(&interpreter_->primary_subgraph());
+  InterpreterOptions options;
+  options.SetLazySubgraphPreparation();
+  ASSERT_EQ(interpreter_->ApplyOptions(&options), kTfLiteOk);
+
+  interpreter_->ResizeInputTensor(interpreter_->inputs()[0], {1});
+  interpreter_->ResizeInputTensor(interpreter_->inputs()[1], {2});
+  interpreter_->ResizeInputTensor(interpreter_->inputs()[2], {1, 2});
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  TfLiteTensor* output = interpreter_->tensor(interpreter_->outputs()[0]);
+  // The output shape is only known once a branch is prepared.
+  EXPECT_EQ(output->allocation_type, kTfLiteDynamic);
+
+  FillIntTensor(interpreter_->tensor(interpreter_->inputs()[1]), {5, 7});
+  FillIntTensor(interpreter_->tensor(interpreter_->inputs()[2]), {1, 2});
+  interpreter_->typed_input_tensor<bool>(0)[0] = true;
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  CheckIntTensor(output, {1, 2}, {6, 9});
+  interpreter_->typed_input_tensor<bool>(0)[0] = false;
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  CheckIntTensor(output, {1, 2}, {5, 14});
+}
+
 // Test IF op using subgraphs with dynamically sized outputs.
 // The computation is: `cond ? a + b : pad(a, b)`.
 class DynamicSubgraphIfTest : public ControlFlowOpTest {
@@ -86,6 +86,19 @@ struct OpData4Bit {
   }
 };
 
+// Returns the number of rows of the quantized input which are processed at
+// once for a batch of `batch_size` rows: the largest supported power of two
+// not exceeding `batch_size`.
+inline int GetRowsRight(int batch_size) {
+  for (int packed_rows = GetMaxSupportedRows(); packed_rows > 0;
+       packed_rows /= 2) {
+    if (batch_size >= packed_rows) {
+      return packed_rows;
+    }
+  }
+  return 1;
+}
+
 namespace api {
 /* Prepack lhs matrix into dest.
  * Transform tensor from (src_rows, src_cols) to
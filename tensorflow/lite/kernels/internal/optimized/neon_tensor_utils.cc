@@ -1961,6 +1961,53 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate1x4(
   }
 }
 
+void NeonSparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const float* __restrict__ matrix, const uint8_t* __restrict__ indices,
+    int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
+    float* __restrict__ result) {
+  constexpr int kGroupSize = 4;
+  TFLITE_DCHECK_EQ(m_cols % kGroupSize, 0);
+  const int num_groups = m_cols / kGroupSize;
+
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const uint8_t* indices_ptr = indices;
+    for (int row = 0; row < m_rows; row++) {
+      float32x4_t acc_32x4 = vmovq_n_f32(0.0);
+      const float* vector_group_ptr = vector + batch * m_cols;
+
+      // Two groups fill a vector with their 4 non-zeros, which are multiplied
+      // by the gathered values of the vector.
+      int g = 0;
+      for (; g <= num_groups - 2; g += 2) {
+        const int indices_0 = indices_ptr[0];
+        const int indices_1 = indices_ptr[1];
+        const float* next_group_ptr = vector_group_ptr + kGroupSize;
+        float32x4_t vector_f32x4 =
+            vld1q_dup_f32(vector_group_ptr + (indices_0 & 3));
+        vector_f32x4 = vld1q_lane_f32(
+            vector_group_ptr + ((indices_0 >> 2) & 3), vector_f32x4, 1);
+        vector_f32x4 =
+            vld1q_lane_f32(next_group_ptr + (indices_1 & 3), vector_f32x4, 2);
+        vector_f32x4 = vld1q_lane_f32(next_group_ptr + ((indices_1 >> 2) & 3),
+                                      vector_f32x4, 3);
+        acc_32x4 = vmlaq_f32(acc_32x4, vld1q_f32(matrix_ptr), vector_f32x4);
+        matrix_ptr += 2 * 2;
+        indices_ptr += 2;
+        vector_group_ptr += 2 * kGroupSize;
+      }
+      float dot_prod = AccumulateNeonLane(acc_32x4);
+      for (; g < num_groups; g++) {
+        const int group_indices = *indices_ptr++;
+        dot_prod += *matrix_ptr++ * vector_group_ptr[group_indices & 3];
+        dot_prod += *matrix_ptr++ * vector_group_ptr[(group_indices >> 2) & 3];
+        vector_group_ptr += kGroupSize;
+      }
+      result[batch * m_rows + row] += dot_prod;
+    }
+  }
+}
+
 void NeonSparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
@@ -2040,6 +2087,93 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate1x16(
   }
 }
 
+void NeonSparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ indices,
+    int m_rows, int m_cols, const int8_t* __restrict__ vector,
+    const int32_t* __restrict__ bias_vector, int n_batch,
+    const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  constexpr int kGroupSize = 4;
+  // Each step consumes the 8 non-zeros of 4 groups, which cover 16 values of
+  // the vector.
+  constexpr int kGroupsPerStep = 4;
+  TFLITE_DCHECK_EQ(m_cols % kGroupSize, 0);
+  const int num_groups = m_cols / kGroupSize;
+
+  // Expands the index bytes of 4 groups into the positions of their 8
+  // non-zeros within the 16 values of the vector.
+  static const uint8_t kDuplicateBytes[8] = {0, 0, 1, 1, 2, 2, 3, 3};
+  static const int8_t kIndexShifts[8] = {0, -2, 0, -2, 0, -2, 0, -2};
+  static const uint8_t kGroupOffsets[8] = {0, 0, 4, 4, 8, 8, 12, 12};
+  const uint8x8_t duplicate_bytes_u8x8 = vld1_u8(kDuplicateBytes);
+  const int8x8_t index_shifts_i8x8 = vld1_s8(kIndexShifts);
+  const uint8x8_t group_offsets_u8x8 = vld1_u8(kGroupOffsets);
+  const uint8x8_t index_mask_u8x8 = vdup_n_u8(3);
+
+  for (int batch = 0; batch < n_batch; ++batch) {
+    const int8_t* matrix_ptr = matrix;
+    const uint8_t* indices_ptr = indices;
+    for (int row = 0; row < m_rows; ++row) {
+      int32x4_t acc_i32x4 = vmovq_n_s32(0);
+      int32x4_t matrix_row_sum_i32x4 = vmovq_n_s32(0);
+      const int8_t* vector_group_ptr = vector + batch * m_cols;
+
+      int g = 0;
+      for (; g <= num_groups - kGroupsPerStep; g += kGroupsPerStep) {
+        uint32_t packed_indices;
+        memcpy(&packed_indices, indices_ptr, sizeof(packed_indices));
+        uint8x8_t indices_u8x8 =
+            vtbl1_u8(vreinterpret_u8_u32(vdup_n_u32(packed_indices)),
+                     duplicate_bytes_u8x8);
+        indices_u8x8 = vand_u8(vshl_u8(indices_u8x8, index_shifts_i8x8),
+                               index_mask_u8x8);
+        indices_u8x8 = vadd_u8(indices_u8x8, group_offsets_u8x8);
+
+        // Gather the 8 values of the vector which meet the non-zeros.
+        const int8x16_t vector_i8x16 = vld1q_s8(vector_group_ptr);
+        int8x8x2_t vector_i8x8x2;
+        vector_i8x8x2.val[0] = vget_low_s8(vector_i8x16);
+        vector_i8x8x2.val[1] = vget_high_s8(vector_i8x16);
+        const int8x8_t gathered_i8x8 =
+            vtbl2_s8(vector_i8x8x2, vreinterpret_s8_u8(indices_u8x8));
+
+        // Multiply the gathered values and the non-zeros and add to
+        // accumulator.
+        const int8x8_t matrix_i8x8 = vld1_s8(matrix_ptr);
+        acc_i32x4 =
+            vpadalq_s16(acc_i32x4, vmull_s8(gathered_i8x8, matrix_i8x8));
+        matrix_row_sum_i32x4 =
+            vpadalq_s16(matrix_row_sum_i32x4, vmovl_s8(matrix_i8x8));
+        matrix_ptr += kGroupsPerStep * 2;
+        indices_ptr += kGroupsPerStep;
+        vector_group_ptr += kGroupsPerStep * kGroupSize;
+      }
+      int32_t acc = AccumulateNeonLane(acc_i32x4);
+      int32_t matrix_row_sum = AccumulateNeonLane(matrix_row_sum_i32x4);
+      for (; g < num_groups; ++g) {
+        const int group_indices = *indices_ptr++;
+        acc += matrix_ptr[0] * vector_group_ptr[group_indices & 3];
+        acc += matrix_ptr[1] * vector_group_ptr[(group_indices >> 2) & 3];
+        matrix_row_sum += matrix_ptr[0] + matrix_ptr[1];
+        matrix_ptr += 2;
+        vector_group_ptr += kGroupSize;
+      }
+      const int32_t bias_value = bias_vector != nullptr ? bias_vector[row] : 0;
+      acc = acc + bias_value + input_offset * matrix_row_sum;
+      acc = MultiplyByQuantizedMultiplier(
+          acc, per_channel_scale ? per_channel_scale[row] : output_multiplier,
+          per_channel_shift ? per_channel_shift[row] : output_shift);
+      acc += output_offset;
+      result[batch * m_rows + row] =
+          static_cast<int8_t>(ActivationFunctionWithMinMax(
+              acc, output_activation_min, output_activation_max));
+    }
+  }
+}
+
 void NeonSparseMatrixBatchVectorMultiplyAccumulate(
     const float* __restrict__ matrix, const uint8_t* __restrict__ ledger,
     int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
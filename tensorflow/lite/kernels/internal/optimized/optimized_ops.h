@@ -7316,6 +7316,92 @@ inline void Transpose3D(const TransposeParams& params,
   }
 }
 
+// Cache-blocked transpose for permutations that have no specialized kernel.
+// The output is written in order; the output dimension that walks the input's
+// innermost (contiguous) dimension is blocked together with the output's
+// innermost dimension so that both the reads and the writes of each tile stay
+// within a few cache lines.
+template <typename T>
+void TransposeTiled(const TransposeParams& params,
+                    const RuntimeShape& input_shape, const T* input_data,
+                    const RuntimeShape& output_shape, T* output_data) {
+  constexpr int kTileSize = 16;
+  constexpr int N = kTransposeMaxDimensions;
+  const int dims_cnt = input_shape.DimensionsCount();
+  TFLITE_DCHECK_LE(dims_cnt, N);
+
+  int input_strides[N];
+  input_strides[dims_cnt - 1] = 1;
+  for (int i = dims_cnt - 2; i >= 0; --i) {
+    input_strides[i] = input_strides[i + 1] * input_shape.Dims(i + 1);
+  }
+  int output_strides[N];
+  output_strides[dims_cnt - 1] = 1;
+  for (int i = dims_cnt - 2; i >= 0; --i) {
+    output_strides[i] = output_strides[i + 1] * output_shape.Dims(i + 1);
+  }
+
+  // `inner` is the output's innermost dimension, `row` is the output
+  // dimension that reads along the input's innermost dimension.
+  const int inner = dims_cnt - 1;
+  int row = 0;
+  for (int i = 0; i < dims_cnt; ++i) {
+    if (params.perm[i] == dims_cnt - 1) row = i;
+  }
+  const int inner_size = output_shape.Dims(inner);
+  const int inner_input_stride = input_strides[params.perm[inner]];
+  const int row_size = output_shape.Dims(row);
+  const int row_output_stride = output_strides[row];
+
+  // Iterate over all other output dimensions with an odometer.
+  int outer_sizes[N];
+  int outer_input_strides[N];
+  int outer_output_strides[N];
+  int outer_cnt = 0;
+  for (int i = 0; i < dims_cnt; ++i) {
+    if (i == inner || i == row) continue;
+    outer_sizes[outer_cnt] = output_shape.Dims(i);
+    outer_input_strides[outer_cnt] = input_strides[params.perm[i]];
+    outer_output_strides[outer_cnt] = output_strides[i];
+    ++outer_cnt;
+  }
+  int index[N] = {};
+  int input_offset = 0;
+  int output_offset = 0;
+  while (true) {
+    const T* in = input_data + input_offset;
+    T* out = output_data + output_offset;
+    if (row == inner) {
+      memcpy(out, in, inner_size * sizeof(T));
+    } else {
+      for (int r0 = 0; r0 < row_size; r0 += kTileSize) {
+        const int r1 = std::min(r0 + kTileSize, row_size);
+        for (int c0 = 0; c0 < inner_size; c0 += kTileSize) {
+          const int c1 = std::min(c0 + kTileSize, inner_size);
+          for (int r = r0; r < r1; ++r) {
+            const T* in_row = in + r;
+            T* out_row = out + r * row_output_stride;
+            for (int c = c0; c < c1; ++c) {
+              out_row[c] = in_row[c * inner_input_stride];
+            }
+          }
+        }
+      }
+    }
+
+    int d = outer_cnt - 1;
+    for (; d >= 0; --d) {
+      input_offset += outer_input_strides[d];
+      output_offset += outer_output_strides[d];
+      if (++index[d] < outer_sizes[d]) break;
+      input_offset -= outer_input_strides[d] * outer_sizes[d];
+      output_offset -= outer_output_strides[d] * outer_sizes[d];
+      index[d] = 0;
+    }
+    if (d < 0) break;
+  }
+}
+
 template <typename T>
 void TransposeImpl(const TransposeParams& params,
                    const RuntimeShape& input_shape, const T* input_data,
@@ -7345,10 +7431,8 @@ void TransposeImpl(const TransposeParams& params,
     return;
   }
 
-  // Reroute to the reference version if an optimized method for the given data
-  // is not available.
-  reference_ops::Transpose<T>(params, input_shape, input_data, output_shape,
-                              output_data);
+  TransposeTiled<T>(params, input_shape, input_data, output_shape,
+                    output_data);
 }
 
 template <typename T, int N = 6>
@@ -0,0 +1,275 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SDPA_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SDPA_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "ruy/profiler/instrumentation.h"  // from @ruy
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/internal/runtime_shape.h"
+
+namespace tflite {
+namespace optimized_ops {
+namespace sdpa_internal {
+
+// Number of queries and of keys processed together. The scores of a tile
+// are the only part of the attention matrix which is materialized.
+constexpr int kQueryTileSize = 32;
+constexpr int kKeyTileSize = 256;
+
+using RowMajorMatrix =
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+using ConstStridedMatrixMap =
+    Eigen::Map<const RowMajorMatrix, Eigen::Unaligned, Eigen::OuterStride<>>;
+using StridedMatrixMap =
+    Eigen::Map<RowMajorMatrix, Eigen::Unaligned, Eigen::OuterStride<>>;
+
+struct SdpaParams {
+  int batches;
+  int num_queries;
+  int num_keys;
+  int num_heads;
+  int num_kv_heads;
+  int head_dim;
+  int value_dim;
+  float scale;
+  const float* query_data;
+  const float* key_data;
+  const float* value_data;
+  // Element strides of the mask along <batch, head, query, key>, zero for
+  // the broadcast dimensions. The mask is ignored when mask_data is null.
+  const float* mask_data;
+  int mask_strides[4];
+  float* output_data;
+};
+
+inline int NumQueryTiles(const SdpaParams& params) {
+  return (params.num_queries + kQueryTileSize - 1) / kQueryTileSize;
+}
+
+// Returns true if all the mask values of the tile are -inf, in which case the
+// tile does not contribute to the output.
+inline bool IsMaskedOut(const SdpaParams& params, int batch, int head,
+                        int query_begin, int query_end, int key_begin,
+                        int key_end) {
+  if (params.mask_data == nullptr) return false;
+  const float* mask = params.mask_data + batch * params.mask_strides[0] +
+                      head * params.mask_strides[1];
+  for (int q = query_begin; q < query_end; ++q) {
+    const float* mask_row = mask + q * params.mask_strides[2];
+    for (int k = key_begin; k < key_end; ++k) {
+      if (mask_row[k * params.mask_strides[3]] !=
+          -std::numeric_limits<float>::infinity()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Computes the attention of the query tiles [start, end) of the units
+// <batch, head, query tile>, with an online softmax over the key tiles.
+inline void SdpaImpl(const SdpaParams& params, int start, int end) {
+  const int num_query_tiles = NumQueryTiles(params);
+  const int heads_per_kv_head = params.num_heads / params.num_kv_heads;
+  const int query_stride = params.num_heads * params.head_dim;
+  const int key_stride = params.num_kv_heads * params.head_dim;
+  const int value_stride = params.num_kv_heads * params.value_dim;
+  const int output_stride = params.num_heads * params.value_dim;
+
+  RowMajorMatrix scores(kQueryTileSize, kKeyTileSize);
+  RowMajorMatrix accumulator(kQueryTileSize, params.value_dim);
+  Eigen::VectorXf max_score(kQueryTileSize);
+  Eigen::VectorXf sum(kQueryTileSize);
+  for (int unit = start; unit < end; ++unit) {
+    const int query_tile = unit % num_query_tiles;
+    const int head = (unit / num_query_tiles) % params.num_heads;
+    const int batch = unit / num_query_tiles / params.num_heads;
+    const int kv_head = head / heads_per_kv_head;
+    const int query_begin = query_tile * kQueryTileSize;
+    const int num_rows =
+        std::min(kQueryTileSize, params.num_queries - query_begin);
+
+    const ConstStridedMatrixMap query(
+        params.query_data +
+            (batch * params.num_queries + query_begin) * query_stride +
+            head * params.head_dim,
+        num_rows, params.head_dim, Eigen::OuterStride<>(query_stride));
+    accumulator.topRows(num_rows).setZero();
+    max_score.head(num_rows).setConstant(
+        -std::numeric_limits<float>::infinity());
+    sum.head(num_rows).setZero();
+
+    for (int key_begin = 0; key_begin < params.num_keys;
+         key_begin += kKeyTileSize) {
+      const int num_cols =
+          std::min(kKeyTileSize, params.num_keys - key_begin);
+      if (IsMaskedOut(params, batch, head, query_begin,
+                      query_begin + num_rows, key_begin,
+                      key_begin + num_cols)) {
+        continue;
+      }
+      const ConstStridedMatrixMap key(
+          params.key_data +
+              (batch * params.num_keys + key_begin) * key_stride +
+              kv_head * params.head_dim,
+          num_cols, params.head_dim, Eigen::OuterStride<>(key_stride));
+      const ConstStridedMatrixMap value(
+          params.value_data +
+              (batch * params.num_keys + key_begin) * value_stride +
+              kv_head * params.value_dim,
+          num_cols, params.value_dim, Eigen::OuterStride<>(value_stride));
+
+      auto tile = scores.topLeftCorner(num_rows, num_cols);
+      tile.noalias() = params.scale * (query * key.transpose());
+      if (params.mask_data != nullptr) {
+        const float* mask =
+            params.mask_data + batch * params.mask_strides[0] +
+            head * params.mask_strides[1] +
+            query_begin * params.mask_strides[2] +
+            key_begin * params.mask_strides[3];
+        for (int r = 0; r < num_rows; ++r) {
+          for (int c = 0; c < num_cols; ++c) {
+            tile(r, c) += mask[r * params.mask_strides[2] +
+                               c * params.mask_strides[3]];
+          }
+        }
+      }
+      for (int r = 0; r < num_rows; ++r) {
+        const float new_max = std::max(max_score[r], tile.row(r).maxCoeff());
+        if (new_max == -std::numeric_limits<float>::infinity()) {
+          tile.row(r).setZero();
+          continue;
+        }
+        // Rescale what was accumulated with the previous maximum.
+        const float correction = std::exp(max_score[r] - new_max);
+        tile.row(r) = (tile.row(r).array() - new_max).exp().matrix();
+        sum[r] = sum[r] * correction + tile.row(r).sum();
+        accumulator.row(r) *= correction;
+        max_score[r] = new_max;
+      }
+      accumulator.topRows(num_rows).noalias() += tile * value;
+    }
+
+    StridedMatrixMap output(
+        params.output_data +
+            (batch * params.num_queries + query_begin) * output_stride +
+            head * params.value_dim,
+        num_rows, params.value_dim, Eigen::OuterStride<>(output_stride));
+    output = (sum.head(num_rows).cwiseInverse().asDiagonal() *
+              accumulator.topRows(num_rows));
+  }
+}
+
+struct SdpaWorkerTask : cpu_backend_threadpool::Task {
+  SdpaWorkerTask(const SdpaParams& params, int start, int end)
+      : params(params), start(start), end(end) {}
+  void Run() override { SdpaImpl(params, start, end); }
+
+ private:
+  const SdpaParams& params;
+  int start;
+  int end;
+};
+
+}  // namespace sdpa_internal
+
+// Computes the scaled dot product attention
+//   softmax(scale * query * key^T + mask) * value
+// of a query of shape <batch, num_queries, num_heads, head_dim> to a key of
+// shape <batch, num_keys, num_kv_heads, head_dim> and a value of shape
+// <batch, num_keys, num_kv_heads, value_dim>, where num_heads is a multiple
+// of num_kv_heads (grouped-query attention). The optional mask broadcasts to
+// <batch, num_heads, num_queries, num_keys>; causal attention is expressed by
+// a mask, and the key tiles which it masks out entirely with -inf are
+// skipped. The output has shape <batch, num_queries, num_heads, value_dim>.
+//
+// The queries and keys are processed in tiles with an online softmax, so
+// that only a tile of the scores is materialized at any time, and the query
+// tiles of all the heads are distributed over the threads.
+inline void ScaledDotProductAttention(
+    const RuntimeShape& query_shape, const float* query_data,
+    const RuntimeShape& key_shape, const float* key_data,
+    const RuntimeShape& value_shape, const float* value_data,
+    const RuntimeShape& mask_shape, const float* mask_data, float scale,
+    const RuntimeShape& output_shape, float* output_data,
+    CpuBackendContext* cpu_backend_context = nullptr) {
+  ruy::profiler::ScopeLabel label("ScaledDotProductAttention");
+  TFLITE_DCHECK_EQ(query_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(key_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(value_shape.DimensionsCount(), 4);
+  sdpa_internal::SdpaParams params;
+  params.batches = query_shape.Dims(0);
+  params.num_queries = query_shape.Dims(1);
+  params.num_heads = query_shape.Dims(2);
+  params.head_dim = query_shape.Dims(3);
+  params.num_keys = key_shape.Dims(1);
+  params.num_kv_heads = key_shape.Dims(2);
+  params.value_dim = value_shape.Dims(3);
+  TFLITE_DCHECK_EQ(params.num_heads % params.num_kv_heads, 0);
+  TFLITE_DCHECK_EQ(output_shape.FlatSize(), params.batches *
+                                                params.num_queries *
+                                                params.num_heads *
+                                                params.value_dim);
+  params.scale = scale;
+  params.query_data = query_data;
+  params.key_data = key_data;
+  params.value_data = value_data;
+  params.mask_data = mask_data;
+  if (mask_data != nullptr) {
+    TFLITE_DCHECK_EQ(mask_shape.DimensionsCount(), 4);
+    int stride = 1;
+    for (int i = 3; i >= 0; --i) {
+      params.mask_strides[i] = mask_shape.Dims(i) == 1 ? 0 : stride;
+      stride *= mask_shape.Dims(i);
+    }
+  }
+  params.output_data = output_data;
+
+  const int num_units = params.batches * params.num_heads *
+                        sdpa_internal::NumQueryTiles(params);
+  const int thread_count =
+      cpu_backend_context == nullptr
+          ? 1
+          : std::min(num_units, cpu_backend_context->max_num_threads());
+  if (thread_count <= 1) {
+    sdpa_internal::SdpaImpl(params, 0, num_units);
+    return;
+  }
+  std::vector<sdpa_internal::SdpaWorkerTask> tasks;
+  tasks.reserve(thread_count);
+  int start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    // Distribute the units as evenly as possible.
+    const int end = start + (num_units - start) / (thread_count - i);
+    tasks.emplace_back(params, start, end);
+    start = end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SDPA_H_
@@ -153,6 +153,88 @@ inline void FullyConnectedSparseWeight1x4Impl(
   }
 }
 
+// `weights_data` and `weights_indices` hold the filter in the 2:4 structured
+// sparse format of tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate2of4.
+inline void FullyConnectedSparseWeight2of4Impl(
+    const FullyConnectedParams& params, const RuntimeShape& input_shape,
+    const float* input_data, const RuntimeShape& weights_shape,
+    const float* weights_data, const uint8_t* weights_indices,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data, int thread_start,
+    int thread_end) {
+  ruy::profiler::ScopeLabel label("FullyConnected");
+  ruy::profiler::ScopeLabel inner_label("2:4 Structured Sparse");
+  const float output_activation_min = params.float_activation_min;
+  const float output_activation_max = params.float_activation_max;
+
+  const int input_dims_count = input_shape.DimensionsCount();
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int weights_dims_count = weights_shape.DimensionsCount();
+  const int batches = thread_end - thread_start;
+  const int input_depth = MatchingDim(weights_shape, weights_dims_count - 1,
+                                      input_shape, input_dims_count - 1);
+  const int output_depth = MatchingDim(weights_shape, weights_dims_count - 2,
+                                       output_shape, output_dims_count - 1);
+
+  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate2of4(
+      weights_data, weights_indices, output_depth, input_depth,
+      input_data + thread_start * input_depth, batches,
+      output_data + thread_start * output_depth);
+
+  ruy::profiler::ScopeLabel activation_label("activation function");
+  for (int b = thread_start; b < thread_end; ++b) {
+    for (int i = 0; i < output_depth; ++i) {
+      float total = output_data[b * output_depth + i];
+      const float bias_value = bias_data ? bias_data[i] : 0;
+      output_data[b * output_depth + i] = ActivationFunctionWithMinMax(
+          total + bias_value, output_activation_min, output_activation_max);
+    }
+  }
+}
+
+struct FullyConnectedSparseWeight2of4Task : cpu_backend_threadpool::Task {
+  FullyConnectedSparseWeight2of4Task(
+      const FullyConnectedParams& params, const RuntimeShape& input_shape,
+      const float* input_data, const RuntimeShape& weights_shape,
+      const float* weights_data, const uint8_t* weights_indices,
+      const RuntimeShape& bias_shape, const float* bias_data,
+      const RuntimeShape& output_shape, float* output_data, int thread_start,
+      int thread_end)
+      : params(params),
+        input_shape(input_shape),
+        input_data(input_data),
+        weights_shape(weights_shape),
+        weights_data(weights_data),
+        weights_indices(weights_indices),
+        bias_shape(bias_shape),
+        bias_data(bias_data),
+        output_shape(output_shape),
+        output_data(output_data),
+        thread_start(thread_start),
+        thread_end(thread_end) {}
+
+  void Run() override {
+    FullyConnectedSparseWeight2of4Impl(
+        params, input_shape, input_data, weights_shape, weights_data,
+        weights_indices, bias_shape, bias_data, output_shape, output_data,
+        thread_start, thread_end);
+  }
+
+ private:
+  const FullyConnectedParams& params;
+  const RuntimeShape& input_shape;
+  const float* input_data;
+  const RuntimeShape& weights_shape;
+  const float* weights_data;
+  const uint8_t* weights_indices;
+  const RuntimeShape& bias_shape;
+  const float* bias_data;
+  const RuntimeShape& output_shape;
+  float* output_data;
+  int thread_start;
+  int thread_end;
+};
+
 struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
   FullyConnectedSparseWeight1x4Task(
       const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
@@ -219,6 +301,36 @@ inline void FullyConnectedSparseWeight1x16(
       output_data, 0, batches, *cpu_backend_context);
 }
 
+// Same as FullyConnectedSparseWeight1x16, but for a filter in the 2:4
+// structured sparse format of
+// tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate2of4.
+inline void FullyConnectedSparseWeight2of4(
+    const FullyConnectedParams& params, const RuntimeShape& input_shape,
+    const int8_t* input_data, const RuntimeShape& weights_shape,
+    const int8_t* weights_data, const uint8_t* weights_indices,
+    const int32_t* per_channel_scale, const int32_t* per_channel_shift,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data) {
+  ruy::profiler::ScopeLabel label("FullyConnected");
+  ruy::profiler::ScopeLabel inner_label("2:4 Structured Sparse");
+
+  const int input_dims_count = input_shape.DimensionsCount();
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int weights_dims_count = weights_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  const int input_depth = MatchingDim(weights_shape, weights_dims_count - 1,
+                                      input_shape, input_dims_count - 1);
+  const int output_depth = MatchingDim(weights_shape, weights_dims_count - 2,
+                                       output_shape, output_dims_count - 1);
+
+  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate2of4(
+      weights_data, weights_indices, output_depth, input_depth, input_data,
+      bias_data, batches, params.input_offset, params.output_multiplier,
+      params.output_shift, per_channel_scale, per_channel_shift,
+      params.output_offset, params.quantized_activation_min,
+      params.quantized_activation_max, output_data);
+}
+
 // The multi-threaded kernel slices the workload along the batch dimension. If
 // there's not enough batches of data, the number of threads used is equal to
 // the batch size. We can improve this later with slicing along the row
@@ -263,6 +375,45 @@ inline void FullyConnectedSparseWeight1x4(
                                   cpu_backend_context);
 }
 
+// Same as FullyConnectedSparseWeight1x4, but for a filter in the 2:4
+// structured sparse format of
+// tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate2of4.
+inline void FullyConnectedSparseWeight2of4(
+    const FullyConnectedParams& params, const RuntimeShape& input_shape,
+    const float* input_data, const RuntimeShape& weights_shape,
+    const float* weights_data, const uint8_t* weights_indices,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  const int output_elements = output_shape.FlatSize();
+  memset(output_data, 0, output_elements * sizeof(float));
+
+  const int max_threads = cpu_backend_context->max_num_threads();
+  const int batches =
+      FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
+  const int thread_count = std::max(1, std::min(batches, max_threads));
+  if (thread_count == 1) {
+    return FullyConnectedSparseWeight2of4Impl(
+        params, input_shape, input_data, weights_shape, weights_data,
+        weights_indices, bias_shape, bias_data, output_shape, output_data, 0,
+        batches);
+  }
+  std::vector<FullyConnectedSparseWeight2of4Task> tasks;
+  tasks.reserve(thread_count);
+  int thread_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int thread_end = thread_start + batches / thread_count;
+    if (i < batches % thread_count) thread_end++;
+
+    tasks.emplace_back(params, input_shape, input_data, weights_shape,
+                       weights_data, weights_indices, bias_shape, bias_data,
+                       output_shape, output_data, thread_start, thread_end);
+    thread_start = thread_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
 }  // namespace optimized_ops
 }  // namespace tflite
 #endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
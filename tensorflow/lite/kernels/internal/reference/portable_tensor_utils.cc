@@ -227,6 +227,30 @@ void PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
   }
 }
 
+void PortableSparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const float* __restrict__ matrix, const uint8_t* __restrict__ indices,
+    int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
+    float* __restrict__ result) {
+  const int kGroupSize = 4;
+  TFLITE_DCHECK_EQ(m_cols % kGroupSize, 0);
+  const int num_groups = m_cols / kGroupSize;
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const uint8_t* indices_ptr = indices;
+    for (int row = 0; row < m_rows; row++) {
+      float dot_prod = 0.0f;
+      const float* vector_group_ptr = vector + batch * m_cols;
+      for (int g = 0; g < num_groups; g++) {
+        const int group_indices = *indices_ptr++;
+        dot_prod += *matrix_ptr++ * vector_group_ptr[group_indices & 3];
+        dot_prod += *matrix_ptr++ * vector_group_ptr[(group_indices >> 2) & 3];
+        vector_group_ptr += kGroupSize;
+      }
+      result[batch * m_rows + row] += dot_prod;
+    }
+  }
+}
+
 void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
@@ -265,6 +289,47 @@ void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
   }
 }
 
+void PortableSparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ indices,
+    int m_rows, int m_cols, const int8_t* __restrict__ vector,
+    const int32_t* __restrict__ bias_vector, int n_batch,
+    const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  const int kGroupSize = 4;
+  TFLITE_DCHECK_EQ(m_cols % kGroupSize, 0);
+  const int num_groups = m_cols / kGroupSize;
+  for (int batch = 0; batch < n_batch; ++batch) {
+    const int8_t* matrix_ptr = matrix;
+    const uint8_t* indices_ptr = indices;
+    for (int row = 0; row < m_rows; ++row) {
+      int32_t dot_prod = 0;
+      const int8_t* vector_group_ptr = vector + batch * m_cols;
+      for (int g = 0; g < num_groups; ++g) {
+        const int group_indices = *indices_ptr++;
+        dot_prod += *matrix_ptr *
+                    (vector_group_ptr[group_indices & 3] + input_offset);
+        ++matrix_ptr;
+        dot_prod += *matrix_ptr *
+                    (vector_group_ptr[(group_indices >> 2) & 3] + input_offset);
+        ++matrix_ptr;
+        vector_group_ptr += kGroupSize;
+      }
+      const int32_t bias_value = bias_vector != nullptr ? bias_vector[row] : 0;
+      dot_prod = MultiplyByQuantizedMultiplier(
+          dot_prod + bias_value,
+          per_channel_scale ? per_channel_scale[row] : output_multiplier,
+          per_channel_shift ? per_channel_shift[row] : output_shift);
+      dot_prod += output_offset;
+      result[batch * m_rows + row] =
+          static_cast<int8_t>(ActivationFunctionWithMinMax(
+              dot_prod, output_activation_min, output_activation_max));
+    }
+  }
+}
+
 void PortableSparseMatrixBatchVectorMultiplyAccumulate(
     const float* __restrict__ matrix, const uint8_t* __restrict__ ledger,
     int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
@@ -0,0 +1,181 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/internal/optimized/sdpa.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/internal/runtime_shape.h"
+
+namespace tflite {
+namespace {
+
+std::vector<float> PseudoRandom(int size, float phase) {
+  std::vector<float> values(size);
+  for (int i = 0; i < size; ++i) values[i] = std::sin(i * 0.37f + phase);
+  return values;
+}
+
+// Materializes the scores of every head, for a mask of shape
+// <batch, num_heads, num_queries, num_keys> or broadcasting to it.
+std::vector<float> ReferenceAttention(
+    const RuntimeShape& query_shape, const std::vector<float>& query,
+    const RuntimeShape& key_shape, const std::vector<float>& key,
+    const RuntimeShape& value_shape, const std::vector<float>& value,
+    const RuntimeShape& mask_shape, const std::vector<float>& mask,
+    float scale) {
+  const int batches = query_shape.Dims(0), num_queries = query_shape.Dims(1),
+            num_heads = query_shape.Dims(2), head_dim = query_shape.Dims(3),
+            num_keys = key_shape.Dims(1), num_kv_heads = key_shape.Dims(2),
+            value_dim = value_shape.Dims(3);
+  auto mask_at = [&](int b, int h, int q, int k) {
+    if (mask.empty()) return 0.0f;
+    const int index[4] = {b, h, q, k};
+    int offset = 0;
+    for (int i = 0; i < 4; ++i) {
+      offset = offset * mask_shape.Dims(i) +
+               (mask_shape.Dims(i) == 1 ? 0 : index[i]);
+    }
+    return mask[offset];
+  };
+  std::vector<float> output(batches * num_queries * num_heads * value_dim);
+  for (int b = 0; b < batches; ++b) {
+    for (int h = 0; h < num_heads; ++h) {
+      const int kv_h = h / (num_heads / num_kv_heads);
+      for (int q = 0; q < num_queries; ++q) {
+        std::vector<float> scores(num_keys);
+        for (int k = 0; k < num_keys; ++k) {
+          float dot = 0.0f;
+          for (int d = 0; d < head_dim; ++d) {
+            dot += query[((b * num_queries + q) * num_heads + h) * head_dim +
+                         d] *
+                   key[((b * num_keys + k) * num_kv_heads + kv_h) * head_dim +
+                       d];
+          }
+          scores[k] = dot * scale + mask_at(b, h, q, k);
+        }
+        const float max_score =
+            *std::max_element(scores.begin(), scores.end());
+        float sum = 0.0f;
+        for (float& score : scores) {
+          score = std::exp(score - max_score);
+          sum += score;
+        }
+        for (int d = 0; d < value_dim; ++d) {
+          float out = 0.0f;
+          for (int k = 0; k < num_keys; ++k) {
+            out += scores[k] / sum *
+                   value[((b * num_keys + k) * num_kv_heads + kv_h) *
+                             value_dim +
+                         d];
+          }
+          output[((b * num_queries + q) * num_heads + h) * value_dim + d] =
+              out;
+        }
+      }
+    }
+  }
+  return output;
+}
+
+void TestSdpa(int batches, int num_queries, int num_keys, int num_heads,
+              int num_kv_heads, int head_dim, int value_dim,
+              const RuntimeShape& mask_shape, const std::vector<float>& mask,
+              CpuBackendContext* cpu_backend_context = nullptr) {
+  const RuntimeShape query_shape({batches, num_queries, num_heads, head_dim});
+  const RuntimeShape key_shape({batches, num_keys, num_kv_heads, head_dim});
+  const RuntimeShape value_shape({batches, num_keys, num_kv_heads, value_dim});
+  const RuntimeShape output_shape(
+      {batches, num_queries, num_heads, value_dim});
+  const std::vector<float> query = PseudoRandom(query_shape.FlatSize(), 0.0f);
+  const std::vector<float> key = PseudoRandom(key_shape.FlatSize(), 1.0f);
+  const std::vector<float> value = PseudoRandom(value_shape.FlatSize(), 2.0f);
+  const float scale = 1.0f / std::sqrt(static_cast<float>(head_dim));
+
+  std::vector<float> output(output_shape.FlatSize());
+  optimized_ops::ScaledDotProductAttention(
+      query_shape, query.data(), key_shape, key.data(), value_shape,
+      value.data(), mask_shape, mask.empty() ? nullptr : mask.data(), scale,
+      output_shape, output.data(), cpu_backend_context);
+  const std::vector<float> expected =
+      ReferenceAttention(query_shape, query, key_shape, key, value_shape,
+                         value, mask_shape, mask, scale);
+  for (size_t i = 0; i < output.size(); ++i) {
+    EXPECT_NEAR(output[i], expected[i], 1e-5f) << i;
+  }
+}
+
+std::vector<float> CausalMask(int num_queries, int num_keys) {
+  std::vector<float> mask(num_queries * num_keys);
+  for (int q = 0; q < num_queries; ++q) {
+    for (int k = 0; k < num_keys; ++k) {
+      // The queries are the last entries of the keys.
+      mask[q * num_keys + k] = k <= num_keys - num_queries + q
+                                   ? 0.0f
+                                   : -std::numeric_limits<float>::infinity();
+    }
+  }
+  return mask;
+}
+
+TEST(ScaledDotProductAttentionTest, MultiHeadWithoutMask) {
+  TestSdpa(/*batches=*/2, /*num_queries=*/3, /*num_keys=*/5, /*num_heads=*/2,
+           /*num_kv_heads=*/2, /*head_dim=*/4, /*value_dim=*/6, RuntimeShape(),
+           {});
+}
+
+TEST(ScaledDotProductAttentionTest, GroupedQueryMultipleTiles) {
+  // Neither the queries nor the keys are a multiple of the tile sizes.
+  TestSdpa(/*batches=*/1, /*num_queries=*/45, /*num_keys=*/300,
+           /*num_heads=*/4, /*num_kv_heads=*/2, /*head_dim=*/8,
+           /*value_dim=*/8, RuntimeShape(), {});
+}
+
+TEST(ScaledDotProductAttentionTest, MultiQueryDecode) {
+  TestSdpa(/*batches=*/1, /*num_queries=*/1, /*num_keys=*/600,
+           /*num_heads=*/8, /*num_kv_heads=*/1, /*head_dim=*/16,
+           /*value_dim=*/16, RuntimeShape(), {});
+}
+
+TEST(ScaledDotProductAttentionTest, CausalMaskSkipsTiles) {
+  TestSdpa(/*batches=*/1, /*num_queries=*/70, /*num_keys=*/600,
+           /*num_heads=*/2, /*num_kv_heads=*/1, /*head_dim=*/8,
+           /*value_dim=*/4, RuntimeShape({1, 1, 70, 600}),
+           CausalMask(70, 600));
+}
+
+TEST(ScaledDotProductAttentionTest, PaddingMaskBroadcastsOverQueries) {
+  std::vector<float> mask = PseudoRandom(2 * 40, 3.0f);
+  TestSdpa(/*batches=*/2, /*num_queries=*/5, /*num_keys=*/40,
+           /*num_heads=*/2, /*num_kv_heads=*/2, /*head_dim=*/4,
+           /*value_dim=*/4, RuntimeShape({2, 1, 1, 40}), mask);
+}
+
+TEST(ScaledDotProductAttentionTest, MultiThreaded) {
+  CpuBackendContext context;
+  context.SetMaxNumThreads(4);
+  TestSdpa(/*batches=*/2, /*num_queries=*/40, /*num_keys=*/300,
+           /*num_heads=*/4, /*num_kv_heads=*/4, /*head_dim=*/8,
+           /*value_dim=*/8, RuntimeShape({1, 1, 40, 300}),
+           CausalMask(40, 300), &context);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -1934,6 +1934,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
           /*recurrent_to_output_is_diag=*/false,
+          /*input_projection_scratch=*/nullptr,
           CpuBackendContext::GetFromContext(context));
     }
     case kTfLiteUInt8:
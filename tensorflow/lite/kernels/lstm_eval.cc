@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/kernel_utils.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
@@ -46,6 +47,14 @@ void MatrixBatchVectorMultiplyAccumulate(
     const float* matrix, const float* vector, const float* result,
     float* output, int m_rows, int m_cols, int n_batch,
     CpuBackendContext* cpu_backend_context) {
+  if (cpu_backend_context == nullptr) {
+    // Batch rows evaluated on a worker thread can't share the context, use
+    // the single threaded kernel.
+    std::copy_n(result, m_rows * n_batch, output);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(matrix, m_rows, m_cols,
+                                                      vector, n_batch, output);
+    return;
+  }
   tflite::FullyConnectedParams float_fc_params;
   float_fc_params.float_activation_min = std::numeric_limits<float>::lowest();
   float_fc_params.float_activation_max = std::numeric_limits<float>::max();
@@ -69,6 +78,28 @@ void MatrixBatchVectorMultiplyAccumulate(
   }
 }
 
+// Multiplies the input vectors of 'n_rows' consecutive time steps or batches
+// with the input weights of a gate in a single GEMM, instead of one small
+// GEMM per time step, and adds the gate bias (if not nullptr). The result
+// is stored in 'output' of size 'n_rows * n_cell'.
+void CalculateLstmInputProjectionFloat(const float* input_to_gate_weights,
+                                       const float* gate_bias,
+                                       const float* input, int n_rows,
+                                       int n_input, int n_cell, float* output,
+                                       CpuBackendContext* cpu_backend_context) {
+  tflite::FullyConnectedParams float_fc_params;
+  float_fc_params.float_activation_min = std::numeric_limits<float>::lowest();
+  float_fc_params.float_activation_max = std::numeric_limits<float>::max();
+  float_fc_params.lhs_cacheable = true;
+  float_fc_params.rhs_cacheable = false;
+
+  tflite::optimized_ops::FullyConnected(
+      float_fc_params, tflite::RuntimeShape({n_rows, n_input}), input,
+      tflite::RuntimeShape({n_cell, n_input}), input_to_gate_weights,
+      tflite::RuntimeShape({n_cell}), gate_bias,
+      tflite::RuntimeShape({n_rows, n_cell}), output, cpu_backend_context);
+}
+
 void ComputeRowSums(
     int32_t* input_to_input_row_sums, int32_t* input_to_forget_row_sums,
     int32_t* input_to_cell_row_sums, int32_t* input_to_output_row_sums,
@@ -181,6 +212,8 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 //   cell_to_gate_weights      | n_cell               | y (peephole)
 //   gate_bias                 | n_cell               |
 //   layer_norm_coefficients   | n_cell               | y (layer norm)
+// Precomputed input projection:
+//   input_projection          | n_cell               | y (long sequences)
 // Output vector:
 //   gate                      | n_cell               |
 // Scalar parameters:
@@ -189,6 +222,11 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 //   activation                                 - activation to use.
 //   is_input_all_zeros, is_aux_input_all_zeros - if input vectors are all zero.
 //   use_layer_norm                             - if doing layer norm LSTM.
+//   input_projection_stride                    - distance between the batches
+//                                                of input_projection.
+//
+// If input_projection is not nullptr, it holds W_input * input (plus the bias
+// without layer norm) of every batch, and input and aux_input are ignored.
 inline void CalculateLstmGateFloat(
     const float* input, const float* input_to_gate_weights,
     const float* aux_input, const float* aux_input_to_gate_weights,
@@ -199,33 +237,43 @@ inline void CalculateLstmGateFloat(
     const int n_output, const int n_cell,
     const TfLiteFusedActivation activation, float* gate,
     const bool is_input_all_zeros, const bool is_aux_input_all_zeros,
-    float* output, bool recurrent_is_diag, CpuBackendContext* context) {
+    float* output, bool recurrent_is_diag, const float* input_projection,
+    int input_projection_stride, CpuBackendContext* context) {
   const bool use_peephole = (cell_to_gate_weights != nullptr);
   const bool use_layer_norm = (layer_norm_coefficients != nullptr);
 
-  // Initialize scratch buffers with bias for regular lstm or initialize with
-  // zero for layer norm lstm.
-  if (use_layer_norm) {
-    std::fill_n(gate, n_cell * n_batch, 0.0f);
-  } else {
-    tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_batch, gate);
-  }
-  // For each batch and cell: compute input_weight * input.
-  // Skip if input is all zeros.
   float* accumulation_buffer = gate;
-  if (!is_input_all_zeros) {
-    MatrixBatchVectorMultiplyAccumulate(input_to_gate_weights, input,
-                                        accumulation_buffer, output, n_cell,
-                                        n_input, n_batch, context);
-    std::swap(accumulation_buffer, output);
-  }
-  // For each batch and cell: compute aux_input_weight * aux_input.
-  // Skip if auxiliary input is not available or all zeros.
-  if (!is_aux_input_all_zeros) {
-    MatrixBatchVectorMultiplyAccumulate(aux_input_to_gate_weights, aux_input,
-                                        accumulation_buffer, output, n_cell,
-                                        n_aux_input, n_batch, context);
-    std::swap(accumulation_buffer, output);
+  if (input_projection != nullptr) {
+    // The input was already multiplied for many time steps at once, gather
+    // the rows of this step.
+    for (int b = 0; b < n_batch; ++b) {
+      std::copy_n(input_projection + b * input_projection_stride, n_cell,
+                  gate + b * n_cell);
+    }
+  } else {
+    // Initialize scratch buffers with bias for regular lstm or initialize
+    // with zero for layer norm lstm.
+    if (use_layer_norm) {
+      std::fill_n(gate, n_cell * n_batch, 0.0f);
+    } else {
+      tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_batch, gate);
+    }
+    // For each batch and cell: compute input_weight * input.
+    // Skip if input is all zeros.
+    if (!is_input_all_zeros) {
+      MatrixBatchVectorMultiplyAccumulate(input_to_gate_weights, input,
+                                          accumulation_buffer, output, n_cell,
+                                          n_input, n_batch, context);
+      std::swap(accumulation_buffer, output);
+    }
+    // For each batch and cell: compute aux_input_weight * aux_input.
+    // Skip if auxiliary input is not available or all zeros.
+    if (!is_aux_input_all_zeros) {
+      MatrixBatchVectorMultiplyAccumulate(aux_input_to_gate_weights, aux_input,
+                                          accumulation_buffer, output, n_cell,
+                                          n_aux_input, n_batch, context);
+      std::swap(accumulation_buffer, output);
+    }
   }
   // For each batch and cell: compute recurrent_weight * output_state.
   if (recurrent_is_diag) {
@@ -822,13 +870,23 @@ void CalculateLstmOutputInteger8x8_8(
 //  - n_aux_input: the auxiliary input size.
 //  - n_output: the output size.
 //  - output_batch_leading_dim: the leading dimension of the output buffer.
-//  - context: the CpuBackendContext for use with matrix multiplications.
+//  - input_projection_stride: the distance between the batches of the
+//    *_projection_ptr buffers.
+//  - context: the CpuBackendContext for use with matrix multiplications, or
+//    nullptr to use the single threaded kernels.
 //
 // Input of size 'n_batch * n_input':
 //   input_ptr
 // Input of size 'n_batch * n_aux_input':
 //   aux_input_ptr                     - optional (can be nullptr)
 //
+// Precomputed input projections of 'n_batch' rows of size 'n_cell', which
+// replace input_ptr and aux_input_ptr when given:
+//   input_gate_projection_ptr         - optional
+//   forget_gate_projection_ptr        - optional
+//   cell_gate_projection_ptr          - optional
+//   output_gate_projection_ptr        - optional
+//
 // LSTM weights:
 // Input weights of size 'n_cell * n_input':
 //   input_to_input_weights            - optional
@@ -905,7 +963,11 @@ inline void LstmStepFloat(
     float* scratch1, float* scratch2, float* scratch3, float* scratch4,
     float* output_ptr, bool recurrent_to_input_is_diag,
     bool recurrent_to_forget_is_diag, bool recurrent_to_cell_is_diag,
-    bool recurrent_to_output_is_diag, CpuBackendContext* context) {
+    bool recurrent_to_output_is_diag, const float* input_gate_projection_ptr,
+    const float* forget_gate_projection_ptr,
+    const float* cell_gate_projection_ptr,
+    const float* output_gate_projection_ptr, int input_projection_stride,
+    CpuBackendContext* context) {
   ruy::profiler::ScopeLabel label("LstmStepFloat");
   // Since we have already checked that weights are all there or none, we can
   // check the existence of only one to the get the condition.
@@ -937,7 +999,8 @@ inline void LstmStepFloat(
         n_input, n_aux_input, n_output, n_cell,
         /*activation=*/kTfLiteActSigmoid, input_gate_scratch,
         is_input_all_zeros, is_aux_input_all_zeros, accumulation_scratch_buffer,
-        recurrent_to_input_is_diag, context);
+        recurrent_to_input_is_diag, input_gate_projection_ptr,
+        input_projection_stride, context);
   }
   // Calculate the forget gate.
   CalculateLstmGateFloat(
@@ -950,7 +1013,8 @@ inline void LstmStepFloat(
       n_input, n_aux_input, n_output, n_cell,
       /*activation=*/kTfLiteActSigmoid, forget_gate_scratch, is_input_all_zeros,
       is_aux_input_all_zeros, accumulation_scratch_buffer,
-      recurrent_to_forget_is_diag, context);
+      recurrent_to_forget_is_diag, forget_gate_projection_ptr,
+      input_projection_stride, context);
   // Calculate the cell update gate.
   CalculateLstmGateFloat(
       input_ptr, input_to_cell_weights_ptr, aux_input_ptr,
@@ -962,7 +1026,8 @@ inline void LstmStepFloat(
       cell_gate_bias_ptr, n_batch, n_input, n_aux_input, n_output, n_cell,
       params->activation, cell_gate_scratch, is_input_all_zeros,
       is_aux_input_all_zeros, accumulation_scratch_buffer,
-      recurrent_to_cell_is_diag, context);
+      recurrent_to_cell_is_diag, cell_gate_projection_ptr,
+      input_projection_stride, context);
   // Update the cell state.
   UpdateLstmCellFloat(n_batch, n_cell, cell_state_ptr, input_gate_scratch,
                       forget_gate_scratch, cell_gate_scratch, use_cifg,
@@ -978,7 +1043,8 @@ inline void LstmStepFloat(
       n_input, n_aux_input, n_output, n_cell,
       /*activation=*/kTfLiteActSigmoid, output_gate_scratch, is_input_all_zeros,
       is_aux_input_all_zeros, accumulation_scratch_buffer,
-      recurrent_to_output_is_diag, context);
+      recurrent_to_output_is_diag, output_gate_projection_ptr,
+      input_projection_stride, context);
   // Update the output state.
   CalculateLstmOutputFloat(n_batch, n_cell, n_output, cell_state_ptr,
                            output_gate_scratch, params->activation,
@@ -1787,6 +1853,19 @@ inline void LstmStepInteger8x8_8(
   std::copy_n(output_state_ptr, n_batch * n_output, output_ptr);
 }
 
+// Evaluates a block of batch rows of EvalFloat on a worker thread.
+template <typename BatchFn>
+struct LstmBatchTask : cpu_backend_threadpool::Task {
+  LstmBatchTask(const BatchFn& batch_fn, int batch_start, int batch_end)
+      : batch_fn(batch_fn), batch_start(batch_start), batch_end(batch_end) {}
+
+  void Run() override { batch_fn(batch_start, batch_end); }
+
+  const BatchFn& batch_fn;
+  int batch_start;
+  int batch_end;
+};
+
 }  // namespace
 
 // LINT.IfChange
@@ -1819,7 +1898,7 @@ TfLiteStatus EvalFloat(
     TfLiteTensor* cell_state, TfLiteTensor* output,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
-    CpuBackendContext* context) {
+    TfLiteTensor* input_projection_scratch, CpuBackendContext* context) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
 
   int max_time, n_batch;
@@ -1866,118 +1945,262 @@ TfLiteStatus EvalFloat(
 
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
-  if (time_major) {
-    // Loop through the sequence.
-    const int input_step = n_batch * n_input;
-    const int output_step = n_batch * output_batch_leading_dim;
-    for (int t = 0; t < max_time; t++) {
-      // If this is the forward_sequence, step forward, otherwise step
-      // backwards.
-      const int t_rel = forward_sequence ? t : max_time - t - 1;
-      const float* input_ptr = GetTensorData<float>(input) + t_rel * input_step;
-      const float* aux_input_ptr = nullptr;
-      if (aux_input) {
-        aux_input_ptr = GetTensorData<float>(aux_input) + t_rel * input_step;
-      }
-      float* output_ptr =
-          GetTensorData<float>(output) + t_rel * output_step + output_offset;
 
-      LstmStepFloat(
-          input_ptr, GetTensorData<float>(input_to_input_weights),
+  // The input to gate projection doesn't depend on the recurrent state, so
+  // it is computed for a chunk of time steps with one GEMM per gate instead of
+  // one small GEMM per time step.
+  const bool use_input_projection = input_projection_scratch != nullptr &&
+                                    aux_input == nullptr && max_time > 1;
+  const int chunk_steps =
+      use_input_projection ? std::min(max_time, kFloatInputProjectionMaxSteps)
+                           : max_time;
+  float* input_gate_projection = nullptr;
+  float* forget_gate_projection = nullptr;
+  float* cell_gate_projection = nullptr;
+  float* output_gate_projection = nullptr;
+  if (use_input_projection) {
+    TF_LITE_ASSERT(input_projection_scratch->bytes >=
+                   GetFloatInputProjectionScratchSize(max_time, n_batch, n_cell,
+                                                      use_cifg) *
+                       sizeof(float));
+    float* input_projection_ptr =
+        GetTensorData<float>(input_projection_scratch);
+    const int gate_projection_size = chunk_steps * n_batch * n_cell;
+    if (!use_cifg) {
+      input_gate_projection = input_projection_ptr;
+      input_projection_ptr += gate_projection_size;
+    }
+    forget_gate_projection = input_projection_ptr;
+    cell_gate_projection = input_projection_ptr + gate_projection_size;
+    output_gate_projection = input_projection_ptr + 2 * gate_projection_size;
+  }
+
+  // Batch rows are independent, so blocks of them are evaluated in parallel.
+  // Every block uses its own rows of the scratch buffers, which requires the
+  // projection bias (n_output per row) to fit into the accumulation buffer
+  // (n_cell per row).
+  const int thread_count =
+      n_output <= n_cell
+          ? std::max(1, std::min(n_batch, context->max_num_threads()))
+          : 1;
+
+  const float* input_data = GetTensorData<float>(input);
+  const float* aux_input_data = GetTensorData<float>(aux_input);
+  float* output_data = GetTensorData<float>(output);
+  float* output_state_data = GetTensorData<float>(output_state);
+  float* cell_state_data = GetTensorData<float>(cell_state);
+
+  for (int chunk_start = 0; chunk_start < max_time;
+       chunk_start += chunk_steps) {
+    const int chunk_end = std::min(max_time, chunk_start + chunk_steps);
+    // The time steps of the chunk cover [chunk_rel_start, chunk_rel_start +
+    // chunk_end - chunk_start) of the input, in either direction.
+    const int chunk_rel_start =
+        forward_sequence ? chunk_start : max_time - chunk_end;
+
+    if (use_input_projection) {
+      ruy::profiler::ScopeLabel label("LstmInputProjectionFloat");
+      const float* input_to_gate_weights[4] = {
+          GetTensorData<float>(input_to_input_weights),
           GetTensorData<float>(input_to_forget_weights),
           GetTensorData<float>(input_to_cell_weights),
-          GetTensorData<float>(input_to_output_weights), aux_input_ptr,
-          GetTensorData<float>(aux_input_to_input_weights),
-          GetTensorData<float>(aux_input_to_forget_weights),
-          GetTensorData<float>(aux_input_to_cell_weights),
-          GetTensorData<float>(aux_input_to_output_weights),
-          GetTensorData<float>(recurrent_to_input_weights),
-          GetTensorData<float>(recurrent_to_forget_weights),
-          GetTensorData<float>(recurrent_to_cell_weights),
-          GetTensorData<float>(recurrent_to_output_weights),
-          GetTensorData<float>(cell_to_input_weights),
-          GetTensorData<float>(cell_to_forget_weights),
-          GetTensorData<float>(cell_to_output_weights),
-          GetTensorData<float>(input_layer_norm_coefficients),
-          GetTensorData<float>(forget_layer_norm_coefficients),
-          GetTensorData<float>(cell_layer_norm_coefficients),
-          GetTensorData<float>(output_layer_norm_coefficients),
-          GetTensorData<float>(input_gate_bias),
-          GetTensorData<float>(forget_gate_bias),
-          GetTensorData<float>(cell_gate_bias),
-          GetTensorData<float>(output_gate_bias),
-          GetTensorData<float>(projection_weights),
-          GetTensorData<float>(projection_bias), params, n_batch, n_cell,
-          n_input, aux_input_size, n_output, output_batch_leading_dim,
-          GetTensorData<float>(output_state), GetTensorData<float>(cell_state),
-          input_gate_scratch, forget_gate_scratch, cell_gate_scratch,
-          output_gate_scratch, accumulation_scratch_buffer, output_ptr,
-          recurrent_to_input_is_diag, recurrent_to_forget_is_diag,
-          recurrent_to_cell_is_diag, recurrent_to_output_is_diag, context);
-    }
-  } else {
-    for (int b = 0; b < n_batch; b++) {
-      const int input_step = n_input;
-      const int output_step = output_batch_leading_dim;
-      for (int t = 0; t < max_time; t++) {
-        // If this is the forward_sequence, step forward, otherwise step
-        // backwards.
-        const int t_rel = forward_sequence ? t : max_time - t - 1;
-        const int time_offset = b * max_time + t_rel;
-        const float* input_ptr =
-            GetTensorData<float>(input) + time_offset * input_step;
-        const float* aux_input_ptr = nullptr;
-        if (aux_input) {
-          aux_input_ptr =
-              GetTensorData<float>(aux_input) + time_offset * input_step;
+          GetTensorData<float>(input_to_output_weights)};
+      // With layer norm the bias is added after the normalization.
+      const bool use_layer_norm = input_layer_norm_coefficients != nullptr ||
+                                  forget_layer_norm_coefficients != nullptr;
+      const float* gate_biases[4] = {
+          use_layer_norm ? nullptr : GetTensorData<float>(input_gate_bias),
+          use_layer_norm ? nullptr : GetTensorData<float>(forget_gate_bias),
+          use_layer_norm ? nullptr : GetTensorData<float>(cell_gate_bias),
+          use_layer_norm ? nullptr : GetTensorData<float>(output_gate_bias)};
+      float* gate_projections[4] = {input_gate_projection,
+                                    forget_gate_projection,
+                                    cell_gate_projection,
+                                    output_gate_projection};
+      const int n_steps = chunk_end - chunk_start;
+      for (int gate = use_cifg ? 1 : 0; gate < 4; ++gate) {
+        if (time_major) {
+          CalculateLstmInputProjectionFloat(
+              input_to_gate_weights[gate], gate_biases[gate],
+              input_data + chunk_rel_start * n_batch * n_input,
+              n_steps * n_batch, n_input, n_cell, gate_projections[gate],
+              context);
+        } else {
+          for (int b = 0; b < n_batch; b++) {
+            CalculateLstmInputProjectionFloat(
+                input_to_gate_weights[gate], gate_biases[gate],
+                input_data + (b * max_time + chunk_rel_start) * n_input,
+                n_steps, n_input, n_cell,
+                gate_projections[gate] + b * chunk_steps * n_cell, context);
+          }
         }
-        float* output_ptr = GetTensorData<float>(output) +
-                            time_offset * output_step + output_offset;
+      }
+    }
 
-        // Offset the {output,cell}_state pointers to the right batch.
-        float* output_state_ptr =
-            GetTensorData<float>(output_state) + b * output_batch_leading_dim;
-        float* cell_state_ptr = GetTensorData<float>(cell_state) + b * n_cell;
-        // Offset the scratch pointers to the right batch.
-        float* input_gate_scratch_ptr =
-            input_gate_scratch ? input_gate_scratch + b * n_cell : nullptr;
-        float* forget_gate_scratch_ptr = forget_gate_scratch + b * n_cell;
-        float* cell_gate_scratch_ptr = cell_gate_scratch + b * n_cell;
-        float* output_gate_scratch_ptr = output_gate_scratch + b * n_cell;
+    // Returns the precomputed projection of batch row 'b' at time 't_rel'.
+    auto gate_projection_ptr = [&](const float* gate_projection, int t_rel,
+                                   int b) -> const float* {
+      if (gate_projection == nullptr) return nullptr;
+      const int step = t_rel - chunk_rel_start;
+      const int row = time_major ? step * n_batch + b : b * chunk_steps + step;
+      return gate_projection + row * n_cell;
+    };
+
+    // Evaluates the time steps of the chunk for the batch rows
+    // [batch_start, batch_end).
+    CpuBackendContext* step_context = thread_count > 1 ? nullptr : context;
+    auto eval_batch_rows = [&](int batch_start, int batch_end) {
+      if (time_major) {
+        const int input_step = n_batch * n_input;
+        const int aux_input_step = n_batch * aux_input_size;
+        const int output_step = n_batch * output_batch_leading_dim;
+        for (int t = chunk_start; t < chunk_end; t++) {
+          // If this is the forward_sequence, step forward, otherwise step
+          // backwards.
+          const int t_rel = forward_sequence ? t : max_time - t - 1;
+          const float* input_ptr =
+              input_data + t_rel * input_step + batch_start * n_input;
+          const float* aux_input_ptr = nullptr;
+          if (aux_input) {
+            aux_input_ptr = aux_input_data + t_rel * aux_input_step +
+                            batch_start * aux_input_size;
+          }
+          float* output_ptr = output_data + t_rel * output_step +
+                              output_offset +
+                              batch_start * output_batch_leading_dim;
+
+          LstmStepFloat(
+              input_ptr, GetTensorData<float>(input_to_input_weights),
+              GetTensorData<float>(input_to_forget_weights),
+              GetTensorData<float>(input_to_cell_weights),
+              GetTensorData<float>(input_to_output_weights), aux_input_ptr,
+              GetTensorData<float>(aux_input_to_input_weights),
+              GetTensorData<float>(aux_input_to_forget_weights),
+              GetTensorData<float>(aux_input_to_cell_weights),
+              GetTensorData<float>(aux_input_to_output_weights),
+              GetTensorData<float>(recurrent_to_input_weights),
+              GetTensorData<float>(recurrent_to_forget_weights),
+              GetTensorData<float>(recurrent_to_cell_weights),
+              GetTensorData<float>(recurrent_to_output_weights),
+              GetTensorData<float>(cell_to_input_weights),
+              GetTensorData<float>(cell_to_forget_weights),
+              GetTensorData<float>(cell_to_output_weights),
+              GetTensorData<float>(input_layer_norm_coefficients),
+              GetTensorData<float>(forget_layer_norm_coefficients),
+              GetTensorData<float>(cell_layer_norm_coefficients),
+              GetTensorData<float>(output_layer_norm_coefficients),
+              GetTensorData<float>(input_gate_bias),
+              GetTensorData<float>(forget_gate_bias),
+              GetTensorData<float>(cell_gate_bias),
+              GetTensorData<float>(output_gate_bias),
+              GetTensorData<float>(projection_weights),
+              GetTensorData<float>(projection_bias), params,
+              batch_end - batch_start, n_cell, n_input, aux_input_size,
+              n_output, output_batch_leading_dim,
+              output_state_data + batch_start * n_output,
+              cell_state_data + batch_start * n_cell,
+              input_gate_scratch ? input_gate_scratch + batch_start * n_cell
+                                 : nullptr,
+              forget_gate_scratch + batch_start * n_cell,
+              cell_gate_scratch + batch_start * n_cell,
+              output_gate_scratch + batch_start * n_cell,
+              accumulation_scratch_buffer + batch_start * n_cell, output_ptr,
+              recurrent_to_input_is_diag, recurrent_to_forget_is_diag,
+              recurrent_to_cell_is_diag, recurrent_to_output_is_diag,
+              gate_projection_ptr(input_gate_projection, t_rel, batch_start),
+              gate_projection_ptr(forget_gate_projection, t_rel, batch_start),
+              gate_projection_ptr(cell_gate_projection, t_rel, batch_start),
+              gate_projection_ptr(output_gate_projection, t_rel, batch_start),
+              /*input_projection_stride=*/n_cell, step_context);
+        }
+      } else {
+        for (int b = batch_start; b < batch_end; b++) {
+          const int input_step = n_input;
+          const int output_step = output_batch_leading_dim;
+          for (int t = chunk_start; t < chunk_end; t++) {
+            // If this is the forward_sequence, step forward, otherwise step
+            // backwards.
+            const int t_rel = forward_sequence ? t : max_time - t - 1;
+            const int time_offset = b * max_time + t_rel;
+            const float* input_ptr = input_data + time_offset * input_step;
+            const float* aux_input_ptr = nullptr;
+            if (aux_input) {
+              aux_input_ptr = aux_input_data + time_offset * aux_input_size;
+            }
+            float* output_ptr =
+                output_data + time_offset * output_step + output_offset;
+
+            // Offset the {output,cell}_state pointers to the right batch.
+            float* output_state_ptr =
+                output_state_data + b * output_batch_leading_dim;
+            float* cell_state_ptr = cell_state_data + b * n_cell;
+            // Offset the scratch pointers to the right batch.
+            float* input_gate_scratch_ptr =
+                input_gate_scratch ? input_gate_scratch + b * n_cell : nullptr;
+            float* forget_gate_scratch_ptr = forget_gate_scratch + b * n_cell;
+            float* cell_gate_scratch_ptr = cell_gate_scratch + b * n_cell;
+            float* output_gate_scratch_ptr = output_gate_scratch + b * n_cell;
+            float* accumulation_scratch_ptr =
+                accumulation_scratch_buffer + b * n_cell;
+
+            LstmStepFloat(
+                input_ptr, GetTensorData<float>(input_to_input_weights),
+                GetTensorData<float>(input_to_forget_weights),
+                GetTensorData<float>(input_to_cell_weights),
+                GetTensorData<float>(input_to_output_weights), aux_input_ptr,
+                GetTensorData<float>(aux_input_to_input_weights),
+                GetTensorData<float>(aux_input_to_forget_weights),
+                GetTensorData<float>(aux_input_to_cell_weights),
+                GetTensorData<float>(aux_input_to_output_weights),
+                GetTensorData<float>(recurrent_to_input_weights),
+                GetTensorData<float>(recurrent_to_forget_weights),
+                GetTensorData<float>(recurrent_to_cell_weights),
+                GetTensorData<float>(recurrent_to_output_weights),
+                GetTensorData<float>(cell_to_input_weights),
+                GetTensorData<float>(cell_to_forget_weights),
+                GetTensorData<float>(cell_to_output_weights),
+                GetTensorData<float>(input_layer_norm_coefficients),
+                GetTensorData<float>(forget_layer_norm_coefficients),
+                GetTensorData<float>(cell_layer_norm_coefficients),
+                GetTensorData<float>(output_layer_norm_coefficients),
+                GetTensorData<float>(input_gate_bias),
+                GetTensorData<float>(forget_gate_bias),
+                GetTensorData<float>(cell_gate_bias),
+                GetTensorData<float>(output_gate_bias),
+                GetTensorData<float>(projection_weights),
+                GetTensorData<float>(projection_bias), params, /*n_batch=*/1,
+                n_cell, n_input, aux_input_size, n_output,
+                output_batch_leading_dim, output_state_ptr, cell_state_ptr,
+                input_gate_scratch_ptr, forget_gate_scratch_ptr,
+                cell_gate_scratch_ptr, output_gate_scratch_ptr,
+                accumulation_scratch_ptr, output_ptr,
+                recurrent_to_input_is_diag, recurrent_to_forget_is_diag,
+                recurrent_to_cell_is_diag, recurrent_to_output_is_diag,
+                gate_projection_ptr(input_gate_projection, t_rel, b),
+                gate_projection_ptr(forget_gate_projection, t_rel, b),
+                gate_projection_ptr(cell_gate_projection, t_rel, b),
+                gate_projection_ptr(output_gate_projection, t_rel, b),
+                /*input_projection_stride=*/n_cell, step_context);
+          }
+        }
+      }
+    };
 
-        LstmStepFloat(
-            input_ptr, GetTensorData<float>(input_to_input_weights),
-            GetTensorData<float>(input_to_forget_weights),
-            GetTensorData<float>(input_to_cell_weights),
-            GetTensorData<float>(input_to_output_weights), aux_input_ptr,
-            GetTensorData<float>(aux_input_to_input_weights),
-            GetTensorData<float>(aux_input_to_forget_weights),
-            GetTensorData<float>(aux_input_to_cell_weights),
-            GetTensorData<float>(aux_input_to_output_weights),
-            GetTensorData<float>(recurrent_to_input_weights),
-            GetTensorData<float>(recurrent_to_forget_weights),
-            GetTensorData<float>(recurrent_to_cell_weights),
-            GetTensorData<float>(recurrent_to_output_weights),
-            GetTensorData<float>(cell_to_input_weights),
-            GetTensorData<float>(cell_to_forget_weights),
-            GetTensorData<float>(cell_to_output_weights),
-            GetTensorData<float>(input_layer_norm_coefficients),
-            GetTensorData<float>(forget_layer_norm_coefficients),
-            GetTensorData<float>(cell_layer_norm_coefficients),
-            GetTensorData<float>(output_layer_norm_coefficients),
-            GetTensorData<float>(input_gate_bias),
-            GetTensorData<float>(forget_gate_bias),
-            GetTensorData<float>(cell_gate_bias),
-            GetTensorData<float>(output_gate_bias),
-            GetTensorData<float>(projection_weights),
-            GetTensorData<float>(projection_bias), params, /*n_batch=*/1,
-            n_cell, n_input, aux_input_size, n_output, output_batch_leading_dim,
-            output_state_ptr, cell_state_ptr, input_gate_scratch_ptr,
-            forget_gate_scratch_ptr, cell_gate_scratch_ptr,
-            output_gate_scratch_ptr, accumulation_scratch_buffer, output_ptr,
-            recurrent_to_input_is_diag, recurrent_to_forget_is_diag,
-            recurrent_to_cell_is_diag, recurrent_to_output_is_diag, context);
+    if (thread_count == 1) {
+      eval_batch_rows(0, n_batch);
+    } else {
+      std::vector<LstmBatchTask<decltype(eval_batch_rows)>> tasks;
+      tasks.reserve(thread_count);
+      int batch_start = 0;
+      for (int i = 0; i < thread_count; ++i) {
+        // The first mod(n_batch, thread_count) tasks process one more batch
+        // row than the rest.
+        int batch_end = batch_start + n_batch / thread_count;
+        if (i < n_batch % thread_count) batch_end++;
+        tasks.emplace_back(eval_batch_rows, batch_start, batch_end);
+        batch_start = batch_end;
       }
+      cpu_backend_threadpool::Execute(tasks.size(), tasks.data(), context);
     }
   }
   return kTfLiteOk;
@@ -95,6 +95,29 @@ struct IntegerLstmParameter {
   int32_t intermediate_zp[12];
 };
 
+// Maximum number of time steps whose input projection EvalFloat computes with
+// a single GEMM per gate. Longer sequences are processed in chunks of this
+// many steps.
+constexpr int kFloatInputProjectionMaxSteps = 64;
+
+// Returns the number of floats of the input_projection_scratch buffer of
+// EvalFloat for a sequence of 'max_time' steps.
+inline int GetFloatInputProjectionScratchSize(int max_time, int n_batch,
+                                              int n_cell, bool use_cifg) {
+  const int n_gates = use_cifg ? 3 : 4;
+  const int n_steps = max_time < kFloatInputProjectionMaxSteps
+                          ? max_time
+                          : kFloatInputProjectionMaxSteps;
+  return n_gates * n_steps * n_batch * n_cell;
+}
+
+// If input_projection_scratch is not nullptr (and there is no aux_input), the
+// input to gate projection of up to kFloatInputProjectionMaxSteps time steps
+// is computed at once before running the recurrent steps. Its size must be at
+// least GetFloatInputProjectionScratchSize().
+//
+// Independent batch rows are evaluated in parallel on the threads of the
+// CpuBackendContext.
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -124,7 +147,7 @@ TfLiteStatus EvalFloat(
     TfLiteTensor* cell_state, TfLiteTensor* output,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
-    CpuBackendContext* context);
+    TfLiteTensor* input_projection_scratch, CpuBackendContext* context);
 
 TfLiteStatus EvalHybrid(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
@@ -0,0 +1,33 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/shared_thread_pools.h"
+
+#include <atomic>
+
+namespace tflite {
+namespace shared_thread_pools {
+namespace {
+
+std::atomic<bool> enabled{false};
+
+}  // namespace
+
+void SetEnabled(bool enabled_value) { enabled = enabled_value; }
+
+bool IsEnabled() { return enabled; }
+
+}  // namespace shared_thread_pools
+}  // namespace tflite
@@ -0,0 +1,60 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_KERNELS_SHARED_THREAD_POOLS_H_
+#define TENSORFLOW_LITE_KERNELS_SHARED_THREAD_POOLS_H_
+
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+
+namespace tflite {
+namespace shared_thread_pools {
+
+// Makes the interpreters of the process share their thread pools: the
+// XNNPack thread pools of the CPU backend contexts and of the XNNPack
+// delegates, and the Eigen thread pools, are then created once per thread
+// count instead of once per interpreter or delegate. This avoids
+// oversubscribing the cores when several interpreters, or delegated and
+// undelegated parts of a model, run at the same time. The drawback is that
+// concurrent invocations wait for each other's parallel sections.
+//
+// Only affects the thread pools created after the call. Disabled by default.
+void SetEnabled(bool enabled);
+
+bool IsEnabled();
+
+// Returns the process-wide thread pool of type `Pool` with `num_threads`
+// threads. If there is none, it is created with `create(num_threads)`, which
+// returns a `std::shared_ptr<Pool>`. A pool is destroyed along with its last
+// reference.
+template <typename Pool, typename CreateFn>
+std::shared_ptr<Pool> GetOrCreate(int num_threads, CreateFn create) {
+  static auto* mutex = new std::mutex;
+  static auto* pools = new std::map<int, std::weak_ptr<Pool>>;
+  std::lock_guard<std::mutex> lock(*mutex);
+  std::weak_ptr<Pool>& weak_pool = (*pools)[num_threads];
+  std::shared_ptr<Pool> pool = weak_pool.lock();
+  if (!pool) {
+    pool = create(num_threads);
+    weak_pool = pool;
+  }
+  return pool;
+}
+
+}  // namespace shared_thread_pools
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_SHARED_THREAD_POOLS_H_
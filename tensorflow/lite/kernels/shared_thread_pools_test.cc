@@ -0,0 +1,65 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/shared_thread_pools.h"
+
+#include <memory>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace shared_thread_pools {
+namespace {
+
+struct FakePool {
+  explicit FakePool(int num_threads) : num_threads(num_threads) {}
+  int num_threads;
+};
+
+std::shared_ptr<FakePool> GetFakePool(int num_threads) {
+  return GetOrCreate<FakePool>(num_threads, [](int num_threads) {
+    return std::make_shared<FakePool>(num_threads);
+  });
+}
+
+TEST(SharedThreadPoolsTest, DisabledByDefault) { EXPECT_FALSE(IsEnabled()); }
+
+TEST(SharedThreadPoolsTest, SetEnabled) {
+  SetEnabled(true);
+  EXPECT_TRUE(IsEnabled());
+  SetEnabled(false);
+  EXPECT_FALSE(IsEnabled());
+}
+
+TEST(SharedThreadPoolsTest, SharesPoolsWithTheSameThreadCount) {
+  std::shared_ptr<FakePool> pool_2 = GetFakePool(2);
+  std::shared_ptr<FakePool> pool_4 = GetFakePool(4);
+  EXPECT_EQ(pool_2->num_threads, 2);
+  EXPECT_EQ(pool_4->num_threads, 4);
+  EXPECT_EQ(GetFakePool(2), pool_2);
+  EXPECT_EQ(GetFakePool(4), pool_4);
+}
+
+TEST(SharedThreadPoolsTest, DestroysPoolsWithTheirLastReference) {
+  std::weak_ptr<FakePool> weak_pool = GetFakePool(3);
+  EXPECT_TRUE(weak_pool.expired());
+  std::shared_ptr<FakePool> pool = GetFakePool(3);
+  ASSERT_NE(pool, nullptr);
+  EXPECT_EQ(pool->num_threads, 3);
+}
+
+}  // namespace
+}  // namespace shared_thread_pools
+}  // namespace tflite
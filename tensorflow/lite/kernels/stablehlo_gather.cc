@@ -175,6 +175,25 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
 
   int64_t num_batch_dims = result_rank - data->num_offset_dims;
 
+  // When the innermost result dimension is an offset dimension mapping to the
+  // innermost operand dimension, each slice is made of contiguous rows of the
+  // operand. Copy these rows at once instead of element by element.
+  const bool copy_rows =
+      result_rank > 0 && data->num_offset_dims > 0 &&
+      data->offset_dims[data->num_offset_dims - 1] == result_rank - 1 &&
+      !ArrayContains(data->collapsed_slice_dims,
+                     data->num_collapsed_slice_dims, operand_rank - 1);
+  std::vector<int> iteration_dims(output->dims->data,
+                                  output->dims->data + result_rank);
+  int64_t row_size = 1;
+  if (copy_rows) {
+    row_size = iteration_dims.back();
+    iteration_dims.back() = 1;
+  }
+
+  const DataType* operand_data = GetTensorData<DataType>(operand);
+  DataType* result_data = GetTensorData<DataType>(output);
+
   Index<IndexType> batch_index(num_batch_dims);
   Index<IndexType> offset_index(data->num_offset_dims);
   do {
@@ -204,18 +223,14 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
     Index<IndexType> operand_lookup_index =
         AddIndices(final_starting_index, full_offset_index);
 
-    const DataType* operand_data = GetTensorData<DataType>(operand);
     IndexType flat_operand_index =
         TensorIndexToFlat(operand_lookup_index.data(),
-                          operand_lookup_index.size(), GetTensorShape(operand));
-    DataType looked_up_value = operand_data[flat_operand_index];
-
-    DataType* result_data = GetTensorData<DataType>(output);
+                          operand_lookup_index.size(), operand_shape);
     IndexType flat_result_index = TensorIndexToFlat(
-        result_index.data(), result_index.size(), GetTensorShape(output));
-    result_data[flat_result_index] = looked_up_value;
-  } while (NextIndex(result_rank, result_runtime_shape.DimsData(),
-                     result_index.data()));
+        result_index.data(), result_index.size(), result_runtime_shape);
+    std::copy_n(operand_data + flat_operand_index, row_size,
+                result_data + flat_result_index);
+  } while (NextIndex(result_rank, iteration_dims.data(), result_index.data()));
 
   return TfLiteStatus::kTfLiteOk;
 }
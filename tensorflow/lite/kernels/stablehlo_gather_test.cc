@@ -107,6 +107,30 @@ TEST(StablehloScatterOpTest, GathersSlices) {
   EXPECT_THAT(model.GetOutput<float>(), ElementsAreArray(expected_values));
 }
 
+TEST(StablehloScatterOpTest, GathersCollapsedInnermostDimension) {
+  TfLiteStablehloGatherParams params = {
+      {3},     // offset_dims
+      1,       // num_offset_dims;
+      {1},     // collapsed_slice_dims
+      1,       // num_collapsed_slice_dims;
+      {1},     // start_index_map
+      1,       // num_start_index_map;
+      3,       // index_vector_dim;
+      {3, 1},  // slice_sizes
+      2,       // num_slice_sizes;
+      false    // indices_are_sorted;
+  };
+  StablehloGatherOpModel model({TensorType_FLOAT32, {3, 4}},
+                               {TensorType_INT64, {2, 1, 1, 1}}, params);
+
+  model.SetInput<float>({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+  model.SetIndices<int64_t>({2, 0});
+
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  std::vector<float> expected_values = {3, 7, 11, 1, 5, 9};
+  EXPECT_THAT(model.GetOutput<float>(), ElementsAreArray(expected_values));
+}
+
 TEST(StablehloScatterOpTest, ClipsStartingIndices) {
   TfLiteStablehloGatherParams params = {
       {2, 3},     // offset_dims
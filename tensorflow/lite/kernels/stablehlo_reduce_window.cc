@@ -396,6 +396,68 @@ void ReduceWindowImpl(const Type* input, Type* output,
   }
 }
 
+// Same as StridedReduce but reduces `row_size` contiguous elements at once into
+// `accu`.
+//
+// This is used for pooling-like windows, where the window doesn't span the
+// innermost dimension. The innermost loop then runs over contiguous memory and
+// can be vectorized.
+template <class Op, class Type>
+void StridedReduceRow(const Type* input, const int64_t* const shape,
+                      const int64_t* const strides, Type* accu,
+                      const int64_t row_size, const int rank,
+                      const int depth) {
+  const int64_t stride = strides[depth];
+  const int64_t size = shape[depth];
+  if (depth + 1 == rank) {
+    const Op op;
+    for (int64_t i = 0; i < size; ++i) {
+      for (int64_t j = 0; j < row_size; ++j) {
+        accu[j] = op(accu[j], input[j]);
+      }
+      input += stride;
+    }
+  } else {
+    for (int64_t i = 0; i < size; ++i) {
+      StridedReduceRow<Op, Type>(input, shape, strides, accu, row_size, rank,
+                                 depth + 1);
+      input += stride;
+    }
+  }
+}
+
+// Same as ReduceWindowImpl for windows that have a size, stride and dilation
+// of 1 in the innermost dimension. `rank` doesn't count the innermost
+// dimension, whose `row_size` elements are reduced together.
+template <class Op, class Type>
+void ReduceWindowRowsImpl(const Type* input, Type* output,
+                          const int64_t* const output_shape,
+                          const int64_t* const output_strides,
+                          const int64_t* const window_offset_strides,
+                          const int64_t* const window_shape,
+                          const int64_t* const window_reduce_strides,
+                          const Type init, const int64_t row_size,
+                          const int rank, const int depth) {
+  if (depth + 1 == rank) {
+    for (int32_t dim = 0; dim < output_shape[depth]; ++dim) {
+      std::fill_n(output, row_size, init);
+      StridedReduceRow<Op, Type>(input, window_shape, window_reduce_strides,
+                                 output, row_size, rank, /*depth=*/0);
+      input += window_offset_strides[depth];
+      output += output_strides[depth];
+    }
+  } else {
+    for (int32_t dim = 0; dim < output_shape[depth]; ++dim) {
+      ReduceWindowRowsImpl<Op, Type>(input, output, output_shape,
+                                     output_strides, window_offset_strides,
+                                     window_shape, window_reduce_strides, init,
+                                     row_size, rank, depth + 1);
+      input += window_offset_strides[depth];
+      output += output_strides[depth];
+    }
+  }
+}
+
 // Computes and holds the parameters that can be precomputed for the dilation
 // operation.
 struct ReduceWindowData {
@@ -460,6 +522,19 @@ struct ReduceWindowData {
 template <class Op, class Type>
 void ReduceWindow(const ReduceWindowData& ctx, const Type* const input,
                   const Type init, Type* output) {
+  const int last = ctx.rank - 1;
+  if (ctx.rank > 1 && ctx.window_shape[last] == 1 &&
+      ctx.window_strides[last] == 1 && ctx.window_dilations[last] == 1) {
+    // Pooling-like window (e.g. [1, h, w, 1] on NHWC data): the innermost
+    // dimension is kept as is, so reduce whole rows of it at once. The
+    // elements are reduced in the same order as in the generic path.
+    ReduceWindowRowsImpl<Op, Type>(
+        input, output, ctx.output_shape, ctx.output_strides,
+        ctx.window_offset_strides, ctx.window_shape, ctx.window_reduce_strides,
+        init, /*row_size=*/ctx.output_shape[last], /*rank=*/last,
+        /*depth=*/0);
+    return;
+  }
   ReduceWindowImpl<Op, Type>(input, output, ctx.output_shape,
                              ctx.output_strides, ctx.window_offset_strides,
                              ctx.window_shape, ctx.window_reduce_strides, init,
@@ -797,6 +797,64 @@ TYPED_TEST(StablehloReduceWindowTest, FuzzyTest) {
   }
 }
 
+TYPED_TEST(StablehloReduceWindowTest, FuzzyTestPoolingLikeWindows) {
+  absl::BitGen bitgen;
+
+  for (size_t iteration = 0; iteration < 200; ++iteration) {
+    const int rank = absl::Uniform(absl::IntervalClosed, bitgen, 2, 4);
+
+    ReduceWindowOpModel<TypeParam> model;
+    // To avoid reduction overflows, we only test mul with floating point types.
+    Body body = Body::GetRandomSupported(
+        bitgen, /*allow_mul=*/std::is_floating_point<TypeParam>::value);
+    model.SetInput(
+        /*shape=*/RandomVector<int64_t>(bitgen, rank, /*min=*/1, /*max=*/10),
+        bitgen, /*min=*/-5, /*max=*/5);
+    model.SetBaseDilations(
+        RandomVector<int64_t>(bitgen, rank, /*min=*/1, /*max=*/3));
+    model.SetPadding(
+        RandomVector<int64_t>(bitgen, 2 * rank, /*min=*/-5, /*max=*/5));
+    // The window doesn't span the innermost dimension, like for pooling on
+    // NHWC data.
+    std::vector<int64_t> window_dimensions =
+        RandomVector<int64_t>(bitgen, rank, /*min=*/1, /*max=*/3);
+    std::vector<int64_t> window_strides =
+        RandomVector<int64_t>(bitgen, rank, /*min=*/1, /*max=*/3);
+    std::vector<int64_t> window_dilations =
+        RandomVector<int64_t>(bitgen, rank, /*min=*/1, /*max=*/3);
+    window_dimensions.back() = 1;
+    window_strides.back() = 1;
+    window_dilations.back() = 1;
+    model.SetWindowDimensions(window_dimensions);
+    model.SetWindowStrides(window_strides);
+    model.SetWindowDilations(window_dilations);
+    model.SetInitValue(body.init_value<TypeParam>());
+    model.SetBody(body.func);
+
+    // Skip invalid specifications.
+    const std::vector<int64_t> padded_shape = reference::PadCropShape(
+        reference::DilateShape(model.GetInputShape(), model.GetBaseDilations()),
+        model.GetPadding());
+    if (absl::c_any_of(padded_shape, [](int64_t d) { return d <= 0; })) {
+      iteration = iteration > 1 ? iteration - 1 : 0;
+      continue;
+    }
+
+    const reference::Tensor<TypeParam> expected = reference::ReduceWindow(
+        reference::Tensor<TypeParam>{/*shape=*/model.GetInputShape(),
+                                     /*data=*/model.GetInput()},
+        model.GetBaseDilations(), model.GetPadding(), model.GetInitValue(),
+        model.GetWindowDimensions(), model.GetWindowDilations(),
+        model.GetWindowStrides(), body);
+
+    ASSERT_EQ(model.BuildAndInvoke(), kTfLiteOk);
+    EXPECT_THAT(model.GetOutputShape(), ElementsAreArray(expected.shape))
+        << model;
+    EXPECT_THAT(model.GetOutputData(), ElementsAreArray(expected.data))
+        << model;
+  }
+}
+
 }  // namespace
 }  // namespace reduce_window
 }  // namespace tflite
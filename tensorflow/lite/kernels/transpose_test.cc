@@ -15,6 +15,7 @@ limitations under the License.
 #include <stdint.h>
 
 #include <initializer_list>
+#include <numeric>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -39,6 +40,10 @@ class TransposeOpModel : public SingleOpModel {
     PopulateTensor<float>(input_, data);
   }
 
+  void SetInput(const std::vector<float>& data) {
+    PopulateTensor<float>(input_, data);
+  }
+
   void SetPerm(std::initializer_list<int> data) {
     PopulateTensor<int>(perm_, data);
   }
@@ -519,5 +524,20 @@ TEST(TransposeTest, Complex5DTestWithReorderDynamicTensor) {
   EXPECT_THAT(m.GetOutput(), result);
 }
 
+// Dimensions larger than the tile size and not a multiple of it, with the
+// input's innermost dimension moved away from the output's innermost one.
+TEST(TransposeTest, Tiled4DTestWithPartialTiles) {
+  const std::vector<int> shape = {3, 20, 5, 18};
+  const std::vector<int> perm = {3, 1, 0, 2};
+  std::vector<float> out = RunTestPermutation<float>(shape, perm);
+  std::vector<float> input(out.size());
+  std::iota(input.begin(), input.end(), 0.0f);
+  TransposeOpConstModel m({3, 20, 5, 18}, {4}, {3, 1, 0, 2});
+  m.SetInput(input);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({18, 20, 3, 5}));
+  EXPECT_EQ(m.GetOutput(), out);
+}
+
 }  // namespace
 }  // namespace tflite
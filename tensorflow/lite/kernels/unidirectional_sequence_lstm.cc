@@ -42,6 +42,8 @@ struct OpData {
   // The scratch tensor index.
   int scratch_tensor_index;
   bool compute_row_sums = false;
+  // If the float kernel precomputes the input projection of many time steps.
+  bool use_input_projection = false;
 
   bool recurrent_to_input_is_diag = false;
   bool recurrent_to_forget_is_diag = false;
@@ -407,6 +409,10 @@ enum TemporaryTensor {
   kNumTemporaryTensors = 12,
 };
 
+// The float kernel only needs the scratch buffer, its second temporary holds
+// the precomputed input projection.
+constexpr int kFloatInputProjection = 1;
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   auto* op_data = new OpData();
   context->AddTensors(context, kNumTemporaryTensors,
@@ -984,11 +990,19 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     TF_LITE_ENSURE(context, num_intermediate_tensors == 5);
   }
 
+  // Float sequences longer than one step compute the input projection of
+  // several time steps at once.
+  const int max_time = time_major ? input->dims->data[0] : input->dims->data[1];
+  op_data->use_input_projection =
+      input_to_output_weights->type == kTfLiteFloat32 && max_time > 1;
+
   TfLiteIntArrayFree(node->temporaries);
   if (IsHybridOp(input, input_to_output_weights)) {
     node->temporaries = TfLiteIntArrayCreate(kNumTemporaryTensors);
   } else if (is_integer) {
     node->temporaries = TfLiteIntArrayCreate(6);
+  } else if (op_data->use_input_projection) {
+    node->temporaries = TfLiteIntArrayCreate(2);
   } else {
     node->temporaries = TfLiteIntArrayCreate(1);
   }
@@ -1019,6 +1033,28 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                    scratch_buffer_size));
 
+  if (op_data->use_input_projection) {
+    node->temporaries->data[kFloatInputProjection] =
+        scratch_tensor_index + kFloatInputProjection;
+    TfLiteTensor* input_projection;
+    TF_LITE_ENSURE_OK(context,
+                      GetTemporarySafe(context, node, kFloatInputProjection,
+                                       &input_projection));
+    input_projection->type = kTfLiteFloat32;
+    input_projection->allocation_type = kTfLiteArenaRw;
+    const int input_projection_dims[1] = {
+        lstm_eval::GetFloatInputProjectionScratchSize(max_time, n_batch,
+                                                      n_cell, use_cifg)};
+    if (!TfLiteIntArrayEqualsArray(input_projection->dims, 1,
+                                   input_projection_dims)) {
+      TfLiteIntArray* input_projection_size = TfLiteIntArrayCreate(1);
+      input_projection_size->data[0] = input_projection_dims[0];
+      TF_LITE_ENSURE_OK(context,
+                        context->ResizeTensor(context, input_projection,
+                                              input_projection_size));
+    }
+  }
+
   if (IsHybridOp(input, input_to_output_weights)) {
     op_data->compute_row_sums = true;
     // Allocate temporary tensors to store quantized values of input,
@@ -1366,6 +1402,12 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       TfLiteTensor* scratch_buffer;
       TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, kScratchBuffer,
                                                   &scratch_buffer));
+      TfLiteTensor* input_projection = nullptr;
+      if (op_data->use_input_projection) {
+        TF_LITE_ENSURE_OK(context,
+                          GetTemporarySafe(context, node, kFloatInputProjection,
+                                           &input_projection));
+      }
       return lstm_eval::EvalFloat(
           input, input_to_input_weights, input_to_forget_weights,
           input_to_cell_weights, input_to_output_weights,
@@ -1392,7 +1434,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           (recurrent_to_cell_weights->dims->size == 1),
           /*recurrent_to_output_is_diag=*/
           (recurrent_to_output_weights->dims->size == 1),
-          CpuBackendContext::GetFromContext(context));
+          input_projection, CpuBackendContext::GetFromContext(context));
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
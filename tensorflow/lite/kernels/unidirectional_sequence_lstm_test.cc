@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 // Unit test for TFLite Sequential LSTM op.
 
+#include <cmath>
 #include <tuple>
 #include <vector>
 
@@ -296,6 +297,123 @@ TEST_F(NoCifgNoPeepholeNoProjectionNoClippingUnidirectionalLstmTest,
                 /*time_major=*/false);
 }
 
+TEST_F(NoCifgNoPeepholeNoProjectionNoClippingUnidirectionalLstmTest,
+       LstmLongSequenceMultiBatchMultiThreaded) {
+  const int n_batch = 3;
+  const int n_input = 2;
+  // n_cell and n_output have the same size when there is no projection.
+  const int n_cell = 4;
+  const int n_output = 4;
+  // Longer than one chunk of precomputed input projections.
+  const int sequence_length = 70;
+
+  // Computes the golden output of one batch row step by step.
+  auto sigmoid = [](float x) { return 1.0f / (1.0f + std::exp(-x)); };
+  auto gate = [&](const std::vector<float>& input_weights,
+                  const std::vector<float>& recurrent_weights,
+                  const std::vector<float>& bias, const float* input,
+                  const std::vector<float>& output_state, int cell) {
+    float acc = bias[cell];
+    for (int i = 0; i < n_input; ++i) {
+      acc += input_weights[cell * n_input + i] * input[i];
+    }
+    for (int i = 0; i < n_output; ++i) {
+      acc += recurrent_weights[cell * n_output + i] * output_state[i];
+    }
+    return acc;
+  };
+  std::vector<std::vector<float>> input(n_batch);
+  std::vector<std::vector<float>> golden_output(n_batch);
+  for (int b = 0; b < n_batch; ++b) {
+    for (int i = 0; i < sequence_length * n_input; ++i) {
+      input[b].push_back(std::sin(0.1f * i + b));
+    }
+    std::vector<float> output_state(n_output, 0.0f);
+    std::vector<float> cell_state(n_cell, 0.0f);
+    for (int t = 0; t < sequence_length; ++t) {
+      const float* step_input = input[b].data() + t * n_input;
+      std::vector<float> new_output_state(n_output);
+      for (int c = 0; c < n_cell; ++c) {
+        const float input_gate =
+            sigmoid(gate(input_to_input_weights_, recurrent_to_input_weights_,
+                         input_gate_bias_, step_input, output_state, c));
+        const float forget_gate = sigmoid(
+            gate(input_to_forget_weights_, recurrent_to_forget_weights_,
+                 forget_gate_bias_, step_input, output_state, c));
+        const float cell_gate =
+            std::tanh(gate(input_to_cell_weights_, recurrent_to_cell_weights_,
+                           cell_gate_bias_, step_input, output_state, c));
+        const float output_gate = sigmoid(
+            gate(input_to_output_weights_, recurrent_to_output_weights_,
+                 output_gate_bias_, step_input, output_state, c));
+        cell_state[c] = forget_gate * cell_state[c] + input_gate * cell_gate;
+        new_output_state[c] = output_gate * std::tanh(cell_state[c]);
+      }
+      output_state = new_output_state;
+      golden_output[b].insert(golden_output[b].end(), output_state.begin(),
+                              output_state.end());
+    }
+  }
+
+  for (bool time_major : {true, false}) {
+    const std::vector<int> input_shape =
+        time_major ? std::vector<int>{sequence_length, n_batch, n_input}
+                   : std::vector<int>{n_batch, sequence_length, n_input};
+    UnidirectionalLSTMOpModel lstm(
+        n_batch, n_input, n_cell, n_output, sequence_length, time_major,
+        /*use_cifg=*/false, /*use_peephole=*/false,
+        /*use_projection_weights=*/false,
+        /*use_projection_bias=*/false,
+        /*cell_clip=*/0.0, /*proj_clip=*/0.0,
+        {
+            input_shape,  // input tensor
+
+            {n_cell, n_input},  // input_to_input_weight tensor
+            {n_cell, n_input},  // input_to_forget_weight tensor
+            {n_cell, n_input},  // input_to_cell_weight tensor
+            {n_cell, n_input},  // input_to_output_weight tensor
+
+            {n_cell, n_output},  // recurrent_to_input_weight tensor
+            {n_cell, n_output},  // recurrent_to_forget_weight tensor
+            {n_cell, n_output},  // recurrent_to_cell_weight tensor
+            {n_cell, n_output},  // recurrent_to_output_weight tensor
+
+            {0},  // cell_to_input_weight tensor
+            {0},  // cell_to_forget_weight tensor
+            {0},  // cell_to_output_weight tensor
+
+            {n_cell},  // input_gate_bias tensor
+            {n_cell},  // forget_gate_bias tensor
+            {n_cell},  // cell_gate_bias tensor
+            {n_cell},  // output_gate_bias tensor
+
+            {0, 0},  // projection_weight tensor
+            {0},     // projection_bias tensor
+
+            {n_batch, n_output},  // output_state tensor
+            {n_batch, n_cell},    // cell_state tensor
+        });
+    lstm.SetNumThreads(2);
+
+    lstm.SetInputToInputWeights(input_to_input_weights_);
+    lstm.SetInputToCellWeights(input_to_cell_weights_);
+    lstm.SetInputToForgetWeights(input_to_forget_weights_);
+    lstm.SetInputToOutputWeights(input_to_output_weights_);
+
+    lstm.SetInputGateBias(input_gate_bias_);
+    lstm.SetCellBias(cell_gate_bias_);
+    lstm.SetForgetGateBias(forget_gate_bias_);
+    lstm.SetOutputGateBias(output_gate_bias_);
+
+    lstm.SetRecurrentToInputWeights(recurrent_to_input_weights_);
+    lstm.SetRecurrentToCellWeights(recurrent_to_cell_weights_);
+    lstm.SetRecurrentToForgetWeights(recurrent_to_forget_weights_);
+    lstm.SetRecurrentToOutputWeights(recurrent_to_output_weights_);
+
+    VerifyGoldens(input, golden_output, &lstm, /*tolerance=*/1e-5, time_major);
+  }
+}
+
 TEST_P(NoCifgNoPeepholeNoProjectionNoClippingUnidirectionalLstmTest,
        HybridLstmBlackBoxTestUint8) {
   const int n_batch = 1;
@@ -15,9 +15,15 @@ limitations under the License.
 
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -87,6 +93,25 @@ OperatorDetails GetOperatorDetails(const tflite::Interpreter& interpreter,
   return details;
 }
 
+// Returns the name and the type used in the stats of the node `node_index`
+// of subgraph `subgraph_index`, as reported by an OPERATOR_INVOKE_EVENT with
+// `tag`.
+std::pair<std::string, std::string> GetNodeNameAndType(
+    const tflite::Interpreter& interpreter, uint32_t subgraph_index,
+    uint32_t node_index, const char* tag) {
+  const auto op_details =
+      GetOperatorDetails(interpreter, subgraph_index, node_index);
+  std::string type_in_stats(tag);
+  if (!op_details.op_description.empty()) {
+    type_in_stats += "/" + op_details.op_description;
+  }
+
+  const auto node_name = ToString(op_details.outputs);
+  // Append node index to node name because 'stats_calculator' can not
+  // distinguish two nodes w/ the same 'node_name'.
+  return {node_name + ":" + std::to_string(node_index), type_in_stats};
+}
+
 }  // namespace
 
 ProfileSummarizer::ProfileSummarizer(
@@ -113,32 +138,72 @@ void ProfileSummarizer::ProcessProfiles(
   std::map<uint32_t, int64_t> total_us_per_subgraph_map;
   int64_t delegate_internal_total_us = 0;
 
+  // Bytes allocated during this run, keyed by (subgraph index, node index).
+  // Memory events are recorded while their operator's invoke event is still
+  // open, so these are collected before the invoke events are processed.
+  std::map<std::pair<uint32_t, int64_t>, int64_t> node_bytes_map;
+  // Bytes allocated during this run, keyed by the memory_stats_ key.
+  std::map<std::tuple<uint32_t, std::string, std::string, std::string>,
+           int64_t>
+      memory_bytes_map;
+  for (auto event : profile_stats) {
+    if (event->event_type != Profiler::EventType::OPERATOR_MEMORY_EVENT) {
+      continue;
+    }
+    const auto subgraph_index = event->extra_event_metadata;
+    const int64_t node_index = event->event_metadata;
+    const int64_t bytes = event->elapsed_time;
+    auto subgraph =
+        const_cast<tflite::Interpreter&>(interpreter).subgraph(subgraph_index);
+    if (subgraph != nullptr && node_index >= 0 &&
+        node_index < subgraph->nodes_size()) {
+      node_bytes_map[{subgraph_index, node_index}] += bytes;
+      const auto& node_reg =
+          subgraph->node_and_registration(node_index)->second;
+      const char* op_name =
+          node_reg.custom_name != nullptr
+              ? node_reg.custom_name
+              : EnumNameBuiltinOperator(
+                    static_cast<BuiltinOperator>(node_reg.builtin_code));
+      auto name_and_type = GetNodeNameAndType(interpreter, subgraph_index,
+                                              node_index, op_name);
+      memory_bytes_map[{subgraph_index, name_and_type.first,
+                        name_and_type.second, event->tag}] += bytes;
+    } else {
+      // Allocations that can't be attributed to a node, e.g. made by a
+      // delegate outside of its kernel invocation.
+      memory_bytes_map[{subgraph_index, "Delegate/" + std::string(event->tag),
+                        "Unknown", event->tag}] += bytes;
+    }
+  }
+  for (const auto& memory_bytes : memory_bytes_map) {
+    memory_stats_[memory_bytes.first].UpdateStat(memory_bytes.second);
+  }
+
   for (auto event : profile_stats) {
     const auto subgraph_index = event->extra_event_metadata;
     auto stats_calculator = GetStatsCalculator(subgraph_index);
     int64_t node_exec_time = event->elapsed_time;
-    if (event->event_type == Profiler::EventType::OPERATOR_INVOKE_EVENT) {
+    if (event->event_type == Profiler::EventType::OPERATOR_MEMORY_EVENT) {
+      // Already accounted for above; the `elapsed_time` of memory events is a
+      // size in bytes.
+      continue;
+    } else if (event->event_type ==
+               Profiler::EventType::OPERATOR_INVOKE_EVENT) {
       // When recording an OPERATOR_INVOKE_EVENT, we have recorded the node
       // index as event_metadata. See the macro
       // TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE defined in
       // tensorflow/lite/core/api/profiler.h for details.
       const auto node_index = event->event_metadata;
 
-      const auto op_details =
-          GetOperatorDetails(interpreter, subgraph_index, node_index);
-      std::string type_in_stats(event->tag);
-      if (!op_details.op_description.empty()) {
-        type_in_stats += "/" + op_details.op_description;
-      }
+      const auto name_and_type = GetNodeNameAndType(
+          interpreter, subgraph_index, node_index, event->tag);
+      const auto node_bytes = node_bytes_map.find({subgraph_index, node_index});
+      const int64_t mem_used =
+          node_bytes == node_bytes_map.end() ? 0 : node_bytes->second;
 
-      const auto node_name = ToString(op_details.outputs);
-      // Append node index to node name because 'stats_calculator' can not
-      // distinguish two nodes w/ the same 'node_name'.
-      const auto node_name_in_stats =
-          node_name + ":" + std::to_string(node_index);
-
-      stats_calculator->AddNodeStats(node_name_in_stats, type_in_stats,
-                                     node_num, node_exec_time, 0 /*memory */);
+      stats_calculator->AddNodeStats(name_and_type.first, name_and_type.second,
+                                     node_num, node_exec_time, mem_used);
     } else if (event->event_type ==
                Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT) {
       const std::string node_name(event->tag);
@@ -205,6 +270,44 @@ void ProfileSummarizer::ProcessProfiles(
   SetSubgraphNameMap(interpreter);
 }
 
+std::string ProfileSummarizer::GetMemoryOutputString() const {
+  if (memory_stats_.empty()) return "";
+
+  std::vector<std::pair<const std::tuple<uint32_t, std::string, std::string,
+                                         std::string>*,
+                        const tensorflow::Stat<int64_t>*>>
+      sorted_details;
+  sorted_details.reserve(memory_stats_.size());
+  for (const auto& details : memory_stats_) {
+    sorted_details.emplace_back(&details.first, &details.second);
+  }
+  std::stable_sort(sorted_details.begin(), sorted_details.end(),
+                   [](const auto& a, const auto& b) {
+                     return a.second->max() > b.second->max();
+                   });
+
+  std::stringstream stream;
+  stream << "============================== Memory allocations per node "
+            "==============================
+";
+  stream << std::setw(10) << "[subgraph]" << "\t" << std::setw(24)
+         << "[node type]" << "\t" << std::setw(24) << "[allocation kind]"
+         << "\t" << std::setw(9) << "[count]" << "\t" << std::setw(12)
+         << "[avg KB]" << "\t" << std::setw(12) << "[max KB]" << "\t"
+         << "[Name]\n";
+  stream << std::fixed << std::setprecision(3);
+  for (const auto& details : sorted_details) {
+    const auto& key = *details.first;
+    const auto& bytes = *details.second;
+    stream << std::setw(10) << std::get<0>(key) << "\t" << std::setw(24)
+           << std::get<2>(key) << "\t" << std::setw(24) << std::get<3>(key)
+           << "\t" << std::setw(9) << bytes.count() << "\t" << std::setw(12)
+           << bytes.avg() / 1000.0 << "\t" << std::setw(12)
+           << bytes.max() / 1000.0 << "\t" << std::get<1>(key) << "\n";
+  }
+  return stream.str();
+}
+
 tensorflow::StatsCalculator* ProfileSummarizer::GetStatsCalculator(
     uint32_t subgraph_index) {
   if (stats_calculator_map_.count(subgraph_index) == 0) {
@@ -20,6 +20,7 @@ limitations under the License.
 #include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "tensorflow/core/util/stats_calculator.h"
@@ -49,6 +50,11 @@ class ProfileSummarizer {
         stats_calculator_map_, *delegate_stats_calculator_, subgraph_name_map_);
   }
 
+  // Returns a table of the memory allocated by each operator node, grouped by
+  // allocation kind (the tag of the OPERATOR_MEMORY_EVENTs), or an empty
+  // string if no memory events were recorded.
+  std::string GetMemoryOutputString() const;
+
   std::string GetShortSummary() {
     return summary_formatter_->GetShortSummary(
         stats_calculator_map_, *delegate_stats_calculator_, subgraph_name_map_);
@@ -76,6 +82,12 @@ class ProfileSummarizer {
 
   std::map<uint32_t, std::string> subgraph_name_map_;
 
+  // Per-invoke statistics of the bytes allocated by a node, keyed by
+  // (subgraph index, node name, op type, allocation kind).
+  std::map<std::tuple<uint32_t, std::string, std::string, std::string>,
+           tensorflow::Stat<int64_t>>
+      memory_stats_;
+
   void SetSubgraphNameMap(const tflite::Interpreter& interpreter) {
     subgraph_name_map_.clear();
     for (int subgraph_index = 0; subgraph_index < interpreter.subgraphs_size();
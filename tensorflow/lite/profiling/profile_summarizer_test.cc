@@ -75,6 +75,39 @@ TfLiteRegistration* RegisterSimpleOpWithProfilingDetails() {
   return &registration;
 }
 
+TfLiteStatus DynamicOutputOpPrepare(TfLiteContext* context, TfLiteNode* node) {
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, /*index=*/0, &output));
+  SetTensorToDynamic(output);
+  return kTfLiteOk;
+}
+
+// Same as SimpleOpEval but allocates its dynamic output and reports a scratch
+// allocation, as a delegate kernel would.
+TfLiteStatus DynamicOutputOpEval(TfLiteContext* context, TfLiteNode* node) {
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, /*index=*/0, &output));
+  TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, output,
+                                                   TfLiteIntArrayCreate(0)));
+  auto* profiler = reinterpret_cast<Profiler*>(context->profiler);
+  TFLITE_ADD_OPERATOR_MEMORY_EVENT(profiler, "Scratch", 2048);
+  return SimpleOpEval(context, node);
+}
+
+TfLiteRegistration* RegisterDynamicOutputOp() {
+  static TfLiteRegistration registration = {nullptr,
+                                            nullptr,
+                                            DynamicOutputOpPrepare,
+                                            DynamicOutputOpEval,
+                                            nullptr,
+                                            tflite::BuiltinOperator_CUSTOM,
+                                            kOpName,
+                                            1};
+  return &registration;
+}
+
 class SimpleOpModel : public SingleOpModel {
  public:
   void Init(const std::function<TfLiteRegistration*()>& registration);
@@ -225,6 +258,47 @@ TEST_F(ProfileSummarizerIfOpTest, TestIfFalse) {
   EXPECT_EQ(3, event_count_of_subgraph_two);
 }
 
+TEST(ProfileSummarizerTest, MemoryEvents) {
+  BufferedProfiler profiler(1024);
+  SimpleOpModel m;
+  m.Init(RegisterDynamicOutputOp);
+  auto interpreter = m.GetInterpreter();
+  interpreter->SetProfiler(&profiler);
+  ProfileSummarizer summarizer;
+  EXPECT_TRUE(summarizer.GetMemoryOutputString().empty());
+  for (int i = 0; i < 2; ++i) {
+    profiler.Reset();
+    profiler.StartProfiling();
+    m.SetInputs(1, 2);
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+    EXPECT_EQ(m.GetOutput(), 3);
+    profiler.StopProfiling();
+
+    auto events = profiler.GetProfileEvents();
+    int memory_event_count = 0;
+    for (const ProfileEvent* event : events) {
+      if (event->event_type != Profiler::EventType::OPERATOR_MEMORY_EVENT) {
+        continue;
+      }
+      ++memory_event_count;
+      // Both allocations are attributed to the only node of the graph.
+      EXPECT_EQ(0, event->event_metadata);
+      EXPECT_EQ(0, event->extra_event_metadata);
+    }
+    // The scratch allocation, plus the output allocated on the first run.
+    EXPECT_EQ(i == 0 ? 2 : 1, memory_event_count);
+    summarizer.ProcessProfiles(events, *interpreter);
+  }
+
+  auto output = summarizer.GetMemoryOutputString();
+  EXPECT_THAT(output, testing::HasSubstr("Scratch"));
+  EXPECT_THAT(output, testing::HasSubstr("DynamicTensorAllocation"));
+  EXPECT_THAT(output, testing::HasSubstr("SimpleOpEval"));
+  // Memory events must not show up as nodes in the timing summary.
+  EXPECT_THAT(summarizer.GetOutputString(),
+              testing::Not(testing::HasSubstr("Scratch")));
+}
+
 }  // namespace
 }  // namespace profiling
 }  // namespace tflite
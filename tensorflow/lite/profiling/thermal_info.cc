@@ -0,0 +1,121 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/thermal_info.h"
+
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/stat.h>
+#endif
+
+namespace tflite {
+namespace profiling {
+namespace thermal {
+namespace {
+
+#ifdef __linux__
+bool DirectoryExists(const std::string& path) {
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+template <typename T>
+bool ReadValue(const std::string& path, T* value) {
+  std::ifstream file(path);
+  return file.good() && (file >> *value);
+}
+#endif  // __linux__
+
+}  // namespace
+
+const int64_t ThermalInfo::kValueNotSet = -1;
+
+bool ThermalInfo::IsSupported() {
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+float ThermalInfo::MaxTemperatureCelsius() const {
+  float max_temperature = -1.0f;
+  for (const ThermalZone& zone : zones) {
+    if (zone.temperature_celsius > max_temperature) {
+      max_temperature = zone.temperature_celsius;
+    }
+  }
+  return max_temperature;
+}
+
+void ThermalInfo::AllStatsToStream(std::ostream* stream) const {
+  *stream << "cpu freq (MHz): [";
+  for (size_t i = 0; i < cpu_freq_khz.size(); ++i) {
+    if (i > 0) *stream << " ";
+    if (cpu_freq_khz[i] == kValueNotSet) {
+      *stream << "-";
+    } else {
+      *stream << cpu_freq_khz[i] / 1000;
+    }
+  }
+  *stream << "] temperature (C): [";
+  for (size_t i = 0; i < zones.size(); ++i) {
+    if (i > 0) *stream << " ";
+    *stream << zones[i].type << "=" << zones[i].temperature_celsius;
+  }
+  *stream << "]";
+}
+
+ThermalInfo GetThermalInfo() { return GetThermalInfo("/sys"); }
+
+ThermalInfo GetThermalInfo(const std::string& sysfs_root) {
+  ThermalInfo result;
+#ifdef __linux__
+  const std::string cpu_dir = sysfs_root + "/devices/system/cpu/cpu";
+  for (int cpu = 0; DirectoryExists(cpu_dir + std::to_string(cpu)); ++cpu) {
+    int64_t freq_khz;
+    if (!ReadValue(cpu_dir + std::to_string(cpu) + "/cpufreq/scaling_cur_freq",
+                   &freq_khz)) {
+      freq_khz = ThermalInfo::kValueNotSet;
+    }
+    result.cpu_freq_khz.push_back(freq_khz);
+  }
+
+  const std::string zone_dir = sysfs_root + "/class/thermal/thermal_zone";
+  for (int zone = 0; DirectoryExists(zone_dir + std::to_string(zone));
+       ++zone) {
+    const std::string path = zone_dir + std::to_string(zone);
+    // Zones report their temperature in millidegrees Celsius. Reading may
+    // fail for zones of powered-down sensors, which are then skipped.
+    int64_t millidegrees;
+    if (!ReadValue(path + "/temp", &millidegrees)) continue;
+    ThermalZone thermal_zone;
+    if (!ReadValue(path + "/type", &thermal_zone.type)) {
+      thermal_zone.type = "zone" + std::to_string(zone);
+    }
+    thermal_zone.temperature_celsius = millidegrees / 1000.0f;
+    result.zones.push_back(std::move(thermal_zone));
+  }
+#endif  // __linux__
+  return result;
+}
+
+}  // namespace thermal
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,79 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_THERMAL_INFO_H_
+#define TENSORFLOW_LITE_PROFILING_THERMAL_INFO_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace tflite {
+namespace profiling {
+namespace thermal {
+
+struct ThermalZone {
+  // The zone type as reported by the kernel, e.g. "cpu-0-0-usr" or
+  // "x86_pkg_temp".
+  std::string type;
+  float temperature_celsius;
+};
+
+struct ThermalInfo {
+  static const int64_t kValueNotSet;
+
+  // Indicates whether obtaining CPU frequencies and temperatures is supported
+  // on the platform.
+  static bool IsSupported();
+
+  // Current frequency (in kHz) of each CPU core, indexed by core id. Set to
+  // kValueNotSet for cores that are offline or don't expose cpufreq.
+  // For Linux, this is read from
+  // /sys/devices/system/cpu/cpu<N>/cpufreq/scaling_cur_freq.
+  std::vector<int64_t> cpu_freq_khz;
+
+  // Temperature of each readable thermal zone.
+  // For Linux, this is read from /sys/class/thermal/thermal_zone<N>/temp.
+  std::vector<ThermalZone> zones;
+
+  bool empty() const { return cpu_freq_khz.empty() && zones.empty(); }
+
+  // Returns the highest zone temperature, or a negative value if no zone is
+  // readable.
+  float MaxTemperatureCelsius() const;
+
+  void AllStatsToStream(std::ostream* stream) const;
+
+  friend std::ostream& operator<<(std::ostream& stream,
+                                  const ThermalInfo& obj) {
+    obj.AllStatsToStream(&stream);
+    return stream;
+  }
+};
+
+// Returns the current CPU frequencies and thermal zone temperatures. The
+// result is empty when the information isn't available.
+// Note: this currently only works on Linux-based systems (incl. Android).
+ThermalInfo GetThermalInfo();
+
+// Same as above but reads from the sysfs tree mounted at `sysfs_root` instead
+// of "/sys". Exposed for testing.
+ThermalInfo GetThermalInfo(const std::string& sysfs_root);
+
+}  // namespace thermal
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_THERMAL_INFO_H_
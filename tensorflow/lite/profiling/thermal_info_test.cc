@@ -0,0 +1,106 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/thermal_info.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#ifdef __linux__
+#include <sys/stat.h>
+#endif
+
+namespace tflite {
+namespace profiling {
+namespace thermal {
+namespace {
+
+TEST(ThermalInfo, IsSupported) {
+#ifdef __linux__
+  EXPECT_TRUE(ThermalInfo::IsSupported());
+#else
+  EXPECT_FALSE(ThermalInfo::IsSupported());
+#endif
+}
+
+TEST(ThermalInfo, MaxTemperature) {
+  ThermalInfo info;
+  EXPECT_TRUE(info.empty());
+  EXPECT_LT(info.MaxTemperatureCelsius(), 0.0f);
+
+  info.zones.push_back({"a", 41.5f});
+  info.zones.push_back({"b", 63.0f});
+  EXPECT_FALSE(info.empty());
+  EXPECT_FLOAT_EQ(63.0f, info.MaxTemperatureCelsius());
+}
+
+TEST(ThermalInfo, AllStatsToStream) {
+  ThermalInfo info;
+  info.cpu_freq_khz = {1800000, ThermalInfo::kValueNotSet};
+  info.zones.push_back({"cpu", 50.0f});
+  std::stringstream stream;
+  stream << info;
+  EXPECT_EQ("cpu freq (MHz): [1800 -] temperature (C): [cpu=50]",
+            stream.str());
+}
+
+#ifdef __linux__
+void MakeDir(const std::string& path) { mkdir(path.c_str(), 0755); }
+
+void WriteFile(const std::string& path, const std::string& content) {
+  std::ofstream file(path);
+  file << content;
+}
+
+TEST(ThermalInfo, ReadsFromSysfs) {
+  const std::string root = ::testing::TempDir() + "/thermal_info_sysfs";
+  MakeDir(root);
+  MakeDir(root + "/devices");
+  MakeDir(root + "/devices/system");
+  MakeDir(root + "/devices/system/cpu");
+  // cpu0 is online, cpu1 has no cpufreq entry (e.g. offline).
+  MakeDir(root + "/devices/system/cpu/cpu0");
+  MakeDir(root + "/devices/system/cpu/cpu0/cpufreq");
+  WriteFile(root + "/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq",
+            "2400000\n");
+  MakeDir(root + "/devices/system/cpu/cpu1");
+  MakeDir(root + "/class");
+  MakeDir(root + "/class/thermal");
+  MakeDir(root + "/class/thermal/thermal_zone0");
+  WriteFile(root + "/class/thermal/thermal_zone0/type", "soc\n");
+  WriteFile(root + "/class/thermal/thermal_zone0/temp", "45500\n");
+  // A zone whose temperature isn't readable is skipped.
+  MakeDir(root + "/class/thermal/thermal_zone1");
+
+  const ThermalInfo info = GetThermalInfo(root);
+  ASSERT_EQ(2, info.cpu_freq_khz.size());
+  EXPECT_EQ(2400000, info.cpu_freq_khz[0]);
+  EXPECT_EQ(ThermalInfo::kValueNotSet, info.cpu_freq_khz[1]);
+  ASSERT_EQ(1, info.zones.size());
+  EXPECT_EQ("soc", info.zones[0].type);
+  EXPECT_FLOAT_EQ(45.5f, info.zones[0].temperature_celsius);
+}
+#endif  // __linux__
+
+TEST(ThermalInfo, MissingSysfsIsEmpty) {
+  EXPECT_TRUE(GetThermalInfo("/nonexistent_sysfs_root").empty());
+}
+
+}  // namespace
+}  // namespace thermal
+}  // namespace profiling
+}  // namespace tflite
@@ -234,7 +234,7 @@ TfLiteStatus SimpleMemoryArena::Allocate(
     TfLiteContext* context, size_t alignment, size_t size, int32_t tensor,
     int32_t first_node, int32_t last_node,
     ArenaAllocWithUsageInterval* new_alloc) {
-  TF_LITE_ENSURE(context, alignment <= underlying_buffer_.GetAlignment());
+  TF_LITE_ENSURE(context, alignment <= buffer().GetAlignment());
   new_alloc->tensor = tensor;
   new_alloc->first_node = first_node;
   new_alloc->last_node = last_node;
@@ -288,22 +288,41 @@ TfLiteStatus SimpleMemoryArena::Commit(bool* arena_reallocated) {
   // Resize the arena to the high water mark (calculated by Allocate), retaining
   // old contents and alignment in the process. Since Alloc pointers are offset
   // based, they will remain valid in the new memory block.
-  *arena_reallocated = underlying_buffer_.Resize(high_water_mark_);
+  *arena_reallocated = buffer().Resize(high_water_mark_);
+  if (shared_buffer_ != nullptr) {
+    // Other arenas sharing the buffer find out that it moved when they are
+    // next committed, or through `SharedBufferMoved`.
+    if (*arena_reallocated) ++shared_buffer_->generation_;
+    *arena_reallocated |=
+        shared_buffer_->generation_ != shared_buffer_generation_;
+    shared_buffer_generation_ = shared_buffer_->generation_;
+  }
   committed_ = true;
   return kTfLiteOk;
 }
 
+void SimpleMemoryArena::RestorePlan(
+    const std::vector<ArenaAllocWithUsageInterval>& allocs) {
+  committed_ = false;
+  active_allocs_ = allocs;
+  std::stable_sort(active_allocs_.begin(), active_allocs_.end());
+  high_water_mark_ = 0;
+  for (const auto& alloc : active_allocs_) {
+    high_water_mark_ = std::max(high_water_mark_, alloc.offset + alloc.size);
+  }
+}
+
 TfLiteStatus SimpleMemoryArena::ResolveAlloc(
     TfLiteContext* context, const ArenaAllocWithUsageInterval& alloc,
     char** output_ptr) {
   TF_LITE_ENSURE(context, committed_);
   TF_LITE_ENSURE(context, output_ptr != nullptr);
   TF_LITE_ENSURE(context,
-                 underlying_buffer_.GetSize() >= (alloc.offset + alloc.size));
+                 buffer().GetSize() >= (alloc.offset + alloc.size));
   if (alloc.size == 0) {
     *output_ptr = nullptr;
   } else {
-    *output_ptr = underlying_buffer_.GetPtr() + alloc.offset;
+    *output_ptr = buffer().GetPtr() + alloc.offset;
   }
   return kTfLiteOk;
 }
@@ -317,7 +336,8 @@ TfLiteStatus SimpleMemoryArena::ClearPlan() {
 
 TfLiteStatus SimpleMemoryArena::ReleaseBuffer() {
   committed_ = false;
-  underlying_buffer_.Release();
+  // The shared buffer may still be used by other arenas.
+  if (shared_buffer_ == nullptr) underlying_buffer_.Release();
   return kTfLiteOk;
 }
 
@@ -329,7 +349,7 @@ TFLITE_ATTRIBUTE_WEAK void DumpArenaInfo(
 
 void SimpleMemoryArena::DumpDebugInfo(
     const std::string& name, const std::vector<int>& execution_plan) const {
-  tflite::DumpArenaInfo(name, execution_plan, underlying_buffer_.GetSize(),
+  tflite::DumpArenaInfo(name, execution_plan, buffer().GetSize(),
                         active_allocs_);
 }
 
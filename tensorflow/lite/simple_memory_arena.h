@@ -100,6 +100,33 @@ class ResizableAlignedBuffer {
   int subgraph_index_;
 };
 
+// A buffer for the non-persistent tensors of several interpreters, which
+// then only take as much memory as the largest of them instead of their sum.
+// It must outlive the interpreters using it, and they must never be invoked
+// concurrently. Since their tensors overlap, the tensors of an interpreter,
+// including its inputs and outputs, are overwritten when another one sharing
+// the buffer is invoked, and their data pointers are only valid until another
+// one is allocated or invoked. Call `AllocateTensors()`, which is cheap when
+// nothing was resized, before accessing the tensors of an interpreter after
+// another one used the buffer.
+// WARNING: This is an experimental API and subject to change.
+class SharedArenaBuffer {
+ public:
+  // `alignment` must be at least the alignment of the arenas sharing the buffer
+  // (`kDefaultArenaAlignment` of arena_planner.h).
+  explicit SharedArenaBuffer(size_t alignment)
+      : buffer_(alignment, /*subgraph_index=*/0) {}
+
+  size_t GetSize() const { return buffer_.GetSize(); }
+
+ private:
+  friend class SimpleMemoryArena;
+
+  ResizableAlignedBuffer buffer_;
+  // Incremented every time the buffer moves.
+  int64_t generation_ = 0;
+};
+
 // This small class is responsible for allocating, deallocating and reusing
 // dynamic memory from a common underlying buffer. The arena can be used in
 // scenarios when the pattern of memory allocations and deallocations is
@@ -144,6 +171,24 @@ class SimpleMemoryArena {
 
   TfLiteStatus Commit(bool* arena_reallocated);
 
+  // Makes the arena allocate its tensors in `shared_buffer` instead of a
+  // buffer of its own. This must be called before the first `Commit`.
+  void SetSharedBuffer(SharedArenaBuffer* shared_buffer) {
+    shared_buffer_ = shared_buffer;
+  }
+
+  // Returns true if another arena moved the shared buffer since this one was
+  // last committed, so that its allocs must be resolved again.
+  bool SharedBufferMoved() const {
+    return shared_buffer_ != nullptr &&
+           shared_buffer_->generation_ != shared_buffer_generation_;
+  }
+
+  // Replaces the allocation plan with `allocs`, which were scheduled by
+  // `Allocate` in an earlier plan of the same tensors. The new plan must be
+  // committed before resolving its allocs.
+  void RestorePlan(const std::vector<ArenaAllocWithUsageInterval>& allocs);
+
   TfLiteStatus ResolveAlloc(TfLiteContext* context,
                             const ArenaAllocWithUsageInterval& alloc,
                             char** output_ptr);
@@ -158,10 +203,10 @@ class SimpleMemoryArena {
   // again until Commit() is called & tensor allocations are resolved.
   TfLiteStatus ReleaseBuffer();
 
-  size_t GetBufferSize() const { return underlying_buffer_.GetSize(); }
+  size_t GetBufferSize() const { return buffer().GetSize(); }
 
   std::intptr_t BasePointer() const {
-    return reinterpret_cast<std::intptr_t>(underlying_buffer_.GetPtr());
+    return reinterpret_cast<std::intptr_t>(buffer().GetPtr());
   }
 
   // Dumps the memory allocation information of this memory arena (which could
@@ -182,10 +227,21 @@ class SimpleMemoryArena {
                      const std::vector<int>& execution_plan) const;
 
  private:
+  ResizableAlignedBuffer& buffer() {
+    return shared_buffer_ ? shared_buffer_->buffer_ : underlying_buffer_;
+  }
+  const ResizableAlignedBuffer& buffer() const {
+    return shared_buffer_ ? shared_buffer_->buffer_ : underlying_buffer_;
+  }
+
   bool committed_;
   size_t high_water_mark_;
   ResizableAlignedBuffer underlying_buffer_;
   std::vector<ArenaAllocWithUsageInterval> active_allocs_;
+  // Not owned, null if the arena has its own buffer.
+  SharedArenaBuffer* shared_buffer_ = nullptr;
+  // Generation of `shared_buffer_` when this arena was last committed.
+  int64_t shared_buffer_generation_ = 0;
 };
 
 }  // namespace tflite
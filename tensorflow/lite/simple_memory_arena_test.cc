@@ -321,6 +321,50 @@ TEST(SimpleMemoryArenaTest, TestClearBuffer) {
   EXPECT_NE(resolved_ptr, nullptr);
 }
 
+TEST(SimpleMemoryArenaTest, SharedBuffer) {
+  TfLiteContext context;
+  context.ReportError = ReportError;
+  SharedArenaBuffer shared_buffer(64);
+  SimpleMemoryArena arena1(64);
+  SimpleMemoryArena arena2(64);
+  arena1.SetSharedBuffer(&shared_buffer);
+  arena2.SetSharedBuffer(&shared_buffer);
+  ArenaAllocWithUsageInterval alloc1, alloc2;
+
+  ASSERT_EQ(arena1.Allocate(&context, 32, 2047, 0, 0, 2, &alloc1), kTfLiteOk);
+  bool reallocated = false;
+  ASSERT_EQ(arena1.Commit(&reallocated), kTfLiteOk);
+  EXPECT_TRUE(reallocated);
+  EXPECT_FALSE(arena1.SharedBufferMoved());
+  // The buffer was allocated after arena2 was last committed.
+  EXPECT_TRUE(arena2.SharedBufferMoved());
+
+  // Smaller arenas reuse the buffer as is, but still report that their allocs
+  // moved.
+  ASSERT_EQ(arena2.Allocate(&context, 32, 1023, 0, 0, 2, &alloc2), kTfLiteOk);
+  ASSERT_EQ(arena2.Commit(&reallocated), kTfLiteOk);
+  EXPECT_TRUE(reallocated);
+  EXPECT_FALSE(arena2.SharedBufferMoved());
+  EXPECT_EQ(arena1.BasePointer(), arena2.BasePointer());
+  EXPECT_EQ(shared_buffer.GetSize(), 2047);
+
+  // Larger ones grow it, and the other arenas find out if it moved.
+  ASSERT_EQ(arena2.ClearPlan(), kTfLiteOk);
+  ASSERT_EQ(arena2.Allocate(&context, 32, 1 << 20, 0, 0, 2, &alloc2),
+            kTfLiteOk);
+  ASSERT_EQ(arena2.Commit(&reallocated), kTfLiteOk);
+  EXPECT_EQ(shared_buffer.GetSize(), 1 << 20);
+  EXPECT_EQ(arena1.SharedBufferMoved(), reallocated);
+  ASSERT_EQ(arena1.Commit(&reallocated), kTfLiteOk);
+  EXPECT_FALSE(arena1.SharedBufferMoved());
+  EXPECT_EQ(arena1.BasePointer(), arena2.BasePointer());
+
+  // Releasing the buffer of an arena leaves the shared one to the others.
+  ASSERT_EQ(arena1.ReleaseBuffer(), kTfLiteOk);
+  EXPECT_NE(arena2.BasePointer(), 0);
+  EXPECT_EQ(shared_buffer.GetSize(), 1 << 20);
+}
+
 // Test parameterized by whether ClearBuffer() is called before ClearPlan(), or
 // vice versa.
 class BufferAndPlanClearingTest : public ::testing::Test,
@@ -21,12 +21,16 @@ limitations under the License.
 #include <unistd.h>
 #endif  // __linux__
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/lite/profiling/memory_info.h"
+#include "tensorflow/lite/profiling/thermal_info.h"
 #include "tensorflow/lite/profiling/time.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 #include "tensorflow/lite/tools/logging.h"
@@ -74,6 +78,8 @@ BenchmarkParams BenchmarkModel::DefaultParams() {
   params.AddParam("memory_footprint_check_interval_ms",
                   BenchmarkParam::Create<int32_t>(kMemoryCheckIntervalMs));
   params.AddParam("gpu_invoke_loop_times", BenchmarkParam::Create<int32_t>(1));
+  params.AddParam("sustained_window_secs",
+                  BenchmarkParam::Create<float>(-1.0f));
   return params;
 }
 
@@ -117,6 +123,88 @@ void BenchmarkLoggingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
   }
 }
 
+namespace {
+
+// Returns the value at the given percentile of `sorted_values`, which must be
+// sorted in ascending order and non-empty.
+int64_t PercentileOfSorted(const std::vector<int64_t>& sorted_values,
+                           int percentile) {
+  const size_t index = (sorted_values.size() - 1) * percentile / 100;
+  return sorted_values[index];
+}
+
+}  // namespace
+
+SustainedPerformanceListener::SustainedPerformanceListener(float window_secs)
+    : window_us_(
+          std::max<int64_t>(1, static_cast<int64_t>(window_secs * 1e6))) {}
+
+void SustainedPerformanceListener::OnSingleRunStart(RunType run_type) {
+  in_regular_run_ = run_type == REGULAR;
+  if (!in_regular_run_) return;
+  run_start_us_ = profiling::time::NowMicros();
+  if (first_run_start_us_ < 0) {
+    first_run_start_us_ = run_start_us_;
+    window_start_us_ = run_start_us_;
+  }
+}
+
+void SustainedPerformanceListener::OnSingleRunEnd() {
+  if (!in_regular_run_) return;
+  in_regular_run_ = false;
+  const int64_t now_us = profiling::time::NowMicros();
+  window_latencies_us_.push_back(now_us - run_start_us_);
+  if (now_us - window_start_us_ >= window_us_) CloseWindow(now_us);
+}
+
+void SustainedPerformanceListener::CloseWindow(int64_t now_us) {
+  WindowStats window;
+  window.start_us = window_start_us_ - first_run_start_us_;
+  window.end_us = now_us - first_run_start_us_;
+  window.num_runs = window_latencies_us_.size();
+  std::sort(window_latencies_us_.begin(), window_latencies_us_.end());
+  window.p50_us = PercentileOfSorted(window_latencies_us_, 50);
+  window.p90_us = PercentileOfSorted(window_latencies_us_, 90);
+  window.p99_us = PercentileOfSorted(window_latencies_us_, 99);
+  window.max_us = window_latencies_us_.back();
+  window.thermal_info = profiling::thermal::GetThermalInfo();
+
+  std::stringstream stream;
+  stream << "Window [" << window.start_us / 1e6 << "s, "
+         << window.end_us / 1e6 << "s): runs=" << window.num_runs
+         << " p50=" << window.p50_us << " p90=" << window.p90_us
+         << " p99=" << window.p99_us << " max=" << window.max_us << " (us)";
+  if (!window.thermal_info.empty()) stream << " " << window.thermal_info;
+  TFLITE_LOG(INFO) << stream.str();
+
+  windows_.push_back(std::move(window));
+  window_latencies_us_.clear();
+  window_start_us_ = now_us;
+}
+
+void SustainedPerformanceListener::OnBenchmarkEnd(
+    const BenchmarkResults& results) {
+  if (!window_latencies_us_.empty()) {
+    CloseWindow(profiling::time::NowMicros());
+  }
+  if (windows_.size() < 2) return;
+  const WindowStats& first = windows_.front();
+  const WindowStats& last = windows_.back();
+  const double p50_change_percent = 100.0 * (last.p50_us - first.p50_us) /
+                                    std::max<int64_t>(1, first.p50_us);
+  std::stringstream stream;
+  stream << "Sustained performance over " << windows_.size()
+         << " windows: p50 changed from " << first.p50_us << "us to "
+         << last.p50_us << "us (" << p50_change_percent << "%)";
+  const float first_temperature = first.thermal_info.MaxTemperatureCelsius();
+  const float last_temperature = last.thermal_info.MaxTemperatureCelsius();
+  if (first_temperature >= 0 && last_temperature >= 0) {
+    stream << ", max temperature changed from " << first_temperature
+           << "C to " << last_temperature << "C";
+  }
+  TFLITE_LOG(INFO) << stream.str();
+}
+
 std::vector<Flag> BenchmarkModel::GetFlags() {
   return {
       CreateFlag<int32_t>(
@@ -179,7 +267,14 @@ std::vector<Flag> BenchmarkModel::GetFlags() {
           "gpu_invoke_loop_times", &params_,
           "Number of GPU delegate invoke loop iterations. If > 0 then reported "
           "latency is divided by this number. Used only when "
-          "TFLITE_GPU_ENABLE_INVOKE_LOOP is defined.")};
+          "TFLITE_GPU_ENABLE_INVOKE_LOOP is defined."),
+      CreateFlag<float>(
+          "sustained_window_secs", &params_,
+          "If positive, report the latency percentiles of the regular runs "
+          "per time window of this many seconds, together with the CPU "
+          "frequencies and temperatures when they are available. Combine with "
+          "a large --min_secs (e.g. several minutes) to observe the effect of "
+          "thermal throttling.")};
 }
 
 void BenchmarkModel::LogParams() {
@@ -206,6 +301,8 @@ void BenchmarkModel::LogParams() {
                       "Report the peak memory footprint", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "memory_footprint_check_interval_ms",
                       "Memory footprint check interval (ms)", verbose);
+  LOG_BENCHMARK_PARAM(float, "sustained_window_secs",
+                      "Sustained performance window (seconds)", verbose);
 #ifdef TFLITE_GPU_ENABLE_INVOKE_LOOP
   LOG_BENCHMARK_PARAM(int32_t, "gpu_invoke_loop_times",
                       "Number of GPU delegate invoke loop iterations. Latency "
@@ -343,6 +440,12 @@ TfLiteStatus BenchmarkModel::Run() {
     return status;
   }
 
+  // Only observes the regular runs, and is removed again once the results
+  // have been reported.
+  const int num_listeners = listeners_.NumListeners();
+  auto sustained_listener = MayCreateSustainedPerformanceListener();
+  if (sustained_listener != nullptr) AddListener(sustained_listener.get());
+
   Stat<int64_t> inference_time_us =
       Run(params_.Get<int32_t>("num_runs"), params_.Get<float>("min_secs"),
           params_.Get<float>("max_secs"), REGULAR, &status);
@@ -358,6 +461,7 @@ TfLiteStatus BenchmarkModel::Run() {
   listeners_.OnBenchmarkEnd({model_size_mb, startup_latency_us, input_bytes,
                              warmup_time_us, inference_time_us, init_mem_usage,
                              overall_mem_usage, peak_mem_mb});
+  listeners_.RemoveListeners(num_listeners);
   return status;
 }
 
@@ -396,5 +500,12 @@ BenchmarkModel::MayCreateMemoryUsageMonitor() const {
       params_.Get<int32_t>("memory_footprint_check_interval_ms"));
 }
 
+std::unique_ptr<SustainedPerformanceListener>
+BenchmarkModel::MayCreateSustainedPerformanceListener() const {
+  const float window_secs = params_.Get<float>("sustained_window_secs");
+  if (window_secs <= 0) return nullptr;
+  return std::make_unique<SustainedPerformanceListener>(window_secs);
+}
+
 }  // namespace benchmark
 }  // namespace tflite
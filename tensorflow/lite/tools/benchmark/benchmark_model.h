@@ -19,6 +19,7 @@ limitations under the License.
 #include <cmath>
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <unordered_set>
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/memory_usage_monitor.h"
+#include "tensorflow/lite/profiling/thermal_info.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_params.h"
 #include "tensorflow/lite/tools/command_line_flags.h"
 
@@ -166,6 +168,46 @@ class BenchmarkLoggingListener : public BenchmarkListener {
   void OnBenchmarkEnd(const BenchmarkResults& results) override;
 };
 
+// Benchmark listener for long-running (sustained) benchmarks. It splits the
+// regular runs into consecutive time windows of a fixed length and logs the
+// latency percentiles of each window together with the CPU frequencies and
+// temperatures sampled at the end of the window, so that a slowdown caused by
+// thermal throttling shows up as a trend across windows.
+class SustainedPerformanceListener : public BenchmarkListener {
+ public:
+  struct WindowStats {
+    // Start and end of the window relative to the start of the first regular
+    // run.
+    int64_t start_us = 0;
+    int64_t end_us = 0;
+    int64_t num_runs = 0;
+    int64_t p50_us = 0;
+    int64_t p90_us = 0;
+    int64_t p99_us = 0;
+    int64_t max_us = 0;
+    profiling::thermal::ThermalInfo thermal_info;
+  };
+
+  explicit SustainedPerformanceListener(float window_secs);
+
+  void OnSingleRunStart(RunType run_type) override;
+  void OnSingleRunEnd() override;
+  void OnBenchmarkEnd(const BenchmarkResults& results) override;
+
+  const std::vector<WindowStats>& windows() const { return windows_; }
+
+ private:
+  void CloseWindow(int64_t now_us);
+
+  const int64_t window_us_;
+  bool in_regular_run_ = false;
+  int64_t run_start_us_ = 0;
+  int64_t first_run_start_us_ = -1;
+  int64_t window_start_us_ = -1;
+  std::vector<int64_t> window_latencies_us_;
+  std::vector<WindowStats> windows_;
+};
+
 template <typename T>
 Flag CreateFlag(const char* name, BenchmarkParams* params,
                 const std::string& usage) {
@@ -230,6 +272,10 @@ class BenchmarkModel {
   virtual std::unique_ptr<profiling::memory::MemoryUsageMonitor>
   MayCreateMemoryUsageMonitor() const;
 
+  // Create a SustainedPerformanceListener if --sustained_window_secs is set.
+  virtual std::unique_ptr<SustainedPerformanceListener>
+  MayCreateSustainedPerformanceListener() const;
+
   BenchmarkParams params_;
   BenchmarkListeners listeners_;
 };
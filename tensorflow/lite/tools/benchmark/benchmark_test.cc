@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/lite/testing/util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_performance_options.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 #include "tensorflow/lite/tools/command_line_flags.h"
 #include "tensorflow/lite/tools/delegates/delegate_provider.h"
 #include "tensorflow/lite/tools/logging.h"
@@ -566,6 +567,59 @@ TEST(BenchmarkTest, MaxDurationWorks) {
   benchmark.Run();
 }
 
+TEST(BenchmarkTest, RunWithConcurrentInterpreters) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  TestBenchmark benchmark(CreateFp32Params());
+  ScopedCommandlineArgs scoped_argv(
+      {"--num_concurrent_interpreters=3", "--num_concurrent_threads=1"});
+  auto status = benchmark.Run(scoped_argv.argc(), scoped_argv.argv());
+  EXPECT_EQ(kTfLiteOk, status);
+}
+
+TEST(BenchmarkTest, RunWithInvalidNumConcurrentInterpreters) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  TestBenchmark benchmark(CreateFp32Params());
+  ScopedCommandlineArgs scoped_argv({"--num_concurrent_interpreters=0"});
+  auto status = benchmark.Run(scoped_argv.argc(), scoped_argv.argv());
+  EXPECT_EQ(kTfLiteError, status);
+}
+
+TEST(BenchmarkTest, RunInSustainedMode) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  BenchmarkParams params = BenchmarkTfLiteModel::DefaultParams();
+  InitializeParams(params, /*num_runs=*/1, /*min_secs=*/0.3f,
+                   /*max_secs=*/150.0f);
+  params.Set<float>("sustained_window_secs", 0.1f);
+  TestBenchmark benchmark(std::move(params));
+  EXPECT_EQ(kTfLiteOk, benchmark.Run());
+}
+
+TEST(SustainedPerformanceListenerTest, SplitsRegularRunsIntoWindows) {
+  SustainedPerformanceListener listener(/*window_secs=*/0.02f);
+  // Warmup runs are not recorded.
+  listener.OnSingleRunStart(WARMUP);
+  listener.OnSingleRunEnd();
+  for (int i = 0; i < 6; ++i) {
+    listener.OnSingleRunStart(REGULAR);
+    util::SleepForSeconds(0.01);
+    listener.OnSingleRunEnd();
+  }
+  listener.OnBenchmarkEnd(BenchmarkResults());
+
+  const auto& windows = listener.windows();
+  ASSERT_GE(windows.size(), 2);
+  int64_t num_runs = 0;
+  for (int i = 0; i < windows.size(); ++i) {
+    num_runs += windows[i].num_runs;
+    EXPECT_LE(windows[i].p50_us, windows[i].p90_us);
+    EXPECT_LE(windows[i].p90_us, windows[i].p99_us);
+    EXPECT_LE(windows[i].p99_us, windows[i].max_us);
+    EXPECT_GE(windows[i].p50_us, 10000);
+    if (i > 0) EXPECT_EQ(windows[i - 1].end_us, windows[i].start_us);
+  }
+  EXPECT_EQ(6, num_runs);
+}
+
 TEST(BenchmarkTest, ParametersArePopulatedWhenInputShapeIsNotSpecified) {
   ASSERT_THAT(g_fp32_model_path, testing::NotNull());
 
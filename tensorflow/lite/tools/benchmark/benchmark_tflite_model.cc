@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdlib>
@@ -27,6 +28,7 @@ limitations under the License.
 #include <random>
 #include <sstream>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -49,6 +51,7 @@ limitations under the License.
 #include "tensorflow/lite/op_resolver.h"
 #include "tensorflow/lite/optional_debug_tools.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
+#include "tensorflow/lite/profiling/time.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 #include "tensorflow/lite/tools/benchmark/profiling_listener.h"
@@ -172,6 +175,102 @@ class OutputSaver : public BenchmarkListener {
   const BenchmarkParams* params_ = nullptr;
 };
 
+// An additional interpreter of the benchmarked model that is invoked on a
+// background thread.
+struct BackgroundInterpreter {
+  // Declared before the interpreter so that they're destroyed after it.
+  std::vector<Interpreter::TfLiteDelegatePtr> delegates;
+  std::unique_ptr<Interpreter> interpreter;
+  std::unique_ptr<BenchmarkInterpreterRunner> runner;
+  tensorflow::Stat<int64_t> invoke_time_us;
+  TfLiteStatus status = kTfLiteOk;
+};
+
+// Keeps additional interpreters of the benchmarked model busy while the
+// benchmark runs, so that the reported latency reflects the contention with
+// models running concurrently in the same process. The interpreters are
+// distributed round-robin over `num_threads` threads, each of which invokes its
+// interpreters back-to-back until the benchmark ends.
+class ConcurrentInterpretersRunner : public BenchmarkListener {
+ public:
+  ConcurrentInterpretersRunner(
+      std::vector<std::unique_ptr<BackgroundInterpreter>> interpreters,
+      int num_threads,
+      std::function<void(BenchmarkInterpreterRunner*)> copy_inputs)
+      : interpreters_(std::move(interpreters)),
+        num_threads_(num_threads),
+        copy_inputs_(std::move(copy_inputs)) {}
+
+  ~ConcurrentInterpretersRunner() override { Stop(); }
+
+  void OnBenchmarkStart(const BenchmarkParams& params) override {
+    for (auto& background : interpreters_) {
+      copy_inputs_(background->runner.get());
+    }
+    stop_ = false;
+    for (int i = 0; i < num_threads_; ++i) {
+      threads_.emplace_back([this, i]() { RunThread(i); });
+    }
+  }
+
+  void OnBenchmarkEnd(const BenchmarkResults& results) override {
+    Stop();
+    for (int i = 0; i < interpreters_.size(); ++i) {
+      const BackgroundInterpreter& background = *interpreters_[i];
+      TFLITE_LOG(INFO) << "Concurrent interpreter #" << i + 1 << " (thread "
+                       << i % num_threads_
+                       << "): runs=" << background.invoke_time_us.count()
+                       << " avg=" << background.invoke_time_us.avg()
+                       << "us std=" << background.invoke_time_us.std_deviation()
+                       << "us max=" << background.invoke_time_us.max() << "us";
+      TFLITE_MAY_LOG(ERROR, background.status != kTfLiteOk)
+          << "Concurrent interpreter #" << i + 1 << " failed to invoke.";
+    }
+  }
+
+ private:
+  void RunThread(int thread_index) {
+    bool any_running = true;
+    while (any_running && !stop_.load(std::memory_order_relaxed)) {
+      any_running = false;
+      for (int i = thread_index; i < interpreters_.size(); i += num_threads_) {
+        BackgroundInterpreter& background = *interpreters_[i];
+        if (background.status != kTfLiteOk) continue;
+        any_running = true;
+        const int64_t start_us = profiling::time::NowMicros();
+        background.status = background.runner->Invoke();
+        background.invoke_time_us.UpdateStat(profiling::time::NowMicros() -
+                                             start_us);
+      }
+    }
+  }
+
+  void Stop() {
+    stop_ = true;
+    for (auto& thread : threads_) thread.join();
+    threads_.clear();
+  }
+
+  std::vector<std::unique_ptr<BackgroundInterpreter>> interpreters_;
+  const int num_threads_;
+  std::function<void(BenchmarkInterpreterRunner*)> copy_inputs_;
+  std::atomic<bool> stop_{false};
+  std::vector<std::thread> threads_;
+};
+
+InterpreterOptions CreateInterpreterOptions(const BenchmarkParams& params) {
+  InterpreterOptions options;
+  options.SetEnsureDynamicTensorsAreReleased(
+      params.Get<bool>("release_dynamic_tensors"));
+  options.OptimizeMemoryForLargeTensors(
+      params.Get<int32_t>("optimize_memory_for_large_tensors"));
+  options.SetDisableDelegateClustering(
+      params.Get<bool>("disable_delegate_clustering"));
+  options.SetCacheConstantCastOp(
+      params.Get<bool>("enable_builtin_cast_constant_cache"));
+  return options;
+}
+
 std::vector<std::string> Split(const std::string& str, const char delim) {
   if (str.empty()) {
     return {};
@@ -525,6 +624,10 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<int32_t>(15));
   default_params.AddParam("alloc_type_display_length",
                           BenchmarkParam::Create<int32_t>(18));
+  default_params.AddParam("num_concurrent_interpreters",
+                          BenchmarkParam::Create<int32_t>(1));
+  default_params.AddParam("num_concurrent_threads",
+                          BenchmarkParam::Create<int32_t>(0));
 
   tools::ProvidedDelegateList delegate_providers(&default_params);
   delegate_providers.AddAllDelegateParams();
@@ -643,7 +746,17 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "default signature will be used."),
       CreateFlag<bool>("list_signatures", &params_,
                        "Displays all signatures present in the model and then "
-                       "terminates the program.")};
+                       "terminates the program."),
+      CreateFlag<int32_t>(
+          "num_concurrent_interpreters", &params_,
+          "Total number of interpreters of the model. The extra interpreters "
+          "are invoked continuously on background threads while the first one "
+          "is benchmarked. Each interpreter has its own --num_threads CPU "
+          "thread pool and its own instances of the requested delegates."),
+      CreateFlag<int32_t>(
+          "num_concurrent_threads", &params_,
+          "Number of background threads the extra interpreters are "
+          "distributed over. Defaults to one thread per extra interpreter.")};
 
   flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
 
@@ -706,6 +819,10 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Tensor type display length", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "alloc_type_display_length",
                       "Tensor allocation type display length", verbose);
+  LOG_BENCHMARK_PARAM(int32_t, "num_concurrent_interpreters",
+                      "Num concurrent interpreters", verbose);
+  LOG_BENCHMARK_PARAM(int32_t, "num_concurrent_threads",
+                      "Num concurrent interpreter threads", verbose);
 
   for (const auto& delegate_provider :
        tools::GetRegisteredDelegateProviders()) {
@@ -747,6 +864,11 @@ TfLiteStatus BenchmarkTfLiteModel::ValidateParams() {
     }
   }
 
+  if (params_.Get<int32_t>("num_concurrent_interpreters") < 1) {
+    TFLITE_LOG(ERROR) << "--num_concurrent_interpreters must be at least 1.";
+    return kTfLiteError;
+  }
+
   return PopulateInputLayerInfo(
       params_.Get<std::string>("input_layer"),
       params_.Get<std::string>("input_layer_shape"),
@@ -883,11 +1005,16 @@ TfLiteStatus BenchmarkTfLiteModel::PrepareInputData() {
 }
 
 TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
-  const std::vector<int>& runner_inputs = interpreter_runner_->inputs();
+  CopyInputsTo(interpreter_runner_.get());
+  return kTfLiteOk;
+}
+
+void BenchmarkTfLiteModel::CopyInputsTo(BenchmarkInterpreterRunner* runner) {
+  const std::vector<int>& runner_inputs = runner->inputs();
   // Set the values of the input tensors from inputs_data_.
   for (int j = 0; j < runner_inputs.size(); ++j) {
     int i = runner_inputs[j];
-    TfLiteTensor* t = interpreter_runner_->tensor(i);
+    TfLiteTensor* t = runner->tensor(i);
     if (t->type == kTfLiteString) {
       if (inputs_data_[j].data) {
         static_cast<DynamicBuffer*>(inputs_data_[j].data.get())
@@ -906,8 +1033,6 @@ TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
                   inputs_data_[j].bytes);
     }
   }
-
-  return kTfLiteOk;
 }
 
 TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
@@ -915,15 +1040,7 @@ TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
   const int32_t num_threads = params_.Get<int32_t>("num_threads");
   const bool use_caching = params_.Get<bool>("use_caching");
 
-  InterpreterOptions options;
-  options.SetEnsureDynamicTensorsAreReleased(
-      params_.Get<bool>("release_dynamic_tensors"));
-  options.OptimizeMemoryForLargeTensors(
-      params_.Get<int32_t>("optimize_memory_for_large_tensors"));
-  options.SetDisableDelegateClustering(
-      params_.Get<bool>("disable_delegate_clustering"));
-  options.SetCacheConstantCastOp(
-      params_.Get<bool>("enable_builtin_cast_constant_cache"));
+  InterpreterOptions options = CreateInterpreterOptions(params_);
 
   tflite::InterpreterBuilder builder(*model_, *resolver, &options);
   if (builder.SetNumThreads(num_threads) != kTfLiteOk) {
@@ -1129,6 +1246,82 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
   AddOwnedListener(std::unique_ptr<BenchmarkListener>(
       new OutputSaver(interpreter_runner_.get())));
 
+  return InitConcurrentInterpreters();
+}
+
+TfLiteStatus BenchmarkTfLiteModel::InitConcurrentInterpreters() {
+  const int32_t num_interpreters =
+      params_.Get<int32_t>("num_concurrent_interpreters");
+  if (num_interpreters <= 1) return kTfLiteOk;
+
+  auto resolver = GetOpResolver();
+  InterpreterOptions options = CreateInterpreterOptions(params_);
+  tools::ProvidedDelegateList delegate_providers(&params_);
+  std::vector<std::unique_ptr<BackgroundInterpreter>> interpreters;
+  for (int n = 1; n < num_interpreters; ++n) {
+    auto background = std::make_unique<BackgroundInterpreter>();
+    tflite::InterpreterBuilder builder(*model_, *resolver, &options);
+    if (builder.SetNumThreads(params_.Get<int32_t>("num_threads")) !=
+        kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to set thread number";
+      return kTfLiteError;
+    }
+    builder(&background->interpreter);
+    if (!background->interpreter) {
+      TFLITE_LOG(ERROR) << "Failed to initialize concurrent interpreter #"
+                        << n;
+      return kTfLiteError;
+    }
+    background->interpreter->SetAllowFp16PrecisionForFp32(
+        params_.Get<bool>("allow_fp16"));
+
+    auto status_and_runner = BenchmarkInterpreterRunner::Create(
+        background->interpreter.get(),
+        params_.Get<std::string>("signature_to_run_for"));
+    TF_LITE_ENSURE_STATUS(status_and_runner.first);
+    background->runner = std::move(status_and_runner.second);
+
+    const std::vector<int>& runner_inputs = background->runner->inputs();
+    for (int j = 0; j < inputs_.size(); ++j) {
+      if (background->runner->tensor(runner_inputs[j])->type !=
+          kTfLiteString) {
+        background->runner->ResizeInputTensor(runner_inputs[j],
+                                              inputs_[j].shape);
+      }
+    }
+
+    for (auto& created_delegate :
+         delegate_providers.CreateAllRankedDelegates()) {
+      TfLiteDelegate* delegate = created_delegate.delegate.get();
+      background->delegates.emplace_back(std::move(created_delegate.delegate));
+      if (background->interpreter->ModifyGraphWithDelegate(delegate) !=
+          kTfLiteOk) {
+        TFLITE_LOG(ERROR) << "Failed to apply "
+                          << created_delegate.provider->GetName()
+                          << " delegate to concurrent interpreter #" << n;
+        return kTfLiteError;
+      }
+    }
+
+    if (background->runner->AllocateTensors() != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to allocate tensors of concurrent "
+                           "interpreter #"
+                        << n;
+      return kTfLiteError;
+    }
+    interpreters.push_back(std::move(background));
+  }
+
+  int num_threads = params_.Get<int32_t>("num_concurrent_threads");
+  if (num_threads <= 0 || num_threads > interpreters.size()) {
+    num_threads = interpreters.size();
+  }
+  TFLITE_LOG(INFO) << "Running " << interpreters.size()
+                   << " concurrent interpreter(s) on " << num_threads
+                   << " background thread(s).";
+  AddOwnedListener(std::make_unique<ConcurrentInterpretersRunner>(
+      std::move(interpreters), num_threads,
+      [this](BenchmarkInterpreterRunner* runner) { CopyInputsTo(runner); }));
   return kTfLiteOk;
 }
 
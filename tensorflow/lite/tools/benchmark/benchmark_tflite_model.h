@@ -187,6 +187,11 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   // necessary.
   virtual std::unique_ptr<BenchmarkListener> MayCreateProfilingListener() const;
 
+  // Creates the additional interpreters requested by
+  // --num_concurrent_interpreters, which keep running the model on background
+  // threads while the benchmark runs.
+  TfLiteStatus InitConcurrentInterpreters();
+
   void CleanUp();
 
   utils::InputTensorData LoadInputTensorData(
@@ -203,6 +208,9 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   utils::InputTensorData CreateRandomTensorData(
       const TfLiteTensor& t, const InputLayerInfo* layer_info);
 
+  // Copies the prepared input data into the input tensors of `runner`.
+  void CopyInputsTo(BenchmarkInterpreterRunner* runner);
+
   void AddOwnedListener(std::unique_ptr<BenchmarkListener> listener) {
     if (listener == nullptr) return;
     owned_listeners_.emplace_back(std::move(listener));
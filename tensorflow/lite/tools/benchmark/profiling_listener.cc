@@ -71,6 +71,10 @@ void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
   summarizer_formatter_->HandleOutput(init_summarizer_.GetOutputString(),
                                       run_summarizer_.GetOutputString(),
                                       output_file_path_);
+  const std::string memory_output = run_summarizer_.GetMemoryOutputString();
+  if (!memory_output.empty()) {
+    TFLITE_LOG(INFO) << memory_output;
+  }
 }
 
 }  // namespace benchmark
@@ -17,11 +17,18 @@ from tensorflow.python.data.util import structure
 from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
 
 
-def compress(element):
+def compress(element, codec="snappy", link_bandwidth_bytes_per_second=0):
   """Compress a dataset element.
 
   Args:
     element: A nested structure of types supported by Tensorflow.
+    codec: (Optional.) How to compress the components of the element. One of
+      "snappy", "none", "zstd", "byte_shuffle_zstd", or "autotune". "snappy"
+      compresses all the components together. "autotune" chooses the codec of
+      each component by sampling the elements.
+    link_bandwidth_bytes_per_second: (Optional.) The bandwidth of the link over
+      which the compressed elements are sent, used by "autotune". 0 leaves the
+      estimate up to the runtime.
 
   Returns:
     A variant tensor representing the compressed element. This variant can be
@@ -29,7 +36,10 @@ def compress(element):
   """
   element_spec = structure.type_spec_from_value(element)
   tensor_list = structure.to_tensor_list(element_spec, element)
-  return ged_ops.compress_element(tensor_list)
+  return ged_ops.compress_element(
+      tensor_list,
+      codec=codec,
+      link_bandwidth_bytes_per_second=link_bandwidth_bytes_per_second)
 
 
 def uncompress(element, output_spec):
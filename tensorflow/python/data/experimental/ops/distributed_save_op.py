@@ -78,8 +78,10 @@ def distributed_save(
     data_service_address: tf.data service dispatcher address.
     compression: (Optional.) Whether and how to compress the `dataset` snapshot.
       If `"AUTO"`, the tf.data runtime decides which algorithm to use. If
-      `"GZIP"` or `"SNAPPY"`, that specific algorithm is used.  If `None`, the
-      `dataset` snapshot is not compressed.
+      `"GZIP"` or `"SNAPPY"`, that specific algorithm is used.  If
+      `"COLUMNAR_ZSTD"`, elements are stored in blocks of zstd-compressed
+      columns, which are faster to read when elements have many components or
+      large tensors. If `None`, the `dataset` snapshot is not compressed.
 
   Returns:
     An operation which when executed performs the distributed save.
@@ -16,16 +16,21 @@
 import random
 
 from absl.testing import parameterized
+import numpy as np
 
 from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import bucket_by_sequence_length_op
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.eager import context
 from tensorflow.python.framework import combinations
+from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
 from tensorflow.python.framework import sparse_tensor
 from tensorflow.python.framework import tensor_shape
 from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import string_ops
 from tensorflow.python.platform import test
 
 
@@ -470,6 +475,127 @@ class BucketBySequenceLengthTest(test_base.DatasetTestBase,
     expected_batches = _compute_expected_batches(param_drop_remainder)
     self.assertEqual(batches, expected_batches)
 
+  def _buildParityDataset(self, element_type, lengths):
+    """Returns a dataset of `element_type` elements of the given lengths."""
+    lengths = constant_op.constant(lengths, dtype=dtypes.int32)
+    dataset = dataset_ops.Dataset.range(lengths.shape[0])
+
+    def make_ids(i):
+      return array_ops.fill([lengths[i]], math_ops.cast(i + 1, dtypes.int32))
+
+    if element_type == "tensor":
+      return dataset.map(make_ids)
+    if element_type == "tuple":
+      return dataset.map(lambda i: (  # pylint: disable=g-long-lambda
+          make_ids(i),
+          array_ops.fill([lengths[i], 2], math_ops.cast(i, dtypes.float32)),
+          i))
+    return dataset.map(lambda i: {  # pylint: disable=g-long-lambda
+        "ids": make_ids(i),
+        "tokens": string_ops.as_string(make_ids(i)),
+    })
+
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(
+              element_type=["tensor", "tuple", "dict"], seed=[0, 1, 2])))
+  def testMatchesGroupByWindow(self, element_type, seed):
+    # pylint: disable=protected-access
+    boundaries = [3, 8, 12]
+    batch_sizes = [4, 3, 2, 5]
+    # Includes the lengths at the boundaries and past the last boundary, and
+    # leaves partial batches in several buckets at the end of the input.
+    lengths = np.random.RandomState(seed).randint(0, 16, size=50)
+    kwargs = {}
+    if element_type == "tensor":
+      element_len = lambda ids: array_ops.shape(ids)[0]
+    elif element_type == "tuple":
+      element_len = lambda ids, features, index: array_ops.shape(ids)[0]
+      kwargs = {
+          "padded_shapes": ([16], [None, 2], []),
+          "padding_values": (-1, 0.5, np.int64(0)),
+      }
+    else:
+      element_len = lambda element: array_ops.shape(element["ids"])[0]
+
+    dataset = self._buildParityDataset(element_type, lengths)
+    # The bound is never reached, so only full buckets and the remainders at
+    # the end of the input are emitted.
+    bucketed = dataset.bucket_by_sequence_length(
+        element_length_func=element_len,
+        bucket_boundaries=boundaries,
+        bucket_batch_sizes=batch_sizes,
+        max_buffered_bytes=1 << 30,
+        **kwargs)
+    expected = bucket_by_sequence_length_op._bucket_by_group_by_window(
+        dataset,
+        element_length_func=element_len,
+        bucket_boundaries=boundaries,
+        bucket_batch_sizes=batch_sizes,
+        **kwargs)
+
+    self.assertIsInstance(
+        bucketed, bucket_by_sequence_length_op._BucketBySequenceLengthDataset)
+    self.assertEqual(bucketed.element_spec, expected.element_spec)
+    self.assertDatasetsEqual(bucketed, expected)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testUnboundedUsesGroupByWindow(self):
+    # pylint: disable=protected-access
+    dataset = self._buildParityDataset("tensor", [1, 5, 2])
+    bucketed = dataset.bucket_by_sequence_length(
+        element_length_func=lambda ids: array_ops.shape(ids)[0],
+        bucket_boundaries=[3],
+        bucket_batch_sizes=[2, 2])
+    self.assertNotIsInstance(
+        bucketed, bucket_by_sequence_length_op._BucketBySequenceLengthDataset)
+    self.assertDatasetProduces(
+        bucketed, expected_output=[[[1, 0], [3, 3]], [[2, 2, 2, 2, 2]]])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testMaxWindowAge(self):
+    dataset = self._buildParityDataset("tensor", [1, 6, 6, 6, 6, 6, 6])
+    bucketed = dataset.bucket_by_sequence_length(
+        element_length_func=lambda ids: array_ops.shape(ids)[0],
+        bucket_boundaries=[5],
+        bucket_batch_sizes=[10, 2],
+        max_window_age=2)
+    # The first element is emitted alone once two more elements were read
+    # after it, instead of waiting for the end of the input.
+    batches = self.getDatasetOutput(bucketed)
+    self.assertEqual([list(batch[:, 0]) for batch in batches],
+                     [[2, 3], [1], [4, 5], [6, 7]])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testMaxBufferedBytes(self):
+    dataset = self._buildParityDataset("tensor", [1] * 7)
+    # Each element is a single int32, so a bucket holding three of them
+    # exceeds the bound and is emitted as a partial batch.
+    bucketed = dataset.bucket_by_sequence_length(
+        element_length_func=lambda ids: array_ops.shape(ids)[0],
+        bucket_boundaries=[5],
+        bucket_batch_sizes=[10, 10],
+        max_buffered_bytes=8)
+    self.assertDatasetProduces(
+        bucketed, expected_output=[[[1], [2], [3]], [[4], [5], [6]], [[7]]])
+
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(option=[
+              "pad_to_bucket_boundary", "no_padding", "drop_remainder"
+          ])))
+  def testBoundsRejectUnsupportedOptions(self, option):
+    dataset = self._buildParityDataset("tensor", [1, 5, 2])
+    with self.assertRaisesRegex(ValueError, "do not support"):
+      dataset.bucket_by_sequence_length(
+          element_length_func=lambda ids: array_ops.shape(ids)[0],
+          bucket_boundaries=[3],
+          bucket_batch_sizes=[2, 2],
+          max_window_age=4,
+          **{option: True})
+
   @combinations.generate(test_base.default_test_combinations())
   def testCardinality(self):
 
@@ -0,0 +1,309 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""The implementation of `tf.data.Dataset.bucket_by_sequence_length`."""
+
+import numpy as np
+
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.ops import padded_batch_op
+from tensorflow.python.data.ops import structured_function
+from tensorflow.python.data.util import nest
+from tensorflow.python.data.util import structure
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.framework import smart_cond
+from tensorflow.python.framework import tensor_shape
+from tensorflow.python.framework import tensor_spec
+from tensorflow.python.framework import tensor_util
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import check_ops
+from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
+from tensorflow.python.ops import math_ops
+
+
+def _bucket_by_sequence_length(input_dataset,
+                               element_length_func,
+                               bucket_boundaries,
+                               bucket_batch_sizes,
+                               padded_shapes=None,
+                               padding_values=None,
+                               pad_to_bucket_boundary=False,
+                               no_padding=False,
+                               drop_remainder=False,
+                               max_buffered_bytes=None,
+                               max_window_age=None,
+                               name=None):
+  """See `Dataset.bucket_by_sequence_length()` for details."""
+  if len(bucket_batch_sizes) != (len(bucket_boundaries) + 1):
+    raise ValueError(
+        f"`len(bucket_batch_sizes)` must equal `len(bucket_boundaries) + 1` "
+        f"but `len(bucket_batch_sizes)={len(bucket_batch_sizes)}` and "
+        f"`len(bucket_boundaries)={len(bucket_boundaries)}`.")
+
+  # Without a bound, the graph stays the `Dataset.group_by_window()` one, so
+  # that iterator checkpoints saved by earlier versions can still be restored.
+  if max_buffered_bytes is None and max_window_age is None:
+    return _bucket_by_group_by_window(
+        input_dataset,
+        element_length_func,
+        bucket_boundaries,
+        bucket_batch_sizes,
+        padded_shapes=padded_shapes,
+        padding_values=padding_values,
+        pad_to_bucket_boundary=pad_to_bucket_boundary,
+        no_padding=no_padding,
+        drop_remainder=drop_remainder,
+        name=name)
+
+  if not _can_bucket_natively(input_dataset, bucket_boundaries,
+                              bucket_batch_sizes, pad_to_bucket_boundary,
+                              no_padding, drop_remainder):
+    raise ValueError(
+        "`max_buffered_bytes` and `max_window_age` require dense tensor "
+        "components, strictly increasing `bucket_boundaries`, positive "
+        "`bucket_batch_sizes`, and do not support `pad_to_bucket_boundary`, "
+        "`no_padding` or `drop_remainder`.")
+  length_func = structured_function.StructuredFunctionWrapper(
+      element_length_func,
+      "Dataset.bucket_by_sequence_length()",
+      dataset=input_dataset)
+  length_spec = length_func.output_structure
+  if not any(
+      length_spec.is_compatible_with(tensor_spec.TensorSpec([], dtype))
+      for dtype in (dtypes.int32, dtypes.int64)):
+    raise TypeError(
+        f"`element_length_func` must return a scalar `tf.int32` or `tf.int64` "
+        f"tensor, but its output has type {length_spec}.")
+  if max_buffered_bytes is None:
+    max_buffered_bytes = 0
+  if max_window_age is None:
+    max_window_age = 0
+  return _BucketBySequenceLengthDataset(
+      input_dataset,
+      length_func,
+      bucket_boundaries,
+      bucket_batch_sizes,
+      _make_padded_shapes(
+          padded_shapes or dataset_ops.get_legacy_output_shapes(input_dataset)),
+      padding_values,
+      max_buffered_bytes=max_buffered_bytes,
+      max_window_age=max_window_age,
+      name=name)
+
+
+def _can_bucket_natively(input_dataset, bucket_boundaries, bucket_batch_sizes,
+                         pad_to_bucket_boundary, no_padding, drop_remainder):
+  """Returns whether `_BucketBySequenceLengthDataset` supports the arguments.
+
+  The other arguments need `Dataset.group_by_window()`, which batches each
+  bucket with its own `Dataset.padded_batch()` or `Dataset.batch()`.
+
+  Args:
+    input_dataset: The dataset to bucket.
+    bucket_boundaries: The upper length boundaries of the buckets.
+    bucket_batch_sizes: The batch size of each bucket.
+    pad_to_bucket_boundary: Whether to pad to the bucket boundaries, which
+      needs a padded shape per bucket.
+    no_padding: Whether to batch the buckets without padding.
+    drop_remainder: Whether to drop the partial batches.
+
+  Returns:
+    `True` if the dataset can be bucketed by `_BucketBySequenceLengthDataset`.
+  """
+  if pad_to_bucket_boundary or no_padding:
+    return False
+  try:
+    if smart_cond.smart_constant_value(drop_remainder) is not False:
+      return False
+  except TypeError:
+    return False
+  if not all(
+      isinstance(component_spec, tensor_spec.TensorSpec)
+      for component_spec in nest.flatten(input_dataset.element_spec)):
+    return False
+  bucket_boundaries = list(bucket_boundaries)
+  bucket_batch_sizes = list(bucket_batch_sizes)
+  if not all(
+      isinstance(value, (int, np.integer))
+      for value in bucket_boundaries + bucket_batch_sizes):
+    return False
+  return (all(low < high
+              for low, high in zip(bucket_boundaries, bucket_boundaries[1:]))
+          and all(batch_size > 0 for batch_size in bucket_batch_sizes))
+
+
+def _make_padded_shapes(shapes, none_filler=None):
+  """Returns `shapes` with their unknown dimensions set to `none_filler`."""
+  padded = []
+  for shape in nest.flatten(shapes):
+    shape = tensor_shape.TensorShape(shape)
+    shape = [
+        none_filler if tensor_shape.dimension_value(d) is None else d
+        for d in shape
+    ]
+    padded.append(shape)
+  return nest.pack_sequence_as(shapes, padded)
+
+
+def _bucket_by_group_by_window(input_dataset,
+                               element_length_func,
+                               bucket_boundaries,
+                               bucket_batch_sizes,
+                               padded_shapes=None,
+                               padding_values=None,
+                               pad_to_bucket_boundary=False,
+                               no_padding=False,
+                               drop_remainder=False,
+                               name=None):
+  """Buckets `input_dataset` with `Dataset.group_by_window()`."""
+  batch_sizes = constant_op.constant(bucket_batch_sizes, dtype=dtypes.int64)
+
+  def element_to_bucket_id(*args):
+    """Return int64 id of the length bucket for this element."""
+    seq_length = element_length_func(*args)
+
+    boundaries = list(bucket_boundaries)
+    buckets_min = [np.iinfo(np.int32).min] + boundaries
+    buckets_max = boundaries + [np.iinfo(np.int32).max]
+    conditions_c = math_ops.logical_and(
+        math_ops.less_equal(buckets_min, seq_length),
+        math_ops.less(seq_length, buckets_max))
+    bucket_id = math_ops.reduce_min(array_ops.where(conditions_c))
+
+    return bucket_id
+
+  def window_size_fn(bucket_id):
+    # The window size is set to the batch size for this bucket
+    window_size = batch_sizes[bucket_id]
+    return window_size
+
+  def batching_fn(bucket_id, grouped_dataset):
+    """Batch elements in dataset."""
+    batch_size = window_size_fn(bucket_id)
+    if no_padding:
+      return grouped_dataset.batch(
+          batch_size, drop_remainder=drop_remainder, name=name)
+    none_filler = None
+    if pad_to_bucket_boundary:
+      err_msg = ("When pad_to_bucket_boundary=True, elements must have "
+                 "length < max(bucket_boundaries).")
+      check = check_ops.assert_less(
+          bucket_id,
+          constant_op.constant(
+              len(bucket_batch_sizes) - 1, dtype=dtypes.int64),
+          message=err_msg)
+      with ops.control_dependencies([check]):
+        boundaries = constant_op.constant(
+            bucket_boundaries, dtype=dtypes.int64)
+        bucket_boundary = boundaries[bucket_id]
+        none_filler = bucket_boundary - 1
+    input_shapes = dataset_ops.get_legacy_output_shapes(grouped_dataset)
+    shapes = _make_padded_shapes(
+        padded_shapes or input_shapes, none_filler=none_filler)
+    return grouped_dataset.padded_batch(
+        batch_size,
+        shapes,
+        padding_values,
+        drop_remainder=drop_remainder,
+        name=name)
+
+  return input_dataset.group_by_window(
+      key_func=element_to_bucket_id,
+      reduce_func=batching_fn,
+      window_size_func=window_size_fn,
+      name=name)
+
+
+class _BucketBySequenceLengthDataset(dataset_ops.UnaryDataset):
+  """A `Dataset` that buckets its input by length and pads it into batches."""
+
+  def __init__(self,
+               input_dataset,
+               element_length_func,
+               bucket_boundaries,
+               bucket_batch_sizes,
+               padded_shapes,
+               padding_values,
+               max_buffered_bytes=0,
+               max_window_age=0,
+               name=None):
+    """See `Dataset.bucket_by_sequence_length()` for details."""
+    self._input_dataset = input_dataset
+    self._element_length_func = element_length_func
+    padding_values = padded_batch_op._padding_values_or_default(  # pylint: disable=protected-access
+        padding_values, input_dataset)
+
+    input_shapes = dataset_ops.get_legacy_output_shapes(input_dataset)
+    flat_padded_shapes = nest.flatten_up_to(input_shapes, padded_shapes)
+    flat_padded_shapes_as_tensors = []
+    for input_component_shape, padded_shape in zip(
+        nest.flatten(input_shapes), flat_padded_shapes):
+      flat_padded_shapes_as_tensors.append(
+          padded_batch_op._padded_shape_to_tensor(  # pylint: disable=protected-access
+              padded_shape, input_component_shape))
+    self._padded_shapes = nest.pack_sequence_as(input_shapes,
+                                                flat_padded_shapes_as_tensors)
+
+    # If padding_values is a single element and input_shapes is a structure,
+    # "broadcast" padding_values to the same structure as input_shapes.
+    if nest.is_nested(input_shapes) and not nest.is_nested(padding_values):
+      padding_values = nest.map_structure(lambda _: padding_values,
+                                          input_shapes)
+    self._padding_values = nest.map_structure_up_to(
+        input_shapes,
+        padded_batch_op._padding_value_to_tensor,  # pylint: disable=protected-access
+        padding_values,
+        dataset_ops.get_legacy_output_types(input_dataset))
+
+    # The buckets emit partial batches at the end of the input.
+    output_shapes = nest.map_structure(
+        lambda s: tensor_shape.TensorShape([None]).concatenate(
+            tensor_util.constant_value_as_shape(s)), self._padded_shapes)
+    self._structure = structure.convert_legacy_structure(
+        dataset_ops.get_legacy_output_types(input_dataset), output_shapes,
+        dataset_ops.get_legacy_output_classes(input_dataset))
+
+    self._name = name
+    variant_tensor = ged_ops.bucket_by_sequence_length_dataset(
+        input_dataset._variant_tensor,  # pylint: disable=protected-access
+        self._element_length_func.function.captured_inputs,
+        bucket_boundaries=ops.convert_to_tensor(
+            list(bucket_boundaries), dtype=dtypes.int64),
+        bucket_batch_sizes=ops.convert_to_tensor(
+            list(bucket_batch_sizes), dtype=dtypes.int64),
+        padded_shapes=[
+            ops.convert_to_tensor(s, dtype=dtypes.int64)
+            for s in nest.flatten(self._padded_shapes)
+        ],
+        padding_values=nest.flatten(self._padding_values),
+        max_buffered_bytes=ops.convert_to_tensor(
+            max_buffered_bytes, dtype=dtypes.int64),
+        max_window_age=ops.convert_to_tensor(
+            max_window_age, dtype=dtypes.int64),
+        element_length_func=self._element_length_func.function,
+        output_shapes=structure.get_flat_tensor_shapes(self._structure),
+        metadata=self._metadata.SerializeToString())
+    super().__init__(input_dataset, variant_tensor)
+
+  @property
+  def element_spec(self):
+    return self._structure
+
+  def _functions(self):
+    return [self._element_length_func]
+
+  def _transformation_name(self):
+    return "Dataset.bucket_by_sequence_length()"
@@ -43,7 +43,6 @@ from tensorflow.python.eager import wrap_function
 from tensorflow.python.framework import auto_control_deps
 from tensorflow.python.framework import auto_control_deps_utils as acd_utils
 from tensorflow.python.framework import composite_tensor
-from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import function
 from tensorflow.python.framework import none_tensor
@@ -55,7 +54,6 @@ from tensorflow.python.framework import tensor_spec
 from tensorflow.python.framework import tensor_util
 from tensorflow.python.framework import type_spec
 from tensorflow.python.ops import array_ops
-from tensorflow.python.ops import check_ops
 from tensorflow.python.ops import cond
 from tensorflow.python.ops import control_flow_assert
 from tensorflow.python.ops import gen_dataset_ops
@@ -3079,6 +3077,8 @@ name=None))
       pad_to_bucket_boundary=False,
       no_padding=False,
       drop_remainder=False,
+      max_buffered_bytes=None,
+      max_window_age=None,
       name=None,
   ) -> "DatasetV2":
     """A transformation that buckets elements in a `Dataset` by length.
@@ -3136,87 +3136,48 @@ name=None))
         whether the last batch should be dropped in the case it has fewer than
         `batch_size` elements; the default behavior is not to drop the smaller
         batch.
+      max_buffered_bytes: (Optional.) A `tf.int64` scalar, the number of bytes
+        of input elements that the buckets may hold. When they hold more, the
+        largest bucket is emitted as a partial batch. If set to
+        `tf.data.AUTOTUNE`, the bound is derived from the tf.data RAM budget.
+        Defaults to no bound.
+      max_window_age: (Optional.) A `tf.int64` scalar. A bucket whose oldest
+        element was read more than `max_window_age` input elements ago is
+        emitted as a partial batch. Defaults to no bound.
       name: (Optional.) A name for the tf.data operation.
 
+    Setting `max_buffered_bytes` or `max_window_age` builds a different dataset
+    graph than leaving both unset, so iterator checkpoints saved with one
+    cannot be restored with the other. The bounds do not support
+    `pad_to_bucket_boundary`, `no_padding` or `drop_remainder`.
+
     Returns:
       A new `Dataset` with the transformation applied as described above.
 
     Raises:
-      ValueError: if `len(bucket_batch_sizes) != len(bucket_boundaries) + 1`.
+      ValueError: if `len(bucket_batch_sizes) != len(bucket_boundaries) + 1`,
+        or if a bound is set together with arguments that it does not support.
+      TypeError: if a bound is set and `element_length_func` does not return a
+        scalar `tf.int32` or `tf.int64` tensor.
     """
-    if len(bucket_batch_sizes) != (len(bucket_boundaries) + 1):
-      raise ValueError(
-          f"`len(bucket_batch_sizes)` must equal `len(bucket_boundaries) + 1` "
-          f"but `len(bucket_batch_sizes)={len(bucket_batch_sizes)}` and "
-          f"`len(bucket_boundaries)={len(bucket_boundaries)}`.")
-
-    batch_sizes = constant_op.constant(bucket_batch_sizes, dtype=dtypes.int64)
-
-    def element_to_bucket_id(*args):
-      """Return int64 id of the length bucket for this element."""
-      seq_length = element_length_func(*args)
-
-      boundaries = list(bucket_boundaries)
-      buckets_min = [np.iinfo(np.int32).min] + boundaries
-      buckets_max = boundaries + [np.iinfo(np.int32).max]
-      conditions_c = math_ops.logical_and(
-          math_ops.less_equal(buckets_min, seq_length),
-          math_ops.less(seq_length, buckets_max))
-      bucket_id = math_ops.reduce_min(array_ops.where(conditions_c))
-
-      return bucket_id
-
-    def window_size_fn(bucket_id):
-      # The window size is set to the batch size for this bucket
-      window_size = batch_sizes[bucket_id]
-      return window_size
-
-    def make_padded_shapes(shapes, none_filler=None):
-      padded = []
-      for shape in nest.flatten(shapes):
-        shape = tensor_shape.TensorShape(shape)
-        shape = [
-            none_filler if tensor_shape.dimension_value(d) is None else d
-            for d in shape
-        ]
-        padded.append(shape)
-      return nest.pack_sequence_as(shapes, padded)
-
-    def batching_fn(bucket_id, grouped_dataset):
-      """Batch elements in dataset."""
-      batch_size = window_size_fn(bucket_id)
-      if no_padding:
-        return grouped_dataset.batch(
-            batch_size, drop_remainder=drop_remainder, name=name)
-      none_filler = None
-      if pad_to_bucket_boundary:
-        err_msg = ("When pad_to_bucket_boundary=True, elements must have "
-                   "length < max(bucket_boundaries).")
-        check = check_ops.assert_less(
-            bucket_id,
-            constant_op.constant(
-                len(bucket_batch_sizes) - 1, dtype=dtypes.int64),
-            message=err_msg)
-        with ops.control_dependencies([check]):
-          boundaries = constant_op.constant(
-              bucket_boundaries, dtype=dtypes.int64)
-          bucket_boundary = boundaries[bucket_id]
-          none_filler = bucket_boundary - 1
-      input_shapes = get_legacy_output_shapes(grouped_dataset)
-      shapes = make_padded_shapes(
-          padded_shapes or input_shapes, none_filler=none_filler)
-      return grouped_dataset.padded_batch(
-          batch_size,
-          shapes,
-          padding_values,
-          drop_remainder=drop_remainder,
-          name=name)
-
-    return self.group_by_window(
-        key_func=element_to_bucket_id,
-        reduce_func=batching_fn,
-        window_size_func=window_size_fn,
+    # Loaded lazily due to a circular dependency (
+    # dataset_ops -> bucket_by_sequence_length_op -> dataset_ops).
+    # pylint: disable=g-import-not-at-top,protected-access
+    from tensorflow.python.data.ops import bucket_by_sequence_length_op
+    return bucket_by_sequence_length_op._bucket_by_sequence_length(
+        self,
+        element_length_func,
+        bucket_boundaries,
+        bucket_batch_sizes,
+        padded_shapes=padded_shapes,
+        padding_values=padding_values,
+        pad_to_bucket_boundary=pad_to_bucket_boundary,
+        no_padding=no_padding,
+        drop_remainder=drop_remainder,
+        max_buffered_bytes=max_buffered_bytes,
+        max_window_age=max_window_age,
         name=name)
+    # pylint: enable=g-import-not-at-top,protected-access
 
   @staticmethod
   def random(
@@ -45,12 +45,17 @@ class AutotuneAlgorithm(enum.Enum):
 
   STAGE_BASED: In each optimization step, this algorithm chooses the worst
   bottleneck parameter and increases its value by 1.
+
+  COST_BASED: In each optimization step, this algorithm chooses the parallelism
+  or buffer size parameter with the largest decrease in output time per unit of
+  CPU and RAM budget used, and increases its value by 1.
   """
   DEFAULT = 0
   HILL_CLIMB = 1
   GRADIENT_DESCENT = 2
   MAX_PARALLELISM = 3
   STAGE_BASED = 4
+  COST_BASED = 5
 
   @classmethod
   def _to_proto(cls, obj):
@@ -64,9 +69,12 @@ class AutotuneAlgorithm(enum.Enum):
       return model_pb2.AutotuneAlgorithm.MAX_PARALLELISM
     if obj == cls.STAGE_BASED:
       return model_pb2.AutotuneAlgorithm.STAGE_BASED
+    if obj == cls.COST_BASED:
+      return model_pb2.AutotuneAlgorithm.COST_BASED
     raise ValueError(
         f"Invalid `obj.` Supported values include `DEFAULT`, `HILL_CLIMB` "
-        f"`GRADIENT_DESCENT`, and `STAGE_BASED`. Got {obj.name}.")
+        f"`GRADIENT_DESCENT`, `STAGE_BASED` and `COST_BASED`. "
+        f"Got {obj.name}.")
 
   @classmethod
   def _from_proto(cls, pb):
@@ -80,9 +88,11 @@ class AutotuneAlgorithm(enum.Enum):
       return cls.MAX_PARALLELISM
     if pb == model_pb2.AutotuneAlgorithm.STAGE_BASED:
       return cls.STAGE_BASED
+    if pb == model_pb2.AutotuneAlgorithm.COST_BASED:
+      return cls.COST_BASED
     raise ValueError(
         f"Invalid `pb.` Supported values include `DEFAULT`, `HILL_CLIMB`, "
-        f"`GRADIENT_DESCENT` and `STAGE_BASED`. Got {pb}.")
+        f"`GRADIENT_DESCENT`, `STAGE_BASED` and `COST_BASED`. Got {pb}.")
 
 
 @tf_export("data.experimental.AutoShardPolicy")
@@ -0,0 +1,114 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Compares two JSON outputs of a C++ kernel benchmark binary.
+
+The inputs are the files written by a benchmark binary run with
+`--benchmark_format=json --benchmark_out=<file>`, e.g.
+//tensorflow/core/kernels:production_kernels_benchmark_test. For every
+benchmark present in both runs the tool prints the relative change of the
+selected time metric, and exits with a non-zero status if any benchmark got
+slower by more than `--threshold`.
+
+Usage:
+  compare_kernel_benchmarks --baseline=before.json --contender=after.json
+"""
+
+import json
+
+from absl import app
+from absl import flags
+
+_BASELINE = flags.DEFINE_string(
+    "baseline", None, "JSON benchmark output of the reference run.")
+_CONTENDER = flags.DEFINE_string(
+    "contender", None, "JSON benchmark output of the run to check.")
+_METRIC = flags.DEFINE_enum(
+    "metric", "cpu_time", ["cpu_time", "real_time"],
+    "Per-iteration time metric to compare.")
+_THRESHOLD = flags.DEFINE_float(
+    "threshold", 0.05,
+    "Relative slowdown above which a benchmark counts as a regression.")
+
+
+def load_benchmarks(path, metric):
+  """Returns a map from benchmark name to its per-iteration `metric`.
+
+  When a benchmark was repeated, aggregate entries are ignored and the median
+  of the repetitions is used.
+  """
+  with open(path) as f:
+    data = json.load(f)
+  samples = {}
+  for benchmark in data.get("benchmarks", []):
+    if benchmark.get("run_type") == "aggregate":
+      continue
+    if "error_occurred" in benchmark and benchmark["error_occurred"]:
+      continue
+    name = benchmark.get("run_name", benchmark["name"])
+    samples.setdefault(name, []).append(float(benchmark[metric]))
+  result = {}
+  for name, values in samples.items():
+    values.sort()
+    result[name] = values[len(values) // 2]
+  return result
+
+
+def compare(baseline, contender, threshold):
+  """Returns rows (name, baseline, contender, change) and the regressed names.
+
+  `change` is the relative change of the contender time over the baseline
+  time; positive values mean the contender is slower.
+  """
+  rows = []
+  regressions = []
+  for name in sorted(baseline.keys() & contender.keys()):
+    base = baseline[name]
+    new = contender[name]
+    change = (new - base) / base if base > 0 else 0.0
+    rows.append((name, base, new, change))
+    if change > threshold:
+      regressions.append(name)
+  return rows, regressions
+
+
+def main(argv):
+  del argv  # Unused.
+  if not _BASELINE.value or not _CONTENDER.value:
+    raise app.UsageError("Both --baseline and --contender are required.")
+  baseline = load_benchmarks(_BASELINE.value, _METRIC.value)
+  contender = load_benchmarks(_CONTENDER.value, _METRIC.value)
+  rows, regressions = compare(baseline, contender, _THRESHOLD.value)
+
+  name_width = max([len(row[0]) for row in rows] + [len("Benchmark")])
+  print("%-*s %14s %14s %9s" %
+        (name_width, "Benchmark", "Baseline", "Contender", "Change"))
+  for name, base, new, change in rows:
+    marker = "  <-- regression" if name in regressions else ""
+    print("%-*s %14.1f %14.1f %+8.1f%%%s" %
+          (name_width, name, base, new, change * 100, marker))
+  for name in sorted(baseline.keys() - contender.keys()):
+    print("%s: missing from contender run" % name)
+  for name in sorted(contender.keys() - baseline.keys()):
+    print("%s: missing from baseline run" % name)
+
+  if regressions:
+    print("%d of %d benchmarks regressed by more than %.1f%%." %
+          (len(regressions), len(rows), _THRESHOLD.value * 100))
+    return 1
+  return 0
+
+
+if __name__ == "__main__":
+  app.run(main)
@@ -28,7 +28,7 @@ limitations under the License.
 namespace tsl {
 
 string AllocatorStats::DebugString() const {
-  return strings::Printf(
+  string result = strings::Printf(
       "Limit:            %20lld\n"
       "InUse:            %20lld\n"
       "MaxInUse:         %20lld\n"
@@ -45,6 +45,15 @@ string AllocatorStats::DebugString() const {
       static_cast<long long>(this->bytes_reserved),
       static_cast<long long>(this->peak_bytes_reserved),
       static_cast<long long>(this->largest_free_block_bytes));
+  if (this->thread_cache_hits || this->thread_cache_misses) {
+    strings::Appendf(
+        &result,
+        "ThreadCacheHits:  %20lld\n"
+        "ThreadCacheMisses:%20lld\n",
+        static_cast<long long>(this->thread_cache_hits.value_or(0)),
+        static_cast<long long>(this->thread_cache_misses.value_or(0)));
+  }
+  return result;
 }
 
 constexpr size_t Allocator::kAllocatorAlignment;
@@ -93,6 +93,11 @@ struct AllocatorStats {
   std::optional<int64_t> pool_bytes;
   std::optional<int64_t> peak_pool_bytes;
 
+  // Number of allocations served from, and not found in, the thread-local
+  // caches of allocators that have them.
+  std::optional<int64_t> thread_cache_hits;
+  std::optional<int64_t> thread_cache_misses;
+
   AllocatorStats()
       : num_allocs(0),
         bytes_in_use(0),
@@ -17,12 +17,15 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "tsl/framework/allocator_retry.h"
 #include "tsl/lib/core/bits.h"
+#include "tsl/platform/cpu_info.h"
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/mutex.h"
@@ -39,6 +42,20 @@ namespace tsl {
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 
+struct BFCAllocator::ThreadCache {
+  mutex mu;
+  // Free chunks indexed by rounded size / kMinAllocationSize - 1.
+  std::vector<std::vector<void*>> free_chunks TF_GUARDED_BY(mu);
+  // The sum of the rounded sizes of the chunks in `free_chunks`.
+  size_t bytes TF_GUARDED_BY(mu) = 0;
+};
+
+struct BFCAllocator::CachedAllocationShard {
+  mutex mu;
+  absl::flat_hash_map<const void*, CachedAllocation> allocations
+      TF_GUARDED_BY(mu);
+};
+
 BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
                            size_t total_memory, const string& name,
                            const Options& opts)
@@ -57,6 +74,8 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
     curr_region_allocation_bytes_ = RoundedBytes(total_memory);
   }
 
+  allocation_history_.resize(opts.allocation_history_size);
+
   // Initially, we have not allocated any memory from the sub-allocator; our
   // pool of memory is empty.
   stats_.pool_bytes = 0;
@@ -84,6 +103,23 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  if (opts.enable_thread_cache) {
+    const int num_caches = std::max(1, port::MaxParallelism());
+    VLOG(1) << "Creating " << num_caches << " thread caches of up to "
+            << strings::HumanReadableNumBytes(opts.thread_cache_bytes);
+    for (int i = 0; i < num_caches; ++i) {
+      auto cache = std::make_unique<ThreadCache>();
+      {
+        mutex_lock l(cache->mu);
+        cache->free_chunks.resize(kMaxThreadCacheChunkBytes /
+                                  kMinAllocationSize);
+      }
+      thread_caches_.push_back(std::move(cache));
+      cached_allocation_shards_.push_back(
+          std::make_unique<CachedAllocationShard>());
+    }
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
@@ -256,9 +292,121 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
   }
 }
 
+BFCAllocator::ThreadCache* BFCAllocator::CurrentThreadCache() {
+  static std::atomic<int> next_thread_index{0};
+  thread_local const int thread_index =
+      next_thread_index.fetch_add(1, std::memory_order_relaxed);
+  return thread_caches_[thread_index % thread_caches_.size()].get();
+}
+
+BFCAllocator::CachedAllocationShard* BFCAllocator::ShardForPtr(
+    const void* ptr) const {
+  const uintptr_t index =
+      reinterpret_cast<uintptr_t>(ptr) >> kMinAllocationBits;
+  return cached_allocation_shards_[index % cached_allocation_shards_.size()]
+      .get();
+}
+
+void* BFCAllocator::AllocateFromThreadCache(size_t rounded_bytes,
+                                            size_t num_bytes) {
+  ThreadCache* cache = CurrentThreadCache();
+  void* ptr;
+  {
+    mutex_lock l(cache->mu);
+    std::vector<void*>& free_chunks =
+        cache->free_chunks[rounded_bytes / kMinAllocationSize - 1];
+    if (free_chunks.empty()) {
+      return nullptr;
+    }
+    ptr = free_chunks.back();
+    free_chunks.pop_back();
+    cache->bytes -= rounded_bytes;
+  }
+  thread_cache_bytes_.fetch_sub(rounded_bytes, std::memory_order_relaxed);
+  AddCachedAllocation(ptr, rounded_bytes, num_bytes);
+  return ptr;
+}
+
+void BFCAllocator::AddCachedAllocation(void* ptr, size_t rounded_bytes,
+                                       size_t num_bytes) {
+  CachedAllocationShard* shard = ShardForPtr(ptr);
+  mutex_lock l(shard->mu);
+  shard->allocations[ptr] = {rounded_bytes, num_bytes};
+}
+
+bool BFCAllocator::DeallocateToThreadCache(void* ptr) {
+  CachedAllocation allocation;
+  {
+    CachedAllocationShard* shard = ShardForPtr(ptr);
+    mutex_lock l(shard->mu);
+    auto it = shard->allocations.find(ptr);
+    if (it == shard->allocations.end()) {
+      return false;
+    }
+    allocation = it->second;
+    shard->allocations.erase(it);
+  }
+  // Chunks freed with a timestamp must go through the bins.
+  if (timing_counter_ != nullptr) {
+    return false;
+  }
+  ThreadCache* cache = CurrentThreadCache();
+  {
+    mutex_lock l(cache->mu);
+    if (cache->bytes + allocation.rounded_bytes > opts_.thread_cache_bytes) {
+      return false;
+    }
+    cache->free_chunks[allocation.rounded_bytes / kMinAllocationSize - 1]
+        .push_back(ptr);
+    cache->bytes += allocation.rounded_bytes;
+  }
+  thread_cache_bytes_.fetch_add(allocation.rounded_bytes,
+                                std::memory_order_relaxed);
+  return true;
+}
+
+bool BFCAllocator::DrainThreadCaches() {
+  bool drained = false;
+  for (const auto& cache : thread_caches_) {
+    std::vector<void*> ptrs;
+    {
+      mutex_lock l(cache->mu);
+      for (std::vector<void*>& free_chunks : cache->free_chunks) {
+        ptrs.insert(ptrs.end(), free_chunks.begin(), free_chunks.end());
+        free_chunks.clear();
+      }
+      thread_cache_bytes_.fetch_sub(cache->bytes, std::memory_order_relaxed);
+      cache->bytes = 0;
+    }
+    for (void* ptr : ptrs) {
+      DeallocateRawLocked(ptr);
+    }
+    drained |= !ptrs.empty();
+  }
+  if (drained) {
+    VLOG(1) << "Returned the chunks held by the thread caches of " << Name()
+            << " to the bins.";
+  }
+  return drained;
+}
+
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
+  const bool use_thread_cache =
+      !thread_caches_.empty() && num_bytes > 0 &&
+      num_bytes <= kMaxThreadCacheChunkBytes &&
+      allocation_attr.freed_by_func == nullptr && timing_counter_ == nullptr;
+  if (use_thread_cache) {
+    void* ptr = AllocateFromThreadCache(RoundedBytes(num_bytes), num_bytes);
+    if (ptr != nullptr) {
+      thread_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+      VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << ptr
+              << " (thread cache)";
+      return ptr;
+    }
+    thread_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+  }
   void* result = [&] {
     if (!opts_.allow_retry_on_failure || !allocation_attr.retry_on_failure) {
       // If we have globally disabled retry-on-failure and fail to allocate an
@@ -305,6 +453,9 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                           allocation_attr);
     }
   }();
+  if (use_thread_cache && result != nullptr) {
+    AddCachedAllocation(result, RoundedBytes(num_bytes), num_bytes);
+  }
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << result;
   VLOG(4) << "[mem-debug] AllocateRaw," << Name() << "," << num_bytes << ","
           << result << "," << tsl::CurrentStackTrace();
@@ -447,6 +598,16 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // The chunks held by the thread caches may coalesce into a chunk that is
+  // large enough.
+  if (DrainThreadCaches()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   if ((freed_before == 0) && (!timestamped_chunks_.empty())) {
     // We're unable to satisfy an allocation request without a specific
     // timestamp requirement.  Rather than fail, try merging any held-out
@@ -512,6 +673,63 @@ double BFCAllocator::GetFragmentation() {
          bytes_available;
 }
 
+void BFCAllocator::RecordAllocationEvent(int64_t allocated_bytes,
+                                         int64_t requested_bytes) {
+  if (allocation_history_.empty()) {
+    return;
+  }
+  AllocationEvent& event =
+      allocation_history_[num_allocation_events_ % allocation_history_.size()];
+  const auto& annotation =
+      tsl::profiler::ScopedMemoryDebugAnnotation::CurrentAnnotation();
+  event.action_count = num_allocation_events_++;
+  event.step_id = annotation.pending_step_id;
+  // Copied, since the annotation does not own the name. Assigning reuses the
+  // capacity of the string, so this does not allocate in steady state.
+  if (annotation.pending_op_name != nullptr) {
+    event.op_name.assign(annotation.pending_op_name);
+  } else {
+    event.op_name.clear();
+  }
+  event.allocated_bytes = allocated_bytes;
+  event.requested_bytes = requested_bytes;
+  event.bytes_in_use = stats_.bytes_in_use;
+}
+
+void BFCAllocator::RecordAllocationHistory(tensorflow::MemoryDump* md) {
+  const uint64 history_size = allocation_history_.size();
+  const uint64 num_events = std::min(num_allocation_events_, history_size);
+  absl::flat_hash_map<int64_t, tensorflow::StepMemory*> step_by_id;
+  for (uint64 i = num_allocation_events_ - num_events;
+       i < num_allocation_events_; ++i) {
+    const AllocationEvent& event = allocation_history_[i % history_size];
+    tensorflow::AllocationEvent* ae = md->add_allocation_event();
+    ae->set_action_count(event.action_count);
+    ae->set_step_id(event.step_id);
+    ae->set_op_name(event.op_name);
+    ae->set_allocated_bytes(event.allocated_bytes);
+    ae->set_requested_bytes(event.requested_bytes);
+    ae->set_bytes_in_use(event.bytes_in_use);
+
+    tensorflow::StepMemory*& step = step_by_id[event.step_id];
+    if (step == nullptr) {
+      step = md->add_step_memory();
+      step->set_step_id(event.step_id);
+      // Events of steps that started before the oldest recorded event may
+      // have been overwritten.
+      step->set_truncated(num_allocation_events_ > history_size &&
+                          step_by_id.size() == 1);
+    }
+    step->set_peak_bytes_in_use(
+        std::max(step->peak_bytes_in_use(), event.bytes_in_use));
+    if (event.allocated_bytes >= 0) {
+      step->set_num_allocs(step->num_allocs() + 1);
+    } else {
+      step->set_num_deallocs(step->num_deallocs() + 1);
+    }
+  }
+}
+
 void BFCAllocator::AddTraceMe(absl::string_view traceme_name, const void* ptr) {
   BFCAllocator::Chunk* chunk = ChunkFromHandle(region_manager_.get_handle(ptr));
   AddTraceMe(traceme_name, chunk->ptr, chunk->requested_size, chunk->size);
@@ -606,6 +824,7 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
             std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
+        RecordAllocationEvent(chunk->size, num_bytes);
 
 #ifdef TENSORFLOW_MEM_DEBUG
         if (ShouldRecordOpName()) {
@@ -684,6 +903,10 @@ void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(4) << "[mem-debug] DeallocateRaw," << Name() << ","
           << (ptr ? RequestedSize(ptr) : 0) << "," << ptr << ","
           << tsl::CurrentStackTrace();
+  if (!thread_caches_.empty() && ptr != nullptr &&
+      DeallocateToThreadCache(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -694,7 +917,10 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     return;
   }
   mutex_lock l(lock_);
+  DeallocateRawLocked(ptr);
+}
 
+void BFCAllocator::DeallocateRawLocked(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -806,6 +1032,7 @@ void BFCAllocator::MarkFree(BFCAllocator::ChunkHandle h) {
 
   // Updates the stats.
   stats_.bytes_in_use -= c->size;
+  RecordAllocationEvent(-static_cast<int64_t>(c->size), c->requested_size);
 
 #ifdef TENSORFLOW_MEM_DEBUG
   if (ShouldRecordOpName()) {
@@ -937,6 +1164,16 @@ bool BFCAllocator::TracksAllocationSizes() const { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(ptr);
+  if (!thread_caches_.empty()) {
+    // The chunk may have been reused from a thread cache, in which case its
+    // requested_size is out of date.
+    CachedAllocationShard* shard = ShardForPtr(ptr);
+    mutex_lock l(shard->mu);
+    auto it = shard->allocations.find(ptr);
+    if (it != shard->allocations.end()) {
+      return it->second.requested_bytes;
+    }
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -1112,6 +1349,20 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
             << " curr_region_allocation_bytes_: "
             << curr_region_allocation_bytes_;
   LOG(INFO) << "Stats: \n" << stats_.DebugString();
+
+  if (num_allocation_events_ > 0) {
+    tensorflow::MemoryDump md;
+    RecordAllocationHistory(&md);
+    LOG(INFO) << "Peak memory of the " << md.step_memory_size()
+              << " most recent steps: ";
+    for (const tensorflow::StepMemory& step : md.step_memory()) {
+      LOG(INFO) << "Step " << step.step_id() << ": "
+                << strings::HumanReadableNumBytes(step.peak_bytes_in_use())
+                << " peak in use, " << step.num_allocs() << " allocations, "
+                << step.num_deallocs() << " deallocations"
+                << (step.truncated() ? " (truncated)" : "");
+    }
+  }
 }
 
 void BFCAllocator::MaybeWriteMemoryMap() {
@@ -1163,6 +1414,11 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
     bs->set_total_bytes_in_bin(bin_info.total_bytes_in_bin);
     bs->set_total_chunks_in_use(bin_info.total_chunks_in_use);
     bs->set_total_chunks_in_bin(bin_info.total_chunks_in_bin);
+    bs->set_total_requested_bytes_in_use(bin_info.total_requested_bytes_in_use);
+    if (!b->free_chunks.empty()) {
+      bs->set_largest_free_chunk_bytes(
+          ChunkFromHandle(*b->free_chunks.rbegin())->size);
+    }
   }
 
   // Record state of every defined Chunk.
@@ -1190,6 +1446,8 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
   mas->set_fragmentation_metric(GetFragmentation());
 
+  RecordAllocationHistory(&md);
+
 #ifdef TENSORFLOW_MEM_DEBUG
   // Record the recent size history
   int history_len = static_cast<int>(std::min(
@@ -1207,11 +1465,26 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  if (thread_caches_.empty()) {
+    return stats_;
+  }
+  // Chunks held by the thread caches are in use as far as the bins are
+  // concerned. They are accounted at their rounded size, so `bytes_in_use` may
+  // still include the unused tail of a cached chunk that was not split.
+  AllocatorStats stats = stats_;
+  const int64_t hits = thread_cache_hits_.load(std::memory_order_relaxed);
+  stats.num_allocs += hits;
+  stats.bytes_in_use -= thread_cache_bytes_.load(std::memory_order_relaxed);
+  stats.thread_cache_hits = hits;
+  stats.thread_cache_misses =
+      thread_cache_misses_.load(std::memory_order_relaxed);
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
   mutex_lock l(lock_);
+  thread_cache_hits_.store(0, std::memory_order_relaxed);
+  thread_cache_misses_.store(0, std::memory_order_relaxed);
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
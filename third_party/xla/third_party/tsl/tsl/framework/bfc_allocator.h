@@ -69,6 +69,21 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If true, freed chunks of up to `kMaxThreadCacheChunkBytes` are kept in
+    // per-thread caches, and reused for requests of the same rounded size
+    // without acquiring the allocator lock. Cached chunks are returned to the
+    // bins when the allocator runs out of memory. Not used for requests with
+    // `AllocationAttributes::freed_by_func`, or once a timing counter is set.
+    bool enable_thread_cache = false;
+
+    // The maximum number of bytes held by each thread cache.
+    size_t thread_cache_bytes = 4 << 20;
+
+    // The number of recent allocation events, tagged with the op name and
+    // step id of the current ScopedMemoryDebugAnnotation, that are kept for
+    // RecordMemoryMap() and the out-of-memory log. 0 disables the history.
+    size_t allocation_history_size = 1024;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -120,6 +135,30 @@ class BFCAllocator : public Allocator {
       const AllocationAttributes& allocation_attr);
 
   void DeallocateRawInternal(void* ptr);
+  void DeallocateRawLocked(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // A cache of free chunks, grouped by rounded size, that is shared by the
+  // threads mapped to it.
+  struct ThreadCache;
+  // The size class and requested size of an in-use chunk that is eligible for
+  // the thread caches.
+  struct CachedAllocation {
+    size_t rounded_bytes;
+    size_t requested_bytes;
+  };
+  // The eligible in-use chunks, sharded by address.
+  struct CachedAllocationShard;
+
+  ThreadCache* CurrentThreadCache();
+  CachedAllocationShard* ShardForPtr(const void* ptr) const;
+  void* AllocateFromThreadCache(size_t rounded_bytes, size_t num_bytes);
+  // Records that `ptr` was handed out for a request of `num_bytes`.
+  void AddCachedAllocation(void* ptr, size_t rounded_bytes, size_t num_bytes);
+  // Returns true if `ptr` was kept in a thread cache instead of being freed.
+  bool DeallocateToThreadCache(void* ptr);
+  // Returns all chunks held in the thread caches to the bins. Returns true if
+  // any chunk was returned.
+  bool DrainThreadCaches() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
@@ -278,6 +317,9 @@ class BFCAllocator : public Allocator {
   static constexpr size_t kMinAllocationBits = 8;
   static constexpr size_t kMinAllocationSize = 1 << kMinAllocationBits;
 
+  // The largest rounded size of the chunks kept in the thread caches.
+  static constexpr size_t kMaxThreadCacheChunkBytes = 64 << 10;
+
   // BFCAllocator allocates memory into a collection of disjoint
   // AllocationRegions.  Each AllocationRegion corresponds to one call to
   // SubAllocator::Alloc().  (Actually, if a subsequent call to
@@ -519,6 +561,25 @@ class BFCAllocator : public Allocator {
   // size over total free memory, and returns a value within [0, 1].
   double GetFragmentation() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // An entry of the allocation history.
+  struct AllocationEvent {
+    uint64 action_count = 0;
+    int64_t step_id = 0;
+    string op_name;
+    int64_t allocated_bytes = 0;
+    int64_t requested_bytes = 0;
+    int64_t bytes_in_use = 0;
+  };
+
+  // Appends an event to the allocation history, after stats_ was updated.
+  void RecordAllocationEvent(int64_t allocated_bytes, int64_t requested_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Adds the allocation history, and the per-step usage derived from it, to
+  // `md`.
+  void RecordAllocationHistory(tensorflow::MemoryDump* md)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Information about a Bin that is useful for debugging.
   struct BinDebugInfo {
     size_t total_bytes_in_use = 0;
@@ -572,6 +633,16 @@ class BFCAllocator : public Allocator {
 
   std::atomic<uint64> safe_frontier_ = {0};
 
+  // Non-empty iff `opts_.enable_thread_cache` is true. Each thread uses one
+  // of `thread_caches_`, and the eligible in-use chunks are recorded in
+  // `cached_allocation_shards_`.
+  std::vector<std::unique_ptr<ThreadCache>> thread_caches_;
+  std::vector<std::unique_ptr<CachedAllocationShard>> cached_allocation_shards_;
+  // The total number of bytes held by the thread caches.
+  std::atomic<int64_t> thread_cache_bytes_{0};
+  std::atomic<int64_t> thread_cache_hits_{0};
+  std::atomic<int64_t> thread_cache_misses_{0};
+
   // Structures mutable after construction
   mutable mutex lock_;
   RegionManager region_manager_ TF_GUARDED_BY(lock_);
@@ -587,6 +658,11 @@ class BFCAllocator : public Allocator {
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+
+  // A ring buffer of the most recent allocation events, and the total number
+  // of events recorded.
+  std::vector<AllocationEvent> allocation_history_ TF_GUARDED_BY(lock_);
+  uint64 num_allocation_events_ TF_GUARDED_BY(lock_) = 0;
 #ifdef TENSORFLOW_MEM_DEBUG
   int64 action_counter_ TF_GUARDED_BY(lock_) = 0;
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
@@ -152,6 +152,12 @@ class ServingDeviceSelector {
   virtual DeviceReservation ReserveDevice(
       absl::string_view program_fingerprint) = 0;
 
+  // Helper to estimate the time until the core becomes idle in nanoseconds.
+  // Only considers queues with priority at least as high as 'priority'.
+  static int64_t EstimateTimeTillIdleNs(const DeviceState& device_state,
+                                        int32_t priority, int64_t min_exec_time,
+                                        int64_t now_ns);
+
  protected:
   // A helper function for Enqueue. The EnqueueHelper does the following things.
   //  1. If there are programs in the scheduled_programs queue of the given
@@ -175,11 +181,6 @@ class ServingDeviceSelector {
                               int32_t priority,
                               std::optional<int64_t>& min_exec_time,
                               bool had_error, int64_t now_ns);
-  // Helper to estimate the time until the core becomes idle in nanoseconds.
-  // Only considers queues with priority at least as high as 'priority'.
-  static int64_t EstimateTimeTillIdleNs(const DeviceState& device_state,
-                                        int32_t priority, int64_t min_exec_time,
-                                        int64_t now_ns);
 
  private:
   friend DeviceReservation;
@@ -15,8 +15,12 @@ limitations under the License.
 #include "tsl/framework/serving_device_selector_policies.h"
 
 #include <atomic>
+#include <cstdint>
+#include <limits>
+#include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "tsl/framework/serving_device_selector.h"
 
 namespace tsl {
@@ -28,4 +32,49 @@ int RoundRobinPolicy::SelectDevice(
   return ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
 }
 
+int EarliestCompletionPolicy::SelectDevice(
+    absl::string_view program_fingerprint,
+    const ServingDeviceSelector::DeviceStates& device_states) {
+  const int num_devices = device_states.states.size();
+  const int64_t now_ns = now_ns_();
+  const int start = ordinal_.fetch_add(1, std::memory_order_relaxed) %
+                    num_devices;
+
+  absl::MutexLock lock(&mu_);
+  std::vector<bool>& used_devices = used_devices_[program_fingerprint];
+  used_devices.resize(num_devices, false);
+
+  int selected = start;
+  int64_t earliest_completion_ns = std::numeric_limits<int64_t>::max();
+  int64_t fewest_programs = std::numeric_limits<int64_t>::max();
+  for (int i = 0; i < num_devices; ++i) {
+    const int device = (start + i) % num_devices;
+    const auto& device_state = device_states.states[device];
+    // Consider the programs of all priorities, as they all delay this one.
+    int64_t completion_ns = ServingDeviceSelector::EstimateTimeTillIdleNs(
+        device_state, device_state.enqueued_programs.size() - 1,
+        /*min_exec_time=*/0, now_ns);
+    if (!used_devices[device]) completion_ns += device_miss_penalty_ns_;
+    // Programs which have never completed have no execution time estimate yet,
+    // so the number of in-flight programs breaks ties.
+    int64_t num_programs = 0;
+    for (const auto& programs : device_state.enqueued_programs) {
+      num_programs += programs.size();
+    }
+    for (const auto& programs : device_state.scheduled_programs) {
+      num_programs += programs.size();
+    }
+    if (completion_ns < earliest_completion_ns ||
+        (completion_ns == earliest_completion_ns &&
+         num_programs < fewest_programs)) {
+      earliest_completion_ns = completion_ns;
+      fewest_programs = num_programs;
+      selected = device;
+    }
+  }
+
+  used_devices[selected] = true;
+  return selected;
+}
+
 }  // namespace tsl
@@ -16,13 +16,22 @@ limitations under the License.
 #define TENSORFLOW_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
 
 #include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
 #include "tsl/framework/serving_device_selector.h"
 
 namespace tsl {
 
 enum class ServingDeviceSelectorPolicy {
   kRoundRobin,
+  kEarliestCompletion,
 };
 
 class RoundRobinPolicy : public ServingDeviceSelector::Policy {
@@ -37,6 +46,35 @@ class RoundRobinPolicy : public ServingDeviceSelector::Policy {
   std::atomic<uint64_t> ordinal_;
 };
 
+// Selects the device on which the program is expected to complete first. The
+// expected completion time of a device is the estimated time until it becomes
+// idle, from the in-flight programs and their running average execution
+// times, plus `device_miss_penalty_ns` if the program has never been run on the
+// device. The penalty accounts for the one-time costs of moving a program to a
+// new device, e.g. the transfer of the variables it uses. Ties are broken by
+// the number of in-flight programs, and then in round-robin order.
+class EarliestCompletionPolicy : public ServingDeviceSelector::Policy {
+ public:
+  explicit EarliestCompletionPolicy(
+      int64_t device_miss_penalty_ns = 0,
+      int64_t (*now_ns)() = absl::GetCurrentTimeNanos)
+      : device_miss_penalty_ns_(device_miss_penalty_ns), now_ns_(now_ns) {}
+
+  int SelectDevice(
+      absl::string_view program_fingerprint,
+      const ServingDeviceSelector::DeviceStates& device_states) override;
+
+ private:
+  const int64_t device_miss_penalty_ns_;
+  int64_t (*const now_ns_)();
+  std::atomic<uint64_t> ordinal_ = 0;
+
+  absl::Mutex mu_;
+  // The devices each program has been run on, by program fingerprint.
+  absl::flat_hash_map<std::string, std::vector<bool>> used_devices_
+      ABSL_GUARDED_BY(mu_);
+};
+
 }  // namespace tsl
 
 #endif  // TENSORFLOW_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
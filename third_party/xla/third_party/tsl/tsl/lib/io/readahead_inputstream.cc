@@ -0,0 +1,160 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/readahead_inputstream.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+
+namespace tsl {
+namespace io {
+
+ReadaheadInputStream::ReadaheadInputStream(RandomAccessFile* file,
+                                           int64_t block_size, int num_blocks,
+                                           thread::ThreadPool* pool)
+    : file_(file),
+      block_size_(std::max<int64_t>(block_size, 1)),
+      num_blocks_(std::max(num_blocks, 1)),
+      pool_(pool) {
+  mutex_lock l(mu_);
+  IssueReadsLocked();
+}
+
+ReadaheadInputStream::~ReadaheadInputStream() {
+  mutex_lock l(mu_);
+  while (num_outstanding_reads_ > 0) {
+    block_done_.wait(l);
+  }
+}
+
+void ReadaheadInputStream::IssueReadsLocked() {
+  while (!reached_eof_ && blocks_.size() < static_cast<size_t>(num_blocks_)) {
+    auto block = std::make_shared<Block>(next_block_offset_);
+    block->scratch.reset(new char[block_size_]);
+    next_block_offset_ += block_size_;
+    blocks_.push_back(block);
+    ++num_outstanding_reads_;
+    auto read = [this, block, generation = generation_]() {
+      StringPiece data;
+      absl::Status s =
+          file_->Read(block->offset, block_size_, &data, block->scratch.get());
+      mutex_lock l(mu_);
+      block->data = data;
+      block->status = std::move(s);
+      block->done = true;
+      // Blocks that were discarded by Seek() must not stop the reads of the
+      // current ones.
+      if (data.size() < static_cast<size_t>(block_size_) &&
+          generation == generation_) {
+        reached_eof_ = true;
+      }
+      --num_outstanding_reads_;
+      block_done_.notify_all();
+    };
+    if (pool_ != nullptr) {
+      pool_->Schedule(std::move(read));
+    } else {
+      Env::Default()->SchedClosure(std::move(read));
+    }
+  }
+}
+
+absl::Status ReadaheadInputStream::Consume(int64_t bytes, tstring* result) {
+  mutex_lock l(mu_);
+  while (bytes > 0) {
+    IssueReadsLocked();
+    if (blocks_.empty()) {
+      return errors::OutOfRange("reached end of file");
+    }
+    const std::shared_ptr<Block> block = blocks_.front();
+    while (!block->done) {
+      block_done_.wait(l);
+    }
+    if (!block->status.ok() && !errors::IsOutOfRange(block->status)) {
+      return block->status;
+    }
+    const int64_t available = block->data.size() - pos_in_block_;
+    if (available == 0) {
+      if (block->data.size() < static_cast<size_t>(block_size_)) {
+        return errors::OutOfRange("reached end of file");
+      }
+      blocks_.pop_front();
+      pos_in_block_ = 0;
+      continue;
+    }
+    const int64_t n = std::min(bytes, available);
+    if (result != nullptr) {
+      result->append(block->data.data() + pos_in_block_, n);
+    }
+    pos_in_block_ += n;
+    pos_ += n;
+    bytes -= n;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ReadaheadInputStream::ReadNBytes(int64_t bytes_to_read,
+                                              tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Cannot read negative number of bytes");
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  return Consume(bytes_to_read, result);
+}
+
+absl::Status ReadaheadInputStream::SkipNBytes(int64_t bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can't skip a negative number of bytes");
+  }
+  if (bytes_to_skip > num_blocks_ * block_size_) {
+    // Rather than reading the skipped blocks, check that the target position
+    // exists and restart reading from there.
+    char scratch;
+    StringPiece data;
+    absl::Status s =
+        file_->Read(pos_ + bytes_to_skip - 1, 1, &data, &scratch);
+    if ((s.ok() || errors::IsOutOfRange(s)) && data.size() == 1) {
+      return Seek(pos_ + bytes_to_skip);
+    }
+  }
+  return Consume(bytes_to_skip, /*result=*/nullptr);
+}
+
+int64_t ReadaheadInputStream::Tell() const { return pos_; }
+
+absl::Status ReadaheadInputStream::Seek(int64_t position) {
+  if (position < 0) {
+    return errors::InvalidArgument("Can't seek to a negative position");
+  }
+  mutex_lock l(mu_);
+  // Outstanding reads of the discarded blocks keep them alive until they
+  // complete.
+  blocks_.clear();
+  ++generation_;
+  next_block_offset_ = position;
+  reached_eof_ = false;
+  pos_in_block_ = 0;
+  pos_ = position;
+  IssueReadsLocked();
+  return absl::OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
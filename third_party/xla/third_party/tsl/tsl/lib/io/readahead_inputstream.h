@@ -0,0 +1,111 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+
+#include "tsl/lib/io/inputstream_interface.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/threadpool.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// Wraps a RandomAccessFile in an InputStreamInterface that keeps up to
+// `num_blocks` reads of `block_size` bytes ahead of the current position in
+// flight, so that sequential reads from high-latency file systems do not wait
+// out a storage round trip for every block.
+//
+// The reads are issued as ranged RandomAccessFile::Read() calls on `pool`, or
+// on Env::Default()->SchedClosure() if `pool` is null. A given instance of
+// ReadaheadInputStream is NOT safe for concurrent use by multiple threads.
+class ReadaheadInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of `file` or `pool`, which must outlive *this.
+  ReadaheadInputStream(RandomAccessFile* file, int64_t block_size,
+                       int num_blocks, thread::ThreadPool* pool = nullptr);
+
+  // Waits for the outstanding reads to complete.
+  ~ReadaheadInputStream() override;
+
+  absl::Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  absl::Status SkipNBytes(int64_t bytes_to_skip) override;
+
+  int64_t Tell() const override;
+
+  // Discards the blocks that have been read ahead, and restarts reading at
+  // `position`.
+  absl::Status Seek(int64_t position);
+
+  absl::Status Reset() override { return Seek(0); }
+
+ private:
+  // A block of the file, starting at `offset`.
+  struct Block {
+    explicit Block(int64_t offset) : offset(offset) {}
+    const int64_t offset;
+    std::unique_ptr<char[]> scratch;
+    // Valid once `done` is true. `data` may be shorter than the block size at
+    // the end of the file.
+    absl::string_view data;
+    absl::Status status;
+    bool done = false;
+  };
+
+  // Issues reads until `num_blocks_` blocks are buffered or in flight.
+  void IssueReadsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Reads or skips up to `bytes` bytes from the blocks, appending them to
+  // `result` unless it is null.
+  absl::Status Consume(int64_t bytes, tstring* result) TF_LOCKS_EXCLUDED(mu_);
+
+  RandomAccessFile* const file_;    // Not owned.
+  const int64_t block_size_;
+  const int num_blocks_;
+  thread::ThreadPool* const pool_;  // Not owned.
+
+  mutex mu_;
+  condition_variable block_done_;
+  // The blocks from the current position onwards, in file order.
+  std::deque<std::shared_ptr<Block>> blocks_ TF_GUARDED_BY(mu_);
+  // The offset of the next block to read.
+  int64_t next_block_offset_ TF_GUARDED_BY(mu_) = 0;
+  // True once a read of the current blocks reached the end of the file.
+  bool reached_eof_ TF_GUARDED_BY(mu_) = false;
+  // Incremented by Seek(), to tell the reads of discarded blocks apart.
+  uint64 generation_ TF_GUARDED_BY(mu_) = 0;
+  // The position within `blocks_.front()`.
+  int64_t pos_in_block_ TF_GUARDED_BY(mu_) = 0;
+  // Only accessed by the thread using the stream.
+  int64_t pos_ = 0;
+  // The number of reads that have not completed, including those of blocks
+  // that have been discarded.
+  int num_outstanding_reads_ TF_GUARDED_BY(mu_) = 0;
+
+  ReadaheadInputStream(const ReadaheadInputStream&) = delete;
+  void operator=(const ReadaheadInputStream&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
@@ -31,6 +31,10 @@ limitations under the License.
 namespace tsl {
 class RandomAccessFile;
 
+namespace thread {
+class ThreadPool;
+}  // namespace thread
+
 namespace io {
 
 struct RecordReaderOptions {
@@ -46,6 +50,16 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64_t buffer_size = 0;
 
+  // If readahead_blocks is non-zero, the file is read through a
+  // ReadaheadInputStream that keeps this many reads of readahead_block_size
+  // bytes in flight, and buffer_size is ignored. As with buffer_size, all reads
+  // should then be sequential.
+  int readahead_blocks = 0;
+  int64_t readahead_block_size = 1 << 20;
+  // The pool on which the readahead reads are run, or null to run them on
+  // Env::Default()->SchedClosure(). Not owned; must outlive the reader.
+  thread::ThreadPool* readahead_thread_pool = nullptr;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
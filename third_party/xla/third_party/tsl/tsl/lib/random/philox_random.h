@@ -23,6 +23,7 @@ limitations under the License.
 #include <stdlib.h>
 
 #include <cstdint>
+#include <limits>
 
 // Function qualifiers that need to work on both CPU and GPU.
 #if defined(__CUDACC__) || defined(__HIPCC__)
@@ -38,6 +39,17 @@ limitations under the License.
 
 #include <math.h>
 
+// SIMD instructions for PhiloxRandom::Generate on CPU.
+#if !defined(__CUDACC__) && !defined(__HIPCC__)
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#define TSL_PHILOX_SIMD_LANES 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TSL_PHILOX_SIMD_LANES 1
+#endif
+#endif
+
 namespace tsl {
 namespace random {
 
@@ -68,6 +80,131 @@ class Array {
   T data_[ElementCount];
 };
 
+#ifdef TSL_PHILOX_SIMD_LANES
+namespace internal {
+
+// The SIMD operations of PhiloxRandom::Generate on vectors of uint32_t lanes.
+struct PhiloxSimdLanes {
+#if defined(__AVX2__)
+  using Vector = __m256i;
+  static constexpr int kLanes = 8;
+
+  static Vector Load(const uint32_t* data) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+  }
+  static void Store(Vector v, uint32_t* data) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data), v);
+  }
+  static Vector Broadcast(uint32_t value) {
+    return _mm256_set1_epi32(static_cast<int>(value));
+  }
+  static Vector Increasing(uint32_t first) {
+    return _mm256_add_epi32(Broadcast(first),
+                            _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  }
+  static Vector Xor(Vector a, Vector b) { return _mm256_xor_si256(a, b); }
+
+  // Stores lane i of `words[j]` to data[4 * i + j].
+  static void StoreInterleaved(const Vector (&words)[4], uint32_t* data) {
+    const Vector words01_lo = _mm256_unpacklo_epi32(words[0], words[1]);
+    const Vector words23_lo = _mm256_unpacklo_epi32(words[2], words[3]);
+    const Vector words01_hi = _mm256_unpackhi_epi32(words[0], words[1]);
+    const Vector words23_hi = _mm256_unpackhi_epi32(words[2], words[3]);
+    // Lanes 0 and 4, 1 and 5, 2 and 6, 3 and 7.
+    const Vector lanes04 = _mm256_unpacklo_epi64(words01_lo, words23_lo);
+    const Vector lanes15 = _mm256_unpackhi_epi64(words01_lo, words23_lo);
+    const Vector lanes26 = _mm256_unpacklo_epi64(words01_hi, words23_hi);
+    const Vector lanes37 = _mm256_unpackhi_epi64(words01_hi, words23_hi);
+    Store(_mm256_permute2x128_si256(lanes04, lanes15, 0x20), data);
+    Store(_mm256_permute2x128_si256(lanes26, lanes37, 0x20), data + 8);
+    Store(_mm256_permute2x128_si256(lanes04, lanes15, 0x31), data + 16);
+    Store(_mm256_permute2x128_si256(lanes26, lanes37, 0x31), data + 24);
+  }
+
+  // Multiplies the lanes of `a` and `b` into 64 bits, `a` must have the same
+  // value in all lanes.
+  static void MultiplyHighLow(Vector a, Vector b, Vector* low, Vector* high) {
+    // The products of the even and of the odd lanes.
+    const Vector even = _mm256_mul_epu32(a, b);
+    const Vector odd = _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32));
+    *low = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    *high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+  }
+#elif defined(__SSE2__)
+  using Vector = __m128i;
+  static constexpr int kLanes = 4;
+
+  static Vector Load(const uint32_t* data) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  }
+  static void Store(Vector v, uint32_t* data) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data), v);
+  }
+  static Vector Broadcast(uint32_t value) {
+    return _mm_set1_epi32(static_cast<int>(value));
+  }
+  static Vector Increasing(uint32_t first) {
+    return _mm_add_epi32(Broadcast(first), _mm_setr_epi32(0, 1, 2, 3));
+  }
+  static Vector Xor(Vector a, Vector b) { return _mm_xor_si128(a, b); }
+
+  // Stores lane i of `words[j]` to data[4 * i + j].
+  static void StoreInterleaved(const Vector (&words)[4], uint32_t* data) {
+    const Vector words01_lo = _mm_unpacklo_epi32(words[0], words[1]);
+    const Vector words23_lo = _mm_unpacklo_epi32(words[2], words[3]);
+    const Vector words01_hi = _mm_unpackhi_epi32(words[0], words[1]);
+    const Vector words23_hi = _mm_unpackhi_epi32(words[2], words[3]);
+    Store(_mm_unpacklo_epi64(words01_lo, words23_lo), data);
+    Store(_mm_unpackhi_epi64(words01_lo, words23_lo), data + 4);
+    Store(_mm_unpacklo_epi64(words01_hi, words23_hi), data + 8);
+    Store(_mm_unpackhi_epi64(words01_hi, words23_hi), data + 12);
+  }
+
+  // Multiplies the lanes of `a` and `b` into 64 bits, `a` must have the same
+  // value in all lanes.
+  static void MultiplyHighLow(Vector a, Vector b, Vector* low, Vector* high) {
+    // The products of the even and of the odd lanes.
+    const Vector even = _mm_mul_epu32(a, b);
+    const Vector odd = _mm_mul_epu32(a, _mm_srli_epi64(b, 32));
+    const Vector odd_lanes = _mm_set_epi32(-1, 0, -1, 0);
+    *low = _mm_or_si128(_mm_andnot_si128(odd_lanes, even),
+                        _mm_slli_epi64(odd, 32));
+    *high = _mm_or_si128(_mm_srli_epi64(even, 32),
+                         _mm_and_si128(odd_lanes, odd));
+  }
+#elif defined(__ARM_NEON)
+  using Vector = uint32x4_t;
+  static constexpr int kLanes = 4;
+
+  static Vector Load(const uint32_t* data) { return vld1q_u32(data); }
+  static void Store(Vector v, uint32_t* data) { vst1q_u32(data, v); }
+  static Vector Broadcast(uint32_t value) { return vdupq_n_u32(value); }
+  static Vector Increasing(uint32_t first) {
+    static constexpr uint32_t kOffsets[kLanes] = {0, 1, 2, 3};
+    return vaddq_u32(Broadcast(first), vld1q_u32(kOffsets));
+  }
+  static Vector Xor(Vector a, Vector b) { return veorq_u32(a, b); }
+
+  // Stores lane i of `words[j]` to data[4 * i + j].
+  static void StoreInterleaved(const Vector (&words)[4], uint32_t* data) {
+    const uint32x4x4_t interleaved = {{words[0], words[1], words[2], words[3]}};
+    vst4q_u32(data, interleaved);
+  }
+
+  // Multiplies the lanes of `a` and `b` into 64 bits, `a` must have the same
+  // value in all lanes.
+  static void MultiplyHighLow(Vector a, Vector b, Vector* low, Vector* high) {
+    const uint64x2_t first = vmull_u32(vget_low_u32(a), vget_low_u32(b));
+    const uint64x2_t second = vmull_u32(vget_high_u32(a), vget_high_u32(b));
+    *low = vcombine_u32(vmovn_u64(first), vmovn_u64(second));
+    *high = vcombine_u32(vshrn_n_u64(first, 32), vshrn_n_u64(second, 32));
+  }
+#endif
+};
+
+}  // namespace internal
+#endif  // TSL_PHILOX_SIMD_LANES
+
 // A class that encapsulates all the states for a random number generator using
 // the philox_4x32_10 algorithm. Each invocation returns a 128-bit random bits
 // in the form of four uint32_t.
@@ -190,6 +327,28 @@ class PhiloxRandom {
     return counter;
   }
 
+  // Number of groups computed together by Generate.
+  static constexpr int kBatchSize = 16;
+
+  // Writes the next `count` groups of four random numbers to `results`, the
+  // same groups as `count` calls of operator().
+  //
+  // The rounds of a single group depend on each other, so operator() can't
+  // use SIMD instructions. Where available (AVX2, SSE2 or NEON), Generate
+  // computes kBatchSize groups at a time instead, with one group per SIMD
+  // lane.
+  void Generate(ResultType* results, int64_t count) {
+#ifdef TSL_PHILOX_SIMD_LANES
+    for (; count >= kBatchSize; count -= kBatchSize) {
+      GenerateBatch(results);
+      results += kBatchSize;
+    }
+#endif
+    for (; count > 0; --count) {
+      *results++ = (*this)();
+    }
+  }
+
  private:
   // We use the same constants as recommended by the original paper.
   static constexpr uint32_t kPhiloxW32A = 0x9E3779B9;
@@ -247,6 +406,70 @@ class PhiloxRandom {
     (*key)[1] += kPhiloxW32B;
   }
 
+#ifdef TSL_PHILOX_SIMD_LANES
+  // Computes the next kBatchSize groups, see Generate.
+  void GenerateBatch(ResultType* results) {
+    using Lanes = internal::PhiloxSimdLanes;
+    using Vector = Lanes::Vector;
+    // Several vectors per word of the counters, so that the rounds of
+    // different vectors overlap.
+    constexpr int kVectors = kBatchSize / Lanes::kLanes;
+    static_assert(kBatchSize % Lanes::kLanes == 0);
+
+    // counter[v][j] holds word j of the counters of groups
+    // [v * kLanes, (v + 1) * kLanes).
+    Vector counter[kVectors][4];
+    if (counter_[0] <= std::numeric_limits<uint32_t>::max() - kBatchSize) {
+      // Only the lowest word differs between the groups.
+      for (int v = 0; v < kVectors; ++v) {
+        counter[v][0] = Lanes::Increasing(counter_[0] + v * Lanes::kLanes);
+        for (int j = 1; j < 4; ++j) {
+          counter[v][j] = Lanes::Broadcast(counter_[j]);
+        }
+      }
+      counter_[0] += kBatchSize;
+    } else {
+      uint32_t words[4][kBatchSize];
+      for (int i = 0; i < kBatchSize; ++i) {
+        for (int j = 0; j < 4; ++j) {
+          words[j][i] = counter_[j];
+        }
+        SkipOne();
+      }
+      for (int v = 0; v < kVectors; ++v) {
+        for (int j = 0; j < 4; ++j) {
+          counter[v][j] = Lanes::Load(&words[j][v * Lanes::kLanes]);
+        }
+      }
+    }
+
+    // The same ten rounds as operator(), see ComputeSingleRound.
+    const Vector multiplier_a = Lanes::Broadcast(kPhiloxM4x32A);
+    const Vector multiplier_b = Lanes::Broadcast(kPhiloxM4x32B);
+    Key key = key_;
+    for (int round = 0; round < 10; ++round) {
+      if (round > 0) RaiseKey(&key);
+      const Vector key0 = Lanes::Broadcast(key[0]);
+      const Vector key1 = Lanes::Broadcast(key[1]);
+      for (int v = 0; v < kVectors; ++v) {
+        Vector lo0, hi0, lo1, hi1;
+        Lanes::MultiplyHighLow(multiplier_a, counter[v][0], &lo0, &hi0);
+        Lanes::MultiplyHighLow(multiplier_b, counter[v][2], &lo1, &hi1);
+        counter[v][0] = Lanes::Xor(Lanes::Xor(hi1, counter[v][1]), key0);
+        counter[v][1] = lo1;
+        counter[v][2] = Lanes::Xor(Lanes::Xor(hi0, counter[v][3]), key1);
+        counter[v][3] = lo0;
+      }
+    }
+
+    // ResultType is a plain array of four words.
+    uint32_t* data = reinterpret_cast<uint32_t*>(results);
+    for (int v = 0; v < kVectors; ++v) {
+      Lanes::StoreInterleaved(counter[v], data + v * Lanes::kLanes * 4);
+    }
+  }
+#endif  // TSL_PHILOX_SIMD_LANES
+
  private:
   ResultType counter_;
   Key key_;
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tsl/platform/logging.h"
 #include "tsl/platform/random.h"
 #include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
 
 namespace tsl {
 namespace random {
@@ -69,6 +70,68 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that Generate returns the same samples as the calls of
+// operator() it replaces, including across carries of the counter.
+TEST(PhiloxRandomTest, GenerateMatchTest) {
+  constexpr int count = 3 * PhiloxRandom::kBatchSize + 5;
+
+  PhiloxRandom::ResultType counter;
+  counter[0] = 0xfffffff0;
+  counter[1] = 0xffffffff;
+  counter[2] = 0xffffffff;
+  counter[3] = 0;
+  const uint64 test_seed = GetTestSeed();
+  PhiloxRandom::Key key;
+  key[0] = static_cast<uint32>(test_seed);
+  key[1] = static_cast<uint32>(test_seed >> 32);
+
+  PhiloxRandom gen1(counter, key);
+  std::vector<PhiloxRandom::ResultType> v1(count);
+  gen1.Generate(v1.data(), count);
+
+  PhiloxRandom gen2(counter, key);
+  for (int i = 0; i < count; ++i) {
+    const PhiloxRandom::ResultType sample = gen2();
+    for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+      ASSERT_EQ(v1[i][j], sample[j]);
+    }
+  }
+  // Both generators continue with the same samples.
+  const PhiloxRandom::ResultType next1 = gen1();
+  const PhiloxRandom::ResultType next2 = gen2();
+  for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+    ASSERT_EQ(next1[j], next2[j]);
+  }
+}
+
+static void BM_PhiloxRandom(::testing::benchmark::State& state) {
+  PhiloxRandom gen(173, 371);
+  std::vector<PhiloxRandom::ResultType> samples(1024);
+  for (auto s : state) {
+    for (auto& sample : samples) {
+      sample = gen();
+    }
+    testing::DoNotOptimize(samples);
+  }
+  state.SetItemsProcessed(state.iterations() * samples.size() *
+                          PhiloxRandom::kResultElementCount);
+}
+
+BENCHMARK(BM_PhiloxRandom);
+
+static void BM_PhiloxRandomGenerate(::testing::benchmark::State& state) {
+  PhiloxRandom gen(173, 371);
+  std::vector<PhiloxRandom::ResultType> samples(1024);
+  for (auto s : state) {
+    gen.Generate(samples.data(), samples.size());
+    testing::DoNotOptimize(samples);
+  }
+  state.SetItemsProcessed(state.iterations() * samples.size() *
+                          PhiloxRandom::kResultElementCount);
+}
+
+BENCHMARK(BM_PhiloxRandomGenerate);
+
 }  // namespace
 }  // namespace random
 }  // namespace tsl
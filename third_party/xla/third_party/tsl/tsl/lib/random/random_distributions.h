@@ -58,6 +58,10 @@ PHILOX_DEVICE_INLINE Int SignedAdd(Int a,
 //             distribution. This could be either float or double for now.
 // This class is meant to be implemented through specialization. The default
 // is not defined by design.
+//
+// operator() consumes a single sample of the generator. It accepts any other
+// generator of the same ResultType as Generator, e.g. one returning samples
+// computed ahead by PhiloxRandom::Generate.
 template <class Generator, typename RealType>
 class UniformDistribution;
 
@@ -74,8 +78,8 @@ class UniformDistribution<Generator, Eigen::half> {
   typedef Array<Eigen::half, kResultElementCount> ResultType;
   typedef Eigen::half ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class BitGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(BitGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -98,8 +102,8 @@ class UniformDistribution<Generator, bfloat16> {
   typedef Array<bfloat16, kResultElementCount> ResultType;
   typedef bfloat16 ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class BitGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(BitGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -122,8 +126,8 @@ class UniformDistribution<Generator, float> {
   typedef Array<float, kResultElementCount> ResultType;
   typedef float ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class BitGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(BitGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -146,8 +150,8 @@ class UniformDistribution<Generator, double> {
   typedef Array<double, kResultElementCount> ResultType;
   typedef double ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class BitGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(BitGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -174,8 +178,8 @@ class UniformDistribution<Generator, int32> {
   UniformDistribution(int32_t lo, int32_t hi)
       : lo_(lo), range_(static_cast<uint32>(hi) - static_cast<uint32>(lo)) {}
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class BitGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(BitGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -209,8 +213,8 @@ class UniformDistribution<Generator, int64_t> {
   UniformDistribution(int64_t lo, int64_t hi)
       : lo_(lo), range_(static_cast<uint64>(hi) - static_cast<uint64>(lo)) {}
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class BitGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(BitGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -230,7 +234,8 @@ class UniformDistribution<Generator, int64_t> {
 
 // Similar to `UniformDistribution`, except that instead of generating numbers
 // in the range [low, high), it generates numbers covering the whole range of
-// the integer type.
+// the integer type. operator() also consumes a single sample of any generator
+// of the same ResultType as Generator.
 template <typename Generator, typename IntType>
 class UniformFullIntDistribution;
 
@@ -247,8 +252,8 @@ class UniformFullIntDistribution32 {
   typedef Array<IntType, kResultElementCount> ResultType;
   typedef IntType ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class BitGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(BitGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -271,8 +276,8 @@ class UniformFullIntDistribution64 {
   typedef Array<IntType, kResultElementCount> ResultType;
   typedef IntType ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class BitGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(BitGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -368,6 +373,8 @@ class SingleSampleAdapter {
 //             distribution. This could be either float or double for now.
 // This class is meant to be implemented through specialization. The default
 // is not defined by design.
+// Like UniformDistribution, operator() consumes a single sample of any
+// generator of the same ResultType as Generator.
 template <class Generator, typename RealType>
 class NormalDistribution;
 
@@ -391,8 +398,8 @@ class NormalDistribution<Generator, Eigen::half> {
   typedef Array<Eigen::half, kResultElementCount> ResultType;
   typedef Eigen::half ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class BitGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(BitGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
@@ -418,8 +425,8 @@ class NormalDistribution<Generator, bfloat16> {
   typedef Array<bfloat16, kResultElementCount> ResultType;
   typedef bfloat16 ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class BitGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(BitGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     static_assert(kResultElementCount % 2 == 0,
@@ -448,8 +455,8 @@ class NormalDistribution<Generator, float> {
   typedef Array<float, kResultElementCount> ResultType;
   typedef float ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class BitGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(BitGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
@@ -472,8 +479,8 @@ class NormalDistribution<Generator, double> {
   typedef Array<double, kResultElementCount> ResultType;
   typedef double ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class BitGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(BitGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
@@ -0,0 +1,252 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/platform/cloud/disk_file_block_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "tsl/platform/errors.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/random.h"
+#include "tsl/platform/strcat.h"
+
+namespace tsl {
+
+DiskFileBlockCache::DiskFileBlockCache(const string& cache_dir,
+                                       size_t block_size, size_t max_bytes,
+                                       BlockFetcher block_fetcher, Env* env)
+    : block_size_(block_size),
+      max_bytes_(max_bytes),
+      block_fetcher_(block_fetcher),
+      env_(env) {
+  if (block_size_ == 0 || max_bytes_ == 0 || cache_dir.empty()) return;
+  // A directory of its own keeps the blocks of different caches and processes
+  // apart, and lets the destructor remove them.
+  const string block_dir = io::JoinPath(
+      cache_dir, strings::StrCat("tf_block_cache_", random::New64()));
+  Status status = env_->RecursivelyCreateDir(block_dir);
+  if (!status.ok()) {
+    LOG(WARNING) << "Disk file block cache is disabled, could not create "
+                 << block_dir << ": " << status;
+    return;
+  }
+  block_dir_ = block_dir;
+  VLOG(1) << "Disk file block cache in " << block_dir_ << " is enabled";
+}
+
+DiskFileBlockCache::~DiskFileBlockCache() { Close(); }
+
+void DiskFileBlockCache::Close() {
+  {
+    mutex_lock lock(mu_);
+    if (closed_ || block_dir_.empty()) return;
+    closed_ = true;
+    block_map_.clear();
+    lru_list_.clear();
+    cache_size_ = 0;
+  }
+  int64_t undeleted_files, undeleted_dirs;
+  Status status =
+      env_->DeleteRecursively(block_dir_, &undeleted_files, &undeleted_dirs);
+  if (!status.ok()) {
+    LOG(WARNING) << "Could not delete disk file block cache " << block_dir_
+                 << ": " << status;
+  }
+}
+
+bool DiskFileBlockCache::IsCacheEnabled() const {
+  if (block_size_ == 0 || max_bytes_ == 0 || block_dir_.empty()) return false;
+  mutex_lock lock(mu_);
+  return !closed_;
+}
+
+string DiskFileBlockCache::BlockPath(uint64 id) const {
+  return io::JoinPath(block_dir_, strings::StrCat("block_", id));
+}
+
+Status DiskFileBlockCache::LoadBlock(const Key& key, std::vector<char>* data) {
+  string path;
+  size_t size = 0;
+  {
+    mutex_lock lock(mu_);
+    auto entry = block_map_.find(key);
+    if (entry != block_map_.end()) {
+      lru_list_.erase(entry->second.lru_iterator);
+      lru_list_.push_front(key);
+      entry->second.lru_iterator = lru_list_.begin();
+      path = BlockPath(entry->second.id);
+      size = entry->second.size;
+    }
+  }
+  if (!path.empty()) {
+    // The block may be evicted concurrently, in which case it is fetched
+    // again below.
+    std::unique_ptr<RandomAccessFile> file;
+    data->resize(size);
+    StringPiece result;
+    if (env_->NewRandomAccessFile(path, &file).ok() &&
+        file->Read(0, size, &result, data->data()).ok() &&
+        result.size() == size) {
+      if (result.data() != data->data()) {
+        memcpy(data->data(), result.data(), size);
+      }
+      if (cache_stats_ != nullptr) cache_stats_->RecordCacheHitBlockSize(size);
+      return OkStatus();
+    }
+  }
+  data->resize(block_size_);
+  size_t bytes_transferred = 0;
+  TF_RETURN_IF_ERROR(block_fetcher_(key.first, key.second, block_size_,
+                                    data->data(), &bytes_transferred));
+  data->resize(bytes_transferred);
+  if (cache_stats_ != nullptr) {
+    cache_stats_->RecordCacheMissBlockSize(bytes_transferred);
+  }
+  if (bytes_transferred > 0) InsertBlock(key, *data);
+  return OkStatus();
+}
+
+void DiskFileBlockCache::InsertBlock(const Key& key,
+                                     const std::vector<char>& data) {
+  uint64 id;
+  {
+    mutex_lock lock(mu_);
+    if (closed_ || block_map_.count(key)) return;
+    id = next_block_id_++;
+  }
+  const string path = BlockPath(id);
+  std::unique_ptr<WritableFile> file;
+  Status status = env_->NewWritableFile(path, &file);
+  if (status.ok()) {
+    status = file->Append(StringPiece(data.data(), data.size()));
+  }
+  if (status.ok()) status = file->Close();
+  if (!status.ok()) {
+    LOG_FIRST_N(WARNING, 5) << "Could not write block to disk file block cache "
+                            << path << ": " << status;
+    env_->DeleteFile(path).IgnoreError();
+    return;
+  }
+  mutex_lock lock(mu_);
+  if (closed_ || block_map_.count(key)) {
+    // The cache was closed or another reader inserted the block meanwhile.
+    env_->DeleteFile(path).IgnoreError();
+    return;
+  }
+  while (!lru_list_.empty() && cache_size_ + data.size() > max_bytes_) {
+    RemoveBlock_Locked(block_map_.find(lru_list_.back()));
+  }
+  lru_list_.push_front(key);
+  block_map_[key] = {data.size(), id, lru_list_.begin()};
+  cache_size_ += data.size();
+}
+
+Status DiskFileBlockCache::Read(const string& filename, size_t offset,
+                                size_t n, char* buffer,
+                                size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  if (n == 0) {
+    return OkStatus();
+  }
+  if (!IsCacheEnabled() || (n > max_bytes_)) {
+    return block_fetcher_(filename, offset, n, buffer, bytes_transferred);
+  }
+  // Calculate the block-aligned start and end of the read.
+  size_t start = block_size_ * (offset / block_size_);
+  size_t finish = block_size_ * ((offset + n) / block_size_);
+  if (finish < offset + n) {
+    finish += block_size_;
+  }
+  size_t total_bytes_transferred = 0;
+  std::vector<char> data;
+  for (size_t pos = start; pos < finish; pos += block_size_) {
+    TF_RETURN_IF_ERROR(LoadBlock(std::make_pair(filename, pos), &data));
+    if (offset >= pos + data.size()) {
+      *bytes_transferred = total_bytes_transferred;
+      return errors::OutOfRange("EOF at offset ", offset, " in file ", filename,
+                                " at position ", pos, " with data size ",
+                                data.size());
+    }
+    size_t begin = offset > pos ? offset - pos : 0;
+    size_t end = std::min(data.size(), offset + n - pos);
+    if (begin < end) {
+      memcpy(&buffer[total_bytes_transferred], data.data() + begin,
+             end - begin);
+      total_bytes_transferred += end - begin;
+    }
+    if (data.size() < block_size_) {
+      // The block was a partial block and thus signals EOF at its upper bound.
+      break;
+    }
+  }
+  *bytes_transferred = total_bytes_transferred;
+  return OkStatus();
+}
+
+bool DiskFileBlockCache::ValidateAndUpdateFileSignature(
+    const string& filename, int64_t file_signature) {
+  mutex_lock lock(mu_);
+  auto it = file_signature_map_.find(filename);
+  if (it != file_signature_map_.end()) {
+    if (it->second == file_signature) {
+      return true;
+    }
+    RemoveFile_Locked(filename);
+    it->second = file_signature;
+    return false;
+  }
+  file_signature_map_[filename] = file_signature;
+  return true;
+}
+
+size_t DiskFileBlockCache::CacheSize() const {
+  mutex_lock lock(mu_);
+  return cache_size_;
+}
+
+void DiskFileBlockCache::Flush() {
+  mutex_lock lock(mu_);
+  while (!block_map_.empty()) {
+    RemoveBlock_Locked(block_map_.begin());
+  }
+}
+
+void DiskFileBlockCache::RemoveFile(const string& filename) {
+  mutex_lock lock(mu_);
+  RemoveFile_Locked(filename);
+}
+
+void DiskFileBlockCache::RemoveFile_Locked(const string& filename) {
+  Key begin = std::make_pair(filename, 0);
+  auto it = block_map_.lower_bound(begin);
+  while (it != block_map_.end() && it->first.first == filename) {
+    auto next = std::next(it);
+    RemoveBlock_Locked(it);
+    it = next;
+  }
+}
+
+void DiskFileBlockCache::RemoveBlock_Locked(BlockMap::iterator entry) {
+  env_->DeleteFile(BlockPath(entry->second.id)).IgnoreError();
+  lru_list_.erase(entry->second.lru_iterator);
+  cache_size_ -= entry->second.size;
+  block_map_.erase(entry);
+}
+
+}  // namespace tsl
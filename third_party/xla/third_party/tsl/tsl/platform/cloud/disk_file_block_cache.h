@@ -0,0 +1,130 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+#define TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tsl/platform/cloud/file_block_cache.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+
+/// \brief An LRU block cache of file contents on a local disk, keyed by
+/// {filename, offset}.
+///
+/// The blocks are stored as files in a directory created under `cache_dir`
+/// for the lifetime of the cache, so a local SSD can hold far more of a remote
+/// dataset than RAM. It is typically used as the block fetcher of a
+/// RamFileBlockCache with the same block size, which keeps the hot blocks in
+/// memory.
+class DiskFileBlockCache : public FileBlockCache {
+ public:
+  DiskFileBlockCache(const string& cache_dir, size_t block_size,
+                     size_t max_bytes, BlockFetcher block_fetcher,
+                     Env* env = Env::Default());
+
+  /// Deletes the block files, see Close().
+  ~DiskFileBlockCache() override;
+
+  /// Deletes the block files and the directory holding them. Later reads go to
+  /// the block fetcher without caching. Reads may run concurrently.
+  void Close() TF_LOCKS_EXCLUDED(mu_);
+
+  /// Read `n` bytes from `filename` starting at `offset` into `out`, with the
+  /// same semantics as RamFileBlockCache::Read. Blocks that cannot be written
+  /// to the cache directory are returned without being cached.
+  Status Read(const string& filename, size_t offset, size_t n, char* buffer,
+              size_t* bytes_transferred) override;
+
+  bool ValidateAndUpdateFileSignature(const string& filename,
+                                      int64_t file_signature) override
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Remove all cached blocks for `filename`.
+  void RemoveFile(const string& filename) override TF_LOCKS_EXCLUDED(mu_);
+
+  /// Remove all cached data.
+  void Flush() override TF_LOCKS_EXCLUDED(mu_);
+
+  /// Accessors for cache parameters.
+  size_t block_size() const override { return block_size_; }
+  size_t max_bytes() const override { return max_bytes_; }
+  uint64 max_staleness() const override { return 0; }
+
+  /// The current size (in bytes) of the cache.
+  size_t CacheSize() const override TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns true if the cache is enabled. If false, the BlockFetcher callback
+  // is always executed during Read.
+  bool IsCacheEnabled() const override TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  typedef std::pair<string, size_t> Key;
+
+  /// A block stored in the file `BlockPath(id)`.
+  struct Block {
+    size_t size;
+    uint64 id;
+    std::list<Key>::iterator lru_iterator;
+  };
+  typedef std::map<Key, Block> BlockMap;
+
+  string BlockPath(uint64 id) const;
+
+  /// Reads the block `key` from the disk or, if it isn't cached, from the
+  /// block fetcher and stores it on the disk.
+  Status LoadBlock(const Key& key, std::vector<char>* data)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Writes a fetched block to the disk and inserts it into the cache.
+  void InsertBlock(const Key& key, const std::vector<char>& data)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  void RemoveFile_Locked(const string& filename)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void RemoveBlock_Locked(BlockMap::iterator entry)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const size_t block_size_;
+  const size_t max_bytes_;
+  const BlockFetcher block_fetcher_;
+  Env* const env_;  // not owned
+  /// The directory holding the block files, empty if it couldn't be created.
+  string block_dir_;
+
+  mutable mutex mu_;
+  BlockMap block_map_ TF_GUARDED_BY(mu_);
+  /// The keys of the cached blocks, most recently used first.
+  std::list<Key> lru_list_ TF_GUARDED_BY(mu_);
+  std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+  size_t cache_size_ TF_GUARDED_BY(mu_) = 0;
+  uint64 next_block_id_ TF_GUARDED_BY(mu_) = 0;
+  /// Whether Close() deleted the block files.
+  bool closed_ TF_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
@@ -0,0 +1,179 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/platform/cloud/disk_file_block_cache.h"
+
+#include <cstring>
+#include <vector>
+
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/test.h"
+
+namespace tsl {
+namespace {
+
+Status ReadCache(DiskFileBlockCache* cache, const string& filename,
+                 size_t offset, size_t n, std::vector<char>* out) {
+  out->clear();
+  out->resize(n, 0);
+  size_t bytes_transferred = 0;
+  Status status =
+      cache->Read(filename, offset, n, out->data(), &bytes_transferred);
+  EXPECT_LE(bytes_transferred, n);
+  out->resize(bytes_transferred, n);
+  return status;
+}
+
+// Serves a file of `file_size` bytes where every byte is its offset modulo 256.
+class CountingFetcher {
+ public:
+  explicit CountingFetcher(size_t file_size) : file_size_(file_size) {}
+
+  DiskFileBlockCache::BlockFetcher fetcher() {
+    return [this](const string& filename, size_t offset, size_t n,
+                  char* buffer, size_t* bytes_transferred) {
+      calls_++;
+      *bytes_transferred = 0;
+      for (size_t i = offset; i < offset + n && i < file_size_; i++) {
+        buffer[(*bytes_transferred)++] = static_cast<char>(i % 256);
+      }
+      return OkStatus();
+    };
+  }
+
+  int calls() const { return calls_; }
+
+ private:
+  const size_t file_size_;
+  int calls_ = 0;
+};
+
+TEST(DiskFileBlockCacheTest, IsCacheEnabled) {
+  CountingFetcher fetcher(0);
+  const string dir = testing::TmpDir();
+  DiskFileBlockCache cache1(dir, 0, 32, fetcher.fetcher());
+  DiskFileBlockCache cache2(dir, 16, 0, fetcher.fetcher());
+  DiskFileBlockCache cache3("", 16, 32, fetcher.fetcher());
+  DiskFileBlockCache cache4(dir, 16, 32, fetcher.fetcher());
+
+  EXPECT_FALSE(cache1.IsCacheEnabled());
+  EXPECT_FALSE(cache2.IsCacheEnabled());
+  EXPECT_FALSE(cache3.IsCacheEnabled());
+  EXPECT_TRUE(cache4.IsCacheEnabled());
+}
+
+TEST(DiskFileBlockCacheTest, ReadsFromDisk) {
+  CountingFetcher fetcher(40);
+  DiskFileBlockCache cache(testing::TmpDir(), 16, 1024, fetcher.fetcher());
+  std::vector<char> out;
+
+  // Spans the first two blocks.
+  TF_EXPECT_OK(ReadCache(&cache, "file", 10, 10, &out));
+  ASSERT_EQ(out.size(), 10);
+  EXPECT_EQ(out[0], 10);
+  EXPECT_EQ(out[9], 19);
+  EXPECT_EQ(fetcher.calls(), 2);
+  EXPECT_EQ(cache.CacheSize(), 32);
+
+  // Served from the disk.
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 32, &out));
+  ASSERT_EQ(out.size(), 32);
+  EXPECT_EQ(out[31], 31);
+  EXPECT_EQ(fetcher.calls(), 2);
+
+  // The last block is partial.
+  TF_EXPECT_OK(ReadCache(&cache, "file", 30, 20, &out));
+  ASSERT_EQ(out.size(), 10);
+  EXPECT_EQ(out[9], 39);
+  EXPECT_EQ(fetcher.calls(), 3);
+  EXPECT_TRUE(errors::IsOutOfRange(ReadCache(&cache, "file", 45, 2, &out)));
+  EXPECT_EQ(fetcher.calls(), 3);
+}
+
+TEST(DiskFileBlockCacheTest, EvictsLeastRecentlyUsed) {
+  CountingFetcher fetcher(64);
+  DiskFileBlockCache cache(testing::TmpDir(), 16, 32, fetcher.fetcher());
+  std::vector<char> out;
+
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 16, 16, &out));
+  // Touch the first block, then evict the second one.
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 32, 16, &out));
+  EXPECT_EQ(fetcher.calls(), 3);
+  EXPECT_EQ(cache.CacheSize(), 32);
+
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  EXPECT_EQ(fetcher.calls(), 3);
+  TF_EXPECT_OK(ReadCache(&cache, "file", 16, 16, &out));
+  EXPECT_EQ(fetcher.calls(), 4);
+}
+
+TEST(DiskFileBlockCacheTest, ValidateAndUpdateFileSignature) {
+  CountingFetcher fetcher(64);
+  DiskFileBlockCache cache(testing::TmpDir(), 16, 64, fetcher.fetcher());
+  std::vector<char> out;
+
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 123));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 123));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  EXPECT_EQ(fetcher.calls(), 1);
+
+  EXPECT_FALSE(cache.ValidateAndUpdateFileSignature("file", 321));
+  EXPECT_EQ(cache.CacheSize(), 0);
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  EXPECT_EQ(fetcher.calls(), 2);
+}
+
+TEST(DiskFileBlockCacheTest, CloseDeletesBlocks) {
+  CountingFetcher fetcher(64);
+  const string dir = io::JoinPath(testing::TmpDir(), "close_deletes_blocks");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir));
+  std::vector<string> children;
+  {
+    DiskFileBlockCache cache(dir, 16, 64, fetcher.fetcher());
+    std::vector<char> out;
+    TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+    TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+    EXPECT_EQ(children.size(), 1);
+
+    cache.Close();
+    TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+    EXPECT_TRUE(children.empty());
+    EXPECT_FALSE(cache.IsCacheEnabled());
+    EXPECT_EQ(cache.CacheSize(), 0);
+
+    // Reads go to the fetcher.
+    TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+    ASSERT_EQ(out.size(), 16);
+    EXPECT_EQ(out[15], 15);
+    EXPECT_EQ(fetcher.calls(), 2);
+  }
+
+  {
+    DiskFileBlockCache cache(dir, 16, 64, fetcher.fetcher());
+    std::vector<char> out;
+    TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  }
+  TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+  EXPECT_TRUE(children.empty());
+}
+
+}  // namespace
+}  // namespace tsl
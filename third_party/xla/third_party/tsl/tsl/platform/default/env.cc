@@ -40,6 +40,7 @@ limitations under the License.
 #include "tsl/platform/load_library.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/mutex.h"
+#include "tsl/platform/numa.h"
 #include "tsl/platform/ram_file_system.h"
 #include "tsl/platform/strcat.h"
 #include "tsl/protobuf/error_codes.pb.h"
@@ -64,6 +65,7 @@ class PThread : public Thread {
     ThreadParams* params = new ThreadParams;
     params->name = name;
     params->fn = std::move(fn);
+    params->numa_node = thread_options.numa_node;
     pthread_attr_t attributes;
     pthread_attr_init(&attributes);
     if (thread_options.stack_size != 0) {
@@ -82,6 +84,7 @@ class PThread : public Thread {
   struct ThreadParams {
     std::string name;
     absl::AnyInvocable<void()> fn;
+    int numa_node = port::kNUMANoAffinity;
   };
   static void* ThreadFn(void* params_arg) {
     std::unique_ptr<ThreadParams> params(
@@ -90,6 +93,9 @@ class PThread : public Thread {
       mutex_lock l(name_mutex);
       GetThreadNameRegistry().emplace(std::this_thread::get_id(), params->name);
     }
+    if (params->numa_node != port::kNUMANoAffinity) {
+      port::NUMASetThreadNodeAffinity(params->numa_node);
+    }
     params->fn();
     {
       mutex_lock l(name_mutex);
@@ -15,10 +15,16 @@ limitations under the License.
 
 #include "tsl/platform/file_system_helper.h"
 
+#include <atomic>
+#include <cstdlib>
 #include <deque>
+#include <map>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/strings/numbers.h"
 #include "tsl/platform/cpu_info.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
@@ -37,22 +43,129 @@ namespace {
 
 const int kNumThreads = port::NumSchedulableCPUs();
 
+// Environment variable with the number of seconds for which directory listings
+// are cached by GetMatchingPaths. Caching is disabled if it is not set or 0.
+constexpr char kListingCacheMaxAge[] = "TF_FILE_LISTING_CACHE_MAX_AGE";
+// Maximum number of directory listings in the cache.
+constexpr size_t kListingCacheMaxEntries = 1024;
+
+#if !TARGET_OS_IPHONE
+// Thread pool shared by all GetMatchingPaths calls, so that expanding a glob
+// doesn't start new threads for every directory.
+thread::ThreadPool* GetMatchingPathsThreadPool() {
+  static thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "GetMatchingPaths", kNumThreads);
+  return pool;
+}
+#endif
+
 // Run a function in parallel using a ThreadPool, but skip the ThreadPool
 // on the iOS platform due to its problems with more than a few threads.
+//
+// The calling thread works on the items as well and only waits for the items
+// that pool threads already started. Nested calls from the pool threads thus
+// can't deadlock when all the threads of the pool are busy.
 void ForEach(int first, int last, const std::function<void(int)>& f) {
 #if TARGET_OS_IPHONE
   for (int i = first; i < last; i++) {
     f(i);
   }
 #else
-  int num_threads = std::min(kNumThreads, last - first);
-  thread::ThreadPool threads(Env::Default(), "ForEach", num_threads);
-  for (int i = first; i < last; i++) {
-    threads.Schedule([f, i] { f(i); });
+  struct State {
+    explicit State(int first) : next(first) {}
+    std::atomic<int> next;
+    mutex mu;
+    condition_variable done_cv;
+    int num_done TF_GUARDED_BY(mu) = 0;
+  };
+  // Shared with the scheduled closures, which may only run after this call
+  // returned.
+  auto state = std::make_shared<State>(first);
+  auto run_items = [state, last, f]() {
+    int num_run = 0;
+    for (int i = state->next++; i < last; i = state->next++) {
+      f(i);
+      num_run++;
+    }
+    if (num_run > 0) {
+      mutex_lock l(state->mu);
+      state->num_done += num_run;
+      state->done_cv.notify_all();
+    }
+  };
+  const int num_helpers = std::min(kNumThreads, last - first) - 1;
+  for (int i = 0; i < num_helpers; i++) {
+    GetMatchingPathsThreadPool()->Schedule(run_items);
+  }
+  run_items();
+  mutex_lock l(state->mu);
+  while (state->num_done < last - first) {
+    state->done_cv.wait(l);
   }
 #endif
 }
 
+// Returns the maximum age in seconds of the cached directory listings, 0 if
+// listings are not cached.
+uint64_t ListingCacheMaxAge() {
+  const char* value = std::getenv(kListingCacheMaxAge);
+  uint64_t max_age = 0;
+  if (value == nullptr || !absl::SimpleAtoi(value, &max_age)) return 0;
+  return max_age;
+}
+
+// Cache of directory listings used by GetMatchingPaths, keyed by the file
+// system and the directory. Listing a directory of an object store can take
+// seconds, while jobs often expand globs over the same directories repeatedly,
+// e.g. for every input pipeline of a dataset.
+class ListingCache {
+ public:
+  // Returns the children of `dir` listed at most `max_age` seconds ago.
+  absl::Status GetChildren(FileSystem* fs, Env* env, const std::string& dir,
+                           uint64_t max_age,
+                           std::vector<std::string>* children) {
+    const uint64_t now = env->NowSeconds();
+    const Key key(fs, dir);
+    {
+      mutex_lock l(mu_);
+      auto it = entries_.find(key);
+      if (it != entries_.end() && now - it->second.timestamp <= max_age) {
+        *children = it->second.children;
+        return absl::OkStatus();
+      }
+    }
+    TF_RETURN_IF_ERROR(fs->GetChildren(dir, children));
+    mutex_lock l(mu_);
+    if (entries_.size() >= kListingCacheMaxEntries) {
+      for (auto it = entries_.begin(); it != entries_.end();) {
+        if (now - it->second.timestamp > max_age) {
+          it = entries_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      if (entries_.size() >= kListingCacheMaxEntries) entries_.clear();
+    }
+    entries_[key] = {now, *children};
+    return absl::OkStatus();
+  }
+
+ private:
+  using Key = std::pair<const FileSystem*, std::string>;
+  struct Entry {
+    uint64_t timestamp;
+    std::vector<std::string> children;
+  };
+
+  mutex mu_;
+  std::map<Key, Entry> entries_ TF_GUARDED_BY(mu_);
+};
+
+ListingCache* GetListingCache() {
+  static ListingCache* cache = new ListingCache();
+  return cache;
+}
+
 // A globbing pattern can only start with these characters:
 static const char kGlobbingChars[] = "*?[\\";
 
@@ -190,14 +303,16 @@ absl::Status GetMatchingPaths(FileSystem* fs, Env* env, const string& pattern,
   mutex result_mutex;
   mutex queue_mutex;
 
+  const uint64_t listing_cache_max_age = ListingCacheMaxAge();
+
   while (!expand_queue.empty()) {
     next_expand_queue.clear();
 
     // The work item for every item in `expand_queue`.
     // pattern, we process them in parallel.
-    auto handle_level = [&fs, &results, &dirs, &expand_queue,
-                         &next_expand_queue, &result_mutex,
-                         &queue_mutex](int i) {
+    auto handle_level = [&fs, &env, &results, &dirs, &expand_queue,
+                         &next_expand_queue, &result_mutex, &queue_mutex,
+                         listing_cache_max_age](int i) {
       // See invariants above, all of these are valid accesses.
       const auto& queue_item = expand_queue.at(i);
       const std::string& parent = queue_item.first;
@@ -206,7 +321,11 @@ absl::Status GetMatchingPaths(FileSystem* fs, Env* env, const string& pattern,
 
       // Get all children of `parent`. If this fails, return early.
       std::vector<std::string> children;
-      absl::Status s = fs->GetChildren(parent, &children);
+      absl::Status s =
+          listing_cache_max_age > 0
+              ? GetListingCache()->GetChildren(fs, env, parent,
+                                               listing_cache_max_age, &children)
+              : fs->GetChildren(parent, &children);
       if (s.code() == absl::StatusCode::kPermissionDenied) {
         return;
       }
@@ -221,14 +340,19 @@ absl::Status GetMatchingPaths(FileSystem* fs, Env* env, const string& pattern,
       // We also check that children match the pattern in parallel, for speedup.
       // We store the status of the match and `IsDirectory` in
       // `children_status` array, one element for each children.
+      // Matches of the last pattern are results whether or not they are
+      // directories, so we only stat the children on the intermediate levels.
+      // For a glob over the files of a single directory this saves one stat
+      // per file.
+      const bool is_last_level = index == dirs.size() - 1;
       std::vector<absl::Status> children_status(children.size());
       auto handle_children = [&fs, &match_pattern, &parent, &children,
-                              &children_status](int j) {
+                              &children_status, is_last_level](int j) {
         const std::string path = io::JoinPath(parent, children[j]);
         if (!fs->Match(path, match_pattern)) {
           children_status[j] = absl::Status(absl::StatusCode::kCancelled,
                                             "Operation not needed");
-        } else {
+        } else if (!is_last_level) {
           children_status[j] = fs->IsDirectory(path);
         }
       };
@@ -249,7 +373,7 @@ absl::Status GetMatchingPaths(FileSystem* fs, Env* env, const string& pattern,
         }
 
         const std::string path = io::JoinPath(parent, children[j]);
-        if (index == dirs.size() - 1) {
+        if (is_last_level) {
           mutex_lock l(result_mutex);
           results->emplace_back(path);
         } else if (children_status[j].ok()) {
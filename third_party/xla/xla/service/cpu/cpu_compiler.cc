@@ -780,12 +780,12 @@ absl::Status CpuCompiler::RunHloPassesAfterLayoutAssn(
   }();
 
   // Outline ops in the entry computation into calls to subcomputations.
-  if (!is_aot_compile) {
+  if (!is_aot_compile || module->config().intra_op_parallelism_threads() > 0) {
     // Run ParallelTaskAssigner to assign parallel tasks to HLOs in module.
-    // Note this is not run for AOT because it would bring in thread pool
-    // and thread synchronization dependencies which would likely increase
-    // binary size (and most AOT applications are single-threaded).
-    // TODO(b/29630486) Support multi-threaded AOT.
+    // Note this is not run for AOT unless requested with
+    // CpuAotCompilationOptions::intra_op_parallelism, because it brings in
+    // thread pool and thread synchronization dependencies which would likely
+    // increase binary size (and most AOT applications are single-threaded).
     pipeline.AddPass<ParallelTaskAssigner>(
         max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
   }
@@ -1440,6 +1440,11 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
   for (size_t i = 0; i < modules.size(); ++i) {
     HloModule* module = modules[i].get();
     VLOG(1) << "Compiling ahead-of-time: " << module->name();
+    // The intra-op thread pool of the compiling process says nothing about
+    // the one the compiled code runs on.
+    module->mutable_config().set_intra_op_parallelism_threads(
+        options.intra_op_parallelism() > 0 ? options.intra_op_parallelism()
+                                           : -1);
 
     if (!module->has_schedule()) {
       TF_RETURN_IF_ERROR(
@@ -91,6 +91,13 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   bool use_mlir_hlo_lowering() const { return use_mlir_hlo_lowering_; }
   void set_use_mlir_hlo_lowering(bool value) { use_mlir_hlo_lowering_ = value; }
 
+  // The maximum number of parallel tasks the compiled code splits an HLO into.
+  // Parallel tasks run on the intra-op thread pool of the run options, and
+  // require the fork-join runtime to be linked in. If not positive, the
+  // compiled code is single-threaded.
+  int intra_op_parallelism() const { return intra_op_parallelism_; }
+  void set_intra_op_parallelism(int value) { intra_op_parallelism_ = value; }
+
  private:
   const std::string triple_;
   const std::string cpu_name_;
@@ -98,6 +105,7 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   const std::string entry_point_name_;
   const RelocationModel relocation_model_;
   bool use_mlir_hlo_lowering_ = false;
+  int intra_op_parallelism_ = 0;
 };
 
 class CpuAotCompilationResult : public AotCompilationResult {